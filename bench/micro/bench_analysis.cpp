@@ -0,0 +1,58 @@
+/*********************                                                        */
+/*! \file bench_analysis.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Micro-benchmarks of the analyses of a transition system.
+**
+**/
+
+#include "benchmark/benchmark.h"
+#include "bench/micro/synthetic.h"
+#include "core/fts.h"
+#include "modifiers/static_coi.h"
+#include "smt/available_solvers.h"
+#include "utils/term_walkers.h"
+
+using namespace pono;
+using namespace pono_bench;
+using namespace smt;
+using namespace std;
+
+// StaticConeOfInfluence of the property, which keeps half of the chain
+static void BM_StaticConeOfInfluence(benchmark::State & state)
+{
+  size_t num_vars = state.range(0);
+  FunctionalTransitionSystem fts(create_solver(BTOR));
+  Term prop = chain_system(fts, num_vars, 32);
+  for (auto _ : state) {
+    FunctionalTransitionSystem copy(fts);
+    StaticConeOfInfluence coi(copy, { prop }, 0);
+    benchmark::DoNotOptimize(copy.trans());
+  }
+  state.SetItemsProcessed(state.iterations() * num_vars);
+}
+BENCHMARK(BM_StaticConeOfInfluence)->Arg(64)->Arg(512)->Arg(4096);
+
+// TermOpCollector walk of trans for the arithmetic operators
+static void BM_TermOpCollector(benchmark::State & state)
+{
+  size_t num_vars = state.range(0);
+  FunctionalTransitionSystem fts(create_solver(BTOR));
+  chain_system(fts, num_vars, 32);
+  const unordered_set<PrimOp> ops({ BVAdd, BVMul });
+  for (auto _ : state) {
+    TermOpCollector collector(fts.solver());
+    UnorderedTermSet out;
+    collector.find_matching_terms(fts.trans(), ops, out);
+    benchmark::DoNotOptimize(out.size());
+  }
+  state.SetItemsProcessed(state.iterations() * num_vars);
+}
+BENCHMARK(BM_TermOpCollector)->Arg(64)->Arg(512)->Arg(4096);
@@ -0,0 +1,114 @@
+/*********************                                                        */
+/*! \file bench_core.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Micro-benchmarks of the transition system and the unrollers.
+**
+**/
+
+#include "benchmark/benchmark.h"
+#include "bench/micro/synthetic.h"
+#include "core/fts.h"
+#include "core/functional_unroller.h"
+#include "core/unroller.h"
+#include "smt/available_solvers.h"
+
+using namespace pono;
+using namespace pono_bench;
+using namespace smt;
+using namespace std;
+
+// Unroller::at_time of trans at a given depth, without the term caches
+// so that every iteration traverses trans (the timed variables are kept)
+static void BM_UnrollerAtTime(benchmark::State & state)
+{
+  size_t depth = state.range(0);
+  FunctionalTransitionSystem fts(create_solver(BTOR));
+  chain_system(fts, 256, 32);
+  Unroller unroller(fts);
+  unroller.set_term_cache_limit(0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(unroller.at_time(fts.trans(), depth));
+  }
+}
+BENCHMARK(BM_UnrollerAtTime)->Arg(1)->Arg(16)->Arg(256);
+
+// Unroller::at_time of trans at every time step up to a depth, with the
+// term caches as in BMC
+static void BM_UnrollerUnrollTo(benchmark::State & state)
+{
+  size_t depth = state.range(0);
+  FunctionalTransitionSystem fts(create_solver(BTOR));
+  chain_system(fts, 256, 32);
+  size_t run = 0;
+  for (auto _ : state) {
+    // a fresh time identifier, so that the timed variables are new too
+    Unroller unroller(fts, "@" + std::to_string(run++) + "_");
+    for (size_t k = 0; k < depth; ++k) {
+      benchmark::DoNotOptimize(unroller.at_time(fts.trans(), k));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * depth);
+}
+BENCHMARK(BM_UnrollerUnrollTo)->Arg(8)->Arg(32);
+
+// FunctionalUnroller::at_time of the property at a depth, substituting
+// the state updates
+static void BM_FunctionalUnroller(benchmark::State & state)
+{
+  size_t depth = state.range(0);
+  size_t interval = state.range(1);
+  FunctionalTransitionSystem fts(create_solver(BTOR));
+  Term prop = chain_system(fts, 64, 32);
+  size_t run = 0;
+  for (auto _ : state) {
+    FunctionalUnroller unroller(
+        fts, interval, "@" + std::to_string(run++) + "_");
+    benchmark::DoNotOptimize(unroller.at_time(prop, depth));
+  }
+}
+BENCHMARK(BM_FunctionalUnroller)
+    ->Args({ 8, 0 })
+    ->Args({ 32, 0 })
+    ->Args({ 32, 4 });
+
+// building a system: make_statevar and assign_next for every variable
+static void BM_AssignNext(benchmark::State & state)
+{
+  size_t num_vars = state.range(0);
+  for (auto _ : state) {
+    state.PauseTiming();
+    FunctionalTransitionSystem fts(create_solver(BTOR));
+    state.ResumeTiming();
+    benchmark::DoNotOptimize(chain_system(fts, num_vars, 32));
+  }
+  state.SetItemsProcessed(state.iterations() * num_vars);
+}
+BENCHMARK(BM_AssignNext)->Arg(64)->Arg(512)->Arg(4096);
+
+// TransitionSystem::replace_terms of all the inputs, on a copy of the
+// system (which shares the data until the replacement)
+static void BM_ReplaceTerms(benchmark::State & state)
+{
+  size_t num_vars = state.range(0);
+  FunctionalTransitionSystem fts(create_solver(BTOR));
+  chain_system(fts, num_vars, 32);
+  UnorderedTermMap to_replace;
+  TermVec inputs(fts.inputvars().begin(), fts.inputvars().end());
+  for (const auto & in : inputs) {
+    to_replace[in] = fts.make_inputvar(in->to_string() + "_r", in->get_sort());
+  }
+  for (auto _ : state) {
+    FunctionalTransitionSystem copy(fts);
+    copy.replace_terms(to_replace);
+    benchmark::DoNotOptimize(copy.trans());
+  }
+}
+BENCHMARK(BM_ReplaceTerms)->Arg(64)->Arg(512)->Arg(4096);
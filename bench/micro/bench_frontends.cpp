@@ -0,0 +1,76 @@
+/*********************                                                        */
+/*! \file bench_frontends.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Micro-benchmarks of parsing and witness printing.
+**
+**/
+
+#include <cstdio>
+
+#include "benchmark/benchmark.h"
+#include "bench/micro/synthetic.h"
+#include "core/fts.h"
+#include "frontends/btor2_encoder.h"
+#include "printers/vcd_witness_printer.h"
+#include "smt/available_solvers.h"
+
+using namespace pono;
+using namespace pono_bench;
+using namespace smt;
+using namespace std;
+
+// BTOR2Encoder parsing throughput, in lines per second
+static void BM_Btor2Parse(benchmark::State & state)
+{
+  size_t num_vars = state.range(0);
+  string filename =
+      temp_file("pono_micro_bench_" + std::to_string(num_vars) + ".btor2");
+  size_t lines = write_chain_btor2(filename, num_vars, 32);
+  for (auto _ : state) {
+    state.PauseTiming();
+    FunctionalTransitionSystem fts(create_solver(BTOR));
+    state.ResumeTiming();
+    BTOR2Encoder be(filename, fts);
+    benchmark::DoNotOptimize(be.propvec().size());
+  }
+  state.counters["lines"] = lines;
+  state.counters["lines/s"] =
+      benchmark::Counter(state.iterations() * lines, benchmark::Counter::kIsRate);
+  remove(filename.c_str());
+}
+BENCHMARK(BM_Btor2Parse)->Arg(64)->Arg(512)->Arg(4096);
+
+// VCDWitnessPrinter of a witness of a given length over all the variables
+static void BM_VcdPrint(benchmark::State & state)
+{
+  size_t length = state.range(0);
+  FunctionalTransitionSystem fts(create_solver(BTOR));
+  chain_system(fts, 256, 32);
+  vector<UnorderedTermMap> cex(length);
+  for (size_t k = 0; k < length; ++k) {
+    size_t v = k;
+    for (const auto & sv : fts.statevars()) {
+      cex[k][sv] = fts.make_term(v++ % 1024, sv->get_sort());
+    }
+    for (const auto & iv : fts.inputvars()) {
+      cex[k][iv] = fts.make_term(v++ % 1024, iv->get_sort());
+    }
+  }
+
+  string filename = temp_file("pono_micro_bench.vcd");
+  for (auto _ : state) {
+    VCDWitnessPrinter printer(fts, cex);
+    printer.dump_trace_to_file(filename);
+  }
+  state.SetItemsProcessed(state.iterations() * length);
+  remove(filename.c_str());
+}
+BENCHMARK(BM_VcdPrint)->Arg(16)->Arg(256);
@@ -0,0 +1,90 @@
+/*********************                                                        */
+/*! \file bench_ic3.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Micro-benchmarks of the IC3 queries.
+**
+**/
+
+#include "benchmark/benchmark.h"
+#include "bench/micro/synthetic.h"
+#include "core/fts.h"
+#include "engines/mbic3.h"
+#include "smt/available_solvers.h"
+
+using namespace pono;
+using namespace pono_bench;
+using namespace smt;
+using namespace std;
+
+/** Exposes the relative induction check of IC3 on the frames built by
+ *  a few bounds of check_until
+ */
+class RelIndBench : public ModelBasedIC3
+{
+ public:
+  RelIndBench(const Property & p,
+              const TransitionSystem & ts,
+              const SmtSolver & s,
+              int k)
+      : ModelBasedIC3(p, ts, s)
+  {
+    check_until(k);
+    // cubes assigning the first state variables, which are reachable
+    // in one step or not depending on the value
+    TermVec statevars(ts_.statevars().begin(), ts_.statevars().end());
+    for (int64_t v = 0; v < 8; ++v) {
+      TermVec lits;
+      for (size_t i = 0; i < 4 && i < statevars.size(); ++i) {
+        const Term & sv = statevars[i];
+        lits.push_back(solver_->make_term(
+            Equal, sv, solver_->make_term(v + i, sv->get_sort())));
+      }
+      cubes_.push_back(ic3formula_conjunction(lits));
+    }
+  }
+
+  size_t num_frames() const { return frames_.size(); }
+
+  /** Check the next cube relative to the frame before the frontier
+   *  @return true iff it is inductive relative to it
+   */
+  bool check(bool get_pred)
+  {
+    IC3Formula out;
+    const IC3Formula & c = cubes_[next_++ % cubes_.size()];
+    return rel_ind_check(frontier_idx(), c, out, get_pred);
+  }
+
+ protected:
+  vector<IC3Formula> cubes_;
+  size_t next_ = 0;
+};
+
+// rel_ind_check on fixed frames, with and without a predecessor
+static void BM_RelIndCheck(benchmark::State & state)
+{
+  size_t num_vars = state.range(0);
+  bool get_pred = state.range(1);
+  SmtSolver s = create_solver_for(BTOR, MBIC3, false);
+  FunctionalTransitionSystem fts(s);
+  Term prop = chain_system(fts, num_vars, 8);
+  Property p(s, prop);
+  RelIndBench ic3(p, fts, s, 2);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ic3.check(get_pred));
+  }
+  state.counters["frames"] = ic3.num_frames();
+}
+BENCHMARK(BM_RelIndCheck)
+    ->Args({ 16, 0 })
+    ->Args({ 16, 1 })
+    ->Args({ 64, 0 })
+    ->Args({ 64, 1 });
@@ -0,0 +1,147 @@
+/*********************                                                        */
+/*! \file synthetic.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Synthetic transition systems of a given size for the
+**        micro-benchmarks, built in memory or written as BTOR2.
+**
+**/
+
+#include "bench/micro/synthetic.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include "utils/exceptions.h"
+
+using namespace pono;
+using namespace smt;
+using namespace std;
+
+namespace pono_bench {
+
+/** @return the number of inputs of a chain */
+static size_t num_chain_inputs(size_t num_vars) { return num_vars / 4 + 1; }
+
+Term chain_system(TransitionSystem & ts, size_t num_vars, size_t width)
+{
+  if (!num_vars) {
+    throw PonoException("A chain needs at least one state variable");
+  }
+
+  Sort sort = ts.make_sort(BV, width);
+  Term zero = ts.make_term(0, sort);
+  Term one = ts.make_term(1, sort);
+
+  TermVec inputs;
+  for (size_t j = 0; j < num_chain_inputs(num_vars); ++j) {
+    inputs.push_back(ts.make_inputvar("in" + std::to_string(j), sort));
+  }
+
+  TermVec states;
+  for (size_t i = 0; i < num_vars; ++i) {
+    states.push_back(ts.make_statevar("s" + std::to_string(i), sort));
+    ts.constrain_init(ts.make_term(Equal, states.back(), zero));
+  }
+
+  for (size_t i = 0; i < num_vars; ++i) {
+    const Term & s = states[i];
+    const Term & prev = states[i ? i - 1 : 0];
+    const Term & in = inputs[i % inputs.size()];
+    Term mixed;
+    if (i % 3 == 0) {
+      mixed = ts.make_term(BVAdd, s, prev);
+    } else if (i % 3 == 1) {
+      mixed = ts.make_term(BVXor, s, in);
+    } else {
+      mixed = ts.make_term(BVMul, prev, in);
+    }
+    ts.assign_next(s,
+                   ts.make_term(Ite,
+                                ts.make_term(BVUlt, in, s),
+                                mixed,
+                                ts.make_term(BVAdd, s, one)));
+  }
+
+  Term ones = ts.make_term(BVNot, zero);
+  return ts.make_term(Distinct, states[num_vars / 2], ones);
+}
+
+size_t write_chain_btor2(const string & filename,
+                         size_t num_vars,
+                         size_t width)
+{
+  if (!num_vars) {
+    throw PonoException("A chain needs at least one state variable");
+  }
+
+  ofstream out(filename);
+  if (!out.is_open()) {
+    throw PonoException("Could not open " + filename);
+  }
+
+  // node ids of the same structure as chain_system
+  size_t nid = 0;
+  size_t lines = 0;
+  auto line = [&](const string & s) {
+    out << ++nid << " " << s << "\n";
+    ++lines;
+    return nid;
+  };
+  auto id = [](size_t n) { return std::to_string(n); };
+
+  size_t sort = line("sort bitvec " + id(width));
+  size_t bool_sort = line("sort bitvec 1");
+  size_t zero = line("zero " + id(sort));
+  size_t one = line("one " + id(sort));
+
+  vector<size_t> inputs;
+  for (size_t j = 0; j < num_chain_inputs(num_vars); ++j) {
+    inputs.push_back(line("input " + id(sort) + " in" + id(j)));
+  }
+
+  vector<size_t> states;
+  for (size_t i = 0; i < num_vars; ++i) {
+    states.push_back(line("state " + id(sort) + " s" + id(i)));
+    line("init " + id(sort) + " " + id(states.back()) + " " + id(zero));
+  }
+
+  for (size_t i = 0; i < num_vars; ++i) {
+    string s = id(states[i]);
+    string prev = id(states[i ? i - 1 : 0]);
+    string in = id(inputs[i % inputs.size()]);
+    size_t mixed;
+    if (i % 3 == 0) {
+      mixed = line("add " + id(sort) + " " + s + " " + prev);
+    } else if (i % 3 == 1) {
+      mixed = line("xor " + id(sort) + " " + s + " " + in);
+    } else {
+      mixed = line("mul " + id(sort) + " " + prev + " " + in);
+    }
+    size_t lt = line("ult " + id(bool_sort) + " " + in + " " + s);
+    size_t inc = line("add " + id(sort) + " " + s + " " + id(one));
+    size_t ite = line("ite " + id(sort) + " " + id(lt) + " " + id(mixed) + " "
+                      + id(inc));
+    line("next " + id(sort) + " " + s + " " + id(ite));
+  }
+
+  size_t ones = line("ones " + id(sort));
+  size_t bad = line("eq " + id(bool_sort) + " " + id(states[num_vars / 2])
+                    + " " + id(ones));
+  line("bad " + id(bad));
+  return lines;
+}
+
+string temp_file(const string & name)
+{
+  return (filesystem::temp_directory_path() / name).string();
+}
+
+}  // namespace pono_bench
@@ -0,0 +1,51 @@
+/*********************                                                        */
+/*! \file synthetic.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Synthetic transition systems of a given size for the
+**        micro-benchmarks, built in memory or written as BTOR2.
+**
+**/
+
+#pragma once
+
+#include <string>
+
+#include "core/ts.h"
+#include "smt-switch/smt.h"
+
+namespace pono_bench {
+
+/** Build a functional chain of bit-vector state variables s0, s1, ...
+ *  Each state variable is updated from itself, its predecessor in the
+ *  chain and an input, with a mix of additions, xors, multiplications and
+ *  comparisons. All the state variables start at zero. The property is
+ *  over the state variable in the middle of the chain, so the second half
+ *  of the chain is outside its cone of influence.
+ *  @param ts the (empty) functional transition system to build in
+ *  @param num_vars the number of state variables
+ *  @param width the width of the state variables and inputs
+ *  @return the property
+ */
+smt::Term chain_system(pono::TransitionSystem & ts,
+                       size_t num_vars,
+                       size_t width);
+
+/** Write the system of chain_system as a BTOR2 file
+ *  @return the number of lines written
+ */
+size_t write_chain_btor2(const std::string & filename,
+                         size_t num_vars,
+                         size_t width);
+
+/** @return a file name in the temporary directory */
+std::string temp_file(const std::string & name);
+
+}  // namespace pono_bench
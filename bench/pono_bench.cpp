@@ -0,0 +1,535 @@
+/*********************                                                        */
+/*! \file pono_bench.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Benchmark harness that runs a matrix of engines and solvers over
+**        a set of files and reports wall time, peak memory, solver calls
+**        and results as CSV or JSON. Optionally compares the results
+**        against a stored baseline and fails on regressions.
+**
+**        Every run is a separate process, so that a crash does not stop
+**        the harness and the peak resident memory is that of the run.
+**
+**        With --scaling, it runs the parallel features instead at each
+**        number of threads of --threads, and reports the speedup,
+**        efficiency, lock contention and solver busy fraction.
+**
+**/
+
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "optionparser.h"
+#include "options/option_args.h"
+#include "options/options.h"
+#include "utils/benchmark.h"
+#include "utils/exceptions.h"
+
+using namespace pono;
+using namespace smt;
+using namespace std;
+
+enum benchOptionIndex
+{
+  UNKNOWN_OPTION,
+  HELP,
+  ENGINES,
+  SOLVERS,
+  BOUND,
+  WARMUP,
+  REPS,
+  TIMEOUT,
+  CSV,
+  JSON,
+  BASELINE,
+  THRESHOLD,
+  SCALING,
+  THREADS,
+  SCALING_CSV
+};
+
+const option::Descriptor usage[] = {
+  { UNKNOWN_OPTION,
+    0,
+    "",
+    "",
+    Arg::None,
+    "USAGE: pono-bench [options] [files or directories]\n\n"
+    "Runs every engine with every solver on every btor2, smv and vmt file "
+    "(default: samples and tests/encoders/inputs).\n\nOptions:" },
+  { HELP, 0, "", "help", Arg::None, "  --help \tPrint usage and exit." },
+  { ENGINES,
+    0,
+    "",
+    "engines",
+    Arg::NonEmpty,
+    "  --engines <e1,e2,...> \tEngines to run (default: bmc,ind,mbic3)." },
+  { SOLVERS,
+    0,
+    "",
+    "solvers",
+    Arg::NonEmpty,
+    "  --solvers <s1,s2,...> \tSolvers to run from [btor, cvc4, msat] "
+    "(default: btor)." },
+  { BOUND,
+    0,
+    "k",
+    "bound",
+    Arg::Numeric,
+    "  --bound, -k \tBound to check up to (default: 10)." },
+  { WARMUP,
+    0,
+    "",
+    "warmup",
+    Arg::Numeric,
+    "  --warmup \tNumber of discarded runs per configuration (default: 1)." },
+  { REPS,
+    0,
+    "",
+    "reps",
+    Arg::Numeric,
+    "  --reps \tNumber of measured runs per configuration (default: 3)." },
+  { TIMEOUT,
+    0,
+    "",
+    "timeout",
+    Arg::Numeric,
+    "  --timeout \tTime limit per run in seconds, the run is killed after "
+    "twice this time (default: 60)." },
+  { CSV,
+    0,
+    "",
+    "csv",
+    Arg::NonEmpty,
+    "  --csv <file> \tWrite the results as CSV (default: stdout)." },
+  { JSON,
+    0,
+    "",
+    "json",
+    Arg::NonEmpty,
+    "  --json <file> \tAlso write the results as JSON." },
+  { BASELINE,
+    0,
+    "",
+    "baseline",
+    Arg::NonEmpty,
+    "  --baseline <file> \tCompare against results in CSV from a previous "
+    "run, exits with 1 on a regression." },
+  { THRESHOLD,
+    0,
+    "",
+    "threshold",
+    Arg::Numeric,
+    "  --threshold \tSlowdown in percent reported as a regression when "
+    "statistically significant (default: 10)." },
+  { SCALING,
+    0,
+    "",
+    "scaling",
+    Arg::NonEmpty,
+    "  --scaling <f1,f2,...> \tMeasure how parallel features scale instead "
+    "of running the engines, from [bmc-par, ic3-prop, ic3-block, portfolio] "
+    "(use the designs of pono-bench-gen)." },
+  { THREADS,
+    0,
+    "",
+    "threads",
+    Arg::NonEmpty,
+    "  --threads <n1,n2,...> \tThread counts for --scaling "
+    "(default: 1,2,4,8,16,32)." },
+  { SCALING_CSV,
+    0,
+    "",
+    "scaling-csv",
+    Arg::NonEmpty,
+    "  --scaling-csv <file> \tWrite the speedup, efficiency, lock wait time "
+    "and solver busy fraction per thread count as CSV (default: stderr)." },
+  { 0, 0, 0, 0, 0, 0 }
+};
+
+static vector<string> split(const string & s, char sep)
+{
+  vector<string> res;
+  stringstream ss(s);
+  string elem;
+  while (getline(ss, elem, sep)) {
+    if (!elem.empty()) {
+      res.push_back(elem);
+    }
+  }
+  return res;
+}
+
+static SolverEnum to_solver_enum(const string & s)
+{
+  if (s == "btor") {
+    return BTOR;
+  } else if (s == "cvc4") {
+    return CVC4;
+  } else if (s == "msat") {
+    return MSAT;
+  }
+  throw PonoException("Unknown solver: " + s);
+}
+
+static vector<string> collect_files(const vector<string> & paths)
+{
+  vector<string> files;
+  for (const auto & p : paths) {
+    if (filesystem::is_directory(p)) {
+      for (const auto & entry : filesystem::recursive_directory_iterator(p)) {
+        string f = entry.path().string();
+        if (entry.is_regular_file() && is_benchmark_file(f)) {
+          files.push_back(f);
+        }
+      }
+    } else if (filesystem::exists(p)) {
+      files.push_back(p);
+    } else {
+      throw PonoException("No such file or directory: " + p);
+    }
+  }
+  // directory iteration order is unspecified
+  sort(files.begin(), files.end());
+  return files;
+}
+
+/** A parallel feature measured by --scaling */
+struct ScalingFeature
+{
+  string name;
+  Engine engine;
+  /** set the number of threads of the feature in the options */
+  void (*set_threads)(PonoOptions & opts, unsigned int n);
+};
+
+static void set_bmc_threads(PonoOptions & opts, unsigned int n)
+{
+  opts.bmc_threads_ = n;
+}
+
+static void set_ic3_prop_threads(PonoOptions & opts, unsigned int n)
+{
+  opts.ic3_prop_threads_ = n;
+}
+
+static void set_ic3_block_threads(PonoOptions & opts, unsigned int n)
+{
+  opts.ic3_block_threads_ = n;
+}
+
+static void set_portfolio_cores(PonoOptions & opts, unsigned int n)
+{
+  opts.portfolio_ = true;
+  opts.portfolio_cores_ = n;
+}
+
+// the engine of the portfolio is only used to create the solver of the
+// transition system
+static const vector<ScalingFeature> scaling_features(
+    { { "bmc-par", BMC_PAR, set_bmc_threads },
+      { "ic3-prop", MBIC3, set_ic3_prop_threads },
+      { "ic3-block", MBIC3, set_ic3_block_threads },
+      { "portfolio", BMC, set_portfolio_cores } });
+
+static const ScalingFeature & to_scaling_feature(const string & s)
+{
+  for (const auto & f : scaling_features) {
+    if (f.name == s) {
+      return f;
+    }
+  }
+  throw PonoException("Unknown parallel feature: " + s);
+}
+
+/** Run a benchmark in a child process
+ *  The child writes its record as a CSV line to a pipe. If it crashes or
+ *  times out the result is ERROR or UNKNOWN respectively.
+ */
+static BenchRecord run_in_child(const string & file,
+                                Engine e,
+                                SolverEnum se,
+                                const PonoOptions & opts,
+                                unsigned int timeout)
+{
+  BenchRecord rec;
+  rec.file = file;
+  rec.engine = to_string(e);
+  rec.solver = smt::to_string(se);
+  rec.result = ProverResult::ERROR;
+
+  int fds[2];
+  if (pipe(fds)) {
+    throw PonoException("Failed to create a pipe");
+  }
+
+  pid_t pid = fork();
+  if (pid < 0) {
+    throw PonoException("Failed to fork");
+  } else if (pid == 0) {
+    close(fds[0]);
+    // the engines stop themselves after timeout, this is a backup
+    alarm(2 * timeout);
+    int status = 0;
+    try {
+      BenchRecord r = run_benchmark(file, e, se, opts);
+      ostringstream out;
+      write_bench_csv(out, { r }, false);
+      string line = out.str();
+      if (write(fds[1], line.c_str(), line.size()) < 0) {
+        status = 1;
+      }
+    }
+    catch (std::exception & ex) {
+      cerr << file << " (" << rec.engine << ", " << rec.solver
+           << "): " << ex.what() << endl;
+      status = 1;
+    }
+    close(fds[1]);
+    _exit(status);
+  }
+
+  close(fds[1]);
+  string line;
+  char buf[256];
+  ssize_t n;
+  while ((n = read(fds[0], buf, sizeof(buf))) > 0) {
+    line.append(buf, n);
+  }
+  close(fds[0]);
+
+  int status;
+  struct rusage usage;
+  if (wait4(pid, &status, 0, &usage) < 0) {
+    throw PonoException("Failed to wait for benchmark process");
+  }
+
+  if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+    istringstream in(line);
+    vector<BenchRecord> records = read_bench_csv(in);
+    if (records.size() == 1) {
+      rec = records[0];
+    }
+  } else if (WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM) {
+    rec.result = ProverResult::UNKNOWN;
+    rec.wall_time = 2 * timeout;
+  }
+  // ru_maxrss is in kilobytes on Linux
+  rec.peak_rss_kb = usage.ru_maxrss;
+  return rec;
+}
+
+int main(int argc, char ** argv)
+{
+  argc -= (argc > 0);
+  argv += (argc > 0);  // skip program name argv[0] if present
+  option::Stats stats(usage, argc, argv);
+  std::vector<option::Option> options(stats.options_max);
+  std::vector<option::Option> buffer(stats.buffer_max);
+  option::Parser parse(usage, argc, argv, &options[0], &buffer[0]);
+
+  if (parse.error()) {
+    return 2;
+  }
+  if (options[HELP] || options[UNKNOWN_OPTION]) {
+    option::printUsage(cout, usage);
+    return options[HELP] ? 0 : 2;
+  }
+
+  vector<Engine> engines = { BMC, KIND, MBIC3 };
+  vector<SolverEnum> solvers = { BTOR };
+  unsigned int warmup = 1;
+  unsigned int reps = 3;
+  unsigned int timeout = 60;
+  double threshold = 0.1;
+  string csv_file;
+  string json_file;
+  string baseline_file;
+  vector<ScalingFeature> features;
+  vector<unsigned int> thread_counts = { 1, 2, 4, 8, 16, 32 };
+  string scaling_csv_file;
+  PonoOptions opts;
+  opts.bound_ = 10;
+
+  vector<string> files;
+  try {
+    for (int i = 0; i < parse.optionsCount(); ++i) {
+      option::Option & opt = buffer[i];
+      switch (opt.index()) {
+        case ENGINES: {
+          engines.clear();
+          for (const auto & e : split(opt.arg, ',')) {
+            engines.push_back(opts.to_engine(e));
+          }
+          break;
+        }
+        case SOLVERS: {
+          solvers.clear();
+          for (const auto & s : split(opt.arg, ',')) {
+            solvers.push_back(to_solver_enum(s));
+          }
+          break;
+        }
+        case BOUND: opts.bound_ = atoi(opt.arg); break;
+        case WARMUP: warmup = atoi(opt.arg); break;
+        case REPS: reps = atoi(opt.arg); break;
+        case TIMEOUT: timeout = atoi(opt.arg); break;
+        case CSV: csv_file = opt.arg; break;
+        case JSON: json_file = opt.arg; break;
+        case BASELINE: baseline_file = opt.arg; break;
+        case THRESHOLD: threshold = atoi(opt.arg) / 100.0; break;
+        case SCALING: {
+          for (const auto & f : split(opt.arg, ',')) {
+            features.push_back(to_scaling_feature(f));
+          }
+          break;
+        }
+        case THREADS: {
+          thread_counts.clear();
+          for (const auto & n : split(opt.arg, ',')) {
+            if (!atoi(n.c_str())) {
+              throw PonoException("--threads must be positive numbers");
+            }
+            thread_counts.push_back(atoi(n.c_str()));
+          }
+          break;
+        }
+        case SCALING_CSV: scaling_csv_file = opt.arg; break;
+        default: break;
+      }
+    }
+
+    if (!reps) {
+      throw PonoException("--reps must be at least 1");
+    }
+    if (!timeout) {
+      throw PonoException("--timeout must be at least 1");
+    }
+    opts.time_limit_ = timeout;
+
+    vector<string> paths;
+    for (int i = 0; i < parse.nonOptionsCount(); ++i) {
+      paths.push_back(parse.nonOption(i));
+    }
+    if (!paths.size()) {
+      paths = { "samples", "tests/encoders/inputs" };
+    }
+    files = collect_files(paths);
+  }
+  catch (PonoException & ex) {
+    cerr << ex.what() << endl;
+    return 2;
+  }
+
+  vector<BenchRecord> records;
+  for (const auto & f : files) {
+    for (const auto & se : solvers) {
+      for (const auto & feature : features) {
+        for (const auto & n : thread_counts) {
+          PonoOptions fopts = opts;
+          feature.set_threads(fopts, n);
+          for (unsigned int i = 0; i < warmup; ++i) {
+            run_in_child(f, feature.engine, se, fopts, timeout);
+          }
+          for (unsigned int i = 0; i < reps; ++i) {
+            BenchRecord r = run_in_child(f, feature.engine, se, fopts, timeout);
+            r.engine = feature.name;
+            r.threads = n;
+            r.rep = i;
+            records.push_back(r);
+            cerr << f << " " << r.engine << " x" << n << " " << r.solver
+                 << " #" << i << ": " << to_string(r.result) << " in "
+                 << r.wall_time << "s" << endl;
+          }
+        }
+      }
+      if (features.size()) {
+        // --scaling replaces the engines
+        continue;
+      }
+      for (const auto & e : engines) {
+        for (unsigned int i = 0; i < warmup; ++i) {
+          run_in_child(f, e, se, opts, timeout);
+        }
+        for (unsigned int i = 0; i < reps; ++i) {
+          BenchRecord r = run_in_child(f, e, se, opts, timeout);
+          r.rep = i;
+          records.push_back(r);
+          cerr << f << " " << r.engine << " " << r.solver << " #" << i << ": "
+               << to_string(r.result) << " in " << r.wall_time << "s" << endl;
+        }
+      }
+    }
+  }
+
+  if (csv_file.empty()) {
+    write_bench_csv(cout, records);
+  } else {
+    ofstream out(csv_file);
+    write_bench_csv(out, records);
+  }
+
+  if (!json_file.empty()) {
+    ofstream out(json_file);
+    out << bench_to_json(records);
+  }
+
+  if (features.size()) {
+    vector<ScalingPoint> points = scaling_summary(records);
+    if (scaling_csv_file.empty()) {
+      write_scaling_csv(cerr, points);
+    } else {
+      ofstream out(scaling_csv_file);
+      write_scaling_csv(out, points);
+    }
+  }
+
+  if (baseline_file.empty()) {
+    return 0;
+  }
+
+  ifstream in(baseline_file);
+  if (!in.is_open()) {
+    cerr << "Could not open baseline " << baseline_file << endl;
+    return 2;
+  }
+  vector<BenchRegression> regressions;
+  try {
+    regressions = compare_benchmarks(read_bench_csv(in), records, threshold);
+  }
+  catch (PonoException & ex) {
+    cerr << ex.what() << endl;
+    return 2;
+  }
+
+  for (const auto & reg : regressions) {
+    cerr << "REGRESSION " << reg.file << " (" << reg.engine << ", "
+         << reg.solver;
+    if (reg.threads > 1) {
+      cerr << ", " << reg.threads << " threads";
+    }
+    cerr << "): " << reg.reason << endl;
+  }
+  if (regressions.size()) {
+    return 1;
+  }
+  cerr << "No regressions against " << baseline_file << endl;
+  return 0;
+}
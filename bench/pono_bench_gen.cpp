@@ -0,0 +1,380 @@
+/*********************                                                        */
+/*! \file pono_bench_gen.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Generator of BTOR2 benchmark families of a given size, built with
+**        the TS API, for scaling curves with pono-bench.
+**
+**        Each design gets a file with a true property and a file with a
+**        false property whose shortest counterexample has a known length,
+**        and index.csv lists the files with their expected results.
+**
+**/
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "core/fts.h"
+#include "optionparser.h"
+#include "options/option_args.h"
+#include "printers/btor2_printer.h"
+#include "smt/available_solvers.h"
+#include "utils/exceptions.h"
+
+using namespace pono;
+using namespace smt;
+using namespace std;
+
+enum genOptionIndex
+{
+  UNKNOWN_OPTION,
+  HELP,
+  FAMILIES,
+  SIZES,
+  DEPTH,
+  OUT
+};
+
+const option::Descriptor usage[] = {
+  { UNKNOWN_OPTION,
+    0,
+    "",
+    "",
+    Arg::None,
+    "USAGE: pono-bench-gen [options]\n\n"
+    "Writes BTOR2 designs of the given sizes, one file with a true and one "
+    "with a false property per design, and index.csv with the expected "
+    "results.\n\n"
+    "Families (the size is):\n"
+    "  counter   the width of a counter that resets at --depth\n"
+    "  fifo      the depth of a FIFO of bytes\n"
+    "  memory    the number of words of a memory written in order\n"
+    "  pipeline  the number of stages of a pipeline\n\nOptions:" },
+  { HELP, 0, "", "help", Arg::None, "  --help \tPrint usage and exit." },
+  { FAMILIES,
+    0,
+    "",
+    "families",
+    Arg::NonEmpty,
+    "  --families <f1,f2,...> \tFamilies to generate "
+    "(default: counter,fifo,memory,pipeline)." },
+  { SIZES,
+    0,
+    "",
+    "sizes",
+    Arg::NonEmpty,
+    "  --sizes <n1,n2,...> \tSizes to generate (default: 4,8,16,32,64)." },
+  { DEPTH,
+    0,
+    "",
+    "depth",
+    Arg::Numeric,
+    "  --depth \tLength of the counterexample of the counters (default: "
+    "10)." },
+  { OUT,
+    0,
+    "o",
+    "out",
+    Arg::NonEmpty,
+    "  --out, -o <dir> \tDirectory to write to (default: scaling)." },
+  { 0, 0, 0, 0, 0, 0 }
+};
+
+/** A generated design with its two properties */
+struct Design
+{
+  Term true_prop;
+  Term false_prop;
+  size_t cex_length;  ///< length of the shortest counterexample of false_prop
+};
+
+static vector<string> split(const string & s, char sep)
+{
+  vector<string> res;
+  stringstream ss(s);
+  string elem;
+  while (getline(ss, elem, sep)) {
+    if (!elem.empty()) {
+      res.push_back(elem);
+    }
+  }
+  return res;
+}
+
+/** @return the number of bits needed for the values 0 to n */
+static size_t bits_for(size_t n)
+{
+  size_t w = 1;
+  while (w < 64 && (n >> w)) {
+    ++w;
+  }
+  return w;
+}
+
+/** A width-bit counter that counts up to depth and then resets
+ *  true: x <= depth, false: x != depth
+ */
+static Design counter(TransitionSystem & ts, size_t width, size_t depth)
+{
+  if (width < 64 && depth >> width) {
+    throw PonoException("A " + std::to_string(width)
+                        + "-bit counter can't count to "
+                        + std::to_string(depth));
+  }
+  Sort sort = ts.make_sort(BV, width);
+  Term x = ts.make_statevar("x", sort);
+  Term zero = ts.make_term(0, sort);
+  Term max = ts.make_term(depth, sort);
+  ts.constrain_init(ts.make_term(Equal, x, zero));
+  ts.assign_next(
+      x,
+      ts.make_term(Ite,
+                   ts.make_term(BVUlt, x, max),
+                   ts.make_term(BVAdd, x, ts.make_term(1, sort)),
+                   zero));
+  return { ts.make_term(BVUle, x, max),
+           ts.make_term(Distinct, x, max),
+           depth };
+}
+
+/** A FIFO of depth entries of bytes in registers, pushing has priority
+ *  true: count <= depth, false: the FIFO is never full
+ */
+static Design fifo(TransitionSystem & ts, size_t depth)
+{
+  Sort data_sort = ts.make_sort(BV, 8);
+  Sort count_sort = ts.make_sort(BV, bits_for(depth));
+  Term push = ts.make_inputvar("push", ts.make_sort(BOOL));
+  Term pop = ts.make_inputvar("pop", ts.make_sort(BOOL));
+  Term din = ts.make_inputvar("din", data_sort);
+  Term count = ts.make_statevar("count", count_sort);
+  Term zero = ts.make_term(0, count_sort);
+  Term one = ts.make_term(1, count_sort);
+  Term full_count = ts.make_term(depth, count_sort);
+
+  Term do_push = ts.make_term(
+      And, push, ts.make_term(BVUlt, count, full_count));
+  Term do_pop = ts.make_term(And,
+                             ts.make_term(Not, do_push),
+                             ts.make_term(And,
+                                          pop,
+                                          ts.make_term(BVUgt, count, zero)));
+
+  TermVec entries;
+  for (size_t i = 0; i < depth; ++i) {
+    entries.push_back(
+        ts.make_statevar("entry" + std::to_string(i), data_sort));
+    ts.constrain_init(
+        ts.make_term(Equal, entries.back(), ts.make_term(0, data_sort)));
+  }
+  for (size_t i = 0; i < depth; ++i) {
+    // written at the tail, shifted towards the head when popping
+    Term written = ts.make_term(
+        Ite,
+        ts.make_term(Equal, count, ts.make_term(i, count_sort)),
+        din,
+        entries[i]);
+    Term shifted = i + 1 < depth ? entries[i + 1] : entries[i];
+    ts.assign_next(
+        entries[i],
+        ts.make_term(Ite,
+                     do_push,
+                     written,
+                     ts.make_term(Ite, do_pop, shifted, entries[i])));
+  }
+
+  ts.constrain_init(ts.make_term(Equal, count, zero));
+  ts.assign_next(
+      count,
+      ts.make_term(Ite,
+                   do_push,
+                   ts.make_term(BVAdd, count, one),
+                   ts.make_term(Ite,
+                                do_pop,
+                                ts.make_term(BVSub, count, one),
+                                count)));
+  return { ts.make_term(BVUle, count, full_count),
+           ts.make_term(Distinct, count, full_count),
+           depth };
+}
+
+/** A memory of size words written in order from address 0, with a
+ *  register shadowing address 0
+ *  true: mem[0] = shadow, false: the last word stays 0
+ */
+static Design memory(TransitionSystem & ts, size_t size)
+{
+  if (size < 2) {
+    throw PonoException("A memory needs at least two words");
+  }
+  Sort addr_sort = ts.make_sort(BV, bits_for(size - 1));
+  Sort data_sort = ts.make_sort(BV, 8);
+  Sort mem_sort = ts.make_sort(ARRAY, addr_sort, data_sort);
+  Term din = ts.make_inputvar("din", data_sort);
+  Term mem = ts.make_statevar("mem", mem_sort);
+  Term ptr = ts.make_statevar("ptr", addr_sort);
+  Term shadow = ts.make_statevar("shadow", data_sort);
+  Term addr_zero = ts.make_term(0, addr_sort);
+  Term data_zero = ts.make_term(0, data_sort);
+  Term last = ts.make_term(size - 1, addr_sort);
+
+  ts.constrain_init(ts.make_term(Equal, mem, ts.make_term(data_zero, mem_sort)));
+  ts.constrain_init(ts.make_term(Equal, ptr, addr_zero));
+  ts.constrain_init(ts.make_term(Equal, shadow, data_zero));
+
+  ts.assign_next(mem, ts.make_term(Store, mem, ptr, din));
+  ts.assign_next(ptr,
+                 ts.make_term(Ite,
+                              ts.make_term(Equal, ptr, last),
+                              addr_zero,
+                              ts.make_term(BVAdd,
+                                           ptr,
+                                           ts.make_term(1, addr_sort))));
+  ts.assign_next(
+      shadow,
+      ts.make_term(Ite, ts.make_term(Equal, ptr, addr_zero), din, shadow));
+
+  return { ts.make_term(
+               Equal, ts.make_term(Select, mem, addr_zero), shadow),
+           ts.make_term(Equal, ts.make_term(Select, mem, last), data_zero),
+           size };
+}
+
+/** A pipeline of stages that each add one to the data of the previous
+ *  stage, with a valid bit per stage that starts false
+ *  true: a valid stage follows a valid stage, false: the last stage
+ *  never gets valid
+ */
+static Design pipeline(TransitionSystem & ts, size_t stages)
+{
+  if (stages < 2) {
+    throw PonoException("A pipeline needs at least two stages");
+  }
+  Sort data_sort = ts.make_sort(BV, 8);
+  Sort bool_sort = ts.make_sort(BOOL);
+  Term in = ts.make_inputvar("in", data_sort);
+  Term one = ts.make_term(1, data_sort);
+  Term f = ts.make_term(false);
+
+  TermVec data, valid;
+  for (size_t i = 0; i < stages; ++i) {
+    data.push_back(ts.make_statevar("data" + std::to_string(i), data_sort));
+    valid.push_back(ts.make_statevar("valid" + std::to_string(i), bool_sort));
+    ts.constrain_init(
+        ts.make_term(Equal, data.back(), ts.make_term(0, data_sort)));
+    ts.constrain_init(ts.make_term(Equal, valid.back(), f));
+  }
+  ts.assign_next(data[0], in);
+  ts.assign_next(valid[0], ts.make_term(true));
+  for (size_t i = 1; i < stages; ++i) {
+    ts.assign_next(data[i], ts.make_term(BVAdd, data[i - 1], one));
+    ts.assign_next(valid[i], valid[i - 1]);
+  }
+
+  return { ts.make_term(
+               Implies, valid[stages - 1], valid[stages - 2]),
+           ts.make_term(Not, valid[stages - 1]),
+           stages };
+}
+
+static Design generate(const string & family,
+                       TransitionSystem & ts,
+                       size_t size,
+                       size_t depth)
+{
+  if (family == "counter") {
+    return counter(ts, size, depth);
+  } else if (family == "fifo") {
+    return fifo(ts, size);
+  } else if (family == "memory") {
+    return memory(ts, size);
+  } else if (family == "pipeline") {
+    return pipeline(ts, size);
+  }
+  throw PonoException("Unknown family: " + family);
+}
+
+int main(int argc, char ** argv)
+{
+  argc -= (argc > 0);
+  argv += (argc > 0);  // skip program name argv[0] if present
+  option::Stats stats(usage, argc, argv);
+  std::vector<option::Option> options(stats.options_max);
+  std::vector<option::Option> buffer(stats.buffer_max);
+  option::Parser parse(usage, argc, argv, &options[0], &buffer[0]);
+
+  if (parse.error()) {
+    return 2;
+  }
+  if (options[HELP] || options[UNKNOWN_OPTION] || parse.nonOptionsCount()) {
+    option::printUsage(cout, usage);
+    return options[HELP] ? 0 : 2;
+  }
+
+  vector<string> families = { "counter", "fifo", "memory", "pipeline" };
+  vector<size_t> sizes = { 4, 8, 16, 32, 64 };
+  size_t depth = 10;
+  string out_dir = "scaling";
+
+  try {
+    for (int i = 0; i < parse.optionsCount(); ++i) {
+      option::Option & opt = buffer[i];
+      switch (opt.index()) {
+        case FAMILIES: families = split(opt.arg, ','); break;
+        case SIZES: {
+          sizes.clear();
+          for (const auto & s : split(opt.arg, ',')) {
+            sizes.push_back(stoul(s));
+          }
+          break;
+        }
+        case DEPTH: depth = atoi(opt.arg); break;
+        case OUT: out_dir = opt.arg; break;
+        default: break;
+      }
+    }
+
+    filesystem::create_directories(out_dir);
+    ofstream index(out_dir + "/index.csv");
+    if (!index.is_open()) {
+      throw PonoException("Could not write " + out_dir + "/index.csv");
+    }
+    index << "file,family,size,expected,cex_length\n";
+
+    for (const auto & family : families) {
+      for (auto size : sizes) {
+        FunctionalTransitionSystem fts(create_solver(BTOR));
+        Design d = generate(family, fts, size, depth);
+        string base = family + "_" + std::to_string(size);
+
+        string true_file = base + "_true.btor2";
+        write_btor2_file(out_dir + "/" + true_file, fts, { d.true_prop });
+        index << true_file << "," << family << "," << size << ",unsat,\n";
+
+        string false_file = base + "_false.btor2";
+        write_btor2_file(out_dir + "/" + false_file, fts, { d.false_prop });
+        index << false_file << "," << family << "," << size << ",sat,"
+              << d.cex_length << "\n";
+
+        cerr << "wrote " << out_dir << "/" << base << "_{true,false}.btor2"
+             << endl;
+      }
+    }
+  }
+  catch (std::exception & ex) {
+    cerr << ex.what() << endl;
+    return 2;
+  }
+  return 0;
+}
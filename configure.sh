@@ -17,12 +17,15 @@ Configures the CMAKE build environment.
                         Required for interpolant based model checking
 --with-msat-ic3ia       build with the open-source IC3IA implementation as a backend. (default: off)
 --with-coreir           build the CoreIR frontend (default: off)
+--with-cudd             build the BDD engine with CUDD (default: off)
 --with-coreir-extern    build the CoreIR frontend using an installation of coreir in /usr/local/lib (default: off)
 --debug                 build debug with debug symbols (default: off)
 --python                compile with python bindings (default: off)
 --static-lib            build a static library (default: shared)
 --static                build a static executable (default: dynamic); implies --static-lib
 --with-profiling        build with gperftools for profiling (default: off)
+--log-max-level=N       compile out log messages above verbosity N (default: none)
+--micro-bench           build the google benchmark micro-benchmarks (default: off)
 EOF
   exit 0
 }
@@ -39,11 +42,14 @@ with_msat=default
 with_msat_ic3ia=default
 with_coreir=default
 with_coreir_extern=default
+with_cudd=default
 debug=default
 python=default
 lib_type=SHARED
 static_exec=NO
 with_profiling=default
+log_max_level=default
+micro_bench=default
 
 buildtype=Release
 
@@ -75,6 +81,7 @@ do
         --with-msat-ic3ia) with_msat_ic3ia=ON;;
         --with-coreir) with_coreir=ON;;
         --with-coreir-extern) with_coreir_extern=ON;;
+        --with-cudd) with_cudd=ON;;
         --debug)
             debug=yes;
             buildtype=Debug
@@ -90,6 +97,9 @@ do
             lib_type=STATIC;
             ;;
         --with-profiling) with_profiling=ON;;
+        --log-max-level) die "missing argument to $1 (see -h)" ;;
+        --log-max-level=*) log_max_level=${1##*=};;
+        --micro-bench) micro_bench=ON;;
         *) die "unexpected argument: $1";;
     esac
     shift
@@ -112,12 +122,21 @@ cmake_opts="-DCMAKE_BUILD_TYPE=$buildtype -DPONO_LIB_TYPE=${lib_type} -DPONO_STA
 [ $with_coreir_extern != default ] \
     && cmake_opts="$cmake_opts -DWITH_COREIR_EXTERN=$with_coreir_extern"
 
+[ $with_cudd != default ] \
+    && cmake_opts="$cmake_opts -DWITH_CUDD=$with_cudd"
+
 [ $python != default ] \
     && cmake_opts="$cmake_opts -DBUILD_PYTHON_BINDINGS=ON"
 
 [ $with_profiling != default ] \
     && cmake_opts="$cmake_opts -DWITH_PROFILING=$with_profiling"
 
+[ $log_max_level != default ] \
+    && cmake_opts="$cmake_opts -DPONO_LOG_MAX_LEVEL=$log_max_level"
+
+[ $micro_bench != default ] \
+    && cmake_opts="$cmake_opts -DBUILD_MICRO_BENCH=$micro_bench"
+
 root_dir=$(pwd)
 
 [ -e "$build_dir" ] && rm -r "$build_dir"
@@ -0,0 +1,31 @@
+#!/bin/bash
+
+CUDD_VERSION=cudd-3.0.0
+
+DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" >/dev/null 2>&1 && pwd )"
+DEPS=$DIR/../deps
+
+mkdir -p $DEPS
+
+if [ ! -d "$DEPS/cudd" ]; then
+    cd $DEPS
+    git clone --depth 1 --branch $CUDD_VERSION https://github.com/ivmai/cudd.git cudd
+    cd cudd
+    # the C++ interface (cuddObj.hh) is built into libcudd.a with --enable-obj
+    ./configure --enable-obj --disable-shared --prefix=$DEPS/cudd/local \
+                CFLAGS="-fPIC -O3" CXXFLAGS="-fPIC -O3"
+    make -j${NPROC}
+    make install
+    cd $DIR
+else
+    echo "$DEPS/cudd already exists. If you want to rebuild, please remove it manually."
+fi
+
+if [ -f $DEPS/cudd/local/lib/libcudd.a ] ; then \
+    echo "It appears CUDD was successfully built in $DEPS/cudd/local/lib."
+    echo "You may now build pono with: ./configure.sh --with-cudd && cd build && make"
+else
+    echo "Building CUDD failed."
+    echo "Please see their github page for installation instructions: https://github.com/ivmai/cudd"
+    exit 1
+fi
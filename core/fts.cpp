@@ -25,12 +25,12 @@ namespace pono {
 
 bool FunctionalTransitionSystem::known_symbols(const Term & term) const
 {
-  return contains(term, UnorderedTermSetPtrVec{ &statevars_, &inputvars_ });
+  return contains(term, UnorderedTermSetPtrVec{ &*statevars_, &*inputvars_ });
 }
 
 Term FunctionalTransitionSystem::to_next_func(const Term & term)
 {
-  return solver_->substitute(term, state_updates_);
+  return solver_->substitute(term, *state_updates_);
 }
 
 }  // namespace pono
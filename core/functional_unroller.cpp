@@ -16,6 +16,9 @@
 **/
 #include "core/functional_unroller.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 #include "assert.h"
 #include "utils/exceptions.h"
 
@@ -28,6 +31,8 @@ FunctionalUnroller::FunctionalUnroller(const TransitionSystem & ts,
                                        size_t interval,
                                        const string & time_identifier)
   : super(ts, time_identifier), interval_(interval),
+    max_nodes_(0),
+    max_depth_(0),
     true_(solver_->make_term(true))
 {
   if (!ts.is_functional()) {
@@ -45,64 +50,145 @@ Term FunctionalUnroller::at_time(const Term & t, unsigned int k)
   return super::at_time(t, k);
 }
 
+TermVec FunctionalUnroller::at_time(const TermVec & terms, unsigned int k)
+{
+  for (const auto & t : terms) {
+    if (!ts_.no_next(t)) {
+      throw PonoException(
+          "Functional unroller cannot replace next state variables");
+    }
+  }
+  return super::at_time(terms, k);
+}
+
 UnorderedTermMap & FunctionalUnroller::var_cache_at_time(unsigned int k)
 {
-  const UnorderedTermMap & state_updates = ts_.state_updates();
   while (time_cache_.size() <= k) {
     time_cache_.push_back(UnorderedTermMap());
+    evicted_.push_back(false);
     extra_constraints_.push_back(true_);
-    UnorderedTermMap & subst = time_cache_.back();
-    const unsigned int t = time_cache_.size() - 1;
-    assert(extra_constraints_.size() == t + 1);
-
-    // create new state variables instead of substituting
-    // every interval_ steps (if interval_ nonzero)
-    // except when k is zero then we have to create_new regardless
-    bool create_new = (interval_ && (k % interval_ == 0));
-    create_new |= !t;
-
-    for (auto v : ts_.statevars()) {
-      bool no_update = state_updates.find(v) == state_updates.end();
-      if (create_new || no_update) {
-        Term new_v = var_at_time(v, t);
-        subst[v] = new_v;
-      }
+    fresh_symbols_.push_back(TermVec());
+    fill_functional_var_cache(time_cache_.size() - 1, true);
+  }
 
-      if (t == 0) {
-        assert(create_new);  // should be creating new symbols at 0
-        // no extra constraints at 0
-        continue;
-      } else if (no_update) {
-        // nothing more to be done for implicit inputs
-        continue;
-      }
+  if (evicted_[k]) {
+    // the substitutions at k are built from the ones at k-1
+    unsigned int first = k;
+    while (first > 0 && evicted_[first - 1]) {
+      --first;
+    }
+    for (unsigned int t = first; t <= k; ++t) {
+      fill_functional_var_cache(t, false);
+      restored_time_step(t);
+    }
+  }
 
-      assert(!no_update);
-      Term fun_subst =
-          solver_->substitute(state_updates.at(v), time_cache_.at(t - 1));
+  return time_cache_.at(k);
+}
 
-      if (create_new) {
-        // add equality to extra constraints
-        extra_constraints_[t] =
-            solver_->make_term(And,
-                               extra_constraints_[t],
-                               solver_->make_term(Equal, subst[v], fun_subst));
-      } else {
-        assert(!subst[v]);  // expecting to not have been set already (e.g. be
-                            // null)
+void FunctionalUnroller::fill_functional_var_cache(unsigned int t,
+                                                   bool add_constraints)
+{
+  const UnorderedTermMap & state_updates = ts_.state_updates();
+  UnorderedTermMap & subst = time_cache_[t];
+  assert(extra_constraints_.size() > t);
+
+  // create new state variables instead of substituting
+  // every interval_ steps (if interval_ nonzero)
+  // except when t is zero then we have to create_new regardless
+  bool create_new = (interval_ && (t % interval_ == 0));
+  create_new |= !t;
+
+  for (auto v : ts_.statevars()) {
+    bool no_update = state_updates.find(v) == state_updates.end();
+    if (create_new || no_update) {
+      Term new_v = var_at_time(v, t);
+      subst[v] = new_v;
+    }
 
+    if (t == 0) {
+      assert(create_new);  // should be creating new symbols at 0
+      // no extra constraints at 0
+      continue;
+    } else if (no_update) {
+      // nothing more to be done for implicit inputs
+      continue;
+    }
+
+    assert(!no_update);
+    if (create_new && !add_constraints) {
+      // the fresh symbol is already constrained
+      continue;
+    }
+
+    Term fun_subst =
+        solver_->substitute(state_updates.at(v), time_cache_.at(t - 1));
+
+    bool fresh = create_new;
+    if (!create_new) {
+      assert(!subst[v]);  // expecting to not have been set already (e.g. be
+                          // null)
+      if ((max_nodes_ || max_depth_) && exceeds_inline_limits(fun_subst)) {
+        // cut the unrolling here
+        subst[v] = var_at_time(v, t);
+        fresh = true;
+      } else {
         subst[v] = fun_subst;
       }
     }
 
-    // always need to create new input variables
-    for (auto v : ts_.inputvars()) {
-      Term new_v = var_at_time(v, t);
-      subst[v] = new_v;
+    if (fresh && add_constraints) {
+      // add equality to extra constraints
+      extra_constraints_[t] =
+          solver_->make_term(And,
+                             extra_constraints_[t],
+                             solver_->make_term(Equal, subst[v], fun_subst));
+      fresh_symbols_[t].push_back(subst[v]);
     }
   }
 
-  return time_cache_.at(k);
+  // always need to create new input variables
+  for (auto v : ts_.inputvars()) {
+    Term new_v = var_at_time(v, t);
+    subst[v] = new_v;
+  }
+}
+
+bool FunctionalUnroller::exceeds_inline_limits(const Term & t) const
+{
+  // post-order traversal computing the depth of each distinct node
+  std::unordered_map<Term, size_t> depth;
+  TermVec to_visit({ t });
+  while (to_visit.size()) {
+    Term cur = to_visit.back();
+    if (depth.find(cur) != depth.end()) {
+      to_visit.pop_back();
+      continue;
+    }
+
+    bool children_done = true;
+    size_t d = 0;
+    for (const auto & c : cur) {
+      auto it = depth.find(c);
+      if (it == depth.end()) {
+        children_done = false;
+        to_visit.push_back(c);
+      } else {
+        d = std::max(d, it->second + 1);
+      }
+    }
+    if (!children_done) {
+      continue;
+    }
+
+    to_visit.pop_back();
+    depth[cur] = d;
+    if ((max_nodes_ && depth.size() > max_nodes_)
+        || (max_depth_ && d > max_depth_)) {
+      return true;
+    }
+  }
+  return false;
 }
 
 }  // namespace pono
@@ -61,6 +61,12 @@ class FunctionalUnroller : public Unroller
    */
   smt::Term at_time(const smt::Term & t, unsigned int k) override;
 
+  /** takes terms over current state and input variables
+   *  and returns them at a given time with a functional unrolling
+   *  NOTE: will throw exception if there's a next-state variable
+   */
+  smt::TermVec at_time(const smt::TermVec & terms, unsigned int k) override;
+
   /** Provides extra constraints for a functional unrolling
    *  with intermittent fresh symbols
    *  this is an attempt to deal with ITE explosion in deeply
@@ -79,10 +85,44 @@ class FunctionalUnroller : public Unroller
     return extra_constraints_.at(k);
   }
 
+  /** Introduce fresh symbols when the inlined updates get too large
+   *  A deep functional unrolling can grow exponentially with reconvergent
+   *  logic. With a limit, a state variable whose inlined update at time k
+   *  exceeds it is replaced by a fresh timed symbol instead, constrained to
+   *  be equal to the update in extra_constraints_at(k), so the unrolling
+   *  grows linearly. The size is the number of distinct (hash-consed)
+   *  nodes of the term.
+   *  Only applies to the time steps unrolled after this call.
+   *  @param max_nodes the maximum size of an inlined update, 0 for no limit
+   *  @param max_depth the maximum depth of an inlined update, 0 for no limit
+   */
+  void set_inline_limits(size_t max_nodes, size_t max_depth = 0)
+  {
+    max_nodes_ = max_nodes;
+    max_depth_ = max_depth;
+  }
+
+  /** @return the state variables that are fresh symbols at time k > 0
+   *          (constrained in extra_constraints_at(k)), because of the
+   *          interval or the inline limits
+   */
+  const smt::TermVec & fresh_symbols_at(unsigned int k) const
+  {
+    if (k >= fresh_symbols_.size()) {
+      throw PonoException("Haven't unrolled enough for fresh symbols at "
+                          + std::to_string(k));
+    }
+    return fresh_symbols_.at(k);
+  }
+
  protected:
   size_t interval_;
 
   smt::TermVec extra_constraints_;
+  std::vector<smt::TermVec> fresh_symbols_;
+
+  size_t max_nodes_;  ///< maximum size of an inlined update, 0 for no limit
+  size_t max_depth_;  ///< maximum depth of an inlined update, 0 for no limit
 
   // useful term
   smt::Term true_;
@@ -90,5 +130,17 @@ class FunctionalUnroller : public Unroller
   // overridden to use the interval_ parameter as described in constructor
   // documentation
   smt::UnorderedTermMap & var_cache_at_time(unsigned int k) override;
+
+  /** Fill the variable cache of time step t, the one of t-1 must be filled
+   *  @param t the time step
+   *  @param add_constraints add the extra constraints of the fresh symbols,
+   *         false when the time step is rebuilt after being dropped
+   */
+  void fill_functional_var_cache(unsigned int t, bool add_constraints);
+
+  /** @return true iff t has more distinct nodes or a larger depth than
+   *          the inline limits. Stops after max_nodes_ + 1 nodes.
+   */
+  bool exceeds_inline_limits(const smt::Term & t) const;
 };
 }  // namespace pono
@@ -25,29 +25,35 @@ void RelationalTransitionSystem::set_behavior(const Term & init,
                                               const Term & trans)
 {
   // TODO: Only do this check in debug mode
+  classify(init);
+  classify(trans);
   if (!known_symbols(init) || !known_symbols(trans)) {
     throw PonoException("Unknown symbols");
   }
   init_ = init;
+  trans_conjuncts_ = TermVec{ trans };
   trans_ = trans;
 }
 
 void RelationalTransitionSystem::set_trans(const Term & trans)
 {
   // TODO: Only do this check in debug mode
+  classify(trans);
   if (!known_symbols(trans)) {
     throw PonoException("Unknown symbols");
   }
+  trans_conjuncts_ = TermVec{ trans };
   trans_ = trans;
 }
 
 void RelationalTransitionSystem::constrain_trans(const Term & constraint)
 {
   // TODO: Only do this check in debug mode
+  classify(constraint);
   if (!known_symbols(constraint)) {
     throw PonoException("Unknown symbols");
   }
-  trans_ = solver_->make_term(And, trans_, constraint);
+  add_trans_conjunct(constraint);
 }
 
 }  // namespace pono
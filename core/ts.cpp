@@ -31,6 +31,7 @@ void swap(TransitionSystem & ts1, TransitionSystem & ts2)
 {
   std::swap(ts1.solver_, ts2.solver_);
   std::swap(ts1.init_, ts2.init_);
+  std::swap(ts1.trans_conjuncts_, ts2.trans_conjuncts_);
   std::swap(ts1.trans_, ts2.trans_);
   std::swap(ts1.statevars_, ts2.statevars_);
   std::swap(ts1.next_statevars_, ts2.next_statevars_);
@@ -43,6 +44,11 @@ void swap(TransitionSystem & ts1, TransitionSystem & ts2)
   std::swap(ts1.functional_, ts2.functional_);
   std::swap(ts1.deterministic_, ts2.deterministic_);
   std::swap(ts1.constraints_, ts2.constraints_);
+  std::swap(ts1.symbol_classes_, ts2.symbol_classes_);
+  std::swap(ts1.next_walker_, ts2.next_walker_);
+  std::swap(ts1.curr_walker_, ts2.curr_walker_);
+  std::swap(ts1.next_conversions_, ts2.next_conversions_);
+  std::swap(ts1.curr_conversions_, ts2.curr_conversions_);
 }
 
 TransitionSystem & TransitionSystem::operator=(TransitionSystem other)
@@ -72,28 +78,30 @@ TransitionSystem::TransitionSystem(const TransitionSystem & other_ts,
   // transfer init and trans -- expect them to be boolean
   // will cast if underlying solver aliases Bool/BV1
   init_ = transfer_as(other_ts.init_, BOOL);
-  trans_ = transfer_as(other_ts.trans_, BOOL);
+  for (const auto & c : *other_ts.trans_conjuncts_) {
+    trans_conjuncts_.mut().push_back(transfer_as(c, BOOL));
+  }
 
   // populate data structures with translated terms
 
-  for (const auto & v : other_ts.statevars_) {
-    statevars_.insert(transfer(v));
+  for (const auto & v : *other_ts.statevars_) {
+    statevars_.mut().insert(transfer(v));
   }
 
-  for (const auto & v : other_ts.inputvars_) {
-    inputvars_.insert(transfer(v));
+  for (const auto & v : *other_ts.inputvars_) {
+    inputvars_.mut().insert(transfer(v));
   }
 
-  for (const auto & v : other_ts.next_statevars_) {
-    next_statevars_.insert(transfer(v));
+  for (const auto & v : *other_ts.next_statevars_) {
+    next_statevars_.mut().insert(transfer(v));
   }
 
-  for (const auto & elem : other_ts.named_terms_) {
-    named_terms_[elem.first] = transfer(elem.second);
+  for (const auto & elem : *other_ts.named_terms_) {
+    named_terms_.mut()[elem.first] = transfer(elem.second);
   }
 
-  for (const auto & elem : other_ts.term_to_name_) {
-    term_to_name_[transfer(elem.first)] = elem.second;
+  for (const auto & elem : *other_ts.term_to_name_) {
+    term_to_name_.mut()[transfer(elem.first)] = elem.second;
   }
 
   // variables might have already be in the TermTranslator cache
@@ -101,27 +109,27 @@ TransitionSystem::TransitionSystem(const TransitionSystem & other_ts,
   // use the SortKind as a hint when transferring
   // sorts of the two terms should match for state updates and next_map
   Term key, val;
-  for (const auto & elem : other_ts.state_updates_) {
+  for (const auto & elem : *other_ts.state_updates_) {
     key = transfer(elem.first);
     val = transfer_as(elem.second, key->get_sort()->get_sort_kind());
     assert(key->get_sort() == val->get_sort());
-    state_updates_[key] = val;
+    state_updates_.mut()[key] = val;
   }
-  for (const auto & elem : other_ts.next_map_) {
+  for (const auto & elem : *other_ts.next_map_) {
     key = transfer(elem.first);
     val = transfer_as(elem.second, key->get_sort()->get_sort_kind());
-    next_map_[key] = val;
+    next_map_.mut()[key] = val;
   }
 
-  for (const auto & elem : other_ts.curr_map_) {
-    curr_map_[transfer(elem.first)] = transfer(elem.second);
+  for (const auto & elem : *other_ts.curr_map_) {
+    curr_map_.mut()[transfer(elem.first)] = transfer(elem.second);
   }
 
   /* Constraints collected in vector 'constraints_' were part of init_
-     and/or trans_ and were transferred already above. Hence these
+     and/or trans_conjuncts_ and were transferred already above. Hence these
      terms should be in the term translator cache. */
-  for (const auto & e : other_ts.constraints_) {
-    constraints_.push_back({ transfer_as(e.first, BOOL), e.second });
+  for (const auto & e : *other_ts.constraints_) {
+    constraints_.mut().push_back({ transfer_as(e.first, BOOL), e.second });
   }
   functional_ = other_ts.functional_;
   deterministic_ = other_ts.deterministic_;
@@ -131,7 +139,7 @@ bool TransitionSystem::operator==(const TransitionSystem & other) const
 {
   return (solver_ == other.solver_ &&
           init_ == other.init_ &&
-          trans_ == other.trans_ &&
+          trans() == other.trans() &&
           statevars_ == other.statevars_ &&
           next_statevars_ == other.next_statevars_ &&
           inputvars_ == other.inputvars_ &&
@@ -150,9 +158,39 @@ bool TransitionSystem::operator!=(const TransitionSystem & other) const
   return !(*this == other);
 }
 
+Term TransitionSystem::trans() const
+{
+  if (trans_) {
+    return trans_;
+  }
+
+  if (trans_conjuncts_->empty()) {
+    trans_ = solver_->make_term(true);
+    return trans_;
+  }
+
+  // pairwise conjunctions keep the depth logarithmic in the number of
+  // conjuncts (a left-nested chain is as deep as there are latches)
+  TermVec level = *trans_conjuncts_;
+  while (level.size() > 1) {
+    TermVec next_level;
+    next_level.reserve((level.size() + 1) / 2);
+    for (size_t i = 0; i + 1 < level.size(); i += 2) {
+      next_level.push_back(solver_->make_term(And, level[i], level[i + 1]));
+    }
+    if (level.size() % 2) {
+      next_level.push_back(level.back());
+    }
+    level.swap(next_level);
+  }
+  trans_ = level[0];
+  return trans_;
+}
+
 void TransitionSystem::set_init(const Term & init)
 {
   // TODO: only do this check in debug mode
+  classify(init);
   if (!only_curr(init)) {
     throw PonoException(
         "Initial state constraints should only use current state variables");
@@ -164,6 +202,7 @@ void TransitionSystem::set_init(const Term & init)
 void TransitionSystem::constrain_init(const Term & constraint)
 {
   // TODO: Only do this check in debug mode
+  classify(constraint);
   if (!only_curr(constraint)) {
     throw PonoException(
         "Initial state constraints should only use current state variables");
@@ -174,32 +213,32 @@ void TransitionSystem::constrain_init(const Term & constraint)
 void TransitionSystem::assign_next(const Term & state, const Term & val)
 {
   // TODO: only do this check in debug mode
-  if (statevars_.find(state) == statevars_.end()) {
+  if (statevars_->find(state) == statevars_->end()) {
     throw PonoException("Unknown state variable");
   }
 
+  classify(val);
   if (!no_next(val)) {
     throw PonoException(
         "Got a symbolic that is not a current state or input variable in RHS "
         "of functional assignment");
   }
 
-  if (state_updates_.find(state) != state_updates_.end()) {
+  if (state_updates_->find(state) != state_updates_->end()) {
     throw PonoException("State variable " + state->to_string()
                         + " already has next-state logic assigned.");
   }
 
-  state_updates_[state] = val;
-  trans_ = solver_->make_term(
-      And, trans_, solver_->make_term(Equal, next_map_.at(state), val));
+  state_updates_.mut()[state] = val;
+  add_trans_conjunct(solver_->make_term(Equal, next_map_->at(state), val));
 
   // if not functional, then we cannot guarantee deterministm
   // if it is functional, depends on if all state variables
   // have updates
   // technically not even functional if there are constraints
   // TODO: revisit this and possibly rename functional/deterministic
-  if (functional_ && !constraints_.size()) {
-    deterministic_ = (state_updates_.size() == statevars_.size());
+  if (functional_ && !constraints_->size()) {
+    deterministic_ = (state_updates_->size() == statevars_->size());
   }
 }
 
@@ -210,13 +249,14 @@ void TransitionSystem::add_invar(const Term & constraint)
   deterministic_ = false;
 
   // TODO: only check this in debug mode
+  classify(constraint);
   if (only_curr(constraint)) {
     init_ = solver_->make_term(And, init_, constraint);
-    trans_ = solver_->make_term(And, trans_, constraint);
-    Term next_constraint = solver_->substitute(constraint, next_map_);
+    add_trans_conjunct(constraint);
+    Term next_constraint = solver_->substitute(constraint, *next_map_);
     // add the next-state version
-    trans_ = solver_->make_term(And, trans_, next_constraint);
-    constraints_.push_back({ constraint, true });
+    add_trans_conjunct(next_constraint);
+    constraints_.mut().push_back({ constraint, true });
   } else {
     throw PonoException("Invariants should be over current states only.");
   }
@@ -228,9 +268,10 @@ void TransitionSystem::constrain_inputs(const Term & constraint)
   // TODO: revisit this and possibly rename functional/deterministic
   deterministic_ = false;
 
+  classify(constraint);
   if (no_next(constraint)) {
-    trans_ = solver_->make_term(And, trans_, constraint);
-    constraints_.push_back({ constraint, true });
+    add_trans_conjunct(constraint);
+    constraints_.mut().push_back({ constraint, true });
   } else {
     throw PonoException("Cannot have next-states in an input constraint.");
   }
@@ -243,18 +284,19 @@ void TransitionSystem::add_constraint(const Term & constraint,
   // TODO: revisit this and possibly rename functional/deterministic
   deterministic_ = false;
 
+  classify(constraint);
   if (only_curr(constraint)) {
-    trans_ = solver_->make_term(And, trans_, constraint);
+    add_trans_conjunct(constraint);
 
     if (to_init_and_next) {
       init_ = solver_->make_term(And, init_, constraint);
-      Term next_constraint = solver_->substitute(constraint, next_map_);
-      trans_ = solver_->make_term(And, trans_, next_constraint);
+      Term next_constraint = solver_->substitute(constraint, *next_map_);
+      add_trans_conjunct(next_constraint);
     }
-    constraints_.push_back({ constraint, to_init_and_next });
+    constraints_.mut().push_back({ constraint, to_init_and_next });
   } else if (no_next(constraint)) {
-    trans_ = solver_->make_term(And, trans_, constraint);
-    constraints_.push_back({ constraint, to_init_and_next });
+    add_trans_conjunct(constraint);
+    constraints_.mut().push_back({ constraint, to_init_and_next });
   } else {
     throw PonoException("Constraint cannot have next states");
   }
@@ -262,13 +304,26 @@ void TransitionSystem::add_constraint(const Term & constraint,
 
 void TransitionSystem::name_term(const string name, const Term & t)
 {
-  auto it = named_terms_.find(name);
-  if (it != named_terms_.end() && t != it->second) {
+  auto it = named_terms_->find(name);
+  if (it != named_terms_->end() && t != it->second) {
     throw PonoException("Name " + name + " has already been used.");
   }
-  named_terms_[name] = t;
+  named_terms_.mut()[name] = t;
   // save this name as a representative (might overwrite)
-  term_to_name_[t] = name;
+  term_to_name_.mut()[t] = name_interner().intern(name);
+}
+
+void TransitionSystem::assign_next(const TermVec & states,
+                                   const TermVec & vals)
+{
+  if (states.size() != vals.size()) {
+    throw PonoException("Got " + std::to_string(states.size())
+                        + " state variables but "
+                        + std::to_string(vals.size()) + " updates");
+  }
+  for (size_t i = 0; i < states.size(); ++i) {
+    assign_next(states[i], vals[i]);
+  }
 }
 
 Term TransitionSystem::make_inputvar(const string name, const Sort & sort)
@@ -289,47 +344,104 @@ Term TransitionSystem::make_statevar(const string name, const Sort & sort)
   return state;
 }
 
+TermVec TransitionSystem::make_inputvars(
+    const vector<pair<string, Sort>> & vars)
+{
+  TermVec res;
+  res.reserve(vars.size());
+  for (const auto & v : vars) {
+    res.push_back(make_inputvar(v.first, v.second));
+  }
+  return res;
+}
+
+TermVec TransitionSystem::make_statevars(
+    const vector<pair<string, Sort>> & vars)
+{
+  TermVec res;
+  res.reserve(vars.size());
+  for (const auto & v : vars) {
+    res.push_back(make_statevar(v.first, v.second));
+  }
+  return res;
+}
+
 Term TransitionSystem::curr(const Term & term) const
 {
-  return solver_->substitute(term, curr_map_);
+  auto it = curr_map_->find(term);
+  if (it != curr_map_->end()) {
+    return it->second;
+  }
+  return conversion_walker(curr_walker_, curr_conversions_, *curr_map_)
+      .visit(term);
 }
 
 Term TransitionSystem::next(const Term & term) const
 {
-  if (next_map_.find(term) != next_map_.end()) {
-    return next_map_.at(term);
+  auto it = next_map_->find(term);
+  if (it != next_map_->end()) {
+    return it->second;
+  }
+  return conversion_walker(next_walker_, next_conversions_, *next_map_)
+      .visit(term);
+}
+
+TermVec TransitionSystem::next(const TermVec & terms) const
+{
+  TermVec res;
+  res.reserve(terms.size());
+  SubstitutionWalker & sw =
+      conversion_walker(next_walker_, next_conversions_, *next_map_);
+  for (const auto & t : terms) {
+    res.push_back(sw.visit(t));
   }
-  return solver_->substitute(term, next_map_);
+  return res;
+}
+
+SubstitutionWalker & TransitionSystem::conversion_walker(
+    shared_ptr<SubstitutionWalker> & walker,
+    size_t & conversions,
+    const UnorderedTermMap & map) const
+{
+  // the walker keeps the substitution of every visited subterm
+  // so converting terms that share subterms (e.g. the literals of
+  // cubes) only visits the new ones
+  if (!walker || walker.use_count() > 1 || conversions >= max_conversions) {
+    walker = make_shared<SubstitutionWalker>(solver_, map);
+    conversions = 0;
+  }
+  ++conversions;
+  return *walker;
 }
 
 bool TransitionSystem::is_curr_var(const Term & sv) const
 {
-  return (statevars_.find(sv) != statevars_.end());
+  return (statevars_->find(sv) != statevars_->end());
 }
 
 bool TransitionSystem::is_next_var(const Term & sv) const
 {
-  return (next_statevars_.find(sv) != next_statevars_.end());
+  return (next_statevars_->find(sv) != next_statevars_->end());
 }
 
 bool TransitionSystem::is_input_var(const Term & sv) const
 {
-  return (inputvars_.find(sv) != inputvars_.end());
+  return (inputvars_->find(sv) != inputvars_->end());
 }
 
 std::string TransitionSystem::get_name(const Term & t) const
 {
-  const auto & it = term_to_name_.find(t);
-  if (it != term_to_name_.end()) {
-    return it->second;
+  const auto & it = term_to_name_->find(t);
+  if (it != term_to_name_->end()) {
+    return name_interner().name(it->second);
   }
   return t->to_string();
 }
 
 smt::Term TransitionSystem::lookup(std::string name) const
 {
-  const auto & it = named_terms_.find(name);
-  if (it == named_terms_.end()) {
+  const auto & it = named_terms_->find(name);
+  if (it == named_terms_->end()) {
     throw PonoException("Could not find term named: " + name);
   }
   return it->second;
@@ -341,40 +453,47 @@ void TransitionSystem::add_statevar(const Term & cv, const Term & nv)
   //       could refactor entirely, or just pass a flag
   //       saying whether to check these things or not
 
-  if (statevars_.find(cv) != statevars_.end()) {
+  if (statevars_->find(cv) != statevars_->end()) {
     throw PonoException("Cannot redeclare a state variable");
   }
 
-  if (next_statevars_.find(nv) != next_statevars_.end()) {
+  if (next_statevars_->find(nv) != next_statevars_->end()) {
     throw PonoException("Cannot redeclare a state variable");
   }
 
-  if (next_statevars_.find(cv) != next_statevars_.end()) {
+  if (next_statevars_->find(cv) != next_statevars_->end()) {
     throw PonoException(
         "Cannot use an existing next state variable as a current state var");
   }
 
-  if (statevars_.find(nv) != statevars_.end()) {
+  if (statevars_->find(nv) != statevars_->end()) {
     throw PonoException(
         "Cannot use an existing state variable as a next state var");
   }
 
   // if using an input variable, remove from set
   // will be a state variable now
-  if (inputvars_.find(cv) != inputvars_.end()) {
-    bool success = inputvars_.erase(cv);
+  if (inputvars_->find(cv) != inputvars_->end()) {
+    bool success = inputvars_.mut().erase(cv);
     assert(success);
   }
 
-  if (inputvars_.find(nv) != inputvars_.end()) {
-    bool success = inputvars_.erase(nv);
+  if (inputvars_->find(nv) != inputvars_->end()) {
+    bool success = inputvars_.mut().erase(nv);
     assert(success);
   }
 
-  statevars_.insert(cv);
-  next_statevars_.insert(nv);
-  next_map_[cv] = nv;
-  curr_map_[nv] = cv;
+  // the cached classes of terms over cv or nv are stale
+  reclassify(cv);
+  reclassify(nv);
+  // and so are the cached conversions
+  next_walker_ = nullptr;
+  curr_walker_ = nullptr;
+
+  statevars_.mut().insert(cv);
+  next_statevars_.mut().insert(nv);
+  next_map_.mut()[cv] = nv;
+  curr_map_.mut()[nv] = cv;
   // automatically include in named_terms
   name_term(cv->to_string(), cv);
   name_term(nv->to_string(), nv);
@@ -385,14 +504,15 @@ void TransitionSystem::add_inputvar(const Term & v)
   // TODO: this check is running even when used by make_inputvar
   //       could refactor entirely or just pass a boolean saying whether or not
   //       to check these things
-  if (statevars_.find(v) != statevars_.end()
-      || next_statevars_.find(v) != next_statevars_.end()
-      || inputvars_.find(v) != inputvars_.end()) {
+  if (statevars_->find(v) != statevars_->end()
+      || next_statevars_->find(v) != next_statevars_->end()
+      || inputvars_->find(v) != inputvars_->end()) {
     throw PonoException(
         "Cannot reuse an existing variable as an input variable");
   }
 
-  inputvars_.insert(v);
+  reclassify(v);
+  inputvars_.mut().insert(v);
   // automatically include in named_terms
   name_term(v->to_string(), v);
 }
@@ -481,109 +601,299 @@ Term TransitionSystem::make_term(const Op op, const TermVec & terms)
   return solver_->make_term(op, terms);
 }
 
+TermVec TransitionSystem::make_terms(const TermVec & leaves,
+                                    const vector<Op> & ops,
+                                    const vector<uint64_t> & tape)
+{
+  TermVec res;
+  TermVec args;
+  size_t i = 0;
+  while (i < tape.size()) {
+    if (i + 1 >= tape.size()) {
+      throw PonoException("Truncated term tape entry at " + std::to_string(i));
+    }
+    uint64_t op_idx = tape[i];
+    uint64_t n = tape[i + 1];
+    i += 2;
+    if (op_idx >= ops.size()) {
+      throw PonoException("Unknown operator index " + std::to_string(op_idx)
+                          + " in term tape");
+    }
+    if (n > tape.size() - i) {
+      throw PonoException("Truncated term tape entry at " + std::to_string(i));
+    }
+    args.clear();
+    for (uint64_t j = 0; j < n; ++j, ++i) {
+      uint64_t a = tape[i];
+      if (a < leaves.size()) {
+        args.push_back(leaves[a]);
+      } else if (a - leaves.size() < res.size()) {
+        args.push_back(res[a - leaves.size()]);
+      } else {
+        throw PonoException("Term tape argument " + std::to_string(a)
+                            + " refers to a term not made yet");
+      }
+    }
+    res.push_back(solver_->make_term(ops[op_idx], args));
+  }
+  return res;
+}
+
 void TransitionSystem::rebuild_trans_based_on_coi(
     const UnorderedTermSet & state_vars_in_coi,
     const UnorderedTermSet & input_vars_in_coi)
 {
-  /* Clear current transition relation 'trans_'. */
-  trans_ = solver_->make_term(true);
-
-  /* Add next-state functions for state variables in COI. */
-  for (const auto & state_var : state_vars_in_coi) {
-    Term next_func = NULL;
-    const auto & elem = state_updates_.find(state_var);
-    if (elem != state_updates_.end())
-      next_func = elem->second;
-    /* May find state variables without next-function. */
-    if (next_func != NULL) {
-        Term eq = solver_->make_term(Equal, next_map_.at(state_var), next_func);
-        trans_ = solver_->make_term(And, trans_, eq);
-      }
+  Rewrite rw = begin_rewrite();
+  rw.restrict_vars(state_vars_in_coi, input_vars_in_coi);
+  commit_rewrite(rw);
+}
+
+void TransitionSystem::Rewrite::replace_terms(
+    const UnorderedTermMap & to_replace)
+{
+  if (to_replace.empty()) {
+    return;
   }
 
-  /* Add global constraints added to previous 'trans_'. */
-  // TODO: check potential optimizations in removing global constraints
-  std::vector<std::pair<smt::Term, bool>> prev_constraints = constraints_;
-  constraints_.clear();
-  for (const auto & e : prev_constraints) {
-    add_constraint(e.first, e.second);
+  // compose with the replacements staged before: a staged key maps to
+  // its replacement after both substitutions
+  // (exact if the keys are symbols, which is the common case)
+  SubstitutionWalker sw(solver_, to_replace);
+  for (auto & elem : replacements_) {
+    elem.second = sw.visit(elem.second);
   }
+  for (const auto & elem : to_replace) {
+    if (replacements_.find(elem.first) == replacements_.end()) {
+      replacements_[elem.first] = elem.second;
+    }
+  }
+}
 
-  statevars_.clear();
-  // Have to add any state variables in init back in
-  // this is because COI doesn't consider init and if
-  // we remove those state variables then the TS is
-  // ill-formed (e.g. init will contain unknown symbols)
-  // this shouldn't affect performance much, because
-  // variables in init that are not in the COI *only*
-  // appear in init
-  get_free_symbolic_consts(init_, statevars_);
-  for (const auto & var : state_vars_in_coi) {
-    statevars_.insert(var);
+void TransitionSystem::Rewrite::drop_state_updates(const TermVec & svs)
+{
+  dropped_.insert(svs.begin(), svs.end());
+}
+
+void TransitionSystem::Rewrite::restrict_vars(
+    const UnorderedTermSet & statevars, const UnorderedTermSet & inputvars)
+{
+  if (!restricted_) {
+    restricted_ = true;
+    statevars_ = statevars;
+    inputvars_ = inputvars;
+    return;
   }
 
-  inputvars_.clear();
-  for (const auto & var : input_vars_in_coi) {
-    inputvars_.insert(var);
+  UnorderedTermSet kept;
+  for (const auto & v : statevars_) {
+    if (statevars.find(v) != statevars.end()) {
+      kept.insert(v);
+    }
+  }
+  statevars_.swap(kept);
+  kept.clear();
+  for (const auto & v : inputvars_) {
+    if (inputvars.find(v) != inputvars.end()) {
+      kept.insert(v);
+    }
+  }
+  inputvars_.swap(kept);
+}
+
+void TransitionSystem::commit_rewrite(const Rewrite & rw)
+{
+  if (rw.empty()) {
+    return;
   }
 
-  smt::UnorderedTermMap reduced_state_updates;
-  for (const auto & var : state_vars_in_coi) {
-    const auto & elem = state_updates_.find(var);
-    if (elem != state_updates_.end()) {
-      Term next_func = elem->second;
-      reduced_state_updates[var] = next_func;
+  for (const auto & sv : rw.dropped_) {
+    if (!is_curr_var(sv)) {
+      throw PonoException("Got non-state var in drop_state_updates");
     }
   }
-  state_updates_ = reduced_state_updates;
 
-  /* update named_terms and term_to_name_ by removing terms that
-     no longer exist in the system
+  // first check that all the replacements contain known symbols
+  UnorderedTermSetPtrVec all_symbols(
+      { &*statevars_, &*inputvars_, &*next_statevars_ });
+  for (const auto & elem : rw.replacements_) {
+    classify(elem.first);
+    classify(elem.second);
+    bool known = contains(elem.first, all_symbols);
+    known &= contains(elem.second, all_symbols);
+    if (!known) {
+      throw PonoException("Got an unknown symbol in replace_terms map");
+    }
+  }
+
+  // use a substitution walker because
+  //   1. it keeps a persistent cache, shared by all the terms below
+  //   2. it supports substituting arbitrary terms (e.g. not just mapping from
+  //   symbols)
+  SubstitutionWalker sw(solver_, rw.replacements_);
+
+  // compute everything before modifying the system
+  Term new_init = sw.visit(init_);
+  classify(new_init);
+  if (!only_curr(new_init)) {
+    throw PonoException(
+        "Replaced a state variable appearing in init with an input in "
+        "replace_terms");
+  }
+
+  // NOTE: the variables keep their next state variables and updates, so
+  //       replacing a state variable does not clobber the entries of
+  //       another one
+  UnorderedTermMap new_state_updates;
+  Term update;
+  for (const auto & elem : *state_updates_) {
+    const Term & sv = elem.first;
+    if (rw.dropped_.find(sv) != rw.dropped_.end()
+        || (rw.restricted_ && rw.statevars_.find(sv) == rw.statevars_.end())) {
+      continue;
+    }
+    update = sw.visit(elem.second);
+    classify(update);
+    if (functional_ && !no_next(update)) {
+      throw PonoException(
+          "Got a next state variable in a state update for a functional "
+          "TransitionSystem in replace_terms");
+    }
+    new_state_updates[sv] = update;
+  }
+
+  vector<pair<Term, bool>> new_constraints;
+  new_constraints.reserve(constraints_->size());
+  for (const auto & e : *constraints_) {
+    new_constraints.push_back({ sw.visit(e.first), e.second });
+  }
+
+  UnorderedTermSet new_statevars;
+  UnorderedTermSet new_inputvars;
+  if (rw.restricted_) {
+    // Have to add any state variables in init back in
+    // this is because COI doesn't consider init and if
+    // we remove those state variables then the TS is
+    // ill-formed (e.g. init will contain unknown symbols)
+    // this shouldn't affect performance much, because
+    // variables in init that are not in the COI *only*
+    // appear in init
+    get_free_symbolic_consts(new_init, new_statevars);
+    new_statevars.insert(rw.statevars_.begin(), rw.statevars_.end());
+    new_inputvars = rw.inputvars_;
+  }
+
+  /* update named_terms and term_to_name_ with the replacements, and
+     remove the terms that no longer exist in the system
    */
-  unordered_map<string, Term> reduced_named_terms;
-  unordered_map<Term, string> reduced_term_to_name;
-  UnorderedTermSet free_vars;
-  for (const auto & elem : named_terms_) {
-    free_vars.clear();
-    get_free_symbolic_consts(elem.second, free_vars);
-    bool all_in_sys = true;
-    Term currvar;
+  auto in_sys = [&](const Term & t) {
+    if (!rw.restricted_) {
+      return true;
+    }
+    UnorderedTermSet free_vars;
+    get_free_symbolic_consts(t, free_vars);
     for (const auto & v : free_vars) {
       // v is an input variable, current variable, or next variable
       // we want the current version of a state variable
-      const auto & it = curr_map_.find(v);
-      if (it != curr_map_.end()) {
-        // get the current state version of a next variable
-        currvar = it->second;
-      } else {
-        currvar = v;
+      const auto & it = curr_map_->find(v);
+      const Term & currvar = it != curr_map_->end() ? it->second : v;
+      if (new_statevars.find(currvar) == new_statevars.end()
+          && new_inputvars.find(currvar) == new_inputvars.end()) {
+        return false;
       }
+    }
+    return true;
+  };
+
+  // the names are updated in place, only copied if they are shared
+  unordered_map<string, Term> & named_terms = named_terms_.mut();
+  // a replacement that already has a name keeps it
+  // NOTE: name might not be the same as the key
+  //       need to use the representative name
+  //       stored in term_to_name_
+  unordered_map<Term, NameId> new_term_to_name;
+  vector<pair<Term, Term>> replaced;
+  for (auto it = named_terms.begin(); it != named_terms.end();) {
+    Term t = sw.visit(it->second);
+    if (!in_sys(t)) {
+      it = named_terms.erase(it);
+      continue;
+    }
+    if (t == it->second) {
+      new_term_to_name[t] = term_to_name_->at(t);
+    } else {
+      replaced.push_back({ it->second, t });
+      it->second = t;
+    }
+    ++it;
+  }
+  for (const auto & elem : replaced) {
+    new_term_to_name.emplace(elem.second, term_to_name_->at(elem.first));
+  }
 
-      if (statevars_.find(currvar) == statevars_.end()
-          && inputvars_.find(currvar) == inputvars_.end()) {
-        all_in_sys = false;
-        break;
-      }
+  // now update the system
+  init_ = new_init;
+  state_updates_ = std::move(new_state_updates);
+  term_to_name_ = std::move(new_term_to_name);
+
+  if (rw.restricted_) {
+    statevars_ = std::move(new_statevars);
+    inputvars_ = std::move(new_inputvars);
+    // removed variables are unknown symbols now
+    symbol_classes_.reset();
+  }
+
+  if (rw.restricted_ || !rw.dropped_.empty()) {
+    /* Rebuild the transition relation from the remaining next-state
+       functions and the constraints. */
+    trans_conjuncts_.reset();
+    trans_ = nullptr;
+    for (const auto & elem : *state_updates_) {
+      assert(elem.second);  // should be non-null if in map
+      Term eq =
+          solver_->make_term(Equal, next_map_->at(elem.first), elem.second);
+      add_trans_conjunct(eq);
     }
 
-    if (all_in_sys) {
-      reduced_named_terms[elem.first] = elem.second;
-      // NOTE: name might not be the same as elem.first
-      //       need to use the representative name
-      //       stored in term_to_name_
-      reduced_term_to_name[elem.second] = term_to_name_.at(elem.second);
+    // TODO: check potential optimizations in removing global constraints
+    constraints_.reset();
+    for (const auto & e : new_constraints) {
+      add_constraint(e.first, e.second);
+    }
+  } else {
+    for (auto & c : trans_conjuncts_.mut()) {
+      c = sw.visit(c);
     }
+    trans_ = nullptr;
+    constraints_ = std::move(new_constraints);
   }
-  named_terms_ = reduced_named_terms;
-  term_to_name_ = reduced_term_to_name;
 }
 
 // protected methods
 
 bool TransitionSystem::contains(const Term & term,
-                                UnorderedTermSetPtrVec term_sets) const
+                                const UnorderedTermSetPtrVec & term_sets) const
 {
-  UnorderedTermSet visited;
+  uint8_t allowed = 0;
+  bool foreign = false;
+  for (const auto & ts : term_sets) {
+    if (ts == &*statevars_) {
+      allowed |= CURR_SYMBOLS;
+    } else if (ts == &*inputvars_) {
+      allowed |= INPUT_SYMBOLS;
+    } else if (ts == &*next_statevars_) {
+      allowed |= NEXT_SYMBOLS;
+    } else {
+      foreign = true;
+    }
+  }
+
+  if (!foreign) {
+    TermHashMap<uint8_t> memo;
+    return !(compute_symbol_classes(term, memo) & ~allowed);
+  }
+
+  // sets that are not part of this system, walk the whole term
+  TermHashSet visited;
   TermVec to_visit{ term };
   Term t;
   while (to_visit.size()) {
@@ -618,45 +928,102 @@ bool TransitionSystem::contains(const Term & term,
   return true;
 }
 
-bool TransitionSystem::only_curr(const Term & term) const
-{
-  return contains(term, UnorderedTermSetPtrVec{ &statevars_ });
-}
-
-bool TransitionSystem::no_next(const Term & term) const
+uint8_t TransitionSystem::symbol_class(const Term & sym) const
 {
-  return contains(term, UnorderedTermSetPtrVec{ &statevars_, &inputvars_ });
+  if (statevars_->find(sym) != statevars_->end()) {
+    return CURR_SYMBOLS;
+  } else if (inputvars_->find(sym) != inputvars_->end()) {
+    return INPUT_SYMBOLS;
+  } else if (next_statevars_->find(sym) != next_statevars_->end()) {
+    return NEXT_SYMBOLS;
+  }
+  return OTHER_SYMBOLS;
 }
 
-void TransitionSystem::drop_state_updates(const TermVec & svs)
+uint8_t TransitionSystem::compute_symbol_classes(
+    const Term & term, TermHashMap<uint8_t> & memo) const
 {
-  for (const auto & sv : svs) {
-    if (!is_curr_var(sv)) {
-      throw PonoException("Got non-state var in drop_state_updates");
+  auto lookup = [&](const Term & t, uint8_t & cls) {
+    auto it = symbol_classes_->find(t);
+    if (it != symbol_classes_->end()) {
+      cls = it->second;
+      return true;
     }
-    state_updates_.erase(sv);
+    it = memo.find(t);
+    if (it != memo.end()) {
+      cls = it->second;
+      return true;
+    }
+    return false;
+  };
+
+  uint8_t cls;
+  if (lookup(term, cls)) {
+    return cls;
   }
 
-  // now rebuild trans
-  /* Clear current transition relation 'trans_'. */
-  trans_ = solver_->make_term(true);
+  // post-order traversal of the subterms that were not visited before
+  // the flag is set once the children of the term are pushed
+  std::vector<std::pair<Term, bool>> to_visit{ { term, false } };
+  while (to_visit.size()) {
+    Term t = to_visit.back().first;
+    bool expanded = to_visit.back().second;
+
+    if (lookup(t, cls)) {
+      to_visit.pop_back();
+      continue;
+    }
 
-  /* Add next-state functions for state variables in COI. */
-  for (const auto & elem : state_updates_) {
-    assert(elem.second);  // should be non-null if in map
-    Term eq = solver_->make_term(Equal, next_map_.at(elem.first), elem.second);
-    trans_ = solver_->make_term(And, trans_, eq);
-  }
+    if (t->is_symbolic_const()) {
+      memo[t] = symbol_class(t);
+      to_visit.pop_back();
+      continue;
+    }
 
-  /* Add global constraints added to previous 'trans_'. */
-  for (const auto & e : constraints_) {
-    add_constraint(e.first, e.second);
+    if (!expanded) {
+      to_visit.back().second = true;
+      for (const auto & c : t) {
+        if (!lookup(c, cls)) {
+          to_visit.push_back({ c, false });
+        }
+      }
+    } else {
+      uint8_t t_cls = 0;
+      for (const auto & c : t) {
+        bool found = lookup(c, cls);
+        assert(found);
+        t_cls |= cls;
+      }
+      memo[t] = t_cls;
+      to_visit.pop_back();
+    }
   }
+
+  bool found = lookup(term, cls);
+  assert(found);
+  return cls;
+}
+
+bool TransitionSystem::only_curr(const Term & term) const
+{
+  return contains(term, UnorderedTermSetPtrVec{ &*statevars_ });
+}
+
+bool TransitionSystem::no_next(const Term & term) const
+{
+  return contains(term, UnorderedTermSetPtrVec{ &*statevars_, &*inputvars_ });
+}
+
+void TransitionSystem::drop_state_updates(const TermVec & svs)
+{
+  Rewrite rw = begin_rewrite();
+  rw.drop_state_updates(svs);
+  commit_rewrite(rw);
 }
 
 void TransitionSystem::promote_inputvar(const Term & iv)
 {
-  size_t num_erased = inputvars_.erase(iv);
+  size_t num_erased = inputvars_.mut().erase(iv);
   if (!num_erased) {
     throw PonoException("Tried to promote non-input to state variable: "
                         + iv->to_string());
@@ -673,85 +1040,16 @@ void TransitionSystem::promote_inputvar(const Term & iv)
 
 void TransitionSystem::replace_terms(const UnorderedTermMap & to_replace)
 {
-  // first check that all the replacements contain known symbols
-  UnorderedTermSetPtrVec all_symbols(
-      { &statevars_, &inputvars_, &next_statevars_ });
-  for (const auto & elem : to_replace) {
-    bool known = contains(elem.first, all_symbols);
-    known &= contains(elem.second, all_symbols);
-    if (!known) {
-      throw PonoException("Got an unknown symbol in replace_terms map");
-    }
-  }
-
-  // use a substitution walker because
-  //   1. it keeps a persistent cache
-  //   2. it supports substituting arbitrary terms (e.g. not just mapping from
-  //   symbols)
-  SubstitutionWalker sw(solver_, to_replace);
-
-  // now rebuild terms in every data structure with replacements
-  init_ = sw.visit(init_);
-  if (!only_curr(init_)) {
-    throw PonoException(
-        "Replaced a state variable appearing in init with an input in "
-        "replace_terms");
-  }
-  trans_ = sw.visit(trans_);
-
-  unordered_map<string, Term> new_named_terms;
-  unordered_map<Term, string> new_term_to_name;
-  for (auto elem : named_terms_) {
-    new_named_terms[elem.first] = sw.visit(elem.second);
-    new_term_to_name[sw.visit(elem.second)] = term_to_name_.at(elem.second);
-  }
-  named_terms_ = new_named_terms;
-  term_to_name_ = new_term_to_name;
-
-  // NOTE: don't need to update vars, let COI reduction handle that
-  UnorderedTermMap new_state_updates;
-  Term sv, update;
-  for (auto elem : state_updates_) {
-    sv = elem.first;
-    sv = sw.visit(sv);
-    update = sw.visit(elem.second);
-    if (functional_ && !no_next(update)) {
-      throw PonoException(
-          "Got a next state variable in a state update for a functional "
-          "TransitionSystem in replace_terms");
-    }
-    new_state_updates[sv] = update;
-  }
-  state_updates_ = new_state_updates;
-
-  UnorderedTermMap new_next_map_;
-  UnorderedTermMap new_curr_map_;
-  Term c, n;
-  for (const auto & elem : next_map_) {
-    c = elem.first;
-    n = elem.second;
-    c = sw.visit(c);
-    n = sw.visit(n);
-    new_next_map_[c] = n;
-    assert(curr_map_.at(elem.second) == elem.first);
-    new_curr_map_[n] = c;
-  }
-  next_map_ = new_next_map_;
-  curr_map_ = new_curr_map_;
-
-  vector<pair<Term, bool>> new_constraints;
-  new_constraints.reserve(constraints_.size());
-  for (const auto & e : constraints_) {
-    new_constraints.push_back(e);
-  }
-  constraints_ = new_constraints;
+  Rewrite rw = begin_rewrite();
+  rw.replace_terms(to_replace);
+  commit_rewrite(rw);
 }
 
 bool TransitionSystem::known_symbols(const Term & term) const
 {
   return contains(
       term,
-      UnorderedTermSetPtrVec{ &statevars_, &inputvars_, &next_statevars_ });
+      UnorderedTermSetPtrVec{ &*statevars_, &*inputvars_, &*next_statevars_ });
 }
 
 }  // namespace pono
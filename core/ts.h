@@ -16,13 +16,22 @@
 
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
 #include "smt-switch/cvc4_factory.h"
 #include "smt-switch/smt.h"
 
+#include "utils/copy_on_write.h"
 #include "utils/exceptions.h"
+#include "utils/name_interner.h"
+#include "utils/term_hash_map.h"
+
+namespace smt {
+class SubstitutionWalker;
+}
 
 namespace pono {
 
@@ -109,6 +118,15 @@ class TransitionSystem
    */
   void assign_next(const smt::Term & state, const smt::Term & val);
 
+  /* Set the transition functions of many state variables at once
+   *   (e.g. for front-ends that pay for every call)
+   * @param states the state variables you are updating
+   * @param vals the values they should get, in the same order
+   * Throws a PonoException if the sizes differ, and in the cases of
+   * assign_next
+   */
+  void assign_next(const smt::TermVec & states, const smt::TermVec & vals);
+
   /* Add an invariant constraint to the system
    * This is enforced over all time
    * Specifically, it adds the constraint over both current and next variables
@@ -161,6 +179,20 @@ class TransitionSystem
    */
   smt::Term make_statevar(const std::string name, const smt::Sort & sort);
 
+  /* Create many inputs at once
+   * @param vars the names and sorts of the inputs
+   * @return the input terms, in the same order
+   */
+  smt::TermVec make_inputvars(
+      const std::vector<std::pair<std::string, smt::Sort>> & vars);
+
+  /* Create many states at once
+   * @param vars the names and sorts of the states
+   * @return the current state variables, in the same order
+   */
+  smt::TermVec make_statevars(
+      const std::vector<std::pair<std::string, smt::Sort>> & vars);
+
   /* Map all next state variables to current state variables in the term
    * @param t the term to map
    * @return the term with all current state variables
@@ -173,6 +205,12 @@ class TransitionSystem
    */
   smt::Term next(const smt::Term & term) const;
 
+  /* Map all current state variables to next state variables in the terms
+   * @param terms the terms to map
+   * @return the terms with all next state variables, in the same order
+   */
+  smt::TermVec next(const smt::TermVec & terms) const;
+
   /* @param sv the state variable to check
    * @return true if sv is a current state variable
    *
@@ -231,9 +269,9 @@ class TransitionSystem
   /* Gets a non-const reference to the solver */
   smt::SmtSolver & get_solver() { return solver_; };
 
-  const smt::UnorderedTermSet & statevars() const { return statevars_; };
+  const smt::UnorderedTermSet & statevars() const { return *statevars_; };
 
-  const smt::UnorderedTermSet & inputvars() const { return inputvars_; };
+  const smt::UnorderedTermSet & inputvars() const { return *inputvars_; };
 
   /* Returns the initial state constraints
    * @return a boolean term constraining the initial state
@@ -241,22 +279,33 @@ class TransitionSystem
   smt::Term init() const { return init_; };
 
   /* Returns the transition relation
+   * Built on demand as a balanced conjunction of trans_conjuncts()
+   * and cached until the next change to the system, so the first call
+   * after a change must not race with other calls.
    * @return a boolean term representing the transition relation
    */
-  smt::Term trans() const { return trans_; };
+  smt::Term trans() const;
+
+  /* Returns the conjuncts of the transition relation
+   * i.e. the state update equalities and the constraints, in the order
+   * they were added. Engines can unroll and assert them individually
+   * instead of the monolithic trans().
+   * @return the conjuncts of the transition relation
+   */
+  const smt::TermVec & trans_conjuncts() const { return *trans_conjuncts_; };
 
   /* Returns the next state updates
    * @return a map of functional next state updates
    */
   const smt::UnorderedTermMap & state_updates() const
   {
-    return state_updates_;
+    return *state_updates_;
   };
 
   /* @return the named terms mapping */
   const std::unordered_map<std::string, smt::Term> & named_terms() const
   {
-    return named_terms_;
+    return *named_terms_;
   };
 
   /** @return the constraints of the system
@@ -270,7 +319,7 @@ class TransitionSystem
    */
   const std::vector<std::pair<smt::Term, bool>> & constraints() const
   {
-    return constraints_;
+    return *constraints_;
   };
 
   /** Whether the transition system is functional
@@ -304,6 +353,72 @@ class TransitionSystem
    * states */
   bool no_next(const smt::Term & term) const;
 
+  /** EXPERTS ONLY
+   *  A batch of replacements, dropped state updates and variable
+   *  restrictions that is applied to the system by commit_rewrite in one
+   *  rebuild, with one substitution cache. Several passes can stage
+   *  their changes in the same Rewrite instead of rebuilding the system
+   *  once each.
+   */
+  class Rewrite
+  {
+   public:
+    Rewrite(const smt::SmtSolver & solver) : solver_(solver) {}
+
+    /** Stage replacements, see TransitionSystem::replace_terms
+     *  They apply to the result of the replacements staged before, as if
+     *  replace_terms was called in the same order.
+     *  @param to_replace a mapping from terms in the transition
+     *         system to their replacement.
+     */
+    void replace_terms(const smt::UnorderedTermMap & to_replace);
+
+    /** Stage dropping the state updates of these variables
+     *  @param svs the state variables to drop updates for
+     */
+    void drop_state_updates(const smt::TermVec & svs);
+
+    /** Stage keeping only these variables, as in
+     *  TransitionSystem::rebuild_trans_based_on_coi
+     *  Restricting several times keeps the intersection.
+     *  @param statevars the state variables to keep
+     *  @param inputvars the input variables to keep
+     */
+    void restrict_vars(const smt::UnorderedTermSet & statevars,
+                       const smt::UnorderedTermSet & inputvars);
+
+    /** @return true iff nothing is staged */
+    bool empty() const
+    {
+      return replacements_.empty() && dropped_.empty() && !restricted_;
+    }
+
+   protected:
+    friend class TransitionSystem;
+
+    smt::SmtSolver solver_;
+    smt::UnorderedTermMap replacements_;
+    smt::UnorderedTermSet dropped_;
+    bool restricted_ = false;
+    smt::UnorderedTermSet statevars_;
+    smt::UnorderedTermSet inputvars_;
+  };
+
+  /** @return an empty batch of changes to this system */
+  Rewrite begin_rewrite() const { return Rewrite(solver_); }
+
+  /** EXPERTS ONLY
+   *  Apply a batch of changes and rebuild the system once
+   *  The transition relation is rebuilt from the state updates and
+   *  constraints if updates are dropped or variables are restricted,
+   *  otherwise the replacements are applied to its conjuncts.
+   *  Throws a PonoException (before modifying the system) if a
+   *  replacement contains unknown symbols or makes init or a functional
+   *  update ill-formed.
+   *  @param rw the changes
+   */
+  void commit_rewrite(const Rewrite & rw);
+
   /** EXPERTS ONLY
    *  Drop the state update for these variables and rebuild the system
    *  @param svs the state variables to drop updates for
@@ -331,6 +446,8 @@ class TransitionSystem
    *    to cut out parts of the design by replacing terms with
    *    fresh inputs. Then cone of influence reduction can remove
    *    the unconnected parts of the transition system
+   *  Replaced state variables keep their next state variables and
+   *    state updates, use drop_state_updates to remove them.
    *  @param to_replace a mapping from terms in the transition
    *         system to their replacement.
    */
@@ -468,6 +585,21 @@ class TransitionSystem
    */
   smt::Term make_term(const smt::Op op, const smt::TermVec & terms);
 
+  /* Make many terms from a tape, in one call
+   * The tape is a sequence of entries op_index, n, a_1, ..., a_n, each
+   *   making the term ops[op_index](t_a_1, ..., t_a_n). Argument i refers
+   *   to leaves[i] if i < leaves.size(), and otherwise to the
+   *   (i - leaves.size())-th term made by the tape.
+   * @param leaves the terms made beforehand (variables, values)
+   * @param ops the operators of the tape
+   * @param tape the entries
+   * @return the terms made, one per entry
+   * Throws a PonoException if the tape is malformed
+   */
+  smt::TermVec make_terms(const smt::TermVec & leaves,
+                          const std::vector<smt::Op> & ops,
+                          const std::vector<uint64_t> & tape);
+
   /* Rebuild transition relation 'trans_' based on set
      'state_vars_in_coi' of state-variables in cone-of-influence. The
      set 'state_vars_in_coi' is computed in the 'Prover' class that
@@ -485,36 +617,40 @@ class TransitionSystem
   // initial state constraint
   smt::Term init_;
 
-  // transition relation (functional in this class)
-  smt::Term trans_;
+  // conjuncts of the transition relation (functional in this class)
+  CopyOnWrite<smt::TermVec> trans_conjuncts_;
+
+  // the conjunction of trans_conjuncts_, null until requested
+  mutable smt::Term trans_;
 
   // system state variables
-  smt::UnorderedTermSet statevars_;
+  CopyOnWrite<smt::UnorderedTermSet> statevars_;
 
   // set of next state variables
-  smt::UnorderedTermSet next_statevars_;
+  CopyOnWrite<smt::UnorderedTermSet> next_statevars_;
 
   // system inputs
-  smt::UnorderedTermSet inputvars_;
+  CopyOnWrite<smt::UnorderedTermSet> inputvars_;
 
   // mapping from names to terms
-  std::unordered_map<std::string, smt::Term> named_terms_;
+  CopyOnWrite<std::unordered_map<std::string, smt::Term>> named_terms_;
 
   // mapping from terms to a representative name
   // because a term can have multiple names
-  std::unordered_map<smt::Term, std::string> term_to_name_;
+  // the names are interned (see utils/name_interner.h)
+  CopyOnWrite<std::unordered_map<smt::Term, NameId>> term_to_name_;
 
   // next state update function
-  smt::UnorderedTermMap state_updates_;
+  CopyOnWrite<smt::UnorderedTermMap> state_updates_;
 
   // maps states and inputs variables to next versions
   // note: the next state variables are only used
   //       on the left hand side of equalities in
   //       trans for functional transition systems
-  smt::UnorderedTermMap next_map_;
+  CopyOnWrite<smt::UnorderedTermMap> next_map_;
 
   // maps next back to curr
-  smt::UnorderedTermMap curr_map_;
+  CopyOnWrite<smt::UnorderedTermMap> curr_map_;
 
   // whether the TransitionSystem is functional
   bool functional_;
@@ -537,14 +673,43 @@ class TransitionSystem
   // in the pre-state. It is very unsound to assume the property over
   // the init or next state variables, so the associated boolean for
   // that constraint would be false
-  std::vector<std::pair<smt::Term, bool>> constraints_;
+  CopyOnWrite<std::vector<std::pair<smt::Term, bool>>> constraints_;
   ///< constraints added via
   ///< add_invar/constrain_inputs/add_constraint
 
   typedef std::vector<const smt::UnorderedTermSet *> UnorderedTermSetPtrVec;
 
+  ///< classes of symbols, see symbol_classes_
+  static constexpr uint8_t CURR_SYMBOLS = 1;
+  static constexpr uint8_t INPUT_SYMBOLS = 2;
+  static constexpr uint8_t NEXT_SYMBOLS = 4;
+  static constexpr uint8_t OTHER_SYMBOLS = 8;
+
+  ///< the classes of the symbols that each term registered with the
+  ///< system contains, so that checking a new term only visits the
+  ///< subterms that were never seen before
+  ///< cleared whenever the class of a known symbol changes
+  CopyOnWrite<TermHashMap<uint8_t>> symbol_classes_;
+
+  ///< persistent substitution caches for next() and curr()
+  ///< not shared between copies, and dropped when a state variable is
+  ///< added or after max_conversions conversions
+  ///< next() and curr() must not be called concurrently on one system
+  mutable std::shared_ptr<smt::SubstitutionWalker> next_walker_;
+  mutable std::shared_ptr<smt::SubstitutionWalker> curr_walker_;
+  mutable size_t next_conversions_ = 0;
+  mutable size_t curr_conversions_ = 0;
+  static constexpr size_t max_conversions = 1 << 16;
+
   // helpers and checkers
 
+  /** Add a conjunct to the transition relation */
+  void add_trans_conjunct(const smt::Term & conjunct)
+  {
+    trans_conjuncts_.mut().push_back(conjunct);
+    trans_ = nullptr;
+  }
+
   /** Returns true iff all symbols in term are present in at least one of the
    * term sets
    *  @param term the term to check
@@ -552,7 +717,49 @@ class TransitionSystem
    * term
    *  @return true iff all symbols in term are in at least one of the term sets
    */
-  bool contains(const smt::Term & term, UnorderedTermSetPtrVec term_sets) const;
+  bool contains(const smt::Term & term,
+                const UnorderedTermSetPtrVec & term_sets) const;
+
+  /** @return the class of a symbolic constant */
+  uint8_t symbol_class(const smt::Term & sym) const;
+
+  /** Compute the classes of the symbols in a term
+   *  Looks up the subterms in symbol_classes_ and memo, and only adds
+   *  to memo.
+   *  @param term the term
+   *  @param memo the classes of the other visited subterms
+   *  @return the union of the classes of the symbols in term
+   */
+  uint8_t compute_symbol_classes(const smt::Term & term,
+                                 TermHashMap<uint8_t> & memo) const;
+
+  /** Compute the classes of the symbols in a term and cache them in
+   *  symbol_classes_. Called on the terms added to the system, before
+   *  checking them.
+   */
+  void classify(const smt::Term & term)
+  {
+    compute_symbol_classes(term, symbol_classes_.mut());
+  }
+
+  /** @return the walker for next() or curr(), created if the cached one
+   *          is missing, shared with a copy, or used too many times
+   *  @param walker the cached walker
+   *  @param conversions the number of conversions with the cached walker
+   *  @param map the substitution of the walker
+   */
+  smt::SubstitutionWalker & conversion_walker(
+      std::shared_ptr<smt::SubstitutionWalker> & walker,
+      size_t & conversions,
+      const smt::UnorderedTermMap & map) const;
+
+  /** Clear the cache if the class of a symbol is about to change */
+  void reclassify(const smt::Term & sym)
+  {
+    if (symbol_classes_->find(sym) != symbol_classes_->end()) {
+      symbol_classes_.reset();
+    }
+  }
 
   /* Returns true iff all the symbols in the formula are known */
   virtual bool known_symbols(const smt::Term & term) const;
@@ -26,8 +26,20 @@ using namespace std;
 
 namespace pono {
 
+// default maximum number of unrolled subterms kept across calls
+static const size_t default_term_cache_limit = 1 << 20;
+
 Unroller::Unroller(const TransitionSystem & ts, const string & time_identifier)
-  : ts_(ts), solver_(ts.solver()), time_id_(time_identifier)
+  : ts_(ts),
+    solver_(ts.solver()),
+    time_id_(time_identifier),
+    term_cache_uses_(0),
+    num_cached_terms_(0),
+    term_cache_limit_(default_term_cache_limit),
+    window_(0),
+    latest_time_(0),
+    evict_from_(0),
+    num_evictions_(0)
 {
   num_vars_ = ts_.statevars().size();
   num_vars_ += ts_.inputvars().size();
@@ -42,10 +54,145 @@ Term Unroller::at_time(const Term & t, unsigned int k)
   // if t is a variable, it will be cached
   auto it = cache.find(t);
   if (it != cache.end()) {
-    return it->second;
+    Term res = it->second;
+    evict_old_time_steps(k);
+    return res;
+  }
+
+  unroll_terms({ t }, k);
+  Term res = cached_at_time(t, k);
+  if (k < init_constants_.size()) {
+    res = init_simplifier_->simplify(res);
   }
+  evict_term_caches(k);
+  evict_old_time_steps(k);
+  return res;
+}
 
-  return solver_->substitute(t, cache);
+TermVec Unroller::at_time(const TermVec & terms, unsigned int k)
+{
+  unroll_terms(terms, k);
+  TermVec res;
+  res.reserve(terms.size());
+  for (const auto & t : terms) {
+    res.push_back(cached_at_time(t, k));
+    if (k < init_constants_.size()) {
+      res.back() = init_simplifier_->simplify(res.back());
+    }
+  }
+  evict_term_caches(k);
+  evict_old_time_steps(k);
+  return res;
+}
+
+void Unroller::set_term_cache_limit(size_t limit)
+{
+  term_cache_limit_ = limit;
+  for (size_t i = 0; i < term_cache_.size(); ++i) {
+    evict_term_caches(i);
+  }
+}
+
+void Unroller::set_init_constants(size_t depth)
+{
+  assert(time_cache_.empty());
+  init_constants_.clear();
+  if (!depth) {
+    init_simplifier_.reset();
+    return;
+  }
+
+  UnorderedTermMap values;
+  TermVec conjuncts;
+  conjunctive_partition(ts_.init(), conjuncts, false);
+  for (const auto & conj : conjuncts) {
+    Op op = conj->get_op();
+    if (ts_.is_curr_var(conj)) {
+      values.emplace(conj, solver_->make_term(true));
+    } else if (op == Not && ts_.is_curr_var(*conj->begin())) {
+      values.emplace(*conj->begin(), solver_->make_term(false));
+    } else if (op == Equal) {
+      TermVec ch(conj->begin(), conj->end());
+      for (size_t i = 0; i < 2; ++i) {
+        if (ts_.is_curr_var(ch[i]) && ch[1 - i]->is_value()) {
+          values.emplace(ch[i], ch[1 - i]);
+        }
+      }
+    }
+  }
+
+  // values at the next time step from the state updates
+  while (values.size() && init_constants_.size() < depth) {
+    init_constants_.push_back(values);
+    TermSimplifier simplifier(solver_, init_constants_.back());
+    values.clear();
+    for (const auto & elem : ts_.state_updates()) {
+      Term val = simplifier.simplify(elem.second);
+      if (val->is_value()) {
+        values.emplace(elem.first, val);
+      }
+    }
+  }
+  init_simplifier_.reset(new TermSimplifier(solver_));
+}
+
+void Unroller::set_window(size_t window)
+{
+  window_ = window;
+  evict_old_time_steps(latest_time_);
+}
+
+size_t Unroller::num_cache_entries() const
+{
+  size_t n = untime_cache_.size() + var_times_.size() + num_cached_terms_;
+  for (const auto & m : time_cache_) {
+    n += m.size();
+  }
+  for (const auto & m : time_var_map_) {
+    n += m.size();
+  }
+  return n;
+}
+
+size_t Unroller::cache_memory() const
+{
+  // a node of an unordered map holds the pair and the next pointer, and
+  // the buckets are one pointer each
+  const size_t term_pair = sizeof(Term) + sizeof(Term) + sizeof(void *);
+  const size_t time_pair = sizeof(Term) + sizeof(size_t) + sizeof(void *);
+  size_t bytes = 0;
+  auto map_bytes = [&](const UnorderedTermMap & m) {
+    bytes += m.size() * term_pair + m.bucket_count() * sizeof(void *);
+  };
+  for (const auto * caches : { &time_cache_, &time_var_map_ }) {
+    bytes += caches->capacity() * sizeof(UnorderedTermMap);
+    for (const auto & m : *caches) {
+      map_bytes(m);
+    }
+  }
+  // the flat term caches hold their slots in one array
+  for (const auto & m : term_cache_) {
+    bytes += m.memory();
+  }
+  bytes += (term_cache_.capacity() - term_cache_.size())
+           * sizeof(TermHashMap<Term>);
+  map_bytes(untime_cache_);
+  bytes += var_times_.size() * time_pair
+           + var_times_.bucket_count() * sizeof(void *);
+  return bytes;
+}
+
+void Unroller::report_statistics(Statistics & stats) const
+{
+  stats.set("unroller_time_steps", time_cache_.size());
+  stats.set("unroller_cached_terms", num_cached_terms_);
+  stats.set("unroller_cache_entries", num_cache_entries());
+  stats.set("unroller_cache_bytes", cache_memory());
+  stats.set("unroller_evicted_time_steps", num_evictions_);
+  if (init_constants_.size()) {
+    stats.set("unroller_init_constant_steps", init_constants_.size());
+    stats.set("unroller_init_constants", init_constants_[0].size());
+  }
 }
 
 Term Unroller::untime(const Term & t) const
@@ -53,6 +200,65 @@ Term Unroller::untime(const Term & t) const
   return solver_->substitute(t, untime_cache_);
 }
 
+Term Unroller::shift(const Term & t, unsigned int from, unsigned int to)
+{
+  if (from == to) {
+    return t;
+  }
+
+  // post-order traversal as in unroll_terms, the unrolled variables are
+  // mapped with untime_cache_ and time_var_map_ instead of a substitution
+  // to the untimed variables and another one back
+  TermHashMap<Term> cache;
+  TermVec to_visit({ t });
+  TermVec children;
+  while (to_visit.size()) {
+    Term cur = to_visit.back();
+    if (cache.find(cur) != cache.end()) {
+      to_visit.pop_back();
+      continue;
+    }
+
+    if (cur->get_op().is_null()) {
+      to_visit.pop_back();
+      auto it = var_times_.find(cur);
+      if (it == var_times_.end()) {
+        // values and other symbols stay the same
+        cache[cur] = cur;
+      } else if (it->second + to < from) {
+        throw PonoException("Cannot shift " + cur->to_string() + " from time "
+                            + std::to_string(from) + " to time "
+                            + std::to_string(to));
+      } else {
+        cache[cur] =
+            var_at_time(untime_cache_.at(cur), it->second - from + to);
+      }
+      continue;
+    }
+
+    bool children_done = true;
+    for (const auto & c : cur) {
+      if (cache.find(c) == cache.end()) {
+        to_visit.push_back(c);
+        children_done = false;
+      }
+    }
+    if (!children_done) {
+      continue;
+    }
+
+    to_visit.pop_back();
+    children.clear();
+    bool changed = false;
+    for (const auto & c : cur) {
+      children.push_back(cache.at(c));
+      changed |= (children.back() != c);
+    }
+    cache[cur] = changed ? solver_->make_term(cur->get_op(), children) : cur;
+  }
+  return cache.at(t);
+}
+
 size_t Unroller::get_var_time(const Term & v) const
 {
   auto it = var_times_.find(v);
@@ -105,24 +311,160 @@ Term Unroller::var_at_time(const Term & v, unsigned int k)
   return timed_v;
 }
 
-UnorderedTermMap & Unroller::var_cache_at_time(unsigned int k)
+void Unroller::unroll_terms(const TermVec & terms, unsigned int k)
 {
-  while (time_cache_.size() <= k) {
-    time_cache_.push_back(UnorderedTermMap());
-    UnorderedTermMap & subst = time_cache_.back();
-    const unsigned int t = time_cache_.size() - 1;
+  const UnorderedTermMap & vars = var_cache_at_time(k);
+  while (term_cache_.size() <= k) {
+    term_cache_.emplace_back();
+    term_cache_last_use_.push_back(0);
+  }
+  TermHashMap<Term> & cache = term_cache_[k];
+  term_cache_last_use_[k] = ++term_cache_uses_;
 
-    for (auto v : ts_.statevars()) {
-      Term vn = ts_.next(v);
-      Term new_v = var_at_time(v, t);
-      Term new_vn = var_at_time(v, t + 1);
-      subst[v] = new_v;
-      subst[vn] = new_vn;
+  // post-order traversal, children are unrolled before their parents
+  TermVec to_visit(terms.begin(), terms.end());
+  TermHashSet visited;
+  TermVec children;
+  while (to_visit.size()) {
+    Term t = to_visit.back();
+    if (t->get_op().is_null() || vars.find(t) != vars.end()
+        || cache.find(t) != cache.end()) {
+      // leaves that are not variables stay the same (e.g. values or
+      // already unrolled variables)
+      to_visit.pop_back();
+      continue;
     }
-    for (auto v : ts_.inputvars()) {
-      Term new_v = var_at_time(v, t);
-      subst[v] = new_v;
+
+    if (visited.insert(t).second) {
+      for (const auto & c : t) {
+        to_visit.push_back(c);
+      }
+      continue;
     }
+
+    to_visit.pop_back();
+    children.clear();
+    bool changed = false;
+    for (const auto & c : t) {
+      children.push_back(cached_at_time(c, k));
+      changed |= (children.back() != c);
+    }
+    cache[t] = changed ? solver_->make_term(t->get_op(), children) : t;
+    ++num_cached_terms_;
+  }
+}
+
+Term Unroller::cached_at_time(const Term & t, unsigned int k) const
+{
+  const UnorderedTermMap & vars = time_cache_.at(k);
+  auto it = vars.find(t);
+  if (it != vars.end()) {
+    return it->second;
+  }
+
+  const TermHashMap<Term> & cache = term_cache_.at(k);
+  auto cit = cache.find(t);
+  if (cit != cache.end()) {
+    return cit->second;
+  }
+
+  assert(t->get_op().is_null());
+  return t;
+}
+
+void Unroller::evict_term_caches(unsigned int k)
+{
+  while (num_cached_terms_ > term_cache_limit_) {
+    // least recently used non-empty time step, k is dropped last
+    size_t lru = k;
+    for (size_t i = 0; i < term_cache_.size(); ++i) {
+      if (i != k && term_cache_[i].size()
+          && (lru == k
+              || term_cache_last_use_[i] < term_cache_last_use_[lru])) {
+        lru = i;
+      }
+    }
+
+    num_cached_terms_ -= term_cache_[lru].size();
+    term_cache_[lru].clear();
+    if (lru == k) {
+      break;
+    }
+  }
+}
+
+void Unroller::clear_term_caches()
+{
+  for (auto & cache : term_cache_) {
+    cache.clear();
+  }
+  num_cached_terms_ = 0;
+}
+
+void Unroller::fill_var_cache(unsigned int t)
+{
+  UnorderedTermMap & subst = time_cache_[t];
+  // the state variables with a value at a time step are replaced by it
+  auto timed = [&](const Term & v, unsigned int k) {
+    if (k < init_constants_.size()) {
+      auto it = init_constants_[k].find(v);
+      if (it != init_constants_[k].end()) {
+        return it->second;
+      }
+    }
+    return var_at_time(v, k);
+  };
+  for (auto v : ts_.statevars()) {
+    subst[v] = timed(v, t);
+    subst[ts_.next(v)] = timed(v, t + 1);
+  }
+  for (auto v : ts_.inputvars()) {
+    subst[v] = var_at_time(v, t);
+  }
+}
+
+void Unroller::evict_old_time_steps(unsigned int k)
+{
+  latest_time_ = std::max(latest_time_, k);
+  if (!window_ || latest_time_ <= window_) {
+    return;
+  }
+
+  unsigned int end = std::min<size_t>(latest_time_ - window_,
+                                      time_cache_.size());
+  for (unsigned int t = evict_from_; t < end; ++t) {
+    if (t == k || evicted_[t]) {
+      continue;
+    }
+    // use swap to release the memory of the buckets as well
+    UnorderedTermMap().swap(time_cache_[t]);
+    if (t < term_cache_.size()) {
+      num_cached_terms_ -= term_cache_[t].size();
+      TermHashMap<Term>().swap(term_cache_[t]);
+    }
+    evicted_[t] = true;
+    ++num_evictions_;
+  }
+  // k can only be dropped by a later call
+  evict_from_ = (k < end) ? k : end;
+}
+
+void Unroller::restored_time_step(unsigned int t)
+{
+  evicted_[t] = false;
+  evict_from_ = std::min(evict_from_, t);
+}
+
+UnorderedTermMap & Unroller::var_cache_at_time(unsigned int k)
+{
+  while (time_cache_.size() <= k) {
+    time_cache_.push_back(UnorderedTermMap());
+    evicted_.push_back(false);
+    fill_var_cache(time_cache_.size() - 1);
+  }
+  if (evicted_[k]) {
+    fill_var_cache(k);
+    restored_time_step(k);
   }
 
   UnorderedTermMap & var_cache = time_cache_[k];
@@ -133,21 +475,12 @@ UnorderedTermMap & Unroller::var_cache_at_time(unsigned int k)
   // timed-var-term-map
   if (current_num_vars > num_vars_) {
     num_vars_ = current_num_vars;
-    size_t t = 0;
-    for (UnorderedTermMap & st : time_cache_) {
-      for (auto v : ts_.statevars()) {
-        Term vn = ts_.next(v);
-        Term new_v = var_at_time(v, t);
-        Term new_vn = var_at_time(v, t + 1);
-        st[v] = new_v;
-        st[vn] = new_vn;
-      }
-      for (auto v : ts_.inputvars()) {
-        Term new_v = var_at_time(v, t);
-        st[v] = new_v;
+    // cached subterms might contain the new variables
+    clear_term_caches();
+    for (size_t t = 0; t < time_cache_.size(); ++t) {
+      if (!evicted_[t]) {
+        fill_var_cache(t);
       }
-
-      ++t;
     }
   }
 
@@ -16,7 +16,12 @@
 
 #pragma once
 
+#include <memory>
+
 #include "core/ts.h"
+#include "utils/statistics.h"
+#include "utils/term_hash_map.h"
+#include "utils/term_walkers.h"
 
 #include "smt-switch/smt.h"
 
@@ -50,8 +55,93 @@ class Unroller
    */
   virtual smt::Term at_time(const smt::Term & t, unsigned int k);
 
+  /** Return unrolled versions of several terms at time k
+   *  Uses a single traversal for all the terms, so shared subterms
+   *  are only unrolled once.
+   *
+   *  @param terms the terms to unroll
+   *  @param k the time to unroll the terms at
+   *  @return the unrolled terms in the same order
+   */
+  virtual smt::TermVec at_time(const smt::TermVec & terms, unsigned int k);
+
+  /** Set the maximum number of unrolled subterms kept in the caches
+   *  Unrolled subterms are cached per time step so that unrolling the
+   *  same term (e.g. trans) again, or terms sharing subterms, does not
+   *  traverse them again. Once the limit is exceeded, the caches of the
+   *  least recently used time steps are dropped.
+   *  @param limit the maximum number of cached subterms, 0 disables
+   *         the cache across calls
+   */
+  void set_term_cache_limit(size_t limit);
+
+  /** @return the number of unrolled subterms currently cached */
+  size_t num_cached_terms() const { return num_cached_terms_; }
+
+  /** Only keep the caches of the latest time steps
+   *  For callers that only unroll at the latest time steps (e.g. a forward
+   *  BMC). The variable and term caches of the time steps more than window
+   *  steps before the latest time used are dropped, and rebuilt if the
+   *  time step is used again. The timed variables themselves (and their
+   *  untime and time maps) are kept, they are owned by the solver anyway.
+   *  @param window the number of time steps to keep before the latest one,
+   *         0 keeps all of them
+   */
+  void set_window(size_t window);
+
+  /** Replace the state variables by their values in the first time
+   *  steps where init determines them
+   *  The values at time 0 are the conjuncts v = value of init, and a
+   *  state variable has a value at time t + 1 if its state update
+   *  simplifies to a value with the values at time t. The terms
+   *  unrolled at these time steps are simplified.
+   *  Only for unrollings that assert init at time 0 and trans between
+   *  consecutive time steps (e.g. BMC), must be called before unrolling.
+   *  @param depth the number of time steps to propagate the values to
+   */
+  void set_init_constants(size_t depth);
+
+  /** @return the number of state variables replaced by a value at time k
+   */
+  size_t num_init_constants(unsigned int k) const
+  {
+    return k < init_constants_.size() ? init_constants_[k].size() : 0;
+  }
+
+  /** @return the number of entries in all the caches of the unroller */
+  size_t num_cache_entries() const;
+
+  /** @return an estimate of the memory used by the caches in bytes, not
+   *          counting the terms themselves
+   */
+  size_t cache_memory() const;
+
+  /** Set the counters of the caches in stats, prefixed by "unroller_" */
+  void report_statistics(Statistics & stats) const;
+
+  /** Drop all the term caches, e.g. when variables are added or to
+   *  reduce the memory, they are rebuilt on demand
+   */
+  void clear_term_caches();
+
   smt::Term untime(const smt::Term & t) const;
 
+  /** Move an unrolled term in time, in one traversal
+   *  Equivalent to at_time(untime(t), to) for a term over the variables
+   *  of a single time step from, and more generally replaces every
+   *  unrolled variable at time k by the same variable at time
+   *  k - from + to. Unlike at_time, the init constants (see
+   *  set_init_constants) are not applied.
+   *  example: shift(x@4 + y@5, 4, 0) = x@0 + y@1
+   *  @param t the unrolled term
+   *  @param from the time of t
+   *  @param to the new time
+   *  @return the shifted term
+   *  @throws PonoException if t has a variable at a time k with
+   *          k + to < from
+   */
+  smt::Term shift(const smt::Term & t, unsigned int from, unsigned int to);
+
   /** Returns the time of an unrolled variable
    *  example: get_var_time(x@4) = 4
    *  this only works for unrolled variables
@@ -78,6 +168,31 @@ class Unroller
   smt::Term var_at_time(const smt::Term & v, unsigned int k);
   virtual smt::UnorderedTermMap & var_cache_at_time(unsigned int k);
 
+  /** Unroll all the terms at time k into the term cache of time k
+   *  The results can then be read with cached_at_time.
+   */
+  void unroll_terms(const smt::TermVec & terms, unsigned int k);
+
+  /** @return t at time k, requires t to be unrolled at time k already */
+  smt::Term cached_at_time(const smt::Term & t, unsigned int k) const;
+
+  /** Drop the term caches of least recently used time steps until
+   *  the number of cached terms is within the limit
+   *  @param k the time step that was just used, dropped last
+   */
+  void evict_term_caches(unsigned int k);
+
+  /** Fill the variable cache of time step t with the timed variables */
+  void fill_var_cache(unsigned int t);
+
+  /** Drop the caches of the time steps outside of the window
+   *  @param k the time step that was just used, never dropped
+   */
+  void evict_old_time_steps(unsigned int k);
+
+  /** Mark time step t as rebuilt after it was dropped */
+  void restored_time_step(unsigned int t);
+
   const TransitionSystem & ts_;
   const smt::SmtSolver solver_;
   const std::string time_id_;
@@ -86,11 +201,29 @@ class Unroller
   TimeCache time_cache_;
   TimeCache time_var_map_;
   smt::UnorderedTermMap untime_cache_;
+
+  ///< unrolled non-variable subterms per time step
+  std::vector<TermHashMap<smt::Term>> term_cache_;
+  std::vector<size_t> term_cache_last_use_;  ///< for evicting term_cache_
+  size_t term_cache_uses_;   ///< number of accesses to term_cache_
+  size_t num_cached_terms_;  ///< total size of term_cache_
+  size_t term_cache_limit_;  ///< maximum size of term_cache_
   std::unordered_map<smt::Term, size_t> var_times_;
 
+  size_t window_;             ///< number of time steps kept, 0 for all
+  unsigned int latest_time_;  ///< latest time step used
+  unsigned int evict_from_;   ///< earliest time step that might be kept
+  std::vector<bool> evicted_;  ///< the caches of this time step are dropped
+  size_t num_evictions_;       ///< number of time steps dropped
+
   size_t num_vars_;  ///< the last known number of variables in the transition
                      ///< system
 
+  ///< values of the state variables at the first time steps
+  std::vector<smt::UnorderedTermMap> init_constants_;
+  ///< simplifies the terms unrolled at these time steps
+  std::unique_ptr<TermSimplifier> init_simplifier_;
+
 };  // class Unroller
 
 }  // namespace pono
@@ -0,0 +1,669 @@
+/*********************                                                        */
+/*! \file bdd_reach.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Symbolic forward reachability with BDDs (CUDD), for small
+**        control-dominated systems.
+**
+**/
+
+#include "engines/bdd_reach.h"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+#include "assert.h"
+#include "printers/witness_values.h"
+#include "utils/logger.h"
+#include "utils/timeline.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+// a cluster of partitions is closed once it has this many nodes
+static const int cluster_node_limit = 2500;
+
+/** Termination callback of CUDD, polled during long operations */
+static int bdd_terminate(const void * arg)
+{
+  return static_cast<Budget *>(const_cast<void *>(arg))->exhausted();
+}
+
+/** @return the number of bits of a boolean or bit-vector sort, 0 otherwise */
+static size_t num_bits(const Sort & sort)
+{
+  SortKind sk = sort->get_sort_kind();
+  if (sk == BOOL) {
+    return 1;
+  } else if (sk == BV) {
+    return sort->get_width();
+  }
+  return 0;
+}
+
+BddReach::BddReach(const Property & p,
+                   const TransitionSystem & ts,
+                   const SmtSolver & solver,
+                   PonoOptions opt)
+    : super(p, ts, solver, opt), gave_up_(false)
+{
+  engine_ = Engine::BDD_REACH;
+}
+
+BddReach::~BddReach()
+{
+  // the BDDs must be freed before their manager
+  cache_.clear();
+  var_bits_.clear();
+  next_bits_.clear();
+  partitions_.clear();
+  clusters_.clear();
+  quantify_.clear();
+  curr_vars_.clear();
+  next_vars_.clear();
+  input_vars_.clear();
+  rings_.clear();
+  constraints_ = BDD();
+  constrained_ = BDD();
+  init_ = BDD();
+  bad_bdd_ = BDD();
+  reached_ = BDD();
+}
+
+void BddReach::initialize()
+{
+  if (initialized_) {
+    return;
+  }
+  super::initialize();
+
+  TIMELINE_SPAN("bdd_encode");
+  try {
+    gave_up_ = !encode();
+    if (!gave_up_) {
+      build_clusters();
+    }
+  }
+  catch (std::logic_error & e) {
+    // errors of CUDD, e.g. too many nodes
+    logger.log(1, "BDD: giving up while encoding the system, {}", e.what());
+    gave_up_ = true;
+  }
+  // the bits of the terms are not needed anymore
+  cache_.clear();
+}
+
+ProverResult BddReach::check_until(int k)
+{
+  initialize();
+  if (gave_up_) {
+    return ProverResult::UNKNOWN;
+  }
+
+  try {
+    while (reached_k_ < k) {
+      int i = reached_k_ + 1;
+      if (interrupted()) {
+        logger.log(1, "BDD: interrupted at bound {}", i);
+        return ProverResult::UNKNOWN;
+      }
+
+      if (rings_.empty()) {
+        reached_ = init_;
+        rings_.push_back(init_);
+      } else {
+        BDD img = image(rings_.back()) & constrained_;
+        BDD fresh = img & !reached_;
+        stats_->increment("bdd_images");
+        if (fresh.IsZero()) {
+          logger.log(1, "BDD: fixed point after {} steps", i - 1);
+          invar_ = to_term(reached_);
+          return ProverResult::TRUE;
+        }
+        reached_ |= fresh;
+        rings_.push_back(fresh);
+      }
+
+      size_t nodes = mgr_->ReadNodeCount();
+      stats_->set("bdd_nodes", max<size_t>(stats_->get("bdd_nodes"), nodes));
+      logger.log(2, "BDD: step {}, {} live nodes", i, nodes);
+
+      if (!(rings_.back() & bad_bdd_).IsZero()) {
+        compute_bdd_witness(i);
+        return ProverResult::FALSE;
+      }
+      reached_k_ = i;
+      checkpoint();
+    }
+  }
+  catch (std::logic_error & e) {
+    logger.log(1, "BDD: giving up at bound {}, {}", reached_k_ + 1, e.what());
+    gave_up_ = true;
+  }
+  return ProverResult::UNKNOWN;
+}
+
+bool BddReach::encode()
+{
+  if (!ts_.is_functional()) {
+    logger.log(1, "BDD: only functional systems are supported");
+    return false;
+  }
+
+  mgr_.reset(new Cudd());
+  DdManager * dd = mgr_->getManager();
+  // operations over the limit fail, and the C++ interface throws
+  Cudd_SetMaxLive(dd, options_.bdd_node_limit_);
+  mgr_->RegisterTerminationCallback(bdd_terminate, &budget_);
+  mgr_->AutodynEnable(CUDD_REORDER_GROUP_SIFT);
+
+  // sort the variables for a deterministic initial order
+  auto by_name = [](const Term & a, const Term & b) {
+    return a->to_string() < b->to_string();
+  };
+  TermVec states(ts_.statevars().begin(), ts_.statevars().end());
+  TermVec inputs(ts_.inputvars().begin(), ts_.inputvars().end());
+  sort(states.begin(), states.end(), by_name);
+  sort(inputs.begin(), inputs.end(), by_name);
+
+  for (const auto & sv : states) {
+    size_t width = num_bits(sv->get_sort());
+    if (!width) {
+      logger.log(1, "BDD: unsupported sort of {}", sv);
+      return false;
+    }
+    BddVec & cur = var_bits_[sv];
+    BddVec & next = next_bits_[sv];
+    for (size_t j = 0; j < width; ++j) {
+      cur.push_back(mgr_->bddVar());
+      next.push_back(mgr_->bddVar());
+      unsigned int idx = cur.back().NodeReadIndex();
+      // reorder the current and next state bit as a group
+      // (the last argument is MTR_DEFAULT)
+      Cudd_MakeTreeNode(dd, idx, 2, 0);
+      index_bit_[idx] = { sv, j };
+      curr_vars_.push_back(cur.back());
+      next_vars_.push_back(next.back());
+    }
+  }
+  for (const auto & iv : inputs) {
+    size_t width = num_bits(iv->get_sort());
+    if (!width) {
+      logger.log(1, "BDD: unsupported sort of {}", iv);
+      return false;
+    }
+    BddVec & cur = var_bits_[iv];
+    for (size_t j = 0; j < width; ++j) {
+      cur.push_back(mgr_->bddVar());
+      input_vars_.push_back(cur.back());
+    }
+  }
+  stats_->set("bdd_vars", mgr_->ReadSize());
+
+  constraints_ = mgr_->bddOne();
+  for (const auto & c : ts_.constraints()) {
+    BddVec b = bits(c.first);
+    if (b.empty()) {
+      return false;
+    }
+    constraints_ &= b[0];
+  }
+  constrained_ = constraints_.ExistAbstract(mgr_->computeCube(input_vars_));
+
+  for (const auto & elem : ts_.state_updates()) {
+    BddVec b = bits(elem.second);
+    if (b.empty()) {
+      return false;
+    }
+    const BddVec & next = next_bits_.at(elem.first);
+    assert(b.size() == next.size());
+    for (size_t j = 0; j < b.size(); ++j) {
+      partitions_.push_back(next[j].Xnor(b[j]));
+    }
+  }
+
+  BddVec init = bits(ts_.init());
+  BddVec bad = bits(bad_);
+  if (init.empty() || bad.empty()) {
+    return false;
+  }
+  init_ = init[0] & constrained_;
+  bad_bdd_ = bad[0] & constrained_;
+  return true;
+}
+
+BddReach::BddVec BddReach::bits(const Term & t)
+{
+  TermVec to_visit({ t });
+  while (to_visit.size()) {
+    Term cur = to_visit.back();
+    if (cache_.find(cur) != cache_.end()) {
+      to_visit.pop_back();
+      continue;
+    }
+
+    size_t width = num_bits(cur->get_sort());
+    if (!width) {
+      logger.log(1, "BDD: unsupported sort of {}", cur);
+      return {};
+    }
+
+    auto it = var_bits_.find(cur);
+    if (it != var_bits_.end()) {
+      cache_[cur] = it->second;
+      to_visit.pop_back();
+      continue;
+    }
+
+    if (cur->is_value()) {
+      string v = value_bits(cur);
+      BddVec & b = cache_[cur];
+      for (auto c = v.rbegin(); c != v.rend(); ++c) {
+        b.push_back(*c == '1' ? mgr_->bddOne() : mgr_->bddZero());
+      }
+      to_visit.pop_back();
+      continue;
+    }
+
+    Op op = cur->get_op();
+    if (op.is_null()) {
+      // e.g. a next state variable or an uninterpreted function
+      logger.log(1, "BDD: unsupported symbol {}", cur);
+      return {};
+    }
+
+    bool ready = true;
+    for (const auto & c : *cur) {
+      if (cache_.find(c) == cache_.end()) {
+        ready = false;
+        to_visit.push_back(c);
+      }
+    }
+    if (!ready) {
+      continue;
+    }
+    to_visit.pop_back();
+
+    vector<BddVec> args;
+    for (const auto & c : *cur) {
+      args.push_back(cache_.at(c));
+    }
+    BddVec res = bits_of_op(cur, args);
+    if (res.empty()) {
+      logger.log(1, "BDD: unsupported operator {}", op.to_string());
+      return {};
+    }
+    assert(res.size() == width);
+    cache_[cur] = res;
+  }
+  return cache_.at(t);
+}
+
+BddReach::BddVec BddReach::bits_of_op(const Term & t,
+                                      const vector<BddVec> & args)
+{
+  Op op = t->get_op();
+  PrimOp po = op.prim_op;
+  BDD one = mgr_->bddOne();
+  BDD zero = mgr_->bddZero();
+
+  auto bitwise = [&](function<BDD(const BDD &, const BDD &)> f) {
+    BddVec res = args[0];
+    for (size_t i = 1; i < args.size(); ++i) {
+      for (size_t j = 0; j < res.size(); ++j) {
+        res[j] = f(res[j], args[i][j]);
+      }
+    }
+    return res;
+  };
+  auto negate = [](BddVec v) {
+    for (auto & b : v) {
+      b = !b;
+    }
+    return v;
+  };
+  auto add = [&](const BddVec & a, const BddVec & b, BDD carry) {
+    BddVec res;
+    for (size_t j = 0; j < a.size(); ++j) {
+      res.push_back(a[j] ^ b[j] ^ carry);
+      carry = (a[j] & b[j]) | (carry & (a[j] ^ b[j]));
+    }
+    return res;
+  };
+  auto equal = [&](const BddVec & a, const BddVec & b) {
+    BDD res = one;
+    for (size_t j = 0; j < a.size(); ++j) {
+      res &= a[j].Xnor(b[j]);
+    }
+    return res;
+  };
+  // a < b unsigned, from the least significant bit up
+  auto ult = [&](const BddVec & a, const BddVec & b) {
+    BDD lt = zero;
+    for (size_t j = 0; j < a.size(); ++j) {
+      lt = (!a[j] & b[j]) | (a[j].Xnor(b[j]) & lt);
+    }
+    return lt;
+  };
+  // flip the sign bits for the signed comparisons
+  auto flip_sign = [](BddVec v) {
+    v.back() = !v.back();
+    return v;
+  };
+  // shift by a variable amount, one stage per bit of the amount
+  auto shift = [&](const BddVec & a, const BddVec & b, bool left, bool arith) {
+    size_t w = a.size();
+    BDD fill = arith ? a.back() : zero;
+    BddVec res = a;
+    BDD too_far = zero;
+    for (size_t s = 0; s < b.size(); ++s) {
+      if (s >= 64 || (size_t(1) << s) >= w) {
+        too_far |= b[s];
+        continue;
+      }
+      size_t dist = size_t(1) << s;
+      BddVec shifted(w, fill);
+      for (size_t j = 0; j < w; ++j) {
+        if (left && j >= dist) {
+          shifted[j] = res[j - dist];
+        } else if (!left && j + dist < w) {
+          shifted[j] = res[j + dist];
+        }
+      }
+      for (size_t j = 0; j < w; ++j) {
+        res[j] = b[s].Ite(shifted[j], res[j]);
+      }
+    }
+    for (size_t j = 0; j < w; ++j) {
+      res[j] = too_far.Ite(fill, res[j]);
+    }
+    return res;
+  };
+
+  switch (po) {
+    case Not:
+    case BVNot: return negate(args[0]);
+    case And:
+    case BVAnd:
+      return bitwise([](const BDD & a, const BDD & b) { return a & b; });
+    case Or:
+    case BVOr:
+      return bitwise([](const BDD & a, const BDD & b) { return a | b; });
+    case Xor:
+    case BVXor:
+      return bitwise([](const BDD & a, const BDD & b) { return a ^ b; });
+    case BVNand: return negate(bitwise([](const BDD & a, const BDD & b) {
+      return a & b;
+    }));
+    case BVNor: return negate(bitwise([](const BDD & a, const BDD & b) {
+      return a | b;
+    }));
+    case BVXnor:
+      return bitwise([](const BDD & a, const BDD & b) { return a.Xnor(b); });
+    case Implies: return { !args[0][0] | args[1][0] };
+    case Equal:
+    case BVComp: {
+      BDD res = one;
+      for (size_t i = 1; i < args.size(); ++i) {
+        res &= equal(args[0], args[i]);
+      }
+      return { res };
+    }
+    case Distinct: {
+      if (args.size() != 2) {
+        return {};
+      }
+      return { !equal(args[0], args[1]) };
+    }
+    case Ite: {
+      BddVec res;
+      for (size_t j = 0; j < args[1].size(); ++j) {
+        res.push_back(args[0][0].Ite(args[1][j], args[2][j]));
+      }
+      return res;
+    }
+    case BVNeg: return add(negate(args[0]), BddVec(args[0].size(), zero), one);
+    case BVAdd: {
+      BddVec res = args[0];
+      for (size_t i = 1; i < args.size(); ++i) {
+        res = add(res, args[i], zero);
+      }
+      return res;
+    }
+    case BVSub: return add(args[0], negate(args[1]), one);
+    case BVUlt: return { ult(args[0], args[1]) };
+    case BVUle: return { !ult(args[1], args[0]) };
+    case BVUgt: return { ult(args[1], args[0]) };
+    case BVUge: return { !ult(args[0], args[1]) };
+    case BVSlt: return { ult(flip_sign(args[0]), flip_sign(args[1])) };
+    case BVSle: return { !ult(flip_sign(args[1]), flip_sign(args[0])) };
+    case BVSgt: return { ult(flip_sign(args[1]), flip_sign(args[0])) };
+    case BVSge: return { !ult(flip_sign(args[0]), flip_sign(args[1])) };
+    case Concat: {
+      // the first argument is the most significant
+      BddVec res;
+      for (auto a = args.rbegin(); a != args.rend(); ++a) {
+        res.insert(res.end(), a->begin(), a->end());
+      }
+      return res;
+    }
+    case Extract:
+      return BddVec(args[0].begin() + op.idx1, args[0].begin() + op.idx0 + 1);
+    case Zero_Extend: {
+      BddVec res = args[0];
+      res.resize(res.size() + op.idx0, zero);
+      return res;
+    }
+    case Sign_Extend: {
+      BddVec res = args[0];
+      res.resize(res.size() + op.idx0, args[0].back());
+      return res;
+    }
+    case Repeat: {
+      BddVec res;
+      for (size_t i = 0; i < op.idx0; ++i) {
+        res.insert(res.end(), args[0].begin(), args[0].end());
+      }
+      return res;
+    }
+    case Rotate_Left:
+    case Rotate_Right: {
+      size_t w = args[0].size();
+      size_t r = op.idx0 % w;
+      if (po == Rotate_Right) {
+        r = (w - r) % w;
+      }
+      BddVec res(w, zero);
+      for (size_t j = 0; j < w; ++j) {
+        res[(j + r) % w] = args[0][j];
+      }
+      return res;
+    }
+    case BVShl: return shift(args[0], args[1], true, false);
+    case BVLshr: return shift(args[0], args[1], false, false);
+    case BVAshr: return shift(args[0], args[1], false, true);
+    default:
+      // multiplication, division, arithmetic over integers, arrays...
+      return {};
+  }
+}
+
+void BddReach::build_clusters()
+{
+  // conjoin consecutive partitions up to cluster_node_limit nodes
+  BDD cluster = mgr_->bddOne();
+  bool empty = true;
+  for (const auto & p : partitions_) {
+    BDD c = cluster & p;
+    if (!empty && c.nodeCount() > cluster_node_limit) {
+      clusters_.push_back(cluster);
+      cluster = p;
+    } else {
+      cluster = c;
+    }
+    empty = false;
+  }
+  if (!empty) {
+    clusters_.push_back(cluster);
+  }
+
+  // quantify each current state and input bit after the last cluster
+  // over it, and the bits of no cluster right away
+  unordered_map<unsigned int, size_t> last_use;
+  for (size_t c = 0; c < clusters_.size(); ++c) {
+    for (const auto & idx : clusters_[c].SupportIndices()) {
+      last_use[idx] = c;
+    }
+  }
+  vector<vector<BDD>> vars(max<size_t>(clusters_.size(), 1));
+  auto schedule = [&](const BDD & v) {
+    auto it = last_use.find(v.NodeReadIndex());
+    vars[it == last_use.end() ? 0 : it->second].push_back(v);
+  };
+  for (const auto & v : curr_vars_) {
+    schedule(v);
+  }
+  for (const auto & v : input_vars_) {
+    schedule(v);
+  }
+  for (const auto & vs : vars) {
+    quantify_.push_back(mgr_->computeCube(vs));
+  }
+  stats_->set("bdd_clusters", clusters_.size());
+  logger.log(1,
+             "BDD: {} variables, {} partitions in {} clusters",
+             mgr_->ReadSize(),
+             partitions_.size(),
+             clusters_.size());
+}
+
+BDD BddReach::image(const BDD & states)
+{
+  TIMELINE_SPAN("bdd_image");
+  BDD res = states & constraints_;
+  if (clusters_.empty()) {
+    res = res.ExistAbstract(quantify_[0]);
+  }
+  for (size_t c = 0; c < clusters_.size(); ++c) {
+    res = res.AndAbstract(clusters_[c], quantify_[c]);
+  }
+  // over the next state bits now
+  return res.SwapVariables(next_vars_, curr_vars_);
+}
+
+void BddReach::compute_bdd_witness(size_t k)
+{
+  vector<BDD> all_vars = curr_vars_;
+  all_vars.insert(all_vars.end(), input_vars_.begin(), input_vars_.end());
+  BDD input_cube = mgr_->computeCube(input_vars_);
+  BDD next_cube = mgr_->computeCube(next_vars_);
+
+  // a minterm over the state and input bits of each step, from the end
+  vector<BDD> steps(k + 1);
+  steps[k] = (rings_[k] & bad_bdd_ & constraints_).PickOneMinterm(all_vars);
+  for (size_t j = k; j-- > 0;) {
+    BDD succ = steps[j + 1]
+                   .ExistAbstract(input_cube)
+                   .SwapVariables(curr_vars_, next_vars_);
+    // the successor fixes the next state bits, so the partitions are small
+    BDD pred = rings_[j] & constraints_ & succ;
+    for (const auto & p : partitions_) {
+      pred &= p;
+    }
+    pred = pred.ExistAbstract(next_cube);
+    assert(!pred.IsZero());
+    steps[j] = pred.PickOneMinterm(all_vars);
+  }
+
+  witness_.clear();
+  for (size_t j = 0; j <= k; ++j) {
+    witness_.push_back(UnorderedTermMap());
+    if (!witness_step(j)) {
+      continue;
+    }
+    UnorderedTermMap & map = witness_.back();
+    for (const auto & sv : ts_.statevars()) {
+      if (witness_signal(sv->to_string())) {
+        map[sv] = var_value(steps[j], sv);
+      }
+    }
+    for (const auto & iv : ts_.inputvars()) {
+      if (witness_signal(iv->to_string())) {
+        map[iv] = var_value(steps[j], iv);
+      }
+    }
+  }
+}
+
+Term BddReach::var_value(const BDD & cube, const Term & var)
+{
+  const BddVec & b = var_bits_.at(var);
+  string v(b.size(), '0');
+  for (size_t j = 0; j < b.size(); ++j) {
+    if (!(cube & b[j]).IsZero()) {
+      v[b.size() - 1 - j] = '1';
+    }
+  }
+  Sort sort = var->get_sort();
+  if (sort->get_sort_kind() == BOOL) {
+    return solver_->make_term(v[0] == '1');
+  }
+  return solver_->make_term(v, sort, 2);
+}
+
+Term BddReach::to_term(const BDD & b)
+{
+  Term true_ = solver_->make_term(true);
+  unordered_map<unsigned int, Term> bit_terms;
+  auto bit_term = [&](unsigned int idx) {
+    Term & t = bit_terms[idx];
+    if (!t) {
+      const auto & vb = index_bit_.at(idx);
+      const Term & sv = vb.first;
+      if (sv->get_sort()->get_sort_kind() == BOOL) {
+        t = sv;
+      } else {
+        Op ext(Extract, vb.second, vb.second);
+        t = solver_->make_term(Equal,
+                               solver_->make_term(ext, sv),
+                               solver_->make_term(1, solver_->make_sort(BV, 1)));
+      }
+    }
+    return t;
+  };
+
+  // nodes are shared, convert each once (complement edges negate)
+  unordered_map<DdNode *, Term> cache;
+  function<Term(DdNode *)> convert = [&](DdNode * n) -> Term {
+    DdNode * r = Cudd_Regular(n);
+    Term res;
+    if (Cudd_IsConstant(r)) {
+      res = true_;
+    } else {
+      auto it = cache.find(r);
+      if (it != cache.end()) {
+        res = it->second;
+      } else {
+        res = solver_->make_term(Ite,
+                                 bit_term(Cudd_NodeReadIndex(r)),
+                                 convert(Cudd_T(r)),
+                                 convert(Cudd_E(r)));
+        cache[r] = res;
+      }
+    }
+    return Cudd_IsComplement(n) ? solver_->make_term(Not, res) : res;
+  };
+  return convert(b.getNode());
+}
+
+}  // namespace pono
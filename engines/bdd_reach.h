@@ -0,0 +1,123 @@
+/*********************                                                        */
+/*! \file bdd_reach.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Symbolic forward reachability with BDDs (CUDD), for small
+**        control-dominated systems.
+**
+**        The state and input variables are bit-blasted into BDD
+**        variables. The image is computed over a transition relation
+**        partitioned by the state update of each bit, clustered and
+**        with early quantification of the variables no later cluster
+**        depends on. Variables are reordered dynamically, keeping each
+**        current and next state bit together.
+**        The engine gives up (returns unknown) on operators it does not
+**        bit-blast (e.g. multiplication, arrays, integers) and when the
+**        number of live BDD nodes exceeds options_.bdd_node_limit_.
+**
+**/
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cuddObj.hh"
+#include "engines/prover.h"
+
+namespace pono {
+
+class BddReach : public Prover
+{
+ public:
+  BddReach(const Property & p,
+           const TransitionSystem & ts,
+           const smt::SmtSolver & solver,
+           PonoOptions opt = PonoOptions());
+
+  ~BddReach();
+
+  typedef Prover super;
+
+  void initialize() override;
+
+  /** Compute up to k images of the initial states
+   *  @return TRUE at a fixed point (the reached states are the invariant),
+   *          FALSE if a bad state is reached within k steps, and UNKNOWN
+   *          otherwise, or if the engine gave up
+   */
+  ProverResult check_until(int k) override;
+
+  size_t witness_length() const override { return witness_.size(); }
+
+ protected:
+  typedef std::vector<BDD> BddVec;  ///< bits, least significant first
+
+  /** Bit-blast the state update, constraints, init and bad_
+   *  @return false if a term is not supported
+   */
+  bool encode();
+
+  /** @return the bits of a term over the current state and input
+   *          variables, empty if it is not supported
+   */
+  BddVec bits(const smt::Term & t);
+
+  /** @return the bits of op(args), empty if it is not supported */
+  BddVec bits_of_op(const smt::Term & t, const std::vector<BddVec> & args);
+
+  /** Partition the transition relation and schedule the quantification
+   *  of each variable after the last cluster depending on it
+   */
+  void build_clusters();
+
+  /** @return the successors of states, over the current state bits */
+  BDD image(const BDD & states);
+
+  /** Set witness_ from the rings, ending in a bad state of ring k */
+  void compute_bdd_witness(size_t k);
+
+  /** @return the value of the bits of a variable in a minterm
+   *  @param cube the minterm, as a BDD that is a single cube
+   *  @param var the state or input variable
+   */
+  smt::Term var_value(const BDD & cube, const smt::Term & var);
+
+  /** @return a BDD over the current state bits as a term */
+  smt::Term to_term(const BDD & b);
+
+  std::unique_ptr<Cudd> mgr_;
+  bool gave_up_;  ///< unsupported system or over the node limit
+
+  std::unordered_map<smt::Term, BddVec> cache_;  ///< bits of terms
+  std::unordered_map<smt::Term, BddVec> var_bits_;  ///< current state and
+                                                    ///< input variables
+  std::unordered_map<smt::Term, BddVec> next_bits_;  ///< next state bits
+  // state variable and bit of each current state BDD variable index
+  std::unordered_map<unsigned int, std::pair<smt::Term, size_t>> index_bit_;
+
+  BddVec partitions_;  ///< next bit = update bit, one per updated bit
+  BddVec clusters_;    ///< conjunctions of consecutive partitions
+  BddVec quantify_;    ///< cube of the current state and input bits
+                       ///< quantified after each cluster
+  std::vector<BDD> curr_vars_;   ///< current state bits
+  std::vector<BDD> next_vars_;   ///< next state bits, in the same order
+  std::vector<BDD> input_vars_;  ///< input bits
+  BDD constraints_;    ///< over current state and input bits
+  BDD constrained_;    ///< states where the constraints hold for some input
+  BDD init_;
+  BDD bad_bdd_;
+  BDD reached_;
+  std::vector<BDD> rings_;  ///< states first reached at each step
+};
+
+}  // namespace pono
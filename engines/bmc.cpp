@@ -15,15 +15,30 @@
  **/
 
 #include "bmc.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "assert.h"
+#include "smt-switch/utils.h"
+#include "utils/concrete_simulator.h"
+#include "utils/cube_and_conquer.h"
+#include "utils/exceptions.h"
+#include "utils/lemma_cache.h"
 #include "utils/logger.h"
 
 using namespace smt;
 
 namespace pono {
 
+// the longest simulated trace for --bmc-sim-guide
+static const int max_guide_depth = 1024;
+// guided queries without a counterexample before the guide is dropped
+static const size_t max_guide_misses = 8;
+
 Bmc::Bmc(const Property & p, const TransitionSystem & ts,
          const SmtSolver & solver, PonoOptions opt)
-  : super(p, ts, solver, opt)
+  : super(p, ts, solver, opt), guide_misses_(0), cones_saturated_(false)
 {
   engine_ = Engine::BMC;
 }
@@ -38,20 +53,79 @@ void Bmc::initialize()
 
   super::initialize();
 
+  if (options_.bmc_unroll_window_) {
+    // a step unrolls at most bmc_step_size_ bounds back
+    unroller_.set_window(
+        std::max(options_.bmc_unroll_window_, options_.bmc_step_size_));
+  }
+
+  if (options_.bmc_init_constants_) {
+    // the first time steps are concrete in the variables init determines
+    unroller_.set_init_constants(options_.bmc_init_constants_);
+    logger.log(1,
+               "Bmc: {} state variables with a value at time 0, propagated "
+               "over {} time steps",
+               unroller_.num_init_constants(0),
+               options_.bmc_init_constants_);
+  }
+
   // NOTE: There's an implicit assumption that this solver is only used for
   // model checking once Otherwise there could be conflicting assertions to
   // the solver or it could just be polluted with redundant assertions in the
   // future we can use solver_->reset_assertions(), but it is not currently
   // supported in boolector
   solver_->assert_formula(unroller_.at_time(ts_.init(), 0));
+
+  if (!options_.bmc_cube_.empty()) {
+    // a job of cube-and-conquer, see utils/cube_and_conquer.h
+    Cube cube = parse_cube(ts_, options_.bmc_cube_);
+    for (const auto & lit : cube) {
+      solver_->assert_formula(
+          unroller_.at_time(cube_literal_term(solver_, lit), lit.time));
+    }
+    logger.log(1, "Bmc: restricted to a cube of {} literals", cube.size());
+  }
+
+  if (options_.bmc_sim_guide_ && !options_.bmc_cone_slice_) {
+    simulate_guide();
+  }
+
+  if (options_.bmc_cone_slice_) {
+    sliced_trans_.reset(new PartitionedTrans(ts_));
+    UnorderedTermSet free_vars;
+    get_free_symbolic_consts(sliced_trans_->global(), free_vars);
+    for (const auto & v : free_vars) {
+      if (ts_.is_curr_var(v)) {
+        global_vars_.insert(v);
+      }
+    }
+    for (size_t i = 0; i < sliced_trans_->size(); ++i) {
+      free_vars.clear();
+      get_free_symbolic_consts(sliced_trans_->partition(i), free_vars);
+      partition_support_.emplace_back();
+      for (const auto & v : free_vars) {
+        if (ts_.is_curr_var(v)) {
+          partition_support_.back().insert(v);
+        }
+      }
+    }
+  }
 }
 
 ProverResult Bmc::check_until(int k)
 {
   initialize();
+  resume_checkpoint();
 
-  for (int i = reached_k_ + 1; i <= k; ++i) {
-    if (!step(i)) {
+  int step_size = options_.bmc_step_size_;
+  while (reached_k_ < k) {
+    int i = reached_k_ + 1;
+    if (interrupted()) {
+      logger.log(1, "BMC: interrupted at bound {}", i);
+      return ProverResult::UNKNOWN;
+    }
+    int j = std::min(k, i + step_size - 1);
+    if (!(j > i ? step_range(i, j) : step(i))) {
       compute_witness();
       return ProverResult::FALSE;
     }
@@ -66,22 +140,513 @@ bool Bmc::step(int i)
   }
 
   bool res = true;
-  if (i > 0) {
-    solver_->assert_formula(unroller_.at_time(ts_.trans(), i - 1));
+  if (sliced_trans_) {
+    assert_sliced_trans(i);
+  } else if (i > 0) {
+    assert_trans_at(i - 1);
   }
+  assert_frame_lemmas(i);
 
-  solver_->push();
   logger.log(1, "Checking bmc at bound: {}", i);
-  solver_->assert_formula(unroller_.at_time(bad_, i));
-  Result r = solver_->check_sat();
+  Term bad_i = unroller_.at_time(bad_, i);
+  if (guide_.size() && i + 1 >= (int)guide_.size() && guided_step(i, bad_i)) {
+    return false;
+  }
+  Result r;
+  TermVec assumps;
+  if (options_.bmc_assumptions_) {
+    // guard bad@i with an activation literal instead of push/pop
+    // so that the solver keeps what it learned for the next bounds
+    Term act = solver_->make_symbol("__bmc_act_" + std::to_string(i),
+                                    solver_->make_sort(BOOL));
+    solver_->assert_formula(solver_->make_term(Implies, act, bad_i));
+    assumps.push_back(act);
+    r = retry_unknown(check_sat_assuming(assumps), assumps, i);
+  } else {
+    solver_->push();
+    solver_->assert_formula(bad_i);
+    r = retry_unknown(check_sat(), {}, i);
+  }
+
   if (r.is_sat()) {
     res = false;
+    if (sliced_trans_) {
+      // the variables outside of the cones are arbitrary in the model,
+      // but they can always be completed to a path
+      for (int t = 0; t < i; ++t) {
+        assert_trans_at(t);
+      }
+      r = assumps.empty() ? check_sat() : check_sat_assuming(assumps);
+      if (!r.is_sat()) {
+        throw PonoException(
+            "Internal error: Expecting the sliced counterexample to extend "
+            "to a path");
+      }
+    }
+  } else if (r.is_unknown()) {
+    // e.g. the query time limit was hit -- bound i is not reached
+    if (!options_.bmc_assumptions_) {
+      solver_->pop();
+    }
+    budget_.cancel("solver returned unknown at bound " + std::to_string(i));
   } else {
-    solver_->pop();
+    if (options_.bmc_assumptions_) {
+      // bad@i is unreachable, which strengthens the later bounds
+      // (and disables the activation literal)
+      solver_->assert_formula(solver_->make_term(Not, bad_i));
+    } else {
+      solver_->pop();
+    }
     ++reached_k_;
+    stats_->set("reached_k", reached_k_);
+    unroller_.report_statistics(*stats_);
+    publish_safe_bound(reached_k_);
+    checkpoint();
   }
 
   return res;
 }
 
+void Bmc::simulate_guide()
+{
+  if (!ts_.is_functional()) {
+    logger.log(1, "Bmc: no simulation guide for a relational system");
+    return;
+  }
+
+  // the conjuncts of bad, as the outputs they are scored by: a boolean
+  // or the two sides of a bit-vector equality
+  TermVec conjuncts;
+  TermVec to_visit({ bad_ });
+  while (to_visit.size()) {
+    Term t = to_visit.back();
+    to_visit.pop_back();
+    Op op = t->get_op();
+    if (op == And) {
+      for (const auto & c : *t) {
+        to_visit.push_back(c);
+      }
+    } else if (op == Not && (*t->begin())->get_op() == Or) {
+      for (const auto & c : *t->begin()) {
+        to_visit.push_back(solver_->make_term(Not, c));
+      }
+    } else {
+      conjuncts.push_back(t);
+    }
+  }
+
+  std::unique_ptr<ConcreteSimulator> sim;
+  std::vector<std::pair<uint32_t, uint32_t>> goals;
+  std::vector<uint32_t> goal_widths;
+  TermVec vars;
+  std::vector<uint32_t> var_ids;
+  try {
+    sim.reset(new ConcreteSimulator(ts_, options_.random_seed_));
+    for (const auto & c : conjuncts) {
+      TermVec args;
+      for (const auto & a : *c) {
+        args.push_back(a);
+      }
+      if (c->get_op() == Equal && args.size() == 2
+          && args[0]->get_sort()->get_sort_kind() == BV) {
+        goals.push_back({ sim->add_output(args[0]), sim->add_output(args[1]) });
+        goal_widths.push_back(args[0]->get_sort()->get_width());
+      } else {
+        goals.push_back({ sim->add_output(c), 0 });
+        goal_widths.push_back(0);
+      }
+    }
+    for (const auto & vs : { ts_.statevars(), ts_.inputvars() }) {
+      for (const auto & v : vs) {
+        vars.push_back(v);
+        var_ids.push_back(sim->add_output(v));
+      }
+    }
+  }
+  catch (PonoException & e) {
+    logger.log(1, "Bmc: no simulation guide: {}", e.what());
+    return;
+  }
+
+  auto score = [&]() {
+    double res = 0;
+    for (size_t g = 0; g < goals.size(); ++g) {
+      uint32_t w = goal_widths[g];
+      if (!w) {
+        res += sim->value(goals[g].first) != 0;
+      } else {
+        uint64_t diff =
+            sim->value(goals[g].first) ^ sim->value(goals[g].second);
+        res += double(w - __builtin_popcountll(diff)) / w;
+      }
+    }
+    return res;
+  };
+
+  int depth = std::max(1, std::min((int)options_.bound_, max_guide_depth));
+  size_t num_traces =
+      std::max<size_t>(1, options_.bmc_sim_guide_ / (depth + 1));
+  std::vector<std::vector<uint64_t>> trace, best_trace;
+  double best_score = -1;
+  bool hit = false;
+  for (size_t n = 0; n < num_traces && !hit && !interrupted(); ++n) {
+    if (!sim->reset()) {
+      break;
+    }
+    trace.clear();
+    for (int c = 0; c <= depth; ++c) {
+      if (c && !sim->step()) {
+        break;
+      }
+      trace.emplace_back();
+      for (auto id : var_ids) {
+        trace.back().push_back(sim->value(id));
+      }
+      double sc = score();
+      if (sc > best_score) {
+        best_score = sc;
+        best_trace = trace;
+      }
+      if (sc == goals.size()) {
+        hit = true;
+        break;
+      }
+    }
+  }
+
+  for (const auto & frame : best_trace) {
+    Term step = solver_->make_term(true);
+    for (size_t v = 0; v < vars.size(); ++v) {
+      Sort sort = vars[v]->get_sort();
+      Term val = sort->get_sort_kind() == BOOL
+                     ? solver_->make_term(frame[v] != 0)
+                     : solver_->make_term(std::to_string(frame[v]), sort);
+      step = solver_->make_term(
+          And, step, solver_->make_term(Equal, vars[v], val));
+    }
+    guide_.push_back(step);
+  }
+
+  stats_->set("bmc_guide_length", guide_.size());
+  logger.log(1,
+             "Bmc: simulated {} cycles, the closest trace has {} of {} "
+             "conjuncts of bad at step {}",
+             sim->num_cycles(),
+             best_score,
+             goals.size(),
+             (int)guide_.size() - 1);
+}
+
+bool Bmc::guided_step(int i, const Term & bad_i)
+{
+  solver_->push();
+  for (size_t t = 0; t < guide_.size(); ++t) {
+    solver_->assert_formula(unroller_.at_time(guide_[t], t));
+  }
+  solver_->assert_formula(bad_i);
+  stats_->increment("bmc_guided_queries");
+  Result r = check_sat();
+  if (r.is_sat()) {
+    logger.log(1, "Bmc: counterexample at bound {} along the guide", i);
+    stats_->increment("bmc_guided_hits");
+    return true;
+  }
+
+  solver_->pop();
+  if (++guide_misses_ >= max_guide_misses) {
+    logger.log(1, "Bmc: dropping the simulation guide at bound {}", i);
+    guide_.clear();
+  }
+  return false;
+}
+
+bool Bmc::step_range(int i, int j)
+{
+  assert(i == reached_k_ + 1);
+  assert(i < j);
+
+  if (i > 0) {
+    assert_trans_at(i - 1);
+  }
+  assert_frame_lemmas(j);
+
+  logger.log(1, "Checking bmc at bounds: {} to {}", i, j);
+  int first;
+  Result r = check_range(i, i, j, first);
+  if (r.is_unknown()) {
+    budget_.cancel("solver returned unknown at bound " + std::to_string(i));
+    return true;
+  } else if (r.is_unsat()) {
+    // no counterexample up to j, extend the unrolling
+    for (int t = i; t < j; ++t) {
+      assert_trans_at(t);
+    }
+    if (options_.bmc_assumptions_) {
+      for (int t = i; t <= j; ++t) {
+        solver_->assert_formula(
+            solver_->make_term(Not, unroller_.at_time(bad_, t)));
+      }
+    }
+    reached_k_ = j;
+    stats_->set("reached_k", reached_k_);
+    unroller_.report_statistics(*stats_);
+    publish_safe_bound(reached_k_);
+    checkpoint();
+    return true;
+  }
+
+  // there is a counterexample of length first
+  // bisect [i, first - 1] for a shorter one
+  int lo = i;
+  int hi = first;
+  while (lo < hi) {
+    int mid = lo + (hi - lo - 1) / 2;
+    r = check_range(i, lo, mid, first);
+    if (r.is_unknown()) {
+      budget_.cancel("solver returned unknown at bound " + std::to_string(lo));
+      reached_k_ = lo - 1;
+      return true;
+    } else if (r.is_sat()) {
+      assert(first <= mid);
+      hi = first;
+    } else {
+      lo = mid + 1;
+    }
+  }
+
+  // replay the shortest counterexample for the witness
+  logger.log(1, "Found shortest counterexample at bound: {}", hi);
+  reached_k_ = hi - 1;
+  solver_->push();
+  for (int t = i; t < hi; ++t) {
+    assert_trans_at(t);
+  }
+  solver_->assert_formula(unroller_.at_time(bad_, hi));
+  r = check_sat();
+  if (!r.is_sat()) {
+    throw PonoException("Internal error: Expecting satisfiable result");
+  }
+  return false;
+}
+
+Result Bmc::check_range(int i, int lo, int hi, int & first)
+{
+  assert(i <= lo);
+  assert(lo <= hi);
+
+  // bad@lo or (trans@lo and (bad@lo+1 or (trans@lo+1 and ... bad@hi)))
+  // this does not require paths to bad@t to be extendable up to hi
+  Term query = unroller_.at_time(bad_, hi);
+  for (int t = hi - 1; t >= lo; --t) {
+    query = solver_->make_term(
+        Or,
+        unroller_.at_time(bad_, t),
+        solver_->make_term(And, unroller_.at_time(ts_.trans(), t), query));
+  }
+  for (int t = lo - 1; t >= i; --t) {
+    query = solver_->make_term(And, unroller_.at_time(ts_.trans(), t), query);
+  }
+
+  Result r;
+  if (options_.bmc_assumptions_) {
+    Term act = solver_->make_symbol(
+        "__bmc_act_" + std::to_string(lo) + "_" + std::to_string(hi),
+        solver_->make_sort(BOOL));
+    solver_->assert_formula(solver_->make_term(Implies, act, query));
+    r = retry_unknown(check_sat_assuming({ act }), { act }, lo);
+  } else {
+    solver_->push();
+    solver_->assert_formula(query);
+    r = retry_unknown(check_sat(), {}, lo);
+  }
+
+  if (r.is_sat()) {
+    // read the shortest counterexample in this model
+    Term true_ = solver_->make_term(true);
+    bool path = true;
+    first = hi;
+    for (int t = lo; t <= hi && path; ++t) {
+      if (solver_->get_value(unroller_.at_time(bad_, t)) == true_) {
+        first = t;
+        break;
+      }
+      path = solver_->get_value(unroller_.at_time(ts_.trans(), t)) == true_;
+    }
+  }
+
+  if (!options_.bmc_assumptions_) {
+    solver_->pop();
+  }
+  return r;
+}
+
+void Bmc::assert_sliced_trans(int k)
+{
+  assert(sliced_trans_);
+  size_t n = sliced_trans_->size();
+  size_t num_asserted = 0;
+  while (sliced_asserted_.size() < static_cast<size_t>(k)) {
+    size_t t = sliced_asserted_.size();
+    solver_->assert_formula(unroller_.at_time(sliced_trans_->global(), t));
+    sliced_asserted_.push_back(std::vector<bool>(n, false));
+    sliced_dist_.push_back(-1);
+    ++num_asserted;
+  }
+
+  std::vector<size_t> parts;
+  for (int t = 0; t < k; ++t) {
+    int d = k - t - 1;
+    if (cones_saturated_
+        && sliced_dist_[t] >= static_cast<int>(cones_.size()) - 1) {
+      // the cone stopped growing, nothing new for this frame
+      continue;
+    }
+    parts.clear();
+    sliced_trans_->cone(sliced_cone(d), parts);
+    for (auto p : parts) {
+      if (!sliced_asserted_[t][p]) {
+        solver_->assert_formula(
+            unroller_.at_time(sliced_trans_->partition(p), t));
+        sliced_asserted_[t][p] = true;
+        ++num_asserted;
+      }
+    }
+    sliced_dist_[t] = std::max(sliced_dist_[t], d);
+  }
+  stats_->increment("bmc_sliced_assertions", num_asserted);
+}
+
+const UnorderedTermSet & Bmc::sliced_cone(size_t d)
+{
+  if (cones_.empty()) {
+    UnorderedTermSet free_vars;
+    get_free_symbolic_consts(bad_, free_vars);
+    cones_.emplace_back();
+    for (const auto & v : free_vars) {
+      if (ts_.is_curr_var(v)) {
+        cones_.back().insert(v);
+      }
+    }
+  }
+
+  // the frame before needs the support of the updates of the cone
+  while (!cones_saturated_ && cones_.size() <= d) {
+    std::vector<size_t> parts;
+    sliced_trans_->cone(cones_.back(), parts);
+    UnorderedTermSet next = cones_.back();
+    next.insert(global_vars_.begin(), global_vars_.end());
+    for (auto p : parts) {
+      const UnorderedTermSet & support = partition_support_[p];
+      next.insert(support.begin(), support.end());
+    }
+    if (next.size() == cones_.back().size()) {
+      // the cones only grow, so they stay the same from here on
+      cones_saturated_ = true;
+      logger.log(1, "BMC: the cone of bad stops growing at distance {}",
+                 cones_.size() - 1);
+    } else {
+      cones_.push_back(std::move(next));
+    }
+  }
+  return cones_[std::min(d, cones_.size() - 1)];
+}
+
+void Bmc::assert_frame_lemmas(int k)
+{
+  if (!options_.bmc_frame_lemmas_) {
+    return;
+  }
+
+  std::vector<TermVec> lemmas;
+  std::vector<int> frames;
+  import_frame_lemmas(lemmas, frames);
+  for (size_t i = 0; i < lemmas.size(); ++i) {
+    Term lemma = lemmas[i][0];
+    for (size_t j = 1; j < lemmas[i].size(); ++j) {
+      lemma = solver_->make_term(Or, lemma, lemmas[i][j]);
+    }
+    if (!ts_.only_curr(lemma)) {
+      continue;
+    }
+    auto it = frame_lemma_idx_.find(lemma);
+    if (it == frame_lemma_idx_.end()) {
+      frame_lemma_idx_[lemma] = frame_lemmas_.size();
+      frame_lemmas_.push_back(lemma);
+      frame_lemma_frames_.push_back(frames[i]);
+      frame_lemma_steps_.push_back(-1);
+    } else {
+      int & frame = frame_lemma_frames_[it->second];
+      frame = std::max(frame, frames[i]);
+    }
+  }
+
+  // a state at step t is reachable in t transitions, so the lemmas of
+  // the frames t and above hold in it
+  size_t num_asserted = 0;
+  for (size_t i = 0; i < frame_lemmas_.size(); ++i) {
+    int last = std::min(frame_lemma_frames_[i], k);
+    for (int t = frame_lemma_steps_[i] + 1; t <= last; ++t) {
+      solver_->assert_formula(unroller_.at_time(frame_lemmas_[i], t));
+      ++num_asserted;
+    }
+    frame_lemma_steps_[i] = std::max(frame_lemma_steps_[i], last);
+  }
+  stats_->set("bmc_frame_lemmas", frame_lemmas_.size());
+  stats_->increment("bmc_frame_lemma_assertions", num_asserted);
+}
+
+bool Bmc::save_checkpoint_state(Checkpoint & cp) const
+{
+  // the windowed unroller cannot rebuild the earlier bounds
+  return !options_.bmc_unroll_window_;
+}
+
+bool Bmc::restore_checkpoint_state(const Checkpoint & cp)
+{
+  if (options_.bmc_unroll_window_ || reached_k_ != -1) {
+    return false;
+  }
+
+  // the solver state after step(cp.reached_k), without the queries
+  for (int t = 0; t < cp.reached_k; ++t) {
+    assert_trans_at(t);
+  }
+  if (options_.bmc_assumptions_) {
+    for (int t = 0; t <= cp.reached_k; ++t) {
+      solver_->assert_formula(
+          solver_->make_term(Not, unroller_.at_time(bad_, t)));
+    }
+  }
+  reached_k_ = cp.reached_k;
+  stats_->set("reached_k", reached_k_);
+  publish_safe_bound(reached_k_);
+  return true;
+}
+
+Result Bmc::retry_unknown(Result r, const TermVec & assumps, int bound)
+{
+  size_t scale = 1;
+  for (unsigned int t = 0; r.is_unknown() && t < options_.query_retries_;
+       ++t) {
+    if (interrupted()) {
+      break;
+    }
+    scale *= 2;
+    if (!set_query_limits(solver_, scale)) {
+      // no limit that a bigger budget could help with
+      break;
+    }
+    logger.log(1,
+               "BMC: retrying bound {} with {}x the query limits",
+               bound,
+               scale);
+    stats_->increment("bmc_query_retries");
+    r = assumps.empty() ? check_sat() : check_sat_assuming(assumps);
+  }
+  if (scale > 1) {
+    set_query_limits(solver_);
+  }
+  return r;
+}
+
 }  // namespace pono
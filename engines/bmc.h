@@ -16,7 +16,11 @@
 
 #pragma once
 
+#include <memory>
+#include <unordered_map>
+
 #include "engines/prover.h"
+#include "utils/partitioned_trans.h"
 
 namespace pono {
 
@@ -38,6 +42,96 @@ public:
  protected:
   bool step(int i);
 
+  /** Check bounds i to j (i < j) with one query, bisecting on a
+   *  counterexample to find the shortest one
+   *  @param i the first bound, reached_k_ must be i - 1
+   *  @param j the last bound
+   *  @return false iff there is a counterexample, then the solver state
+   *          holds the shortest one and reached_k_ is its length - 1
+   */
+  bool step_range(int i, int j);
+
+  /** Check whether bad is reachable at a bound in [lo, hi] using the
+   *  transitions from i on (earlier transitions must be asserted)
+   *  @param i the first transition that is not asserted yet
+   *  @param lo the first bound to check, lo >= i
+   *  @param hi the last bound to check
+   *  @param first set to the smallest counterexample bound in the model
+   *         if the result is sat
+   *  @return the solver result
+   */
+  smt::Result check_range(int i, int lo, int hi, int & first);
+
+  /** Retry an unknown query up to --query-retries times, doubling the
+   *  per-query limits each time, then restore the limits
+   *  @param r the result of the query
+   *  @param assumps the assumptions of the query (empty for check_sat)
+   *  @param bound the bound being checked, for logging
+   *  @return the result of the last try
+   */
+  smt::Result retry_unknown(smt::Result r,
+                            const smt::TermVec & assumps,
+                            int bound);
+
+  /** Import the lemmas of IC3 frames from the lemma bus and assert each
+   *  one at the steps up to the minimum of its frame and k where it is
+   *  not asserted yet (see --bmc-frame-lemmas)
+   */
+  void assert_frame_lemmas(int k);
+
+  // lemmas with a frame from the lemma bus, in solver_
+  smt::TermVec frame_lemmas_;
+  std::vector<int> frame_lemma_frames_;  ///< the lemma holds up to this step
+  std::vector<int> frame_lemma_steps_;  ///< asserted at the steps up to this
+  std::unordered_map<smt::Term, size_t> frame_lemma_idx_;
+
+  /** Assert the parts of the transition relation that bad@k depends on
+   *  (see --bmc-cone-slice): the global part of every frame t < k and
+   *  the state updates of the variables in sliced_cone(k - t - 1).
+   *  The cones grow with the distance, so every bound only adds parts.
+   */
+  void assert_sliced_trans(int k);
+
+  /** @return the current state variables that bad depends on at most
+   *          d steps before it is checked, with the variables of the
+   *          global part of trans for d > 0
+   */
+  const smt::UnorderedTermSet & sliced_cone(size_t d);
+
+  // used with options_.bmc_cone_slice_
+  std::unique_ptr<PartitionedTrans> sliced_trans_;
+  std::vector<smt::UnorderedTermSet> partition_support_;
+  smt::UnorderedTermSet global_vars_;  ///< state variables of the global part
+  std::vector<smt::UnorderedTermSet> cones_;  ///< cones_[d], see sliced_cone
+  bool cones_saturated_;  ///< the last cone is the cone of every larger d
+  ///< sliced_asserted_[t][i] iff partition i is asserted at frame t
+  std::vector<std::vector<bool>> sliced_asserted_;
+  std::vector<int> sliced_dist_;  ///< largest distance asserted at t
+
+  /** Simulate the system (see --bmc-sim-guide) and keep the prefix of
+   *  the trace that came closest to a bad state, by the number of
+   *  conjuncts of bad that hold, where a bit-vector equality counts the
+   *  fraction of its bits that are equal. Does nothing for relational
+   *  systems and systems the simulator does not support.
+   */
+  void simulate_guide();
+
+  /** Check bad@i along the guide: with the variables fixed to their
+   *  values in the guide up to its last step
+   *  @return true iff there is a counterexample, then the solver state
+   *          holds it (with an additional context level)
+   */
+  bool guided_step(int i, const smt::Term & bad_i);
+
+  ///< the values of the variables in each step of the guide, over the
+  ///< current state and input variables
+  smt::TermVec guide_;
+  size_t guide_misses_;  ///< guided queries that found no counterexample
+
+  // only the bound is saved, the unrolling is rebuilt on restore
+  bool save_checkpoint_state(Checkpoint & cp) const override;
+  bool restore_checkpoint_state(const Checkpoint & cp) override;
+
 };  // class Bmc
 
 }  // namespace pono
@@ -25,7 +25,7 @@ namespace pono {
 BmcSimplePath::BmcSimplePath(const Property & p, const TransitionSystem & ts,
                              const SmtSolver & solver,
                              PonoOptions opt)
-  : super(p, ts, solver, opt)
+  : super(p, ts, solver, opt), cover_not_init_time_(0)
 {
   engine_ = Engine::BMC_SP;
 }
@@ -35,13 +35,22 @@ BmcSimplePath::~BmcSimplePath() {}
 ProverResult BmcSimplePath::check_until(int k)
 {
   initialize();
+  resume_checkpoint();
 
   for (int i = 0; i <= k; ++i) {
+    if (interrupted()) {
+      logger.log(1, "BmcSimplePath: interrupted at bound {}", i);
+      return ProverResult::UNKNOWN;
+    }
     logger.log(1, "Checking Bmc at bound: {}", i);
     if (!base_step(i)) {
       compute_witness();
       return ProverResult::FALSE;
     }
+    if (interrupted()) {
+      logger.log(1, "BmcSimplePath: interrupted at bound {}", i);
+      return ProverResult::UNKNOWN;
+    }
     logger.log(1, "Checking simple path at bound: {}", i);
     if (cover_step(i)) {
       return ProverResult::TRUE;
@@ -56,18 +65,37 @@ bool BmcSimplePath::cover_step(int i)
     return false;
   }
 
-  solver_->push();
-  solver_->assert_formula(init0_);
+  if (!cover_act_) {
+    cover_act_ = solver_->make_symbol("__bmc_sp_cover_act",
+                                      solver_->make_sort(BOOL));
+    solver_->assert_formula(
+        solver_->make_term(PrimOp::Implies, cover_act_, init0_));
+  }
+  // only the new time steps, the earlier ones are still asserted
   Term not_init = solver_->make_term(PrimOp::Not, ts_.init());
-  for (int j = 1; j <= i; ++j) {
-    solver_->assert_formula(unroller_.at_time(not_init, j));
+  while (cover_not_init_time_ < i) {
+    ++cover_not_init_time_;
+    solver_->assert_formula(
+        solver_->make_term(PrimOp::Implies,
+                           cover_act_,
+                           unroller_.at_time(not_init, cover_not_init_time_)));
   }
-  if (ts_.statevars().size() && check_simple_path_lazy(i)) {
-    return true;
+
+  if (ts_.statevars().size()) {
+    do {
+      Result r = check_sat_assuming({ cover_act_ });
+      if (r.is_unsat()) {
+        return true;
+      } else if (r.is_unknown()) {
+        budget_.cancel("solver returned unknown at bound "
+                       + std::to_string(i));
+        return false;
+      }
+    } while (add_repeated_state_constraints(i, cover_act_));
   }
-  solver_->pop();
 
   ++reached_k_;
+  checkpoint();
 
   return false;
 }
@@ -34,8 +34,16 @@ class BmcSimplePath : public KInduction
   ProverResult check_until(int k) override;
 
  protected:
+  /** Checks that there is no simple path of length i from init that
+   *  doesn't visit init again. The query and its simple path constraints
+   *  are kept across bounds under cover_act_, the constraints are only
+   *  added for pairs of states that are equal in a model.
+   */
   bool cover_step(int i);
 
+  smt::Term cover_act_;  ///< activates init0_, not init and simple paths
+  int cover_not_init_time_;  ///< not init is asserted at times 1 to this
+
 };  // BmcSimplePath
 
 }  // namespace pono
@@ -24,15 +24,19 @@
 #include "assert.h"
 #include "engines/bmc.h"
 #include "engines/bmc_simplepath.h"
+#include "engines/ic3base.h"
 #include "engines/ic3ia.h"
 #include "engines/ic3sa.h"
 #include "engines/interpolantmc.h"
 #include "engines/kinduction.h"
 #include "engines/mbic3.h"
+#include "smt-switch/utils.h"
 #include "smt/available_solvers.h"
+#include "utils/core_minimizer.h"
 #include "utils/logger.h"
 #include "utils/make_provers.h"
 #include "utils/term_analysis.h"
+#include "utils/timeline.h"
 #include "utils/ts_analysis.h"
 
 #ifdef WITH_MSAT_IC3IA
@@ -59,13 +63,16 @@ CegProphecyArrays<Prover_T>::CegProphecyArrays(const Property & p,
            ts.solver() == super::solver_
                ? p.prop()
                : super::to_prover_solver_.transfer_term(p.prop(), BOOL),
-           super::options_.cegp_timed_axiom_red_),
+           super::options_.cegp_timed_axiom_red_,
+           super::options_.cegp_incremental_axioms_),
       pm_(abs_ts_),
       reached_k_(-1),
-      num_added_axioms_(0)
+      num_added_axioms_(0),
+      restart_num_vars_(0)
 {
   // point orig_ts_ to the correct one
   super::orig_ts_ = ts;
+  aa_.set_statistics(super::stats_);
 }
 
 template <class Prover_T>
@@ -144,12 +151,26 @@ ProverResult CegProphecyArrays<Prover_T>::check_until(int k)
     } while (num_added_axioms_ && reached_k_ <= k);
 
     if (super::options_.cegp_force_restart_ || super::engine_ != IC3IA_ENGINE) {
-      Property latest_prop(super::solver_,
-                           super::solver_->make_term(Not, super::bad_));
-      SmtSolver s = create_solver_for(super::solver_->get_solver_enum(),
-                                      super::engine_, false);
-      shared_ptr<Prover> prover = make_prover(super::engine_, latest_prop,
-                                              abs_ts_, s, super::options_);
+      // an IC3 prover can keep its frames if the refinement only added
+      // axioms (prophecy variables change the variables of the system)
+      shared_ptr<IC3Base> ic3_prover =
+          dynamic_pointer_cast<IC3Base>(restart_prover_);
+      if (ic3_prover && super::engine_ != IC3IA_ENGINE
+          && !super::options_.cegp_force_restart_
+          && restart_num_vars_
+                 == abs_ts_.statevars().size() + abs_ts_.inputvars().size()) {
+        ic3_prover->strengthen_ts(abs_ts_, super::bad_);
+      } else {
+        Property latest_prop(super::solver_,
+                             super::solver_->make_term(Not, super::bad_));
+        SmtSolver s = create_solver_for(super::solver_->get_solver_enum(),
+                                        super::engine_, false);
+        restart_prover_ = make_prover(
+            super::engine_, latest_prop, abs_ts_, s, super::options_);
+        restart_num_vars_ =
+            abs_ts_.statevars().size() + abs_ts_.inputvars().size();
+      }
+      shared_ptr<Prover> prover = restart_prover_;
       if (super::engine_ == IC3IA_ENGINE) {
         shared_ptr<IC3IA> ic3ia_prover =
             std::static_pointer_cast<IC3IA>(prover);
@@ -270,6 +291,25 @@ void CegProphecyArrays<Prover_T>::cegar_abstract()
   assert(super::bad_);
   super::bad_ = aa_.abstract(super::bad_);
 
+  // seed the abstraction with the axioms learned for other properties
+  if (super::refinement_cache_
+      && super::refinement_cache_->solver() == conc_ts_.solver()) {
+    RelationalTransitionSystem & rts =
+        static_cast<RelationalTransitionSystem &>(abs_ts_);
+    size_t num_seeded = 0;
+    for (auto ax : super::refinement_cache_->relevant(conc_ts_)) {
+      Term abs_ax = aa_.abstract(ax);
+      if (rts.only_curr(abs_ax)) {
+        rts.constrain_init(abs_ax);
+        rts.constrain_trans(rts.next(abs_ax));
+      }
+      rts.constrain_trans(abs_ax);
+      ++num_seeded;
+    }
+    logger.log(1, "CEGP: seeded {} cached axiom(s)", num_seeded);
+    super::stats_->increment("cegp_seeded_axioms", num_seeded);
+  }
+
   // the abstract system should have all the same state and input variables
   // but abstracted
   // plus it will have some new variables for the witnesses and lambdas
@@ -277,9 +317,26 @@ void CegProphecyArrays<Prover_T>::cegar_abstract()
   assert(abs_ts_.inputvars().size() >= conc_ts_.inputvars().size());
 }
 
+template <class Prover_T>
+void CegProphecyArrays<Prover_T>::report_memory()
+{
+  super::report_memory();
+  aae_.report_statistics(*super::stats_);
+}
+
+template <class Prover_T>
+void CegProphecyArrays<Prover_T>::reduce_memory()
+{
+  super::reduce_memory();
+  aae_.clear_candidates();
+  abs_unroller_.clear_term_caches();
+}
+
 template <class Prover_T>
 bool CegProphecyArrays<Prover_T>::cegar_refine()
 {
+  TIMELINE_SPAN("ceg_prophecy_refine");
+  super::stats_->increment("cegar_refinements");
   num_added_axioms_ = 0;
   // TODO use ArrayAxiomEnumerator and modifiers to refine the system
   // create BMC formula
@@ -342,12 +399,17 @@ bool CegProphecyArrays<Prover_T>::cegar_refine()
       // can't target a non-current state variable
       // because the target will appear in the updated property
       assert(delay > 0 || abs_ts_.only_curr(idx));
+      if (pm_.has_proph(idx, delay)) {
+        // an earlier refinement already added this prophecy variable
+        // to the indices and the property
+        continue;
+      }
       // Prophecy Modifier will add prophecy and history variables
       // automatically here but it does NOT update the property
       proph_vars.push_back(pm_.get_proph(idx, delay));
     }
 
-    assert(instantiations.size() == proph_vars.size());
+    assert(instantiations.size() >= proph_vars.size());
     logger.log(1, "Added {} prophecy variables", proph_vars.size());
 
     // now update bad_ and add the prophecy variables to the index set
@@ -400,14 +462,25 @@ bool CegProphecyArrays<Prover_T>::cegar_refine()
 template <class Prover_T>
 Term CegProphecyArrays<Prover_T>::get_bmc_formula(size_t b)
 {
-  Term abs_bmc_formula = abs_unroller_.at_time(abs_ts_.init(), 0);
-  for (int k = 0; k < b; ++k) {
-    abs_bmc_formula = super::solver_->make_term(
-        And, abs_bmc_formula, abs_unroller_.at_time(abs_ts_.trans(), k));
+  // refine_ts strengthens init and trans, which invalidates the prefix
+  if (bmc_prefix_init_ != abs_ts_.init()
+      || bmc_prefix_trans_ != abs_ts_.trans()) {
+    bmc_prefix_init_ = abs_ts_.init();
+    bmc_prefix_trans_ = abs_ts_.trans();
+    bmc_prefix_.clear();
+    bmc_prefix_.push_back(abs_unroller_.at_time(bmc_prefix_init_, 0));
+  }
+
+  while (bmc_prefix_.size() <= b) {
+    size_t k = bmc_prefix_.size() - 1;
+    bmc_prefix_.push_back(
+        super::solver_->make_term(And,
+                                  bmc_prefix_.back(),
+                                  abs_unroller_.at_time(bmc_prefix_trans_, k)));
   }
 
   return super::solver_->make_term(
-      And, abs_bmc_formula, abs_unroller_.at_time(super::bad_, b));
+      And, bmc_prefix_[b], abs_unroller_.at_time(super::bad_, b));
 }
 
 template <class Prover_T>
@@ -438,11 +511,19 @@ void CegProphecyArrays<Prover_T>::reduce_consecutive_axioms(
     assumps.push_back(lbl);
   }
 
-  Result res = super::solver_->check_sat_assuming(assumps);
-  assert(res.is_unsat());
-
   UnorderedTermSet core;
-  super::solver_->get_unsat_assumptions(core);
+  if (super::options_.cegar_core_min_time_) {
+    TermVec min_core;
+    CoreMinimizer minimizer(super::solver_,
+                            super::options_.cegar_core_min_time_);
+    bool unsat = minimizer.minimize(assumps, min_core);
+    assert(unsat);
+    core.insert(min_core.begin(), min_core.end());
+  } else {
+    Result res = super::solver_->check_sat_assuming(assumps);
+    assert(res.is_unsat());
+    super::solver_->get_unsat_assumptions(core);
+  }
 
   logger.log(
       1, "Reduced consecutive axioms: {}/{}", core.size(), assumps.size());
@@ -493,8 +574,41 @@ AxiomVec CegProphecyArrays<Prover_T>::reduce_nonconsecutive_axioms(
   super::solver_->push();
   super::solver_->assert_formula(abs_bmc_formula);
 
+  if (super::options_.cegar_core_min_time_) {
+    // label each group of axioms, QuickXplain prefers the groups
+    // that come first, i.e. the ones with a smaller delay
+    TermVec assumps;
+    for (const auto & group : sorted_nonconsec_ax) {
+      Term unrolled_group = super::solver_->make_term(true);
+      for (const auto & ax_inst : group) {
+        size_t max_k =
+            abs_ts_.no_next(ax_inst.ax) ? reached_k_ + 1 : reached_k_;
+        for (size_t k = 0; k <= max_k; ++k) {
+          unrolled_group = super::solver_->make_term(
+              And, unrolled_group, abs_unroller_.at_time(ax_inst.ax, k));
+        }
+      }
+      Term lbl = label(unrolled_group);
+      super::solver_->assert_formula(
+          super::solver_->make_term(Implies, lbl, unrolled_group));
+      assumps.push_back(lbl);
+    }
+
+    TermVec min_core;
+    CoreMinimizer minimizer(super::solver_,
+                            super::options_.cegar_core_min_time_);
+    if (minimizer.minimize(assumps, min_core)) {
+      UnorderedTermSet kept(min_core.begin(), min_core.end());
+      for (size_t i = 0; i < assumps.size(); ++i) {
+        include_axioms[i] = kept.find(assumps[i]) != kept.end();
+      }
+    }
+  }
+
   Result res;
-  for (int i = sorted_nonconsec_ax.size() - 1; i >= 0; --i) {
+  for (int i = sorted_nonconsec_ax.size() - 1;
+       !super::options_.cegar_core_min_time_ && i >= 0;
+       --i) {
     super::solver_->push();
     // assert all the included axioms except the i-th
     for (size_t j = 0; j < include_axioms.size(); j++) {
@@ -573,6 +687,7 @@ void CegProphecyArrays<Prover_T>::refine_ts(const UnorderedTermSet & consecutive
   RelationalTransitionSystem & rts =
     static_cast<RelationalTransitionSystem &>(abs_ts_);
   for (const auto & ax : consecutive_axioms) {
+    export_refinement(ax);
     if (reached_k_ == -1) {
       // if only checking initial state
       // need to add to init
@@ -589,6 +704,29 @@ void CegProphecyArrays<Prover_T>::refine_ts(const UnorderedTermSet & consecutive
   refine_subprover_ts(consecutive_axioms);
 }
 
+template <class Prover_T>
+void CegProphecyArrays<Prover_T>::export_refinement(const Term & ax)
+{
+  if (!super::refinement_cache_
+      || super::refinement_cache_->solver() != conc_ts_.solver()) {
+    return;
+  }
+
+  // axioms over witnesses, lambdas or prophecy variables only make sense
+  // for this abstraction
+  Term abs_ax = ax;
+  Term conc_ax = aa_.concrete(abs_ax);
+  UnorderedTermSet free_vars;
+  get_free_symbolic_consts(conc_ax, free_vars);
+  for (const auto & v : free_vars) {
+    if (!conc_ts_.is_curr_var(v) && !conc_ts_.is_next_var(v)
+        && !conc_ts_.is_input_var(v)) {
+      return;
+    }
+  }
+  super::refinement_cache_->add(conc_ax);
+}
+
 template <class Prover_T>
 void CegProphecyArrays<Prover_T>::refine_subprover_ts(const UnorderedTermSet & consecutive_axioms)
 {
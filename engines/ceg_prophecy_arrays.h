@@ -69,6 +69,18 @@ class CegProphecyArrays : public CEGAR<Prover_T>
 
   smt::UnorderedTermMap labels_;  ///< labels for unsat core minimization
 
+  // prover on abs_ts_ when it is restarted after each refinement
+  std::shared_ptr<Prover> restart_prover_;
+  size_t restart_num_vars_;  ///< number of variables of abs_ts_ when
+                             ///< restart_prover_ was created
+
+  // the unrolled abstract system, reused across refinements
+  // bmc_prefix_[k] is init@0 /\ trans@0 /\ ... /\ trans@(k-1)
+  // it is rebuilt only when the abstract init or trans change
+  smt::TermVec bmc_prefix_;
+  smt::Term bmc_prefix_init_;   ///< abstract init used in bmc_prefix_
+  smt::Term bmc_prefix_trans_;  ///< abstract trans used in bmc_prefix_
+
   smt::UnorderedTermSet
       important_vars_;  ///< important variables
                         ///< useful for IC3IA to prioritize predicates
@@ -78,7 +90,21 @@ class CegProphecyArrays : public CEGAR<Prover_T>
   void cegar_abstract() override;
   bool cegar_refine() override;
 
+  /** Also reports the index set and axiom candidates of aae_ */
+  void report_memory() override;
+
+  /** Also drops the axiom candidates of aae_ and the term caches of
+   *  abs_unroller_
+   */
+  void reduce_memory() override;
+
   // helpers
+
+  /** Returns the abstract BMC formula reaching bad at bound b
+   *  Extends bmc_prefix_ one step at a time as the bound grows
+   *  @param b the bound
+   *  @return init@0 /\ trans@0 /\ ... /\ trans@(b-1) /\ bad@b
+   */
   smt::Term get_bmc_formula(size_t b);
 
   /** Unsat core based axiom reduction
@@ -111,6 +137,11 @@ class CegProphecyArrays : public CEGAR<Prover_T>
 
   void refine_subprover_ts(const smt::UnorderedTermSet & consecutive_axioms);
 
+  /** Add a consecutive axiom to the refinement cache (if there is one)
+   *  when its concrete version is only over variables of conc_ts_
+   */
+  void export_refinement(const smt::Term & ax);
+
   void add_important_var(const smt::Term & v);
 };
 
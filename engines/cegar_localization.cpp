@@ -0,0 +1,276 @@
+/*********************                                                        */
+/*! \file cegar_localization.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A CEGAR loop for localization abstraction: latches outside of
+**        the abstraction are cut (their next state and initial value
+**        become free) and the latches in the unsat core of a BMC check
+**        of each spurious counterexample are added back
+**
+**/
+
+#include "engines/cegar_localization.h"
+
+#include "assert.h"
+#include "smt-switch/utils.h"
+#include "smt/available_solvers.h"
+#include "utils/core_minimizer.h"
+#include "utils/exceptions.h"
+#include "utils/logger.h"
+#include "utils/make_provers.h"
+#include "utils/timeline.h"
+#include "utils/ts_manipulation.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+CegarLocalization::CegarLocalization(const Property & p,
+                                     const TransitionSystem & ts,
+                                     const SmtSolver & solver,
+                                     PonoOptions opt)
+    : super(p, ts, solver, opt), abs_ts_(create_fresh_ts(true, solver))
+{
+  if (!ts.is_functional()) {
+    throw PonoException(
+        "Localization abstraction requires a functional transition system");
+  }
+  engine_ = options_.engine_;
+  solver_->set_opt("produce-unsat-assumptions", "true");
+}
+
+void CegarLocalization::initialize()
+{
+  if (initialized_) {
+    return;
+  }
+  super::initialize();
+
+  Sort boolsort = solver_->make_sort(BOOL);
+  size_t i = 0;
+  for (const auto & elem : ts_.state_updates()) {
+    Term lbl = solver_->make_symbol(
+        "__loc_assump_" + std::to_string(i++), boolsort);
+    latch_labels_[elem.first] = lbl;
+    label_latches_[lbl] = elem.first;
+  }
+
+  TermVec conjuncts;
+  conjunctive_partition(ts_.init(), conjuncts, true);
+  for (const auto & c : conjuncts) {
+    UnorderedTermSet free_vars;
+    get_free_symbolic_consts(c, free_vars);
+    UnorderedTermSet labels;
+    for (const auto & v : free_vars) {
+      auto it = latch_labels_.find(v);
+      if (it != latch_labels_.end()) {
+        labels.insert(it->second);
+      }
+    }
+    init_conjuncts_.push_back({ c, labels });
+  }
+
+  if (options_.ceg_localization_pba_) {
+    // proof-based abstraction: keep the latches needed to refute the
+    // counterexamples up to the bound
+    for (size_t j = 0; j <= options_.ceg_localization_pba_; ++j) {
+      if (interrupted()) {
+        break;
+      }
+      Result r = check_concrete(j, kept_);
+      if (!r.is_unsat()) {
+        // a real counterexample (witness_ is set) or unknown
+        break;
+      }
+    }
+    logger.log(1,
+               "CegarLocalization: {} latches in the cores of BMC up to {}",
+               kept_.size(),
+               options_.ceg_localization_pba_);
+  } else {
+    UnorderedTermSet prop_vars;
+    get_free_symbolic_consts(bad_, prop_vars);
+    for (const auto & v : prop_vars) {
+      if (latch_labels_.find(v) != latch_labels_.end()) {
+        kept_.insert(v);
+      }
+    }
+  }
+  stats_->set("latches", latch_labels_.size());
+}
+
+ProverResult CegarLocalization::check_until(int k)
+{
+  initialize();
+  if (witness_.size()) {
+    // found by the proof-based abstraction
+    return ProverResult::FALSE;
+  }
+
+  while (true) {
+    if (interrupted()) {
+      return ProverResult::UNKNOWN;
+    }
+
+    cegar_abstract();
+    // the engine keeps no state across abstractions, use a fresh one
+    SmtSolver s = create_solver_for(solver_->get_solver_enum(),
+                                    options_.engine_,
+                                    options_.logging_smt_solver_);
+    Property abs_prop(solver_, solver_->make_term(Not, bad_));
+    abs_prover_ = make_prover(options_.engine_, abs_prop, abs_ts_, s, options_);
+    ProverResult res = abs_prover_->check_until(k);
+
+    if (res == ProverResult::FALSE) {
+      if (!cegar_refine()) {
+        return witness_.size() ? ProverResult::FALSE : ProverResult::UNKNOWN;
+      }
+      continue;
+    }
+
+    if (res == ProverResult::TRUE) {
+      // an invariant of the abstraction is one of the concrete system
+      try {
+        invar_ = abs_prover_->invar();
+      }
+      catch (PonoException & e) {
+        // the engine doesn't support invariants
+      }
+    }
+    return res;
+  }
+}
+
+void CegarLocalization::cegar_abstract()
+{
+  abs_ts_ = create_fresh_ts(true, solver_);
+  for (const auto & sv : ts_.statevars()) {
+    abs_ts_.add_statevar(sv, ts_.next(sv));
+  }
+  for (const auto & iv : ts_.inputvars()) {
+    abs_ts_.add_inputvar(iv);
+  }
+
+  // cut latches have no update and no initial value
+  for (const auto & elem : ts_.state_updates()) {
+    if (kept_.find(elem.first) != kept_.end()) {
+      abs_ts_.assign_next(elem.first, elem.second);
+    }
+  }
+  for (const auto & ic : init_conjuncts_) {
+    bool keep = true;
+    for (const auto & lbl : ic.second) {
+      keep &= kept_.find(label_latches_.at(lbl)) != kept_.end();
+    }
+    if (keep) {
+      abs_ts_.constrain_init(ic.first);
+    }
+  }
+  // the constraints of the concrete system over cut latches still hold
+  // for any value of the latch
+  for (const auto & c : ts_.constraints()) {
+    abs_ts_.add_constraint(c.first, c.second);
+  }
+
+  stats_->set("localization_latches", kept_.size());
+  logger.log(1,
+             "CegarLocalization: abstraction with {} of {} latches",
+             kept_.size(),
+             latch_labels_.size());
+}
+
+bool CegarLocalization::cegar_refine()
+{
+  TIMELINE_SPAN("cegar_localization_refine");
+  stats_->increment("cegar_refinements");
+  size_t cex_length = abs_prover_->witness_length();
+
+  UnorderedTermSet core_latches;
+  Result r = check_concrete(cex_length, core_latches);
+  if (!r.is_unsat()) {
+    // a real counterexample (witness_ is set) or unknown
+    return false;
+  }
+
+  size_t num_kept = kept_.size();
+  for (const auto & l : core_latches) {
+    if (kept_.insert(l).second) {
+      logger.log(2, "CegarLocalization adding latch {}", l);
+    }
+  }
+  if (kept_.size() == num_kept) {
+    logger.log(1,
+               "CegarLocalization: no latch refutes the counterexample of "
+               "length {}",
+               cex_length);
+    return false;
+  }
+  return true;
+}
+
+Result CegarLocalization::check_concrete(size_t len,
+                                         UnorderedTermSet & core_latches)
+{
+  solver_->push();
+
+  for (const auto & ic : init_conjuncts_) {
+    Term c = unroller_.at_time(ic.first, 0);
+    for (const auto & lbl : ic.second) {
+      c = solver_->make_term(Implies, lbl, c);
+    }
+    solver_->assert_formula(c);
+  }
+  for (size_t i = 0; i <= len; ++i) {
+    for (const auto & c : ts_.constraints()) {
+      solver_->assert_formula(unroller_.at_time(c.first, i));
+    }
+  }
+  for (size_t i = 0; i < len; ++i) {
+    for (const auto & elem : ts_.state_updates()) {
+      Term eq = solver_->make_term(Equal, ts_.next(elem.first), elem.second);
+      solver_->assert_formula(solver_->make_term(
+          Implies, latch_labels_.at(elem.first), unroller_.at_time(eq, i)));
+    }
+  }
+  solver_->assert_formula(unroller_.at_time(bad_, len));
+
+  // the core minimization prefers the latches already kept
+  TermVec assumps;
+  for (const auto & l : kept_) {
+    assumps.push_back(latch_labels_.at(l));
+  }
+  for (const auto & elem : latch_labels_) {
+    if (kept_.find(elem.first) == kept_.end()) {
+      assumps.push_back(elem.second);
+    }
+  }
+
+  Result r = check_sat_assuming(assumps);
+  if (r.is_sat()) {
+    reached_k_ = static_cast<int>(len) - 1;
+    witness_.clear();
+    compute_witness();
+  } else if (r.is_unsat()) {
+    UnorderedTermSet core;
+    solver_->get_unsat_assumptions(core);
+    if (options_.cegar_core_min_time_) {
+      minimize_core(solver_, assumps, core, options_.cegar_core_min_time_);
+    }
+    for (const auto & lbl : core) {
+      core_latches.insert(label_latches_.at(lbl));
+    }
+  }
+
+  solver_->pop();
+  return r;
+}
+
+}  // namespace pono
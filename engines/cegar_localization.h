@@ -0,0 +1,80 @@
+/*********************                                                        */
+/*! \file cegar_localization.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A CEGAR loop for localization abstraction: latches outside of
+**        the abstraction are cut (their next state and initial value
+**        become free) and the latches in the unsat core of a BMC check
+**        of each spurious counterexample are added back
+**
+**/
+
+#pragma once
+
+#include "engines/cegar.h"
+
+namespace pono {
+
+/** Localization abstraction of a functional transition system
+ *  The abstraction is checked by a fresh prover of options_.engine_,
+ *  re-created after each refinement. The concrete checks run on solver_
+ *  with an assumption label for the update and initial value of each
+ *  latch, and the latches of the (minimized) unsat core are added to the
+ *  abstraction. With options_.ceg_localization_pba_ > 0, the initial
+ *  abstraction is the latches of the unsat cores of BMC up to that bound
+ *  (proof-based abstraction), otherwise the latches of the property.
+ */
+class CegarLocalization : public CEGAR<Prover>
+{
+  typedef CEGAR<Prover> super;
+
+ public:
+  CegarLocalization(const Property & p,
+                    const TransitionSystem & ts,
+                    const smt::SmtSolver & solver,
+                    PonoOptions opt = PonoOptions());
+
+  void initialize() override;
+
+  ProverResult check_until(int k) override;
+
+  /** @return the latches currently in the abstraction */
+  const smt::UnorderedTermSet & kept_latches() const { return kept_; }
+
+ protected:
+  /** Rebuild abs_ts_ from ts_ and kept_ */
+  void cegar_abstract() override;
+
+  /** Check the counterexample length of the abstract prover on the
+   *  concrete system and add the latches of the unsat core to kept_
+   *  @return true iff new latches were added, false if the counterexample
+   *          is real (then witness_ is set) or no latch could be added
+   */
+  bool cegar_refine() override;
+
+  /** Check whether bad_ is reachable in exactly len steps in ts_
+   *  under the assumption labels of all the latches
+   *  If it is, computes the witness. If not, adds the latches of the
+   *  unsat core to core_latches.
+   *  @return the result of the query
+   */
+  smt::Result check_concrete(size_t len, smt::UnorderedTermSet & core_latches);
+
+  TransitionSystem abs_ts_;  ///< the abstraction, over solver_
+  std::shared_ptr<Prover> abs_prover_;  ///< prover of the last abstraction
+
+  smt::UnorderedTermSet kept_;  ///< latches in the abstraction
+  smt::UnorderedTermMap latch_labels_;  ///< assumption label of each latch
+  smt::UnorderedTermMap label_latches_;  ///< latch of each label
+  // conjuncts of init and the labels of the latches they constrain
+  std::vector<std::pair<smt::Term, smt::UnorderedTermSet>> init_conjuncts_;
+};
+
+}  // namespace pono
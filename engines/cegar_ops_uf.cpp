@@ -22,10 +22,13 @@
 #include "engines/ic3sa.h"
 #include "engines/ceg_prophecy_arrays.h"
 #include "smt/available_solvers.h"
+#include "utils/core_minimizer.h"
 #include "utils/exceptions.h"
 #include "utils/logger.h"
 #include "utils/make_provers.h"
 #include "utils/term_analysis.h"
+#include "utils/thread_placement.h"
+#include "utils/timeline.h"
 #include "utils/ts_manipulation.h"
 
 using namespace smt;
@@ -47,7 +50,8 @@ CegarOpsUf<Prover_T>::CegarOpsUf(const Property & p,
       to_cegopsuf_solver_(cegopsuf_solver_),
       from_cegopsuf_solver_(super::prover_interface_ts().solver()),
       cegopsuf_ts_(cegopsuf_solver_),
-      cegopsuf_un_(cegopsuf_ts_)
+      cegopsuf_un_(cegopsuf_ts_),
+      max_op_refinements_(0)
 {
   cegopsuf_solver_->set_opt("produce-unsat-assumptions", "true");
 }
@@ -142,6 +146,8 @@ void CegarOpsUf<Prover_T>::cegar_abstract()
 template <class Prover_T>
 bool CegarOpsUf<Prover_T>::cegar_refine()
 {
+  TIMELINE_SPAN("cegar_ops_uf_refine");
+  super::stats_->increment("cegar_refinements");
   const UnorderedTermMap & abs_terms = oa_.abstract_terms();
   if (abs_terms.size() == 0) {
     return false;
@@ -163,6 +169,8 @@ bool CegarOpsUf<Prover_T>::cegar_refine()
 
   TermVec assumps;
   TermVec equalities;
+  TermVec apps;  // the UF application of each equality
+  Term query = bmcform;  // for the parallel checks
   for (const auto & elem : abs_terms) {
     Term l = to_cegopsuf_solver_.transfer_term(elem.first);
     Term r = to_cegopsuf_solver_.transfer_term(elem.second);
@@ -182,22 +190,92 @@ bool CegarOpsUf<Prover_T>::cegar_refine()
     }
 
     equalities.push_back(uf_eq);
+    apps.push_back(l);
     Term imp = cegopsuf_solver_->make_term(Implies, lbl, unrolled_uf_eq);
     cegopsuf_solver_->assert_formula(imp);
+    query = cegopsuf_solver_->make_term(And, query, imp);
     assumps.push_back(lbl);
   }
   assert(assumps.size() == equalities.size());
 
-  Result r = cegopsuf_solver_->check_sat_assuming(assumps);
+  // first check the instances of each abstracted operator on their own,
+  // refining all the operators that rule out the counterexample at once
+  Result r;
+  UnorderedTermSet core;
+  size_t num_threads =
+      num_worker_threads(super::options_, super::options_.cegar_refine_threads_);
+  if (num_threads > 1) {
+    vector<TermVec> groups;
+    unordered_map<Term, size_t> group_idx;
+    for (size_t i = 0; i < assumps.size(); ++i) {
+      auto it = group_idx.emplace(*(apps[i]->begin()), groups.size()).first;
+      if (it->second == groups.size()) {
+        groups.push_back({});
+      }
+      groups[it->second].push_back(assumps[i]);
+    }
+    if (groups.size() > 1) {
+      size_t num_unsat = split_unsat_cores(cegopsuf_solver_,
+                                           query,
+                                           groups,
+                                           num_threads,
+                                           super::options_.cegar_core_min_time_,
+                                           core);
+      logger.log(2,
+                 "CegarOpsUf {} of {} operators rule out the counterexample",
+                 num_unsat,
+                 groups.size());
+      if (num_unsat) {
+        super::stats_->increment("cegar_split_refinements");
+        r = Result(UNSAT);
+      }
+    }
+  }
+
+  if (!r.is_unsat()) {
+    r = cegopsuf_solver_->check_sat_assuming(assumps);
+    if (r.is_unsat()) {
+      cegopsuf_solver_->get_unsat_assumptions(core);
+      if (super::options_.cegar_core_min_time_) {
+        minimize_core(cegopsuf_solver_,
+                      assumps,
+                      core,
+                      super::options_.cegar_core_min_time_);
+      }
+    }
+  }
 
   // do refinement if needed
   if (r.is_unsat()) {
     UnorderedTermSet axioms;
-    UnorderedTermSet core;
-    cegopsuf_solver_->get_unsat_assumptions(core);
+
+    vector<bool> refine(assumps.size(), false);
+    UnorderedTermSet saturated_ops;
+    for (size_t i = 0; i < assumps.size(); ++i) {
+      if (core.find(assumps[i]) == core.end()) {
+        continue;
+      }
+      refine[i] = true;
+      const Term & app = apps[i];
+      if (max_op_refinements_ && refined_.insert(app).second) {
+        Term uf = *(app->begin());
+        if (++op_refinements_[uf] == max_op_refinements_) {
+          logger.log(1, "CegarOpsUf refining all instances of {}", uf);
+          saturated_ops.insert(uf);
+        }
+      }
+    }
+    if (saturated_ops.size()) {
+      for (size_t i = 0; i < equalities.size(); ++i) {
+        if (saturated_ops.find(*(apps[i]->begin())) != saturated_ops.end()) {
+          refine[i] = true;
+          refined_.insert(apps[i]);
+        }
+      }
+    }
 
     for (size_t i = 0; i < assumps.size(); ++i) {
-      if (core.find(assumps[i]) != core.end()) {
+      if (refine[i]) {
         Term eq = equalities[i];
         axioms.insert(eq);
         logger.log(2, "CegarOpsUf adding refinement axiom {}", eq);
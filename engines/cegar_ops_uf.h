@@ -39,6 +39,16 @@ class CegarOpsUf : public CEGAR<Prover_T>
 
   void set_min_bitwidth(size_t w) { oa_.set_min_bitwidth(w); };
 
+  /** Only abstract operator instances with at least this estimated cost
+   *  (see OpsAbstractor::instance_cost)
+   */
+  void set_min_cost(size_t c) { oa_.set_min_cost(c); };
+
+  /** Once n instances of an abstracted operator (of one sort) were
+   *  refined, refine all of its instances at once. 0 disables this.
+   */
+  void set_max_op_refinements(size_t n) { max_op_refinements_ = n; };
+
   void initialize() override;
 
   ProverResult check_until(int k) override;
@@ -69,6 +79,12 @@ class CegarOpsUf : public CEGAR<Prover_T>
 
   smt::UnorderedTermMap cegopsuf_labels_;  // labels for each abstract uf
 
+  size_t max_op_refinements_;
+  std::unordered_map<smt::Term, size_t>
+      op_refinements_;  ///< number of refined instances of each
+                        ///< abstract operator (in cegopsuf_solver_)
+  smt::UnorderedTermSet refined_;  ///< refined instances (cegopsuf_solver_)
+
 };
 
 } // namespace pono
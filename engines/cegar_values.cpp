@@ -16,18 +16,26 @@
 
 #include "engines/cegar_values.h"
 
+#include <algorithm>
+#include <memory>
 #include <unordered_set>
 
+#include "gmpxx.h"
+
 #include "core/fts.h"
 #include "core/rts.h"
 #include "engines/ceg_prophecy_arrays.h"
 #include "engines/ic3ia.h"
 #include "math.h"
+#include "printers/witness_values.h"
 #include "smt-switch/identity_walker.h"
 #include "smt/available_solvers.h"
+#include "utils/core_minimizer.h"
 #include "utils/exceptions.h"
 #include "utils/logger.h"
 #include "utils/make_provers.h"
+#include "utils/thread_placement.h"
+#include "utils/timeline.h"
 #include "utils/ts_manipulation.h"
 
 using namespace smt;
@@ -60,8 +68,6 @@ class ValueAbstractor : public smt::IdentityWalker
         ts_(ts),
         abstracted_values_(abstracted_values),
         boolsort_(ts_.solver()->make_sort(BOOL)),
-        fresh_solver_(create_solver(ts_.solver()->get_solver_enum())),
-        to_fresh_solver_(fresh_solver_),
         cutoff_(cutoff)
   {
   }
@@ -81,42 +87,18 @@ class ValueAbstractor : public smt::IdentityWalker
           return Walker_Continue;
         }
 
-        // TODO determine if value is within cutoff and whether
-        // it's positive or negative without using a solver call
-
-        Term fresh_solver_term = to_fresh_solver_.transfer_term(term);
-
-        Term zero = fresh_solver_->make_term(0, sort);
-        Op minus = (sk == BV) ? BVSub : Minus;
-        Op lt = (sk == BV) ? BVUlt : Lt;
-        Op gt = (sk == BV) ? BVUgt : Gt;
-
-        Term cutoff_term = fresh_solver_->make_term(cutoff_, sort);
-        Term neg_cutoff_term =
-            fresh_solver_->make_term(minus, zero, cutoff_term);
-
-        fresh_solver_->push();
-
-        fresh_solver_->assert_formula(
-            fresh_solver_->make_term(lt, fresh_solver_term, cutoff_term));
-        fresh_solver_->assert_formula(
-            fresh_solver_->make_term(gt, fresh_solver_term, neg_cutoff_term));
-        Result r = fresh_solver_->check_sat();
-
-        fresh_solver_->pop();
+        bool within_cutoff;
+        bool nonneg;
+        if (!classify_value(term, within_cutoff, nonneg)) {
+          // couldn't parse the value, ask a solver
+          classify_value_with_solver(term, within_cutoff, nonneg);
+        }
 
-        if (r.is_sat()) {
+        if (within_cutoff) {
           save_in_cache(term, term);
           return Walker_Continue;
         }
 
-        fresh_solver_->push();
-        fresh_solver_->assert_formula(
-            fresh_solver_->make_term(lt, fresh_solver_term, zero));
-        r = fresh_solver_->check_sat();
-        bool nonneg = r.is_unsat();
-        fresh_solver_->pop();
-
         // create a frozen variable
         Term frozen_var =
             ts_.make_statevar("__abs_" + term->to_string(), term->get_sort());
@@ -126,7 +108,11 @@ class ValueAbstractor : public smt::IdentityWalker
         abstracted_values_[frozen_var] = term;
 
         // save a polarity axiom over ts terms
-        Term ts_zero = ts_.make_term(0, frozen_var->get_sort());
+        Op lt = (sk == BV) ? BVUlt : Lt;
+        Term & ts_zero = zeros_[sort];
+        if (!ts_zero) {
+          ts_zero = ts_.make_term(0, sort);
+        }
         Term polarity_axiom = ts_.make_term(lt, frozen_var, ts_zero);
         if (nonneg) {
           polarity_axiom = ts_.make_term(Not, polarity_axiom);
@@ -155,13 +141,138 @@ class ValueAbstractor : public smt::IdentityWalker
     return Walker_Continue;
   }
 
+  /** Determines whether a value is strictly between -cutoff_ and cutoff_
+   *  and whether it is non-negative, by parsing the value.
+   *  Bit-vectors are compared with unsigned comparisons, where -cutoff_
+   *  is 2^width - cutoff_ (as the solver would compute it).
+   *  @return false if the value could not be parsed
+   */
+  bool classify_value(const Term & val, bool & within_cutoff, bool & nonneg)
+  {
+    Sort sort = val->get_sort();
+    mpq_class cutoff(mpz_class(std::to_string(cutoff_), 10));
+    if (sort->get_sort_kind() == BV) {
+      mpz_class v;
+      mpz_class modulus;
+      try {
+        v = mpz_class(value_bits(val), 2);
+      }
+      catch (std::exception & e) {
+        return false;
+      }
+      mpz_ui_pow_ui(modulus.get_mpz_t(), 2, sort->get_width());
+      mpz_class c = cutoff.get_num() % modulus;
+      mpz_class neg_c = (modulus - c) % modulus;
+      within_cutoff = v < c && v > neg_c;
+      // no unsigned value is less than zero
+      nonneg = true;
+      return true;
+    }
+
+    mpq_class v;
+    if (!rational_value(val->to_string(), v)) {
+      return false;
+    }
+    within_cutoff = v < cutoff && v > -cutoff;
+    nonneg = v >= 0;
+    return true;
+  }
+
+  /** Parses an integer or real value printed in SMT-LIB format
+   *  e.g. 3, 2.5, (- 3), (/ 1 2) or (- (/ 1 2))
+   *  @return false if it could not be parsed
+   */
+  static bool rational_value(std::string repr, mpq_class & out)
+  {
+    bool neg = false;
+    if (repr.size() > 4 && repr.compare(0, 3, "(- ") == 0
+        && repr.back() == ')') {
+      neg = true;
+      repr = repr.substr(3, repr.size() - 4);
+    }
+
+    if (repr.size() > 4 && repr.compare(0, 3, "(/ ") == 0
+        && repr.back() == ')') {
+      string body = repr.substr(3, repr.size() - 4);
+      size_t space = body.find(' ');
+      if (space == string::npos) {
+        return false;
+      }
+      mpq_class num, den;
+      if (!rational_value(body.substr(0, space), num)
+          || !rational_value(body.substr(space + 1), den) || den == 0) {
+        return false;
+      }
+      out = num / den;
+    } else {
+      size_t dot = repr.find('.');
+      string digits = repr;
+      mpz_class scale = 1;
+      if (dot != string::npos) {
+        digits = repr.substr(0, dot) + repr.substr(dot + 1);
+        mpz_ui_pow_ui(scale.get_mpz_t(), 10, repr.size() - dot - 1);
+      }
+      if (digits.empty()
+          || digits.find_first_not_of("0123456789") != string::npos) {
+        return false;
+      }
+      out = mpq_class(mpz_class(digits, 10), scale);
+      out.canonicalize();
+    }
+
+    if (neg) {
+      out = -out;
+    }
+    return true;
+  }
+
+  /** Fallback for classify_value using a fresh solver */
+  void classify_value_with_solver(const Term & term,
+                                  bool & within_cutoff,
+                                  bool & nonneg)
+  {
+    if (!fresh_solver_) {
+      fresh_solver_ = create_solver(ts_.solver()->get_solver_enum());
+      to_fresh_solver_.reset(new TermTranslator(fresh_solver_));
+    }
+
+    Sort sort = term->get_sort();
+    SortKind sk = sort->get_sort_kind();
+    Term fresh_solver_term = to_fresh_solver_->transfer_term(term);
+    Sort fresh_sort = fresh_solver_term->get_sort();
+
+    Term zero = fresh_solver_->make_term(0, fresh_sort);
+    Op minus = (sk == BV) ? BVSub : Minus;
+    Op lt = (sk == BV) ? BVUlt : Lt;
+    Op gt = (sk == BV) ? BVUgt : Gt;
+
+    Term cutoff_term = fresh_solver_->make_term(cutoff_, fresh_sort);
+    Term neg_cutoff_term = fresh_solver_->make_term(minus, zero, cutoff_term);
+
+    fresh_solver_->push();
+    fresh_solver_->assert_formula(
+        fresh_solver_->make_term(lt, fresh_solver_term, cutoff_term));
+    fresh_solver_->assert_formula(
+        fresh_solver_->make_term(gt, fresh_solver_term, neg_cutoff_term));
+    within_cutoff = fresh_solver_->check_sat().is_sat();
+    fresh_solver_->pop();
+
+    fresh_solver_->push();
+    fresh_solver_->assert_formula(
+        fresh_solver_->make_term(lt, fresh_solver_term, zero));
+    nonneg = fresh_solver_->check_sat().is_unsat();
+    fresh_solver_->pop();
+  }
+
   TransitionSystem & ts_;
   UnorderedTermMap & abstracted_values_;
   Sort boolsort_;
   TermVec polarity_axioms_;
+  std::unordered_map<Sort, Term> zeros_;  ///< zero of each sort in ts_
 
-  SmtSolver fresh_solver_;  ///< solver just for the range check
-  TermTranslator to_fresh_solver_;
+  SmtSolver fresh_solver_;  ///< solver for values that can't be parsed
+                            ///< created on first use
+  std::unique_ptr<TermTranslator> to_fresh_solver_;
   size_t cutoff_;
 };
 
@@ -311,6 +422,8 @@ void CegarValues<Prover_T>::cegar_abstract()
 template <class Prover_T>
 bool CegarValues<Prover_T>::cegar_refine()
 {
+  TIMELINE_SPAN("cegar_values_refine");
+  super::stats_->increment("cegar_refinements");
   size_t cex_length = super::witness_length();
 
   // create bmc formula for abstract system
@@ -328,6 +441,7 @@ bool CegarValues<Prover_T>::cegar_refine()
   // TODO add lemmas to both cegval_ts_ and prover_ts_
   TermVec assumps;
   TermVec equalities;
+  Term query = bmcform;  // for the parallel checks
   for (const auto & elem : to_vals_) {
     assert(cegval_ts_.is_curr_var(elem.first));
     assert(elem.second->is_value());
@@ -339,16 +453,55 @@ bool CegarValues<Prover_T>::cegar_refine()
     Term eqval0 = cegval_un_.at_time(eqval, 0);
     Term imp = cegval_solver_->make_term(Implies, lbl, eqval0);
     cegval_solver_->assert_formula(imp);
+    query = cegval_solver_->make_term(And, query, imp);
   }
   assert(assumps.size() == equalities.size());
 
-  Result r = cegval_solver_->check_sat_assuming(assumps);
+  // first check a few groups of the values on their own, refining with all
+  // the groups that rule out the counterexample at once
+  Result r;
+  UnorderedTermSet core;
+  size_t num_threads =
+      num_worker_threads(super::options_, super::options_.cegar_refine_threads_);
+  num_threads = std::min(num_threads, assumps.size());
+  if (num_threads > 1) {
+    // group t gets the values [t * n / num_threads, (t + 1) * n / num_threads)
+    const size_t n = assumps.size();
+    vector<TermVec> groups(num_threads);
+    for (size_t t = 0; t < num_threads; ++t) {
+      groups[t].assign(assumps.begin() + t * n / num_threads,
+                       assumps.begin() + (t + 1) * n / num_threads);
+    }
+    size_t num_unsat = split_unsat_cores(cegval_solver_,
+                                         query,
+                                         groups,
+                                         num_threads,
+                                         super::options_.cegar_core_min_time_,
+                                         core);
+    logger.log(2,
+               "CegarValues {} of {} groups rule out the counterexample",
+               num_unsat,
+               groups.size());
+    if (num_unsat) {
+      super::stats_->increment("cegar_split_refinements");
+      r = Result(UNSAT);
+    }
+  }
+
+  if (!r.is_unsat()) {
+    r = cegval_solver_->check_sat_assuming(assumps);
+    if (r.is_unsat()) {
+      cegval_solver_->get_unsat_assumptions(core);
+      if (super::options_.cegar_core_min_time_) {
+        minimize_core(
+            cegval_solver_, assumps, core, super::options_.cegar_core_min_time_);
+      }
+    }
+  }
 
   // do refinement if needed
   if (r.is_unsat()) {
-    UnorderedTermSet core;
     UnorderedTermSet axioms;
-    cegval_solver_->get_unsat_assumptions(core);
     for (size_t i = 0; i < assumps.size(); ++i) {
       if (core.find(assumps[i]) != core.end()) {
         Term eq = equalities[i];
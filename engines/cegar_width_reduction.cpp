@@ -0,0 +1,139 @@
+/*********************                                                        */
+/*! \file cegar_width_reduction.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A CEGAR loop for datapath width reduction: the data that is
+**        only moved around is reduced to a few bits, and the
+**        counterexamples of the reduced system are checked on the
+**        concrete one by BMC
+**
+**/
+
+#include "engines/cegar_width_reduction.h"
+
+#include "smt/available_solvers.h"
+#include "utils/exceptions.h"
+#include "utils/logger.h"
+#include "utils/make_provers.h"
+#include "utils/timeline.h"
+#include "utils/ts_manipulation.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+CegarWidthReduction::CegarWidthReduction(const Property & p,
+                                         const TransitionSystem & ts,
+                                         const SmtSolver & solver,
+                                         PonoOptions opt)
+    : super(p, ts, solver, opt), abs_ts_(create_fresh_ts(true, solver))
+{
+  if (!ts.is_functional()) {
+    throw PonoException(
+        "Width reduction requires a functional transition system");
+  }
+  engine_ = options_.engine_;
+}
+
+void CegarWidthReduction::initialize()
+{
+  if (initialized_) {
+    return;
+  }
+  super::initialize();
+
+  reducer_.reset(new WidthReducer(ts_, bad_));
+  stats_->set("width_reduction_classes", reducer_->num_classes());
+}
+
+ProverResult CegarWidthReduction::check_until(int k)
+{
+  initialize();
+
+  while (true) {
+    if (interrupted()) {
+      return ProverResult::UNKNOWN;
+    }
+
+    cegar_abstract();
+    // the engine keeps no state across abstractions, use a fresh one
+    SmtSolver s = create_solver_for(solver_->get_solver_enum(),
+                                    options_.engine_,
+                                    options_.logging_smt_solver_);
+    Property abs_prop(solver_, solver_->make_term(Not, abs_bad_));
+    abs_prover_ = make_prover(options_.engine_, abs_prop, abs_ts_, s, options_);
+    ProverResult res = abs_prover_->check_until(k);
+
+    if (res == ProverResult::FALSE) {
+      if (!cegar_refine()) {
+        return witness_.size() ? ProverResult::FALSE : ProverResult::UNKNOWN;
+      }
+      continue;
+    }
+
+    // NOTE: an invariant of the reduced system is over the reduced
+    // values, it is not one of the concrete system
+    return res;
+  }
+}
+
+void CegarWidthReduction::cegar_abstract()
+{
+  abs_ts_ = reducer_->abstract(abs_bad_);
+  stats_->set("width_reduction_reduced", reducer_->num_reduced());
+  logger.log(1,
+             "CegarWidthReduction: {} of {} classes reduced",
+             reducer_->num_reduced(),
+             reducer_->num_classes());
+}
+
+bool CegarWidthReduction::cegar_refine()
+{
+  TIMELINE_SPAN("cegar_width_reduction_refine");
+  stats_->increment("cegar_refinements");
+  size_t cex_length = abs_prover_->witness_length();
+
+  Result r = check_concrete(cex_length);
+  if (!r.is_unsat()) {
+    // a real counterexample (witness_ is set) or unknown
+    return false;
+  }
+
+  // the reduction is exact, this is only a safety net
+  logger.log(1,
+             "CegarWidthReduction: spurious counterexample of length {}, "
+             "restoring the concrete widths",
+             cex_length);
+  return reducer_->refine();
+}
+
+Result CegarWidthReduction::check_concrete(size_t len)
+{
+  solver_->push();
+
+  solver_->assert_formula(unroller_.at_time(ts_.init(), 0));
+  for (size_t i = 0; i < len; ++i) {
+    solver_->assert_formula(unroller_.at_time(ts_.trans(), i));
+  }
+  solver_->assert_formula(unroller_.at_time(bad_, len));
+
+  Result r = check_sat();
+  if (r.is_sat()) {
+    reached_k_ = static_cast<int>(len) - 1;
+    witness_.clear();
+    compute_witness();
+  }
+
+  solver_->pop();
+  return r;
+}
+
+}  // namespace pono
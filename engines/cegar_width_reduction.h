@@ -0,0 +1,78 @@
+/*********************                                                        */
+/*! \file cegar_width_reduction.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A CEGAR loop for datapath width reduction: the data that is
+**        only moved around is reduced to a few bits, and the
+**        counterexamples of the reduced system are checked on the
+**        concrete one by BMC
+**
+**/
+
+#pragma once
+
+#include <memory>
+
+#include "engines/cegar.h"
+#include "modifiers/width_reducer.h"
+
+namespace pono {
+
+/** Datapath width reduction of a functional transition system
+ *  The reduced system (see WidthReducer) is checked by a fresh prover of
+ *  options_.engine_. A counterexample of the reduced system is checked
+ *  by BMC at its length on the concrete system, which gives the concrete
+ *  witness. The reduction is exact, but if the counterexample is
+ *  spurious anyway the concrete widths are restored and the system is
+ *  checked again. No invariant is available: the one of the reduced
+ *  system is over the reduced values.
+ */
+class CegarWidthReduction : public CEGAR<Prover>
+{
+  typedef CEGAR<Prover> super;
+
+ public:
+  CegarWidthReduction(const Property & p,
+                      const TransitionSystem & ts,
+                      const smt::SmtSolver & solver,
+                      PonoOptions opt = PonoOptions());
+
+  void initialize() override;
+
+  ProverResult check_until(int k) override;
+
+  /** @return the reducer of the system */
+  const WidthReducer & reducer() const { return *reducer_; }
+
+ protected:
+  /** Rebuild abs_ts_ and abs_bad_ with the current widths */
+  void cegar_abstract() override;
+
+  /** Check the counterexample length of the abstract prover on the
+   *  concrete system and restore the concrete widths if it is spurious
+   *  @return true iff the widths were restored, false if the
+   *          counterexample is real (then witness_ is set) or nothing was
+   *          reduced
+   */
+  bool cegar_refine() override;
+
+  /** Check whether bad_ is reachable in exactly len steps in ts_
+   *  If it is, computes the witness.
+   *  @return the result of the query
+   */
+  smt::Result check_concrete(size_t len);
+
+  std::unique_ptr<WidthReducer> reducer_;
+  TransitionSystem abs_ts_;  ///< the reduced system, over solver_
+  smt::Term abs_bad_;  ///< the reduced bad states
+  std::shared_ptr<Prover> abs_prover_;  ///< prover of the last abstraction
+};
+
+}  // namespace pono
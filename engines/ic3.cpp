@@ -38,7 +38,8 @@ IC3Formula IC3::get_model_ic3formula() const
 {
   // expecting all solving in IC3 to be done at context level > 0
   // so if we're getting a model we should not be at context 0
-  assert(solver_context_);
+  // (unless rel_ind_check uses assumptions instead)
+  assert(solver_context_ || options_.ic3_rel_ind_assumptions_);
 
   const UnorderedTermSet & statevars = ts_.statevars();
   TermVec children;
@@ -51,7 +52,7 @@ IC3Formula IC3::get_model_ic3formula() const
     }
   }
 
-  return ic3formula_conjunction(children);
+  return ic3formula_conjunction(std::move(children));
 }
 
 bool IC3::ic3formula_check_valid(const IC3Formula & u) const
@@ -91,6 +92,11 @@ void IC3::predecessor_generalization(size_t i,
     return;
   }
 
+  if (options_.ic3_ternary_sim_ && ts_.is_deterministic()) {
+    ternary_predecessor_generalization(c, pred);
+    return;
+  }
+
   Term formula = make_and(input_lits);
   if (ts_.is_deterministic()) {
     // NOTE: need to use full trans, not just trans_label_ here
@@ -120,6 +126,7 @@ void IC3::predecessor_generalization(size_t i,
   //       not sure if it makes sense to have at the boolean level
 
   TermVec red_cube_lits, rem_cube_lits;
+  stats_->increment("reducer_unsat_cores");
   reducer_.reduce_assump_unsatcore(
       formula, cube_lits, red_cube_lits, &rem_cube_lits);
 
@@ -127,11 +134,74 @@ void IC3::predecessor_generalization(size_t i,
   // formula should not be unsat on its own
   assert(red_cube_lits.size() > 0);
 
-  pred = ic3formula_conjunction(red_cube_lits);
+  pred = ic3formula_conjunction(std::move(red_cube_lits));
   // expecting a Cube here
   assert(!pred.disjunction);
 }
 
+void IC3::init_bit_literals()
+{
+  for (const auto & sv : ts_.statevars()) {
+    bit_lits_[sv] = { sv, 0, true };
+    bit_lits_[solver_->make_term(Not, sv)] = { sv, 0, false };
+  }
+}
+
+void IC3::ternary_predecessor_generalization(const Term & c,
+                                             IC3Formula & pred)
+{
+  assert(ts_.is_deterministic());
+  assert(!pred.disjunction);
+
+  if (!ternary_sim_) {
+    ternary_sim_.reset(new TernarySimulator(ts_));
+    init_bit_literals();
+  }
+  TernarySimulator & sim = *ternary_sim_;
+
+  sim.clear();
+  for (const auto & iv : ts_.inputvars()) {
+    sim.set_value(iv, solver_->get_value(iv));
+  }
+
+  const TermVec & cube_lits = pred.children;
+  for (const auto & l : cube_lits) {
+    auto it = bit_lits_.find(l);
+    if (it == bit_lits_.end()) {
+      // not a literal of a single bit, keep the whole predecessor
+      return;
+    }
+    const auto & [var, bit, val] = it->second;
+    sim.set_bit(var, bit, val);
+  }
+
+  if (!sim.eval_next(c).is_true()) {
+    // too imprecise (e.g. unsupported operators), keep it all
+    stats_->increment("ternary_sim_failures");
+    return;
+  }
+
+  TermVec red_cube_lits;
+  for (size_t j = 0; j < cube_lits.size(); ++j) {
+    const auto & [var, bit, val] = bit_lits_.at(cube_lits[j]);
+    sim.set_unknown(var, bit);
+    if (!sim.eval_next(c).is_true()) {
+      // needed to reach c
+      sim.set_bit(var, bit, val);
+      red_cube_lits.push_back(cube_lits[j]);
+    }
+  }
+
+  if (red_cube_lits.empty()) {
+    // every state reaches c with these inputs, keep one literal
+    red_cube_lits.push_back(cube_lits.at(0));
+  }
+
+  stats_->increment("ternary_sim_lifts");
+  pred = ic3formula_conjunction(std::move(red_cube_lits));
+  assert(!pred.disjunction);
+}
+
 void IC3::check_ts() const
 {
   for (const auto &sv : ts_.statevars()) {
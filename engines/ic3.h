@@ -14,7 +14,12 @@
 
 #pragma once
 
+#include <memory>
+#include <tuple>
+#include <unordered_map>
+
 #include "engines/ic3base.h"
+#include "utils/ternary_simulator.h"
 
 namespace pono {
 
@@ -41,6 +46,24 @@ class IC3 : public IC3Base
 
   void check_ts() const override;
 
+  /** Populates bit_lits_ for the literals used in cubes */
+  virtual void init_bit_literals();
+
+  /** Predecessor generalization by ternary simulation
+   *  Drops the literals of pred whose value does not matter for reaching c
+   *  with the inputs of the current model.
+   *  @requires ts_.is_deterministic() and the solver_ context is SAT
+   *  @param c the term the predecessor reaches (over current state vars)
+   *  @param pred the predecessor to generalize
+   */
+  void ternary_predecessor_generalization(const smt::Term & c,
+                                          IC3Formula & pred);
+
+  ///< for each literal (both polarities) the state variable, the bit
+  ///< (0 for booleans) and the value it fixes
+  std::unordered_map<smt::Term, std::tuple<smt::Term, size_t, bool>>
+      bit_lits_;
+  std::unique_ptr<TernarySimulator> ternary_sim_;  ///< built on first use
 };
 
 }  // namespace pono
@@ -17,16 +17,28 @@
 
 #include "engines/ic3base.h"
 
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <thread>
+
 #include "assert.h"
 #include "smt/available_solvers.h"
+#include "utils/lemma_cache.h"
 #include "utils/logger.h"
+#include "utils/solver_trace.h"
 #include "utils/term_analysis.h"
+#include "utils/thread_placement.h"
+#include "utils/timeline.h"
 
 using namespace smt;
 using namespace std;
 
 namespace pono {
 
+static const LogComponent ic3_log = Log::component("ic3");
+
 // helper functions
 
 /** Less than comparison of the hash of two terms
@@ -49,6 +61,15 @@ static bool subsumes(const IC3Formula &a, const IC3Formula &b)
 {
   assert(a.disjunction);
   assert(a.disjunction == b.disjunction);
+  if (a.signature & ~b.signature) {
+    // a has a child that b does not have
+    return false;
+  }
+  if (!a.lits.empty() && !b.lits.empty()) {
+    return a.lits.size() <= b.lits.size()
+           && std::includes(
+               b.lits.begin(), b.lits.end(), a.lits.begin(), a.lits.end());
+  }
   const TermVec &ac = a.children;
   const TermVec &bc = b.children;
   // NOTE: IC3Formula children are sorted on construction
@@ -63,9 +84,6 @@ ProofGoalQueue::~ProofGoalQueue() { clear(); }
 
 void ProofGoalQueue::clear()
 {
-  for (auto p : store_) {
-    delete p;
-  }
   store_.clear();
   while (!queue_.empty()) {
     queue_.pop();
@@ -74,11 +92,12 @@ void ProofGoalQueue::clear()
 
 void ProofGoalQueue::new_proof_goal(const IC3Formula & c,
                                     unsigned int t,
-                                    const ProofGoal * n)
+                                    const ProofGoal * n,
+                                    GoalModel m,
+                                    size_t rank)
 {
-  ProofGoal * pg = new ProofGoal(c, t, n);
-  queue_.push(pg);
-  store_.push_back(pg);
+  store_.emplace_back(c, t, n, std::move(m), rank);
+  queue_.push(&store_.back());
 }
 
 ProofGoal * ProofGoalQueue::top() { return queue_.top(); }
@@ -87,6 +106,27 @@ void ProofGoalQueue::pop() { queue_.pop(); }
 
 bool ProofGoalQueue::empty() const { return queue_.empty(); }
 
+std::vector<const ProofGoal *> ProofGoalQueue::goals() const
+{
+  std::vector<const ProofGoal *> res;
+  res.reserve(queue_.size());
+  auto q = queue_;
+  while (!q.empty()) {
+    res.push_back(q.top());
+    q.pop();
+  }
+  return res;
+}
+
+/** Apply the per-query time limit of the reducer, if any */
+static SmtSolver limit_reducer(const SmtSolver & s, size_t ms)
+{
+  if (ms) {
+    set_query_time_limit(s, ms);
+  }
+  return s;
+}
+
 /** IC3Base */
 
 IC3Base::IC3Base(const Property & p,
@@ -94,12 +134,22 @@ IC3Base::IC3Base(const Property & p,
                  const SmtSolver & s,
                  PonoOptions opt)
     : super(p, ts, s, opt),
-      reducer_(create_reducer_for(
-          s->get_solver_enum(), Engine::IC3IA_ENGINE, opt.logging_smt_solver_)),
+      reducer_(limit_reducer(
+          create_reducer_for(s->get_solver_enum(),
+                             Engine::IC3IA_ENGINE,
+                             opt.logging_smt_solver_),
+          opt.reducer_query_time_limit_)),
       solver_context_(0),
       num_check_sat_since_reset_(0),
+      num_lemma_assertions_(0),
       failed_to_reset_solver_(false),
-      approx_pregen_(false)
+      activity_inc_(1.0),
+      num_act_lits_(0),
+      num_dead_act_lits_(0),
+      approx_pregen_(false),
+      rel_ind_unknown_(false),
+      goal_models_(opt.witness_),
+      num_collected_lemmas_(0)
 {
 }
 
@@ -126,6 +176,8 @@ void IC3Base::initialize()
   assert(solver_context_ == 0);  // expecting to be at base context level
 
   frames_.clear();
+  inf_frame_.clear();
+  lemma_activity_.clear();
   frame_labels_.clear();
   // first frame is always the initial states
   push_frame();
@@ -145,6 +197,7 @@ void IC3Base::initialize()
   trans_label_ = solver_->make_symbol("__trans_label", boolsort_);
   solver_->assert_formula(
       solver_->make_term(Implies, trans_label_, ts_.trans()));
+  define_trans_partitions();
 
   bad_label_ = solver_->make_symbol("__bad_label", boolsort_);
   solver_->assert_formula(solver_->make_term(Implies, bad_label_, bad_));
@@ -164,12 +217,18 @@ ProverResult IC3Base::check_until(int k)
   int i = reached_k_ + 1;
   assert(reached_k_ + 1 >= 0);
   while (i <= k) {
+    if (interrupted()) {
+      logger.log(ic3_log, 1, "IC3Base: interrupted at frame {}", i);
+      return ProverResult::UNKNOWN;
+    }
+
     res = step(i);
 
     if (res == ProverResult::FALSE) {
       assert(cex_.size());
       RefineResult s = refine();
       if (s == REFINE_SUCCESS) {
+        stats_->increment("refinements");
         continue;
       } else if (s == REFINE_NONE) {
         // this is a real counterexample
@@ -177,7 +236,9 @@ ProverResult IC3Base::check_until(int k)
         return ProverResult::FALSE;
       } else {
         assert(s == REFINE_FAIL);
-        logger.log(1, "IC3Base: refinement failure, returning unknown");
+        logger.log(ic3_log,
+                   1,
+                   "IC3Base: refinement failure, returning unknown");
         return ProverResult::UNKNOWN;
       }
     } else {
@@ -189,12 +250,18 @@ ProverResult IC3Base::check_until(int k)
     }
   }
 
+  // keep the lemmas for a later run, they are filtered when loaded
+  save_lemma_cache(1);
   return ProverResult::UNKNOWN;
 }
 
 bool IC3Base::witness(std::vector<smt::UnorderedTermMap> & out)
 {
-  throw PonoException("IC3 witness NYI");
+  if (witness_.empty() && !witness_from_goals()) {
+    throw PonoException(
+        "IC3 witness needs a concrete trace of recorded proof goals");
+  }
+  return super::witness(out);
 }
 
 size_t IC3Base::witness_length() const
@@ -206,24 +273,24 @@ size_t IC3Base::witness_length() const
 
 // Protected Methods
 
-IC3Formula IC3Base::ic3formula_disjunction(const TermVec & c) const
+IC3Formula IC3Base::ic3formula_disjunction(TermVec c) const
 {
   assert(c.size());
   Term term = c.at(0);
   for (size_t i = 1; i < c.size(); ++i) {
     term = solver_->make_term(Or, term, c[i]);
   }
-  return IC3Formula(term, c, true);
+  return IC3Formula(term, std::move(c), true);
 }
 
-IC3Formula IC3Base::ic3formula_conjunction(const TermVec & c) const
+IC3Formula IC3Base::ic3formula_conjunction(TermVec c) const
 {
   assert(c.size());
   Term term = c.at(0);
   for (size_t i = 1; i < c.size(); ++i) {
     term = solver_->make_term(And, term, c[i]);
   }
-  return IC3Formula(term, c, false);
+  return IC3Formula(term, std::move(c), false);
 }
 
 IC3Formula IC3Base::ic3formula_negate(const IC3Formula & u) const
@@ -250,10 +317,38 @@ IC3Formula IC3Base::ic3formula_negate(const IC3Formula & u) const
       term = solver_->make_term(Or, term, nc);
     }
   }
-  return IC3Formula(term, neg_children, !is_clause);
+  return IC3Formula(term, std::move(neg_children), !is_clause);
 }
 
 IC3Formula IC3Base::inductive_generalization(size_t i, const IC3Formula & c)
+{
+  SOLVER_TRACE_SCOPE("ic3_generalize");
+  return generalize_cube(i, c, 1);
+}
+
+IC3Formula IC3Base::record_inductive_generalization(size_t i,
+                                                    const IC3Formula & c)
+{
+  size_t calls_before = budget_.num_solver_calls();
+  auto begin = std::chrono::steady_clock::now();
+  IC3Formula gen = inductive_generalization(i, c);
+  auto micros = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - begin)
+                    .count();
+  size_t before = c.children.size();
+  size_t after = gen.children.size();
+  stats_->record("gen_cube_size_before", before);
+  stats_->record("gen_cube_size_after", after);
+  stats_->record("gen_dropped_lits", before > after ? before - after : 0);
+  stats_->record("gen_solver_calls",
+                 budget_.num_solver_calls() - calls_before);
+  stats_->record("gen_micros", micros);
+  return gen;
+}
+
+IC3Formula IC3Base::generalize_cube(size_t i,
+                                    const IC3Formula & c,
+                                    size_t depth)
 {
   assert(!solver_context_);
   assert(i <= frontier_idx());
@@ -261,8 +356,10 @@ IC3Formula IC3Base::inductive_generalization(size_t i, const IC3Formula & c)
   // be default will try to find a minimal cube
   // NOTE: not necessarily minimum (e.g. it's a local minimum)
 
-  logger.log(
-      3, "trying to generalize an IC3Formula of size {}", c.children.size());
+  logger.log(ic3_log,
+             3,
+             "trying to generalize an IC3Formula of size {}",
+             c.children.size());
 
   // TODO use unsat core reducer
   // TODO use ic3_gen_max_iter_ option or remove it
@@ -280,6 +377,13 @@ IC3Formula IC3Base::inductive_generalization(size_t i, const IC3Formula & c)
     // TODO use random_seed_ if set for shuffling
     //      order of drop attempts
 
+    if (options_.ic3_lit_order_) {
+      j = next_literal_to_drop(gen.children, necessary);
+      if (j == gen.children.size()) {
+        break;
+      }
+    }
+
     // try dropping j
     dropped = gen.children.at(j);
     if (necessary.find(dropped) != necessary.end()) {
@@ -296,15 +400,23 @@ IC3Formula IC3Base::inductive_generalization(size_t i, const IC3Formula & c)
     //       and instead only doing it for subsumption checks
     gen = ic3formula_conjunction(gen.children);
 
-    if (!check_intersects_initial(gen.term)
-        && rel_ind_check(i, gen, out, false)) {
+    bool dropped_lit;
+    if (options_.ic3_ctg_) {
+      out = gen;
+      dropped_lit = ctg_down(i, out, depth);
+    } else {
+      dropped_lit = !check_intersects_initial(gen.term)
+                    && rel_ind_check(i, gen, out, false);
+    }
+
+    if (dropped_lit) {
       // we can drop this literal
 
       // out was generalized with an unsat core in
       // rel_ind_check
       // we can't rely on the order of the children
       // being the same
-      gen = out;
+      gen = std::move(out);
       j = 0;  // start iteration over
     } else {
       // could not drop this child
@@ -330,6 +442,109 @@ IC3Formula IC3Base::inductive_generalization(size_t i, const IC3Formula & c)
   return block;
 }
 
+size_t IC3Base::next_literal_to_drop(const TermVec & lits,
+                                     const UnorderedTermSet & necessary)
+{
+  size_t best = lits.size();
+  size_t best_importance = 0;
+  double best_activity = 0;
+  size_t best_age = 0;
+  for (size_t k = 0; k < lits.size(); ++k) {
+    const Term & l = lits[k];
+    if (necessary.find(l) != necessary.end()) {
+      continue;
+    }
+    size_t importance = literal_importance(l);
+    auto it = lit_activity_.find(l);
+    double activity = it == lit_activity_.end() ? 0 : it->second;
+    size_t age = lit_age_.emplace(l, lit_age_.size()).first->second;
+    if (best == lits.size() || importance < best_importance
+        || (importance == best_importance
+            && (activity < best_activity
+                || (activity == best_activity && age > best_age)))) {
+      best = k;
+      best_importance = importance;
+      best_activity = activity;
+      best_age = age;
+    }
+  }
+  return best;
+}
+
+void IC3Base::bump_activity(const TermVec & lits)
+{
+  for (const auto & l : lits) {
+    lit_activity_[l] += activity_inc_;
+  }
+  // decay the older bumps
+  activity_inc_ /= 0.95;
+  if (activity_inc_ > 1e100) {
+    for (auto & elem : lit_activity_) {
+      elem.second *= 1e-100;
+    }
+    activity_inc_ *= 1e-100;
+  }
+}
+
+bool IC3Base::ctg_down(size_t i, IC3Formula & cube, size_t depth)
+{
+  assert(!solver_context_);
+  assert(!cube.disjunction);
+
+  size_t ctgs = 0;
+  IC3Formula ctg, out;
+  while (true) {
+    if (check_intersects_initial(cube.term)) {
+      return false;
+    }
+
+    if (rel_ind_check(i, cube, out)) {
+      cube = std::move(out);
+      return true;
+    }
+    if (rel_ind_unknown_) {
+      // no CTG to work with, keep the literal
+      return false;
+    }
+    // out is a counterexample to generalization (CTG)
+    // a state in F[i-1] that reaches cube
+    std::swap(ctg, out);
+
+    if (depth > options_.ic3_ctg_max_depth_) {
+      return false;
+    }
+
+    if (ctgs < options_.ic3_ctg_max_ctgs_ && i > 1
+        && !check_intersects_initial(ctg.term)
+        && rel_ind_check(i - 1, ctg, out, false)) {
+      // the CTG can be blocked at frame i-1, then retry cube
+      ++ctgs;
+      stats_->increment("blocked_ctgs");
+      IC3Formula lemma = generalize_cube(i - 1, out, depth + 1);
+      size_t idx = find_highest_frame(i - 1, lemma);
+      logger.log(ic3_log, 3, "Blocking CTG at frame {}: {}", idx, lemma.term);
+      constrain_frame(idx, lemma);
+      continue;
+    }
+
+    // join: keep the literals of cube that also hold in the CTG
+    ctgs = 0;
+    UnorderedTermSet ctg_lits(ctg.children.begin(), ctg.children.end());
+    TermVec kept;
+    for (const auto & l : cube.children) {
+      if (ctg_lits.find(l) != ctg_lits.end()) {
+        kept.push_back(l);
+      }
+    }
+    if (kept.empty() || kept.size() == cube.children.size()) {
+      // nothing left or no progress
+      // (e.g. the CTG was generalized and lost the literal)
+      return false;
+    }
+    cube = ic3formula_conjunction(kept);
+  }
+}
+
 void IC3Base::predecessor_generalization(size_t i,
                                          const Term & c,
                                          IC3Formula & pred)
@@ -346,9 +561,13 @@ bool IC3Base::reaches_bad(IC3Formula & out)
   // see if it can reach bad in one step
   solver_->assert_formula(ts_.next(bad_));
   solver_->assert_formula(trans_label_);
+  for (const auto & e : bad_exclusions_) {
+    solver_->assert_formula(e);
+  }
   Result r = check_sat();
 
   if (r.is_sat()) {
+    record_goal_model();
     out = get_model_ic3formula();
     assert(out.term);
     assert(out.children.size());
@@ -366,12 +585,48 @@ bool IC3Base::reaches_bad(IC3Formula & out)
 
   pop_solver_context();
 
-  assert(!r.is_unknown());
+  if (r.is_unknown()) {
+    // can't tell whether the frontier is safe, step checks interrupted()
+    budget_.cancel("IC3: query for bad states returned unknown");
+  }
   return r.is_sat();
 }
 
+bool IC3Base::reaches_bad_batch(
+    std::vector<std::pair<IC3Formula, GoalModel>> & out)
+{
+  out.clear();
+  size_t batch = std::max(1u, options_.ic3_bad_batch_);
+  IC3Formula goal;
+  while (out.size() < batch && reaches_bad(goal)) {
+    out.push_back({ goal, last_goal_model_ });
+    if (out.size() < batch) {
+      bad_exclusions_.push_back(ic3formula_negate(goal).term);
+    }
+    if (interrupted()) {
+      break;
+    }
+  }
+  bad_exclusions_.clear();
+
+  if (batch > 1 && out.size()) {
+    stats_->increment("bad_cube_batches");
+    stats_->increment("bad_cubes", out.size());
+    // the more general cubes are expected to block more of the others
+    std::stable_sort(out.begin(),
+                     out.end(),
+                     [](const std::pair<IC3Formula, GoalModel> & a,
+                        const std::pair<IC3Formula, GoalModel> & b) {
+                       return a.first.children.size()
+                              < b.first.children.size();
+                     });
+  }
+  return out.size();
+}
+
 ProverResult IC3Base::step(int i)
 {
+  TIMELINE_SPAN("ic3_step");
   if (i <= reached_k_) {
     return ProverResult::UNKNOWN;
   }
@@ -384,13 +639,19 @@ ProverResult IC3Base::step(int i)
   // at this point there are reached_k_ + 1 frames that don't
   // intersect bad, and reached_k_ + 2 frames overall
   assert(reached_k_ == frontier_idx());
-  logger.log(1, "Blocking phase at frame {}", i);
-  if (!block_all()) {
+  add_shared_lemmas();
+  logger.log(ic3_log, 1, "Blocking phase at frame {}", i);
+  bool all_blocked = block_all();
+  if (interrupted()) {
+    // proof goals might not have been blocked, can't propagate
+    return ProverResult::UNKNOWN;
+  }
+  if (!all_blocked) {
     // counter-example
     return ProverResult::FALSE;
   }
 
-  logger.log(1, "Propagation phase at frame {}", i);
+  logger.log(ic3_log, 1, "Propagation phase at frame {}", i);
   // propagation phase
   push_frame();
   for (size_t j = 1; j < frontier_idx(); ++j) {
@@ -399,15 +660,49 @@ ProverResult IC3Base::step(int i)
       // save the invariant
       // which is the frame that just had all terms
       // from the previous frames propagated
-      invar_ = get_frame_term(j + 1);
+      Term invar = get_frame_term(j + 1);
+      if (num_collected_lemmas_ && !is_inductive(invar)) {
+        // a deleted lemma was needed for the relative induction
+        stats_->increment("lemma_gc_rejected_fixpoints");
+        continue;
+      }
+      invar_ = invar;
+      save_lemma_cache(j + 1);
       return ProverResult::TRUE;
     }
   }
 
-  reset_solver();
+  if (options_.ic3_inf_frame_period_
+      && frontier_idx() % options_.ic3_inf_frame_period_ == 0) {
+    propagate_to_inf_frame();
+  }
+
+  if (options_.ic3_lemma_gc_period_
+      && frontier_idx() % options_.ic3_lemma_gc_period_ == 0) {
+    collect_lemmas();
+  }
+
+  if (solver_reset_due()) {
+    reset_solver();
+  }
 
   ++reached_k_;
 
+  publish_frontier_lemmas();
+
+  std::vector<size_t> lemmas_per_frame;
+  lemmas_per_frame.reserve(frames_.size());
+  size_t num_lemmas = 0;
+  for (const auto & f : frames_) {
+    lemmas_per_frame.push_back(f.size());
+    num_lemmas += f.size();
+  }
+  stats_->set("frames", frames_.size());
+  stats_->set("lemmas", num_lemmas);
+  stats_->set_list("lemmas_per_frame", lemmas_per_frame);
+  // after the statistics, for the progress it reports
+  checkpoint();
+
   return ProverResult::UNKNOWN;
 }
 
@@ -415,27 +710,32 @@ ProverResult IC3Base::step_01()
 {
   assert(reached_k_ < 1);
   if (reached_k_ < 0) {
-    logger.log(1, "Checking if initial states satisfy property");
+    logger.log(ic3_log, 1, "Checking if initial states satisfy property");
 
     push_solver_context();
     solver_->assert_formula(init_label_);
     solver_->assert_formula(bad_);
     Result r = check_sat();
     if (r.is_sat()) {
+      record_goal_model();
       pop_solver_context();
       // trace is only one bad state that intersects with initial
       cex_.clear();
       cex_.push_back(bad_);
+      cex_models_.assign(1, last_goal_model_);
       return ProverResult::FALSE;
+    } else if (r.is_unknown()) {
+      pop_solver_context();
+      budget_.cancel("IC3: initial query returned unknown");
+      return ProverResult::UNKNOWN;
     } else {
-      assert(r.is_unsat());
       reached_k_ = 0;  // keep reached_k_ aligned with number of frames
     }
     pop_solver_context();
   }
 
   assert(reached_k_ == 0);
-  logger.log(1, "Checking if property can be violated in one-step");
+  logger.log(ic3_log, 1, "Checking if property can be violated in one-step");
 
   push_solver_context();
   solver_->assert_formula(init_label_);
@@ -443,18 +743,25 @@ ProverResult IC3Base::step_01()
   solver_->assert_formula(ts_.next(bad_));
   Result r = check_sat();
   if (r.is_sat()) {
-    const IC3Formula &c = get_model_ic3formula();
+    record_goal_model();
+    IC3Formula c = get_model_ic3formula();
     pop_solver_context();
-    ProofGoal * pg = new ProofGoal(c, 0, nullptr);
-    reconstruct_trace(pg, cex_);
-    delete pg;
+    ProofGoal pg(std::move(c), 0, nullptr, last_goal_model_);
+    reconstruct_trace(&pg, cex_, &cex_models_);
     return ProverResult::FALSE;
+  } else if (r.is_unknown()) {
+    pop_solver_context();
+    budget_.cancel("IC3: one-step query returned unknown");
+    return ProverResult::UNKNOWN;
   } else {
-    assert(r.is_unsat());
     reached_k_ = 1;  // keep reached_k_ aligned with number of frames
   }
   pop_solver_context();
 
+  if (!resume_checkpoint()) {
+    load_lemma_cache();
+  }
+
   return ProverResult::UNKNOWN;
 }
 
@@ -463,6 +770,7 @@ bool IC3Base::rel_ind_check(size_t i,
                             IC3Formula & out,
                             bool get_pred)
 {
+  SOLVER_TRACE_SCOPE("ic3_rel_ind");
   assert(i > 0);
   assert(i < frames_.size());
   // expecting to be the polarity for proof goals, not frames
@@ -470,14 +778,45 @@ bool IC3Base::rel_ind_check(size_t i,
   assert(!c.disjunction);
 
   assert(solver_context_ == 0);
-  push_solver_context();
+  rel_ind_unknown_ = false;
+  if (options_.ic3_frame_solvers_ && !get_pred) {
+    // the model is not needed, so it can use the smaller solver
+    return frame_solver_rel_ind_check(i, c, out);
+  }
 
-  // F[i-1]
-  assert_frame_labels(i - 1);
-  // -c
-  solver_->assert_formula(solver_->make_term(Not, c.term));
-  // Trans
-  assert_trans_label();
+  const bool use_act_lit = options_.ic3_rel_ind_assumptions_;
+  // without a predecessor, only the cone of c' is needed
+  TermVec trans_labels;
+  if (partitioned_trans_ && !get_pred) {
+    trans_cone_labels(c, trans_labels);
+  } else {
+    trans_labels.push_back(trans_label_);
+  }
+  Term act;
+  if (use_act_lit) {
+    if (options_.ic3_act_lit_reset_ && !failed_to_reset_solver_
+        && num_dead_act_lits_ >= options_.ic3_act_lit_reset_) {
+      // retire the dead activation literals in bulk
+      reset_solver();
+    }
+    // -c guarded by a fresh activation literal, F[i-1] and Trans are
+    // passed as assumptions below, so the solver keeps what it learns
+    act = solver_->make_symbol(
+        "__rel_ind_act_" + std::to_string(num_act_lits_++), boolsort_);
+    solver_->assert_formula(
+        solver_->make_term(Implies, act, solver_->make_term(Not, c.term)));
+  } else {
+    push_solver_context();
+
+    // F[i-1]
+    assert_frame_labels(i - 1);
+    // -c
+    solver_->assert_formula(solver_->make_term(Not, c.term));
+    // Trans
+    for (const auto & l : trans_labels) {
+      solver_->assert_formula(l);
+    }
+  }
 
   // use assumptions for c' so we can get cheap initial
   // generalization if the check is unsat
@@ -491,19 +830,37 @@ bool IC3Base::rel_ind_check(size_t i,
     for (const auto & cc : c.children) {
       ccnext = ts_.next(cc);
       lbl = label(ccnext);
-      if (lbl != ccnext && !is_global_label(lbl)) {
+      if (lbl != ccnext && !is_global_label(lbl)
+          && (!use_act_lit || label_defs_.insert(lbl).second)) {
         // only need to add assertion if the label is not the same as ccnext
         // could be the same if ccnext is already a literal
         // and is not already in a global assumption
+        // without a solver context it stays until the next reset
         solver_->assert_formula(solver_->make_term(Implies, lbl, ccnext));
       }
       assumps_.push_back(lbl);
     }
   }
 
-  Result r = check_sat_assuming(assumps_);
+  Result r;
+  TermVec ctx_assumps;  // replace the solver context if use_act_lit
+  if (use_act_lit) {
+    frame_label_assumptions(i - 1, ctx_assumps);
+    ctx_assumps.insert(
+        ctx_assumps.end(), trans_labels.begin(), trans_labels.end());
+    ctx_assumps.push_back(act);
+    // appended for this check only, without copying assumps_, which must
+    // match c.children afterwards
+    size_t num_lits = assumps_.size();
+    assumps_.insert(assumps_.end(), ctx_assumps.begin(), ctx_assumps.end());
+    r = check_sat_assuming(assumps_);
+    assumps_.resize(num_lits);
+  } else {
+    r = check_sat_assuming(assumps_);
+  }
   if (r.is_sat()) {
     if (get_pred) {
+      record_goal_model();
       out = get_model_ic3formula();
       if (options_.ic3_pregen_) {
         predecessor_generalization_and_fix(i, c.term, out);
@@ -513,78 +870,234 @@ bool IC3Base::rel_ind_check(size_t i,
       }
     }
     assert(ic3formula_check_valid(out));
+  } else if (r.is_unknown()) {
+    // e.g. hit the per-query limit: treat c as not blocked, without a
+    // predecessor. Generalization keeps the literal and moves on.
+    rel_ind_unknown_ = true;
+    stats_->increment("ic3_unknown_queries");
   } else if (options_.ic3_unsatcore_gen_) {
-    assert(r.is_unsat());  // not expecting to get unknown
-
     // Use unsat core to get cheap generalization
     UnorderedTermSet core;
+    SolverCallTimer timer(TRACE_GET_UNSAT_ASSUMPTIONS);
     solver_->get_unsat_assumptions(core);
-    assert(core.size());
-
-    TermVec gen;  // cheap unsat-core generalization of c
-    TermVec rem;  // conjuncts removed by unsat core
-    // might need to be re-added if it
-    // ends up intersecting with initial
-    assert(assumps_.size() == c.children.size());
-    for (size_t i = 0; i < assumps_.size(); ++i) {
-      if (core.find(assumps_.at(i)) == core.end()) {
-        rem.push_back(c.children.at(i));
-      } else {
-        gen.push_back(c.children.at(i));
-      }
+    timer.done(uint8_t(1));
+    for (const auto & a : ctx_assumps) {
+      core.erase(a);
     }
-
-    fix_if_intersects_initial(gen, rem);
-    assert(gen.size() >= core.size());
-
-    // keep it as a conjunction for now
-    out = ic3formula_conjunction(gen);
+    stats_->increment("unsat_cores");
+    out = unsat_core_generalization(c, assumps_, core);
   } else {
-    assert(r.is_unsat());  // not expecting to get unknown
     // don't generalize with an unsat core, just keep c
     out = c;
   }
 
-  pop_solver_context();
+  if (use_act_lit) {
+    // disable -c for good, removed at the next solver reset
+    solver_->assert_formula(solver_->make_term(Not, act));
+    ++num_dead_act_lits_;
+  } else {
+    pop_solver_context();
+  }
   assert(!solver_context_);
 
-  if (r.is_sat() && get_pred) {
-    assert(out.term);
-    assert(out.children.size());
+  assert(!r.is_sat() || !get_pred || (out.term && out.children.size()));
+  return r.is_unsat();
+}
+
+bool IC3Base::frame_solver_rel_ind_check(size_t i,
+                                         const IC3Formula & c,
+                                         IC3Formula & out)
+{
+  assert(i > 0);
+  assert(i < frames_.size());
+  assert(!c.disjunction);
 
-    // this check needs to be here after the solver context has been popped
-    // if i == 1 and there's a predecessor, then it should be an initial state
-    assert(i != 1 || check_intersects_initial(out.term));
+  FrameSolver & fs = frame_solver(i - 1);
+  RelIndQuery q;
+  prepare_rel_ind_query(fs, c, q);
+  run_rel_ind_query(fs.solver, q);
 
-    // should never intersect with a frame before F[i-1]
-    // otherwise, this predecessor should have been found
-    // in a previous step (before a new frame was pushed)
-    assert(i < 2 || !check_intersects(out.term, get_frame_term(i - 2)));
+  if (q.res.is_unknown()) {
+    rel_ind_unknown_ = true;
+    stats_->increment("ic3_unknown_queries");
+    return false;
+  }
+  if (q.res.is_sat()) {
+    return false;
   }
 
-  assert(!r.is_unknown());
-  return r.is_unsat();
+  if (options_.ic3_unsatcore_gen_) {
+    stats_->increment("unsat_cores");
+    out = unsat_core_generalization(c, q.assumps, q.core);
+  } else {
+    out = c;
+  }
+  return true;
+}
+
+void IC3Base::prepare_rel_ind_query(FrameSolver & fs,
+                                    const IC3Formula & c,
+                                    RelIndQuery & q)
+{
+  assert(!c.disjunction);
+  const SmtSolver & s = fs.solver;
+  TermTranslator & tt = *fs.to_solver;
+
+  // -c
+  q.not_c = tt.transfer_term(solver_->make_term(Not, c.term), BOOL);
+
+  // c' as assumptions, the label semantics are local to this query
+  // because this solver does not have the global labels of solver_
+  q.assumps.reserve(c.children.size());
+  Term lbl, ccnext, tlbl;
+  for (const auto & cc : c.children) {
+    ccnext = ts_.next(cc);
+    lbl = label(ccnext);
+    tlbl = tt.transfer_term(lbl, BOOL);
+    if (lbl != ccnext) {
+      q.label_defs.push_back(
+          s->make_term(Implies, tlbl, tt.transfer_term(ccnext, BOOL)));
+    }
+    q.assumps.push_back(tlbl);
+  }
+}
+
+void IC3Base::run_rel_ind_query(const SmtSolver & s, RelIndQuery & q)
+{
+  s->push();
+  s->assert_formula(q.not_c);
+  for (const auto & d : q.label_defs) {
+    s->assert_formula(d);
+  }
+
+  budget_.count_solver_call();
+  auto begin = chrono::steady_clock::now();
+  q.res = s->check_sat_assuming(q.assumps);
+  stats_->add_time(
+      "frame_solver_time",
+      chrono::duration<double>(chrono::steady_clock::now() - begin).count());
+  stats_->increment("frame_solver_calls");
+
+  if (q.res.is_unsat() && options_.ic3_unsatcore_gen_) {
+    s->get_unsat_assumptions(q.core);
+  }
+  s->pop();
+}
+
+IC3Base::FrameSolver & IC3Base::frame_solver(size_t i)
+{
+  assert(i < frames_.size());
+  if (frame_solvers_.size() <= i) {
+    frame_solvers_.resize(i + 1);
+  }
+
+  unique_ptr<FrameSolver> & fs = frame_solvers_[i];
+  if (fs && fs->trans == ts_.trans() && (i || fs->init == ts_.init())) {
+    return *fs;
+  }
+
+  logger.log(ic3_log, 2, "IC3Base: building solver for frame {}", i);
+  stats_->increment("frame_solver_builds");
+  fs = make_frame_solver(i);
+  return *fs;
+}
+
+unique_ptr<IC3Base::FrameSolver> IC3Base::make_frame_solver(size_t i)
+{
+  unique_ptr<FrameSolver> fs(new FrameSolver);
+  fs->solver = create_solver_for(solver_->get_solver_enum(), engine_, false);
+  set_query_limits(fs->solver);
+  fs->to_solver.reset(new TermTranslator(fs->solver));
+  fs->init = ts_.init();
+  fs->trans = ts_.trans();
+
+  const SmtSolver & s = fs->solver;
+  TermTranslator & tt = *fs->to_solver;
+  s->assert_formula(tt.transfer_term(ts_.trans(), BOOL));
+  if (!i) {
+    s->assert_formula(tt.transfer_term(ts_.init(), BOOL));
+  } else {
+    // frames_ keeps lemmas in the highest frame they hold in
+    s->assert_formula(tt.transfer_term(smart_not(bad_), BOOL));
+    for (const auto & u : inf_frame_) {
+      s->assert_formula(tt.transfer_term(u.term, BOOL));
+    }
+    for (size_t j = i; j < frames_.size(); ++j) {
+      for (const auto & u : frames_[j]) {
+        s->assert_formula(tt.transfer_term(u.term, BOOL));
+      }
+    }
+  }
+  return fs;
+}
+
+IC3Formula IC3Base::unsat_core_generalization(const IC3Formula & c,
+                                              const TermVec & assumps,
+                                              const UnorderedTermSet & core)
+{
+  assert(core.size());
+
+  TermVec gen;  // cheap unsat-core generalization of c
+  TermVec rem;  // conjuncts removed by unsat core
+  // might need to be re-added if it
+  // ends up intersecting with initial
+  assert(assumps.size() == c.children.size());
+  for (size_t i = 0; i < assumps.size(); ++i) {
+    if (core.find(assumps.at(i)) == core.end()) {
+      rem.push_back(c.children.at(i));
+    } else {
+      gen.push_back(c.children.at(i));
+    }
+  }
+
+  if (options_.ic3_lit_order_) {
+    bump_activity(gen);
+  }
+
+  fix_if_intersects_initial(gen, rem);
+  assert(gen.size() >= core.size());
+
+  // keep it as a conjunction for now
+  return ic3formula_conjunction(gen);
 }
 
 // Helper methods
 
 bool IC3Base::block_all()
 {
+  TIMELINE_SPAN("ic3_block_all");
   assert(!solver_context_);
   ProofGoalQueue proof_goals;
-  IC3Formula goal;
-  while (reaches_bad(goal)) {
-    assert(goal.term);            // expecting non-null
-    assert(proof_goals.empty());  // bad should be the first goal each iteration
-    proof_goals.new_proof_goal(goal, frontier_idx(), nullptr);
+  std::vector<std::pair<IC3Formula, GoalModel>> bad_goals;
+
+  size_t num_threads = num_worker_threads(options_, options_.ic3_block_threads_);
+  // proof goals checked concurrently
+  // NOTE: the goals stay allocated until proof_goals is destroyed
+  //       so the pointers are unique
+  std::unordered_set<const ProofGoal *> tried;
+  std::unordered_map<const ProofGoal *, IC3Formula> blocked;
+  while (reaches_bad_batch(bad_goals)) {
+    // bad should be the first goals each iteration
+    assert(proof_goals.empty());
+    for (size_t j = 0; j < bad_goals.size(); ++j) {
+      assert(bad_goals[j].first.term);  // expecting non-null
+      proof_goals.new_proof_goal(
+          bad_goals[j].first, frontier_idx(), nullptr, bad_goals[j].second, j);
+    }
 
     while (!proof_goals.empty()) {
+      if (interrupted()) {
+        // caller (step) checks interrupted() before using the result
+        proof_goals.clear();
+        return true;
+      }
+
       const ProofGoal * pg = proof_goals.top();
 
       if (!pg->idx) {
         // went all the way back to initial
         // need to create a new proof goal that's not managed by the queue
-        reconstruct_trace(pg, cex_);
+        reconstruct_trace(pg, cex_, &cex_models_);
 
         // in case this is spurious, clear the queue of proof goals
         // which might not have been precise
@@ -596,7 +1109,7 @@ bool IC3Base::block_all()
       }
 
       if (is_blocked(pg)) {
-        logger.log(3,
+        logger.log(ic3_log, 3,
                    "Skipping already blocked proof goal <{}, {}>",
                    pg->target.term,
                    pg->idx);
@@ -606,20 +1119,45 @@ bool IC3Base::block_all()
         continue;
       }
 
+      if (num_threads > 1) {
+        check_proof_goals_concurrently(
+            proof_goals, num_threads, tried, blocked);
+      }
+
       IC3Formula collateral;  // populated by rel_ind_check
-      if (rel_ind_check(pg->idx, pg->target, collateral)) {
+      auto it = blocked.find(pg);
+      bool is_ind;
+      if (it != blocked.end()) {
+        collateral = it->second;
+        blocked.erase(it);
+        is_ind = true;
+      } else {
+        is_ind = rel_ind_check(pg->idx, pg->target, collateral);
+        if (rel_ind_unknown_) {
+          // there is no predecessor to continue with, give up on this
+          // step rather than reporting the goal as blocked
+          budget_.cancel("IC3: relative induction query returned unknown");
+          continue;
+        }
+      }
+
+      if (is_ind) {
         // this proof goal can be blocked
         assert(!solver_context_);
         assert(collateral.term);
-        logger.log(
-            3, "Blocking term at frame {}: {}", pg->idx, pg->target.term);
+        logger.log(ic3_log,
+                   3,
+                   "Blocking term at frame {}: {}",
+                   pg->idx,
+                   pg->target.term);
 
         // remove the proof goal now that it has been blocked
         assert(pg == proof_goals.top());
         proof_goals.pop();
 
         if (options_.ic3_indgen_) {
-          collateral = inductive_generalization(pg->idx, collateral);
+          collateral =
+              record_inductive_generalization(pg->idx, collateral);
         } else {
           // just negate the term
           collateral = ic3formula_negate(collateral);
@@ -637,89 +1175,654 @@ bool IC3Base::block_all()
         // up to the frontier
         if (idx < frontier_idx()) {
           assert(!pg->target.disjunction);
-          proof_goals.new_proof_goal(pg->target, idx + 1, pg->next);
+          proof_goals.new_proof_goal(
+              pg->target, idx + 1, pg->next, pg->model);
         }
 
       } else {
         // could not block this proof goal
         assert(collateral.term);
-        proof_goals.new_proof_goal(collateral, pg->idx - 1, pg);
+
+        // these checks need the solver context to be popped
+        // if the goal is at frame 1, the predecessor is an initial state
+        assert(pg->idx != 1 || check_intersects_initial(collateral.term));
+
+        // should never intersect with a frame before F[i-1]
+        // otherwise, this predecessor should have been found
+        // in a previous step (before a new frame was pushed)
+        assert(pg->idx < 2
+               || !check_intersects(collateral.term,
+                                    get_frame_term(pg->idx - 2)));
+
+        proof_goals.new_proof_goal(
+            collateral, pg->idx - 1, pg, last_goal_model_);
       }
     }  // end while(!proof_goals.empty())
 
-    assert(!(goal = IC3Formula()).term);  // in debug mode, reset it
-  }                                       // end while(reaches_bad(goal))
+  }  // end while(reaches_bad_batch(bad_goals))
 
   assert(proof_goals.empty());
   return true;
 }
 
-bool IC3Base::is_blocked(const ProofGoal * pg)
+void IC3Base::check_proof_goals_concurrently(
+    const ProofGoalQueue & proof_goals,
+    size_t num_threads,
+    std::unordered_set<const ProofGoal *> & tried,
+    std::unordered_map<const ProofGoal *, IC3Formula> & blocked)
 {
-  // syntactic check
-  for (size_t i = pg->idx; i < frames_.size(); ++i) {
-    const vector<IC3Formula> & Fi = frames_.at(i);
-    for (size_t j = 0; j < Fi.size(); ++j) {
-      if (subsumes(Fi[j], ic3formula_negate(pg->target))) {
-        return true;
-      }
+  assert(!solver_context_);
+
+  // at most one goal per frame solver
+  std::vector<const ProofGoal *> batch;
+  std::unordered_set<size_t> frames;
+  for (const auto & pg : proof_goals.goals()) {
+    if (batch.size() >= num_threads) {
+      break;
     }
+    if (!pg->idx || tried.find(pg) != tried.end()
+        || !frames.insert(pg->idx).second) {
+      continue;
+    }
+    tried.insert(pg);
+    batch.push_back(pg);
   }
 
-  // now semantic check
-  assert(solver_context_ == 0);
+  if (batch.size() < 2) {
+    // nothing to gain, the goal is checked by rel_ind_check
+    for (const auto & pg : batch) {
+      tried.erase(pg);
+    }
+    return;
+  }
 
-  push_solver_context();
-  assert_frame_labels(pg->idx);
-  solver_->assert_formula(pg->target.term);
-  Result r = check_sat();
-  pop_solver_context();
+  // only this thread uses solver_, see parallel_propagate
+  std::vector<RelIndQuery> queries(batch.size());
+  for (size_t j = 0; j < batch.size(); ++j) {
+    prepare_rel_ind_query(
+        frame_solver(batch[j]->idx - 1), batch[j]->target, queries[j]);
+  }
 
-  return r.is_unsat();
+  std::vector<thread> threads;
+  threads.reserve(batch.size());
+  for (size_t j = 0; j < batch.size(); ++j) {
+    const SmtSolver & s = frame_solvers_[batch[j]->idx - 1]->solver;
+    threads.push_back(
+        thread(&IC3Base::run_rel_ind_query, this, s, std::ref(queries[j])));
+  }
+  for (auto & t : threads) {
+    t.join();
+  }
+  stats_->increment("concurrent_proof_goal_batches");
+
+  for (size_t j = 0; j < batch.size(); ++j) {
+    const RelIndQuery & q = queries[j];
+    if (!q.res.is_unsat()) {
+      continue;
+    }
+    const IC3Formula & c = batch[j]->target;
+    if (options_.ic3_unsatcore_gen_) {
+      stats_->increment("unsat_cores");
+      blocked[batch[j]] = unsat_core_generalization(c, q.assumps, q.core);
+    } else {
+      blocked[batch[j]] = c;
+    }
+  }
 }
 
-bool IC3Base::propagate(size_t i)
+void IC3Base::add_shared_lemmas()
 {
-  assert(!solver_context_);
-  assert(i < frontier_idx());
+  if (!lemma_bus_) {
+    return;
+  }
 
-  vector<IC3Formula> & Fi = frames_.at(i);
+  std::vector<TermVec> candidates;
+  import_lemmas(candidates);
+  for (const auto & children : candidates) {
+    IC3Formula u = ic3formula_disjunction(children);
+    if (!ts_.only_curr(u.term) || !ic3formula_check_valid(u)) {
+      // not a lemma this flavor of IC3 can use
+      continue;
+    }
 
-  size_t k = 0;
-  IC3Formula gen;
-  for (size_t j = 0; j < Fi.size(); ++j) {
-    const IC3Formula & c = Fi.at(j);
-    assert(c.disjunction);
-    assert(c.term);
-    assert(c.children.size());
+    if (check_intersects_initial(ic3formula_negate(u).term)) {
+      continue;
+    }
 
-    // NOTE: rel_ind_check works on conjunctions
-    //       need to negate
-    if (rel_ind_check(i + 1, ic3formula_negate(c), gen, false)) {
-      // can push to next frame
-      // got unsat-core based generalization
-      assert(gen.term);
-      assert(gen.children.size());
-      constrain_frame(i + 1, ic3formula_negate(gen), false);
-    } else {
-      // have to keep this one at this frame
-      Fi[k++] = c;
+    // u holds in F[0], push as far as possible
+    size_t idx = find_highest_frame(0, u);
+    if (idx) {
+      logger.log(ic3_log,
+                 3,
+                 "Adding shared lemma at frame {}: {}",
+                 idx,
+                 u.term);
+      stats_->increment("accepted_lemmas");
+      constrain_frame(idx, u);
     }
   }
-
-  // get rid of garbage at end of frame
-  Fi.resize(k);
-
-  return Fi.empty();
 }
 
-void IC3Base::predecessor_generalization_and_fix(size_t i,
-                                                 const Term & c,
-                                                 IC3Formula & pred)
+void IC3Base::load_lemma_cache()
 {
-  TermVec orig_pred_children;
-  if (approx_pregen_) {
-    assert(!pred.disjunction);
+  assert(reached_k_ == 1);
+  assert(!solver_context_);
+  if (options_.ic3_lemma_cache_.empty()) {
+    return;
+  }
+
+  std::vector<TermVec> candidates;
+  if (!read_lemma_cache(options_.ic3_lemma_cache_, ts_, bad_, candidates)) {
+    logger.log(ic3_log, 1,
+               "IC3Base: no usable lemma cache in {}",
+               options_.ic3_lemma_cache_);
+    return;
+  }
+
+  std::vector<IC3Formula> lemmas;
+  for (const auto & children : candidates) {
+    IC3Formula u = ic3formula_disjunction(children);
+    if (ic3formula_check_valid(u)) {
+      lemmas.push_back(u);
+    }
+  }
+  stats_->set("cached_lemmas", candidates.size());
+
+  // drop lemmas that some initial state violates
+  while (lemmas.size()) {
+    TermVec lemma_terms;
+    for (const auto & u : lemmas) {
+      lemma_terms.push_back(u.term);
+    }
+    push_solver_context();
+    solver_->assert_formula(init_label_);
+    solver_->assert_formula(smart_not(make_and(lemma_terms)));
+    Result r = check_sat();
+    if (r.is_unsat()) {
+      pop_solver_context();
+      break;
+    }
+    if (!r.is_sat()) {
+      // e.g. a query limit, there is no model to filter the lemmas with
+      pop_solver_context();
+      logger.log(ic3_log, 1,
+                 "IC3Base: lemma cache check returned unknown, not using "
+                 "the cache");
+      stats_->set("reused_lemmas", 0);
+      return;
+    }
+    std::vector<IC3Formula> kept;
+    for (const auto & u : lemmas) {
+      if (solver_->get_value(u.term) == solver_true_) {
+        kept.push_back(u);
+      }
+    }
+    pop_solver_context();
+    assert(kept.size() < lemmas.size());
+    lemmas = std::move(kept);
+  }
+
+  // drop lemmas that are not inductive relative to the others
+  while (lemmas.size()) {
+    TermVec lemma_terms;
+    for (const auto & u : lemmas) {
+      lemma_terms.push_back(u.term);
+    }
+    Term all_lemmas = make_and(lemma_terms);
+    push_solver_context();
+    solver_->assert_formula(trans_label_);
+    solver_->assert_formula(all_lemmas);
+    solver_->assert_formula(smart_not(ts_.next(all_lemmas)));
+    Result r = check_sat();
+    if (r.is_unsat()) {
+      pop_solver_context();
+      break;
+    }
+    if (!r.is_sat()) {
+      // e.g. a query limit, there is no model to filter the lemmas with
+      pop_solver_context();
+      logger.log(ic3_log, 1,
+                 "IC3Base: lemma cache check returned unknown, not using "
+                 "the cache");
+      stats_->set("reused_lemmas", 0);
+      return;
+    }
+    std::vector<IC3Formula> kept;
+    for (const auto & u : lemmas) {
+      if (solver_->get_value(ts_.next(u.term)) == solver_true_) {
+        kept.push_back(u);
+      }
+    }
+    pop_solver_context();
+    assert(kept.size() < lemmas.size());
+    lemmas = std::move(kept);
+  }
+
+  logger.log(ic3_log, 1,
+             "IC3Base: seeding frame 1 with {} of {} cached lemmas",
+             lemmas.size(),
+             candidates.size());
+  stats_->set("reused_lemmas", lemmas.size());
+  for (const auto & u : lemmas) {
+    constrain_frame(1, u);
+  }
+}
+
+void IC3Base::save_lemma_cache(size_t i) const
+{
+  if (options_.ic3_lemma_cache_.empty()) {
+    return;
+  }
+
+  std::vector<TermVec> lemmas;
+  for (size_t j = i; j < frames_.size(); ++j) {
+    for (const auto & u : frames_[j]) {
+      lemmas.push_back(u.children);
+    }
+  }
+  for (const auto & u : inf_frame_) {
+    lemmas.push_back(u.children);
+  }
+  size_t n = write_lemma_cache(options_.ic3_lemma_cache_, ts_, bad_, lemmas);
+  logger.log(ic3_log, 1,
+             "IC3Base: saved {} lemmas to {}",
+             n,
+             options_.ic3_lemma_cache_);
+}
+
+void IC3Base::report_memory()
+{
+  super::report_memory();
+  size_t num_lemmas = 0;
+  size_t bytes = frames_.capacity() * sizeof(vector<IC3Formula>);
+  for (const auto & f : frames_) {
+    num_lemmas += f.size();
+    bytes += f.capacity() * sizeof(IC3Formula);
+    for (const auto & c : f) {
+      bytes += c.children.capacity() * sizeof(Term);
+      bytes += c.lits.capacity() * sizeof(LitId);
+    }
+  }
+  bytes += inf_frame_.capacity() * sizeof(IC3Formula);
+  for (const auto & c : inf_frame_) {
+    bytes += c.children.capacity() * sizeof(Term);
+    bytes += c.lits.capacity() * sizeof(LitId);
+  }
+  stats_->set("ic3_frame_lemmas", num_lemmas);
+  stats_->set("ic3_inf_frame_lemmas", inf_frame_.size());
+  stats_->set("ic3_literals", lit_table_.size());
+  stats_->set("ic3_frames_bytes", bytes);
+  stats_->set("ic3_labels", labels_.size());
+  stats_->set("ic3_labels_bytes", labels_.memory());
+}
+
+void IC3Base::reduce_memory()
+{
+  super::reduce_memory();
+  reset_solver();
+}
+
+bool IC3Base::save_checkpoint_state(Checkpoint & cp) const
+{
+  assert(cp.reached_k == frontier_idx());
+  cp.frames.clear();
+  for (size_t j = 1; j < frames_.size(); ++j) {
+    cp.frames.emplace_back();
+    for (const auto & u : frames_[j]) {
+      cp.frames.back().push_back(u.children);
+    }
+  }
+  // the infinity frame holds in the frontier, it is found again after
+  // the restore
+  for (const auto & u : inf_frame_) {
+    cp.frames.back().push_back(u.children);
+  }
+  return true;
+}
+
+bool IC3Base::restore_checkpoint_state(const Checkpoint & cp)
+{
+  assert(reached_k_ == 1);
+  assert(!solver_context_);
+  if (cp.frames.size() != static_cast<size_t>(cp.reached_k)) {
+    return false;
+  }
+
+  // check all the lemmas before changing the frames
+  std::vector<std::vector<IC3Formula>> lemmas;
+  for (const auto & f : cp.frames) {
+    lemmas.emplace_back();
+    for (const auto & children : f) {
+      if (children.empty()) {
+        return false;
+      }
+      IC3Formula u = ic3formula_disjunction(children);
+      if (!ic3formula_check_valid(u)) {
+        return false;
+      }
+      lemmas.back().push_back(u);
+    }
+  }
+
+  while (frames_.size() < lemmas.size() + 1) {
+    push_frame();
+  }
+  for (size_t i = 0; i < lemmas.size(); ++i) {
+    for (const auto & u : lemmas[i]) {
+      constrain_frame(i + 1, u, false);
+    }
+  }
+  reached_k_ = frontier_idx();
+  assert(reached_k_ == cp.reached_k);
+
+  stats_->set("frames", frames_.size());
+  return true;
+}
+
+void IC3Base::publish_frontier_lemmas()
+{
+  if (!lemma_bus_) {
+    return;
+  }
+
+  // the frontier over-approximates the states reachable in frontier_idx()
+  // transitions, the bus only keeps a lemma again if its frame grows
+  int frame = frontier_idx();
+  for (const auto & u : frames_.back()) {
+    publish_lemma(u.children, frame);
+  }
+}
+
+bool IC3Base::is_blocked(const ProofGoal * pg)
+{
+  // syntactic check
+  IC3Formula blocking = ic3formula_negate(pg->target);
+  blocking.lits = lit_table_.ids(blocking.children);
+  for (const auto & u : inf_frame_) {
+    if (subsumes(u, blocking)) {
+      return true;
+    }
+  }
+  for (size_t i = pg->idx; i < frames_.size(); ++i) {
+    const vector<IC3Formula> & Fi = frames_.at(i);
+    for (size_t j = 0; j < Fi.size(); ++j) {
+      if (subsumes(Fi[j], blocking)) {
+        if (options_.ic3_lemma_gc_period_) {
+          ++lemma_activity_[Fi[j].term];
+        }
+        return true;
+      }
+    }
+  }
+
+  // now semantic check
+  assert(solver_context_ == 0);
+
+  push_solver_context();
+  assert_frame_labels(pg->idx);
+  solver_->assert_formula(pg->target.term);
+  Result r = check_sat();
+  pop_solver_context();
+
+  return r.is_unsat();
+}
+
+bool IC3Base::propagate(size_t i)
+{
+  TIMELINE_SPAN("ic3_propagate");
+  SOLVER_TRACE_SCOPE("ic3_propagate");
+  assert(!solver_context_);
+  assert(i < frontier_idx());
+
+  vector<IC3Formula> & Fi = frames_.at(i);
+
+  size_t num_threads = num_worker_threads(options_, options_.ic3_prop_threads_);
+  if (num_threads > 1 && Fi.size() > 1) {
+    return parallel_propagate(i, std::min(num_threads, Fi.size()));
+  }
+
+  size_t k = 0;
+  IC3Formula gen;
+  for (size_t j = 0; j < Fi.size(); ++j) {
+    const IC3Formula & c = Fi.at(j);
+    assert(c.disjunction);
+    assert(c.term);
+    assert(c.children.size());
+
+    // NOTE: rel_ind_check works on conjunctions
+    //       need to negate
+    if (rel_ind_check(i + 1, ic3formula_negate(c), gen, false)) {
+      // can push to next frame
+      // got unsat-core based generalization
+      assert(gen.term);
+      assert(gen.children.size());
+      constrain_frame(i + 1, ic3formula_negate(gen), false);
+    } else {
+      // have to keep this one at this frame
+      if (k != j) {
+        Fi[k] = std::move(Fi[j]);
+      }
+      ++k;
+    }
+  }
+
+  // get rid of garbage at end of frame
+  Fi.resize(k);
+
+  return Fi.empty();
+}
+
+bool IC3Base::parallel_propagate(size_t i, size_t num_threads)
+{
+  assert(!solver_context_);
+  assert(num_threads > 1);
+
+  vector<IC3Formula> & Fi = frames_.at(i);
+  const size_t n = Fi.size();
+  assert(num_threads <= n);
+  stats_->increment("parallel_propagations");
+
+  // only this thread uses solver_, so all the terms are created here and
+  // the threads just run the queries in their own solver
+  // NOTE: declared before the queries, whose terms have to go first
+  vector<unique_ptr<FrameSolver>> solvers;
+  vector<IC3Formula> conjs;
+  vector<RelIndQuery> queries(n);
+  conjs.reserve(n);
+  for (size_t t = 0; t < num_threads; ++t) {
+    solvers.push_back(make_frame_solver(i));
+    // thread t checks lemmas [t * n / num_threads, (t + 1) * n / num_threads)
+    for (size_t j = t * n / num_threads; j < (t + 1) * n / num_threads; ++j) {
+      const IC3Formula & c = Fi.at(j);
+      assert(c.disjunction);
+      conjs.push_back(ic3formula_negate(c));
+      prepare_rel_ind_query(*solvers.back(), conjs.back(), queries[j]);
+    }
+  }
+  assert(conjs.size() == n);
+
+  auto run = [&](size_t t) {
+    for (size_t j = t * n / num_threads; j < (t + 1) * n / num_threads; ++j) {
+      if (interrupted()) {
+        return;
+      }
+      run_rel_ind_query(solvers[t]->solver, queries[j]);
+    }
+  };
+
+  vector<thread> threads;
+  threads.reserve(num_threads);
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.push_back(thread(run, t));
+  }
+  for (auto & t : threads) {
+    t.join();
+  }
+
+  // merge in the order of Fi, same as propagate
+  size_t k = 0;
+  IC3Formula gen;
+  for (size_t j = 0; j < n; ++j) {
+    const RelIndQuery & q = queries[j];
+    if (q.res.is_unsat()) {
+      if (options_.ic3_unsatcore_gen_) {
+        stats_->increment("unsat_cores");
+        gen = unsat_core_generalization(conjs[j], q.assumps, q.core);
+      } else {
+        gen = conjs[j];
+      }
+      constrain_frame(i + 1, ic3formula_negate(gen), false);
+    } else {
+      // not inductive (or not checked), keep this one at this frame
+      if (k != j) {
+        Fi[k] = std::move(Fi[j]);
+      }
+      ++k;
+    }
+  }
+
+  Fi.resize(k);
+
+  return Fi.empty();
+}
+
+size_t IC3Base::propagate_to_inf_frame()
+{
+  TIMELINE_SPAN("ic3_inf_frame");
+  assert(!solver_context_);
+
+  // drop lemmas that are not inductive relative to the others
+  std::vector<IC3Formula> lemmas = frames_.back();
+  while (lemmas.size()) {
+    TermVec lemma_terms;
+    for (const auto & u : lemmas) {
+      lemma_terms.push_back(u.term);
+    }
+    Term all_lemmas = make_and(lemma_terms);
+    push_solver_context();
+    solver_->assert_formula(trans_label_);
+    solver_->assert_formula(all_lemmas);
+    solver_->assert_formula(smart_not(ts_.next(all_lemmas)));
+    Result r = check_sat();
+    stats_->increment("inf_frame_checks");
+    if (r.is_unsat()) {
+      pop_solver_context();
+      break;
+    } else if (r.is_unknown()) {
+      pop_solver_context();
+      lemmas.clear();
+      break;
+    }
+    std::vector<IC3Formula> kept;
+    for (const auto & u : lemmas) {
+      if (solver_->get_value(ts_.next(u.term)) == solver_true_) {
+        kept.push_back(u);
+      }
+    }
+    pop_solver_context();
+    assert(kept.size() < lemmas.size());
+    lemmas = std::move(kept);
+  }
+
+  if (lemmas.empty()) {
+    return 0;
+  }
+
+  // assert them for every query, the old assertions under the frontier
+  // label become dead
+  for (const auto & u : lemmas) {
+    solver_->assert_formula(u.term);
+    ++num_lemma_assertions_;
+    inf_frame_.push_back(u);
+    // holds in every state reachable in any number of transitions
+    publish_lemma(u.children, std::numeric_limits<int>::max());
+  }
+  // removes them from the frontier, they subsume themselves
+  size_t num_dropped = drop_subsumed_lemmas() - lemmas.size();
+
+  logger.log(ic3_log,
+             1,
+             "IC3Base: moved {} lemmas to the infinity frame, dropped {} "
+             "subsumed lemmas",
+             lemmas.size(),
+             num_dropped);
+  stats_->increment("inf_frame_moved_lemmas", lemmas.size());
+  stats_->set("inf_frame_lemmas", inf_frame_.size());
+  return lemmas.size();
+}
+
+size_t IC3Base::collect_lemmas()
+{
+  TIMELINE_SPAN("ic3_lemma_gc");
+  assert(!solver_context_);
+
+  std::vector<std::pair<Term, size_t>> kept;
+  size_t num_deleted = 0;
+  for (size_t i = 1; i < frames_.size(); ++i) {
+    vector<IC3Formula> & Fi = frames_[i];
+    size_t k = 0;
+    for (size_t l = 0; l < Fi.size(); ++l) {
+      auto it = lemma_activity_.find(Fi[l].term);
+      size_t activity = (it == lemma_activity_.end()) ? 0 : it->second;
+      if (!activity && i < frontier_idx()) {
+        continue;
+      }
+      kept.emplace_back(Fi[l].term, activity / 2);
+      if (k != l) {
+        Fi[k] = std::move(Fi[l]);
+      }
+      ++k;
+    }
+    num_deleted += Fi.size() - k;
+    Fi.resize(k);
+  }
+
+  // also forgets the lemmas that were propagated or subsumed
+  lemma_activity_.clear();
+  for (const auto & elem : kept) {
+    if (elem.second) {
+      lemma_activity_[elem.first] = elem.second;
+    }
+  }
+
+  if (num_deleted) {
+    num_collected_lemmas_ += num_deleted;
+    // the frame solvers still hold the deleted lemmas
+    frame_solvers_.clear();
+    // and so does solver_, under the labels of their frames
+    reset_solver();
+  }
+
+  logger.log(ic3_log,
+             1,
+             "IC3Base: deleted {} inactive lemmas, kept {}",
+             num_deleted,
+             kept.size());
+  stats_->increment("lemma_gc_runs");
+  stats_->set("lemma_gc_deleted_lemmas", num_collected_lemmas_);
+  return num_deleted;
+}
+
+bool IC3Base::is_inductive(const Term & t)
+{
+  assert(!solver_context_);
+  push_solver_context();
+  solver_->assert_formula(trans_label_);
+  solver_->assert_formula(t);
+  solver_->assert_formula(smart_not(ts_.next(t)));
+  Result r = check_sat();
+  pop_solver_context();
+  return r.is_unsat();
+}
+
+void IC3Base::predecessor_generalization_and_fix(size_t i,
+                                                 const Term & c,
+                                                 IC3Formula & pred)
+{
+  size_t orig_size = pred.children.size();
+  TermVec orig_pred_children;
+  if (approx_pregen_) {
+    assert(!pred.disjunction);
     // save original predecessor conjuncts
     orig_pred_children = pred.children;
     assert(orig_pred_children.size());
@@ -742,15 +1845,28 @@ void IC3Base::predecessor_generalization_and_fix(size_t i,
     // need to make sure it does not intersect with F[i-2]
     Term formula = get_frame_term(i - 2);
     formula = solver_->make_term(And, formula, pred.term);
+    stats_->increment("reducer_unsat_cores");
     bool unsat =
         reducer_.reduce_assump_unsatcore(formula, dropped, pred_children);
-    assert(unsat);
-    pred = ic3formula_conjunction(pred_children);
+    if (unsat) {
+      pred = ic3formula_conjunction(pred_children);
+    } else {
+      // e.g. the reducer hit its query limit, keep the unreduced predecessor
+      stats_->increment("reducer_unknown_queries");
+      pred = ic3formula_conjunction(orig_pred_children);
+    }
   }
 
   assert(pred.term);
   assert(pred.children.size());
   assert(!pred.disjunction);  // expecting a conjunction
+
+  // the percentage of the assignment dropped by the generalization
+  if (orig_size) {
+    size_t size = std::min(pred.children.size(), orig_size);
+    stats_->record("pregen_reduction_percent",
+                   100 * (orig_size - size) / orig_size);
+  }
 }
 
 void IC3Base::push_frame()
@@ -780,13 +1896,21 @@ void IC3Base::constrain_frame(size_t i, const IC3Formula & constraint,
   assert(constraint.disjunction);
   assert(ts_.only_curr(constraint.term));
 
+  IC3Formula lemma = constraint;
+  if (lemma.lits.empty()) {
+    lemma.lits = lit_table_.ids(lemma.children);
+  }
+
   if (new_constraint) {
     for (size_t j = 1; j <= i; ++j) {
       vector<IC3Formula> & Fj = frames_.at(j);
       size_t k = 0;
       for (size_t l = 0; l < Fj.size(); ++l) {
-        if (!subsumes(constraint, Fj[l])) {
-          Fj[k++] = Fj[l];
+        if (!subsumes(lemma, Fj[l])) {
+          if (k != l) {
+            Fj[k] = std::move(Fj[l]);
+          }
+          ++k;
         }
       }
       Fj.resize(k);
@@ -795,8 +1919,22 @@ void IC3Base::constrain_frame(size_t i, const IC3Formula & constraint,
 
   assert(i > 0);  // there's a special case for frame 0
 
-  constrain_frame_label(i, constraint);
-  frames_.at(i).push_back(constraint);
+  if (new_constraint && options_.ic3_lemma_gc_period_) {
+    ++lemma_activity_[lemma.term];
+  }
+
+  constrain_frame_label(i, lemma);
+
+  // the constraint also holds in all the lower frames
+  for (size_t j = 1; j <= i && j < frame_solvers_.size(); ++j) {
+    if (frame_solvers_[j]) {
+      FrameSolver & fs = *frame_solvers_[j];
+      fs.solver->assert_formula(
+          fs.to_solver->transfer_term(lemma.term, BOOL));
+    }
+  }
+
+  frames_.at(i).push_back(std::move(lemma));
 }
 
 void IC3Base::constrain_frame_label(size_t i, const IC3Formula & constraint)
@@ -805,6 +1943,7 @@ void IC3Base::constrain_frame_label(size_t i, const IC3Formula & constraint)
 
   solver_->assert_formula(
       solver_->make_term(Implies, frame_labels_.at(i), constraint.term));
+  ++num_lemma_assertions_;
 }
 
 void IC3Base::assert_frame_labels(size_t i) const
@@ -825,6 +1964,16 @@ void IC3Base::assert_frame_labels(size_t i) const
   }
 }
 
+void IC3Base::frame_label_assumptions(size_t i, TermVec & out) const
+{
+  assert(frame_labels_.size() == frames_.size());
+  for (size_t j = 0; j < frame_labels_.size(); ++j) {
+    // same as assert_frame_labels: disable the unused constraints
+    out.push_back(j < i ? solver_->make_term(Not, frame_labels_[j])
+                        : frame_labels_[j]);
+  }
+}
+
 Term IC3Base::get_frame_term(size_t i) const
 {
   // TODO: decide if frames should hold IC3Formulas or terms
@@ -840,6 +1989,9 @@ Term IC3Base::get_frame_term(size_t i) const
       res = solver_->make_term(And, res, u.term);
     }
   }
+  for (const auto & u : inf_frame_) {
+    res = solver_->make_term(And, res, u.term);
+  }
 
   // the property is implicitly part of the frame
   res = solver_->make_term(And, res, smart_not(bad_));
@@ -854,6 +2006,42 @@ void IC3Base::assert_trans_label() const
   solver_->assert_formula(trans_label_);
 }
 
+void IC3Base::define_trans_partitions()
+{
+  if (!options_.ic3_partition_trans_) {
+    return;
+  }
+
+  // trans might have changed since the last definition (e.g. on a reset)
+  partitioned_trans_.reset(new PartitionedTrans(ts_));
+  global_trans_label_ = solver_->make_symbol(
+      "__global_trans_label_" + std::to_string(num_act_lits_++), boolsort_);
+  solver_->assert_formula(solver_->make_term(
+      Implies, global_trans_label_, partitioned_trans_->global()));
+  partition_labels_.clear();
+  for (size_t i = 0; i < partitioned_trans_->size(); ++i) {
+    Term lbl = solver_->make_symbol("__trans_partition_label_"
+                                        + std::to_string(num_act_lits_++),
+                                    boolsort_);
+    solver_->assert_formula(
+        solver_->make_term(Implies, lbl, partitioned_trans_->partition(i)));
+    partition_labels_.push_back(lbl);
+  }
+}
+
+void IC3Base::trans_cone_labels(const IC3Formula & c, TermVec & out) const
+{
+  assert(partitioned_trans_);
+  UnorderedTermSet free_vars;
+  get_free_symbolic_consts(c.term, free_vars);
+  std::vector<size_t> cone;
+  partitioned_trans_->cone(free_vars, cone);
+  out.push_back(global_trans_label_);
+  for (auto i : cone) {
+    out.push_back(partition_labels_.at(i));
+  }
+}
+
 bool IC3Base::check_intersects(const Term & A, const Term & B)
 {
   // should only do this check starting from context 0
@@ -869,6 +2057,7 @@ bool IC3Base::check_intersects(const Term & A, const Term & B)
 
 bool IC3Base::check_intersects_initial(const Term & t)
 {
+  SOLVER_TRACE_SCOPE("ic3_initial");
   return check_intersects(init_label_, t);
 }
 
@@ -880,13 +2069,27 @@ void IC3Base::fix_if_intersects_initial(TermVec & to_keep, const TermVec & rem)
   if (rem.size() != 0) {
     Term formula = solver_->make_term(And, ts_.init(), make_and(to_keep));
 
+    stats_->increment("reducer_unsat_cores");
+    stats_->increment("init_fix_checks");
+    TermVec orig_keep = to_keep;
     bool success = reducer_.reduce_assump_unsatcore(formula,
                                                     rem,
                                                     to_keep,
                                                     NULL,
                                                     options_.ic3_gen_max_iter_,
                                                     options_.random_seed_);
-    assert(success);
+    if (!success) {
+      // e.g. the reducer hit its query limit, keep the unreduced set
+      stats_->increment("reducer_unknown_queries");
+      to_keep = orig_keep;
+      to_keep.insert(to_keep.end(), rem.begin(), rem.end());
+    }
+    if (to_keep.size() > orig_keep.size()) {
+      // the generalization intersected the initial states
+      stats_->increment("init_fix_fired");
+      stats_->record("init_fix_readded_lits",
+                     to_keep.size() - orig_keep.size());
+    }
   }
 }
 
@@ -919,29 +2122,51 @@ size_t IC3Base::find_highest_frame(size_t i, IC3Formula & u)
   return j;
 }
 
+void IC3Base::get_values(const TermVec & terms, TermVec & out) const
+{
+  out.clear();
+  out.reserve(terms.size());
+  SolverCallTimer timer(TRACE_GET_VALUE, terms.size());
+  for (const auto & t : terms) {
+    out.push_back(solver_->get_value(t));
+  }
+}
+
 TermVec IC3Base::get_input_values() const
 {
+  TermVec inputs(ts_.inputvars().begin(), ts_.inputvars().end());
+  TermVec vals;
+  get_values(inputs, vals);
+
   TermVec out_inputs;
-  out_inputs.reserve(ts_.inputvars().size());
-  for (const auto & iv : ts_.inputvars()) {
-    out_inputs.push_back(solver_->make_term(Equal, iv, solver_->get_value(iv)));
+  out_inputs.reserve(inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    out_inputs.push_back(solver_->make_term(Equal, inputs[i], vals[i]));
   }
   return out_inputs;
 }
 
 TermVec IC3Base::get_next_state_values() const
 {
-  TermVec out_nexts;
-  out_nexts.reserve(ts_.statevars().size());
-  Term nv;
+  TermVec nexts;
+  nexts.reserve(ts_.statevars().size());
   for (const auto & sv : ts_.statevars()) {
-    nv = ts_.next(sv);
-    out_nexts.push_back(solver_->make_term(Equal, nv, solver_->get_value(nv)));
+    nexts.push_back(ts_.next(sv));
+  }
+  TermVec vals;
+  get_values(nexts, vals);
+
+  TermVec out_nexts;
+  out_nexts.reserve(nexts.size());
+  for (size_t i = 0; i < nexts.size(); ++i) {
+    out_nexts.push_back(solver_->make_term(Equal, nexts[i], vals[i]));
   }
   return out_nexts;
 }
 
-void IC3Base::reconstruct_trace(const ProofGoal * pg, TermVec & out)
+void IC3Base::reconstruct_trace(const ProofGoal * pg,
+                                TermVec & out,
+                                std::vector<GoalModel> * models)
 {
   assert(!solver_context_);
   assert(pg);
@@ -949,9 +2174,15 @@ void IC3Base::reconstruct_trace(const ProofGoal * pg, TermVec & out)
   assert(check_intersects_initial(pg->target.term));
 
   out.clear();
+  if (models) {
+    models->clear();
+  }
   while (pg) {
     out.push_back(pg->target.term);
     assert(ts_.only_curr(out.back()));
+    if (models) {
+      models->push_back(pg->model);
+    }
     pg = pg->next;
   }
 
@@ -960,6 +2191,178 @@ void IC3Base::reconstruct_trace(const ProofGoal * pg, TermVec & out)
   out.push_back(bad_);
 }
 
+void IC3Base::record_goal_model()
+{
+  if (!goal_models_) {
+    return;
+  }
+
+  TermVec terms;
+  terms.reserve(2 * ts_.statevars().size() + ts_.inputvars().size());
+  for (const auto & sv : ts_.statevars()) {
+    terms.push_back(sv);
+    terms.push_back(ts_.next(sv));
+  }
+  terms.insert(terms.end(), ts_.inputvars().begin(), ts_.inputvars().end());
+  if (!options_.witness_inputs_only_) {
+    for (const auto & elem : ts_.named_terms()) {
+      terms.push_back(elem.second);
+    }
+  }
+
+  TermVec vals;
+  get_values(terms, vals);
+  auto model = std::make_shared<UnorderedTermMap>();
+  model->reserve(terms.size());
+  for (size_t i = 0; i < terms.size(); ++i) {
+    model->emplace(terms[i], vals[i]);
+  }
+  last_goal_model_ = std::move(model);
+}
+
+bool IC3Base::witness_from_goals()
+{
+  assert(!solver_context_);
+  if (cex_.empty() || cex_models_.empty()
+      || cex_models_.size() + 1 < cex_.size()) {
+    return false;
+  }
+  for (const auto & m : cex_models_) {
+    if (!m) {
+      return false;
+    }
+  }
+
+  TermVec named;
+  if (!options_.witness_inputs_only_) {
+    for (const auto & elem : ts_.named_terms()) {
+      named.push_back(elem.second);
+    }
+  }
+
+  // the goals are cubes (e.g. after predecessor generalization), so the
+  // state reached from a goal's model need not be the state of the next
+  // goal's model. Then the step is replayed from the reached state with
+  // the inputs of the model, which leads into the next goal as well if
+  // ts_ is deterministic.
+  std::vector<UnorderedTermMap> frames(cex_.size());
+  UnorderedTermMap state;
+  for (size_t j = 0; j < frames.size(); ++j) {
+    const bool last = j + 1 == frames.size();
+    const UnorderedTermMap * m =
+        j < cex_models_.size() ? cex_models_[j].get() : nullptr;
+    UnorderedTermMap & frame = frames[j];
+
+    bool same = m != nullptr;
+    if (same && j) {
+      for (const auto & sv : ts_.statevars()) {
+        if (m->at(sv) != state.at(sv)) {
+          same = false;
+          break;
+        }
+      }
+    }
+    if (same) {
+      frame = *m;
+      for (const auto & sv : ts_.statevars()) {
+        state[sv] = last ? m->at(sv) : m->at(ts_.next(sv));
+      }
+      continue;
+    }
+
+    if (!last && !ts_.is_deterministic()) {
+      stats_->increment("ic3_goal_witness_gaps");
+      return false;
+    }
+
+    TermVec terms = named;
+    push_solver_context();
+    for (const auto & sv : ts_.statevars()) {
+      const Term & val = state.at(sv);
+      solver_->assert_formula(solver_->make_term(Equal, sv, val));
+      frame[sv] = val;
+    }
+    if (last) {
+      // only the inputs and named terms of the bad state are missing
+      for (const auto & c : ts_.constraints()) {
+        solver_->assert_formula(c.first);
+      }
+      solver_->assert_formula(bad_);
+      terms.insert(
+          terms.end(), ts_.inputvars().begin(), ts_.inputvars().end());
+    } else {
+      for (const auto & iv : ts_.inputvars()) {
+        const Term & val = m->at(iv);
+        solver_->assert_formula(solver_->make_term(Equal, iv, val));
+        frame[iv] = val;
+      }
+      solver_->assert_formula(trans_label_);
+      for (const auto & sv : ts_.statevars()) {
+        terms.push_back(ts_.next(sv));
+      }
+    }
+    Result r = check_sat();
+    if (r.is_sat()) {
+      TermVec vals;
+      get_values(terms, vals);
+      for (size_t i = 0; i < terms.size(); ++i) {
+        frame[terms[i]] = vals[i];
+      }
+    }
+    pop_solver_context();
+    if (!r.is_sat()) {
+      stats_->increment("ic3_goal_witness_gaps");
+      return false;
+    }
+    stats_->increment("ic3_goal_witness_replayed_steps");
+    if (!last) {
+      for (const auto & sv : ts_.statevars()) {
+        state[sv] = frame.at(ts_.next(sv));
+      }
+    }
+  }
+
+  // same selection as Prover::compute_witness
+  auto add = [](UnorderedTermMap & map,
+                const UnorderedTermMap & frame,
+                const Term & t) {
+    auto it = frame.find(t);
+    if (it != frame.end()) {
+      map[t] = it->second;
+    }
+  };
+  witness_.clear();
+  for (size_t j = 0; j < frames.size(); ++j) {
+    witness_.push_back(UnorderedTermMap());
+    if (!witness_step(j)) {
+      continue;
+    }
+    UnorderedTermMap & map = witness_.back();
+    const UnorderedTermMap & frame = frames[j];
+    if (!options_.witness_inputs_only_ || !j) {
+      for (const auto & sv : ts_.statevars()) {
+        if (witness_signal(sv->to_string())) {
+          add(map, frame, sv);
+        }
+      }
+    }
+    for (const auto & iv : ts_.inputvars()) {
+      if (witness_signal(iv->to_string())) {
+        add(map, frame, iv);
+      }
+    }
+    if (!options_.witness_inputs_only_) {
+      for (const auto & elem : ts_.named_terms()) {
+        if (witness_signal(elem.first)) {
+          add(map, frame, elem.second);
+        }
+      }
+    }
+  }
+  stats_->increment("ic3_goal_witnesses");
+  return true;
+}
+
 Term IC3Base::make_and(TermVec vec, SmtSolver slv) const
 {
   if (!slv) {
@@ -979,6 +2382,38 @@ Term IC3Base::make_and(TermVec vec, SmtSolver slv) const
   return res;
 }
 
+void IC3Base::strengthen_ts(const TransitionSystem & ts, const Term & bad)
+{
+  initialize();
+  assert(solver_context_ == 0);
+
+  if (ts.statevars().size() != ts_.statevars().size()
+      || ts.inputvars().size() != ts_.inputvars().size()) {
+    throw PonoException(
+        "IC3Base::strengthen_ts expects the variables of the current system");
+  }
+
+  if (ts.solver() == solver_) {
+    ts_ = ts;
+    bad_ = bad;
+  } else {
+    ts_ = TransitionSystem(ts, to_prover_solver_);
+    bad_ = to_prover_solver_.transfer_term(bad, BOOL);
+  }
+  check_ts();
+  cex_.clear();
+  cex_models_.clear();
+
+  // re-asserts init, trans and bad with the frames
+  reset_solver();
+  if (failed_to_reset_solver_) {
+    throw PonoException(
+        "IC3Base::strengthen_ts Cannot keep the frames because the "
+        "underlying SMT solver doesn't support the reset-solver method");
+  }
+  stats_->increment("strengthened_ts");
+}
+
 void IC3Base::reset_solver()
 {
   assert(solver_context_ == 0);
@@ -991,9 +2426,27 @@ void IC3Base::reset_solver()
 
   try {
     solver_->reset_assertions();
+    // also drops the activation literals and label implications
+    // added by rel_ind_check
+    num_dead_act_lits_ = 0;
+    label_defs_.clear();
+
+    num_lemma_assertions_ = 0;
 
     // Now need to add back in constraints at context level 0
-    logger.log(2, "IC3Base: Reset solver and now re-adding constraints.");
+    logger.log(ic3_log,
+               2,
+               "IC3Base: Reset solver and now re-adding constraints.");
+
+    // no need to re-add lemmas implied by the ones of higher frames
+    // only on the resets of --ic3-reset-dead-ratio, the others happen
+    // after every frame and the scan is quadratic in the lemmas
+    if (options_.ic3_reset_dead_ratio_) {
+      size_t num_dropped = drop_subsumed_lemmas();
+      if (num_dropped) {
+        stats_->increment("dropped_subsumed_lemmas", num_dropped);
+      }
+    }
 
     // define init, trans, and bad labels
     assert(init_label_ == frame_labels_.at(0));
@@ -1002,6 +2455,7 @@ void IC3Base::reset_solver()
 
     solver_->assert_formula(
         solver_->make_term(Implies, trans_label_, ts_.trans()));
+    define_trans_partitions();
 
     solver_->assert_formula(solver_->make_term(Implies, bad_label_, bad_));
 
@@ -1021,22 +2475,122 @@ void IC3Base::reset_solver()
         constrain_frame_label(i, constraint);
       }
     }
+
+    // the infinity frame holds in every frame
+    for (const auto & u : inf_frame_) {
+      solver_->assert_formula(u.term);
+      ++num_lemma_assertions_;
+    }
   }
   catch (SmtException & e) {
-    logger.log(1,
+    logger.log(ic3_log, 1,
                "Failed to reset solver (underlying solver must not support "
                "it). Disabling solver resets for rest of run.");
     failed_to_reset_solver_ = true;
   }
 
+  if (!failed_to_reset_solver_) {
+    stats_->increment("solver_resets");
+  }
   num_check_sat_since_reset_ = 0;
 }
 
+void IC3Base::relabel_init_trans()
+{
+  assert(solver_context_ == 0);
+  assert(init_label_ == frame_labels_.at(0));
+
+  init_label_ = solver_->make_symbol(
+      "__init_label_" + std::to_string(num_act_lits_++), boolsort_);
+  frame_labels_[0] = init_label_;
+  solver_->assert_formula(
+      solver_->make_term(Implies, init_label_, ts_.init()));
+  for (const auto & constraint : frames_.at(0)) {
+    constrain_frame_label(0, constraint);
+  }
+
+  trans_label_ = solver_->make_symbol(
+      "__trans_label_" + std::to_string(num_act_lits_++), boolsort_);
+  solver_->assert_formula(
+      solver_->make_term(Implies, trans_label_, ts_.trans()));
+  define_trans_partitions();
+
+  num_dead_act_lits_ += 2;
+  stats_->increment("relabeled_ts");
+}
+
+Term IC3Base::inf_frame_invar()
+{
+  initialize();
+  Term res = solver_true_;
+  for (const auto & u : inf_frame_) {
+    res = solver_->make_term(And, res, u.term);
+  }
+  return to_orig_ts(res, BOOL);
+}
+
+bool IC3Base::solver_reset_due() const
+{
+  if (!options_.ic3_reset_dead_ratio_) {
+    return true;
+  }
+
+  size_t live = inf_frame_.size();
+  for (const auto & f : frames_) {
+    live += f.size();
+  }
+  // lemmas that were subsumed or propagated stay asserted under their
+  // old frame label
+  size_t dead = (num_lemma_assertions_ > live)
+                    ? num_lemma_assertions_ - live
+                    : 0;
+  dead += num_dead_act_lits_;
+  size_t total = live + dead;
+  return dead && 100 * dead >= options_.ic3_reset_dead_ratio_ * total;
+}
+
+size_t IC3Base::drop_subsumed_lemmas()
+{
+  size_t num_dropped = 0;
+  // a lemma of F[j] also holds in every F[i] with i <= j
+  // and a lemma of the infinity frame in all of them
+  for (size_t i = 1; i < frames_.size(); ++i) {
+    vector<IC3Formula> & Fi = frames_[i];
+    size_t k = 0;
+    for (size_t l = 0; l < Fi.size(); ++l) {
+      bool subsumed = false;
+      for (const auto & u : inf_frame_) {
+        if (subsumes(u, Fi[l])) {
+          subsumed = true;
+          break;
+        }
+      }
+      for (size_t j = i + 1; j < frames_.size() && !subsumed; ++j) {
+        for (const auto & u : frames_[j]) {
+          if (subsumes(u, Fi[l])) {
+            subsumed = true;
+            break;
+          }
+        }
+      }
+      if (!subsumed) {
+        if (k != l) {
+          Fi[k] = std::move(Fi[l]);
+        }
+        ++k;
+      }
+    }
+    num_dropped += Fi.size() - k;
+    Fi.resize(k);
+  }
+  return num_dropped;
+}
+
 Term IC3Base::label(const Term & t)
 {
   auto it = labels_.find(t);
   if (it != labels_.end()) {
-    return labels_.at(t);
+    return it->second;
   }
 
   Term l;
@@ -1049,7 +2603,7 @@ Term IC3Base::label(const Term & t)
       try {
         l = solver_->make_symbol(
             "assump_" + std::to_string(t->hash()) + "_" + std::to_string(i),
-            solver_->make_sort(BOOL));
+            boolsort_);
         break;
       }
       catch (IncorrectUsageException & e) {
@@ -1076,9 +2630,8 @@ smt::Term IC3Base::smart_not(const Term & t) const
 {
   const Op &op = t->get_op();
   if (op == Not) {
-    TermVec children(t->begin(), t->end());
-    assert(children.size() == 1);
-    return children[0];
+    // no TermVec, this is on the path of every literal
+    return *t->begin();
   } else {
     return solver_->make_term(Not, t);
   }
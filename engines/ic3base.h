@@ -64,29 +64,41 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <memory>
 #include <queue>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "engines/prover.h"
 #include "smt-switch/utils.h"
+#include "utils/literal_table.h"
+#include "utils/partitioned_trans.h"
+#include "utils/term_hash_map.h"
 
 namespace pono {
 
 struct IC3Formula
 {
   // nullary constructor
-  IC3Formula() : term(nullptr) {}
-  IC3Formula(const smt::Term & t, const smt::TermVec & c, bool n)
-      : term(t), children(c), disjunction(n)
+  IC3Formula() : term(nullptr), signature(0) {}
+  // takes the children by value so that callers can move them in
+  IC3Formula(const smt::Term & t, smt::TermVec c, bool n)
+      : term(t), children(std::move(c)), disjunction(n), signature(0)
   {
     std::sort(children.begin(), children.end());
+    for (const auto & cc : children) {
+      signature |= signature_bit(cc);
+    }
   }
 
-  IC3Formula(const IC3Formula & other)
-      : term(other.term),
-        children(other.children),
-        disjunction(other.disjunction)
-  {
-  }
+  // moves are declared explicitly, the virtual destructor would
+  // otherwise turn every move (e.g. in std::vector) into a copy
+  IC3Formula(const IC3Formula & other) = default;
+  IC3Formula(IC3Formula && other) = default;
+  IC3Formula & operator=(const IC3Formula & other) = default;
+  IC3Formula & operator=(IC3Formula && other) = default;
 
   virtual ~IC3Formula() {}
 
@@ -97,20 +109,43 @@ struct IC3Formula
   smt::TermVec
       children;  ///< flattened children of either a disjunction or conjunction
   bool disjunction;  ///< true if currently representing a disjunction
+  uint64_t signature;  ///< one bit per child (by hash), if the children of
+                       ///< a are a subset of those of b then the bits of a
+                       ///< are a subset of those of b
+  LitVec lits;  ///< ids of the children in the literal table of the engine
+                ///< set for the lemmas in the frames, empty otherwise
+
+  static uint64_t signature_bit(const smt::Term & t)
+  {
+    return uint64_t(1) << (t->hash() % 64);
+  }
   // NOTE: treating the disjunction as the primary orientation
   //       e.g. aligned with what's kept in frames (disjunctions), not proof
   //       goals (conjunctions), but IC3Formula can represent both
 };
 
+/** The model of the query that found a proof goal (with witnesses
+ *  enabled): the values of the state variables, inputs and named terms
+ *  of the goal's state and of the next state variables, the successor
+ *  it was found for
+ */
+typedef std::shared_ptr<const smt::UnorderedTermMap> GoalModel;
+
 struct ProofGoal
 {
   // based on open-source ic3ia ProofObligation
   IC3Formula target;
   size_t idx;
   const ProofGoal * next;
-
-  ProofGoal(IC3Formula u, size_t i, const ProofGoal * n)
-      : target(u), idx(i), next(n)
+  GoalModel model;  ///< null unless recorded
+  size_t rank;      ///< order among the goals of the same frame, lower first
+
+  ProofGoal(IC3Formula u,
+            size_t i,
+            const ProofGoal * n,
+            GoalModel m = nullptr,
+            size_t r = 0)
+      : target(std::move(u)), idx(i), next(n), model(std::move(m)), rank(r)
   {
   }
 };
@@ -126,7 +161,7 @@ struct ProofGoalOrder
   // -- we want the lowest index to be processed first
   bool operator()(const ProofGoal * a, const ProofGoal * b) const
   {
-    return b->idx < a->idx;
+    return b->idx < a->idx || (b->idx == a->idx && b->rank < a->rank);
   }
 };
 
@@ -142,15 +177,21 @@ class ProofGoalQueue
   void clear();
   void new_proof_goal(const IC3Formula & c,
                       unsigned int t,
-                      const ProofGoal * n = NULL);
+                      const ProofGoal * n = NULL,
+                      GoalModel m = nullptr,
+                      size_t rank = 0);
   ProofGoal * top();
   void pop();
   bool empty() const;
+  /** @return the queued proof goals in the order they would be popped */
+  std::vector<const ProofGoal *> goals() const;
 
  private:
   std::priority_queue<ProofGoal *, std::vector<ProofGoal *>, ProofGoalOrder>
       queue_;
-  std::vector<ProofGoal *> store_;
+  ///< owns the proof goals, allocated in blocks and released together
+  ///< a deque never moves its elements, so the pointers stay valid
+  std::deque<ProofGoal> store_;
 };
 
 class IC3Base : public Prover
@@ -177,6 +218,25 @@ class IC3Base : public Prover
 
   size_t witness_length() const override;
 
+  /** Continue with a strengthened version of the system
+   *  For CEGAR loops that refine by adding constraints: ts must have
+   *  the same variables as the current system and only add constraints
+   *  to its init and trans, and bad must imply the current bad.
+   *  Then every lemma in the frames stays valid, so the frames are kept
+   *  and the next call to check_until resumes from the current frontier.
+   *  @param ts the strengthened transition system
+   *  @param bad the (possibly weaker) bad states of the strengthened system
+   *  @throws PonoException if ts has different variables or the solver
+   *          cannot be reset
+   */
+  void strengthen_ts(const TransitionSystem & ts, const smt::Term & bad);
+
+  /** @return the conjunction of the lemmas of the infinity frame (see
+   *          options_.ic3_inf_frame_period_), an inductive invariant that
+   *          need not imply the property, over the original system
+   */
+  smt::Term inf_frame_invar();
+
  protected:
 
   smt::UnsatCoreReducer reducer_;
@@ -188,19 +248,72 @@ class IC3Base : public Prover
   size_t solver_context_;
 
   size_t num_check_sat_since_reset_;
+  size_t num_lemma_assertions_;  ///< lemmas asserted since the last reset
 
   bool failed_to_reset_solver_;  ///< some solvers don't support reset
                                  ///< assertions. Stop trying for those solvers.
 
+  // literal ordering for generalize_cube, see next_literal_to_drop
+  TermHashMap<double> lit_activity_;
+  TermHashMap<size_t> lit_age_;  ///< order of first use
+  double activity_inc_;
+
+  // used by rel_ind_check with options_.ic3_rel_ind_assumptions_
+  size_t num_act_lits_;       ///< activation literals created so far
+  size_t num_dead_act_lits_;  ///< retired since the last solver reset
+  TermHashSet label_defs_;  ///< labels with their implication
+                            ///< asserted at the base context
+
+  // used by rel_ind_check with options_.ic3_partition_trans_
+  std::unique_ptr<PartitionedTrans> partitioned_trans_;
+  smt::Term global_trans_label_;        ///< label to activate its global part
+  smt::TermVec partition_labels_;       ///< labels to activate its partitions
+
+  /** A solver holding only trans and the lemmas of one frame
+   *  (see options_.ic3_frame_solvers_)
+   */
+  struct FrameSolver
+  {
+    smt::SmtSolver solver;
+    std::unique_ptr<smt::TermTranslator> to_solver;
+    smt::Term init;   ///< ts_.init() when it was built
+    smt::Term trans;  ///< ts_.trans() when it was built
+  };
+  ///< frame_solvers_[i] holds F[i], built on first use
+  std::vector<std::unique_ptr<FrameSolver>> frame_solvers_;
+
+  /** A relative induction check prepared for a FrameSolver
+   *  so that it can run on another thread (see run_rel_ind_query)
+   */
+  struct RelIndQuery
+  {
+    smt::Term not_c;          ///< the negated conjunction
+    smt::TermVec label_defs;  ///< semantics of the labels in assumps
+    smt::TermVec assumps;     ///< labels for the children at the next state
+    smt::Result res;          ///< null until checked
+    smt::UnorderedTermSet core;
+  };
+
   smt::TermVec cex_;  ///< a vector of terms over state variables describing
                       ///< a (possibly abstract) counterexample trace
 
+  bool goal_models_;  ///< record the models of the proof goals to build
+                      ///< the witness from them, set with options_.witness_
+                      ///< and cleared by flavors where ts_ is abstract
+  GoalModel last_goal_model_;  ///< of the last query that found a goal
+  smt::TermVec bad_exclusions_;  ///< asserted by reaches_bad, the negations
+                                 ///< of the bad cubes of the current batch
+  ///< the models of the goals of cex_, and of bad_ if it is initial
+  std::vector<GoalModel> cex_models_;
+
   bool approx_pregen_;  ///< if set to true then predecessor generalization
                         ///< might over-generalize leading to intersection
                         ///< with F[i-2]
                         ///< in this case, it will do an extra call to fix
                         ///< this to maintain the invariant that the predecessor
                         ///< is within F[i-1] but not F[i-2]
+
+  bool rel_ind_unknown_;  ///< set iff the last rel_ind_check was unknown
                         ///< default is false and should be set in algorithms
                         ///< with approximate predecessor generalization
 
@@ -208,6 +321,18 @@ class IC3Base : public Prover
   ///< a vector of the given Unit template
   ///< which changes depending on the implementation
   std::vector<std::vector<IC3Formula>> frames_;
+  ///< the infinity frame: lemmas that are inductive relative to each
+  ///< other, asserted without a label and kept out of frames_
+  std::vector<IC3Formula> inf_frame_;
+
+  // used with options_.ic3_lemma_gc_period_
+  ///< lemma -> times it was learned or blocked a proof goal, halved at
+  ///< every collection
+  TermHashMap<size_t> lemma_activity_;
+  size_t num_collected_lemmas_;  ///< lemmas deleted so far
+
+  ///< ids of the literals of the lemmas, for the syntactic checks
+  LiteralTable lit_table_;
 
   ///< priority queue of outstanding proof goals
   // labels for activating assertions
@@ -215,7 +340,7 @@ class IC3Base : public Prover
   smt::Term trans_label_;      ///< label to activate trans
   smt::Term bad_label_;        ///< label to activate bad
   smt::TermVec frame_labels_;  ///< labels to activate frames
-  smt::UnorderedTermMap labels_;  //< labels for unsat cores
+  TermHashMap<smt::Term> labels_;  //< labels for unsat cores
 
   // useful terms
   smt::Term solver_true_;
@@ -265,11 +390,12 @@ class IC3Base : public Prover
   // virtual methods that can optionally be overridden
 
   /** Creates a disjunction IC3Formula from a vector of terms
-   *  @param c the children terms
+   *  @param c the children terms, by value so that callers on the hot
+   *         paths (e.g. get_model_ic3formula) can move them in
    *  @ensures resulting IC3Formula children == c
    *  @ensures resulting IC3Formula with is_disjunction true
    */
-  virtual IC3Formula ic3formula_disjunction(const smt::TermVec & c) const;
+  virtual IC3Formula ic3formula_disjunction(smt::TermVec c) const;
 
   /** Creates a conjunction IC3Formula from a vector of terms
    *  @param c the children terms
@@ -279,7 +405,7 @@ class IC3Base : public Prover
    *  note: assumes the children are already in the right polarity
    *  (doesn't negate them)
    */
-  virtual IC3Formula ic3formula_conjunction(const smt::TermVec & c) const;
+  virtual IC3Formula ic3formula_conjunction(smt::TermVec c) const;
 
   /** Negates an IC3Formula
    *  @param u the IC3Formula to negate
@@ -300,6 +426,64 @@ class IC3Base : public Prover
    */
   virtual IC3Formula inductive_generalization(size_t i, const IC3Formula & c);
 
+  /** Calls inductive_generalization and records the distributions of
+   *  the cube size before and after, the dropped literals, the calls to
+   *  the engine solver and the time in microseconds in the statistics
+   *  (the gen_* histograms)
+   */
+  IC3Formula record_inductive_generalization(size_t i, const IC3Formula & c);
+
+  /** The default inductive_generalization, drops literals one at a time
+   *  With options_.ic3_ctg_ a failed drop first tries to block the
+   *  counterexample to generalization (see ctg_down).
+   *  @param i the frame number to generalize it against
+   *  @param c the IC3Formula that should be blocked
+   *  @param depth the nesting level, 1 for a proof goal, higher for CTGs
+   *  @return a generalized IC3Formula (a disjunction)
+   */
+  IC3Formula generalize_cube(size_t i, const IC3Formula & c, size_t depth);
+
+  /** Picks the next literal generalize_cube tries to drop
+   *  (with options_.ic3_lit_order_): the one least likely to be needed.
+   *  That is the lowest literal_importance, then the lowest activity
+   *  (decayed count of the unsat cores containing it), then the newest.
+   *  @param lits the literals of the cube
+   *  @param necessary the literals that cannot be dropped
+   *  @return the index of the literal in lits, lits.size() if all the
+   *          literals are necessary
+   */
+  size_t next_literal_to_drop(const smt::TermVec & lits,
+                              const smt::UnorderedTermSet & necessary);
+
+  /** @return how important a literal is to keep in generalized cubes
+   *  higher values are tried last by generalize_cube with
+   *  options_.ic3_lit_order_, the default gives every literal 0
+   */
+  virtual size_t literal_importance(const smt::Term & lit) const
+  {
+    return 0;
+  }
+
+  /** Bumps the activity of the literals of an unsat core
+   *  @param lits the literals in the core
+   */
+  void bump_activity(const smt::TermVec & lits);
+
+  /** Tries to make cube inductive relative to F[i-1] without growing it
+   *  (the down procedure from "Better Generalization in IC3", Hassan,
+   *  Bradley and Somenzi, FMCAD 2013). A CTG is a predecessor of cube in
+   *  F[i-1]. Up to options_.ic3_ctg_max_ctgs_ CTGs in a row are blocked at
+   *  frame i-1 by generalizing them at depth + 1, as long as depth is at
+   *  most options_.ic3_ctg_max_depth_. Otherwise cube is reduced to the
+   *  literals it shares with the CTG.
+   *  @param i the frame number
+   *  @param cube the conjunction, set to the inductive subcube on success
+   *  @param depth the nesting level
+   *  @return true iff cube (updated) is inductive relative to F[i-1] and
+   *          does not intersect the initial states
+   */
+  bool ctg_down(size_t i, IC3Formula & cube, size_t depth);
+
   /** Generalize a counterexample
    *  @requires rel_ind_check(i, c)
    *  @requires the solver_ context is currently satisfiable
@@ -356,6 +540,15 @@ class IC3Base : public Prover
    */
   virtual bool reaches_bad(IC3Formula & out);
 
+  /** Find up to options_.ic3_bad_batch_ states in the frontier that can
+   *  reach bad in one step, each excluded from the next query (see
+   *  bad_exclusions_), so every query finds a new cube
+   *  @param out set to the cubes and their goal models, the more general
+   *         (fewer literals) first
+   *  @return true iff bad is reachable from a state in the frontier
+   */
+  bool reaches_bad_batch(std::vector<std::pair<IC3Formula, GoalModel>> & out);
+
   // ********************************** Common Methods
   // These methods are common to all flavors of IC3 currently implemented
 
@@ -392,6 +585,9 @@ class IC3Base : public Prover
    *                  predecessors if it's SAT. (in that case, SAT just means
    *                  we can't drop the literal we tried dropping)
    *  @return true iff c is inductive relative to frame i-1
+   *          if the query is unknown (e.g. it hit --query-time-limit),
+   *          returns false without a predecessor and sets
+   *          rel_ind_unknown_, i.e. c is treated as not blocked
    *  @ensures returns false  : out -> F[i-1] /\ \forall s in out . (s, c) \in
    * [T] returns true   : out unchanged, F[i-1] /\ T /\ c' is unsat
    */
@@ -400,6 +596,65 @@ class IC3Base : public Prover
                      IC3Formula & out,
                      bool get_pred = true);
 
+  /** rel_ind_check in the solver of frame i-1 instead of solver_
+   *  Only for queries that do not need a predecessor.
+   *  @requires options_.ic3_frame_solvers_
+   *  @return true iff c is inductive relative to frame i-1, then out
+   *          is set as in rel_ind_check (false if the query is unknown)
+   */
+  bool frame_solver_rel_ind_check(size_t i,
+                                  const IC3Formula & c,
+                                  IC3Formula & out);
+
+  /** Returns the solver of frame i, (re)building it if it does not exist
+   *  or the transition system changed since it was built (e.g. refined)
+   */
+  FrameSolver & frame_solver(size_t i);
+
+  /** Creates a new solver holding trans and F[i] */
+  std::unique_ptr<FrameSolver> make_frame_solver(size_t i);
+
+  /** Translate the check of c against the frame of fs into q
+   *  Uses solver_, so it must be called from the main thread.
+   *  @param fs the solver of frame i-1 for a check at frame i
+   *  @param c the conjunction to check
+   *  @param q the query to populate
+   */
+  void prepare_rel_ind_query(FrameSolver & fs,
+                             const IC3Formula & c,
+                             RelIndQuery & q);
+
+  /** Run a prepared query, sets q.res and on unsat q.core
+   *  Only uses s, so it can be called from any thread that
+   *  has exclusive access to s.
+   */
+  void run_rel_ind_query(const smt::SmtSolver & s, RelIndQuery & q);
+
+  /** Check queued proof goals concurrently before they are popped
+   *  Takes up to num_threads goals at different frames that were not tried
+   *  yet and checks them in the frame solvers. The goals that are blocked
+   *  are added to blocked with their unsat-core generalization. Frames only
+   *  get stronger, so those results stay valid until the goals are popped.
+   *  Goals that are not blocked are left to rel_ind_check, because the
+   *  predecessor needs a model of solver_.
+   */
+  void check_proof_goals_concurrently(
+      const ProofGoalQueue & proof_goals,
+      size_t num_threads,
+      std::unordered_set<const ProofGoal *> & tried,
+      std::unordered_map<const ProofGoal *, IC3Formula> & blocked);
+
+  /** Generalize c with an unsat core over the assumptions
+   *  @param c the conjunction that was checked
+   *  @param assumps the assumption for each child of c (same order)
+   *  @param core the unsat core
+   *  @return the conjunction of the children of c in the core,
+   *          which does not intersect the initial states
+   */
+  IC3Formula unsat_core_generalization(const IC3Formula & c,
+                                       const smt::TermVec & assumps,
+                                       const smt::UnorderedTermSet & core);
+
   // Helper methods
 
   /** Attempt to block all proof goals
@@ -410,6 +665,49 @@ class IC3Base : public Prover
    */
   bool block_all();
 
+  /** Import clauses from the lemma bus and add the ones that hold
+   *  initially to the highest frame they can be pushed to
+   */
+  void add_shared_lemmas();
+
+  /** Publish the lemmas of the frontier frame to the lemma bus
+   *  These are the lemmas that were propagated all the way.
+   */
+  void publish_frontier_lemmas();
+
+  /** Load the clauses of options_.ic3_lemma_cache_ (if any) and add the
+   *  largest subset that holds initially and is inductive to frame 1
+   *  The subset is found by batched queries that drop every clause
+   *  violated in the model until the query is unsat.
+   *  @requires reached_k_ == 1
+   */
+  void load_lemma_cache();
+
+  /** Save the lemmas of frames i and above to options_.ic3_lemma_cache_
+   *  (if set)
+   *  @param i the first frame to save
+   */
+  void save_lemma_cache(size_t i) const;
+
+  /** Saves the lemmas of frames 1 to the frontier */
+  bool save_checkpoint_state(Checkpoint & cp) const override;
+
+  /** Rebuilds the frames of a checkpoint, called in step_01 instead of
+   *  load_lemma_cache. Fails if a lemma is not valid for this flavor.
+   *  @requires reached_k_ == 1
+   */
+  bool restore_checkpoint_state(const Checkpoint & cp) override;
+
+  /** Also reports the number of lemmas in the frames and an estimate of
+   *  the memory of the frames and of the labels in bytes
+   */
+  void report_memory() override;
+
+  /** Also resets the solver (see reset_solver), which drops the clauses
+   *  learned by the solver but keeps the lemmas of the frames
+   */
+  void reduce_memory() override;
+
   /** Check if the given proof goal is already blocked
    *  @param pg the proof goal
    *  @return true iff the proof goal is already blocked
@@ -423,6 +721,41 @@ class IC3Base : public Prover
    */
   bool propagate(size_t i);
 
+  /** propagate(i) with the relative induction checks split over threads
+   *  Each thread checks a contiguous slice of F[i] in its own solver. The
+   *  results are merged in the order of F[i], so the outcome does not
+   *  depend on the scheduling of the threads.
+   *  @param i the frame index to propagate
+   *  @param num_threads the number of threads
+   *  @return true iff all the clauses are propagated
+   */
+  bool parallel_propagate(size_t i, size_t num_threads);
+
+  /** Move the largest subset of the frontier lemmas that is inductive
+   *  relative to itself (and the infinity frame) into the infinity frame
+   *  The subset is found by batched queries, as in load_lemma_cache.
+   *  The lemmas hold initially because they are in a frame.
+   *  @return the number of lemmas moved
+   */
+  size_t propagate_to_inf_frame();
+
+  /** Delete the lemmas below the frontier with no activity since the
+   *  previous collection, and halve the activity of the others
+   *  This is sound because the frames still over-approximate the
+   *  reachable states, but their lemmas may no longer be inductive
+   *  relative to the previous frame, so a fixpoint has to be checked
+   *  with is_inductive afterwards. The lemmas of the frontier and of the
+   *  infinity frame are never deleted. The solver is reset if a lemma
+   *  was deleted, so it no longer holds them.
+   *  @return the number of lemmas deleted
+   */
+  size_t collect_lemmas();
+
+  /** @return true iff t is inductive (unknown counts as not inductive)
+   *  @param t a term over current state variables
+   */
+  bool is_inductive(const smt::Term & t);
+
   /** Calls predecessor_generalization to generalize the current
    *  model (assumes the current context is satisfiable)
    *  Then if approx_pregen_ is true will do a solver call
@@ -474,10 +807,26 @@ class IC3Base : public Prover
    */
   void assert_frame_labels(size_t i) const;
 
+  /** Add the assumptions equivalent to assert_frame_labels(i) to out
+   *  for checking frame i without a solver context
+   */
+  void frame_label_assumptions(size_t i, smt::TermVec & out) const;
+
   smt::Term get_frame_term(size_t i) const;
 
   void assert_trans_label() const;
 
+  /** Partition ts_.trans() and define the labels of the partitions
+   *  Called when trans_label_ is defined, with options_.ic3_partition_trans_
+   */
+  void define_trans_partitions();
+
+  /** Add the labels of the part of trans needed for a relative induction
+   *  check of c without a predecessor: the global part and the partitions
+   *  defining the next-state variables of c
+   */
+  void trans_cone_labels(const IC3Formula & c, smt::TermVec & out) const;
+
   /** Check if there are common assignments
    *  between A and B
    *  i.e. if A /\ B is SAT
@@ -506,6 +855,17 @@ class IC3Base : public Prover
    */
   size_t find_highest_frame(size_t i, IC3Formula & u);
 
+  /** Queries the values of several terms in the current model
+   *  All the model queries of the IC3 engines go through here, so that
+   *  they are made in one batch over a prepared vector of terms.
+   *  smt-switch has no bulk query, so this is still one get_value per
+   *  term, but without any term construction in between.
+   *  @require solver_ state to be SAT
+   *  @param terms the terms to evaluate
+   *  @param out the values, in the same order (overwritten)
+   */
+  void get_values(const smt::TermVec & terms, smt::TermVec & out) const;
+
   /** Returns a vector of equalities between input variables
    *  and their values in the current model
    *  @require solver_ state to be SAT
@@ -529,7 +889,24 @@ class IC3Base : public Prover
    *  can reach bad in one step.
    *  thus this method always adds bad_ to the end of the vector
    */
-  void reconstruct_trace(const ProofGoal * pg, smt::TermVec & out);
+  void reconstruct_trace(const ProofGoal * pg,
+                         smt::TermVec & out,
+                         std::vector<GoalModel> * models = nullptr);
+
+  /** Records the current model in last_goal_model_ if goal_models_ is set
+   *  @require solver_ state to be SAT from the query that found a goal
+   */
+  void record_goal_model();
+
+  /** Builds witness_ from cex_models_ without an unrolled query
+   *  The models are used as they are while the next state of each one
+   *  is the state of the following one. Otherwise (or for the inputs
+   *  and named terms of the bad state) the step is replayed from the
+   *  reached state with a query over that single step.
+   *  @return false if a model is missing, or a step can't be replayed
+   *          (ts_ is not deterministic or the replay is unsat)
+   */
+  bool witness_from_goals();
 
   /** Creates a reduce and of the vector of boolean terms
    *  It also sorts the vector by the hash
@@ -561,13 +938,13 @@ class IC3Base : public Prover
   inline smt::Result check_sat()
   {
     num_check_sat_since_reset_++;
-    return solver_->check_sat();
+    return super::check_sat();
   }
 
   inline smt::Result check_sat_assuming(const smt::TermVec & assumps)
   {
     num_check_sat_since_reset_++;
-    return solver_->check_sat_assuming(assumps);
+    return super::check_sat_assuming(assumps);
   }
 
   /** Attempts to reset the solver and re-add constraints
@@ -576,6 +953,28 @@ class IC3Base : public Prover
    */
   virtual void reset_solver();
 
+  /** Re-defines init and trans under fresh labels, without resetting
+   *  the solver, after ts_ was modified in place. The definitions under
+   *  the old labels stay asserted but are never activated again (they
+   *  count as dead activation literals for the next reset).
+   *  Like reset_solver, this keeps the lemmas of frames_ and bad_label_.
+   */
+  void relabel_init_trans();
+
+  /** @return true iff the solver should be reset after a frame
+   *  With options_.ic3_reset_dead_ratio_ this is the case once that
+   *  percentage of the lemma assertions in solver_ no longer belong to a
+   *  lemma in frames_ (or are retired activation literals).
+   */
+  bool solver_reset_due() const;
+
+  /** Remove lemmas that are subsumed by a lemma in a higher frame
+   *  constrain_frame only removes lemmas in lower frames that the new
+   *  constraint subsumes.
+   *  @return the number of lemmas removed
+   */
+  size_t drop_subsumed_lemmas();
+
   inline size_t frontier_idx() const { return frames_.size() - 1; }
 
   /** Create a boolean label for a given term
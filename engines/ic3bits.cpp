@@ -16,6 +16,14 @@
 
 #include "engines/ic3bits.h"
 
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <queue>
+
+#include "utils/logger.h"
+#include "utils/solver_trace.h"
+
 using namespace smt;
 using namespace std;
 
@@ -25,8 +33,14 @@ IC3Bits::IC3Bits(const Property & p,
                  const TransitionSystem & ts,
                  const SmtSolver & s,
                  PonoOptions opt)
-    : super(p, ts, s, opt)
+    : super(p, ts, s, opt),
+      sat_init_lit_(0),
+      sat_bad_next_lit_(0),
+      sat_init_bad_lit_(0),
+      sat_cex_length_(0)
 {
+  // the trace is found on the bit-blasted system
+  goal_models_ = false;
 }
 
 void IC3Bits::initialize()
@@ -35,8 +49,47 @@ void IC3Bits::initialize()
     return;
   }
 
+  if (options_.ic3bits_sat_ && sat_initialize()) {
+    return;
+  }
+
   super::initialize();
+  init_state_bits();
+}
+
+ProverResult IC3Bits::check_until(int k)
+{
+  initialize();
+  if (!sat_) {
+    return super::check_until(k);
+  }
+
+  ProverResult res;
+  for (int i = reached_k_ + 1; i <= k; ++i) {
+    if (interrupted()) {
+      logger.log(1, "IC3Bits: interrupted at frame {}", i);
+      return ProverResult::UNKNOWN;
+    }
 
+    res = sat_step(i);
+    if (res != ProverResult::UNKNOWN) {
+      return res;
+    }
+  }
+
+  return ProverResult::UNKNOWN;
+}
+
+size_t IC3Bits::witness_length() const
+{
+  if (!sat_) {
+    return super::witness_length();
+  }
+  return sat_cex_length_;
+}
+
+void IC3Bits::init_state_bits()
+{
   Term bv1 = solver_->make_term(1, solver_->make_sort(BV, 1));
 
   assert(!state_bits_.size());
@@ -58,7 +111,8 @@ IC3Formula IC3Bits::get_model_ic3formula() const
 {
   // expecting all solving in IC3 to be done at context level > 0
   // so if we're getting a model we should not be at context 0
-  assert(solver_context_);
+  // (unless rel_ind_check uses assumptions instead)
+  assert(solver_context_ || options_.ic3_rel_ind_assumptions_);
 
   TermVec children;
   children.reserve(state_bits_.size());
@@ -70,7 +124,7 @@ IC3Formula IC3Bits::get_model_ic3formula() const
     }
   }
 
-  return ic3formula_conjunction(children);
+  return ic3formula_conjunction(std::move(children));
 }
 
 bool IC3Bits::ic3formula_check_valid(const IC3Formula & u) const
@@ -91,6 +145,458 @@ bool IC3Bits::ic3formula_check_valid(const IC3Formula & u) const
   return true;
 }
 
+void IC3Bits::init_bit_literals()
+{
+  // same order as in initialize
+  size_t idx = 0;
+  for (const auto & sv : ts_.statevars()) {
+    const Sort & sort = sv->get_sort();
+    size_t width = (sort == boolsort_) ? 1 : sort->get_width();
+    for (size_t i = 0; i < width; ++i) {
+      const Term & b = state_bits_.at(idx++);
+      bit_lits_[b] = { sv, i, true };
+      bit_lits_[solver_->make_term(Not, b)] = { sv, i, false };
+    }
+  }
+  assert(idx == state_bits_.size());
+}
+
+bool IC3Bits::sat_initialize()
+{
+  for (const auto & v : ts_.statevars()) {
+    if (!CnfEncoder::supported_sort(v->get_sort())) {
+      return false;
+    }
+  }
+  for (const auto & v : ts_.inputvars()) {
+    if (!CnfEncoder::supported_sort(v->get_sort())) {
+      return false;
+    }
+  }
+
+  boolsort_ = solver_->make_sort(BOOL);
+  solver_true_ = solver_->make_term(true);
+  init_state_bits();
+
+  SolverEnum se = solver_->get_solver_enum();
+  sat_ = create_sat_solver(se, options_.logging_smt_solver_);
+  sat_init_ = create_sat_solver(se, options_.logging_smt_solver_);
+  CnfEncoder enc(*sat_);
+  CnfEncoder init_enc(*sat_init_);
+
+  // the same literals for the current state in both solvers
+  size_t idx = 0;
+  for (const auto & sv : ts_.statevars()) {
+    SatLit l = sat_->new_var();
+    SatLit init_l = sat_init_->new_var();
+    assert(l == init_l);
+    sat_curr_.push_back(l);
+    enc.bind(sv, l);
+    init_enc.bind(sv, init_l);
+    ++idx;
+  }
+  for (const auto & sv : ts_.statevars()) {
+    sat_next_.push_back(sat_->new_var());
+    enc.bind(ts_.next(sv), sat_next_.back());
+  }
+  assert(idx == state_bits_.size());
+
+  try {
+    enc.add_term(ts_.trans());
+    sat_init_lit_ = enc.encode(ts_.init());
+    sat_bad_next_lit_ = enc.encode(ts_.next(bad_));
+    init_enc.add_term(ts_.init());
+    sat_init_bad_lit_ = init_enc.encode(bad_);
+  }
+  catch (PonoException & e) {
+    logger.log(1, "IC3Bits: not using the SAT-level mode, {}", e.what());
+    sat_.reset();
+    sat_init_.reset();
+    sat_curr_.clear();
+    sat_next_.clear();
+    state_bits_.clear();
+    return false;
+  }
+
+  Prover::initialize();
+  stats_->set("sat_vars", sat_->num_vars());
+  logger.log(1,
+             "IC3Bits: SAT-level mode with {} state bits and {} variables",
+             sat_curr_.size(),
+             sat_->num_vars());
+  return true;
+}
+
+ProverResult IC3Bits::sat_step(int i)
+{
+  if (i <= reached_k_) {
+    return ProverResult::UNKNOWN;
+  }
+
+  if (reached_k_ < 1) {
+    return sat_step_01();
+  }
+
+  assert(size_t(reached_k_) == sat_frontier_idx());
+  logger.log(1, "Blocking phase at frame {}", i);
+  while (true) {
+    sat_assumps_.clear();
+    sat_frame_assumptions(sat_frontier_idx(), sat_assumps_);
+    sat_assumps_.push_back(sat_bad_next_lit_);
+    Result r = sat_solve(*sat_, sat_assumps_);
+    if (r.is_unknown()) {
+      budget_.cancel("IC3Bits: query for bad states returned unknown");
+      return ProverResult::UNKNOWN;
+    } else if (r.is_unsat()) {
+      break;
+    }
+
+    if (!sat_block(sat_model_cube())) {
+      return interrupted() ? ProverResult::UNKNOWN : ProverResult::FALSE;
+    }
+  }
+
+  logger.log(1, "Propagation phase at frame {}", i);
+  sat_push_frame();
+  vector<vector<SatLit>> cubes;
+  vector<SatLit> core;
+  for (size_t j = 1; j < sat_frontier_idx(); ++j) {
+    cubes.clear();
+    cubes.swap(sat_frames_[j]);
+    for (auto & c : cubes) {
+      Result r = sat_rel_ind(j + 1, c, core);
+      if (r.is_unknown()) {
+        budget_.cancel("IC3Bits: propagation query returned unknown");
+        return ProverResult::UNKNOWN;
+      } else if (r.is_unsat()) {
+        sat_add_lemma(j + 1, std::move(c));
+      } else {
+        sat_frames_[j].push_back(std::move(c));
+      }
+    }
+
+    if (sat_frames_[j].empty()) {
+      invar_ = sat_frame_term(j + 1);
+      return ProverResult::TRUE;
+    }
+  }
+
+  ++reached_k_;
+
+  std::vector<size_t> lemmas_per_frame;
+  lemmas_per_frame.reserve(sat_frames_.size());
+  for (const auto & f : sat_frames_) {
+    lemmas_per_frame.push_back(f.size());
+  }
+  stats_->set("frames", sat_frames_.size());
+  stats_->set_list("lemmas_per_frame", lemmas_per_frame);
+
+  return ProverResult::UNKNOWN;
+}
+
+ProverResult IC3Bits::sat_step_01()
+{
+  assert(reached_k_ < 1);
+  if (reached_k_ < 0) {
+    logger.log(1, "Checking if initial states satisfy property");
+    Result r = sat_solve(*sat_init_, { sat_init_bad_lit_ });
+    if (r.is_sat()) {
+      sat_cex_length_ = 0;
+      return ProverResult::FALSE;
+    } else if (r.is_unknown()) {
+      budget_.cancel("IC3Bits: initial query returned unknown");
+      return ProverResult::UNKNOWN;
+    }
+    reached_k_ = 0;
+  }
+
+  assert(reached_k_ == 0);
+  logger.log(1, "Checking if property can be violated in one-step");
+  Result r = sat_solve(*sat_, { sat_init_lit_, sat_bad_next_lit_ });
+  if (r.is_sat()) {
+    sat_cex_length_ = 1;
+    return ProverResult::FALSE;
+  } else if (r.is_unknown()) {
+    budget_.cancel("IC3Bits: one-step query returned unknown");
+    return ProverResult::UNKNOWN;
+  }
+
+  // frame 0 is the initial states, activated by sat_init_lit_
+  assert(sat_frames_.empty());
+  sat_frames_.emplace_back();
+  sat_frame_acts_.push_back(sat_init_lit_);
+  sat_push_frame();
+  reached_k_ = 1;
+  return ProverResult::UNKNOWN;
+}
+
+Result IC3Bits::sat_solve(SatSolver & s, const vector<SatLit> & assumps)
+{
+  budget_.count_solver_call();
+  auto begin = chrono::steady_clock::now();
+  SolverCallTimer timer(TRACE_CHECK_SAT_ASSUMING, assumps.size());
+  Result r = s.solve(assumps);
+  timer.done(r);
+  stats_->add_time(
+      "sat_solve_time",
+      chrono::duration<double>(chrono::steady_clock::now() - begin).count());
+  stats_->increment("sat_solve_calls");
+  return r;
+}
+
+bool IC3Bits::sat_block(vector<SatLit> cube)
+{
+  auto cmp = [](const SatGoal * a, const SatGoal * b) {
+    return a->idx > b->idx;
+  };
+  // deque keeps the goals in place for the next pointers
+  std::deque<SatGoal> store;
+  std::priority_queue<const SatGoal *, vector<const SatGoal *>, decltype(cmp)>
+      goals(cmp);
+  store.push_back({ std::move(cube), sat_frontier_idx(), nullptr });
+  goals.push(&store.back());
+
+  vector<SatLit> out;
+  while (!goals.empty()) {
+    if (interrupted()) {
+      return false;
+    }
+
+    const SatGoal * g = goals.top();
+    if (sat_is_blocked(g->idx, g->cube)) {
+      goals.pop();
+      continue;
+    }
+
+    Result r = sat_rel_ind(g->idx, g->cube, out);
+    if (r.is_unknown()) {
+      budget_.cancel("IC3Bits: relative induction query returned unknown");
+      return false;
+    } else if (r.is_sat()) {
+      if (g->idx == 1 || sat_intersects_init(out)) {
+        if (interrupted()) {
+          return false;
+        }
+        // the predecessor is initial, one transition per goal
+        sat_cex_length_ = 1;
+        for (const SatGoal * p = g->next; p; p = p->next) {
+          ++sat_cex_length_;
+        }
+        ++sat_cex_length_;
+        return false;
+      }
+      store.push_back({ out, g->idx - 1, g });
+      goals.push(&store.back());
+      continue;
+    }
+
+    goals.pop();
+    vector<SatLit> c = g->cube;
+    sat_generalize(g->idx, c, out);
+
+    // push the lemma as far as it goes
+    size_t j = g->idx;
+    while (j < sat_frontier_idx()) {
+      r = sat_rel_ind(j + 1, c, out);
+      if (!r.is_unsat()) {
+        break;
+      }
+      ++j;
+    }
+    sat_add_lemma(j, c);
+    stats_->increment("lemmas");
+
+    if (j < sat_frontier_idx()) {
+      store.push_back({ g->cube, j + 1, g->next });
+      goals.push(&store.back());
+    }
+  }
+  return true;
+}
+
+Result IC3Bits::sat_rel_ind(size_t i,
+                            const vector<SatLit> & cube,
+                            vector<SatLit> & out)
+{
+  assert(i > 0);
+  assert(i < sat_frames_.size());
+  assert(cube.size());
+
+  // !cube as a temporary clause under a fresh activation literal
+  SatLit act = sat_->new_var();
+  out.clear();
+  out.push_back(-act);
+  for (const auto & l : cube) {
+    out.push_back(-l);
+  }
+  sat_->add_clause(out);
+
+  sat_assumps_.clear();
+  sat_assumps_.push_back(act);
+  sat_frame_assumptions(i - 1, sat_assumps_);
+  for (const auto & l : cube) {
+    sat_assumps_.push_back(sat_next(l));
+  }
+
+  Result r = sat_solve(*sat_, sat_assumps_);
+  if (r.is_sat()) {
+    out = sat_model_cube();
+  } else {
+    out.clear();
+    if (r.is_unsat()) {
+      for (const auto & l : cube) {
+        if (sat_->failed(sat_next(l))) {
+          out.push_back(l);
+        }
+      }
+    }
+  }
+
+  // retire the activation literal
+  sat_->add_clause({ -act });
+  return r;
+}
+
+bool IC3Bits::sat_intersects_init(const vector<SatLit> & cube)
+{
+  Result r = sat_solve(*sat_init_, cube);
+  if (r.is_unknown()) {
+    budget_.cancel("IC3Bits: initial states query returned unknown");
+  }
+  return !r.is_unsat();
+}
+
+void IC3Bits::sat_generalize(size_t i,
+                             vector<SatLit> & cube,
+                             const vector<SatLit> & core)
+{
+  // the core without init might intersect the initial states,
+  // add back literals of the cube until it doesn't
+  vector<SatLit> reduced = core;
+  for (const auto & l : cube) {
+    if (reduced.size() && !sat_intersects_init(reduced)) {
+      break;
+    }
+    if (std::find(reduced.begin(), reduced.end(), l) == reduced.end()) {
+      reduced.push_back(l);
+    }
+  }
+  std::sort(reduced.begin(), reduced.end());
+  if (reduced.size() && !sat_intersects_init(reduced)) {
+    cube.swap(reduced);
+  }
+
+  // then try to drop each remaining literal
+  vector<SatLit> cand, out;
+  size_t k = 0;
+  while (k < cube.size() && cube.size() > 1 && !interrupted()) {
+    cand = cube;
+    cand.erase(cand.begin() + k);
+    if (!sat_intersects_init(cand) && sat_rel_ind(i, cand, out).is_unsat()) {
+      // the core is only used if it keeps out of the initial states
+      std::sort(out.begin(), out.end());
+      if (out.size() && !sat_intersects_init(out)) {
+        cand.swap(out);
+      }
+      cube.swap(cand);
+      k = 0;
+    } else {
+      ++k;
+    }
+  }
+}
+
+void IC3Bits::sat_add_lemma(size_t i, vector<SatLit> cube)
+{
+  assert(i > 0);
+  assert(i < sat_frames_.size());
+  assert(std::is_sorted(cube.begin(), cube.end()));
+
+  // drop lemmas that are subsumed in this frame and the lower ones
+  for (size_t j = 1; j <= i; ++j) {
+    auto & f = sat_frames_[j];
+    f.erase(std::remove_if(f.begin(),
+                           f.end(),
+                           [&cube](const vector<SatLit> & c) {
+                             return std::includes(
+                                 c.begin(), c.end(), cube.begin(), cube.end());
+                           }),
+            f.end());
+  }
+
+  vector<SatLit> clause;
+  clause.reserve(cube.size() + 1);
+  clause.push_back(-sat_frame_acts_[i]);
+  for (const auto & l : cube) {
+    clause.push_back(-l);
+  }
+  sat_->add_clause(clause);
+  sat_frames_[i].push_back(std::move(cube));
+}
+
+bool IC3Bits::sat_is_blocked(size_t i, const vector<SatLit> & cube) const
+{
+  for (size_t j = i; j < sat_frames_.size(); ++j) {
+    for (const auto & c : sat_frames_[j]) {
+      if (std::includes(cube.begin(), cube.end(), c.begin(), c.end())) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void IC3Bits::sat_push_frame()
+{
+  sat_frames_.emplace_back();
+  sat_frame_acts_.push_back(sat_->new_var());
+}
+
+void IC3Bits::sat_frame_assumptions(size_t i, vector<SatLit> & out) const
+{
+  if (i == 0) {
+    out.push_back(sat_init_lit_);
+    return;
+  }
+  // a lemma at frame j holds in all frames up to j
+  for (size_t j = i; j < sat_frame_acts_.size(); ++j) {
+    out.push_back(sat_frame_acts_[j]);
+  }
+}
+
+vector<SatLit> IC3Bits::sat_model_cube()
+{
+  vector<SatLit> cube;
+  cube.reserve(sat_curr_.size());
+  for (const auto & l : sat_curr_) {
+    cube.push_back(sat_->value(l) ? l : -l);
+  }
+  std::sort(cube.begin(), cube.end());
+  return cube;
+}
+
+Term IC3Bits::sat_frame_term(size_t i) const
+{
+  TermVec clauses;
+  TermVec children;
+  for (size_t j = i; j < sat_frames_.size(); ++j) {
+    for (const auto & c : sat_frames_[j]) {
+      children.clear();
+      for (const auto & l : c) {
+        const Term & b = state_bits_.at(sat_bit(l));
+        children.push_back(l > 0 ? solver_->make_term(Not, b) : b);
+      }
+      clauses.push_back(children.size() > 1
+                            ? solver_->make_term(Or, children)
+                            : children[0]);
+    }
+  }
+  if (clauses.empty()) {
+    return solver_true_;
+  }
+  return clauses.size() > 1 ? solver_->make_term(And, clauses) : clauses[0];
+}
+
 void IC3Bits::check_ts() const
 {
   for (const auto & sv : ts_.statevars()) {
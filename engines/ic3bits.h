@@ -12,11 +12,22 @@
 ** \brief Bit-level IC3 implementation that splits bitvector variables
 **        into the individual bits for bit-level cubes/clauses
 **        However, the transition system itself still uses bitvectors
+**
+**        With --ic3bits-sat, a purely Boolean system (booleans and
+**        bit-vectors of width 1) is instead encoded to CNF once and
+**        checked by a separate IC3 loop over integer literal cubes
+**        on a SatSolver, without creating terms per query.
 **/
 
 #pragma once
 
+#include <cassert>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
 #include "engines/ic3.h"
+#include "smt/sat_solver.h"
 
 namespace pono {
 
@@ -36,10 +47,113 @@ class IC3Bits : public IC3
 
   void initialize() override;
 
+  ProverResult check_until(int k) override;
+
+  size_t witness_length() const override;
+
  protected:
   smt::TermVec state_bits_;  ///< boolean variables + bit-vector variables
                              ///< split into individual bits
 
+  /** Populates state_bits_ in the order of ts_.statevars() */
+  void init_state_bits();
+
+  // SAT-level mode (--ic3bits-sat)
+  // cubes are vectors of literals over sat_curr_, sorted by value
+
+  struct SatGoal
+  {
+    std::vector<SatLit> cube;
+    size_t idx;
+    const SatGoal * next;
+  };
+
+  /** Encodes the system into sat_ and sat_init_
+   *  @return false if it is not purely Boolean, leaving the solvers unset
+   */
+  bool sat_initialize();
+
+  ProverResult sat_step(int i);
+
+  ProverResult sat_step_01();
+
+  /** Calls solve on s, counts the call against the budget
+   *  and records the number of calls and the time in the statistics
+   */
+  smt::Result sat_solve(SatSolver & s, const std::vector<SatLit> & assumps);
+
+  /** Recursively block a cube that reaches bad from the frontier
+   *  @return false on a counterexample (sets sat_cex_length_)
+   *          or if interrupted
+   */
+  bool sat_block(std::vector<SatLit> cube);
+
+  /** Check F[i-1] /\ !cube /\ T /\ cube'
+   *  @param out the predecessor if sat, the literals of cube in the unsat
+   *         core if unsat
+   */
+  smt::Result sat_rel_ind(size_t i,
+                          const std::vector<SatLit> & cube,
+                          std::vector<SatLit> & out);
+
+  /** @return true iff cube intersects the initial states
+   *          (or the query was unknown, which also cancels the budget)
+   */
+  bool sat_intersects_init(const std::vector<SatLit> & cube);
+
+  /** Drop literals of a cube that is inductive relative to F[i-1]
+   *  @param core the literals of cube in the unsat core of sat_rel_ind
+   */
+  void sat_generalize(size_t i,
+                      std::vector<SatLit> & cube,
+                      const std::vector<SatLit> & core);
+
+  /** Block cube at frame i and all lower frames */
+  void sat_add_lemma(size_t i, std::vector<SatLit> cube);
+
+  /** @return true iff a lemma at frame i or above subsumes cube */
+  bool sat_is_blocked(size_t i, const std::vector<SatLit> & cube) const;
+
+  void sat_push_frame();
+
+  /** Assumptions for F[i], the initial states for i = 0 */
+  void sat_frame_assumptions(size_t i, std::vector<SatLit> & out) const;
+
+  /** @return the current state cube of the last model of sat_ */
+  std::vector<SatLit> sat_model_cube();
+
+  /** @return the term of F[i] over state_bits_ */
+  smt::Term sat_frame_term(size_t i) const;
+
+  size_t sat_bit(SatLit l) const
+  {
+    assert(size_t(abs(l) - abs(sat_curr_.at(0))) < sat_curr_.size());
+    return abs(l) - abs(sat_curr_[0]);
+  }
+
+  SatLit sat_next(SatLit l) const
+  {
+    SatLit n = sat_next_[sat_bit(l)];
+    return l > 0 ? n : -n;
+  }
+
+  inline size_t sat_frontier_idx() const { return sat_frames_.size() - 1; }
+
+  std::unique_ptr<SatSolver> sat_;  ///< trans, init, bad and the frames
+                                    ///< (null if not in SAT-level mode)
+  std::unique_ptr<SatSolver> sat_init_;  ///< only init, same state literals
+  std::vector<SatLit> sat_curr_;  ///< literal of each state bit
+  std::vector<SatLit> sat_next_;  ///< literal of each next state bit
+  SatLit sat_init_lit_;           ///< init in sat_
+  SatLit sat_bad_next_lit_;       ///< next state bad in sat_
+  SatLit sat_init_bad_lit_;       ///< bad in sat_init_
+
+  ///< cubes blocked at each frame and not at a higher one
+  std::vector<std::vector<std::vector<SatLit>>> sat_frames_;
+  std::vector<SatLit> sat_frame_acts_;  ///< activates each frame > 0
+  std::vector<SatLit> sat_assumps_;     ///< used for storing assumptions
+  size_t sat_cex_length_;
+
   // virtual method overrides
 
   IC3Formula get_model_ic3formula() const override;
@@ -47,6 +161,8 @@ class IC3Bits : public IC3
   bool ic3formula_check_valid(const IC3Formula & u) const override;
 
   void check_ts() const override;
+
+  void init_bit_literals() override;
 };
 
 }  // namespace pono
@@ -30,16 +30,21 @@
 #include "engines/ic3ia.h"
 
 #include <random>
+#include <thread>
 
 #include "smt/available_solvers.h"
+#include "utils/lemma_cache.h"
 #include "utils/logger.h"
 #include "utils/term_analysis.h"
+#include "utils/timeline.h"
 
 using namespace smt;
 using namespace std;
 
 namespace pono {
 
+static const LogComponent ic3ia_log = Log::component("ic3ia");
+
 IC3IA::IC3IA(const Property & p,
              const TransitionSystem & ts,
              const SmtSolver & s,
@@ -52,6 +57,7 @@ IC3IA::IC3IA(const Property & p,
           SolverEnum::MSAT_INTERPOLATOR, Engine::IC3IA_ENGINE)),
       to_interpolator_(interpolator_),
       to_solver_(solver_),
+      pred_collector_(solver_, false, false, true),
       longest_cex_length_(0)
 {
   // since we passed a fresh RelationalTransitionSystem as the main TS
@@ -59,6 +65,12 @@ IC3IA::IC3IA(const Property & p,
   orig_ts_ = ts;
   engine_ = Engine::IC3IA_ENGINE;
   approx_pregen_ = true;
+  // the goals are over the abstract system
+  goal_models_ = false;
+  ia_.set_core_min_time(options_.cegar_core_min_time_);
+  if (options_.reducer_query_time_limit_) {
+    ia_.set_reducer_query_time_limit(options_.reducer_query_time_limit_);
+  }
 }
 
 void IC3IA::add_important_var(Term v)
@@ -72,7 +84,7 @@ void IC3IA::add_important_var(Term v)
   if (solver_ != orig_ts_.solver()) {
     v = to_prover_solver_.transfer_term(v);
   }
-  logger.log(1, "Adding important variable: {}", v);
+  logger.log(ic3ia_log, 1, "Adding important variable: {}", v);
   ia_.add_important_var(v);
 }
 
@@ -80,19 +92,18 @@ void IC3IA::add_important_var(Term v)
 
 IC3Formula IC3IA::get_model_ic3formula() const
 {
+  TermVec vals;
+  get_values(predlbls_, vals);
+
   TermVec conjuncts;
   conjuncts.reserve(predlbls_.size());
-  Term val;
-  for (const auto & p : predlbls_) {
-    if ((val = solver_->get_value(p)) == solver_true_) {
-      conjuncts.push_back(lbl2pred_.at(p));
-    } else {
-      conjuncts.push_back(solver_->make_term(Not, lbl2pred_.at(p)));
-    }
-    assert(val->is_value());
+  for (size_t i = 0; i < predlbls_.size(); ++i) {
+    assert(vals[i]->is_value());
+    conjuncts.push_back(vals[i] == solver_true_ ? predvec_[i]
+                                                : negpredvec_[i]);
   }
 
-  return ic3formula_conjunction(conjuncts);
+  return ic3formula_conjunction(std::move(conjuncts));
 }
 
 bool IC3IA::ic3formula_check_valid(const IC3Formula & u) const
@@ -102,7 +113,10 @@ bool IC3IA::ic3formula_check_valid(const IC3Formula & u) const
   Op op;
   for (const auto &c : u.children) {
     if (c->get_sort() != boolsort_) {
-      logger.log(3, "ERROR IC3IA IC3Formula contains non-boolean atom: {}", c);
+      logger.log(ic3ia_log,
+                 3,
+                 "ERROR IC3IA IC3Formula contains non-boolean atom: {}",
+                 c);
       return false;
     }
 
@@ -115,7 +129,10 @@ bool IC3IA::ic3formula_check_valid(const IC3Formula & u) const
 
     // expecting either a boolean variable or a predicate
     if (predset_.find(pred) == predset_.end()) {
-      logger.log(3, "ERROR IC3IA IC3Formula contains unknown atom: {}", pred);
+      logger.log(ic3ia_log,
+                 3,
+                 "ERROR IC3IA IC3Formula contains unknown atom: {}",
+                 pred);
       return false;
     }
   }
@@ -139,20 +156,38 @@ void IC3IA::initialize()
   }
 
   super::initialize();
+  asserted_bad_ = bad_;
 
   // add all the predicates from init and property to the abstraction
   // NOTE: abstract is called automatically in IC3Base initialize
   UnorderedTermSet preds;
-  get_predicates(solver_, conc_ts_.init(), preds, false, false, true);
+  pred_collector_.get_predicates(conc_ts_.init(), preds);
   size_t num_init_preds = preds.size();
-  get_predicates(solver_, bad_, preds, false, false, true);
+  pred_collector_.get_predicates(bad_, preds);
   size_t num_prop_preds = preds.size() - num_init_preds;
   for (const auto &p : preds) {
     add_predicate(p);
   }
-  logger.log(1, "Number predicates found in init: {}", num_init_preds);
-  logger.log(1, "Number predicates found in prop: {}", num_prop_preds);
-  logger.log(1, "Total number of initial predicates: {}", preds.size());
+  logger.log(ic3ia_log,
+             1,
+             "Number predicates found in init: {}",
+             num_init_preds);
+  logger.log(ic3ia_log,
+             1,
+             "Number predicates found in prop: {}",
+             num_prop_preds);
+  logger.log(ic3ia_log,
+             1,
+             "Total number of initial predicates: {}",
+             preds.size());
+  size_t num_cached_preds = load_predicate_cache();
+  if (num_cached_preds) {
+    logger.log(ic3ia_log,
+               1,
+               "Number predicates loaded from cache: {}",
+               num_cached_preds);
+  }
+  initial_preds_ = predset_;
   // more predicates will be added during refinement
   // these ones are just initial predicates
 
@@ -191,13 +226,21 @@ void IC3IA::initialize()
   //      behaves a bit differently with both concrete and abstract next state
   //      vars
   if (options_.ic3_pregen_) {
-    logger.log(1,
+    logger.log(ic3ia_log, 1,
                "WARNING automatically disabling predecessor generalization -- "
                "not supported in IC3IA yet.");
     options_.ic3_pregen_ = false;
   }
 }
 
+ProverResult IC3IA::check_until(int k)
+{
+  ProverResult res = super::check_until(k);
+  save_predicate_cache();
+  stats_->set("ic3ia_shadow_vars", ia_.num_shadow_vars());
+  return res;
+}
+
 void IC3IA::abstract()
 {
   const UnorderedTermSet &bool_symbols = ia_.do_abstraction();
@@ -229,6 +272,7 @@ void IC3IA::abstract()
 
 RefineResult IC3IA::refine()
 {
+  TIMELINE_SPAN("ic3ia_refine");
   // counterexample trace should have been populated
   assert(cex_.size());
   if (cex_.size() == 1) {
@@ -247,16 +291,42 @@ RefineResult IC3IA::refine()
     // make sure to_solver_ cache is populated with unrolled symbols
     register_symbol_mappings(i);
 
-    Term t = unroller_.at_time(cex_[i], i);
+    // unroll the step and trans together, they share subterms
+    TermVec step = { cex_[i] };
     if (i + 1 < cex_length) {
-      t = solver_->make_term(And, t, unroller_.at_time(conc_ts_.trans(), i));
+      step.push_back(conc_ts_.trans());
+    }
+    step = unroller_.at_time(step, i);
+    Term t = step[0];
+    if (step.size() > 1) {
+      t = solver_->make_term(And, t, step[1]);
     }
     formulae.push_back(to_interpolator_.transfer_term(t, BOOL));
   }
 
   TermVec out_interpolants;
-  Result r =
-      interpolator_->get_sequence_interpolants(formulae, out_interpolants);
+  Result r(UNKNOWN);
+  TermVec core_preds;
+  bool core_refined = false;
+  if (options_.ic3ia_refine_portfolio_) {
+    // interpolation runs in its own thread while this thread (the only one
+    // using solver_) looks for predicates with unsat cores
+    thread itp([&]() {
+      try {
+        r = interpolator_->get_sequence_interpolants(formulae,
+                                                     out_interpolants);
+      }
+      catch (SmtException & e) {
+        logger.log(ic3ia_log, 1, "IC3IA: interpolation failed: {}", e.what());
+        r = Result(UNKNOWN);
+        out_interpolants.clear();
+      }
+    });
+    core_refined = core_predicates(core_preds);
+    itp.join();
+  } else {
+    r = interpolator_->get_sequence_interpolants(formulae, out_interpolants);
+  }
 
   if (r.is_sat()) {
     // this is a real counterexample, so the property is false
@@ -279,8 +349,8 @@ RefineResult IC3IA::refine()
 
     Term solver_I = unroller_.untime(to_solver_.transfer_term(I, BOOL));
     assert(conc_ts_.only_curr(solver_I));
-    logger.log(3, "got interpolant: {}", solver_I);
-    get_predicates(solver_, solver_I, preds, false, false, true);
+    logger.log(ic3ia_log, 3, "got interpolant: {}", solver_I);
+    pred_collector_.get_predicates(solver_I, preds);
   }
 
   // new predicates
@@ -292,8 +362,52 @@ RefineResult IC3IA::refine()
     }
   }
 
+  if (!fresh_preds.size() && unloaded_pred_rels_.size()) {
+    // the abstract counterexample can be spurious because of relations
+    // that were not loaded yet, first load the ones of the predicates
+    // from the interpolants, otherwise all of them
+    size_t n = 0;
+    for (const auto & p : preds) {
+      n += load_predicate_relation(p);
+    }
+    if (!n) {
+      n = load_all_predicate_relations();
+    }
+    logger.log(ic3ia_log,
+               1,
+               "IC3IA: refinement loaded {} predicate relations",
+               n);
+    stats_->increment("ic3ia_loaded_pred_rels", n);
+    longest_cex_length_ = cex_length;
+    return RefineResult::REFINE_SUCCESS;
+  }
+
+  if (!fresh_preds.size() && !options_.ic3ia_refine_portfolio_) {
+    // fall back on the cheap unsat-core-based discovery
+    core_refined = core_predicates(core_preds);
+  }
+
+  if (core_refined
+      && (!fresh_preds.size() || core_preds.size() < fresh_preds.size())) {
+    // already reduced by core_predicates
+    logger.log(ic3ia_log, 1,
+               "IC3IA: using {} predicates from unsat cores instead of {} "
+               "from interpolants",
+               core_preds.size(),
+               fresh_preds.size());
+    stats_->increment("ic3ia_core_refinements");
+    for (auto const & p : core_preds) {
+      bool new_pred = add_predicate(p);
+      assert(new_pred);
+    }
+    longest_cex_length_ = cex_length;
+    return RefineResult::REFINE_SUCCESS;
+  }
+
   if (!fresh_preds.size()) {
-    logger.log(1, "IC3IA: refinement failed couldn't find any new predicates");
+    logger.log(ic3ia_log,
+               1,
+               "IC3IA: refinement failed couldn't find any new predicates");
     return RefineResult::REFINE_FAIL;
   }
 
@@ -308,7 +422,7 @@ RefineResult IC3IA::refine()
   if (options_.ic3ia_reduce_preds_
       && ia_.reduce_predicates(cex_, fresh_preds, red_preds)) {
     // reduction successful
-    logger.log(2,
+    logger.log(ic3ia_log, 2,
                "reduce predicates successful {}/{}",
                red_preds.size(),
                fresh_preds.size());
@@ -323,7 +437,7 @@ RefineResult IC3IA::refine()
     // but IC3 (which doesn't unroll) still needs the predicates
     // in this case, just use all the fresh predicates
     assert(!options_.ic3ia_reduce_preds_ || red_preds.size() == 0);
-    logger.log(2, "reduce predicates FAILED");
+    logger.log(ic3ia_log, 2, "reduce predicates FAILED");
   }
 
   // add all the new predicates
@@ -334,15 +448,68 @@ RefineResult IC3IA::refine()
     assert(new_pred);
   }
 
-  logger.log(1, "{} new predicates added by refinement", fresh_preds.size());
+  logger.log(ic3ia_log,
+             1,
+             "{} new predicates added by refinement",
+             fresh_preds.size());
 
   // able to refine the system to rule out this abstract counterexample
   return RefineResult::REFINE_SUCCESS;
 }
 
+bool IC3IA::core_predicates(TermVec & out)
+{
+  if (candidate_atoms_trans_ != conc_ts_.trans()) {
+    candidate_atoms_trans_ = conc_ts_.trans();
+    UnorderedTermSet atoms;
+    pred_collector_.get_predicates(conc_ts_.init(), atoms);
+    pred_collector_.get_predicates(conc_ts_.trans(), atoms);
+    pred_collector_.get_predicates(bad_, atoms);
+
+    UnorderedTermSet curr_atoms;
+    UnorderedTermSet free_vars;
+    for (const auto & a : atoms) {
+      if (conc_ts_.only_curr(a)) {
+        curr_atoms.insert(a);
+        continue;
+      }
+      // an atom over next state variables only is a predicate of the
+      // next state
+      free_vars.clear();
+      get_free_symbolic_consts(a, free_vars);
+      bool all_next = true;
+      for (const auto & v : free_vars) {
+        all_next &= conc_ts_.is_next_var(v);
+      }
+      if (all_next) {
+        curr_atoms.insert(conc_ts_.curr(a));
+      }
+    }
+    candidate_atoms_.assign(curr_atoms.begin(), curr_atoms.end());
+  }
+
+  TermVec candidates;
+  for (const auto & a : candidate_atoms_) {
+    if (predset_.find(a) == predset_.end()) {
+      candidates.push_back(a);
+    }
+  }
+  if (candidates.empty()) {
+    return false;
+  }
+
+  TermVec red;
+  if (!ia_.reduce_predicates(cex_, candidates, red)) {
+    return false;
+  }
+  out.insert(out.end(), red.begin(), red.end());
+  return true;
+}
+
 void IC3IA::reset_solver()
 {
   super::reset_solver();
+  asserted_bad_ = bad_;
 
   for (const auto & elem : lbl2pred_) {
     solver_->assert_formula(solver_->make_term(Equal, elem.first, elem.second));
@@ -360,6 +527,31 @@ bool IC3IA::is_global_label(const Term & l) const
   return true;
 }
 
+size_t IC3IA::literal_importance(const Term & lit) const
+{
+  const UnorderedTermSet & important_vars = ia_.important_vars();
+  if (important_vars.empty()) {
+    return 0;
+  }
+
+  auto it = lit_importance_.find(lit);
+  if (it != lit_importance_.end()) {
+    return it->second;
+  }
+
+  UnorderedTermSet free_vars;
+  get_free_symbolic_consts(lit, free_vars);
+  size_t importance = 0;
+  for (const auto & v : free_vars) {
+    if (important_vars.find(v) != important_vars.end()) {
+      importance = 1;
+      break;
+    }
+  }
+  lit_importance_[lit] = importance;
+  return importance;
+}
+
 void IC3IA::reabstract()
 {
   // don't add boolean symbols that are never used in the system
@@ -384,19 +576,31 @@ void IC3IA::reabstract()
   }
 
   // predicates from init and bad
-  get_predicates(solver_, ts_.init(), preds, false, false, true);
-  get_predicates(solver_, bad_, preds, false, false, true);
+  pred_collector_.get_predicates(ts_.init(), preds);
+  pred_collector_.get_predicates(bad_, preds);
   // instead of add previously found predicates, we add all the predicates in frame 1
-  get_predicates(solver_, get_frame_term(1), preds, false, false, true);
+  pred_collector_.get_predicates(get_frame_term(1), preds);
 
-  super::reset_solver();
-  if (failed_to_reset_solver_) {
-    throw PonoException("IC3IA::reabstract Cannot reabstract because "
-                        "the underlying SMT solver doesn't support "
-                        "the reset-solver method");
+  if (bad_ == asserted_bad_) {
+    // incremental update: the old init, trans and predicate constraints
+    // are retired with their labels, the predicate labels stay defined
+    super::relabel_init_trans();
+  } else {
+    // bad_ is part of the frames, they need to be asserted again
+    super::reset_solver();
+    if (failed_to_reset_solver_) {
+      throw PonoException("IC3IA::reabstract Cannot reabstract because "
+                          "the underlying SMT solver doesn't support "
+                          "the reset-solver method");
+    }
+    asserted_bad_ = bad_;
+    defined_lbls_.clear();
   }
   predset_.clear();
   predlbls_.clear();
+  predvec_.clear();
+  negpredvec_.clear();
+  unloaded_pred_rels_.clear();
 
   // add predicates
   for (const auto &p : preds) {
@@ -412,7 +616,7 @@ bool IC3IA::add_predicate(const Term & pred)
   }
 
   assert(ts_.only_curr(pred));
-  logger.log(2, "adding predicate {}", pred);
+  logger.log(ic3ia_log, 2, "adding predicate {}", pred);
   predset_.insert(pred);
   assert(pred->get_sort() == boolsort_);
   assert(pred->is_symbolic_const() || is_predicate(pred, boolsort_));
@@ -420,9 +624,12 @@ bool IC3IA::add_predicate(const Term & pred)
   Term lbl = label(pred);
   // set the negated label as well
   // can use in either polarity because we add a bi-implication
-  labels_[solver_->make_term(Not, pred)] = solver_->make_term(Not, lbl);
+  Term npred_cur = solver_->make_term(Not, pred);
+  labels_[npred_cur] = solver_->make_term(Not, lbl);
 
-  predlbls_.insert(lbl);
+  predlbls_.push_back(lbl);
+  predvec_.push_back(pred);
+  negpredvec_.push_back(npred_cur);
   lbl2pred_[lbl] = pred;
 
   Term npred = ts_.next(pred);
@@ -432,20 +639,20 @@ bool IC3IA::add_predicate(const Term & pred)
   if (!pred->is_symbolic_const()) {
     // only need to assert equalities for labels that are distinct
     assert(lbl != pred);
-    solver_->assert_formula(solver_->make_term(Equal, lbl, pred));
-    solver_->assert_formula(solver_->make_term(Equal, nlbl, npred));
+    if (defined_lbls_.insert(lbl).second) {
+      // (still defined if the predicate was retired by a reabstraction)
+      solver_->assert_formula(solver_->make_term(Equal, lbl, pred));
+      solver_->assert_formula(solver_->make_term(Equal, nlbl, npred));
+    }
 
     // only need to modify transition relation for non constants
     // boolean constants will be precise
 
     // add predicate to abstraction and get the new constraint
-    Term predabs_rel = ia_.predicate_refinement(pred);
-    static_cast<RelationalTransitionSystem &>(ts_).constrain_trans(predabs_rel);
-    // refine the transition relation incrementally
-    // by adding a new constraint
-    assert(!solver_context_);  // should be at context 0
-    solver_->assert_formula(
-        solver_->make_term(Implies, trans_label_, predabs_rel));
+    unloaded_pred_rels_[pred] = ia_.predicate_refinement(pred);
+    if (!options_.ic3ia_lazy_pred_rels_) {
+      load_predicate_relation(pred);
+    }
   }
 
   // keep track of the labels and different polarities for debugging assertions
@@ -457,6 +664,58 @@ bool IC3IA::add_predicate(const Term & pred)
   return true;
 }
 
+bool IC3IA::load_predicate_relation(const Term & pred)
+{
+  Term p = pred;
+  if (p->get_op() == Not) {
+    p = *(p->begin());
+  }
+  auto it = unloaded_pred_rels_.find(p);
+  if (it == unloaded_pred_rels_.end()) {
+    return false;
+  }
+
+  Term predabs_rel = it->second;
+  unloaded_pred_rels_.erase(it);
+  static_cast<RelationalTransitionSystem &>(ts_).constrain_trans(predabs_rel);
+  // refine the transition relation incrementally
+  // by adding a new constraint
+  assert(!solver_context_);  // should be at context 0
+  solver_->assert_formula(
+      solver_->make_term(Implies, trans_label_, predabs_rel));
+  return true;
+}
+
+size_t IC3IA::load_all_predicate_relations()
+{
+  TermVec preds;
+  for (const auto & elem : unloaded_pred_rels_) {
+    preds.push_back(elem.first);
+  }
+  for (const auto & p : preds) {
+    load_predicate_relation(p);
+  }
+  return preds.size();
+}
+
+IC3Formula IC3IA::inductive_generalization(size_t i, const IC3Formula & c)
+{
+  IC3Formula gen = super::inductive_generalization(i, c);
+  if (options_.ic3ia_lazy_pred_rels_) {
+    // the lemma was checked without the relations of unloaded predicates
+    // (a weaker transition relation), so it stays valid once they are
+    // loaded
+    size_t n = 0;
+    for (const auto & l : gen.children) {
+      n += load_predicate_relation(l);
+    }
+    if (n) {
+      stats_->increment("ic3ia_loaded_pred_rels", n);
+    }
+  }
+  return gen;
+}
+
 void IC3IA::register_symbol_mappings(size_t i)
 {
   if (i < longest_cex_length_) {
@@ -471,4 +730,50 @@ void IC3IA::register_symbol_mappings(size_t i)
   }
 }
 
+size_t IC3IA::load_predicate_cache()
+{
+  if (options_.ic3ia_pred_cache_.empty()) {
+    return 0;
+  }
+
+  TermVec cached;
+  if (!read_predicate_cache(options_.ic3ia_pred_cache_, ts_, cached)) {
+    return 0;
+  }
+  size_t num_added = 0;
+  for (const auto & p : cached) {
+    // e.g. a boolean state variable, which is a predicate anyway
+    if (p->is_symbolic_const() || !is_predicate(p, boolsort_)) {
+      continue;
+    }
+    num_added += add_predicate(p);
+  }
+  stats_->set("ic3ia_cached_preds", cached.size());
+  stats_->set("ic3ia_reused_preds", num_added);
+  return num_added;
+}
+
+void IC3IA::save_predicate_cache()
+{
+  if (options_.ic3ia_pred_cache_.empty()) {
+    return;
+  }
+
+  TermVec learned;
+  for (const auto & p : predvec_) {
+    if (!p->is_symbolic_const()
+        && initial_preds_.find(p) == initial_preds_.end()) {
+      learned.push_back(p);
+    }
+  }
+  size_t n = write_predicate_cache(options_.ic3ia_pred_cache_, ts_, learned);
+  // saved once, a later call only appends the newer ones
+  initial_preds_.insert(learned.begin(), learned.end());
+  logger.log(ic3ia_log,
+             1,
+             "IC3IA: saved {} predicates to {}",
+             n,
+             options_.ic3ia_pred_cache_);
+}
+
 }  // namespace pono
@@ -32,6 +32,7 @@
 #include "engines/ic3.h"
 #include "modifiers/implicit_predicate_abstractor.h"
 #include "smt-switch/term_translator.h"
+#include "utils/term_analysis.h"
 
 namespace pono {
 
@@ -51,6 +52,11 @@ class IC3IA : public IC3
 
   void add_important_var(smt::Term v);
 
+  /** Saves the learned predicates to options_.ic3ia_pred_cache_ (if set)
+   *  whatever the result
+   */
+  ProverResult check_until(int k) override;
+
  protected:
   // Note: important that conc_ts_ and abs_ts_ are before ia_
   //       because we will pass them to ia_ and they must be
@@ -70,6 +76,10 @@ class IC3IA : public IC3
   smt::TermTranslator
       to_solver_;  ///< transfer terms from interpolator_ to solver_
 
+  ///< mines predicates from init, bad, frames and interpolants, which
+  ///< share most of their subterms
+  PredicateCollector pred_collector_;
+
   size_t longest_cex_length_;  ///< keeps track of longest (abstract)
                                ///< counterexample
 
@@ -79,7 +89,12 @@ class IC3IA : public IC3
   // instead, we assign indicator labels to check the value of
   // predicates. This should still work fine with other solvers
   smt::UnorderedTermMap lbl2pred_;
-  smt::UnorderedTermSet predlbls_;
+  smt::TermVec predlbls_;  ///< the labels, in the order of predvec_
+  smt::TermVec predvec_;     ///< the predicates
+  smt::TermVec negpredvec_;  ///< the negated predicates
+  smt::UnorderedTermSet defined_lbls_;  ///< labels whose definition is
+                                        ///< asserted in solver_
+  smt::Term asserted_bad_;  ///< bad_ when bad_label_ was last defined
   smt::UnorderedTermSet all_lbls_;  ///< for debugging assertions only
                                     ///< keeps track of both polarities
                                     ///< mostly needed because some solvers
@@ -103,14 +118,30 @@ class IC3IA : public IC3
 
   void initialize() override;
 
+  // the predicates and refinements are not saved
+  bool save_checkpoint_state(Checkpoint & cp) const override
+  {
+    return false;
+  }
+
   void abstract() override;
 
   RefineResult refine() override;
 
+  /** Loads the relations of the predicates in the lemma before returning it
+   *  (with options_.ic3ia_lazy_pred_rels_)
+   */
+  IC3Formula inductive_generalization(size_t i, const IC3Formula & c) override;
+
   void reset_solver() override;
 
   bool is_global_label(const smt::Term & l) const override;
 
+  /** @return 1 for literals over important variables
+   *  (with options_.ic3ia_track_important_vars_), 0 otherwise
+   */
+  size_t literal_importance(const smt::Term & lit) const override;
+
   // specific to IC3IA
 
   void reabstract();
@@ -123,6 +154,23 @@ class IC3IA : public IC3
    */
   bool add_predicate(const smt::Term & pred);
 
+  /** Adds the relation of a predicate to the transition relation, if it
+   *  was not loaded yet (with options_.ic3ia_lazy_pred_rels_, the
+   *  relations are only loaded once a lemma mentions the predicate)
+   *  @param pred the predicate (or its negation)
+   *  @return true iff the relation was loaded by this call
+   */
+  bool load_predicate_relation(const smt::Term & pred);
+
+  /** Loads the relations of all the predicates
+   *  @return the number of relations loaded
+   */
+  size_t load_all_predicate_relations();
+
+  // predicates whose relation (ia_.predicate_refinement) is not in the
+  // transition relation yet, with options_.ic3ia_lazy_pred_rels_
+  smt::UnorderedTermMap unloaded_pred_rels_;
+
   /** Register a state variable mapping in to_solver_
    *  This is a bit ugly but it's needed because symbols aren't created in
    * to_solver_ so it needs the mapping from interpolator_ symbols to solver_
@@ -132,6 +180,35 @@ class IC3IA : public IC3
    *         makes sure not to repeat work
    */
   void register_symbol_mappings(size_t i);
+
+  /** Unsat-core-based predicate discovery, a cheap alternative to
+   *  interpolation: the atoms of the concrete system that are not
+   *  predicates yet are reduced with ia_.reduce_predicates to a set
+   *  that rules out the abstract counterexample cex_
+   *  @param out the new predicates (appended to)
+   *  @return true iff it found predicates ruling out cex_
+   */
+  bool core_predicates(smt::TermVec & out);
+
+  smt::TermVec candidate_atoms_;  ///< atoms of the concrete system over
+                                  ///< current state variables
+  mutable std::unordered_map<smt::Term, size_t>
+      lit_importance_;  ///< cache for literal_importance
+  smt::Term candidate_atoms_trans_;  ///< conc_ts_ trans when candidate_atoms_
+                                     ///< was computed
+
+  /** Adds the predicates of options_.ic3ia_pred_cache_ over the state
+   *  variables of this system
+   *  @return the number of predicates added
+   */
+  size_t load_predicate_cache();
+
+  /** Appends the predicates that were not known at initialization to
+   *  options_.ic3ia_pred_cache_
+   */
+  void save_predicate_cache();
+
+  smt::UnorderedTermSet initial_preds_;  ///< from init, bad and the cache
 };
 
 }  // namespace pono
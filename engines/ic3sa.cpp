@@ -31,6 +31,7 @@
 #include "utils/logger.h"
 #include "utils/term_analysis.h"
 #include "utils/term_walkers.h"
+#include "utils/timeline.h"
 
 using namespace smt;
 using namespace std;
@@ -63,19 +64,16 @@ IC3SA::IC3SA(const Property & p,
 {
   engine_ = Engine::IC3SA_ENGINE;
   approx_pregen_ = true;
+  // the goals are over the abstract system
+  goal_models_ = false;
+  f_unroller_.set_inline_limits(options_.ic3sa_func_unroll_limit_);
 }
 
 IC3Formula IC3SA::get_model_ic3formula() const
 {
   UnorderedTermSet cube_lits;
   // first populate with predicates
-  for (const auto & p : predset_) {
-    if (solver_->get_value(p) == solver_true_) {
-      cube_lits.insert(p);
-    } else {
-      cube_lits.insert(solver_->make_term(Not, p));
-    }
-  }
+  get_predicate_literals(nullptr, cube_lits);
 
   EquivalenceClasses ec;
   get_equivalence_classes_from_model(ts_.statevars(), ec);
@@ -135,6 +133,8 @@ void IC3SA::predecessor_generalization(size_t i,
                                        IC3Formula & pred)
 {
   UnorderedTermSet all_coi_symbols = projection_set_;
+  // the justifications of c and of the constraints share one walk
+  reset_justification();
   justify_coi(ts_.next(c), all_coi_symbols);
   assert(all_coi_symbols.size());
 
@@ -165,17 +165,7 @@ void IC3SA::predecessor_generalization(size_t i,
 
   UnorderedTermSet cube_lits;
   // first populate with predicates
-  for (const auto & p : predset_) {
-    if (!in_projection(p, coi_symbols)) {
-      continue;
-    }
-
-    if (solver_->get_value(p) == solver_true_) {
-      cube_lits.insert(p);
-    } else {
-      cube_lits.insert(solver_->make_term(Not, p));
-    }
-  }
+  get_predicate_literals(&coi_symbols, cube_lits);
 
   EquivalenceClasses ec;
   get_equivalence_classes_from_model(coi_symbols, ec);
@@ -233,6 +223,7 @@ void IC3SA::abstract()
 
 RefineResult IC3SA::refine()
 {
+  TIMELINE_SPAN("ic3sa_refine");
   assert(!solver_context_);
   logger.log(1, "IC3SA: refining a counterexample of length {}", cex_.size());
 
@@ -390,6 +381,9 @@ RefineResult IC3SA::ic3sa_refine_functional(Term & learned_lemma)
       conjunctive_assumptions(unrolled, used_lbls, lbls, assumps);
     }
 
+    // definitions of the fresh symbols of large inlined updates
+    solver_->assert_formula(f_unroller_.extra_constraints_at(i));
+
     r = check_sat_assuming(lbls);
     if (r.is_unsat()) {
       break;
@@ -403,6 +397,12 @@ RefineResult IC3SA::ic3sa_refine_functional(Term & learned_lemma)
           last_model_vals[iv_j] = solver_->get_value(iv_j);
         }
       }
+      // fresh symbols are treated like inputs
+      for (size_t j = 1; j < i; ++j) {
+        for (const auto & fv : f_unroller_.fresh_symbols_at(j)) {
+          last_model_vals[fv] = solver_->get_value(fv);
+        }
+      }
     }
   }
   assert(lbls.size() == assumps.size());
@@ -417,6 +417,7 @@ RefineResult IC3SA::ic3sa_refine_functional(Term & learned_lemma)
   assert(r.is_unsat());  // not expecting unknown
   UnorderedTermSet core;
   solver_->get_unsat_assumptions(core);
+  stats_->increment("unsat_cores");
   assert(core.size());
 
   TermVec reduced_constraints;
@@ -546,6 +547,7 @@ RefineResult IC3SA::ic3sa_refine_value(Term & learned_lemma)
   assert(r.is_unsat());  // not expecting unknown
   UnorderedTermSet core;
   solver_->get_unsat_assumptions(core);
+  stats_->increment("unsat_cores");
   assert(core.size());
 
   pop_solver_context();
@@ -573,7 +575,9 @@ void IC3SA::conjunctive_assumptions(const Term & term,
                                     TermVec & lbls,
                                     TermVec & assumps)
 {
-  assert(solver_context_);  // should only add assumptions at non-zero context
+  // should only add assumptions at non-zero context
+  // (or in rel_ind_check with assumptions instead of a context)
+  assert(solver_context_ || options_.ic3_rel_ind_assumptions_);
   tmp_.clear();
   conjunctive_partition(term, tmp_, true);
   Term lbl;
@@ -674,25 +678,77 @@ void IC3SA::get_equivalence_classes_from_model(const UnorderedTermSet & to_keep,
                                                EquivalenceClasses & ec) const
 {
   assert(!ec.size());
+
+  // the terms of the abstraction are over current state variables,
+  // if they are all kept there is no need to check the projection
+  bool keep_all = &to_keep == &ts_.statevars();
+  if (!keep_all && to_keep.size() >= ts_.statevars().size()) {
+    keep_all = true;
+    for (const auto & sv : ts_.statevars()) {
+      if (to_keep.find(sv) == to_keep.end()) {
+        keep_all = false;
+        break;
+      }
+    }
+  }
+
   // assumes the solver state is sat
-  for (const auto & elem : term_abstraction_) {
+  for (const auto & elem : term_abstraction_vec_) {
     const Sort & sort = elem.first;
-    const UnorderedTermSet & terms = elem.second;
+    const TermVec & terms = elem.second;
 
     // TODO figure out if a DisjointSet is a better data structure
     //      will need to keep track of all terms in each partition though
 
-    ec[sort] = std::unordered_map<smt::Term, smt::UnorderedTermSet>();
-    std::unordered_map<smt::Term, smt::UnorderedTermSet> & m = ec.at(sort);
-    for (const auto & t : terms) {
-      if (in_projection(t, to_keep)) {
-        Term val = solver_->get_value(t);
-        m[val].insert(t);
+    std::unordered_map<smt::Term, smt::UnorderedTermSet> & m = ec[sort];
+    const TermVec * projected = &terms;
+    if (!keep_all) {
+      projected_buf_.clear();
+      for (const auto & t : terms) {
+        if (in_projection(t, to_keep)) {
+          projected_buf_.push_back(t);
+        }
+      }
+      projected = &projected_buf_;
+    }
+    get_values(*projected, vals_buf_);
+    for (size_t i = 0; i < projected->size(); ++i) {
+      m[vals_buf_[i]].insert((*projected)[i]);
+    }
+  }
+}
+
+void IC3SA::get_predicate_literals(const UnorderedTermSet * to_keep,
+                                   UnorderedTermSet & out_cube) const
+{
+  // assumes the solver state is sat
+  TermVec projected_negs;
+  const TermVec * preds = &predvec_;
+  if (to_keep) {
+    projected_buf_.clear();
+    for (size_t i = 0; i < predvec_.size(); ++i) {
+      if (in_projection(predvec_[i], *to_keep)) {
+        projected_buf_.push_back(predvec_[i]);
+        projected_negs.push_back(negpredvec_[i]);
       }
     }
+    preds = &projected_buf_;
+  }
+  const TermVec & negpreds = to_keep ? projected_negs : negpredvec_;
+
+  get_values(*preds, vals_buf_);
+  for (size_t i = 0; i < preds->size(); ++i) {
+    out_cube.insert(vals_buf_[i] == solver_true_ ? (*preds)[i] : negpreds[i]);
   }
 }
 
+void IC3SA::cache_free_vars(const Term & t)
+{
+  UnorderedTermSet free_vars;
+  get_free_symbolic_consts(t, free_vars);
+  free_vars_cache_[t] = TermVec(free_vars.begin(), free_vars.end());
+}
+
 void IC3SA::construct_partition(const EquivalenceClasses & ec,
                                 UnorderedTermSet & out_cube) const
 {
@@ -783,8 +839,11 @@ UnorderedTermSet IC3SA::add_to_term_abstraction(const Term & term)
 {
   UnorderedTermSet new_terms;
 
-  Sort boolsort = solver_->make_sort(BOOL);
-  SubTermCollector stc(solver_);
+  if (!subterm_collector_) {
+    subterm_collector_.reset(new SubTermCollector(solver_));
+  }
+  SubTermCollector & stc = *subterm_collector_;
+  stc.clear_collected();
   stc.collect_subterms(term);
 
   for (const auto & p : stc.get_predicates()) {
@@ -796,6 +855,9 @@ UnorderedTermSet IC3SA::add_to_term_abstraction(const Term & term)
     if (ts_.only_curr(p)) {
       if (predset_.insert(p).second) {
         new_terms.insert(p);
+        predvec_.push_back(p);
+        negpredvec_.push_back(solver_->make_term(Not, p));
+        cache_free_vars(p);
       }
     }
   }
@@ -808,6 +870,8 @@ UnorderedTermSet IC3SA::add_to_term_abstraction(const Term & term)
       if (ts_.only_curr(term)) {
         if (term_abstraction_[elem.first].insert(term).second) {
           new_terms.insert(term);
+          term_abstraction_vec_[elem.first].push_back(term);
+          cache_free_vars(term);
         }
       }
     }
@@ -820,21 +884,22 @@ void IC3SA::justify_coi(Term term, UnorderedTermSet & projection)
 {
   // expecting to have a satisfiable context
   // and IC3Base only solves at context levels > 0
-  assert(solver_context_);
+  // (or in rel_ind_check with assumptions instead of a context)
+  assert(solver_context_ || options_.ic3_rel_ind_assumptions_);
 
-  TermVec to_visit({ term });
-  UnorderedTermSet visited;
+  TermVec & to_visit = to_visit_buf_;
+  to_visit.clear();
+  to_visit.push_back(term);
 
   Term c;
   while (!to_visit.empty()) {
     c = to_visit.back();
     to_visit.pop_back();
 
-    if (visited.find(c) != visited.end()) {
+    if (!justified_.insert(c).second) {
       // already visited
       continue;
     }
-    visited.insert(c);
 
     Op op = c->get_op();
     Sort sort = c->get_sort();
@@ -842,13 +907,13 @@ void IC3SA::justify_coi(Term term, UnorderedTermSet & projection)
       TermVec children(c->begin(), c->end());
       assert(children.size() == 3);
       to_visit.push_back(children[0]);
-      if (solver_->get_value(children[0]) == solver_true_) {
+      if (justify_value(children[0]) == solver_true_) {
         to_visit.push_back(children[1]);
       } else {
         to_visit.push_back(children[2]);
       }
     } else if (sort == boolsort_
-               && is_controlled(op.prim_op, solver_->get_value(c))) {
+               && is_controlled(op.prim_op, justify_value(c))) {
       to_visit.push_back(get_controlling(c));
     } else {
       for (const auto & cc : c) {
@@ -863,11 +928,51 @@ void IC3SA::justify_coi(Term term, UnorderedTermSet & projection)
         }
       }
 
-      get_free_symbolic_consts(c, projection);
+      collect_symbols(c, projection);
     }
   }
 }
 
+void IC3SA::reset_justification()
+{
+  justified_.clear();
+  collected_.clear();
+  justify_values_.clear();
+}
+
+void IC3SA::collect_symbols(const Term & t, UnorderedTermSet & projection)
+{
+  // same result as get_free_symbolic_consts, but each subterm is
+  // only traversed once per query instead of once per ancestor
+  TermVec to_visit({ t });
+  Term c;
+  while (!to_visit.empty()) {
+    c = to_visit.back();
+    to_visit.pop_back();
+    if (!collected_.insert(c).second) {
+      continue;
+    }
+    if (c->is_symbolic_const()
+        && c->get_sort()->get_sort_kind() != FUNCTION) {
+      projection.insert(c);
+    }
+    for (const auto & cc : c) {
+      to_visit.push_back(cc);
+    }
+  }
+}
+
+Term IC3SA::justify_value(const Term & t) const
+{
+  auto it = justify_values_.find(t);
+  if (it != justify_values_.end()) {
+    return it->second;
+  }
+  Term val = solver_->get_value(t);
+  justify_values_[t] = val;
+  return val;
+}
+
 bool IC3SA::is_controlled(PrimOp po, const Term & val) const
 {
   assert(val->is_value());
@@ -885,10 +990,10 @@ bool IC3SA::is_controlled(PrimOp po, const Term & val) const
 
 Term IC3SA::get_controlling(Term t) const
 {
-  assert(solver_context_);
+  assert(solver_context_ || options_.ic3_rel_ind_assumptions_);
 
   Op op = t->get_op();
-  assert(is_controlled(op.prim_op, solver_->get_value(t)));
+  assert(is_controlled(op.prim_op, justify_value(t)));
   assert(!op.is_null());
 
   if (op == Implies) {
@@ -909,7 +1014,7 @@ Term IC3SA::get_controlling(Term t) const
 
   Term controlling_term;
   for (const auto & tt : t) {
-    if (solver_->get_value(tt) == controlling_val) {
+    if (justify_value(tt) == controlling_val) {
       controlling_term = tt;
       break;
     }
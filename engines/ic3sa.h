@@ -26,6 +26,7 @@
 
 #include "core/functional_unroller.h"
 #include "engines/ic3.h"
+#include "utils/term_walkers.h"
 
 namespace pono {
 
@@ -62,6 +63,22 @@ class IC3SA : public IC3
 
   smt::UnorderedTermSet projection_set_;  ///< variables always in projection
 
+  // the same terms as predset_ and term_abstraction_, in the order they
+  // were added, maintained incrementally by add_to_term_abstraction
+  smt::TermVec predvec_;
+  smt::TermVec negpredvec_;  ///< the negations of predvec_
+  std::unordered_map<smt::Sort, smt::TermVec> term_abstraction_vec_;
+  ///< free symbols of each term of predvec_ and term_abstraction_vec_
+  std::unordered_map<smt::Term, smt::TermVec> free_vars_cache_;
+
+  ///< keeps the subterms it visited, so add_to_term_abstraction only
+  ///< visits the subterms of a term that were never added before
+  std::unique_ptr<SubTermCollector> subterm_collector_;
+
+  // buffers reused by the model queries
+  mutable smt::TermVec projected_buf_;
+  mutable smt::TermVec vals_buf_;
+
   smt::SmtSolver interpolator_;
   std::unique_ptr<smt::TermTranslator> to_interpolator_;
   std::unique_ptr<smt::TermTranslator> from_interpolator_;
@@ -101,6 +118,12 @@ class IC3SA : public IC3
 
   void initialize() override;
 
+  // the term abstraction and refinements are not saved
+  bool save_checkpoint_state(Checkpoint & cp) const override
+  {
+    return false;
+  }
+
   // IC3SA specific methods
 
   RefineResult ic3sa_refine_functional(smt::Term & learned_lemma);
@@ -157,11 +180,31 @@ class IC3SA : public IC3
    */
   void justify_coi(smt::Term term, smt::UnorderedTermSet & projection);
 
+  /** Starts a new justification query: the calls to justify_coi until
+   *  the next call share their visited terms and model values
+   *  (the model must not change in between)
+   */
+  void reset_justification();
+
+  /** Adds the free symbolic constants of t to projection
+   *  skipping the subterms already collected in this query
+   */
+  void collect_symbols(const smt::Term & t, smt::UnorderedTermSet & projection);
+
+  /** @return the value of t in the current model, memoized per query */
+  smt::Term justify_value(const smt::Term & t) const;
+
   bool is_controlled(smt::PrimOp po, const smt::Term & val) const;
 
   // helper function for justify_coi
   smt::Term get_controlling(smt::Term t) const;
 
+  // state of the current justification query, see reset_justification
+  smt::UnorderedTermSet justified_;  ///< terms visited by justify_coi
+  smt::UnorderedTermSet collected_;  ///< terms visited by collect_symbols
+  mutable smt::UnorderedTermMap justify_values_;
+  smt::TermVec to_visit_buf_;
+
   /** Check if a term is in the projection
    *  @param t the term to check
    *  @param to_keep the symbols for the projection
@@ -171,23 +214,48 @@ class IC3SA : public IC3
   inline bool in_projection(const smt::Term & t,
                             const smt::UnorderedTermSet & to_keep) const
   {
-    // TODO can improve this with a specialized function which returns false
-    // as soon as it finds a symbol outside of to_keep when traversing t
+    auto it = free_vars_cache_.find(t);
+    if (it != free_vars_cache_.end()) {
+      return in_projection(it->second, to_keep);
+    }
 
     smt::UnorderedTermSet free_vars;
     get_free_symbolic_consts(t, free_vars);
-    bool in_projection = true;
+    return in_projection(smt::TermVec(free_vars.begin(), free_vars.end()),
+                         to_keep);
+  }
+
+  /** Check if the free symbols of a term are in the projection
+   *  @param free_vars the free symbols
+   *  @param to_keep the symbols for the projection
+   */
+  inline bool in_projection(const smt::TermVec & free_vars,
+                            const smt::UnorderedTermSet & to_keep) const
+  {
     for (const auto & fv : free_vars) {
       if (to_keep.find(fv) == to_keep.end()
           && projection_set_.find(fv) == projection_set_.end()) {
         // this term contains a symbol not in the to_keep set
-        in_projection = false;
-        break;
+        return false;
       }
     }
-    return in_projection;
+    return true;
   }
 
+  /** Records the free symbols of a new term of the abstraction
+   *  @param t the term added to predset_ or term_abstraction_
+   */
+  void cache_free_vars(const smt::Term & t);
+
+  /** Adds the literals of the predicates to a cube, with their values
+   *  in the current model
+   *  @param to_keep only the predicates in this projection
+   *         (null for all the predicates)
+   *  @param out_cube set of formulae to add to
+   */
+  void get_predicate_literals(const smt::UnorderedTermSet * to_keep,
+                              smt::UnorderedTermSet & out_cube) const;
+
   /** Register a state variable mapping in to_solver_
    *  This is a bit ugly but it's needed because symbols aren't created in
    * to_solver_ so it needs the mapping from interpolator_ symbols to solver_
@@ -16,10 +16,13 @@
 
 #include "engines/interpolantmc.h"
 
+#include <chrono>
+
 #include "smt-switch/exceptions.h"
 #include "smt-switch/utils.h"
 #include "smt/available_solvers.h"
 #include "utils/logger.h"
+#include "utils/solver_trace.h"
 #include "utils/term_analysis.h"
 
 using namespace smt;
@@ -83,6 +86,11 @@ void InterpolantMC::initialize()
   transA_ = unroller_.at_time(ts_.trans(), 0);
   transB_ = solver_->make_term(true);
   bad_disjuncts_ = solver_->make_term(false);
+
+  int_init0_ = to_interpolator_.transfer_term(init0_);
+  int_transA_ = to_interpolator_.transfer_term(transA_);
+  int_transB_ = interpolator_->make_term(true);
+  int_bad_disjuncts_ = interpolator_->make_term(false);
 }
 
 ProverResult InterpolantMC::check_until(int k)
@@ -91,6 +99,10 @@ ProverResult InterpolantMC::check_until(int k)
 
   try {
     for (int i = 0; i <= k; ++i) {
+      if (interrupted()) {
+        logger.log(1, "InterpolantMC: interrupted at bound {}", i);
+        return ProverResult::UNKNOWN;
+      }
       if (step(i)) {
         return ProverResult::TRUE;
       } else if (concrete_cex_) {
@@ -121,39 +133,92 @@ bool InterpolantMC::step(int i)
 
   Term bad_i = unroller_.at_time(bad_, i);
   bad_disjuncts_ = solver_->make_term(Or, bad_disjuncts_, bad_i);
-  Term int_bad_disjuncts = to_interpolator_.transfer_term(bad_disjuncts_);
-  Term int_transA = to_interpolator_.transfer_term(transA_);
-  Term int_transB = to_interpolator_.transfer_term(transB_);
+  int_bad_disjuncts_ = interpolator_->make_term(
+      Or, int_bad_disjuncts_, to_interpolator_.transfer_term(bad_i));
+  Term int_B = interpolator_->make_term(And, int_transB_, int_bad_disjuncts_);
+
+  // R is kept as a flat disjunction, with each disjunct transferred once
   Term R = init0_;
+  Term int_R = int_init0_;
+  UnorderedTermSet R_disjuncts({ init0_ });
+  TermVec learned;  // the disjuncts of R besides init0_, in order
+  if (options_.interp_reuse_) {
+    learned = safe_seeds();
+    for (const auto & d : learned) {
+      R_disjuncts.insert(d);
+      R = solver_->make_term(Or, R, d);
+      int_R = interpolator_->make_term(
+          Or, int_R, to_interpolator_.transfer_term(d));
+    }
+  }
+  // the seeds can't reach a bad state at this bound, so a counterexample
+  // from R before any interpolant is added starts in init
+  const Term R_start = R;
   Term Ri;
   bool got_interpolant = true;
 
   while (got_interpolant) {
-    Term int_R = to_interpolator_.transfer_term(R);
+    if (interrupted()) {
+      // leave reached_k_ unchanged, check_until will return unknown
+      return false;
+    }
     Term int_Ri;
+    budget_.count_solver_call();
+    auto begin = std::chrono::steady_clock::now();
+    SolverCallTimer timer(TRACE_GET_INTERPOLANT);
     Result r = interpolator_->get_interpolant(
-        interpolator_->make_term(And, int_R, int_transA),
-        interpolator_->make_term(And, int_transB, int_bad_disjuncts),
-        int_Ri);
+        interpolator_->make_term(And, int_R, int_transA_), int_B, int_Ri);
+    timer.done(r);
+    stats_->add_time("interpolant_time",
+                     std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - begin)
+                         .count());
+    stats_->increment("interpolant_calls");
 
     got_interpolant = r.is_unsat();
 
     if (got_interpolant) {
       Ri = to_solver_.transfer_term(int_Ri);
-      // map Ri to time 0
-      Ri = unroller_.at_time(unroller_.untime(Ri), 0);
+      // map Ri from time 1 to time 0
+      Ri = unroller_.shift(Ri, 1, 0);
+
+      // the disjuncts of Ri that are not in R yet
+      TermVec new_disjuncts;
+      TermVec to_visit({ Ri });
+      while (to_visit.size()) {
+        Term d = to_visit.back();
+        to_visit.pop_back();
+        if (d->get_op() == Or) {
+          for (const auto & c : *d) {
+            to_visit.push_back(c);
+          }
+        } else if (R_disjuncts.find(d) == R_disjuncts.end()) {
+          new_disjuncts.push_back(d);
+        }
+      }
 
-      if (check_entail(Ri, R)) {
-        // check if the over-approximation has reached a fix-point
+      // check if the over-approximation has reached a fix-point
+      // if every disjunct is in R already this holds syntactically
+      if (new_disjuncts.empty() || check_entail(Ri, R)) {
+        if (new_disjuncts.empty()) {
+          stats_->increment("syntactic_fixpoints");
+        }
         logger.log(1, "Found a proof at bound: {}", i);
         invar_ = unroller_.untime(R);
         return true;
       } else {
         logger.log(1, "Extending initial states.");
         logger.log(3, "Using interpolant: {}", Ri);
-        R = solver_->make_term(Or, R, Ri);
+        for (const auto & d : new_disjuncts) {
+          if (R_disjuncts.insert(d).second) {
+            learned.push_back(d);
+            R = solver_->make_term(Or, R, d);
+            int_R = interpolator_->make_term(
+                Or, int_R, to_interpolator_.transfer_term(d));
+          }
+        }
       }
-    } else if (R == init0_) {
+    } else if (R == R_start) {
       // found a concrete counter example
       // replay it in the solver with model generation
       concrete_cex_ = true;
@@ -163,7 +228,7 @@ bool InterpolantMC::step(int i)
       solver_->assert_formula(solver_->make_term(
           And, init0_, solver_->make_term(And, solver_trans, bad_i)));
 
-      Result r = solver_->check_sat();
+      Result r = check_sat();
       if (!r.is_sat()) {
         throw PonoException("Internal error: Expecting satisfiable result");
       }
@@ -176,12 +241,19 @@ bool InterpolantMC::step(int i)
     }
   }
 
+  if (options_.interp_reuse_) {
+    // spurious, the next bound starts from the safe part of this R
+    seeds_ = std::move(learned);
+  }
+
   // Note: important that it's for i > 0
   // transB can't have any symbols from time 0 in it
   assert(i > 0);
   // extend the unrolling
-  transB_ =
-      solver_->make_term(And, transB_, unroller_.at_time(ts_.trans(), i));
+  Term trans_i = unroller_.at_time(ts_.trans(), i);
+  transB_ = solver_->make_term(And, transB_, trans_i);
+  int_transB_ = interpolator_->make_term(
+      And, int_transB_, to_interpolator_.transfer_term(trans_i));
   ++reached_k_;
 
   return false;
@@ -193,15 +265,59 @@ bool InterpolantMC::step_0()
   solver_->assert_formula(init0_);
   solver_->assert_formula(unroller_.at_time(bad_, 0));
 
-  Result r = solver_->check_sat();
+  Result r = check_sat();
   if (r.is_unsat()) {
     ++reached_k_;
+  } else if (r.is_unknown()) {
+    budget_.cancel("solver returned unknown at bound 0");
   } else {
     concrete_cex_ = true;
   }
   return false;
 }
 
+TermVec InterpolantMC::safe_seeds()
+{
+  TermVec res;
+  if (seeds_.empty()) {
+    return res;
+  }
+
+  // a seed is safe if no bad state is reachable from it in 1 to i steps,
+  // with i the current bound, checked without interpolation
+  reset_assertions(solver_);
+  solver_->assert_formula(transA_);
+  solver_->assert_formula(transB_);
+  solver_->assert_formula(bad_disjuncts_);
+  Term all_seeds = seeds_[0];
+  for (size_t j = 1; j < seeds_.size(); ++j) {
+    all_seeds = solver_->make_term(Or, all_seeds, seeds_[j]);
+  }
+  solver_->push();
+  solver_->assert_formula(all_seeds);
+  Result r = check_sat();
+  solver_->pop();
+  if (r.is_unsat()) {
+    res = seeds_;
+  } else {
+    // keep the prefix of safe seeds, the later ones were found from it
+    for (const auto & d : seeds_) {
+      solver_->push();
+      solver_->assert_formula(d);
+      r = check_sat();
+      solver_->pop();
+      if (!r.is_unsat()) {
+        break;
+      }
+      res.push_back(d);
+    }
+  }
+  logger.log(2, "Reusing {} of {} interpolants", res.size(), seeds_.size());
+  stats_->increment("reused_interpolants", res.size());
+  stats_->increment("dropped_interpolants", seeds_.size() - res.size());
+  return res;
+}
+
 void InterpolantMC::reset_assertions(SmtSolver & s)
 {
   // reset assertions is not supported by all solvers
@@ -220,7 +336,7 @@ bool InterpolantMC::check_entail(const Term & p, const Term & q)
   reset_assertions(solver_);
   solver_->assert_formula(
       solver_->make_term(And, p, solver_->make_term(Not, q)));
-  Result r = solver_->check_sat();
+  Result r = check_sat();
   assert(r.is_unsat() || r.is_sat());
   return r.is_unsat();
 }
@@ -47,6 +47,12 @@ class InterpolantMC : public Prover
 
   bool check_entail(const smt::Term & p, const smt::Term & q);
 
+  /** @return the longest prefix of seeds_ from which no bad state is
+   *  reachable at the current bound (with options_.interp_reuse_)
+   *  Uses solver_, requires transB_ and bad_disjuncts_ for the bound.
+   */
+  smt::TermVec safe_seeds();
+
   smt::SmtSolver interpolator_;
   // for translating terms to interpolator_
   smt::TermTranslator to_interpolator_;
@@ -61,6 +67,17 @@ class InterpolantMC : public Prover
   smt::Term transB_;
   smt::Term bad_disjuncts_;  ///< a disjunction of bads in the suffix
 
+  // the same terms in interpolator_, extended incrementally so that only
+  // the new parts of the unrolling are transferred
+  smt::Term int_init0_;
+  smt::Term int_transA_;
+  smt::Term int_transB_;
+  smt::Term int_bad_disjuncts_;
+
+  ///< the interpolants of the last bound, at time 0 in the order they were
+  ///< found, to start the next bound with (options_.interp_reuse_)
+  smt::TermVec seeds_;
+
 };  // class InterpolantMC
 
 }  // namespace pono
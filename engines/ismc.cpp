@@ -0,0 +1,249 @@
+/*********************                                                        */
+/*! \file ismc.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Interpolation-sequence based model checking.
+**        See Interpolation-Sequence Based Model Checking
+**        (Vizel and Grumberg, FMCAD 2009)
+**
+**/
+
+#include "engines/ismc.h"
+
+#include <chrono>
+
+#include "smt-switch/exceptions.h"
+#include "smt-switch/utils.h"
+#include "smt/available_solvers.h"
+#include "utils/logger.h"
+
+using namespace smt;
+
+namespace pono {
+
+ISMC::ISMC(const Property & p,
+           const TransitionSystem & ts,
+           const SmtSolver & slv,
+           PonoOptions opt)
+    : super(p, ts, slv, opt),
+      // only mathsat interpolator supported
+      interpolator_(create_interpolating_solver_for(
+          SolverEnum::MSAT_INTERPOLATOR, Engine::ISMC_ENGINE)),
+      to_interpolator_(interpolator_),
+      to_solver_(solver_)
+{
+  engine_ = Engine::ISMC_ENGINE;
+}
+
+ISMC::~ISMC() {}
+
+void ISMC::initialize()
+{
+  if (initialized_) {
+    return;
+  }
+
+  super::initialize();
+
+  reset_assertions(interpolator_);
+
+  // need to copy over UF as well
+  UnorderedTermMap & cache = to_solver_.get_cache();
+  UnorderedTermSet free_symbols;
+  get_free_symbols(bad_, free_symbols);
+  get_free_symbols(ts_.init(), free_symbols);
+  get_free_symbols(ts_.trans(), free_symbols);
+  for (const auto & s : free_symbols) {
+    if (s->get_sort()->get_sort_kind() == FUNCTION) {
+      cache[to_interpolator_.transfer_term(s)] = s;
+    }
+  }
+
+  concrete_cex_ = false;
+  init0_ = unroller_.at_time(ts_.init(), 0);
+  int_init0_ = to_interpolator_.transfer_term(init0_, BOOL);
+  int_trans_.clear();
+  reach_ = { ts_.init() };
+}
+
+ProverResult ISMC::check_until(int k)
+{
+  initialize();
+
+  try {
+    for (int i = reached_k_ + 1; i <= k; ++i) {
+      if (interrupted()) {
+        logger.log(1, "ISMC: interrupted at bound {}", i);
+        return ProverResult::UNKNOWN;
+      }
+      if (step(i)) {
+        return ProverResult::TRUE;
+      } else if (concrete_cex_) {
+        compute_witness();
+        return ProverResult::FALSE;
+      }
+    }
+  }
+  catch (InternalSolverException & e) {
+    logger.log(1, "Failed when computing interpolant.");
+  }
+  return ProverResult::UNKNOWN;
+}
+
+bool ISMC::step(int i)
+{
+  if (i <= reached_k_) {
+    return false;
+  }
+
+  logger.log(1, "Checking interpolation sequence at bound: {}", i);
+
+  if (i == 0) {
+    // no interpolants at bound 0, only checking for trivial bug
+    return step_0();
+  }
+
+  // extend the unrolling by one transition, earlier ones are reused
+  assert(int_trans_.size() + 1 == static_cast<size_t>(i));
+  register_symbol_mappings(i);
+  int_trans_.push_back(to_interpolator_.transfer_term(
+      unroller_.at_time(ts_.trans(), i - 1), BOOL));
+
+  TermVec formulae;
+  formulae.reserve(i + 1);
+  formulae.push_back(interpolator_->make_term(And, int_init0_, int_trans_[0]));
+  for (int j = 1; j < i; ++j) {
+    formulae.push_back(int_trans_[j]);
+  }
+  formulae.push_back(
+      to_interpolator_.transfer_term(unroller_.at_time(bad_, i), BOOL));
+
+  TermVec interpolants;
+  budget_.count_solver_call();
+  auto begin = std::chrono::steady_clock::now();
+  Result r = interpolator_->get_sequence_interpolants(formulae, interpolants);
+  stats_->add_time("interpolant_time",
+                   std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - begin)
+                       .count());
+  stats_->increment("interpolant_calls");
+
+  if (r.is_sat()) {
+    // the previous bounds were unsat, so this is a shortest counterexample
+    replay_cex(i);
+    return false;
+  } else if (r.is_unknown()) {
+    budget_.cancel("interpolant generation failed at bound "
+                   + std::to_string(i));
+    return false;
+  }
+
+  assert(interpolants.size() == static_cast<size_t>(i));
+  reach_.push_back(solver_->make_term(true));
+  for (int j = 1; j <= i; ++j) {
+    const Term & I = interpolants[j - 1];
+    assert(I);
+    Term solver_I = unroller_.untime(to_solver_.transfer_term(I, BOOL));
+    logger.log(3, "got interpolant for step {}: {}", j, solver_I);
+    reach_[j] = solver_->make_term(And, reach_[j], solver_I);
+  }
+
+  ++reached_k_;
+
+  // fix-point check: are the states after j steps reached before?
+  Term reached = reach_[0];
+  for (int j = 1; j <= i; ++j) {
+    if (interrupted()) {
+      return false;
+    }
+    if (check_entail(reach_[j], reached)) {
+      logger.log(1, "Found a proof at bound: {}", i);
+      invar_ = reached;
+      stats_->set("fixpoint_step", j);
+      return true;
+    }
+    reached = solver_->make_term(Or, reached, reach_[j]);
+  }
+
+  return false;
+}
+
+bool ISMC::step_0()
+{
+  reset_assertions(solver_);
+  solver_->assert_formula(init0_);
+  solver_->assert_formula(unroller_.at_time(bad_, 0));
+
+  Result r = check_sat();
+  if (r.is_unsat()) {
+    ++reached_k_;
+  } else if (r.is_unknown()) {
+    budget_.cancel("solver returned unknown at bound 0");
+  } else {
+    concrete_cex_ = true;
+  }
+  return false;
+}
+
+void ISMC::reset_assertions(SmtSolver & s)
+{
+  // reset assertions is not supported by all solvers
+  // but MathSAT is the only supported solver that can do interpolation
+  // so this should be safe
+  try {
+    s->reset_assertions();
+  }
+  catch (NotImplementedException & e) {
+    throw PonoException("Got unexpected solver in ISMC.");
+  }
+}
+
+bool ISMC::check_entail(const Term & p, const Term & q)
+{
+  reset_assertions(solver_);
+  solver_->assert_formula(
+      solver_->make_term(And, p, solver_->make_term(Not, q)));
+  Result r = check_sat();
+  assert(r.is_unsat() || r.is_sat());
+  return r.is_unsat();
+}
+
+void ISMC::register_symbol_mappings(int i)
+{
+  UnorderedTermMap & cache = to_solver_.get_cache();
+  Term unrolled;
+  for (const auto & sv : ts_.statevars()) {
+    unrolled = unroller_.at_time(sv, i);
+    cache[to_interpolator_.transfer_term(unrolled)] = unrolled;
+  }
+  for (const auto & iv : ts_.inputvars()) {
+    unrolled = unroller_.at_time(iv, i);
+    cache[to_interpolator_.transfer_term(unrolled)] = unrolled;
+  }
+}
+
+void ISMC::replay_cex(int i)
+{
+  // replay it in the solver with model generation
+  concrete_cex_ = true;
+  reset_assertions(solver_);
+  solver_->assert_formula(init0_);
+  for (int j = 0; j < i; ++j) {
+    solver_->assert_formula(unroller_.at_time(ts_.trans(), j));
+  }
+  solver_->assert_formula(unroller_.at_time(bad_, i));
+
+  Result r = check_sat();
+  if (!r.is_sat()) {
+    throw PonoException("Internal error: Expecting satisfiable result");
+  }
+}
+
+}  // namespace pono
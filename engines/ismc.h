@@ -0,0 +1,82 @@
+/*********************                                                        */
+/*! \file ismc.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Interpolation-sequence based model checking.
+**        See Interpolation-Sequence Based Model Checking
+**        (Vizel and Grumberg, FMCAD 2009)
+**
+**        Every bound k is a single BMC query, and its sequence
+**        interpolant gives an over-approximation of the states reachable
+**        in exactly j steps for each j <= k. These are conjoined across
+**        bounds, and the property holds once the states of some step j
+**        are contained in the union of the earlier steps.
+**
+**/
+
+#pragma once
+
+#include "engines/prover.h"
+#include "smt-switch/smt.h"
+
+namespace pono {
+
+class ISMC : public Prover
+{
+ public:
+  ISMC(const Property & p,
+       const TransitionSystem & ts,
+       const smt::SmtSolver & slv,
+       PonoOptions opt = PonoOptions());
+
+  ~ISMC();
+
+  typedef Prover super;
+
+  void initialize() override;
+
+  ProverResult check_until(int k) override;
+
+ protected:
+  bool step(int i);
+  bool step_0();
+
+  void reset_assertions(smt::SmtSolver & s);
+
+  bool check_entail(const smt::Term & p, const smt::Term & q);
+
+  /** Map the unrolled symbols at time i from interpolator_ to solver_ */
+  void register_symbol_mappings(int i);
+
+  /** Replay the counterexample of length i in solver_ for the witness */
+  void replay_cex(int i);
+
+  smt::SmtSolver interpolator_;
+  // for translating terms to interpolator_
+  smt::TermTranslator to_interpolator_;
+  // for translating terms to solver_
+  smt::TermTranslator to_solver_;
+
+  // set to true when a concrete_cex is found
+  bool concrete_cex_;
+
+  smt::Term init0_;
+  ///< int_trans_[j] is the transition from j to j+1 in interpolator_,
+  ///< transferred once and reused by all the following bounds
+  smt::TermVec int_trans_;
+  smt::Term int_init0_;
+
+  ///< reach_[j] over-approximates the states reachable in exactly j steps
+  ///< (untimed), reach_[0] is init
+  smt::TermVec reach_;
+
+};  // class ISMC
+
+}  // namespace pono
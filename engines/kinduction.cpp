@@ -15,16 +15,62 @@
  **/
 
 #include "kinduction.h"
+
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+
+#include "smt/available_solvers.h"
+#include "utils/lemma_cache.h"
 #include "utils/logger.h"
 
 using namespace smt;
 
 namespace pono {
 
+/** The inductive steps of k-induction in their own solver
+ *  Only used by one thread at a time.
+ */
+class KInductionStepWorker : public KInduction
+{
+ public:
+  KInductionStepWorker(const Property & p,
+                       const TransitionSystem & ts,
+                       const SmtSolver & solver,
+                       PonoOptions opt)
+      : KInduction(p, ts, solver, opt), unrolled_(0)
+  {
+  }
+
+  /** Check the inductive step at bound i
+   *  The transitions and the property up to i are asserted permanently,
+   *  so bounds should be given in increasing order.
+   *  @return true iff the step holds
+   */
+  bool check_step(int i)
+  {
+    const Term prop = solver_->make_term(Not, bad_);
+    for (; unrolled_ <= i; ++unrolled_) {
+      assert_trans_at(unrolled_);
+      solver_->assert_formula(unroller_.at_time(prop, unrolled_));
+    }
+    return inductive_step(i);
+  }
+
+  int reached_k() const { return reached_k_; }
+
+ private:
+  int unrolled_;  ///< the number of times with trans and prop asserted
+};
+
 KInduction::KInduction(const Property & p, const TransitionSystem & ts,
                        const SmtSolver & solver,
                        PonoOptions opt)
-  : super(p, ts, solver, opt)
+  : super(p, ts, solver, opt),
+    step_proven_(-1),
+    stop_step_(false),
+    candidates_changed_(false),
+    shared_lemmas_time_(-1)
 {
   engine_ = Engine::KIND;
 }
@@ -47,18 +93,68 @@ void KInduction::initialize()
   init0_ = unroller_.at_time(ts_.init(), 0);
   false_ = solver_->make_term(false);
   simple_path_ = solver_->make_term(true);
+
+  // with a dual solver the worker loads them
+  if (!options_.kind_invariants_.empty() && !options_.kind_dual_solver_) {
+    std::vector<TermVec> lemmas;
+    if (!read_lemma_cache(options_.kind_invariants_, ts_, bad_, lemmas)) {
+      logger.log(1,
+                 "KInduction: no usable invariants in {}",
+                 options_.kind_invariants_);
+    }
+    for (const auto & children : lemmas) {
+      Term lemma = children[0];
+      for (size_t j = 1; j < children.size(); ++j) {
+        lemma = solver_->make_term(Or, lemma, children[j]);
+      }
+      candidates_.push_back(lemma);
+      candidates_changed_ = true;
+    }
+  }
+
+  if (options_.kind_dual_solver_) {
+    // the worker only polls this prover's budget
+    PonoOptions wopts = options_;
+    wopts.kind_dual_solver_ = false;
+    wopts.time_limit_ = 0;
+    wopts.solver_call_limit_ = 0;
+    wopts.mem_limit_ = 0;
+
+    // constructed on this thread because it reads the terms of orig_ts_
+    SmtSolver s = create_solver_for(
+        solver_->get_solver_enum(), Engine::KIND, false);
+    step_worker_.reset(
+        new KInductionStepWorker(orig_property_, orig_ts_, s, wopts));
+    step_worker_->initialize();
+    if (orig_candidates_.size()) {
+      step_worker_->add_candidate_invariants(orig_candidates_);
+    }
+  }
 }
 
 ProverResult KInduction::check_until(int k)
 {
   initialize();
+  resume_checkpoint();
+
+  if (step_worker_) {
+    return check_until_dual(k);
+  }
 
   for (int i = reached_k_ + 1; i <= k; ++i) {
+    if (interrupted()) {
+      logger.log(1, "KInduction: interrupted at bound {}", i);
+      return ProverResult::UNKNOWN;
+    }
     logger.log(1, "Checking k-induction base case at bound: {}", i);
     if (!base_step(i)) {
       compute_witness();
       return ProverResult::FALSE;
     }
+    if (interrupted()) {
+      logger.log(1, "KInduction: interrupted at bound {}", i);
+      return ProverResult::UNKNOWN;
+    }
     logger.log(1, "Checking k-induction inductive step at bound: {}", i);
     if (inductive_step(i)) {
       return ProverResult::TRUE;
@@ -67,23 +163,132 @@ ProverResult KInduction::check_until(int k)
   return ProverResult::UNKNOWN;
 }
 
+void KInduction::add_candidate_invariants(const TermVec & candidates)
+{
+  if (options_.kind_dual_solver_) {
+    // the inductive steps are checked by the worker
+    orig_candidates_.insert(
+        orig_candidates_.end(), candidates.begin(), candidates.end());
+    if (step_worker_) {
+      step_worker_->add_candidate_invariants(candidates);
+    }
+    return;
+  }
+
+  for (const auto & c : candidates) {
+    candidates_.push_back(ts_.solver() == orig_ts_.solver()
+                              ? c
+                              : to_prover_solver_.transfer_term(c, BOOL));
+    candidates_changed_ = true;
+  }
+}
+
+ProverResult KInduction::check_until_dual(int k)
+{
+  assert(step_worker_);
+  int proven = step_proven_;
+  if (proven >= 0 && proven <= reached_k_) {
+    return ProverResult::TRUE;
+  }
+
+  stop_step_ = false;
+  std::thread step_thread(&KInduction::run_step_worker, this, k);
+
+  ProverResult res = ProverResult::UNKNOWN;
+  for (int i = reached_k_ + 1; i <= k; ++i) {
+    if (interrupted()) {
+      logger.log(1, "KInduction: interrupted at bound {}", i);
+      break;
+    }
+    logger.log(1, "Checking k-induction base case at bound: {}", i);
+    if (!base_step(i)) {
+      stop_step_ = true;
+      step_worker_->interrupt();
+      step_thread.join();
+      compute_witness();
+      return ProverResult::FALSE;
+    }
+    if (interrupted()) {
+      // the base case was not decided
+      break;
+    }
+    reached_k_ = i;
+    stats_->set("reached_k", reached_k_);
+
+    proven = step_proven_;
+    if (proven >= 0 && proven <= i) {
+      res = ProverResult::TRUE;
+      break;
+    }
+  }
+
+  if (res == ProverResult::UNKNOWN && reached_k_ == k) {
+    // all base cases passed, wait for the remaining steps
+    step_thread.join();
+    proven = step_proven_;
+    if (proven >= 0 && proven <= k) {
+      res = ProverResult::TRUE;
+    }
+  } else {
+    stop_step_ = true;
+    step_worker_->interrupt();
+    step_thread.join();
+  }
+  return res;
+}
+
+void KInduction::run_step_worker(int k)
+{
+  KInductionStepWorker & w = *step_worker_;
+  for (int i = w.reached_k() + 1; i <= k; ++i) {
+    if (stop_step_ || interrupted() || w.interrupted()) {
+      return;
+    }
+    logger.log(1, "Checking k-induction inductive step at bound: {}", i);
+    budget_.count_solver_call();
+    stats_->increment("check_sat_calls");
+    if (w.check_step(i)) {
+      step_proven_ = i;
+      return;
+    }
+    if (w.interrupted() && !stop_step_) {
+      // the worker's solver returned unknown
+      budget_.cancel("inductive step returned unknown at bound "
+                     + std::to_string(i));
+      return;
+    }
+  }
+}
+
 bool KInduction::base_step(int i)
 {
   if (i <= reached_k_) {
     return true;
   }
 
-  solver_->push();
-  solver_->assert_formula(init0_);
-  solver_->assert_formula(unroller_.at_time(bad_, i));
-  Result r = solver_->check_sat();
-  if (r.is_sat()) {
-    return false;
+  if (i <= shared_safe_bound()) {
+    // another engine already showed there is no counterexample
+    logger.log(2, "KInduction: skipping base case at bound {}", i);
+    stats_->increment("skipped_base_cases");
+  } else {
+    solver_->push();
+    solver_->assert_formula(init0_);
+    solver_->assert_formula(unroller_.at_time(bad_, i));
+    Result r = check_sat();
+    if (r.is_sat()) {
+      return false;
+    }
+    solver_->pop();
+    if (r.is_unknown()) {
+      // e.g. the query time limit was hit -- check_until stops
+      budget_.cancel("solver returned unknown at bound " + std::to_string(i));
+      return true;
+    }
+    publish_safe_bound(i);
   }
-  solver_->pop();
 
   const Term &prop = solver_->make_term(Not, bad_);
-  solver_->assert_formula(unroller_.at_time(ts_.trans(), i));
+  assert_trans_at(i);
   solver_->assert_formula(unroller_.at_time(prop, i));
 
   return true;
@@ -95,6 +300,8 @@ bool KInduction::inductive_step(int i)
     return false;
   }
 
+  add_shared_lemmas(i + 1);
+
   solver_->push();
   solver_->assert_formula(simple_path_);
   solver_->assert_formula(unroller_.at_time(bad_, i + 1));
@@ -106,10 +313,35 @@ bool KInduction::inductive_step(int i)
   solver_->pop();
 
   ++reached_k_;
+  stats_->set("reached_k", reached_k_);
+  checkpoint();
 
   return false;
 }
 
+bool KInduction::save_checkpoint_state(Checkpoint & cp) const
+{
+  return !options_.kind_dual_solver_;
+}
+
+bool KInduction::restore_checkpoint_state(const Checkpoint & cp)
+{
+  if (options_.kind_dual_solver_ || reached_k_ != -1) {
+    return false;
+  }
+
+  // the assertions of base_step(i) for the bounds that passed
+  Term prop = solver_->make_term(Not, bad_);
+  for (int i = 0; i <= cp.reached_k; ++i) {
+    assert_trans_at(i);
+    solver_->assert_formula(unroller_.at_time(prop, i));
+  }
+  reached_k_ = cp.reached_k;
+  stats_->set("reached_k", reached_k_);
+  publish_safe_bound(reached_k_);
+  return true;
+}
+
 Term KInduction::simple_path_constraint(int i, int j)
 {
   assert(ts_.statevars().size());
@@ -131,9 +363,17 @@ bool KInduction::check_simple_path_lazy(int i)
   bool added_to_simple_path = false;
 
   do {
-    Result r = solver_->check_sat();
+    Result r = check_sat();
     if (r.is_unsat()) {
       return true;
+    } else if (r.is_unknown()) {
+      budget_.cancel("solver returned unknown at bound " + std::to_string(i));
+      return false;
+    }
+
+    if (options_.kind_fingerprint_) {
+      added_to_simple_path = add_repeated_state_constraints(i);
+      continue;
     }
 
     added_to_simple_path = false;
@@ -157,4 +397,166 @@ bool KInduction::check_simple_path_lazy(int i)
   return false;
 }
 
+bool KInduction::add_repeated_state_constraints(int i, const Term & act)
+{
+  assert(ts_.statevars().size());
+
+  if (timed_statevars_.empty()) {
+    // any fixed order works, it just has to be the same at every time
+    TermVec svs(ts_.statevars().begin(), ts_.statevars().end());
+    timed_statevars_.push_back(svs);
+  }
+  while (timed_statevars_.size() <= static_cast<size_t>(i)) {
+    TermVec timed;
+    timed.reserve(timed_statevars_[0].size());
+    for (const auto & v : timed_statevars_[0]) {
+      timed.push_back(unroller_.at_time(v, timed_statevars_.size()));
+    }
+    timed_statevars_.push_back(timed);
+  }
+
+  // values are hash-consed in the solver, so equal values hash equally
+  std::vector<TermVec> values(i + 1);
+  std::unordered_map<size_t, std::vector<int>> fingerprints;
+  bool added = false;
+  for (int l = 0; l <= i; ++l) {
+    size_t fp = 0;
+    values[l].reserve(timed_statevars_[l].size());
+    for (const auto & v : timed_statevars_[l]) {
+      Term val = solver_->get_value(v);
+      fp ^= val->hash() + 0x9e3779b9 + (fp << 6) + (fp >> 2);
+      values[l].push_back(val);
+    }
+
+    std::vector<int> & same_fp = fingerprints[fp];
+    for (int j : same_fp) {
+      if (values[j] != values[l]) {
+        // hash collision
+        continue;
+      }
+
+      auto key = std::make_pair(j, l);
+      auto it = simple_path_constraints_.find(key);
+      if (it == simple_path_constraints_.end()) {
+        it = simple_path_constraints_
+                 .emplace(key, simple_path_constraint(j, l))
+                 .first;
+      }
+      logger.log(2, "Adding Simple Path Clause for {} and {}", j, l);
+      if (act) {
+        solver_->assert_formula(
+            solver_->make_term(PrimOp::Implies, act, it->second));
+      } else {
+        simple_path_ =
+            solver_->make_term(PrimOp::And, simple_path_, it->second);
+        solver_->assert_formula(it->second);
+      }
+      stats_->increment("simple_path_clauses");
+      added = true;
+    }
+    same_fp.push_back(l);
+  }
+  return added;
+}
+
+void KInduction::add_shared_lemmas(int i)
+{
+  if (!lemma_bus_ && candidates_.empty() && shared_lemmas_.empty()) {
+    return;
+  }
+
+  for (int t = shared_lemmas_time_ + 1; t <= i; ++t) {
+    for (const auto & l : shared_lemmas_) {
+      solver_->assert_formula(unroller_.at_time(l, t));
+    }
+  }
+  shared_lemmas_time_ = std::max(shared_lemmas_time_, i);
+
+  std::vector<TermVec> candidates;
+  import_lemmas(candidates);
+  for (const auto & children : candidates) {
+    Term lemma = children[0];
+    for (size_t j = 1; j < children.size(); ++j) {
+      lemma = solver_->make_term(Or, lemma, children[j]);
+    }
+
+    if (!ts_.only_curr(lemma) || !check_shared_lemma(lemma)) {
+      continue;
+    }
+
+    logger.log(2, "KInduction: using shared lemma {}", lemma);
+    stats_->increment("accepted_lemmas");
+    shared_lemmas_.push_back(lemma);
+    for (int t = 0; t <= shared_lemmas_time_; ++t) {
+      solver_->assert_formula(unroller_.at_time(lemma, t));
+    }
+    candidates_changed_ = true;
+  }
+
+  // rejected candidates can only pass once more lemmas are accepted
+  while (candidates_changed_) {
+    candidates_changed_ = false;
+    TermVec rejected;
+    for (const auto & c : candidates_) {
+      if (!ts_.only_curr(c)) {
+        continue;
+      }
+      if (!check_shared_lemma(c)) {
+        rejected.push_back(c);
+        continue;
+      }
+      logger.log(2, "KInduction: using candidate invariant {}", c);
+      stats_->increment("accepted_invariants");
+      shared_lemmas_.push_back(c);
+      for (int t = 0; t <= shared_lemmas_time_; ++t) {
+        solver_->assert_formula(unroller_.at_time(c, t));
+      }
+      candidates_changed_ = true;
+    }
+    candidates_ = rejected;
+  }
+}
+
+bool KInduction::check_shared_lemma(const Term & lemma)
+{
+  if (!lemma_checker_) {
+    lemma_checker_ = create_solver(solver_->get_solver_enum());
+    to_lemma_checker_.reset(new TermTranslator(lemma_checker_));
+    lemma_checker_ts_.reset(new TransitionSystem(ts_, *to_lemma_checker_));
+    lemma_checker_->assert_formula(lemma_checker_ts_->trans());
+    lemma_checker_->assert_formula(to_lemma_checker_->transfer_term(
+        solver_->make_term(Not, bad_), BOOL));
+  }
+
+  Term l = to_lemma_checker_->transfer_term(lemma, BOOL);
+  Term not_l = lemma_checker_->make_term(Not, l);
+
+  // init -> l
+  lemma_checker_->push();
+  lemma_checker_->assert_formula(lemma_checker_ts_->init());
+  lemma_checker_->assert_formula(not_l);
+  budget_.count_solver_call();
+  Result r = lemma_checker_->check_sat();
+  lemma_checker_->pop();
+  if (!r.is_unsat()) {
+    return false;
+  }
+
+  // l is preserved by trans from states satisfying prop
+  // and the accepted lemmas
+  lemma_checker_->push();
+  lemma_checker_->assert_formula(l);
+  lemma_checker_->assert_formula(lemma_checker_ts_->next(not_l));
+  budget_.count_solver_call();
+  r = lemma_checker_->check_sat();
+  lemma_checker_->pop();
+  if (!r.is_unsat()) {
+    return false;
+  }
+
+  // accepted lemmas strengthen the following checks
+  lemma_checker_->assert_formula(l);
+  return true;
+}
+
 }  // namespace pono
@@ -16,10 +16,18 @@
 
 #pragma once
 
+#include <atomic>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "engines/prover.h"
 
 namespace pono {
 
+class KInductionStepWorker;
+
 class KInduction : public Prover
 {
  public:
@@ -35,17 +43,90 @@ class KInduction : public Prover
 
   ProverResult check_until(int k) override;
 
+  /** Add candidate invariants, e.g. mined from simulation
+   *  They are used once they hold initially and are inductive relative
+   *  to the property and the invariants accepted so far. The ones that
+   *  are not are checked again whenever another invariant is accepted.
+   *  @param candidates terms over the current state variables of the
+   *         transition system passed to the constructor
+   */
+  void add_candidate_invariants(const smt::TermVec & candidates);
+
  protected:
   bool base_step(int i);
   bool inductive_step(int i);
 
+  /** check_until with options_.kind_dual_solver_
+   *  The base cases run on this thread in solver_ and the inductive steps
+   *  on another thread in the solver of step_worker_. A step proof at
+   *  bound j is only used once the base cases up to j passed.
+   */
+  ProverResult check_until_dual(int k);
+
+  /** Run the inductive steps of step_worker_ up to bound k
+   *  Stops at the first bound that is proven, or when stop_step_ is set.
+   */
+  void run_step_worker(int k);
+
   smt::Term simple_path_constraint(int i, int j);
   bool check_simple_path_lazy(int i);
 
+  /** Add the simple path constraints for all pairs of steps up to i that
+   *  are equal in the current model (see options_.kind_fingerprint_)
+   *  Equal steps are found by hashing the model values of each step.
+   *  @param i the last time step
+   *  @param act if given, the constraints are asserted under this
+   *         activation literal (and not added to simple_path_)
+   *  @return true iff some constraint was added
+   */
+  bool add_repeated_state_constraints(int i,
+                                      const smt::Term & act = smt::Term());
+
+  /** Import lemmas from the lemma bus and assert the ones that are
+   *  inductive relative to the property at times 0 to i
+   *  The candidate invariants are checked the same way.
+   *  Also extends the previously accepted lemmas up to time i.
+   *  @param i the last time step of the induction query
+   */
+  void add_shared_lemmas(int i);
+
+  /** Checks that a lemma over current state variables holds initially
+   *  and is inductive relative to the property and the lemmas accepted
+   *  so far. Uses a separate solver without the unrolling.
+   *  @param lemma the lemma to check
+   *  @return true iff the lemma can be used to strengthen the property
+   */
+  bool check_shared_lemma(const smt::Term & lemma);
+
+  // only the bound is saved, the simple path constraints and shared
+  // lemmas are found again (not supported with a dual solver)
+  bool save_checkpoint_state(Checkpoint & cp) const override;
+  bool restore_checkpoint_state(const Checkpoint & cp) override;
+
   smt::Term init0_;
   smt::Term false_;
   smt::Term simple_path_;
 
+  ///< with options_.kind_fingerprint_: the state variables at each time
+  ///< in a fixed order, and the constraints built per pair of times
+  std::vector<smt::TermVec> timed_statevars_;
+  std::map<std::pair<int, int>, smt::Term> simple_path_constraints_;
+
+  ///< with options_.kind_dual_solver_
+  std::unique_ptr<KInductionStepWorker> step_worker_;
+  std::atomic<int> step_proven_;  ///< bound of a step proof (-1 if none)
+  std::atomic<bool> stop_step_;   ///< tells run_step_worker to stop
+
+  smt::TermVec shared_lemmas_;  ///< accepted lemmas and invariants
+  smt::TermVec candidates_;     ///< candidate invariants not yet accepted
+  smt::TermVec orig_candidates_;  ///< as given, passed on to step_worker_
+  bool candidates_changed_;     ///< new candidates or accepted lemmas since
+                                ///< candidates_ were last checked
+  int shared_lemmas_time_;      ///< lemmas are asserted up to this time
+  smt::SmtSolver lemma_checker_;  ///< for checking lemmas from the bus
+  std::unique_ptr<smt::TermTranslator> to_lemma_checker_;
+  std::unique_ptr<TransitionSystem> lemma_checker_ts_;
+
 };  // class KInduction
 
 }  // namespace pono
@@ -0,0 +1,197 @@
+/*********************                                                        */
+/*! \file kliveness.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief k-liveness: proves that a signal holds only finitely often by
+**        checking with IC3 that it holds at most k times, for increasing
+**        k, and finds counterexamples as lassos with BMC.
+**
+**/
+
+#include "engines/kliveness.h"
+
+#include "assert.h"
+#include "smt/available_solvers.h"
+#include "utils/logger.h"
+#include "utils/make_provers.h"
+#include "utils/timeline.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+// the counter saturates far above any bound that is checked in practice
+static const size_t counter_width = 32;
+
+KLiveness::KLiveness(const Property & p,
+                     const TransitionSystem & ts,
+                     const SmtSolver & solver,
+                     PonoOptions opt)
+    : super(p, ts, solver, opt), live_k_(0), lasso_depth_(0)
+{
+  engine_ = Engine::KLIVE;
+}
+
+void KLiveness::initialize()
+{
+  if (initialized_) {
+    return;
+  }
+  super::initialize();
+
+  // absorbing counter of the occurrences of bad_
+  count_ts_ = ts_;
+  Sort sort = solver_->make_sort(BV, counter_width);
+  counter_ = count_ts_.make_statevar("__klive_counter", sort);
+  Term max = solver_->make_term(string(counter_width, '1'), sort, 2);
+  count_ts_.constrain_init(
+      solver_->make_term(Equal, counter_, solver_->make_term(0, sort)));
+  count_ts_.assign_next(
+      counter_,
+      solver_->make_term(
+          Ite,
+          solver_->make_term(
+              And, bad_, solver_->make_term(Distinct, counter_, max)),
+          solver_->make_term(BVAdd, counter_, solver_->make_term(1, sort)),
+          counter_));
+
+  PonoOptions ic3_opts = options_;
+  ic3_opts.engine_ = options_.klive_engine_;
+  SmtSolver s = create_solver_for(solver_->get_solver_enum(),
+                                  options_.klive_engine_,
+                                  options_.logging_smt_solver_);
+  Property prop(solver_, solver_->make_term(Not, counter_bad(live_k_)));
+  ic3_ = dynamic_pointer_cast<IC3Base>(
+      make_prover(options_.klive_engine_, prop, count_ts_, s, ic3_opts));
+  if (!ic3_) {
+    throw PonoException("k-liveness expects an IC3 variant, got "
+                        + to_string(options_.klive_engine_));
+  }
+
+  solver_->assert_formula(unroller_.at_time(ts_.init(), 0));
+}
+
+ProverResult KLiveness::check_until(int k)
+{
+  initialize();
+
+  while (live_k_ <= static_cast<size_t>(k)) {
+    if (interrupted()) {
+      logger.log(1, "KLiveness: interrupted at bound {}", live_k_);
+      return ProverResult::UNKNOWN;
+    }
+
+    // a real counterexample needs a loop, look for one of each length
+    // as the bound grows
+    if (lasso_depth_ <= k && find_lasso(lasso_depth_ + 1)) {
+      return ProverResult::FALSE;
+    }
+
+    ProverResult r;
+    {
+      TIMELINE_SPAN("klive_safety");
+      r = ic3_->check_until(k);
+    }
+    if (r == ProverResult::TRUE) {
+      logger.log(1,
+                 "KLiveness: the signal holds at most {} times on every path",
+                 live_k_);
+      return ProverResult::TRUE;
+    } else if (r != ProverResult::FALSE) {
+      break;
+    }
+
+    // the signal can hold live_k_ + 1 times, try the next bound with the
+    // same frames: its bad states are a subset of the current ones
+    ++live_k_;
+    stats_->set("klive_bound", live_k_);
+    logger.log(1, "KLiveness: trying bound {}", live_k_);
+    try {
+      ic3_->strengthen_ts(count_ts_, counter_bad(live_k_));
+    }
+    catch (PonoException & e) {
+      // e.g. the solver can't be reset, start over for this bound
+      logger.log(1, "KLiveness: restarting IC3, {}", e.what());
+      PonoOptions ic3_opts = options_;
+      ic3_opts.engine_ = options_.klive_engine_;
+      SmtSolver s = create_solver_for(solver_->get_solver_enum(),
+                                      options_.klive_engine_,
+                                      options_.logging_smt_solver_);
+      Property prop(solver_, solver_->make_term(Not, counter_bad(live_k_)));
+      ic3_ = static_pointer_cast<IC3Base>(
+          make_prover(options_.klive_engine_, prop, count_ts_, s, ic3_opts));
+      stats_->increment("klive_restarts");
+    }
+  }
+
+  // the longer lassos are cheap compared to the safety checks
+  while (lasso_depth_ <= k) {
+    if (interrupted()) {
+      return ProverResult::UNKNOWN;
+    }
+    if (find_lasso(lasso_depth_ + 1)) {
+      return ProverResult::FALSE;
+    }
+  }
+  return ProverResult::UNKNOWN;
+}
+
+bool KLiveness::find_lasso(int n)
+{
+  assert(n > 0);
+  TIMELINE_SPAN("klive_lasso");
+  while (lasso_depth_ < n) {
+    assert_trans_at(lasso_depth_++);
+  }
+
+  // the state after n steps is the state at some l < n, and bad_ holds
+  // in some state of the loop from l to n - 1
+  Term loops = solver_->make_term(false);
+  Term bad_in_loop = solver_->make_term(false);
+  for (int l = n - 1; l >= 0; --l) {
+    bad_in_loop =
+        solver_->make_term(Or, bad_in_loop, unroller_.at_time(bad_, l));
+    Term same = solver_->make_term(true);
+    for (const auto & sv : ts_.statevars()) {
+      same = solver_->make_term(And,
+                                same,
+                                solver_->make_term(Equal,
+                                                   unroller_.at_time(sv, l),
+                                                   unroller_.at_time(sv, n)));
+    }
+    loops = solver_->make_term(
+        Or, loops, solver_->make_term(And, same, bad_in_loop));
+  }
+
+  solver_->push();
+  solver_->assert_formula(loops);
+  Result r = check_sat();
+  stats_->increment("klive_lasso_checks");
+  bool found = r.is_sat();
+  if (found) {
+    logger.log(1, "KLiveness: found a lasso of {} steps", n);
+    reached_k_ = n - 1;
+    witness_.clear();
+    compute_witness();
+  } else {
+    reached_k_ = n;
+  }
+  solver_->pop();
+  return found;
+}
+
+Term KLiveness::counter_bad(size_t k) const
+{
+  return solver_->make_term(
+      BVUgt, counter_, solver_->make_term(k, counter_->get_sort()));
+}
+
+}  // namespace pono
@@ -0,0 +1,75 @@
+/*********************                                                        */
+/*! \file kliveness.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief k-liveness: proves that a signal holds only finitely often by
+**        checking with IC3 that it holds at most k times, for increasing
+**        k, and finds counterexamples as lassos with BMC.
+**
+**        The IC3 prover runs on the system with an absorbing counter of
+**        the occurrences of the signal. The property for k + 1 is weaker
+**        than the one for k, so the frames of IC3 stay valid and are kept
+**        across the values of k (see IC3Base::strengthen_ts).
+**
+**/
+
+#pragma once
+
+#include "engines/ic3base.h"
+#include "engines/prover.h"
+
+namespace pono {
+
+class KLiveness : public Prover
+{
+ public:
+  /** Checks the liveness property FG p.prop()
+   *  i.e. bad_ (the negation of p.prop(), e.g. the acceptance signal of
+   *  add_justice_monitor) holds only finitely often on every path.
+   *  The safety checks use options_.klive_engine_.
+   */
+  KLiveness(const Property & p,
+            const TransitionSystem & ts,
+            const smt::SmtSolver & solver,
+            PonoOptions opt = PonoOptions());
+
+  typedef Prover super;
+
+  void initialize() override;
+
+  /** Tries the bounds 0 to k on the number of occurrences of bad_ and
+   *  the lassos of up to k + 1 steps
+   *  @return TRUE if bad_ holds at most some bound times on every path,
+   *          FALSE if there is a lasso with bad_ in the loop (the witness
+   *          ends in the first state of the loop), UNKNOWN otherwise
+   */
+  ProverResult check_until(int k) override;
+
+  /** @return the current bound on the number of occurrences of bad_ */
+  size_t bound() const { return live_k_; }
+
+ protected:
+  /** Check for a path of n steps back to one of its states with bad_ in
+   *  the loop, on solver_ with the unrolling of ts_
+   *  If there is one, computes the witness.
+   */
+  bool find_lasso(int n);
+
+  /** @return the bad states of the counting system for bound k */
+  smt::Term counter_bad(size_t k) const;
+
+  TransitionSystem count_ts_;  ///< ts_ with the counter, over solver_
+  smt::Term counter_;          ///< occurrences of bad_ in the previous steps
+  std::shared_ptr<IC3Base> ic3_;  ///< safety checks, on its own solver
+  size_t live_k_;  ///< bound on the occurrences of bad_ checked next
+  int lasso_depth_;  ///< transitions asserted on solver_
+};
+
+}  // namespace pono
@@ -16,11 +16,13 @@
 #include "engines/mbic3.h"
 
 #include <algorithm>
+#include <chrono>
 #include <random>
 
 #include "smt-switch/utils.h"
 #include "smt/available_solvers.h"
 #include "utils/logger.h"
+#include "utils/solver_trace.h"
 
 using namespace smt;
 using namespace std;
@@ -96,7 +98,7 @@ IC3Formula ModelBasedIC3::get_model_ic3formula() const
     }
   }
 
-  return ic3formula_conjunction(cube_lits);
+  return ic3formula_conjunction(std::move(cube_lits));
 }
 
 bool ModelBasedIC3::ic3formula_check_valid(const IC3Formula & u) const
@@ -145,6 +147,7 @@ IC3Formula ModelBasedIC3::inductive_generalization(size_t i,
                                 ts_.trans(),
                                 solver_->make_term(Not, c.term) });
       formula = solver_->make_term(Or, formula, ts_.next(ts_.init()));
+      stats_->increment("reducer_unsat_cores");
       reducer_.reduce_assump_unsatcore(formula, lits, red_lits, NULL,
                                        options_.ic3_gen_max_iter_,
                                        options_.random_seed_);
@@ -157,24 +160,35 @@ IC3Formula ModelBasedIC3::inductive_generalization(size_t i,
     } else if (options_.mbic3_indgen_mode == 2) {
       // TODO: consider creating a separate derived class for this mode
       interpolator_->reset_assertions();
+      auto begin = chrono::steady_clock::now();
+      update_itp_ts();
 
       TermVec conjuncts;
       split_eq(solver_, c.children, conjuncts);
 
       // ( (frame /\ trans /\ not(c)) \/ init') /\ c' is unsat
-      Term formula = make_and({ get_frame_term(i - 1),
-                                ts_.trans(),
-                                solver_->make_term(Not, make_and(conjuncts)) });
-      formula = solver_->make_term(Or, formula, ts_.next(ts_.init()));
-
-      Term int_A = to_interpolator_->transfer_term(formula, BOOL);
+      // only the cube is transferred, trans, init and the lemmas of the
+      // frame are already in the interpolator
+      Term int_not_c = to_interpolator_->transfer_term(
+          solver_->make_term(Not, make_and(conjuncts)), BOOL);
+      Term int_A = interpolator_->make_term(
+          And, itp_frame_term(i - 1), itp_trans_);
+      int_A = interpolator_->make_term(And, int_A, int_not_c);
+      int_A = interpolator_->make_term(Or, int_A, itp_init_next_);
       // still use c in B
       // only split equalities in A to encourage more general unsat proofs /
       // interpolants
       Term int_B = to_interpolator_->transfer_term(ts_.next(c.term), BOOL);
+      stats_->add_time(
+          "mbic3_itp_transfer_time",
+          chrono::duration<double>(chrono::steady_clock::now() - begin)
+              .count());
+      stats_->increment("mbic3_itp_generalizations");
 
       Term interp;
+      SolverCallTimer timer(TRACE_GET_INTERPOLANT);
       Result r = interpolator_->get_interpolant(int_A, int_B, interp);
+      timer.done(r);
       assert(r.is_unsat());
       logger.log(3, "Got interpolant: {}", interp);
 
@@ -216,8 +230,10 @@ void ModelBasedIC3::predecessor_generalization(size_t i,
   // NOTE: for now this implementation doesn't use pred
   //       except to assign to it at the end
   //       need the model in a particular format
-  assert(solver_context_  == 1);  // shouldn't use solver, solving all in
-                                  // reducer_
+  // shouldn't use solver, solving all in reducer_
+  // (context 0 if rel_ind_check uses assumptions instead)
+  assert(solver_context_ == 1
+         || (options_.ic3_rel_ind_assumptions_ && !solver_context_));
   DisjointSet ds(disjoint_set_rank);
   UnorderedTermMap model;
   const UnorderedTermSet & statevars = ts_.statevars();
@@ -302,6 +318,7 @@ void ModelBasedIC3::predecessor_generalization(size_t i,
 
     TermVec splits, red_cube_lits, rem_cube_lits;
     split_eq(solver_, cube_lits, splits);
+    stats_->increment("reducer_unsat_cores");
     reducer_.reduce_assump_unsatcore(formula, splits, red_cube_lits,
                                      &rem_cube_lits,
                                      options_.ic3_gen_max_iter_,
@@ -311,7 +328,7 @@ void ModelBasedIC3::predecessor_generalization(size_t i,
     assert(red_cube_lits.size() > 0);
 
     // update pred to the generalization
-    pred = ic3formula_conjunction(red_cube_lits);
+    pred = ic3formula_conjunction(std::move(red_cube_lits));
 
   } else if (options_.ic3_pregen_ && options_.ic3_functional_preimage_) {
     assert(ts_.is_deterministic());
@@ -328,8 +345,49 @@ void ModelBasedIC3::predecessor_generalization(size_t i,
     Term fun_preimage = solver_->substitute(trans_label_, m);
     TermVec conjuncts;
     conjunctive_partition(fun_preimage, conjuncts, true);
-    pred = ic3formula_conjunction(conjuncts);
+    pred = ic3formula_conjunction(std::move(conjuncts));
+  }
+}
+
+void ModelBasedIC3::update_itp_ts()
+{
+  if (itp_src_trans_ == ts_.trans() && itp_src_init_ == ts_.init()
+      && itp_src_bad_ == bad_) {
+    return;
+  }
+  itp_src_trans_ = ts_.trans();
+  itp_src_init_ = ts_.init();
+  itp_src_bad_ = bad_;
+  itp_trans_ = to_interpolator_->transfer_term(ts_.trans(), BOOL);
+  itp_init_ = to_interpolator_->transfer_term(ts_.init(), BOOL);
+  itp_init_next_ = to_interpolator_->transfer_term(ts_.next(ts_.init()), BOOL);
+  itp_not_bad_ = to_interpolator_->transfer_term(smart_not(bad_), BOOL);
+  stats_->increment("mbic3_itp_ts_transfers");
+}
+
+Term ModelBasedIC3::itp_frame_term(size_t i)
+{
+  // same as get_frame_term, but in the interpolator
+  if (i == 0) {
+    return itp_init_;
+  }
+
+  Term res = itp_not_bad_;
+  for (size_t j = i; j <= frames_.size(); ++j) {
+    // the infinity frame comes last
+    const vector<IC3Formula> & Fj =
+        (j < frames_.size()) ? frames_[j] : inf_frame_;
+    for (const auto & u : Fj) {
+      auto it = itp_lemmas_.find(u.term);
+      if (it == itp_lemmas_.end()) {
+        Term l = to_interpolator_->transfer_term(u.term, BOOL);
+        it = itp_lemmas_.emplace(u.term, l).first;
+        stats_->increment("mbic3_itp_lemma_transfers");
+      }
+      res = interpolator_->make_term(And, res, it->second);
+    }
   }
+  return res;
 }
 
 void ModelBasedIC3::check_ts() const
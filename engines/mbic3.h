@@ -36,6 +36,27 @@ class ModelBasedIC3 : public IC3Base
   smt::SmtSolver interpolator_;
   std::unique_ptr<smt::TermTranslator> to_interpolator_;
   std::unique_ptr<smt::TermTranslator> to_solver_;
+  // the A side parts that don't depend on the cube, transferred to the
+  // interpolator once (again only if the system changes)
+  smt::Term itp_src_trans_;  ///< the ts_ terms the transferred ones are for
+  smt::Term itp_src_init_;
+  smt::Term itp_src_bad_;
+  smt::Term itp_trans_;
+  smt::Term itp_init_;
+  smt::Term itp_init_next_;
+  smt::Term itp_not_bad_;
+  ///< the lemmas of the frames in the interpolator, by their solver term
+  TermHashMap<smt::Term> itp_lemmas_;
+
+  /** Transfers the parts of the A side that don't depend on the cube
+   *  if ts_ changed since the last call
+   */
+  void update_itp_ts();
+
+  /** @return the term of frame i in the interpolator, built from the
+   *          transferred lemmas, only transferring new lemmas
+   */
+  smt::Term itp_frame_term(size_t i);
 
   // pure virtual method implementations
 
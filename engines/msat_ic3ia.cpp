@@ -17,6 +17,8 @@
 
 #include "engines/msat_ic3ia.h"
 
+#include <chrono>
+
 #include "assert.h"
 #include "smt-switch/msat_factory.h"
 #include "smt-switch/msat_solver.h"
@@ -32,11 +34,42 @@ namespace pono {
 
 MsatIC3IA::MsatIC3IA(const Property & p, const TransitionSystem & ts,
                      const SmtSolver & solver, PonoOptions opt)
-  : super(p, ts, solver, opt)
+  : super(p, ts, solver, opt), shared_env_(false)
 {
   engine_ = Engine::MSAT_IC3IA;
 }
 
+void MsatIC3IA::setup_backend_solver()
+{
+  if (msat_solver_) {
+    return;
+  }
+
+  if (options_.msat_ic3ia_share_env_) {
+    msat_solver_ = dynamic_pointer_cast<MsatSolver>(solver_);
+    shared_env_ = (bool)msat_solver_;
+    if (!shared_env_) {
+      logger.log(1,
+                 "MsatIC3IA: cannot share the environment of a wrapped "
+                 "solver, translating the system instead");
+    }
+  }
+
+  if (!shared_env_) {
+    // move everything over to a fresh solver
+    msat_solver_ = static_pointer_cast<MsatSolver>(
+        create_solver_for(MSAT, MSAT_IC3IA, false));
+    to_msat_solver_.reset(new TermTranslator(msat_solver_));
+    to_ts_solver_.reset(new TermTranslator(solver_));
+  }
+}
+
+msat_term MsatIC3IA::to_msat(const Term & t, SortKind sk)
+{
+  Term res = shared_env_ ? t : to_msat_solver_->transfer_term(t, sk);
+  return static_pointer_cast<MsatTerm>(res)->get_msat_term();
+}
+
 ProverResult MsatIC3IA::prove()
 {
   initialize();
@@ -45,59 +78,51 @@ ProverResult MsatIC3IA::prove()
     throw PonoException("MsatIC3IA only supports mathsat solver.");
   }
 
-  // move everything over to a fresh solver
-  shared_ptr<MsatSolver> msat_solver = static_pointer_cast<MsatSolver>(
-      create_solver_for(MSAT, MSAT_IC3IA, false));
-  msat_env env = msat_solver->get_msat_env();
+  auto begin = chrono::steady_clock::now();
+  setup_backend_solver();
+  msat_env env = msat_solver_->get_msat_env();
   ::ic3ia::TransitionSystem ic3ia_ts(env);
 
-  TermTranslator to_msat_solver(msat_solver);
-  TermTranslator to_ts_solver(solver_);
-
-  // give mapping between symbols
-  UnorderedTermMap & ts_solver_cache = to_ts_solver.get_cache();
-  for (const auto & v : ts_.statevars()) {
-    ts_solver_cache[to_msat_solver.transfer_term(v)] = v;
-    ts_solver_cache[to_msat_solver.transfer_term(ts_.next(v))] = ts_.next(v);
-  }
-  for (const auto & v : ts_.inputvars()) {
-    ts_solver_cache[to_msat_solver.transfer_term(v)] = v;
-  }
+  if (!shared_env_) {
+    // give mapping between symbols
+    // Note: the caches persist, only new symbols are translated
+    UnorderedTermMap & ts_solver_cache = to_ts_solver_->get_cache();
+    for (const auto & v : ts_.statevars()) {
+      ts_solver_cache[to_msat_solver_->transfer_term(v)] = v;
+      ts_solver_cache[to_msat_solver_->transfer_term(ts_.next(v))] =
+          ts_.next(v);
+    }
+    for (const auto & v : ts_.inputvars()) {
+      ts_solver_cache[to_msat_solver_->transfer_term(v)] = v;
+    }
 
-  // need to handle UFs also
-  UnorderedTermSet ufs;
-  auto is_uf = [](const Term & term) {
-    return term->get_sort()->get_sort_kind() == smt::FUNCTION;
-  };
-  get_matching_terms(ts_.init(), ufs, is_uf);
-  get_matching_terms(ts_.trans(), ufs, is_uf);
-  get_matching_terms(bad_, ufs, is_uf);
-
-  for (const auto &uf : ufs) {
-    assert(uf->get_sort()->get_sort_kind() == smt::FUNCTION);
-    ts_solver_cache[to_msat_solver.transfer_term(uf)] = uf;
+    // need to handle UFs also
+    UnorderedTermSet ufs;
+    auto is_uf = [](const Term & term) {
+      return term->get_sort()->get_sort_kind() == smt::FUNCTION;
+    };
+    get_matching_terms(ts_.init(), ufs, is_uf);
+    get_matching_terms(ts_.trans(), ufs, is_uf);
+    get_matching_terms(bad_, ufs, is_uf);
+
+    for (const auto &uf : ufs) {
+      assert(uf->get_sort()->get_sort_kind() == smt::FUNCTION);
+      ts_solver_cache[to_msat_solver_->transfer_term(uf)] = uf;
+    }
   }
 
   // get mathsat terms for transition system
-  msat_term msat_init = static_pointer_cast<MsatTerm>(
-                            to_msat_solver.transfer_term(ts_.init(), BOOL))
-                            ->get_msat_term();
-  msat_term msat_trans = static_pointer_cast<MsatTerm>(
-                             to_msat_solver.transfer_term(ts_.trans(), BOOL))
-                             ->get_msat_term();
-  msat_term msat_prop =
-      static_pointer_cast<MsatTerm>(
-          to_msat_solver.transfer_term(solver_->make_term(Not, bad_), BOOL))
-          ->get_msat_term();
+  msat_term msat_init = to_msat(ts_.init(), BOOL);
+  msat_term msat_trans = to_msat(ts_.trans(), BOOL);
+  msat_term msat_prop = to_msat(solver_->make_term(Not, bad_), BOOL);
   unordered_map<msat_term, msat_term> msat_statevars;
   for (const auto & sv : ts_.statevars()) {
-    msat_statevars[static_pointer_cast<MsatTerm>(
-                       to_msat_solver.transfer_term(sv))
-                       ->get_msat_term()] =
-        static_pointer_cast<MsatTerm>(
-            to_msat_solver.transfer_term(ts_.next(sv)))
-            ->get_msat_term();
+    SortKind sk = sv->get_sort()->get_sort_kind();
+    msat_statevars[to_msat(sv, sk)] = to_msat(ts_.next(sv), sk);
   }
+  stats_->add_time(
+      "msat_ic3ia_translation_time",
+      chrono::duration<double>(chrono::steady_clock::now() - begin).count());
   // initialize the transition system
   // NOTE: assuming not a liveprop
   ic3ia_ts.initialize(msat_statevars, msat_init, msat_trans, msat_prop, false);
@@ -129,10 +154,9 @@ ProverResult MsatIC3IA::prove()
       Term clause = solver_->make_term(false);
       assert(msat_clause.size());
       for (const msat_term & l : msat_clause) {
+        Term lit = make_shared<MsatTerm>(env, l);
         clause = solver_->make_term(
-            Or,
-            clause,
-            to_ts_solver.transfer_term(make_shared<MsatTerm>(env, l)));
+            Or, clause, shared_env_ ? lit : to_ts_solver_->transfer_term(lit));
       }
       invar_ = solver_->make_term(And, invar_, clause);
     }
@@ -140,7 +164,7 @@ ProverResult MsatIC3IA::prove()
     return ProverResult::TRUE;
   } else {
     assert(res == MSAT_FALSE);
-    compute_witness(env, ic3, to_ts_solver);
+    compute_witness(env, ic3, to_ts_solver_.get());
     return ProverResult::FALSE;
   }
 }
@@ -152,7 +176,7 @@ ProverResult MsatIC3IA::check_until(int k)
 
 bool MsatIC3IA::compute_witness(msat_env env,
                                 ic3ia::IC3 & ic3,
-                                TermTranslator & to_ts_solver)
+                                TermTranslator * to_ts_solver)
 {
   // compute the witness, guided by the one from ic3ia
   // ic3ia does not give assignments to inputs, which we require
@@ -185,7 +209,7 @@ bool MsatIC3IA::compute_witness(msat_env env,
     for (const auto &msat_eq : ic3ia_wit[i]) {
       // create an smt-switch term for the equality
       Term eq = make_shared<MsatTerm>(env, msat_eq);
-      Term solver_eq = to_ts_solver.transfer_term(eq);
+      Term solver_eq = to_ts_solver ? to_ts_solver->transfer_term(eq) : eq;
       // either a literal or an equality
       assert(is_lit(solver_eq, boolsort) || solver_eq->get_op() == Equal);
       solver_->assert_formula(unroller_.at_time(solver_eq, i));
@@ -17,8 +17,11 @@
 
 #pragma once
 
+#include <memory>
+
 #include "engines/prover.h"
 #include "ic3ia/ic3.h"
+#include "smt-switch/msat_solver.h"
 
 namespace pono {
 
@@ -47,12 +50,30 @@ class MsatIC3IA : public Prover
    *  @param ic3 the backend ic3ia engine that was used -- should have returned
    * false
    *  @param to_ts_solver a TermTranslator that moves terms from the fresh
-   * solver for ic3ia to terms of solver_
+   * solver for ic3ia to terms of solver_ (null if the environment is shared)
    *  @return true on sucess
    */
   bool compute_witness(msat_env env,
                        ic3ia::IC3 & ic3,
-                       smt::TermTranslator & to_ts_solver);
+                       smt::TermTranslator * to_ts_solver);
+
+  /** Creates the solver for the backend and the translators between it
+   *  and solver_, once. With --msat-ic3ia-share-env and a MathSAT
+   *  solver_, the backend works directly in the environment of solver_
+   *  and no translation is needed.
+   */
+  void setup_backend_solver();
+
+  /** @return the mathsat term for a term of solver_ */
+  msat_term to_msat(const smt::Term & t, smt::SortKind sk);
+
+  std::shared_ptr<smt::MsatSolver> msat_solver_;  ///< backend solver, is
+                                                  ///< solver_ if shared
+  bool shared_env_;  ///< true iff msat_solver_ is solver_
+  // persist across calls to prove, e.g. under CEGAR wrappers
+  // null if shared_env_
+  std::unique_ptr<smt::TermTranslator> to_msat_solver_;
+  std::unique_ptr<smt::TermTranslator> to_ts_solver_;
 };
 
 }  // namespace pono
@@ -0,0 +1,255 @@
+/*********************                                                        */
+/*! \file parallel_bmc.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Multithreaded bounded model checking.
+**        Distributes the bounds over several threads, each with its own
+**        solver instance holding an unrolling of the transition system.
+**
+**/
+
+#include "engines/parallel_bmc.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "engines/bmc.h"
+#include "smt/available_solvers.h"
+#include "utils/logger.h"
+#include "utils/thread_placement.h"
+#include "utils/timeline.h"
+#include "utils/ts_clone.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+/** A BMC unrolling in its own solver that checks single bounds
+ *  Only used by one thread at a time.
+ */
+class ParallelBmcWorker : public Bmc
+{
+ public:
+  ParallelBmcWorker(const Property & p,
+                    const TransitionSystem & ts,
+                    const SmtSolver & solver,
+                    PonoOptions opt)
+      : Bmc(p, ts, solver, opt), unrolled_(0)
+  {
+  }
+
+  /** Check whether bad is reachable in exactly i transitions
+   *  The transitions up to i are asserted permanently, so bounds
+   *  should be given in increasing order.
+   *  On a counterexample the witness is computed before returning.
+   */
+  Result check_bound(int i)
+  {
+    for (; unrolled_ < i; ++unrolled_) {
+      solver_->assert_formula(unroller_.at_time(ts_.trans(), unrolled_));
+    }
+
+    solver_->push();
+    solver_->assert_formula(unroller_.at_time(bad_, i));
+    Result r = check_sat();
+    if (r.is_sat()) {
+      reached_k_ = i - 1;
+      witness_.clear();
+      compute_witness();
+    }
+    solver_->pop();
+    return r;
+  }
+
+ private:
+  int unrolled_;  ///< the number of transitions asserted
+};
+
+ParallelBmc::ParallelBmc(const Property & p,
+                         const TransitionSystem & ts,
+                         const SmtSolver & solver,
+                         PonoOptions opt)
+    : super(p, ts, solver, opt),
+      first_bound_(0),
+      next_bound_(0),
+      cex_bound_(-1),
+      winner_(0)
+{
+  engine_ = Engine::BMC_PAR;
+}
+
+ParallelBmc::~ParallelBmc() {}
+
+void ParallelBmc::initialize()
+{
+  if (initialized_) {
+    return;
+  }
+
+  super::initialize();
+
+  size_t num_threads = num_worker_threads(options_, options_.bmc_threads_);
+
+  // the workers only poll this prover's budget
+  PonoOptions wopts = options_;
+  wopts.engine_ = Engine::BMC;
+  wopts.time_limit_ = 0;
+  wopts.solver_call_limit_ = 0;
+  wopts.mem_limit_ = 0;
+  wopts.bmc_assumptions_ = false;
+  wopts.bmc_step_size_ = 1;
+
+  // constructed on this thread because it reads the terms of orig_ts_
+  // the copies of the system are loaded concurrently if it fits in a
+  // snapshot, then the workers find its terms in their translators
+  SolverEnum se = solver_->get_solver_enum();
+  vector<SmtSolver> solvers;
+  for (size_t i = 0; i < num_threads; ++i) {
+    solvers.push_back(create_solver_for(se, Engine::BMC, false));
+  }
+  unique_ptr<TsCloner> cloner;
+  try {
+    cloner.reset(new TsCloner(orig_ts_, { orig_property_.prop() }));
+    // the memory of copy i is allocated where worker i runs
+    cloner->clone(
+        solvers, 0, [this](size_t t) { place_worker_thread(options_, t); });
+  }
+  catch (PonoException & e) {
+    logger.log(1, "Parallel BMC: copying the system serially: {}", e.what());
+  }
+  for (const auto & s : solvers) {
+    workers_.emplace_back(
+        new ParallelBmcWorker(orig_property_, orig_ts_, s, wopts));
+    workers_.back()->initialize();
+  }
+  stats_->set("threads", num_threads);
+  logger.log(1, "Parallel BMC: using {} threads", num_threads);
+}
+
+ProverResult ParallelBmc::check_until(int k)
+{
+  initialize();
+
+  if (cex_bound_ >= 0) {
+    return ProverResult::FALSE;
+  }
+
+  first_bound_ = reached_k_ + 1;
+  next_bound_ = first_bound_;
+  vector<thread> threads;
+  threads.reserve(workers_.size());
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    threads.push_back(thread(&ParallelBmc::run_worker, this, i, k));
+  }
+  for (auto & t : threads) {
+    t.join();
+  }
+
+  if (cex_bound_ >= 0) {
+    if (reached_k_ + 1 < cex_bound_) {
+      // a lower bound was not decided (e.g. interrupted)
+      logger.log(1,
+                 "Parallel BMC: counterexample at bound {} might not be the "
+                 "shortest",
+                 cex_bound_);
+    }
+    reached_k_ = cex_bound_ - 1;
+    stats_->set("cex_bound", cex_bound_);
+    return ProverResult::FALSE;
+  }
+
+  return ProverResult::UNKNOWN;
+}
+
+bool ParallelBmc::witness(vector<UnorderedTermMap> & out)
+{
+  if (cex_bound_ < 0) {
+    return super::witness(out);
+  }
+  return workers_[winner_]->witness(out);
+}
+
+void ParallelBmc::run_worker(size_t idx, int k)
+{
+  TIMELINE_SPAN("parallel_bmc_worker");
+  ParallelBmcWorker & w = *workers_[idx];
+  place_worker_thread(
+      options_, idx, stats_.get(), "worker_" + std::to_string(idx));
+  // deterministic: worker idx checks the bounds first_bound_ + idx modulo
+  // the number of workers, so the bounds a worker asserts do not depend
+  // on the timing of the others
+  int fixed_bound = first_bound_ + idx;
+  while (true) {
+    int i;
+    {
+      TimedLockGuard lock(mutex_, stats_.get());
+      if (interrupted()) {
+        return;
+      }
+      if (options_.deterministic_) {
+        i = fixed_bound;
+        fixed_bound += workers_.size();
+      } else {
+        i = next_bound_++;
+      }
+      if (i > k || (cex_bound_ >= 0 && i >= cex_bound_)) {
+        return;
+      }
+    }
+
+    logger.log(1, "Parallel BMC: worker {} checking bound: {}", idx, i);
+    budget_.count_solver_call();
+    stats_->increment("check_sat_calls");
+    auto begin = chrono::steady_clock::now();
+    Result r = w.check_bound(i);
+    stats_->add_time(
+        "check_sat_time",
+        chrono::duration<double>(chrono::steady_clock::now() - begin).count());
+
+    TimedLockGuard lock(mutex_, stats_.get());
+    if (r.is_sat()) {
+      if (cex_bound_ < 0 || i < cex_bound_) {
+        cex_bound_ = i;
+        winner_ = idx;
+      }
+      // this worker keeps its witness
+      return;
+    } else if (r.is_unknown()) {
+      budget_.cancel("solver returned unknown at bound " + std::to_string(i));
+      return;
+    }
+    bound_proven(i);
+  }
+}
+
+void ParallelBmc::bound_proven(int i)
+{
+  size_t j = i - (reached_k_ + 1);
+  if (j >= proven_.size()) {
+    proven_.resize(j + 1, false);
+  }
+  proven_[j] = true;
+
+  bool extended = false;
+  while (proven_.size() && proven_.front()) {
+    proven_.pop_front();
+    ++reached_k_;
+    extended = true;
+  }
+
+  if (extended) {
+    stats_->set("reached_k", reached_k_);
+    publish_safe_bound(reached_k_);
+  }
+}
+
+}  // namespace pono
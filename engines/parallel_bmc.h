@@ -0,0 +1,79 @@
+/*********************                                                        */
+/*! \file parallel_bmc.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Multithreaded bounded model checking.
+**        Distributes the bounds over several threads, each with its own
+**        solver instance holding an unrolling of the transition system.
+**        Bounds are handed out in increasing order, so the workers check
+**        neighboring bounds concurrently. The shortest counterexample is
+**        reported unless a lower bound was left undecided (interrupted).
+**        With --deterministic each worker checks a fixed residue class
+**        of the bounds instead, so the reported counterexample (and its
+**        witness) is the same in every run.
+**
+**/
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "engines/prover.h"
+
+namespace pono {
+
+class ParallelBmcWorker;
+
+class ParallelBmc : public Prover
+{
+ public:
+  ParallelBmc(const Property & p,
+              const TransitionSystem & ts,
+              const smt::SmtSolver & solver,
+              PonoOptions opt = PonoOptions());
+
+  ~ParallelBmc();
+
+  typedef Prover super;
+
+  void initialize() override;
+
+  ProverResult check_until(int k) override;
+
+  bool witness(std::vector<smt::UnorderedTermMap> & out) override;
+
+ protected:
+  /** Check bounds for worker idx until there are none left below k
+   *  or a shorter counterexample is known. Runs in its own thread.
+   */
+  void run_worker(size_t idx, int k);
+
+  /** Record that bound i has no counterexample and extend reached_k_
+   *  over the prefix of proven bounds. Requires holding mutex_.
+   */
+  void bound_proven(int i);
+
+  std::vector<std::unique_ptr<ParallelBmcWorker>> workers_;
+
+  int first_bound_;  ///< the first bound of the current check_until
+
+  std::mutex mutex_;  ///< protects all the members below
+  int next_bound_;    ///< the next bound to hand out
+  int cex_bound_;     ///< the shortest counterexample so far (-1 if none)
+  size_t winner_;     ///< the worker that found the counterexample
+  std::deque<bool> proven_;  ///< bounds above reached_k_ without a cex
+                             ///< proven_[j] is bound reached_k_ + 1 + j
+
+};  // class ParallelBmc
+
+}  // namespace pono
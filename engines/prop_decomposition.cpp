@@ -0,0 +1,366 @@
+/*********************                                                        */
+/*! \file prop_decomposition.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Checks a property that is a conjunction (bad states that are a
+**        disjunction) by checking each conjunct on its own cone of
+**        influence, in parallel.
+**
+**/
+
+#include "engines/prop_decomposition.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include "assert.h"
+#include "smt/available_solvers.h"
+#include "utils/logger.h"
+#include "utils/make_provers.h"
+#include "utils/thread_placement.h"
+#include "utils/timeline.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+/** @return true iff t is the bit-vector value 1 of width one */
+static bool is_bv_one(const Term & t)
+{
+  Sort sort = t->get_sort();
+  return t->is_value() && sort->get_sort_kind() == BV
+         && sort->get_width() == 1 && t->to_int() == 1;
+}
+
+/** @return the bit-vector of width one that t compares to 1, if any */
+static Term bv_one_arg(const Term & t)
+{
+  if (t->get_op() != Equal) {
+    return Term();
+  }
+  TermVec children(t->begin(), t->end());
+  if (children.size() != 2) {
+    return Term();
+  }
+  if (is_bv_one(children[1])) {
+    return children[0];
+  } else if (is_bv_one(children[0])) {
+    return children[1];
+  }
+  return Term();
+}
+
+TermVec decompose_property(const SmtSolver & solver, const Term & prop)
+{
+  Term true_ = solver->make_term(true);
+  Term bv_one = solver->make_term(1, solver->make_sort(BV, 1));
+
+  TermVec res;
+  UnorderedTermSet seen;
+  TermVec to_visit({ prop });
+  // children are pushed in reverse, so the conjuncts keep their order
+  auto push_all = [&](TermVec children) {
+    to_visit.insert(to_visit.end(), children.rbegin(), children.rend());
+  };
+  while (to_visit.size()) {
+    Term t = to_visit.back();
+    to_visit.pop_back();
+    if (t == true_ || !seen.insert(t).second) {
+      continue;
+    }
+
+    Op op = t->get_op();
+    TermVec children(t->begin(), t->end());
+    if (op == And) {
+      push_all(children);
+      continue;
+    }
+
+    if (op == Implies) {
+      // e.g. the reset guard around a conjunction
+      TermVec parts = decompose_property(solver, children[1]);
+      if (parts.size() > 1) {
+        for (auto & part : parts) {
+          part = solver->make_term(Implies, children[0], part);
+        }
+        push_all(parts);
+        continue;
+      }
+    }
+
+    // conjunctions of bit-vectors of width one
+    Term bv = bv_one_arg(t);
+    if (bv && bv->get_op() == BVAnd) {
+      TermVec parts;
+      for (const auto & c : *bv) {
+        parts.push_back(solver->make_term(Equal, c, bv_one));
+      }
+      push_all(parts);
+      continue;
+    }
+
+    if (op == Not) {
+      const Term & arg = children[0];
+      Op arg_op = arg->get_op();
+      if (arg_op == Not) {
+        push_all({ *arg->begin() });
+        continue;
+      } else if (arg_op == Or) {
+        TermVec parts;
+        for (const auto & c : *arg) {
+          parts.push_back(solver->make_term(Not, c));
+        }
+        push_all(parts);
+        continue;
+      }
+      // negated disjunctions of bit-vectors of width one (BTOR2 bad)
+      Term bv = bv_one_arg(arg);
+      if (bv && bv->get_op() == BVOr) {
+        TermVec parts;
+        for (const auto & c : *bv) {
+          parts.push_back(
+              solver->make_term(Not, solver->make_term(Equal, c, bv_one)));
+        }
+        push_all(parts);
+        continue;
+      }
+    }
+
+    res.push_back(t);
+  }
+  return res;
+}
+
+PropDecomposition::PropDecomposition(const Property & p,
+                                     const TransitionSystem & ts,
+                                     const SmtSolver & solver,
+                                     PonoOptions opt)
+    : super(p, ts, solver, opt)
+{
+  engine_ = options_.engine_;
+}
+
+void PropDecomposition::initialize()
+{
+  if (initialized_) {
+    return;
+  }
+  super::initialize();
+
+  sub_props_ = decompose_property(orig_ts_.solver(), orig_property_.prop());
+  sub_results_.assign(sub_props_.size(), ProverResult::UNKNOWN);
+  sub_assumptions_.assign(sub_props_.size(), 0);
+  sub_invars_.assign(sub_props_.size(), Term());
+  if (orig_ts_.is_functional()) {
+    coi_.reset(new IncrementalConeOfInfluence(orig_ts_));
+  }
+  stats_->set("sub_properties", sub_props_.size());
+  logger.log(1, "PropDecomposition: {} sub-properties", sub_props_.size());
+}
+
+ProverResult PropDecomposition::check_until(int k)
+{
+  initialize();
+
+  size_t num_threads =
+      num_worker_threads(options_, options_.decompose_threads_);
+
+  // each round checks the open sub-properties that gained assumptions
+  bool first_round = true;
+  while (true) {
+    if (interrupted()) {
+      return ProverResult::UNKNOWN;
+    }
+
+    // construct the provers on this thread, this is where the terms of
+    // the original system are read
+    vector<size_t> todo;
+    vector<TransitionSystem> systems;
+    vector<shared_ptr<Prover>> provers;
+    for (size_t idx = 0; idx < sub_props_.size(); ++idx) {
+      if (sub_results_[idx] != ProverResult::UNKNOWN) {
+        continue;
+      }
+      size_t num_assumptions;
+      TransitionSystem sub_ts = sub_system(idx, num_assumptions);
+      if (!first_round && num_assumptions == sub_assumptions_[idx]) {
+        // nothing new to assume
+        continue;
+      }
+      sub_assumptions_[idx] = num_assumptions;
+      todo.push_back(idx);
+      systems.push_back(sub_ts);
+    }
+    if (todo.empty()) {
+      break;
+    }
+    for (size_t i = 0; i < todo.size(); ++i) {
+      SmtSolver s = create_solver_for(solver_->get_solver_enum(),
+                                      options_.engine_,
+                                      options_.logging_smt_solver_);
+      Property sub_prop(orig_ts_.solver(), sub_props_[todo[i]]);
+      provers.push_back(
+          make_prover(options_.engine_, sub_prop, systems[i], s, options_));
+      logger.log(1,
+                 "PropDecomposition: sub-property {} with {} state variables "
+                 "and {} assumptions",
+                 todo[i],
+                 systems[i].statevars().size(),
+                 sub_assumptions_[todo[i]]);
+    }
+    first_round = false;
+    stats_->increment("sub_checks", todo.size());
+
+    // a false sub-property decides the property, stop the others
+    // deterministic: only the ones not started yet, the sub-properties
+    // are handed out in order so the first false one is always found
+    vector<ProverResult> results(todo.size(), ProverResult::UNKNOWN);
+    atomic<size_t> next(0);
+    mutex false_mutex;
+    bool found_false = false;
+    auto worker = [&]() {
+      size_t i;
+      while ((i = next++) < todo.size()) {
+        {
+          lock_guard<mutex> lock(false_mutex);
+          if (found_false) {
+            return;
+          }
+        }
+        ProverResult r = ProverResult::UNKNOWN;
+        try {
+          TIMELINE_SPAN("sub_property");
+          // HACK MSAT_IC3IA does not support check_until
+          r = (options_.engine_ == MSAT_IC3IA) ? provers[i]->prove()
+                                               : provers[i]->check_until(k);
+        }
+        catch (std::exception & e) {
+          logger.log(1,
+                     "PropDecomposition: sub-property {} failed with: {}",
+                     todo[i],
+                     e.what());
+        }
+        results[i] = r;
+        if (r == ProverResult::FALSE) {
+          lock_guard<mutex> lock(false_mutex);
+          found_false = true;
+          if (!options_.deterministic_) {
+            for (size_t j = 0; j < provers.size(); ++j) {
+              if (j != i) {
+                provers[j]->interrupt();
+              }
+            }
+          }
+        }
+      }
+    };
+    vector<thread> workers;
+    for (size_t t = 0; t < min(num_threads, todo.size()); ++t) {
+      workers.push_back(thread(worker));
+    }
+    for (auto & w : workers) {
+      w.join();
+    }
+
+    for (size_t i = 0; i < todo.size(); ++i) {
+      size_t idx = todo[i];
+      sub_results_[idx] = results[i];
+      logger.log(1,
+                 "PropDecomposition: sub-property {} returned {}",
+                 idx,
+                 to_string(results[i]));
+      if (results[i] == ProverResult::FALSE) {
+        // a violation of any conjunct violates the property
+        vector<UnorderedTermMap> cex;
+        if (provers[i]->witness(cex)) {
+          extend_witness(cex);
+        }
+        return ProverResult::FALSE;
+      } else if (results[i] == ProverResult::TRUE) {
+        try {
+          sub_invars_[idx] = provers[i]->invar();
+        }
+        catch (PonoException & e) {
+          // the engine doesn't support invariants
+        }
+      }
+    }
+  }
+
+  for (size_t idx = 0; idx < sub_props_.size(); ++idx) {
+    if (sub_results_[idx] != ProverResult::TRUE) {
+      return ProverResult::UNKNOWN;
+    }
+  }
+
+  // each invariant is inductive assuming conjuncts implied by the others
+  Term invar = solver_->make_term(true);
+  for (const auto & inv : sub_invars_) {
+    if (!inv) {
+      invar = Term();
+      break;
+    }
+    invar = solver_->make_term(
+        And, invar, to_prover_solver_.transfer_term(inv, BOOL));
+  }
+  invar_ = invar;
+  return ProverResult::TRUE;
+}
+
+void PropDecomposition::extend_witness(const vector<UnorderedTermMap> & cex)
+{
+  // the values of the cone determine a path of the whole system, which
+  // is free outside of it
+  solver_->push();
+  solver_->assert_formula(unroller_.at_time(ts_.init(), 0));
+  for (size_t i = 0; i < cex.size(); ++i) {
+    if (i + 1 < cex.size()) {
+      assert_trans_at(i);
+    }
+    for (const auto & elem : cex[i]) {
+      Term var = to_prover_solver_.transfer_term(elem.first);
+      Term val = to_prover_solver_.transfer_term(elem.second);
+      solver_->assert_formula(
+          solver_->make_term(Equal, unroller_.at_time(var, i), val));
+    }
+  }
+  Result r = check_sat();
+  if (!r.is_sat()) {
+    solver_->pop();
+    throw PonoException(
+        "PropDecomposition: the witness of a conjunct is not a path of the "
+        "system");
+  }
+  reached_k_ = static_cast<int>(cex.size()) - 2;
+  witness_.clear();
+  compute_witness();
+  solver_->pop();
+}
+
+TransitionSystem PropDecomposition::sub_system(size_t idx,
+                                               size_t & num_assumptions)
+{
+  TransitionSystem sub_ts =
+      coi_ ? coi_->reduced_ts({ sub_props_[idx] }) : orig_ts_;
+  num_assumptions = 0;
+  for (size_t j = 0; j < sub_props_.size(); ++j) {
+    if (j != idx && sub_results_[j] == ProverResult::TRUE
+        && sub_ts.only_curr(sub_props_[j])) {
+      sub_ts.add_invar(sub_props_[j]);
+      ++num_assumptions;
+    }
+  }
+  return sub_ts;
+}
+
+}  // namespace pono
@@ -0,0 +1,93 @@
+/*********************                                                        */
+/*! \file prop_decomposition.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Checks a property that is a conjunction (bad states that are a
+**        disjunction) by checking each conjunct on its own cone of
+**        influence, in parallel.
+**
+**        The conjuncts that are proven are added as invariants of the
+**        systems of the others, which are checked again if that gives
+**        them new assumptions. This is sound because the proven
+**        conjuncts only depend on the ones proven before them.
+**
+**/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "engines/prover.h"
+#include "utils/incremental_coi.h"
+
+namespace pono {
+
+/** @return the conjuncts of prop, splitting conjunctions, negated
+ *          disjunctions (also of bit-vectors of width one, as in BTOR2
+ *          bad states) and implications with a conjunction on the right
+ *          e.g. the reset guard, without duplicates or true
+ */
+smt::TermVec decompose_property(const smt::SmtSolver & solver,
+                                const smt::Term & prop);
+
+class PropDecomposition : public Prover
+{
+ public:
+  /** The conjuncts are checked with options_.engine_, by
+   *  options_.decompose_threads_ threads (all the cores if 0)
+   */
+  PropDecomposition(const Property & p,
+                    const TransitionSystem & ts,
+                    const smt::SmtSolver & solver,
+                    PonoOptions opt = PonoOptions());
+
+  typedef Prover super;
+
+  void initialize() override;
+
+  /** @return FALSE with the witness of a false conjunct, TRUE if all
+   *          are true (the invariant is the conjunction of their
+   *          invariants if the engine supports them), UNKNOWN otherwise
+   */
+  ProverResult check_until(int k) override;
+
+  /** @return the conjuncts, over the original system */
+  const smt::TermVec & sub_properties() const { return sub_props_; }
+
+  /** @return the result of each conjunct */
+  const std::vector<ProverResult> & sub_results() const
+  {
+    return sub_results_;
+  }
+
+ protected:
+  /** @return the system of conjunct idx: its cone of influence (for
+   *          functional systems) with the proven conjuncts over its
+   *          variables as invariants
+   *  @param num_assumptions set to the number of these conjuncts
+   */
+  TransitionSystem sub_system(size_t idx, size_t & num_assumptions);
+
+  /** Sets witness_ to a path of ts_ that agrees with cex, the witness of
+   *  a conjunct over the original solver, on the variables of its cone
+   */
+  void extend_witness(const std::vector<smt::UnorderedTermMap> & cex);
+
+  // cones of the conjuncts, null for relational systems
+  std::unique_ptr<IncrementalConeOfInfluence> coi_;
+  smt::TermVec sub_props_;  ///< conjuncts of the original property
+  std::vector<ProverResult> sub_results_;
+  // number of assumptions in the last check of each conjunct
+  std::vector<size_t> sub_assumptions_;
+  std::vector<smt::Term> sub_invars_;  ///< null if not proven or unsupported
+};
+
+}  // namespace pono
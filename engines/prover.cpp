@@ -17,13 +17,19 @@
 #include "engines/prover.h"
 
 #include <cassert>
+#include <chrono>
 #include <climits>
 #include <functional>
 
 #include "core/rts.h"
 #include "modifiers/static_coi.h"
+#include "smt-switch/utils.h"
 #include "smt/available_solvers.h"
+#include "utils/event_stream.h"
+#include "utils/lemma_cache.h"
 #include "utils/logger.h"
+#include "utils/solver_trace.h"
+#include "utils/ts_clone.h"
 
 using namespace smt;
 using namespace std;
@@ -36,7 +42,7 @@ Prover::Prover(const Property & p,
                PonoOptions opt)
     : initialized_(false),
       solver_(s),
-      to_prover_solver_(s),
+      to_prover_solver_(make_translator(ts, s)),
       orig_property_(p),
       orig_ts_(ts),
       ts_(ts, to_prover_solver_),
@@ -47,12 +53,36 @@ Prover::Prover(const Property & p,
               ? orig_property_.prop()
               : to_prover_solver_.transfer_term(orig_property_.prop(), BOOL))),
       options_(opt),
-      engine_(Engine::NONE)
+      engine_(Engine::NONE),
+      stats_(new Statistics()),
+      num_imported_lemmas_(0),
+      num_imported_frame_lemmas_(0)
 {
+  budget_.set_time_limit(options_.time_limit_);
+  budget_.set_solver_call_limit(options_.solver_call_limit_);
+  budget_.set_memory_limit(options_.mem_limit_);
+  budget_.set_soft_memory_limit(options_.soft_mem_limit_);
+  set_query_limits(solver_);
 }
 
 Prover::~Prover() {}
 
+bool Prover::set_query_limits(const SmtSolver & s, size_t scale) const
+{
+  bool limited = false;
+  bool supported = true;
+  if (options_.query_time_limit_) {
+    limited = true;
+    supported &= set_query_time_limit(s, scale * options_.query_time_limit_);
+  }
+  if (options_.query_resource_limit_) {
+    limited = true;
+    supported &=
+        set_query_resource_limit(s, scale * options_.query_resource_limit_);
+  }
+  return limited && supported;
+}
+
 void Prover::initialize()
 {
   if (initialized_) {
@@ -65,9 +95,250 @@ void Prover::initialize()
     throw PonoException("Property should not contain inputs or next state variables");
   }
 
+  statistics_registry.add(to_string(engine_), stats_);
+  last_checkpoint_ = chrono::steady_clock::now();
+
   initialized_ = true;
 }
 
+void Prover::checkpoint(bool force)
+{
+  // the bound of every engine, e.g. for the metrics file
+  stats_->set("reached_k", reached_k_);
+  manage_memory();
+  report_progress();
+
+  if (options_.checkpoint_.empty()) {
+    return;
+  }
+  auto now = chrono::steady_clock::now();
+  if (!force
+      && now - last_checkpoint_
+             < chrono::seconds(options_.checkpoint_interval_)) {
+    return;
+  }
+  last_checkpoint_ = now;
+
+  Checkpoint cp;
+  cp.engine = to_string(engine_);
+  cp.reached_k = reached_k_;
+  if (!save_checkpoint_state(cp)) {
+    return;
+  }
+  if (!write_checkpoint(options_.checkpoint_, ts_, bad_, cp)) {
+    logger.log(1,
+               "Checkpoint: state of bound {} cannot be written",
+               reached_k_);
+    return;
+  }
+  stats_->increment("checkpoints");
+  logger.log(1,
+             "Checkpoint: saved bound {} to {}",
+             reached_k_,
+             options_.checkpoint_);
+}
+
+void Prover::report_progress() const
+{
+  if (!event_stream.enabled()) {
+    return;
+  }
+  JsonEvent e("progress");
+  e.add_string("engine", to_string(engine_))
+      .add_int("bound", reached_k_)
+      .add_int("frames", stats_->get("frames"))
+      .add_int("refinements",
+               stats_->get("cegar_refinements") + stats_->get("refinements"))
+      .add_int("lemmas", stats_->get("lemmas"))
+      .add_int("solver_calls", budget_.num_solver_calls());
+  event_stream.emit(e);
+}
+
+void Prover::manage_memory()
+{
+  if (budget_.over_soft_memory_limit()) {
+    size_t before_kb = current_memory_kb();
+    reduce_memory();
+    stats_->increment("soft_memory_reductions");
+    logger.log(1,
+               "Soft memory limit of {}MB exceeded at {}MB, dropped the "
+               "caches",
+               options_.soft_mem_limit_,
+               before_kb / 1024);
+  }
+  if (statistics_registry.enabled()) {
+    report_memory();
+  }
+}
+
+void Prover::report_memory()
+{
+  unroller_.report_statistics(*stats_);
+  stats_->set("rss_kb", current_memory_kb());
+}
+
+void Prover::reduce_memory() { unroller_.clear_term_caches(); }
+
+bool Prover::resume_checkpoint()
+{
+  if (!options_.resume_ || options_.checkpoint_.empty()) {
+    return false;
+  }
+
+  Checkpoint cp;
+  if (!read_checkpoint(options_.checkpoint_, ts_, bad_, cp)
+      || cp.engine != to_string(engine_)) {
+    logger.log(0,
+               "Checkpoint: {} was not saved by {} for this system, "
+               "starting over",
+               options_.checkpoint_,
+               to_string(engine_));
+    return false;
+  }
+  if (cp.reached_k <= reached_k_ || !restore_checkpoint_state(cp)) {
+    return false;
+  }
+  assert(reached_k_ == cp.reached_k);
+  stats_->set("resumed_bound", reached_k_);
+  logger.log(0, "Checkpoint: resumed {} at bound {}", cp.engine, reached_k_);
+  return true;
+}
+
+bool Prover::save_checkpoint_state(Checkpoint & cp) const { return false; }
+
+bool Prover::restore_checkpoint_state(const Checkpoint & cp) { return false; }
+
+Result Prover::check_sat()
+{
+  budget_.count_solver_call();
+  auto begin = chrono::steady_clock::now();
+  SolverCallTimer timer(TRACE_CHECK_SAT);
+  Result r = solver_->check_sat();
+  timer.done(r);
+  stats_->add_time(
+      "check_sat_time",
+      chrono::duration<double>(chrono::steady_clock::now() - begin).count());
+  stats_->increment("check_sat_calls");
+  return r;
+}
+
+Result Prover::check_sat_assuming(const TermVec & assumps)
+{
+  budget_.count_solver_call();
+  auto begin = chrono::steady_clock::now();
+  SolverCallTimer timer(TRACE_CHECK_SAT_ASSUMING, assumps.size());
+  Result r = solver_->check_sat_assuming(assumps);
+  timer.done(r);
+  stats_->add_time(
+      "check_sat_assuming_time",
+      chrono::duration<double>(chrono::steady_clock::now() - begin).count());
+  stats_->increment("check_sat_assuming_calls");
+  return r;
+}
+
+void Prover::assert_trans_at(int k)
+{
+  for (const auto & c : ts_.trans_conjuncts()) {
+    solver_->assert_formula(unroller_.at_time(c, k));
+  }
+}
+
+void Prover::set_lemma_bus(const shared_ptr<LemmaBus> & bus)
+{
+  if (initialized_) {
+    throw PonoException("Lemma bus must be set before initialization");
+  }
+  if (bus->solver() != orig_ts_.solver()) {
+    throw PonoException(
+        "Lemma bus must use the solver of the original transition system");
+  }
+  if (solver_ == orig_ts_.solver()) {
+    throw PonoException(
+        "Lemma bus can only be used by provers with their own solver");
+  }
+
+  lemma_bus_ = bus;
+  lemma_bus_->register_source(this);
+  to_lemma_bus_.reset(new TermTranslator(bus->solver()));
+  UnorderedTermMap & cache = to_lemma_bus_->get_cache();
+  for (const auto & v : orig_ts_.statevars()) {
+    cache[to_prover_solver_.transfer_term(v)] = v;
+  }
+}
+
+void Prover::set_refinement_cache(const shared_ptr<RefinementCache> & cache)
+{
+  if (initialized_) {
+    throw PonoException("Refinement cache must be set before initialization");
+  }
+  if (cache->solver() != orig_ts_.solver()) {
+    throw PonoException(
+        "Refinement cache must use the solver of the original transition "
+        "system");
+  }
+  refinement_cache_ = cache;
+}
+
+void Prover::publish_lemma(const TermVec & children, int frame)
+{
+  if (!lemma_bus_) {
+    return;
+  }
+
+  // only share clauses over the original state variables
+  // anything else (e.g. abstraction variables) means nothing to others
+  const UnorderedTermMap & cache = to_lemma_bus_->get_cache();
+  UnorderedTermSet free_vars;
+  for (const auto & c : children) {
+    get_free_symbolic_consts(c, free_vars);
+  }
+  for (const auto & v : free_vars) {
+    if (cache.find(v) == cache.end()) {
+      return;
+    }
+  }
+
+  lemma_bus_->publish_lemma(
+      children, *to_lemma_bus_, this, stats_.get(), frame);
+  stats_->increment("published_lemmas");
+}
+
+void Prover::import_lemmas(vector<TermVec> & out)
+{
+  if (!lemma_bus_) {
+    return;
+  }
+  size_t prev = out.size();
+  lemma_bus_->import_lemmas(
+      num_imported_lemmas_, to_prover_solver_, this, out, stats_.get());
+  stats_->increment("imported_lemmas", out.size() - prev);
+}
+
+void Prover::import_frame_lemmas(vector<TermVec> & out, vector<int> & frames)
+{
+  if (!lemma_bus_) {
+    return;
+  }
+  lemma_bus_->import_frame_lemmas(num_imported_frame_lemmas_,
+                                  to_prover_solver_,
+                                  this,
+                                  out,
+                                  frames,
+                                  stats_.get());
+}
+
+void Prover::publish_safe_bound(int k)
+{
+  if (lemma_bus_) {
+    lemma_bus_->publish_safe_bound(k);
+  }
+}
+
+int Prover::shared_safe_bound() const
+{
+  return lemma_bus_ ? lemma_bus_->safe_bound() : -1;
+}
+
 ProverResult Prover::prove()
 {
   return check_until(INT_MAX);
@@ -107,23 +378,31 @@ bool Prover::witness(std::vector<UnorderedTermMap> & out)
   }
 
   bool success = true;
+  // the witness options leave some values out on purpose
+  const bool filtered = options_.filtered_witness();
 
   // Some backends don't support full witnesses
   // it will still populate state variables, but will return false instead of
   // true
-  for (auto wit_map : witness_) {
+  for (const auto & wit_map : witness_) {
     out.push_back(UnorderedTermMap());
     UnorderedTermMap & map = out.back();
 
     for (const auto &v : orig_ts_.statevars()) {
       const SortKind &sk = v->get_sort()->get_sort_kind();
       const Term &pv = transfer_to_prover_as(v, sk);
+      if (filtered && wit_map.find(pv) == wit_map.end()) {
+        continue;
+      }
       map[v] = transfer_to_orig_ts_as(wit_map.at(pv), sk);
     }
 
     for (const auto &v : orig_ts_.inputvars()) {
       const SortKind &sk = v->get_sort()->get_sort_kind();
       const Term &pv = transfer_to_prover_as(v, sk);
+      if (filtered && wit_map.find(pv) == wit_map.end()) {
+        continue;
+      }
       try {
         map[v] = transfer_to_orig_ts_as(wit_map.at(pv), sk);
       }
@@ -137,6 +416,9 @@ bool Prover::witness(std::vector<UnorderedTermMap> & out)
       for (const auto &elem : orig_ts_.named_terms()) {
         const SortKind &sk = elem.second->get_sort()->get_sort_kind();
         const Term &pt = transfer_to_prover_as(elem.second, sk);
+        if (filtered && wit_map.find(pt) == wit_map.end()) {
+          continue;
+        }
         try {
           map[elem.second] = transfer_to_orig_ts_as(wit_map.at(pt), sk);
         }
@@ -169,19 +451,28 @@ Term Prover::to_orig_ts(Term t, SortKind sk)
     // don't need to transfer terms if the solvers are the same
     return t;
   } else {
-    // need to add symbols to cache
-    TermTranslator to_orig_ts_solver(orig_ts_.solver());
-    UnorderedTermMap & cache = to_orig_ts_solver.get_cache();
-    for (const auto &v : orig_ts_.statevars()) {
-      cache[to_prover_solver_.transfer_term(v)] = v;
-      const Term &nv = orig_ts_.next(v);
-      cache[to_prover_solver_.transfer_term(nv)] = v;
-    }
-    for (const auto &v : orig_ts_.inputvars()) {
-      cache[to_prover_solver_.transfer_term(v)] = v;
+    if (!to_orig_ts_solver_) {
+      // need to add symbols to cache
+      // the translator is kept so that terms shared between calls
+      // (e.g. the frames of an invariant) are only translated once
+      to_orig_ts_solver_.reset(new TermTranslator(orig_ts_.solver()));
+      UnorderedTermMap & cache = to_orig_ts_solver_->get_cache();
+      for (const auto &v : orig_ts_.statevars()) {
+        cache[to_prover_solver_.transfer_term(v)] = v;
+        const Term &nv = orig_ts_.next(v);
+        cache[to_prover_solver_.transfer_term(nv)] = v;
+      }
+      for (const auto &v : orig_ts_.inputvars()) {
+        cache[to_prover_solver_.transfer_term(v)] = v;
+      }
     }
     // TODO: need a to add UFs to the cache also
-    return to_orig_ts_solver.transfer_term(t, sk);
+    auto begin = chrono::steady_clock::now();
+    Term res = to_orig_ts_solver_->transfer_term(t, sk);
+    stats_->add_time(
+        "to_orig_ts_time",
+        chrono::duration<double>(chrono::steady_clock::now() - begin).count());
+    return res;
   }
 }
 
@@ -194,29 +485,80 @@ bool Prover::compute_witness()
 {
   // TODO: make sure the solver state is SAT
 
+  // only query the solver for the requested terms (see the witness options)
+  TermVec states, inputs, named;
+  for (const auto & v : ts_.statevars()) {
+    if (witness_signal(v->to_string())) {
+      states.push_back(v);
+    }
+  }
+  for (const auto & v : ts_.inputvars()) {
+    if (witness_signal(v->to_string())) {
+      inputs.push_back(v);
+    }
+  }
+  if (!options_.witness_inputs_only_) {
+    for (const auto & elem : ts_.named_terms()) {
+      if (witness_signal(elem.first)) {
+        named.push_back(elem.second);
+      }
+    }
+  }
+
   for (int i = 0; i <= reached_k_ + 1; ++i) {
     witness_.push_back(UnorderedTermMap());
     UnorderedTermMap & map = witness_.back();
+    if (!witness_step(i)) {
+      continue;
+    }
 
-    for (const auto &v : ts_.statevars()) {
-      const Term &vi = unroller_.at_time(v, i);
-      const Term &r = solver_->get_value(vi);
-      map[v] = r;
+    if (!options_.witness_inputs_only_ || !i) {
+      for (const auto & v : states) {
+        const Term & vi = unroller_.at_time(v, i);
+        map[v] = solver_->get_value(vi);
+      }
     }
 
-    for (const auto &v : ts_.inputvars()) {
-      const Term &vi = unroller_.at_time(v, i);
-      const Term &r = solver_->get_value(vi);
-      map[v] = r;
+    for (const auto & v : inputs) {
+      const Term & vi = unroller_.at_time(v, i);
+      map[v] = solver_->get_value(vi);
     }
 
-    for (const auto &elem : ts_.named_terms()) {
-      const Term &ti = unroller_.at_time(elem.second, i);
-      map[elem.second] = solver_->get_value(ti);
+    for (const auto & t : named) {
+      const Term & ti = unroller_.at_time(t, i);
+      map[t] = solver_->get_value(ti);
     }
   }
 
   return true;
 }
 
+bool Prover::witness_step(int i) const
+{
+  return i >= options_.witness_first_step_
+         && (options_.witness_last_step_ < 0
+             || i <= options_.witness_last_step_);
+}
+
+bool Prover::witness_signal(const std::string & name) const
+{
+  const std::string & globs = options_.witness_signals_;
+  if (globs.empty()) {
+    return true;
+  }
+  size_t start = 0;
+  while (start <= globs.size()) {
+    size_t end = globs.find(',', start);
+    if (end == std::string::npos) {
+      end = globs.size();
+    }
+    std::string glob = globs.substr(start, end - start);
+    if (!glob.empty() && fnmatch(glob.c_str(), name.c_str(), 0) == 0) {
+      return true;
+    }
+    start = end + 1;
+  }
+  return false;
+}
+
 }  // namespace pono
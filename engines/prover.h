@@ -16,15 +16,23 @@
 
 #pragma once
 
+#include <chrono>
+
 #include "core/prop.h"
 #include "core/proverresult.h"
 #include "core/ts.h"
 #include "core/unroller.h"
 #include "options/options.h"
 #include "smt-switch/smt.h"
+#include "utils/budget.h"
+#include "utils/lemma_bus.h"
+#include "utils/refinement_cache.h"
+#include "utils/statistics.h"
 
 namespace pono {
 
+struct Checkpoint;
+
 /** enum for communicating result of a refinement step
  *  only used for algorithms that use abstraction refinement
  */
@@ -66,6 +74,48 @@ class Prover
    */
   smt::Term invar();
 
+  /** Request that a running check_until stops as soon as possible
+   *  Safe to call from a different thread than the one running the engine.
+   *  Engines poll interrupted() between solver queries and return UNKNOWN
+   *  once it is set. A single long-running solver query is only aborted
+   *  if the solver supports a per-query time limit (see --query-time-limit).
+   */
+  void interrupt() { budget_.cancel(); }
+
+  /** @return true iff interrupt() has been called on this prover
+   *          or its resource budget is exhausted
+   */
+  bool interrupted() { return budget_.exhausted(); }
+
+  /** The resource budget of this prover, configured from the options
+   *  on construction. Also holds the number of solver calls so far.
+   */
+  Budget & budget() { return budget_; }
+
+  /** The statistics filled in by this prover
+   *  Added to the global statistics_registry on initialization.
+   */
+  const Statistics & statistics() const { return *stats_; }
+  Statistics & statistics() { return *stats_; }
+
+  /** Share lemmas and bounds with other provers through a bus
+   *  Must be called before initialize. The bus solver must be the solver
+   *  of the transition system passed to the constructor, and the prover
+   *  must use a different solver.
+   *  @param bus the bus to publish to and import from
+   */
+  void set_lemma_bus(const std::shared_ptr<LemmaBus> & bus);
+
+  /** Share learned refinements with the provers of other properties
+   *  of the same design. Only used by CEGAR engines that support it
+   *  (currently CegProphecyArrays, and SygusPdr for the operator terms of
+   *  its operator abstraction), ignored by the others.
+   *  Must be called before initialize. The cache solver must be the
+   *  solver of the transition system passed to the constructor.
+   *  @param cache the cache to seed the abstraction from and export to
+   */
+  void set_refinement_cache(const std::shared_ptr<RefinementCache> & cache);
+
  protected:
   /** Take a term from the Prover's solver
    *  to the original transition system's solver
@@ -93,6 +143,14 @@ class Prover
    */
   bool compute_witness();
 
+  /** @return true iff step i is in the witness steps of the options */
+  bool witness_step(int i) const;
+
+  /** @return true iff the name matches the witness signals of the options
+   *          (always true if there are none)
+   */
+  bool witness_signal(const std::string & name) const;
+
   /** Returns the reference of the interface ts, which is a copy of orig_ts but
    *  built using solver_. By default, the method returns a reference to ts_.
    *  The derived classes may be based on abstraction-refinement methods (e.g.
@@ -100,6 +158,119 @@ class Prover
    */
   virtual TransitionSystem & prover_interface_ts() { return ts_; };
 
+  /** Calls check_sat on solver_, counts the call against the budget
+   *  and records the number of calls and the time in the statistics
+   */
+  smt::Result check_sat();
+
+  /** Calls check_sat_assuming on solver_, counts the call against the
+   *  budget and records the number of calls and the time in the statistics
+   */
+  smt::Result check_sat_assuming(const smt::TermVec & assumps);
+
+  /** Assert the conjuncts of the transition relation at time k
+   *  one by one rather than as a single conjunction
+   *  @param k the time step
+   */
+  void assert_trans_at(int k);
+
+  /** Publish a clause over current state variables to the lemma bus
+   *  Does nothing if there is no bus or the clause contains symbols that
+   *  are not state variables of the original transition system.
+   *  @param children the literals of the clause
+   *  @param frame the clause holds in every state reachable with at most
+   *         frame transitions, -1 if it is only a candidate
+   */
+  void publish_lemma(const smt::TermVec & children, int frame = -1);
+
+  /** Get the clauses published on the lemma bus since the last call
+   *  These are only candidates and must be checked before they are used.
+   *  @param out vector to append the literals of each clause to
+   */
+  void import_lemmas(std::vector<smt::TermVec> & out);
+
+  /** Get the clauses with a frame published on the lemma bus since the
+   *  last call, including the ones published again with a larger frame
+   *  Each holds in every state reachable with at most its frame
+   *  transitions.
+   *  @param out vector to append the literals of each clause to
+   *  @param frames vector to append the frame of each clause to
+   */
+  void import_frame_lemmas(std::vector<smt::TermVec> & out,
+                           std::vector<int> & frames);
+
+  /** Publish that there is no counterexample with k or fewer transitions
+   *  Does nothing if there is no bus.
+   */
+  void publish_safe_bound(int k);
+
+  /** @return the largest bound k published on the lemma bus such that
+   *          there is no counterexample with k or fewer transitions
+   *          (-1 if there is no bus)
+   */
+  int shared_safe_bound() const;
+
+  /** Apply --query-time-limit and --query-resource-limit to a solver
+   *  @param s the solver, e.g. solver_ or a helper solver of the engine
+   *  @param scale factor for both limits, e.g. to retry a query that
+   *         returned unknown with a bigger budget
+   *  @return true iff a limit is set and the solver accepted all of them
+   */
+  bool set_query_limits(const smt::SmtSolver & s, size_t scale = 1) const;
+
+  /** Save the state of the engine to options_.checkpoint_ if it is set and
+   *  options_.checkpoint_interval_ seconds passed since the last save.
+   *  Engines call it after each bound they complete. It also reports the
+   *  progress (see report_progress) and the memory of the caches, and
+   *  drops them above --soft-mem-limit, see manage_memory.
+   *  @param force save regardless of the interval
+   */
+  void checkpoint(bool force = false);
+
+  /** Write a progress event with the bound reached and the frames,
+   *  refinements and lemmas of the statistics to the event stream, if
+   *  it is enabled (see --json-events). Called by checkpoint.
+   */
+  void report_progress() const;
+
+  /** Report the memory with report_memory if the statistics are
+   *  enabled, and call reduce_memory once the soft memory limit of the
+   *  budget is exceeded. Called by checkpoint, between the steps of the
+   *  engine.
+   */
+  void manage_memory();
+
+  /** Set the sizes of the caches of the engine in stats_, and the
+   *  resident memory of the process (rss_kb), so that the memory not
+   *  accounted to the caches can be attributed to the solvers
+   *  By default this reports the caches of unroller_.
+   */
+  virtual void report_memory();
+
+  /** Drop caches that can be rebuilt on demand, to reduce the memory
+   *  Only called between the steps of the engine. By default this drops
+   *  the unrolled term caches of unroller_.
+   */
+  virtual void reduce_memory();
+
+  /** With options_.resume_, restore the state saved in
+   *  options_.checkpoint_ by the same engine for the same system
+   *  Engines call it once they can continue from a later bound.
+   *  @return true iff a checkpoint was restored
+   */
+  bool resume_checkpoint();
+
+  /** Fill a checkpoint with the state of the engine (reached_k is set)
+   *  @return false if the engine does not support checkpoints (default)
+   */
+  virtual bool save_checkpoint_state(Checkpoint & cp) const;
+
+  /** Restore the state saved by save_checkpoint_state, the solver is in
+   *  the state of the bound reached_k_ (not supported by default)
+   *  @return true on success, and then reached_k_ is cp.reached_k
+   */
+  virtual bool restore_checkpoint_state(const Checkpoint & cp);
+
   bool initialized_;
 
   smt::SmtSolver solver_;
@@ -126,5 +297,22 @@ class Prover
 
   smt::Term invar_; ///< populated with an invariant if the engine supports it
 
+  Budget budget_;  ///< cancelled by interrupt() or exhausted resources,
+                   ///< polled by engines
+
+  std::shared_ptr<Statistics> stats_;  ///< statistics of this prover
+
+  std::shared_ptr<LemmaBus> lemma_bus_;  ///< null if not sharing
+  std::unique_ptr<smt::TermTranslator> to_lemma_bus_;
+  ///< persistent translator used by to_orig_ts, created on first use
+  std::unique_ptr<smt::TermTranslator> to_orig_ts_solver_;
+  size_t num_imported_lemmas_;  ///< number of lemmas taken from the bus
+  size_t num_imported_frame_lemmas_;  ///< same for import_frame_lemmas
+
+  std::shared_ptr<RefinementCache> refinement_cache_;  ///< null if not
+                                                       ///< sharing
+
+  std::chrono::steady_clock::time_point last_checkpoint_;
+
 };
 }  // namespace pono
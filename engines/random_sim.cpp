@@ -0,0 +1,227 @@
+/*********************                                                        */
+/*! \file random_sim.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Bug hunting by concrete random simulation.
+**        Simulates random traces of a functional transition system without
+**        calling a solver, and reports the first one reaching a bad state.
+**        Can only find counterexamples, never prove the property.
+**
+**/
+
+#include "engines/random_sim.h"
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "utils/bit_parallel_simulator.h"
+#include "utils/exceptions.h"
+#include "utils/logger.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+// the budget is polled once per trace and every this many cycles
+static const int poll_interval = 4096;
+
+RandomSim::RandomSim(const Property & p,
+                     const TransitionSystem & ts,
+                     const SmtSolver & solver,
+                     PonoOptions opt)
+    : super(p, ts, solver, opt)
+{
+  engine_ = Engine::SIM;
+}
+
+RandomSim::~RandomSim() {}
+
+void RandomSim::initialize()
+{
+  if (initialized_) {
+    return;
+  }
+
+  super::initialize();
+
+  if (!ts_.is_functional()) {
+    throw PonoException(
+        "Random simulation requires a functional transition system");
+  }
+
+  // all built on this thread, the threads only run them
+  sims_.clear();
+  for (unsigned int t = 0; t < options_.sim_threads_; ++t) {
+    unsigned int seed = options_.random_seed_ + t;
+    if (options_.sim_lanes_ > 1) {
+      sims_.emplace_back(
+          new BitParallelSimulator(ts_, options_.sim_lanes_, seed));
+    } else {
+      sims_.emplace_back(new ConcreteSimulator(ts_, seed));
+    }
+  }
+  ConcreteSimulator & sim = *sims_[0];
+
+  terms_.clear();
+  terms_.insert(terms_.end(), ts_.statevars().begin(), ts_.statevars().end());
+  terms_.insert(terms_.end(), ts_.inputvars().begin(), ts_.inputvars().end());
+  // the witness is incomplete without the named terms that are not
+  // supported, but that does not matter for finding the bug
+  for (const auto & elem : ts_.named_terms()) {
+    if (sim.supported(elem.second)) {
+      terms_.push_back(elem.second);
+    }
+  }
+
+  // the outputs are numbered in the order they are added, so they are
+  // the same in all the simulators
+  for (auto & s : sims_) {
+    bad_id_ = s->add_output(bad_);
+    ids_.clear();
+    for (const auto & t : terms_) {
+      ids_.push_back(s->add_output(t));
+    }
+  }
+}
+
+uint64_t RandomSim::num_cycles() const
+{
+  uint64_t cycles = 0;
+  for (const auto & s : sims_) {
+    cycles += s->num_cycles();
+  }
+  return cycles;
+}
+
+ProverResult RandomSim::check_until(int k)
+{
+  initialize();
+
+  auto begin = chrono::steady_clock::now();
+  uint64_t begin_cycles = num_cycles();
+
+  // all lanes of a simulator start a trace at once, and the threads take
+  // the next batch of traces until the bad state is hit
+  const size_t lanes = sims_[0]->num_lanes();
+  const size_t num_threads = sims_.size();
+  atomic<size_t> next_trace(0);
+  atomic<bool> stop(false);
+  vector<size_t> traces(num_threads, 0), blocked(num_threads, 0);
+  mutex found_mutex;
+  size_t found_sim = num_threads;
+  int found_bound = -1;
+  size_t found_lane = 0;
+
+  auto run = [&](size_t w) {
+    ConcreteSimulator & sim = *sims_[w];
+    while (!stop) {
+      size_t t = next_trace.fetch_add(lanes);
+      if (options_.sim_traces_ && t >= options_.sim_traces_) {
+        return;
+      }
+      if (interrupted()) {
+        stop = true;
+        return;
+      }
+
+      traces[w] += lanes;
+      if (!sim.reset()) {
+        // could not find an initial state satisfying the constraints
+        ++blocked[w];
+        continue;
+      }
+
+      for (int i = 0; i <= k && !stop; ++i) {
+        size_t lane = sim.find_lane(bad_id_);
+        if (lane < lanes) {
+          lock_guard<mutex> lock(found_mutex);
+          if (found_sim == num_threads) {
+            found_sim = w;
+            found_bound = i;
+            found_lane = lane;
+          }
+          stop = true;
+          return;
+        }
+
+        if (i == k) {
+          break;
+        } else if ((i + 1) % poll_interval == 0 && interrupted()) {
+          stop = true;
+          return;
+        } else if (!sim.step()) {
+          // no inputs satisfy the constraints, start over
+          ++blocked[w];
+          break;
+        }
+      }
+    }
+  };
+
+  if (num_threads == 1) {
+    run(0);
+  } else {
+    vector<thread> workers;
+    for (size_t w = 0; w < num_threads; ++w) {
+      workers.push_back(thread(run, w));
+    }
+    for (auto & w : workers) {
+      w.join();
+    }
+  }
+
+  for (size_t w = 0; w < num_threads; ++w) {
+    stats_->increment("traces", traces[w]);
+    stats_->increment("blocked_traces", blocked[w]);
+  }
+  if (found_sim < num_threads) {
+    logger.log(
+        1, "RandomSim: found a counterexample at bound {}", found_bound);
+    compute_sim_witness(*sims_[found_sim], found_bound, found_lane);
+  }
+  stats_->add_time(
+      "simulation_time",
+      chrono::duration<double>(chrono::steady_clock::now() - begin).count());
+  stats_->increment("cycles", num_cycles() - begin_cycles);
+  return found_sim < num_threads ? ProverResult::FALSE
+                                 : ProverResult::UNKNOWN;
+}
+
+void RandomSim::compute_sim_witness(ConcreteSimulator & sim,
+                                    int k,
+                                    size_t lane)
+{
+  // the trace is not recorded while simulating, repeat it instead
+  witness_.clear();
+  bool ok = sim.rewind();
+  for (int i = 0; ok && i <= k; ++i) {
+    witness_.push_back(UnorderedTermMap());
+    UnorderedTermMap & map = witness_.back();
+    for (size_t j = 0; j < terms_.size(); ++j) {
+      const Term & t = terms_[j];
+      Sort sort = t->get_sort();
+      uint64_t v = sim.value(ids_[j], lane);
+      map[t] = (sort->get_sort_kind() == BOOL)
+                   ? solver_->make_term(v != 0)
+                   : solver_->make_term(std::to_string(v), sort);
+    }
+    ok = (i == k) || sim.step();
+  }
+  if (!ok) {
+    throw PonoException("Internal error: could not repeat simulated trace");
+  }
+  assert(sim.value(bad_id_, lane));
+}
+
+}  // namespace pono
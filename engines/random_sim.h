@@ -0,0 +1,78 @@
+/*********************                                                        */
+/*! \file random_sim.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Bug hunting by concrete random simulation.
+**        Simulates random traces of a functional transition system without
+**        calling a solver, and reports the first one reaching a bad state.
+**        Can only find counterexamples, never prove the property.
+**
+**        With --sim-threads, each thread has its own simulator (and seed)
+**        and they share the traces to simulate, so the number of traces
+**        per second scales with the cores.
+**
+**/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "engines/prover.h"
+#include "utils/concrete_simulator.h"
+
+namespace pono {
+
+class RandomSim : public Prover
+{
+ public:
+  RandomSim(const Property & p,
+            const TransitionSystem & ts,
+            const smt::SmtSolver & solver,
+            PonoOptions opt = PonoOptions());
+
+  ~RandomSim();
+
+  typedef Prover super;
+
+  void initialize() override;
+
+  /** Simulate options_.sim_traces_ random traces of k transitions each
+   *  With options_.sim_lanes_ above 1, that many traces are simulated at
+   *  once with bit-parallel simulation, by each of options_.sim_threads_
+   *  threads.
+   *  @return FALSE if a trace reached a bad state, UNKNOWN otherwise
+   */
+  ProverResult check_until(int k) override;
+
+  size_t witness_length() const override { return witness_.size(); }
+
+ protected:
+  /** Set witness_ by repeating the current traces up to bound k
+   *  @param sim the simulator of the trace
+   *  @param k the bound of the bad state
+   *  @param lane the simulator lane of the trace reaching it
+   */
+  void compute_sim_witness(ConcreteSimulator & sim, int k, size_t lane);
+
+  /** @return the cycles simulated by all the simulators */
+  uint64_t num_cycles() const;
+
+  ///< one per thread, with the same outputs
+  std::vector<std::unique_ptr<ConcreteSimulator>> sims_;
+  uint32_t bad_id_;      ///< output of the simulators for bad_
+  smt::TermVec terms_;   ///< state and input variables, and the named
+                         ///< terms the simulators support, recorded for
+                         ///< the witness
+  std::vector<uint32_t> ids_;  ///< outputs of the simulators for terms_
+
+};  // class RandomSim
+
+}  // namespace pono
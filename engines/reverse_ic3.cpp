@@ -0,0 +1,128 @@
+/*********************                                                        */
+/*! \file reverse_ic3.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Runs an IC3 variant backwards: from the bad states on the
+**        reversed transition relation, towards the initial states.
+**
+**/
+
+#include "engines/reverse_ic3.h"
+
+#include "modifiers/mod_ts_prop.h"
+#include "smt/available_solvers.h"
+#include "utils/logger.h"
+#include "utils/make_provers.h"
+#include "utils/timeline.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+ReverseIC3::ReverseIC3(const Property & p,
+                       const TransitionSystem & ts,
+                       const SmtSolver & solver,
+                       PonoOptions opt)
+    : super(p, ts, solver, opt)
+{
+  engine_ = Engine::REVERSE_IC3;
+
+  // built here rather than in initialize: the portfolio constructs the
+  // provers on one thread and runs them on others
+  Term prop = solver_->make_term(Not, bad_);
+  rev_ts_ = reverse_ts_and_prop(ts_, prop);
+
+  PonoOptions rev_opts = options_;
+  rev_opts.engine_ = options_.reverse_engine_;
+  SmtSolver s = create_solver_for(solver_->get_solver_enum(),
+                                  options_.reverse_engine_,
+                                  options_.logging_smt_solver_);
+  rev_prover_ = make_prover(options_.reverse_engine_,
+                            Property(solver_, prop),
+                            rev_ts_,
+                            s,
+                            rev_opts);
+}
+
+ProverResult ReverseIC3::check_until(int k)
+{
+  initialize();
+
+  // one bound at a time, so that an interrupt stops the engine
+  for (int i = reached_k_ + 1; i <= k; ++i) {
+    if (interrupted()) {
+      logger.log(1, "ReverseIC3: interrupted at bound {}", i);
+      return ProverResult::UNKNOWN;
+    }
+
+    ProverResult r;
+    {
+      TIMELINE_SPAN("ic3_rev");
+      r = rev_prover_->check_until(i);
+    }
+
+    if (r == ProverResult::FALSE) {
+      // a path back from the bad states to init is a counterexample
+      if (!find_witness(i + 1)) {
+        throw PonoException(
+            "ReverseIC3: no counterexample for the reversed one");
+      }
+      return ProverResult::FALSE;
+    } else if (r == ProverResult::TRUE) {
+      // the states that can't reach bad (and satisfy the invariant
+      // constraints) are inductive
+      try {
+        Term invar = solver_->make_term(Not, rev_prover_->invar());
+        for (const auto & c : ts_.constraints()) {
+          if (c.second && ts_.only_curr(c.first)) {
+            invar = solver_->make_term(And, invar, c.first);
+          }
+        }
+        invar_ = invar;
+      }
+      catch (PonoException & e) {
+        // the engine doesn't support invariants
+      }
+      return ProverResult::TRUE;
+    }
+    reached_k_ = i;
+  }
+  return ProverResult::UNKNOWN;
+}
+
+bool ReverseIC3::find_witness(int k)
+{
+  TIMELINE_SPAN("ic3_rev_witness");
+  solver_->push();
+  solver_->assert_formula(unroller_.at_time(ts_.init(), 0));
+  for (int j = 0; j <= k; ++j) {
+    if (j) {
+      assert_trans_at(j - 1);
+    }
+    solver_->push();
+    solver_->assert_formula(unroller_.at_time(bad_, j));
+    Result r = check_sat();
+    if (r.is_sat()) {
+      logger.log(1, "ReverseIC3: counterexample at bound {}", j);
+      reached_k_ = j - 1;
+      witness_.clear();
+      compute_witness();
+      solver_->pop();
+      solver_->pop();
+      return true;
+    }
+    solver_->pop();
+  }
+  solver_->pop();
+  return false;
+}
+
+}  // namespace pono
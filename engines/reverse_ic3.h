@@ -0,0 +1,58 @@
+/*********************                                                        */
+/*! \file reverse_ic3.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Runs an IC3 variant backwards: from the bad states on the
+**        reversed transition relation, towards the initial states.
+**
+**        This helps when the cone of the bad states is small but the
+**        states reachable from init are not, and is cheap to run next to
+**        forward IC3 in a portfolio.
+**
+**/
+
+#pragma once
+
+#include "engines/prover.h"
+
+namespace pono {
+
+class ReverseIC3 : public Prover
+{
+ public:
+  /** Runs options_.reverse_engine_ on the reverse of ts for p (see
+   *  reverse_ts_and_prop), on its own solver
+   */
+  ReverseIC3(const Property & p,
+             const TransitionSystem & ts,
+             const smt::SmtSolver & solver,
+             PonoOptions opt = PonoOptions());
+
+  typedef Prover super;
+
+  /** @return FALSE with a shortest counterexample of ts (found with BMC,
+   *          the IC3 variants don't give witnesses), TRUE with an
+   *          invariant if the engine gives one for the reversed system,
+   *          UNKNOWN otherwise
+   */
+  ProverResult check_until(int k) override;
+
+ protected:
+  /** Check for a counterexample of at most k transitions on solver_
+   *  with the unrolling of ts_
+   *  If there is one, computes the witness of the shortest one.
+   */
+  bool find_witness(int k);
+
+  TransitionSystem rev_ts_;  ///< the reverse of ts_, over solver_
+  std::shared_ptr<Prover> rev_prover_;  ///< checks rev_ts_ on its own solver
+};
+
+}  // namespace pono
@@ -16,9 +16,11 @@
 
 #include "engines/syguspdr.h"
 #include "modifiers/mod_ts_prop.h"
+#include "utils/concrete_simulator.h"
 #include "utils/container_shortcut.h"
 #include "utils/logger.h"
 #include "utils/term_walkers.h"
+#include "utils/timeline.h"
 #include "utils/sygus_predicate_constructor.h"
 
 using namespace smt;
@@ -73,7 +75,7 @@ bool SygusPdr::test_ts_has_op(const std::unordered_set<PrimOp> & prim_ops) const
   UnorderedTermSet term_op_out;
   TermOpCollector op_collector(ts_.solver());
   for (const auto & s_update : ts_.state_updates()) {
-    op_collector.find_matching_terms(s_update.second, prim_ops, term_op_out);
+    op_collector.add_matching_terms(s_update.second, prim_ops, term_op_out);
   }
   return !term_op_out.empty();
 }
@@ -88,6 +90,8 @@ SygusPdr::SygusPdr(const Property & p, const TransitionSystem & ts,
     partial_model_getter(solver_),
     has_assumptions(true) // most conservative way
 {
+  // the goals are over the abstract system
+  goal_models_ = false;
   solver_->set_opt("produce-unsat-assumptions", "true");
 
   // we need to have the reset-assertion capability 
@@ -139,11 +143,12 @@ void SygusPdr::initialize()
   if (options_.sygus_use_operator_abstraction_) {
     if ( options_.sygus_use_operator_abstraction_ == 2 )
       op_abstractor_ = std::make_unique<OpUfAbstractor>(
-        orig_ts_, ts_, std::unordered_set<PrimOp>({BVMul, BVUdiv, BVSdiv, BVSmod, BVSrem, BVUrem}));
+        orig_ts_, ts_, std::unordered_set<PrimOp>({BVMul, BVUdiv, BVSdiv, BVSmod, BVSrem, BVUrem}),
+        refinement_cache_);
     else {
       op_abstractor_ = std::make_unique<OpInpAbstractor>(
         orig_ts_, ts_, std::unordered_set<PrimOp>({BVMul, BVUdiv, BVSdiv, BVSmod, BVSrem, BVUrem}),
-        bad_, 0);
+        bad_, 0, refinement_cache_);
 
       ts_ = promote_inputvars(ts_);
     }
@@ -188,25 +193,24 @@ void SygusPdr::initialize()
     // } // else skip
   }
   // initialize the caches  
-  // extract the operators
+  // one walk extracts the operators, the parents, the scores and the
+  // constants of the terms for the exprs, then the operators of the rest
   op_extract_ = std::make_unique<syntax_analysis::OpExtractor>();
-  op_extract_->WalkBFS(ts_.init());
-  op_extract_->WalkBFS(ts_.trans());
-  op_extract_->GetSyntaxConstruct().RemoveConcat();
-  op_extract_->GetSyntaxConstruct().RemoveExtract();
-  op_extract_->GetSyntaxConstruct().AndOrConvert();
-  op_extract_->GetSyntaxConstruct().RemoveUnusedStructure();
-    
+  syntax_analysis::ConstantExtractor constants(
+    sygus_term_manager_.ConstantMapToFill(),
+    sygus_term_manager_.ConstantStringsToFill());
+  syntax_analysis::FusedExtractor fused_walker(op_extract_.get(),
+    &term_score_walker_, &parent_of_terms_, &constants);
 
   { // 1. register terms to find exprs
     // 2. extract parent from the same terms
     for (auto && v_nxtexpr_pair : ts_.state_updates()) {
       assert(ts_.no_next(v_nxtexpr_pair.second));
       sygus_term_manager_.RegisterTermsToWalk(v_nxtexpr_pair.second);
-      parent_of_terms_.WalkBFS(v_nxtexpr_pair.second);
+      fused_walker.WalkBFS(v_nxtexpr_pair.second);
     }
     sygus_term_manager_.RegisterTermsToWalk(ts_.init());
-    parent_of_terms_.WalkBFS(ts_.init());
+    fused_walker.WalkBFS(ts_.init());
 
     for (const auto & c_next_init : ts_.constraints()) {
       if (!c_next_init.second)
@@ -214,7 +218,7 @@ void SygusPdr::initialize()
       assert(ts_.no_next(c_next_init.first));
       //if (ts_.no_next(c_next_init.first)) {
       sygus_term_manager_.RegisterTermsToWalk(c_next_init.first);
-      parent_of_terms_.WalkBFS(c_next_init.first);
+      fused_walker.WalkBFS(c_next_init.first);
       //  }
     }
 
@@ -222,6 +226,14 @@ void SygusPdr::initialize()
     // parent_of_terms_.WalkBFS(property_.prop());
   }
 
+  // the rest of trans only for the operators
+  fused_walker.SetAll(false);
+  fused_walker.WalkBFS(ts_.trans());
+  op_extract_->GetSyntaxConstruct().RemoveConcat();
+  op_extract_->GetSyntaxConstruct().RemoveExtract();
+  op_extract_->GetSyntaxConstruct().AndOrConvert();
+  op_extract_->GetSyntaxConstruct().RemoveUnusedStructure();
+
   // cache two lambda functions for sygus enum
   to_next_func_ = [this] (const Term & v) -> Term {
     return this->ts_.next(v);
@@ -516,6 +528,7 @@ IC3Formula SygusPdr::select_predicates_generic(const Term & base, const TermVec
   UnorderedTermSet pred_set(preds_nxt.begin(), preds_nxt.end());
   TermVec deduplicate_preds_nxt(pred_set.begin(), pred_set.end());
 
+  stats_->increment("reducer_unsat_cores");
   reducer_.reduce_assump_unsatcore(base, deduplicate_preds_nxt, unsatcore, NULL, 0, options_.random_seed_);
 
   D(3,"[IterativeReduction] End core size {}", unsatcore.size());
@@ -533,6 +546,7 @@ IC3Formula SygusPdr::select_predicates_generic(const Term & base, const TermVec
     term_id_map.emplace(pos->second, pidx ++);
   }
   unsatcore.clear(); // reuse this
+  stats_->increment("reducer_unsat_cores");
   reducer_.linear_reduce_assump_unsatcore(base, sorted_unsatcore, unsatcore, NULL, 0);
   #ifdef DEBUG
     std::cout << "Total : " << preds_nxt.size() << " {";
@@ -618,18 +632,30 @@ syntax_analysis::PerCexInfo & SygusPdr::setup_cex_info (syntax_analysis::IC3Form
 
   syntax_analysis::PerCexInfo & per_cex_info = cex_term_map_pos->second;
 
-  // then evalute the terms on the cex
-  push_solver_context();
-  disable_all_labels();
-  for(const auto & c : op_uf_assumptions_)
-    solver_->assert_formula(c);
-  solver_->assert_formula( post_model->to_expr() );
-  auto res = check_sat();
-  assert (res.is_sat());
-
   bool reset_due_to_more_refinement = per_cex_info.prev_refine_constraint_count < op_uf_assumptions_.size();
   per_cex_info.prev_refine_constraint_count = op_uf_assumptions_.size();
+  if (reset_due_to_more_refinement) {
+    // only the values from the solver depend on the refinement
+    for (const auto & t : per_cex_info.solver_evaluated)
+      per_cex_info.terms_val_under_cex.erase(t);
+    per_cex_info.solver_evaluated.clear();
+  }
+
+  // the terms are over the variables of the cex, so most of them can be
+  // evaluated from the cube directly, without a solver query
+  if (per_cex_info.native_vals.size() > options_.sygus_eval_cache_limit_) {
+    per_cex_info.native_vals.clear();
+    per_cex_info.native_failed.clear();
+  }
+  if (per_cex_info.native_vals.empty()) {
+    for (const auto & var_val : post_model->cube()) {
+      if (sim_evaluate(var_val.second, per_cex_info.native_vals))
+        per_cex_info.native_vals[var_val.first] =
+          per_cex_info.native_vals.at(var_val.second);
+    }
+  }
 
+  TermVec solver_terms;
   // for each witdh
   for (const auto & width_term_const_pair : per_cex_info.varset_info.terms) {
     auto width = width_term_const_pair.first;
@@ -644,8 +670,13 @@ syntax_analysis::PerCexInfo & SygusPdr::setup_cex_info (syntax_analysis::IC3Form
     // cache the terms and constants value under the cex
     for (unsigned tidx = nt; tidx < nt_end ; ++tidx) {
       const auto & t = width_term_const_pair.second.terms.at(tidx);
-      per_cex_info.terms_val_under_cex.emplace(
-        t, syntax_analysis::eval_val( solver_->get_value(t)->to_string() ));
+      if (IN(t, per_cex_info.terms_val_under_cex))
+        continue;
+      if (sim_evaluate(t, per_cex_info.native_vals, &per_cex_info.native_failed))
+        per_cex_info.terms_val_under_cex.emplace(
+          t, syntax_analysis::eval_val(per_cex_info.native_vals.at(t)));
+      else
+        solver_terms.push_back(t);
     }
     for (unsigned cidx = nc ; cidx <  nc_end; ++cidx) {
       const auto & c = width_term_const_pair.second.constants.at(cidx);
@@ -653,7 +684,24 @@ syntax_analysis::PerCexInfo & SygusPdr::setup_cex_info (syntax_analysis::IC3Form
         c, c->to_string() );
     }
   } // eval terms on cex
-  pop_solver_context();
+  stats_->increment("sygus_solver_evals", solver_terms.size());
+
+  if (!solver_terms.empty()) {
+    // then evalute the remaining terms on the cex
+    push_solver_context();
+    disable_all_labels();
+    for(const auto & c : op_uf_assumptions_)
+      solver_->assert_formula(c);
+    solver_->assert_formula( post_model->to_expr() );
+    auto res = check_sat();
+    assert (res.is_sat());
+    for (const auto & t : solver_terms) {
+      per_cex_info.terms_val_under_cex.emplace(
+        t, syntax_analysis::eval_val( solver_->get_value(t)->to_string() ));
+      per_cex_info.solver_evaluated.push_back(t);
+    }
+    pop_solver_context();
+  }
 
   if (reset_due_to_more_refinement)
     per_cex_info.ResetPredicates();
@@ -876,6 +924,7 @@ void SygusPdr::abstract() {
 
 
 RefineResult SygusPdr::refine() {
+  TIMELINE_SPAN("syguspdr_refine");
   if (!options_.sygus_use_operator_abstraction_)
     return REFINE_NONE;
 
@@ -945,7 +994,7 @@ bool SygusPdr::try_recursive_block_goal(const IC3Formula & to_block, unsigned fi
       assert(pg == proof_goals.top());
       proof_goals.pop();
       assert(collateral.term == pg->target.term);
-      collateral = inductive_generalization(pg->idx, collateral);
+      collateral = record_inductive_generalization(pg->idx, collateral);
 
       size_t idx = find_highest_frame(pg->idx, collateral);
       assert(idx >= pg->idx);
@@ -1016,6 +1065,7 @@ bool SygusPdr::rel_ind_check_may_block(size_t i,
     out.term = solver_true_;
     out.children = {solver_true_};
     out.disjunction = false;
+    out.signature = IC3Formula::signature_bit(solver_true_);
     pop_solver_context();
     return r.is_unsat();
   }
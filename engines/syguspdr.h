@@ -69,6 +69,12 @@ class SygusPdr : public IC3Base
 
   void initialize() override;
 
+  // the candidate lemmas of the sygus queries are not saved
+  bool save_checkpoint_state(Checkpoint & cp) const override
+  {
+    return false;
+  }
+
 
   virtual void abstract() override;
 
@@ -0,0 +1,474 @@
+/*********************                                                        */
+/*! \file aiger_encoder.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Frontend for the AIGER format (ASCII "aag" and binary "aig",
+**        version 1.9 without justice properties).
+**        See http://fmv.jku.at/aiger/ for more information.
+**
+**/
+
+#include "frontends/aiger_encoder.h"
+
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+
+#include "assert.h"
+#include "smt-switch/utils.h"
+#include "utils/exceptions.h"
+#include "utils/logger.h"
+#include "utils/memory_profile.h"
+#include "utils/timeline.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+namespace {
+
+// reads the content of an AIGER file, with line and character positions
+// for the error messages
+class AigerReader
+{
+ public:
+  AigerReader(const string & content) : s_(content), pos_(0), line_(1) {}
+
+  bool at_end() const { return pos_ >= s_.size(); }
+
+  int peek() const { return at_end() ? -1 : (unsigned char)s_[pos_]; }
+
+  void error(const string & msg) const
+  {
+    throw PonoException("AIGER line " + to_string(line_) + ": " + msg);
+  }
+
+  uint32_t read_uint()
+  {
+    if (at_end() || !isdigit(s_[pos_])) {
+      error("expecting an unsigned integer");
+    }
+    uint64_t res = 0;
+    while (!at_end() && isdigit(s_[pos_])) {
+      res = 10 * res + (s_[pos_++] - '0');
+      if (res > UINT32_MAX) {
+        error("integer too large");
+      }
+    }
+    return res;
+  }
+
+  void expect(char c)
+  {
+    if (c == '\n' && peek() == '\r') {
+      ++pos_;
+    }
+    if (peek() != c) {
+      error(c == '\n' ? "expecting a new line"
+                      : string("expecting '") + c + "'");
+    }
+    ++pos_;
+    if (c == '\n') {
+      ++line_;
+    }
+  }
+
+  /** @return the next number of a line of numbers */
+  uint32_t read_line_uint()
+  {
+    uint32_t res = read_uint();
+    expect('\n');
+    return res;
+  }
+
+  /** @return the rest of the current line */
+  string read_rest_of_line()
+  {
+    size_t end = s_.find('\n', pos_);
+    if (end == string::npos) {
+      end = s_.size();
+    }
+    string res = s_.substr(pos_, end - pos_);
+    if (res.size() && res.back() == '\r') {
+      res.pop_back();
+    }
+    pos_ = end < s_.size() ? end + 1 : end;
+    ++line_;
+    return res;
+  }
+
+  /** @return a number in the binary (7 bits per byte) encoding */
+  uint32_t read_delta()
+  {
+    uint64_t res = 0;
+    unsigned shift = 0;
+    while (true) {
+      if (at_end()) {
+        error("unexpected end of the binary and gates");
+      }
+      unsigned char b = s_[pos_++];
+      res |= (uint64_t)(b & 0x7f) << shift;
+      if (res > UINT32_MAX) {
+        error("invalid binary and gate");
+      }
+      if (!(b & 0x80)) {
+        return res;
+      }
+      shift += 7;
+      if (shift > 28) {
+        error("invalid binary and gate");
+      }
+    }
+  }
+
+ private:
+  const string & s_;
+  size_t pos_;
+  size_t line_;
+};
+
+}  // namespace
+
+AigerEncoder::AigerEncoder(std::string filename,
+                           FunctionalTransitionSystem & fts)
+    : fts_(fts), solver_(fts.solver()), max_var_(0)
+{
+  ifstream in(filename, ios::binary);
+  if (!in.good()) {
+    throw PonoException("Could not open " + filename);
+  }
+  stringstream content;
+  content << in.rdbuf();
+
+  read(content.str());
+  sort_ands();
+  encode();
+
+  logger.log(1,
+             "AigerEncoder: {} inputs, {} latches, {} and gates, {} "
+             "properties",
+             inputs_.size(),
+             latches_.size(),
+             ands_.size(),
+             propvec_.size());
+}
+
+void AigerEncoder::simulate(std::vector<uint8_t> & values) const
+{
+  values.resize(max_var_ + 1, 2);
+  values[0] = 0;
+  for (const auto & a : ands_) {
+    uint8_t v0 = lit_value(values, a.rhs0);
+    uint8_t v1 = lit_value(values, a.rhs1);
+    if (!v0 || !v1) {
+      values[a.lhs >> 1] = 0;
+    } else if (v0 == 1 && v1 == 1) {
+      values[a.lhs >> 1] = 1;
+    } else {
+      values[a.lhs >> 1] = 2;
+    }
+  }
+}
+
+uint8_t AigerEncoder::lit_value(const std::vector<uint8_t> & values,
+                                uint32_t lit)
+{
+  uint8_t v = (lit >> 1) ? values[lit >> 1] : 0;
+  return (v != 2 && (lit & 1)) ? 1 - v : v;
+}
+
+Term AigerEncoder::lit_term(uint32_t lit) const
+{
+  uint32_t var = lit >> 1;
+  if (var == 0) {
+    return solver_->make_term((bool)(lit & 1));
+  } else if (var >= var_terms_.size() || !var_terms_[var]) {
+    throw PonoException("AIGER literal " + to_string(lit)
+                        + " is not encoded");
+  }
+  const Term & t = var_terms_[var];
+  return (lit & 1) ? solver_->make_term(Not, t) : t;
+}
+
+void AigerEncoder::read(const std::string & content)
+{
+  AigerReader r(content);
+
+  string format;
+  while (!r.at_end() && isalpha(r.peek())) {
+    format.push_back(r.peek());
+    r.expect(format.back());
+  }
+  if (format != "aag" && format != "aig") {
+    r.error("expecting an aag or aig header");
+  }
+  bool binary = format == "aig";
+
+  // M I L O A [B C J F]
+  vector<uint32_t> header;
+  while (r.peek() == ' ') {
+    r.expect(' ');
+    header.push_back(r.read_uint());
+  }
+  r.expect('\n');
+  if (header.size() < 5 || header.size() > 9) {
+    r.error("expecting M I L O A [B C J F] in the header");
+  }
+  header.resize(9, 0);
+  max_var_ = header[0];
+  uint32_t num_inputs = header[1], num_latches = header[2],
+           num_outputs = header[3], num_ands = header[4],
+           num_bads = header[5], num_constraints = header[6],
+           num_justice = header[7], num_fairness = header[8];
+  if (num_justice) {
+    throw PonoException("AIGER justice properties are not supported");
+  }
+  if (binary && (uint64_t)num_inputs + num_latches + num_ands != max_var_) {
+    r.error("expecting M = I + L + A in a binary file");
+  }
+
+  auto check_lit = [&](uint32_t lit) {
+    if ((lit >> 1) > max_var_) {
+      r.error("literal " + to_string(lit) + " is larger than 2M+1");
+    }
+    return lit;
+  };
+
+  inputs_.reserve(num_inputs);
+  for (uint32_t i = 0; i < num_inputs; ++i) {
+    inputs_.push_back(binary ? 2 * (i + 1) : check_lit(r.read_line_uint()));
+  }
+
+  latches_.reserve(num_latches);
+  for (uint32_t i = 0; i < num_latches; ++i) {
+    AigerLatch l;
+    if (binary) {
+      l.lit = 2 * (num_inputs + i + 1);
+    } else {
+      l.lit = check_lit(r.read_uint());
+      r.expect(' ');
+    }
+    l.next = check_lit(r.read_uint());
+    l.reset = 0;
+    if (r.peek() == ' ') {
+      r.expect(' ');
+      l.reset = check_lit(r.read_uint());
+    }
+    r.expect('\n');
+    if (l.reset > 1 && l.reset != l.lit) {
+      r.error("the reset of a latch must be 0, 1 or the latch");
+    }
+    latches_.push_back(l);
+  }
+
+  for (uint32_t i = 0; i < num_outputs; ++i) {
+    outputs_.push_back(check_lit(r.read_line_uint()));
+  }
+  for (uint32_t i = 0; i < num_bads; ++i) {
+    bads_.push_back(check_lit(r.read_line_uint()));
+  }
+  for (uint32_t i = 0; i < num_constraints; ++i) {
+    constraints_.push_back(check_lit(r.read_line_uint()));
+  }
+  for (uint32_t i = 0; i < num_fairness; ++i) {
+    // only meaningful for justice properties
+    check_lit(r.read_line_uint());
+  }
+
+  ands_.reserve(num_ands);
+  for (uint32_t i = 0; i < num_ands; ++i) {
+    AigerAnd a;
+    if (binary) {
+      a.lhs = 2 * (num_inputs + num_latches + i + 1);
+      uint32_t delta0 = r.read_delta();
+      if (delta0 == 0 || delta0 > a.lhs) {
+        r.error("invalid binary and gate");
+      }
+      a.rhs0 = a.lhs - delta0;
+      uint32_t delta1 = r.read_delta();
+      if (delta1 > a.rhs0) {
+        r.error("invalid binary and gate");
+      }
+      a.rhs1 = a.rhs0 - delta1;
+    } else {
+      a.lhs = check_lit(r.read_uint());
+      r.expect(' ');
+      a.rhs0 = check_lit(r.read_uint());
+      r.expect(' ');
+      a.rhs1 = check_lit(r.read_uint());
+      r.expect('\n');
+    }
+    ands_.push_back(a);
+  }
+
+  // symbol table, up to the comments
+  input_names_.resize(num_inputs);
+  latch_names_.resize(num_latches);
+  while (!r.at_end() && r.peek() != 'c') {
+    char kind = r.peek();
+    r.expect(kind);
+    uint32_t pos = r.read_uint();
+    r.expect(' ');
+    string name = r.read_rest_of_line();
+    if (kind == 'i' && pos < num_inputs) {
+      input_names_[pos] = name;
+    } else if (kind == 'l' && pos < num_latches) {
+      latch_names_[pos] = name;
+    } else if (kind != 'o' && kind != 'b' && kind != 'j' && kind != 'f') {
+      r.error(string("unexpected symbol kind '") + kind + "'");
+    }
+  }
+}
+
+void AigerEncoder::sort_ands()
+{
+  // 0: not an and gate, 1: not visited, 2: visiting, 3: done
+  vector<uint8_t> state(max_var_ + 1, 0);
+  vector<uint32_t> gate(max_var_ + 1, 0);
+  auto add_var = [&state](uint32_t lit) {
+    if ((lit & 1) || (lit >> 1) == 0 || state[lit >> 1]) {
+      throw PonoException("AIGER literal " + to_string(lit)
+                          + " is not a fresh variable");
+    }
+    state[lit >> 1] = 4;
+  };
+  for (uint32_t lit : inputs_) {
+    add_var(lit);
+  }
+  for (const auto & l : latches_) {
+    add_var(l.lit);
+  }
+  for (uint32_t i = 0; i < ands_.size(); ++i) {
+    uint32_t var = ands_[i].lhs >> 1;
+    if ((ands_[i].lhs & 1) || var == 0 || state[var]) {
+      throw PonoException("AIGER literal " + to_string(ands_[i].lhs)
+                          + " is not a fresh and gate");
+    }
+    state[var] = 1;
+    gate[var] = i;
+  }
+
+  vector<AigerAnd> sorted;
+  sorted.reserve(ands_.size());
+  vector<uint32_t> stack;
+  for (const auto & root : ands_) {
+    stack.push_back(root.lhs >> 1);
+    while (stack.size()) {
+      uint32_t var = stack.back();
+      const AigerAnd & a = ands_[gate[var]];
+      if (state[var] == 1) {
+        state[var] = 2;
+        for (uint32_t rhs : { a.rhs0, a.rhs1 }) {
+          uint8_t s = state[rhs >> 1];
+          if (s == 1) {
+            stack.push_back(rhs >> 1);
+          } else if (s == 2) {
+            throw PonoException("AIGER and gates are cyclic");
+          }
+        }
+      } else {
+        stack.pop_back();
+        if (state[var] == 2) {
+          state[var] = 3;
+          sorted.push_back(a);
+        }
+      }
+    }
+  }
+  assert(sorted.size() == ands_.size());
+  ands_ = std::move(sorted);
+}
+
+void AigerEncoder::encode()
+{
+  TIMELINE_SPAN("aiger_encode");
+  MEMORY_PHASE("aiger_encode");
+  Sort boolsort = solver_->make_sort(BOOL);
+  var_terms_.assign(max_var_ + 1, Term());
+
+  unordered_set<string> names;
+  auto fresh_name = [&names](const string & symbol, const string & dflt) {
+    string name = symbol.empty() || names.count(symbol) ? dflt : symbol;
+    while (names.count(name)) {
+      name += "_";
+    }
+    names.insert(name);
+    return name;
+  };
+
+  for (size_t i = 0; i < inputs_.size(); ++i) {
+    string name = fresh_name(input_names_[i], "i" + to_string(i));
+    Term v = fts_.make_inputvar(name, boolsort);
+    var_terms_[inputs_[i] >> 1] = v;
+    inputsvec_.push_back(v);
+  }
+  for (size_t i = 0; i < latches_.size(); ++i) {
+    string name = fresh_name(latch_names_[i], "l" + to_string(i));
+    Term v = fts_.make_statevar(name, boolsort);
+    var_terms_[latches_[i].lit >> 1] = v;
+    statesvec_.push_back(v);
+  }
+
+  // only the gates in the cone of the system
+  const vector<uint32_t> & bads = bads_.size() ? bads_ : outputs_;
+  vector<bool> needed(max_var_ + 1, false);
+  for (const auto & l : latches_) {
+    needed[l.next >> 1] = true;
+  }
+  for (uint32_t b : bads) {
+    needed[b >> 1] = true;
+  }
+  for (uint32_t c : constraints_) {
+    needed[c >> 1] = true;
+  }
+  for (auto it = ands_.rbegin(); it != ands_.rend(); ++it) {
+    if (needed[it->lhs >> 1]) {
+      needed[it->rhs0 >> 1] = true;
+      needed[it->rhs1 >> 1] = true;
+    }
+  }
+  for (const auto & a : ands_) {
+    if (needed[a.lhs >> 1]) {
+      var_terms_[a.lhs >> 1] =
+          solver_->make_term(And, lit_term(a.rhs0), lit_term(a.rhs1));
+    }
+  }
+
+  for (const auto & l : latches_) {
+    const Term & sv = var_terms_[l.lit >> 1];
+    fts_.assign_next(sv, lit_term(l.next));
+    if (l.reset == 0) {
+      fts_.constrain_init(solver_->make_term(Not, sv));
+    } else if (l.reset == 1) {
+      fts_.constrain_init(sv);
+    }
+  }
+
+  for (uint32_t c : constraints_) {
+    Term constraint = lit_term(c);
+    // constraints over inputs need to be promoted to state variables
+    UnorderedTermSet free_vars;
+    get_free_symbolic_consts(constraint, free_vars);
+    for (const auto & v : free_vars) {
+      if (fts_.is_input_var(v)) {
+        fts_.promote_inputvar(v);
+      }
+    }
+    fts_.add_constraint(constraint);
+  }
+
+  for (uint32_t b : bads) {
+    propvec_.push_back(lit_term(b ^ 1));
+  }
+}
+
+}  // namespace pono
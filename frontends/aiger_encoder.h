@@ -0,0 +1,126 @@
+/*********************                                                        */
+/*! \file aiger_encoder.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Frontend for the AIGER format (ASCII "aag" and binary "aig",
+**        version 1.9 without justice properties).
+**        See http://fmv.jku.at/aiger/ for more information.
+**
+**        Besides the transition system, the encoder keeps the and-inverter
+**        graph as literal arrays, with the and gates in topological order,
+**        so that bit-level code can read (and simulate) it directly.
+**
+**/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/fts.h"
+#include "smt-switch/smt.h"
+
+namespace pono {
+
+/** A latch: its literal, the literal of its next state, and its reset
+ *  (0, 1, or lit for an uninitialized latch)
+ */
+struct AigerLatch
+{
+  uint32_t lit;
+  uint32_t next;
+  uint32_t reset;
+};
+
+/** An and gate lhs = rhs0 & rhs1 */
+struct AigerAnd
+{
+  uint32_t lhs;
+  uint32_t rhs0;
+  uint32_t rhs1;
+};
+
+class AigerEncoder
+{
+ public:
+  /** Encode an AIGER file in fts
+   *  Inputs and latches become boolean input and state variables, named
+   *  after the symbol table if possible. The and gates are only encoded
+   *  in the cone of the latches, bad states and constraints.
+   *  If there are no bad states, the outputs are the bad states.
+   *  @throws PonoException if the file cannot be read or is malformed
+   */
+  AigerEncoder(std::string filename, FunctionalTransitionSystem & fts);
+
+  /** @return the properties, i.e. the negation of each bad state */
+  const smt::TermVec & propvec() const { return propvec_; }
+  const smt::TermVec & inputsvec() const { return inputsvec_; }
+  const smt::TermVec & statesvec() const { return statesvec_; }
+
+  // The and-inverter graph. A literal is 2 * variable index, plus 1 if it
+  // is negated. Variable 0 is the constant false.
+  uint32_t max_var() const { return max_var_; }
+  const std::vector<uint32_t> & inputs() const { return inputs_; }
+  const std::vector<AigerLatch> & latches() const { return latches_; }
+  const std::vector<uint32_t> & outputs() const { return outputs_; }
+  const std::vector<uint32_t> & bads() const { return bads_; }
+  const std::vector<uint32_t> & constraints() const { return constraints_; }
+  /** the and gates, each after the gates of its inputs */
+  const std::vector<AigerAnd> & ands() const { return ands_; }
+
+  /** Ternary simulation of the and gates
+   *  @param values the value of each variable (0, 1, or 2 for unknown),
+   *         indexed by variable. The values of the inputs and latches
+   *         must be set, the values of the gates are overwritten.
+   */
+  void simulate(std::vector<uint8_t> & values) const;
+
+  /** @return the value of a literal in the result of simulate */
+  static uint8_t lit_value(const std::vector<uint8_t> & values, uint32_t lit);
+
+  /** @return the term of a literal in the cone of the encoded system
+   *  @throws PonoException if it was not encoded
+   */
+  smt::Term lit_term(uint32_t lit) const;
+
+ protected:
+  /** Parse the header, literals, gates and symbols of the file content */
+  void read(const std::string & content);
+
+  /** Order the and gates topologically (the gates of the ASCII format may
+   *  come in any order)
+   */
+  void sort_ands();
+
+  /** Create the variables and the gates in the cone of the system */
+  void encode();
+
+  FunctionalTransitionSystem & fts_;
+  const smt::SmtSolver & solver_;
+
+  uint32_t max_var_;
+  std::vector<uint32_t> inputs_;
+  std::vector<AigerLatch> latches_;
+  std::vector<uint32_t> outputs_;
+  std::vector<uint32_t> bads_;
+  std::vector<uint32_t> constraints_;
+  std::vector<AigerAnd> ands_;
+
+  std::vector<std::string> input_names_;
+  std::vector<std::string> latch_names_;
+
+  smt::TermVec var_terms_;  ///< indexed by variable, null if not encoded
+  smt::TermVec inputsvec_;
+  smt::TermVec statesvec_;
+  smt::TermVec propvec_;
+};
+
+}  // namespace pono
@@ -18,8 +18,19 @@
 
 #include "btor2_encoder.h"
 #include "utils/logger.h"
+#include "utils/memory_profile.h"
+#include "utils/timeline.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <thread>
 #include "assert.h"
 
 using namespace smt;
@@ -146,6 +157,14 @@ Term BTOR2Encoder::bv_to_bool(const Term & t) const
   }
 }
 
+Sort BTOR2Encoder::sort_at(int64_t id) const
+{
+  if (id <= 0 || (size_t)id >= sorts_.size() || !sorts_[id]) {
+    throw PonoException("Missing sort for id " + std::to_string(id));
+  }
+  return sorts_[id];
+}
+
 TermVec BTOR2Encoder::lazy_convert(const TermVec & tvec) const
 {
   TermVec res;
@@ -184,31 +203,148 @@ TermVec BTOR2Encoder::lazy_convert(const TermVec & tvec) const
 }
 
 
-// to handle the case where yosys generate sth. like this
-// state (with no name)
-// output (with name)
-// for Verilog :  output reg xxx;
+// the largest line id of a mapped btor2 file, to size the tables indexed by
+// id once. Large files are scanned by several threads, in chunks that end
+// at a newline. Malformed lines are skipped, they are reported by the parser.
+static int64_t max_btor2_id(const char * data, size_t size)
+{
+  const size_t min_chunk = 1 << 22;
+  size_t num_chunks = std::min<size_t>(
+      std::max(std::thread::hardware_concurrency(), 1u), size / min_chunk);
+  num_chunks = std::max<size_t>(num_chunks, 1);
+
+  std::vector<const char *> bounds({ data });
+  for (size_t i = 1; i < num_chunks; ++i) {
+    const char * b = data + i * (size / num_chunks);
+    b = std::max(b, bounds.back());
+    const char * nl = (const char *)memchr(b, '\n', data + size - b);
+    bounds.push_back(nl ? nl + 1 : data + size);
+  }
+  bounds.push_back(data + size);
+
+  std::vector<int64_t> max_ids(num_chunks, 0);
+  auto scan = [&](size_t i) {
+    const char * p = bounds[i];
+    const char * end = bounds[i + 1];
+    while (p < end) {
+      int64_t id = 0;
+      while (p < end && *p >= '0' && *p <= '9') {
+        id = 10 * id + (*p++ - '0');
+      }
+      max_ids[i] = std::max(max_ids[i], id);
+      const char * nl = (const char *)memchr(p, '\n', end - p);
+      p = nl ? nl + 1 : end;
+    }
+  };
 
-// this function go over the file and record this case
-// when we encounter it again we shall replace the state's name
-void BTOR2Encoder::preprocess(const std::string& filename) {
-  FILE * input_file = fopen(filename.c_str(), "r");
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < num_chunks; ++i) {
+    workers.emplace_back(scan, i);
+  }
+  scan(0);
+  for (auto & w : workers) {
+    w.join();
+  }
+  return *std::max_element(max_ids.begin(), max_ids.end());
+}
+
+void BTOR2Encoder::read(const std::string & filename)
+{
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw PonoException("Could not open " + filename);
+  }
+
+  // map large files instead of streaming them through stdio
+  // falls back to a regular stream (e.g. for pipes or empty files)
+  struct stat st;
+  void * data = MAP_FAILED;
+  size_t size = 0;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    size = st.st_size;
+    data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+
+  FILE * input_file;
+  if (data != MAP_FAILED) {
+    madvise(data, size, MADV_SEQUENTIAL);
+    int64_t max_id = max_btor2_id((const char *)data, size);
+    sorts_.reserve(max_id + 1);
+    terms_.reserve(max_id + 1);
+    input_file = fmemopen(data, size, "r");
+  } else {
+    input_file = fdopen(dup(fd), "r");
+  }
+  close(fd);
 
   if (!input_file) {
+    if (data != MAP_FAILED) {
+      munmap(data, size);
+    }
     throw PonoException("Could not open " + filename);
   }
 
   reader_ = btor2parser_new();
+  bool ok = btor2parser_read_lines(reader_, input_file);
+  fclose(input_file);
+  // the parser keeps its own copies of the symbols
+  if (data != MAP_FAILED) {
+    munmap(data, size);
+  }
 
-  if (!btor2parser_read_lines(reader_, input_file)) {
-    throw PonoException(std::string(btor2parser_error(reader_)));
+  if (!ok) {
+    std::string msg = btor2parser_error(reader_);
+    btor2parser_delete(reader_);
+    reader_ = nullptr;
+    throw PonoException(msg);
   }
+}
+
+// to handle the case where yosys generate sth. like this
+// state (with no name)
+// output (with name)
+// for Verilog :  output reg xxx;
 
+// this function go over the lines and record this case
+// when we encounter it again we shall replace the state's name
+void BTOR2Encoder::preprocess()
+{
   it_ = btor2parser_iter_init(reader_);
 
+  // dependencies of the lines, for the cone of the selected property
+  const bool lazy = prop_idx_ >= 0;
+  std::vector<std::vector<int64_t>> deps;
+  if (lazy) {
+    deps.reserve(terms_.capacity());
+  }
+  std::vector<int64_t> roots;
+  size_t num_bad = 0;
+
   std::unordered_set<uint64_t> unamed_state_ids;
   while ((l_ = btor2parser_iter_next(&it_))) {
-  
+    if (lazy) {
+      if (deps.size() <= (size_t)l_->id) {
+        deps.resize(l_->id + 1);
+      }
+      for (uint32_t i = 0; i < l_->nargs; ++i) {
+        int64_t arg = std::abs(l_->args[i]);
+        if (arg <= 0 || (size_t)arg >= deps.size()) {
+          throw PonoException("Missing term for id " + std::to_string(arg));
+        }
+        deps[l_->id].push_back(arg);
+      }
+      if ((l_->tag == BTOR2_TAG_init || l_->tag == BTOR2_TAG_next)
+          && l_->nargs) {
+        // the state depends on its initial value and update
+        deps[std::abs(l_->args[0])].push_back(l_->id);
+      } else if (l_->tag == BTOR2_TAG_constraint) {
+        roots.push_back(l_->id);
+      } else if (l_->tag == BTOR2_TAG_bad
+                 && (int64_t)num_bad++ == prop_idx_) {
+        roots.push_back(l_->id);
+      }
+    }
+
     if (l_->tag == BTOR2_TAG_state) {
       if (!l_->symbol) { // if we see state has no name, record it
         unamed_state_ids.insert(l_->id);
@@ -229,24 +365,29 @@ void BTOR2Encoder::preprocess(const std::string& filename) {
     } // end of if input
   } // end of while
 
-  fclose(input_file);
-  btor2parser_delete(reader_);
+  if (lazy) {
+    in_cone_.assign(deps.size(), false);
+    while (roots.size()) {
+      int64_t id = roots.back();
+      roots.pop_back();
+      if (!in_cone_[id]) {
+        in_cone_[id] = true;
+        roots.insert(roots.end(), deps[id].begin(), deps[id].end());
+      }
+    }
+    logger.log(1,
+               "BTOR2Encoder: encoding {} of {} lines in the cone of property "
+               "{}",
+               std::count(in_cone_.begin(), in_cone_.end(), true),
+               deps.size(),
+               prop_idx_);
+  }
 } // end of preprocess
 
-void BTOR2Encoder::parse(const std::string filename)
+void BTOR2Encoder::parse()
 {
-  FILE * input_file = fopen(filename.c_str(), "r");
-
-  if (!input_file) {
-    throw PonoException("Could not open " + filename);
-  }
-
-  reader_ = btor2parser_new();
-
-  if (!btor2parser_read_lines(reader_, input_file)) {
-    throw PonoException(std::string(btor2parser_error(reader_)));
-  }
-
+  TIMELINE_SPAN("btor2_parse");
+  MEMORY_PHASE("btor2_parse");
   uint64_t num_states = 0;
   std::unordered_map<int64_t, uint64_t> id2statenum;
 
@@ -255,7 +396,27 @@ void BTOR2Encoder::parse(const std::string filename)
     /******************************** Identify sort
      * ********************************/
     if (l_->tag != BTOR2_TAG_sort && l_->sort.id) {
-      linesort_ = sorts_.at(l_->sort.id);
+      linesort_ = sort_at(l_->sort.id);
+    }
+
+    // ids are increasing, so the tables grow with the lines
+    if (terms_.size() <= (size_t)l_->id) {
+      terms_.resize(l_->id + 1);
+      sorts_.resize(l_->id + 1);
+    }
+
+    // outside of the cone of the selected property, only keep the
+    // positions of the states, inputs and properties
+    if (prop_idx_ >= 0 && l_->tag != BTOR2_TAG_sort && !in_cone_[l_->id]) {
+      if (l_->tag == BTOR2_TAG_state) {
+        statesvec_.push_back(Term());
+        num_states++;
+      } else if (l_->tag == BTOR2_TAG_input) {
+        inputsvec_.push_back(Term());
+      } else if (l_->tag == BTOR2_TAG_bad) {
+        propvec_.push_back(Term());
+      }
+      continue;
     }
 
     /******************************** Gather term arguments
@@ -269,11 +430,11 @@ void BTOR2Encoder::parse(const std::string filename)
         negated_ = true;
         idx_ = -idx_;
       }
-      if (terms_.find(idx_) == terms_.end()) {
+      if ((size_t)idx_ >= terms_.size() || !terms_[idx_]) {
         throw PonoException("Missing term for id " + std::to_string(idx_));
       }
 
-      Term term_ = terms_.at(idx_);
+      Term term_ = terms_[idx_];
       if (negated_) {
         if (term_->get_sort()->get_sort_kind() == BV) {
           term_ = solver_->make_term(BVNot, term_);
@@ -335,8 +496,8 @@ void BTOR2Encoder::parse(const std::string filename)
         }
         case BTOR2_TAG_SORT_array: {
           linesort_ = solver_->make_sort(ARRAY,
-                                         sorts_.at(l_->sort.array.index),
-                                         sorts_.at(l_->sort.array.element));
+                                         sort_at(l_->sort.array.index),
+                                         sort_at(l_->sort.array.element));
           sorts_[l_->id] = linesort_;
           break;
         }
@@ -417,12 +578,15 @@ void BTOR2Encoder::parse(const std::string filename)
       propvec_.push_back(prop);
       terms_[l_->id] = prop;
     } else if (l_->tag == BTOR2_TAG_justice) {
-      std::cout << "Warning: ignoring justice term" << std::endl;
-      justicevec_.push_back(termargs_[0]);
+      // only checked by the klive engine
+      TermVec conditions;
+      for (const auto & t : termargs_) {
+        conditions.push_back(bv_to_bool(t));
+      }
+      justicevec_.push_back(conditions);
       terms_[l_->id] = termargs_[0];
     } else if (l_->tag == BTOR2_TAG_fair) {
-      std::cout << "Warning: ignoring fair term" << std::endl;
-      fairvec_.push_back(termargs_[0]);
+      fairvec_.push_back(bv_to_bool(termargs_[0]));
       terms_[l_->id] = termargs_[0];
     } else if (l_->constant) {
       terms_[l_->id] =
@@ -739,12 +903,21 @@ void BTOR2Encoder::parse(const std::string filename)
       }
     }
 
+    // fold constants of the gates when they are built, the arguments are
+    // already folded
+    if (simplifier_ && terms_[l_->id] && l_->tag != BTOR2_TAG_state
+        && l_->tag != BTOR2_TAG_input && l_->tag != BTOR2_TAG_output
+        && l_->tag != BTOR2_TAG_constraint && l_->tag != BTOR2_TAG_init
+        && l_->tag != BTOR2_TAG_next && l_->tag != BTOR2_TAG_bad) {
+      terms_[l_->id] = simplifier_->simplify(terms_[l_->id]);
+    }
+
     // use the symbol to name the term (if applicable)
     // input, output, and state already named
     if (l_->symbol && l_->tag != BTOR2_TAG_input && l_->tag != BTOR2_TAG_output
-        && l_->tag != BTOR2_TAG_state && terms_.find(l_->id) != terms_.end()) {
+        && l_->tag != BTOR2_TAG_state && terms_[l_->id]) {
       try {
-        ts_.name_term(l_->symbol, terms_.at(l_->id));
+        ts_.name_term(l_->symbol, terms_[l_->id]);
       }
       catch (PonoException & e) {
         logger.log(1, "BTOR2Encoder Warning: {}", e.what());
@@ -752,10 +925,7 @@ void BTOR2Encoder::parse(const std::string filename)
     }
 
     // sort tag should be the only one that doesn't populate terms_
-    assert(l_->tag == BTOR2_TAG_sort || terms_.find(l_->id) != terms_.end());
+    assert(l_->tag == BTOR2_TAG_sort || terms_[l_->id]);
   }
-
-  fclose(input_file);
-  btor2parser_delete(reader_);
 }
 }  // namespace pono
@@ -24,12 +24,15 @@ extern "C" {
 #include <stdio.h>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include "assert.h"
 
 #include "core/ts.h"
 #include "utils/exceptions.h"
+#include "utils/term_walkers.h"
 
 #include "smt-switch/smt.h"
 
@@ -37,15 +40,44 @@ namespace pono {
 class BTOR2Encoder
 {
  public:
-  BTOR2Encoder(std::string filename, TransitionSystem & ts)
-      : ts_(ts), solver_(ts.solver())
+  /** Encode a BTOR2 file in ts
+   *  The file is read (through a memory mapping when possible) and
+   *  tokenized once, then the parsed lines are traversed twice.
+   *  @param filename the file
+   *  @param ts the transition system to encode the file in
+   *  @param simplify fold the constants of the gates while encoding them
+   *  @param prop_idx if non-negative, only encode the cone of the
+   *         prop_idx-th bad line (and the constraints), through the
+   *         arguments of the lines and the init and next lines of the
+   *         states. The vectors of states, inputs and properties keep
+   *         their size, with null terms for the ones outside of the cone.
+   */
+  BTOR2Encoder(std::string filename,
+               TransitionSystem & ts,
+               bool simplify = false,
+               int64_t prop_idx = -1)
+      : ts_(ts), solver_(ts.solver()), prop_idx_(prop_idx), reader_(nullptr)
   {
-    preprocess(filename);
-    parse(filename);
+    if (simplify) {
+      simplifier_.reset(new TermSimplifier(solver_));
+    }
+    read(filename);
+    try {
+      preprocess();
+      parse();
+    }
+    catch (...) {
+      btor2parser_delete(reader_);
+      throw;
+    }
+    btor2parser_delete(reader_);
+    reader_ = nullptr;
   };
 
   const smt::TermVec & propvec() const { return propvec_; };
-  const smt::TermVec & justicevec() const { return justicevec_; };
+  /** @return the conditions of each justice property, which all have to
+   *          hold infinitely often on a counterexample */
+  const std::vector<smt::TermVec> & justicevec() const { return justicevec_; };
   const smt::TermVec & fairvec() const { return fairvec_; };
   const smt::TermVec & inputsvec() const { return inputsvec_; }
   const smt::TermVec & statesvec() const { return statesvec_; }
@@ -63,11 +95,17 @@ class BTOR2Encoder
   // takes a list of booleans / bitvectors of size one
   // and lazily converts them to the majority
   smt::TermVec lazy_convert(const smt::TermVec &) const;
+
+  // the sort of a sort line, throws if there is none
+  smt::Sort sort_at(int64_t id) const;
   
-  // preprocess a btor2 file
-  void preprocess(const std::string & filename);
-  // parse a btor2 file
-  void parse(const std::string filename);
+  // read and tokenize a btor2 file into reader_, and reserve the tables
+  // indexed by id from a (parallel) scan of the mapped file
+  void read(const std::string & filename);
+  // find the names of the unnamed states from the lines of reader_
+  void preprocess();
+  // encode the lines of reader_
+  void parse();
 
   // Important members
   const smt::SmtSolver & solver_;
@@ -83,12 +121,16 @@ class BTOR2Encoder
   // Useful variables
   smt::Sort linesort_;
   smt::TermVec termargs_;
-  std::unordered_map<int, smt::Sort> sorts_;
-  std::unordered_map<int, smt::Term> terms_;
+  // indexed by the (dense) btor2 ids, null if undefined
+  std::vector<smt::Sort> sorts_;
+  std::vector<smt::Term> terms_;
+  std::unique_ptr<TermSimplifier> simplifier_;  ///< folds gates if set
+  int64_t prop_idx_;  ///< the selected property, negative for all
+  std::vector<bool> in_cone_;  ///< lines of the selected property's cone
   std::string symbol_;
 
   smt::TermVec propvec_;
-  smt::TermVec justicevec_;
+  std::vector<smt::TermVec> justicevec_;
   smt::TermVec fairvec_;
 
   Btor2Parser * reader_;
@@ -1,6 +1,9 @@
 #include "frontends/coreir_encoder.h"
 #include "utils/logger.h"
+#include "utils/memory_profile.h"
+#include "utils/timeline.h"
 
+#include <chrono>
 #include <iostream>
 #include <set>
 #include <sstream>
@@ -61,6 +64,9 @@ Module * CoreIREncoder::read_coreir_file(Context * c, std::string filename)
 
 void CoreIREncoder::encode()
 {
+  TIMELINE_SPAN("coreir_encode");
+  MEMORY_PHASE("coreir_encode");
+  auto begin = chrono::steady_clock::now();
   // expecting top_ to be non-null
   assert(top_);
 
@@ -76,6 +82,9 @@ void CoreIREncoder::encode()
 
   // start processing module
   def_ = top_->getDef();
+  if (!outputs_.empty()) {
+    compute_needed_instances();
+  }
 
   // used to determine which inputs of an instance have been processed
   unordered_map<Instance *, set<Wireable *>> covered_inputs;
@@ -84,8 +93,13 @@ void CoreIREncoder::encode()
   vector<Instance *> instances;
   set<Instance *> state_elements;
   unordered_map<Instance *, size_t> num_inputs;
-  bool arst;
+  size_t num_connections = 0;
   for (auto ipair : def_->getInstances()) {
+    if (!outputs_.empty() && needed_.find(ipair.second) == needed_.end()) {
+      // not in the cone of the outputs, never added to instances
+      continue;
+    }
+    bool arst = false;
     type_ = ipair.second->getType();
     if (instance_of(ipair.second, "coreir", "reg")
         || (arst = instance_of(ipair.second, "coreir", "reg_arst"))) {
@@ -152,6 +166,7 @@ void CoreIREncoder::encode()
     Instance * parent_inst;
     for (auto conn : elem.second->getLocalConnections()) {
       wire_connection(conn);
+      num_connections++;
       dst = conn.second;
       Type * typ = dst->getType();
 
@@ -217,6 +232,7 @@ void CoreIREncoder::encode()
     Instance * parent_inst;
     for (Connection conn : inst_out->getLocalConnections()) {
       wire_connection(conn);
+      num_connections++;
       dst = conn.second;
       type_ = dst->getType();
 
@@ -229,8 +245,7 @@ void CoreIREncoder::encode()
         parent_inst = dyn_cast<Instance>(parent);
 
         // state_elements have already been added to instances so ignore those
-        if (instance_of(parent_inst, "coreir", "reg")
-            || instance_of(parent_inst, "coreir", "reg_arst")) {
+        if (state_elements.find(parent_inst) != state_elements.end()) {
           continue;
         }
 
@@ -253,7 +268,9 @@ void CoreIREncoder::encode()
     }
   }
 
-  if (processed_instances != def_->getInstances().size()) {
+  size_t num_instances =
+      outputs_.empty() ? def_->getInstances().size() : needed_.size();
+  if (processed_instances != num_instances) {
     throw PonoException("Issue: not all instances processed in CoreIR Encoder");
   }
 
@@ -261,6 +278,70 @@ void CoreIREncoder::encode()
   for (auto st : state_elements) {
     process_state_element(st);
   }
+
+  double seconds =
+      chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+  stats_->set("instances", processed_instances);
+  stats_->set("skipped_instances",
+              def_->getInstances().size() - processed_instances);
+  stats_->set("connections", num_connections);
+  stats_->add_time("encode_time", seconds);
+  if (statistics_registry.enabled()) {
+    statistics_registry.add("coreir_encoder", stats_);
+  }
+  logger.log(1,
+             "CoreIREncoder: encoded {} of {} instances and {} connections "
+             "in {} seconds",
+             processed_instances,
+             def_->getInstances().size(),
+             num_connections,
+             seconds);
+}
+
+void CoreIREncoder::compute_needed_instances()
+{
+  vector<Instance *> todo;
+  for (const auto & name : outputs_) {
+    auto selects = def_->getInterface()->getSelects();
+    auto it = selects.find(name);
+    if (it == selects.end()) {
+      throw PonoException("CoreIREncoder: no output named " + name + " in "
+                          + top_->getName());
+    }
+    add_drivers(it->second, todo);
+  }
+
+  while (todo.size()) {
+    Instance * inst = todo.back();
+    todo.pop_back();
+    if (!needed_.insert(inst).second) {
+      continue;
+    }
+    for (auto elem : inst->getSelects()) {
+      Type * t = elem.second->getType();
+      if (t->isInput() || t->isInOut()) {
+        add_drivers(elem.second, todo);
+      }
+    }
+  }
+  logger.log(1,
+             "CoreIREncoder: {} of {} instances in the cone of the outputs",
+             needed_.size(),
+             def_->getInstances().size());
+}
+
+void CoreIREncoder::add_drivers(Wireable * w, vector<Instance *> & todo) const
+{
+  for (Wireable * c : w->getConnectedWireables()) {
+    Wireable * parent = c->getTopParent();
+    if (Instance::classof(parent)) {
+      todo.push_back(cast<Instance>(parent));
+    }
+  }
+  // the bit-selects are driven separately
+  for (auto elem : w->getSelects()) {
+    add_drivers(elem.second, todo);
+  }
 }
 
 Wireable * CoreIREncoder::process_instance(CoreIR::Instance * inst)
@@ -289,12 +370,11 @@ Wireable * CoreIREncoder::process_instance(CoreIR::Instance * inst)
     }
   } else if (name == "reg" || name == "reg_arst") {
     // NOTE: inputs to state_elements are not wired up until later
-    sort_ = solver_->make_sort(
-        BV, inst->getModuleRef()->getGenArgs().at("width")->get<int>());
+    sort_ = bv_sort(inst->getModuleRef()->getGenArgs().at("width")->get<int>());
     t_ = ts_.make_statevar(inst->toString(), sort_);
   } else if (nsname == "coreir" && name == "const") {
     size_t w = mod_->getGenArgs().at("width")->get<int>();
-    sort_ = solver_->make_sort(BV, w);
+    sort_ = bv_sort(w);
     t_ = solver_->make_term(
         (inst->getModArgs().at("value"))->get<BitVec>().binary_string(),
         sort_,
@@ -318,7 +398,7 @@ Wireable * CoreIREncoder::process_instance(CoreIR::Instance * inst)
     t_ = solver_->make_term(
         Concat, w2term_.at(inst->sel("in0")), w2term_.at(inst->sel("in1")));
   } else if (nsname == "coreir" && name == "undriven") {
-    sort_ = solver_->make_sort(BV, mod_->getGenArgs().at("width")->get<int>());
+    sort_ = bv_sort(mod_->getGenArgs().at("width")->get<int>());
     t_ = ts_.make_inputvar(inst->toString(), sort_);
   } else if (nsname == "corebit" && name == "undriven") {
     t_ = ts_.make_inputvar(inst->toString(), boolsort_);
@@ -501,16 +581,12 @@ void CoreIREncoder::wire_connection(Connection conn)
     Wireable * parent = dst_sel->getParent();
     size_t idx = stoi(dst_sel->getSelStr());
 
-    Term tparent;
-    if (w2term_.find(parent) == w2term_.end()) {
+    Term & tparent = w2term_[parent];
+    if (!tparent) {
       // create new "input" (actually more of a definition) for dst parent
-      // need a forward reference for it
+      // need a forward reference for it, cached in w2term_
       sort_ = compute_sort(parent);
       tparent = ts_.make_inputvar(parent->toString(), sort_);
-      // cache this symbol
-      w2term_[parent] = tparent;
-    } else {
-      tparent = w2term_.at(parent);
     }
 
     // expecting a bit-vector, cannot select from a Bool
@@ -534,15 +610,12 @@ void CoreIREncoder::wire_connection(Connection conn)
     size_t src_idx = stoi(src_sel->getSelStr());
     size_t dst_idx = stoi(dst_sel->getSelStr());
 
-    Term term_dst_parent;
-    if (w2term_.find(dst_parent) == w2term_.end()) {
+    Term & term_dst_parent = w2term_[dst_parent];
+    if (!term_dst_parent) {
       // create new "input" (actually more of a definition) for dst parent
-      // need a forward reference for it
+      // need a forward reference for it, cached in w2term_
       sort_ = compute_sort(dst_parent);
       term_dst_parent = ts_.make_inputvar(dst_parent->toString(), sort_);
-      w2term_[dst_parent] = term_dst_parent;
-    } else {
-      term_dst_parent = w2term_.at(dst_parent);
     }
 
     // expecting bit-vectors, cannot select from a Bool
@@ -560,27 +633,41 @@ void CoreIREncoder::wire_connection(Connection conn)
     tmpterm = t_;
   }
 
-  if (w2term_.find(dst) != w2term_.end()) {
+  // name and save the value for the dst
+  if (!w2term_.emplace(dst, tmpterm).second) {
     throw PonoException("CoreIREncoder error. Multiple drivers for "
                         + dst->toString());
   }
-
-  // name and save the value for the dst
-  w2term_[dst] = tmpterm;
   ts_.name_term(dst->toString(), tmpterm);
 }
 
 Sort CoreIREncoder::compute_sort(CoreIR::Wireable * w)
 {
   Type * t = w->getType();
+  auto it = type2sort_.find(t);
+  if (it != type2sort_.end()) {
+    return it->second;
+  }
   Sort s;
   if (t->getKind() == CoreIR::Type::TypeKind::TK_Array) {
     // bit-vector sort -- array of bits
-    s = solver_->make_sort(BV, t->getSize());
+    s = bv_sort(t->getSize());
   } else {
     // boolean sort
     s = boolsort_;
   }
+  type2sort_[t] = s;
+  return s;
+}
+
+Sort CoreIREncoder::bv_sort(size_t width)
+{
+  auto it = bv_sorts_.find(width);
+  if (it != bv_sorts_.end()) {
+    return it->second;
+  }
+  Sort s = solver_->make_sort(BV, width);
+  bv_sorts_[width] = s;
   return s;
 }
 
@@ -1,24 +1,36 @@
+#include <memory>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "coreir.h"
 
 #include "core/rts.h"
 #include "smt-switch/smt.h"
+#include "utils/statistics.h"
 
 namespace pono {
 class CoreIREncoder
 {
  public:
+  /** Encodes a CoreIR design
+   *  @param outputs if not empty, only the instances in the cone-of-
+   *         influence of these outputs of the top module (through the
+   *         registers) are encoded, e.g. when the properties only use them
+   */
   CoreIREncoder(std::string filename,
                 RelationalTransitionSystem & ts,
-                bool force_abstract_clock = false)
+                bool force_abstract_clock = false,
+                const std::vector<std::string> & outputs = {})
       : ts_(ts),
         solver_(ts.solver()),
         c_(CoreIR::newContext()),
         num_clocks_(0),
         can_abstract_clock_(true),
-        force_abstract_clock_(force_abstract_clock)
+        force_abstract_clock_(force_abstract_clock),
+        outputs_(outputs),
+        stats_(std::make_shared<Statistics>())
   {
     c_->getLibraryManager()->loadLib("commonlib");
     bvsort1_ = solver_->make_sort(smt::BV, 1);
@@ -30,14 +42,17 @@ class CoreIREncoder
 
   CoreIREncoder(CoreIR::Module * m,
                 RelationalTransitionSystem & ts,
-                bool force_abstract_clock = false)
+                bool force_abstract_clock = false,
+                const std::vector<std::string> & outputs = {})
       : top_(m),
         ts_(ts),
         solver_(ts.solver()),
         c_(m->getContext()),
         num_clocks_(0),
         can_abstract_clock_(true),
-        force_abstract_clock_(force_abstract_clock)
+        force_abstract_clock_(force_abstract_clock),
+        outputs_(outputs),
+        stats_(std::make_shared<Statistics>())
   {
     c_->getLibraryManager()->loadLib("commonlib");
     bvsort1_ = solver_->make_sort(smt::BV, 1);
@@ -47,6 +62,9 @@ class CoreIREncoder
     encode();
   }
 
+  /** @return the instances, connections and time of the encoding */
+  const Statistics & statistics() const { return *stats_; }
+
  protected:
   static CoreIR::Module * read_coreir_file(CoreIR::Context * c,
                                            std::string filename);
@@ -93,6 +111,19 @@ class CoreIREncoder
    */
   smt::Sort compute_sort(CoreIR::Wireable * w);
 
+  /** @return the bit-vector sort of width, cached */
+  smt::Sort bv_sort(size_t width);
+
+  /** Fills needed_ with the instances in the cone-of-influence of
+   *  outputs_, following the drivers of the inputs of each instance
+   *  @throws PonoException if an output is not in the interface
+   */
+  void compute_needed_instances();
+
+  /** Adds the instances driving w or its bit-selects to todo */
+  void add_drivers(CoreIR::Wireable * w,
+                   std::vector<CoreIR::Instance *> & todo) const;
+
   RelationalTransitionSystem & ts_;
   smt::SmtSolver solver_;
   CoreIR::Context * c_;
@@ -101,9 +132,16 @@ class CoreIREncoder
   bool can_abstract_clock_;  ///< stays true if it's safe to abstract the clock
   bool force_abstract_clock_;  ///< force the clock to be abstracted
                                ///< (synchronizes async behavior)
+  std::vector<std::string> outputs_;  ///< encode only their cone if not empty
+  std::unordered_set<CoreIR::Instance *> needed_;  ///< the cone of outputs_
+
+  std::shared_ptr<Statistics> stats_;
 
   // conversion data structures
   std::unordered_map<CoreIR::Wireable *, smt::Term> w2term_;
+  // the types are unique in a CoreIR context
+  std::unordered_map<CoreIR::Type *, smt::Sort> type2sort_;
+  std::unordered_map<size_t, smt::Sort> bv_sorts_;
 
   // useful reusable variables
   smt::Sort bvsort1_;
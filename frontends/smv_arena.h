@@ -0,0 +1,106 @@
+/*********************                                                        */
+/*! \file smv_arena.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief An arena for the nodes of the SMV syntax tree, which are only
+**        freed together once the system is encoded, and a pool of
+**        interned identifier strings.
+**
+**/
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace pono {
+
+class SMVArena
+{
+ public:
+  SMVArena() : used_(block_size) {}
+
+  ~SMVArena() { clear(); }
+
+  SMVArena(const SMVArena &) = delete;
+  SMVArena & operator=(const SMVArena &) = delete;
+
+  /** Construct a T in the arena
+   *  @return a pointer that stays valid until clear
+   */
+  template <class T, class... Args>
+  T * make(Args &&... args)
+  {
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "over-aligned SMV node");
+    T * res = new (allocate(sizeof(T))) T(std::forward<Args>(args)...);
+    dtors_.push_back({ res, [](void * p) { static_cast<T *>(p)->~T(); } });
+    return res;
+  }
+
+  /** @return the interned copy of s, valid until clear */
+  const std::string & intern(const std::string & s)
+  {
+    return *strings_.insert(s).first;
+  }
+
+  /** Destroy all the objects (in reverse order) and free their memory
+   *  The strings from intern are freed as well.
+   */
+  void clear()
+  {
+    for (auto it = dtors_.rbegin(); it != dtors_.rend(); ++it) {
+      it->second(it->first);
+    }
+    dtors_.clear();
+    blocks_.clear();
+    large_.clear();
+    used_ = block_size;
+    strings_.clear();
+  }
+
+  /** @return the number of objects in the arena */
+  size_t size() const { return dtors_.size(); }
+
+ private:
+  static const size_t block_size = 64 * 1024;
+
+  void * allocate(size_t n)
+  {
+    // keep every object aligned for any type
+    const size_t align = alignof(std::max_align_t);
+    n = (n + align - 1) / align * align;
+    if (n > block_size) {
+      // too big for a block, give it its own
+      large_.emplace_back(new std::max_align_t[n / align]);
+      return large_.back().get();
+    }
+    if (used_ + n > block_size) {
+      blocks_.emplace_back(new std::max_align_t[block_size / align]);
+      used_ = 0;
+    }
+    void * res = reinterpret_cast<char *>(blocks_.back().get()) + used_;
+    used_ += n;
+    return res;
+  }
+
+  std::vector<std::unique_ptr<std::max_align_t[]>> blocks_;
+  std::vector<std::unique_ptr<std::max_align_t[]>> large_;
+  size_t used_;  ///< bytes used in the last block
+  ///< objects in construction order with their destructor
+  std::vector<std::pair<void *, void (*)(void *)>> dtors_;
+  std::unordered_set<std::string> strings_;
+};
+
+}  // namespace pono
@@ -1,11 +1,20 @@
 #include "smv_encoder.h"
 
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "utils/logger.h"
+#include "utils/memory_profile.h"
+#include "utils/timeline.h"
+
 using namespace smt;
 using namespace pono;
 using namespace std;
 
 int pono::SMVEncoder::parse(std::string filename)
 {
+  TIMELINE_SPAN("smv_parse");
+  MEMORY_PHASE("smv_parse");
   std::ifstream ifs;
   ifs.open(filename);
   if (!ifs.good()) {
@@ -63,6 +72,25 @@ void pono::SMVEncoder::processCase()
     solver_->pop();
   }
 }
+void pono::SMVEncoder::release_ast()
+{
+  logger.log(2, "SMV: freeing {} syntax tree nodes", arena_.size());
+  // everything below points into the arena
+  caseterm_.clear();
+  module_list.clear();
+  define_list_.clear();
+  assign_list_.clear();
+  ivar_list_.clear();
+  var_list_.clear();
+  frozenvar_list_.clear();
+  fun_list_.clear();
+  init_list_.clear();
+  trans_list_.clear();
+  invar_list_.clear();
+  invarspec_list_.clear();
+  arena_.clear();
+}
+
 //change the input stream to output stringstream 
 int pono::SMVEncoder::parse_flat(std::istream & s)
 {
@@ -73,7 +101,10 @@ int pono::SMVEncoder::parse_flat(std::istream & s)
 }
 
 //modular SMV preprocess
-std::stringstream pono::SMVEncoder::preprocess()
+// the flattened module is streamed through a temporary file, which is
+// unlinked once it is opened for the parser, so that large generated
+// models are never held in memory as text
+int pono::SMVEncoder::preprocess()
 {
   module_node * main_n;
   if (module_list.find("main") != module_list.end()) {
@@ -81,16 +112,35 @@ std::stringstream pono::SMVEncoder::preprocess()
   } else {
     throw PonoException("no main module found");
   }
-  std::stringstream str;
-  str << "MODULE main" << std::endl;
-  main_n->process_main(module_list, str);
+
+  const char * tmpdir = getenv("TMPDIR");
+  std::string path = tmpdir ? tmpdir : "/tmp";
+  path += "/pono_smv_XXXXXX";
+  int fd = mkstemp(&path[0]);
+  if (fd < 0) {
+    throw PonoException("could not create a file for the flattened module");
+  }
+  close(fd);
+
+  std::ifstream flat;
+  try {
+    std::ofstream str(path);
+    str << "MODULE main" << std::endl;
+    main_n->process_main(module_list, str);
+    str.close();
+    if (!str) {
+      throw PonoException("could not write the flattened module to " + path);
+    }
+    flat.open(path);
+  }
+  catch (...) {
+    unlink(path.c_str());
+    throw;
+  }
+  unlink(path.c_str());
+  if (!flat.good()) {
+    throw PonoException("could not read the flattened module");
+  }
   // TODO add a command line flag to re-enable dumping the debug file
-  // generate text file
-  // if(module_flat){
-  //   std::string flatten =file.substr(0,file.find_last_of(".")) +
-  //   "_flatten.txt"; std::ofstream ofile(flatten); ofile << str.str()
-  //   <<std::endl; ofile.close();
-  // }
-  parse_flat(str);
-  return str;
+  return parse_flat(flat);
 }
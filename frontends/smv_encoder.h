@@ -18,6 +18,7 @@
 #include "smt-switch/smt.h"
 #include "utils/exceptions.h"
 
+#include "frontends/smv_arena.h"
 #include "frontends/smvscanner.h"
 #include "smvparser.h"
 #include "smvscanner.h"
@@ -36,8 +37,9 @@ class SMVEncoder
     preprocess();
     module_flat = true;
     loc.end.line = 0;
-    std::string output= preprocess().str();
+    preprocess();
     processCase();
+    release_ast();
   };
 
  public:
@@ -48,8 +50,11 @@ class SMVEncoder
   smt::Term parseString(std::string newline);
   location loc;
   void processCase();
-  std::stringstream preprocess();
+  // flatten the main module and parse it from a stream
+  int preprocess();
   smt::TermVec propvec() { return propvec_; }
+  /** Free the syntax tree once the system is encoded */
+  void release_ast();
 
   smt::Term parse_term;
   const smt::SmtSolver & solver_;
@@ -74,6 +79,8 @@ class SMVEncoder
   ///< caseterm_: used to temporaily store each statement in case body before future process check that the conditions cover all possibilities (required by nuXmv manual)
   std::vector<smt::Term> casecheck_;
   std::vector<std::pair<SMVnode*,SMVnode*>> caseterm_;
+  ///< arena_: owns the nodes of the syntax tree and the interned names
+  SMVArena arena_;
   ///< module_list: map from module name to module node
   std::unordered_map<std::string,module_node*> module_list;
   // indicate whether needs to flatten module first
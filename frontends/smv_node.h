@@ -160,6 +160,12 @@ class module_node
   element_node * invar_li;
   element_node * invarspec_li;
 
+  static element_node * empty_list()
+  {
+    static element_node empty;
+    return &empty;
+  }
+
  public:
   module_node(std::string name) { module_name = name; }
   module_node(std::string name, std::vector<string> id_list)
@@ -173,16 +179,17 @@ class module_node
   {
     module_name = name;
     par_li = id_list;
-    var_li = new element_node();
-    ivar_li = new element_node();
-    define_li = new element_node();
-    assign_li = new element_node();
-    frozenvar_li = new element_node();
-    fun_li = new element_node();
-    init_li = new element_node();
-    trans_li = new element_node();
-    invar_li = new element_node();
-    invarspec_li = new element_node();
+    // the sections that are missing share one empty list
+    var_li = empty_list();
+    ivar_li = empty_list();
+    define_li = empty_list();
+    assign_li = empty_list();
+    frozenvar_li = empty_list();
+    fun_li = empty_list();
+    init_li = empty_list();
+    trans_li = empty_list();
+    invar_li = empty_list();
+    invarspec_li = empty_list();
     for (std::unordered_map<SMVnode::NodeMtype, element_node *>::iterator it =
              decl_map.begin();
          it != decl_map.end();
@@ -204,16 +211,17 @@ class module_node
               std::unordered_map<SMVnode::NodeMtype, element_node *> decl_map)
   {
     module_name = name;
-    var_li = new element_node();
-    ivar_li = new element_node();
-    define_li = new element_node();
-    assign_li = new element_node();
-    frozenvar_li = new element_node();
-    fun_li = new element_node();
-    init_li = new element_node();
-    trans_li = new element_node();
-    invar_li = new element_node();
-    invarspec_li = new element_node();
+    // the sections that are missing share one empty list
+    var_li = empty_list();
+    ivar_li = empty_list();
+    define_li = empty_list();
+    assign_li = empty_list();
+    frozenvar_li = empty_list();
+    fun_li = empty_list();
+    init_li = empty_list();
+    trans_li = empty_list();
+    invar_li = empty_list();
+    invarspec_li = empty_list();
     for (std::unordered_map<SMVnode::NodeMtype, element_node *>::iterator it =
              decl_map.begin();
          it != decl_map.end();
@@ -654,10 +662,10 @@ class invarspec_node : public element_node
 
 class constant : public SMVnode
 {
-  string in;
+  const string & in;  ///< interned in the SMVArena of the encoder
 
  public:
-  constant(std::string input) { in = input; }
+  constant(const std::string & input) : in(input) {}
   void generate_ostream(std::string name,
                         std::string prefix,
                         std::unordered_map<string, module_node *> module_list,
@@ -667,10 +675,10 @@ class constant : public SMVnode
 
 class identifier : public SMVnode
 {
-  string in;
+  const string & in;  ///< interned in the SMVArena of the encoder
 
  public:
-  identifier(std::string input) { in = input; }
+  identifier(const std::string & input) : in(input) {}
   void generate_ostream(std::string name,
                         std::string prefix,
                         std::unordered_map<string, module_node *> module_list,
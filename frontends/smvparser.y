@@ -115,12 +115,12 @@ header:
 module_decl:
     MODULE complex_identifier {
       if(!enc.module_flat){
-      enc.module_list[$2] = new module_node($2);
+      enc.module_list[$2] = enc.arena_.make<module_node>($2);
       }
     }
   | MODULE complex_identifier module_body {
      if(!enc.module_flat){
-      enc.module_list[$2] = new module_node($2,$3);
+      enc.module_list[$2] = enc.arena_.make<module_node>($2,$3);
       enc.define_list_.clear();
       enc.ivar_list_.clear();
       enc.var_list_.clear();
@@ -135,12 +135,12 @@ module_decl:
   }
   | MODULE complex_identifier "(" module_parameters ")" {
    if(!enc.module_flat){
-    enc.module_list[$2] = new module_node($2,$4);
+    enc.module_list[$2] = enc.arena_.make<module_node>($2,$4);
    }
   }
   | MODULE complex_identifier "(" module_parameters ")" module_body {
     if(!enc.module_flat){
-      enc.module_list[$2] = new module_node($2,$4,$6);
+      enc.module_list[$2] = enc.arena_.make<module_node>($2,$4,$6);
       enc.define_list_.clear();
       enc.ivar_list_.clear();
       enc.var_list_.clear();
@@ -192,51 +192,51 @@ module_body:
 module_element:
      define_decl {
       if(!enc.module_flat){
-       $$ = new define_node(enc.define_list_,SMVnode::DEFINE);
+       $$ = enc.arena_.make<define_node>(enc.define_list_,SMVnode::DEFINE);
       }
      }
     | assign_decl {
-      $$ = new assign_node(enc.assign_list_,SMVnode::ASSIGN);
+      $$ = enc.arena_.make<assign_node>(enc.assign_list_,SMVnode::ASSIGN);
     }
     | ivar_test {
       if(!enc.module_flat){
-       $$ = new ivar_node(enc.ivar_list_,SMVnode::IVAR);
+       $$ = enc.arena_.make<ivar_node>(enc.ivar_list_,SMVnode::IVAR);
       }
     }
     | var_test {
       if(!enc.module_flat){
-      $$ = new var_node(enc.var_list_,SMVnode::VAR);
+      $$ = enc.arena_.make<var_node>(enc.var_list_,SMVnode::VAR);
       }
     }
     | frozenvar_test {
       if(!enc.module_flat){
-      $$ = new frozenvar_node(enc.frozenvar_list_,SMVnode::FROZENVAR);
+      $$ = enc.arena_.make<frozenvar_node>(enc.frozenvar_list_,SMVnode::FROZENVAR);
       }
     }
     | fun_list {
       if (!enc.module_flat)
       {
-        $$ = new fun_node(enc.fun_list_, SMVnode::FUN);
+        $$ = enc.arena_.make<fun_node>(enc.fun_list_, SMVnode::FUN);
       }
     }
     | init_constraint{
      if(!enc.module_flat){
-      $$ = new init_node(enc.init_list_,SMVnode::INIT);
+      $$ = enc.arena_.make<init_node>(enc.init_list_,SMVnode::INIT);
      }
     }
     | trans_constraint{
     if(!enc.module_flat){
-      $$ = new trans_node(enc.trans_list_,SMVnode::TRANS);
+      $$ = enc.arena_.make<trans_node>(enc.trans_list_,SMVnode::TRANS);
       }
     }
     | invar_constraint{
     if(!enc.module_flat){
-      $$ = new invar_node(enc.invar_list_,SMVnode::INVAR);
+      $$ = enc.arena_.make<invar_node>(enc.invar_list_,SMVnode::INVAR);
     }
     }
     | invarspec_test{
    if(!enc.module_flat){
-      $$ = new invarspec_node(enc.invarspec_list_,SMVnode::INVARSPEC);
+      $$ = enc.arena_.make<invarspec_node>(enc.invarspec_list_,SMVnode::INVARSPEC);
     }
     }
 
@@ -261,7 +261,7 @@ define_body: complex_identifier ASSIGNSYM basic_expr semioption {
                enc.arrayint_[$1] = a->getElementType();
               }
   }else{
-      enc.define_list_.push_back(new define_node_c($1,$3));
+      enc.define_list_.push_back(enc.arena_.make<define_node_c>($1,$3));
   }
 };
 
@@ -277,7 +277,7 @@ assign_test: complex_identifier ASSIGNSYM simple_expr {
           smt::Term assign = enc.solver_->make_term(smt::Equal, e, a->getTerm());
           enc.rts_.add_constraint(assign);
   }else{
-      enc.assign_list_.push_back(new assign_node_c("",$1,$3));
+      enc.assign_list_.push_back(enc.arena_.make<assign_node_c>("",$1,$3));
   }
 }
         | TOK_INIT "(" complex_identifier ")" ASSIGNSYM simple_expr{
@@ -287,7 +287,7 @@ assign_test: complex_identifier ASSIGNSYM simple_expr {
           smt::Term e = enc.solver_->make_term(smt::Equal, init, a->getTerm());
           enc.rts_.constrain_init(e);
         }else{
-         enc.assign_list_.push_back(new assign_node_c("init",$3,$6));
+         enc.assign_list_.push_back(enc.arena_.make<assign_node_c>("init",$3,$6));
         }
         }
         | TOK_NEXT "(" complex_identifier ")" ASSIGNSYM basic_expr {
@@ -303,7 +303,7 @@ assign_test: complex_identifier ASSIGNSYM simple_expr {
             enc.rts_.constrain_trans(enc.rts_.make_term(smt::Equal, enc.rts_.next(state), a->getTerm()));
           }
           }else{
-          enc.assign_list_.push_back(new assign_node_c("next",$3,$6));
+          enc.assign_list_.push_back(enc.arena_.make<assign_node_c>("next",$3,$6));
           }
         };
 
@@ -329,7 +329,7 @@ ivar_list:
         }
          enc.terms_[$1] = input;
         }else{
-          SMVnode *a = new ivar_node_c($1,$3);
+          SMVnode *a = enc.arena_.make<ivar_node_c>($1,$3);
           enc.ivar_list_.push_back(a);
         }
     };
@@ -354,15 +354,15 @@ var_list:
           enc.arrayint_[$1] = a->getElementType();
          } 
       }else{
-          SMVnode *a = new var_node_c($1,$3,SMVnode::BasicT);
-          enc.var_list_.push_back(new var_node_c($1,$3,SMVnode::BasicT));
+          SMVnode *a = enc.arena_.make<var_node_c>($1,$3,SMVnode::BasicT);
+          enc.var_list_.push_back(enc.arena_.make<var_node_c>($1,$3,SMVnode::BasicT));
       }
     }
     | complex_identifier ":" module_type_identifier semioption{
       if(enc.module_flat){
         throw PonoException("module preprocess error");
       }else{
-         enc.var_list_.push_back(new var_node_c($1,$3,SMVnode::ModuleT));
+         enc.var_list_.push_back(enc.arena_.make<var_node_c>($1,$3,SMVnode::ModuleT));
       }
     }
     ;
@@ -380,7 +380,7 @@ fun_decl:
     }
     else
     {
-      SMVnode * f = new fun_node_c($1, $3);
+      SMVnode * f = enc.arena_.make<fun_node_c>($1, $3);
       enc.fun_list_.push_back(f);
     }
   }
@@ -388,10 +388,10 @@ fun_decl:
 
 module_type_identifier:
   complex_identifier{
-    $$ = new type_node($1);
+    $$ = enc.arena_.make<type_node>($1);
   }
   | complex_identifier "(" parameter_list ")" {
-    $$ = new type_node($1,$3);
+    $$ = enc.arena_.make<type_node>($1,$3);
   }
 
 parameter_list:
@@ -430,7 +430,7 @@ frozenvar_list:
       enc.rts_.constrain_trans(e);
       enc.transterm_.push_back(make_pair(enc.loc.end.line,e));
     }else{
-      SMVnode *a = new frozenvar_node_c($1,$3);
+      SMVnode *a = enc.arena_.make<frozenvar_node_c>($1,$3);
       enc.frozenvar_list_.push_back(a);
     }
   };
@@ -442,7 +442,7 @@ init_list: simple_expr semioption{
         SMVnode *a = $1;
         enc.rts_.constrain_init(a->getTerm());
   }else{
-    SMVnode *a = new init_node_c($1);
+    SMVnode *a = enc.arena_.make<init_node_c>($1);
     enc.init_list_.push_back(a);
   }
       };
@@ -455,7 +455,7 @@ trans_list: basic_expr semioption{
             enc.rts_.constrain_trans(a->getTerm());
             case_true = false;
   }else{
-    SMVnode *a = new trans_node_c($1);
+    SMVnode *a = enc.arena_.make<trans_node_c>($1);
     enc.trans_list_.push_back(a);
   }
 };
@@ -470,7 +470,7 @@ invar_list: basic_expr semioption{
             enc.transterm_.push_back(make_pair(enc.loc.end.line,a->getTerm()));
             enc.transterm_.push_back(make_pair(enc.loc.end.line,enc.rts_.next(a->getTerm())));
   }else{
-     SMVnode *a = new invar_node_c($1);
+     SMVnode *a = enc.arena_.make<invar_node_c>($1);
     enc.invar_list_.push_back(a);
   }
 };
@@ -484,7 +484,7 @@ invarspec_list: basic_expr semioption {
                 smt::Term prop = a->getTerm();
                 enc.propvec_.push_back(prop);
   }else{
-    SMVnode *a = new invarspec_node_c($1);
+    SMVnode *a = enc.arena_.make<invarspec_node_c>($1);
     enc.invarspec_list_.push_back(a);
   }
 };
@@ -492,28 +492,28 @@ invarspec_list: basic_expr semioption {
 constant: boolean_constant {
   if(enc.module_flat){
       smt::Term con = enc.solver_->make_term($1);
-      $$ = new SMVnode(con,SMVnode::Boolean);
+      $$ = enc.arena_.make<SMVnode>(con,SMVnode::Boolean);
   }else{
-    if($1) $$ = new constant("TRUE");
-    else $$ = new constant("FALSE");
+    if($1) $$ = enc.arena_.make<constant>(enc.arena_.intern("TRUE"));
+    else $$ = enc.arena_.make<constant>(enc.arena_.intern("FALSE"));
   }
 }
           | integer_constant {
             if(enc.module_flat){
             smt::Sort sort_ = enc.solver_->make_sort(smt::INT);
             smt::Term con = enc.solver_->make_term($1,sort_);
-            $$ = new SMVnode(con,SMVnode::Integer);
+            $$ = enc.arena_.make<SMVnode>(con,SMVnode::Integer);
             }else{
-          $$ = new constant($1);
+          $$ = enc.arena_.make<constant>(enc.arena_.intern($1));
           }
 }
           | real_constant{
             if(enc.module_flat){
             smt::Sort sort_ = enc.solver_->make_sort(smt::REAL);
             smt::Term con = enc.solver_->make_term($1,sort_);
-            $$ = new SMVnode(con,SMVnode::Real);
+            $$ = enc.arena_.make<SMVnode>(con,SMVnode::Real);
             }else{
-            $$ = new constant($1);
+            $$ = enc.arena_.make<constant>(enc.arena_.intern($1));
             }
           }
           | word_value {
@@ -522,7 +522,7 @@ constant: boolean_constant {
             }else{
               SMVnode *wv = $1;
               string n = wv ->getName();
-              $$ = new type_node(n);
+              $$ = enc.arena_.make<type_node>(n);
             }
           }
           | range_constant{
@@ -548,10 +548,10 @@ word_value: word_index1 integer_val "_" integer_val {
               base = 2;
           }
           smt::Term num = enc.solver_->make_term($4, sort_, base);
-          $$ = new SMVnode(num, SMVnode::Unsigned); }
+          $$ = enc.arena_.make<SMVnode>(num, SMVnode::Unsigned); }
           else{
             string n = $1 + $2 + "_" + $4;
-            $$ = new type_node(n);
+            $$ = enc.arena_.make<type_node>(n);
         } }
         | word_index2 integer_val "_" integer_val {
         if(enc.module_flat){
@@ -583,10 +583,10 @@ word_value: word_index1 integer_val "_" integer_val {
               base = 2;
           }
           smt::Term num = enc.solver_->make_term($4, sort_, base);
-          $$ = new SMVnode(num,bvt);
+          $$ = enc.arena_.make<SMVnode>(num,bvt);
         }else{
             string n = $1 + $2 + "_" + $4;
-            $$ = new type_node(n);
+            $$ = enc.arena_.make<type_node>(n);
         }
    };
 
@@ -629,31 +629,31 @@ simple_expr: constant {
             if(enc.module_flat){
               smt::Term tok = enc.terms_.at($1);
               if (enc.unsignedbv_.find($1) != enc.unsignedbv_.end() ) {
-                $$ = new SMVnode(tok, SMVnode::Unsigned);
+                $$ = enc.arena_.make<SMVnode>(tok, SMVnode::Unsigned);
               } else if(enc.signedbv_.find($1) != enc.signedbv_.end()){
-                $$ = new SMVnode(tok, SMVnode::Signed);
+                $$ = enc.arena_.make<SMVnode>(tok, SMVnode::Signed);
               } else if(enc.arrayty_.find($1) != enc.arrayty_.end()){
-                $$ = new SMVnode(tok, SMVnode::WordArray,enc.arrayty_[$1]);
+                $$ = enc.arena_.make<SMVnode>(tok, SMVnode::WordArray,enc.arrayty_[$1]);
               } else if(enc.arrayint_.find($1) != enc.arrayint_.end()){
-                $$ = new SMVnode(tok, SMVnode::IntArray,enc.arrayint_[$1]);
+                $$ = enc.arena_.make<SMVnode>(tok, SMVnode::IntArray,enc.arrayint_[$1]);
               }
               else{
                 smt::SortKind kind_ = tok->get_sort()->get_sort_kind();
                 assert(tok);
-                if (kind_ == smt::BV || kind_ == smt::BOOL) $$ = new SMVnode(tok,SMVnode::Boolean);
-                else if (kind_ == smt::INT) $$ = new SMVnode(tok,SMVnode::Integer);
-                else if (kind_ == smt::REAL) $$ = new SMVnode(tok,SMVnode::Real);
+                if (kind_ == smt::BV || kind_ == smt::BOOL) $$ = enc.arena_.make<SMVnode>(tok,SMVnode::Boolean);
+                else if (kind_ == smt::INT) $$ = enc.arena_.make<SMVnode>(tok,SMVnode::Integer);
+                else if (kind_ == smt::REAL) $$ = enc.arena_.make<SMVnode>(tok,SMVnode::Real);
                 else throw PonoException("The type of the identifier is wrong");
               }
             }else{
-              $$ = new identifier($1);
+              $$ = enc.arena_.make<identifier>(enc.arena_.intern($1));
               }
             }
             | "(" basic_expr ")"{
               if(enc.module_flat){
               $$ = $2;
               }else{
-              $$ = new par_expr($2);
+              $$ = enc.arena_.make<par_expr>($2);
               }
             }
             | OP_NOT basic_expr {
@@ -671,9 +671,9 @@ simple_expr: constant {
                else  e = enc.solver_->make_term(smt::BVNot, a->getTerm());
               }
               assert(e);    //check e non-null
-              $$ = new SMVnode(e,bvs_a);
+              $$ = enc.arena_.make<SMVnode>(e,bvs_a);
             }else{
-              $$ = new not_expr($2);
+              $$ = enc.arena_.make<not_expr>($2);
               }
             }
             | basic_expr OP_AND basic_expr {
@@ -700,9 +700,9 @@ simple_expr: constant {
                 else e = enc.solver_->make_term(smt::BVAnd, a->getTerm(), b->getTerm());
               }
                 assert(e);    //check e in non-null
-                $$ = new SMVnode(e,bvs_a);
+                $$ = enc.arena_.make<SMVnode>(e,bvs_a);
             }else{
-              $$ = new and_expr($1,$3);
+              $$ = enc.arena_.make<and_expr>($1,$3);
               }
             }
             | basic_expr OP_OR basic_expr{
@@ -729,9 +729,9 @@ simple_expr: constant {
                 else e = enc.solver_->make_term(smt::BVOr, a->getTerm(), b->getTerm());
               }
                 assert(e);    //check e in non-null
-                $$ = new SMVnode(e,bvs_a);
+                $$ = enc.arena_.make<SMVnode>(e,bvs_a);
               }else{
-              $$ = new or_expr($1,$3);
+              $$ = enc.arena_.make<or_expr>($1,$3);
               }
             }
             | basic_expr OP_XOR basic_expr {
@@ -758,9 +758,9 @@ simple_expr: constant {
                 else e = enc.solver_->make_term(smt::BVXor, a->getTerm(), b->getTerm());
               }
                 assert(e);    //check e in non-null
-                $$ = new SMVnode(e,bvs_a);
+                $$ = enc.arena_.make<SMVnode>(e,bvs_a);
               }else{
-              $$ = new xor_expr($1,$3);
+              $$ = enc.arena_.make<xor_expr>($1,$3);
               }
             }
             | basic_expr OP_XNOR basic_expr{
@@ -787,9 +787,9 @@ simple_expr: constant {
                 else e = enc.solver_->make_term(smt::BVXnor, a->getTerm(), b->getTerm());
               }
                 assert(e);    //check e in non-null
-                $$ = new SMVnode(e,bvs_a);
+                $$ = enc.arena_.make<SMVnode>(e,bvs_a);
               }else{
-              $$ = new xor_expr($1,$3);
+              $$ = enc.arena_.make<xor_expr>($1,$3);
               }
             }
             | basic_expr OP_IMPLY basic_expr{
@@ -813,9 +813,9 @@ simple_expr: constant {
               e = enc.solver_->make_term(smt::Implies, a->getTerm(), b->getTerm());
               }
               assert(e);
-              $$ = new SMVnode(e,bvs_a);
+              $$ = enc.arena_.make<SMVnode>(e,bvs_a);
               }else{
-              $$ = new imp_expr($1,$3);
+              $$ = enc.arena_.make<imp_expr>($1,$3);
               }
             }
             | basic_expr OP_BI basic_expr{
@@ -839,9 +839,9 @@ simple_expr: constant {
               e = enc.solver_->make_term(smt::Equal, a->getTerm(), b->getTerm());
               }
               assert(e);
-              $$ = new SMVnode(e,bvs_a);
+              $$ = enc.arena_.make<SMVnode>(e,bvs_a);
               }else{
-              $$ = new iff_expr($1,$3);
+              $$ = enc.arena_.make<iff_expr>($1,$3);
               }
             }
             | basic_expr OP_EQ basic_expr {
@@ -859,9 +859,9 @@ simple_expr: constant {
                e = enc.solver_->make_term(smt::Equal, a->getTerm(), b->getTerm());
               }
               assert(e);
-              $$ = new SMVnode(e,SMVnode::Boolean);
+              $$ = enc.arena_.make<SMVnode>(e,SMVnode::Boolean);
               }else{
-              $$ = new eq_expr($1,$3);
+              $$ = enc.arena_.make<eq_expr>($1,$3);
               }
             }
             | basic_expr OP_NEQ basic_expr {
@@ -879,9 +879,9 @@ simple_expr: constant {
                 e = enc.solver_->make_term(smt::Distinct, a->getTerm(), b->getTerm());
               }
                 assert(e);
-                $$ = new SMVnode(e,SMVnode::Boolean);
+                $$ = enc.arena_.make<SMVnode>(e,SMVnode::Boolean);
               }else{
-              $$ = new neq_expr($1,$3);
+              $$ = enc.arena_.make<neq_expr>($1,$3);
               }
             }
             | basic_expr OP_LT basic_expr  {
@@ -903,9 +903,9 @@ simple_expr: constant {
                   }
               }
                   assert(res);
-                  $$ = new SMVnode(res,SMVnode::Boolean);
+                  $$ = enc.arena_.make<SMVnode>(res,SMVnode::Boolean);
               }else{
-              $$ = new lt_expr($1,$3);
+              $$ = enc.arena_.make<lt_expr>($1,$3);
               }
             }
             | basic_expr OP_GT basic_expr {
@@ -929,9 +929,9 @@ simple_expr: constant {
                   }
               }
                   assert(res);
-                  $$ = new SMVnode(res,SMVnode::Boolean);
+                  $$ = enc.arena_.make<SMVnode>(res,SMVnode::Boolean);
               }else{
-              $$ = new gt_expr($1,$3);
+              $$ = enc.arena_.make<gt_expr>($1,$3);
               }
             }
             | basic_expr OP_LTE basic_expr{
@@ -953,9 +953,9 @@ simple_expr: constant {
                   }
               }
                   assert(res);
-                  $$ = new SMVnode(res,SMVnode::Boolean);
+                  $$ = enc.arena_.make<SMVnode>(res,SMVnode::Boolean);
               }else{
-              $$ = new lte_expr($1,$3);
+              $$ = enc.arena_.make<lte_expr>($1,$3);
               }
             }
             | basic_expr OP_GTE basic_expr{
@@ -977,9 +977,9 @@ simple_expr: constant {
                   }
               }
                   assert(res);
-                  $$ = new SMVnode(res,SMVnode::Boolean);
+                  $$ = enc.arena_.make<SMVnode>(res,SMVnode::Boolean);
               }else{
-              $$ = new gte_expr($1,$3);
+              $$ = enc.arena_.make<gte_expr>($1,$3);
               }
             }
             | OP_MINUS basic_expr %prec UMINUS{
@@ -990,15 +990,15 @@ simple_expr: constant {
                 if ((bvs_a == SMVnode::Integer) || (bvs_a == SMVnode::Real)){
                   res = enc.solver_->make_term(smt::Negate, a->getTerm());
                   assert(res); //check res non-null
-                  if(res->get_sort()->get_sort_kind()==smt::REAL) $$ = new SMVnode(res,SMVnode::Real);
-                  else $$ = new SMVnode(res,SMVnode::Integer);
+                  if(res->get_sort()->get_sort_kind()==smt::REAL) $$ = enc.arena_.make<SMVnode>(res,SMVnode::Real);
+                  else $$ = enc.arena_.make<SMVnode>(res,SMVnode::Integer);
                 }else {
                   res = enc.solver_->make_term(smt::BVNeg, a->getTerm());
                   assert(res); //check res non-null
-                  $$ = new SMVnode(res,bvs_a);
+                  $$ = enc.arena_.make<SMVnode>(res,bvs_a);
                 }
               }else{
-              $$ = new uminus_expr($2);
+              $$ = enc.arena_.make<uminus_expr>($2);
               }
             }
             | basic_expr "+" basic_expr{
@@ -1011,19 +1011,19 @@ simple_expr: constant {
               if ((bvs_a == SMVnode::Integer) || (bvs_a == SMVnode::Real) ||(bvs_b == SMVnode::Integer) || (bvs_b == SMVnode::Real) ){
                   res = enc.solver_->make_term(smt::Plus, a->getTerm(), b->getTerm());
                   assert(res); //check res non-null
-                  if(res->get_sort()->get_sort_kind()==smt::REAL) $$ = new SMVnode(res,SMVnode::Real);
-                  else $$ = new SMVnode(res,SMVnode::Integer);
+                  if(res->get_sort()->get_sort_kind()==smt::REAL) $$ = enc.arena_.make<SMVnode>(res,SMVnode::Real);
+                  else $$ = enc.arena_.make<SMVnode>(res,SMVnode::Integer);
               }else{
                   if(bvs_a != bvs_b){
                    throw PonoException(to_string(enc.loc.end.line) +"Unsigned/Signed bitvector mismatch");
                   } else{
                   res = enc.solver_->make_term(smt::BVAdd, a->getTerm(), b->getTerm());
                   assert(res); //check res non-null
-                  $$ = new SMVnode(res,bvs_a);
+                  $$ = enc.arena_.make<SMVnode>(res,bvs_a);
                 }
               }
               }else{
-              $$ = new add_expr($1,$3);
+              $$ = enc.arena_.make<add_expr>($1,$3);
               }
             }
             | basic_expr "-" basic_expr{
@@ -1036,19 +1036,19 @@ simple_expr: constant {
               if ((bvs_a == SMVnode::Integer) || (bvs_a == SMVnode::Real) ||(bvs_b == SMVnode::Integer) || (bvs_b == SMVnode::Real) ){
                   res = enc.solver_->make_term(smt::Minus, a->getTerm(), b->getTerm());
                   assert(res); //check res non-null
-                  if(res->get_sort()->get_sort_kind()==smt::REAL) $$ = new SMVnode(res,SMVnode::Real);
-                  else $$ = new SMVnode(res,SMVnode::Integer);
+                  if(res->get_sort()->get_sort_kind()==smt::REAL) $$ = enc.arena_.make<SMVnode>(res,SMVnode::Real);
+                  else $$ = enc.arena_.make<SMVnode>(res,SMVnode::Integer);
               }else{
                   if(bvs_a != bvs_b){
                    throw PonoException(to_string(enc.loc.end.line) +"Unsigned/Signed bitvector mismatch");
                   } else{
                   assert(res); //check res non-null
                   res = enc.solver_->make_term(smt::BVSub, a->getTerm(), b->getTerm());
-                  $$ = new SMVnode(res,bvs_a);
+                  $$ = enc.arena_.make<SMVnode>(res,bvs_a);
                   }
               }
               }else{
-              $$ = new sub_expr($1,$3);
+              $$ = enc.arena_.make<sub_expr>($1,$3);
               }
             }
             | basic_expr "*" basic_expr{
@@ -1061,19 +1061,19 @@ simple_expr: constant {
               if ((bvs_a == SMVnode::Integer) || (bvs_a == SMVnode::Real) ||(bvs_b == SMVnode::Integer) || (bvs_b == SMVnode::Real) ){
                   res = enc.solver_->make_term(smt::Mult, a->getTerm(), b->getTerm());
                   assert(res); //check res non-null
-                  if(res->get_sort()->get_sort_kind()==smt::REAL) $$ = new SMVnode(res,SMVnode::Real);
-                  else $$ = new SMVnode(res,SMVnode::Integer);
+                  if(res->get_sort()->get_sort_kind()==smt::REAL) $$ = enc.arena_.make<SMVnode>(res,SMVnode::Real);
+                  else $$ = enc.arena_.make<SMVnode>(res,SMVnode::Integer);
               }else{
                   if(bvs_a != bvs_b){
                    throw PonoException(to_string(enc.loc.end.line) +"Unsigned/Signed bitvector mismatch");
                   } else{
                   assert(res); //check res non-null
                   res = enc.solver_->make_term(smt::BVMul, a->getTerm(), b->getTerm());
-                  $$ = new SMVnode(res,bvs_a);
+                  $$ = enc.arena_.make<SMVnode>(res,bvs_a);
                   }
               }
               }else{
-              $$ = new mul_expr($1,$3);
+              $$ = enc.arena_.make<mul_expr>($1,$3);
               }
             }
             | basic_expr "/" basic_expr{
@@ -1086,22 +1086,22 @@ simple_expr: constant {
               if ((bvs_a == SMVnode::Integer) || (bvs_a == SMVnode::Real) ||(bvs_b == SMVnode::Integer) || (bvs_b == SMVnode::Real) ){
                   res = enc.solver_->make_term(smt::Div, a->getTerm(), b->getTerm());
                   assert(res); //check res non-null
-                  if(res->get_sort()->get_sort_kind()==smt::REAL) $$ = new SMVnode(res,SMVnode::Real);
-                  else $$ = new SMVnode(res,SMVnode::Integer);
+                  if(res->get_sort()->get_sort_kind()==smt::REAL) $$ = enc.arena_.make<SMVnode>(res,SMVnode::Real);
+                  else $$ = enc.arena_.make<SMVnode>(res,SMVnode::Integer);
               }else{
                   if (bvs_a == bvs_b == SMVnode::Unsigned){
                     res = enc.solver_->make_term(smt::BVUdiv, a->getTerm(), b->getTerm());
-                    $$ = new SMVnode(res,SMVnode::Unsigned);
+                    $$ = enc.arena_.make<SMVnode>(res,SMVnode::Unsigned);
                   } else if (bvs_a == bvs_b == SMVnode::Signed){
                     assert(res); //check res non-null
                     res = enc.solver_->make_term(smt::BVSdiv, a->getTerm(), b->getTerm());
-                    $$ = new SMVnode(res,SMVnode::Signed);
+                    $$ = enc.arena_.make<SMVnode>(res,SMVnode::Signed);
                   } else{
                     throw PonoException (to_string(enc.loc.end.line) +"Unsigned/Signed bitvector mismatch");
                   }
               }
               }else{
-              $$ = new div_expr($1,$3);
+              $$ = enc.arena_.make<div_expr>($1,$3);
               }
             }
             | basic_expr OP_MOD basic_expr{
@@ -1114,23 +1114,23 @@ simple_expr: constant {
               if ((bvs_a == SMVnode::Integer) || (bvs_a == SMVnode::Real) ||(bvs_b == SMVnode::Integer) || (bvs_b == SMVnode::Real) ){
                   res = enc.solver_->make_term(smt::Mod, a->getTerm(), b->getTerm());
                   assert(res); //check res non-null
-                  if(res->get_sort()->get_sort_kind()==smt::REAL) $$ = new SMVnode(res,SMVnode::Real);
-                  else $$ = new SMVnode(res,SMVnode::Integer);
+                  if(res->get_sort()->get_sort_kind()==smt::REAL) $$ = enc.arena_.make<SMVnode>(res,SMVnode::Real);
+                  else $$ = enc.arena_.make<SMVnode>(res,SMVnode::Integer);
               }else{
                   if (bvs_a == bvs_b == SMVnode::Unsigned){
                     res = enc.solver_->make_term(smt::BVUrem, a->getTerm(), b->getTerm());
                     assert(res); //check res non-null
-                    $$ = new SMVnode(res,SMVnode::Unsigned);
+                    $$ = enc.arena_.make<SMVnode>(res,SMVnode::Unsigned);
                   } else if (bvs_a == bvs_b == SMVnode::Signed){
                     res = enc.solver_->make_term(smt::BVSmod, a->getTerm(), b->getTerm());
                     assert(res); //check res non-null
-                    $$ = new SMVnode(res,SMVnode::Signed);
+                    $$ = enc.arena_.make<SMVnode>(res,SMVnode::Signed);
                   } else{
                     throw PonoException (to_string(enc.loc.end.line) +"Unsigned/Signed bitvector mismatch");
                   }
               }
               }else{
-              $$ = new mod_expr($1,$3);
+              $$ = enc.arena_.make<mod_expr>($1,$3);
               }
             }
             | basic_expr OP_SHIFTR basic_expr{
@@ -1141,13 +1141,13 @@ simple_expr: constant {
               smt::Term res = enc.solver_->make_term(smt::BVLshr, a->getTerm(), b->getTerm());
                 if(bvs_b == SMVnode::Unsigned){
                   assert(res); //check res non-null
-                  $$ = new SMVnode(res,a->getType());
+                  $$ = enc.arena_.make<SMVnode>(res,a->getType());
                 }else{
                   throw PonoException("Shift type mismatch");
                 }
 
               }else{
-              $$ = new sr_expr($1,$3);
+              $$ = enc.arena_.make<sr_expr>($1,$3);
               }
             }
             | basic_expr OP_SHIFTL basic_expr{
@@ -1158,12 +1158,12 @@ simple_expr: constant {
               smt::Term res = enc.solver_->make_term(smt::BVShl, a->getTerm(), b->getTerm());
               if(bvs_b == SMVnode::Unsigned){
                   assert(res); //check res non-null
-                  $$ = new SMVnode(res,a->getType());
+                  $$ = enc.arena_.make<SMVnode>(res,a->getType());
                 }else{
                   throw PonoException("Shift type mismatch");
               }
               }else{
-              $$ = new sl_expr($1,$3);
+              $$ = enc.arena_.make<sl_expr>($1,$3);
               }
             }
             | basic_expr OP_CON basic_expr  {
@@ -1177,10 +1177,10 @@ simple_expr: constant {
               } else{
                 smt::Term res = enc.solver_->make_term(smt::Concat, a->getTerm(), b->getTerm());
                 assert(res); //check res non-null
-                $$ = new SMVnode(res,SMVnode::Unsigned);
+                $$ = enc.arena_.make<SMVnode>(res,SMVnode::Unsigned);
               }
               }else{
-                $$ = new con_expr($1,$3);
+                $$ = enc.arena_.make<con_expr>($1,$3);
               }
             }
             | basic_expr sizev {
@@ -1193,12 +1193,12 @@ simple_expr: constant {
                 if(bvs_a == SMVnode::Unsigned || bvs_a == SMVnode::Signed){
                   smt::Term res = enc.solver_->make_term(smt::Op(smt::Extract, stoi($3),stoi($5)), a->getTerm());
                   assert(res); //check res non-null
-                  $$ = new SMVnode(res,SMVnode::Unsigned);
+                  $$ = enc.arena_.make<SMVnode>(res,SMVnode::Unsigned);
                 }else{
                   throw PonoException("Bit selection type is uncompatible");
                 }
                 }else{
-                $$ = new sel_expr($1,$3,$5);
+                $$ = enc.arena_.make<sel_expr>($1,$3,$5);
               }
             }
             | word1 "(" basic_expr ")" {
@@ -1223,14 +1223,14 @@ simple_expr: constant {
                 if(enc.module_flat){
                 $$ = $3;
                 }else{
-                $$ = new signed_expr($3);
+                $$ = enc.arena_.make<signed_expr>($3);
                 }
             }    //unsigned word convert to
             | tok_unsigned "(" basic_expr ")"{
               if(enc.module_flat){
                 $$ = $3;
                 }else{
-              $$ = new unsigned_expr($3);
+              $$ = enc.arena_.make<unsigned_expr>($3);
               }
             }
             | tok_sizeof "(" basic_expr ")"{
@@ -1243,11 +1243,11 @@ simple_expr: constant {
                 smt::SortKind sk = t->get_sort()->get_sort_kind();
                 assert(sk == smt::REAL || sk == smt::INT);
                 smt::Term res = enc.solver_->make_term(smt::To_Int, t);
-                $$ = new SMVnode(res, SMVnode::Integer);
+                $$ = enc.arena_.make<SMVnode>(res, SMVnode::Integer);
               }
               else
               {
-                $$ = new floor_expr($3);
+                $$ = enc.arena_.make<floor_expr>($3);
               }
             }
             | extend "(" basic_expr ")"{
@@ -1277,9 +1277,9 @@ simple_expr: constant {
                  SMVnode *b = $3;
                  SMVnode *c = $5;
                  smt::Term e = enc.solver_->make_term(smt::Ite, a->getTerm(),b->getTerm(),c->getTerm());
-                 $$ = new SMVnode(e,b->getType());
+                 $$ = enc.arena_.make<SMVnode>(e,b->getType());
               }else{
-                $$ = new ite_expr($1,$3,$5);
+                $$ = enc.arena_.make<ite_expr>($1,$3,$5);
               }
             }
           | WRITE "(" basic_expr "," basic_expr "," basic_expr ")"{
@@ -1301,10 +1301,10 @@ simple_expr: constant {
                                                        a->getTerm(),
                                                        b->getTerm(),
                                                        c->getTerm());
-            $$ = new SMVnode(write_r, a->getType(), a->getElementType());
+            $$ = enc.arena_.make<SMVnode>(write_r, a->getType(), a->getElementType());
             }
             else{
-              $$ = new write_expr($3,$5,$7);
+              $$ = enc.arena_.make<write_expr>($3,$5,$7);
             }
           }
           | READ "(" basic_expr "," basic_expr ")"{
@@ -1312,9 +1312,9 @@ simple_expr: constant {
             SMVnode *a = $3;
             SMVnode *b = $5;
             smt::Term read_r =  enc.solver_->make_term(smt::Select, a->getTerm(),b->getTerm());
-            $$ = new SMVnode(read_r,a->getElementType());
+            $$ = enc.arena_.make<SMVnode>(read_r,a->getElementType());
             }else{
-              $$ = new read_expr($3,$5);
+              $$ = enc.arena_.make<read_expr>($3,$5);
             }
           }
           | CONSTARRAY "(" tok_typeof "(" complex_identifier ")" "," basic_expr ")" {
@@ -1325,17 +1325,17 @@ simple_expr: constant {
               if(enc.arrayty_.find($5) != enc.arrayty_.end()){
                  smt::Sort kind_ = tok->get_sort();
                 smt::Term const_arr = enc.solver_->make_term(a->getTerm(),kind_);
-                $$ = new SMVnode(const_arr,SMVnode::WordArray,a->getType());
+                $$ = enc.arena_.make<SMVnode>(const_arr,SMVnode::WordArray,a->getType());
               } else if (enc.arrayint_.find($5) != enc.arrayint_.end()){
                 smt::Sort sort_ = tok->get_sort();
                 smt::Term const_arr = enc.solver_->make_term(a->getTerm(),sort_);
-                $$ = new SMVnode(const_arr,SMVnode::IntArray,SMVnode::Integer);
+                $$ = enc.arena_.make<SMVnode>(const_arr,SMVnode::IntArray,SMVnode::Integer);
               }
               else{
                 throw PonoException("The type of the const array is wrong");
               }
              }else{
-               $$ = new constarray_type_expr($5, $8);
+               $$ = enc.arena_.make<constarray_type_expr>($5, $8);
              }
           }
           | CONSTARRAY "(" arrayword sizev of type_identifier "," basic_expr ")" {
@@ -1345,9 +1345,9 @@ simple_expr: constant {
              smt::Sort arraysort = enc.solver_->make_sort(smt::BV,$4);
              smt::Sort sort_ = enc.solver_->make_sort(smt::ARRAY, arraysort,b->getSort());
              smt::Term const_arr = enc.solver_->make_term(a->getTerm(),sort_);
-             $$ = new SMVnode(const_arr,SMVnode::WordArray, a->getType());
+             $$ = enc.arena_.make<SMVnode>(const_arr,SMVnode::WordArray, a->getType());
              }else{
-               $$ = new constarray_word_expr($4, $6, $8);
+               $$ = enc.arena_.make<constarray_word_expr>($4, $6, $8);
              }
           }
           | CONSTARRAY "(" arrayinteger of type_identifier "," basic_expr ")" {
@@ -1357,9 +1357,9 @@ simple_expr: constant {
              smt::Sort arraysort = enc.solver_->make_sort(smt::INT);
              smt::Sort sort_ = enc.solver_->make_sort(smt::ARRAY, arraysort, b->getSort());
              smt::Term const_arr = enc.solver_->make_term(a->getTerm(),sort_);
-             $$ = new SMVnode(const_arr,SMVnode::IntArray,a->getType());
+             $$ = enc.arena_.make<SMVnode>(const_arr,SMVnode::IntArray,a->getType());
              }else{
-               $$ = new constarray_int_expr($5, $7);
+               $$ = enc.arena_.make<constarray_int_expr>($5, $7);
              }
           }
           | case_expr {
@@ -1382,12 +1382,12 @@ simple_expr: constant {
               {
                 args.push_back(arg->getTerm());
               }
-              $$ = new SMVnode(enc.solver_->make_term(smt::Apply, args),
+              $$ = enc.arena_.make<SMVnode>(enc.solver_->make_term(smt::Apply, args),
                                return_type);
             }
             else
             {
-              $$ = new apply_expr($1, $3);
+              $$ = enc.arena_.make<apply_expr>($1, $3);
             }
           }
 ;
@@ -1396,9 +1396,9 @@ next_expr: TOK_NEXT "(" basic_expr ")"{
   if(enc.module_flat){
           SMVnode *a = $3;
           smt::Term n = enc.rts_.next(a->getTerm());
-          $$ = new SMVnode(n,a->getType());
+          $$ = enc.arena_.make<SMVnode>(n,a->getType());
   }else{
-    $$ = new next_expr($3);
+    $$ = enc.arena_.make<next_expr>($3);
   }
 };
 
@@ -1421,9 +1421,9 @@ case_expr: TOK_CASE case_body TOK_ESAC {
             final_term = e;
           }
           enc.casecheck_.push_back(cond);
-          $$ = new SMVnode(final_term,t);
+          $$ = enc.arena_.make<SMVnode>(final_term,t);
   }else{
-    $$ = new case_expr($2);
+    $$ = enc.arena_.make<case_expr>($2);
   }
 }
 
@@ -1436,7 +1436,7 @@ case_body: basic_expr ":" basic_expr ";"{
       enc.caseterm_.push_back(make_pair(a,b));
   }else{
     vector<SMVnode*> body;
-    body.push_back(new case_body_ex($1,$3));
+    body.push_back(enc.arena_.make<case_body_ex>($1,$3));
     $$ = body;
   }
 } | case_body basic_expr ":" basic_expr ";" {
@@ -1446,7 +1446,7 @@ case_body: basic_expr ":" basic_expr ";"{
       enc.caseterm_.push_back(make_pair(a,b));
   }else{
     vector<SMVnode*> body = $1;
-    body.push_back(new case_body_ex($2,$4));
+    body.push_back(enc.arena_.make<case_body_ex>($2,$4));
     $$ = body;
   }
 };
@@ -1470,25 +1470,25 @@ complex_identifier: tok_name{
 type_identifier: real_type{
         if(enc.module_flat){
                 smt::Sort sort_ = enc.solver_->make_sort(smt::REAL);
-                $$ =  new type_node(sort_,SMVnode::Real);
+                $$ =  enc.arena_.make<type_node>(sort_,SMVnode::Real);
         }else{
-          $$ = new type_node("real");
+          $$ = enc.arena_.make<type_node>("real");
         }
                 }
                 | integer_type{
                   if(enc.module_flat){
                   smt::Sort sort_ = enc.solver_->make_sort(smt::INT);
-                  $$ =  new type_node (sort_,SMVnode::Integer);
+                  $$ =  enc.arena_.make<type_node>(sort_,SMVnode::Integer);
                   }else{
-                   $$ = new type_node("integer");
+                   $$ = enc.arena_.make<type_node>("integer");
                   }
                 }
                 | bool_type {
                   if(enc.module_flat){
                   smt::Sort sort_ = enc.solver_->make_sort(smt::BOOL);
-                  $$ =  new type_node(sort_,SMVnode::Boolean);
+                  $$ =  enc.arena_.make<type_node>(sort_,SMVnode::Boolean);
                   }else{
-                    $$ = new type_node("boolean");
+                    $$ = enc.arena_.make<type_node>("boolean");
                   }
                 }
                 | array_type{
@@ -1504,28 +1504,28 @@ type_identifier: real_type{
 word_type: signed_word sizev {
   if(enc.module_flat){
         smt::Sort sort_ = enc.solver_->make_sort(smt::BV, $2);
-        $$ =  new type_node(sort_,SMVnode::Signed);
+        $$ =  enc.arena_.make<type_node>(sort_,SMVnode::Signed);
   }else{
     string n = "signed word [" + std::to_string($2) + "]";
-    $$ = new type_node(n);
+    $$ = enc.arena_.make<type_node>(n);
   }
 }
           | unsigned_word sizev{
             if(enc.module_flat){
             smt::Sort sort_ = enc.solver_->make_sort(smt::BV, $2);
-            $$ =  new type_node (sort_,SMVnode::Unsigned);
+            $$ =  enc.arena_.make<type_node>(sort_,SMVnode::Unsigned);
     }else{
         string n = "unsigned word [" + std::to_string($2) + "]";
-         $$ = new type_node(n);
+         $$ = enc.arena_.make<type_node>(n);
     }
 }
           | tok_word sizev{
     if(enc.module_flat){
         smt::Sort sort_ = enc.solver_->make_sort(smt::BV, $2);
-        $$ =  new type_node (sort_,SMVnode::Unsigned);
+        $$ =  enc.arena_.make<type_node>(sort_,SMVnode::Unsigned);
     }else{
         string n = "word [" + std::to_string($2) + "]";
-        $$ = new type_node(n);
+        $$ = enc.arena_.make<type_node>(n);
     }
 };
 
@@ -1534,11 +1534,11 @@ array_type: arrayword sizev of type_identifier{
               smt::Sort arraysort = enc.solver_->make_sort(smt::BV,$2);
               SMVnode *a = $4;
               smt::Sort sort_ = enc.solver_->make_sort(smt::ARRAY, arraysort,a->getSort());
-              $$ = new type_node(sort_,SMVnode::WordArray,a->getType());
+              $$ = enc.arena_.make<type_node>(sort_,SMVnode::WordArray,a->getType());
             }else{
               SMVnode *temp = $4;
               string n = "array word" + std::to_string($2) + "of " + temp->getName();
-              $$ = new type_node(n);
+              $$ = enc.arena_.make<type_node>(n);
             }
           }
           | arrayinteger of type_identifier{
@@ -1546,11 +1546,11 @@ array_type: arrayword sizev of type_identifier{
             smt::Sort arraysort = enc.solver_->make_sort(smt::INT);
             SMVnode *a = $3;
             smt::Sort sort_ = enc.solver_->make_sort(smt::ARRAY, arraysort,a->getSort());
-            $$ = new type_node(sort_,SMVnode::IntArray,a->getType());
+            $$ = enc.arena_.make<type_node>(sort_,SMVnode::IntArray,a->getType());
             }else{
             SMVnode *temp = $3;
             string n = "array integer of " + temp->getName();
-            $$ = new type_node(n);
+            $$ = enc.arena_.make<type_node>(n);
             }
           }
           | array_tok of type_identifier{
@@ -1574,7 +1574,7 @@ fun_type:
        //       need to propagate signed / unsigned type checking
        //       at the SMV level (no notion of signed / unsigned values
        //       in SMT-LIB, instead only the operators)
-       $$ = new type_node(funsort, $3->getType());
+       $$ = enc.arena_.make<type_node>(funsort, $3->getType());
      }
      else
      {
@@ -1585,7 +1585,7 @@ fun_type:
          n += " * " + $1[i]->getName();
        }
        n += " -> " + $3->getName();
-       $$ = new type_node(n);
+       $$ = enc.arena_.make<type_node>(n);
      }
    }
 ;
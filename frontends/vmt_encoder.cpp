@@ -17,25 +17,72 @@
 
 #include "frontends/vmt_encoder.h"
 
+#include <chrono>
+#include <fstream>
+
+#include "utils/logger.h"
+#include "utils/memory_profile.h"
+#include "utils/timeline.h"
+
 using namespace smt;
 using namespace std;
 
 namespace pono {
 
 VMTEncoder::VMTEncoder(std::string filename, RelationalTransitionSystem & rts)
-    : super(rts.get_solver()), filename_(filename), rts_(rts)
+    : super(rts.get_solver()),
+      filename_(filename),
+      rts_(rts),
+      num_attributes_(0),
+      stats_(std::make_shared<Statistics>())
 {
+  TIMELINE_SPAN("vmt_parse");
+  MEMORY_PHASE("vmt_parse");
+  auto begin = chrono::steady_clock::now();
   set_logic_all();
   int res = parse(filename_);
   assert(!res);  // 0 means success
+  build_ts();
+  double seconds =
+      chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+  size_t file_bytes = 0;
+  ifstream f(filename_, ios::binary | ios::ate);
+  if (f) {
+    file_bytes = f.tellg();
+  }
+  stats_->set("symbols", symbols_.size());
+  stats_->set("statevars", statevars_.size());
+  stats_->set("attributes", num_attributes_);
+  stats_->set("file_bytes", file_bytes);
+  stats_->set("bytes_per_second",
+              seconds > 0 ? static_cast<size_t>(file_bytes / seconds) : 0);
+  stats_->add_time("parse_time", seconds);
+  if (statistics_registry.enabled()) {
+    statistics_registry.add("vmt_encoder", stats_);
+  }
+  logger.log(1,
+             "VMTEncoder: parsed {} bytes with {} symbols and {} state "
+             "variables in {} seconds",
+             file_bytes,
+             symbols_.size(),
+             statevars_.size(),
+             seconds);
+
+  // only needed to build the system
+  symbols_.clear();
+  statevars_.clear();
+  statevar_set_.clear();
+  init_.clear();
+  trans_.clear();
 }
 
 void VMTEncoder::new_symbol(const std::string & name, const smt::Sort & sort)
 {
   super::new_symbol(name, sort);
   if (sort->get_sort_kind() != FUNCTION) {
-    // treat as an input variable until given :next
-    rts_.add_inputvar(lookup_symbol(name));
+    // an input variable unless it's given :next
+    symbols_.push_back(lookup_symbol(name));
   }
 }
 
@@ -53,16 +100,37 @@ void VMTEncoder::term_attribute(const Term & term,
       next_var = lookup_symbol(value);
     }
     assert(next_var);
-    rts_.add_statevar(term, next_var);
+    statevars_.push_back({ term, next_var });
+    statevar_set_.insert(term);
+    statevar_set_.insert(next_var);
   } else if (keyword == "init") {
-    rts_.constrain_init(term);
+    init_.push_back(term);
   } else if (keyword == "trans") {
-    rts_.constrain_trans(term);
+    trans_.push_back(term);
   } else if (keyword == "invar-property") {
     propvec_.push_back(term);
   } else {
     throw PonoException("Unhandled VMT attribute -- :" + keyword + " " + value);
   }
+  ++num_attributes_;
+}
+
+void VMTEncoder::build_ts()
+{
+  for (const auto & s : symbols_) {
+    if (statevar_set_.find(s) == statevar_set_.end()) {
+      rts_.add_inputvar(s);
+    }
+  }
+  for (const auto & elem : statevars_) {
+    rts_.add_statevar(elem.first, elem.second);
+  }
+  for (const auto & i : init_) {
+    rts_.constrain_init(i);
+  }
+  for (const auto & t : trans_) {
+    rts_.constrain_trans(t);
+  }
 }
 
 }  // namespace pono
@@ -18,12 +18,16 @@
 #pragma once
 
 #include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include "assert.h"
 #include "core/rts.h"
 #include "smt-switch/smt.h"
 #include "smt-switch/smtlib_reader.h"
 #include "utils/exceptions.h"
+#include "utils/statistics.h"
 
 namespace pono {
 class VMTEncoder : public smt::SmtLibReader
@@ -41,12 +45,33 @@ class VMTEncoder : public smt::SmtLibReader
 
   const smt::TermVec & propvec() const { return propvec_; }
 
+  /** @return the parsing statistics: symbols, statevars, attributes,
+   *          file_bytes, bytes_per_second and parse_time
+   */
+  const Statistics & statistics() const { return *stats_; }
+
  protected:
+  /** Adds the variables and constraints collected while parsing to rts_
+   *  Every variable is added once with its final kind, instead of as an
+   *  input variable that a later :next turns into a state variable.
+   */
+  void build_ts();
+
   std::string filename_;
 
   RelationalTransitionSystem & rts_;
 
   smt::TermVec propvec_;
+
+  // collected while parsing, folded into rts_ by build_ts
+  smt::TermVec symbols_;  ///< the non-function symbols in declaration order
+  std::vector<std::pair<smt::Term, smt::Term>> statevars_;
+  smt::UnorderedTermSet statevar_set_;  ///< current and next vars
+  smt::TermVec init_;
+  smt::TermVec trans_;
+  size_t num_attributes_;
+
+  std::shared_ptr<Statistics> stats_;
 };
 
 }  // namespace pono
@@ -16,6 +16,8 @@
 
 #include "assert.h"
 
+#include <chrono>
+
 #include "modifiers/array_abstractor.h"
 #include "utils/exceptions.h"
 
@@ -165,7 +167,7 @@ WalkerStepResult ArrayAbstractor::ConcretizationWalker::visit_term(Term & term)
     assert(cached_args.size() == 3);
     assert(cached_args[0]->get_sort()->get_sort_kind() == ARRAY);
     Term idx = cached_args[1];
-    res = solver_->make_term(Store, cached_args[0], idx, cached_args[1]);
+    res = solver_->make_term(Store, cached_args[0], idx, cached_args[2]);
   } else if (aa_.arrayeq_ufs_set_.find(uf) != aa_.arrayeq_ufs_set_.end()) {
     assert(cached_args.size() == 2);
     assert(cached_args[0]->get_sort()->get_sort_kind() == ARRAY);
@@ -196,9 +198,45 @@ ArrayAbstractor::ArrayAbstractor(const TransitionSystem & conc_ts,
 {
 }
 
-Term ArrayAbstractor::abstract(Term & t) { return abs_walker_.visit(t); }
+Term ArrayAbstractor::abstract(Term & t)
+{
+  auto begin = chrono::steady_clock::now();
+  Term res = abs_walker_.visit(t);
+  record_time("abstraction_time", begin);
+  return res;
+}
 
-Term ArrayAbstractor::concrete(Term & t) { return conc_walker_.visit(t); }
+Term ArrayAbstractor::concrete(Term & t)
+{
+  auto begin = chrono::steady_clock::now();
+  Term res = conc_walker_.visit(t);
+  record_time("concretization_time", begin);
+  return res;
+}
+
+TermVec ArrayAbstractor::abstract(const TermVec & terms)
+{
+  auto begin = chrono::steady_clock::now();
+  TermVec res;
+  res.reserve(terms.size());
+  for (Term t : terms) {
+    res.push_back(abs_walker_.visit(t));
+  }
+  record_time("abstraction_time", begin);
+  return res;
+}
+
+TermVec ArrayAbstractor::concrete(const TermVec & terms)
+{
+  auto begin = chrono::steady_clock::now();
+  TermVec res;
+  res.reserve(terms.size());
+  for (Term t : terms) {
+    res.push_back(conc_walker_.visit(t));
+  }
+  record_time("concretization_time", begin);
+  return res;
+}
 
 Sort ArrayAbstractor::abstract(Sort & s)
 {
@@ -253,10 +291,11 @@ Term ArrayAbstractor::get_arrayeq_uf(const smt::Sort & sort) const
 void ArrayAbstractor::do_abstraction()
 {
   abstract_vars();
-  Term init = conc_ts_.init();
-  Term trans = conc_ts_.trans();
-  Term abs_init = abstract(init);
-  Term abs_trans = abstract(trans);
+  // one pass over the whole system, the shared subterms of init and
+  // trans are abstracted once
+  TermVec abs = abstract(TermVec{ conc_ts_.init(), conc_ts_.trans() });
+  Term abs_init = abs[0];
+  Term abs_trans = abs[1];
 
   // need a relational system
   // but generic abstractor does not require a relational system
@@ -369,4 +408,14 @@ void ArrayAbstractor::update_sort_cache(const Sort & conc_sort,
   concrete_sorts_[abs_sort] = conc_sort;
 }
 
+void ArrayAbstractor::record_time(const string & name,
+                                  chrono::steady_clock::time_point begin) const
+{
+  if (stats_) {
+    stats_->add_time(
+        name,
+        chrono::duration<double>(chrono::steady_clock::now() - begin).count());
+  }
+}
+
 }  // namespace pono
@@ -16,9 +16,13 @@
 
 #pragma once
 
+#include <chrono>
+#include <memory>
+
 #include "smt-switch/identity_walker.h"
 
 #include "abstractor.h"
+#include "utils/statistics.h"
 
 namespace pono {
 
@@ -60,9 +64,31 @@ class ArrayAbstractor : public Abstractor
 
   typedef Abstractor super;
 
+  /** The abstraction and concretization caches persist for the lifetime
+   *  of the abstractor, and each abstracted term is recorded in both
+   *  directions. After do_abstraction, every subterm of the system
+   *  (e.g. of an invariant or witness over the abstract system) is
+   *  mapped by a cache lookup rather than a new traversal.
+   */
   smt::Term abstract(smt::Term & t) override;
   smt::Term concrete(smt::Term & t) override;
 
+  /** Abstract / concretize several terms at once
+   *  Shares the caches, so the common subterms are visited only once.
+   *  @param terms the terms to map
+   *  @return the mapped terms, in the same order
+   */
+  smt::TermVec abstract(const smt::TermVec & terms);
+  smt::TermVec concrete(const smt::TermVec & terms);
+
+  /** Record the time spent in abstract / concrete
+   *  (abstraction_time and concretization_time) in stats
+   */
+  void set_statistics(const std::shared_ptr<Statistics> & stats)
+  {
+    stats_ = stats;
+  };
+
   /** Returns the abstraction of a given sort
    *  if the sort has not been abstracted, the original
    *  sort is returned
@@ -125,6 +151,11 @@ class ArrayAbstractor : public Abstractor
   void update_sort_cache(const smt::Sort & conc_sort,
                          const smt::Sort & abs_sort);
 
+  /** Add the time since begin to the statistic name, if there are stats
+   */
+  void record_time(const std::string & name,
+                   std::chrono::steady_clock::time_point begin) const;
+
   bool abstract_array_equality_;
   const smt::SmtSolver & solver_;
 
@@ -147,6 +178,8 @@ class ArrayAbstractor : public Abstractor
   smt::UnorderedTermSet read_ufs_set_;
   smt::UnorderedTermSet write_ufs_set_;
   smt::UnorderedTermSet arrayeq_ufs_set_;
+
+  std::shared_ptr<Statistics> stats_;  ///< null if not recording
 };
 
 }  // namespace pono
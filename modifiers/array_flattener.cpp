@@ -0,0 +1,406 @@
+/*********************                                                        */
+/*! \file array_flattener.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Expands small arrays (e.g. register files) into one bit-vector
+**        variable per element.
+**
+**/
+
+#include "modifiers/array_flattener.h"
+
+#include <algorithm>
+
+#include "assert.h"
+#include "utils/exceptions.h"
+#include "utils/logger.h"
+#include "utils/ts_manipulation.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+/** @return the conjunction of terms, true if there are none */
+static Term make_and(const SmtSolver & solver, const TermVec & terms)
+{
+  if (terms.empty()) {
+    return solver->make_term(true);
+  }
+  Term res = terms[0];
+  for (size_t i = 1; i < terms.size(); ++i) {
+    res = solver->make_term(And, res, terms[i]);
+  }
+  return res;
+}
+
+ArrayFlattener::ArrayFlattener(TransitionSystem & ts,
+                               size_t max_index_width,
+                               size_t max_cost)
+    : ts_(ts), solver_(ts.solver())
+{
+  if (!ts_.is_functional()) {
+    logger.log(1, "ArrayFlattener: only supports functional systems");
+    return;
+  }
+  choose_sorts(max_index_width, max_cost);
+  if (!sorts_.empty()) {
+    flatten_ts();
+  }
+}
+
+Term ArrayFlattener::rewrite(const Term & t)
+{
+  if (!flattened()) {
+    return t;
+  }
+  flatten(t);
+  return cache_.at(t);
+}
+
+void ArrayFlattener::lift_witness(vector<UnorderedTermMap> & cex) const
+{
+  for (auto & frame : cex) {
+    for (const auto & var : vars_) {
+      const TermVec & elems = elements_.at(var);
+      const TermVec & idx = indices_.at(var->get_sort());
+      auto it = frame.find(elems[0]);
+      if (it == frame.end()) {
+        // e.g. left out by the witness options
+        continue;
+      }
+      Term first = it->second;
+      Term val = solver_->make_term(first, var->get_sort());
+      for (size_t j = 1; j < elems.size(); ++j) {
+        auto jt = frame.find(elems[j]);
+        if (jt != frame.end() && jt->second != first) {
+          val = solver_->make_term(Store, val, idx[j], jt->second);
+        }
+      }
+      frame[var] = val;
+    }
+  }
+}
+
+void ArrayFlattener::choose_sorts(size_t max_index_width, size_t max_cost)
+{
+  unordered_map<Sort, size_t> accesses;
+  auto candidate = [&](const Term & v) {
+    Sort sort = v->get_sort();
+    if (sort->get_sort_kind() != ARRAY) {
+      return;
+    }
+    Sort idxsort = sort->get_indexsort();
+    if (idxsort->get_sort_kind() == BV
+        && idxsort->get_width() <= max_index_width
+        && sort->get_elemsort()->get_sort_kind() == BV) {
+      accesses.emplace(sort, 0);
+    }
+  };
+  for (const auto & sv : ts_.statevars()) {
+    candidate(sv);
+  }
+  for (const auto & iv : ts_.inputvars()) {
+    candidate(iv);
+  }
+  if (accesses.empty()) {
+    return;
+  }
+
+  // count the selects and stores of each sort, every ite chain has as
+  // many conditions as there are elements
+  TermVec to_visit({ ts_.init() });
+  for (const auto & elem : ts_.state_updates()) {
+    to_visit.push_back(elem.second);
+  }
+  for (const auto & elem : ts_.constraints()) {
+    to_visit.push_back(elem.first);
+  }
+  UnorderedTermSet visited;
+  while (!to_visit.empty()) {
+    Term t = to_visit.back();
+    to_visit.pop_back();
+    if (!visited.insert(t).second) {
+      continue;
+    }
+    Op op = t->get_op();
+    if (op == Store || op == Select) {
+      Sort sort = (op == Store) ? t->get_sort() : (*t->begin())->get_sort();
+      auto it = accesses.find(sort);
+      if (it != accesses.end()) {
+        ++it->second;
+      }
+    }
+    for (const auto & c : t) {
+      to_visit.push_back(c);
+    }
+  }
+
+  for (const auto & elem : accesses) {
+    size_t num_elems = size_t(1) << elem.first->get_indexsort()->get_width();
+    size_t cost = num_elems * max<size_t>(elem.second, 1);
+    logger.log(2,
+               "ArrayFlattener: sort {} with {} accesses has cost {}",
+               elem.first,
+               elem.second,
+               cost);
+    if (cost <= max_cost) {
+      sorts_.insert(elem.first);
+    }
+  }
+}
+
+void ArrayFlattener::flatten_ts()
+{
+  TransitionSystem new_ts = create_fresh_ts(true, solver_);
+  try {
+    for (const auto & sv : ts_.statevars()) {
+      Sort sort = sv->get_sort();
+      if (!is_flattened(sort)) {
+        new_ts.add_statevar(sv, ts_.next(sv));
+        continue;
+      }
+      size_t num_elems = indices(sort).size();
+      TermVec curr, next;
+      string name = ts_.get_name(sv);
+      for (size_t j = 0; j < num_elems; ++j) {
+        Term e = make_fresh_var(new_ts,
+                                name + "[" + std::to_string(j) + "]",
+                                sort->get_elemsort(),
+                                true);
+        curr.push_back(e);
+        next.push_back(new_ts.next(e));
+      }
+      elements_[sv] = curr;
+      elements_[ts_.next(sv)] = next;
+      vars_.push_back(sv);
+    }
+
+    for (const auto & iv : ts_.inputvars()) {
+      Sort sort = iv->get_sort();
+      if (!is_flattened(sort)) {
+        new_ts.add_inputvar(iv);
+        continue;
+      }
+      size_t num_elems = indices(sort).size();
+      TermVec elems;
+      string name = ts_.get_name(iv);
+      for (size_t j = 0; j < num_elems; ++j) {
+        elems.push_back(make_fresh_var(new_ts,
+                                       name + "[" + std::to_string(j) + "]",
+                                       sort->get_elemsort(),
+                                       false));
+      }
+      elements_[iv] = elems;
+      vars_.push_back(iv);
+    }
+
+    Term init = ts_.init();
+    flatten(init);
+    new_ts.set_init(cache_.at(init));
+
+    for (const auto & elem : ts_.state_updates()) {
+      flatten(elem.second);
+      if (is_flattened(elem.first->get_sort())) {
+        const TermVec & vars = elements_.at(elem.first);
+        const TermVec & updates = elements_.at(elem.second);
+        for (size_t j = 0; j < vars.size(); ++j) {
+          new_ts.assign_next(vars[j], updates[j]);
+        }
+      } else {
+        new_ts.assign_next(elem.first, cache_.at(elem.second));
+      }
+    }
+
+    for (const auto & elem : ts_.constraints()) {
+      flatten(elem.first);
+      new_ts.add_constraint(cache_.at(elem.first), elem.second);
+    }
+  }
+  catch (PonoException & e) {
+    logger.log(1, "ArrayFlattener: leaving the arrays, {}", e.what());
+    sorts_.clear();
+    elements_.clear();
+    cache_.clear();
+    vars_.clear();
+    return;
+  }
+
+  // the names are only kept if they can be flattened as well
+  for (const auto & elem : ts_.named_terms()) {
+    if (is_flattened(elem.second->get_sort())) {
+      continue;
+    }
+    try {
+      flatten(elem.second);
+      new_ts.name_term(elem.first, cache_.at(elem.second));
+    }
+    catch (PonoException & e) {
+      // e.g. the name is taken by the elements
+    }
+  }
+
+  size_t num_vars = 0;
+  for (const auto & v : vars_) {
+    num_vars += elements_.at(v).size();
+  }
+  logger.log(1,
+             "ArrayFlattener: flattened {} arrays into {} variables",
+             vars_.size(),
+             num_vars);
+  ts_ = new_ts;
+}
+
+bool ArrayFlattener::is_flattened(const Sort & sort) const
+{
+  return sorts_.find(sort) != sorts_.end();
+}
+
+const TermVec & ArrayFlattener::indices(const Sort & sort)
+{
+  auto it = indices_.find(sort);
+  if (it != indices_.end()) {
+    return it->second;
+  }
+  Sort idxsort = sort->get_indexsort();
+  size_t num_elems = size_t(1) << idxsort->get_width();
+  TermVec & res = indices_[sort];
+  res.reserve(num_elems);
+  for (size_t j = 0; j < num_elems; ++j) {
+    res.push_back(solver_->make_term(j, idxsort));
+  }
+  return res;
+}
+
+void ArrayFlattener::flatten(const Term & t)
+{
+  auto done = [this](const Term & u) {
+    return elements_.find(u) != elements_.end()
+           || cache_.find(u) != cache_.end();
+  };
+
+  TermVec to_visit({ t });
+  UnorderedTermSet visited;
+  while (!to_visit.empty()) {
+    Term cur = to_visit.back();
+    if (done(cur)) {
+      to_visit.pop_back();
+      continue;
+    }
+    if (visited.insert(cur).second) {
+      // the children first
+      for (const auto & c : cur) {
+        to_visit.push_back(c);
+      }
+      continue;
+    }
+    to_visit.pop_back();
+
+    Op op = cur->get_op();
+    TermVec children(cur->begin(), cur->end());
+    Sort sort = cur->get_sort();
+
+    if (is_flattened(sort)) {
+      const TermVec & idx = indices(sort);
+      TermVec elems;
+      elems.reserve(idx.size());
+      if (op == Store) {
+        const TermVec & arr = elements_.at(children[0]);
+        const Term & i = cache_.at(children[1]);
+        const Term & v = cache_.at(children[2]);
+        for (size_t j = 0; j < idx.size(); ++j) {
+          if (i->is_value()) {
+            elems.push_back(static_cast<size_t>(i->to_int()) == j ? v : arr[j]);
+          } else {
+            elems.push_back(solver_->make_term(
+                Ite, solver_->make_term(Equal, i, idx[j]), v, arr[j]));
+          }
+        }
+      } else if (op == Ite) {
+        const Term & c = cache_.at(children[0]);
+        const TermVec & then_elems = elements_.at(children[1]);
+        const TermVec & else_elems = elements_.at(children[2]);
+        for (size_t j = 0; j < idx.size(); ++j) {
+          elems.push_back(
+              solver_->make_term(Ite, c, then_elems[j], else_elems[j]));
+        }
+      } else if (op.is_null() && !cur->is_symbolic_const()
+                 && children.size() == 1) {
+        // constant array
+        elems.assign(idx.size(), cache_.at(children[0]));
+      } else {
+        throw PonoException("can't flatten array term " + cur->to_string());
+      }
+      elements_[cur] = std::move(elems);
+      continue;
+    }
+
+    if (op.is_null()) {
+      cache_[cur] = cur;
+      continue;
+    }
+
+    bool array_arg = children.size() && is_flattened(children[0]->get_sort());
+    Term res;
+    if (op == Select && array_arg) {
+      const TermVec & elems = elements_.at(children[0]);
+      const TermVec & idx = indices(children[0]->get_sort());
+      const Term & i = cache_.at(children[1]);
+      if (i->is_value()) {
+        res = elems.at(i->to_int());
+      } else {
+        res = elems.back();
+        for (size_t j = elems.size() - 1; j-- > 0;) {
+          res = solver_->make_term(
+              Ite, solver_->make_term(Equal, i, idx[j]), elems[j], res);
+        }
+      }
+    } else if ((op == Equal || op == Distinct) && array_arg) {
+      // elementwise, distinct arrays differ in some element
+      auto equal = [&](const Term & a, const Term & b) {
+        const TermVec & ae = elements_.at(a);
+        const TermVec & be = elements_.at(b);
+        TermVec eqs;
+        for (size_t j = 0; j < ae.size(); ++j) {
+          eqs.push_back(solver_->make_term(Equal, ae[j], be[j]));
+        }
+        return make_and(solver_, eqs);
+      };
+      TermVec conjuncts;
+      if (op == Equal) {
+        for (size_t k = 1; k < children.size(); ++k) {
+          conjuncts.push_back(equal(children[0], children[k]));
+        }
+      } else {
+        for (size_t k = 0; k < children.size(); ++k) {
+          for (size_t l = k + 1; l < children.size(); ++l) {
+            conjuncts.push_back(
+                solver_->make_term(Not, equal(children[k], children[l])));
+          }
+        }
+      }
+      res = make_and(solver_, conjuncts);
+    } else {
+      TermVec flat_children;
+      flat_children.reserve(children.size());
+      for (const auto & c : children) {
+        if (is_flattened(c->get_sort())) {
+          throw PonoException("can't flatten " + op.to_string()
+                              + " over arrays");
+        }
+        flat_children.push_back(cache_.at(c));
+      }
+      res = solver_->make_term(op, flat_children);
+    }
+    cache_[cur] = res;
+  }
+}
+
+}  // namespace pono
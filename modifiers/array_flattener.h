@@ -0,0 +1,102 @@
+/*********************                                                        */
+/*! \file array_flattener.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Expands small arrays (e.g. register files) into one bit-vector
+**        variable per element. Selects become chains of ites over the
+**        elements and stores update every element under a comparison
+**        of the indices.
+**
+**/
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "core/ts.h"
+
+namespace pono {
+
+class ArrayFlattener
+{
+ public:
+  /** This class modifies the transition system on construction
+   *  The arrays of a sort are flattened if its indices and elements are
+   *  bit-vectors, the indices have at most max_index_width bits, and
+   *  the size of the ite chains, the number of elements times the number
+   *  of selects and stores of that sort in the system, is at most
+   *  max_cost.
+   *  Relational systems and systems with other array terms than
+   *  variables, stores, ites and constant arrays (of the chosen sorts)
+   *  are left unchanged.
+   *  @param ts the transition system to modify
+   *  @param max_index_width the largest width of a flattened index
+   *  @param max_cost the largest cost of a flattened sort
+   */
+  ArrayFlattener(TransitionSystem & ts,
+                 size_t max_index_width,
+                 size_t max_cost = default_max_cost);
+
+  static const size_t default_max_cost = 1 << 16;
+
+  /** @return true iff some arrays were flattened */
+  bool flattened() const { return !vars_.empty(); }
+
+  /** @return the array variables that were flattened (current state
+   *          variables and inputs of the original system)
+   */
+  const smt::TermVec & flattened_vars() const { return vars_; }
+
+  /** @return t over the flattened system */
+  smt::Term rewrite(const smt::Term & t);
+
+  /** Adds to each state of a witness of the flattened system the value
+   *  of every flattened array: a constant array of its first element
+   *  with a store for each other element, as the witness printers
+   *  expect it
+   *  @param cex the witness to update in place
+   */
+  void lift_witness(std::vector<smt::UnorderedTermMap> & cex) const;
+
+ protected:
+  /** Chooses sorts_ with the cost heuristic */
+  void choose_sorts(size_t max_index_width, size_t max_cost);
+
+  /** Flattens the system into a new one, assigned to ts_ on success */
+  void flatten_ts();
+
+  /** @return true iff the arrays of sort are flattened */
+  bool is_flattened(const smt::Sort & sort) const;
+
+  /** Computes the flattened version of t and its subterms, into
+   *  elements_ for arrays of a flattened sort and cache_ for the others
+   *  @throw PonoException for an array term that can't be flattened
+   */
+  void flatten(const smt::Term & t);
+
+  /** @return the values of the indices of arrays of sort */
+  const smt::TermVec & indices(const smt::Sort & sort);
+
+  TransitionSystem & ts_;
+  smt::SmtSolver solver_;
+
+  smt::UnorderedSortSet sorts_;  ///< the array sorts to flatten
+  std::unordered_map<smt::Sort, smt::TermVec> indices_;
+
+  ///< flattened array terms -> their elements in index order
+  std::unordered_map<smt::Term, smt::TermVec> elements_;
+  ///< other terms -> their rewritten versions
+  smt::UnorderedTermMap cache_;
+
+  smt::TermVec vars_;
+};
+
+}  // namespace pono
@@ -0,0 +1,166 @@
+/*********************                                                        */
+/*! \file constant_propagation.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Word-level constant propagation and structural simplification of
+**        a transition system.
+**
+**/
+
+#include "modifiers/constant_propagation.h"
+
+#include "assert.h"
+#include "smt-switch/utils.h"
+#include "utils/logger.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+ConstantPropagation::ConstantPropagation(TransitionSystem & ts) : ts_(ts)
+{
+  logger.log(1, "Starting constant propagation:");
+  logger.log(1, "  - state variables: {}", ts_.statevars().size());
+
+  const SmtSolver & solver = ts_.solver();
+  if (ts_.is_functional()) {
+    find_init_values();
+    UnorderedTermMap candidates;
+    const UnorderedTermMap & updates = ts_.state_updates();
+    for (const auto & elem : init_values_) {
+      if (updates.find(elem.first) != updates.end()) {
+        candidates.insert(elem);
+      }
+    }
+    size_t rounds = 1;
+    while (refine_constants(candidates)) {
+      ++rounds;
+    }
+    constants_ = candidates;
+    logger.log(2, "Constant propagation: {} rounds", rounds);
+  }
+
+  simplifier_.reset(new TermSimplifier(solver, constants_));
+  apply();
+
+  logger.log(1,
+             "Constant propagation completed: {} constant latches, {} "
+             "remaining state variables",
+             constants_.size(),
+             ts_.statevars().size());
+}
+
+Term ConstantPropagation::rewrite(const Term & t)
+{
+  return simplifier_->simplify(t);
+}
+
+void ConstantPropagation::find_init_values()
+{
+  TermVec conjuncts;
+  conjunctive_partition(ts_.init(), conjuncts, false);
+  const SmtSolver & solver = ts_.solver();
+  for (const auto & conj : conjuncts) {
+    Term var, val;
+    Op op = conj->get_op();
+    if (ts_.is_curr_var(conj)) {
+      var = conj;
+      val = solver->make_term(true);
+    } else if (op == Not && ts_.is_curr_var(*conj->begin())) {
+      var = *conj->begin();
+      val = solver->make_term(false);
+    } else if (op == Equal) {
+      TermVec ch;
+      for (auto c : conj) {
+        ch.push_back(c);
+      }
+      for (size_t i = 0; i < 2; ++i) {
+        if (ts_.is_curr_var(ch[i]) && ch[1 - i]->is_value()) {
+          var = ch[i];
+          val = ch[1 - i];
+        }
+      }
+    }
+    if (var && init_values_.find(var) == init_values_.end()) {
+      init_values_[var] = val;
+    }
+  }
+}
+
+bool ConstantPropagation::refine_constants(UnorderedTermMap & candidates)
+{
+  TermSimplifier simplifier(ts_.solver(), candidates);
+  const UnorderedTermMap & updates = ts_.state_updates();
+  TermVec dropped;
+  for (const auto & elem : candidates) {
+    if (simplifier.simplify(updates.at(elem.first)) != elem.second) {
+      dropped.push_back(elem.first);
+    }
+  }
+  for (const auto & sv : dropped) {
+    candidates.erase(sv);
+  }
+  return dropped.size();
+}
+
+void ConstantPropagation::apply()
+{
+  UnorderedTermMap to_replace = constants_;
+  auto add = [&](const Term & t) {
+    Term simplified = simplifier_->simplify(t);
+    if (simplified != t) {
+      to_replace[t] = simplified;
+    }
+  };
+
+  add(ts_.init());
+  for (const auto & elem : ts_.state_updates()) {
+    add(elem.second);
+  }
+  for (const auto & e : ts_.constraints()) {
+    add(e.first);
+  }
+  for (const auto & elem : ts_.named_terms()) {
+    add(elem.second);
+  }
+  if (!ts_.is_functional()) {
+    for (const auto & c : ts_.trans_conjuncts()) {
+      add(c);
+    }
+  }
+
+  if (to_replace.empty()) {
+    return;
+  }
+
+  // rebuild the system once
+  TransitionSystem::Rewrite rw = ts_.begin_rewrite();
+  TermVec dropped;
+  for (const auto & elem : constants_) {
+    dropped.push_back(elem.first);
+  }
+  rw.drop_state_updates(dropped);
+  rw.replace_terms(to_replace);
+
+  if (ts_.is_functional()) {
+    // rebuild trans from the simplified updates and constraints
+    UnorderedTermSet statevars;
+    for (const auto & sv : ts_.statevars()) {
+      if (constants_.find(sv) == constants_.end()) {
+        statevars.insert(sv);
+      }
+    }
+    rw.restrict_vars(statevars, ts_.inputvars());
+  }
+  ts_.commit_rewrite(rw);
+}
+
+}  // namespace pono
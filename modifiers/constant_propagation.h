@@ -0,0 +1,74 @@
+/*********************                                                        */
+/*! \file constant_propagation.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Word-level constant propagation and structural simplification of
+**        a transition system. The state updates, init, constraints and
+**        named terms are simplified with one shared cache. Constant
+**        latches are found as a greatest fixed point: all the state
+**        variables with an initial value are assumed to keep it, and the
+**        ones whose update does not simplify to it under this assumption
+**        are dropped until the rest is stable.
+**
+**/
+
+#pragma once
+
+#include <memory>
+
+#include "core/ts.h"
+#include "utils/term_walkers.h"
+
+namespace pono {
+
+class ConstantPropagation
+{
+ public:
+  /** This class simplifies the transition system on construction
+   *  Constant latches are only detected in functional systems, and they
+   *  are removed like the state variables outside of the
+   *  cone-of-influence, so terms over them (e.g. the property) must be
+   *  rewritten with rewrite().
+   *  @param ts the transition system to modify
+   */
+  ConstantPropagation(TransitionSystem & ts);
+
+  /** @return the simplified t, with the constant latches replaced */
+  smt::Term rewrite(const smt::Term & t);
+
+  /** @return the value of each constant latch */
+  const smt::UnorderedTermMap & constants() const { return constants_; }
+
+ protected:
+  /** Collect the initial values of the state variables from the
+   *  conjuncts v = value (or v, !v for booleans) of init
+   */
+  void find_init_values();
+
+  /** Drop the candidate constant latches whose update does not simplify
+   *  to their initial value, with all the candidates replaced by their
+   *  initial value
+   *  @param candidates the candidates and their initial values
+   *  @return true iff a candidate was dropped
+   */
+  bool refine_constants(smt::UnorderedTermMap & candidates);
+
+  /** Replace all the terms of the system with their simplification */
+  void apply();
+
+  TransitionSystem & ts_;
+
+  smt::UnorderedTermMap init_values_;
+  smt::UnorderedTermMap constants_;
+
+  std::unique_ptr<TermSimplifier> simplifier_;
+};
+
+}  // namespace pono
@@ -19,11 +19,35 @@
 
 #include "modifiers/control_signals.h"
 
+#include "core/unroller.h"
+#include "smt/available_solvers.h"
+#include "utils/logger.h"
+#include "utils/term_analysis.h"
+
 using namespace smt;
 using namespace std;
 
 namespace pono {
 
+/** @return a term that is true when the reset signal is active */
+static Term active_reset_term(const SmtSolver & s, const Term & reset_symbol)
+{
+  Sort reset_sort = reset_symbol->get_sort();
+  SortKind sk = reset_sort->get_sort_kind();
+
+  Sort one_bit_sort = s->make_sort(BV, 1);
+  if (sk != BOOL && reset_sort != one_bit_sort) {
+    throw PonoException("Unexpected reset symbol sort: "
+                        + reset_symbol->get_sort()->to_string());
+  }
+
+  assert(sk == BOOL || sk == BV);
+  if (sk == BV) {
+    return s->make_term(Equal, reset_symbol, s->make_term(1, one_bit_sort));
+  }
+  return reset_symbol;
+}
+
 void toggle_clock(TransitionSystem & ts, const Term & clock_symbol)
 {
   const SmtSolver & s = ts.solver();
@@ -53,19 +77,84 @@ void toggle_clock(TransitionSystem & ts, const Term & clock_symbol)
   }
 }
 
+bool fold_clock(TransitionSystem & ts,
+                const Term & clock_symbol,
+                const TermVec & props)
+{
+  const SmtSolver & s = ts.solver();
+  Sort sort = clock_symbol->get_sort();
+  SortKind sk = sort->get_sort_kind();
+  Sort one_bit_sort = s->make_sort(BV, 1);
+
+  if (clock_symbol->get_sort() != one_bit_sort && sk != BOOL) {
+    throw PonoException("Expecting a boolean or one-bit clock sort.");
+  }
+
+  if (!ts.is_functional() || !ts.is_input_var(clock_symbol)) {
+    logger.log(1, "Clock folding: needs a functional system and clock input");
+    return false;
+  }
+  for (const auto & c : ts.constraints()) {
+    if (get_free_symbols(c.first).count(clock_symbol)) {
+      logger.log(1, "Clock folding: a constraint uses the clock");
+      return false;
+    }
+  }
+  for (const auto & p : props) {
+    if (get_free_symbols(p).count(clock_symbol)) {
+      logger.log(1, "Clock folding: a property uses the clock");
+      return false;
+    }
+  }
+
+  // find a phase whose step is the identity on all state variables
+  TermVec phases;
+  if (sk == BV) {
+    phases = { s->make_term(0, one_bit_sort), s->make_term(1, one_bit_sort) };
+  } else {
+    phases = { s->make_term(false), s->make_term(true) };
+  }
+
+  SmtSolver solver = create_solver(s->get_solver_enum());
+  solver->set_opt("incremental", "true");
+  TermTranslator to_solver(solver);
+  for (size_t idle = 0; idle < phases.size(); ++idle) {
+    UnorderedTermMap subst({ { clock_symbol, phases[idle] } });
+    Term changes = solver->make_term(false);
+    for (const auto & elem : ts.state_updates()) {
+      Term update = s->substitute(elem.second, subst);
+      if (update == elem.first) {
+        continue;
+      }
+      Term eq = to_solver.transfer_term(
+          s->make_term(Equal, elem.first, update), BOOL);
+      changes = solver->make_term(Or, changes, solver->make_term(Not, eq));
+    }
+    solver->push();
+    solver->assert_formula(changes);
+    Result r = solver->check_sat();
+    solver->pop();
+    if (r.is_unsat()) {
+      const Term & active = phases[1 - idle];
+      logger.log(1,
+                 "Clock folding: state only changes when {} is {}",
+                 clock_symbol,
+                 active);
+      ts.replace_terms({ { clock_symbol, active } });
+      return true;
+    }
+  }
+
+  logger.log(1, "Clock folding: state changes in both clock phases");
+  return false;
+}
+
 Term add_reset_seq(TransitionSystem & ts,
                    const Term & reset_symbol,
                    size_t reset_bnd)
 {
   const SmtSolver & s = ts.solver();
-  Sort reset_sort = reset_symbol->get_sort();
-  SortKind sk = reset_sort->get_sort_kind();
-
-  Sort one_bit_sort = s->make_sort(BV, 1);
-  if (sk != BOOL && reset_sort != one_bit_sort) {
-    throw PonoException("Unexpected reset symbol sort: "
-                        + reset_symbol->get_sort()->to_string());
-  }
+  Term active_reset = active_reset_term(s, reset_symbol);
 
   uint32_t num_bits = ceil(log2(reset_bnd)) + 1;
   Sort bvsort = s->make_sort(BV, num_bits);
@@ -85,13 +174,6 @@ Term add_reset_seq(TransitionSystem & ts,
           reset_counter,
           s->make_term(BVAdd, reset_counter, s->make_term(1, bvsort))));
 
-  assert(sk == BOOL || sk == BV);
-  Term active_reset = reset_symbol;  // if it's boolean
-  if (sk == BV) {
-    active_reset =
-        s->make_term(Equal, reset_symbol, s->make_term(1, one_bit_sort));
-  }
-
   Term inactive_reset = s->make_term(Not, active_reset);
   ts.constrain_inputs(s->make_term(Implies, in_reset, active_reset));
   ts.constrain_inputs(s->make_term(Implies, reset_done, inactive_reset));
@@ -99,4 +181,89 @@ Term add_reset_seq(TransitionSystem & ts,
   return reset_done;
 }
 
+bool presimulate_reset(TransitionSystem & ts,
+                       const Term & reset_symbol,
+                       size_t reset_bnd)
+{
+  const SmtSolver & s = ts.solver();
+  Term active_reset = active_reset_term(s, reset_symbol);
+
+  for (const auto & sv : ts.statevars()) {
+    SortKind sk = sv->get_sort()->get_sort_kind();
+    if (sk != BOOL && sk != BV) {
+      logger.log(1,
+                 "Reset pre-simulation: state variable {} of sort {} "
+                 "is not supported",
+                 sv,
+                 sv->get_sort());
+      return false;
+    }
+  }
+
+  // the reset phase in a fresh solver
+  SmtSolver solver = create_solver(s->get_solver_enum());
+  solver->set_opt("incremental", "true");
+  solver->set_opt("produce-models", "true");
+  TermTranslator to_solver(solver);
+  TermTranslator to_ts(s);
+  // its own suffix, so the engines can unroll ts in the same solver
+  Unroller unroller(ts, "@reset_presim_");
+
+  solver->assert_formula(
+      to_solver.transfer_term(unroller.at_time(ts.init(), 0), BOOL));
+  for (size_t t = 0; t < reset_bnd; ++t) {
+    solver->assert_formula(
+        to_solver.transfer_term(unroller.at_time(ts.trans(), t), BOOL));
+    solver->assert_formula(
+        to_solver.transfer_term(unroller.at_time(active_reset, t), BOOL));
+  }
+
+  Result r = solver->check_sat();
+  if (!r.is_sat()) {
+    logger.log(1,
+               "Reset pre-simulation: no path through the reset sequence "
+               "({})",
+               r.to_string());
+    return false;
+  }
+
+  // the state after reset, and whether any other one is reachable
+  TermVec post_reset;
+  TermVec differs;
+  for (const auto & sv : ts.statevars()) {
+    Term sv_bnd = to_solver.transfer_term(unroller.at_time(sv, reset_bnd));
+    Term val = solver->get_value(sv_bnd);
+    post_reset.push_back(s->make_term(Equal, sv, to_ts.transfer_term(val)));
+    differs.push_back(
+        solver->make_term(Not, solver->make_term(Equal, sv_bnd, val)));
+  }
+
+  if (differs.size()) {
+    Term some_differ = differs[0];
+    for (size_t i = 1; i < differs.size(); ++i) {
+      some_differ = solver->make_term(Or, some_differ, differs[i]);
+    }
+    solver->assert_formula(some_differ);
+    r = solver->check_sat();
+    if (!r.is_unsat()) {
+      logger.log(1,
+                 "Reset pre-simulation: the state after reset depends on "
+                 "the inputs or the initial state");
+      return false;
+    }
+  }
+
+  logger.log(1,
+             "Reset pre-simulation: starting from the state after {} "
+             "reset steps",
+             reset_bnd);
+  Term init = s->make_term(true);
+  for (const auto & eq : post_reset) {
+    init = s->make_term(And, init, eq);
+  }
+  ts.set_init(init);
+  ts.constrain_inputs(s->make_term(Not, active_reset));
+  return true;
+}
+
 }  // namespace pono
@@ -29,6 +29,26 @@ namespace pono {
  */
 void toggle_clock(TransitionSystem & ts, const smt::Term & clock_symbol);
 
+/** Alternative to toggle_clock for designs where the state only changes
+ *  in one clock phase (e.g. posedge-only). Then the step of the other
+ *  phase does not change any state variable, and every clock cycle can
+ *  be one transition: the clock is replaced by its active value. This
+ *  halves the unrolling depth, and every state of the toggled system is
+ *  still reached (the idle steps only repeat states).
+ *
+ *  Only applies if ts is functional, the clock is an input and neither
+ *  the constraints nor the given terms (the properties) use it.
+ *  Otherwise ts is unchanged and toggle_clock should be used instead.
+ *
+ *  @param ts the TransitionSystem to modify
+ *  @param clock_symbol the clock input, a boolean or bit-vector of size one
+ *  @param props terms that are checked over ts, they must not use the clock
+ *  @return true iff ts was modified
+ */
+bool fold_clock(TransitionSystem & ts,
+                const smt::Term & clock_symbol,
+                const smt::TermVec & props);
+
 /** Holds a reset signal active for reset_bnd steps starting in the first state.
  *  Returns the condition to guard a property with to not check
  *  it until after the reset sequence has ended.
@@ -44,4 +64,24 @@ smt::Term add_reset_seq(TransitionSystem & ts,
                         const smt::Term & reset_symbol,
                         size_t reset_bnd = 1);
 
+/** Replaces the reset sequence of add_reset_seq by its result: simulates
+ *  reset_bnd steps with the reset signal active and, if they always end
+ *  in the same state, makes that state the only initial state and holds
+ *  reset inactive from then on. The property then needs no guard, and
+ *  the engines never unroll the reset phase. Traces start after reset.
+ *
+ *  The post-reset state is unique if it does not depend on the inputs or
+ *  on the choice of initial state. If it is not, or the system has state
+ *  variables that are not booleans or bit-vectors, ts is unchanged and
+ *  add_reset_seq should be used instead.
+ *
+ *  @param ts the transition system to modify
+ *  @param reset_symbol the reset signal, as for add_reset_seq
+ *  @param reset_bnd how many steps to hold reset active
+ *  @return true iff ts was modified
+ */
+bool presimulate_reset(TransitionSystem & ts,
+                       const smt::Term & reset_symbol,
+                       size_t reset_bnd = 1);
+
 }  // namespace pono
@@ -0,0 +1,331 @@
+/*********************                                                        */
+/*! \file fraig.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Merges functionally equivalent internal nodes of the state
+**        updates and constraints.
+**
+**/
+
+#include "modifiers/fraig.h"
+
+#include <memory>
+#include <unordered_map>
+
+#include "assert.h"
+#include "smt-switch/term_translator.h"
+#include "smt/available_solvers.h"
+#include "utils/bit_parallel_simulator.h"
+#include "utils/budget.h"
+#include "utils/exceptions.h"
+#include "utils/logger.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+namespace {
+
+uint64_t mix(uint64_t h, uint64_t x)
+{
+  h ^= x + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+  return h;
+}
+
+bool simulated_sort(const Sort & sort)
+{
+  SortKind sk = sort->get_sort_kind();
+  return sk == BOOL || (sk == BV && sort->get_width() <= 64);
+}
+
+}  // namespace
+
+Fraig::Fraig(TransitionSystem & ts,
+             size_t lanes,
+             size_t cycles,
+             size_t query_ms,
+             size_t max_nodes,
+             unsigned int seed)
+    : ts_(ts)
+{
+  logger.log(1, "Starting SAT sweeping:");
+
+  if (!ts_.is_functional()) {
+    logger.log(1, "SAT sweeping skipped: system is not functional");
+    return;
+  }
+
+  collect(max_nodes);
+  logger.log(1, "  - nodes: {}", nodes_.size());
+  if (!propose(lanes, cycles, seed)) {
+    return;
+  }
+  size_t num_candidates = candidates_.size();
+  prove(query_ms);
+  merge();
+
+  logger.log(1,
+             "SAT sweeping completed: merged {} of {} candidates",
+             candidates_.size(),
+             num_candidates);
+}
+
+Term Fraig::rewrite(const Term & t) const
+{
+  if (subst_.empty()) {
+    return t;
+  }
+  return ts_.solver()->substitute(t, subst_);
+}
+
+void Fraig::collect(size_t max_nodes)
+{
+  TermVec roots;
+  for (const auto & elem : ts_.state_updates()) {
+    roots.push_back(elem.second);
+  }
+  for (const auto & c : ts_.constraints()) {
+    roots.push_back(c.first);
+  }
+
+  // post-order, so the representative of a class is never above the
+  // nodes it replaces
+  UnorderedTermSet visited;
+  TermVec to_visit;
+  for (const auto & r : roots) {
+    to_visit.push_back(r);
+    while (to_visit.size() && nodes_.size() < max_nodes) {
+      Term t = to_visit.back();
+      if (t->is_value() || visited.find(t) != visited.end()) {
+        to_visit.pop_back();
+        continue;
+      }
+
+      bool children_done = true;
+      for (const auto & c : t) {
+        if (!c->is_value() && visited.find(c) == visited.end()) {
+          to_visit.push_back(c);
+          children_done = false;
+        }
+      }
+      if (!children_done) {
+        continue;
+      }
+
+      to_visit.pop_back();
+      visited.insert(t);
+      if (simulated_sort(t->get_sort())) {
+        nodes_.push_back(t);
+      }
+    }
+    to_visit.clear();
+  }
+}
+
+bool Fraig::propose(size_t lanes, size_t cycles, unsigned int seed)
+{
+  unique_ptr<BitParallelSimulator> sim;
+  try {
+    sim.reset(new BitParallelSimulator(ts_, lanes, seed));
+  }
+  catch (PonoException & e) {
+    logger.log(1, "SAT sweeping skipped: {}", e.what());
+    return false;
+  }
+
+  // nodes the simulator does not support are dropped
+  TermVec nodes;
+  vector<uint32_t> ids;
+  for (const auto & t : nodes_) {
+    if (!sim->supported(t)) {
+      continue;
+    }
+    nodes.push_back(t);
+    ids.push_back(sim->add_output(t));
+  }
+  nodes_ = nodes;
+
+  size_t n = nodes_.size();
+  vector<uint32_t> widths(n);
+  for (size_t i = 0; i < n; ++i) {
+    Sort sort = nodes_[i]->get_sort();
+    widths[i] = sort->get_sort_kind() == BOOL ? 1 : sort->get_width();
+  }
+
+  // as in LatchSweep, the signature hashes the values of all traces in
+  // every cycle and seen0 / seen1 are the bits that were 0 / 1 at least
+  // once
+  vector<uint64_t> signatures(n, 0);
+  vector<uint64_t> seen0(n, 0);
+  vector<uint64_t> seen1(n, 0);
+  size_t words = sim->num_lanes() / 64;
+  if (!sim->reset()) {
+    logger.log(1, "SAT sweeping skipped: no initial state found");
+    return false;
+  }
+  for (size_t c = 0; c < cycles; ++c) {
+    if (c && !sim->step()) {
+      break;
+    }
+    const vector<uint64_t> & alive = sim->alive();
+    for (size_t i = 0; i < n; ++i) {
+      for (uint32_t b = 0; b < widths[i]; ++b) {
+        const uint64_t * p = sim->bits(ids[i], b);
+        for (size_t k = 0; k < words; ++k) {
+          uint64_t x = p[k] & alive[k];
+          signatures[i] = mix(signatures[i], x);
+          if (x) {
+            seen1[i] |= uint64_t(1) << b;
+          }
+          if (~p[k] & alive[k]) {
+            seen0[i] |= uint64_t(1) << b;
+          }
+        }
+      }
+    }
+  }
+
+  const SmtSolver & solver = ts_.solver();
+  unordered_map<uint64_t, TermVec> classes;
+  for (size_t i = 0; i < n; ++i) {
+    const Term & t = nodes_[i];
+    // variables are only representatives
+    bool is_var = t->is_symbolic_const();
+    Sort sort = t->get_sort();
+    Term rep;
+    if (!is_var && !(seen0[i] & seen1[i])) {
+      // one value in all the traces
+      rep = sort->get_sort_kind() == BOOL
+                ? solver->make_term(seen1[i] != 0)
+                : solver->make_term(std::to_string(seen1[i]), sort);
+    } else {
+      TermVec & cls = classes[signatures[i]];
+      for (const auto & r : cls) {
+        if (r->get_sort() == sort) {
+          rep = r;
+          break;
+        }
+      }
+      if (!rep) {
+        cls.push_back(t);
+        continue;
+      }
+      if (is_var) {
+        continue;
+      }
+    }
+    candidates_.push_back({ t, rep });
+  }
+
+  logger.log(1,
+             "SAT sweeping: {} candidates after simulating {} cycles",
+             candidates_.size(),
+             sim->num_cycles());
+  return true;
+}
+
+void Fraig::prove(size_t query_ms)
+{
+  if (candidates_.empty()) {
+    return;
+  }
+
+  // combinational queries in a fresh solver, nothing is asserted but the
+  // negated equivalence
+  SmtSolver solver = create_solver(ts_.solver()->get_solver_enum());
+  solver->set_opt("incremental", "true");
+  if (query_ms) {
+    set_query_time_limit(solver, query_ms);
+  }
+  TermTranslator tt(solver);
+
+  unordered_map<Term, Term> reps;
+  for (const auto & c : candidates_) {
+    reps[c.node] = c.rep;
+  }
+
+  // the nodes with the proven candidates below them replaced, so that
+  // structurally equal nodes are merged without a query
+  const SmtSolver & ts_solver = ts_.solver();
+  UnorderedTermMap simplified;
+  auto lookup = [&simplified](const Term & t) {
+    auto it = simplified.find(t);
+    return it == simplified.end() ? t : it->second;
+  };
+
+  vector<Candidate> proven;
+  size_t num_structural = 0, num_unknown = 0;
+  TermVec children;
+  for (const auto & t : nodes_) {
+    Term s = t;
+    if (!t->is_symbolic_const()) {
+      children.clear();
+      bool changed = false;
+      for (const auto & c : t) {
+        children.push_back(lookup(c));
+        changed |= children.back() != c;
+      }
+      if (changed) {
+        s = ts_solver->make_term(t->get_op(), children);
+      }
+    }
+
+    auto it = reps.find(t);
+    if (it != reps.end()) {
+      Term rep = lookup(it->second);
+      bool equal = (s == rep);
+      if (equal) {
+        ++num_structural;
+      } else {
+        solver->push();
+        solver->assert_formula(solver->make_term(
+            Distinct, tt.transfer_term(s), tt.transfer_term(rep)));
+        Result r = solver->check_sat();
+        solver->pop();
+        equal = r.is_unsat();
+        num_unknown += r.is_unknown();
+      }
+      if (equal) {
+        logger.log(2, "SAT sweeping: merged {} into {}", t, rep);
+        proven.push_back({ t, rep });
+        s = rep;
+      }
+    }
+    if (s != t) {
+      simplified[t] = s;
+    }
+  }
+
+  logger.log(1,
+             "SAT sweeping: {} merged structurally, {} queries timed out",
+             num_structural,
+             num_unknown);
+  candidates_ = proven;
+}
+
+void Fraig::merge()
+{
+  if (candidates_.empty()) {
+    return;
+  }
+
+  // the replacements don't contain merged nodes, see prove
+  for (const auto & c : candidates_) {
+    assert(subst_.find(c.rep) == subst_.end());
+    subst_[c.node] = c.rep;
+  }
+
+  TransitionSystem::Rewrite rw = ts_.begin_rewrite();
+  rw.replace_terms(subst_);
+  ts_.commit_rewrite(rw);
+}
+
+}  // namespace pono
@@ -0,0 +1,100 @@
+/*********************                                                        */
+/*! \file fraig.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Merges functionally equivalent internal nodes of the state
+**        updates and constraints (SAT sweeping, or fraiging). Candidates
+**        are proposed by bit-parallel random simulation: nodes with the
+**        same values in every simulated cycle are candidate equivalences,
+**        and those with a single value are candidate constants. Each
+**        candidate is proven combinationally (for all values of the
+**        variables, not only the reachable ones) by a SAT query with a
+**        small time limit, and the proven ones are replaced by their
+**        representative.
+**
+**        Unlike LatchSweep, no variable is removed, the state updates
+**        just share more of their subterms.
+**
+**/
+
+#pragma once
+
+#include "core/ts.h"
+
+namespace pono {
+
+class Fraig
+{
+ public:
+  /** This class modifies the transition system on construction
+   *  Relational systems and systems the simulator does not support are
+   *  left unchanged. Terms over the system (e.g. the property) stay
+   *  valid, and can be simplified with rewrite().
+   *  @param ts the transition system to modify
+   *  @param lanes the number of simulated traces, a positive multiple of 64
+   *  @param cycles the length of the simulated traces
+   *  @param query_ms the time limit of each equivalence query in
+   *         milliseconds, 0 for none
+   *  @param max_nodes the maximum number of nodes considered
+   *  @param seed the seed for the random simulation
+   */
+  Fraig(TransitionSystem & ts,
+        size_t lanes = 256,
+        size_t cycles = 16,
+        size_t query_ms = 100,
+        size_t max_nodes = 20000,
+        unsigned int seed = 0);
+
+  /** @return t with the merged nodes replaced */
+  smt::Term rewrite(const smt::Term & t) const;
+
+  /** @return the replacement of each merged node, an equivalent node or
+   *          a value
+   */
+  const smt::UnorderedTermMap & substitution() const { return subst_; }
+
+ protected:
+  /** Collect the nodes of the state updates and constraints, children
+   *  before their parents
+   *  @param max_nodes the maximum number of nodes
+   */
+  void collect(size_t max_nodes);
+
+  /** Propose candidates from the simulation signatures of the nodes
+   *  @param lanes the number of simulated traces
+   *  @param cycles the length of the simulated traces
+   *  @param seed the seed for the random simulation
+   *  @return false if the system cannot be simulated
+   */
+  bool propose(size_t lanes, size_t cycles, unsigned int seed);
+
+  /** Check the candidates, children first, and keep the proven ones
+   *  @param query_ms the time limit of each query
+   */
+  void prove(size_t query_ms);
+
+  /** Replace the proven candidates in the system */
+  void merge();
+
+  TransitionSystem & ts_;
+
+  smt::TermVec nodes_;  ///< boolean and bit-vector nodes, in post-order
+
+  struct Candidate
+  {
+    smt::Term node;  ///< the node to replace
+    smt::Term rep;   ///< a node before it in nodes_ or a value
+  };
+  std::vector<Candidate> candidates_;  ///< in the order of nodes_
+
+  smt::UnorderedTermMap subst_;
+};
+
+}  // namespace pono
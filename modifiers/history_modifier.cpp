@@ -34,6 +34,13 @@ Term HistoryModifier::get_hist(const Term & target, size_t delay)
     return target;
   }
 
+  auto it = hist_info_.find(target);
+  if (it != hist_info_.end()) {
+    // a history of a history variable: extend the original chain
+    // instead of starting a new one
+    return get_hist(it->second.first, it->second.second + delay);
+  }
+
   Sort sort = target->get_sort();
 
   // create new history variables if needed
@@ -70,6 +77,7 @@ Term HistoryModifier::get_hist(const Term & target, size_t delay)
     }
 
     hist_vars_[target].push_back(var);
+    hist_info_[var] = { target, num_existing_hist_vars };
   }
 
   // get the desired variable
@@ -15,6 +15,8 @@
 **/
 #pragma once
 
+#include <utility>
+
 #include "core/ts.h"
 
 namespace pono {
@@ -29,9 +31,15 @@ class HistoryModifier
    *  @param target a current state variable to target for a history variable
    *  @param delay the amount of delay to introduce for the history
    *  @return the history variable
+   *  The variables are pooled: a history of a history variable reuses
+   *  the chain of its target, and the chain of a target is only
+   *  extended up to the largest delay requested so far.
    */
   smt::Term get_hist(const smt::Term & target, size_t delay);
 
+  /** @return the number of history variables created so far */
+  size_t num_hist_vars() const { return hist_info_.size(); }
+
  protected:
   TransitionSystem & ts_;
   const smt::SmtSolver solver_;
@@ -39,6 +47,8 @@ class HistoryModifier
   // maps current state variables to a list of history variables
   // where the index corresponds to the delay (-1)
   std::unordered_map<smt::Term, smt::TermVec> hist_vars_;
+  // maps each history variable to its target and delay
+  std::unordered_map<smt::Term, std::pair<smt::Term, size_t>> hist_info_;
 };
 
 }  // namespace pono
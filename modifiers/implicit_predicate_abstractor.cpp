@@ -17,7 +17,11 @@
 
 #include "modifiers/implicit_predicate_abstractor.h"
 
+#include <utility>
+#include <vector>
+
 #include "assert.h"
+#include "utils/core_minimizer.h"
 #include "utils/logger.h"
 #include "smt/available_solvers.h"
 
@@ -49,7 +53,8 @@ ImplicitPredicateAbstractor::ImplicitPredicateAbstractor(
       reducer_(create_solver(solver_->get_solver_enum(), false, true, false)),
       to_reducer_(reducer_),
       abs_rts_(static_cast<RelationalTransitionSystem &>(abs_ts_)),
-      red_can_reset_(true)  // start by assuming it can reset
+      red_can_reset_(true),  // start by assuming it can reset
+      core_min_time_(0)
 {
   if (conc_ts_.solver() != abs_ts_.solver()) {
     throw PonoException(
@@ -79,12 +84,48 @@ Term ImplicitPredicateAbstractor::concrete(Term & t)
   return solver_->substitute(t, concretization_cache_);
 }
 
+Term ImplicitPredicateAbstractor::shadow(const Term & nv)
+{
+  auto it = abstraction_cache_.find(nv);
+  if (it != abstraction_cache_.end()) {
+    return it->second;
+  }
+  // note: this is not a state variable -- using input variable so there's no
+  // next
+  Term abs_nv = abs_rts_.make_inputvar(nv->to_string() + "^", nv->get_sort());
+  // map next var to this abstracted next var
+  update_term_cache(nv, abs_nv);
+  return abs_nv;
+}
+
 Term ImplicitPredicateAbstractor::predicate_refinement(const Term & pred)
 {
   assert(abstracted_);
   Term next_pred = abs_ts_.next(pred);
+
+  // the abstract variables of the predicate, with the updates that were
+  // left out of the transition relation
+  TermVec updates;
+  UnorderedTermSet free_vars;
+  get_free_symbolic_consts(next_pred, free_vars);
+  for (const auto & v : free_vars) {
+    if (!abs_ts_.is_next_var(v) || v->get_sort()->get_sort_kind() == BOOL) {
+      // boolean variables are precise
+      continue;
+    }
+    Term abs_nv = shadow(v);
+    auto it = deferred_updates_.find(v);
+    if (it != deferred_updates_.end()) {
+      updates.push_back(solver_->make_term(Equal, abs_nv, it->second));
+    }
+  }
+
   // constrain next state vars and abstract vars to agree on this predicate
-  return solver_->make_term(Equal, next_pred, abstract(next_pred));
+  Term res = solver_->make_term(Equal, next_pred, abstract(next_pred));
+  for (const auto & u : updates) {
+    res = solver_->make_term(And, res, u);
+  }
+  return res;
 }
 
 bool ImplicitPredicateAbstractor::reduce_predicates(const TermVec & cex,
@@ -126,8 +167,15 @@ bool ImplicitPredicateAbstractor::reduce_predicates(const TermVec & cex,
   reducer_->assert_formula(to_reducer_.transfer_term(formula));
   Result res = reducer_->check_sat_assuming(assumps);
   if (!res.is_unsat()) {
-    // TODO: investigate this in more detail
+    // unknown if the reducer hit its query limit, keep the unreduced set
+    // TODO: investigate sat in more detail
     // it doesn't seem like this should happen
+    logger.log(2,
+               "IA: reducer returned {}, keeping all predicates",
+               res.to_string());
+    if (!reset) {
+      reducer_->pop();
+    }
     out = new_preds;
     return false;
   }
@@ -135,6 +183,9 @@ bool ImplicitPredicateAbstractor::reduce_predicates(const TermVec & cex,
   UnorderedTermSet core;
   try {
     reducer_->get_unsat_assumptions(core);
+    if (core_min_time_) {
+      minimize_core(reducer_, assumps, core, core_min_time_);
+    }
     for (size_t i = 0; i < assumps.size(); ++i) {
       if (core.find(assumps[i]) != core.end()) {
         out.push_back(new_preds[i]);
@@ -196,6 +247,47 @@ UnorderedTermSet ImplicitPredicateAbstractor::do_abstraction()
 
   Sort boolsort_ = solver_->make_sort(BOOL);
 
+  // the updates of the non-boolean variables are left out unless their
+  // next state variable appears in another conjunct
+  UnorderedTermMap updates;
+  for (const auto & elem : conc_ts_.state_updates()) {
+    if (elem.first->get_sort() != boolsort_) {
+      updates[conc_ts_.next(elem.first)] = elem.second;
+    }
+  }
+  // next state variable and conjunct, in the order of the conjuncts
+  std::vector<std::pair<Term, Term>> update_conjuncts;
+  TermVec conjuncts;
+  UnorderedTermSet conjunct_vars;
+  for (const auto & c : conc_ts_.trans_conjuncts()) {
+    if (c->get_op() == Equal) {
+      // the solver may have swapped the sides
+      TermVec sides(c->begin(), c->end());
+      assert(sides.size() == 2);
+      bool found = false;
+      for (size_t i = 0; i < 2 && !found; ++i) {
+        auto u = updates.find(sides[i]);
+        if (u != updates.end() && u->second == sides[1 - i]) {
+          update_conjuncts.push_back({ sides[i], c });
+          found = true;
+        }
+      }
+      if (found) {
+        continue;
+      }
+    }
+    conjuncts.push_back(c);
+    get_free_symbolic_consts(c, conjunct_vars);
+  }
+  deferred_updates_.clear();
+  for (const auto & elem : update_conjuncts) {
+    if (conjunct_vars.find(elem.first) == conjunct_vars.end()) {
+      deferred_updates_[elem.first] = updates.at(elem.first);
+    } else {
+      conjuncts.push_back(elem.second);
+    }
+  }
+
   // create abstract variables for each next state variable
   for (auto sv : conc_ts_.statevars()) {
     if (sv->get_sort() == boolsort_)
@@ -211,23 +303,38 @@ UnorderedTermSet ImplicitPredicateAbstractor::do_abstraction()
     }
 
     Term nv = conc_ts_.next(sv);
-    // note: this is not a state variable -- using input variable so there's no
-    // next
-
-    // for incrementality
-    // only create new variables if not present in cache
-    if (abstraction_cache_.find(nv) == abstraction_cache_.end()) {
-      Term abs_nv = abs_rts_.make_inputvar(nv->to_string() + "^",
-                                           nv->get_sort());
-      // map next var to this abstracted next var
-      update_term_cache(nv, abs_nv);
+    // the others are created when a predicate needs them
+    if (conjunct_vars.find(nv) != conjunct_vars.end()) {
+      shadow(nv);
     }
   }
 
   // TODO: fix the population.
   // Right now state_updates, constraints, and named_terms are not updated
-  Term trans = conc_ts_.trans();
+  Term trans;
+  if (deferred_updates_.empty()) {
+    trans = conc_ts_.trans();
+  } else {
+    // balanced, see TransitionSystem::trans
+    while (conjuncts.size() > 1) {
+      TermVec level;
+      level.reserve((conjuncts.size() + 1) / 2);
+      for (size_t i = 0; i + 1 < conjuncts.size(); i += 2) {
+        level.push_back(
+            solver_->make_term(And, conjuncts[i], conjuncts[i + 1]));
+      }
+      if (conjuncts.size() % 2) {
+        level.push_back(conjuncts.back());
+      }
+      conjuncts.swap(level);
+    }
+    trans = conjuncts.empty() ? solver_->make_term(true) : conjuncts[0];
+  }
   abs_rts_.set_trans(abstract(trans));
+  logger.log(1,
+             "IA: {} abstract next state variables, {} updates deferred",
+             num_shadow_vars(),
+             deferred_updates_.size());
   logger.log(3, "Set abstract transition relation to {}", abs_rts_.trans());
 
   return conc_predicates;
@@ -19,6 +19,7 @@
 
 #include "abstractor.h"
 #include "core/unroller.h"
+#include "utils/budget.h"
 #include "smt-switch/term_translator.h"
 #include "smt-switch/utils.h"
 
@@ -36,26 +37,60 @@ class ImplicitPredicateAbstractor : public Abstractor
   smt::Term concrete(smt::Term & t) override;
 
   /** Returns the predicate refinement of the given predicate
+   *  Creates the abstract next state variables of the predicate that
+   *  don't exist yet (see do_abstraction).
    *  @param pred the predicate to refine
    *  (over concrete current state variables)
    *  @return the condition: pred(X') <-> pred(X^)
+   *          and v^ = f_v(X) for the variables v of pred whose update was
+   *          left out of the abstract transition relation
    *          this is for use in a procedure that wants to incrementally add
    *          predicates instead of re-adding the whole updated transition
    * relation
    */
   smt::Term predicate_refinement(const smt::Term & pred);
 
+  /** @return the number of abstract next state variables created so far */
+  size_t num_shadow_vars() const { return abstraction_cache_.size(); }
+
   void add_important_var(const smt::Term & v)
   {
     important_vars_.insert(v);
   }
 
+  const smt::UnorderedTermSet & important_vars() const
+  {
+    return important_vars_;
+  }
+
+  /** Minimize the cores of reduce_predicates with QuickXplain
+   *  @param ms the time budget per reduction in milliseconds
+   *         (0 keeps the first core of the solver)
+   */
+  void set_core_min_time(size_t ms) { core_min_time_ = ms; }
+
+  /** Give the reducer solver a time limit per query
+   *  On timeout, reduce_predicates keeps all the new predicates.
+   *  @param ms the time limit in milliseconds (see set_query_time_limit)
+   */
+  void set_reducer_query_time_limit(size_t ms)
+  {
+    set_query_time_limit(reducer_, ms);
+  }
+
   bool reduce_predicates(const smt::TermVec & cex,
                          const smt::TermVec & new_preds,
                          smt::TermVec & out);
 
   /** Does the abstraction and returns a set of concrete boolean symbols
    *  abstraction
+   *  The abstract next state variables X^ are only created for the
+   *  variables the transition relation needs. The update v' = f_v(X) of a
+   *  variable whose next state appears nowhere else says nothing about
+   *  the other variables once v' is replaced by v^, so it is left out
+   *  until a predicate over v needs v^ (see predicate_refinement). The
+   *  abstraction grows with the cone of the predicates instead of the
+   *  whole system.
    *  @return set of concrete boolean symbols
    */
   smt::UnorderedTermSet do_abstraction();
@@ -76,9 +111,18 @@ class ImplicitPredicateAbstractor : public Abstractor
 
   bool red_can_reset_;  ///< true iff reset_assertions workedo n reducer_
 
+  size_t core_min_time_;  ///< QuickXplain budget in ms, 0 to disable
+
   smt::UnorderedTermSet important_vars_; ///< important variables
                                          ///< prioritize predicates containing these
 
+  // the updates left out of the abstract transition relation, by
+  // concrete next state variable
+  smt::UnorderedTermMap deferred_updates_;
+
+  /** @return the abstract next state variable of nv, created if needed */
+  smt::Term shadow(const smt::Term & nv);
+
   bool reset_reducer()
   {
     if (!red_can_reset_) {
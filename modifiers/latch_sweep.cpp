@@ -0,0 +1,294 @@
+/*********************                                                        */
+/*! \file latch_sweep.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Merges state variables that are equal or constant in all
+**        reachable states.
+**
+**/
+
+#include "modifiers/latch_sweep.h"
+
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+
+#include "assert.h"
+#include "smt-switch/term_translator.h"
+#include "smt/available_solvers.h"
+#include "utils/bit_parallel_simulator.h"
+#include "utils/exceptions.h"
+#include "utils/logger.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+namespace {
+
+uint64_t mix(uint64_t h, uint64_t x)
+{
+  h ^= x + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+  return h;
+}
+
+}  // namespace
+
+LatchSweep::LatchSweep(TransitionSystem & ts,
+                       size_t lanes,
+                       size_t cycles,
+                       unsigned int seed)
+    : ts_(ts)
+{
+  logger.log(1, "Starting latch sweeping:");
+  logger.log(1, "  - state variables: {}", ts_.statevars().size());
+
+  if (!ts_.is_functional()) {
+    logger.log(1, "Latch sweeping skipped: system is not functional");
+    return;
+  }
+
+  if (!propose(lanes, cycles, seed)) {
+    return;
+  }
+  size_t num_candidates = candidates_.size();
+  prove();
+  merge();
+
+  logger.log(1,
+             "Latch sweeping completed: merged {} of {} candidates, {} "
+             "remaining state variables",
+             candidates_.size(),
+             num_candidates,
+             ts_.statevars().size());
+}
+
+Term LatchSweep::rewrite(const Term & t) const
+{
+  if (subst_.empty()) {
+    return t;
+  }
+  return ts_.solver()->substitute(t, subst_);
+}
+
+bool LatchSweep::propose(size_t lanes, size_t cycles, unsigned int seed)
+{
+  TermVec vars(ts_.statevars().begin(), ts_.statevars().end());
+  // deterministic representatives
+  sort(vars.begin(), vars.end(), [](const Term & a, const Term & b) {
+    return a->get_id() < b->get_id();
+  });
+
+  unique_ptr<BitParallelSimulator> sim;
+  vector<uint32_t> ids;
+  try {
+    sim.reset(new BitParallelSimulator(ts_, lanes, seed));
+    for (const auto & v : vars) {
+      ids.push_back(sim->add_output(v));
+    }
+  }
+  catch (PonoException & e) {
+    logger.log(1, "Latch sweeping skipped: {}", e.what());
+    return false;
+  }
+
+  size_t n = vars.size();
+  vector<uint32_t> widths(n);
+  for (size_t i = 0; i < n; ++i) {
+    Sort sort = vars[i]->get_sort();
+    widths[i] = sort->get_sort_kind() == BOOL ? 1 : sort->get_width();
+  }
+
+  // the signature hashes the values of all traces in every cycle
+  // and seen0 / seen1 are the bits that were 0 / 1 at least once
+  vector<uint64_t> signatures(n, 0);
+  vector<uint64_t> seen0(n, 0);
+  vector<uint64_t> seen1(n, 0);
+  size_t words = sim->num_lanes() / 64;
+  if (!sim->reset()) {
+    logger.log(1, "Latch sweeping skipped: no initial state found");
+    return false;
+  }
+  for (size_t c = 0; c < cycles; ++c) {
+    if (c && !sim->step()) {
+      break;
+    }
+    const vector<uint64_t> & alive = sim->alive();
+    for (size_t i = 0; i < n; ++i) {
+      for (uint32_t b = 0; b < widths[i]; ++b) {
+        const uint64_t * p = sim->bits(ids[i], b);
+        for (size_t k = 0; k < words; ++k) {
+          uint64_t x = p[k] & alive[k];
+          signatures[i] = mix(signatures[i], x);
+          if (x) {
+            seen1[i] |= uint64_t(1) << b;
+          }
+          if (~p[k] & alive[k]) {
+            seen0[i] |= uint64_t(1) << b;
+          }
+        }
+      }
+    }
+  }
+
+  const SmtSolver & solver = ts_.solver();
+  unordered_map<uint64_t, TermVec> classes;
+  for (size_t i = 0; i < n; ++i) {
+    const Term & v = vars[i];
+    Sort sort = v->get_sort();
+    Term rep;
+    if (!(seen0[i] & seen1[i])) {
+      // one value in all the traces
+      rep = sort->get_sort_kind() == BOOL
+                ? solver->make_term(seen1[i] != 0)
+                : solver->make_term(std::to_string(seen1[i]), sort);
+    } else {
+      TermVec & cls = classes[signatures[i]];
+      for (const auto & r : cls) {
+        if (r->get_sort() == sort) {
+          rep = r;
+          break;
+        }
+      }
+      if (!rep) {
+        cls.push_back(v);
+        continue;
+      }
+    }
+    candidates_.push_back({ v, rep, solver->make_term(Equal, v, rep) });
+  }
+
+  logger.log(1,
+             "Latch sweeping: {} candidates after simulating {} cycles",
+             candidates_.size(),
+             sim->num_cycles());
+  return true;
+}
+
+void LatchSweep::prove()
+{
+  if (candidates_.empty()) {
+    return;
+  }
+
+  // use a fresh solver
+  // to avoid issues with a corrupted solver state
+  SmtSolver solver = create_solver(ts_.solver()->get_solver_enum());
+  solver->set_opt("incremental", "true");
+  TermTranslator tt(solver);
+  Term solver_true = solver->make_term(true);
+
+  size_t n = candidates_.size();
+  TermVec curr, next;
+  curr.reserve(n);
+  next.reserve(n);
+  for (const auto & c : candidates_) {
+    curr.push_back(tt.transfer_term(c.eq, BOOL));
+    next.push_back(tt.transfer_term(ts_.next(c.eq), BOOL));
+  }
+  vector<bool> active(n, true);
+
+  // drop the active candidates that are false in a model of
+  // the assertions and one of goals being false, until there is no model
+  // assume_active additionally assumes the active candidates
+  auto refine = [&](const TermVec & goals, bool assume_active) {
+    while (true) {
+      Term some_false;
+      for (size_t i = 0; i < n; ++i) {
+        if (!active[i]) {
+          continue;
+        }
+        Term f = solver->make_term(Not, goals[i]);
+        some_false = some_false ? solver->make_term(Or, some_false, f) : f;
+      }
+      if (!some_false) {
+        return;
+      }
+
+      solver->push();
+      if (assume_active) {
+        for (size_t i = 0; i < n; ++i) {
+          if (active[i]) {
+            solver->assert_formula(curr[i]);
+          }
+        }
+      }
+      solver->assert_formula(some_false);
+      Result r = solver->check_sat();
+      if (r.is_sat()) {
+        for (size_t i = 0; i < n; ++i) {
+          if (active[i] && solver->get_value(goals[i]) != solver_true) {
+            active[i] = false;
+          }
+        }
+      } else if (r.is_unknown()) {
+        logger.log(1, "Latch sweeping: solver returned unknown");
+        fill(active.begin(), active.end(), false);
+      }
+      solver->pop();
+      if (!r.is_sat()) {
+        return;
+      }
+    }
+  };
+
+  // base case: init |= candidates
+  solver->push();
+  solver->assert_formula(tt.transfer_term(ts_.init(), BOOL));
+  refine(curr, false);
+  solver->pop();
+
+  // inductive step: candidates & trans |= candidates'
+  solver->push();
+  solver->assert_formula(tt.transfer_term(ts_.trans(), BOOL));
+  refine(next, true);
+  solver->pop();
+
+  vector<Candidate> proven;
+  for (size_t i = 0; i < n; ++i) {
+    if (active[i]) {
+      proven.push_back(candidates_[i]);
+      logger.log(2, "Latch sweeping: proved {}", candidates_[i].eq);
+    }
+  }
+  candidates_ = proven;
+}
+
+void LatchSweep::merge()
+{
+  if (candidates_.empty()) {
+    return;
+  }
+
+  TermVec merged;
+  merged.reserve(candidates_.size());
+  for (const auto & c : candidates_) {
+    assert(subst_.find(c.rep) == subst_.end());
+    subst_[c.var] = c.rep;
+    merged.push_back(c.var);
+  }
+
+  UnorderedTermSet statevars;
+  for (const auto & sv : ts_.statevars()) {
+    if (subst_.find(sv) == subst_.end()) {
+      statevars.insert(sv);
+    }
+  }
+
+  // rebuild the system once
+  TransitionSystem::Rewrite rw = ts_.begin_rewrite();
+  rw.drop_state_updates(merged);
+  rw.replace_terms(subst_);
+  rw.restrict_vars(statevars, ts_.inputvars());
+  ts_.commit_rewrite(rw);
+}
+
+}  // namespace pono
@@ -0,0 +1,83 @@
+/*********************                                                        */
+/*! \file latch_sweep.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Merges state variables that are equal or constant in all
+**        reachable states. Candidates are proposed by bit-parallel random
+**        simulation: state variables with the same values in every
+**        simulated cycle are candidate equivalences, and those with a
+**        single value are candidate constants. The candidates are proven
+**        together by induction, dropping the refuted ones until the rest
+**        is inductive, and the proven ones are substituted away.
+**
+**/
+
+#pragma once
+
+#include "core/ts.h"
+
+namespace pono {
+
+class LatchSweep
+{
+ public:
+  /** This class modifies the transition system on construction
+   *  Relational systems and systems the simulator does not support are
+   *  left unchanged. Merged state variables are removed from the system
+   *  like the ones outside the cone-of-influence, so terms over them
+   *  (e.g. the property) must be rewritten with rewrite().
+   *  @param ts the transition system to modify
+   *  @param lanes the number of simulated traces, a positive multiple of 64
+   *  @param cycles the length of the simulated traces
+   *  @param seed the seed for the random simulation
+   */
+  LatchSweep(TransitionSystem & ts,
+             size_t lanes = 256,
+             size_t cycles = 64,
+             unsigned int seed = 0);
+
+  /** @return t with the merged state variables replaced */
+  smt::Term rewrite(const smt::Term & t) const;
+
+  /** @return the replacement of each merged state variable, either
+   *          another state variable or a value
+   */
+  const smt::UnorderedTermMap & substitution() const { return subst_; }
+
+ protected:
+  /** Propose candidates from the simulation signatures of the state
+   *  variables
+   *  @param lanes the number of simulated traces
+   *  @param cycles the length of the simulated traces
+   *  @param seed the seed for the random simulation
+   *  @return false if the system cannot be simulated
+   */
+  bool propose(size_t lanes, size_t cycles, unsigned int seed);
+
+  /** Drop candidates until the remaining ones are inductive */
+  void prove();
+
+  /** Substitute the proven candidates and rebuild the system */
+  void merge();
+
+  TransitionSystem & ts_;
+
+  struct Candidate
+  {
+    smt::Term var;  ///< the state variable to replace
+    smt::Term rep;  ///< its replacement, a state variable or a value
+    smt::Term eq;   ///< var = rep
+  };
+  std::vector<Candidate> candidates_;
+
+  smt::UnorderedTermMap subst_;
+};
+
+}  // namespace pono
@@ -27,36 +27,39 @@ using namespace std;
 
 namespace pono {
 
-TransitionSystem pseudo_init_and_prop(TransitionSystem & ts, Term & prop)
+/** Make a state variable with a name that is not used yet in the solver
+ *  The same system can be modified once per property, and the copies
+ *  share the solver.
+ */
+static Term make_fresh_statevar(TransitionSystem & ts,
+                                const string & name,
+                                const Sort & sort)
 {
-  logger.log(1, "Modifying init and prop");
-
-  RelationalTransitionSystem rts =
-      ts.is_functional() ? RelationalTransitionSystem(ts.solver())
-                         : static_cast<RelationalTransitionSystem &>(ts);
-
-  // make it relational if it wasn't already
-  if (ts.is_functional()) {
-    for (const auto & sv : ts.statevars()) {
-      rts.add_statevar(sv, ts.next(sv));
+  size_t cnt = 0;
+  while (true) {
+    try {
+      return ts.make_statevar(cnt ? name + "_" + std::to_string(cnt) : name,
+                              sort);
     }
-    for (const auto & iv : ts.inputvars()) {
-      rts.add_inputvar(iv);
+    catch (std::exception & e) {
+      ++cnt;
     }
-    rts.set_init(ts.init());
-    rts.set_trans(ts.trans());
   }
+}
 
+TransitionSystem pseudo_init_and_prop(TransitionSystem & ts, Term & prop)
+{
+  logger.log(1, "Modifying init and prop");
+
+  // a view of ts that shares its variables and terms (copy-on-write)
+  // only the new variables and the guards below are added
+  RelationalTransitionSystem rts(ts);
   assert(!rts.is_functional());
 
   Sort boolsort = rts.make_sort(BOOL);
 
-  // Save original initial state constraints
-  TermVec init_conjuncts;
-  conjunctive_partition(rts.init(), init_conjuncts, true);
-
   // create a pseudo initial state
-  Term pseudo_init = rts.make_statevar("__pseudo_init", boolsort);
+  Term pseudo_init = make_fresh_statevar(rts, "__pseudo_init", boolsort);
   Term not_pseudo_init = rts.make_term(Not, pseudo_init);
 
   // guard property with it
@@ -66,25 +69,20 @@ TransitionSystem pseudo_init_and_prop(TransitionSystem & ts, Term & prop)
   // and enforce that the second state is constrained by the original
   // initial state constraints
   // NOTE: need to guard transition relation as well for correctness
-  TermVec trans_conjuncts;
-  conjunctive_partition(rts.trans(), trans_conjuncts, true);
-  // reset transition relation
-  rts.set_trans(rts.make_term(true));
-  // add fake transition from pseudo_init to actual initial states
-  for (const auto & ic : init_conjuncts) {
-    assert(rts.only_curr(ic));
-    rts.constrain_trans(rts.make_term(Implies, pseudo_init, rts.next(ic)));
-  }
-  // add regular transitions back in
-  for (const auto & tc : trans_conjuncts) {
-    rts.constrain_trans(rts.make_term(Implies, not_pseudo_init, tc));
-  }
+  // the original init and trans are guarded as a whole, so none of
+  // their subterms are rebuilt
+  Term init = rts.init();
+  assert(rts.only_curr(init));
+  rts.set_trans(rts.make_term(
+      And,
+      rts.make_term(Implies, pseudo_init, rts.next(init)),
+      rts.make_term(Implies, not_pseudo_init, rts.trans())));
 
   rts.set_init(pseudo_init);
   rts.assign_next(pseudo_init, rts.make_term(false));
 
   // now create a property monitor
-  Term new_prop = rts.make_statevar("__prop_monitor", boolsort);
+  Term new_prop = make_fresh_statevar(rts, "__prop_monitor", boolsort);
   if (rts.only_curr(prop)) {
     rts.add_invar(rts.make_term(Equal, new_prop, prop));
   } else {
@@ -103,6 +101,7 @@ TransitionSystem pseudo_init_and_prop(TransitionSystem & ts, Term & prop)
 
 void prop_in_trans(TransitionSystem & ts, const Term & prop)
 {
+  // only adds one conjunct, the rest of ts is shared with its copies
   // NOTE: CRUCIAL that we pass false here
   // cannot add to init or the next states
   // passing false prevents that
@@ -151,4 +150,89 @@ TransitionSystem promote_inputvars(const TransitionSystem & ts)
   return new_ts;
 }
 
+Term add_justice_monitor(TransitionSystem & ts, const TermVec & conditions)
+{
+  if (conditions.empty()) {
+    throw PonoException("Expecting at least one justice condition");
+  }
+  for (const auto & c : conditions) {
+    if (!ts.no_next(c)) {
+      throw PonoException("Cannot use next in a justice condition");
+    }
+  }
+  if (conditions.size() == 1 && ts.only_curr(conditions[0])) {
+    return conditions[0];
+  }
+
+  logger.log(
+      1, "Adding a monitor for {} justice conditions", conditions.size());
+  Sort boolsort = ts.make_sort(BOOL);
+  Term false_ = ts.make_term(false);
+
+  Term accept = conditions[0];
+  if (conditions.size() > 1) {
+    // seen_i: condition i held since the monitor last accepted
+    TermVec seen, seen_or_now;
+    accept = ts.make_term(true);
+    for (size_t i = 0; i < conditions.size(); ++i) {
+      seen.push_back(make_fresh_statevar(
+          ts, "__justice_seen_" + std::to_string(i), boolsort));
+      ts.constrain_init(ts.make_term(Equal, seen[i], false_));
+      seen_or_now.push_back(ts.make_term(Or, seen[i], conditions[i]));
+      accept = ts.make_term(And, accept, seen_or_now[i]);
+    }
+    for (size_t i = 0; i < conditions.size(); ++i) {
+      ts.assign_next(seen[i],
+                     ts.make_term(Ite, accept, false_, seen_or_now[i]));
+    }
+  }
+
+  Term monitor = make_fresh_statevar(ts, "__justice_monitor", boolsort);
+  ts.constrain_init(ts.make_term(Equal, monitor, false_));
+  ts.assign_next(monitor, accept);
+  return monitor;
+}
+
+TransitionSystem reverse_ts_and_prop(const TransitionSystem & ts, Term & prop)
+{
+  if (!ts.only_curr(prop)) {
+    throw PonoException(
+        "Reversing a system expects a property over the current state "
+        "variables");
+  }
+
+  const SmtSolver & solver = ts.solver();
+  UnorderedTermMap swap;
+  for (const auto & sv : ts.statevars()) {
+    Term nv = ts.next(sv);
+    swap[sv] = nv;
+    swap[nv] = sv;
+  }
+
+  // the invariant constraints are in init and in both states of trans
+  Term init = solver->make_term(Not, prop);
+  for (const auto & c : ts.constraints()) {
+    if (c.second && ts.only_curr(c.first)) {
+      init = solver->make_term(And, init, c.first);
+    }
+  }
+
+  RelationalTransitionSystem rts(ts);
+  rts.set_behavior(init, solver->substitute(ts.trans(), swap));
+  prop = solver->make_term(Not, ts.init());
+  return rts;
+}
+
+size_t assume_invariants(TransitionSystem & ts, const TermVec & invariants)
+{
+  size_t num_added = 0;
+  for (const auto & inv : invariants) {
+    if (ts.only_curr(inv)) {
+      ts.add_invar(inv);
+      ++num_added;
+    }
+  }
+  return num_added;
+}
+
 }  // namespace pono
@@ -26,6 +26,11 @@ namespace pono {
  *
  *  NOTE: doing this requires making the ts relational
  *
+ *  The returned system shares the variables and terms of ts, only the
+ *  new state variables and guards around init and trans are added, so
+ *  it is cheap to apply once per property to copies of one system. The
+ *  new variables get a numbered suffix if their name is already used.
+ *
  *  @param ts the transition system to modify
  *  @param prop the property to modify
  *  @return the updated transition system
@@ -50,4 +55,49 @@ void prop_in_trans(TransitionSystem & ts, const smt::Term & prop);
  */
 TransitionSystem promote_inputvars(const TransitionSystem & ts);
 
+/** Adds a monitor for a justice (Buechi) condition to ts
+ *  The monitor remembers which of the conditions held since it last
+ *  accepted, and accepts when all of them held. So the returned signal
+ *  holds infinitely often on a path iff each condition does.
+ *  The returned signal is over the current state variables: with a single
+ *  condition over the current state variables, it is that condition,
+ *  otherwise a new state variable holding the acceptance of the monitor
+ *  in the previous step.
+ *  @param ts the transition system to modify
+ *  @param conditions the conditions, e.g. the conditions of a BTOR2
+ *         justice property and the fairness constraints
+ *  @return the acceptance signal of the monitor
+ */
+smt::Term add_justice_monitor(TransitionSystem & ts,
+                              const smt::TermVec & conditions);
+
+/** Returns the reverse of ts for prop: its initial states are the bad
+ *  states of prop (that satisfy the invariant constraints), its
+ *  transitions are the ones of ts backwards, i.e. with the current and
+ *  next state variables swapped, and prop is updated to the negation of
+ *  the initial states of ts.
+ *  ts has a counterexample with k transitions iff the result does, with
+ *  the states in reverse order. The negation of an inductive invariant
+ *  of the result is an inductive invariant of ts.
+ *  The result shares the variables of ts and is relational.
+ *  @param ts the transition system
+ *  @param prop the property, over the current state variables of ts
+ *  @return the reversed transition system
+ *  Updates the prop in-place
+ */
+TransitionSystem reverse_ts_and_prop(const TransitionSystem & ts,
+                                     smt::Term & prop);
+
+/** Adds the invariants over the current state variables of ts as
+ *  invariant constraints, skipping the others (e.g. over the variables
+ *  outside of a cone-of-influence, which can't restrict it)
+ *  This is only sound if each one holds in every reachable state of ts,
+ *  e.g. properties proven without assuming the ones checked after them.
+ *  @param ts the transition system to modify
+ *  @param invariants the invariants, over the solver of ts
+ *  @return the number of invariants added
+ */
+size_t assume_invariants(TransitionSystem & ts,
+                         const smt::TermVec & invariants);
+
 }  // namespace pono
@@ -27,15 +27,37 @@ using namespace smt;
 
 namespace pono {
 
+// the terms of the state updates to abstract, only walked once for the
+// properties with the same state updates if there is a cache
+static void collect_op_terms(const TransitionSystem & ts,
+                             const std::unordered_set<PrimOp> & ops,
+                             RefinementCache * cache,
+                             UnorderedTermSet & out)
+{
+  if (cache && cache->solver() == ts.solver()) {
+    if (cache->op_terms(ts, ops, out)) {
+      logger.log(1, "Operator abstraction: reusing the operator terms found "
+                    "for another property");
+    }
+    return;
+  }
+
+  TermOpCollector op_collector(ts.solver());
+  for (const auto & s_update : ts.state_updates()) {
+    op_collector.add_matching_terms(s_update.second, ops, out);
+  } // walk state update functions
+}
+
 OpInpAbstractor::OpInpAbstractor(
     const TransitionSystem & conc_ts,
     TransitionSystem & abs_ts,
     const OpSet & op_to_abstract,
     const smt::Term & prop, // it is okay to use bad
-    int verbosity
+    int verbosity,
+    const std::shared_ptr<RefinementCache> & cache
     ) : OpAbstractor(conc_ts, abs_ts)
 { 
-  abstract_ts(conc_ts, abs_ts, op_to_abstract, prop, verbosity);
+  abstract_ts(conc_ts, abs_ts, op_to_abstract, prop, verbosity, cache.get());
   unroller_ = std::make_unique<Unroller>(abs_ts);
 } // OpAbstractor
 
@@ -43,18 +65,15 @@ OpInpAbstractor::OpInpAbstractor(
 TransitionSystem & OpInpAbstractor::abstract_ts(const TransitionSystem & in_ts,
   TransitionSystem & out_ts, const OpSet & op_to_abstract,
     const smt::Term & prop, // it is okay to use bad
-    int verbosity) {
+    int verbosity,
+    RefinementCache * cache) {
   
   // copy if not done outside
   if (out_ts.inputvars().empty() && out_ts.statevars().empty())
     out_ts = in_ts;
 
-  TermOpCollector op_collector(out_ts.solver());
-
   UnorderedTermSet term_op_out;
-  for (const auto & s_update : out_ts.state_updates()) {
-    op_collector.find_matching_terms(s_update.second, op_to_abstract, term_op_out);
-  } // walk state update functions
+  collect_op_terms(out_ts, op_to_abstract, cache, term_op_out);
 
   unsigned dummy_input_cnt = 0;
   UnorderedTermMap replacement;
@@ -219,29 +238,27 @@ bool OpInpAbstractor::refine_with_constraints(
 OpUfAbstractor::OpUfAbstractor(
     const TransitionSystem & conc_ts,
     TransitionSystem & abs_ts,
-    const OpSet & op_to_abstract
+    const OpSet & op_to_abstract,
+    const std::shared_ptr<RefinementCache> & cache
     ) : OpAbstractor(conc_ts, abs_ts),
     uf_extractor_(abs_ts.solver())
 { 
-  abstract_ts(conc_ts, abs_ts, op_to_abstract);
+  abstract_ts(conc_ts, abs_ts, op_to_abstract, cache.get());
   unroller_ = std::make_unique<Unroller>(abs_ts);
 } // OpAbstractor
 
 TransitionSystem & OpUfAbstractor::abstract_ts(
     const TransitionSystem & in_ts,
-    TransitionSystem & out_ts, const OpSet & op_to_abstract)
+    TransitionSystem & out_ts, const OpSet & op_to_abstract,
+    RefinementCache * cache)
 {
   // copy if not done outside
   if (out_ts.inputvars().empty() && out_ts.statevars().empty())
     out_ts = in_ts;
   const auto & solver_ = out_ts.solver();
 
-  TermOpCollector op_collector(out_ts.solver());
-
   UnorderedTermSet term_op_out;
-  for (const auto & s_update : out_ts.state_updates()) {
-    op_collector.find_matching_terms(s_update.second, op_to_abstract, term_op_out);
-  } // walk state update functions
+  collect_op_terms(out_ts, op_to_abstract, cache, term_op_out);
 
   unsigned dummy_uf_cnt = 0;
   UnorderedTermMap replacement;
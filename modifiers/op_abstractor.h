@@ -23,6 +23,7 @@
 #include "engines/ic3base.h"
 #include "core/unroller.h"
 #include "modifiers/abstractor.h"
+#include "utils/refinement_cache.h"
 
 namespace pono {
 
@@ -60,11 +61,14 @@ class OpInpAbstractor : public OpAbstractor
 public:
   typedef std::unordered_set<smt::PrimOp> OpSet;
 
+  // the operator terms are shared through the cache, if there is one
+  // with the solver of abs_ts
   OpInpAbstractor(const TransitionSystem & conc_ts,
     TransitionSystem & abs_ts,
     const OpSet & op_to_abstract,
     const smt::Term & prop, // it is okay to use bad
-    int verbosity);
+    int verbosity,
+    const std::shared_ptr<RefinementCache> & cache = nullptr);
   
   // return true if it can refine
   // otherwise return false
@@ -87,7 +91,8 @@ protected:
     const TransitionSystem & in_ts,
     TransitionSystem & out_ts, const OpSet & op_to_abstract,
     const smt::Term & prop, // it is okay to use bad
-    int verbosity);
+    int verbosity,
+    RefinementCache * cache);
 
   std::unique_ptr<Unroller> unroller_;
 
@@ -126,9 +131,12 @@ class OpUfAbstractor : public OpAbstractor
 public:
   typedef std::unordered_set<smt::PrimOp> OpSet;
 
+  // the operator terms are shared through the cache, if there is one
+  // with the solver of abs_ts
   OpUfAbstractor(const TransitionSystem & conc_ts,
     TransitionSystem & abs_ts,
-    const OpSet & op_to_abstract);
+    const OpSet & op_to_abstract,
+    const std::shared_ptr<RefinementCache> & cache = nullptr);
   
   // return true if it can refine
   // otherwise return false
@@ -146,7 +154,8 @@ protected:
   
   TransitionSystem & abstract_ts(
     const TransitionSystem & in_ts,
-    TransitionSystem & out_ts, const OpSet & op_to_abstract);
+    TransitionSystem & out_ts, const OpSet & op_to_abstract,
+    RefinementCache * cache);
     
   std::unique_ptr<Unroller> unroller_;
   std::vector<OpUfAbstract> op_abstracted;
@@ -16,6 +16,9 @@
 
 #include "modifiers/ops_abstractor.h"
 
+#include <algorithm>
+#include <limits>
+
 using namespace smt;
 using namespace std;
 
@@ -27,8 +30,50 @@ OpsAbstractor::OpsAbstractor(const TransitionSystem & conc_ts,
       solver_(abs_ts_.solver()),
       abs_walker_(*this, &abstraction_cache_),
       conc_walker_(*this, &concretization_cache_),
-      min_bw_(0)
+      min_bw_(0),
+      min_cost_(0)
+{
+}
+
+size_t OpsAbstractor::instance_cost(const Op & op,
+                                    const TermVec & children,
+                                    const Sort & sort)
 {
+  static const UnorderedOpSet nonlinear_ops({ BVMul,
+                                              BVUdiv,
+                                              BVSdiv,
+                                              BVUrem,
+                                              BVSrem,
+                                              BVSmod,
+                                              Mult,
+                                              Div,
+                                              Mod,
+                                              Pow,
+                                              IntDiv });
+
+  bool const_arg = false;
+  for (const auto & c : children) {
+    const_arg |= c->is_value();
+  }
+
+  bool is_bv = sort->get_sort_kind() == BV;
+  size_t width = is_bv ? sort->get_width() : 1;
+  if (is_bv && children.size()) {
+    // e.g. for Extract, the width of the argument matters
+    Sort arg_sort = children[0]->get_sort();
+    if (arg_sort->get_sort_kind() == BV) {
+      width = std::max(width, (size_t)arg_sort->get_width());
+    }
+  }
+
+  if (nonlinear_ops.find(op) == nonlinear_ops.end() || const_arg) {
+    // linear in the non-constant argument
+    return width;
+  }
+  if (is_bv) {
+    return width * width;
+  }
+  return std::numeric_limits<size_t>::max();
 }
 
 Term OpsAbstractor::abstract(Term & t)
@@ -129,7 +174,9 @@ WalkerStepResult OpsAbstractor::AbstractionWalker::visit_term(Term & term)
   // check if we do not need to abstract the operator
   if (op.is_null() ||
       oa_.ops_to_abstract_.find(op) == oa_.ops_to_abstract_.end() ||
-      (sk == BV && sort->get_width() <= oa_.min_bw_)) {
+      (sk == BV && sort->get_width() <= oa_.min_bw_) ||
+      (oa_.min_cost_
+       && instance_cost(op, cached_children, sort) < oa_.min_cost_)) {
     res = op.is_null() ? term : solver_->make_term(op, cached_children);
   } else {
     switch (op.prim_op) {
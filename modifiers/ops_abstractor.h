@@ -39,6 +39,25 @@ class OpsAbstractor : public Abstractor
 
   void set_min_bitwidth(size_t w) { min_bw_ = w; };
 
+  /** Only abstract the operator instances with an estimated cost
+   *  (see instance_cost) of at least c. 0 abstracts every instance.
+   */
+  void set_min_cost(size_t c) { min_cost_ = c; };
+
+  /** Estimates how expensive an operator instance is for the solver
+   *  Roughly the size of its bit-blasted circuit: quadratic in the
+   *  width for multipliers and dividers with two non-constant arguments,
+   *  linear in the width otherwise. Non-linear arithmetic over integers
+   *  or reals is the most expensive, linear arithmetic the cheapest.
+   *  @param op the operator
+   *  @param children the arguments
+   *  @param sort the sort of the result
+   *  @return the estimated cost
+   */
+  static size_t instance_cost(const smt::Op & op,
+                              const smt::TermVec & children,
+                              const smt::Sort & sort);
+
   void do_abstraction();
 
  protected:
@@ -74,6 +93,7 @@ class OpsAbstractor : public Abstractor
   smt::UnorderedOpSet ops_to_abstract_;
 
   size_t min_bw_;
+  size_t min_cost_;
 
   std::unordered_map<std::string, smt::Term> abs_op_symbols_;
   std::unordered_map<smt::Term, smt::Op> abs_symbols_to_op_;
@@ -30,13 +30,30 @@ pair<Term, Term> ProphecyModifier::get_proph(const Term & target, size_t delay)
   // first use history variables to delay target
   Term hist_var = hm_.get_hist(target, delay);
 
+  TermVec & proph_vars = proph_vars_[target];
+  if (proph_vars.size() <= delay) {
+    proph_vars.resize(delay + 1);
+  }
+  if (proph_vars[delay]) {
+    // already predicting this target with this delay
+    return { proph_vars[delay], hist_var };
+  }
+
   // now add a prophecy variable which targets that history variable
   string name = "proph_" + target->to_string() + "_" + std::to_string(delay);
   Term proph_var = ts_.make_statevar(name, target->get_sort());
   // make it frozen
   ts_.assign_next(proph_var, proph_var);
+  proph_vars[delay] = proph_var;
 
   return { proph_var, hist_var };
 }
 
+bool ProphecyModifier::has_proph(const Term & target, size_t delay) const
+{
+  auto it = proph_vars_.find(target);
+  return it != proph_vars_.end() && it->second.size() > delay
+         && it->second[delay];
+}
+
 }  // namespace pono
@@ -41,13 +41,19 @@ class ProphecyModifier
   std::pair<smt::Term, smt::Term> get_proph(const smt::Term & target,
                                             size_t delay);
 
+  /** @return true iff get_proph was already called with the same target
+   *          and delay (a second call returns the same variables)
+   */
+  bool has_proph(const smt::Term & target, size_t delay) const;
+
  protected:
   TransitionSystem & ts_;
   const smt::SmtSolver solver_;
   HistoryModifier hm_;
 
   // maps current state variables to a list of prophecy variables
-  // where the index corresponds to the delay of the target (-1)
+  // where the index corresponds to the delay of the target
+  // (null if there is no prophecy variable for that delay)
   std::unordered_map<smt::Term, smt::TermVec> proph_vars_;
 };
 
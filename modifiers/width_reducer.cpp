@@ -0,0 +1,318 @@
+/*********************                                                        */
+/*! \file width_reducer.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Datapath width reduction for data that is only moved around:
+**        bit-vectors that only go through muxes, equalities and the
+**        state updates are reduced to the width needed to tell their
+**        values apart.
+**
+**/
+
+#include "modifiers/width_reducer.h"
+
+#include <algorithm>
+
+#include "assert.h"
+#include "utils/exceptions.h"
+#include "utils/ts_manipulation.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+WidthReducer::WidthReducer(const TransitionSystem & ts, const Term & bad)
+    : ts_(ts), solver_(ts.solver()), bad_(bad)
+{
+  if (!ts.is_functional()) {
+    throw PonoException("Width reduction requires a functional system");
+  }
+
+  TermVec roots({ ts_.init(), bad_ });
+  for (const auto & c : ts_.constraints()) {
+    roots.push_back(c.first);
+  }
+  for (const auto & elem : ts_.state_updates()) {
+    roots.push_back(elem.second);
+  }
+  for (const auto & v : ts_.statevars()) {
+    roots.push_back(v);
+  }
+  for (const auto & v : ts_.inputvars()) {
+    roots.push_back(v);
+  }
+  analyze(roots);
+  compute_classes();
+}
+
+size_t WidthReducer::num_reduced() const
+{
+  size_t res = 0;
+  for (size_t i = 0; i < widths_.size(); ++i) {
+    res += widths_[i] < conc_widths_[i];
+  }
+  return res;
+}
+
+bool WidthReducer::refine()
+{
+  bool res = false;
+  for (size_t i = 0; i < widths_.size(); ++i) {
+    res |= widths_[i] < conc_widths_[i];
+    widths_[i] = conc_widths_[i];
+  }
+  return res;
+}
+
+TransitionSystem WidthReducer::abstract(Term & abs_bad)
+{
+  TransitionSystem abs_ts = create_fresh_ts(true, solver_);
+  cache_.clear();
+
+  for (const auto & v : ts_.statevars()) {
+    int c = reduced_class(v);
+    if (c < 0) {
+      abs_ts.add_statevar(v, ts_.next(v));
+      cache_[v] = v;
+    } else {
+      cache_[v] =
+          make_fresh_var(abs_ts,
+                         v->to_string() + "_w" + std::to_string(widths_[c]),
+                         solver_->make_sort(BV, widths_[c]),
+                         true);
+    }
+  }
+  for (const auto & v : ts_.inputvars()) {
+    int c = reduced_class(v);
+    if (c < 0) {
+      abs_ts.add_inputvar(v);
+      cache_[v] = v;
+    } else {
+      cache_[v] =
+          make_fresh_var(abs_ts,
+                         v->to_string() + "_w" + std::to_string(widths_[c]),
+                         solver_->make_sort(BV, widths_[c]),
+                         false);
+    }
+  }
+
+  for (const auto & elem : ts_.state_updates()) {
+    abs_ts.assign_next(cache_.at(elem.first), abstract_term(elem.second));
+  }
+  abs_ts.set_init(abstract_term(ts_.init()));
+  for (const auto & c : ts_.constraints()) {
+    abs_ts.add_constraint(abstract_term(c.first), c.second);
+  }
+  abs_bad = abstract_term(bad_);
+  return abs_ts;
+}
+
+Term WidthReducer::find(const Term & t)
+{
+  Term r = t;
+  while (true) {
+    const Term & p = parent_.at(r);
+    if (p == r) {
+      break;
+    }
+    r = p;
+  }
+  // path compression
+  Term cur = t;
+  while (cur != r) {
+    Term & p = parent_.at(cur);
+    cur = p;
+    p = r;
+  }
+  return r;
+}
+
+void WidthReducer::merge(const Term & a, const Term & b)
+{
+  Term ra = find(a);
+  Term rb = find(b);
+  if (ra != rb) {
+    parent_[ra] = rb;
+  }
+}
+
+void WidthReducer::analyze(const TermVec & roots)
+{
+  UnorderedTermSet visited;
+  TermVec to_visit = roots;
+  while (to_visit.size()) {
+    Term t = to_visit.back();
+    to_visit.pop_back();
+    if (!visited.insert(t).second) {
+      continue;
+    }
+    TermVec children(t->begin(), t->end());
+    to_visit.insert(to_visit.end(), children.begin(), children.end());
+    bool is_bv = t->get_sort()->get_sort_kind() == BV;
+    if (is_bv) {
+      parent_.emplace(t, t);
+    }
+    for (const auto & c : children) {
+      if (c->get_sort()->get_sort_kind() == BV) {
+        parent_.emplace(c, c);
+      }
+    }
+
+    Op op = t->get_op();
+    if (op.is_null()) {
+      // only the state and input variables of a functional system
+      if (is_bv && !t->is_value() && !ts_.is_curr_var(t)
+          && !ts_.is_input_var(t)) {
+        tainted_.insert(t);
+      }
+    } else if (op == Ite && is_bv) {
+      merge(t, children[1]);
+      merge(t, children[2]);
+    } else if ((op == Equal || op == Distinct)
+               && children[0]->get_sort()->get_sort_kind() == BV) {
+      for (size_t i = 1; i < children.size(); ++i) {
+        merge(children[0], children[i]);
+      }
+    } else {
+      // the bits of the values matter
+      if (is_bv) {
+        tainted_.insert(t);
+      }
+      for (const auto & c : children) {
+        if (c->get_sort()->get_sort_kind() == BV) {
+          tainted_.insert(c);
+        }
+      }
+    }
+  }
+
+  for (const auto & elem : ts_.state_updates()) {
+    if (elem.first->get_sort()->get_sort_kind() == BV) {
+      merge(elem.first, elem.second);
+    }
+  }
+}
+
+void WidthReducer::compute_classes()
+{
+  UnorderedTermSet tainted_roots;
+  for (const auto & t : tainted_) {
+    tainted_roots.insert(find(t));
+  }
+
+  // the number of values a step of each class involves at most
+  unordered_map<Term, size_t> root_classes;
+  vector<size_t> num_values;
+  vector<TermVec> consts;
+  for (const auto & elem : parent_) {
+    const Term & t = elem.first;
+    Term r = find(t);
+    if (tainted_roots.find(r) != tainted_roots.end()) {
+      continue;
+    }
+    auto it = root_classes.find(r);
+    if (it == root_classes.end()) {
+      it = root_classes.emplace(r, conc_widths_.size()).first;
+      conc_widths_.push_back(r->get_sort()->get_width());
+      num_values.push_back(0);
+      consts.push_back({});
+    }
+    size_t c = it->second;
+    classes_[t] = c;
+
+    if (ts_.is_curr_var(t)) {
+      // a state variable without update also takes a new value
+      bool has_update =
+          ts_.state_updates().find(t) != ts_.state_updates().end();
+      num_values[c] += has_update ? 1 : 2;
+    } else if (ts_.is_input_var(t)) {
+      ++num_values[c];
+    } else if (t->is_value()) {
+      ++num_values[c];
+      consts[c].push_back(t);
+    }
+  }
+
+  for (size_t c = 0; c < conc_widths_.size(); ++c) {
+    // the reduced values of the constants don't depend on the hashing
+    std::sort(consts[c].begin(),
+              consts[c].end(),
+              [](const Term & a, const Term & b) {
+                return a->to_string() < b->to_string();
+              });
+    for (size_t i = 0; i < consts[c].size(); ++i) {
+      const_ranks_[consts[c][i]] = i;
+    }
+
+    size_t w = 1;
+    while (w < conc_widths_[c] && w < 63 && (size_t(1) << w) < num_values[c]) {
+      ++w;
+    }
+    widths_.push_back(w);
+  }
+}
+
+int WidthReducer::reduced_class(const Term & t) const
+{
+  auto it = classes_.find(t);
+  if (it == classes_.end()
+      || widths_[it->second] >= conc_widths_[it->second]) {
+    return -1;
+  }
+  return it->second;
+}
+
+Term WidthReducer::abstract_term(const Term & t)
+{
+  TermVec to_visit({ t });
+  while (to_visit.size()) {
+    Term cur = to_visit.back();
+    if (cache_.find(cur) != cache_.end()) {
+      to_visit.pop_back();
+      continue;
+    }
+
+    TermVec children(cur->begin(), cur->end());
+    bool children_done = true;
+    for (const auto & c : children) {
+      if (cache_.find(c) == cache_.end()) {
+        to_visit.push_back(c);
+        children_done = false;
+      }
+    }
+    if (!children_done) {
+      continue;
+    }
+    to_visit.pop_back();
+
+    Op op = cur->get_op();
+    int c = reduced_class(cur);
+    if (op.is_null()) {
+      // a constant, the variables are in the cache already
+      cache_[cur] = c < 0 ? cur
+                          : solver_->make_term(
+                              static_cast<int64_t>(const_ranks_.at(cur)),
+                              solver_->make_sort(BV, widths_[c]));
+      continue;
+    }
+
+    TermVec abs_children;
+    abs_children.reserve(children.size());
+    for (const auto & ch : children) {
+      abs_children.push_back(cache_.at(ch));
+    }
+    cache_[cur] =
+        abs_children == children ? cur : solver_->make_term(op, abs_children);
+  }
+  return cache_.at(t);
+}
+
+}  // namespace pono
@@ -0,0 +1,103 @@
+/*********************                                                        */
+/*! \file width_reducer.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Datapath width reduction for data that is only moved around:
+**        bit-vectors that only go through muxes, equalities and the
+**        state updates are reduced to the width needed to tell their
+**        values apart.
+**
+**        Such a system is data-independent: it only observes whether
+**        values are equal. A step involves at most n values of a class
+**        (its state variables and inputs, the next values of its state
+**        variables without update and its constants), so any concrete
+**        run can be renamed step by step into a run over 2^w >= n values
+**        (the reachable states are closed under the renamings that fix
+**        the constants), and a run over 2^w values is a concrete run.
+**        The reduced system has the same counterexample lengths and the
+**        same proofs as the concrete one.
+**
+**/
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "core/ts.h"
+
+namespace pono {
+
+class WidthReducer
+{
+ public:
+  /** Finds the classes of data terms and their reduced widths
+   *  A class is the set of bit-vector terms connected by the state
+   *  updates, equalities and the branches of ites. It is reduced if no
+   *  term of the class is used or computed by another operator, and
+   *  its values fit in fewer bits than its sort.
+   *  @param ts the functional system to reduce
+   *  @param bad the bad state property of ts
+   */
+  WidthReducer(const TransitionSystem & ts, const smt::Term & bad);
+
+  /** @return the number of data classes that only go through muxes and
+   *          equalities
+   */
+  size_t num_classes() const { return widths_.size(); }
+
+  /** @return the number of classes below their concrete width */
+  size_t num_reduced() const;
+
+  /** Restores the concrete width of every class
+   *  @return false if no class was reduced
+   */
+  bool refine();
+
+  /** Builds the reduced system with the current widths
+   *  @param abs_bad set to the reduced bad state property
+   *  @return the reduced system, over the solver of ts
+   */
+  TransitionSystem abstract(smt::Term & abs_bad);
+
+ protected:
+  /** @return the representative of the class of t */
+  smt::Term find(const smt::Term & t);
+  void merge(const smt::Term & a, const smt::Term & b);
+
+  /** Merges and taints the classes for the structure of the system */
+  void analyze(const smt::TermVec & roots);
+
+  /** Computes the classes and their widths from the analysis */
+  void compute_classes();
+
+  /** @return the class of t, or -1 if it is not reduced */
+  int reduced_class(const smt::Term & t) const;
+
+  /** @return the reduced version of t */
+  smt::Term abstract_term(const smt::Term & t);
+
+  const TransitionSystem & ts_;
+  smt::SmtSolver solver_;
+  smt::Term bad_;
+
+  smt::UnorderedTermMap parent_;  ///< union-find over bit-vector terms
+  smt::UnorderedTermSet tainted_;  ///< terms used by other operators
+
+  std::unordered_map<smt::Term, size_t> classes_;  ///< data term -> class
+  std::vector<size_t> widths_;  ///< current width of each class
+  std::vector<size_t> conc_widths_;  ///< concrete width of each class
+  ///< the constants of the classes -> their reduced values
+  std::unordered_map<smt::Term, size_t> const_ranks_;
+
+  smt::UnorderedTermMap cache_;  ///< of the last abstraction
+};
+
+}  // namespace pono
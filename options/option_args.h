@@ -0,0 +1,58 @@
+/*********************                                                        */
+/*! \file option_args.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief The argument checks of the command line options, shared by pono
+**        and the benchmark tools.
+**
+**/
+
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "optionparser.h"
+
+namespace pono {
+
+struct Arg : public option::Arg
+{
+  static void printError(const char * msg1,
+                         const option::Option & opt,
+                         const char * msg2)
+  {
+    fprintf(stderr, "%s", msg1);
+    fwrite(opt.name, opt.namelen, 1, stderr);
+    fprintf(stderr, "%s", msg2);
+  }
+
+  static option::ArgStatus Numeric(const option::Option & option, bool msg)
+  {
+    char * endptr = 0;
+    if (option.arg != 0 && strtol(option.arg, &endptr, 10)) {
+    };
+    if (endptr != option.arg && *endptr == 0) return option::ARG_OK;
+
+    if (msg) printError("Option '", option, "' requires a numeric argument\n");
+    return option::ARG_ILLEGAL;
+  }
+
+  static option::ArgStatus NonEmpty(const option::Option & option, bool msg)
+  {
+    if (option.arg != 0 && option.arg[0] != 0) return option::ARG_OK;
+
+    if (msg)
+      printError("Option '", option, "' requires a non-empty argument\n");
+    return option::ARG_ILLEGAL;
+  }
+};
+
+}  // namespace pono
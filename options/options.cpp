@@ -19,9 +19,11 @@
 #include <string>
 #include <vector>
 #include "optionparser.h"
+#include "options/option_args.h"
 #include "utils/exceptions.h"
 
 using namespace std;
+using pono::Arg;
 
 /************************************* Option Handling setup
  * *****************************************/
@@ -72,39 +74,131 @@ enum optionIndex
   SYGUS_TERM_MODE,
   IC3SA_INITIAL_TERMS_LVL,
   IC3SA_INTERP,
-  PRINT_WALL_TIME
-};
-
-struct Arg : public option::Arg
-{
-  static void printError(const char * msg1,
-                         const option::Option & opt,
-                         const char * msg2)
-  {
-    fprintf(stderr, "%s", msg1);
-    fwrite(opt.name, opt.namelen, 1, stderr);
-    fprintf(stderr, "%s", msg2);
-  }
-
-  static option::ArgStatus Numeric(const option::Option & option, bool msg)
-  {
-    char * endptr = 0;
-    if (option.arg != 0 && strtol(option.arg, &endptr, 10)) {
-    };
-    if (endptr != option.arg && *endptr == 0) return option::ARG_OK;
-
-    if (msg) printError("Option '", option, "' requires a numeric argument\n");
-    return option::ARG_ILLEGAL;
-  }
-
-  static option::ArgStatus NonEmpty(const option::Option & option, bool msg)
-  {
-    if (option.arg != 0 && option.arg[0] != 0) return option::ARG_OK;
-
-    if (msg)
-      printError("Option '", option, "' requires a non-empty argument\n");
-    return option::ARG_ILLEGAL;
-  }
+  PRINT_WALL_TIME,
+  PORTFOLIO,
+  ALL_PROPS,
+  TIME_LIMIT,
+  SOLVER_CALL_LIMIT,
+  MEM_LIMIT,
+  QUERY_TIME_LIMIT,
+  STATS_JSON,
+  SHARE_LEMMAS,
+  BMC_ASSUMPTIONS,
+  BMC_STEP_SIZE,
+  BMC_THREADS,
+  IC3_REL_IND_ASSUMPTIONS,
+  IC3_ACT_LIT_RESET,
+  IC3_FRAME_SOLVERS,
+  IC3_PROP_THREADS,
+  IC3_BLOCK_THREADS,
+  IC3_CTG,
+  IC3_CTG_MAX_DEPTH,
+  IC3_CTG_MAX_CTGS,
+  IC3_TERNARY_SIM,
+  IC3_LEMMA_CACHE,
+  IC3_RESET_DEAD_RATIO,
+  KIND_FINGERPRINT,
+  KIND_DUAL_SOLVER,
+  KIND_INVARIANTS,
+  SIM_TRACES,
+  SIM_LANES,
+  LATCH_SWEEP,
+  MINE_INVARIANTS,
+  MINE_THREADS,
+  SIMPLIFY,
+  SAVE_SNAPSHOT,
+  BMC_UNROLL_WINDOW,
+  IC3SA_FUNC_UNROLL_LIMIT,
+  IC3_PARTITION_TRANS,
+  BTOR2_PROP_CONE,
+  WITNESS_SIGNALS,
+  WITNESS_INPUTS_ONLY,
+  WITNESS_STEPS,
+  MINIMIZE_CEX,
+  CEGP_INCREMENTAL_AXIOMS,
+  CEGAR_CORE_MIN_TIME,
+  CEGAR_SHARE_REFINEMENTS,
+  CEG_BV_ARITH_MIN_COST,
+  CEG_BV_ARITH_MAX_REFINE,
+  IC3IA_REFINE_PORTFOLIO,
+  MSAT_IC3IA_SHARE_ENV,
+  IC3_LIT_ORDER,
+  IC3IA_LAZY_PRED_RELS,
+  SYGUS_EVAL_CACHE_LIMIT,
+  SOLVER_PROFILES,
+  SOLVER_PROFILE,
+  SOLVER_TRACE,
+  QUERY_RESOURCE_LIMIT,
+  REDUCER_QUERY_TIME_LIMIT,
+  QUERY_RETRIES,
+  IC3BITS_SAT,
+  LOG_BUFFER,
+  LOG_ASYNC,
+  LOG_COMPONENTS,
+  LOG_RATE_LIMIT,
+  TRACE_FILE,
+  CHECK_INVAR_THREADS,
+  COMPACT_INVAR,
+  COMPACT_INVAR_TIME_LIMIT,
+  CHECKPOINT,
+  CHECKPOINT_INTERVAL,
+  RESUME,
+  RESET_PRESIM,
+  FOLD_CLOCK,
+  SERVE,
+  SERVE_WORKERS,
+  RESULT_CACHE,
+  ENGINE_MODEL,
+  PORTFOLIO_SIZE,
+  PORTFOLIO_CORES,
+  PORTFOLIO_SLICE,
+  SOFT_MEM_LIMIT,
+  STATS_ONLY,
+  CEG_LOCALIZATION,
+  CEG_LOCALIZATION_PBA,
+  BDD_NODE_LIMIT,
+  KLIVE_ENGINE,
+  DECOMPOSE_PROP,
+  DECOMPOSE_THREADS,
+  ASSUME_PROVEN,
+  ASSUME_PROVEN_INVARS,
+  BMC_FRAME_LEMMAS,
+  REVERSE_ENGINE,
+  IC3_INF_FRAME_PERIOD,
+  IC3_LEMMA_GC_PERIOD,
+  BMC_CONE_SLICE,
+  FLATTEN_ARRAYS,
+  FLATTEN_ARRAYS_WIDTH,
+  BMC_INIT_CONSTANTS,
+  CEG_WIDTH_REDUCTION,
+  EXPORT_BTOR2,
+  EXPORT_VMT,
+  JSON_EVENTS,
+  METRICS_FILE,
+  METRICS_INTERVAL,
+  DETERMINISTIC,
+  THREADS,
+  PIN,
+  NUMA,
+  PRE_CHECK,
+  PRE_CHECK_CYCLES,
+  IC3IA_PRED_CACHE,
+  INTERP_REUSE,
+  IC3_BAD_BATCH,
+  FRAIG,
+  CHECK_WITNESS,
+  BMC_SIM_GUIDE,
+  CUBE_SERVERS,
+  CUBE_VARS,
+  CUBE_DEPTH,
+  CUBE_SNAPSHOT,
+  BMC_CUBE,
+  LEMMA_EXCHANGE,
+  LEMMA_EXCHANGE_RATE,
+  MIGRATE_LEMMAS,
+  SIM_THREADS,
+  WITNESS_QUEUE,
+  CEGAR_REFINE_THREADS
 };
 
 const option::Descriptor usage[] = {
@@ -122,7 +216,13 @@ const option::Descriptor usage[] = {
     "engine",
     Arg::NonEmpty,
     "  --engine, -e <engine> \tSelect engine from [bmc, bmc-sp, ind, "
-    "interp, mbic3, ic3bits, ic3ia, msat-ic3ia, ic3sa, sygus-pdr]." },
+    "interp, mbic3, ic3bits, ic3ia, msat-ic3ia, ic3sa, sygus-pdr, "
+    "bmc-par, ismc, sim, bdd, klive, ic3-rev, auto]. With auto, the "
+    "engine, solver and some options are picked from static features of "
+    "the system after the cone-of-influence reduction (see "
+    "--engine-model). klive checks the justice properties of a BTOR2 file "
+    "(--prop is their index). ic3-rev runs IC3 backwards from the bad "
+    "states (see --reverse-engine)." },
   { BOUND,
     0,
     "k",
@@ -153,6 +253,14 @@ const option::Descriptor usage[] = {
     "vcd",
     Arg::NonEmpty,
     "  --vcd \tName of Value Change Dump (VCD) if witness exists." },
+  { WITNESS_QUEUE,
+    0,
+    "",
+    "witness-queue",
+    Arg::Numeric,
+    "  --witness-queue \tNumber of results and witnesses queued for a "
+    "background thread that prints them while the next property is "
+    "checked. 0 prints them synchronously. (default: 4)" },
   { SMT_SOLVER,
     0,
     "",
@@ -418,6 +526,990 @@ const option::Descriptor usage[] = {
     "print-wall-time",
     Arg::None,
     "  --print-wall-time \tPrint wall clock time of entire execution" },
+  { PORTFOLIO,
+    0,
+    "",
+    "portfolio",
+    Arg::None,
+    "  --portfolio \tRace bmc, ind, mbic3 (and ic3ia, interp if built with "
+    "MathSAT) in parallel threads and report the first definitive result. "
+    "Ignores --engine." },
+  { ALL_PROPS,
+    0,
+    "",
+    "all-props",
+    Arg::None,
+    "  --all-props \tCheck every property in the file, sharing the parsed "
+    "design. Reports a result for each property and ignores --prop." },
+  { TIME_LIMIT,
+    0,
+    "",
+    "time-limit",
+    Arg::Numeric,
+    "  --time-limit \tWall-clock limit in seconds for the engine. The engine "
+    "stops at the next polling point and returns unknown (default: 0, no "
+    "limit)." },
+  { SOLVER_CALL_LIMIT,
+    0,
+    "",
+    "solver-call-limit",
+    Arg::Numeric,
+    "  --solver-call-limit \tMaximum number of solver queries for the engine "
+    "before it returns unknown (default: 0, no limit)." },
+  { MEM_LIMIT,
+    0,
+    "",
+    "mem-limit",
+    Arg::Numeric,
+    "  --mem-limit \tPeak memory limit in megabytes. The engine returns "
+    "unknown once it is exceeded (default: 0, no limit)." },
+  { QUERY_TIME_LIMIT,
+    0,
+    "",
+    "query-time-limit",
+    Arg::Numeric,
+    "  --query-time-limit \tTime limit in milliseconds for a single solver "
+    "query, only supported by cvc4. A query that times out makes the engine "
+    "return unknown (default: 0, no limit)." },
+  { STATS_JSON,
+    0,
+    "",
+    "stats-json",
+    Arg::NonEmpty,
+    "  --stats-json \tWrite the statistics of each engine (solver calls and "
+    "time, unsat cores, solver resets, frames, refinements) to the given "
+    "file as JSON at exit or on SIGINT/SIGTERM/SIGALRM." },
+  { SHARE_LEMMAS,
+    0,
+    "",
+    "share-lemmas",
+    Arg::None,
+    "  --share-lemmas \tWith --portfolio, IC3 engines share the lemmas of "
+    "their frontier frame, which k-induction and the other IC3 engines "
+    "check and import. bmc and k-induction share the bound without a "
+    "counterexample so k-induction can skip base cases." },
+  { BMC_ASSUMPTIONS,
+    0,
+    "",
+    "bmc-assumptions",
+    Arg::None,
+    "  --bmc-assumptions \tBMC checks each bound with an activation literal "
+    "and check_sat_assuming instead of push/pop, so learned clauses survive "
+    "across bounds. The negation of bad is asserted once a bound is "
+    "proven." },
+  { BMC_STEP_SIZE,
+    0,
+    "",
+    "bmc-step-size",
+    Arg::Numeric,
+    "  --bmc-step-size \tNumber of bounds BMC checks with a single query. "
+    "On a counterexample it bisects the window to report the shortest one "
+    "(default: 1)." },
+  { BMC_THREADS,
+    0,
+    "",
+    "bmc-threads",
+    Arg::Numeric,
+    "  --bmc-threads \tNumber of threads (and solver instances) used by the "
+    "bmc-par engine, 0 means one per hardware thread (default: 0)." },
+  { IC3_REL_IND_ASSUMPTIONS,
+    0,
+    "",
+    "ic3-rel-ind-assumptions",
+    Arg::None,
+    "  --ic3-rel-ind-assumptions \tIC3 relative induction checks guard the "
+    "negated clause with an activation literal and pass the frame and trans "
+    "labels as assumptions instead of using push/pop." },
+  { IC3_ACT_LIT_RESET,
+    0,
+    "",
+    "ic3-act-lit-reset",
+    Arg::Numeric,
+    "  --ic3-act-lit-reset \tWith --ic3-rel-ind-assumptions, reset the solver "
+    "once this many activation literals were retired, 0 means only between "
+    "frames (default: 10000)." },
+  { IC3_FRAME_SOLVERS,
+    0,
+    "",
+    "ic3-frame-solvers",
+    Arg::None,
+    "  --ic3-frame-solvers \tGive each IC3 frame its own solver holding only "
+    "trans and the lemmas of that frame. Used for the relative induction "
+    "checks that do not need a predecessor." },
+  { IC3_PROP_THREADS,
+    0,
+    "",
+    "ic3-prop-threads",
+    Arg::Numeric,
+    "  --ic3-prop-threads \tNumber of threads checking the lemmas of a "
+    "frame in IC3 propagation, each with its own solver, 0 means one per "
+    "core (default: 1)." },
+  { IC3_BLOCK_THREADS,
+    0,
+    "",
+    "ic3-block-threads",
+    Arg::Numeric,
+    "  --ic3-block-threads \tNumber of proof goals at different frames that "
+    "IC3 checks concurrently, each in the solver of its frame, 0 means one "
+    "per core (default: 1)." },
+  { IC3_CTG,
+    0,
+    "",
+    "ic3-ctg",
+    Arg::None,
+    "  --ic3-ctg \tIn IC3 inductive generalization, try to block the "
+    "counterexamples to generalization (CTGs) at a lower frame instead of "
+    "keeping the literal." },
+  { IC3_CTG_MAX_DEPTH,
+    0,
+    "",
+    "ic3-ctg-max-depth",
+    Arg::Numeric,
+    "  --ic3-ctg-max-depth \tNesting depth of generalizations of CTGs with "
+    "--ic3-ctg (default: 1)." },
+  { IC3_CTG_MAX_CTGS,
+    0,
+    "",
+    "ic3-ctg-max-ctgs",
+    Arg::Numeric,
+    "  --ic3-ctg-max-ctgs \tNumber of CTGs blocked in a row before "
+    "dropping a literal is given up with --ic3-ctg (default: 3)." },
+  { IC3_TERNARY_SIM,
+    0,
+    "",
+    "ic3-ternary-sim",
+    Arg::None,
+    "  --ic3-ternary-sim \tGeneralize predecessors in ic3bool and ic3bits "
+    "with ternary simulation of the state updates instead of a solver "
+    "(only for deterministic functional systems)." },
+  { IC3_LEMMA_CACHE,
+    0,
+    "",
+    "ic3-lemma-cache",
+    Arg::NonEmpty,
+    "  --ic3-lemma-cache <file> \tLoad lemmas saved by a previous run on the "
+    "same state variables and property, seed frame 1 with the ones that "
+    "are still inductive, and save the final lemmas." },
+  { IC3_RESET_DEAD_RATIO,
+    0,
+    "",
+    "ic3-reset-dead-ratio",
+    Arg::Numeric,
+    "  --ic3-reset-dead-ratio \tOnly reset the main IC3 solver after a frame "
+    "once at least this percentage of its lemma assertions are dead "
+    "(subsumed lemmas and retired activation literals). (default: 0, reset "
+    "after every frame)" },
+  { KIND_FINGERPRINT,
+    0,
+    "",
+    "kind-fingerprint",
+    Arg::None,
+    "  --kind-fingerprint \tIn k-induction, find states repeated in a "
+    "model by hashing the state variable values of each step instead of "
+    "evaluating a disequality for every pair of steps." },
+  { KIND_DUAL_SOLVER,
+    0,
+    "",
+    "kind-dual-solver",
+    Arg::None,
+    "  --kind-dual-solver \tRun the k-induction base cases and inductive "
+    "steps concurrently, each in its own solver." },
+  { KIND_INVARIANTS,
+    0,
+    "",
+    "kind-invariants",
+    Arg::NonEmpty,
+    "  --kind-invariants <file> \tStrengthen k-induction with the candidate "
+    "invariants in a lemma cache file (see --ic3-lemma-cache) that hold "
+    "initially and are inductive relative to the property." },
+  { SIM_TRACES,
+    0,
+    "",
+    "sim-traces",
+    Arg::Numeric,
+    "  --sim-traces \tNumber of random traces simulated by the sim engine, each "
+    "as long as the bound. (default: 1000, 0 for no limit)" },
+  { SIM_LANES,
+    0,
+    "",
+    "sim-lanes",
+    Arg::Numeric,
+    "  --sim-lanes \tNumber of traces the sim engine simulates at once. "
+    "Values above 1 must be multiples of 64 and enable bit-parallel "
+    "simulation. (default: 1)" },
+  { SIM_THREADS,
+    0,
+    "",
+    "sim-threads",
+    Arg::Numeric,
+    "  --sim-threads \tNumber of threads of the sim engine, each simulating "
+    "--sim-lanes traces at once with its own seed. The first trace reaching "
+    "a bad state is the witness. (default: 1)" },
+  { LATCH_SWEEP,
+    0,
+    "",
+    "latch-sweep",
+    Arg::None,
+    "  --latch-sweep \tMerge state variables proven equal or constant "
+    "after random simulation, before solving." },
+  { MINE_INVARIANTS,
+    0,
+    "",
+    "mine-invariants",
+    Arg::None,
+    "  --mine-invariants \tAdd the candidate invariants mined from random "
+    "simulation that survive Houdini pruning as constraints." },
+  { MINE_THREADS,
+    0,
+    "",
+    "mine-threads",
+    Arg::Numeric,
+    "  --mine-threads \tNumber of threads checking the candidates of "
+    "--mine-invariants in each Houdini round. (default: 1)" },
+  { SIMPLIFY,
+    0,
+    "",
+    "simplify",
+    Arg::None,
+    "  --simplify \tApply word-level constant propagation and structural "
+    "simplification to the system before solving. The gates of a BTOR2 "
+    "file are also folded while it is parsed." },
+  { SAVE_SNAPSHOT,
+    0,
+    "",
+    "save-snapshot",
+    Arg::NonEmpty,
+    "  --save-snapshot <file> \tSave the transition system and property after "
+    "the preprocessing passes (e.g. --static-coi) in a binary snapshot, "
+    "which can be checked again by passing it as the input file (.snap)." },
+  { BMC_UNROLL_WINDOW,
+    0,
+    "",
+    "bmc-unroll-window",
+    Arg::Numeric,
+    "  --bmc-unroll-window \tOnly keep the unrolling caches of the last n "
+    "bounds to bound the memory of deep BMC runs. Older bounds are rebuilt "
+    "if needed, e.g. for the witness (default: 0, keep all)." },
+  { IC3SA_FUNC_UNROLL_LIMIT,
+    0,
+    "",
+    "ic3sa-func-unroll-limit",
+    Arg::Numeric,
+    "  --ic3sa-func-unroll-limit \tIntroduce a fresh symbol in the functional "
+    "unrolling of IC3SA refinement for the state variables whose inlined "
+    "update has more nodes than this (default: 0, no limit)." },
+  { IC3_PARTITION_TRANS,
+    0,
+    "",
+    "ic3-partition-trans",
+    Arg::None,
+    "  --ic3-partition-trans \tPartition trans by next-state variables and only "
+    "use the partitions in the cone of the cube in the relative induction "
+    "checks that do not need a predecessor." },
+  { BTOR2_PROP_CONE,
+    0,
+    "",
+    "btor2-prop-cone",
+    Arg::None,
+    "  --btor2-prop-cone \tOnly encode the lines of a BTOR2 file in the cone "
+    "of the selected property (--prop) and of the constraints." },
+  { WITNESS_SIGNALS,
+    0,
+    "",
+    "witness-signals",
+    Arg::NonEmpty,
+    "  --witness-signals \tOnly include the variables and named terms whose "
+    "name matches one of these comma-separated globs in the witness." },
+  { WITNESS_INPUTS_ONLY,
+    0,
+    "",
+    "witness-inputs-only",
+    Arg::None,
+    "  --witness-inputs-only \tOnly include the inputs, and the state "
+    "variables of the first step, in the witness (enough to replay it)." },
+  { WITNESS_STEPS,
+    0,
+    "",
+    "witness-steps",
+    Arg::NonEmpty,
+    "  --witness-steps \tOnly include the steps in the range <first>:<last> "
+    "of the witness (either may be omitted). The other steps are empty." },
+  { MINIMIZE_CEX,
+    0,
+    "",
+    "minimize-cex",
+    Arg::None,
+    "  --minimize-cex \tCut the witness at the first violation and drop the "
+    "input values it does not depend on (by ternary simulation)." },
+  { CEGP_INCREMENTAL_AXIOMS,
+    0,
+    "",
+    "cegp-incremental-axioms",
+    Arg::None,
+    "  --cegp-incremental-axioms \tKeep the instantiated axiom candidates "
+    "between refinements in CEGP and only instantiate new indices" },
+  { CEGAR_CORE_MIN_TIME,
+    0,
+    "",
+    "cegar-core-min-time",
+    Arg::Numeric,
+    "  --cegar-core-min-time \tMinimize the unsat cores of the CEGAR axiom "
+    "and predicate reductions with QuickXplain, with this time budget in "
+    "milliseconds per reduction (default: 0, use the first core)" },
+  { CEGAR_REFINE_THREADS,
+    0,
+    "",
+    "cegar-refine-threads",
+    Arg::Numeric,
+    "  --cegar-refine-threads \tNumber of solvers checking the abstract "
+    "counterexamples of --ceg-bv-arith and --cegp-abs-vals against "
+    "each abstracted operator (or group of values) on its own, to refine "
+    "with all of those that rule it out at once. 0 means one per core "
+    "(default: 1, one check with all of them)." },
+  { CEGAR_SHARE_REFINEMENTS,
+    0,
+    "",
+    "cegar-share-refinements",
+    Arg::None,
+    "  --cegar-share-refinements \tWith --all-props, seed the abstraction of "
+    "each property with the refinements learned for the previous ones "
+    "(currently the array axioms of --ceg-prophecy-arrays). The operator "
+    "abstraction of sygus-pdr is found once for the properties with the "
+    "same state updates." },
+  { CEG_BV_ARITH_MIN_COST,
+    0,
+    "",
+    "ceg-bv-arith-min-cost",
+    Arg::Numeric,
+    "  --ceg-bv-arith-min-cost \tOnly abstract the operator instances with "
+    "at least this estimated cost: the width for linear operators, the "
+    "squared width for multipliers and dividers (default: 0, all)" },
+  { CEG_BV_ARITH_MAX_REFINE,
+    0,
+    "",
+    "ceg-bv-arith-max-refine",
+    Arg::Numeric,
+    "  --ceg-bv-arith-max-refine \tOnce this many instances of an abstracted "
+    "operator were refined, refine all its instances (default: 0, never)" },
+  { IC3IA_REFINE_PORTFOLIO,
+    0,
+    "",
+    "ic3ia-refine-portfolio",
+    Arg::None,
+    "  --ic3ia-refine-portfolio \tIn IC3IA, look for predicates from unsat "
+    "cores while computing interpolants in another thread, and use the "
+    "smaller predicate set" },
+  { MSAT_IC3IA_SHARE_ENV,
+    0,
+    "",
+    "msat-ic3ia-share-env",
+    Arg::None,
+    "  --msat-ic3ia-share-env \tRun the ic3ia backend directly in the "
+    "MathSAT environment of the system instead of translating it" },
+  { IC3_LIT_ORDER,
+    0,
+    "",
+    "ic3-lit-order",
+    Arg::None,
+    "  --ic3-lit-order \tIn IC3 generalization, first try to drop the "
+    "literals over unimportant variables, then the ones that were the "
+    "least often in unsat cores, then the newest" },
+  { IC3IA_LAZY_PRED_RELS,
+    0,
+    "",
+    "ic3ia-lazy-pred-rels",
+    Arg::None,
+    "  --ic3ia-lazy-pred-rels \tIn IC3IA, only add the next-state relation "
+    "of a predicate once a lemma mentions it (or a refinement needs it)" },
+  { SYGUS_EVAL_CACHE_LIMIT,
+    0,
+    "",
+    "sygus-eval-cache-limit",
+    Arg::Numeric,
+    "  --sygus-eval-cache-limit \tIn SyGuS-PDR, the number of subterm values cached "
+    "per counterexample before the cache is flushed (default: 1048576)" },
+  { SOLVER_PROFILES,
+    0,
+    "",
+    "solver-profiles",
+    Arg::NonEmpty,
+    "  --solver-profiles \tRead solver option profiles from the given file: "
+    "lines <solver> <engine> <option> <value> (* matches any solver or engine, "
+    "engine reducer for the reducing solvers), grouped in [name] sections" },
+  { SOLVER_PROFILE,
+    0,
+    "",
+    "solver-profile",
+    Arg::NonEmpty,
+    "  --solver-profile \tThe section of the solver profiles file to use "
+    "(default: the lines before the first section)" },
+  { SOLVER_TRACE,
+    0,
+    "",
+    "solver-trace",
+    Arg::NonEmpty,
+    "  --solver-trace \tTime every solver call by kind and engine phase and "
+    "write the histograms to the given file as JSON at exit or on "
+    "SIGINT/SIGTERM/SIGALRM." },
+  { QUERY_RESOURCE_LIMIT,
+    0,
+    "",
+    "query-resource-limit",
+    Arg::Numeric,
+    "  --query-resource-limit \tResource limit (roughly, solver steps such as "
+    "conflicts) for a single solver query, only supported by cvc4. Unlike "
+    "--query-time-limit it is deterministic (default: 0, no limit)." },
+  { REDUCER_QUERY_TIME_LIMIT,
+    0,
+    "",
+    "reducer-query-time-limit",
+    Arg::Numeric,
+    "  --reducer-query-time-limit \tTime limit in milliseconds for a single "
+    "query of the unsat core / interpolant reducer solvers, only supported "
+    "by cvc4. On timeout, the reducer keeps the unreduced set "
+    "(default: 0, no limit)." },
+  { QUERY_RETRIES,
+    0,
+    "",
+    "query-retries",
+    Arg::Numeric,
+    "  --query-retries \tNumber of times bmc retries a query that returned "
+    "unknown with a doubled --query-time-limit / --query-resource-limit "
+    "before giving up (default: 0)." },
+  { IC3BITS_SAT,
+    0,
+    "",
+    "ic3bits-sat",
+    Arg::None,
+    "  --ic3bits-sat \tRun ic3bits on a CNF encoding of the system with "
+    "integer literal cubes when the system is purely Boolean (booleans and "
+    "bit-vectors of width 1), falling back to the term-level ic3bits "
+    "otherwise." },
+  { LOG_BUFFER,
+    0,
+    "",
+    "log-buffer",
+    Arg::Numeric,
+    "  --log-buffer \tBuffer log messages and write them once this many bytes "
+    "are pending, instead of flushing the output after every message "
+    "(default: 0, unbuffered)." },
+  { LOG_ASYNC,
+    0,
+    "",
+    "log-async",
+    Arg::None,
+    "  --log-async \tWrite the buffered log messages from a background "
+    "thread (requires --log-buffer)." },
+  { LOG_COMPONENTS,
+    0,
+    "",
+    "log-components",
+    Arg::NonEmpty,
+    "  --log-components \tVerbosity per component overriding -v, as comma "
+    "separated name=level pairs, e.g. ic3=3,ic3ia=1." },
+  { LOG_RATE_LIMIT,
+    0,
+    "",
+    "log-rate-limit",
+    Arg::Numeric,
+    "  --log-rate-limit \tPrint at most this many log messages per second "
+    "and drop the others (default: 0, no limit)." },
+  { TRACE_FILE,
+    0,
+    "",
+    "trace-file",
+    Arg::NonEmpty,
+    "  --trace-file \tRecord the engine phases (parsing, IC3 steps, "
+    "refinement, ...) per thread and write them to the given file in the "
+    "Chrome trace format (chrome://tracing, ui.perfetto.dev) at exit or on "
+    "SIGINT/SIGTERM/SIGALRM." },
+  { CHECK_INVAR_THREADS,
+    0,
+    "",
+    "check-invar-threads",
+    Arg::Numeric,
+    "  --check-invar-threads \tWith --check-invar, check the inductiveness "
+    "of each conjunct of the invariant separately in this many parallel "
+    "solvers, concurrently with the other obligations, and report the "
+    "conjuncts that fail. (default: 0, one monolithic check)" },
+  { COMPACT_INVAR,
+    0,
+    "",
+    "compact-invar",
+    Arg::None,
+    "  --compact-invar \tDrop the lemmas of the invariant that are not "
+    "needed to keep it inductive before showing or checking it." },
+  { COMPACT_INVAR_TIME_LIMIT,
+    0,
+    "",
+    "compact-invar-time-limit",
+    Arg::Numeric,
+    "  --compact-invar-time-limit \tTime budget in ms of --compact-invar, "
+    "the invariant is kept as is if it runs out (default: 10000, 0 for no "
+    "limit)" },
+  { CHECKPOINT,
+    0,
+    "",
+    "checkpoint",
+    Arg::NonEmpty,
+    "  --checkpoint \tPeriodically save the state of the engine (the bound "
+    "reached by bmc, bmc-sp and ind, and the frames of the IC3 engines "
+    "without abstraction) to the given file." },
+  { CHECKPOINT_INTERVAL,
+    0,
+    "",
+    "checkpoint-interval",
+    Arg::Numeric,
+    "  --checkpoint-interval \tMinimum number of seconds between two saves "
+    "of --checkpoint (default: 600)" },
+  { RESUME,
+    0,
+    "",
+    "resume",
+    Arg::None,
+    "  --resume \tRestart from the --checkpoint file if it was saved by the "
+    "same engine for exactly the same system and property." },
+  { RESET_PRESIM,
+    0,
+    "",
+    "reset-presim",
+    Arg::None,
+    "  --reset-presim \tSimulate the --reset sequence before model checking "
+    "and start from the state it ends in, if it is the same for all inputs. "
+    "Otherwise the reset sequence is checked symbolically. Counterexamples "
+    "then start after reset." },
+  { FOLD_CLOCK,
+    0,
+    "",
+    "fold-clock",
+    Arg::None,
+    "  --fold-clock \tIf the state only changes in one phase of the --clock "
+    "input, use one transition per clock cycle instead of toggling the "
+    "clock every step. Otherwise the clock is toggled." },
+  { SERVE,
+    0,
+    "",
+    "serve",
+    Arg::NonEmpty,
+    "  --serve \tRun as a server on the given Unix domain socket instead of "
+    "checking a file. Designs are parsed once and kept in memory, and the "
+    "properties are checked by a pool of workers (see "
+    "utils/verification_server.h for the protocol). The other options are "
+    "the defaults of the jobs." },
+  { SERVE_WORKERS,
+    0,
+    "",
+    "serve-workers",
+    Arg::Numeric,
+    "  --serve-workers \tNumber of jobs run in parallel by --serve "
+    "(default: 0, the number of hardware threads)" },
+  { RESULT_CACHE,
+    0,
+    "",
+    "result-cache",
+    Arg::NonEmpty,
+    "  --result-cache \tDirectory of proven results, invariants and "
+    "witnesses, keyed by a hash of the structure of the system after the "
+    "cone-of-influence reduction (names ignored), the engine and the bound. "
+    "Unchanged properties are answered from it, after checking the cached "
+    "invariant or replaying the cached witness. It can be shared by "
+    "concurrent runs." },
+  { ENGINE_MODEL,
+    0,
+    "",
+    "engine-model",
+    Arg::NonEmpty,
+    "  --engine-model \tFile with the decision rules of --engine auto and "
+    "--portfolio-size, replacing the built-in ones (see "
+    "utils/engine_selector.h for the format)." },
+  { PORTFOLIO_SIZE,
+    0,
+    "",
+    "portfolio-size",
+    Arg::Numeric,
+    "  --portfolio-size \tNumber of engines run by --portfolio, the most "
+    "promising ones for the system according to the --engine auto rules "
+    "(default: 0, all of them)" },
+  { PORTFOLIO_CORES,
+    0,
+    "",
+    "portfolio-cores",
+    Arg::Numeric,
+    "  --portfolio-cores \tNumber of engines --portfolio runs at the same "
+    "time. With fewer cores than engines, the engines take turns in time "
+    "slices and the cores go to the engines making the most progress "
+    "(default: 0, one thread per engine)" },
+  { PORTFOLIO_SLICE,
+    0,
+    "",
+    "portfolio-slice",
+    Arg::Numeric,
+    "  --portfolio-slice \tLength of a time slice of --portfolio-cores in "
+    "milliseconds (default: 1000)" },
+  { SOFT_MEM_LIMIT,
+    0,
+    "",
+    "soft-mem-limit",
+    Arg::Numeric,
+    "  --soft-mem-limit \tSoft resident memory limit in megabytes. Once it "
+    "is exceeded the engine drops its caches (e.g. of the unroller) and "
+    "continues (default: 0, no limit)" },
+  { STATS_ONLY,
+    0,
+    "",
+    "stats-only",
+    Arg::None,
+    "  --stats-only \tParse the design and print its size as JSON (variables "
+    "by sort, DAG nodes of init and trans, arrays, operators) without "
+    "checking it. With --static-coi, also the cone of influence of each "
+    "property." },
+  { CEG_LOCALIZATION,
+    0,
+    "",
+    "ceg-localization",
+    Arg::None,
+    "  --ceg-localization \tLocalization abstraction-refinement: cut the "
+    "latches outside of the abstraction into free variables, check the "
+    "abstraction with the engine and add the latches of the unsat core of "
+    "a BMC check of each spurious counterexample (functional systems "
+    "only)" },
+  { CEG_LOCALIZATION_PBA,
+    0,
+    "",
+    "ceg-localization-pba",
+    Arg::Numeric,
+    "  --ceg-localization-pba \tWith --ceg-localization, start from the "
+    "latches in the unsat cores of BMC up to this bound (proof-based "
+    "abstraction) instead of the latches of the property (default: 0, "
+    "disabled)" },
+  { BDD_NODE_LIMIT,
+    0,
+    "",
+    "bdd-node-limit",
+    Arg::Numeric,
+    "  --bdd-node-limit \tNumber of live BDD nodes above which the bdd "
+    "engine gives up and returns unknown (default: 2000000)" },
+  { KLIVE_ENGINE,
+    0,
+    "",
+    "klive-engine",
+    Arg::NonEmpty,
+    "  --klive-engine <engine> \tIC3 variant for the safety checks of the "
+    "klive engine, which keeps its frames across the bounds (default: "
+    "mbic3)" },
+  { DECOMPOSE_PROP,
+    0,
+    "",
+    "decompose-prop",
+    Arg::None,
+    "  --decompose-prop \tSplit the property into its conjuncts and check "
+    "each one with the engine on its own cone of influence, in parallel. "
+    "The proven conjuncts are assumed when checking the others again." },
+  { DECOMPOSE_THREADS,
+    0,
+    "",
+    "decompose-threads",
+    Arg::Numeric,
+    "  --decompose-threads \tConjuncts checked at once by --decompose-prop "
+    "(default: 0, one per core)" },
+  { ASSUME_PROVEN,
+    0,
+    "",
+    "assume-proven",
+    Arg::None,
+    "  --assume-proven \tWith --all-props, assume the properties proven so "
+    "far as invariants when checking the next ones" },
+  { ASSUME_PROVEN_INVARS,
+    0,
+    "",
+    "assume-proven-invars",
+    Arg::None,
+    "  --assume-proven-invars \tWith --assume-proven, also assume the "
+    "inductive invariants of the proven properties, if the engine "
+    "provides them" },
+  { BMC_FRAME_LEMMAS,
+    0,
+    "",
+    "bmc-frame-lemmas",
+    Arg::None,
+    "  --bmc-frame-lemmas \tWith --share-lemmas, bmc asserts each lemma of "
+    "IC3 frame i at the steps 0 to i of its unrolling, where it holds "
+    "without a check" },
+  { REVERSE_ENGINE,
+    0,
+    "",
+    "reverse-engine",
+    Arg::NonEmpty,
+    "  --reverse-engine <engine> \tIC3 variant that the ic3-rev engine runs "
+    "from the bad states on the reversed transition relation (default: "
+    "mbic3)" },
+  { IC3_INF_FRAME_PERIOD,
+    0,
+    "",
+    "ic3-inf-frame-period",
+    Arg::Numeric,
+    "  --ic3-inf-frame-period \tEvery this many IC3 frames, move the lemmas "
+    "of the frontier that are inductive relative to each other into an "
+    "infinity frame asserted outside of the frame labels, 0 means never "
+    "(default: 0)" },
+  { IC3_LEMMA_GC_PERIOD,
+    0,
+    "",
+    "ic3-lemma-gc-period",
+    Arg::Numeric,
+    "  --ic3-lemma-gc-period \tEvery this many IC3 frames, delete the lemmas "
+    "below the frontier that were not learned and blocked no proof goal "
+    "recently. A fixpoint is then only accepted if it is inductive, 0 "
+    "means never (default: 0)" },
+  { BMC_CONE_SLICE,
+    0,
+    "",
+    "bmc-cone-slice",
+    Arg::None,
+    "  --bmc-cone-slice \tAt bound k, bmc only asserts the state updates "
+    "of time frame t that are in the backward cone of bad k - t steps "
+    "later. Counterexamples are completed with the full transition "
+    "relation." },
+  { FLATTEN_ARRAYS,
+    0,
+    "",
+    "flatten-arrays",
+    Arg::None,
+    "  --flatten-arrays \tExpand small arrays into one state variable per "
+    "element, with selects and stores as ite chains. The arrays of a sort "
+    "are expanded if their indices have at most --flatten-arrays-width "
+    "bits and the ite chains are not too large for the number of selects "
+    "and stores. Witnesses show the arrays." },
+  { FLATTEN_ARRAYS_WIDTH,
+    0,
+    "",
+    "flatten-arrays-width",
+    Arg::Numeric,
+    "  --flatten-arrays-width \tLargest index width of the arrays expanded "
+    "by --flatten-arrays (default: 5)" },
+  { BMC_INIT_CONSTANTS,
+    0,
+    "",
+    "bmc-init-constants",
+    Arg::Numeric,
+    "  --bmc-init-constants \tIn this many first time steps, bmc replaces "
+    "the state variables that have a value by it: the ones init sets to a "
+    "value, then the ones whose state update simplifies to a value. 0 "
+    "disables it (default: 0)" },
+  { CEG_WIDTH_REDUCTION,
+    0,
+    "",
+    "ceg-width-reduction",
+    Arg::None,
+    "  --ceg-width-reduction \tDatapath width reduction: the bit-vectors "
+    "that only go through ites and equalities are reduced to the width "
+    "that tells their values apart, the reduced system is checked with "
+    "the engine and its counterexamples are checked by bmc (functional "
+    "systems only, no invariants)" },
+  { EXPORT_BTOR2,
+    0,
+    "",
+    "export-btor2",
+    Arg::NonEmpty,
+    "  --export-btor2 <file> \tWrite the transition system and property "
+    "after the preprocessing passes (e.g. --static-coi) as BTOR2, with the "
+    "names of the variables and the named terms as outputs (functional "
+    "systems only)" },
+  { EXPORT_VMT,
+    0,
+    "",
+    "export-vmt",
+    Arg::NonEmpty,
+    "  --export-vmt <file> \tWrite the transition system and property after "
+    "the preprocessing passes (e.g. --static-coi) as VMT, with the names of "
+    "the variables and the named terms" },
+  { JSON_EVENTS,
+    0,
+    "",
+    "json-events",
+    Arg::NonEmpty,
+    "  --json-events <file> \tStream newline-delimited JSON events to the "
+    "given file (- for stdout): the progress of the engines (bound, "
+    "frames, refinements, lemmas) and the result of each property with "
+    "its time and witness location. Written from a background thread, "
+    "progress events are dropped if the reader falls behind." },
+  { METRICS_FILE,
+    0,
+    "",
+    "metrics-file",
+    Arg::NonEmpty,
+    "  --metrics-file <file> \tRewrite the given file with the statistics "
+    "of the running engines (bound, frames, lemmas, solver calls, memory) "
+    "in the Prometheus text format, e.g. for the textfile collector of "
+    "node_exporter. See --metrics-interval." },
+  { METRICS_INTERVAL,
+    0,
+    "",
+    "metrics-interval",
+    Arg::Numeric,
+    "  --metrics-interval \tSeconds between two rewrites of the "
+    "--metrics-file (default: 10)" },
+  { DETERMINISTIC,
+    0,
+    "",
+    "deterministic",
+    Arg::None,
+    "  --deterministic \tReproducible results of the parallel engines for "
+    "a given --random-seed: parallel bmc splits the bounds between its "
+    "threads in a fixed way, decomposed properties are all checked before "
+    "the first violated one is reported, and the portfolio runs its "
+    "engines in lockstep epochs of one bound, exchanging lemmas (see "
+    "--share-lemmas) between epochs and taking the result of the first "
+    "engine in the list. Time limits are not reproducible." },
+  { THREADS,
+    0,
+    "",
+    "threads",
+    Arg::Numeric,
+    "  --threads \tWorker threads of the parallel modes (parallel bmc, the "
+    "concurrent IC3 blocking and propagation, --decompose-prop) that "
+    "don't set their own (default: the number of cores)" },
+  { PIN,
+    0,
+    "",
+    "pin",
+    Arg::None,
+    "  --pin \tPin each worker thread of parallel bmc and the portfolio to "
+    "its own CPU, the placement is in the statistics (Linux only)" },
+  { NUMA,
+    0,
+    "",
+    "numa",
+    Arg::None,
+    "  --numa \tSpread the worker threads of parallel bmc and the "
+    "portfolio evenly over the NUMA nodes, and keep each worker and the "
+    "memory of its solver on its node (Linux only)" },
+  { PRE_CHECK,
+    0,
+    "",
+    "pre-check",
+    Arg::None,
+    "  --pre-check \tBefore starting the engine, try to decide the property "
+    "cheaply: by constant propagation, by random simulation (see "
+    "--pre-check-cycles) and by bmc up to bound 1 with a time limit of "
+    "one second" },
+  { PRE_CHECK_CYCLES,
+    0,
+    "",
+    "pre-check-cycles",
+    Arg::Numeric,
+    "  --pre-check-cycles \tCycles of random simulation of --pre-check, 0 "
+    "to skip it (default: 4096)" },
+  { IC3IA_PRED_CACHE,
+    0,
+    "",
+    "ic3ia-pred-cache",
+    Arg::NonEmpty,
+    "  --ic3ia-pred-cache <file> \tStart ic3ia with the predicates saved in "
+    "the file by previous runs or properties (the ones over state variables "
+    "of the cone of the property), and add the predicates it learns to the "
+    "file" },
+  { INTERP_REUSE,
+    0,
+    "",
+    "interp-reuse",
+    Arg::None,
+    "  --interp-reuse \tStart each bound of interp with the interpolants of "
+    "the previous bound that still can't reach a bad state" },
+  { IC3_BAD_BATCH,
+    0,
+    "",
+    "ic3-bad-batch",
+    Arg::Numeric,
+    "  --ic3-bad-batch \tNumber of states of the frontier that can reach a "
+    "bad state that IC3 finds at once and blocks together, the more "
+    "general first (default: 1)." },
+  { FRAIG,
+    0,
+    "",
+    "fraig",
+    Arg::None,
+    "  --fraig \tMerge the nodes of the state updates and constraints that "
+    "are proven equivalent after random simulation, before solving." },
+  { CHECK_WITNESS,
+    0,
+    "",
+    "check-witness",
+    Arg::None,
+    "  --check-witness \tReplay counterexamples on the simulator and fail if "
+    "they are not valid. Always on with --portfolio and the abstraction "
+    "refinement options (relational systems are not checked)." },
+  { BMC_SIM_GUIDE,
+    0,
+    "",
+    "bmc-sim-guide",
+    Arg::Numeric,
+    "  --bmc-sim-guide \tNumber of cycles bmc simulates before solving. From "
+    "the step where a trace came closest to a bad state, each bound is "
+    "first checked along that trace. 0 disables it (default: 0)" },
+  { CUBE_SERVERS,
+    0,
+    "",
+    "cube-servers",
+    Arg::NonEmpty,
+    "  --cube-servers <sockets> \tCheck the bounds up to -k by "
+    "cube-and-conquer bmc on the pono servers (see --serve) listening on "
+    "the comma-separated sockets." },
+  { CUBE_VARS,
+    0,
+    "",
+    "cube-vars",
+    Arg::Numeric,
+    "  --cube-vars \tNumber of variables cube-and-conquer splits on, for "
+    "2^n cubes (default: 4)" },
+  { CUBE_DEPTH,
+    0,
+    "",
+    "cube-depth",
+    Arg::Numeric,
+    "  --cube-depth \tTime step where cube-and-conquer splits, 0 for half "
+    "of the bound (default: 0)" },
+  { CUBE_SNAPSHOT,
+    0,
+    "",
+    "cube-snapshot",
+    Arg::NonEmpty,
+    "  --cube-snapshot <file> \tWhere cube-and-conquer writes the snapshot "
+    "of the system for the servers, a .snap file they can read (default: "
+    "in the working directory)" },
+  { BMC_CUBE,
+    0,
+    "",
+    "bmc-cube",
+    Arg::NonEmpty,
+    "  --bmc-cube <cube> \tOnly search the counterexamples in a cube, e.g. "
+    "en@3=1;x@3[7]=0 (see utils/cube_and_conquer.h)" },
+  { LEMMA_EXCHANGE,
+    0,
+    "",
+    "lemma-exchange",
+    Arg::NonEmpty,
+    "  --lemma-exchange <socket> \tWith --share-lemmas, also exchange the "
+    "lemmas with the portfolios on other machines through the verification "
+    "server on the given Unix domain socket (e.g. forwarded with ssh). The "
+    "lemmas of the others are candidates the engines check before use." },
+  { LEMMA_EXCHANGE_RATE,
+    0,
+    "",
+    "lemma-exchange-rate",
+    Arg::Numeric,
+    "  --lemma-exchange-rate \tWith --serve, the new lemmas per second the "
+    "server keeps for each system, more are dropped (default: 1000)" },
+  { MIGRATE_LEMMAS,
+    0,
+    "",
+    "migrate-lemmas",
+    Arg::NonEmpty,
+    "  --migrate-lemmas <file> \tReuse a lemma cache of a previous revision "
+    "of the design (see --ic3-lemma-cache and --kind-invariants), even if "
+    "its state variables changed. The clauses are mapped by variable name "
+    "and sort, and the ones that are still inductive (Houdini pruning with "
+    "--mine-threads) are added as constraints for every engine." },
   { 0, 0, 0, 0, 0, 0 }
 };
 /*********************************** end Option Handling setup
@@ -446,6 +1538,26 @@ Engine PonoOptions::to_engine(std::string s)
   }
 }
 
+void PonoOptions::set_witness_steps(const std::string & range)
+{
+  size_t colon = range.find(':');
+  std::string first = range.substr(0, colon);
+  std::string last =
+      colon == std::string::npos ? first : range.substr(colon + 1);
+  try {
+    witness_first_step_ = first.empty() ? 0 : std::stoi(first);
+    witness_last_step_ = last.empty() ? -1 : std::stoi(last);
+  }
+  catch (std::exception & e) {
+    throw PonoException("Invalid witness steps " + range);
+  }
+  if (witness_first_step_ < 0
+      || (witness_last_step_ >= 0
+          && witness_last_step_ < witness_first_step_)) {
+    throw PonoException("Invalid witness steps " + range);
+  }
+}
+
 // Parse command line options given by 'argc' and 'argv' and set
 // respective options in the 'pono_options' object.
 // Returns 'ERROR' if there is something wrong with the given options
@@ -572,6 +1684,136 @@ ProverResult PonoOptions::parse_and_set_options(int argc,
         }
         case IC3SA_INTERP: ic3sa_interp_ = true; break;
         case PRINT_WALL_TIME: print_wall_time_ = true; break;
+        case PORTFOLIO: portfolio_ = true; break;
+        case ALL_PROPS: all_props_ = true; break;
+        case TIME_LIMIT: time_limit_ = atoi(opt.arg); break;
+        case SOLVER_CALL_LIMIT: solver_call_limit_ = atoi(opt.arg); break;
+        case MEM_LIMIT: mem_limit_ = atoi(opt.arg); break;
+        case QUERY_TIME_LIMIT: query_time_limit_ = atoi(opt.arg); break;
+        case STATS_JSON: stats_json_ = opt.arg; break;
+        case SHARE_LEMMAS: share_lemmas_ = true; break;
+        case BMC_ASSUMPTIONS: bmc_assumptions_ = true; break;
+        case BMC_STEP_SIZE: bmc_step_size_ = atoi(opt.arg); break;
+        case BMC_THREADS: bmc_threads_ = atoi(opt.arg); break;
+        case IC3_REL_IND_ASSUMPTIONS: ic3_rel_ind_assumptions_ = true; break;
+        case IC3_ACT_LIT_RESET: ic3_act_lit_reset_ = atoi(opt.arg); break;
+        case IC3_FRAME_SOLVERS: ic3_frame_solvers_ = true; break;
+        case IC3_PROP_THREADS: ic3_prop_threads_ = atoi(opt.arg); break;
+        case IC3_BLOCK_THREADS: ic3_block_threads_ = atoi(opt.arg); break;
+        case IC3_CTG: ic3_ctg_ = true; break;
+        case IC3_CTG_MAX_DEPTH: ic3_ctg_max_depth_ = atoi(opt.arg); break;
+        case IC3_CTG_MAX_CTGS: ic3_ctg_max_ctgs_ = atoi(opt.arg); break;
+        case IC3_TERNARY_SIM: ic3_ternary_sim_ = true; break;
+        case IC3_LEMMA_CACHE: ic3_lemma_cache_ = opt.arg; break;
+        case IC3_RESET_DEAD_RATIO: ic3_reset_dead_ratio_ = atoi(opt.arg); break;
+        case KIND_FINGERPRINT: kind_fingerprint_ = true; break;
+        case KIND_DUAL_SOLVER: kind_dual_solver_ = true; break;
+        case KIND_INVARIANTS: kind_invariants_ = opt.arg; break;
+        case SIM_TRACES: sim_traces_ = atoi(opt.arg); break;
+        case SIM_LANES: sim_lanes_ = atoi(opt.arg); break;
+        case LATCH_SWEEP: latch_sweep_ = true; break;
+        case MINE_INVARIANTS: mine_invariants_ = true; break;
+        case MINE_THREADS: mine_threads_ = atoi(opt.arg); break;
+        case SIMPLIFY: simplify_ = true; break;
+        case SAVE_SNAPSHOT: save_snapshot_ = opt.arg; break;
+        case BMC_UNROLL_WINDOW: bmc_unroll_window_ = atoi(opt.arg); break;
+        case IC3SA_FUNC_UNROLL_LIMIT: ic3sa_func_unroll_limit_ = atoi(opt.arg); break;
+        case IC3_PARTITION_TRANS: ic3_partition_trans_ = true; break;
+        case BTOR2_PROP_CONE: btor2_prop_cone_ = true; break;
+        case WITNESS_SIGNALS: witness_signals_ = opt.arg; break;
+        case WITNESS_INPUTS_ONLY: witness_inputs_only_ = true; break;
+        case WITNESS_STEPS: set_witness_steps(opt.arg); break;
+        case MINIMIZE_CEX: minimize_cex_ = true; break;
+        case CEGP_INCREMENTAL_AXIOMS: cegp_incremental_axioms_ = true; break;
+        case CEGAR_CORE_MIN_TIME: cegar_core_min_time_ = atoi(opt.arg); break;
+        case CEGAR_REFINE_THREADS: cegar_refine_threads_ = atoi(opt.arg); break;
+        case CEGAR_SHARE_REFINEMENTS: cegar_share_refinements_ = true; break;
+        case CEG_BV_ARITH_MIN_COST: ceg_bv_arith_min_cost_ = atoi(opt.arg); break;
+        case CEG_BV_ARITH_MAX_REFINE: ceg_bv_arith_max_refine_ = atoi(opt.arg); break;
+        case IC3IA_REFINE_PORTFOLIO: ic3ia_refine_portfolio_ = true; break;
+        case MSAT_IC3IA_SHARE_ENV: msat_ic3ia_share_env_ = true; break;
+        case IC3_LIT_ORDER: ic3_lit_order_ = true; break;
+        case IC3IA_LAZY_PRED_RELS: ic3ia_lazy_pred_rels_ = true; break;
+        case SYGUS_EVAL_CACHE_LIMIT: sygus_eval_cache_limit_ = atoi(opt.arg); break;
+        case SOLVER_PROFILES: solver_profiles_ = opt.arg; break;
+        case SOLVER_PROFILE: solver_profile_ = opt.arg; break;
+        case SOLVER_TRACE: solver_trace_ = opt.arg; break;
+        case QUERY_RESOURCE_LIMIT: query_resource_limit_ = atoi(opt.arg); break;
+        case REDUCER_QUERY_TIME_LIMIT: reducer_query_time_limit_ = atoi(opt.arg); break;
+        case QUERY_RETRIES: query_retries_ = atoi(opt.arg); break;
+        case IC3BITS_SAT: ic3bits_sat_ = true; break;
+        case LOG_BUFFER: log_buffer_ = atoi(opt.arg); break;
+        case LOG_ASYNC: log_async_ = true; break;
+        case LOG_COMPONENTS: log_components_ = opt.arg; break;
+        case LOG_RATE_LIMIT: log_rate_limit_ = atoi(opt.arg); break;
+        case TRACE_FILE: trace_file_ = opt.arg; break;
+        case CHECK_INVAR_THREADS: check_invar_threads_ = atoi(opt.arg); break;
+        case COMPACT_INVAR: compact_invar_ = true; break;
+        case CHECKPOINT: checkpoint_ = opt.arg; break;
+        case CHECKPOINT_INTERVAL: checkpoint_interval_ = atoi(opt.arg); break;
+        case RESUME: resume_ = true; break;
+        case RESET_PRESIM: reset_presim_ = true; break;
+        case FOLD_CLOCK: fold_clock_ = true; break;
+        case SERVE: serve_ = opt.arg; break;
+        case SERVE_WORKERS: serve_workers_ = atoi(opt.arg); break;
+        case RESULT_CACHE: result_cache_ = opt.arg; break;
+        case ENGINE_MODEL: engine_model_ = opt.arg; break;
+        case PORTFOLIO_SIZE: portfolio_size_ = atoi(opt.arg); break;
+        case PORTFOLIO_CORES: portfolio_cores_ = atoi(opt.arg); break;
+        case PORTFOLIO_SLICE: portfolio_slice_ = atoi(opt.arg); break;
+        case SOFT_MEM_LIMIT: soft_mem_limit_ = atoi(opt.arg); break;
+        case STATS_ONLY: stats_only_ = true; break;
+        case CEG_LOCALIZATION: ceg_localization_ = true; break;
+        case CEG_LOCALIZATION_PBA:
+          ceg_localization_pba_ = atoi(opt.arg);
+          break;
+        case BDD_NODE_LIMIT: bdd_node_limit_ = atoi(opt.arg); break;
+        case KLIVE_ENGINE: klive_engine_ = to_engine(opt.arg); break;
+        case DECOMPOSE_PROP: decompose_prop_ = true; break;
+        case DECOMPOSE_THREADS: decompose_threads_ = atoi(opt.arg); break;
+        case ASSUME_PROVEN: assume_proven_ = true; break;
+        case ASSUME_PROVEN_INVARS: assume_proven_invars_ = true; break;
+        case BMC_FRAME_LEMMAS: bmc_frame_lemmas_ = true; break;
+        case REVERSE_ENGINE: reverse_engine_ = to_engine(opt.arg); break;
+        case IC3_INF_FRAME_PERIOD:
+          ic3_inf_frame_period_ = atoi(opt.arg);
+          break;
+        case IC3_LEMMA_GC_PERIOD:
+          ic3_lemma_gc_period_ = atoi(opt.arg);
+          break;
+        case BMC_CONE_SLICE: bmc_cone_slice_ = true; break;
+        case FLATTEN_ARRAYS: flatten_arrays_ = true; break;
+        case FLATTEN_ARRAYS_WIDTH: flatten_arrays_width_ = atoi(opt.arg); break;
+        case BMC_INIT_CONSTANTS: bmc_init_constants_ = atoi(opt.arg); break;
+        case CEG_WIDTH_REDUCTION: ceg_width_reduction_ = true; break;
+        case EXPORT_BTOR2: export_btor2_ = opt.arg; break;
+        case EXPORT_VMT: export_vmt_ = opt.arg; break;
+        case JSON_EVENTS: json_events_ = opt.arg; break;
+        case METRICS_FILE: metrics_file_ = opt.arg; break;
+        case METRICS_INTERVAL: metrics_interval_ = atoi(opt.arg); break;
+        case DETERMINISTIC: deterministic_ = true; break;
+        case THREADS: threads_ = atoi(opt.arg); break;
+        case PIN: pin_threads_ = true; break;
+        case NUMA: numa_ = true; break;
+        case PRE_CHECK: pre_check_ = true; break;
+        case PRE_CHECK_CYCLES: pre_check_cycles_ = atoi(opt.arg); break;
+        case IC3IA_PRED_CACHE: ic3ia_pred_cache_ = opt.arg; break;
+        case INTERP_REUSE: interp_reuse_ = true; break;
+        case IC3_BAD_BATCH: ic3_bad_batch_ = atoi(opt.arg); break;
+        case FRAIG: fraig_ = true; break;
+        case CHECK_WITNESS: check_witness_ = true; break;
+        case BMC_SIM_GUIDE: bmc_sim_guide_ = atoi(opt.arg); break;
+        case CUBE_SERVERS: cube_servers_ = opt.arg; break;
+        case CUBE_VARS: cube_vars_ = atoi(opt.arg); break;
+        case CUBE_DEPTH: cube_depth_ = atoi(opt.arg); break;
+        case CUBE_SNAPSHOT: cube_snapshot_ = opt.arg; break;
+        case BMC_CUBE: bmc_cube_ = opt.arg; break;
+        case LEMMA_EXCHANGE: lemma_exchange_ = opt.arg; break;
+        case LEMMA_EXCHANGE_RATE: lemma_exchange_rate_ = atoi(opt.arg); break;
+        case MIGRATE_LEMMAS: migrate_lemmas_ = opt.arg; break;
+        case SIM_THREADS: sim_threads_ = atoi(opt.arg); break;
+        case WITNESS_QUEUE: witness_queue_ = atoi(opt.arg); break;
+        case COMPACT_INVAR_TIME_LIMIT: compact_invar_time_limit_ = atoi(opt.arg); break;
         case UNKNOWN_OPTION:
           // not possible because Arg::Unknown returns ARG_ILLEGAL
           // which aborts the parse with an error
@@ -579,9 +1821,84 @@ ProverResult PonoOptions::parse_and_set_options(int argc,
       }
     }
 
-    if (smt_solver_ != smt::MSAT && engine_ == Engine::INTERP) {
+    if (smt_solver_ != smt::MSAT
+        && (engine_ == Engine::INTERP || engine_ == Engine::ISMC_ENGINE)) {
       throw PonoException(
-          "Interpolation engine can be only used with '--smt-solver msat'.");
+          "Interpolation engines can be only used with '--smt-solver msat'.");
+    }
+
+    if (log_async_ && !log_buffer_) {
+      throw PonoException("--log-async requires --log-buffer");
+    }
+
+    if (resume_ && checkpoint_.empty()) {
+      throw PonoException("--resume requires --checkpoint");
+    }
+
+    if (reset_presim_ && reset_name_.empty()) {
+      throw PonoException("--reset-presim requires --reset");
+    }
+
+    if (fold_clock_ && clock_name_.empty()) {
+      throw PonoException("--fold-clock requires --clock");
+    }
+
+    if (portfolio_size_ && !portfolio_) {
+      throw PonoException("--portfolio-size requires --portfolio");
+    }
+
+    if (ceg_localization_pba_ && !ceg_localization_) {
+      throw PonoException("--ceg-localization-pba requires --ceg-localization");
+    }
+
+    if (ic3_variants().find(klive_engine_) == ic3_variants().end()
+        || klive_engine_ == IC3IA_ENGINE || klive_engine_ == MSAT_IC3IA) {
+      // the abstraction of IC3IA does not keep its frames across bounds
+      throw PonoException("--klive-engine expects an IC3 variant other "
+                          "than ic3ia and msat-ic3ia");
+    }
+
+    if (ic3_variants().find(reverse_engine_) == ic3_variants().end()
+        || reverse_engine_ == MSAT_IC3IA || reverse_engine_ == IC3SA_ENGINE
+        || reverse_engine_ == SYGUS_PDR) {
+      // the reversed system is relational
+      throw PonoException("--reverse-engine expects an IC3 variant other "
+                          "than msat-ic3ia, ic3sa and sygus-pdr");
+    }
+
+    if (decompose_threads_ && !decompose_prop_) {
+      throw PonoException("--decompose-threads requires --decompose-prop");
+    }
+
+    if (decompose_prop_
+        && (portfolio_ || ceg_prophecy_arrays_ || cegp_abs_vals_
+            || ceg_bv_arith_ || ceg_localization_ || ceg_width_reduction_)) {
+      throw PonoException(
+          "--decompose-prop can't be combined with --portfolio or CEGAR");
+    }
+
+    if (assume_proven_ && !all_props_) {
+      throw PonoException("--assume-proven requires --all-props");
+    }
+
+    if (assume_proven_invars_ && !assume_proven_) {
+      throw PonoException("--assume-proven-invars requires --assume-proven");
+    }
+
+    if (portfolio_cores_ && !portfolio_) {
+      throw PonoException("--portfolio-cores requires --portfolio");
+    }
+
+    if (!portfolio_slice_) {
+      throw PonoException("--portfolio-slice must be at least 1");
+    }
+
+    if (sim_lanes_ != 1 && (!sim_lanes_ || sim_lanes_ % 64)) {
+      throw PonoException("--sim-lanes must be 1 or a multiple of 64");
+    }
+
+    if (!sim_threads_) {
+      throw PonoException("--sim-threads must be at least 1");
     }
 
     if (ceg_prophecy_arrays_ && smt_solver_ != smt::MSAT) {
@@ -590,18 +1907,49 @@ ProverResult PonoOptions::parse_and_set_options(int argc,
     }
 
     if (smt_solver_ == smt::CVC4
-        && ic3_variants().find(engine_) != ic3_variants().end()) {
+        && (ic3_variants().find(engine_) != ic3_variants().end()
+            || engine_ == REVERSE_IC3)) {
       throw PonoException(
           "CVC4 cannot handle multiple solver instances, and thus does not "
           "currently support IC3 variants.");
     }
+
+    if (!bmc_step_size_) {
+      throw PonoException("--bmc-step-size must be at least 1");
+    }
+
+    if (share_lemmas_ && !portfolio_) {
+      throw PonoException("--share-lemmas requires --portfolio");
+    }
+
+    if (!lemma_exchange_.empty() && !share_lemmas_) {
+      throw PonoException("--lemma-exchange requires --share-lemmas");
+    }
+
+    if (bmc_frame_lemmas_ && !share_lemmas_) {
+      throw PonoException("--bmc-frame-lemmas requires --share-lemmas");
+    }
+
+    if (bmc_frame_lemmas_ && bmc_unroll_window_) {
+      // the lemmas are asserted at earlier steps as their frames grow
+      throw PonoException(
+          "--bmc-frame-lemmas can't be combined with --bmc-unroll-window");
+    }
+
+    if (bmc_cone_slice_ && (bmc_step_size_ > 1 || bmc_unroll_window_)) {
+      // the cones are per bound, and earlier frames grow with the bound
+      throw PonoException(
+          "--bmc-cone-slice can't be combined with --bmc-step-size or "
+          "--bmc-unroll-window");
+    }
   }
   catch (PonoException & ce) {
     cout << ce.what() << endl;
     return ERROR;
   }
 
-  if (expect_file) {
+  // no file to check when serving
+  if (expect_file && (serve_.empty() || parse.nonOptionsCount())) {
     filename_ = parse.nonOption(0);
   }
 
@@ -670,6 +2018,34 @@ string to_string(Engine e)
       res = "sygus-pdr";
       break;
     }
+    case BMC_PAR: {
+      res = "bmc-par";
+      break;
+    }
+    case ISMC_ENGINE: {
+      res = "ismc";
+      break;
+    }
+    case SIM: {
+      res = "sim";
+      break;
+    }
+    case BDD_REACH: {
+      res = "bdd";
+      break;
+    }
+    case KLIVE: {
+      res = "klive";
+      break;
+    }
+    case REVERSE_IC3: {
+      res = "ic3-rev";
+      break;
+    }
+    case AUTO: {
+      res = "auto";
+      break;
+    }
     default: {
       throw PonoException("Unhandled engine: " + std::to_string(e));
     }
@@ -39,7 +39,14 @@ enum Engine
   IC3IA_ENGINE,
   MSAT_IC3IA,
   IC3SA_ENGINE,
-  SYGUS_PDR
+  SYGUS_PDR,
+  BMC_PAR,
+  ISMC_ENGINE,
+  SIM,
+  BDD_REACH,
+  KLIVE,
+  REVERSE_IC3,
+  AUTO  ///< picked per property by EngineSelector, never constructed
   // NOTE: if adding an IC3 variant,
   // make sure to update ic3_variants_set in options/options.cpp
   // used for setting solver options appropriately
@@ -65,7 +72,14 @@ const std::unordered_map<std::string, Engine> str2engine(
       { "ic3ia", IC3IA_ENGINE },
       { "msat-ic3ia", MSAT_IC3IA },
       { "ic3sa", IC3SA_ENGINE },
-      { "sygus-pdr", SYGUS_PDR } });
+      { "sygus-pdr", SYGUS_PDR },
+      { "bmc-par", BMC_PAR },
+      { "ismc", ISMC_ENGINE },
+      { "sim", SIM },
+      { "bdd", BDD_REACH },
+      { "klive", KLIVE },
+      { "ic3-rev", REVERSE_IC3 },
+      { "auto", AUTO } });
 
 // SyGuS mode option
 enum SyGuSTermMode{
@@ -131,7 +145,108 @@ class PonoOptions
             default_sygus_use_operator_abstraction_),
         ic3sa_initial_terms_lvl_(default_ic3sa_initial_terms_lvl_),
         ic3sa_interp_(default_ic3sa_interp_),
-        print_wall_time_(default_print_wall_time_)
+        print_wall_time_(default_print_wall_time_),
+        portfolio_(default_portfolio_),
+        all_props_(default_all_props_),
+        time_limit_(default_time_limit_),
+        solver_call_limit_(default_solver_call_limit_),
+        mem_limit_(default_mem_limit_),
+        query_time_limit_(default_query_time_limit_),
+        share_lemmas_(default_share_lemmas_),
+        bmc_assumptions_(default_bmc_assumptions_),
+        bmc_step_size_(default_bmc_step_size_),
+        bmc_threads_(default_bmc_threads_),
+        ic3_rel_ind_assumptions_(default_ic3_rel_ind_assumptions_),
+        ic3_act_lit_reset_(default_ic3_act_lit_reset_),
+        ic3_frame_solvers_(default_ic3_frame_solvers_),
+        ic3_prop_threads_(default_ic3_prop_threads_),
+        ic3_block_threads_(default_ic3_block_threads_),
+        ic3_ctg_(default_ic3_ctg_),
+        ic3_ctg_max_depth_(default_ic3_ctg_max_depth_),
+        ic3_ctg_max_ctgs_(default_ic3_ctg_max_ctgs_),
+        ic3_ternary_sim_(default_ic3_ternary_sim_),
+        ic3_reset_dead_ratio_(default_ic3_reset_dead_ratio_),
+        kind_fingerprint_(default_kind_fingerprint_),
+        kind_dual_solver_(default_kind_dual_solver_),
+        sim_traces_(default_sim_traces_),
+        sim_lanes_(default_sim_lanes_),
+        latch_sweep_(default_latch_sweep_),
+        mine_invariants_(default_mine_invariants_),
+        mine_threads_(default_mine_threads_),
+        simplify_(default_simplify_),
+        metrics_interval_(default_metrics_interval_),
+        deterministic_(default_deterministic_),
+        threads_(default_threads_),
+        pin_threads_(default_pin_threads_),
+        numa_(default_numa_),
+        pre_check_(default_pre_check_),
+        pre_check_cycles_(default_pre_check_cycles_),
+        interp_reuse_(default_interp_reuse_),
+        ic3_bad_batch_(default_ic3_bad_batch_),
+        fraig_(default_fraig_),
+        check_witness_(default_check_witness_),
+        bmc_sim_guide_(default_bmc_sim_guide_),
+        cube_vars_(default_cube_vars_),
+        cube_depth_(default_cube_depth_),
+        lemma_exchange_rate_(default_lemma_exchange_rate_),
+        sim_threads_(default_sim_threads_),
+        witness_queue_(default_witness_queue_),
+        bmc_unroll_window_(default_bmc_unroll_window_),
+        ic3sa_func_unroll_limit_(default_ic3sa_func_unroll_limit_),
+        ic3_partition_trans_(default_ic3_partition_trans_),
+        btor2_prop_cone_(default_btor2_prop_cone_),
+        witness_inputs_only_(default_witness_inputs_only_),
+        witness_first_step_(default_witness_first_step_),
+        witness_last_step_(default_witness_last_step_),
+        minimize_cex_(default_minimize_cex_),
+        cegp_incremental_axioms_(default_cegp_incremental_axioms_),
+        cegar_core_min_time_(default_cegar_core_min_time_),
+        cegar_refine_threads_(default_cegar_refine_threads_),
+        cegar_share_refinements_(default_cegar_share_refinements_),
+        ceg_bv_arith_min_cost_(default_ceg_bv_arith_min_cost_),
+        ceg_bv_arith_max_refine_(default_ceg_bv_arith_max_refine_),
+        ic3ia_refine_portfolio_(default_ic3ia_refine_portfolio_),
+        msat_ic3ia_share_env_(default_msat_ic3ia_share_env_),
+        ic3_lit_order_(default_ic3_lit_order_),
+        ic3ia_lazy_pred_rels_(default_ic3ia_lazy_pred_rels_),
+        sygus_eval_cache_limit_(default_sygus_eval_cache_limit_),
+        query_resource_limit_(default_query_resource_limit_),
+        reducer_query_time_limit_(default_reducer_query_time_limit_),
+        query_retries_(default_query_retries_),
+        ic3bits_sat_(default_ic3bits_sat_),
+        log_buffer_(default_log_buffer_),
+        log_async_(default_log_async_),
+        log_rate_limit_(default_log_rate_limit_),
+        check_invar_threads_(default_check_invar_threads_),
+        compact_invar_(default_compact_invar_),
+        compact_invar_time_limit_(default_compact_invar_time_limit_),
+        checkpoint_interval_(default_checkpoint_interval_),
+        resume_(default_resume_),
+        reset_presim_(default_reset_presim_),
+        fold_clock_(default_fold_clock_),
+        serve_workers_(default_serve_workers_),
+        portfolio_size_(default_portfolio_size_),
+        portfolio_cores_(default_portfolio_cores_),
+        portfolio_slice_(default_portfolio_slice_),
+        soft_mem_limit_(default_soft_mem_limit_),
+        stats_only_(default_stats_only_),
+        ceg_localization_(default_ceg_localization_),
+        ceg_localization_pba_(default_ceg_localization_pba_),
+        bdd_node_limit_(default_bdd_node_limit_),
+        klive_engine_(default_klive_engine_),
+        decompose_prop_(default_decompose_prop_),
+        decompose_threads_(default_decompose_threads_),
+        assume_proven_(default_assume_proven_),
+        assume_proven_invars_(default_assume_proven_invars_),
+        bmc_frame_lemmas_(default_bmc_frame_lemmas_),
+        reverse_engine_(default_reverse_engine_),
+        ic3_inf_frame_period_(default_ic3_inf_frame_period_),
+        ic3_lemma_gc_period_(default_ic3_lemma_gc_period_),
+        bmc_cone_slice_(default_bmc_cone_slice_),
+        flatten_arrays_(default_flatten_arrays_),
+        flatten_arrays_width_(default_flatten_arrays_width_),
+        bmc_init_constants_(default_bmc_init_constants_),
+        ceg_width_reduction_(default_ceg_width_reduction_)
   {
   }
 
@@ -155,6 +270,18 @@ class PonoOptions
 
   Engine to_engine(std::string s);
 
+  /** Set the witness steps from a range <first>:<last>, where an omitted
+   *  first step is 0 and an omitted last step is the last one
+   */
+  void set_witness_steps(const std::string & range);
+
+  /** @return true iff the witness is restricted to some signals or steps */
+  bool filtered_witness() const
+  {
+    return !witness_signals_.empty() || witness_inputs_only_
+           || witness_first_step_ > 0 || witness_last_step_ >= 0;
+  }
+
   // Pono options
   Engine engine_;
   unsigned int prop_idx_;
@@ -216,6 +343,141 @@ class PonoOptions
   bool ic3sa_interp_;
   // print wall clock time spent in entire execution
   bool print_wall_time_;
+  bool portfolio_;  ///< race several engines in parallel threads
+  bool all_props_;  ///< check every property in the file in one run
+  // resource budget of each engine, 0 means no limit
+  unsigned int time_limit_;         ///< wall-clock limit in seconds
+  size_t solver_call_limit_;        ///< maximum number of solver queries
+  size_t mem_limit_;                ///< peak memory limit in megabytes
+  size_t query_time_limit_;         ///< time limit per solver query in ms
+  std::string stats_json_;  ///< file to write engine statistics to as JSON
+  bool share_lemmas_;  ///< exchange lemmas and bounds in the portfolio
+  bool bmc_assumptions_;  ///< guard bad states with assumptions, no push/pop
+  unsigned int bmc_step_size_;  ///< number of bounds bmc checks with one query
+  unsigned int bmc_threads_;  ///< number of threads used by bmc-par
+  bool ic3_rel_ind_assumptions_;  ///< rel_ind_check without push/pop
+  unsigned int ic3_act_lit_reset_;  ///< dead activation literals per reset
+  bool ic3_frame_solvers_;  ///< one solver per IC3 frame
+  unsigned int ic3_prop_threads_;  ///< threads for IC3 propagation
+  unsigned int ic3_block_threads_;  ///< threads for IC3 proof goals
+  bool ic3_ctg_;  ///< block CTGs in IC3 generalization
+  unsigned int ic3_ctg_max_depth_;  ///< recursion depth for --ic3-ctg
+  unsigned int ic3_ctg_max_ctgs_;  ///< CTGs blocked per literal with --ic3-ctg
+  bool ic3_ternary_sim_;  ///< ternary simulation pregen in IC3
+  std::string ic3_lemma_cache_;  ///< file to cache IC3 lemmas in across runs
+  unsigned int ic3_reset_dead_ratio_;  ///< percent of dead assertions before an IC3 solver reset
+  bool kind_fingerprint_;  ///< model fingerprints for simple path checks in k-induction
+  bool kind_dual_solver_;  ///< base and step of k-induction in separate solvers and threads
+  std::string kind_invariants_;  ///< file with candidate invariants for k-induction
+  unsigned int sim_traces_;  ///< number of random traces of the sim engine
+  unsigned int sim_lanes_;  ///< traces simulated at once by the sim engine
+  bool latch_sweep_;  ///< merge equivalent and constant state variables
+  bool mine_invariants_;  ///< strengthen the system with mined invariants
+  unsigned int mine_threads_;  ///< threads for pruning mined invariants
+  bool simplify_;  ///< constant propagation and simplification of the system
+  std::string save_snapshot_;  ///< file to save the preprocessed system in
+  std::string export_btor2_;  ///< file to write the preprocessed system in
+  std::string export_vmt_;  ///< file to write the preprocessed system in
+  std::string json_events_;  ///< file to stream progress and results to
+  std::string metrics_file_;  ///< file to rewrite the live statistics in
+  size_t metrics_interval_;  ///< seconds between rewrites of metrics_file_
+  bool deterministic_;  ///< reproducible results of the parallel engines
+  unsigned int threads_;  ///< default threads of the parallel modes, 0 for
+                          ///< the number of cores
+  bool pin_threads_;  ///< pin each worker thread to a CPU
+  bool numa_;  ///< spread the worker threads over the NUMA nodes
+  bool pre_check_;  ///< decide trivial properties before the engine starts
+  size_t pre_check_cycles_;  ///< cycles simulated by the pre-check
+  std::string ic3ia_pred_cache_;  ///< file to cache IC3IA predicates in
+                                  ///< across runs and properties
+  bool interp_reuse_;  ///< start each bound of interp with the last one's
+                       ///< interpolants
+  unsigned int ic3_bad_batch_;  ///< bad cubes IC3 enumerates per query round
+  bool fraig_;  ///< merge equivalent nodes of the state updates
+  bool check_witness_;  ///< replay counterexamples on the simulator
+  size_t bmc_sim_guide_;  ///< cycles simulated to guide bmc
+  std::string cube_servers_;  ///< sockets of the cube-and-conquer servers
+  size_t cube_vars_;          ///< variables cube-and-conquer splits on
+  unsigned int cube_depth_;   ///< time step of the cubes, 0 for bound / 2
+  std::string cube_snapshot_;  ///< snapshot file shipped to the servers
+  std::string bmc_cube_;       ///< the cube bmc is restricted to
+  std::string lemma_exchange_;  ///< socket of the server to share lemmas
+  size_t lemma_exchange_rate_;  ///< lemmas per second a server keeps
+  std::string migrate_lemmas_;  ///< lemma cache of a previous revision
+  unsigned int sim_threads_;    ///< threads of the sim engine
+  size_t witness_queue_;  ///< results queued for printing, 0 for none
+  unsigned int bmc_unroll_window_;  ///< bounds bmc keeps unrolling caches of
+  unsigned int ic3sa_func_unroll_limit_;  ///< max inlined update in ic3sa
+  bool ic3_partition_trans_;  ///< partitioned trans in ic3 relative induction
+  bool btor2_prop_cone_;  ///< only encode the cone of the property
+  std::string witness_signals_;  ///< comma-separated witness name globs
+  bool witness_inputs_only_;  ///< witness for replay: inputs and init
+  int witness_first_step_;  ///< first step of the witness
+  int witness_last_step_;  ///< last step of the witness, negative for all
+  bool minimize_cex_;  ///< minimize counterexamples for replay
+  bool cegp_incremental_axioms_;  ///< keep axiom candidates between refinements
+  size_t cegar_core_min_time_;  ///< QuickXplain budget in ms for CEGAR reductions
+  unsigned int cegar_refine_threads_;  ///< solvers checking CEGAR cexs
+  bool cegar_share_refinements_;  ///< share CEGAR refinements between properties
+  size_t ceg_bv_arith_min_cost_;  ///< min estimated cost of an abstracted op
+  size_t ceg_bv_arith_max_refine_;  ///< refine all instances of an op after this many
+  bool ic3ia_refine_portfolio_;  ///< run the refinement strategies of IC3IA concurrently
+  bool msat_ic3ia_share_env_;  ///< run the msat ic3ia backend in the solver environment
+  bool ic3_lit_order_;  ///< order the literals dropped by IC3 generalization
+  bool ic3ia_lazy_pred_rels_;  ///< load IC3IA predicate relations on demand
+  unsigned sygus_eval_cache_limit_;  ///< SyGuS bound on the cached subterm values per cex
+  std::string solver_profiles_;  ///< file of solver option profiles
+  std::string solver_profile_;  ///< profile selected in the solver profiles file
+  std::string solver_trace_;  ///< file to write the solver call histograms to
+  size_t query_resource_limit_;  ///< resource limit per solver query
+  size_t reducer_query_time_limit_;  ///< time limit per reducer query in ms
+  unsigned int query_retries_;  ///< retries of an unknown bmc query
+  bool ic3bits_sat_;  ///< SAT-level IC3Bits on pure Boolean systems
+  size_t log_buffer_;  ///< bytes of log messages buffered before writing
+  bool log_async_;  ///< write the log buffer from a background thread
+  std::string log_components_;  ///< name=level verbosities per component
+  size_t log_rate_limit_;  ///< log messages per second, 0 for no limit
+  std::string trace_file_;  ///< file to write the Chrome trace timeline to
+  unsigned int check_invar_threads_;  ///< clause-wise --check-invar solvers
+  bool compact_invar_;  ///< drop the lemmas not needed by the invariant
+  size_t compact_invar_time_limit_;  ///< time budget of compact_invar_ in ms
+  std::string checkpoint_;  ///< file to save the engine state to
+  size_t checkpoint_interval_;  ///< minimum seconds between checkpoints
+  bool resume_;  ///< restart from the checkpoint file
+  bool reset_presim_;  ///< start from the state after the reset sequence
+  bool fold_clock_;  ///< one transition per clock cycle if possible
+  std::string serve_;  ///< socket of the verification server
+  unsigned int serve_workers_;  ///< jobs run in parallel by the server
+  std::string result_cache_;  ///< directory of cached results
+  std::string engine_model_;  ///< decision model of --engine auto
+  unsigned int portfolio_size_;  ///< engines kept by --portfolio, 0 for all
+  unsigned int portfolio_cores_;  ///< engines running at once, 0 for all
+  size_t portfolio_slice_;  ///< time slice of the portfolio in ms
+  size_t soft_mem_limit_;   ///< memory in megabytes above which the
+                            ///< engines drop their caches
+  bool stats_only_;  ///< print the size of the design instead of checking it
+  bool ceg_localization_;  ///< CEGAR -- localization abstraction of latches
+  size_t ceg_localization_pba_;  ///< bound of the proof-based abstraction
+                                 ///< of the initial latches, 0 to disable
+  size_t bdd_node_limit_;  ///< live BDD nodes above which bdd gives up
+  Engine klive_engine_;    ///< IC3 variant for the safety checks of klive
+  bool decompose_prop_;    ///< check the conjuncts of the property apart
+  unsigned int decompose_threads_;  ///< conjuncts checked at once, 0 for all
+                                    ///< the cores
+  bool assume_proven_;  ///< assume the proven properties with --all-props
+  bool assume_proven_invars_;  ///< and their invariants
+  bool bmc_frame_lemmas_;  ///< bmc asserts the lemmas of the IC3 frames
+  Engine reverse_engine_;  ///< IC3 variant run backwards by ic3-rev
+  unsigned int ic3_inf_frame_period_;  ///< frames between IC3 checks for
+                                       ///< globally inductive lemmas
+  unsigned int ic3_lemma_gc_period_;  ///< frames between IC3 lemma
+                                      ///< garbage collections
+  bool bmc_cone_slice_;  ///< bmc asserts only the cone of bad per frame
+  bool flatten_arrays_;  ///< expand small arrays into their elements
+  unsigned int flatten_arrays_width_;  ///< largest index width expanded
+  unsigned int bmc_init_constants_;  ///< time steps where bmc replaces the
+                                     ///< state variables with known values
+  bool ceg_width_reduction_;  ///< CEGAR -- datapath width reduction
 
  private:
   // Default options
@@ -266,6 +528,107 @@ class PonoOptions
   static const size_t default_ic3sa_initial_terms_lvl_ = 4;
   static const bool default_ic3sa_interp_ = false;
   static const bool default_print_wall_time_ = false;
+  static const bool default_portfolio_ = false;
+  static const bool default_all_props_ = false;
+  static const unsigned int default_time_limit_ = 0;
+  static const size_t default_solver_call_limit_ = 0;
+  static const size_t default_mem_limit_ = 0;
+  static const size_t default_query_time_limit_ = 0;
+  static const bool default_share_lemmas_ = false;
+  static const bool default_bmc_assumptions_ = false;
+  static const unsigned int default_bmc_step_size_ = 1;
+  static const unsigned int default_bmc_threads_ = 0;
+  static const bool default_ic3_rel_ind_assumptions_ = false;
+  static const unsigned int default_ic3_act_lit_reset_ = 10000;
+  static const bool default_ic3_frame_solvers_ = false;
+  static const unsigned int default_ic3_prop_threads_ = 1;
+  static const unsigned int default_ic3_block_threads_ = 1;
+  static const bool default_ic3_ctg_ = false;
+  static const unsigned int default_ic3_ctg_max_depth_ = 1;
+  static const unsigned int default_ic3_ctg_max_ctgs_ = 3;
+  static const bool default_ic3_ternary_sim_ = false;
+  static const unsigned int default_ic3_reset_dead_ratio_ = 0;
+  static const bool default_kind_fingerprint_ = false;
+  static const bool default_kind_dual_solver_ = false;
+  static const unsigned int default_sim_traces_ = 1000;
+  static const unsigned int default_sim_lanes_ = 1;
+  static const bool default_latch_sweep_ = false;
+  static const bool default_mine_invariants_ = false;
+  static const unsigned int default_mine_threads_ = 1;
+  static const bool default_simplify_ = false;
+  static const unsigned int default_bmc_unroll_window_ = 0;
+  static const unsigned int default_ic3sa_func_unroll_limit_ = 0;
+  static const bool default_ic3_partition_trans_ = false;
+  static const bool default_btor2_prop_cone_ = false;
+  static const bool default_witness_inputs_only_ = false;
+  static const int default_witness_first_step_ = 0;
+  static const int default_witness_last_step_ = -1;
+  static const bool default_minimize_cex_ = false;
+  static const bool default_cegp_incremental_axioms_ = false;
+  static const size_t default_cegar_core_min_time_ = 0;
+  static const unsigned int default_cegar_refine_threads_ = 1;
+  static const bool default_cegar_share_refinements_ = false;
+  static const size_t default_ceg_bv_arith_min_cost_ = 0;
+  static const size_t default_ceg_bv_arith_max_refine_ = 0;
+  static const bool default_ic3ia_refine_portfolio_ = false;
+  static const bool default_msat_ic3ia_share_env_ = false;
+  static const bool default_ic3_lit_order_ = false;
+  static const bool default_ic3ia_lazy_pred_rels_ = false;
+  static const unsigned default_sygus_eval_cache_limit_ = 1 << 20;
+  static const size_t default_query_resource_limit_ = 0;
+  static const size_t default_reducer_query_time_limit_ = 0;
+  static const unsigned int default_query_retries_ = 0;
+  static const bool default_ic3bits_sat_ = false;
+  static const size_t default_log_buffer_ = 0;
+  static const bool default_log_async_ = false;
+  static const size_t default_log_rate_limit_ = 0;
+  static const size_t default_metrics_interval_ = 10;
+  static const bool default_deterministic_ = false;
+  static const unsigned int default_threads_ = 0;
+  static const bool default_pin_threads_ = false;
+  static const bool default_numa_ = false;
+  static const bool default_pre_check_ = false;
+  static const size_t default_pre_check_cycles_ = 4096;
+  static const bool default_interp_reuse_ = false;
+  static const unsigned int default_ic3_bad_batch_ = 1;
+  static const bool default_fraig_ = false;
+  static const bool default_check_witness_ = false;
+  static const size_t default_bmc_sim_guide_ = 0;
+  static const size_t default_cube_vars_ = 4;
+  static const unsigned int default_cube_depth_ = 0;
+  static const size_t default_lemma_exchange_rate_ = 1000;
+  static const unsigned int default_sim_threads_ = 1;
+  static const size_t default_witness_queue_ = 4;
+  static const unsigned int default_check_invar_threads_ = 0;
+  static const bool default_compact_invar_ = false;
+  static const size_t default_compact_invar_time_limit_ = 10000;
+  static const size_t default_checkpoint_interval_ = 600;
+  static const bool default_resume_ = false;
+  static const bool default_reset_presim_ = false;
+  static const bool default_fold_clock_ = false;
+  static const unsigned int default_serve_workers_ = 0;
+  static const unsigned int default_portfolio_size_ = 0;
+  static const unsigned int default_portfolio_cores_ = 0;
+  static const size_t default_portfolio_slice_ = 1000;
+  static const size_t default_soft_mem_limit_ = 0;
+  static const bool default_stats_only_ = false;
+  static const bool default_ceg_localization_ = false;
+  static const size_t default_ceg_localization_pba_ = 0;
+  static const size_t default_bdd_node_limit_ = 2000000;
+  static const Engine default_klive_engine_ = MBIC3;
+  static const bool default_decompose_prop_ = false;
+  static const unsigned int default_decompose_threads_ = 0;
+  static const bool default_assume_proven_ = false;
+  static const bool default_assume_proven_invars_ = false;
+  static const bool default_bmc_frame_lemmas_ = false;
+  static const Engine default_reverse_engine_ = MBIC3;
+  static const unsigned int default_ic3_inf_frame_period_ = 0;
+  static const unsigned int default_ic3_lemma_gc_period_ = 0;
+  static const bool default_bmc_cone_slice_ = false;
+  static const bool default_flatten_arrays_ = false;
+  static const unsigned int default_flatten_arrays_width_ = 5;
+  static const unsigned int default_bmc_init_constants_ = 0;
+  static const bool default_ceg_width_reduction_ = false;
 };
 
 // Useful functions for printing etc...
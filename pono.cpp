@@ -14,9 +14,15 @@
 **
 **/
 
+#include <algorithm>
 #include <csignal>
+#include <functional>
 #include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
 #include "assert.h"
+#include <pthread.h>
 
 #ifdef WITH_PROFILING
 #include <gperftools/profiler.h>
@@ -28,33 +34,81 @@
 #endif
 
 #include "core/fts.h"
+#include "core/rts.h"
+#include "frontends/aiger_encoder.h"
 #include "frontends/btor2_encoder.h"
 #include "frontends/smv_encoder.h"
 #include "frontends/vmt_encoder.h"
+#include "modifiers/array_flattener.h"
+#include "modifiers/constant_propagation.h"
 #include "modifiers/control_signals.h"
+#include "modifiers/fraig.h"
+#include "modifiers/latch_sweep.h"
 #include "modifiers/mod_ts_prop.h"
 #include "modifiers/prop_monitor.h"
 #include "modifiers/static_coi.h"
 #include "options/options.h"
+#include "printers/aiger_witness_printer.h"
+#include "printers/btor2_printer.h"
 #include "printers/btor2_witness_printer.h"
-#include "printers/vcd_witness_printer.h"
+#include "printers/vcd_stream_writer.h"
+#include "printers/vmt_printer.h"
+#include "printers/witness_writer.h"
 #include "smt-switch/logging_solver.h"
+#include "smt-switch/utils.h"
 #include "smt/available_solvers.h"
+#include "smt/solver_profiles.h"
+#include "utils/cex_minimizer.h"
+#include "utils/cube_and_conquer.h"
+#include "utils/design_stats.h"
+#include "utils/engine_selector.h"
+#include "utils/event_stream.h"
+#include "utils/incremental_coi.h"
+#include "utils/invariant_miner.h"
+#include "utils/lemma_cache.h"
 #include "utils/logger.h"
 #include "utils/timestamp.h"
 #include "utils/make_provers.h"
+#include "utils/portfolio.h"
+#include "utils/pre_check.h"
+#include "utils/refinement_cache.h"
+#include "utils/solver_trace.h"
+#include "utils/memory_profile.h"
+#include "utils/timeline.h"
+#include "utils/statistics.h"
 #include "utils/ts_analysis.h"
+#include "utils/ts_snapshot.h"
+#include "utils/verification_server.h"
 
 using namespace pono;
 using namespace smt;
 using namespace std;
 
-ProverResult check_prop(PonoOptions pono_options,
-                        Term & prop,
-                        TransitionSystem & ts,
-                        const SmtSolver & s,
-                        std::vector<UnorderedTermMap> & cex)
+/** @return the options that are part of the key of the result cache */
+static string result_cache_options(const PonoOptions & pono_options)
 {
+  return "engine=" + to_string(pono_options.engine_)
+         + " bound=" + std::to_string(pono_options.bound_);
+}
+
+ProverResult check_prop(
+    PonoOptions pono_options,
+    Term & prop,
+    TransitionSystem & ts,
+    const SmtSolver & s,
+    std::vector<UnorderedTermMap> & cex,
+    const std::shared_ptr<RefinementCache> & refinements = nullptr,
+    Term * proven_invar = nullptr,
+    bool * bounded = nullptr)
+{
+  TIMELINE_SPAN("check_prop");
+  if (bounded) {
+    *bounded = false;
+  }
+  if (pono_options.engine_ == KLIVE) {
+    throw PonoException(
+        "The klive engine checks the justice properties of BTOR2 files");
+  }
   // get property name before it is rewritten
   const string prop_name = ts.get_name(prop);
 
@@ -65,7 +119,9 @@ ProverResult check_prop(PonoOptions pono_options,
   // modify the transition system and property based on options
   if (!pono_options.clock_name_.empty()) {
     Term clock_symbol = ts.lookup(pono_options.clock_name_);
-    toggle_clock(ts, clock_symbol);
+    if (!pono_options.fold_clock_ || !fold_clock(ts, clock_symbol, { prop })) {
+      toggle_clock(ts, clock_symbol);
+    }
   }
   if (!pono_options.reset_name_.empty()) {
     std::string reset_name = pono_options.reset_name_;
@@ -77,22 +133,206 @@ ProverResult check_prop(PonoOptions pono_options,
     Term reset_symbol = ts.lookup(reset_name);
     if (negative_reset) {
       SortKind sk = reset_symbol->get_sort()->get_sort_kind();
-      reset_symbol = (sk == BV) ? s->make_term(BVNot, reset_symbol)
-                                : s->make_term(Not, reset_symbol);
+      reset_symbol = (sk == BV) ? ts.make_term(BVNot, reset_symbol)
+                                : ts.make_term(Not, reset_symbol);
+    }
+    if (!pono_options.reset_presim_
+        || !presimulate_reset(ts, reset_symbol, pono_options.reset_bnd_)) {
+      Term reset_done =
+          add_reset_seq(ts, reset_symbol, pono_options.reset_bnd_);
+      // guard the property with reset_done
+      prop = ts.solver()->make_term(Implies, reset_done, prop);
     }
-    Term reset_done = add_reset_seq(ts, reset_symbol, pono_options.reset_bnd_);
-    // guard the property with reset_done
-    prop = ts.solver()->make_term(Implies, reset_done, prop);
   }
 
 
+  if (pono_options.simplify_) {
+    ConstantPropagation cp(ts);
+    prop = cp.rewrite(prop);
+  }
+
+  if (pono_options.latch_sweep_) {
+    LatchSweep sweep(ts);
+    prop = sweep.rewrite(prop);
+  }
+
+  if (pono_options.fraig_) {
+    TIMELINE_SPAN("fraig");
+    Fraig fraig(ts);
+    prop = fraig.rewrite(prop);
+  }
+
   if (pono_options.static_coi_) {
     /* Compute the set of state/input variables related to the
        bad-state property. Based on that information, rebuild the
        transition relation of the transition system. */
+    TIMELINE_SPAN("static_coi");
+    MEMORY_PHASE("static_coi");
     StaticConeOfInfluence coi(ts, { prop }, pono_options.verbosity_);
   }
 
+  if (pono_options.pre_check_) {
+    // trivial properties don't pay for the engine setup
+    MEMORY_PHASE("pre_check");
+    PreCheckResult pc = pre_check(ts, prop, pono_options);
+    if (pc.result != pono::UNKNOWN) {
+      logger.log(0,
+                 "Pre-check: property {} is {} by {}",
+                 prop_name,
+                 to_string(pc.result),
+                 pc.stage);
+      if (pc.result == FALSE && pono_options.witness_) {
+        cex = pc.cex;
+      }
+      logger.flush();
+      return pc.result;
+    }
+  }
+
+  if (!pono_options.cube_servers_.empty()) {
+    MEMORY_PHASE("cube_and_conquer");
+    vector<unique_ptr<CubeServer>> servers;
+    istringstream sockets(pono_options.cube_servers_);
+    string socket;
+    while (getline(sockets, socket, ',')) {
+      servers.emplace_back(new SocketCubeServer(socket));
+    }
+    CubeAndConquerResult cc =
+        cube_and_conquer(ts, prop, pono_options, servers);
+    logger.log(0,
+               "Cube-and-conquer: {} of {} cubes unsat, {} undecided",
+               cc.num_unsat,
+               cc.num_cubes,
+               cc.num_unknown);
+    if (cc.result == FALSE) {
+      logger.log(0, "Cube-and-conquer: counterexample in cube {}", cc.cube);
+      if (pono_options.witness_) {
+        cex = cc.cex;
+      }
+    }
+    logger.flush();
+    return cc.result;
+  }
+
+  // the prover gets its own solver if --engine auto picks another one
+  SmtSolver prover_solver = s;
+  std::vector<Engine> portfolio_engines = default_portfolio_engines();
+  if (pono_options.engine_ == AUTO || pono_options.portfolio_size_) {
+    TIMELINE_SPAN("select_engine");
+    EngineSelector selector;
+    if (!pono_options.engine_model_.empty()) {
+      selector.load_model(pono_options.engine_model_);
+    }
+    TsFeatures features = extract_features(ts, prop);
+    logger.log(1, "Features: {}", features.to_string());
+
+    if (pono_options.portfolio_) {
+      portfolio_engines = selector.rank_portfolio(
+          features, portfolio_engines, pono_options.portfolio_size_);
+      logger.log(1, "Portfolio: running {} engines", portfolio_engines.size());
+    } else if (pono_options.engine_ == AUTO) {
+      EngineChoice choice = selector.select(features);
+      logger.log(0,
+                 "Auto: picked engine {} with solver {} by rule \"{}\"",
+                 to_string(choice.engine),
+                 smt::to_string(choice.solver),
+                 choice.rule);
+      pono_options.engine_ = choice.engine;
+      pono_options.smt_solver_ = choice.solver;
+      if (choice.options.size()
+          && pono_options.parse_and_set_options(choice.options, false)
+                 == ERROR) {
+        throw PonoException("Invalid options in the engine rule "
+                            + choice.rule);
+      }
+      prover_solver = create_solver_for(pono_options.smt_solver_,
+                                        pono_options.engine_,
+                                        false,
+                                        pono_options.ceg_prophecy_arrays_);
+      if (pono_options.logging_smt_solver_) {
+        prover_solver = make_shared<LoggingSolver>(prover_solver);
+      }
+    }
+  }
+
+  // the result cache is keyed by the system at this point, the later
+  // modifications only help the engines
+  std::unique_ptr<TransitionSystem> cache_ts;
+  Term cache_prop;
+  if (!pono_options.result_cache_.empty()) {
+    TIMELINE_SPAN("result_cache");
+    cache_ts.reset(new TransitionSystem(ts));
+    cache_prop = prop;
+    CachedResult cached;
+    if (read_result_cache(pono_options.result_cache_,
+                          ts,
+                          prop,
+                          result_cache_options(pono_options),
+                          cached)) {
+      // a result is only reused with its proof: an invariant that is
+      // checked again, or a witness that is replayed by simulation
+      bool valid = false;
+      if (cached.result == TRUE) {
+        valid = cached.invar && check_invar(ts, prop, cached.invar);
+      } else if (cached.result == FALSE && cached.cex.size()) {
+        WitnessCheckResult wcr = check_witness(ts, prop, cached.cex);
+        valid = wcr.supported && wcr.valid;
+      }
+      if (valid) {
+        logger.log(0,
+                   "Result cache: property {} is {}",
+                   prop_name,
+                   to_string(cached.result));
+        if (cached.result == FALSE && pono_options.witness_) {
+          cex = cached.cex;
+        } else if (cached.invar && pono_options.show_invar_) {
+          logger.log(0, "INVAR: {}", cached.invar);
+        }
+        if (proven_invar && cached.result == TRUE) {
+          *proven_invar = cached.invar;
+        }
+        logger.flush();
+        return cached.result;
+      }
+      logger.log(
+          1, "Result cache: unverified entry for property {}", prop_name);
+    }
+  }
+
+  if (pono_options.mine_invariants_) {
+    // after COI, otherwise the constraints keep all their variables
+    InvariantMiner miner(ts, pono_options.mine_threads_);
+    for (const auto & inv : miner.prune(miner.mine())) {
+      ts.add_invar(inv);
+    }
+  }
+
+  if (!pono_options.migrate_lemmas_.empty()) {
+    // also after COI, the clauses over removed variables are dropped
+    TermVec invars = migrate_invariants(
+        ts, pono_options.migrate_lemmas_, pono_options.mine_threads_);
+    for (const auto & inv : invars) {
+      ts.add_invar(inv);
+    }
+    logger.log(1, "Migrated {} invariants", invars.size());
+  }
+
+  if (!pono_options.save_snapshot_.empty()) {
+    // e.g. to skip parsing and preprocessing in the next runs
+    write_ts_snapshot(pono_options.save_snapshot_, ts, { prop });
+    logger.log(1, "Saved snapshot: {}", pono_options.save_snapshot_);
+  }
+
+  if (!pono_options.export_btor2_.empty()) {
+    write_btor2_file(pono_options.export_btor2_, ts, { prop });
+    logger.log(1, "Exported BTOR2: {}", pono_options.export_btor2_);
+  }
+
+  if (!pono_options.export_vmt_.empty()) {
+    write_vmt_file(pono_options.export_vmt_, ts, { prop });
+    logger.log(1, "Exported VMT: {}", pono_options.export_vmt_);
+  }
+
   if (pono_options.pseudo_init_prop_) {
     ts = pseudo_init_and_prop(ts, prop);
   }
@@ -116,48 +356,153 @@ ProverResult check_prop(PonoOptions pono_options,
     prop_in_trans(ts, prop);
   }
 
-  Property p(s, prop, prop_name);
+  // the engines check the system with the small arrays expanded, ts is
+  // restored before returning and the witness shows the arrays
+  std::unique_ptr<TransitionSystem> array_ts;
+  std::unique_ptr<ArrayFlattener> flattener;
+  if (pono_options.flatten_arrays_) {
+    TIMELINE_SPAN("flatten_arrays");
+    array_ts.reset(new TransitionSystem(ts));
+    flattener.reset(
+        new ArrayFlattener(ts, pono_options.flatten_arrays_width_));
+    if (flattener->flattened()) {
+      prop = flattener->rewrite(prop);
+    } else {
+      flattener.reset();
+      array_ts.reset();
+    }
+  }
+
+  Property p(ts.solver(), prop, prop_name);
 
   // end modification of the transition system and property
 
   Engine eng = pono_options.engine_;
 
   std::shared_ptr<Prover> prover;
-  if (pono_options.cegp_abs_vals_) {
-    prover = make_cegar_values_prover(eng, p, ts, s, pono_options);
+  ProverResult r;
+  if (pono_options.portfolio_) {
+    MEMORY_PHASE("portfolio");
+    PortfolioResult pr = run_portfolio(portfolio_engines,
+                                       p,
+                                       ts,
+                                       pono_options.bound_,
+                                       pono_options);
+    if (!pr.prover) {
+      if (array_ts) {
+        ts = *array_ts;
+      }
+      return ProverResult::UNKNOWN;
+    }
+    logger.log(0, "Portfolio: decided by engine {}", to_string(pr.engine));
+    prover = pr.prover;
+    r = pr.result;
+    pono_options.engine_ = pr.engine;
+  } else if (pono_options.decompose_prop_) {
+    prover = make_decomposed_prover(eng, p, ts, prover_solver, pono_options);
+  } else if (pono_options.cegp_abs_vals_) {
+    prover = make_cegar_values_prover(eng, p, ts, prover_solver, pono_options);
   } else if (pono_options.ceg_bv_arith_) {
-    prover = make_cegar_bv_arith_prover(eng, p, ts, s, pono_options);
+    prover =
+        make_cegar_bv_arith_prover(eng, p, ts, prover_solver, pono_options);
+  } else if (pono_options.ceg_localization_) {
+    prover = make_cegar_localization_prover(
+        eng, p, ts, prover_solver, pono_options);
+  } else if (pono_options.ceg_width_reduction_) {
+    prover = make_cegar_width_reduction_prover(
+        eng, p, ts, prover_solver, pono_options);
   } else if (pono_options.ceg_prophecy_arrays_) {
-    prover = make_ceg_proph_prover(eng, p, ts, s, pono_options);
+    prover = make_ceg_proph_prover(eng, p, ts, prover_solver, pono_options);
   } else {
-    prover = make_prover(eng, p, ts, s, pono_options);
+    prover = make_prover(eng, p, ts, prover_solver, pono_options);
   }
   assert(prover);
+  if (refinements && !pono_options.portfolio_) {
+    prover->set_refinement_cache(refinements);
+  }
 
   // TODO: handle this in a more elegant way in the future
   //       consider calling prover for CegProphecyArrays (so that underlying
   //       model checker runs prove unbounded) or possibly, have a command line
   //       flag to pick between the two
-  ProverResult r;
-  if (pono_options.engine_ == MSAT_IC3IA)
-  {
+  if (pono_options.portfolio_) {
+    // already ran to completion in run_portfolio
+  } else if (pono_options.engine_ == MSAT_IC3IA) {
     // HACK MSAT_IC3IA does not support check_until
+    TIMELINE_SPAN("prove");
+    MEMORY_PHASE("prove");
     r = prover->prove();
-  }
-  else
-  {
+  } else {
+    TIMELINE_SPAN("prove");
+    MEMORY_PHASE("prove");
     r = prover->check_until(pono_options.bound_);
   }
 
-  if (r == FALSE && pono_options.witness_) {
-    bool success = prover->witness(cex);
+  if (bounded && r == pono::UNKNOWN && !pono_options.portfolio_
+      && pono_options.engine_ != MSAT_IC3IA) {
+    // not stopped early, so all the bounds up to -k were checked
+    *bounded = !prover->interrupted();
+  }
+
+  if (r == pono::UNKNOWN && prover->budget().cancelled()) {
+    logger.log(0,
+               "Engine stopped: {} after {} solver calls and {}s",
+               prover->budget().reason(),
+               prover->budget().num_solver_calls(),
+               prover->budget().elapsed_seconds());
+  }
+
+  // the witnesses of the abstraction refinement engines and the portfolio
+  // (which may be decided by one) are always checked
+  bool validate_cex = pono_options.check_witness_ || pono_options.portfolio_
+                      || pono_options.cegp_abs_vals_
+                      || pono_options.ceg_bv_arith_
+                      || pono_options.ceg_localization_
+                      || pono_options.ceg_width_reduction_
+                      || pono_options.ceg_prophecy_arrays_
+                      || pono_options.engine_ == IC3IA_ENGINE;
+  // the result cache keeps the witness, so that a cached FALSE result
+  // can be replayed
+  bool cache_cex = !pono_options.result_cache_.empty();
+  vector<UnorderedTermMap> lifted_cex;
+  if (r == FALSE && (pono_options.witness_ || validate_cex || cache_cex)) {
+    vector<UnorderedTermMap> trace;
+    bool success = prover->witness(trace);
     if (!success) {
       logger.log(
           0,
           "Only got a partial witness from engine. Not suitable for printing.");
+    } else if (pono_options.witness_ && pono_options.minimize_cex_) {
+      CexMinimizer minimizer(ts, p.prop());
+      trace = minimizer.minimize(trace);
+    }
+    if (success && validate_cex) {
+      TIMELINE_SPAN("check_witness");
+      WitnessCheckResult wcr = check_witness(ts, p.prop(), trace);
+      if (!wcr.passed()) {
+        std::cout << "Witness Check FAILED" << std::endl;
+        // shouldn't return false with an invalid counterexample
+        throw PonoException("Witness Check FAILED at step "
+                            + std::to_string(wcr.step) + ": " + wcr.reason);
+      }
+      logger.log(1,
+                 "Witness Check {}",
+                 wcr.supported ? "PASSED" : "skipped: " + wcr.reason);
+    }
+    if (pono_options.witness_ || (success && cache_cex)) {
+      lifted_cex = trace;
+      if (flattener) {
+        flattener->lift_witness(lifted_cex);
+      }
+    }
+    if (pono_options.witness_) {
+      cex = lifted_cex;
     }
   }
 
+  // write the buffered log messages of the engine before any result
+  logger.flush();
+
   Term invar;
   if (r == TRUE && (pono_options.show_invar_ || pono_options.check_invar_)) {
     try {
@@ -169,12 +514,37 @@ ProverResult check_prop(PonoOptions pono_options,
     }
   }
 
+  if (invar && pono_options.compact_invar_) {
+    TIMELINE_SPAN("compact_invar");
+    MEMORY_PHASE("compact_invar");
+    invar = compact_invar(
+        ts, p.prop(), invar, pono_options.compact_invar_time_limit_);
+  }
+
   if (r == TRUE && pono_options.show_invar_ && invar) {
     logger.log(0, "INVAR: {}", invar);
+    logger.flush();
   }
 
   if (r == TRUE && pono_options.check_invar_ && invar) {
-    bool invar_passes = check_invar(ts, p.prop(), invar);
+    TIMELINE_SPAN("check_invar");
+    MEMORY_PHASE("check_invar");
+    bool invar_passes;
+    if (pono_options.check_invar_threads_) {
+      InvarCheckResult icr = check_invar_clauses(
+          ts, p.prop(), invar, pono_options.check_invar_threads_);
+      invar_passes = icr.passed();
+      if (!icr.not_inductive.empty()) {
+        logger.log(0,
+                   "Invariant Check: {} conjuncts are not inductive, "
+                   "e.g. {}",
+                   icr.not_inductive.size(),
+                   icr.not_inductive[0]);
+        logger.flush();
+      }
+    } else {
+      invar_passes = check_invar(ts, p.prop(), invar);
+    }
     std::cout << "Invariant Check " << (invar_passes ? "PASSED" : "FAILED")
               << std::endl;
     if (!invar_passes) {
@@ -182,29 +552,477 @@ ProverResult check_prop(PonoOptions pono_options,
       throw PonoException("Invariant Check FAILED");
     }
   }
+
+  if (!pono_options.result_cache_.empty() && (r == TRUE || r == FALSE)) {
+    CachedResult res;
+    res.result = r;
+    res.cex = lifted_cex;
+    if (r == TRUE && !invar) {
+      try {
+        invar = prover->invar();
+      }
+      catch (PonoException & e) {
+        // cached without an invariant
+      }
+    }
+    res.invar = invar;
+    try {
+      write_result_cache(pono_options.result_cache_,
+                         *cache_ts,
+                         cache_prop,
+                         result_cache_options(pono_options),
+                         res);
+    }
+    catch (PonoException & e) {
+      logger.log(0, "Warning: {}", e.what());
+    }
+  }
+
+  if (proven_invar && r == TRUE) {
+    if (!invar) {
+      try {
+        invar = prover->invar();
+      }
+      catch (PonoException & e) {
+        // only the property can be assumed
+      }
+    }
+    // the invariant is over the expanded arrays, which are not in the
+    // restored system
+    *proven_invar = array_ts ? Term() : invar;
+  }
+  if (array_ts) {
+    ts = *array_ts;
+  }
   return r;
 }
 
-// Note: signal handlers are registered only when profiling is enabled.
-void profiling_sig_handler(int sig)
+/** Write a counterexample to a VCD file, one frame at a time
+ *  The value changes are written here, the VCD file by the writer.
+ */
+void write_vcd(const TransitionSystem & ts,
+               const std::vector<UnorderedTermMap> & cex,
+               const std::string & filename,
+               WitnessWriter & writer)
+{
+  VCDStreamWriter vcd(ts, filename);
+  for (const auto & frame : cex) {
+    vcd.add_frame(frame);
+  }
+  std::string header = vcd.close_body();
+  writer.post([filename, header]() {
+    VCDStreamWriter::write_file(filename, header);
+  });
+}
+
+/** Write the result of a property to the event stream (--json-events)
+ *  @param idx the index of the property
+ *  @param r its result
+ *  @param witness_len the number of steps of the printed witness, 0 if
+ *         there is none
+ *  @param vcd the VCD file the witness was written to, if any
+ */
+static void result_event(size_t idx,
+                         ProverResult r,
+                         size_t witness_len,
+                         const std::string & vcd = "")
+{
+  if (!event_stream.enabled()) {
+    return;
+  }
+  JsonEvent e("result");
+  e.add_int("property", idx).add_string(
+      "result", r == FALSE ? "sat" : (r == TRUE ? "unsat" : "unknown"));
+  if (witness_len) {
+    e.add_int("witness_length", witness_len).add_string("witness", "stdout");
+  }
+  if (!vcd.empty()) {
+    e.add_string("vcd", vcd);
+  }
+  // results are never dropped
+  event_stream.emit(e, false);
+}
+
+/** Print the result of a property and then write its event, after the
+ *  results and witnesses before it
+ *  @param writer the witness writer
+ *  @param text the result, with the witness if there is one
+ *  @param idx the index of the property
+ *  @param r its result
+ *  @param witness_len the number of steps of the witness, 0 if none
+ *  @param vcd the VCD file the witness is written to, if any
+ */
+static void publish_result(WitnessWriter & writer,
+                           std::string text,
+                           size_t idx,
+                           ProverResult r,
+                           size_t witness_len,
+                           const std::string & vcd = "")
+{
+  if (text.size()) {
+    writer.print(std::move(text));
+  }
+  writer.post(
+      [idx, r, witness_len, vcd]() { result_event(idx, r, witness_len, vcd); });
+}
+
+/** Print a witness over a relational system, one line per value */
+static void print_witness_values(const std::vector<UnorderedTermMap> & cex,
+                                 std::ostream & out)
+{
+  for (size_t t = 0; t < cex.size(); t++) {
+    out << "AT TIME " << t << "\n";
+    for (const auto & elem : cex[t]) {
+      out << "\t" << elem.first << " : " << elem.second << "\n";
+    }
+  }
+}
+
+typedef std::function<void(size_t,
+                           ProverResult,
+                           const TransitionSystem &,
+                           const std::vector<UnorderedTermMap> &)>
+    PropReporter;
+
+/** Checks every property in propvec while parsing the design only once
+ *  The property-independent modifications (clock, reset, promoting inputs)
+ *  are applied to ts once. Then each property is checked on a copy of ts
+ *  with a fresh solver for the prover, starting with the properties with
+ *  the smallest cone-of-influence. The cones are found in one dependency
+ *  graph of the system. Syntactically identical properties, and the
+ *  properties whose cones are the same up to renaming, are only checked
+ *  once (the witness is renamed).
+ *  With --assume-proven, the properties proven so far (and with
+ *  --assume-proven-invars their invariants) are invariant constraints of
+ *  the systems of the next ones. Each proof only assumes the properties
+ *  proven before it, so they hold in every reachable state and no
+ *  property is assumed in its own proof.
+ *  @param pono_options the options
+ *  @param propvec the properties to check
+ *  @param ts the parsed transition system (modified in place)
+ *  @param report called once per property, when it is checked
+ *  @return FALSE if any property is false, TRUE if all are true and
+ *          UNKNOWN otherwise
+ */
+ProverResult check_all_props(PonoOptions pono_options,
+                             const TermVec & propvec,
+                             TransitionSystem & ts,
+                             const PropReporter & report)
+{
+  logger.log(1, "Checking all {} properties", propvec.size());
+
+  Term reset_done;
+  if (!pono_options.clock_name_.empty()) {
+    Term clock_symbol = ts.lookup(pono_options.clock_name_);
+    if (!pono_options.fold_clock_ || !fold_clock(ts, clock_symbol, propvec)) {
+      toggle_clock(ts, clock_symbol);
+    }
+  }
+  if (!pono_options.reset_name_.empty()) {
+    std::string reset_name = pono_options.reset_name_;
+    bool negative_reset = false;
+    if (reset_name.at(0) == '~') {
+      reset_name = reset_name.substr(1, reset_name.length() - 1);
+      negative_reset = true;
+    }
+    Term reset_symbol = ts.lookup(reset_name);
+    if (negative_reset) {
+      SortKind sk = reset_symbol->get_sort()->get_sort_kind();
+      reset_symbol = (sk == BV) ? ts.make_term(BVNot, reset_symbol)
+                                : ts.make_term(Not, reset_symbol);
+    }
+    if (!pono_options.reset_presim_
+        || !presimulate_reset(ts, reset_symbol, pono_options.reset_bnd_)) {
+      reset_done = add_reset_seq(ts, reset_symbol, pono_options.reset_bnd_);
+    }
+  }
+  if (pono_options.promote_inputvars_) {
+    ts = promote_inputvars(ts);
+  }
+  // shared by all the properties
+  std::unique_ptr<ConstantPropagation> cp;
+  if (pono_options.simplify_) {
+    cp.reset(new ConstantPropagation(ts));
+  }
+  std::unique_ptr<LatchSweep> sweep;
+  if (pono_options.latch_sweep_) {
+    sweep.reset(new LatchSweep(ts));
+  }
+  std::unique_ptr<Fraig> fraig;
+  if (pono_options.fraig_) {
+    fraig.reset(new Fraig(ts));
+  }
+
+  // options for each property -- system-level modifications are done
+  PonoOptions prop_options = pono_options;
+  prop_options.clock_name_.clear();
+  prop_options.reset_name_.clear();
+  prop_options.promote_inputvars_ = false;
+  prop_options.simplify_ = false;
+  prop_options.latch_sweep_ = false;
+  prop_options.fraig_ = false;
+
+  // cone-of-influence from one dependency graph of the state updates
+  // only supported for functional systems, otherwise each property
+  // runs the regular static COI pass in check_prop
+  std::unique_ptr<IncrementalConeOfInfluence> coi;
+  if (pono_options.static_coi_ && ts.is_functional()) {
+    coi.reset(new IncrementalConeOfInfluence(ts));
+    prop_options.static_coi_ = false;
+  }
+
+  // the properties over the modified system
+  TermVec props;
+  props.reserve(propvec.size());
+  for (Term prop : propvec) {
+    if (reset_done) {
+      prop = ts.make_term(Implies, reset_done, prop);
+    }
+    if (cp) {
+      prop = cp->rewrite(prop);
+    }
+    if (sweep) {
+      prop = sweep->rewrite(prop);
+    }
+    if (fraig) {
+      prop = fraig->rewrite(prop);
+    }
+    props.push_back(prop);
+  }
+
+  // check the properties with the smallest cones first
+  std::vector<size_t> order(propvec.size());
+  for (size_t idx = 0; idx < order.size(); ++idx) {
+    order[idx] = idx;
+  }
+  if (coi) {
+    std::vector<size_t> cone_sizes;
+    cone_sizes.reserve(props.size());
+    for (size_t idx = 0; idx < props.size(); ++idx) {
+      cone_sizes.push_back(coi->cone_size({ props[idx] }));
+      logger.log(1,
+                 "Property {} has {} variables in its cone-of-influence",
+                 idx,
+                 cone_sizes.back());
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return cone_sizes[a] < cone_sizes[b];
+    });
+  }
+
+  // refinements learned by the CEGAR engines, in the solver of ts
+  std::shared_ptr<RefinementCache> refinements;
+  if (pono_options.cegar_share_refinements_) {
+    refinements = std::make_shared<RefinementCache>(ts.solver());
+  }
+
+  // results for syntactically identical properties
+  std::unordered_map<Term, size_t> first_idx;
+  // the cones checked so far by canonical hash, to check the properties
+  // with the same cone up to renaming (e.g. replicated lanes) only once
+  struct CheckedCone
+  {
+    size_t idx;
+    TransitionSystem ts;  ///< before assuming the proven properties
+    Term prop;
+    TermVec vars;  ///< in canonical order
+  };
+  std::unordered_map<uint64_t, std::vector<CheckedCone>> checked_cones;
+  std::vector<ProverResult> results(propvec.size(), pono::UNKNOWN);
+  std::vector<std::vector<UnorderedTermMap>> cexs(propvec.size());
+  // the system of each property is only kept until the last identical
+  // property reported with it, the engine and its solver are destroyed
+  // once check_prop returns -- only the results, the counterexamples and
+  // the cones above outlive a property
+  std::vector<std::shared_ptr<TransitionSystem>> prop_systems(propvec.size());
+  std::unordered_map<Term, size_t> num_reports;
+  for (const auto & p : propvec) {
+    ++num_reports[p];
+  }
+  auto release_system = [&](size_t idx, size_t first) {
+    if (idx != first) {
+      prop_systems[idx].reset();
+    }
+    if (!--num_reports.at(propvec[idx])) {
+      prop_systems[first].reset();
+    }
+  };
+
+  // proven properties and invariants, valid in every reachable state
+  TermVec proven;
+
+  bool any_false = false;
+  bool all_true = true;
+  for (size_t idx : order) {
+    auto it = first_idx.find(propvec[idx]);
+    if (it != first_idx.end()) {
+      size_t prev = it->second;
+      logger.log(1, "Property {} is identical to property {}", idx, prev);
+      results[idx] = results[prev];
+      cexs[idx] = cexs[prev];
+      prop_systems[idx] = prop_systems[prev];
+      logger.flush();
+      report(idx, results[idx], *prop_systems[idx], cexs[idx]);
+      release_system(idx, prev);
+      continue;
+    }
+    first_idx[propvec[idx]] = idx;
+
+    Term prop = props[idx];
+    if (coi) {
+      prop_systems[idx] =
+          std::make_shared<TransitionSystem>(coi->reduced_ts({ prop }));
+    } else {
+      prop_systems[idx] = std::make_shared<TransitionSystem>(ts);
+    }
+    TransitionSystem & prop_ts = *prop_systems[idx];
+
+    if (coi) {
+      TermVec vars;
+      uint64_t h = canonical_hash(prop_ts, prop, &vars);
+      std::vector<CheckedCone> & same_hash = checked_cones[h];
+      UnorderedTermMap renaming;
+      auto same = std::find_if(
+          same_hash.begin(), same_hash.end(), [&](const CheckedCone & cc) {
+            return same_up_to_renaming(
+                cc.ts, cc.prop, cc.vars, prop_ts, prop, vars, renaming);
+          });
+      if (same != same_hash.end()) {
+        size_t prev = same->idx;
+        logger.log(1,
+                   "Property {} has the same cone as property {} up to "
+                   "renaming",
+                   idx,
+                   prev);
+        results[idx] = results[prev];
+        // the named terms of the witness are renamed too, and the terms
+        // that are not in this system are dropped
+        const auto & named = prop_ts.named_terms();
+        UnorderedTermMap renamed;
+        for (const auto & step : cexs[prev]) {
+          cexs[idx].emplace_back();
+          for (const auto & elem : step) {
+            auto rit = renamed.find(elem.first);
+            if (rit == renamed.end()) {
+              Term t = prop_ts.solver()->substitute(elem.first, renaming);
+              auto nit = named.find(prop_ts.get_name(t));
+              bool keep = prop_ts.is_curr_var(t) || prop_ts.is_input_var(t)
+                          || (nit != named.end() && nit->second == t);
+              rit = renamed.emplace(elem.first, keep ? t : Term()).first;
+            }
+            if (rit->second) {
+              cexs[idx].back()[rit->second] = elem.second;
+            }
+          }
+        }
+        if (results[idx] == TRUE && pono_options.assume_proven_) {
+          proven.push_back(props[idx]);
+        }
+        logger.flush();
+        report(idx, results[idx], prop_ts, cexs[idx]);
+        release_system(idx, idx);
+        continue;
+      }
+      same_hash.push_back({ idx, prop_ts, prop, vars });
+    }
+
+    if (pono_options.assume_proven_ && proven.size()) {
+      size_t num_assumed = assume_invariants(prop_ts, proven);
+      logger.log(1,
+                 "Assuming {} proven invariants for property {}",
+                 num_assumed,
+                 idx);
+    }
+
+    // every prover gets its own solver so the unrollings don't clash
+    SmtSolver ps = create_solver_for(pono_options.smt_solver_,
+                                     pono_options.engine_,
+                                     false,
+                                     pono_options.ceg_prophecy_arrays_);
+    if (pono_options.logging_smt_solver_) {
+      ps = make_shared<LoggingSolver>(ps);
+    }
+
+    Term invar;
+    ProverResult r = check_prop(prop_options,
+                                prop,
+                                prop_ts,
+                                ps,
+                                cexs[idx],
+                                refinements,
+                                pono_options.assume_proven_invars_ ? &invar
+                                                                   : nullptr);
+    // we assume that a prover never returns 'ERROR'
+    assert(r != ERROR);
+    results[idx] = r;
+    if (r == TRUE && pono_options.assume_proven_) {
+      // prop may have been rewritten for the engine, e.g. with a monitor
+      proven.push_back(props[idx]);
+      if (invar) {
+        proven.push_back(invar);
+      }
+    }
+    report(idx, r, prop_ts, cexs[idx]);
+
+    ps.reset();
+    release_system(idx, idx);
+    release_memory("property");
+  }
+
+  for (const auto & r : results) {
+    any_false |= (r == FALSE);
+    all_true &= (r == TRUE);
+  }
+  if (any_false) {
+    return FALSE;
+  }
+  return all_true ? TRUE : pono::UNKNOWN;
+}
+
+// held by whoever writes the outputs at the end, so they are only written
+// once: at exit, or on a signal
+static std::mutex outputs_mutex;
+
+// Note: the signals are handled only when profiling or statistics are
+// enabled. They are blocked in all the threads and this thread waits for
+// them, so the outputs are written outside of a signal handler, which
+// could have interrupted a thread holding one of their locks.
+void profiling_signal_thread(sigset_t signals)
 {
+  int sig;
+  if (sigwait(&signals, &sig)) {
+    return;
+  }
   std::string signame;
   switch (sig) {
     case SIGINT: signame = "SIGINT"; break;
     case SIGTERM: signame = "SIGTERM"; break;
     case SIGALRM: signame = "SIGALRM"; break;
-    default:
-      throw PonoException(
-          "Caught unexpected signal"
-          "in profiling signal handler.");
+    default: return;
   }
+  // never released, the process ends below
+  outputs_mutex.lock();
   logger.log(0, "\n Signal {} received\n", signame);
+  logger.flush();
+  statistics_registry.dump();
+  statistics_registry.write_metrics();
+  solver_trace.dump();
+  timeline.dump();
+  if (event_stream.enabled()) {
+    event_stream.emit(JsonEvent("signal").add_string("signal", signame),
+                      false);
+    event_stream.close();
+  }
 #ifdef WITH_PROFILING
   ProfilerFlush();
   ProfilerStop();
 #endif
   // Switch back to default handling for signal 'sig' and raise it.
   signal(sig, SIG_DFL);
+  sigset_t raised;
+  sigemptyset(&raised);
+  sigaddset(&raised, sig);
+  pthread_sigmask(SIG_UNBLOCK, &raised, nullptr);
   raise(sig);
 }
 
@@ -221,16 +1039,62 @@ int main(int argc, char ** argv)
   // incompatible options were passed
   assert(res == pono::UNKNOWN);
 
+  // For profiling and statistics: handle common signals to abort program.
+  // This is necessary to gracefully stop profiling and write the
+  // statistics when, e.g., an external time limit is enforced to stop the
+  // program. Done before any other thread is started, the threads inherit
+  // the blocked signals.
+  if (!pono_options.profiling_log_filename_.empty()
+      || !pono_options.stats_json_.empty()
+      || !pono_options.metrics_file_.empty()
+      || !pono_options.solver_trace_.empty()
+      || !pono_options.trace_file_.empty()
+      || !pono_options.json_events_.empty()) {
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGALRM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    std::thread(profiling_signal_thread, signals).detach();
+  }
+
   // set logger verbosity -- can only be set once
   logger.set_verbosity(pono_options.verbosity_);
+  if (!pono_options.log_components_.empty()) {
+    Log::set_component_verbosities(pono_options.log_components_);
+  }
+  logger.set_buffer_size(pono_options.log_buffer_);
+  logger.set_async(pono_options.log_async_);
+  logger.set_rate_limit(pono_options.log_rate_limit_);
+
+  if (!pono_options.stats_json_.empty()) {
+    statistics_registry.set_output_file(pono_options.stats_json_);
+    memory_profile.enable();
+  }
+  if (!pono_options.metrics_file_.empty()) {
+    statistics_registry.set_metrics_file(pono_options.metrics_file_,
+                                         pono_options.metrics_interval_);
+  }
+  if (!pono_options.solver_trace_.empty()) {
+    solver_trace.set_output_file(pono_options.solver_trace_);
+  }
+  if (!pono_options.trace_file_.empty()) {
+    timeline.set_output_file(pono_options.trace_file_);
+  }
+  if (!pono_options.json_events_.empty()) {
+    if (!event_stream.set_output_file(pono_options.json_events_)) {
+      logger.log(0,
+                 "Warning: could not open the event stream {}",
+                 pono_options.json_events_);
+    }
+    JsonEvent start("start");
+    start.add_string("file", pono_options.filename_)
+        .add_string("engine", to_string(pono_options.engine_));
+    event_stream.emit(start, false);
+  }
 
-  // For profiling: set signal handlers for common signals to abort
-  // program.  This is necessary to gracefully stop profiling when,
-  // e.g., an external time limit is enforced to stop the program.
   if (!pono_options.profiling_log_filename_.empty()) {
-    signal(SIGINT, profiling_sig_handler);
-    signal(SIGTERM, profiling_sig_handler);
-    signal(SIGALRM, profiling_sig_handler);
 #ifdef WITH_PROFILING
     logger.log(
         0, "Profiling log filename: {}", pono_options.profiling_log_filename_);
@@ -238,9 +1102,18 @@ int main(int argc, char ** argv)
 #endif
   }
 
+  // prints the results, see --witness-queue
+  WitnessWriter witness_writer(pono_options.witness_queue_);
+  // set if an exception is caught
+  string error_msg;
 #ifdef NDEBUG
   try {
 #endif
+    if (!pono_options.solver_profiles_.empty()) {
+      load_solver_profiles(pono_options.solver_profiles_,
+                           pono_options.solver_profile_);
+    }
+
     // no logging by default
     // could create an option for logging solvers in the future
 
@@ -282,47 +1155,226 @@ int main(int argc, char ** argv)
     //       and also only create the transition system once
     string file_ext = pono_options.filename_.substr(
         pono_options.filename_.find_last_of(".") + 1);
-    if (file_ext == "btor2" || file_ext == "btor") {
+    if (!pono_options.serve_.empty()) {
+      // the jobs run the same pipeline as a single property
+      auto check = [](PonoOptions opts,
+                      Term & prop,
+                      TransitionSystem & ts,
+                      const SmtSolver & js,
+                      vector<UnorderedTermMap> & cex,
+                      bool & bounded) {
+        return check_prop(opts, prop, ts, js, cex, nullptr, nullptr, &bounded);
+      };
+      VerificationServer server(
+          pono_options, check, pono_options.serve_workers_);
+      server.serve(pono_options.serve_);
+      res = pono::UNKNOWN;
+    } else if (pono_options.stats_only_) {
+      unique_ptr<TransitionSystem> ts;
+      TermVec propvec;
+      if (file_ext == "btor2" || file_ext == "btor") {
+        ts.reset(new FunctionalTransitionSystem(s));
+        BTOR2Encoder btor_enc(
+            pono_options.filename_, *ts, pono_options.simplify_);
+        propvec = btor_enc.propvec();
+      } else if (file_ext == "aag" || file_ext == "aig") {
+        FunctionalTransitionSystem * fts = new FunctionalTransitionSystem(s);
+        ts.reset(fts);
+        AigerEncoder aiger_enc(pono_options.filename_, *fts);
+        propvec = aiger_enc.propvec();
+      } else if (file_ext == "smv") {
+        RelationalTransitionSystem * rts = new RelationalTransitionSystem(s);
+        ts.reset(rts);
+        SMVEncoder smv_enc(pono_options.filename_, *rts);
+        propvec = smv_enc.propvec();
+      } else if (file_ext == "vmt" || file_ext == "smt2") {
+        RelationalTransitionSystem * rts = new RelationalTransitionSystem(s);
+        ts.reset(rts);
+        VMTEncoder vmt_enc(pono_options.filename_, *rts);
+        propvec = vmt_enc.propvec();
+      } else {
+        throw PonoException("Unrecognized file extension " + file_ext
+                            + " for file " + pono_options.filename_);
+      }
+      DesignStats stats =
+          compute_design_stats(*ts, propvec, pono_options.static_coi_);
+      cout << stats.to_json() << endl;
+      res = pono::UNKNOWN;
+    } else if (pono_options.engine_ == KLIVE) {
+      if (file_ext != "btor2" && file_ext != "btor") {
+        throw PonoException(
+            "The klive engine checks the justice properties of BTOR2 files");
+      }
       logger.log(2, "Parsing BTOR2 file: {}", pono_options.filename_);
       FunctionalTransitionSystem fts(s);
-      BTOR2Encoder btor_enc(pono_options.filename_, fts);
+      BTOR2Encoder btor_enc(
+          pono_options.filename_, fts, pono_options.simplify_);
+      const vector<TermVec> & justicevec = btor_enc.justicevec();
+      if (pono_options.prop_idx_ >= justicevec.size()) {
+        throw PonoException(
+            "Justice property index " + to_string(pono_options.prop_idx_)
+            + " is greater than the number of justice properties in file "
+            + pono_options.filename_ + " (" + to_string(justicevec.size())
+            + ")");
+      }
+
+      // the fairness constraints have to hold infinitely often as well
+      TermVec conditions = justicevec[pono_options.prop_idx_];
+      const TermVec & fairvec = btor_enc.fairvec();
+      conditions.insert(conditions.end(), fairvec.begin(), fairvec.end());
+      Term accept = add_justice_monitor(fts, conditions);
+      Property p(s, s->make_term(Not, accept));
+
+      shared_ptr<Prover> prover =
+          make_prover(KLIVE, p, fts, s, pono_options);
+      {
+        TIMELINE_SPAN("prove");
+        MEMORY_PHASE("prove");
+        res = prover->check_until(pono_options.bound_);
+      }
+      logger.flush();
+
+      ostringstream out;
+      vector<UnorderedTermMap> cex;
+      if (res == FALSE) {
+        out << "sat\n";
+        out << "j" << pono_options.prop_idx_ << "\n";
+        if (pono_options.witness_ && prover->witness(cex)) {
+          // the last state is the first state of the loop
+          print_witness_btor(btor_enc, cex, fts, out);
+        }
+      } else {
+        out << (res == TRUE ? "unsat" : "unknown") << "\n";
+        out << "j" << pono_options.prop_idx_ << "\n";
+      }
+      publish_result(
+          witness_writer, out.str(), pono_options.prop_idx_, res, cex.size());
+    } else if (file_ext == "btor2" || file_ext == "btor") {
+      logger.log(2, "Parsing BTOR2 file: {}", pono_options.filename_);
+      FunctionalTransitionSystem fts(s);
+      int64_t cone_prop = -1;
+      if (pono_options.btor2_prop_cone_ && !pono_options.all_props_) {
+        cone_prop = pono_options.prop_idx_;
+      }
+      BTOR2Encoder btor_enc(
+          pono_options.filename_, fts, pono_options.simplify_, cone_prop);
       const TermVec & propvec = btor_enc.propvec();
       unsigned int num_props = propvec.size();
-      if (pono_options.prop_idx_ >= num_props) {
+      if (pono_options.all_props_) {
+        auto report = [&](size_t idx,
+                          ProverResult r,
+                          const TransitionSystem & prop_ts,
+                          const vector<UnorderedTermMap> & prop_cex) {
+          // printed while the next property is checked
+          ostringstream out;
+          if (r == FALSE) {
+            out << "sat\n";
+            out << "b" << idx << "\n";
+            if (prop_cex.size()) {
+              print_witness_btor(btor_enc, prop_cex, prop_ts, out);
+            }
+          } else {
+            out << (r == TRUE ? "unsat" : "unknown") << "\n";
+            out << "b" << idx << "\n";
+          }
+          publish_result(witness_writer, out.str(), idx, r, prop_cex.size());
+        };
+        res = check_all_props(pono_options, propvec, fts, report);
+      } else if (pono_options.prop_idx_ >= num_props) {
         throw PonoException(
             "Property index " + to_string(pono_options.prop_idx_)
             + " is greater than the number of properties in file "
             + pono_options.filename_ + " (" + to_string(num_props) + ")");
       }
 
-      Term prop = propvec[pono_options.prop_idx_];
-
       vector<UnorderedTermMap> cex;
-      res = check_prop(pono_options, prop, fts, s, cex);
-      // we assume that a prover never returns 'ERROR'
-      assert(res != ERROR);
+      if (!pono_options.all_props_) {
+        Term prop = propvec[pono_options.prop_idx_];
+        res = check_prop(pono_options, prop, fts, s, cex);
+        // we assume that a prover never returns 'ERROR'
+        assert(res != ERROR);
+      }
 
       // print btor output
-      if (res == FALSE) {
-        cout << "sat" << endl;
-        cout << "b" << pono_options.prop_idx_ << endl;
+      if (pono_options.all_props_) {
+        // already reported per property
+      } else if (res == FALSE) {
+        ostringstream out;
+        out << "sat\n";
+        out << "b" << pono_options.prop_idx_ << "\n";
         assert(pono_options.witness_ || !cex.size());
+        string vcd;
         if (cex.size()) {
-          print_witness_btor(btor_enc, cex, fts);
-          if (!pono_options.vcd_name_.empty()) {
-            VCDWitnessPrinter vcdprinter(fts, cex);
-            vcdprinter.dump_trace_to_file(pono_options.vcd_name_);
-          }
+          print_witness_btor(btor_enc, cex, fts, out);
+          vcd = pono_options.vcd_name_;
         }
+        // the event follows the VCD file
+        witness_writer.print(out.str());
+        if (!vcd.empty()) {
+          write_vcd(fts, cex, vcd, witness_writer);
+        }
+        publish_result(
+            witness_writer, "", pono_options.prop_idx_, res, cex.size(), vcd);
       } else if (res == TRUE) {
-        cout << "unsat" << endl;
-        cout << "b" << pono_options.prop_idx_ << endl;
+        publish_result(witness_writer,
+                       "unsat\nb" + to_string(pono_options.prop_idx_) + "\n",
+                       pono_options.prop_idx_,
+                       res,
+                       0);
       } else {
         assert(res == pono::UNKNOWN);
-        cout << "unknown" << endl;
-        cout << "b" << pono_options.prop_idx_ << endl;
+        publish_result(witness_writer,
+                       "unknown\nb" + to_string(pono_options.prop_idx_) + "\n",
+                       pono_options.prop_idx_,
+                       res,
+                       0);
       }
 
+    } else if (file_ext == "aag" || file_ext == "aig") {
+      logger.log(2, "Parsing AIGER file: {}", pono_options.filename_);
+      FunctionalTransitionSystem fts(s);
+      AigerEncoder aiger_enc(pono_options.filename_, fts);
+      const TermVec & propvec = aiger_enc.propvec();
+      unsigned int num_props = propvec.size();
+      auto report = [&](size_t idx,
+                        ProverResult r,
+                        const vector<UnorderedTermMap> & prop_cex) {
+        ostringstream out;
+        if (r == FALSE) {
+          out << "1\n";
+          out << "b" << idx << "\n";
+          print_witness_aiger(aiger_enc, prop_cex, out);
+        } else {
+          out << (r == TRUE ? "0" : "2") << "\n";
+          out << "b" << idx << "\n";
+        }
+        publish_result(witness_writer, out.str(), idx, r, prop_cex.size());
+      };
+
+      if (pono_options.all_props_) {
+        res = check_all_props(
+            pono_options,
+            propvec,
+            fts,
+            [&](size_t idx,
+                ProverResult r,
+                const TransitionSystem & prop_ts,
+                const vector<UnorderedTermMap> & prop_cex) {
+              report(idx, r, prop_cex);
+            });
+      } else if (pono_options.prop_idx_ >= num_props) {
+        throw PonoException(
+            "Property index " + to_string(pono_options.prop_idx_)
+            + " is greater than the number of properties in file "
+            + pono_options.filename_ + " (" + to_string(num_props) + ")");
+      } else {
+        vector<UnorderedTermMap> cex;
+        Term prop = propvec[pono_options.prop_idx_];
+        res = check_prop(pono_options, prop, fts, s, cex);
+        // we assume that a prover never returns 'ERROR'
+        assert(res != ERROR);
+        report(pono_options.prop_idx_, res, cex);
+      }
     } else if (file_ext == "smv" || file_ext == "vmt" || file_ext == "smt2") {
       logger.log(2, "Parsing SMV/VMT file: {}", pono_options.filename_);
       RelationalTransitionSystem rts(s);
@@ -336,71 +1388,164 @@ int main(int argc, char ** argv)
         propvec = vmt_enc.propvec();
       }
       unsigned int num_props = propvec.size();
-      if (pono_options.prop_idx_ >= num_props) {
+      if (pono_options.all_props_) {
+        auto report = [&](size_t idx,
+                          ProverResult r,
+                          const TransitionSystem & prop_ts,
+                          const vector<UnorderedTermMap> & prop_cex) {
+          logger.log(0, "Property {} is {}", idx, to_string(r));
+          ostringstream out;
+          out << "property " << idx << ": ";
+          if (r == FALSE) {
+            out << "sat\n";
+            print_witness_values(prop_cex, out);
+          } else {
+            out << (r == TRUE ? "unsat" : "unknown") << "\n";
+          }
+          publish_result(witness_writer, out.str(), idx, r, prop_cex.size());
+        };
+        res = check_all_props(pono_options, propvec, rts, report);
+      } else if (pono_options.prop_idx_ >= num_props) {
         throw PonoException(
             "Property index " + to_string(pono_options.prop_idx_)
             + " is greater than the number of properties in file "
             + pono_options.filename_ + " (" + to_string(num_props) + ")");
       }
 
-      Term prop = propvec[pono_options.prop_idx_];
-      // get property name before it is rewritten
-
       std::vector<UnorderedTermMap> cex;
-      res = check_prop(pono_options, prop, rts, s, cex);
-      // we assume that a prover never returns 'ERROR'
-      assert(res != ERROR);
+      if (!pono_options.all_props_) {
+        Term prop = propvec[pono_options.prop_idx_];
+        res = check_prop(pono_options, prop, rts, s, cex);
+        // we assume that a prover never returns 'ERROR'
+        assert(res != ERROR);
 
-      logger.log(
-          0, "Property {} is {}", pono_options.prop_idx_, to_string(res));
+        logger.log(
+            0, "Property {} is {}", pono_options.prop_idx_, to_string(res));
+      }
 
-      if (res == FALSE) {
-        cout << "sat" << endl;
+      if (pono_options.all_props_) {
+        // already reported per property
+      } else if (res == FALSE) {
+        ostringstream out;
+        out << "sat\n";
         assert(pono_options.witness_ || cex.size() == 0);
-        for (size_t t = 0; t < cex.size(); t++) {
-          cout << "AT TIME " << t << endl;
-          for (auto elem : cex[t]) {
-            cout << "\t" << elem.first << " : " << elem.second << endl;
-          }
-        }
+        print_witness_values(cex, out);
+        // the event follows the VCD file
+        witness_writer.print(out.str());
         assert(pono_options.witness_ || pono_options.vcd_name_.empty());
         if (!pono_options.vcd_name_.empty()) {
-          VCDWitnessPrinter vcdprinter(rts, cex);
-          vcdprinter.dump_trace_to_file(pono_options.vcd_name_);
+          write_vcd(rts, cex, pono_options.vcd_name_, witness_writer);
         }
+        publish_result(witness_writer,
+                       "",
+                       pono_options.prop_idx_,
+                       res,
+                       cex.size(),
+                       pono_options.vcd_name_);
       } else if (res == TRUE) {
-        cout << "unsat" << endl;
+        publish_result(
+            witness_writer, "unsat\n", pono_options.prop_idx_, res, 0);
       } else {
         assert(res == pono::UNKNOWN);
-        cout << "unknown" << endl;
+        publish_result(
+            witness_writer, "unknown\n", pono_options.prop_idx_, res, 0);
+      }
+    } else if (file_ext == "snap") {
+      logger.log(2, "Loading snapshot: {}", pono_options.filename_);
+      string data = read_ts_snapshot_file(pono_options.filename_);
+      unique_ptr<TransitionSystem> ts;
+      if (ts_snapshot_is_functional(data.data(), data.size())) {
+        ts.reset(new FunctionalTransitionSystem(s));
+      } else {
+        ts.reset(new RelationalTransitionSystem(s));
+      }
+      TermVec propvec;
+      {
+        TIMELINE_SPAN("load_snapshot");
+        load_ts_snapshot(data.data(), data.size(), *ts, propvec);
+      }
+      unsigned int num_props = propvec.size();
+
+      if (pono_options.all_props_) {
+        auto report = [&](size_t idx,
+                          ProverResult r,
+                          const TransitionSystem & prop_ts,
+                          const vector<UnorderedTermMap> & prop_cex) {
+          ostringstream out;
+          out << "property " << idx << ": ";
+          if (r == FALSE) {
+            out << "sat\n";
+            print_witness_values(prop_cex, out);
+          } else {
+            out << (r == TRUE ? "unsat" : "unknown") << "\n";
+          }
+          publish_result(witness_writer, out.str(), idx, r, prop_cex.size());
+        };
+        res = check_all_props(pono_options, propvec, *ts, report);
+      } else if (pono_options.prop_idx_ >= num_props) {
+        throw PonoException(
+            "Property index " + to_string(pono_options.prop_idx_)
+            + " is greater than the number of properties in file "
+            + pono_options.filename_ + " (" + to_string(num_props) + ")");
+      } else {
+        std::vector<UnorderedTermMap> cex;
+        Term prop = propvec[pono_options.prop_idx_];
+        res = check_prop(pono_options, prop, *ts, s, cex);
+        // we assume that a prover never returns 'ERROR'
+        assert(res != ERROR);
+
+        ostringstream out;
+        if (res == FALSE) {
+          out << "sat\n";
+          print_witness_values(cex, out);
+        } else if (res == TRUE) {
+          out << "unsat\n";
+        } else {
+          assert(res == pono::UNKNOWN);
+          out << "unknown\n";
+        }
+        publish_result(
+            witness_writer, out.str(), pono_options.prop_idx_, res, cex.size());
       }
     } else {
       throw PonoException("Unrecognized file extension " + file_ext
                           + " for file " + pono_options.filename_);
     }
+    witness_writer.flush();
 #ifdef NDEBUG
   }
   catch (PonoException & ce) {
+    witness_writer.wait();
+    logger.flush();
     cout << ce.what() << endl;
     cout << "error" << endl;
     cout << "b" << pono_options.prop_idx_ << endl;
     res = ProverResult::ERROR;
+    error_msg = ce.what();
   }
   catch (SmtException & se) {
+    witness_writer.wait();
+    logger.flush();
     cout << se.what() << endl;
     cout << "error" << endl;
     cout << "b" << pono_options.prop_idx_ << endl;
     res = ProverResult::ERROR;
+    error_msg = se.what();
   }
   catch (std::exception & e) {
+    witness_writer.wait();
+    logger.flush();
     cout << "Caught generic exception..." << endl;
     cout << e.what() << endl;
     cout << "error" << endl;
     cout << "b" << pono_options.prop_idx_ << endl;
     res = ProverResult::ERROR;
+    error_msg = e.what();
   }
 #endif
 
+  // not released, a later signal must not write the outputs again
+  outputs_mutex.lock();
   if (!pono_options.profiling_log_filename_.empty()) {
 #ifdef WITH_PROFILING
     ProfilerFlush();
@@ -408,6 +1553,34 @@ int main(int argc, char ** argv)
 #endif
   }
 
+  if (!statistics_registry.dump()) {
+    logger.log(0,
+               "Warning: could not write statistics to {}",
+               pono_options.stats_json_);
+  }
+  // with the final values of the statistics
+  statistics_registry.stop_metrics();
+  if (!solver_trace.dump()) {
+    logger.log(0,
+               "Warning: could not write the solver trace to {}",
+               pono_options.solver_trace_);
+  }
+  if (!timeline.dump()) {
+    logger.log(0,
+               "Warning: could not write the timeline to {}",
+               pono_options.trace_file_);
+  }
+  if (event_stream.enabled()) {
+    JsonEvent done("done");
+    done.add_string("result", to_string(res))
+        .add_int("dropped_events", event_stream.num_dropped());
+    if (!error_msg.empty()) {
+      done.add_string("error", error_msg);
+    }
+    event_stream.emit(done, false);
+    event_stream.close();
+  }
+
   if (pono_options.print_wall_time_) {
     auto end_time_stamp = timestamp();
     auto elapsed_time = timestamp_diff(begin_time_stamp, end_time_stamp);
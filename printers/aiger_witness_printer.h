@@ -0,0 +1,64 @@
+/*********************                                                        */
+/*! \file aiger_witness_printer.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Print a counterexample in the AIGER witness format: the initial
+**        values of the latches, then the values of the inputs of each
+**        frame, with 'x' for the values missing from the counterexample.
+**
+**/
+
+#pragma once
+
+#include <iostream>
+#include <vector>
+
+#include "frontends/aiger_encoder.h"
+#include "smt-switch/smt.h"
+#include "utils/timeline.h"
+
+namespace pono {
+
+inline char aiger_witness_value(const smt::UnorderedTermMap & frame,
+                                const smt::Term & var)
+{
+  if (!var) {
+    return 'x';
+  }
+  auto it = frame.find(var);
+  if (it == frame.end()) {
+    return 'x';
+  }
+  return it->second->to_string() == "true" ? '1' : '0';
+}
+
+/** Print the body of a witness, after the "1" and "b<idx>" lines */
+inline void print_witness_aiger(const AigerEncoder & aiger_enc,
+                                const std::vector<smt::UnorderedTermMap> & cex,
+                                std::ostream & out = std::cout)
+{
+  TIMELINE_SPAN("aiger_witness");
+  if (cex.empty()) {
+    return;
+  }
+  for (const auto & sv : aiger_enc.statesvec()) {
+    out << aiger_witness_value(cex[0], sv);
+  }
+  out << std::endl;
+  for (const auto & frame : cex) {
+    for (const auto & iv : aiger_enc.inputsvec()) {
+      out << aiger_witness_value(frame, iv);
+    }
+    out << std::endl;
+  }
+  out << "." << std::endl;
+}
+
+}  // namespace pono
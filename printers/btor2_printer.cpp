@@ -0,0 +1,409 @@
+/*********************                                                        */
+/*! \file btor2_printer.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Writes a functional transition system as BTOR2, e.g. to produce
+**        benchmarks from systems built with the TS API or to hand a
+**        preprocessed system to other tools.
+**
+**/
+
+#include "printers/btor2_printer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "printers/witness_values.h"
+#include "smt-switch/utils.h"
+#include "utils/exceptions.h"
+#include "utils/term_analysis.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+// the BTOR2 operators that map one to one (with one operator per node)
+static const unordered_map<PrimOp, string> btor2_ops({
+    { And, "and" },       { Or, "or" },         { Xor, "xor" },
+    { Not, "not" },       { Implies, "implies" }, { Equal, "eq" },
+    { Distinct, "neq" },  { Ite, "ite" },       { BVComp, "eq" },
+    { BVNot, "not" },     { BVNeg, "neg" },     { BVAnd, "and" },
+    { BVOr, "or" },       { BVXor, "xor" },     { BVNand, "nand" },
+    { BVNor, "nor" },     { BVXnor, "xnor" },   { BVAdd, "add" },
+    { BVSub, "sub" },     { BVMul, "mul" },     { BVUdiv, "udiv" },
+    { BVSdiv, "sdiv" },   { BVUrem, "urem" },   { BVSrem, "srem" },
+    { BVSmod, "smod" },   { BVShl, "sll" },     { BVLshr, "srl" },
+    { BVAshr, "sra" },    { BVUlt, "ult" },     { BVUle, "ulte" },
+    { BVUgt, "ugt" },     { BVUge, "ugte" },    { BVSlt, "slt" },
+    { BVSle, "slte" },    { BVSgt, "sgt" },     { BVSge, "sgte" },
+    { Concat, "concat" }, { Extract, "slice" }, { Zero_Extend, "uext" },
+    { Sign_Extend, "sext" }, { Select, "read" }, { Store, "write" } });
+
+// operators that can be folded if a solver gives them more than two
+// children
+static const unordered_set<PrimOp> associative_ops(
+    { And, Or, Xor, BVAnd, BVOr, BVXor, BVAdd, BVMul, Concat });
+
+/** @return the name of a variable without the quotes of SMT-LIB */
+static string btor2_name(const Term & var)
+{
+  string name = var->to_string();
+  if (name.size() > 1 && name.front() == '|' && name.back() == '|') {
+    name = name.substr(1, name.size() - 2);
+  }
+  return name;
+}
+
+/** @return the variables ordered by name, for a deterministic output */
+static TermVec sorted_vars(const UnorderedTermSet & vars)
+{
+  TermVec res(vars.begin(), vars.end());
+  sort(res.begin(), res.end(), [](const Term & a, const Term & b) {
+    return a->to_string() < b->to_string();
+  });
+  return res;
+}
+
+class Btor2Writer
+{
+ public:
+  Btor2Writer(ostream & out, const TransitionSystem & ts)
+      : out_(out), ts_(ts), next_id_(0)
+  {
+  }
+
+  void write(const TermVec & props)
+  {
+    for (const auto & v : sorted_vars(ts_.inputvars())) {
+      nodes_[v] = line("input " + id(sort_id(v->get_sort())) + " "
+                       + btor2_name(v));
+    }
+    TermVec states = sorted_vars(ts_.statevars());
+    for (const auto & v : states) {
+      nodes_[v] = line("state " + id(sort_id(v->get_sort())) + " "
+                       + btor2_name(v));
+    }
+
+    write_init();
+
+    const UnorderedTermMap & updates = ts_.state_updates();
+    for (const auto & v : states) {
+      auto it = updates.find(v);
+      if (it != updates.end()) {
+        size_t n = node(it->second);
+        line("next " + id(sort_id(v->get_sort())) + " " + id(nodes_.at(v))
+             + " " + id(n));
+      }
+    }
+
+    for (const auto & c : ts_.constraints()) {
+      line("constraint " + id(node(c.first)));
+    }
+
+    for (const auto & p : props) {
+      size_t n = node(p);
+      size_t bad = line("not " + id(bv_sort_id(1)) + " " + id(n));
+      line("bad " + id(bad));
+    }
+
+    write_outputs();
+  }
+
+ protected:
+  /** Writes the init lines of the states set to a value, and the other
+   *  conjuncts as a constraint of the first step
+   */
+  void write_init()
+  {
+    TermVec conjuncts;
+    conjunctive_partition(ts_.init(), conjuncts, false);
+    unordered_set<Term> initialized;
+    TermVec others;
+    for (const auto & c : conjuncts) {
+      if (c->is_value() && c->to_string() == "true") {
+        continue;
+      }
+
+      Term state, val;
+      if (ts_.is_curr_var(c) && !initialized.count(c)) {
+        // a boolean state, e.g. after a solver rewrote s = true
+        state = c;
+        val = ts_.solver()->make_term(true);
+      } else if (c->get_op() == Not) {
+        Term s = *c->begin();
+        if (ts_.is_curr_var(s) && !initialized.count(s)) {
+          state = s;
+          val = ts_.solver()->make_term(false);
+        }
+      } else if (c->get_op() == Equal) {
+        TermVec children;
+        for (const auto & cc : *c) {
+          children.push_back(cc);
+        }
+        if (children.size() == 2) {
+          for (size_t i = 0; i < 2 && !state; ++i) {
+            const Term & s = children[i];
+            const Term & v = children[1 - i];
+            if (ts_.is_curr_var(s) && !initialized.count(s)
+                && get_free_symbols(v).empty()) {
+              state = s;
+              val = v;
+            }
+          }
+        }
+      }
+
+      if (!state) {
+        others.push_back(c);
+        continue;
+      }
+      initialized.insert(state);
+      size_t n;
+      if (is_const_array(val)) {
+        // BTOR2 initializes an array with its constant element
+        n = node(*val->begin());
+      } else {
+        n = node(val);
+      }
+      line("init " + id(sort_id(state->get_sort())) + " "
+           + id(nodes_.at(state)) + " " + id(n));
+    }
+
+    if (others.empty()) {
+      return;
+    }
+    // a state that is only true in the first step
+    size_t bool_sid = bv_sort_id(1);
+    size_t first = line("state " + id(bool_sid) + " _init_");
+    size_t one = line("one " + id(bool_sid));
+    size_t zero = line("zero " + id(bool_sid));
+    line("init " + id(bool_sid) + " " + id(first) + " " + id(one));
+    line("next " + id(bool_sid) + " " + id(first) + " " + id(zero));
+    for (const auto & c : others) {
+      size_t n = node(c);
+      size_t guarded = line("implies " + id(bool_sid) + " " + id(first) + " "
+                            + id(n));
+      line("constraint " + id(guarded));
+    }
+  }
+
+  /** Writes the named terms as outputs with their names, except the
+   *  names of variables and the terms BTOR2 can't express
+   */
+  void write_outputs()
+  {
+    vector<pair<string, Term>> named(ts_.named_terms().begin(),
+                                     ts_.named_terms().end());
+    sort(named.begin(), named.end(), [](const auto & a, const auto & b) {
+      return a.first < b.first;
+    });
+    for (const auto & elem : named) {
+      const string & name = elem.first;
+      const Term & t = elem.second;
+      if ((t->is_symbol() && btor2_name(t) == name) || !ts_.only_curr(t)
+          || any_of(name.begin(), name.end(), [](char c) {
+               return isspace(static_cast<unsigned char>(c));
+             })) {
+        continue;
+      }
+      size_t n;
+      try {
+        n = node(t);
+      }
+      catch (PonoException & e) {
+        // the nodes written so far are complete, just not used
+        continue;
+      }
+      line("output " + id(n) + " " + name);
+    }
+  }
+
+  bool is_const_array(const Term & t) const
+  {
+    return t->get_sort()->get_sort_kind() == ARRAY && t->get_op().is_null()
+           && !t->is_symbol();
+  }
+
+  size_t bv_sort_id(uint64_t width)
+  {
+    auto it = bv_sorts_.find(width);
+    if (it != bv_sorts_.end()) {
+      return it->second;
+    }
+    size_t sid = line("sort bitvec " + std::to_string(width));
+    bv_sorts_[width] = sid;
+    return sid;
+  }
+
+  size_t sort_id(const Sort & sort)
+  {
+    SortKind sk = sort->get_sort_kind();
+    if (sk == BOOL) {
+      return bv_sort_id(1);
+    } else if (sk == BV) {
+      return bv_sort_id(sort->get_width());
+    } else if (sk == ARRAY) {
+      auto it = array_sorts_.find(sort);
+      if (it != array_sorts_.end()) {
+        return it->second;
+      }
+      size_t idx = sort_id(sort->get_indexsort());
+      size_t elem = sort_id(sort->get_elemsort());
+      size_t sid = line("sort array " + id(idx) + " " + id(elem));
+      array_sorts_[sort] = sid;
+      return sid;
+    }
+    throw PonoException("BTOR2 does not support the sort "
+                        + sort->to_string());
+  }
+
+  /** Writes the nodes of a term (children first) if not written yet
+   *  @return the node of the term
+   */
+  size_t node(const Term & t)
+  {
+    TermVec to_visit({ t });
+    while (to_visit.size()) {
+      Term cur = to_visit.back();
+      if (nodes_.find(cur) != nodes_.end()) {
+        to_visit.pop_back();
+        continue;
+      }
+
+      bool children_done = true;
+      for (const auto & c : *cur) {
+        if (nodes_.find(c) == nodes_.end()) {
+          to_visit.push_back(c);
+          children_done = false;
+        }
+      }
+      if (!children_done) {
+        continue;
+      }
+      to_visit.pop_back();
+      nodes_[cur] = write_node(cur);
+    }
+    return nodes_.at(t);
+  }
+
+  /** Writes one term, all its children are written */
+  size_t write_node(const Term & t)
+  {
+    Op op = t->get_op();
+    if (op.is_null()) {
+      if (t->is_symbol()) {
+        // the state and input variables are written first
+        throw PonoException("BTOR2 can only refer to current state and "
+                            "input variables, but got "
+                            + t->to_string());
+      } else if (is_const_array(t)) {
+        throw PonoException(
+            "BTOR2 only supports constant arrays to initialize states");
+      }
+      return line("const " + id(sort_id(t->get_sort())) + " "
+                  + value_bits(t));
+    }
+
+    auto it = btor2_ops.find(op.prim_op);
+    if (it == btor2_ops.end()) {
+      throw PonoException("BTOR2 does not support the operator "
+                          + op.to_string());
+    }
+    const string & name = it->second;
+
+    TermVec terms;
+    vector<size_t> children;
+    for (const auto & c : *t) {
+      terms.push_back(c);
+      children.push_back(nodes_.at(c));
+    }
+    size_t sid = sort_id(t->get_sort());
+
+    if (children.size() > 2 && associative_ops.count(op.prim_op)) {
+      // fold from the left, the intermediate nodes of a concat are
+      // narrower
+      size_t acc = children[0];
+      uint64_t width = op.prim_op == Concat ? terms[0]->get_sort()->get_width()
+                                            : 0;
+      for (size_t i = 1; i < children.size(); ++i) {
+        size_t isid = sid;
+        if (op.prim_op == Concat && i + 1 < children.size()) {
+          width += terms[i]->get_sort()->get_width();
+          isid = bv_sort_id(width);
+        }
+        acc = line(name + " " + id(isid) + " " + id(acc) + " "
+                   + id(children[i]));
+      }
+      return acc;
+    }
+
+    string s = name + " " + id(sid);
+    for (auto c : children) {
+      s += " " + id(c);
+    }
+    if ((op.prim_op == Equal || op.prim_op == Distinct)
+        && children.size() != 2) {
+      throw PonoException("BTOR2 only supports binary " + op.to_string());
+    }
+    for (size_t i = 0; i < op.num_idx; ++i) {
+      s += " " + std::to_string(i ? op.idx1 : op.idx0);
+    }
+    return line(s);
+  }
+
+  /** Writes a line with the next node id
+   *  @return the id
+   */
+  size_t line(const string & s)
+  {
+    out_ << ++next_id_ << " " << s << "\n";
+    return next_id_;
+  }
+
+  static string id(size_t n) { return std::to_string(n); }
+
+  ostream & out_;
+  const TransitionSystem & ts_;
+  size_t next_id_;
+  unordered_map<uint64_t, size_t> bv_sorts_;
+  unordered_map<Sort, size_t> array_sorts_;
+  unordered_map<Term, size_t> nodes_;
+};
+
+void write_btor2(ostream & out,
+                 const TransitionSystem & ts,
+                 const TermVec & props)
+{
+  if (!ts.is_functional()) {
+    throw PonoException("Only functional systems can be written as BTOR2");
+  }
+  Btor2Writer writer(out, ts);
+  writer.write(props);
+}
+
+void write_btor2_file(const string & filename,
+                      const TransitionSystem & ts,
+                      const TermVec & props)
+{
+  ofstream out(filename);
+  if (!out.is_open()) {
+    throw PonoException("Could not open " + filename);
+  }
+  write_btor2(out, ts, props);
+  if (!out) {
+    throw PonoException("Could not write " + filename);
+  }
+}
+
+}  // namespace pono
@@ -0,0 +1,53 @@
+/*********************                                                        */
+/*! \file btor2_printer.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Writes a functional transition system as BTOR2, e.g. to produce
+**        benchmarks from systems built with the TS API.
+**
+**        Booleans become bit-vectors of width 1. Conjuncts of init of the
+**        form state = value become init lines, the remaining ones are
+**        guarded by a fresh state that is only true in the first step.
+**        The properties become bad lines of their negation.
+**
+**/
+
+#pragma once
+
+#include <iostream>
+#include <string>
+
+#include "core/ts.h"
+#include "smt-switch/smt.h"
+
+namespace pono {
+
+/** Write a transition system as BTOR2
+ *  The variables keep their names, and the named terms are written as
+ *  outputs with their names (if BTOR2 can express them).
+ *  @param out the stream to write to
+ *  @param ts the system, must be functional with only boolean,
+ *         bit-vector and array sorts
+ *  @param props the properties, over the variables of ts
+ *  @throws PonoException if ts is relational or uses a sort or operator
+ *          that BTOR2 cannot express (e.g. integers or repeat)
+ */
+void write_btor2(std::ostream & out,
+                 const TransitionSystem & ts,
+                 const smt::TermVec & props);
+
+/** write_btor2 to a file
+ *  @throws PonoException if the file can't be written
+ */
+void write_btor2_file(const std::string & filename,
+                      const TransitionSystem & ts,
+                      const smt::TermVec & props);
+
+}  // namespace pono
@@ -19,59 +19,14 @@
 #include <sstream>
 #include <vector>
 
-#include "gmpxx.h"
-
 #include "smt-switch/smt.h"
 
+#include "printers/witness_values.h"
 #include "utils/logger.h"
+#include "utils/timeline.h"
 
 namespace pono {
 
-std::string as_bits(std::string val)
-{
-  // TODO: this makes assumptions on format of value from boolector
-  //       to support other solvers, we need to be more general
-  std::string res = val;
-
-  if (val.length() < 2) {
-    throw PonoException("Don't know how to interpret value: " + val);
-  }
-
-  if (res.substr(0, 2) == "#b") {
-    // remove the #b prefix
-    res = res.substr(2, val.length() - 2);
-  } else if (res.substr(0, 2) == "#x") {
-    throw PonoException("Not supporting hexadecimal format yet.");
-  } else {
-    res = res.substr(5, res.length() - 5);
-    std::istringstream iss(res);
-    std::vector<std::string> tokens(std::istream_iterator<std::string>{ iss },
-                                    std::istream_iterator<std::string>());
-
-    if (tokens.size() != 2) {
-      throw PonoException("Failed to interpret " + val);
-    }
-
-    res = tokens[0];
-    // get rid of ")"
-    std::string width_str = tokens[1].substr(0, tokens[1].length() - 1);
-    size_t width = std::stoull(width_str);
-    mpz_class cval(res);
-    res = cval.get_str(2);
-    size_t strlen = res.length();
-
-    if (strlen < width) {
-      // pad with zeros
-      res = std::string(width - strlen, '0') + res;
-    } else if (strlen > width) {
-      // remove prepended zeros
-      res = res.erase(0, strlen - width);
-    }
-    return res;
-  }
-  return res;
-}
-
 // Returns true iff 'term' appears in either the state variables or in
 // the input variables of 'ts'. If COI is applied, then 'ts' might
 // have different state and input variables than the original
@@ -81,6 +36,10 @@ std::string as_bits(std::string val)
 bool appears_in_ts_coi (const smt::Term &term,
                         const TransitionSystem & ts)
 {
+  // e.g. a variable outside of the cone of a lazily encoded property
+  if (!term)
+    return false;
+
   const auto & it_states = ts.statevars().find(term);
   if (it_states != ts.statevars().end())
     return true;
@@ -92,145 +51,118 @@ bool appears_in_ts_coi (const smt::Term &term,
   return false;
 }
 
+// Prints the value of term (the idx-th of its kind in the btor2 file) at
+// time, BV values as "idx bits name@time" and array values as one
+// "idx [index] element name@time" line per store, followed by the constant
+// array default if there is one.
+void print_btor_val_at_time(uint64_t idx,
+                            const smt::Term & term,
+                            const smt::UnorderedTermMap & valmap,
+                            unsigned int time,
+                            WitnessValues & values,
+                            std::ostream & out)
+{
+  auto it = valmap.find(term);
+  if (it == valmap.end()) {
+    // e.g. left out by the witness options
+    return;
+  }
+  smt::SortKind sk = term->get_sort()->get_sort_kind();
+  const std::string & name = values.name(term);
+  if (sk == smt::BV) {
+    out << idx << " " << values.bits(it->second) << " " << name << "@"
+        << time << "\n";
+  } else if (sk == smt::ARRAY) {
+    smt::Term tmp = it->second;
+    smt::TermVec store_children(3);
+    while (tmp->get_op() == smt::Store) {
+      int num = 0;
+      for (auto c : tmp) {
+        store_children[num] = c;
+        num++;
+      }
+
+      out << idx << " [" << values.bits(store_children[1]) << "] "
+          << values.bits(store_children[2]) << " " << name << "@" << time
+          << "\n";
+      tmp = store_children[0];
+    }
+
+    if (tmp->get_op().is_null()
+        && tmp->get_sort()->get_sort_kind() == smt::ARRAY) {
+      smt::Term const_val = *(tmp->begin());
+      out << idx << " " << values.bits(const_val) << " " << name << "@"
+          << time << "\n";
+    }
+  } else {
+    throw PonoException("Unhandled sort kind: " + ::smt::to_string(sk));
+  }
+}
+
 void print_btor_vals_at_time(const smt::TermVec & vec,
                              const smt::UnorderedTermMap & valmap,
-                             unsigned int time, const TransitionSystem & ts)
+                             unsigned int time,
+                             const TransitionSystem & ts,
+                             WitnessValues & values,
+                             std::ostream & out)
 {
-  smt::SortKind sk;
-  smt::TermVec store_children(3);
   for (size_t i = 0, size = vec.size(); i < size; ++i) {
     // Do not print if term 'vec[i]' does not appear in COI. When not
     // using COI, this check always returns true.
     if (!appears_in_ts_coi(vec[i], ts))
       continue;
-    sk = vec[i]->get_sort()->get_sort_kind();
-    if (sk == smt::BV) {
-      // TODO: this makes assumptions on format of value from boolector
-      //       to support other solvers, we need to be more general
-      logger.log(0,
-                 "{} {} {}@{}",
-                 i,
-                 as_bits(valmap.at(vec[i])->to_string()),
-                 vec[i],
-                 time);
-    } else if (sk == smt::ARRAY) {
-      smt::Term tmp = valmap.at(vec[i]);
-      while (tmp->get_op() == smt::Store) {
-        int num = 0;
-        for (auto c : tmp) {
-          store_children[num] = c;
-          num++;
-        }
-
-        logger.log(0,
-                   "{} [{}] {} {}@{}",
-                   i,
-                   as_bits(store_children[1]->to_string()),
-                   as_bits(store_children[2]->to_string()),
-                   vec[i],
-                   time);
-        tmp = store_children[0];
-      }
-
-      if (tmp->get_op().is_null()
-          && tmp->get_sort()->get_sort_kind() == smt::ARRAY) {
-        smt::Term const_val = *(tmp->begin());
-        logger.log(
-            0, "{} {} {}@{}", i, as_bits(const_val->to_string()), vec[i], time);
-      }
-
-    } else {
-      throw PonoException("Unhandled sort kind: " + ::smt::to_string(sk));
-    }
+    print_btor_val_at_time(i, vec[i], valmap, time, values, out);
   }
 }
 
 void print_btor_vals_at_time(const std::map<uint64_t, smt::Term> m,
                              const smt::UnorderedTermMap & valmap,
-                             unsigned int time, const TransitionSystem & ts)
+                             unsigned int time,
+                             const TransitionSystem & ts,
+                             WitnessValues & values,
+                             std::ostream & out)
 {
-  smt::SortKind sk;
-  smt::TermVec store_children(3);
   for (auto entry : m) {
     // Do not print if term 'entry.second' does not appear in COI. When not
     // using COI, this check always returns true.
     if (!appears_in_ts_coi(entry.second, ts))
       continue;
-    sk = entry.second->get_sort()->get_sort_kind();
-    if (sk == smt::BV) {
-      // TODO: this makes assumptions on format of value from boolector
-      //       to support other solvers, we need to be more general
-      // Remove the #b prefix
-      logger.log(0,
-                 "{} {} {}@{}",
-                 entry.first,
-                 as_bits(valmap.at(entry.second)->to_string()),
-                 entry.second,
-                 time);
-    } else if (sk == smt::ARRAY) {
-      smt::Term tmp = valmap.at(entry.second);
-      while (tmp->get_op() == smt::Store) {
-        int num = 0;
-        for (auto c : tmp) {
-          store_children[num] = c;
-          num++;
-        }
-
-        logger.log(0,
-                   "{} [{}] {} {}@{}",
-                   entry.first,
-                   as_bits(store_children[1]->to_string()),
-                   as_bits(store_children[2]->to_string()),
-                   entry.second,
-                   time);
-        tmp = store_children[0];
-      }
-
-      if (tmp->get_op().is_null()
-          && tmp->get_sort()->get_sort_kind() == smt::ARRAY) {
-        smt::Term const_val = *(tmp->begin());
-        logger.log(0,
-                   "{} {} {}@{}",
-                   entry.first,
-                   as_bits(const_val->to_string()),
-                   entry.second,
-                   time);
-      }
-
-    } else {
-      throw PonoException("Unhandled sort kind: " + ::smt::to_string(sk));
-    }
+    print_btor_val_at_time(
+        entry.first, entry.second, valmap, time, values, out);
   }
 }
 
+// The values are converted once per distinct value and written to a
+// buffered stream, flushed at the end of the witness.
 void print_witness_btor(const BTOR2Encoder & btor_enc,
                         const std::vector<smt::UnorderedTermMap> & cex,
-			const TransitionSystem & ts)
+                        const TransitionSystem & ts,
+                        std::ostream & out = std::cout)
 {
-  const smt::TermVec inputs = btor_enc.inputsvec();
-  const smt::TermVec states = btor_enc.statesvec();
-  const std::map<uint64_t, smt::Term> no_next_states =
+  TIMELINE_SPAN("btor2_witness");
+  const smt::TermVec & inputs = btor_enc.inputsvec();
+  const smt::TermVec & states = btor_enc.statesvec();
+  const std::map<uint64_t, smt::Term> & no_next_states =
       btor_enc.no_next_statevars();
   bool has_states_without_next = no_next_states.size();
+  WitnessValues values;
 
-  logger.log(0, "#0");
-  print_btor_vals_at_time(states, cex.at(0), 0, ts);
+  out << "#0\n";
+  print_btor_vals_at_time(states, cex.at(0), 0, ts, values, out);
 
   for (size_t k = 0, cex_size = cex.size(); k < cex_size; ++k) {
     // states without next
     if (k && has_states_without_next) {
-      logger.log(0, "#{}", k);
-      print_btor_vals_at_time(no_next_states, cex.at(k), k, ts);
+      out << "#" << k << "\n";
+      print_btor_vals_at_time(no_next_states, cex.at(k), k, ts, values, out);
     }
 
     // inputs
-    if (k < cex_size) {
-      logger.log(0, "@{}", k);
-      print_btor_vals_at_time(inputs, cex.at(k), k, ts);
-    }
+    out << "@" << k << "\n";
+    print_btor_vals_at_time(inputs, cex.at(k), k, ts, values, out);
   }
 
-  logger.log(0, ".");
+  out << "." << std::endl;
 }
 
 }  // namespace pono
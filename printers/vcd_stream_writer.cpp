@@ -0,0 +1,197 @@
+/*********************                                                        */
+/*! \file vcd_stream_writer.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A VCD writer that is given a trace one frame at a time, so
+**        that the frames do not have to be kept in memory.
+**
+**/
+
+#include "printers/vcd_stream_writer.h"
+
+#include <cstdio>
+#include <sstream>
+#include <unordered_set>
+
+#include "printers/witness_values.h"
+#include "utils/exceptions.h"
+#include "utils/logger.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+// the signals are declared by the base class from the system alone
+static const vector<UnorderedTermMap> no_frames;
+
+static const size_t write_buffer_size = 1 << 20;
+
+// the value changes are written next to the VCD file
+static const char * body_suffix = ".body.tmp";
+
+VCDStreamWriter::VCDStreamWriter(const TransitionSystem & ts,
+                                 const std::string & filename)
+    : VCDWitnessPrinter(ts, no_frames),
+      filename_(filename),
+      body_filename_(filename + body_suffix),
+      buffer_(write_buffer_size),
+      closed_(false),
+      num_frames_(0)
+{
+  body_.rdbuf()->pubsetbuf(buffer_.data(), buffer_.size());
+  body_.open(body_filename_, ios::out | ios::trunc);
+  if (!body_.is_open()) {
+    throw PonoException("Unable to write to : " + body_filename_);
+  }
+}
+
+VCDStreamWriter::~VCDStreamWriter()
+{
+  if (!closed_) {
+    body_.close();
+    remove(body_filename_.c_str());
+  }
+}
+
+void VCDStreamWriter::write_change(const std::string & hash,
+                                   const std::string & val)
+{
+  auto it = last_values_.find(hash);
+  if (it == last_values_.end()) {
+    last_values_.emplace(hash, val);
+  } else if (it->second != val) {
+    it->second = val;
+  } else {
+    return;
+  }
+  body_ << val << " " << hash << "\n";
+}
+
+const std::string & VCDStreamWriter::element_hash(VCDArray & arr,
+                                                  const std::string & index)
+{
+  auto it = arr.indices2hash.find(index);
+  if (it == arr.indices2hash.end()) {
+    it = arr.indices2hash.emplace(index, new_hash_id()).first;
+  }
+  return it->second;
+}
+
+void VCDStreamWriter::add_frame(const smt::UnorderedTermMap & valmap)
+{
+  if (closed_) {
+    throw PonoException("Adding a frame to a closed VCD writer");
+  }
+  body_ << "#" << num_frames_ << "\n";
+
+  for (auto && sig_bv_ptr : allsig_bv_) {
+    auto pos = valmap.find(sig_bv_ptr->ast);
+    if (pos == valmap.end()) {
+      logger.log(1,
+                 "missing value in provided trace @{}: {}",
+                 num_frames_,
+                 sig_bv_ptr->full_name);
+      continue;
+    }
+    write_change(sig_bv_ptr->hash, "b" + value_bits(pos->second));
+  }
+
+  TermVec store_children(3);
+  unordered_set<string> written;
+  for (auto && sig_array_ptr : allsig_array_) {
+    auto pos = valmap.find(sig_array_ptr->ast);
+    if (pos == valmap.end()) {
+      logger.log(1,
+                 "missing value in provided trace @{}: {}",
+                 num_frames_,
+                 sig_array_ptr->full_name);
+      continue;
+    }
+    // the outermost store of an index is its value
+    written.clear();
+    Term memvalue = pos->second;
+    while (memvalue->get_op() == Store) {
+      int num = 0;
+      for (auto c : memvalue) {
+        store_children[num] = c;
+        num++;
+      }
+      string addr = value_decimal(store_children[1]);
+      if (written.insert(addr).second) {
+        write_change(element_hash(*sig_array_ptr, addr),
+                     "b" + value_bits(store_children[2]));
+      }
+      memvalue = store_children[0];
+    }
+
+    if (memvalue->get_op().is_null() && memvalue->is_value()) {
+      Term const_val = *(memvalue->begin());
+      write_change(element_hash(*sig_array_ptr, "default"),
+                   "b" + value_bits(const_val));
+    }
+  }
+
+  ++num_frames_;
+}
+
+void VCDStreamWriter::close()
+{
+  if (closed_) {
+    return;
+  }
+  write_file(filename_, close_body());
+}
+
+std::string VCDStreamWriter::close_body()
+{
+  if (closed_) {
+    throw PonoException("Closing a closed VCD writer");
+  }
+  if (!num_frames_) {
+    throw PonoException("No trace to dump");
+  }
+  body_ << "#" << num_frames_ << "\n";
+  body_.close();
+  closed_ = true;
+
+  std::ostringstream header;
+  GenHeader(header);
+  return header.str();
+}
+
+void VCDStreamWriter::write_file(const std::string & filename,
+                                 const std::string & header)
+{
+  std::string body_filename = filename + body_suffix;
+  std::vector<char> out_buffer(write_buffer_size);
+  std::ofstream fout;
+  fout.rdbuf()->pubsetbuf(out_buffer.data(), out_buffer.size());
+  fout.open(filename, ios::out | ios::trunc);
+  std::ifstream body(body_filename);
+  if (!fout.is_open() || !body.is_open()) {
+    remove(body_filename.c_str());
+    throw PonoException("Unable to write to : " + filename);
+  }
+
+  fout << header;
+  if (body.peek() != EOF) {
+    fout << body.rdbuf();
+  }
+  body.close();
+  remove(body_filename.c_str());
+  fout.close();
+  if (!fout) {
+    throw PonoException("Unable to write to : " + filename);
+  }
+  logger.log(0, "Trace written to " + filename);
+}
+
+}  // namespace pono
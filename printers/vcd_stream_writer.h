@@ -0,0 +1,103 @@
+/*********************                                                        */
+/*! \file vcd_stream_writer.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A VCD writer that is given a trace one frame at a time, so
+**        that the frames do not have to be kept in memory.
+**
+**        Only the value changes are written, and for arrays only the
+**        elements that appear in the stores of their values. Because the
+**        VCD header declares every array element, the value changes are
+**        written to a temporary file next to the output, which is copied
+**        after the header when the writer is closed. Only the last value
+**        of each signal is kept in memory.
+**
+**/
+
+#pragma once
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/ts.h"
+#include "printers/vcd_witness_printer.h"
+#include "smt-switch/smt.h"
+
+namespace pono {
+
+class VCDStreamWriter : public VCDWitnessPrinter
+{
+ public:
+  /** @param ts the system of the trace, its state, input variables and
+   *         named terms are the signals
+   *  @param filename the VCD file, written when the writer is closed
+   *  @throws PonoException if the temporary file cannot be created
+   */
+  VCDStreamWriter(const TransitionSystem & ts, const std::string & filename);
+
+  /** Removes the temporary file if the writer was not closed */
+  ~VCDStreamWriter();
+
+  /** Write the value changes of the next frame
+   *  @param valmap the values of the signals in this frame
+   */
+  void add_frame(const smt::UnorderedTermMap & valmap);
+
+  /** Write the header and the value changes to the VCD file
+   *  @throws PonoException if there was no frame or the file cannot be
+   *          written
+   */
+  void close();
+
+  /** Finish the value changes without writing the VCD file, which is
+   *  then written by write_file (e.g. on another thread, as it doesn't
+   *  use the terms of the system)
+   *  @return the header of the VCD file
+   *  @throws PonoException if there was no frame
+   */
+  std::string close_body();
+
+  /** Write a VCD file from its header and the value changes of a writer
+   *  finished by close_body
+   *  @param filename the filename the writer was created with
+   *  @param header the header returned by close_body
+   *  @throws PonoException if the file cannot be written
+   */
+  static void write_file(const std::string & filename,
+                         const std::string & header);
+
+  /** @return the number of frames added so far */
+  size_t num_frames() const { return num_frames_; }
+
+ protected:
+  /** Write the value of a signal if it changed
+   *  @param hash the VCD identifier of the signal
+   *  @param val the bits of the value, with the 'b' prefix
+   */
+  void write_change(const std::string & hash, const std::string & val);
+
+  /** @return the VCD identifier of element index of an array, declared on
+   *          first use
+   */
+  const std::string & element_hash(VCDArray & arr, const std::string & index);
+
+  std::string filename_;
+  std::string body_filename_;
+  std::ofstream body_;
+  std::vector<char> buffer_;  ///< large block buffer of body_
+  bool closed_;
+  size_t num_frames_;
+  std::unordered_map<std::string, std::string> last_values_;  ///< per hash
+};
+
+}  // namespace pono
@@ -15,6 +15,7 @@
  **/
 
 #include "utils/logger.h"
+#include "utils/timeline.h"
 #include "frontends/btor2_encoder.h"
 #include "smt-switch/boolector_factory.h"
 
@@ -39,23 +40,6 @@ static const char date_time_format [] = "%A %Y/%m/%d  %H:%M:%S";
 
 // ------------- HELPER FUNCTIONS ------------------ //
 
-static std::vector<std::string> split(const std::string& str,
-                               const std::string& delim) {
-  std::vector<std::string> tokens;
-  size_t prev = 0, pos = 0;
-  do {
-    pos = str.find(delim, prev);
-    if (pos == std::string::npos)
-      pos = str.length();
-    std::string token = str.substr(prev, pos - prev);
-    if (!token.empty())
-      tokens.push_back(token);
-    prev = pos + delim.length();
-  } while (pos < str.length() && prev < str.length());
-  return tokens;
-}
-
-
 // convert a widith to a verilog string
 static std::string width2range(uint64_t w) {
   if (w > 1)
@@ -63,96 +47,13 @@ static std::string width2range(uint64_t w) {
   return "";
 }
 
-// copied from btor2_witness_printer,
-// so that we don't need to include
-// because its header contains also 
-// implementation, this creates troubles
-static std::string as_bits(std::string val)
-{
-  // TODO: this makes assumptions on format of value from boolector
-  //       to support other solvers, we need to be more general
-  std::string res = val;
-
-  if (val.length() < 2) {
-    throw PonoException("Don't know how to interpret value: " + val);
-  }
-
-  if (res.substr(0, 2) == "#b") {
-    // #b prefix -> b
-    res = res.substr(1, val.length() - 1);
-  } else if (res.substr(0, 2) == "#x") {
-    throw PonoException("Not supporting hexadecimal format yet.");
-  } else {
-    res = res.substr(5, res.length() - 5);
-    std::istringstream iss(res);
-    std::vector<std::string> tokens(std::istream_iterator<std::string>{ iss },
-                                    std::istream_iterator<std::string>());
-
-    if (tokens.size() != 2) {
-      throw PonoException("Failed to interpret " + val);
-    }
-
-    res = tokens[0];
-    // get rid of ")"
-    std::string width_str = tokens[1].substr(0, tokens[1].length() - 1);
-    size_t width = std::stoull(width_str);
-    mpz_class cval(res);
-    res = cval.get_str(2);
-    size_t strlen = res.length();
-
-    if (strlen < width) {
-      // pad with zeros
-      res = std::string(width - strlen, '0') + res;
-    } else if (strlen > width) {
-      // remove prepended zeros
-      res = res.erase(0, strlen - width);
-    }
-    return res;
-  }
-  return res;
-}
+// ------------- CLASS FUNCTIONS ------------------ //
 
-// convert boolector value to decimal
-static std::string as_decimal(std::string val)
+std::string VCDWitnessPrinter::vcd_bits(const smt::Term & val) const
 {
-  // TODO: this makes assumptions on format of value from boolector
-  //       to support other solvers, we need to be more general
-  std::string res = val;
-
-  if (val.length() < 2) {
-    throw PonoException("Don't know how to interpret value: " + val);
-  }
-
-  if (res.substr(0, 2) == "#b") {
-    // #b prefix -> b
-    res = res.substr(2, val.length() - 1);
-    mpz_class cval(res, 2);
-    res = cval.get_str(10);
-  } else if (res.substr(0, 2) == "#x") {
-    throw PonoException("Not supporting hexadecimal format yet.");
-  } else {
-    res = res.substr(5, res.length() - 5);
-    std::istringstream iss(res);
-    std::vector<std::string> tokens(std::istream_iterator<std::string>{ iss },
-                                    std::istream_iterator<std::string>());
-
-    if (tokens.size() != 2) {
-      throw PonoException("Failed to interpret " + val);
-    }
-
-    res = tokens[0];
-    // get rid of ")"
-    std::string width_str = tokens[1].substr(0, tokens[1].length() - 1);
-    size_t width = std::stoull(width_str);
-    mpz_class cval(res);
-    res = cval.get_str(10);
-    return res;
-  }
-  return res;
+  return "b" + values_.bits(val);
 }
 
-// ------------- CLASS FUNCTIONS ------------------ //
-
 VCDWitnessPrinter::VCDWitnessPrinter(
     const TransitionSystem & ts, const std::vector<smt::UnorderedTermMap> & cex)
     : inputs_(ts.inputvars()),
@@ -199,7 +100,7 @@ VCDWitnessPrinter::VCDWitnessPrinter(
             store_children[num] = c;
             num++;
           }
-          indices.insert(as_decimal(store_children[1]->to_string()));
+          indices.insert(values_.decimal(store_children[1]));
           tmp = store_children[0];
         }
 
@@ -249,6 +150,25 @@ bool static is_bad_state_pattern(const std::string & n) {
   return true;
 }
 
+VCDScope * VCDWitnessPrinter::find_scope(NameId id,
+                                         std::string_view & short_name)
+{
+  // the scopes from the innermost, empty ones (e.g. of a..b) are skipped
+  std::vector<std::string_view> scopes;
+  for (; id != NameInterner::root; id = name_interner().scope(id)) {
+    std::string_view leaf = name_interner().leaf(id);
+    if (!leaf.empty())
+      scopes.push_back(leaf);
+  }
+  short_name = scopes.empty() ? std::string_view() : scopes.front();
+  VCDScope * root = & root_scope_;
+  for (size_t idx = scopes.size(); idx > 1; --idx) {
+    // creates the scope if it does not exist
+    root = & (root->subscopes[scopes.at(idx - 1)]);
+  } // at the end of this loop, we are at the scope to insert our variable
+  return root;
+} // end of find_scope
+
 void VCDWitnessPrinter::check_insert_scope(std::string full_name,
                                            bool is_reg,
                                            const smt::Term & ast)
@@ -282,22 +202,12 @@ void VCDWitnessPrinter::check_insert_scope(std::string full_name,
     full_name = full_name.substr(0,pos);
   // gtkwave doesn't like colons in name
   std::replace(full_name.begin(), full_name.end(), ':', '_');
-  auto scopes = split(full_name, ".");
-  VCDScope * root = & root_scope_;
-  for (size_t idx = 0; idx < scopes.size() - 1; ++idx) {
-    const auto & next_scope = scopes.at(idx);
-    auto pos = root->subscopes.find(next_scope);
-    if (pos != root->subscopes.end()) { // we find it
-      root = & (pos->second);
-    } else { // we need to insert this scope
-      root->subscopes.emplace(next_scope, VCDScope());
-      root = &( root->subscopes.at(next_scope) );
-    }
-  } // at the end of this loop, we are at the scope to insert our variable
-  const auto & short_name = scopes.back();
+  NameId id = name_interner().intern(full_name);
+  std::string_view short_name;
+  VCDScope * root = find_scope(id, short_name);
   uint64_t width = ast->get_sort()->get_width();
 
-  std::map<std::string, VCDSignal> & signal_set = is_reg ? root->regs : root->wires;
+  std::map<std::string_view, VCDSignal> & signal_set = is_reg ? root->regs : root->wires;
 
   if (signal_set.find(short_name) != signal_set.end()) {
     // this can happen if the term is registered both under
@@ -308,8 +218,8 @@ void VCDWitnessPrinter::check_insert_scope(std::string full_name,
   auto hashid = new_hash_id();
   signal_set.emplace(short_name,
     VCDSignal(
-      short_name + width2range(width), 
-      full_name,  hashid , ast, width));
+      std::string(short_name) + width2range(width),
+      name_interner().name(id),  hashid , ast, width));
   allsig_bv_.push_back( &(signal_set.at(short_name)) );
 } // end of check_insert_scope
 
@@ -321,22 +231,12 @@ void VCDWitnessPrinter::check_insert_scope_array(
 {
   // vcd doesn't like colons in name
   std::replace(full_name.begin(), full_name.end(), ':', '_');
-  auto scopes = split(full_name, ".");
-  VCDScope * root = & root_scope_;
-  for (size_t idx = 0; idx < scopes.size() - 1; ++idx) {
-    const auto & next_scope = scopes.at(idx);
-    auto pos = root->subscopes.find(next_scope);
-    if (pos != root->subscopes.end()) { // we find it
-      root = & (pos->second);
-    } else { // we need to insert this scope
-      root->subscopes.emplace(next_scope, VCDScope());
-      root = &( root->subscopes.at(next_scope) );
-    }
-  } // at the end of this loop, we are at the scope to insert our variable
-  const auto & short_name = scopes.back();
+  NameId id = name_interner().intern(full_name);
+  std::string_view short_name;
+  VCDScope * root = find_scope(id, short_name);
   uint64_t data_width = ast->get_sort()->get_elemsort()->get_width();
 
-  std::map<std::string, VCDArray> & signal_set = root->arrays;
+  std::map<std::string_view, VCDArray> & signal_set = root->arrays;
 
   if (signal_set.find(short_name) != signal_set.end()) {
     // I actually maybe should use `assert(false)` here, because
@@ -345,7 +245,7 @@ void VCDWitnessPrinter::check_insert_scope_array(
   }
 
   signal_set.emplace(short_name,
-    VCDArray(short_name, full_name,  ast, data_width));
+    VCDArray(std::string(short_name), name_interner().name(id),  ast, data_width));
   auto & indices2hash = signal_set.at(short_name).indices2hash;
   for (const auto & index : indices)
     indices2hash.emplace(index, new_hash_id());
@@ -415,7 +315,7 @@ void VCDWitnessPrinter::dump_all(const smt::UnorderedTermMap & valmap,
         sig_bv_ptr->full_name);
       continue;
     }
-    auto val = as_bits(pos->second->to_string());
+    auto val = vcd_bits(pos->second);
     valbuf.emplace(
       sig_bv_ptr->hash,
       val
@@ -440,8 +340,8 @@ void VCDWitnessPrinter::dump_all(const smt::UnorderedTermMap & valmap,
         num++;
       }
 
-      auto addr = as_decimal(store_children[1]->to_string());
-      auto data = as_bits(store_children[2]->to_string());
+      auto addr = values_.decimal(store_children[1]);
+      auto data = vcd_bits(store_children[2]);
       auto addr_pos = sig_array_ptr->indices2hash.find(addr);
       if (addr_pos != sig_array_ptr->indices2hash.end()) {
         valbuf.emplace(addr_pos->second, data);
@@ -456,7 +356,7 @@ void VCDWitnessPrinter::dump_all(const smt::UnorderedTermMap & valmap,
 
     if (memvalue->get_op().is_null() && memvalue->is_value()) {
       smt::Term const_val = *(memvalue->begin());
-      auto data_default = as_bits(const_val->to_string());
+      auto data_default = vcd_bits(const_val);
       auto addr_pos = sig_array_ptr->indices2hash.find("default");
       if (addr_pos != sig_array_ptr->indices2hash.end()) {
         valbuf.emplace(addr_pos->second, data_default);
@@ -482,7 +382,7 @@ void VCDWitnessPrinter::dump_diff(const smt::UnorderedTermMap & valmap,
         sig_bv_ptr->full_name);
       continue;
     }
-    auto val = as_bits(pos->second->to_string());
+    auto val = vcd_bits(pos->second);
     auto prev_pos = valprev.find(sig_bv_ptr->hash);
     if (prev_pos == valprev.end()) {
       valprev.emplace(sig_bv_ptr->hash, val );
@@ -516,8 +416,8 @@ void VCDWitnessPrinter::dump_diff(const smt::UnorderedTermMap & valmap,
         num++;
       }
 
-      auto addr = as_decimal(store_children[1]->to_string());
-      auto data = as_bits(store_children[2]->to_string());
+      auto addr = values_.decimal(store_children[1]);
+      auto data = vcd_bits(store_children[2]);
       auto addr_pos = sig_array_ptr->indices2hash.find(addr);
       if (addr_pos != sig_array_ptr->indices2hash.end()) {
         auto prev_pos = valprev.find(addr_pos->second);
@@ -530,7 +430,7 @@ void VCDWitnessPrinter::dump_diff(const smt::UnorderedTermMap & valmap,
           // before it is first assigned
           // so you can consider even remove the logger below
           logger.log(3, "{} was not cached before time : {}.",
-            sig_array_ptr->full_name+"["+addr+"]", std::to_string(t));
+            std::string(sig_array_ptr->full_name)+"["+addr+"]", std::to_string(t));
         } else {
           if (prev_pos->second != data) {
             prev_pos->second = data; // update the value
@@ -549,7 +449,7 @@ void VCDWitnessPrinter::dump_diff(const smt::UnorderedTermMap & valmap,
 
     if (memvalue->get_op().is_null() && memvalue->is_value()) {
       smt::Term const_val = *(memvalue->begin());
-      auto data_default = as_bits(const_val->to_string());
+      auto data_default = vcd_bits(const_val);
       auto addr_pos = sig_array_ptr->indices2hash.find("default");
       if (addr_pos != sig_array_ptr->indices2hash.end()) {
         auto prev_pos = valprev.find(addr_pos->second);
@@ -562,7 +462,7 @@ void VCDWitnessPrinter::dump_diff(const smt::UnorderedTermMap & valmap,
           // before it is first assigned
           // so you can consider even remove the logger below
           logger.log(3, "{} was not cached before time : {}.",
-            sig_array_ptr->full_name+"[default]", std::to_string(t));
+            std::string(sig_array_ptr->full_name)+"[default]", std::to_string(t));
         } else {
           if (prev_pos->second != data_default) {
             prev_pos->second = data_default; // update the value
@@ -602,6 +502,7 @@ void VCDWitnessPrinter::DumpValues(std::ostream & fout) const {
 void VCDWitnessPrinter::dump_trace_to_file(
     const std::string & vcd_file_name) const
 {
+  TIMELINE_SPAN("vcd_witness");
   std::ofstream fout(vcd_file_name);
   if (!fout.is_open())
     throw PonoException("Unable to write to : " + vcd_file_name);
@@ -14,28 +14,35 @@
  **
  **/
 
+#pragma once
+
 #include <iterator>
 #include <map>
 #include <sstream>
 #include <vector>
 #include <set>
+#include <string_view>
 #include <functional>
 
 #include "gmpxx.h"
 #include "smt-switch/smt.h"
 
+#include "printers/witness_values.h"
 #include "utils/logger.h"
+#include "utils/name_interner.h"
 
 namespace pono {
 
+// the names of the signals and scopes are views of interned names
+// (see utils/name_interner.h)
 struct VCDSignal {
   std::string vcd_name; // maybe you want to add this : [N:0]
-  std::string full_name;
+  std::string_view full_name;
   std::string hash;
   smt::Term   ast;
   uint64_t    data_width;
   VCDSignal(const std::string & _vcd_name,
-            const std::string & _full_name,
+            std::string_view _full_name,
             const std::string & _hash,
             const smt::Term & _ast,
             uint64_t w)
@@ -51,7 +58,7 @@ struct VCDSignal {
 struct VCDArray : public VCDSignal {
   std::unordered_map<std::string, std::string> indices2hash;
   VCDArray(const std::string & _vcd_name,
-           const std::string & _full_name,
+           std::string_view _full_name,
            const smt::Term & _ast,
            uint64_t w)
       : VCDSignal(_vcd_name, _full_name, "", _ast, w)
@@ -60,10 +67,10 @@ struct VCDArray : public VCDSignal {
 };
 
 struct VCDScope {
-  std::map<std::string, VCDScope> subscopes;
-  std::map<std::string, VCDSignal>  wires;
-  std::map<std::string, VCDSignal>  regs;
-  std::map<std::string, VCDArray> arrays;
+  std::map<std::string_view, VCDScope> subscopes;
+  std::map<std::string_view, VCDSignal>  wires;
+  std::map<std::string_view, VCDSignal>  regs;
+  std::map<std::string_view, VCDArray> arrays;
 }; // struct VCDScope
 
 class VCDWitnessPrinter {
@@ -81,6 +88,10 @@ protected:
  std::vector<VCDSignal *> allsig_bv_;
  std::vector<VCDArray *> allsig_array_;
 
+ // the scope of an interned name like a.b.c, following its scopes in
+ // the interner (created if they do not exist)
+ // short_name is set to the name in that scope, e.g. c
+ VCDScope * find_scope(NameId id, std::string_view & short_name);
  // given a name like a.b.c, find the right scope and
  // create if it does not exists
  void check_insert_scope(std::string full_name,
@@ -92,6 +103,11 @@ protected:
                                bool has_default,
                                const smt::Term & ast);
 
+ // converted values, shared by all the frames
+ mutable WitnessValues values_;
+ // the VCD representation of a bit-vector value
+ std::string vcd_bits(const smt::Term & val) const;
+
  uint64_t hash_id_cnt_;
  std::string new_hash_id();
 
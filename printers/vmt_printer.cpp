@@ -0,0 +1,254 @@
+/*********************                                                        */
+/*! \file vmt_printer.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Writes a transition system as VMT (SMT-LIB with :next, :init,
+**        :trans and :invar-property annotations), e.g. to hand a
+**        preprocessed system to other tools.
+**
+**/
+
+#include "printers/vmt_printer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "smt-switch/utils.h"
+#include "utils/exceptions.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+/** @return name as an SMT-LIB symbol, quoted if it is not simple */
+static string vmt_symbol(string name)
+{
+  if (name.size() > 1 && name.front() == '|' && name.back() == '|') {
+    name = name.substr(1, name.size() - 2);
+  }
+  static const string extra = "~!@$%^&*_-+=<>.?/";
+  bool simple = !name.empty() && !isdigit(static_cast<unsigned char>(name[0]));
+  for (char c : name) {
+    simple &= isalnum(static_cast<unsigned char>(c))
+              || extra.find(c) != string::npos;
+  }
+  return simple ? name : "|" + name + "|";
+}
+
+/** @return the variables ordered by name, for a deterministic output */
+static TermVec sorted_vars(const UnorderedTermSet & vars)
+{
+  TermVec res(vars.begin(), vars.end());
+  sort(res.begin(), res.end(), [](const Term & a, const Term & b) {
+    return a->to_string() < b->to_string();
+  });
+  return res;
+}
+
+class VmtWriter
+{
+ public:
+  VmtWriter(ostream & out, const TransitionSystem & ts)
+      : out_(out), ts_(ts), num_defs_(0)
+  {
+  }
+
+  void write(const TermVec & props)
+  {
+    TermVec states = sorted_vars(ts_.statevars());
+    for (const auto & v : sorted_vars(ts_.inputvars())) {
+      declare(v);
+    }
+    for (const auto & v : states) {
+      declare(v);
+      declare(ts_.next(v));
+    }
+
+    // the uninterpreted functions (and other free symbols)
+    UnorderedTermSet symbols;
+    get_free_symbols(ts_.init(), symbols);
+    get_free_symbols(ts_.trans(), symbols);
+    for (const auto & p : props) {
+      get_free_symbols(p, symbols);
+    }
+    for (const auto & v : sorted_vars(symbols)) {
+      if (names_.find(v) == names_.end()) {
+        declare(v);
+      }
+    }
+
+    for (size_t i = 0; i < states.size(); ++i) {
+      const Term & v = states[i];
+      out_ << "(define-fun .sv" << i << " () " << sort(v->get_sort())
+           << " (! " << names_.at(v) << " :next " << names_.at(ts_.next(v))
+           << "))\n";
+    }
+
+    string init = term(ts_.init());
+    out_ << "(define-fun .init () Bool (! " << init << " :init true))\n";
+    string trans = term(ts_.trans());
+    out_ << "(define-fun .trans () Bool (! " << trans << " :trans true))\n";
+    for (size_t i = 0; i < props.size(); ++i) {
+      string p = term(props[i]);
+      out_ << "(define-fun .prop" << i << " () Bool (! " << p
+           << " :invar-property " << i << "))\n";
+    }
+
+    // the names are only kept for the readers of the file
+    vector<pair<string, Term>> named(ts_.named_terms().begin(),
+                                     ts_.named_terms().end());
+    std::sort(named.begin(), named.end(), [](const auto & a, const auto & b) {
+      return a.first < b.first;
+    });
+    for (const auto & elem : named) {
+      string name = vmt_symbol(elem.first);
+      if (taken_.find(name) != taken_.end()) {
+        continue;
+      }
+      string t = term(elem.second);
+      out_ << "(define-fun " << name << " () " << sort(elem.second->get_sort())
+           << " " << t << ")\n";
+      taken_.insert(name);
+    }
+  }
+
+ protected:
+  void declare(const Term & v)
+  {
+    string name = vmt_symbol(v->to_string());
+    names_[v] = name;
+    taken_.insert(name);
+    Sort s = v->get_sort();
+    if (s->get_sort_kind() == FUNCTION) {
+      out_ << "(declare-fun " << name << " (";
+      const SortVec & domain = s->get_domain_sorts();
+      for (size_t i = 0; i < domain.size(); ++i) {
+        out_ << (i ? " " : "") << sort(domain[i]);
+      }
+      out_ << ") " << sort(s->get_codomain_sort()) << ")\n";
+    } else {
+      out_ << "(declare-fun " << name << " () " << sort(s) << ")\n";
+    }
+  }
+
+  string sort(const Sort & s) const
+  {
+    switch (s->get_sort_kind()) {
+      case BOOL: return "Bool";
+      case INT: return "Int";
+      case REAL: return "Real";
+      case BV: return "(_ BitVec " + std::to_string(s->get_width()) + ")";
+      case ARRAY:
+        return "(Array " + sort(s->get_indexsort()) + " "
+               + sort(s->get_elemsort()) + ")";
+      default: return s->to_string();
+    }
+  }
+
+  /** Writes the define-funs of the operator nodes of t (children first)
+   *  that are not written yet
+   *  @return the name or value that refers to t
+   */
+  string term(const Term & t)
+  {
+    TermVec to_visit({ t });
+    while (to_visit.size()) {
+      Term cur = to_visit.back();
+      if (names_.find(cur) != names_.end()) {
+        to_visit.pop_back();
+        continue;
+      }
+
+      bool children_done = true;
+      for (const auto & c : *cur) {
+        if (names_.find(c) == names_.end()) {
+          to_visit.push_back(c);
+          children_done = false;
+        }
+      }
+      if (!children_done) {
+        continue;
+      }
+      to_visit.pop_back();
+      names_[cur] = write_node(cur);
+    }
+    return names_.at(t);
+  }
+
+  /** Writes one term, all its children are written
+   *  @return the name or value that refers to it
+   */
+  string write_node(const Term & t)
+  {
+    Op op = t->get_op();
+    if (op.is_null()) {
+      if (t->is_symbol()) {
+        throw PonoException("VMT writer got an undeclared symbol "
+                            + t->to_string());
+      }
+      if (t->get_sort()->get_sort_kind() == ARRAY) {
+        // constant array
+        return "((as const " + sort(t->get_sort()) + ") "
+               + names_.at(*t->begin()) + ")";
+      }
+      return t->to_string();
+    }
+
+    string expr = "(";
+    bool first = true;
+    if (op.prim_op != Apply) {
+      expr += op.to_string();
+      first = false;
+    }
+    for (const auto & c : *t) {
+      expr += (first ? "" : " ") + names_.at(c);
+      first = false;
+    }
+    expr += ")";
+
+    string name = ".def" + std::to_string(num_defs_++);
+    out_ << "(define-fun " << name << " () " << sort(t->get_sort()) << " "
+         << expr << ")\n";
+    return name;
+  }
+
+  ostream & out_;
+  const TransitionSystem & ts_;
+  size_t num_defs_;
+  ///< variables and written terms -> how to refer to them
+  unordered_map<Term, string> names_;
+  unordered_set<string> taken_;  ///< the declared names
+};
+
+void write_vmt(ostream & out, const TransitionSystem & ts, const TermVec & props)
+{
+  VmtWriter writer(out, ts);
+  writer.write(props);
+}
+
+void write_vmt_file(const string & filename,
+                    const TransitionSystem & ts,
+                    const TermVec & props)
+{
+  ofstream out(filename);
+  if (!out.is_open()) {
+    throw PonoException("Could not open " + filename);
+  }
+  write_vmt(out, ts, props);
+  if (!out) {
+    throw PonoException("Could not write " + filename);
+  }
+}
+
+}  // namespace pono
@@ -0,0 +1,47 @@
+/*********************                                                        */
+/*! \file vmt_printer.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Writes a transition system as VMT (SMT-LIB with :next, :init,
+**        :trans and :invar-property annotations).
+**
+**/
+
+#pragma once
+
+#include <iostream>
+#include <string>
+
+#include "core/ts.h"
+#include "smt-switch/smt.h"
+
+namespace pono {
+
+/** Write a transition system as VMT
+ *  The variables keep their names, the next state variables are declared
+ *  with the names of ts. Every operator node is written once as a
+ *  define-fun, and the named terms of ts are written as define-funs with
+ *  their names (except those that are variable names).
+ *  @param out the stream to write to
+ *  @param ts the system, functional or relational
+ *  @param props the properties, over the variables of ts
+ */
+void write_vmt(std::ostream & out,
+               const TransitionSystem & ts,
+               const smt::TermVec & props);
+
+/** write_vmt to a file
+ *  @throws PonoException if the file can't be written
+ */
+void write_vmt_file(const std::string & filename,
+                    const TransitionSystem & ts,
+                    const smt::TermVec & props);
+
+}  // namespace pono
@@ -0,0 +1,223 @@
+/*********************                                                        */
+/*! \file witness_values.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Conversion of the values of a witness to the strings printed by
+**        the witness printers, for the value formats of all the solvers.
+**
+**/
+
+#include "printers/witness_values.h"
+
+#include <algorithm>
+#include <cctype>
+#include <exception>
+
+#include "gmpxx.h"
+
+#include "utils/exceptions.h"
+#include "utils/logger.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+// the bits of the string representation of a bit-vector value
+static string parse_bits(const string & val, uint64_t width)
+{
+  string res;
+  if (val.compare(0, 2, "#b") == 0) {
+    res = val.substr(2);
+  } else if (val.compare(0, 2, "#x") == 0) {
+    static const char * nibbles[16] = { "0000", "0001", "0010", "0011",
+                                        "0100", "0101", "0110", "0111",
+                                        "1000", "1001", "1010", "1011",
+                                        "1100", "1101", "1110", "1111" };
+    res.reserve(4 * (val.size() - 2));
+    for (size_t i = 2; i < val.size(); ++i) {
+      char c = tolower(val[i]);
+      if (c >= '0' && c <= '9') {
+        res += nibbles[c - '0'];
+      } else if (c >= 'a' && c <= 'f') {
+        res += nibbles[c - 'a' + 10];
+      } else {
+        throw PonoException("Failed to interpret " + val);
+      }
+    }
+  } else if (val.compare(0, 5, "(_ bv") == 0) {
+    size_t end = val.find(' ', 5);
+    if (end == string::npos) {
+      throw PonoException("Failed to interpret " + val);
+    }
+    mpz_class cval(val.substr(5, end - 5));
+    res = cval.get_str(2);
+  } else {
+    throw PonoException("Don't know how to interpret value: " + val);
+  }
+
+  if (res.size() < width) {
+    // pad with zeros
+    res.insert(0, width - res.size(), '0');
+  } else if (res.size() > width) {
+    // remove prepended zeros
+    res.erase(0, res.size() - width);
+  }
+  return res;
+}
+
+string value_bits(const Term & val)
+{
+  Sort sort = val->get_sort();
+  if (sort->get_sort_kind() == BOOL) {
+    return val->to_string() == "true" ? "1" : "0";
+  } else if (sort->get_sort_kind() != BV) {
+    throw PonoException("Expecting a bit-vector value but got "
+                        + val->to_string());
+  }
+
+  uint64_t width = sort->get_width();
+  if (width <= 64 && val->is_value()) {
+    try {
+      uint64_t v = val->to_int();
+      string res(width, '0');
+      for (uint64_t i = 0; i < width; ++i) {
+        if ((v >> i) & 1) {
+          res[width - 1 - i] = '1';
+        }
+      }
+      return res;
+    }
+    catch (std::exception & e) {
+      // fall back to the string representation
+    }
+  }
+  return parse_bits(val->to_string(), width);
+}
+
+string value_decimal(const Term & val)
+{
+  Sort sort = val->get_sort();
+  if (sort->get_sort_kind() == BV && sort->get_width() <= 64
+      && val->is_value()) {
+    try {
+      return std::to_string(val->to_int());
+    }
+    catch (std::exception & e) {
+      // fall back to the string representation
+    }
+  }
+  mpz_class cval(value_bits(val), 2);
+  return cval.get_str(10);
+}
+
+const string & WitnessValues::bits(const Term & val)
+{
+  auto it = bits_.find(val);
+  if (it == bits_.end()) {
+    it = bits_.emplace(val, value_bits(val)).first;
+  }
+  return it->second;
+}
+
+const string & WitnessValues::decimal(const Term & val)
+{
+  auto it = decimals_.find(val);
+  if (it == decimals_.end()) {
+    it = decimals_.emplace(val, value_decimal(val)).first;
+  }
+  return it->second;
+}
+
+const string & WitnessValues::name(const Term & var)
+{
+  auto it = names_.find(var);
+  if (it == names_.end()) {
+    it = names_.emplace(var, remove_curly_brackets(var->to_string())).first;
+  }
+  return it->second;
+}
+
+// the width of a boolean (1) or bit-vector sort, 0 for other sorts
+static uint32_t table_width(const Sort & sort)
+{
+  SortKind sk = sort->get_sort_kind();
+  if (sk == BOOL) {
+    return 1;
+  } else if (sk == BV) {
+    return sort->get_width();
+  }
+  return 0;
+}
+
+void witness_table(const vector<UnorderedTermMap> & cex, WitnessTable & out)
+{
+  out = WitnessTable();
+  WitnessValues wv;
+
+  TermVec vars;
+  UnorderedTermSet seen;
+  for (const auto & frame : cex) {
+    for (const auto & elem : frame) {
+      if (table_width(elem.first->get_sort()) && seen.insert(elem.first).second) {
+        vars.push_back(elem.first);
+      }
+    }
+  }
+  sort(vars.begin(), vars.end(), [&wv](const Term & a, const Term & b) {
+    return wv.name(a) < wv.name(b);
+  });
+
+  unordered_map<Term, size_t> column;
+  for (size_t i = 0; i < vars.size(); ++i) {
+    column[vars[i]] = i;
+    uint32_t w = table_width(vars[i]->get_sort());
+    out.names.push_back(wv.name(vars[i]));
+    out.widths.push_back(w);
+    out.offsets.push_back(out.row_words);
+    out.row_words += (w + 63) / 64;
+  }
+
+  out.num_frames = cex.size();
+  out.values.assign(out.num_frames * out.row_words, 0);
+  out.known.assign(out.num_frames * vars.size(), 0);
+  for (size_t f = 0; f < cex.size(); ++f) {
+    uint64_t * row = out.values.data() + f * out.row_words;
+    for (const auto & elem : cex[f]) {
+      auto it = column.find(elem.first);
+      if (it == column.end()) {
+        continue;
+      }
+      size_t c = it->second;
+      out.known[f * vars.size() + c] = 1;
+      uint32_t w = out.widths[c];
+      uint64_t * words = row + out.offsets[c];
+      const Term & val = elem.second;
+      if (w > 1 && w <= 64 && val->is_value()) {
+        try {
+          words[0] = val->to_int();
+          continue;
+        }
+        catch (std::exception & e) {
+          // fall back to the bits
+        }
+      }
+      // least significant bit last
+      const string & bits = wv.bits(val);
+      for (uint32_t i = 0; i < w; ++i) {
+        if (bits[w - 1 - i] == '1') {
+          words[i / 64] |= uint64_t(1) << (i % 64);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace pono
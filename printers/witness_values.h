@@ -0,0 +1,87 @@
+/*********************                                                        */
+/*! \file witness_values.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Conversion of the values of a witness to the strings printed by
+**        the witness printers, for the value formats of all the solvers.
+**        Values of at most 64 bits are converted through their integer,
+**        wider ones from their binary, hexadecimal or (_ bvN W) string.
+**        Values are terms shared by all frames, so the conversions are
+**        cached.
+**
+**/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "smt-switch/smt.h"
+
+namespace pono {
+
+/** @return the bits of a boolean or bit-vector value, most significant
+ *          first
+ *  @throws PonoException if it is not such a value
+ */
+std::string value_bits(const smt::Term & val);
+
+/** @return the unsigned decimal of a boolean or bit-vector value
+ *  @throws PonoException if it is not such a value
+ */
+std::string value_decimal(const smt::Term & val);
+
+class WitnessValues
+{
+ public:
+  /** @return value_bits(val), computed once per value */
+  const std::string & bits(const smt::Term & val);
+
+  /** @return value_decimal(val), computed once per value */
+  const std::string & decimal(const smt::Term & val);
+
+  /** @return the name of a variable for printing (without curly brackets),
+   *          computed once per variable
+   */
+  const std::string & name(const smt::Term & var);
+
+ protected:
+  std::unordered_map<smt::Term, std::string> bits_;
+  std::unordered_map<smt::Term, std::string> decimals_;
+  std::unordered_map<smt::Term, std::string> names_;
+};
+
+/** A witness as a table with one row per frame and one column per boolean
+ *  or bit-vector variable. Each value takes ceil(width / 64) words, least
+ *  significant first, so the table can be handed out as a flat buffer.
+ */
+struct WitnessTable
+{
+  std::vector<std::string> names;  ///< the column names, sorted
+  std::vector<uint32_t> widths;    ///< the width of each column
+  std::vector<uint32_t> offsets;   ///< the first word of each column in a row
+  uint32_t row_words = 0;          ///< the number of words in a row
+  size_t num_frames = 0;
+  std::vector<uint64_t> values;  ///< num_frames * row_words words
+  ///< num_frames * names.size() flags, 1 iff the frame has a value
+  std::vector<uint8_t> known;
+};
+
+/** Build the table of a witness in one pass over its frames
+ *  @param cex the witness
+ *  @param out the table, overwritten
+ *  @throws PonoException if a value cannot be interpreted
+ */
+void witness_table(const std::vector<smt::UnorderedTermMap> & cex,
+                   WitnessTable & out);
+
+}  // namespace pono
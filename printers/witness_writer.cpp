@@ -0,0 +1,139 @@
+/*********************                                                        */
+/*! \file witness_writer.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Writes the results and witnesses from a background thread.
+**
+**/
+
+#include "printers/witness_writer.h"
+
+#include <exception>
+#include <memory>
+
+#include "utils/exceptions.h"
+#include "utils/logger.h"
+
+using namespace std;
+
+namespace pono {
+
+WitnessWriter::WitnessWriter(size_t max_jobs, std::ostream & out)
+    : max_jobs_(max_jobs),
+      out_(out),
+      busy_(false),
+      stop_(false),
+      num_jobs_(0)
+{
+  if (max_jobs_) {
+    thread_ = std::thread([this]() { run(); });
+  }
+}
+
+WitnessWriter::~WitnessWriter()
+{
+  if (thread_.joinable()) {
+    {
+      lock_guard<mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+  }
+  if (!error_.empty()) {
+    logger.log(0, "Error writing the witness: {}", error_);
+  }
+}
+
+void WitnessWriter::post(const Job & job)
+{
+  if (!max_jobs_) {
+    ++num_jobs_;
+    job();
+    return;
+  }
+
+  unique_lock<mutex> lock(mutex_);
+  done_cv_.wait(lock, [this]() { return jobs_.size() < max_jobs_; });
+  jobs_.push_back(job);
+  lock.unlock();
+  cv_.notify_one();
+}
+
+void WitnessWriter::print(std::string text)
+{
+  // the job owns the text, without copying it
+  auto shared = make_shared<string>(std::move(text));
+  post([this, shared]() {
+    // the messages logged before the result come first
+    logger.flush();
+    out_.write(shared->data(), shared->size());
+    out_.flush();
+  });
+}
+
+void WitnessWriter::flush()
+{
+  wait();
+  lock_guard<mutex> lock(mutex_);
+  if (!error_.empty()) {
+    string msg;
+    msg.swap(error_);
+    throw PonoException(msg);
+  }
+}
+
+void WitnessWriter::wait()
+{
+  unique_lock<mutex> lock(mutex_);
+  done_cv_.wait(lock, [this]() { return jobs_.empty() && !busy_; });
+}
+
+size_t WitnessWriter::num_jobs() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return num_jobs_;
+}
+
+void WitnessWriter::run()
+{
+  unique_lock<mutex> lock(mutex_);
+  while (true) {
+    // the queued jobs are still run when stopping
+    cv_.wait(lock, [this]() { return stop_ || !jobs_.empty(); });
+    if (jobs_.empty()) {
+      return;
+    }
+    Job job = std::move(jobs_.front());
+    jobs_.pop_front();
+    busy_ = true;
+    lock.unlock();
+    // a full queue can take the next job now
+    done_cv_.notify_all();
+
+    string error;
+    try {
+      job();
+    }
+    catch (std::exception & e) {
+      error = e.what();
+    }
+
+    lock.lock();
+    busy_ = false;
+    ++num_jobs_;
+    if (!error.empty() && error_.empty()) {
+      error_ = error;
+    }
+    done_cv_.notify_all();
+  }
+}
+
+}  // namespace pono
@@ -0,0 +1,92 @@
+/*********************                                                        */
+/*! \file witness_writer.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Writes the results and witnesses from a background thread (see
+**        --witness-queue), so that printing a large witness overlaps
+**        with checking the next property.
+**
+**        The jobs run one at a time in the order they were posted, so
+**        the output is the same as when writing synchronously. The terms
+**        of a witness belong to a solver that the next property keeps
+**        using, so a job must not touch terms: the witness is converted
+**        to text (or the value changes of a VCD file) before it is
+**        posted, and the job only does the I/O.
+**
+**/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace pono {
+
+class WitnessWriter
+{
+ public:
+  typedef std::function<void()> Job;
+
+  /** @param max_jobs the jobs queued before post waits for the writer,
+   *         0 runs each job when it is posted (no thread)
+   *  @param out the stream print writes to
+   */
+  WitnessWriter(size_t max_jobs = 4, std::ostream & out = std::cout);
+
+  /** Waits for the queued jobs, errors are only logged */
+  ~WitnessWriter();
+
+  /** Run a job after the ones posted before
+   *  Waits while max_jobs jobs are queued.
+   *  @param job the job, must not use solver terms
+   *  @throws PonoException if there is no thread and the job throws
+   */
+  void post(const Job & job);
+
+  /** Write text to the output after the jobs posted before */
+  void print(std::string text);
+
+  /** Wait until the queued jobs are done
+   *  @throws PonoException with the message of the first job that threw
+   *          since the last flush
+   */
+  void flush();
+
+  /** Wait until the queued jobs are done, keeping the errors for flush
+   *  (e.g. before reporting another error)
+   */
+  void wait();
+
+  /** @return the number of jobs run so far */
+  size_t num_jobs() const;
+
+ protected:
+  void run();
+
+  size_t max_jobs_;
+  std::ostream & out_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;       ///< signals new jobs and stopping
+  std::condition_variable done_cv_;  ///< signals finished jobs
+  std::deque<Job> jobs_;
+  bool busy_;  ///< a job is running
+  bool stop_;
+  size_t num_jobs_;
+  std::string error_;  ///< the first error since the last flush
+  std::thread thread_;
+};
+
+}  // namespace pono
@@ -1,4 +1,4 @@
-from libc.stdint cimport uint64_t
+from libc.stdint cimport uint8_t, uint32_t, uint64_t
 from libcpp cimport bool
 from libcpp.pair cimport pair
 from libcpp.string cimport string
@@ -19,12 +19,15 @@ cdef extern from "core/ts.h" namespace "pono":
         void set_init(const c_Term & init) except +
         void constrain_init(const c_Term & constraint) except +
         void assign_next(const c_Term & state, const c_Term & val) except +
+        void assign_next(const c_TermVec & states, const c_TermVec & vals) except +
         void add_invar(const c_Term & constraint) except +
         void constrain_inputs(const c_Term & constraint) except +
         void add_constraint(const c_Term & constraint, bint to_init_and_next) except +
         void name_term(const string name, const c_Term & t) except +
         c_Term make_inputvar(const string name, const c_Sort & sort) except +
         c_Term make_statevar(const string name, const c_Sort & sort) except +
+        c_TermVec make_inputvars(const vector[pair[string, c_Sort]] & vars) except +
+        c_TermVec make_statevars(const vector[pair[string, c_Sort]] & vars) except +
         c_Term curr(const c_Term & term) except +
         c_Term next(const c_Term & term) except +
         bint is_curr_var(const c_Term & sv) except +
@@ -59,6 +62,7 @@ cdef extern from "core/ts.h" namespace "pono":
         c_Term make_term(const string val, const c_Sort & sort, uint64_t base) except +
         c_Term make_term(const c_Term & val, const c_Sort & sort) except +
         c_Term make_term(const c_Op op, const c_TermVec & terms) except +
+        c_TermVec make_terms(const c_TermVec & leaves, const vector[c_Op] & ops, const vector[uint64_t] & tape) except +
 
 
 cdef extern from "core/rts.h" namespace "pono":
@@ -105,10 +109,12 @@ cdef extern from "engines/prover.h" namespace "pono":
         Prover(const Property & p, const TransitionSystem & ts,
                c_SmtSolver & s) except +
         void initialize() except +
-        ProverResult check_until(int k) except +
-        bint witness(vector[c_UnorderedTermMap] & out) except +
+        # the long running calls release the GIL, see __AbstractProver
+        ProverResult check_until(int k) nogil except +
+        bint witness(vector[c_UnorderedTermMap] & out) nogil except +
         c_Term invar() except +
-        ProverResult prove() except +
+        ProverResult prove() nogil except +
+        void interrupt() nogil
 
 
 cdef extern from "engines/bmc.h" namespace "pono":
@@ -223,9 +229,14 @@ cdef extern from "modifiers/mod_ts_prop.h" namespace "pono":
     void prop_in_trans(TransitionSystem & ts, const c_Term & prop) except +
 
 cdef extern from "options/options.h" namespace "pono":
+    cdef enum Engine:
+        NONE
+    string engine_to_string "pono::to_string" (Engine e) except +
+
     cdef cppclass PonoOptions:
         PonoOptions() except +
         ProverResult parse_and_set_options(vector[string] & opts, bint expect_file) except +
+        Engine to_engine(string s) except +
 
 cdef extern from "printers/vcd_witness_printer.h" namespace "pono":
     cdef cppclass VCDWitnessPrinter:
@@ -233,6 +244,19 @@ cdef extern from "printers/vcd_witness_printer.h" namespace "pono":
                           vector[c_UnorderedTermMap] & cex)
         void dump_trace_to_file(const string & vcd_file_name) except +
 
+cdef extern from "printers/witness_values.h" namespace "pono":
+    cdef cppclass WitnessTable:
+        vector[string] names
+        vector[uint32_t] widths
+        vector[uint32_t] offsets
+        uint32_t row_words
+        size_t num_frames
+        vector[uint64_t] values
+        vector[uint8_t] known
+
+    void witness_table(const vector[c_UnorderedTermMap] & cex,
+                       WitnessTable & out) except +
+
 cdef extern from "utils/logger.h" namespace "pono":
     void set_global_logger_verbosity(unsigned int v) except +
 
@@ -241,3 +265,28 @@ cdef extern from "utils/ts_analysis.h" namespace "pono":
                      const c_Term & prop,
                      const c_Term & invar) except +
 
+cdef extern from "utils/ts_snapshot.h" namespace "pono":
+    string ts_snapshot(const TransitionSystem & ts,
+                       const c_TermVec & props) except +
+    bint ts_snapshot_is_functional(const char * data, size_t size) except +
+    void load_ts_snapshot(const char * data,
+                          size_t size,
+                          TransitionSystem & ts,
+                          c_TermVec & props) except +
+
+cdef extern from "utils/batch_check.h" namespace "pono":
+    cdef struct BatchResult:
+        size_t idx
+        ProverResult result
+        Engine engine
+
+    cdef cppclass BatchChecker:
+        BatchChecker(const TransitionSystem & ts,
+                     const c_TermVec & props,
+                     const vector[Engine] & engines,
+                     int k,
+                     const PonoOptions & opts) except +
+        # the long running calls release the GIL, see PropertyBatch
+        void run() nogil except +
+        bint next_result(BatchResult & out) nogil
+        void interrupt() nogil
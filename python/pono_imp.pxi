@@ -1,5 +1,7 @@
+from cpython cimport array
 from cython.operator cimport dereference as dref, preincrement as inc
-from libc.stdint cimport uintptr_t
+from libc.stdint cimport uint64_t, uintptr_t
+from libc.string cimport memcpy
 from libcpp cimport bool as cbool
 from libcpp.pair cimport pair
 from libcpp.string cimport string
@@ -35,19 +37,32 @@ IF WITH_COREIR == "ON":
     from pono_imp cimport Module as c_Module
     from pono_imp cimport CoreIREncoder as c_CoreIREncoder
 from pono_imp cimport PonoOptions as c_PonoOptions
+from pono_imp cimport Engine as c_Engine
+from pono_imp cimport engine_to_string as c_engine_to_string
+from pono_imp cimport BatchResult as c_BatchResult
+from pono_imp cimport BatchChecker as c_BatchChecker
 from pono_imp cimport HistoryModifier as c_HistoryModifier
 from pono_imp cimport StaticConeOfInfluence as c_StaticConeOfInfluence
 from pono_imp cimport add_prop_monitor as c_add_prop_monitor
 from pono_imp cimport VCDWitnessPrinter as c_VCDWitnessPrinter
+from pono_imp cimport WitnessTable as c_WitnessTable
+from pono_imp cimport witness_table as c_witness_table
 from pono_imp cimport pseudo_init_and_prop as c_pseudo_init_and_prop
 from pono_imp cimport prop_in_trans as c_prop_in_trans
 from pono_imp cimport set_global_logger_verbosity as c_set_global_logger_verbosity
 from pono_imp cimport check_invar as c_check_invar
+from pono_imp cimport ts_snapshot as c_ts_snapshot
+from pono_imp cimport ts_snapshot_is_functional as c_ts_snapshot_is_functional
+from pono_imp cimport load_ts_snapshot as c_load_ts_snapshot
 
-from smt_switch cimport SmtSolver, PrimOp, Op, c_SortKind, SortKind, \
+from smt_switch cimport SmtSolver, PrimOp, Op, c_Op, c_SortKind, SortKind, \
     c_Sort, c_SortVec, Sort, Term, c_Term, c_TermVec, c_UnorderedTermMap
 
+import array
+from collections import namedtuple
+from concurrent.futures import Future
 from enum import Enum
+import threading
 
 PYCOREIR_AVAILABLE=False
 IF WITH_COREIR == "ON":
@@ -81,6 +96,20 @@ cdef class __AbstractTransitionSystem:
     def assign_next(self, Term state, Term val):
         dref(self.cts).assign_next(state.ct, val.ct)
 
+    def assign_nexts(self, dict updates):
+        '''
+        Assign the next state functions of many state variables in one call
+        @param updates dictionary from state variables to their updates
+        '''
+        cdef c_TermVec c_states
+        cdef c_TermVec c_vals
+        c_states.reserve(len(updates))
+        c_vals.reserve(len(updates))
+        for k, v in updates.items():
+            c_states.push_back((<Term?> k).ct)
+            c_vals.push_back((<Term?> v).ct)
+        dref(self.cts).assign_next(c_states, c_vals)
+
     def add_invar(self, Term constraint):
         dref(self.cts).add_invar(constraint.ct)
 
@@ -103,6 +132,39 @@ cdef class __AbstractTransitionSystem:
         term.ct = dref(self.cts).make_statevar(name.encode(), sort.cs)
         return term
 
+    def make_inputvars(self, list vars):
+        '''
+        Create many inputs in one call
+        @param vars list of (name, sort) pairs
+        @return the list of inputs
+        '''
+        return self._wrap_terms(dref(self.cts).make_inputvars(self._to_c_vars(vars)))
+
+    def make_statevars(self, list vars):
+        '''
+        Create many states in one call
+        @param vars list of (name, sort) pairs
+        @return the list of current state variables
+        '''
+        return self._wrap_terms(dref(self.cts).make_statevars(self._to_c_vars(vars)))
+
+    cdef vector[pair[string, c_Sort]] _to_c_vars(self, list vars):
+        cdef vector[pair[string, c_Sort]] c_vars
+        c_vars.reserve(len(vars))
+        for name, sort in vars:
+            c_vars.push_back(pair[string, c_Sort](<const string?> name.encode(),
+                                                  (<Sort?> sort).cs))
+        return c_vars
+
+    cdef list _wrap_terms(self, const c_TermVec & c_terms):
+        cdef Term term
+        res = []
+        for ct in c_terms:
+            term = Term(self._solver)
+            term.ct = ct
+            res.append(term)
+        return res
+
     def curr(self, Term t):
         cdef Term term = Term(self._solver)
         term.ct = dref(self.cts).curr(t.ct)
@@ -283,6 +345,22 @@ cdef class __AbstractTransitionSystem:
 
         dref(self.cts).replace_terms(utm)
 
+    def snapshot(self, list props=[]):
+        '''
+        @param props the properties (terms of this system) to include
+        @return the binary snapshot (bytes) of the system and properties,
+                which load_snapshot rebuilds in any solver
+        '''
+        cdef c_TermVec c_props
+        for p in props:
+            c_props.push_back((<Term?> p).ct)
+        return <bytes> c_ts_snapshot(dref(self.cts), c_props)
+
+    def __reduce__(self):
+        # solvers can't be pickled, the system is rebuilt from its
+        # snapshot in the solver given by set_unpickle_solver
+        return (_ts_from_snapshot, (self.snapshot(),))
+
     def make_sort(self, arg0, arg1=None, arg2=None, arg3=None):
         cdef Sort s = Sort(self._solver)
         cdef c_SortKind sk
@@ -363,6 +441,34 @@ cdef class __AbstractTransitionSystem:
                                                                               for a in [op_or_val] + args]))
         return term
 
+    def make_terms(self, list leaves, list ops, tape):
+        '''
+        Make many terms in one call from a tape of integers
+        The tape is a sequence of entries op_index, n, a_1, ..., a_n, each
+          making the term ops[op_index](t_a_1, ..., t_a_n). Argument i
+          refers to leaves[i] if i < len(leaves), and otherwise to the
+          (i - len(leaves))-th term made by the tape.
+        @param leaves the terms made beforehand (variables, values)
+        @param ops the operators (Op or PrimOp) of the tape
+        @param tape an iterable of non-negative ints, e.g. an array('Q')
+        @return the list of terms made, one per entry
+        '''
+        cdef c_TermVec c_leaves
+        cdef vector[c_Op] c_ops
+        cdef vector[uint64_t] c_tape
+
+        c_leaves.reserve(len(leaves))
+        for l in leaves:
+            c_leaves.push_back((<Term?> l).ct)
+        c_ops.reserve(len(ops))
+        for o in ops:
+            if isinstance(o, PrimOp):
+                o = Op(o)
+            c_ops.push_back((<Op?> o).op)
+        for v in tape:
+            c_tape.push_back(v)
+        return self._wrap_terms(dref(self.cts).make_terms(c_leaves, c_ops, c_tape))
+
 
 cdef class RelationalTransitionSystem(__AbstractTransitionSystem):
     def __cinit__(self, SmtSolver s):
@@ -450,6 +556,36 @@ cdef class Unroller:
         return dref(self.cu).get_var_time(v.ct)
 
 
+# A witness in columns, see __AbstractProver.witness_table
+WitnessTable = namedtuple('WitnessTable', ['names', 'widths', 'offsets',
+                                           'row_words', 'num_frames',
+                                           'values', 'known'])
+
+
+# the solvers used by a running prover call
+# solvers are not thread-safe, so two provers can only run at the same time
+# (in different threads) if they have their own solver
+_busy_solvers = set()
+_busy_solvers_lock = threading.Lock()
+
+
+class ProverFuture(Future):
+    '''
+    The result of an asynchronous prover call
+    Cancelling it while the call is running interrupts the prover, which then
+    stops at its next solver query and the result is None (unknown).
+    '''
+    def __init__(self, prover):
+        super().__init__()
+        self._prover = prover
+
+    def cancel(self):
+        if super().cancel():
+            return True
+        self._prover.interrupt()
+        return False
+
+
 cdef class __AbstractProver:
     # this pointer is allocated and deallocated by derived classes
     cdef c_Prover* cp
@@ -457,14 +593,35 @@ cdef class __AbstractProver:
     cdef __AbstractTransitionSystem _ts
     cdef SmtSolver _solver
 
+    def _acquire_solver(self):
+        with _busy_solvers_lock:
+            if id(self._solver) in _busy_solvers:
+                raise RuntimeError("The solver of this prover is used by a "
+                                   "running prover call, provers running "
+                                   "at the same time need their own solver")
+            _busy_solvers.add(id(self._solver))
+
+    def _release_solver(self):
+        with _busy_solvers_lock:
+            _busy_solvers.discard(id(self._solver))
+
     def initialize(self):
         dref(self.cp).initialize()
 
     def check_until(self, int k):
         '''
         Checks until bound k, returns True, False or None (if unknown)
+        Releases the GIL while checking.
         '''
-        cdef int r = <int> dref(self.cp).check_until(k)
+        cdef c_ProverResult res
+        cdef int r
+        self._acquire_solver()
+        try:
+            with nogil:
+                res = dref(self.cp).check_until(k)
+        finally:
+            self._release_solver()
+        r = <int> res
         if r == (<int> c_UNKNOWN):
             return None
         elif r == (<int> c_FALSE):
@@ -472,9 +629,39 @@ cdef class __AbstractProver:
         elif r == (<int> c_TRUE):
             return True
 
+    def check_until_async(self, int k):
+        '''
+        Checks until bound k in a new thread
+        Returns a ProverFuture for the result of check_until
+        '''
+        f = ProverFuture(self)
+        def run():
+            if not f.set_running_or_notify_cancel():
+                return
+            try:
+                f.set_result(self.check_until(k))
+            except BaseException as e:
+                f.set_exception(e)
+        threading.Thread(target=run, daemon=True).start()
+        return f
+
+    def interrupt(self):
+        '''
+        Asks a running check_until or prove (e.g. in another thread) to stop
+        at its next solver query, it then returns None (unknown)
+        The prover stays interrupted, later calls return None as well.
+        '''
+        dref(self.cp).interrupt()
+
     def witness(self):
         cdef vector[c_UnorderedTermMap] cw
-        success = dref(self.cp).witness(cw)
+        cdef cbool success
+        self._acquire_solver()
+        try:
+            with nogil:
+                success = dref(self.cp).witness(cw)
+        finally:
+            self._release_solver()
 
         if not success:
             return None
@@ -494,6 +681,67 @@ cdef class __AbstractProver:
 
         return w
 
+    def witness_table(self):
+        '''
+        Returns the witness as a WitnessTable (or None if there is none),
+        without creating a Python object per value:
+          names, widths: the variable of each column, and its width
+          offsets: the first word of each column in a row
+          row_words: the number of words in a row (one row per frame)
+          values: an array of num_frames * row_words unsigned 64-bit words,
+                  a value takes ceil(width / 64) words, least significant first
+          known: num_frames * len(names) bytes, 1 iff the frame has the value
+        e.g. numpy.frombuffer(t.values, numpy.uint64).reshape(t.num_frames, -1)
+        '''
+        cdef vector[c_UnorderedTermMap] cw
+        cdef c_WitnessTable table
+        cdef cbool success
+        cdef size_t n
+        cdef array.array values
+        self._acquire_solver()
+        try:
+            with nogil:
+                success = dref(self.cp).witness(cw)
+        finally:
+            self._release_solver()
+        if not success:
+            return None
+        c_witness_table(cw, table)
+
+        n = table.values.size()
+        values = array.clone(array.array('Q'), n, zero=False)
+        if n:
+            memcpy(values.data.as_voidptr, table.values.data(), n * sizeof(uint64_t))
+        known = b''
+        if table.known.size():
+            known = (<char *> table.known.data())[:table.known.size()]
+        return WitnessTable([name.decode() for name in table.names],
+                            list(table.widths), list(table.offsets),
+                            table.row_words, table.num_frames, values, known)
+
+    def dump_witness_vcd(self, str vcd_file_name):
+        '''
+        Writes the witness to a VCD file without converting it to Python,
+        returns False if there is no witness
+        '''
+        cdef vector[c_UnorderedTermMap] cw
+        cdef cbool success
+        cdef c_VCDWitnessPrinter * printer
+        self._acquire_solver()
+        try:
+            with nogil:
+                success = dref(self.cp).witness(cw)
+        finally:
+            self._release_solver()
+        if not success:
+            return False
+        printer = new c_VCDWitnessPrinter(dref(self._ts.cts), cw)
+        try:
+            dref(printer).dump_trace_to_file(vcd_file_name.encode())
+        finally:
+            del printer
+        return True
+
     def invar(self):
         cdef Term inv = Term(self._solver)
         inv.ct = dref(self.cp).invar()
@@ -502,8 +750,17 @@ cdef class __AbstractProver:
     def prove(self):
         '''
         Tries to prove property unboundedly, returns True, False or None (if unknown)
+        Releases the GIL while proving.
         '''
-        cdef int r = <int> dref(self.cp).prove()
+        cdef c_ProverResult res
+        cdef int r
+        self._acquire_solver()
+        try:
+            with nogil:
+                res = dref(self.cp).prove()
+        finally:
+            self._release_solver()
+        r = <int> res
 
         if r == (<int> c_UNKNOWN):
             return None
@@ -729,6 +986,105 @@ def parse_options(list opts):
 
     return pono_opts
 
+cdef class PropertyBatch:
+    '''
+    Checks many properties of a transition system in one call, racing the
+    given engines on each property (see run_portfolio). The cone-of-influence
+    analysis of the system is shared by the properties, and each engine
+    runs in its own solver.
+    The properties are checked in a background thread without the GIL.
+    Iterating gives (property index, result, engine name) as they
+    complete, with result True, False or None (unknown).
+    The solver of ts is busy until the iteration ends.
+    '''
+    cdef c_BatchChecker * cbc
+    cdef __AbstractTransitionSystem _ts
+    cdef object _thread
+    cdef object _error
+
+    def __cinit__(self, __AbstractTransitionSystem ts, list props,
+                  list engines, int k, PonoOptions options=None):
+        cdef c_TermVec c_props
+        cdef vector[c_Engine] c_engines
+        cdef c_PonoOptions c_opts
+        if options is not None:
+            c_opts = options.cpo
+        for p in props:
+            c_props.push_back((<Term?> p).ct)
+        for e in engines:
+            c_engines.push_back(c_opts.to_engine((<str?> e).encode()))
+        self.cbc = new c_BatchChecker(dref(ts.cts), c_props, c_engines, k, c_opts)
+        self._ts = ts
+        self._error = None
+
+        with _busy_solvers_lock:
+            if id(ts._solver) in _busy_solvers:
+                del self.cbc
+                self.cbc = NULL
+                raise RuntimeError("The solver of this system is used by a "
+                                   "running prover call")
+            _busy_solvers.add(id(ts._solver))
+        self._thread = threading.Thread(target=self._run, daemon=True)
+        self._thread.start()
+
+    def _run(self):
+        try:
+            with nogil:
+                self.cbc.run()
+        except BaseException as e:
+            self._error = e
+        finally:
+            with _busy_solvers_lock:
+                _busy_solvers.discard(id(self._ts._solver))
+
+    def __iter__(self):
+        return self
+
+    def __next__(self):
+        cdef c_BatchResult r
+        cdef cbool found
+        cdef int res
+        with nogil:
+            found = self.cbc.next_result(r)
+        if not found:
+            self._thread.join()
+            if self._error is not None:
+                raise self._error
+            raise StopIteration
+
+        res = <int> r.result
+        if res == (<int> c_TRUE):
+            py_res = True
+        elif res == (<int> c_FALSE):
+            py_res = False
+        else:
+            py_res = None
+        return (r.idx, py_res, c_engine_to_string(r.engine).decode())
+
+    def interrupt(self):
+        '''
+        The properties that are not started yet are reported as unknown
+        '''
+        self.cbc.interrupt()
+
+    def __dealloc__(self):
+        # the running thread keeps a reference to self
+        if self.cbc != NULL:
+            del self.cbc
+
+def check_properties(__AbstractTransitionSystem ts, list props, list engines,
+                     int k, PonoOptions options=None):
+    '''
+    Check many properties of ts in one call
+    @param props the property terms
+    @param engines the engine names (as for --engine) raced on each property
+    @param k the bound
+    @param options a PonoOptions from parse_options
+    @return a PropertyBatch, an iterator over the (index, result, engine)
+            of the properties as they complete
+    '''
+    return PropertyBatch(ts, props, engines, k, options)
+
 cdef class HistoryModifier:
     cdef c_HistoryModifier * chm
     cdef __AbstractTransitionSystem _ts
@@ -780,6 +1136,46 @@ def pseudo_init_and_prop(__AbstractTransitionSystem ts, Term prop):
 def prop_in_trans(__AbstractTransitionSystem ts, Term prop):
     c_prop_in_trans(dref(ts.cts), prop.ct)
 
+def load_snapshot(bytes data, SmtSolver solver):
+    '''
+    Rebuild a system saved by snapshot (or --save-snapshot) in solver
+    @return (the system, the list of properties)
+    '''
+    cdef const char * c_data = data
+    cdef size_t size = len(data)
+    cdef c_TermVec c_props
+    cdef Term term
+    if c_ts_snapshot_is_functional(c_data, size):
+        ts = FunctionalTransitionSystem(solver)
+    else:
+        ts = RelationalTransitionSystem(solver)
+    c_load_ts_snapshot(c_data, size, dref((<__AbstractTransitionSystem> ts).cts), c_props)
+    props = []
+    for ct in c_props:
+        term = Term(solver)
+        term.ct = ct
+        props.append(term)
+    return ts, props
+
+_unpickle_solver_factory = None
+
+def set_unpickle_solver(factory):
+    '''
+    Set the function, without arguments, that returns the solver of each
+    unpickled system (e.g. in the initializer of a worker process).
+    By default, a fresh solver of the first available backend.
+    '''
+    global _unpickle_solver_factory
+    _unpickle_solver_factory = factory
+
+def _ts_from_snapshot(bytes data):
+    if _unpickle_solver_factory is None:
+        import smt_switch
+        solver = next(iter(smt_switch.solvers.values()))(False)
+    else:
+        solver = _unpickle_solver_factory()
+    return load_snapshot(data, solver)[0]
+
 def set_global_logger_verbosity(int v):
     c_set_global_logger_verbosity(v)
 
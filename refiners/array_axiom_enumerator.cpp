@@ -137,10 +137,16 @@ WalkerStepResult ArrayFinder::visit_term(Term & term)
 ArrayAxiomEnumerator::ArrayAxiomEnumerator(ArrayAbstractor & aa,
                                            Unroller & un,
                                            const Term & prop,
-                                           bool red_axioms)
-    : super(aa.abs_ts()), aa_(aa), un_(un), reduce_axioms_unsatcore_(red_axioms)
+                                           bool red_axioms,
+                                           bool incremental)
+    : super(aa.abs_ts()),
+      aa_(aa),
+      un_(un),
+      reduce_axioms_unsatcore_(red_axioms),
+      incremental_(incremental)
 {
   conc_bad_ = solver_->make_term(Not, prop);
+  true_ = solver_->make_term(true);
   false_ = solver_->make_term(false);
 }
 
@@ -183,6 +189,8 @@ bool ArrayAxiomEnumerator::enumerate_axioms(const Term & abs_trace_formula,
   bool only_curr = (bound == 0);
   while (res.is_sat()) {
     bool found_lemmas = false;
+    // values from the previous model are stale
+    model_cache_.clear();
 
     // check axioms
     // heuristic order -- all need to be checked for completeness
@@ -225,6 +233,7 @@ bool ArrayAxiomEnumerator::enumerate_axioms(const Term & abs_trace_formula,
 
     if (!found_lemmas) {
       // there appears to be a concrete counterexample
+      model_cache_.clear();
       solver_->pop();
       return false;
     }
@@ -284,10 +293,37 @@ bool ArrayAxiomEnumerator::enumerate_axioms(const Term & abs_trace_formula,
     }
   }
 
+  model_cache_.clear();
   solver_->pop();
   return true;
 }
 
+void ArrayAxiomEnumerator::report_statistics(Statistics & stats) const
+{
+  size_t num_candidates = 0;
+  size_t num_candidate_indices = 0;
+  for (const auto & elem : consecutive_candidates_) {
+    num_candidates += elem.second.axioms.size();
+    num_candidate_indices += elem.second.indices.size();
+  }
+  for (const auto & elem : nonconsecutive_candidates_) {
+    num_candidates += elem.second.axioms.size();
+    num_candidate_indices += elem.second.indices.size();
+  }
+  stats.set("aae_index_set", index_set_.size());
+  stats.set("aae_candidate_axioms", num_candidates);
+  stats.set("aae_candidate_indices", num_candidate_indices);
+  stats.set("aae_consecutive_axioms", consecutive_axioms_.size());
+  stats.set("aae_nonconsecutive_axioms", nonconsecutive_axioms_.size());
+  stats.set("aae_untime_index_cache", untime_index_cache_.size());
+}
+
+void ArrayAxiomEnumerator::clear_candidates()
+{
+  consecutive_candidates_.clear();
+  nonconsecutive_candidates_.clear();
+}
+
 void ArrayAxiomEnumerator::add_index(const Term & idx)
 {
   index_set_.insert(idx);
@@ -305,6 +341,38 @@ bool ArrayAxiomEnumerator::check_consecutive_axioms(AxiomClass ac,
   logger.log(3, "Checking consecutive axioms for class: {}", to_string(ac));
   UnorderedTermSet & indices = only_curr ? cur_index_set_ : index_set_;
 
+  if (incremental_) {
+    // in incremental mode, only_curr is checked per axiom below
+    // so the candidates can always be instantiated over all indices
+    // (an axiom over a non-current index is not over current vars only)
+    const AxiomCandidates & cands =
+        candidate_axioms(ac, index_set_, consecutive_candidates_[ac]);
+    size_t num_found_lemmas = 0;
+    Term unrolled_ax;
+    for (size_t j = 0; j < cands.axioms.size(); ++j) {
+      const Term & ax = cands.axioms[j].ax;
+      bool ax_only_curr = cands.only_curr[j];
+      if (only_curr && !ax_only_curr) {
+        continue;
+      }
+      size_t max_k = ax_only_curr ? bound_ : bound_ - 1;
+      for (size_t k = 0; k <= max_k; ++k) {
+        unrolled_ax = un_.at_time(ax, k);
+        if (is_violated(unrolled_ax)) {
+          logger.log(4, "Violated Axiom: {}", unrolled_ax);
+          violated_axioms_.insert(unrolled_ax);
+          ts_axioms_[unrolled_ax] = ax;
+          num_found_lemmas++;
+
+          if (lemma_limit > 0 && num_found_lemmas >= lemma_limit) {
+            return num_found_lemmas;
+          }
+        }
+      }
+    }
+    return num_found_lemmas;
+  }
+
   UnorderedTermSet axioms_to_check;
   if (index_axiom_classes.find(ac) == index_axiom_classes.end()) {
     axioms_to_check = non_index_axioms(ac);
@@ -369,7 +437,10 @@ bool ArrayAxiomEnumerator::check_nonconsecutive_axioms(AxiomClass ac,
   // must be within bound
   assert(i <= bound_);
 
-  UnorderedTermSet & indices = only_curr ? cur_index_set_ : index_set_;
+  // see check_consecutive_axioms for why incremental mode
+  // can use all the indices
+  UnorderedTermSet & indices =
+      (only_curr && !incremental_) ? cur_index_set_ : index_set_;
   UnorderedTermSet unrolled_indices;
   Term unrolled_idx;
   for (auto idx : indices) {
@@ -393,8 +464,24 @@ bool ArrayAxiomEnumerator::check_nonconsecutive_axioms(AxiomClass ac,
   // but the rest of the axiom is not, until later
   size_t num_found_lemmas = 0;
   Term unrolled_ax;
-  for (AxiomInstantiation ax_inst : index_axioms(ac, unrolled_indices)) {
-    if (only_curr && !ts_.only_curr(ax_inst.ax)) {
+  AxiomVec fresh_axioms;
+  const AxiomVec * axioms = &fresh_axioms;
+  const std::vector<bool> * cached_only_curr = nullptr;
+  if (incremental_) {
+    const AxiomCandidates & cands =
+        candidate_axioms(ac,
+                         unrolled_indices,
+                         nonconsecutive_candidates_[{ ac, i }]);
+    axioms = &cands.axioms;
+    cached_only_curr = &cands.only_curr;
+  } else {
+    fresh_axioms = index_axioms(ac, unrolled_indices);
+  }
+  for (size_t j = 0; j < axioms->size(); ++j) {
+    const AxiomInstantiation & ax_inst = (*axioms)[j];
+    bool ax_only_curr =
+        cached_only_curr ? (*cached_only_curr)[j] : ts_.only_curr(ax_inst.ax);
+    if (only_curr && !ax_only_curr) {
       // if requesting axioms over only current state variables
       // and this axiom isn't, then continue
       continue;
@@ -407,7 +494,7 @@ bool ArrayAxiomEnumerator::check_nonconsecutive_axioms(AxiomClass ac,
     //    this would get unrolled for different k values, for k = 3 it would be:
     //             i@1 != j@3 -> read(write(a@3, j@3, e@3), i@1) = read(a@3,
     //             i@1)
-    size_t max_k = ts_.only_curr(ax_inst.ax) ? bound_ : bound_ - 1;
+    size_t max_k = ax_only_curr ? bound_ : bound_ - 1;
     for (size_t k = 0; k <= max_k; ++k) {
       unrolled_ax = un_.at_time(ax_inst.ax, k);
       if (is_violated(unrolled_ax)) {
@@ -497,13 +584,113 @@ void ArrayAxiomEnumerator::clear_state()
 bool ArrayAxiomEnumerator::is_violated(const Term & ax) const
 {
   assert(ax->get_sort()->get_sort_kind() == BOOL);
-  Term val = solver_->get_value(ax);
-  // expecting to have solver options such that
-  // we can get the value of arbitrary axioms
-  assert(val->is_value());
+  // the candidate axioms share most of their subterms (reads at the
+  // same indices, index disequalities), so evaluating them with the
+  // cached model takes far fewer solver queries than asking for the
+  // value of each axiom
+  Term val = model_value(ax);
+  assert(val == solver_->get_value(ax));
   return val == false_;
 }
 
+// helper for model_value
+// parses an integer value, printed either as n or (- n)
+static bool int_value(const Term & val, mpz_class & out)
+{
+  string repr = val->to_string();
+  bool neg = false;
+  if (repr.size() > 4 && repr.substr(0, 3) == "(- "
+      && repr.back() == ')') {
+    neg = true;
+    repr = repr.substr(3, repr.size() - 4);
+  }
+  if (out.set_str(repr, 10) != 0) {
+    return false;
+  }
+  if (neg) {
+    out = -out;
+  }
+  return true;
+}
+
+Term ArrayAxiomEnumerator::model_value(const Term & t) const
+{
+  auto it = model_cache_.find(t);
+  if (it != model_cache_.end()) {
+    return it->second;
+  }
+
+  Term res;
+  Op op = t->get_op();
+  PrimOp po = op.prim_op;
+  if (po == Not || po == And || po == Or || po == Implies) {
+    TermVec vals;
+    for (auto c : t) {
+      vals.push_back(model_value(c));
+    }
+    bool b;
+    if (po == Not) {
+      assert(vals.size() == 1);
+      b = vals[0] == false_;
+    } else if (po == Implies) {
+      assert(vals.size() == 2);
+      b = vals[0] == false_ || vals[1] == true_;
+    } else {
+      bool is_and = po == And;
+      b = is_and;
+      for (auto v : vals) {
+        if ((v == true_) != is_and) {
+          b = !is_and;
+          break;
+        }
+      }
+    }
+    res = b ? true_ : false_;
+  } else if (po == Equal || po == Distinct) {
+    TermVec vals;
+    for (auto c : t) {
+      vals.push_back(model_value(c));
+    }
+    // values are unique in the model, so equal values are the same term
+    bool all_diff = true;
+    for (size_t i = 0; all_diff && i < vals.size(); ++i) {
+      for (size_t j = i + 1; j < vals.size(); ++j) {
+        if (vals[i] == vals[j]) {
+          all_diff = false;
+          break;
+        }
+      }
+    }
+    assert(po == Distinct || vals.size() == 2);
+    res = (po == Distinct) == all_diff ? true_ : false_;
+  } else if (po == Ite) {
+    TermVec children(t->begin(), t->end());
+    assert(children.size() == 3);
+    res = model_value(children[0]) == true_ ? model_value(children[1])
+                                            : model_value(children[2]);
+  } else if ((po == Lt || po == Le || po == Gt || po == Ge)
+             && (*t->begin())->get_sort()->get_sort_kind() == INT) {
+    TermVec children(t->begin(), t->end());
+    assert(children.size() == 2);
+    mpz_class v0, v1;
+    if (int_value(model_value(children[0]), v0)
+        && int_value(model_value(children[1]), v1)) {
+      int c = cmp(v0, v1);
+      bool b = (po == Lt) ? c < 0 : (po == Le) ? c <= 0 : (po == Gt) ? c > 0
+                                                                     : c >= 0;
+      res = b ? true_ : false_;
+    }
+  }
+
+  if (!res) {
+    // a leaf, or a value we couldn't parse
+    res = t->is_value() ? t : solver_->get_value(t);
+    assert(res->is_value());
+  }
+  model_cache_[t] = res;
+  return res;
+}
+
 UnorderedTermSet ArrayAxiomEnumerator::non_index_axioms(AxiomClass ac)
 {
   assert(index_axiom_classes.find(ac) == index_axiom_classes.end());
@@ -579,6 +766,41 @@ AxiomVec ArrayAxiomEnumerator::index_axioms(AxiomClass ac,
   return axioms_to_check;
 }
 
+const AxiomCandidates & ArrayAxiomEnumerator::candidate_axioms(
+    AxiomClass ac, UnorderedTermSet & indices, AxiomCandidates & cands)
+{
+  size_t old_size = cands.axioms.size();
+  if (index_axiom_classes.find(ac) == index_axiom_classes.end()) {
+    if (!cands.non_index_done) {
+      for (auto ax : non_index_axioms(ac)) {
+        cands.axioms.push_back(AxiomInstantiation(ax, {}));
+      }
+      cands.non_index_done = true;
+    }
+  } else {
+    UnorderedTermSet new_indices;
+    for (auto idx : indices) {
+      if (cands.indices.insert(idx).second) {
+        new_indices.insert(idx);
+      }
+    }
+    if (new_indices.size()) {
+      AxiomVec new_axioms = index_axioms(ac, new_indices);
+      cands.axioms.insert(
+          cands.axioms.end(), new_axioms.begin(), new_axioms.end());
+    }
+  }
+
+  for (size_t j = old_size; j < cands.axioms.size(); ++j) {
+    cands.only_curr.push_back(ts_.only_curr(cands.axioms[j].ax));
+  }
+  logger.log(3,
+             "{} new candidates for class {}",
+             cands.axioms.size() - old_size,
+             to_string(ac));
+  return cands;
+}
+
 Term ArrayAxiomEnumerator::constarr_axiom(const Term & constarr,
                                           const Term & val,
                                           const Term & index) const
@@ -15,6 +15,9 @@
 **/
 #pragma once
 
+#include <map>
+#include <utility>
+
 #include "smt-switch/identity_walker.h"
 
 #include "core/prop.h"
@@ -22,6 +25,7 @@
 #include "core/unroller.h"
 #include "modifiers/array_abstractor.h"
 #include "refiners/axiom_enumerator.h"
+#include "utils/statistics.h"
 
 namespace pono {
 
@@ -52,6 +56,18 @@ const std::unordered_set<AxiomClass> index_axiom_classes(
 // forward declaration for reference
 class ArrayAxiomEnumerator;
 
+// Axiom instantiations kept between calls to enumerate_axioms
+// in incremental mode, so that only the instantiations over
+// new indices are created
+struct AxiomCandidates
+{
+  smt::UnorderedTermSet indices;   ///< indices instantiated so far
+  AxiomVec axioms;                 ///< the instantiated axioms
+  std::vector<bool> only_curr;     ///< whether each axiom is only over
+                                   ///< current state variables
+  bool non_index_done = false;     ///< for classes without indices
+};
+
 // Walker for finding all the array terms and associated indices
 // takes the *concrete* transition system and collects all array
 // terms and indices and stores them in the appropriate
@@ -77,7 +93,8 @@ class ArrayAxiomEnumerator : public AxiomEnumerator
   ArrayAxiomEnumerator(ArrayAbstractor & aa,
                        Unroller & un,
                        const smt::Term & prop,
-                       bool red_axioms);
+                       bool red_axioms,
+                       bool incremental = false);
 
   typedef AxiomEnumerator super;
 
@@ -118,6 +135,17 @@ class ArrayAxiomEnumerator : public AxiomEnumerator
     return nonconsecutive_axioms_;
   }
 
+  /** Set the sizes of the index set and of the axiom candidates of
+   *  incremental mode in stats, prefixed by "aae_"
+   */
+  void report_statistics(Statistics & stats) const;
+
+  /** Drop the axiom candidates of incremental mode, they are
+   *  instantiated again when needed
+   *  Must not be called during enumerate_axioms.
+   */
+  void clear_candidates();
+
  protected:
   // helper functions
 
@@ -177,6 +205,18 @@ class ArrayAxiomEnumerator : public AxiomEnumerator
    */
   bool is_violated(const smt::Term & ax) const;
 
+  /** Evaluates a term in the current model
+   *  Boolean connectives, equalities and integer comparisons are
+   *  evaluated natively from the values of their children. Everything
+   *  else (variables, UF applications, other operators) is a leaf whose
+   *  value is queried from the solver once per model.
+   *  The cache must be cleared (see model_cache_) whenever the model
+   *  changes.
+   *  @param t the (unrolled) term to evaluate
+   *  @return the value of t
+   */
+  smt::Term model_value(const smt::Term & t) const;
+
   // methods for instantiating groups of axioms
   // uses helper methods below for single axioms
 
@@ -197,6 +237,18 @@ class ArrayAxiomEnumerator : public AxiomEnumerator
    */
   AxiomVec index_axioms(AxiomClass ac, smt::UnorderedTermSet & indices);
 
+  /** Extends the cached candidates of an axiom class with the
+   *  instantiations over indices that were not instantiated yet
+   *  (or with all the axioms of a class without indices, the first time)
+   *  @param ac the AxiomClass
+   *  @param indices the set of indices to check (can be unrolled or not)
+   *  @param cands the cached candidates to extend
+   *  @return the cached candidates
+   */
+  const AxiomCandidates & candidate_axioms(AxiomClass ac,
+                                           smt::UnorderedTermSet & indices,
+                                           AxiomCandidates & cands);
+
   // helper methods for instantiating single axioms
 
   /** Instantiates the axiom:
@@ -378,6 +430,7 @@ class ArrayAxiomEnumerator : public AxiomEnumerator
 
   bool reduce_axioms_unsatcore_;  ///< reduce generated axioms with an unsat
                                   ///< core if set to true
+  bool incremental_;  ///< keep axiom instantiations between refinements
 
   size_t bound_;  ///< the bound of the current abstract trace
   smt::UnorderedTermMap
@@ -417,7 +470,19 @@ class ArrayAxiomEnumerator : public AxiomEnumerator
 
   smt::UnorderedTermMap untime_index_cache_;
 
+  // candidates for incremental mode
+  std::unordered_map<int, AxiomCandidates>
+      consecutive_candidates_;  ///< maps AxiomClass to its candidates
+  std::map<std::pair<int, size_t>, AxiomCandidates>
+      nonconsecutive_candidates_;  ///< maps AxiomClass and the time of the
+                                   ///< indices to its candidates
+
+  mutable smt::UnorderedTermMap
+      model_cache_;  ///< values of terms in the current model,
+                     ///< cleared after each call to check_sat
+
   // useful terms
+  smt::Term true_;
   smt::Term false_;
 };
 
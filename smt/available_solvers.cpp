@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "assert.h"
+#include "smt/solver_profiles.h"
 
 // these two always included
 #include "smt-switch/boolector_factory.h"
@@ -137,6 +138,10 @@ SmtSolver create_solver_for(SolverEnum se,
       // below) not effective
       opts["preprocessor.toplevel_propagation"] = "false";
     }
+    // mathsat options are part of the configuration
+    for (const auto & opt : solver_profile_options(se, to_string(e))) {
+      opts[opt.first] = opt.second;
+    }
     msat_config cfg = get_msat_config_for_ic3(false, opts);
     msat_env env = msat_create_env(cfg);
     s = std::make_shared<MsatSolver>(cfg, env);
@@ -154,6 +159,9 @@ SmtSolver create_solver_for(SolverEnum se,
   if (ic3_engine) {
     s->set_opt("produce-unsat-assumptions", "true");
   }
+  for (const auto & opt : solver_profile_options(se, to_string(e))) {
+    s->set_opt(opt.first, opt.second);
+  }
   return s;
 }
 
@@ -164,11 +172,17 @@ SmtSolver create_reducer_for(SolverEnum se, Engine e, bool logging)
     s = create_solver_base(se, logging);
     s->set_opt("incremental", "true");
     s->set_opt("produce-unsat-assumptions", "true");
+    for (const auto & opt : solver_profile_options(se, "reducer")) {
+      s->set_opt(opt.first, opt.second);
+    }
   }
 #ifdef WITH_MSAT
   else {
     // no models needed for a reducer
     unordered_map<string, string> opts({ { "model_generation", "false" } });
+    for (const auto & opt : solver_profile_options(se, "reducer")) {
+      opts[opt.first] = opt.second;
+    }
     msat_config cfg = get_msat_config_for_ic3(false, opts);
     msat_env env = msat_create_env(cfg);
     s = std::make_shared<MsatSolver>(cfg, env);
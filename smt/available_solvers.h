@@ -17,12 +17,18 @@
 #pragma once
 
 #include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "options/options.h"
 #include "smt-switch/smt.h"
 
 namespace pono {
 
+/** solver options, as (name, value) pairs for set_opt */
+typedef std::vector<std::pair<std::string, std::string>> SolverOptions;
+
 /** Creates an SmtSolver of the provided type
  *  @param se the SolverEnum to identify which type of solver
  *  @param logging whether or not to keep track of term DAG at smt-switch level
@@ -36,6 +42,7 @@ smt::SmtSolver create_solver(smt::SolverEnum se, bool logging=false,
 
 // same as create_solver but will set reasonable options
 // for particular engines (mostly IC3-variants)
+// and the options of the loaded solver profiles (see solver_profiles.h)
 // the full_model parameter forces a solver configuration that supports full
 // model generation if it is false, it can still enable model generation
 // depending on the engine
@@ -50,6 +57,7 @@ smt::SmtSolver create_solver_for(smt::SolverEnum se,
 // for a reducing solver (e.g. produce-models off)
 // unsat cores on
 // and other solver-specific options where appropriate
+// (including the loaded solver profiles for the "reducer" engine)
 smt::SmtSolver create_reducer_for(smt::SolverEnum se, Engine e, bool logging);
 
 /** Creates an interpolating SmtSolver of the provided type */
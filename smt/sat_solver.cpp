@@ -0,0 +1,338 @@
+/*********************                                                        */
+/*! \file sat_solver.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A minimal incremental SAT solver interface over integer literals,
+**        for the engines that work on a CNF encoding of the system.
+**
+**/
+
+#include "smt/sat_solver.h"
+
+#include <cstdlib>
+
+#include "assert.h"
+#include "smt/available_solvers.h"
+#include "utils/exceptions.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+SmtSatSolver::SmtSatSolver(const SmtSolver & s)
+    : solver_(s),
+      true_(s->make_term(true)),
+      vars_(1),
+      neg_vars_(1),
+      core_computed_(false)
+{
+}
+
+SatLit SmtSatSolver::new_var()
+{
+  SatLit v = vars_.size();
+  Term var = solver_->make_symbol("__sat_" + std::to_string(v),
+                                  solver_->make_sort(BOOL));
+  vars_.push_back(var);
+  neg_vars_.push_back(solver_->make_term(Not, var));
+  return v;
+}
+
+void SmtSatSolver::add_clause(const vector<SatLit> & clause)
+{
+  if (clause.empty()) {
+    solver_->assert_formula(solver_->make_term(false));
+    return;
+  }
+  Term c = lit_term(clause[0]);
+  for (size_t i = 1; i < clause.size(); ++i) {
+    c = solver_->make_term(Or, c, lit_term(clause[i]));
+  }
+  solver_->assert_formula(c);
+}
+
+Result SmtSatSolver::solve(const vector<SatLit> & assumps)
+{
+  assumps_.clear();
+  for (const auto & l : assumps) {
+    assert(l && size_t(abs(l)) < vars_.size());
+    assumps_.push_back(lit_term(l));
+  }
+  Result r = solver_->check_sat_assuming(assumps_);
+  model_.assign(vars_.size(), -1);
+  core_computed_ = false;
+  return r;
+}
+
+bool SmtSatSolver::value(SatLit l)
+{
+  size_t v = abs(l);
+  assert(v && v < vars_.size());
+  if (v >= model_.size()) {
+    // created after the last solve, unconstrained
+    return l < 0;
+  }
+  if (model_[v] < 0) {
+    model_[v] = solver_->get_value(vars_[v]) == true_;
+  }
+  return (l > 0) == bool(model_[v]);
+}
+
+bool SmtSatSolver::failed(SatLit l)
+{
+  if (!core_computed_) {
+    core_.clear();
+    solver_->get_unsat_assumptions(core_);
+    core_computed_ = true;
+  }
+  return core_.find(lit_term(l)) != core_.end();
+}
+
+CnfEncoder::CnfEncoder(SatSolver & sat) : sat_(sat), true_(sat.new_var())
+{
+  sat_.add_clause({ true_ });
+}
+
+bool CnfEncoder::supported_sort(const Sort & sort)
+{
+  SortKind sk = sort->get_sort_kind();
+  return sk == BOOL || (sk == BV && sort->get_width() == 1);
+}
+
+void CnfEncoder::bind(const Term & sym, SatLit l)
+{
+  assert(sym->is_symbolic_const());
+  assert(cache_.find(sym) == cache_.end());
+  cache_[sym] = l;
+}
+
+SatLit CnfEncoder::encode(const Term & t)
+{
+  auto it = cache_.find(t);
+  if (it != cache_.end()) {
+    return it->second;
+  }
+
+  // post-order traversal without recursion, designs can be deep
+  TermVec to_visit({ t });
+  vector<SatLit> args;
+  while (to_visit.size()) {
+    Term cur = to_visit.back();
+    if (cache_.find(cur) != cache_.end()) {
+      to_visit.pop_back();
+      continue;
+    }
+
+    const Sort & sort = cur->get_sort();
+    if (!supported_sort(sort)) {
+      throw PonoException("CnfEncoder: unsupported sort " + sort->to_string()
+                          + " in " + cur->to_string());
+    }
+
+    if (cur->is_symbolic_const()) {
+      cache_[cur] = sat_.new_var();
+      to_visit.pop_back();
+      continue;
+    } else if (cur->is_value()) {
+      bool val = sort->get_sort_kind() == BOOL ? cur->to_string() == "true"
+                                               : cur->to_int() == 1;
+      cache_[cur] = val ? true_ : -true_;
+      to_visit.pop_back();
+      continue;
+    }
+
+    bool ready = true;
+    for (const auto & c : cur) {
+      if (cache_.find(c) == cache_.end()) {
+        ready = false;
+        to_visit.push_back(c);
+      }
+    }
+    if (!ready) {
+      continue;
+    }
+
+    to_visit.pop_back();
+    args.clear();
+    for (const auto & c : cur) {
+      args.push_back(cache_.at(c));
+    }
+    cache_[cur] = encode_op(cur, args);
+  }
+
+  return cache_.at(t);
+}
+
+void CnfEncoder::add_term(const Term & t)
+{
+  TermVec to_visit({ t });
+  vector<SatLit> clause;
+  while (to_visit.size()) {
+    Term cur = to_visit.back();
+    to_visit.pop_back();
+    PrimOp po = cur->get_op().prim_op;
+    if (po == And) {
+      for (const auto & c : cur) {
+        to_visit.push_back(c);
+      }
+    } else if (po == Or) {
+      clause.clear();
+      for (const auto & c : cur) {
+        clause.push_back(encode(c));
+      }
+      sat_.add_clause(clause);
+    } else {
+      sat_.add_clause({ encode(cur) });
+    }
+  }
+}
+
+SatLit CnfEncoder::encode_op(const Term & t, const vector<SatLit> & args)
+{
+  const Op op = t->get_op();
+  assert(args.size());
+  SatLit res;
+  switch (op.prim_op) {
+    case Not:
+    case BVNot: return -args[0];
+    case BVNeg:
+    case Extract:
+    case Zero_Extend:
+    case Sign_Extend:
+    case Repeat:
+    case Rotate_Left:
+    case Rotate_Right:
+      // with a result of width 1 these are the identity
+      assert(args.size() == 1);
+      return args[0];
+    case And:
+    case BVAnd:
+    case BVMul:
+    case BVNand:
+      res = args[0];
+      for (size_t i = 1; i < args.size(); ++i) {
+        res = mk_and(res, args[i]);
+      }
+      return op.prim_op == BVNand ? -res : res;
+    case Or:
+    case BVOr:
+    case BVNor:
+      res = -args[0];
+      for (size_t i = 1; i < args.size(); ++i) {
+        res = mk_and(res, -args[i]);
+      }
+      return op.prim_op == BVNor ? res : -res;
+    case Xor:
+    case BVXor:
+    case BVAdd:
+    case BVSub:
+      res = args[0];
+      for (size_t i = 1; i < args.size(); ++i) {
+        res = mk_xor(res, args[i]);
+      }
+      return res;
+    case Equal:
+    case BVXnor:
+    case BVComp:
+      assert(args.size() == 2);
+      return -mk_xor(args[0], args[1]);
+    case Distinct:
+      if (args.size() == 2) {
+        return mk_xor(args[0], args[1]);
+      }
+      // three or more values of a two-element domain can't be distinct
+      return -true_;
+    case Implies:
+      assert(args.size() == 2);
+      return -mk_and(args[0], -args[1]);
+    case Ite:
+      assert(args.size() == 3);
+      return mk_ite(args[0], args[1], args[2]);
+    // at width 1 the unsigned value is the bit and the signed value
+    // is minus the bit
+    case BVUlt:
+    case BVSgt: return mk_and(-args[0], args[1]);
+    case BVUle:
+    case BVSge: return -mk_and(args[0], -args[1]);
+    case BVUgt:
+    case BVSlt: return mk_and(args[0], -args[1]);
+    case BVUge:
+    case BVSle: return -mk_and(-args[0], args[1]);
+    default:
+      throw PonoException("CnfEncoder: unsupported operator "
+                          + op.to_string() + " in " + t->to_string());
+  }
+}
+
+SatLit CnfEncoder::mk_and(SatLit a, SatLit b)
+{
+  if (a == -true_ || b == -true_ || a == -b) {
+    return -true_;
+  } else if (a == true_ || a == b) {
+    return b;
+  } else if (b == true_) {
+    return a;
+  }
+
+  SatLit g = sat_.new_var();
+  sat_.add_clause({ -g, a });
+  sat_.add_clause({ -g, b });
+  sat_.add_clause({ g, -a, -b });
+  return g;
+}
+
+SatLit CnfEncoder::mk_xor(SatLit a, SatLit b)
+{
+  if (a == true_ || a == -true_) {
+    return a == true_ ? -b : b;
+  } else if (b == true_ || b == -true_) {
+    return b == true_ ? -a : a;
+  } else if (a == b) {
+    return -true_;
+  } else if (a == -b) {
+    return true_;
+  }
+
+  SatLit g = sat_.new_var();
+  sat_.add_clause({ -g, a, b });
+  sat_.add_clause({ -g, -a, -b });
+  sat_.add_clause({ g, -a, b });
+  sat_.add_clause({ g, a, -b });
+  return g;
+}
+
+SatLit CnfEncoder::mk_ite(SatLit c, SatLit t, SatLit e)
+{
+  if (c == true_) {
+    return t;
+  } else if (c == -true_) {
+    return e;
+  } else if (t == e) {
+    return t;
+  } else if (t == -e) {
+    return -mk_xor(c, t);
+  }
+
+  SatLit g = sat_.new_var();
+  sat_.add_clause({ -c, -t, g });
+  sat_.add_clause({ -c, t, -g });
+  sat_.add_clause({ c, -e, g });
+  sat_.add_clause({ c, e, -g });
+  return g;
+}
+
+unique_ptr<SatSolver> create_sat_solver(SolverEnum se, bool logging)
+{
+  return unique_ptr<SatSolver>(
+      new SmtSatSolver(create_solver_for(se, IC3_BITS, logging)));
+}
+
+}  // namespace pono
@@ -0,0 +1,145 @@
+/*********************                                                        */
+/*! \file sat_solver.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A minimal incremental SAT solver interface over integer literals,
+**        for the engines that work on a CNF encoding of the system.
+**
+**        SmtSatSolver implements it on top of any smt-switch solver, with
+**        one boolean symbol per variable created once, so that queries
+**        and models only index vectors instead of building terms.
+**
+**/
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "smt-switch/smt.h"
+
+namespace pono {
+
+/** A literal as in DIMACS: a variable index (from 1), negated for its
+ *  complement
+ */
+typedef int SatLit;
+
+class SatSolver
+{
+ public:
+  virtual ~SatSolver() {}
+
+  /** @return a fresh variable, as a positive literal */
+  virtual SatLit new_var() = 0;
+
+  /** @return the number of variables created so far */
+  virtual size_t num_vars() const = 0;
+
+  /** Add a clause permanently (the empty clause makes the solver unsat) */
+  virtual void add_clause(const std::vector<SatLit> & clause) = 0;
+
+  /** Solve under assumptions
+   *  @return sat, unsat or unknown (e.g. on a per-query limit)
+   */
+  virtual smt::Result solve(const std::vector<SatLit> & assumps) = 0;
+
+  /** @requires the last solve returned sat
+   *  @return the value of the literal in the model
+   */
+  virtual bool value(SatLit l) = 0;
+
+  /** @requires the last solve returned unsat
+   *  @return true iff the assumption l is in the unsat core
+   */
+  virtual bool failed(SatLit l) = 0;
+};
+
+class SmtSatSolver : public SatSolver
+{
+ public:
+  /** @param s the backend, needs incremental solving, models and
+   *         unsat assumptions
+   */
+  SmtSatSolver(const smt::SmtSolver & s);
+
+  SatLit new_var() override;
+  size_t num_vars() const override { return vars_.size() - 1; }
+  void add_clause(const std::vector<SatLit> & clause) override;
+  smt::Result solve(const std::vector<SatLit> & assumps) override;
+  bool value(SatLit l) override;
+  bool failed(SatLit l) override;
+
+  const smt::SmtSolver & solver() const { return solver_; }
+
+ protected:
+  const smt::Term & lit_term(SatLit l) const
+  {
+    return l > 0 ? vars_[l] : neg_vars_[-l];
+  }
+
+  smt::SmtSolver solver_;
+  smt::Term true_;
+  smt::TermVec vars_;      ///< indexed by variable, vars_[0] is unused
+  smt::TermVec neg_vars_;  ///< the negation of each variable
+
+  smt::TermVec assumps_;        ///< reused by solve
+  std::vector<int8_t> model_;   ///< -1 if not queried since the last solve
+  smt::UnorderedTermSet core_;  ///< computed on the first call to failed
+  bool core_computed_;
+};
+
+/** Tseitin encoding of Boolean terms into a SatSolver
+ *  Bit-vectors of width 1 are treated as booleans, with the literal of
+ *  such a term meaning that it is #b1. Symbols that were not bound are
+ *  given a fresh variable on first use.
+ *  Throws a PonoException for terms over other sorts or operators that
+ *  have no bit-level meaning at width 1.
+ */
+class CnfEncoder
+{
+ public:
+  CnfEncoder(SatSolver & sat);
+
+  /** @return true iff terms of this sort can be encoded */
+  static bool supported_sort(const smt::Sort & sort);
+
+  /** Use a literal for a symbol, must be called before it is encoded */
+  void bind(const smt::Term & sym, SatLit l);
+
+  /** @return a literal equivalent to t */
+  SatLit encode(const smt::Term & t);
+
+  /** Add t as clauses, splitting top-level conjunctions */
+  void add_term(const smt::Term & t);
+
+  /** @return the literal that is always true */
+  SatLit true_lit() const { return true_; }
+
+ protected:
+  SatLit encode_op(const smt::Term & t, const std::vector<SatLit> & args);
+
+  SatLit mk_and(SatLit a, SatLit b);
+  SatLit mk_xor(SatLit a, SatLit b);
+  SatLit mk_ite(SatLit c, SatLit t, SatLit e);
+
+  SatSolver & sat_;
+  SatLit true_;
+  std::unordered_map<smt::Term, SatLit> cache_;
+};
+
+/** @param se the solver backend for SmtSatSolver
+ *  @param logging use a logging solver (see create_solver)
+ */
+std::unique_ptr<SatSolver> create_sat_solver(smt::SolverEnum se,
+                                             bool logging = false);
+
+}  // namespace pono
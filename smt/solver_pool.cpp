@@ -0,0 +1,128 @@
+/*********************                                                        */
+/*! \file solver_pool.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A thread-safe pool of solvers.
+**
+**/
+
+#include "smt/solver_pool.h"
+
+#include "smt/available_solvers.h"
+#include "utils/exceptions.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+static string pool_key(SolverEnum se,
+                       Engine e,
+                       bool logging,
+                       bool full_model,
+                       bool reducer,
+                       const SolverOptions & opts)
+{
+  string key = to_string(se) + "/" + to_string(e) + "/"
+               + (logging ? "l" : "") + (full_model ? "f" : "")
+               + (reducer ? "r" : "");
+  for (const auto & opt : opts) {
+    key += "/" + opt.first + "=" + opt.second;
+  }
+  return key;
+}
+
+SmtSolver SolverPool::acquire(SolverEnum se,
+                              Engine e,
+                              bool logging,
+                              bool full_model,
+                              bool reducer,
+                              const SolverOptions & opts)
+{
+  string key = pool_key(se, e, logging, full_model, reducer, opts);
+  {
+    unique_lock<mutex> lck(mutex_);
+    auto it = idle_.find(key);
+    if (it != idle_.end() && !it->second.empty()) {
+      SmtSolver s = it->second.back();
+      it->second.pop_back();
+      leased_[s.get()] = key;
+      ++stats_.reused;
+      return s;
+    }
+  }
+
+  // build outside of the lock, it is the expensive part
+  SmtSolver s = reducer ? create_reducer_for(se, e, logging)
+                        : create_solver_for(se, e, logging, full_model);
+  for (const auto & opt : opts) {
+    s->set_opt(opt.first, opt.second);
+  }
+
+  unique_lock<mutex> lck(mutex_);
+  leased_[s.get()] = key;
+  ++stats_.created;
+  return s;
+}
+
+void SolverPool::release(const SmtSolver & s)
+{
+  string key;
+  {
+    unique_lock<mutex> lck(mutex_);
+    auto it = leased_.find(s.get());
+    if (it == leased_.end()) {
+      throw PonoException("SolverPool: releasing a solver it did not hand out");
+    }
+    key = it->second;
+    leased_.erase(it);
+    ++stats_.released;
+  }
+
+  bool reset = true;
+  try {
+    s->reset_assertions();
+  }
+  catch (SmtException & e) {
+    reset = false;
+  }
+
+  unique_lock<mutex> lck(mutex_);
+  auto & idle = idle_[key];
+  if (reset && idle.size() < max_idle_) {
+    idle.push_back(s);
+  } else {
+    ++stats_.dropped;
+  }
+}
+
+size_t SolverPool::num_idle() const
+{
+  unique_lock<mutex> lck(mutex_);
+  size_t n = 0;
+  for (const auto & elem : idle_) {
+    n += elem.second.size();
+  }
+  return n;
+}
+
+SolverPoolStats SolverPool::stats() const
+{
+  unique_lock<mutex> lck(mutex_);
+  return stats_;
+}
+
+SolverPool & global_solver_pool()
+{
+  static SolverPool pool;
+  return pool;
+}
+
+}  // namespace pono
@@ -0,0 +1,91 @@
+/*********************                                                        */
+/*! \file solver_pool.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A thread-safe pool of solvers, to reuse the solvers (and for
+**        MathSAT, the configurations and environments) of create_solver_for
+**        and create_reducer_for instead of building new ones every time.
+**
+**        Released solvers are reset (reset_assertions) before they are
+**        handed out again, but they keep the symbols declared in them, so
+**        a pooled solver should be reused for the same terms, e.g. through
+**        a TermTranslator from the same transition system.
+**
+**/
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "options/options.h"
+#include "smt-switch/smt.h"
+#include "smt/available_solvers.h"
+
+namespace pono {
+
+struct SolverPoolStats
+{
+  size_t created = 0;   ///< solvers built because none was idle
+  size_t reused = 0;    ///< acquisitions served by an idle solver
+  size_t released = 0;  ///< solvers returned to the pool
+  size_t dropped = 0;   ///< released solvers destroyed (pool full or the
+                        ///< reset failed)
+};
+
+class SolverPool
+{
+ public:
+  /** @param max_idle the number of idle solvers kept per key */
+  SolverPool(size_t max_idle = 8) : max_idle_(max_idle) {}
+
+  SolverPool(const SolverPool &) = delete;
+  SolverPool & operator=(const SolverPool &) = delete;
+
+  /** Hand out a solver as created by create_solver_for (or
+   *  create_reducer_for if reducer is true), reusing an idle one with
+   *  the same arguments if possible
+   *  @param opts options set (with set_opt) on a newly created solver
+   */
+  smt::SmtSolver acquire(smt::SolverEnum se,
+                         Engine e,
+                         bool logging = false,
+                         bool full_model = false,
+                         bool reducer = false,
+                         const SolverOptions & opts = {});
+
+  /** Return a solver from acquire
+   *  It is reset and kept for later acquisitions with the same arguments.
+   *  @throws PonoException if the solver was not handed out by this pool
+   */
+  void release(const smt::SmtSolver & s);
+
+  /** @return the number of idle solvers over all keys */
+  size_t num_idle() const;
+
+  SolverPoolStats stats() const;
+
+ protected:
+  const size_t max_idle_;
+
+  mutable std::mutex mutex_;
+  ///< idle solvers by key
+  std::unordered_map<std::string, std::vector<smt::SmtSolver>> idle_;
+  ///< the key of each handed out solver
+  std::unordered_map<smt::AbsSmtSolver *, std::string> leased_;
+  SolverPoolStats stats_;
+};
+
+/** @return a pool shared by the whole process */
+SolverPool & global_solver_pool();
+
+}  // namespace pono
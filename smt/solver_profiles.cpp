@@ -0,0 +1,136 @@
+/*********************                                                        */
+/*! \file solver_profiles.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Solver option profiles, read from a tuning file.
+**
+**/
+
+#include "smt/solver_profiles.h"
+
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include "utils/exceptions.h"
+#include "utils/logger.h"
+#include "utils/statistics.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+namespace {
+
+struct ProfileEntry
+{
+  string solver;
+  string engine;
+  string option;
+  string value;
+};
+
+mutex profiles_mutex;
+vector<ProfileEntry> profile_entries;
+
+}  // namespace
+
+void load_solver_profiles(const string & filename, const string & profile)
+{
+  ifstream in(filename);
+  if (!in.is_open()) {
+    throw PonoException("Could not open solver profiles file " + filename);
+  }
+
+  vector<ProfileEntry> entries;
+  bool found = profile.empty();
+  string section;
+  string line;
+  size_t lineno = 0;
+  while (getline(in, line)) {
+    ++lineno;
+    size_t comment = line.find('#');
+    if (comment != string::npos) {
+      line.erase(comment);
+    }
+    istringstream words(line);
+    string first;
+    if (!(words >> first)) {
+      continue;
+    }
+
+    if (first.front() == '[') {
+      if (first.back() != ']' || first.size() < 3) {
+        throw PonoException("Malformed section in " + filename + ":"
+                            + std::to_string(lineno));
+      }
+      section = first.substr(1, first.size() - 2);
+      found |= section == profile;
+      continue;
+    }
+
+    ProfileEntry entry;
+    entry.solver = first;
+    string rest;
+    if (!(words >> entry.engine >> entry.option >> entry.value)
+        || (words >> rest)) {
+      throw PonoException("Expecting <solver> <engine> <option> <value> in "
+                          + filename + ":" + std::to_string(lineno));
+    }
+    if (section == profile) {
+      entries.push_back(entry);
+    }
+  }
+  if (!found) {
+    throw PonoException("No solver profile " + profile + " in " + filename);
+  }
+
+  shared_ptr<Statistics> stats = make_shared<Statistics>();
+  stats->set_string("profile", profile.empty() ? "default" : profile);
+  for (const auto & entry : entries) {
+    logger.log(1,
+               "Solver profile: {} {} {} = {}",
+               entry.solver,
+               entry.engine,
+               entry.option,
+               entry.value);
+    stats->set_string(entry.solver + " " + entry.engine + " " + entry.option,
+                      entry.value);
+  }
+  statistics_registry.add("solver_profile", stats);
+
+  lock_guard<mutex> lock(profiles_mutex);
+  profile_entries = entries;
+}
+
+void clear_solver_profiles()
+{
+  lock_guard<mutex> lock(profiles_mutex);
+  profile_entries.clear();
+}
+
+SolverOptions solver_profile_options(SolverEnum se, const string & engine)
+{
+  string solver = to_string(se);
+  SolverOptions opts;
+  lock_guard<mutex> lock(profiles_mutex);
+  for (const auto & entry : profile_entries) {
+    if ((entry.solver == "*" || entry.solver == solver)
+        && (entry.engine == "*" || entry.engine == engine)) {
+      opts.push_back({ entry.option, entry.value });
+    }
+  }
+  return opts;
+}
+
+}  // namespace pono
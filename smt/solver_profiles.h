@@ -0,0 +1,56 @@
+/*********************                                                        */
+/*! \file solver_profiles.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Solver option profiles, read from a tuning file and applied by
+**        create_solver_for and create_reducer_for.
+**
+**        The file has one option per line:
+**          <solver> <engine> <option> <value>
+**        where solver is a solver name (e.g. btor, msat) and engine an
+**        engine name (e.g. bmc, ic3ia) or "reducer" for the reducing
+**        solvers, and * matches any of them. Lines can be grouped in
+**        sections starting with [name], one of which is selected per run.
+**        Everything after a # is a comment.
+**
+**/
+
+#pragma once
+
+#include <string>
+
+#include "options/options.h"
+#include "smt-switch/smt.h"
+#include "smt/available_solvers.h"
+
+namespace pono {
+
+/** Read the profiles of a file and use those of one section from now on
+ *  The selected options are recorded in the statistics registry.
+ *  @param filename the file
+ *  @param profile the section name, empty for the lines before the
+ *         first section
+ *  @throws PonoException if the file cannot be read, is malformed, or
+ *          does not have the section
+ */
+void load_solver_profiles(const std::string & filename,
+                          const std::string & profile = "");
+
+/** Stop using the loaded profiles */
+void clear_solver_profiles();
+
+/** @return the options of the loaded profile for a solver and engine,
+ *          in the order of the file
+ *  @param engine the engine name, or "reducer"
+ */
+SolverOptions solver_profile_options(smt::SolverEnum se,
+                                     const std::string & engine);
+
+}  // namespace pono
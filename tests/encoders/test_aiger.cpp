@@ -0,0 +1,75 @@
+#include <string>
+#include <vector>
+
+#include "core/fts.h"
+#include "engines/bmc.h"
+#include "frontends/aiger_encoder.h"
+#include "gtest/gtest.h"
+#include "smt/available_solvers.h"
+
+using namespace pono;
+using namespace smt;
+using namespace std;
+
+namespace pono_tests {
+
+class AigerUnitTests : public ::testing::Test,
+                       public ::testing::WithParamInterface<SolverEnum>
+{
+};
+
+TEST_P(AigerUnitTests, Encode)
+{
+  SmtSolver s = create_solver(GetParam());
+  s->set_opt("incremental", "true");
+  FunctionalTransitionSystem fts(s);
+  // PONO_SRC_DIR is a macro set using CMake PROJECT_SRC_DIR
+  string filename = STRFY(PONO_SRC_DIR);
+  filename += "/tests/encoders/inputs/aiger/shift.aag";
+  AigerEncoder ae(filename, fts);
+
+  EXPECT_EQ(fts.inputvars().size(), 1);
+  EXPECT_EQ(fts.statevars().size(), 2);
+  ASSERT_EQ(ae.propvec().size(), 1);
+  EXPECT_EQ(ae.inputsvec()[0], fts.lookup("en"));
+
+  // the and gates are sorted
+  ASSERT_EQ(ae.ands().size(), 2);
+  EXPECT_EQ(ae.ands()[0].lhs, 8);
+  EXPECT_EQ(ae.ands()[1].lhs, 10);
+
+  Property p(fts.solver(), ae.propvec()[0]);
+  Bmc bmc(p, fts, s);
+  EXPECT_EQ(bmc.check_until(1), ProverResult::UNKNOWN);
+  EXPECT_EQ(bmc.check_until(2), ProverResult::FALSE);
+}
+
+TEST_P(AigerUnitTests, Simulate)
+{
+  SmtSolver s = create_solver(GetParam());
+  FunctionalTransitionSystem fts(s);
+  string filename = STRFY(PONO_SRC_DIR);
+  filename += "/tests/encoders/inputs/aiger/shift.aag";
+  AigerEncoder ae(filename, fts);
+
+  // en = X, b0 = 1, b1 = 1
+  vector<uint8_t> values(ae.max_var() + 1, 2);
+  values[2] = 1;
+  values[3] = 1;
+  ae.simulate(values);
+  EXPECT_EQ(AigerEncoder::lit_value(values, 8), 1);
+  EXPECT_EQ(AigerEncoder::lit_value(values, 10), 2);
+  EXPECT_EQ(AigerEncoder::lit_value(values, ae.bads()[0]), 2);
+
+  // en = 0 makes the bad state false
+  values[1] = 0;
+  ae.simulate(values);
+  EXPECT_EQ(AigerEncoder::lit_value(values, 10), 0);
+  EXPECT_EQ(AigerEncoder::lit_value(values, 11), 1);
+}
+
+INSTANTIATE_TEST_SUITE_P(ParameterizedSolverAigerUnitTests,
+                         AigerUnitTests,
+                         testing::ValuesIn(available_solver_enums()));
+
+}  // namespace pono_tests
@@ -1,3 +1,4 @@
+#include <sstream>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -7,8 +8,10 @@
 #include "engines/kinduction.h"
 #include "frontends/btor2_encoder.h"
 #include "gtest/gtest.h"
+#include "printers/btor2_printer.h"
 #include "smt/available_solvers.h"
 #include "test_encoder_inputs.h"
+#include "utils/exceptions.h"
 
 using namespace pono;
 using namespace smt;
@@ -55,6 +58,43 @@ TEST_P(Btor2UnitTests, OverflowEncoding)
   EXPECT_EQ(r, ProverResult::TRUE);
 }
 
+TEST_P(Btor2UnitTests, SimplifiedEncoding)
+{
+  SmtSolver s = create_solver(GetParam());
+  s->set_opt("incremental", "true");
+  FunctionalTransitionSystem fts(s);
+  // PONO_SRC_DIR is a macro set using CMake PROJECT_SRC_DIR
+  string filename = STRFY(PONO_SRC_DIR);
+  filename += "/tests/encoders/inputs/btor2/mulo-test.btor2";
+  BTOR2Encoder be(filename, fts, true);
+  EXPECT_EQ(be.propvec().size(), 1);
+  Property p(fts.solver(), be.propvec()[0]);
+  KInduction kind(p, fts, s);
+  ProverResult r = kind.check_until(2);
+  EXPECT_EQ(r, ProverResult::TRUE);
+}
+
+TEST_P(Btor2UnitTests, PropertyCone)
+{
+  SmtSolver s = create_solver(GetParam());
+  s->set_opt("incremental", "true");
+  FunctionalTransitionSystem fts(s);
+  // PONO_SRC_DIR is a macro set using CMake PROJECT_SRC_DIR
+  string filename = STRFY(PONO_SRC_DIR);
+  filename += "/tests/encoders/inputs/btor2/counter.btor";
+  BTOR2Encoder be(filename, fts, false, 0);
+  // the clk input is not in the cone of the property
+  ASSERT_EQ(be.inputsvec().size(), 2);
+  EXPECT_FALSE(be.inputsvec()[0]);
+  EXPECT_TRUE(be.inputsvec()[1]);
+  EXPECT_EQ(fts.inputvars().size(), 1);
+  ASSERT_EQ(be.propvec().size(), 1);
+  Property p(fts.solver(), be.propvec()[0]);
+  Bmc bmc(p, fts, s);
+  ProverResult r = bmc.check_until(10);
+  EXPECT_EQ(r, ProverResult::FALSE);
+}
+
 TEST_P(Btor2UnitTests, InputConstraints)
 {
   // test BTOR2 file with constraint containing input variables
@@ -72,6 +112,58 @@ TEST_P(Btor2UnitTests, InputConstraints)
   ASSERT_NE(r, ProverResult::FALSE);
 }
 
+TEST_P(Btor2UnitTests, WriteBtor2)
+{
+  SmtSolver s = create_solver(GetParam());
+  FunctionalTransitionSystem fts(s);
+  Sort bvsort = fts.make_sort(BV, 4);
+  Sort arrsort = fts.make_sort(ARRAY, bvsort, bvsort);
+  Term x = fts.make_statevar("x", bvsort);
+  Term b = fts.make_statevar("b", fts.make_sort(BOOL));
+  Term mem = fts.make_statevar("mem", arrsort);
+  Term in = fts.make_inputvar("in", bvsort);
+  Term zero = fts.make_term(0, bvsort);
+  fts.constrain_init(fts.make_term(Equal, x, zero));
+  fts.constrain_init(fts.make_term(Equal, b, fts.make_term(false)));
+  fts.constrain_init(fts.make_term(Equal, mem, fts.make_term(zero, arrsort)));
+  // not of the form state = value
+  fts.constrain_init(fts.make_term(BVUle, fts.make_term(Select, mem, x), x));
+  fts.assign_next(x, fts.make_term(BVAdd, x, fts.make_term(1, bvsort)));
+  fts.assign_next(b, fts.make_term(BVUgt, in, x));
+  fts.assign_next(mem, fts.make_term(Store, mem, x, in));
+  fts.add_constraint(fts.make_term(Distinct, in, zero));
+  fts.name_term("x_plus_in", fts.make_term(BVAdd, x, in));
+  // x reaches 5 after 5 steps
+  Term prop = fts.make_term(Distinct, x, fts.make_term(5, bvsort));
+
+  string filename = ::testing::TempDir() + "pono_write_btor2.btor2";
+  write_btor2_file(filename, fts, { prop });
+
+  SmtSolver s2 = create_solver(GetParam());
+  FunctionalTransitionSystem fts2(s2);
+  BTOR2Encoder be(filename, fts2);
+  // and the state that is only true in the first step
+  EXPECT_EQ(fts2.statevars().size(), fts.statevars().size() + 1);
+  EXPECT_EQ(fts2.inputvars().size(), 1);
+  // the named terms are outputs
+  EXPECT_NO_THROW(fts2.lookup("x_plus_in"));
+  ASSERT_EQ(be.propvec().size(), 1);
+  Property p(s2, be.propvec()[0]);
+  Bmc bmc(p, fts2, s2);
+  EXPECT_EQ(bmc.check_until(4), ProverResult::UNKNOWN);
+  EXPECT_EQ(bmc.check_until(5), ProverResult::FALSE);
+
+  // integers can't be written
+  if (s->get_solver_enum() != BTOR) {
+    FunctionalTransitionSystem ints(s);
+    Term i = ints.make_statevar("i", ints.make_sort(INT));
+    ints.assign_next(i, i);
+    std::ostringstream out;
+    EXPECT_THROW(write_btor2(out, ints, { ints.make_term(true) }),
+                 PonoException);
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(
     ParameterizedSolverBtor2FileUnitTests,
     Btor2FileUnitTests,
@@ -9,6 +9,7 @@
 #include "gtest/gtest.h"
 #include "smt/available_solvers.h"
 #include "test_encoder_inputs.h"
+#include "utils/exceptions.h"
 
 using namespace pono;
 using namespace smt;
@@ -46,6 +47,33 @@ TEST_P(CoreIRUnitTests, EncodeForceAbstract)
   CoreIREncoder ce(filename, rts, true);
 }
 
+TEST(CoreIROutputsTests, EncodeCone)
+{
+  SmtSolver s = create_solver(available_solver_enums()[0]);
+  string filename = STRFY(PONO_SRC_DIR);
+  filename += "/tests/encoders/inputs/coreir/SimpleALU.json";
+
+  RelationalTransitionSystem full_rts(s);
+  CoreIREncoder full(filename, full_rts);
+  size_t num_instances = full.statistics().get("instances");
+  EXPECT_GT(num_instances, 0);
+  EXPECT_EQ(full.statistics().get("skipped_instances"), 0);
+
+  SmtSolver s2 = create_solver(available_solver_enums()[0]);
+  RelationalTransitionSystem cone_rts(s2);
+  CoreIREncoder cone(filename, cone_rts, false, { "c" });
+  size_t num_cone = cone.statistics().get("instances");
+  EXPECT_GT(num_cone, 0);
+  EXPECT_LE(num_cone, num_instances);
+  EXPECT_EQ(cone.statistics().get("skipped_instances"),
+            num_instances - num_cone);
+
+  SmtSolver s3 = create_solver(available_solver_enums()[0]);
+  RelationalTransitionSystem bad_rts(s3);
+  EXPECT_THROW(CoreIREncoder(filename, bad_rts, false, { "no_such_output" }),
+               PonoException);
+}
+
 INSTANTIATE_TEST_SUITE_P(
     ParameterizedSolverCoreIRUnitTests,
     CoreIRUnitTests,
@@ -0,0 +1,112 @@
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "core/fts.h"
+#include "core/rts.h"
+#include "engines/bmc.h"
+#include "frontends/vmt_encoder.h"
+#include "gtest/gtest.h"
+#include "printers/vmt_printer.h"
+#include "smt/available_solvers.h"
+
+using namespace pono;
+using namespace smt;
+using namespace std;
+
+namespace pono_tests {
+
+class VmtUnitTests : public ::testing::Test,
+                     public ::testing::WithParamInterface<SolverEnum>
+{
+};
+
+TEST_P(VmtUnitTests, WriteVmt)
+{
+  SmtSolver s = create_solver(GetParam());
+  FunctionalTransitionSystem fts(s);
+  Sort bvsort = fts.make_sort(BV, 4);
+  Sort arrsort = fts.make_sort(ARRAY, bvsort, bvsort);
+  Term x = fts.make_statevar("x", bvsort);
+  Term mem = fts.make_statevar("mem", arrsort);
+  Term in = fts.make_inputvar("in", bvsort);
+  Term zero = fts.make_term(0, bvsort);
+  fts.constrain_init(fts.make_term(Equal, x, zero));
+  fts.constrain_init(fts.make_term(Equal, mem, fts.make_term(zero, arrsort)));
+  fts.assign_next(x, fts.make_term(BVAdd, x, fts.make_term(1, bvsort)));
+  fts.assign_next(mem, fts.make_term(Store, mem, x, in));
+  fts.add_constraint(fts.make_term(Distinct, in, zero));
+  fts.name_term("x_plus_in", fts.make_term(BVAdd, x, in));
+  // x reaches 5 after 5 steps
+  Term prop = fts.make_term(Distinct, x, fts.make_term(5, bvsort));
+
+  std::ostringstream out;
+  write_vmt(out, fts, { prop });
+  EXPECT_NE(out.str().find("(define-fun x_plus_in () (_ BitVec 4)"),
+            string::npos);
+
+  string filename = ::testing::TempDir() + "pono_write_vmt.vmt";
+  write_vmt_file(filename, fts, { prop });
+
+  SmtSolver s2 = create_solver(GetParam());
+  s2->set_opt("incremental", "true");
+  s2->set_opt("produce-models", "true");
+  RelationalTransitionSystem rts(s2);
+  VMTEncoder ve(filename, rts);
+  EXPECT_EQ(rts.statevars().size(), fts.statevars().size());
+  EXPECT_EQ(rts.inputvars().size(), 1);
+  EXPECT_EQ(rts.lookup("x")->get_sort()->get_width(), 4);
+  ASSERT_EQ(ve.propvec().size(), 1);
+  Property p(s2, ve.propvec()[0]);
+  Bmc bmc(p, rts, s2);
+  EXPECT_EQ(bmc.check_until(4), ProverResult::UNKNOWN);
+  EXPECT_EQ(bmc.check_until(5), ProverResult::FALSE);
+}
+
+TEST_P(VmtUnitTests, ParseStatistics)
+{
+  string filename = ::testing::TempDir() + "pono_parse_stats.vmt";
+  {
+    ofstream f(filename);
+    f << "(declare-fun x () (_ BitVec 4))\n"
+      << "(declare-fun in () (_ BitVec 4))\n"
+      << "(define-fun .x () (_ BitVec 4) (! x :next x.next))\n"
+      << "(define-fun init () Bool (! (= x #b0000) :init true))\n"
+      << "(define-fun trans () Bool (! (= x.next (bvadd x in)) :trans "
+         "true))\n"
+      << "(define-fun prop () Bool (! (distinct x #b1111) "
+         ":invar-property 0))\n";
+  }
+
+  SmtSolver s = create_solver(GetParam());
+  s->set_opt("incremental", "true");
+  s->set_opt("produce-models", "true");
+  RelationalTransitionSystem rts(s);
+  VMTEncoder ve(filename, rts);
+
+  // x.next is declared by the :next attribute
+  EXPECT_EQ(ve.statistics().get("symbols"), 3);
+  EXPECT_EQ(ve.statistics().get("statevars"), 1);
+  EXPECT_EQ(ve.statistics().get("attributes"), 4);
+  EXPECT_GT(ve.statistics().get("file_bytes"), 0);
+
+  // x is only a state variable, never an input
+  ASSERT_EQ(rts.statevars().size(), 1);
+  EXPECT_EQ(rts.inputvars().size(), 1);
+  Term x = rts.lookup("x");
+  EXPECT_TRUE(rts.is_curr_var(x));
+  EXPECT_FALSE(rts.is_input_var(x));
+  EXPECT_EQ(rts.next(x), rts.lookup("x.next"));
+  ASSERT_EQ(ve.propvec().size(), 1);
+
+  Property p(s, ve.propvec()[0]);
+  Bmc bmc(p, rts, s);
+  EXPECT_EQ(bmc.check_until(2), ProverResult::FALSE);
+}
+
+INSTANTIATE_TEST_SUITE_P(ParameterizedSolverVmtUnitTests,
+                         VmtUnitTests,
+                         testing::ValuesIn(available_solver_enums()));
+
+}  // namespace pono_tests
@@ -1,7 +1,8 @@
+import concurrent.futures
 import pytest
 import smt_switch as ss
 from smt_switch.sortkinds import BV
-from smt_switch.primops import And, BVAdd, BVSub, Equal, Ite
+from smt_switch.primops import And, BVAdd, BVSub, Distinct, Equal, Ite
 import pono
 import available_solvers
 
@@ -63,6 +64,47 @@ def test_bmc(create_solver):
 
     assert res is None, "BMC shouldn't be able to solve"
 
+@pytest.mark.parametrize("create_solver", ss.solvers.values())
+def test_bmc_async(create_solver):
+    # a portfolio of provers in threads, each with its own solver
+    futures = []
+    for i in range(2):
+        s = create_solver(False)
+        s.set_opt('produce-models', 'true')
+        s.set_opt('incremental', 'true')
+        prop, ts = build_simple_alu_fts(s)
+        bmc = pono.Bmc(prop, ts, s)
+        futures.append((bmc, bmc.check_until_async(5)))
+
+    for bmc, f in futures:
+        assert f.result() is None, "BMC shouldn't be able to solve"
+
+    # an interrupted prover gives up, or never starts if the cancel comes
+    # before the worker picked it up
+    bmc = futures[0][0]
+    f = bmc.check_until_async(1000)
+    f.cancel()
+    try:
+        assert f.result() is None
+    except concurrent.futures.CancelledError:
+        assert f.cancelled()
+
+@pytest.mark.parametrize("create_solver", ss.solvers.values())
+def test_check_properties(create_solver):
+    s = create_solver(False)
+    prop, ts = build_simple_alu_fts(s)
+    bvsort1 = s.make_sort(BV, 1)
+    cfg = ts.lookup('cfg')
+    spec_res = ts.lookup('spec_res')
+    imp_res = ts.lookup('imp_res')
+
+    props = [s.make_term(Equal, cfg, s.make_term(0, bvsort1)),
+             s.make_term(Distinct, spec_res, imp_res)]
+    results = {}
+    for idx, res, engine in pono.check_properties(ts, props, ['bmc', 'ind'], 5):
+        results[idx] = res
+    assert results == {0: True, 1: False}
+
 @pytest.mark.parametrize("create_solver", ss.solvers.values())
 def test_kind(create_solver):
     s = create_solver(False)
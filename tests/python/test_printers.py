@@ -36,3 +36,14 @@ def test_vcd_trace(create_solver):
         vcd_printer = pono.VCDWitnessPrinter(ts, witness)
         vcd_printer.dump_trace_to_file(temp.name)
         assert os.stat(temp.name).st_size, "Expect file to be non-empty"
+
+    with tempfile.NamedTemporaryFile() as temp:
+        assert bmc.dump_witness_vcd(temp.name)
+        assert os.stat(temp.name).st_size, "Expect file to be non-empty"
+
+    table = bmc.witness_table()
+    assert table.names == ['x']
+    assert table.widths == [8]
+    assert table.num_frames == len(witness)
+    assert list(table.values) == list(range(table.num_frames))
+    assert table.known == b'\x01' * table.num_frames
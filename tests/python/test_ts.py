@@ -76,3 +76,46 @@ def test_query_rts(create_solver):
     except Exception as e:
         assert False
 
+
+@pytest.mark.parametrize("create_solver", ss.solvers.values())
+def test_bulk_construction(create_solver):
+    solver = create_solver(False)
+    bvsort = solver.make_sort(ss.sortkinds.BV, 8)
+
+    ts = pono.FunctionalTransitionSystem(solver)
+    x, y = ts.make_statevars([('x', bvsort), ('y', bvsort)])
+    inp, = ts.make_inputvars([('in', bvsort)])
+    assert ts.is_input_var(inp)
+
+    # x + in, (x + in) + y
+    xpi, xpipy = ts.make_terms([x, y, inp], [ss.primops.BVAdd],
+                               [0, 2, 0, 2, 0, 2, 3, 1])
+    assert xpi == solver.make_term(ss.primops.BVAdd, x, inp)
+    assert xpipy == solver.make_term(ss.primops.BVAdd, xpi, y)
+
+    ts.assign_nexts({x: xpipy, y: y})
+    assert ts.state_updates[x] == xpipy
+    assert ts.is_deterministic()
+
+@pytest.mark.parametrize("create_solver", ss.solvers.values())
+def test_pickle(create_solver):
+    import pickle
+    solver = create_solver(False)
+    solver, ts = build_simple_ts(solver, pono.FunctionalTransitionSystem)
+
+    pono.set_unpickle_solver(lambda: create_solver(False))
+    try:
+        ts2 = pickle.loads(pickle.dumps(ts))
+    finally:
+        pono.set_unpickle_solver(None)
+    assert isinstance(ts2, pono.FunctionalTransitionSystem)
+    assert ts2.solver is not solver
+    assert len(ts2.statevars) == 2
+    assert len(ts2.state_updates) == 1
+    assert len(ts2.constraints) == 1
+
+    x = ts.lookup('x')
+    prop = solver.make_term(ss.primops.BVUle, x, x)
+    ts3, props = pono.load_snapshot(ts.snapshot([prop]), create_solver(False))
+    assert len(props) == 1
+    assert str(ts3.lookup('xp1')) == str(ts.lookup('xp1'))
@@ -0,0 +1,91 @@
+#ifdef WITH_CUDD
+
+#include <vector>
+
+#include "core/fts.h"
+#include "engines/bdd_reach.h"
+#include "gtest/gtest.h"
+#include "smt/available_solvers.h"
+#include "tests/common_ts.h"
+
+using namespace pono;
+using namespace smt;
+using namespace std;
+
+namespace pono_tests {
+
+class BddReachTests : public ::testing::Test,
+                      public ::testing::WithParamInterface<SolverEnum>
+{
+ protected:
+  void SetUp() override
+  {
+    s = create_solver(GetParam());
+    bvsort = s->make_sort(BV, 8);
+  }
+  SmtSolver s;
+  Sort bvsort;
+};
+
+TEST_P(BddReachTests, CounterTrue)
+{
+  FunctionalTransitionSystem fts(s);
+  counter_system(fts, fts.make_term(10, bvsort));
+  Term x = fts.lookup("x");
+  Property p(s, fts.make_term(BVUle, x, fts.make_term(10, bvsort)));
+
+  BddReach bdd(p, fts, s);
+  ASSERT_EQ(bdd.check_until(20), ProverResult::TRUE);
+  // 0..10 are reached after 10 images, the 11th adds nothing
+  EXPECT_EQ(bdd.statistics().get("bdd_images"), 11);
+  EXPECT_TRUE(bdd.invar());
+}
+
+TEST_P(BddReachTests, CounterFalse)
+{
+  FunctionalTransitionSystem fts(s);
+  counter_system(fts, fts.make_term(10, bvsort));
+  Term x = fts.lookup("x");
+  Term in = fts.make_inputvar("in", s->make_sort(BOOL));
+  Property p(s, fts.make_term(BVUlt, x, fts.make_term(5, bvsort)));
+
+  BddReach bdd(p, fts, s);
+  EXPECT_EQ(bdd.check_until(4), ProverResult::UNKNOWN);
+  ASSERT_EQ(bdd.check_until(10), ProverResult::FALSE);
+
+  vector<UnorderedTermMap> cex;
+  ASSERT_TRUE(bdd.witness(cex));
+  ASSERT_EQ(cex.size(), 6);
+  for (size_t i = 0; i < cex.size(); ++i) {
+    EXPECT_EQ(cex[i].at(x), s->make_term(i, bvsort));
+    EXPECT_TRUE(cex[i].find(in) != cex[i].end());
+  }
+}
+
+TEST_P(BddReachTests, GivesUp)
+{
+  FunctionalTransitionSystem fts(s);
+  counter_system(fts, fts.make_term(10, bvsort));
+  Term x = fts.lookup("x");
+  Property p(s, fts.make_term(BVUle, x, fts.make_term(10, bvsort)));
+
+  // over the node limit
+  PonoOptions opts;
+  opts.bdd_node_limit_ = 1;
+  BddReach small(p, fts, s, opts);
+  EXPECT_EQ(small.check_until(20), ProverResult::UNKNOWN);
+
+  // multiplication is not bit-blasted
+  Term y = fts.make_statevar("y", bvsort);
+  fts.assign_next(y, fts.make_term(BVMul, y, x));
+  BddReach mul(p, fts, s);
+  EXPECT_EQ(mul.check_until(20), ProverResult::UNKNOWN);
+}
+
+INSTANTIATE_TEST_SUITE_P(ParameterizedSolverBddReachTests,
+                         BddReachTests,
+                         testing::ValuesIn(available_solver_enums()));
+
+}  // namespace pono_tests
+
+#endif
@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "core/fts.h"
+#include "engines/cegar_localization.h"
+#include "gtest/gtest.h"
+#include "smt/available_solvers.h"
+#include "utils/make_provers.h"
+
+using namespace pono;
+using namespace smt;
+using namespace std;
+
+namespace pono_tests {
+
+class CegarLocalizationTests
+    : public ::testing::Test,
+      public ::testing::WithParamInterface<SolverEnum>
+{
+ protected:
+  void SetUp() override
+  {
+    s = create_solver(GetParam());
+    bvsort = s->make_sort(BV, 8);
+  }
+  SmtSolver s;
+  Sort bvsort;
+};
+
+/** x counts to 10 and wraps, y copies x and w counts freely */
+static void localization_system(FunctionalTransitionSystem & fts,
+                                const Sort & bvsort)
+{
+  Term x = fts.make_statevar("x", bvsort);
+  Term y = fts.make_statevar("y", bvsort);
+  Term w = fts.make_statevar("w", bvsort);
+  Term zero = fts.make_term(0, bvsort);
+  Term one = fts.make_term(1, bvsort);
+  Term ten = fts.make_term(10, bvsort);
+  fts.assign_next(x,
+                  fts.make_term(Ite,
+                                fts.make_term(BVUlt, x, ten),
+                                fts.make_term(BVAdd, x, one),
+                                zero));
+  fts.assign_next(y, x);
+  fts.assign_next(w, fts.make_term(BVAdd, w, one));
+  fts.constrain_init(fts.make_term(Equal, x, zero));
+  fts.constrain_init(fts.make_term(Equal, y, zero));
+  fts.constrain_init(fts.make_term(Equal, w, zero));
+}
+
+/** @return the names of the latches kept by the abstraction */
+static vector<string> kept_names(const CegarLocalization & loc)
+{
+  vector<string> names;
+  for (const auto & l : loc.kept_latches()) {
+    names.push_back(l->to_string());
+  }
+  sort(names.begin(), names.end());
+  return names;
+}
+
+TEST_P(CegarLocalizationTests, RefinesToTrue)
+{
+  FunctionalTransitionSystem fts(s);
+  localization_system(fts, bvsort);
+  Term y = fts.lookup("y");
+  Property p(s, fts.make_term(BVUle, y, fts.make_term(10, bvsort)));
+
+  PonoOptions opts;
+  opts.engine_ = KIND;
+  // y is refined by the initial value and update of x, w is never needed
+  CegarLocalization loc(p, fts, create_solver(GetParam()), opts);
+  ASSERT_EQ(loc.check_until(10), ProverResult::TRUE);
+  EXPECT_EQ(kept_names(loc), vector<string>({ "x", "y" }));
+  EXPECT_GE(loc.statistics().get("cegar_refinements"), 1);
+}
+
+TEST_P(CegarLocalizationTests, RealCounterexample)
+{
+  FunctionalTransitionSystem fts(s);
+  localization_system(fts, bvsort);
+  Term y = fts.lookup("y");
+  Property p(s, fts.make_term(BVUlt, y, fts.make_term(5, bvsort)));
+
+  shared_ptr<Prover> loc = make_cegar_localization_prover(
+      BMC, p, fts, create_solver(GetParam()));
+  ASSERT_EQ(loc->check_until(10), ProverResult::FALSE);
+  // y is 5 after 6 steps
+  vector<UnorderedTermMap> cex;
+  ASSERT_TRUE(loc->witness(cex));
+  EXPECT_EQ(cex.size(), 7);
+}
+
+TEST_P(CegarLocalizationTests, ProofBasedAbstraction)
+{
+  FunctionalTransitionSystem fts(s);
+  localization_system(fts, bvsort);
+  Term y = fts.lookup("y");
+  Property p(s, fts.make_term(BVUle, y, fts.make_term(10, bvsort)));
+
+  PonoOptions opts;
+  opts.engine_ = KIND;
+  opts.ceg_localization_ = true;
+  opts.ceg_localization_pba_ = 3;
+  CegarLocalization loc(p, fts, create_solver(GetParam()), opts);
+  ASSERT_EQ(loc.check_until(10), ProverResult::TRUE);
+  // the cores of BMC already refute the abstraction with only y
+  EXPECT_EQ(kept_names(loc), vector<string>({ "x", "y" }));
+  EXPECT_EQ(loc.statistics().get("cegar_refinements"), 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(ParameterizedSolverCegarLocalizationTests,
+                         CegarLocalizationTests,
+                         testing::ValuesIn(available_solver_enums()));
+
+}  // namespace pono_tests
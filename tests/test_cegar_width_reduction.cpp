@@ -0,0 +1,119 @@
+#include <vector>
+
+#include "core/fts.h"
+#include "engines/cegar_width_reduction.h"
+#include "gtest/gtest.h"
+#include "smt/available_solvers.h"
+#include "utils/make_provers.h"
+
+using namespace pono;
+using namespace smt;
+using namespace std;
+
+namespace pono_tests {
+
+class CegarWidthReductionTests
+    : public ::testing::Test,
+      public ::testing::WithParamInterface<SolverEnum>
+{
+ protected:
+  void SetUp() override
+  {
+    s = create_solver(GetParam());
+    boolsort = s->make_sort(BOOL);
+    bvsort = s->make_sort(BV, 32);
+  }
+  SmtSolver s;
+  Sort boolsort;
+  Sort bvsort;
+};
+
+/** a loads in when en is set, b and c both copy a, and cnt counts
+ *  (from 1, the data and cnt share no constant) */
+static void transport_system(FunctionalTransitionSystem & fts,
+                             const Sort & boolsort,
+                             const Sort & bvsort)
+{
+  Term en = fts.make_inputvar("en", boolsort);
+  Term in = fts.make_inputvar("in", bvsort);
+  Term a = fts.make_statevar("a", bvsort);
+  Term b = fts.make_statevar("b", bvsort);
+  Term c = fts.make_statevar("c", bvsort);
+  Term cnt = fts.make_statevar("cnt", bvsort);
+  Term zero = fts.make_term(0, bvsort);
+  Term one = fts.make_term(1, bvsort);
+  fts.assign_next(a, fts.make_term(Ite, en, in, a));
+  fts.assign_next(b, a);
+  fts.assign_next(c, a);
+  fts.assign_next(cnt, fts.make_term(BVAdd, cnt, one));
+  fts.constrain_init(fts.make_term(Equal, a, zero));
+  fts.constrain_init(fts.make_term(Equal, b, zero));
+  fts.constrain_init(fts.make_term(Equal, c, zero));
+  fts.constrain_init(fts.make_term(Equal, cnt, one));
+}
+
+TEST_P(CegarWidthReductionTests, ReducesDataOnly)
+{
+  FunctionalTransitionSystem fts(s);
+  transport_system(fts, boolsort, bvsort);
+  Term b = fts.lookup("b");
+  Term c = fts.lookup("c");
+  Term bad = fts.make_term(Distinct, b, c);
+
+  WidthReducer reducer(fts, bad);
+  // cnt goes through an addition
+  EXPECT_EQ(reducer.num_classes(), 1);
+  EXPECT_EQ(reducer.num_reduced(), 1);
+
+  Term abs_bad;
+  TransitionSystem abs_ts = reducer.abstract(abs_bad);
+  // a, b and c, in and 0 fit in 3 bits
+  for (const auto & v : abs_ts.statevars()) {
+    if (v != fts.lookup("cnt")) {
+      EXPECT_EQ(v->get_sort()->get_width(), 3);
+    }
+  }
+  EXPECT_TRUE(abs_ts.is_functional());
+
+  EXPECT_TRUE(reducer.refine());
+  EXPECT_EQ(reducer.num_reduced(), 0);
+  EXPECT_FALSE(reducer.refine());
+}
+
+TEST_P(CegarWidthReductionTests, Proves)
+{
+  FunctionalTransitionSystem fts(s);
+  transport_system(fts, boolsort, bvsort);
+  Term b = fts.lookup("b");
+  Term c = fts.lookup("c");
+  Property p(s, fts.make_term(Equal, b, c));
+
+  PonoOptions opts;
+  opts.engine_ = KIND;
+  CegarWidthReduction cwr(p, fts, create_solver(GetParam()), opts);
+  ASSERT_EQ(cwr.check_until(10), ProverResult::TRUE);
+  EXPECT_EQ(cwr.statistics().get("width_reduction_reduced"), 1);
+  EXPECT_EQ(cwr.statistics().get("cegar_refinements"), 0);
+}
+
+TEST_P(CegarWidthReductionTests, ConcreteCounterexample)
+{
+  FunctionalTransitionSystem fts(s);
+  transport_system(fts, boolsort, bvsort);
+  Term b = fts.lookup("b");
+  Property p(s, fts.make_term(Distinct, b, fts.make_term(123456, bvsort)));
+
+  shared_ptr<Prover> cwr = make_cegar_width_reduction_prover(
+      BMC, p, fts, create_solver(GetParam()));
+  ASSERT_EQ(cwr->check_until(10), ProverResult::FALSE);
+  // in is loaded into a, then copied to b
+  vector<UnorderedTermMap> cex;
+  ASSERT_TRUE(cwr->witness(cex));
+  ASSERT_EQ(cex.size(), 3);
+}
+
+INSTANTIATE_TEST_SUITE_P(ParameterizedSolverCegarWidthReductionTests,
+                         CegarWidthReductionTests,
+                         testing::ValuesIn(available_solver_enums()));
+
+}  // namespace pono_tests
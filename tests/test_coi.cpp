@@ -2,6 +2,7 @@
 #include "gtest/gtest.h"
 #include "modifiers/static_coi.h"
 #include "smt/available_solvers.h"
+#include "utils/incremental_coi.h"
 
 using namespace pono;
 using namespace smt;
@@ -60,6 +61,50 @@ TEST_P(CoiUnitTests, SimpleCoiTest)
   EXPECT_TRUE(named_terms.find("c") == named_terms.end());
 }
 
+TEST_P(CoiUnitTests, IncrementalCoiTest)
+{
+  FunctionalTransitionSystem fts(s);
+
+  Term a = fts.make_inputvar("a", bvsort8);
+  Term b = fts.make_inputvar("b", bvsort8);
+  Term d = fts.make_inputvar("d", boolsort);
+
+  Term x = fts.make_statevar("x", bvsort8);
+  Term y = fts.make_statevar("y", bvsort8);
+  Term z = fts.make_statevar("z", bvsort8);
+  Term w = fts.make_statevar("w", boolsort);
+
+  // x <- y <- a, z <- z + b, w <- d
+  fts.assign_next(x, y);
+  fts.assign_next(y, a);
+  fts.assign_next(z, fts.make_term(BVAdd, z, b));
+  fts.assign_next(w, d);
+  fts.add_constraint(w);
+
+  IncrementalConeOfInfluence coi(fts);
+  Term px = fts.make_term(BVUlt, x, fts.make_term(3, bvsort8));
+  Term pz = fts.make_term(Equal, z, fts.make_term(0, bvsort8));
+
+  UnorderedTermSet statevars, inputvars;
+  coi.compute_coi({ px }, statevars, inputvars);
+  EXPECT_EQ(statevars, UnorderedTermSet({ x, y, w }));
+  EXPECT_EQ(inputvars, UnorderedTermSet({ a, d }));
+  // x, y, a and the cone of the constraint w, d
+  EXPECT_EQ(coi.cone_size({ px }), 5);
+  EXPECT_EQ(coi.cone_size({ pz }), 4);
+  EXPECT_EQ(coi.cone_size({ px, pz }), 7);
+
+  // same result as the regular pass
+  TransitionSystem reduced = coi.reduced_ts({ pz });
+  FunctionalTransitionSystem fts_copy = fts;
+  StaticConeOfInfluence static_coi(fts_copy, { pz });
+  EXPECT_EQ(reduced.statevars(), fts_copy.statevars());
+  EXPECT_EQ(reduced.inputvars(), fts_copy.inputvars());
+  EXPECT_EQ(reduced.state_updates(), fts_copy.state_updates());
+  // the original system is not modified
+  EXPECT_EQ(fts.statevars().size(), 4);
+}
+
 INSTANTIATE_TEST_SUITE_P(ParameterizedCoiUnitTests,
                          CoiUnitTests,
                          testing::ValuesIn(available_solver_enums()));
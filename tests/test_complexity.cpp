@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/fts.h"
+#include "frontends/btor2_encoder.h"
+#include "gtest/gtest.h"
+#include "smt/available_solvers.h"
+#include "utils/make_provers.h"
+#include "utils/statistics.h"
+
+// used to recover string paths from macros
+#define STRHELPER(A) #A
+#define STRFY(A) STRHELPER(A)
+
+using namespace pono;
+using namespace smt;
+using namespace std;
+
+namespace pono_tests {
+
+// Complexity regression tests: the number of solver calls, unsat cores,
+// refinements and frames of an engine on a sample are deterministic for
+// the default seed, unlike the run time. Each case gives upper bounds on
+// the statistics of the engine, so that an algorithmic regression (e.g.
+// in the generalization of IC3 or a CEGAR loop) fails the tests.
+// Raise a bound only with a reason, and lower it when an improvement
+// makes it loose.
+
+struct ComplexityCase
+{
+  string name;               ///< test name
+  string sample;             ///< file in samples/
+  Engine engine;
+  SolverEnum solver;
+  bool ceg_prophecy_arrays;  ///< run the engine in CegProphecyArrays
+  int bound;                 ///< passed to check_until
+  ProverResult expected;
+  // upper bounds on the counters of the statistics, where solver_calls
+  // is the sum of all check_sat* calls, including the frame solvers
+  vector<pair<string, size_t>> max_stats;
+};
+
+const vector<ComplexityCase> complexity_cases({
+    // the counter reaches 10 after 10 steps, one query per bound
+    { "CounterFalseBmc",
+      "counter.btor",
+      BMC,
+      BTOR,
+      false,
+      20,
+      ProverResult::FALSE,
+      { { "check_sat_calls", 11 } } },
+    // the property of counter-true is 1-inductive
+    { "CounterTrueKInduction",
+      "counter-true.btor",
+      KIND,
+      BTOR,
+      false,
+      10,
+      ProverResult::TRUE,
+      { { "solver_calls", 12 } } },
+    { "CounterTrueMbIC3",
+      "counter-true.btor",
+      MBIC3,
+      BTOR,
+      false,
+      10,
+      ProverResult::TRUE,
+      { { "solver_calls", 60 }, { "unsat_cores", 20 }, { "frames", 5 } } },
+#ifdef WITH_MSAT
+    { "CounterTrueIC3IA",
+      "counter-true.btor",
+      IC3IA_ENGINE,
+      MSAT,
+      false,
+      10,
+      ProverResult::TRUE,
+      { { "solver_calls", 100 }, { "refinements", 5 }, { "frames", 5 } } },
+    { "ArrayLt200CegProphecyIC3IA",
+      "array_lt200.btor2",
+      IC3IA_ENGINE,
+      MSAT,
+      true,
+      10,
+      ProverResult::TRUE,
+      { { "cegar_refinements", 10 },
+        { "refinements", 20 },
+        { "frames", 10 } } },
+#endif
+});
+
+/** @return the counter name of the statistics, or solver_calls */
+size_t get_stat(const Statistics & stats, const string & name)
+{
+  if (name == "solver_calls") {
+    return stats.get("check_sat_calls") + stats.get("check_sat_assuming_calls")
+           + stats.get("frame_solver_calls");
+  }
+  return stats.get(name);
+}
+
+class ComplexityTests : public ::testing::Test,
+                        public ::testing::WithParamInterface<ComplexityCase>
+{
+};
+
+TEST_P(ComplexityTests, SolverCallBounds)
+{
+  const ComplexityCase & c = GetParam();
+  vector<SolverEnum> solvers = available_solver_enums();
+  if (find(solvers.begin(), solvers.end(), c.solver) == solvers.end()) {
+    GTEST_SKIP() << "solver " << to_string(c.solver) << " is not available";
+  }
+
+  SmtSolver s =
+      create_solver_for(c.solver, c.engine, false, c.ceg_prophecy_arrays);
+  FunctionalTransitionSystem fts(s);
+  string filename = STRFY(PONO_SRC_DIR);
+  filename += "/samples/" + c.sample;
+  BTOR2Encoder be(filename, fts);
+  ASSERT_GE(be.propvec().size(), 1);
+  Property p(s, be.propvec()[0]);
+
+  PonoOptions opts;
+  opts.engine_ = c.engine;
+  opts.ceg_prophecy_arrays_ = c.ceg_prophecy_arrays;
+  shared_ptr<Prover> prover =
+      c.ceg_prophecy_arrays ? make_ceg_proph_prover(c.engine, p, fts, s, opts)
+                            : make_prover(c.engine, p, fts, s, opts);
+  ASSERT_EQ(prover->check_until(c.bound), c.expected);
+
+  // the statistics kept by statistics_registry for --stats-json
+  const Statistics & stats = prover->statistics();
+  for (const auto & bound : c.max_stats) {
+    EXPECT_LE(get_stat(stats, bound.first), bound.second)
+        << bound.first << " in " << stats.to_json();
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    ParameterizedComplexityTests,
+    ComplexityTests,
+    testing::ValuesIn(complexity_cases),
+    [](const testing::TestParamInfo<ComplexityCase> & info) {
+      return info.param.name;
+    });
+
+}  // namespace pono_tests
@@ -65,6 +65,59 @@ TEST_P(ControlUnitTests, SimpleReset)
             ProverResult::UNKNOWN);  // bmc can't prove, will only say unknown
 }
 
+TEST_P(ControlUnitTests, PresimulateReset)
+{
+  // x' = rst ? 0 : (x < 10) ? x + 1 : x
+  // y' = rst ? x : in, only known after two reset steps
+  auto make_system = [](FunctionalTransitionSystem & fts) {
+    Sort bvsort8 = fts.make_sort(BV, 8);
+    Term rst = fts.make_inputvar("rst", fts.make_sort(BOOL));
+    Term in = fts.make_inputvar("in", bvsort8);
+    Term x = fts.make_statevar("x", bvsort8);
+    Term y = fts.make_statevar("y", bvsort8);
+    Term x_update =
+        fts.make_term(Ite,
+                      fts.make_term(BVUlt, x, fts.make_term(10, bvsort8)),
+                      fts.make_term(BVAdd, x, fts.make_term(1, bvsort8)),
+                      x);
+    fts.assign_next(
+        x, fts.make_term(Ite, rst, fts.make_term(0, bvsort8), x_update));
+    fts.assign_next(y, fts.make_term(Ite, rst, x, in));
+    return rst;
+  };
+
+  // after one step y depends on the initial value of x
+  FunctionalTransitionSystem one_step(create_solver(s->get_solver_enum()));
+  Term one_step_rst = make_system(one_step);
+  Term one_step_init = one_step.init();
+  EXPECT_FALSE(presimulate_reset(one_step, one_step_rst, 1));
+  EXPECT_EQ(one_step.init(), one_step_init);
+
+  FunctionalTransitionSystem fts(s);
+  Term rst = make_system(fts);
+  Term x = fts.lookup("x");
+  Term y = fts.lookup("y");
+  EXPECT_TRUE(presimulate_reset(fts, rst, 2));
+  // no guard needed, x starts at 0 and y at 0
+  Term p_term = fts.make_term(
+      And,
+      fts.make_term(BVUle, x, fts.make_term(10, bvsort8)),
+      fts.make_term(BVUle, y, fts.make_term(10, bvsort8)));
+  Property p(fts.solver(), p_term);
+  SmtSolver ns = create_solver(s->get_solver_enum());
+  Bmc bmc(p, fts, ns);
+  ProverResult r = bmc.check_until(10);
+  EXPECT_EQ(r, ProverResult::UNKNOWN);
+
+  // y follows the input once reset is released
+  Term p_false_term = fts.make_term(Equal, y, fts.make_term(0, bvsort8));
+  Property p_false(fts.solver(), p_false_term);
+  SmtSolver ns_false = create_solver(s->get_solver_enum());
+  Bmc bmc_false(p_false, fts, ns_false);
+  r = bmc_false.check_until(2);
+  EXPECT_EQ(r, ProverResult::FALSE);
+}
+
 TEST_P(ControlUnitTests, SimpleClock)
 {
   // use a relational system -- easier to express positive clock edge without
@@ -114,6 +167,45 @@ TEST_P(ControlUnitTests, SimpleClock)
             ProverResult::UNKNOWN);  // bmc can't prove, will only say unknown
 }
 
+TEST_P(ControlUnitTests, FoldClock)
+{
+  // x' = clk ? x + 1 : x, with y' = !clk ? y + 1 : y if both_edges
+  auto make_system = [](FunctionalTransitionSystem & fts, bool both_edges) {
+    Sort bvsort8 = fts.make_sort(BV, 8);
+    Term clk = fts.make_inputvar("clk", fts.make_sort(BOOL));
+    Term x = fts.make_statevar("x", bvsort8);
+    Term one = fts.make_term(1, bvsort8);
+    fts.assign_next(x, fts.make_term(Ite, clk, fts.make_term(BVAdd, x, one), x));
+    fts.constrain_init(fts.make_term(Equal, x, fts.make_term(0, bvsort8)));
+    if (both_edges) {
+      Term y = fts.make_statevar("y", bvsort8);
+      fts.assign_next(
+          y, fts.make_term(Ite, clk, y, fts.make_term(BVAdd, y, one)));
+    }
+    return clk;
+  };
+
+  FunctionalTransitionSystem both(create_solver(s->get_solver_enum()));
+  Term both_clk = make_system(both, true);
+  Term both_trans = both.trans();
+  EXPECT_FALSE(fold_clock(both, both_clk, {}));
+  EXPECT_EQ(both.trans(), both_trans);
+
+  FunctionalTransitionSystem fts(s);
+  Term clk = make_system(fts, false);
+  Term x = fts.lookup("x");
+  Term p_term = fts.make_term(Distinct, x, fts.make_term(3, bvsort8));
+  // the property must not use the clock
+  EXPECT_FALSE(fold_clock(fts, clk, { fts.make_term(And, p_term, clk) }));
+  EXPECT_TRUE(fold_clock(fts, clk, { p_term }));
+
+  // one cycle per transition, x reaches 3 at bound 3
+  Property p(fts.solver(), p_term);
+  Bmc bmc(p, fts, create_solver(s->get_solver_enum()));
+  EXPECT_EQ(bmc.check_until(2), ProverResult::UNKNOWN);
+  EXPECT_EQ(bmc.check_until(3), ProverResult::FALSE);
+}
+
 INSTANTIATE_TEST_SUITE_P(ParameterizedControlUnitTests,
                          ControlUnitTests,
                          testing::ValuesIn(available_solver_enums()));
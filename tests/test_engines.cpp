@@ -1,3 +1,4 @@
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -7,11 +8,19 @@
 #include "engines/bmc.h"
 #include "engines/bmc_simplepath.h"
 #include "engines/interpolantmc.h"
+#include "engines/ismc.h"
 #include "engines/kinduction.h"
+#include "engines/mbic3.h"
+#include "engines/parallel_bmc.h"
+#include "engines/random_sim.h"
+#include "engines/reverse_ic3.h"
 #include "gtest/gtest.h"
 #include "smt/available_solvers.h"
 #include "tests/common_ts.h"
+#include "utils/batch_check.h"
 #include "utils/exceptions.h"
+#include "utils/lemma_bus.h"
+#include "utils/portfolio.h"
 #include "utils/ts_analysis.h"
 
 using namespace pono;
@@ -96,6 +105,135 @@ TEST_P(EngineUnitTests, BmcSimplePathFalse)
   ASSERT_EQ(r, ProverResult::FALSE);
 }
 
+TEST_P(EngineUnitTests, BmcAssumptionsTrue)
+{
+  SmtSolver s = create_solver(se);
+  PonoOptions opts;
+  opts.bmc_assumptions_ = true;
+  Bmc b(*true_p, *ts, s, opts);
+  ProverResult r = b.check_until(20);
+  ASSERT_EQ(r, ProverResult::UNKNOWN);
+}
+
+TEST_P(EngineUnitTests, BmcAssumptionsFalse)
+{
+  SmtSolver s = create_solver(se);
+  PonoOptions opts;
+  opts.bmc_assumptions_ = true;
+  Bmc b(*false_p, *ts, s, opts);
+  ProverResult r = b.check_until(20);
+  ASSERT_EQ(r, ProverResult::FALSE);
+  vector<UnorderedTermMap> cex;
+  b.witness(cex);
+  ASSERT_EQ(cex.size(), b.witness_length());
+}
+
+TEST_P(EngineUnitTests, BmcStepSizeFalse)
+{
+  SmtSolver s1 = create_solver(se);
+  Bmc b1(*false_p, *ts, s1);
+  ASSERT_EQ(b1.check_until(20), ProverResult::FALSE);
+
+  for (bool assumptions : { false, true }) {
+    SmtSolver s = create_solver(se);
+    PonoOptions opts;
+    opts.bmc_step_size_ = 5;
+    opts.bmc_assumptions_ = assumptions;
+    Bmc b(*false_p, *ts, s, opts);
+    ProverResult r = b.check_until(20);
+    ASSERT_EQ(r, ProverResult::FALSE);
+    // should find the shortest counterexample
+    ASSERT_EQ(b.witness_length(), b1.witness_length());
+  }
+}
+
+TEST_P(EngineUnitTests, BmcStepSizeTrue)
+{
+  SmtSolver s = create_solver(se);
+  PonoOptions opts;
+  opts.bmc_step_size_ = 4;
+  Bmc b(*true_p, *ts, s, opts);
+  ProverResult r = b.check_until(10);
+  ASSERT_EQ(r, ProverResult::UNKNOWN);
+  // bounds 0-3, 4-7 and 8-10
+  ASSERT_EQ(b.statistics().get("check_sat_calls"), 3);
+}
+
+TEST_P(EngineUnitTests, BmcConeSlice)
+{
+  SmtSolver s = create_solver(se);
+  Sort bvsort = s->make_sort(BV, 8);
+  FunctionalTransitionSystem fts(s);
+  // a counter x feeds a pipeline p0 -> p1 -> p2, y is outside of its cone
+  Term x = fts.make_statevar("x", bvsort);
+  Term y = fts.make_statevar("y", bvsort);
+  Term zero = fts.make_term(0, bvsort);
+  Term one = fts.make_term(1, bvsort);
+  TermVec pipe;
+  for (size_t i = 0; i < 3; ++i) {
+    pipe.push_back(fts.make_statevar("p" + std::to_string(i), bvsort));
+    fts.constrain_init(fts.make_term(Equal, pipe.back(), zero));
+    fts.assign_next(pipe.back(), i ? pipe[i - 1] : x);
+  }
+  for (const auto & v : { x, y }) {
+    fts.constrain_init(fts.make_term(Equal, v, zero));
+    fts.assign_next(v, fts.make_term(BVAdd, v, one));
+  }
+  Property p(s, fts.make_term(BVUlt, pipe.back(), fts.make_term(4, bvsort)));
+
+  SmtSolver s1 = create_solver(se);
+  Bmc b1(p, fts, s1);
+  ASSERT_EQ(b1.check_until(20), ProverResult::FALSE);
+
+  for (bool assumptions : { false, true }) {
+    SmtSolver s2 = create_solver(se);
+    PonoOptions opts;
+    opts.bmc_cone_slice_ = true;
+    opts.bmc_assumptions_ = assumptions;
+    Bmc b(p, fts, s2, opts);
+    ASSERT_EQ(b.check_until(20), ProverResult::FALSE);
+    ASSERT_EQ(b.witness_length(), b1.witness_length());
+
+    // the witness is a path, also outside of the cone of bad
+    vector<UnorderedTermMap> cex;
+    ASSERT_TRUE(b.witness(cex));
+    for (size_t t = 0; t < cex.size(); ++t) {
+      EXPECT_EQ(cex[t].at(y), fts.make_term(t, bvsort));
+    }
+  }
+}
+
+TEST_P(EngineUnitTests, ParallelBmcTrue)
+{
+  SmtSolver s = create_solver(se);
+  PonoOptions opts;
+  opts.bmc_threads_ = 3;
+  ParallelBmc b(*true_p, *ts, s, opts);
+  ProverResult r = b.check_until(10);
+  ASSERT_EQ(r, ProverResult::UNKNOWN);
+  ASSERT_EQ(b.statistics().get("reached_k"), 10);
+  ASSERT_EQ(b.statistics().get("check_sat_calls"), 11);
+}
+
+TEST_P(EngineUnitTests, ParallelBmcFalse)
+{
+  SmtSolver s1 = create_solver(se);
+  Bmc b1(*false_p, *ts, s1);
+  ASSERT_EQ(b1.check_until(20), ProverResult::FALSE);
+
+  SmtSolver s = create_solver(se);
+  PonoOptions opts;
+  opts.bmc_threads_ = 3;
+  ParallelBmc b(*false_p, *ts, s, opts);
+  ProverResult r = b.check_until(20);
+  ASSERT_EQ(r, ProverResult::FALSE);
+  // always the shortest counterexample
+  ASSERT_EQ(b.witness_length(), b1.witness_length());
+  vector<UnorderedTermMap> cex;
+  b.witness(cex);
+  ASSERT_EQ(cex.size(), b.witness_length());
+}
+
 TEST_P(EngineUnitTests, KInductionTrue)
 {
   SmtSolver s = create_solver(se);
@@ -112,6 +250,389 @@ TEST_P(EngineUnitTests, KInductionFalse)
   ASSERT_EQ(r, ProverResult::FALSE);
 }
 
+TEST_P(EngineUnitTests, KInductionFingerprintTrue)
+{
+  SmtSolver s = create_solver(se);
+  PonoOptions opts;
+  opts.kind_fingerprint_ = true;
+  KInduction kind(*true_p, *ts, s, opts);
+  ProverResult r = kind.check_until(20);
+  ASSERT_EQ(r, ProverResult::TRUE);
+}
+
+TEST_P(EngineUnitTests, KInductionFingerprintFalse)
+{
+  SmtSolver s = create_solver(se);
+  PonoOptions opts;
+  opts.kind_fingerprint_ = true;
+  KInduction kind(*false_p, *ts, s, opts);
+  ProverResult r = kind.check_until(20);
+  ASSERT_EQ(r, ProverResult::FALSE);
+}
+
+TEST_P(EngineUnitTests, KInductionDualSolverTrue)
+{
+  SmtSolver s = create_solver(se);
+  PonoOptions opts;
+  opts.kind_dual_solver_ = true;
+  KInduction kind(*true_p, *ts, s, opts);
+  ProverResult r = kind.check_until(20);
+  ASSERT_EQ(r, ProverResult::TRUE);
+}
+
+TEST_P(EngineUnitTests, KInductionDualSolverFalse)
+{
+  SmtSolver s = create_solver(se);
+  PonoOptions opts;
+  opts.kind_dual_solver_ = true;
+  KInduction kind(*false_p, *ts, s, opts);
+  ProverResult r = kind.check_until(20);
+  ASSERT_EQ(r, ProverResult::FALSE);
+}
+
+TEST_P(EngineUnitTests, KInductionCandidateInvariants)
+{
+  Term x = ts->named_terms().at("x");
+  // not k-inductive for small k: 8, ..., 199 is a path to 200
+  Property p(ts->solver(),
+             ts->make_term(Distinct, x, ts->make_term(200, bvsort8)));
+  // x never exceeds the maximum, and a wrong candidate
+  TermVec candidates({ ts->make_term(BVUle, x, max_val),
+                       ts->make_term(Equal, x, ts->make_term(0, bvsort8)) });
+
+  SmtSolver s = create_solver(se);
+  KInduction kind(p, *ts, s);
+  kind.add_candidate_invariants(candidates);
+  ProverResult r = kind.check_until(3);
+  ASSERT_EQ(r, ProverResult::TRUE);
+
+  SmtSolver s2 = create_solver(se);
+  KInduction weak_kind(p, *ts, s2);
+  r = weak_kind.check_until(3);
+  ASSERT_EQ(r, ProverResult::UNKNOWN);
+}
+
+TEST_P(EngineUnitTests, RandomSimTrue)
+{
+  if (!ts->is_functional()) {
+    // simulation requires functional state updates
+    return;
+  }
+  SmtSolver s = create_solver(se);
+  PonoOptions opts;
+  opts.sim_traces_ = 10;
+  RandomSim sim(*true_p, *ts, s, opts);
+  ProverResult r = sim.check_until(20);
+  ASSERT_EQ(r, ProverResult::UNKNOWN);
+  ASSERT_EQ(sim.statistics().get("traces"), 10);
+  ASSERT_EQ(sim.statistics().get("cycles"), 210);
+}
+
+TEST_P(EngineUnitTests, RandomSimFalse)
+{
+  if (!ts->is_functional()) {
+    return;
+  }
+  SmtSolver s = create_solver(se);
+  RandomSim sim(*false_p, *ts, s);
+  ProverResult r = sim.check_until(20);
+  ASSERT_EQ(r, ProverResult::FALSE);
+
+  // the counter reaches 7 after 7 steps
+  vector<UnorderedTermMap> cex;
+  ASSERT_TRUE(sim.witness(cex));
+  ASSERT_EQ(cex.size(), 8);
+  ASSERT_EQ(sim.witness_length(), 8);
+  Term x = ts->named_terms().at("x");
+  ASSERT_EQ(cex.back().at(x), ts->make_term(7, bvsort8));
+}
+
+TEST_P(EngineUnitTests, RandomSimBitParallel)
+{
+  if (!ts->is_functional()) {
+    return;
+  }
+  SmtSolver s = create_solver(se);
+  PonoOptions opts;
+  opts.sim_lanes_ = 256;
+  RandomSim sim(*false_p, *ts, s, opts);
+  ProverResult r = sim.check_until(20);
+  ASSERT_EQ(r, ProverResult::FALSE);
+  ASSERT_EQ(sim.witness_length(), 8);
+  ASSERT_EQ(sim.statistics().get("traces"), 256);
+}
+
+TEST_P(EngineUnitTests, RandomSimThreads)
+{
+  if (!ts->is_functional()) {
+    return;
+  }
+  SmtSolver s = create_solver(se);
+  PonoOptions opts;
+  opts.sim_lanes_ = 64;
+  opts.sim_threads_ = 4;
+  opts.sim_traces_ = 1024;
+  RandomSim true_sim(*true_p, *ts, s, opts);
+  ASSERT_EQ(true_sim.check_until(20), ProverResult::UNKNOWN);
+  // the threads share the traces
+  ASSERT_EQ(true_sim.statistics().get("traces"), 1024);
+  ASSERT_EQ(true_sim.statistics().get("cycles"), 1024 * 21);
+
+  RandomSim false_sim(*false_p, *ts, s, opts);
+  ASSERT_EQ(false_sim.check_until(20), ProverResult::FALSE);
+  vector<UnorderedTermMap> cex;
+  ASSERT_TRUE(false_sim.witness(cex));
+  ASSERT_EQ(cex.size(), 8);
+  Term x = ts->named_terms().at("x");
+  ASSERT_EQ(cex.back().at(x), ts->make_term(7, bvsort8));
+}
+
+TEST_P(EngineUnitTests, PortfolioTrue)
+{
+  PonoOptions opts;
+  opts.smt_solver_ = se;
+  PortfolioResult res = run_portfolio({ BMC, KIND }, *true_p, *ts, 20, opts);
+  ASSERT_EQ(res.result, ProverResult::TRUE);
+  ASSERT_EQ(res.engine, KIND);
+  ASSERT_TRUE(res.prover);
+}
+
+TEST_P(EngineUnitTests, PortfolioFalse)
+{
+  PonoOptions opts;
+  opts.smt_solver_ = se;
+  PortfolioResult res = run_portfolio({ BMC, KIND }, *false_p, *ts, 20, opts);
+  ASSERT_EQ(res.result, ProverResult::FALSE);
+  ASSERT_TRUE(res.prover);
+}
+
+TEST_P(EngineUnitTests, PortfolioShareLemmas)
+{
+  PonoOptions opts;
+  opts.smt_solver_ = se;
+  opts.portfolio_ = true;
+  opts.share_lemmas_ = true;
+  PortfolioResult res =
+      run_portfolio({ BMC, KIND, MBIC3 }, *true_p, *ts, 20, opts);
+  ASSERT_EQ(res.result, ProverResult::TRUE);
+  ASSERT_TRUE(res.prover);
+}
+
+TEST_P(EngineUnitTests, PortfolioSliced)
+{
+  PonoOptions opts;
+  opts.smt_solver_ = se;
+  // one core for three engines, with short slices so they take turns
+  PortfolioResult res = run_sliced_portfolio(
+      { SIM, BMC, KIND }, *true_p, *ts, 20, 1, 0.01, opts);
+  ASSERT_EQ(res.result, ProverResult::TRUE);
+  ASSERT_EQ(res.engine, KIND);
+
+  res = run_sliced_portfolio(
+      { KIND, MBIC3, BMC }, *false_p, *ts, 20, 2, 0.01, opts);
+  ASSERT_EQ(res.result, ProverResult::FALSE);
+  ASSERT_TRUE(res.prover);
+}
+
+TEST_P(EngineUnitTests, PortfolioDeterministic)
+{
+  PonoOptions opts;
+  opts.smt_solver_ = se;
+  opts.deterministic_ = true;
+  opts.share_lemmas_ = true;
+  opts.bmc_threads_ = 3;
+  // the first engine in the list wins the epoch both decide in
+  PortfolioResult res =
+      run_portfolio({ BMC_PAR, KIND, BMC }, *false_p, *ts, 20, opts);
+  ASSERT_EQ(res.result, ProverResult::FALSE);
+  ASSERT_EQ(res.engine, BMC_PAR);
+  vector<UnorderedTermMap> cex;
+  ASSERT_TRUE(res.prover->witness(cex));
+
+  opts.portfolio_cores_ = 1;
+  res = run_portfolio({ BMC_PAR, KIND, BMC }, *false_p, *ts, 20, opts);
+  ASSERT_EQ(res.engine, BMC_PAR);
+  vector<UnorderedTermMap> cex1;
+  ASSERT_TRUE(res.prover->witness(cex1));
+  ASSERT_EQ(cex.size(), cex1.size());
+  for (size_t i = 0; i < cex.size(); ++i) {
+    for (const auto & elem : cex[i]) {
+      EXPECT_EQ(cex1[i].at(elem.first), elem.second);
+    }
+  }
+
+  res = run_portfolio({ BMC, KIND }, *true_p, *ts, 20, opts);
+  ASSERT_EQ(res.result, ProverResult::TRUE);
+  ASSERT_EQ(res.engine, KIND);
+}
+
+TEST_P(EngineUnitTests, LemmaBusEpochs)
+{
+  shared_ptr<LemmaBus> bus = make_shared<LemmaBus>(ts->solver());
+  bus->set_epoch_mode(true);
+  TermTranslator to_bus(ts->solver());
+  TermTranslator from_bus(ts->solver());
+  int first, second;
+  bus->register_source(&first);
+  bus->register_source(&second);
+
+  bus->publish_lemma({ false_p->prop() }, to_bus, &second);
+  bus->publish_lemma({ true_p->prop() }, to_bus, &first);
+  bus->publish_safe_bound(4);
+  EXPECT_EQ(bus->num_lemmas(), 0);
+  EXPECT_EQ(bus->safe_bound(), -1);
+
+  bus->end_epoch();
+  EXPECT_EQ(bus->safe_bound(), 4);
+  size_t idx = 0;
+  vector<TermVec> out;
+  bus->import_lemmas(idx, from_bus, nullptr, out);
+  // ordered by publisher, not by publication
+  ASSERT_EQ(out.size(), 2);
+  EXPECT_EQ(out[0][0], true_p->prop());
+  EXPECT_EQ(out[1][0], false_p->prop());
+}
+
+TEST_P(EngineUnitTests, BatchCheck)
+{
+  PonoOptions opts;
+  opts.smt_solver_ = se;
+  BatchChecker checker(*ts,
+                       { true_p->prop(), false_p->prop(), true_p->prop() },
+                       { BMC, KIND },
+                       20,
+                       opts);
+  std::thread t([&checker] { checker.run(); });
+  std::vector<ProverResult> results(3, ProverResult::ERROR);
+  BatchResult r;
+  size_t num_results = 0;
+  while (checker.next_result(r)) {
+    results.at(r.idx) = r.result;
+    ++num_results;
+  }
+  t.join();
+  EXPECT_EQ(num_results, 3);
+  EXPECT_EQ(results[0], ProverResult::TRUE);
+  EXPECT_EQ(results[1], ProverResult::FALSE);
+  EXPECT_EQ(results[2], ProverResult::TRUE);
+  EXPECT_EQ(checker.results()[0].engine, KIND);
+}
+
+TEST_P(EngineUnitTests, BmcFrameLemmas)
+{
+  // x <= 6 holds in the states reachable with at most 6 transitions
+  shared_ptr<LemmaBus> bus = make_shared<LemmaBus>(ts->solver());
+  TermTranslator to_bus(ts->solver());
+  bus->publish_lemma({ false_p->prop() }, to_bus, &to_bus, nullptr, 6);
+  bus->publish_lemma({ false_p->prop() }, to_bus, &to_bus, nullptr, 5);
+  EXPECT_EQ(bus->num_lemmas(), 1);
+
+  SmtSolver s = create_solver(se);
+  PonoOptions opts;
+  opts.bmc_frame_lemmas_ = true;
+  Bmc b(*false_p, *ts, s, opts);
+  b.set_lemma_bus(bus);
+  ASSERT_EQ(b.check_until(20), ProverResult::FALSE);
+  // the lemma is not asserted at step 7
+  Bmc b1(*false_p, *ts, create_solver(se));
+  ASSERT_EQ(b1.check_until(20), ProverResult::FALSE);
+  EXPECT_EQ(b.witness_length(), b1.witness_length());
+  EXPECT_EQ(b.statistics().get("bmc_frame_lemmas"), 1);
+  EXPECT_EQ(b.statistics().get("bmc_frame_lemma_assertions"), 7);
+}
+
+TEST_P(EngineUnitTests, ReverseIC3)
+{
+  if (se == smt::CVC4) {
+    // IC3 variants use multiple solver instances
+    return;
+  }
+
+  ReverseIC3 rev_true(*true_p, *ts, create_solver(se));
+  ASSERT_EQ(rev_true.check_until(20), ProverResult::TRUE);
+  ASSERT_TRUE(check_invar(*ts, true_p->prop(), rev_true.invar()));
+
+  ReverseIC3 rev_false(*false_p, *ts, create_solver(se));
+  ASSERT_EQ(rev_false.check_until(20), ProverResult::FALSE);
+  Bmc b(*false_p, *ts, create_solver(se));
+  ASSERT_EQ(b.check_until(20), ProverResult::FALSE);
+  EXPECT_EQ(rev_false.witness_length(), b.witness_length());
+}
+
+TEST_P(EngineUnitTests, InterruptedBmc)
+{
+  SmtSolver s = create_solver(se);
+  Bmc b(*false_p, *ts, s);
+  b.interrupt();
+  ProverResult r = b.check_until(20);
+  ASSERT_EQ(r, ProverResult::UNKNOWN);
+
+  // a suspended engine continues
+  b.budget().resume();
+  r = b.check_until(20);
+  ASSERT_EQ(r, ProverResult::FALSE);
+}
+
+TEST_P(EngineUnitTests, BmcSolverCallLimit)
+{
+  SmtSolver s = create_solver(se);
+  PonoOptions opts;
+  opts.solver_call_limit_ = 3;
+  Bmc b(*true_p, *ts, s, opts);
+  ProverResult r = b.check_until(20);
+  ASSERT_EQ(r, ProverResult::UNKNOWN);
+  ASSERT_TRUE(b.budget().cancelled());
+  ASSERT_EQ(b.budget().num_solver_calls(), 3);
+  ASSERT_FALSE(b.budget().reason().empty());
+}
+
+TEST_P(EngineUnitTests, BmcQueryRetries)
+{
+  SmtSolver s = create_solver(se);
+  PonoOptions opts;
+  opts.query_time_limit_ = 60000;
+  opts.query_retries_ = 2;
+  Bmc b(*false_p, *ts, s, opts);
+  // a generous limit never triggers a retry
+  ProverResult r = b.check_until(20);
+  ASSERT_EQ(r, ProverResult::FALSE);
+  ASSERT_EQ(b.statistics().get("bmc_query_retries"), 0);
+}
+
+TEST_P(EngineUnitTests, BmcStatistics)
+{
+  SmtSolver s = create_solver(se);
+  Bmc b(*true_p, *ts, s);
+  ProverResult r = b.check_until(5);
+  ASSERT_EQ(r, ProverResult::UNKNOWN);
+  ASSERT_EQ(b.statistics().get("check_sat_calls"), 6);
+  ASSERT_EQ(b.statistics().get("reached_k"), 5);
+  ASSERT_GE(b.statistics().get_time("check_sat_time"), 0);
+}
+
+TEST_P(EngineUnitTests, BmcSimGuide)
+{
+  SmtSolver s = create_solver(se);
+  PonoOptions opts;
+  opts.bmc_sim_guide_ = 256;
+  opts.bound_ = 20;
+  Bmc b(*false_p, *ts, s, opts);
+  ProverResult r = b.check_until(20);
+  ASSERT_EQ(r, ProverResult::FALSE);
+  vector<UnorderedTermMap> cex;
+  ASSERT_TRUE(b.witness(cex));
+  ASSERT_EQ(cex.size(), 8);
+  if (ts->is_functional()) {
+    // the counter is deterministic, the simulation reaches the bad state
+    // and the first guided query is at the bound of the counterexample
+    EXPECT_EQ(b.statistics().get("bmc_guide_length"), 8);
+    EXPECT_EQ(b.statistics().get("bmc_guided_queries"), 1);
+    EXPECT_EQ(b.statistics().get("bmc_guided_hits"), 1);
+  } else {
+    EXPECT_EQ(b.statistics().get("bmc_guided_queries"), 0);
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(
     ParameterizedEngineUnitTests,
     EngineUnitTests,
@@ -149,6 +670,52 @@ TEST_P(InterpUnitTest, InterpFalse)
   ASSERT_EQ(r, ProverResult::FALSE);
 }
 
+TEST_P(InterpUnitTest, InterpReuse)
+{
+  PonoOptions opts;
+  opts.interp_reuse_ = true;
+  InterpolantMC itpmc(*true_p, *ts, s, opts);
+  ASSERT_EQ(itpmc.check_until(20), ProverResult::TRUE);
+  ASSERT_TRUE(check_invar(*ts, true_p->prop(), itpmc.invar()));
+  EXPECT_GT(itpmc.statistics().get("reused_interpolants"), 0);
+
+  // reused interpolants must not hide a counterexample
+  InterpolantMC itpmc_false(*false_p, *ts, s, opts);
+  ASSERT_EQ(itpmc_false.check_until(20), ProverResult::FALSE);
+}
+
+TEST_P(InterpUnitTest, IsmcTrue)
+{
+  ISMC ismc(*true_p, *ts, s);
+  ProverResult r = ismc.check_until(20);
+  ASSERT_EQ(r, ProverResult::TRUE);
+
+  Term invar = ismc.invar();
+  ASSERT_TRUE(check_invar(*ts, true_p->prop(), invar));
+}
+
+TEST_P(InterpUnitTest, IsmcFalse)
+{
+  ISMC ismc(*false_p, *ts, s);
+  ProverResult r = ismc.check_until(20);
+  ASSERT_EQ(r, ProverResult::FALSE);
+}
+
+TEST_P(InterpUnitTest, MbIC3InterpolantGen)
+{
+  PonoOptions opts;
+  opts.mbic3_indgen_mode = 2;
+  ModelBasedIC3 mbic3(*true_p, *ts, s, opts);
+  ProverResult r = mbic3.check_until(20);
+  ASSERT_EQ(r, ProverResult::TRUE);
+
+  Term invar = mbic3.invar();
+  ASSERT_TRUE(check_invar(*ts, true_p->prop(), invar));
+
+  // trans and init are transferred once, not per generalization
+  EXPECT_EQ(mbic3.statistics().get("mbic3_itp_ts_transfers"), 1);
+}
+
 INSTANTIATE_TEST_SUITE_P(
     ParameterizedInterpUnitTest,
     InterpUnitTest,
@@ -228,6 +795,15 @@ TEST_P(InterpWinTests, BmcSimplePathFail)
   ASSERT_EQ(r, ProverResult::UNKNOWN);
 }
 
+TEST_P(InterpWinTests, BmcSimplePathResume)
+{
+  // the cover queries and their simple path constraints are kept across
+  // bounds and calls
+  BmcSimplePath bsp(*true_p, *ts, s);
+  ASSERT_EQ(bsp.check_until(5), ProverResult::UNKNOWN);
+  ASSERT_EQ(bsp.check_until(10), ProverResult::UNKNOWN);
+}
+
 TEST_P(InterpWinTests, KInductionFail)
 {
   KInduction kind(*true_p, *ts, s);
@@ -242,6 +818,13 @@ TEST_P(InterpWinTests, InterpWin)
   ASSERT_EQ(r, ProverResult::TRUE);
 }
 
+TEST_P(InterpWinTests, IsmcWin)
+{
+  ISMC ismc(*true_p, *ts, s);
+  ProverResult r = ismc.check_until(10);
+  ASSERT_EQ(r, ProverResult::TRUE);
+}
+
 INSTANTIATE_TEST_SUITE_P(ParameterizedInterpWinTests,
                          InterpWinTests,
                          testing::ValuesIn({ Functional, Relational }));
@@ -1,3 +1,8 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -5,7 +10,9 @@
 #include "core/rts.h"
 #include "engines/ic3.h"
 #include "gtest/gtest.h"
+#include "smt-switch/utils.h"
 #include "smt/available_solvers.h"
+#include "utils/lemma_cache.h"
 #include "utils/ts_analysis.h"
 
 using namespace pono;
@@ -54,6 +61,65 @@ TEST_P(IC3UnitTests, SimpleSystemSafe)
   ASSERT_TRUE(check_invar(rts, p.prop(), invar));
 }
 
+TEST_P(IC3UnitTests, ClauseWiseInvarCheck)
+{
+  RelationalTransitionSystem rts(s);
+  Term s1 = rts.make_statevar("s1", boolsort);
+  Term s2 = rts.make_statevar("s2", boolsort);
+  rts.constrain_init(s->make_term(Not, s1));
+  rts.constrain_init(s->make_term(Not, s2));
+  rts.assign_next(s1, s->make_term(Or, s1, s2));
+  rts.assign_next(s2, s2);
+
+  Property p(s, s->make_term(Not, s1));
+  IC3 ic3(p, rts, s);
+  ASSERT_EQ(ic3.prove(), TRUE);
+  Term invar = ic3.invar();
+  for (size_t threads : { 1u, 2u, 4u }) {
+    InvarCheckResult res = check_invar_clauses(rts, p.prop(), invar, threads);
+    EXPECT_TRUE(res.passed());
+    EXPECT_TRUE(res.not_inductive.empty());
+  }
+
+  // !s1 alone holds initially and implies the property, but is not
+  // inductive without !s2
+  Term not_s1 = s->make_term(Not, s1);
+  InvarCheckResult res = check_invar_clauses(rts, p.prop(), not_s1, 2);
+  EXPECT_TRUE(res.init_ok);
+  EXPECT_TRUE(res.prop_ok);
+  EXPECT_FALSE(res.inductive_ok);
+  ASSERT_EQ(res.not_inductive.size(), 1u);
+  EXPECT_EQ(res.not_inductive[0], not_s1);
+  EXPECT_FALSE(check_invar(rts, p.prop(), not_s1));
+}
+
+TEST_P(IC3UnitTests, CompactInvar)
+{
+  RelationalTransitionSystem rts(s);
+  Term s1 = rts.make_statevar("s1", boolsort);
+  Term s2 = rts.make_statevar("s2", boolsort);
+  Term s3 = rts.make_statevar("s3", boolsort);
+  rts.constrain_init(s->make_term(Not, s1));
+  rts.constrain_init(s->make_term(Not, s2));
+  rts.constrain_init(s3);
+  rts.assign_next(s1, s->make_term(Or, s1, s2));
+  rts.assign_next(s2, s2);
+  rts.assign_next(s3, s3);
+
+  Property p(s, s->make_term(Not, s1));
+  Term not_s1 = s->make_term(Not, s1);
+  Term not_s2 = s->make_term(Not, s2);
+  // s3 is inductive on its own but not needed for the property
+  Term invar = s->make_term(And, s->make_term(And, not_s1, not_s2), s3);
+  ASSERT_TRUE(check_invar(rts, p.prop(), invar));
+
+  Term compact = compact_invar(rts, p.prop(), invar, 0);
+  EXPECT_TRUE(check_invar(rts, p.prop(), compact));
+  TermVec conjuncts;
+  conjunctive_partition(compact, conjuncts, true);
+  EXPECT_EQ(conjuncts.size(), 2u);
+}
+
 TEST_P(IC3UnitTests, SimpleSystemUnsafe)
 {
   FunctionalTransitionSystem fts(s);
@@ -76,6 +142,625 @@ TEST_P(IC3UnitTests, SimpleSystemUnsafe)
   ASSERT_EQ(r, FALSE);
 }
 
+TEST_P(IC3UnitTests, GoalWitness)
+{
+  FunctionalTransitionSystem fts(s);
+  Term in = fts.make_inputvar("in", boolsort);
+  Term s1 = fts.make_statevar("s1", boolsort);
+  Term s2 = fts.make_statevar("s2", boolsort);
+  Term s3 = fts.make_statevar("s3", boolsort);
+  Term f = s->make_term(false);
+  fts.constrain_init(s->make_term(Not, s1));
+  fts.constrain_init(s->make_term(Not, s2));
+  fts.constrain_init(s->make_term(Not, s3));
+  fts.assign_next(s1, in);
+  fts.assign_next(s2, s1);
+  fts.assign_next(s3, s2);
+
+  PonoOptions opts;
+  opts.witness_ = true;
+  Property p(s, s->make_term(Not, s3));
+  IC3 ic3(p, fts, s, opts);
+  ASSERT_EQ(ic3.prove(), FALSE);
+
+  vector<UnorderedTermMap> cex;
+  ASSERT_TRUE(ic3.witness(cex));
+  ASSERT_EQ(cex.size(), 4);
+  EXPECT_EQ(cex[0].at(s1), f);
+  EXPECT_EQ(cex[0].at(s2), f);
+  EXPECT_EQ(cex[0].at(s3), f);
+  for (size_t j = 0; j + 1 < cex.size(); ++j) {
+    EXPECT_EQ(cex[j + 1].at(s1), cex[j].at(in));
+    EXPECT_EQ(cex[j + 1].at(s2), cex[j].at(s1));
+    EXPECT_EQ(cex[j + 1].at(s3), cex[j].at(s2));
+  }
+  EXPECT_EQ(cex[3].at(s3), s->make_term(true));
+  EXPECT_EQ(ic3.statistics().get("ic3_goal_witnesses"), 1);
+}
+
+TEST_P(IC3UnitTests, RelIndAssumptions)
+{
+  RelationalTransitionSystem rts(s);
+  Term s1 = rts.make_statevar("s1", boolsort);
+  Term s2 = rts.make_statevar("s2", boolsort);
+  Term s3 = rts.make_statevar("s3", boolsort);
+
+  // INIT !s1 & !s2 & !s3
+  rts.constrain_init(s->make_term(Not, s1));
+  rts.constrain_init(s->make_term(Not, s2));
+  rts.constrain_init(s->make_term(Not, s3));
+
+  // TRANS next(s1) = (s1 | s2)
+  // TRANS next(s2) = s3
+  // TRANS next(s3) = s3
+  rts.assign_next(s1, s->make_term(Or, s1, s2));
+  rts.assign_next(s2, s3);
+  rts.assign_next(s3, s3);
+
+  PonoOptions opts;
+  opts.ic3_rel_ind_assumptions_ = true;
+  // reset the solver all the time to exercise re-adding the labels
+  opts.ic3_act_lit_reset_ = 1;
+
+  Property p(s, s->make_term(Not, s1));
+  IC3 ic3(p, rts, s, opts);
+  ProverResult r = ic3.prove();
+  ASSERT_EQ(r, TRUE);
+  Term invar = ic3.invar();
+  ASSERT_TRUE(check_invar(rts, p.prop(), invar));
+}
+
+TEST_P(IC3UnitTests, FrameSolvers)
+{
+  RelationalTransitionSystem rts(s);
+  Term s1 = rts.make_statevar("s1", boolsort);
+  Term s2 = rts.make_statevar("s2", boolsort);
+  Term s3 = rts.make_statevar("s3", boolsort);
+
+  // INIT !s1 & !s2 & !s3
+  rts.constrain_init(s->make_term(Not, s1));
+  rts.constrain_init(s->make_term(Not, s2));
+  rts.constrain_init(s->make_term(Not, s3));
+
+  // TRANS next(s1) = (s1 | s2)
+  // TRANS next(s2) = s3
+  // TRANS next(s3) = s3
+  rts.assign_next(s1, s->make_term(Or, s1, s2));
+  rts.assign_next(s2, s3);
+  rts.assign_next(s3, s3);
+
+  PonoOptions opts;
+  opts.ic3_frame_solvers_ = true;
+
+  Property p(s, s->make_term(Not, s1));
+  IC3 ic3(p, rts, s, opts);
+  ProverResult r = ic3.prove();
+  ASSERT_EQ(r, TRUE);
+  Term invar = ic3.invar();
+  ASSERT_TRUE(check_invar(rts, p.prop(), invar));
+}
+
+TEST_P(IC3UnitTests, FrameSolversUnsafe)
+{
+  FunctionalTransitionSystem fts(s);
+  Term s1 = fts.make_statevar("s1", boolsort);
+  Term s2 = fts.make_statevar("s2", boolsort);
+
+  // INIT !s1 & s2
+  fts.constrain_init(s->make_term(Not, s1));
+  fts.constrain_init(s2);
+
+  // TRANS next(s1) = (s1 | s2)
+  // TRANS next(s2) = s2
+  fts.assign_next(s1, s->make_term(Or, s1, s2));
+  fts.assign_next(s2, s2);
+
+  PonoOptions opts;
+  opts.ic3_frame_solvers_ = true;
+
+  Property p(s, s->make_term(Not, s1));
+  IC3 ic3(p, fts, s, opts);
+  ProverResult r = ic3.prove();
+  ASSERT_EQ(r, FALSE);
+}
+
+TEST_P(IC3UnitTests, Multithreaded)
+{
+  RelationalTransitionSystem rts(s);
+  TermVec svs;
+  for (size_t i = 0; i < 6; ++i) {
+    svs.push_back(rts.make_statevar("s" + std::to_string(i), boolsort));
+  }
+
+  // INIT all false
+  // TRANS next(s0) = s0 | s1, next(s_i) = s_{i+1}, next(s5) = s5
+  for (size_t i = 0; i < svs.size(); ++i) {
+    rts.constrain_init(s->make_term(Not, svs[i]));
+    if (i == 0) {
+      rts.assign_next(svs[0], s->make_term(Or, svs[0], svs[1]));
+    } else if (i + 1 < svs.size()) {
+      rts.assign_next(svs[i], svs[i + 1]);
+    } else {
+      rts.assign_next(svs[i], svs[i]);
+    }
+  }
+
+  PonoOptions opts;
+  opts.ic3_prop_threads_ = 3;
+  opts.ic3_block_threads_ = 3;
+
+  Property p(s, s->make_term(Not, svs[0]));
+  IC3 ic3(p, rts, s, opts);
+  ProverResult r = ic3.prove();
+  ASSERT_EQ(r, TRUE);
+  Term invar = ic3.invar();
+  ASSERT_TRUE(check_invar(rts, p.prop(), invar));
+  EXPECT_GT(ic3.statistics().get("concurrent_proof_goal_batches"), 0);
+  EXPECT_GT(ic3.statistics().get("parallel_propagations"), 0);
+}
+
+TEST_P(IC3UnitTests, MultithreadedUnsafe)
+{
+  FunctionalTransitionSystem fts(s);
+  TermVec svs;
+  for (size_t i = 0; i < 4; ++i) {
+    svs.push_back(fts.make_statevar("s" + std::to_string(i), boolsort));
+    fts.constrain_init(s->make_term(Not, svs.back()));
+  }
+
+  // a shift register that moves a one from s3 to s0
+  fts.assign_next(svs[0], s->make_term(Or, svs[0], svs[1]));
+  fts.assign_next(svs[1], svs[2]);
+  fts.assign_next(svs[2], svs[3]);
+  fts.assign_next(svs[3], s->make_term(true));
+
+  PonoOptions opts;
+  opts.ic3_block_threads_ = 2;
+
+  Property p(s, s->make_term(Not, svs[0]));
+  IC3 ic3(p, fts, s, opts);
+  ProverResult r = ic3.prove();
+  ASSERT_EQ(r, FALSE);
+}
+
+TEST_P(IC3UnitTests, BadCubeBatch)
+{
+  // each variable is a separate bad cube, s<set> becomes true
+  auto make_system = [](const SmtSolver & solver,
+                        RelationalTransitionSystem & rts,
+                        size_t set) {
+    Sort boolsort = solver->make_sort(BOOL);
+    Term bad = solver->make_term(false);
+    for (size_t i = 0; i < 4; ++i) {
+      Term sv = rts.make_statevar("s" + std::to_string(i), boolsort);
+      rts.constrain_init(solver->make_term(Not, sv));
+      rts.assign_next(sv, i == set ? solver->make_term(true) : sv);
+      bad = solver->make_term(Or, bad, sv);
+    }
+    return solver->make_term(Not, bad);
+  };
+
+  PonoOptions opts;
+  opts.ic3_bad_batch_ = 4;
+
+  RelationalTransitionSystem rts(s);
+  Property p(s, make_system(s, rts, 4));
+  IC3 ic3(p, rts, s, opts);
+  ASSERT_EQ(ic3.prove(), TRUE);
+  ASSERT_TRUE(check_invar(rts, p.prop(), ic3.invar()));
+  EXPECT_GE(ic3.statistics().get("bad_cube_batches"), 1);
+  EXPECT_GT(ic3.statistics().get("bad_cubes"),
+            ic3.statistics().get("bad_cube_batches"));
+
+  // a counterexample through any of the cubes is still found
+  SmtSolver s2 = create_solver_for(GetParam(), IC3_BOOL, false);
+  RelationalTransitionSystem rts2(s2);
+  Property p2(s2, make_system(s2, rts2, 2));
+  IC3 ic3_unsafe(p2, rts2, s2, opts);
+  ASSERT_EQ(ic3_unsafe.prove(), FALSE);
+}
+
+TEST_P(IC3UnitTests, CtgGeneralization)
+{
+  RelationalTransitionSystem rts(s);
+  TermVec svs;
+  for (size_t i = 0; i < 6; ++i) {
+    svs.push_back(rts.make_statevar("s" + std::to_string(i), boolsort));
+    rts.constrain_init(s->make_term(Not, svs.back()));
+  }
+
+  // TRANS next(s0) = s0 | s1, next(s_i) = s_{i+1}, next(s5) = s5
+  rts.assign_next(svs[0], s->make_term(Or, svs[0], svs[1]));
+  for (size_t i = 1; i + 1 < svs.size(); ++i) {
+    rts.assign_next(svs[i], svs[i + 1]);
+  }
+  rts.assign_next(svs.back(), svs.back());
+
+  PonoOptions opts;
+  opts.ic3_ctg_ = true;
+  opts.ic3_ctg_max_depth_ = 2;
+
+  Property p(s, s->make_term(Not, svs[0]));
+  IC3 ic3(p, rts, s, opts);
+  ProverResult r = ic3.prove();
+  ASSERT_EQ(r, TRUE);
+  Term invar = ic3.invar();
+  ASSERT_TRUE(check_invar(rts, p.prop(), invar));
+  EXPECT_GT(ic3.statistics().get("blocked_ctgs"), 0);
+}
+
+TEST_P(IC3UnitTests, GeneralizationStatistics)
+{
+  RelationalTransitionSystem rts(s);
+  TermVec svs;
+  for (size_t i = 0; i < 6; ++i) {
+    svs.push_back(rts.make_statevar("s" + std::to_string(i), boolsort));
+    rts.constrain_init(s->make_term(Not, svs.back()));
+  }
+  rts.assign_next(svs[0], s->make_term(Or, svs[0], svs[1]));
+  for (size_t i = 1; i + 1 < svs.size(); ++i) {
+    rts.assign_next(svs[i], svs[i + 1]);
+  }
+  rts.assign_next(svs.back(), svs.back());
+
+  Property p(s, s->make_term(Not, svs[0]));
+  IC3 ic3(p, rts, s);
+  ASSERT_EQ(ic3.prove(), TRUE);
+
+  const Statistics & stats = ic3.statistics();
+  Statistics::Histogram before = stats.get_histogram("gen_cube_size_before");
+  Statistics::Histogram after = stats.get_histogram("gen_cube_size_after");
+  Statistics::Histogram dropped = stats.get_histogram("gen_dropped_lits");
+  ASSERT_GT(before.count, 0);
+  EXPECT_EQ(after.count, before.count);
+  EXPECT_EQ(stats.get_histogram("gen_micros").count, before.count);
+  EXPECT_EQ(stats.get_histogram("gen_solver_calls").count, before.count);
+  // generalization only drops literals
+  EXPECT_LE(after.sum, before.sum);
+  EXPECT_EQ(dropped.sum, before.sum - after.sum);
+  size_t bucketed = 0;
+  for (size_t n : before.log2_buckets) {
+    bucketed += n;
+  }
+  EXPECT_EQ(bucketed, before.count);
+  EXPECT_LE(stats.get_histogram("pregen_reduction_percent").max, 100);
+  EXPECT_LE(stats.get("init_fix_fired"), stats.get("init_fix_checks"));
+  EXPECT_NE(stats.to_json().find("\"gen_cube_size_before\": {\"count\": "),
+            string::npos);
+}
+
+TEST_P(IC3UnitTests, ResetDeadRatio)
+{
+  RelationalTransitionSystem rts(s);
+  TermVec svs;
+  for (size_t i = 0; i < 6; ++i) {
+    svs.push_back(rts.make_statevar("s" + std::to_string(i), boolsort));
+    rts.constrain_init(s->make_term(Not, svs.back()));
+  }
+
+  // TRANS next(s0) = s0 | s1, next(s_i) = s_{i+1}, next(s5) = s5
+  rts.assign_next(svs[0], s->make_term(Or, svs[0], svs[1]));
+  for (size_t i = 1; i + 1 < svs.size(); ++i) {
+    rts.assign_next(svs[i], svs[i + 1]);
+  }
+  rts.assign_next(svs.back(), svs.back());
+
+  PonoOptions opts;
+  opts.ic3_reset_dead_ratio_ = 50;
+
+  Property p(s, s->make_term(Not, svs[0]));
+  IC3 ic3(p, rts, s, opts);
+  ProverResult r = ic3.prove();
+  ASSERT_EQ(r, TRUE);
+  Term invar = ic3.invar();
+  ASSERT_TRUE(check_invar(rts, p.prop(), invar));
+  EXPECT_GT(ic3.statistics().get("solver_resets"), 0);
+  EXPECT_GT(ic3.statistics().get("dropped_subsumed_lemmas"), 0);
+}
+
+TEST_P(IC3UnitTests, InfFrame)
+{
+  RelationalTransitionSystem rts(s);
+  TermVec svs;
+  for (size_t i = 0; i < 6; ++i) {
+    svs.push_back(rts.make_statevar("s" + std::to_string(i), boolsort));
+    rts.constrain_init(s->make_term(Not, svs.back()));
+  }
+
+  // TRANS next(s0) = s0 | s1, next(s_i) = s_{i+1}, next(s5) = s5
+  rts.assign_next(svs[0], s->make_term(Or, svs[0], svs[1]));
+  for (size_t i = 1; i + 1 < svs.size(); ++i) {
+    rts.assign_next(svs[i], svs[i + 1]);
+  }
+  rts.assign_next(svs.back(), svs.back());
+
+  // t stays false, which is inductive on its own
+  Term t = rts.make_statevar("t", boolsort);
+  rts.constrain_init(s->make_term(Not, t));
+  rts.assign_next(t, t);
+
+  PonoOptions opts;
+  opts.ic3_inf_frame_period_ = 1;
+
+  Term not_t = s->make_term(Not, t);
+  Property p(s, s->make_term(And, s->make_term(Not, svs[0]), not_t));
+  IC3 ic3(p, rts, s, opts);
+  ProverResult r = ic3.prove();
+  ASSERT_EQ(r, TRUE);
+  Term invar = ic3.invar();
+  ASSERT_TRUE(check_invar(rts, p.prop(), invar));
+
+  // the infinity frame is inductive without the property
+  EXPECT_TRUE(check_invar(rts, not_t, ic3.inf_frame_invar()));
+}
+
+TEST_P(IC3UnitTests, LemmaGC)
+{
+  RelationalTransitionSystem rts(s);
+  TermVec svs;
+  for (size_t i = 0; i < 6; ++i) {
+    svs.push_back(rts.make_statevar("s" + std::to_string(i), boolsort));
+    rts.constrain_init(s->make_term(Not, svs.back()));
+  }
+
+  // TRANS next(s0) = s0 | s1, next(s_i) = s_{i+1}, next(s5) = s5
+  rts.assign_next(svs[0], s->make_term(Or, svs[0], svs[1]));
+  for (size_t i = 1; i + 1 < svs.size(); ++i) {
+    rts.assign_next(svs[i], svs[i + 1]);
+  }
+  rts.assign_next(svs.back(), svs.back());
+
+  PonoOptions opts;
+  opts.ic3_lemma_gc_period_ = 1;
+
+  Property p(s, s->make_term(Not, svs[0]));
+  IC3 ic3(p, rts, s, opts);
+  ProverResult r = ic3.prove();
+  ASSERT_EQ(r, TRUE);
+  Term invar = ic3.invar();
+  ASSERT_TRUE(check_invar(rts, p.prop(), invar));
+  EXPECT_GT(ic3.statistics().get("lemma_gc_runs"), 0);
+  EXPECT_GT(ic3.statistics().get("lemma_gc_deleted_lemmas"), 0);
+}
+
+TEST_P(IC3UnitTests, LemmaCache)
+{
+  string cache = (std::filesystem::temp_directory_path()
+                  / ("pono_lemma_cache_" + smt::to_string(GetParam())))
+                     .string();
+  std::remove(cache.c_str());
+
+  // s0 -> s1 -> ... -> s4 is a shift register that stays all false
+  auto make_system = [](const SmtSolver & solver,
+                        RelationalTransitionSystem & rts) {
+    Sort boolsort = solver->make_sort(BOOL);
+    TermVec svs;
+    for (size_t i = 0; i < 5; ++i) {
+      svs.push_back(rts.make_statevar("s" + std::to_string(i), boolsort));
+      rts.constrain_init(solver->make_term(Not, svs.back()));
+    }
+    for (size_t i = 0; i + 1 < svs.size(); ++i) {
+      rts.assign_next(svs[i + 1], svs[i]);
+    }
+    rts.assign_next(svs[0], svs[0]);
+    return solver->make_term(Not, svs.back());
+  };
+
+  PonoOptions opts;
+  opts.ic3_lemma_cache_ = cache;
+
+  RelationalTransitionSystem rts(s);
+  Property p(s, make_system(s, rts));
+  IC3 ic3(p, rts, s, opts);
+  ASSERT_EQ(ic3.prove(), TRUE);
+
+  std::vector<TermVec> lemmas;
+  Term bad = s->make_term(Not, p.prop());
+  ASSERT_TRUE(read_lemma_cache(cache, rts, bad, lemmas));
+  ASSERT_GT(lemmas.size(), 0);
+
+  // a different property is not a match
+  lemmas.clear();
+  ASSERT_FALSE(read_lemma_cache(cache, rts, p.prop(), lemmas));
+  ASSERT_EQ(lemmas.size(), 0);
+
+  // warm start a fresh run on the same system
+  SmtSolver s2 = create_solver_for(GetParam(), IC3_BOOL, false);
+  RelationalTransitionSystem rts2(s2);
+  Property p2(s2, make_system(s2, rts2));
+  IC3 ic3_warm(p2, rts2, s2, opts);
+  ASSERT_EQ(ic3_warm.prove(), TRUE);
+  ASSERT_TRUE(check_invar(rts2, p2.prop(), ic3_warm.invar()));
+
+  std::remove(cache.c_str());
+}
+
+TEST_P(IC3UnitTests, CheckpointResume)
+{
+  string file = (std::filesystem::temp_directory_path()
+                 / ("pono_checkpoint_" + smt::to_string(GetParam())))
+                    .string();
+  std::remove(file.c_str());
+
+  // a single true bit shifted from s0 to s5, the property fails at bound 5
+  auto make_system = [](const SmtSolver & solver,
+                        RelationalTransitionSystem & rts) {
+    Sort boolsort = solver->make_sort(BOOL);
+    TermVec svs;
+    for (size_t i = 0; i < 6; ++i) {
+      svs.push_back(rts.make_statevar("s" + std::to_string(i), boolsort));
+      rts.constrain_init(i ? solver->make_term(Not, svs.back()) : svs.back());
+    }
+    for (size_t i = 0; i + 1 < svs.size(); ++i) {
+      rts.assign_next(svs[i + 1], svs[i]);
+    }
+    rts.assign_next(svs[0], solver->make_term(false));
+    return solver->make_term(Not, svs.back());
+  };
+
+  PonoOptions opts;
+  opts.checkpoint_ = file;
+  opts.checkpoint_interval_ = 0;
+
+  RelationalTransitionSystem rts(s);
+  Property p(s, make_system(s, rts));
+  IC3 ic3(p, rts, s, opts);
+  ASSERT_EQ(ic3.check_until(2), UNKNOWN);
+
+  Checkpoint cp;
+  Term bad = s->make_term(Not, p.prop());
+  ASSERT_TRUE(read_checkpoint(file, rts, bad, cp));
+  ASSERT_EQ(cp.engine, to_string(IC3_BOOL));
+  ASSERT_EQ(cp.reached_k, 2);
+  ASSERT_EQ(cp.frames.size(), 2);
+
+  // a different property is not a match
+  ASSERT_FALSE(read_checkpoint(file, rts, p.prop(), cp));
+
+  // resume a fresh run on the same system from bound 2
+  SmtSolver s2 = create_solver_for(GetParam(), IC3_BOOL, false);
+  RelationalTransitionSystem rts2(s2);
+  Property p2(s2, make_system(s2, rts2));
+  opts.resume_ = true;
+  IC3 ic3_resumed(p2, rts2, s2, opts);
+  ASSERT_EQ(ic3_resumed.check_until(10), FALSE);
+
+  std::remove(file.c_str());
+}
+
+TEST_P(IC3UnitTests, ResultCache)
+{
+  string dir = (std::filesystem::temp_directory_path()
+                / ("pono_result_cache_" + smt::to_string(GetParam())))
+                   .string();
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+
+  // the shift register of LemmaCache, with a prefix for the names
+  auto make_system = [](const SmtSolver & solver,
+                        RelationalTransitionSystem & rts,
+                        const string & prefix,
+                        bool init_val) {
+    Sort boolsort = solver->make_sort(BOOL);
+    TermVec svs;
+    for (size_t i = 0; i < 5; ++i) {
+      svs.push_back(rts.make_statevar(prefix + std::to_string(i), boolsort));
+      rts.constrain_init(solver->make_term(Equal,
+                                           svs.back(),
+                                           solver->make_term(init_val)));
+    }
+    for (size_t i = 0; i + 1 < svs.size(); ++i) {
+      rts.assign_next(svs[i + 1], svs[i]);
+    }
+    rts.assign_next(svs[0], svs[0]);
+    return solver->make_term(Not, svs.back());
+  };
+
+  RelationalTransitionSystem rts(s);
+  Property p(s, make_system(s, rts, "s", false));
+  IC3 ic3(p, rts, s);
+  ASSERT_EQ(ic3.prove(), TRUE);
+  CachedResult res;
+  res.result = TRUE;
+  res.invar = ic3.invar();
+  ASSERT_TRUE(write_result_cache(dir, rts, p.prop(), "ic3 10", res));
+
+  // the names are ignored
+  SmtSolver s2 = create_solver_for(GetParam(), IC3_BOOL, false);
+  RelationalTransitionSystem rts2(s2);
+  Term prop2 = make_system(s2, rts2, "r", false);
+  EXPECT_EQ(canonical_hash(rts, p.prop()), canonical_hash(rts2, prop2));
+  CachedResult cached;
+  ASSERT_TRUE(read_result_cache(dir, rts2, prop2, "ic3 10", cached));
+  EXPECT_EQ(cached.result, TRUE);
+  ASSERT_TRUE(cached.invar);
+  EXPECT_TRUE(check_invar(rts2, prop2, cached.invar));
+
+  // but not the options or the structure
+  EXPECT_FALSE(read_result_cache(dir, rts2, prop2, "ind 10", cached));
+  RelationalTransitionSystem rts3(s2);
+  Term prop3 = make_system(s2, rts3, "t", true);
+  EXPECT_NE(canonical_hash(rts2, prop2), canonical_hash(rts3, prop3));
+  EXPECT_FALSE(read_result_cache(dir, rts3, prop3, "ic3 10", cached));
+
+  // a witness is saved by position too
+  res = CachedResult();
+  res.result = FALSE;
+  TermVec vars;
+  canonical_hash(rts3, prop3, &vars);
+  res.cex.resize(2);
+  for (const auto & v : vars) {
+    res.cex[0][v] = s2->make_term(true);
+    res.cex[1][v] = s2->make_term(false);
+  }
+  ASSERT_TRUE(write_result_cache(dir, rts3, prop3, "bmc 10", res));
+  ASSERT_TRUE(read_result_cache(dir, rts3, prop3, "bmc 10", cached));
+  EXPECT_EQ(cached.result, FALSE);
+  EXPECT_EQ(cached.cex, res.cex);
+
+  // an entry of another system under the same hash (a collision) is a
+  // miss, the system is compared and not only its hash
+  string entry2, entry3;
+  for (const auto & f : std::filesystem::directory_iterator(dir)) {
+    std::ifstream in(f.path());
+    std::stringstream text;
+    text << in.rdbuf();
+    if (text.str().find("options ic3 10") != string::npos) {
+      entry2 = f.path().string();
+    } else {
+      entry3 = text.str();
+    }
+  }
+  ASSERT_FALSE(entry2.empty());
+  ASSERT_FALSE(entry3.empty());
+  string hash3 = "hash " + std::to_string(canonical_hash(rts3, prop3));
+  string hash2 = "hash " + std::to_string(canonical_hash(rts2, prop2));
+  entry3.replace(entry3.find(hash3), hash3.size(), hash2);
+  entry3.replace(entry3.find("options bmc 10"), 14, "options ic3 10");
+  std::ofstream(entry2) << entry3;
+  EXPECT_FALSE(read_result_cache(dir, rts2, prop2, "ic3 10", cached));
+
+  // and a malformed entry is a miss instead of an error
+  std::ofstream(entry2) << "pono-result-cache 2\nresult maybe\n";
+  EXPECT_FALSE(read_result_cache(dir, rts2, prop2, "ic3 10", cached));
+  std::ofstream(entry2) << "not a cache\n";
+  EXPECT_FALSE(read_result_cache(dir, rts2, prop2, "ic3 10", cached));
+
+  std::filesystem::remove_all(dir);
+}
+
+TEST_P(IC3UnitTests, SameUpToRenaming)
+{
+  // two lanes that copy an input through a register
+  auto make_lane = [&](RelationalTransitionSystem & rts,
+                       const string & prefix) {
+    Term in = rts.make_inputvar(prefix + "in", boolsort);
+    Term r = rts.make_statevar(prefix + "r", boolsort);
+    rts.constrain_init(rts.make_term(Not, r));
+    rts.assign_next(r, in);
+    return rts.make_term(Not, r);
+  };
+  RelationalTransitionSystem lane0(s);
+  Term prop0 = make_lane(lane0, "l0_");
+  RelationalTransitionSystem lane1(s);
+  Term prop1 = make_lane(lane1, "l1_");
+
+  TermVec vars0, vars1;
+  ASSERT_EQ(canonical_hash(lane0, prop0, &vars0),
+            canonical_hash(lane1, prop1, &vars1));
+  UnorderedTermMap renaming;
+  ASSERT_TRUE(same_up_to_renaming(
+      lane0, prop0, vars0, lane1, prop1, vars1, renaming));
+  Term r0 = lane0.lookup("l0_r");
+  Term r1 = lane1.lookup("l1_r");
+  EXPECT_EQ(renaming.at(r0), r1);
+  EXPECT_EQ(renaming.at(lane0.next(r0)), lane1.next(r1));
+
+  // not the same property
+  EXPECT_FALSE(same_up_to_renaming(
+      lane0, prop0, vars0, lane1, r1, vars1, renaming));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     ParameterizedSolverIC3UnitTests,
     IC3UnitTests,
@@ -62,6 +62,123 @@ TEST_P(IC3BitsUnitTests, CounterSystemSafe)
   ASSERT_TRUE(check_invar(fts, prop_term, invar));
 }
 
+TEST_P(IC3BitsUnitTests, TernarySimUnsafe)
+{
+  FunctionalTransitionSystem fts(s);
+  Term max_val = fts.make_term(10, bvsort8);
+  counter_system(fts, max_val);
+  Term x = fts.named_terms().at("x");
+
+  Term prop_term = s->make_term(BVUlt, x, max_val);
+  Property p(s, prop_term);
+
+  PonoOptions opts;
+  opts.ic3_ternary_sim_ = true;
+  IC3Bits ic3bits(p, fts, s, opts);
+  ProverResult r = ic3bits.check_until(12);
+  ASSERT_EQ(r, FALSE);
+  EXPECT_GT(ic3bits.statistics().get("ternary_sim_lifts"), 0);
+}
+
+TEST_P(IC3BitsUnitTests, TernarySimSafe)
+{
+  FunctionalTransitionSystem fts(s);
+  Term max_val = fts.make_term(10, bvsort8);
+  counter_system(fts, max_val);
+  Term x = fts.named_terms().at("x");
+
+  Term prop_term = s->make_term(BVUle, x, max_val);
+  Property p(s, prop_term);
+
+  PonoOptions opts;
+  opts.ic3_ternary_sim_ = true;
+  IC3Bits ic3bits(p, fts, s, opts);
+  ProverResult r = ic3bits.prove();
+  ASSERT_EQ(r, TRUE);
+  Term invar = ic3bits.invar();
+  ASSERT_TRUE(check_invar(fts, prop_term, invar));
+  EXPECT_GT(ic3bits.statistics().get("ternary_sim_lifts"), 0);
+}
+
+// three-bit Johnson counter over booleans, reachable states are
+// 000, 100, 110, 111, 011, 001 (as abc)
+static void johnson_counter(FunctionalTransitionSystem & fts)
+{
+  const SmtSolver & s = fts.solver();
+  Sort boolsort = s->make_sort(BOOL);
+  Term a = fts.make_statevar("a", boolsort);
+  Term b = fts.make_statevar("b", boolsort);
+  Term c = fts.make_statevar("c", boolsort);
+  Term f = s->make_term(false);
+  fts.constrain_init(s->make_term(Equal, a, f));
+  fts.constrain_init(s->make_term(Equal, b, f));
+  fts.constrain_init(s->make_term(Equal, c, f));
+  fts.assign_next(a, s->make_term(Not, c));
+  fts.assign_next(b, a);
+  fts.assign_next(c, b);
+}
+
+TEST_P(IC3BitsUnitTests, SatModeSafe)
+{
+  FunctionalTransitionSystem fts(s);
+  johnson_counter(fts);
+  Term a = fts.named_terms().at("a");
+  Term b = fts.named_terms().at("b");
+  Term c = fts.named_terms().at("c");
+
+  Term prop_term = s->make_term(
+      Not, s->make_term(And, a, s->make_term(And, s->make_term(Not, b), c)));
+  Property p(s, prop_term);
+
+  PonoOptions opts;
+  opts.ic3bits_sat_ = true;
+  IC3Bits ic3bits(p, fts, s, opts);
+  ProverResult r = ic3bits.prove();
+  ASSERT_EQ(r, TRUE);
+  Term invar = ic3bits.invar();
+  ASSERT_TRUE(check_invar(fts, prop_term, invar));
+}
+
+TEST_P(IC3BitsUnitTests, SatModeUnsafe)
+{
+  FunctionalTransitionSystem fts(s);
+  johnson_counter(fts);
+  Term a = fts.named_terms().at("a");
+  Term b = fts.named_terms().at("b");
+  Term c = fts.named_terms().at("c");
+
+  Term prop_term =
+      s->make_term(Not, s->make_term(And, a, s->make_term(And, b, c)));
+  Property p(s, prop_term);
+
+  PonoOptions opts;
+  opts.ic3bits_sat_ = true;
+  IC3Bits ic3bits(p, fts, s, opts);
+  ProverResult r = ic3bits.check_until(10);
+  ASSERT_EQ(r, FALSE);
+  ASSERT_EQ(ic3bits.witness_length(), 3u);
+}
+
+TEST_P(IC3BitsUnitTests, SatModeFallback)
+{
+  // bit-vectors wider than 1 use the term-level IC3Bits
+  FunctionalTransitionSystem fts(s);
+  Term max_val = fts.make_term(10, bvsort8);
+  counter_system(fts, max_val);
+  Term x = fts.named_terms().at("x");
+
+  Term prop_term = s->make_term(BVUle, x, max_val);
+  Property p(s, prop_term);
+
+  PonoOptions opts;
+  opts.ic3bits_sat_ = true;
+  IC3Bits ic3bits(p, fts, s, opts);
+  ProverResult r = ic3bits.prove();
+  ASSERT_EQ(r, TRUE);
+  Term invar = ic3bits.invar();
+  ASSERT_TRUE(check_invar(fts, prop_term, invar));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     ParameterizedSolverIC3BitsUnitTests,
     IC3BitsUnitTests,
@@ -1,6 +1,8 @@
 #ifdef WITH_MSAT
 // Only run this test with MathSAT
 
+#include <cstdio>
+#include <filesystem>
 #include <utility>
 #include <vector>
 
@@ -9,6 +11,8 @@
 #include "gtest/gtest.h"
 #include "smt/available_solvers.h"
 #include "tests/common_ts.h"
+#include "utils/lemma_cache.h"
+#include "utils/term_analysis.h"
 #include "utils/ts_analysis.h"
 
 using namespace pono;
@@ -146,6 +150,67 @@ TEST_P(IC3IAUnitTests, SimpleIntSafe)
   ASSERT_TRUE(check_invar(rts, p.prop(), invar));
 }
 
+TEST_P(IC3IAUnitTests, PredicateCache)
+{
+  string cache = (std::filesystem::temp_directory_path()
+                  / ("pono_pred_cache_" + smt::to_string(GetParam())))
+                     .string();
+  std::remove(cache.c_str());
+
+  // y tracks x, which needs a learned predicate over both
+  auto make_system = [](const SmtSolver & solver,
+                        RelationalTransitionSystem & rts) {
+    Sort intsort = solver->make_sort(INT);
+    Term x = rts.make_statevar("x", intsort);
+    Term y = rts.make_statevar("y", intsort);
+    rts.constrain_init(rts.make_term(Equal, x, rts.make_term(0, intsort)));
+    rts.constrain_init(rts.make_term(Equal, y, rts.make_term(0, intsort)));
+    rts.constrain_trans(rts.make_term(Gt, rts.next(x), x));
+    rts.constrain_trans(rts.make_term(
+        Equal,
+        rts.next(y),
+        rts.make_term(Plus, y, rts.make_term(Minus, rts.next(x), x))));
+    Term wit = rts.make_statevar("propwit", solver->make_sort(BOOL));
+    rts.constrain_init(wit);
+    rts.assign_next(wit, rts.make_term(Equal, x, y));
+    return wit;
+  };
+
+  PonoOptions opts;
+  opts.ic3ia_pred_cache_ = cache;
+
+  RelationalTransitionSystem rts(s);
+  Property p(s, make_system(s, rts));
+  IC3IA ic3ia(p, rts, s, opts);
+  ASSERT_EQ(ic3ia.prove(), TRUE);
+
+  TermVec preds;
+  ASSERT_TRUE(read_predicate_cache(cache, rts, preds));
+  ASSERT_GT(preds.size(), 0);
+
+  // only the predicates over the variables of another system are read
+  RelationalTransitionSystem rts_x(s);
+  Term x = rts_x.make_statevar("x", intsort);
+  preds.clear();
+  ASSERT_TRUE(read_predicate_cache(cache, rts_x, preds));
+  for (const auto & pred : preds) {
+    UnorderedTermSet free_vars;
+    get_free_symbolic_consts(pred, free_vars);
+    for (const auto & v : free_vars) {
+      EXPECT_EQ(v, x);
+    }
+  }
+
+  // a fresh run starts with the learned predicates
+  SmtSolver s2 = create_solver_for(GetParam(), IC3IA_ENGINE, false);
+  RelationalTransitionSystem rts2(s2);
+  Property p2(s2, make_system(s2, rts2));
+  IC3IA ic3ia_warm(p2, rts2, s2, opts);
+  ASSERT_EQ(ic3ia_warm.prove(), TRUE);
+  EXPECT_GT(ic3ia_warm.statistics().get("ic3ia_reused_preds"), 0);
+  std::remove(cache.c_str());
+}
+
 INSTANTIATE_TEST_SUITE_P(
     ParameterizedSolverIC3IAUnitTests,
     IC3IAUnitTests,
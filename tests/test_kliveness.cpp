@@ -0,0 +1,104 @@
+#include <vector>
+
+#include "core/fts.h"
+#include "engines/kliveness.h"
+#include "gtest/gtest.h"
+#include "modifiers/mod_ts_prop.h"
+#include "smt/available_solvers.h"
+#include "utils/make_provers.h"
+
+using namespace pono;
+using namespace smt;
+using namespace std;
+
+namespace pono_tests {
+
+class KLivenessTests : public ::testing::Test,
+                       public ::testing::WithParamInterface<SolverEnum>
+{
+ protected:
+  void SetUp() override
+  {
+    s = create_solver(GetParam());
+    bvsort = s->make_sort(BV, 4);
+  }
+  SmtSolver s;
+  Sort bvsort;
+};
+
+/** x counts from 0 to 3, then stays at 3 if saturate, else wraps */
+static Term counter(FunctionalTransitionSystem & fts,
+                    const Sort & bvsort,
+                    bool saturate)
+{
+  Term x = fts.make_statevar("x", bvsort);
+  Term three = fts.make_term(3, bvsort);
+  fts.constrain_init(fts.make_term(Equal, x, fts.make_term(0, bvsort)));
+  fts.assign_next(
+      x,
+      fts.make_term(Ite,
+                    fts.make_term(BVUlt, x, three),
+                    fts.make_term(BVAdd, x, fts.make_term(1, bvsort)),
+                    saturate ? three : fts.make_term(0, bvsort)));
+  return x;
+}
+
+TEST_P(KLivenessTests, FinitelyOften)
+{
+  FunctionalTransitionSystem fts(s);
+  Term x = counter(fts, bvsort, true);
+  // x < 3 holds in the first three states only
+  Term three = fts.make_term(3, bvsort);
+  Property p(s, fts.make_term(Not, fts.make_term(BVUlt, x, three)));
+
+  KLiveness klive(p, fts, s);
+  ASSERT_EQ(klive.check_until(10), ProverResult::TRUE);
+  EXPECT_EQ(klive.bound(), 3);
+}
+
+TEST_P(KLivenessTests, Lasso)
+{
+  FunctionalTransitionSystem fts(s);
+  Term x = counter(fts, bvsort, false);
+  Term accept = add_justice_monitor(
+      fts, { fts.make_term(Equal, x, fts.make_term(3, bvsort)) });
+  EXPECT_EQ(fts.statevars().size(), 1);
+
+  shared_ptr<Prover> klive =
+      make_prover(KLIVE, Property(s, fts.make_term(Not, accept)), fts, s);
+  ASSERT_EQ(klive->check_until(10), ProverResult::FALSE);
+  vector<UnorderedTermMap> cex;
+  ASSERT_TRUE(klive->witness(cex));
+  // 0, 1, 2, 3 and back to 0
+  ASSERT_EQ(cex.size(), 5);
+  EXPECT_EQ(cex.front().at(x), cex.back().at(x));
+}
+
+TEST_P(KLivenessTests, JusticeMonitor)
+{
+  FunctionalTransitionSystem fts(s);
+  Term x = counter(fts, bvsort, true);
+  Term b = fts.make_statevar("b", s->make_sort(BOOL));
+  fts.constrain_init(b);
+  fts.assign_next(b, fts.make_term(Not, b));
+
+  // b and not b both hold infinitely often
+  FunctionalTransitionSystem both(fts);
+  Term accept = add_justice_monitor(both, { b, both.make_term(Not, b) });
+  EXPECT_EQ(both.statevars().size(), 5);
+  KLiveness klive_both(Property(s, both.make_term(Not, accept)), both, s);
+  EXPECT_EQ(klive_both.check_until(10), ProverResult::FALSE);
+
+  // but not together with x < 3
+  FunctionalTransitionSystem with_x(fts);
+  accept = add_justice_monitor(
+      with_x, { b, with_x.make_term(BVUlt, x, with_x.make_term(3, bvsort)) });
+  KLiveness klive_x(Property(s, with_x.make_term(Not, accept)), with_x, s);
+  EXPECT_EQ(klive_x.check_until(10), ProverResult::TRUE);
+}
+
+INSTANTIATE_TEST_SUITE_P(ParameterizedSolverKLivenessTests,
+                         KLivenessTests,
+                         testing::ValuesIn(available_solver_enums()));
+
+}  // namespace pono_tests
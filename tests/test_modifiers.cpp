@@ -3,9 +3,15 @@
 
 #include "core/fts.h"
 #include "core/rts.h"
+#include "engines/bmc.h"
 #include "gtest/gtest.h"
+#include "modifiers/array_flattener.h"
+#include "modifiers/constant_propagation.h"
+#include "modifiers/fraig.h"
 #include "modifiers/history_modifier.h"
 #include "modifiers/implicit_predicate_abstractor.h"
+#include "modifiers/latch_sweep.h"
+#include "modifiers/mod_ts_prop.h"
 #include "modifiers/prophecy_modifier.h"
 #include "smt-switch/utils.h"
 #include "smt/available_solvers.h"
@@ -92,6 +98,37 @@ TEST_P(ModifierUnitTests, ProphecyModifierSimple)
   EXPECT_TRUE(free_vars.find(proph_var) != free_vars.end());
 }
 
+TEST_P(ModifierUnitTests, ProphecyModifierPooling)
+{
+  FunctionalTransitionSystem fts(s);
+  counter_system(fts, fts.make_term(9, bvsort));
+  Term x = fts.named_terms().at("x");
+  size_t num_statevars_orig = fts.statevars().size();
+
+  ProphecyModifier pm(fts);
+  EXPECT_FALSE(pm.has_proph(x, 2));
+  std::pair<Term, Term> p1 = pm.get_proph(x, 2);
+  EXPECT_TRUE(pm.has_proph(x, 2));
+  EXPECT_EQ(fts.statevars().size(), num_statevars_orig + 3);
+
+  // the same target and delay reuses the prophecy variable
+  std::pair<Term, Term> p2 = pm.get_proph(x, 2);
+  EXPECT_EQ(p1, p2);
+  EXPECT_EQ(fts.statevars().size(), num_statevars_orig + 3);
+
+  // a history of a history variable extends the same chain
+  // (a fresh solver because the symbol names would clash)
+  SmtSolver s2 = create_solver(GetParam());
+  FunctionalTransitionSystem fts2(s2);
+  counter_system(fts2, fts2.make_term(9, s2->make_sort(BV, 8)));
+  x = fts2.named_terms().at("x");
+  HistoryModifier hm(fts2);
+  Term hist_x_1 = hm.get_hist(x, 1);
+  Term hist_x_3 = hm.get_hist(x, 3);
+  EXPECT_EQ(hm.get_hist(hist_x_1, 2), hist_x_3);
+  EXPECT_EQ(hm.num_hist_vars(), 3);
+}
+
 TEST_P(ModifierUnitTests, ImplicitPredicateAbstractor)
 {
   RelationalTransitionSystem rts(s);
@@ -138,6 +175,257 @@ TEST_P(ModifierUnitTests, ImplicitPredicateAbstractor)
   EXPECT_TRUE(r.is_unsat());  // expecting it to be inductive now
 }
 
+TEST_P(ModifierUnitTests, ImplicitPredicateAbstractorLazyShadows)
+{
+  FunctionalTransitionSystem fts(s);
+  counter_system(fts, fts.make_term(10, bvsort));
+  Term x = fts.named_terms().at("x");
+  // y and z are not in the cone of the predicates on x
+  Term y = fts.make_statevar("y", bvsort);
+  Term z = fts.make_statevar("z", bvsort);
+  fts.assign_next(y, fts.make_term(BVAdd, y, z));
+  fts.assign_next(z, fts.make_term(BVAdd, z, fts.make_term(1, bvsort)));
+  // the next state of w appears in a constraint, its update is kept
+  Term w = fts.make_statevar("w", bvsort);
+  fts.assign_next(w, x);
+  fts.add_constraint(fts.make_term(BVUle, w, fts.make_term(10, bvsort)));
+
+  RelationalTransitionSystem abs_rts(fts.solver());
+  Unroller un(abs_rts);
+  ImplicitPredicateAbstractor ia(fts, abs_rts, un);
+  ia.do_abstraction();
+  EXPECT_EQ(ia.num_shadow_vars(), 1);
+
+  Term x_le_10 = fts.make_term(BVUle, x, fts.make_term(10, bvsort));
+  s->push();
+  s->assert_formula(x_le_10);
+  s->assert_formula(abs_rts.trans());
+  s->assert_formula(s->make_term(Not, abs_rts.next(x_le_10)));
+  Result r = s->check_sat();
+  s->pop();
+  EXPECT_TRUE(r.is_sat());
+
+  // the refinement brings the update of x with its abstract variable
+  abs_rts.constrain_trans(ia.predicate_refinement(x_le_10));
+  EXPECT_EQ(ia.num_shadow_vars(), 2);
+  s->push();
+  s->assert_formula(x_le_10);
+  s->assert_formula(abs_rts.trans());
+  s->assert_formula(s->make_term(Not, abs_rts.next(x_le_10)));
+  r = s->check_sat();
+  s->pop();
+  EXPECT_TRUE(r.is_unsat());
+}
+
+TEST_P(ModifierUnitTests, LatchSweep)
+{
+  FunctionalTransitionSystem fts(s);
+  Term zero = fts.make_term(0, bvsort);
+  Term one = fts.make_term(1, bvsort);
+
+  Term x = fts.make_statevar("x", bvsort);
+  fts.constrain_init(fts.make_term(Equal, x, zero));
+  fts.assign_next(x, fts.make_term(BVAdd, x, one));
+
+  // duplicate of x
+  Term y = fts.make_statevar("y", bvsort);
+  fts.constrain_init(fts.make_term(Equal, y, zero));
+  fts.assign_next(y, fts.make_term(BVAdd, y, one));
+
+  // stuck at zero
+  Term z = fts.make_statevar("z", bvsort);
+  fts.constrain_init(fts.make_term(Equal, z, zero));
+  fts.assign_next(z, fts.make_term(BVAnd, z, x));
+
+  // equal to x in the simulated cycles but not in all reachable states
+  Term u = fts.make_statevar("u", bvsort);
+  fts.constrain_init(fts.make_term(Equal, u, zero));
+  fts.assign_next(
+      u,
+      fts.make_term(Ite,
+                    fts.make_term(Equal, x, fts.make_term(200, bvsort)),
+                    zero,
+                    fts.make_term(BVAdd, u, one)));
+
+  Term prop = fts.make_term(BVUle, z, y);
+  LatchSweep sweep(fts);
+
+  const UnorderedTermMap & subst = sweep.substitution();
+  EXPECT_EQ(subst.size(), 2);
+  EXPECT_EQ(subst.at(y), x);
+  EXPECT_EQ(subst.at(z), zero);
+
+  const UnorderedTermSet & statevars = fts.statevars();
+  EXPECT_EQ(statevars.size(), 2);
+  EXPECT_TRUE(statevars.find(x) != statevars.end());
+  EXPECT_TRUE(statevars.find(u) != statevars.end());
+  EXPECT_EQ(fts.state_updates().size(), 2);
+
+  UnorderedTermSet free_syms;
+  get_free_symbolic_consts(sweep.rewrite(prop), free_syms);
+  EXPECT_EQ(free_syms.size(), 1);
+  EXPECT_TRUE(free_syms.find(x) != free_syms.end());
+}
+
+TEST_P(ModifierUnitTests, Fraig)
+{
+  FunctionalTransitionSystem fts(s);
+  Term zero = fts.make_term(0, bvsort);
+  Term i = fts.make_inputvar("i", bvsort);
+
+  Term x = fts.make_statevar("x", bvsort);
+  fts.constrain_init(fts.make_term(Equal, x, zero));
+  fts.assign_next(x, fts.make_term(BVAdd, x, i));
+
+  // stuck at zero, but only in the reachable states
+  Term z = fts.make_statevar("z", bvsort);
+  fts.constrain_init(fts.make_term(Equal, z, zero));
+  Term z_update = fts.make_term(BVAnd, z, x);
+  fts.assign_next(z, z_update);
+
+  // two forms of x xor i
+  Term w = fts.make_statevar("w", bvsort);
+  fts.assign_next(w, fts.make_term(BVXor, x, i));
+  Term v = fts.make_statevar("v", bvsort);
+  fts.assign_next(
+      v,
+      fts.make_term(BVOr,
+                    fts.make_term(BVAnd, x, fts.make_term(BVNot, i)),
+                    fts.make_term(BVAnd, fts.make_term(BVNot, x), i)));
+
+  Term prop = fts.make_term(Equal, fts.state_updates().at(v), w);
+  Fraig fraig(fts);
+
+  EXPECT_GE(fraig.substitution().size(), 1);
+  EXPECT_EQ(fts.state_updates().at(w), fts.state_updates().at(v));
+  EXPECT_EQ(fraig.rewrite(prop),
+            fts.make_term(Equal, fts.state_updates().at(w), w));
+
+  // only combinational equivalences are merged
+  EXPECT_EQ(fts.state_updates().at(z), z_update);
+  EXPECT_EQ(fts.statevars().size(), 4);
+}
+
+TEST_P(ModifierUnitTests, ArrayFlattener)
+{
+  // a register file of four counters, incremented in turn
+  FunctionalTransitionSystem fts(s);
+  Sort idxsort = s->make_sort(BV, 2);
+  Sort memsort = s->make_sort(ARRAY, idxsort, bvsort);
+  Term zero = fts.make_term(0, bvsort);
+  Term mem = fts.make_statevar("mem", memsort);
+  Term ptr = fts.make_statevar("ptr", idxsort);
+  fts.constrain_init(
+      fts.make_term(Equal, mem, fts.make_term(zero, memsort)));
+  fts.constrain_init(fts.make_term(Equal, ptr, fts.make_term(0, idxsort)));
+  fts.assign_next(
+      ptr, fts.make_term(BVAdd, ptr, fts.make_term(1, idxsort)));
+  Term inc = fts.make_term(
+      BVAdd, fts.make_term(Select, mem, ptr), fts.make_term(1, bvsort));
+  fts.assign_next(mem, fts.make_term(Store, mem, ptr, inc));
+  Term prop = fts.make_term(BVUlt,
+                            fts.make_term(Select, mem, fts.make_term(0, idxsort)),
+                            fts.make_term(3, bvsort));
+
+  // too large
+  FunctionalTransitionSystem narrow(fts);
+  ArrayFlattener none(narrow, 1);
+  EXPECT_FALSE(none.flattened());
+  EXPECT_EQ(narrow.statevars().size(), 2);
+
+  FunctionalTransitionSystem flat(fts);
+  ArrayFlattener af(flat, 2);
+  ASSERT_TRUE(af.flattened());
+  EXPECT_EQ(af.flattened_vars(), TermVec({ mem }));
+  EXPECT_EQ(flat.statevars().size(), 5);
+  for (const auto & sv : flat.statevars()) {
+    EXPECT_EQ(sv->get_sort()->get_sort_kind(), BV);
+  }
+  Term flat_prop = af.rewrite(prop);
+  EXPECT_TRUE(flat.only_curr(flat_prop));
+
+  // mem[0] reaches 3 after 9 transitions
+  Bmc bmc(Property(s, flat_prop), flat, s);
+  ASSERT_EQ(bmc.check_until(12), ProverResult::FALSE);
+  vector<UnorderedTermMap> cex;
+  ASSERT_TRUE(bmc.witness(cex));
+  ASSERT_EQ(cex.size(), 10);
+  af.lift_witness(cex);
+  Term last = cex.back().at(mem);
+  EXPECT_EQ(last->get_sort(), memsort);
+  EXPECT_EQ(cex.back().at(flat.lookup("mem[0]")), fts.make_term(3, bvsort));
+}
+
+TEST_P(ModifierUnitTests, ConstantPropagation)
+{
+  FunctionalTransitionSystem fts(s);
+  Term zero = fts.make_term(0, bvsort);
+  Term one = fts.make_term(1, bvsort);
+  Term en = fts.make_inputvar("en", boolsort);
+
+  Term x = fts.make_statevar("x", bvsort);
+  fts.constrain_init(fts.make_term(Equal, x, zero));
+
+  // constant latches that depend on each other
+  Term k = fts.make_statevar("k", bvsort);
+  fts.constrain_init(fts.make_term(Equal, k, fts.make_term(5, bvsort)));
+  Term m = fts.make_statevar("m", bvsort);
+  fts.constrain_init(fts.make_term(Equal, m, zero));
+  fts.assign_next(k, fts.make_term(Ite, en, k, fts.make_term(BVAdd, k, m)));
+  fts.assign_next(m, fts.make_term(BVAnd, m, x));
+
+  // x + ((m << 1) + 1), where m is zero
+  Term wide = fts.make_term(Concat, zero, x);
+  fts.assign_next(
+      x,
+      fts.make_term(
+          BVAdd,
+          fts.make_term(Op(Extract, 7, 0), wide),
+          fts.make_term(BVAdd, fts.make_term(BVShl, m, one), one)));
+
+  Term prop = fts.make_term(BVUle, m, k);
+  ConstantPropagation cp(fts);
+
+  const UnorderedTermMap & constants = cp.constants();
+  EXPECT_EQ(constants.size(), 2);
+  EXPECT_EQ(constants.at(k), fts.make_term(5, bvsort));
+  EXPECT_EQ(constants.at(m), zero);
+
+  const UnorderedTermSet & statevars = fts.statevars();
+  EXPECT_EQ(statevars.size(), 1);
+  EXPECT_TRUE(statevars.find(x) != statevars.end());
+  EXPECT_EQ(fts.state_updates().at(x), fts.make_term(BVAdd, x, one));
+  EXPECT_EQ(cp.rewrite(prop), fts.make_term(true));
+}
+
+TEST_P(ModifierUnitTests, AssumeInvariants)
+{
+  FunctionalTransitionSystem fts(s);
+  Term zero = fts.make_term(0, bvsort);
+  Term x = fts.make_statevar("x", bvsort);
+  Term y = fts.make_statevar("y", bvsort);
+  Term in = fts.make_inputvar("in", bvsort);
+  fts.constrain_init(fts.make_term(Equal, x, zero));
+  fts.constrain_init(fts.make_term(Equal, y, zero));
+  fts.assign_next(x, fts.make_term(BVAnd, x, in));
+  fts.assign_next(y, fts.make_term(BVAdd, y, x));
+
+  Term x_zero = fts.make_term(Equal, x, zero);
+  Term y_zero = fts.make_term(Equal, y, zero);
+  // not over the state variables, so it is skipped
+  Term in_zero = fts.make_term(Equal, in, zero);
+  EXPECT_EQ(assume_invariants(fts, { x_zero, in_zero }), 1);
+  EXPECT_EQ(fts.constraints().size(), 1);
+
+  // y == 0 is now inductive
+  s->push();
+  s->assert_formula(y_zero);
+  s->assert_formula(fts.trans());
+  s->assert_formula(fts.make_term(Not, fts.next(y_zero)));
+  EXPECT_TRUE(s->check_sat().is_unsat());
+  s->pop();
+}
+
 INSTANTIATE_TEST_SUITE_P(ParameterizedModifierUnitTests,
                          ModifierUnitTests,
                          testing::ValuesIn(available_solver_enums()));
@@ -116,6 +116,27 @@ TEST_P(DynamicCoiUnitTests, SimpleCoiTest)
     CheckPartialModel(e4b, u);
 }
 
+TEST_P(DynamicCoiUnitTests, RepeatedWalks)
+{
+    Term a = s->make_symbol("a", bvsort8);
+    Term b = s->make_symbol("b", bvsort8);
+    Term c = s->make_symbol("c", boolsort);
+    Term ite = ITE(c, a, b);
+
+    PartialModelGen pt(s);
+    // the marks of a walk must not leak into the next one
+    for (bool cval : { true, false, true }) {
+      s->push();
+      s->assert_formula(cval ? c : NOT(c));
+      ASSERT_TRUE(s->check_sat().is_sat());
+      const TermVec & vars = pt.GetVarListForAsts({ ite });
+      UnorderedTermSet varset(vars.begin(), vars.end());
+      EXPECT_EQ(vars.size(), 2);
+      EXPECT_EQ(varset, UnorderedTermSet({ c, cval ? a : b }));
+      s->pop();
+    }
+}
+
 
 INSTANTIATE_TEST_SUITE_P(ParameterizedDynamicCoiUnitTests,
                          DynamicCoiUnitTests,
@@ -0,0 +1,145 @@
+#include <vector>
+
+#include "core/fts.h"
+#include "engines/prop_decomposition.h"
+#include "gtest/gtest.h"
+#include "smt/available_solvers.h"
+#include "utils/make_provers.h"
+
+using namespace pono;
+using namespace smt;
+using namespace std;
+
+namespace pono_tests {
+
+class PropDecompositionTests
+    : public ::testing::Test,
+      public ::testing::WithParamInterface<SolverEnum>
+{
+ protected:
+  void SetUp() override
+  {
+    s = create_solver(GetParam());
+    boolsort = s->make_sort(BOOL);
+    bvsort = s->make_sort(BV, 4);
+  }
+  SmtSolver s;
+  Sort boolsort;
+  Sort bvsort;
+};
+
+/** name counts up from 0 to 3 and stays there if saturate, else wraps
+ *  at 15
+ */
+static Term counter(FunctionalTransitionSystem & fts,
+                    const Sort & bvsort,
+                    const string & name,
+                    bool saturate)
+{
+  Term x = fts.make_statevar(name, bvsort);
+  Term three = fts.make_term(3, bvsort);
+  Term inc = fts.make_term(BVAdd, x, fts.make_term(1, bvsort));
+  fts.constrain_init(fts.make_term(Equal, x, fts.make_term(0, bvsort)));
+  fts.assign_next(
+      x,
+      saturate ? fts.make_term(Ite, fts.make_term(BVUlt, x, three), inc, three)
+               : inc);
+  return x;
+}
+
+TEST_P(PropDecompositionTests, Decompose)
+{
+  Term a = s->make_symbol("a", boolsort);
+  Term b = s->make_symbol("b", boolsort);
+  Term c = s->make_symbol("c", boolsort);
+  Term d = s->make_symbol("d", boolsort);
+
+  TermVec parts = decompose_property(
+      s,
+      s->make_term(And,
+                   s->make_term(Not, s->make_term(Or, a, b)),
+                   s->make_term(And, c, s->make_term(true))));
+  ASSERT_EQ(parts.size(), 3);
+  EXPECT_EQ(parts[0], s->make_term(Not, a));
+  EXPECT_EQ(parts[1], s->make_term(Not, b));
+  EXPECT_EQ(parts[2], c);
+
+  // implications keep their guard
+  parts = decompose_property(
+      s, s->make_term(Implies, d, s->make_term(And, a, c)));
+  ASSERT_EQ(parts.size(), 2);
+  EXPECT_EQ(parts[0], s->make_term(Implies, d, a));
+  EXPECT_EQ(parts[1], s->make_term(Implies, d, c));
+
+  // BTOR2 bad states are disjunctions of bit-vectors of width one
+  Sort bv1 = s->make_sort(BV, 1);
+  Term one = s->make_term(1, bv1);
+  Term x = s->make_symbol("x", bv1);
+  Term y = s->make_symbol("y", bv1);
+  parts = decompose_property(
+      s,
+      s->make_term(Not, s->make_term(Equal, s->make_term(BVOr, x, y), one)));
+  ASSERT_EQ(parts.size(), 2);
+  EXPECT_EQ(parts[0], s->make_term(Not, s->make_term(Equal, x, one)));
+  EXPECT_EQ(parts[1], s->make_term(Not, s->make_term(Equal, y, one)));
+
+  EXPECT_EQ(decompose_property(s, s->make_term(And, a, a)).size(), 1);
+}
+
+TEST_P(PropDecompositionTests, FalseConjunct)
+{
+  FunctionalTransitionSystem fts(s);
+  Term x = counter(fts, bvsort, "x", false);
+  Term y = counter(fts, bvsort, "y", true);
+  Term fifteen = fts.make_term(15, bvsort);
+  Property p(s,
+             fts.make_term(And,
+                           fts.make_term(BVUle, y, fts.make_term(3, bvsort)),
+                           fts.make_term(Distinct, x, fifteen)));
+
+  PonoOptions opts;
+  opts.decompose_threads_ = 2;
+  shared_ptr<Prover> prover = make_decomposed_prover(BMC, p, fts, s, opts);
+  ASSERT_EQ(prover->check_until(20), ProverResult::FALSE);
+
+  // the witness covers y, outside of the cone of the false conjunct
+  vector<UnorderedTermMap> cex;
+  ASSERT_TRUE(prover->witness(cex));
+  ASSERT_EQ(cex.size(), 16);
+  EXPECT_EQ(cex.back().at(x), fifteen);
+  EXPECT_EQ(cex.back().at(y), fts.make_term(3, bvsort));
+}
+
+TEST_P(PropDecompositionTests, Assumptions)
+{
+  FunctionalTransitionSystem fts(s);
+  Term x = counter(fts, bvsort, "x", true);
+  // z == 0 is only inductive together with x <= 3
+  Term z = fts.make_statevar("z", bvsort);
+  Term zero = fts.make_term(0, bvsort);
+  fts.constrain_init(fts.make_term(Equal, z, zero));
+  fts.assign_next(
+      z,
+      fts.make_term(Ite,
+                    fts.make_term(Equal, x, fts.make_term(7, bvsort)),
+                    fts.make_term(1, bvsort),
+                    z));
+  Property p(s,
+             fts.make_term(And,
+                           fts.make_term(BVUle, x, fts.make_term(3, bvsort)),
+                           fts.make_term(Equal, z, zero)));
+
+  PonoOptions opts;
+  opts.engine_ = KIND;
+  PropDecomposition pd(p, fts, s, opts);
+  ASSERT_EQ(pd.check_until(5), ProverResult::TRUE);
+  ASSERT_EQ(pd.sub_properties().size(), 2);
+  EXPECT_EQ(pd.sub_results()[0], ProverResult::TRUE);
+  EXPECT_EQ(pd.sub_results()[1], ProverResult::TRUE);
+}
+
+INSTANTIATE_TEST_SUITE_P(ParameterizedSolverPropDecompositionTests,
+                         PropDecompositionTests,
+                         testing::ValuesIn(available_solver_enums()));
+
+}  // namespace pono_tests
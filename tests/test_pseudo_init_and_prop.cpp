@@ -64,6 +64,34 @@ TEST_P(PseudoInitPropUnitTests, TrivialUnsafe)
   ASSERT_EQ(r, FALSE);
 }
 
+TEST_P(PseudoInitPropUnitTests, OncePerProperty)
+{
+  FunctionalTransitionSystem fts(s);
+  counter_system(fts, fts.make_term(10, bvsort8));
+  Term x = fts.named_terms().at("x");
+  size_t num_statevars = fts.statevars().size();
+
+  Term safe_prop = s->make_term(BVUle, x, s->make_term(10, bvsort8));
+  Term unsafe_prop = s->make_term(BVUle, x, s->make_term(5, bvsort8));
+
+  // both copies share the solver, the new variables get fresh names
+  TransitionSystem safe_ts = pseudo_init_and_prop(fts, safe_prop);
+  TransitionSystem unsafe_ts = pseudo_init_and_prop(fts, unsafe_prop);
+  EXPECT_EQ(fts.statevars().size(), num_statevars);
+  EXPECT_EQ(safe_ts.statevars().size(), num_statevars + 2);
+  EXPECT_EQ(unsafe_ts.statevars().size(), num_statevars + 2);
+  EXPECT_NE(safe_prop, unsafe_prop);
+
+  Property p_safe(s, safe_prop);
+  KInduction kind_safe(p_safe, safe_ts, create_solver(GetParam(), false));
+  EXPECT_EQ(kind_safe.check_until(11), TRUE);
+
+  Property p_unsafe(s, unsafe_prop);
+  KInduction kind_unsafe(
+      p_unsafe, unsafe_ts, create_solver(GetParam(), false));
+  EXPECT_EQ(kind_unsafe.check_until(10), FALSE);
+}
+
 INSTANTIATE_TEST_SUITE_P(ParameterizedSolverPseudoInitPropUnitTests,
                          PseudoInitPropUnitTests,
                          testing::ValuesIn(available_solver_enums()));
@@ -120,6 +120,43 @@ TEST_P(TermAnalysisUnitTests, GetPredicatesIte)
   }
 }
 
+TEST_P(TermAnalysisUnitTests, PredicateCollector)
+{
+  Term x = s->make_symbol("x", bvsort);
+  Term y = s->make_symbol("y", bvsort);
+  Term z = s->make_symbol("z", bvsort);
+  Term nextval = s->make_symbol("nextval", bvsort);
+
+  Term yltz = s->make_term(BVUlt, y, z);
+  Term ite = s->make_term(Ite, yltz, y, z);
+  Term f1 = s->make_term(Equal, nextval, ite);
+  Term f2 = s->make_term(
+      And, f1, s->make_term(BVUlt, x, s->make_term(8, bvsort)));
+
+  PredicateCollector pc(s, false, false, true);
+  for (const auto & f : { f1, f2, f1 }) {
+    UnorderedTermSet expected, preds;
+    get_predicates(s, f, expected, false, false, true);
+    pc.get_predicates(f, preds);
+    EXPECT_EQ(preds, expected);
+  }
+  // f1 was cached by the call on f2
+  size_t cached = pc.size();
+  UnorderedTermSet preds;
+  pc.get_predicates(f1, preds);
+  EXPECT_EQ(pc.size(), cached);
+
+  // only the predicates that were not returned before
+  UnorderedTermSet new_preds;
+  pc.get_new_predicates(f1, new_preds);
+  EXPECT_EQ(new_preds, preds);
+  new_preds.clear();
+  pc.get_new_predicates(f2, new_preds);
+  EXPECT_EQ(new_preds.size(), 1);
+  EXPECT_TRUE(new_preds.find(s->make_term(BVUlt, x, s->make_term(8, bvsort)))
+              != new_preds.end());
+}
+
 INSTANTIATE_TEST_SUITE_P(ParameterizedTermAnalysisUnitTests,
                          TermAnalysisUnitTests,
                          testing::ValuesIn(available_solver_enums()));
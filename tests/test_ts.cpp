@@ -103,6 +103,77 @@ TEST_P(TSUnitTests, RTS_Exceptions)
   EXPECT_NO_THROW(rts.constrain_trans(s->make_term(Equal, rts.next(x), xp1_n)));
 }
 
+TEST_P(TSUnitTests, SymbolClassesAfterPromotion)
+{
+  FunctionalTransitionSystem fts(s);
+  Term x = fts.make_statevar("x", bvsort);
+  Term y = fts.make_inputvar("y", bvsort);
+  Term x_eq_y = s->make_term(Equal, x, y);
+  // classified as containing an input
+  EXPECT_THROW(fts.constrain_init(x_eq_y), PonoException);
+  EXPECT_NO_THROW(fts.constrain_inputs(x_eq_y));
+
+  fts.promote_inputvar(y);
+  EXPECT_NO_THROW(fts.constrain_init(x_eq_y));
+  EXPECT_NO_THROW(fts.add_invar(x_eq_y));
+  EXPECT_THROW(fts.constrain_inputs(fts.next(x_eq_y)), PonoException);
+}
+
+TEST_P(TSUnitTests, TransConjuncts)
+{
+  FunctionalTransitionSystem fts(s);
+  EXPECT_TRUE(fts.trans_conjuncts().empty());
+  EXPECT_EQ(fts.trans(), s->make_term(true));
+
+  Term x = fts.make_statevar("x", bvsort);
+  Term y = fts.make_statevar("y", bvsort);
+  Term z = fts.make_statevar("z", bvsort);
+  Term one = fts.make_term(1, bvsort);
+  fts.assign_next(x, s->make_term(BVAdd, x, one));
+  Term x_eq = s->make_term(Equal, fts.next(x), s->make_term(BVAdd, x, one));
+  ASSERT_EQ(fts.trans_conjuncts().size(), 1);
+  EXPECT_EQ(fts.trans(), x_eq);
+
+  fts.assign_next(y, x);
+  fts.assign_next(z, y);
+  // the invariant is added in the current and next state
+  fts.add_invar(s->make_term(BVUle, z, y));
+  EXPECT_EQ(fts.trans_conjuncts().size(), 5);
+
+  Term conj = s->make_term(true);
+  for (const auto & c : fts.trans_conjuncts()) {
+    conj = s->make_term(And, conj, c);
+  }
+  s->assert_formula(s->make_term(Distinct, conj, fts.trans()));
+  EXPECT_TRUE(s->check_sat().is_unsat());
+}
+
+TEST_P(TSUnitTests, NextCurrConversion)
+{
+  FunctionalTransitionSystem fts(s);
+  Term x = fts.make_statevar("x", bvsort);
+  Term y = fts.make_inputvar("y", bvsort);
+  Term x_lt_y = s->make_term(BVUlt, x, y);
+  Term x_eq_0 = s->make_term(Equal, x, fts.make_term(0, bvsort));
+
+  Term x_lt_y_n = fts.next(x_lt_y);
+  EXPECT_EQ(x_lt_y_n, s->make_term(BVUlt, fts.next(x), y));
+  // converted again from the cache
+  EXPECT_EQ(fts.next(x_lt_y), x_lt_y_n);
+  EXPECT_EQ(fts.curr(x_lt_y_n), x_lt_y);
+
+  TermVec nexts = fts.next(TermVec{ x_lt_y, x_eq_0, x });
+  ASSERT_EQ(nexts.size(), 3);
+  EXPECT_EQ(nexts[0], x_lt_y_n);
+  EXPECT_EQ(nexts[1], fts.next(x_eq_0));
+  EXPECT_EQ(nexts[2], fts.next(x));
+
+  // the cache is invalidated when y becomes a state variable
+  fts.promote_inputvar(y);
+  EXPECT_EQ(fts.next(x_lt_y),
+            s->make_term(BVUlt, fts.next(x), fts.next(y)));
+}
+
 TEST_P(TSUnitTests, FTS_DefaultCopy)
 {
   FunctionalTransitionSystem fts;
@@ -120,6 +191,64 @@ TEST_P(TSUnitTests, RTS_Copy)
   TransitionSystem ts = rts;
 }
 
+TEST_P(TSUnitTests, FTS_CopyOnWrite)
+{
+  FunctionalTransitionSystem fts(s);
+  Term x = fts.make_statevar("x", bvsort);
+  Term in = fts.make_inputvar("in", bvsort);
+  fts.assign_next(x, in);
+
+  FunctionalTransitionSystem fts_copy = fts;
+  EXPECT_EQ(fts_copy, fts);
+
+  // modifying the copy does not change the original
+  Term y = fts_copy.make_statevar("y", bvsort);
+  fts_copy.assign_next(y, x);
+  fts_copy.add_invar(s->make_term(BVUle, y, x));
+  EXPECT_NE(fts_copy, fts);
+  EXPECT_EQ(fts.statevars().size(), 1);
+  EXPECT_EQ(fts.state_updates().size(), 1);
+  EXPECT_EQ(fts.trans_conjuncts().size(), 1);
+  EXPECT_TRUE(fts.constraints().empty());
+  EXPECT_EQ(fts.named_terms().find("y"), fts.named_terms().end());
+
+  // and the other way around
+  fts.promote_inputvar(in);
+  EXPECT_FALSE(fts_copy.is_curr_var(in));
+  EXPECT_TRUE(fts_copy.is_input_var(in));
+}
+
+TEST_P(TSUnitTests, BulkConstruction)
+{
+  FunctionalTransitionSystem fts(s);
+  TermVec svs = fts.make_statevars({ { "x", bvsort }, { "y", bvsort } });
+  TermVec ins = fts.make_inputvars({ { "in", bvsort } });
+  ASSERT_EQ(svs.size(), 2);
+  ASSERT_EQ(ins.size(), 1);
+  EXPECT_EQ(fts.lookup("y"), svs[1]);
+  EXPECT_TRUE(fts.is_input_var(ins[0]));
+
+  // x + in, (x + in) + y
+  Term one = s->make_term(1, bvsort);
+  TermVec terms = fts.make_terms({ svs[0], svs[1], ins[0], one },
+                                 { Op(BVAdd) },
+                                 { 0, 2, 0, 2, 0, 2, 4, 1 });
+  ASSERT_EQ(terms.size(), 2);
+  EXPECT_EQ(terms[0], s->make_term(BVAdd, svs[0], ins[0]));
+  EXPECT_EQ(terms[1], s->make_term(BVAdd, terms[0], svs[1]));
+
+  fts.assign_next(svs, { terms[1], svs[1] });
+  EXPECT_EQ(fts.state_updates().at(svs[0]), terms[1]);
+  EXPECT_TRUE(fts.is_deterministic());
+
+  EXPECT_THROW(fts.assign_next(svs, { one }), PonoException);
+  // argument 5 is not made yet
+  EXPECT_THROW(fts.make_terms({ svs[0] }, { Op(BVAdd) }, { 0, 2, 0, 5 }),
+               PonoException);
+  EXPECT_THROW(fts.make_terms({ svs[0] }, { Op(BVAdd) }, { 0, 2, 0 }),
+               PonoException);
+}
+
 TEST_P(TSUnitTests, Prop_Copy)
 {
   RelationalTransitionSystem rts(s);
@@ -48,6 +48,44 @@ TEST_P(TSReplaceTests, ReplaceTerms)
   EXPECT_TRUE(free_syms.find(v) == free_syms.end());
 }
 
+TEST_P(TSReplaceTests, BatchedRewrite)
+{
+  FunctionalTransitionSystem fts(s);
+
+  Term x = fts.make_statevar("x", bvsort);
+  Term y = fts.make_statevar("y", bvsort);
+  Term z = fts.make_statevar("z", bvsort);
+  Term in = fts.make_inputvar("in", bvsort);
+  fts.assign_next(x, s->make_term(BVAdd, x, in));
+  fts.assign_next(y, x);
+  fts.assign_next(z, y);
+  fts.add_constraint(s->make_term(BVUle, z, x));
+
+  // replace y by x and then x by z, as two passes would
+  TransitionSystem::Rewrite rw = fts.begin_rewrite();
+  rw.replace_terms({ { y, x } });
+  rw.replace_terms({ { x, z } });
+  rw.drop_state_updates({ x, y });
+  rw.restrict_vars({ z }, { in });
+  EXPECT_FALSE(rw.empty());
+
+  // nothing changes before the commit
+  EXPECT_EQ(fts.state_updates().size(), 3);
+
+  fts.commit_rewrite(rw);
+  EXPECT_EQ(fts.statevars(), UnorderedTermSet({ z }));
+  EXPECT_EQ(fts.inputvars(), UnorderedTermSet({ in }));
+  ASSERT_EQ(fts.state_updates().size(), 1);
+  EXPECT_EQ(fts.state_updates().at(z), z);
+  ASSERT_EQ(fts.constraints().size(), 1);
+  EXPECT_EQ(fts.constraints()[0].first, s->make_term(BVUle, z, z));
+
+  UnorderedTermSet free_syms;
+  get_free_symbolic_consts(fts.trans(), free_syms);
+  EXPECT_TRUE(free_syms.find(x) == free_syms.end());
+  EXPECT_TRUE(free_syms.find(y) == free_syms.end());
+}
+
 INSTANTIATE_TEST_SUITE_P(ParameterizedSolverTSReplaceTests,
                          TSReplaceTests,
                          testing::ValuesIn(available_solver_enums()));
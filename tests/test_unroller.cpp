@@ -10,6 +10,7 @@
 #include "smt/available_solvers.h"
 #include "tests/common_ts.h"
 #include "utils/exceptions.h"
+#include "utils/statistics.h"
 
 using namespace pono;
 using namespace smt;
@@ -92,6 +93,29 @@ TEST_P(UnrollerUnitTests, GetTime)
   EXPECT_THROW(u.get_curr_time(x1px4), PonoException);
 }
 
+TEST_P(UnrollerUnitTests, Shift)
+{
+  RelationalTransitionSystem rts(s);
+  counter_system(rts, rts.make_term(10, bvsort));
+  Term x = rts.named_terms().at("x");
+  Term y = rts.make_inputvar("y", bvsort);
+
+  Unroller u(rts);
+  Term t = rts.make_term(BVUlt, x, rts.make_term(BVAdd, x, y));
+  Term t3 = u.at_time(t, 3);
+  EXPECT_EQ(u.shift(t3, 3, 0), u.at_time(t, 0));
+  EXPECT_EQ(u.shift(t3, 3, 0), u.at_time(u.untime(t3), 0));
+  // forward, to time steps that were not unrolled yet
+  EXPECT_EQ(u.shift(t3, 3, 7), u.at_time(t, 7));
+  EXPECT_EQ(u.shift(t3, 3, 3), t3);
+
+  // the time steps stay apart
+  Term trans1 = u.at_time(rts.trans(), 1);
+  EXPECT_EQ(u.shift(trans1, 1, 0), u.at_time(rts.trans(), 0));
+
+  EXPECT_THROW(u.shift(t3, 4, 0), PonoException);
+}
+
 TEST_P(UnrollerUnitTests, StagedUnrolling)
 {
   RelationalTransitionSystem rts(s);
@@ -146,6 +170,143 @@ TEST_P(UnrollerUnitTests, Unroller)
   EXPECT_EQ(x4py4, x4py4_2);
 }
 
+TEST_P(UnrollerUnitTests, BatchUnrolling)
+{
+  RelationalTransitionSystem rts(s);
+  Term x = rts.make_statevar("x", bvsort);
+  Term y = rts.make_statevar("y", bvsort);
+  Term xpy = rts.make_term(BVAdd, x, y);
+  Term xpy_n = rts.make_term(BVMul, xpy, rts.next(x));
+
+  Unroller u(rts);
+  TermVec unrolled = u.at_time({ xpy, xpy_n, x }, 3);
+  ASSERT_EQ(unrolled.size(), 3);
+  // timed variables are unique, so compare with a substitution
+  UnorderedTermMap subst({ { x, u.at_time(x, 3) },
+                           { y, u.at_time(y, 3) },
+                           { rts.next(x), u.at_time(x, 4) } });
+  EXPECT_EQ(unrolled[0], s->substitute(xpy, subst));
+  EXPECT_EQ(unrolled[1], s->substitute(xpy_n, subst));
+  EXPECT_EQ(unrolled[2], subst.at(x));
+  EXPECT_EQ(u.at_time(rts.next(x), 3), u.at_time(x, 4));
+}
+
+TEST_P(UnrollerUnitTests, TermCacheLimit)
+{
+  RelationalTransitionSystem rts(s);
+  Term x = rts.make_statevar("x", bvsort);
+  Term y = rts.make_statevar("y", bvsort);
+  Term xpy = rts.make_term(BVAdd, x, y);
+  Term t = rts.make_term(BVMul, xpy, rts.make_term(BVSub, xpy, y));
+
+  Unroller u(rts);
+  vector<Term> expected;
+  for (size_t k = 0; k < 5; ++k) {
+    expected.push_back(u.at_time(t, k));
+  }
+  EXPECT_GT(u.num_cached_terms(), 0);
+
+  // with a small cache older time steps are dropped but the results
+  // stay the same
+  u.set_term_cache_limit(3);
+  EXPECT_LE(u.num_cached_terms(), 3);
+  for (size_t k = 0; k < 5; ++k) {
+    EXPECT_EQ(u.at_time(t, k), expected[k]);
+    EXPECT_LE(u.num_cached_terms(), 3);
+  }
+
+  u.set_term_cache_limit(0);
+  EXPECT_EQ(u.num_cached_terms(), 0);
+  EXPECT_EQ(u.at_time(t, 2), expected[2]);
+  EXPECT_EQ(u.num_cached_terms(), 0);
+}
+
+TEST_P(UnrollerUnitTests, UnrollWindow)
+{
+  RelationalTransitionSystem rts(s);
+  Term x = rts.make_statevar("x", bvsort);
+  Term y = rts.make_statevar("y", bvsort);
+  Term t = rts.make_term(BVMul, rts.make_term(BVAdd, x, y), rts.next(x));
+
+  // different time identifiers, the timed variables must be unique
+  Unroller u(rts, "@");
+  Unroller bounded(rts, "#");
+  bounded.set_window(2);
+  vector<Term> expected;
+  for (size_t k = 0; k < 10; ++k) {
+    u.at_time(t, k);
+    expected.push_back(bounded.at_time(t, k));
+  }
+  EXPECT_LT(bounded.num_cache_entries(), u.num_cache_entries());
+  EXPECT_LT(bounded.cache_memory(), u.cache_memory());
+
+  Statistics stats;
+  bounded.report_statistics(stats);
+  EXPECT_EQ(stats.get("unroller_evicted_time_steps"), 7);
+  EXPECT_EQ(stats.get("unroller_cache_bytes"), bounded.cache_memory());
+
+  // dropped time steps are rebuilt with the same variables
+  for (size_t k = 0; k < 10; ++k) {
+    EXPECT_EQ(bounded.at_time(t, k), expected[k]);
+  }
+  EXPECT_EQ(bounded.untime(expected[0]), t);
+  EXPECT_EQ(bounded.get_var_time(bounded.at_time(x, 0)), 0);
+}
+
+TEST_P(UnrollerUnitTests, InitConstants)
+{
+  FunctionalTransitionSystem fts(s);
+  counter_system(fts, fts.make_term(2, bvsort));
+  Term x = fts.named_terms().at("x");
+  Term y = fts.make_statevar("y", bvsort);
+  fts.assign_next(y, fts.make_term(BVAdd, y, x));
+
+  Unroller u(fts);
+  u.set_init_constants(4);
+  // y is not determined by init
+  EXPECT_EQ(u.num_init_constants(0), 1);
+  EXPECT_EQ(u.num_init_constants(4), 0);
+
+  // the counter goes 0, 1, 2, 0
+  EXPECT_EQ(u.at_time(x, 0), fts.make_term(0, bvsort));
+  EXPECT_EQ(u.at_time(x, 2), fts.make_term(2, bvsort));
+  EXPECT_EQ(u.at_time(fts.next(x), 2), fts.make_term(0, bvsort));
+  EXPECT_EQ(u.at_time(fts.make_term(BVAdd, y, x), 0), u.at_time(y, 0));
+  // past the depth, x is a timed variable again
+  Term x4 = u.at_time(x, 4);
+  EXPECT_TRUE(x4->is_symbolic_const());
+  EXPECT_EQ(u.untime(x4), x);
+}
+
+TEST_P(UnrollerUnitTests, FunctionalUnrollWindow)
+{
+  FunctionalTransitionSystem fts(s);
+  counter_system(fts, fts.make_term(10, bvsort));
+  Term x = fts.named_terms().at("x");
+  Term inp = fts.make_inputvar("inp", bvsort);
+  Term y = fts.make_statevar("y", bvsort);
+  fts.assign_next(y, fts.make_term(BVAdd, y, inp));
+  Term t = fts.make_term(BVAdd, x, y);
+
+  FunctionalUnroller u(fts, 3, "@");
+  FunctionalUnroller bounded(fts, 3, "#");
+  bounded.set_window(1);
+  vector<Term> expected;
+  TermVec constraints;
+  for (size_t k = 0; k < 10; ++k) {
+    u.at_time(t, k);
+    expected.push_back(bounded.at_time(t, k));
+    constraints.push_back(bounded.extra_constraints_at(k));
+  }
+  EXPECT_LT(bounded.num_cache_entries(), u.num_cache_entries());
+
+  // rebuilding gives the same terms and keeps the extra constraints
+  for (size_t k = 0; k < 10; ++k) {
+    EXPECT_EQ(bounded.at_time(t, k), expected[k]);
+    EXPECT_EQ(bounded.extra_constraints_at(k), constraints[k]);
+  }
+}
+
 TEST_P(UnrollerUnitTests, FunctionalUnroller)
 {
   FunctionalTransitionSystem fts(s);
@@ -270,6 +431,49 @@ TEST_P(UnrollerUnitTests, IntermittentFunctionalUnrolling)
   EXPECT_TRUE(r.is_unsat());
 }
 
+TEST_P(UnrollerUnitTests, FunctionalInlineLimits)
+{
+  FunctionalTransitionSystem fts(s);
+  counter_system(fts, fts.make_term(10, bvsort));
+  Term x = fts.named_terms().at("x");
+
+  FunctionalUnroller pure(fts, 0, "@");
+  FunctionalUnroller limited(fts, 0, "#");
+  size_t max_nodes = 12;
+  limited.set_inline_limits(max_nodes);
+
+  size_t k = 8;
+  size_t num_fresh = 0;
+  Term constraints = s->make_term(true);
+  for (size_t i = 1; i <= k; ++i) {
+    Term xi = limited.at_time(x, i);
+    UnorderedTermSet subterms;
+    TermVec to_visit({ xi });
+    while (to_visit.size()) {
+      Term t = to_visit.back();
+      to_visit.pop_back();
+      if (subterms.insert(t).second) {
+        for (auto c : t) {
+          to_visit.push_back(c);
+        }
+      }
+    }
+    EXPECT_LE(subterms.size(), max_nodes);
+    num_fresh += limited.fresh_symbols_at(i).size();
+    constraints =
+        s->make_term(And, constraints, limited.extra_constraints_at(i));
+  }
+  EXPECT_GT(num_fresh, 0);
+
+  // same values as the pure functional unrolling
+  s->assert_formula(constraints);
+  s->assert_formula(
+      s->make_term(Equal, pure.at_time(x, 0), limited.at_time(x, 0)));
+  s->assert_formula(
+      s->make_term(Distinct, pure.at_time(x, k), limited.at_time(x, k)));
+  EXPECT_TRUE(s->check_sat().is_unsat());
+}
+
 INSTANTIATE_TEST_SUITE_P(ParameterizedUnrollerUnitTests,
                          UnrollerUnitTests,
                          testing::ValuesIn(available_solver_enums()));
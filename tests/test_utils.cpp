@@ -1,18 +1,57 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include "core/fts.h"
 #include "core/rts.h"
 #include "core/unroller.h"
+#include "engines/bmc.h"
 #include "engines/kinduction.h"
 #include "gtest/gtest.h"
 #include "smt/available_solvers.h"
+#include "smt/solver_pool.h"
+#include "smt/solver_profiles.h"
 #include "tests/common_ts.h"
+#include "utils/benchmark.h"
+#include "utils/bit_parallel_simulator.h"
+#include "utils/cex_minimizer.h"
+#include "utils/concrete_simulator.h"
+#include "utils/core_minimizer.h"
+#include "utils/cube_and_conquer.h"
+#include "utils/design_stats.h"
+#include "utils/engine_selector.h"
+#include "utils/event_stream.h"
 #include "utils/exceptions.h"
+#include "utils/invariant_miner.h"
+#include "utils/lemma_bus.h"
+#include "utils/lemma_cache.h"
+#include "utils/lemma_exchange.h"
+#include "utils/literal_table.h"
+#include "utils/logger.h"
 #include "utils/make_provers.h"
+#include "utils/memory_profile.h"
+#include "utils/name_interner.h"
+#include "utils/partitioned_trans.h"
+#include "utils/pre_check.h"
+#include "utils/refinement_cache.h"
+#include "utils/solver_trace.h"
+#include "utils/statistics.h"
+#include "utils/ternary_simulator.h"
 #include "utils/term_analysis.h"
+#include "utils/term_hash_map.h"
+#include "utils/thread_placement.h"
 #include "utils/term_walkers.h"
+#include "utils/timeline.h"
 #include "utils/ts_analysis.h"
+#include "utils/ts_clone.h"
+#include "utils/ts_snapshot.h"
+#include "utils/verification_server.h"
 
 using namespace pono;
 using namespace smt;
@@ -134,7 +173,7 @@ TEST_P(UtilsEngineUnitTests, MakeProver)
   SolverEnum se = get<0>(GetParam());
   Engine eng = get<1>(GetParam());
 
-  if (eng == INTERP && se != MSAT) {
+  if ((eng == INTERP || eng == ISMC_ENGINE) && se != MSAT) {
     // skip interpolation unless the solver is MathSAT
     return;
   }
@@ -217,6 +256,1426 @@ TEST_P(UtilsUnitTests, RemoveItes)
   EXPECT_TRUE(r.is_unsat());
 }
 
+TEST_P(UtilsUnitTests, ModelIteRemover)
+{
+  Term a = s->make_symbol("a", boolsort);
+  Term x = s->make_symbol("x", bvsort);
+  Term y = s->make_symbol("y", bvsort);
+  Term one = s->make_term(1, bvsort);
+
+  Term xlty = s->make_term(BVUlt, x, y);
+  // nested ITEs in the selected branch, and a shared ITE
+  Term inner = s->make_term(Ite, a, x, y);
+  Term outer = s->make_term(Ite, xlty, inner, s->make_term(BVAdd, y, one));
+  Term t1 = s->make_term(BVAdd, outer, one);
+  Term t2 = s->make_term(BVMul, outer, inner);
+
+  s->assert_formula(a);
+  s->assert_formula(xlty);
+  Result r = s->check_sat();
+  ASSERT_TRUE(r.is_sat());
+
+  ModelIteRemover remover(s);
+  TermVec res = remover.remove_ites({ t1, t2 });
+  EXPECT_EQ(res[0], s->make_term(BVAdd, x, one));
+  EXPECT_EQ(res[1], s->make_term(BVMul, x, x));
+  // one evaluation per condition, shared by both terms
+  EXPECT_EQ(remover.num_evaluations(), 2);
+  EXPECT_EQ(remove_ites_under_model(s, { t1 })[0], res[0]);
+
+  // the memoized values are dropped for a new model
+  s->assert_formula(s->make_term(Not, a));
+  r = s->check_sat();
+  ASSERT_TRUE(r.is_sat());
+  remover.new_model();
+  EXPECT_EQ(remover.remove_ites(t1), s->make_term(BVAdd, y, one));
+  EXPECT_EQ(remover.num_evaluations(), 4);
+}
+
+TEST_P(UtilsUnitTests, CexMinimizer)
+{
+  s->set_opt("produce-models", "true");
+  s->set_opt("incremental", "true");
+  FunctionalTransitionSystem fts(s);
+  Term x = fts.make_statevar("x", bvsort);
+  Term en = fts.make_inputvar("en", boolsort);
+  Term junk = fts.make_inputvar("junk", bvsort);
+  fts.set_init(fts.make_term(Equal, x, fts.make_term(0, bvsort)));
+  fts.assign_next(
+      x,
+      fts.make_term(Ite,
+                    en,
+                    fts.make_term(BVAdd, x, fts.make_term(1, bvsort)),
+                    x));
+  Term prop = fts.make_term(BVUlt, x, fts.make_term(2, bvsort));
+
+  Property p(s, prop);
+  Bmc bmc(p, fts, s);
+  ASSERT_EQ(bmc.check_until(4), ProverResult::FALSE);
+  vector<UnorderedTermMap> cex;
+  ASSERT_TRUE(bmc.witness(cex));
+  ASSERT_EQ(cex.size(), 3);
+
+  CexMinimizer minimizer(fts, prop);
+  ASSERT_TRUE(minimizer.supported());
+  vector<UnorderedTermMap> min_cex = minimizer.minimize(cex);
+  ASSERT_EQ(min_cex.size(), 3);
+  // en is needed to count up, but not in the violating step
+  EXPECT_NE(min_cex[0].find(en), min_cex[0].end());
+  EXPECT_NE(min_cex[1].find(en), min_cex[1].end());
+  EXPECT_EQ(min_cex[2].find(en), min_cex[2].end());
+  for (const auto & frame : min_cex) {
+    EXPECT_EQ(frame.find(junk), frame.end());
+    EXPECT_NE(frame.find(x), frame.end());
+  }
+  EXPECT_EQ(minimizer.num_dropped(), 4);
+}
+
+TEST_P(UtilsUnitTests, CheckWitness)
+{
+  FunctionalTransitionSystem fts(s);
+  Term x = fts.make_statevar("x", bvsort);
+  Term en = fts.make_inputvar("en", boolsort);
+  fts.set_init(fts.make_term(Equal, x, fts.make_term(0, bvsort)));
+  fts.assign_next(
+      x,
+      fts.make_term(Ite,
+                    en,
+                    fts.make_term(BVAdd, x, fts.make_term(1, bvsort)),
+                    x));
+  Term prop = fts.make_term(BVUlt, x, fts.make_term(2, bvsort));
+
+  Property p(s, prop);
+  Bmc bmc(p, fts, s);
+  ASSERT_EQ(bmc.check_until(4), ProverResult::FALSE);
+  vector<UnorderedTermMap> cex;
+  ASSERT_TRUE(bmc.witness(cex));
+  ASSERT_EQ(cex.size(), 3);
+
+  WitnessCheckResult res = check_witness(fts, prop, cex);
+  EXPECT_TRUE(res.supported);
+  EXPECT_TRUE(res.valid);
+  EXPECT_TRUE(res.passed());
+
+  // the minimized witness leaves don't-care inputs out
+  CexMinimizer minimizer(fts, prop);
+  EXPECT_TRUE(check_witness(fts, prop, minimizer.minimize(cex)).valid);
+
+  // not a transition: x can't count up without en
+  vector<UnorderedTermMap> bad_cex = cex;
+  bad_cex[0][en] = s->make_term(false);
+  res = check_witness(fts, prop, bad_cex);
+  EXPECT_TRUE(res.supported);
+  EXPECT_FALSE(res.passed());
+  EXPECT_EQ(res.step, 1);
+
+  // not an initial state
+  bad_cex = cex;
+  bad_cex[0][x] = fts.make_term(1, bvsort);
+  res = check_witness(fts, prop, bad_cex);
+  EXPECT_FALSE(res.passed());
+  EXPECT_EQ(res.step, 0);
+
+  // the property still holds at the end
+  bad_cex = cex;
+  bad_cex.pop_back();
+  res = check_witness(fts, prop, bad_cex);
+  EXPECT_FALSE(res.passed());
+  EXPECT_EQ(res.step, 1);
+
+  // relational systems are not checked
+  RelationalTransitionSystem rts(s);
+  counter_system(rts, rts.make_term(10, bvsort));
+  res = check_witness(rts, prop, cex);
+  EXPECT_FALSE(res.supported);
+  EXPECT_TRUE(res.passed());
+}
+
+TEST_P(UtilsUnitTests, TernarySimulator)
+{
+  FunctionalTransitionSystem fts(s);
+  Term a = fts.make_statevar("a", boolsort);
+  Term i = fts.make_inputvar("i", boolsort);
+  Term max_val = fts.make_term(10, bvsort);
+  counter_system(fts, max_val);
+  Term x = fts.named_terms().at("x");
+  fts.assign_next(a, fts.make_term(And, a, i));
+
+  TernarySimulator sim(fts);
+  Term a_and_i = fts.make_term(And, a, i);
+
+  // a known 0 decides a conjunction
+  sim.set_bit(a, 0, false);
+  EXPECT_TRUE(sim.eval(a_and_i).is_false());
+  EXPECT_TRUE(sim.eval_next(fts.make_term(Not, a)).is_true());
+
+  // but a 1 does not
+  sim.set_bit(a, 0, true);
+  EXPECT_FALSE(sim.eval(a_and_i).is_known());
+  sim.set_bit(i, 0, true);
+  EXPECT_TRUE(sim.eval_next(a).is_true());
+
+  // counter steps from 5 to 6
+  sim.set_value(x, fts.make_term(5, bvsort));
+  Term x_eq_6 = fts.make_term(Equal, x, fts.make_term(6, bvsort));
+  EXPECT_TRUE(sim.eval(x_eq_6).is_false());
+  EXPECT_TRUE(sim.eval_next(x_eq_6).is_true());
+
+  // the low bit does not depend on the high bits with a bitwise and
+  sim.set_unknown(x, 7);
+  Term low = fts.make_term(Op(Extract, 0, 0),
+                           fts.make_term(BVAnd, x, fts.make_term(1, bvsort)));
+  TernaryValue v = sim.eval(low);
+  EXPECT_TRUE(v.is_known());
+  EXPECT_EQ(v.val, 1);
+  EXPECT_FALSE(sim.eval_next(x_eq_6).is_known());
+
+  sim.clear();
+  EXPECT_FALSE(sim.eval(a).is_known());
+}
+
+TEST_P(UtilsUnitTests, ConcreteSimulator)
+{
+  FunctionalTransitionSystem fts(s);
+  Term x = fts.make_statevar("x", bvsort);
+  Term y = fts.make_statevar("y", bvsort);
+  Term i = fts.make_inputvar("i", bvsort);
+  // y has no initial value and no update
+  fts.set_init(fts.make_term(Equal, x, fts.make_term(3, bvsort)));
+  fts.assign_next(x, fts.make_term(BVAdd, x, i));
+  fts.add_constraint(fts.make_term(BVUlt, i, fts.make_term(4, bvsort)));
+
+  ConcreteSimulator sim(fts, 1);
+  Term f = s->make_symbol("f", funsort);
+  EXPECT_FALSE(sim.supported(fts.make_term(Apply, f, x)));
+  uint32_t xid = sim.add_output(x);
+  uint32_t iid = sim.add_output(i);
+  uint32_t yid = sim.add_output(y);
+  uint32_t sdiv = sim.add_output(fts.make_term(BVSdiv, x, y));
+  uint32_t smod = sim.add_output(fts.make_term(BVSmod, x, y));
+
+  ASSERT_TRUE(sim.reset());
+  EXPECT_EQ(sim.value(xid), 3);
+  uint64_t x_val = 3;
+  for (size_t j = 0; j < 100; ++j) {
+    uint64_t i_val = sim.value(iid);
+    EXPECT_LT(i_val, 4);
+
+    int8_t sx = sim.value(xid), sy = sim.value(yid);
+    if (sy != 0 && !(sx == -128 && sy == -1)) {
+      EXPECT_EQ(int8_t(sim.value(sdiv)), sx / sy);
+      int8_t m = sx % sy;
+      if (m != 0 && ((m < 0) != (sy < 0))) {
+        m += sy;
+      }
+      EXPECT_EQ(int8_t(sim.value(smod)), m);
+    }
+
+    ASSERT_TRUE(sim.step());
+    x_val = (x_val + i_val) & 0xff;
+    EXPECT_EQ(sim.value(xid), x_val);
+  }
+  EXPECT_EQ(sim.num_cycles(), 101);
+
+  // rewinding repeats the trace
+  ASSERT_TRUE(sim.rewind());
+  EXPECT_EQ(sim.value(xid), 3);
+}
+
+TEST_P(UtilsUnitTests, SimEvaluateUnderValues)
+{
+  Term x = s->make_symbol("x", bvsort);
+  Term y = s->make_symbol("y", bvsort);
+  Term f = s->make_symbol("f", funsort);
+  unordered_map<Term, uint64_t> values({ { x, 200 }, { y, 100 } });
+  UnorderedTermSet failed;
+
+  Term sum = s->make_term(BVAdd, x, y);
+  Term lt = s->make_term(BVUlt, sum, x);
+  EXPECT_TRUE(sim_evaluate(lt, values, &failed));
+  EXPECT_EQ(values.at(sum), 44);
+  EXPECT_EQ(values.at(lt), 1);
+
+  // uninterpreted functions and variables without a value fail
+  Term app = s->make_term(And, lt, s->make_term(Apply, f, x));
+  EXPECT_FALSE(sim_evaluate(app, values, &failed));
+  EXPECT_TRUE(failed.find(app) != failed.end());
+  Term z = s->make_symbol("z", bvsort);
+  EXPECT_FALSE(sim_evaluate(s->make_term(BVMul, x, z), values));
+}
+
+TEST_P(UtilsUnitTests, BitParallelSimulator)
+{
+  FunctionalTransitionSystem fts(s);
+  Term x = fts.make_inputvar("x", bvsort);
+  Term y = fts.make_inputvar("y", bvsort);
+  Term c = fts.make_statevar("c", bvsort);
+  fts.set_init(fts.make_term(Equal, c, fts.make_term(0, bvsort)));
+  fts.assign_next(c, fts.make_term(BVAdd, c, fts.make_term(1, bvsort)));
+
+  BitParallelSimulator sim(fts, 128, 1);
+  EXPECT_EQ(sim.num_lanes(), 128);
+  uint32_t xid = sim.add_output(x);
+  uint32_t yid = sim.add_output(y);
+  uint32_t cid = sim.add_output(c);
+  vector<pair<PrimOp, uint32_t>> ops;
+  for (PrimOp op : { BVAdd, BVSub, BVMul, BVUdiv, BVShl, BVLshr, BVAshr,
+                     BVUlt, BVSle, BVUge, BVSgt }) {
+    ops.push_back({ op, sim.add_output(fts.make_term(op, x, y)) });
+  }
+  uint32_t neg = sim.add_output(fts.make_term(BVNeg, x));
+  Term cat = fts.make_term(Concat,
+                           fts.make_term(Op(Extract, 3, 0), x),
+                           fts.make_term(Op(Extract, 7, 4), y));
+  uint32_t ite = sim.add_output(
+      fts.make_term(Ite, fts.make_term(Equal, x, y), c, cat));
+
+  ASSERT_TRUE(sim.reset());
+  for (size_t j = 0; j < 4; ++j) {
+    for (size_t lane = 0; lane < sim.num_lanes(); ++lane) {
+      uint8_t xv = sim.value(xid, lane), yv = sim.value(yid, lane);
+      int8_t sx = xv, sy = yv;
+      EXPECT_EQ(sim.value(cid, lane), j);
+      for (const auto & op : ops) {
+        uint64_t expected;
+        switch (op.first) {
+          case BVAdd: expected = uint8_t(xv + yv); break;
+          case BVSub: expected = uint8_t(xv - yv); break;
+          case BVMul: expected = uint8_t(xv * yv); break;
+          case BVUdiv: expected = yv ? xv / yv : 0xff; break;
+          case BVShl: expected = yv < 8 ? uint8_t(xv << yv) : 0; break;
+          case BVLshr: expected = yv < 8 ? xv >> yv : 0; break;
+          case BVAshr: expected = uint8_t(sx >> (yv < 8 ? yv : 7)); break;
+          case BVUlt: expected = xv < yv; break;
+          case BVSle: expected = sx <= sy; break;
+          case BVUge: expected = xv >= yv; break;
+          case BVSgt: expected = sx > sy; break;
+          default: FAIL();
+        }
+        EXPECT_EQ(sim.value(op.second, lane), expected)
+            << smt::to_string(op.first) << " " << int(xv) << " " << int(yv);
+      }
+      EXPECT_EQ(sim.value(neg, lane), uint8_t(-xv));
+      uint64_t ite_val = xv == yv ? j : ((xv & 0xf) << 4) | (yv >> 4);
+      EXPECT_EQ(sim.value(ite, lane), ite_val);
+    }
+    ASSERT_TRUE(sim.step());
+  }
+  EXPECT_EQ(sim.num_cycles(), 5 * 128);
+}
+
+TEST_P(UtilsUnitTests, InvariantMiner)
+{
+  FunctionalTransitionSystem fts(s);
+  Term zero = fts.make_term(0, bvsort);
+  Term one = fts.make_term(1, bvsort);
+
+  // counts from 0 to 9
+  Term c = fts.make_statevar("c", bvsort);
+  fts.constrain_init(fts.make_term(Equal, c, zero));
+  fts.assign_next(c,
+                  fts.make_term(Ite,
+                                fts.make_term(Equal, c, fts.make_term(9, bvsort)),
+                                zero,
+                                fts.make_term(BVAdd, c, one)));
+
+  // one-hot token ring
+  Sort bv4 = s->make_sort(BV, 4);
+  Term t = fts.make_statevar("t", bv4);
+  fts.constrain_init(fts.make_term(Equal, t, fts.make_term(1, bv4)));
+  fts.assign_next(t,
+                  fts.make_term(Concat,
+                                fts.make_term(Op(Extract, 2, 0), t),
+                                fts.make_term(Op(Extract, 3, 3), t)));
+
+  // never true at the same time
+  Term p = fts.make_statevar("p", boolsort);
+  Term r = fts.make_statevar("r", boolsort);
+  fts.constrain_init(fts.make_term(Not, p));
+  fts.constrain_init(fts.make_term(Not, r));
+  fts.assign_next(p, fts.make_term(Equal, c, fts.make_term(4, bvsort)));
+  fts.assign_next(r, fts.make_term(Equal, c, fts.make_term(7, bvsort)));
+
+  // below 64 in the simulated cycles only
+  Term d = fts.make_statevar("d", bvsort);
+  fts.constrain_init(fts.make_term(Equal, d, zero));
+  fts.assign_next(d, fts.make_term(BVAdd, d, one));
+
+  InvariantMiner miner(fts, 2);
+  TermVec candidates = miner.mine();
+  EXPECT_GT(candidates.size(), 0);
+  TermVec invariants = miner.prune(candidates);
+  ASSERT_GT(invariants.size(), 0);
+  EXPECT_LT(invariants.size(), candidates.size());
+
+  Term inv = invariants[0];
+  for (size_t i = 1; i < invariants.size(); ++i) {
+    inv = fts.make_term(And, inv, invariants[i]);
+  }
+  EXPECT_TRUE(check_invar(fts, fts.make_term(true), inv));
+
+  // implied by the invariants
+  Term t_onehot = fts.make_term(
+      And,
+      fts.make_term(Distinct, t, fts.make_term(0, bv4)),
+      fts.make_term(Equal,
+                    fts.make_term(BVAnd,
+                                  t,
+                                  fts.make_term(BVSub, t, fts.make_term(1, bv4))),
+                    fts.make_term(0, bv4)));
+  for (const auto & expected :
+       { t_onehot,
+         fts.make_term(BVUle, c, fts.make_term(9, bvsort)),
+         fts.make_term(Not, fts.make_term(And, p, r)) }) {
+    s->push();
+    s->assert_formula(inv);
+    s->assert_formula(fts.make_term(Not, expected));
+    EXPECT_TRUE(s->check_sat().is_unsat());
+    s->pop();
+  }
+
+  // the range of d is not an invariant
+  s->push();
+  s->assert_formula(inv);
+  s->assert_formula(fts.make_term(BVUgt, d, fts.make_term(63, bvsort)));
+  EXPECT_TRUE(s->check_sat().is_sat());
+  s->pop();
+}
+
+TEST_P(UtilsUnitTests, MigrateInvariants)
+{
+  // counts from 0 to 9
+  auto counter = [](FunctionalTransitionSystem & fts, const Sort & sort) {
+    Term c = fts.make_statevar("c", sort);
+    fts.constrain_init(fts.make_term(Equal, c, fts.make_term(0, sort)));
+    fts.assign_next(
+        c,
+        fts.make_term(Ite,
+                      fts.make_term(Equal, c, fts.make_term(9, sort)),
+                      fts.make_term(0, sort),
+                      fts.make_term(BVAdd, c, fts.make_term(1, sort))));
+    return c;
+  };
+
+  FunctionalTransitionSystem old_fts(s);
+  Term c = counter(old_fts, bvsort);
+  Term p = old_fts.make_statevar("p", boolsort);
+  old_fts.constrain_init(old_fts.make_term(Not, p));
+  old_fts.assign_next(p, old_fts.make_term(false));
+  Term w = old_fts.make_statevar("w", boolsort);
+  old_fts.assign_next(w, w);
+
+  string cache = ::testing::TempDir() + "pono_migrate.cache";
+  Term true_ = old_fts.make_term(true);
+  Term c_le_9 = old_fts.make_term(BVUle, c, old_fts.make_term(9, bvsort));
+  Term c_eq_3 = old_fts.make_term(Equal, c, old_fts.make_term(3, bvsort));
+  EXPECT_EQ(write_lemma_cache(cache,
+                              old_fts,
+                              true_,
+                              { { c_le_9 },
+                                { c_eq_3 },
+                                { old_fts.make_term(Not, p) },
+                                { w, c_le_9 } }),
+            4);
+
+  // the next revision removes p, changes the sort of w and adds n
+  SmtSolver s2 = create_solver(GetParam());
+  FunctionalTransitionSystem new_fts(s2);
+  Sort bvsort2 = s2->make_sort(BV, 8);
+  Term c2 = counter(new_fts, bvsort2);
+  Term w2 = new_fts.make_statevar("w", bvsort2);
+  new_fts.assign_next(w2, w2);
+  Term n = new_fts.make_statevar("n", s2->make_sort(BOOL));
+  new_fts.assign_next(n, n);
+
+  vector<TermVec> clauses;
+  Term true2 = new_fts.make_term(true);
+  EXPECT_FALSE(read_lemma_cache(cache, new_fts, true2, clauses));
+  ASSERT_TRUE(read_lemma_cache_by_name(cache, new_fts, clauses));
+  // the clause over p is dropped, w is a bit-vector now
+  EXPECT_EQ(clauses.size(), 3);
+
+  // c = 3 is not an invariant
+  TermVec invars = migrate_invariants(new_fts, cache, 2);
+  ASSERT_EQ(invars.size(), 1);
+  EXPECT_EQ(invars[0],
+            new_fts.make_term(BVUle, c2, new_fts.make_term(9, bvsort2)));
+  EXPECT_TRUE(check_invar(new_fts, true2, invars[0]));
+  EXPECT_TRUE(migrate_invariants(new_fts, cache + ".missing").empty());
+  remove(cache.c_str());
+}
+
+TEST_P(UtilsUnitTests, PartitionedTrans)
+{
+  FunctionalTransitionSystem fts(s);
+  Term in = fts.make_inputvar("in", bvsort);
+  Term x = fts.make_statevar("x", bvsort);
+  Term y = fts.make_statevar("y", bvsort);
+  Term z = fts.make_statevar("z", bvsort);
+  Term w = fts.make_statevar("w", bvsort);
+  Term one = fts.make_term(1, bvsort);
+  fts.assign_next(x, fts.make_term(BVAdd, x, one));
+  fts.assign_next(y, fts.make_term(BVAdd, y, in));
+  fts.assign_next(z, fts.make_term(BVSub, x, one));
+  fts.assign_next(w, fts.make_term(BVAdd, w, in));
+  // w' is constrained, so its update is global
+  fts.add_constraint(fts.make_term(BVUle, w, fts.make_term(3, bvsort)));
+
+  PartitionedTrans pt(fts);
+  // x and z have the same support
+  ASSERT_EQ(pt.size(), 2);
+  vector<size_t> cone;
+  pt.cone({ x, z }, cone);
+  ASSERT_EQ(cone.size(), 1);
+  EXPECT_EQ(pt.statevars(cone[0]).size(), 2);
+  cone.clear();
+  pt.cone({ w }, cone);
+  EXPECT_TRUE(cone.empty());
+  cone.clear();
+  pt.cone({ x, y, w }, cone);
+  EXPECT_EQ(cone.size(), 2);
+
+  // same answer as trans for a query over y'
+  Term query = fts.make_term(Equal, fts.next(y), fts.make_term(5, bvsort));
+  cone.clear();
+  pt.cone({ y }, cone);
+  ASSERT_EQ(cone.size(), 1);
+  s->push();
+  s->assert_formula(pt.global());
+  s->assert_formula(pt.partition(cone[0]));
+  s->assert_formula(query);
+  s->assert_formula(fts.make_term(Equal, y, fts.make_term(4, bvsort)));
+  s->assert_formula(fts.make_term(BVUgt, in, one));
+  EXPECT_TRUE(s->check_sat().is_unsat());
+  s->pop();
+  s->push();
+  s->assert_formula(fts.trans());
+  s->assert_formula(query);
+  s->assert_formula(fts.make_term(Equal, y, fts.make_term(4, bvsort)));
+  s->assert_formula(fts.make_term(BVUgt, in, one));
+  EXPECT_TRUE(s->check_sat().is_unsat());
+  s->pop();
+}
+
+TEST_P(UtilsUnitTests, TsSnapshot)
+{
+  FunctionalTransitionSystem fts(s);
+  counter_system(fts, fts.make_term(10, bvsort));
+  Term x = fts.lookup("x");
+  Term in = fts.make_inputvar("in", bvsort);
+  Term y = fts.make_statevar("y", bvsort);
+  fts.assign_next(y, fts.make_term(BVAdd, y, in));
+  fts.add_invar(fts.make_term(BVUle, x, fts.make_term(10, bvsort)));
+  fts.constrain_inputs(fts.make_term(BVUlt, in, fts.make_term(3, bvsort)));
+  fts.name_term("sum", fts.make_term(BVAdd, x, y));
+  Term prop = fts.make_term(BVUlt, x, fts.make_term(11, bvsort));
+
+  string data = ts_snapshot(fts, { prop });
+  EXPECT_TRUE(ts_snapshot_is_functional(data.data(), data.size()));
+
+  // load in another solver
+  SmtSolver s2 = create_solver(GetParam());
+  FunctionalTransitionSystem loaded(s2);
+  TermVec props;
+  load_ts_snapshot(data.data(), data.size(), loaded, props);
+  ASSERT_EQ(props.size(), 1);
+  EXPECT_EQ(loaded.statevars().size(), fts.statevars().size());
+  EXPECT_EQ(loaded.inputvars().size(), fts.inputvars().size());
+  EXPECT_EQ(loaded.state_updates().size(), fts.state_updates().size());
+  EXPECT_EQ(loaded.constraints().size(), fts.constraints().size());
+  EXPECT_EQ(loaded.trans_conjuncts().size(), fts.trans_conjuncts().size());
+  EXPECT_EQ(loaded.named_terms().size(), fts.named_terms().size());
+  EXPECT_EQ(loaded.lookup("sum")->to_string(),
+            fts.lookup("sum")->to_string());
+  EXPECT_EQ(ts_snapshot(loaded, props).size(), data.size());
+
+  // only in an empty system of the same kind
+  EXPECT_THROW(load_ts_snapshot(data.data(), data.size(), loaded, props),
+               PonoException);
+  RelationalTransitionSystem rts(s2);
+  EXPECT_THROW(load_ts_snapshot(data.data(), data.size(), rts, props),
+               PonoException);
+  EXPECT_THROW(load_ts_snapshot(data.data(), data.size() - 1, rts, props),
+               PonoException);
+}
+
+TEST_P(UtilsUnitTests, TsCloner)
+{
+  FunctionalTransitionSystem fts(s);
+  counter_system(fts, fts.make_term(10, bvsort));
+  Term x = fts.lookup("x");
+  Term prop = fts.make_term(BVUlt, x, fts.make_term(11, bvsort));
+
+  vector<SmtSolver> solvers;
+  for (size_t i = 0; i < 3; ++i) {
+    solvers.push_back(create_solver(GetParam()));
+  }
+  {
+    TsCloner cloner(fts, { prop });
+    EXPECT_GT(cloner.snapshot_size(), 0);
+    cloner.clone(solvers, 2);
+    ASSERT_EQ(cloner.size(), solvers.size());
+    for (size_t i = 0; i < cloner.size(); ++i) {
+      EXPECT_EQ(cloner.ts(i).solver(), solvers[i]);
+      EXPECT_EQ(cloner.ts(i).statevars().size(), fts.statevars().size());
+      ASSERT_EQ(cloner.props(i).size(), 1);
+      EXPECT_EQ(cloner.props(i)[0]->to_string(), prop->to_string());
+    }
+
+    // the first translator to a solver gets the copied terms
+    TermTranslator tt = make_translator(fts, solvers[0]);
+    EXPECT_FALSE(tt.get_cache().empty());
+    EXPECT_EQ(tt.get_cache().at(prop), cloner.props(0)[0]);
+    EXPECT_TRUE(make_translator(fts, solvers[0]).get_cache().empty());
+  }
+  // the unused ones are dropped with the cloner
+  EXPECT_TRUE(make_translator(fts, solvers[1]).get_cache().empty());
+}
+
+TEST_P(UtilsUnitTests, CoreMinimizer)
+{
+  s->set_opt("incremental", "true");
+  s->set_opt("produce-unsat-assumptions", "true");
+  Term x = s->make_symbol("x", bvsort);
+  TermVec constraints({ s->make_term(Equal, x, s->make_term(5, bvsort)),
+                        s->make_term(BVUgt, x, s->make_term(7, bvsort)),
+                        s->make_term(BVUlt, x, s->make_term(100, bvsort)),
+                        s->make_term(Distinct, x, s->make_term(9, bvsort)) });
+  TermVec assumps;
+  for (size_t i = 0; i < constraints.size(); ++i) {
+    Term lbl = s->make_symbol("core_lbl_" + std::to_string(i), boolsort);
+    s->assert_formula(s->make_term(Implies, lbl, constraints[i]));
+    assumps.push_back(lbl);
+  }
+
+  CoreMinimizer minimizer(s);
+  TermVec core;
+  ASSERT_TRUE(minimizer.minimize(assumps, core));
+  EXPECT_FALSE(minimizer.timed_out());
+  // x = 5 and x > 7 is the only conflict
+  ASSERT_EQ(core.size(), 2);
+  EXPECT_EQ(core[0], assumps[0]);
+  EXPECT_EQ(core[1], assumps[1]);
+
+  // sat assumptions are returned as is
+  TermVec sat_assumps({ assumps[0], assumps[2], assumps[3] });
+  EXPECT_FALSE(minimizer.minimize(sat_assumps, core));
+  EXPECT_EQ(core, sat_assumps);
+}
+
+TEST_P(UtilsUnitTests, SplitUnsatCores)
+{
+  Term x = s->make_symbol("x", bvsort);
+  Term y = s->make_symbol("y", bvsort);
+  TermVec constraints({ s->make_term(Equal, x, s->make_term(5, bvsort)),
+                        s->make_term(BVUgt, x, s->make_term(7, bvsort)),
+                        s->make_term(Equal, y, s->make_term(1, bvsort)),
+                        s->make_term(Equal, y, s->make_term(2, bvsort)),
+                        s->make_term(Equal, x, y) });
+  Term formula = s->make_term(true);
+  TermVec lbls;
+  for (size_t i = 0; i < constraints.size(); ++i) {
+    Term lbl = s->make_symbol("split_lbl_" + std::to_string(i), boolsort);
+    formula = s->make_term(
+        And, formula, s->make_term(Implies, lbl, constraints[i]));
+    lbls.push_back(lbl);
+  }
+
+  // the first two groups are unsat on their own, the last one is not
+  vector<TermVec> groups({ { lbls[0], lbls[1] },
+                           { lbls[2], lbls[3], lbls[4] },
+                           { lbls[0], lbls[4] } });
+  for (size_t num_threads : { 1, 2, 4 }) {
+    UnorderedTermSet core;
+    EXPECT_EQ(split_unsat_cores(s, formula, groups, num_threads, 0, core), 2);
+    EXPECT_EQ(core.count(lbls[0]), 1);
+    EXPECT_EQ(core.count(lbls[1]), 1);
+    EXPECT_EQ(core.count(lbls[2]), 1);
+    EXPECT_EQ(core.count(lbls[3]), 1);
+  }
+
+  // a minimized core drops x = y from the second group
+  UnorderedTermSet core;
+  EXPECT_EQ(split_unsat_cores(s, formula, groups, 2, 1000, core), 2);
+  EXPECT_EQ(core.size(), 4);
+  EXPECT_EQ(core.count(lbls[4]), 0);
+}
+
+TEST_P(UtilsUnitTests, SolverPool)
+{
+  SolverPool pool(1);
+  SmtSolver s1 = pool.acquire(GetParam(), BMC);
+  SmtSolver s2 = pool.acquire(GetParam(), BMC);
+  EXPECT_NE(s1, s2);
+  Term b = s1->make_symbol("b", s1->make_sort(BOOL));
+  s1->assert_formula(s1->make_term(Not, b));
+  s1->assert_formula(b);
+  EXPECT_TRUE(s1->check_sat().is_unsat());
+
+  pool.release(s1);
+  pool.release(s2);  // only one idle solver is kept
+  EXPECT_THROW(pool.release(s2), PonoException);
+  EXPECT_EQ(pool.num_idle(), 1);
+
+  // a released solver comes back without its assertions
+  SmtSolver s3 = pool.acquire(GetParam(), BMC);
+  EXPECT_EQ(s3, s1);
+  EXPECT_TRUE(s3->check_sat().is_sat());
+  // but not for a reducer
+  SmtSolver s4 = pool.acquire(GetParam(), BMC, false, false, true);
+  EXPECT_NE(s4, s1);
+
+  SolverPoolStats stats = pool.stats();
+  EXPECT_EQ(stats.created, 3);
+  EXPECT_EQ(stats.reused, 1);
+  EXPECT_EQ(stats.released, 2);
+  EXPECT_EQ(stats.dropped, 1);
+}
+
+TEST_P(UtilsUnitTests, SolverProfiles)
+{
+  string filename = ::testing::TempDir() + "pono_solver_profiles.txt";
+  {
+    ofstream out(filename);
+    out << "# tuning\n"
+        << "* bmc opt-a 1\n"
+        << "[fast]\n"
+        << "* * opt-b 2  # any engine\n"
+        << "* reducer opt-c 3\n";
+  }
+  SolverEnum se = GetParam();
+
+  load_solver_profiles(filename);
+  EXPECT_EQ(solver_profile_options(se, "bmc"),
+            SolverOptions({ { "opt-a", "1" } }));
+  EXPECT_TRUE(solver_profile_options(se, "ic3ia").empty());
+
+  load_solver_profiles(filename, "fast");
+  EXPECT_EQ(solver_profile_options(se, "bmc"),
+            SolverOptions({ { "opt-b", "2" } }));
+  EXPECT_EQ(solver_profile_options(se, "reducer"),
+            SolverOptions({ { "opt-b", "2" }, { "opt-c", "3" } }));
+
+  EXPECT_THROW(load_solver_profiles(filename, "slow"), PonoException);
+  clear_solver_profiles();
+  EXPECT_TRUE(solver_profile_options(se, "bmc").empty());
+  remove(filename.c_str());
+}
+
+TEST_P(UtilsUnitTests, SolverTrace)
+{
+  solver_trace.set_output_file(::testing::TempDir() + "pono_solver_trace.json");
+  Term b = s->make_symbol("b", boolsort);
+  {
+    SOLVER_TRACE_SCOPE("test_trace");
+    SolverCallTimer timer(TRACE_CHECK_SAT_ASSUMING, 2);
+    Result r = s->check_sat_assuming({ b, s->make_term(Not, b) });
+    timer.done(r);
+    ASSERT_TRUE(r.is_unsat());
+  }
+  EXPECT_EQ(SolverTraceScope::current(), 0);
+
+  string json = solver_trace.to_json();
+  EXPECT_NE(json.find("\"call\": \"check_sat_assuming\", \"tag\": \"test_trace\""),
+            string::npos);
+  EXPECT_NE(json.find("\"unsat\": 1"), string::npos);
+  EXPECT_TRUE(solver_trace.dump());
+}
+
+TEST(TimelineTests, ChromeTraceSpans)
+{
+  timeline.set_output_file(::testing::TempDir() + "pono_timeline.json");
+  {
+    TIMELINE_SPAN("test_outer");
+    TIMELINE_SPAN("test_inner");
+  }
+  std::thread worker([]() { TIMELINE_SPAN("test_worker"); });
+  worker.join();
+
+  string json = timeline.to_json();
+  EXPECT_EQ(json.find("{\"displayTimeUnit\""), 0u);
+  EXPECT_NE(json.find("\"name\": \"test_outer\", \"ph\": \"X\""),
+            string::npos);
+  EXPECT_NE(json.find("\"name\": \"test_inner\""), string::npos);
+  // the worker gets its own track
+  size_t w = json.find("\"name\": \"test_worker\"");
+  ASSERT_NE(w, string::npos);
+  EXPECT_EQ(json.find("\"tid\": 1,", w), string::npos);
+  EXPECT_EQ(timeline.num_dropped(), 0u);
+  EXPECT_TRUE(timeline.dump());
+}
+
+TEST_P(UtilsUnitTests, JsonEventStream)
+{
+  string filename = ::testing::TempDir() + "pono_events.jsonl";
+  ASSERT_TRUE(event_stream.set_output_file(filename));
+
+  RelationalTransitionSystem rts(s);
+  counter_system(rts, rts.make_term(10, bvsort));
+  Term x = rts.named_terms().at("x");
+  Property p(s, rts.make_term(BVUle, x, rts.make_term(10, bvsort)));
+  Bmc bmc(p, rts, s);
+  ASSERT_EQ(bmc.check_until(3), ProverResult::UNKNOWN);
+
+  event_stream.emit(
+      JsonEvent("result").add_int("property", 0).add_string("file", "a\"b"),
+      false);
+  event_stream.close();
+  EXPECT_FALSE(event_stream.enabled());
+  // ignored once closed
+  event_stream.emit(JsonEvent("late"), false);
+
+  ifstream f(filename);
+  vector<string> lines;
+  string line;
+  while (getline(f, line)) {
+    lines.push_back(line);
+  }
+  // one progress event per bound, then the result
+  ASSERT_EQ(lines.size(), 5);
+  for (size_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(lines[i].find("{\"event\": \"progress\", \"time\": "), 0u);
+    EXPECT_NE(lines[i].find("\"engine\": \"" + to_string(BMC) + "\""),
+              string::npos);
+    EXPECT_NE(lines[i].find("\"bound\": " + std::to_string(i) + ","),
+              string::npos);
+    EXPECT_EQ(lines[i].back(), '}');
+  }
+  EXPECT_NE(lines[4].find("\"property\": 0, \"file\": \"a\\\"b\"}"),
+            string::npos);
+  EXPECT_EQ(event_stream.num_dropped(), 0u);
+}
+
+TEST(StatisticsTests, JsonEscapes)
+{
+  Statistics stats;
+  stats.set("a\"b\\c\nd\te\x01", 1);
+  EXPECT_NE(stats.to_json().find("\"a\\\"b\\\\c\\nd\\te\\u0001\": 1"),
+            string::npos);
+}
+
+TEST(MemoryProfileTests, PhasesAndSoftLimit)
+{
+  statistics_registry.set_output_file(::testing::TempDir()
+                                      + "pono_memory.json");
+  memory_profile.enable();
+  ASSERT_TRUE(memory_profile.enabled());
+
+  Budget b;
+  EXPECT_FALSE(b.over_soft_memory_limit());
+  b.set_soft_memory_limit(1);
+  EXPECT_TRUE(b.over_soft_memory_limit());
+  // only fires again once the memory grew
+  EXPECT_FALSE(b.over_soft_memory_limit());
+  {
+    MEMORY_PHASE("test_alloc");
+    // touch the pages so that they are resident
+    vector<char> block(64 << 20, 1);
+    EXPECT_GE(current_memory_kb(), 64u << 10);
+    EXPECT_TRUE(b.over_soft_memory_limit());
+  }
+
+  release_memory("test_alloc");
+
+  const Statistics & stats = memory_profile.statistics();
+  EXPECT_GT(stats.get("test_alloc_rss_kb"), 0);
+  EXPECT_GT(stats.get("test_alloc_retained_kb"), 0);
+  EXPECT_NE(stats.to_json().find("\"test_alloc_released_kb\""),
+            string::npos);
+  EXPECT_GE(stats.get("peak_rss_kb"), 64u << 10);
+  EXPECT_NE(stats.to_json().find("\"test_alloc_peak_growth_kb\""),
+            string::npos);
+}
+
+TEST(StatisticsTests, PrometheusMetrics)
+{
+  string filename = ::testing::TempDir() + "pono_metrics.prom";
+  std::remove(filename.c_str());
+  statistics_registry.set_metrics_file(filename, 3600);
+  ASSERT_TRUE(statistics_registry.enabled());
+
+  auto stats = make_shared<Statistics>();
+  stats->set("reached_k", 7);
+  stats->add_time("check-sat", 0.5);
+  statistics_registry.add("test \"engine\"", stats);
+  ASSERT_TRUE(statistics_registry.write_metrics());
+
+  auto read = [&filename]() {
+    ifstream f(filename);
+    stringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+  };
+  string text = read();
+  EXPECT_NE(text.find("# TYPE pono_rss_bytes gauge\npono_rss_bytes "),
+            string::npos);
+  EXPECT_NE(text.find("# TYPE pono_reached_k gauge\n"), string::npos);
+  // other tests may have registered engines as well
+  string sample = "pono_reached_k{engine=\"test \\\"engine\\\"\",id=\"";
+  size_t pos = text.find(sample);
+  ASSERT_NE(pos, string::npos);
+  EXPECT_EQ(text.substr(text.find('}', pos), 4), "} 7\n");
+  EXPECT_NE(text.find("pono_check_sat_seconds{"), string::npos);
+
+  // written a last time on stop, with the current values
+  stats->set("reached_k", 8);
+  statistics_registry.stop_metrics();
+  text = read();
+  pos = text.find(sample);
+  ASSERT_NE(pos, string::npos);
+  EXPECT_EQ(text.substr(text.find('}', pos), 4), "} 8\n");
+}
+
+TEST_P(UtilsUnitTests, SoftMemoryLimit)
+{
+  FunctionalTransitionSystem fts(s);
+  Term x = fts.make_statevar("x", bvsort);
+  fts.set_init(fts.make_term(Equal, x, fts.make_term(0, bvsort)));
+  fts.assign_next(x, fts.make_term(BVAdd, x, fts.make_term(1, bvsort)));
+  Term prop = fts.make_term(BVUlt, x, fts.make_term(6, bvsort));
+
+  // any process is above 1MB, so the caches are dropped after a step
+  PonoOptions opts;
+  opts.soft_mem_limit_ = 1;
+  Property p(s, prop);
+  Bmc bmc(p, fts, s, opts);
+  ASSERT_EQ(bmc.check_until(10), ProverResult::FALSE);
+  EXPECT_GE(bmc.statistics().get("soft_memory_reductions"), 1);
+  vector<UnorderedTermMap> cex;
+  ASSERT_TRUE(bmc.witness(cex));
+  EXPECT_EQ(cex.size(), 7);
+}
+
+TEST_P(UtilsUnitTests, RefinementCache)
+{
+  RelationalTransitionSystem rts(s);
+  Term x = rts.make_statevar("x", bvsort);
+  Term in = rts.make_inputvar("in", bvsort);
+  RelationalTransitionSystem other(s);
+  Term y = other.make_statevar("y", bvsort);
+
+  RefinementCache cache(s);
+  Term r1 = rts.make_term(BVUle, x, rts.next(x));
+  Term r2 = rts.make_term(Distinct, in, y);
+  cache.add(r1);
+  cache.add(r2);
+  cache.add(r1);
+  EXPECT_EQ(cache.size(), 2);
+
+  // r2 also has a variable of the other system
+  TermVec relevant = cache.relevant(rts);
+  ASSERT_EQ(relevant.size(), 1);
+  EXPECT_EQ(relevant[0], r1);
+  EXPECT_EQ(cache.relevant(other).size(), 0);
+}
+
+TEST_P(UtilsUnitTests, RefinementCacheOpTerms)
+{
+  FunctionalTransitionSystem fts(s);
+  Term x = fts.make_statevar("x", bvsort);
+  Term y = fts.make_statevar("y", bvsort);
+  Term prod = fts.make_term(BVMul, x, y);
+  fts.assign_next(x, fts.make_term(BVAdd, prod, y));
+  fts.assign_next(y, y);
+  // the system of another property, with the same state updates
+  FunctionalTransitionSystem other(fts);
+  other.add_constraint(fts.make_term(BVUle, x, y));
+
+  RefinementCache cache(s);
+  std::unordered_set<PrimOp> ops({ BVMul, BVUdiv });
+  UnorderedTermSet first;
+  EXPECT_FALSE(cache.op_terms(fts, ops, first));
+  ASSERT_EQ(first.size(), 1);
+  EXPECT_EQ(*first.begin(), prod);
+
+  UnorderedTermSet reused;
+  EXPECT_TRUE(cache.op_terms(other, ops, reused));
+  EXPECT_EQ(reused, first);
+
+  // other operators are walked again
+  UnorderedTermSet adds;
+  EXPECT_FALSE(cache.op_terms(fts, { BVAdd }, adds));
+  EXPECT_EQ(adds.size(), 1);
+}
+
+TEST_P(UtilsUnitTests, TermHashMap)
+{
+  // enough terms to grow past the inline slots several times
+  TermVec terms;
+  Term x = s->make_symbol("x", bvsort);
+  for (int64_t i = 0; i < 100; ++i) {
+    terms.push_back(s->make_term(BVAdd, x, s->make_term(i, bvsort)));
+  }
+
+  TermHashMap<size_t> m;
+  TermHashSet set;
+  for (size_t i = 0; i < terms.size(); ++i) {
+    m[terms[i]] = i;
+    EXPECT_TRUE(set.insert(terms[i]).second);
+  }
+  EXPECT_EQ(m.size(), terms.size());
+  EXPECT_EQ(set.size(), terms.size());
+
+  // a term rebuilt by the solver is found as well
+  Term t5 = s->make_term(BVAdd, x, s->make_term(5, bvsort));
+  ASSERT_NE(m.find(t5), m.end());
+  EXPECT_EQ(m.at(t5), 5u);
+  EXPECT_FALSE(set.insert(t5).second);
+
+  for (size_t i = 0; i < terms.size(); i += 2) {
+    EXPECT_EQ(m.erase(terms[i]), 1u);
+    EXPECT_EQ(set.erase(terms[i]), 1u);
+  }
+  EXPECT_EQ(m.size(), terms.size() / 2);
+  for (size_t i = 0; i < terms.size(); ++i) {
+    EXPECT_EQ(m.count(terms[i]), i % 2);
+    EXPECT_EQ(set.count(terms[i]), i % 2);
+  }
+
+  size_t n = 0;
+  for (const auto & elem : m) {
+    EXPECT_EQ(elem.first, terms.at(elem.second));
+    ++n;
+  }
+  EXPECT_EQ(n, m.size());
+
+  m.clear();
+  EXPECT_TRUE(m.empty());
+  EXPECT_EQ(m.find(terms[1]), m.end());
+}
+
+TEST_P(UtilsUnitTests, LiteralTable)
+{
+  Term x = s->make_symbol("x", bvsort);
+  Term y = s->make_symbol("y", bvsort);
+  Term a = s->make_term(BVUlt, x, y);
+  Term b = s->make_term(Equal, x, y);
+  Term c = s->make_term(Not, a);
+
+  LiteralTable table;
+  EXPECT_EQ(table.id(b), 0u);
+  LitVec abc = table.ids({ c, b, a, b });
+  // sorted, without duplicates
+  ASSERT_EQ(abc, LitVec({ 0, 1, 2 }));
+  EXPECT_EQ(table.size(), 3u);
+  EXPECT_EQ(table.term(1), c);
+  EXPECT_EQ(table.terms(abc), TermVec({ b, c, a }));
+
+  // a rebuilt literal has the same id
+  LitVec ab = table.ids({ s->make_term(BVUlt, x, y), b });
+  EXPECT_EQ(ab, LitVec({ 0, 2 }));
+  EXPECT_TRUE(std::includes(abc.begin(), abc.end(), ab.begin(), ab.end()));
+  EXPECT_EQ(table.size(), 3u);
+}
+
+TEST_P(UtilsUnitTests, EngineSelector)
+{
+  FunctionalTransitionSystem fts(s);
+  counter_system(fts, fts.make_term(10, bvsort));
+  Term x = fts.lookup("x");
+  Term in = fts.make_inputvar("in", bvsort);
+  Term y = fts.make_statevar("y", bvsort);
+  fts.assign_next(y, fts.make_term(BVMul, y, in));
+  Term prop = fts.make_term(BVUle, x, fts.make_term(10, bvsort));
+
+  TsFeatures f = extract_features(fts, prop);
+  EXPECT_EQ(f.statevars, 2);
+  EXPECT_EQ(f.inputs, 1);
+  EXPECT_EQ(f.state_bits, 16);
+  EXPECT_TRUE(f.functional);
+  EXPECT_FALSE(f.arrays);
+  EXPECT_EQ(f.max_width, 8);
+  EXPECT_EQ(f.mul_ops, 1);
+  EXPECT_GT(f.arith_ops, 0);
+  EXPECT_EQ(f.get("mul_ops"), 1);
+  EXPECT_THROW(f.get("latches"), PonoException);
+
+  // the built-in model always picks something
+  EngineSelector selector;
+  EngineChoice choice = selector.select(f);
+  EXPECT_FALSE(choice.rule.empty());
+
+  string model = ::testing::TempDir() + "pono_engine_model.txt";
+  {
+    ofstream out(model);
+    out << "# tuning\n"
+        << "mul_ops>=1 max_width<16 => ind btor --kind-dual-solver\n"
+        << "=> bmc btor  # fallback\n";
+  }
+  selector.load_model(model);
+  choice = selector.select(f);
+  EXPECT_EQ(choice.engine, KIND);
+  EXPECT_EQ(choice.solver, BTOR);
+  ASSERT_EQ(choice.options.size(), 1);
+  EXPECT_EQ(choice.options[0], "--kind-dual-solver");
+
+  f.mul_ops = 0;
+  EXPECT_EQ(selector.select(f).engine, BMC);
+  // the engines of the matching rules come first
+  vector<Engine> ranked = selector.rank_portfolio(f, { SIM, KIND, BMC }, 2);
+  EXPECT_EQ(ranked, vector<Engine>({ BMC, SIM }));
+
+  {
+    ofstream out(model);
+    out << "mul_ops>x => bmc btor\n";
+  }
+  EXPECT_THROW(selector.load_model(model), PonoException);
+  remove(model.c_str());
+}
+
+TEST_P(UtilsUnitTests, DesignStats)
+{
+  FunctionalTransitionSystem fts(s);
+  counter_system(fts, fts.make_term(10, bvsort));
+  Term x = fts.lookup("x");
+  Term in = fts.make_inputvar("in", bvsort);
+  Term y = fts.make_statevar("y", bvsort);
+  fts.assign_next(y, fts.make_term(BVMul, y, in));
+  Term z = fts.make_statevar("z", bvsort);
+  fts.assign_next(z, z);
+  TermVec props({ fts.make_term(BVUle, x, fts.make_term(10, bvsort)),
+                  fts.make_term(Distinct, y, z) });
+
+  DesignStats stats = compute_design_stats(fts, props, false);
+  EXPECT_EQ(stats.statevars.at(bvsort->to_string()), 3);
+  EXPECT_EQ(stats.inputvars.at(bvsort->to_string()), 1);
+  EXPECT_EQ(stats.arrays, 0);
+  EXPECT_EQ(stats.props, 2);
+  EXPECT_GT(stats.init_nodes, 0);
+  EXPECT_GT(stats.trans_nodes, stats.init_nodes);
+  EXPECT_EQ(stats.ops.at(to_string(BVMul)), 1);
+  EXPECT_TRUE(stats.cones.empty());
+
+  stats = compute_design_stats(fts, props, true);
+  ASSERT_EQ(stats.cones.size(), 2);
+  EXPECT_EQ(stats.cones[0].statevars, 1);
+  EXPECT_EQ(stats.cones[0].inputvars, 0);
+  EXPECT_EQ(stats.cones[1].statevars, 2);
+  EXPECT_EQ(stats.cones[1].inputvars, 1);
+
+  string json = stats.to_json();
+  EXPECT_NE(json.find("\"trans_nodes\": "), string::npos);
+  EXPECT_NE(json.find("\"cones\": [{"), string::npos);
+}
+
+TEST_P(UtilsUnitTests, VerificationServer)
+{
+  FunctionalTransitionSystem fts(s);
+  counter_system(fts, fts.make_term(10, bvsort));
+  Term x = fts.lookup("x");
+  Term holds = fts.make_term(BVUle, x, fts.make_term(10, bvsort));
+  Term fails = fts.make_term(BVUlt, x, fts.make_term(5, bvsort));
+
+  PonoOptions opts;
+  opts.smt_solver_ = GetParam();
+  opts.bound_ = 10;
+  auto check = [](PonoOptions o,
+                  Term & prop,
+                  TransitionSystem & ts,
+                  const SmtSolver & js,
+                  vector<UnorderedTermMap> & cex,
+                  bool & bounded) {
+    // each job has its own copy of the design
+    EXPECT_EQ(ts.solver(), js);
+    Property p(js, prop);
+    return make_prover(o.engine_, p, ts, js, o)->check_until(o.bound_);
+  };
+
+  mutex mtx;
+  vector<string> replies;
+  auto reply = [&](const string & line) {
+    lock_guard<mutex> lock(mtx);
+    replies.push_back(line);
+  };
+
+  VerificationServer server(opts, check, 2);
+  size_t handle = server.add_design(fts, { holds, fails });
+  EXPECT_EQ(server.num_props(handle), 2);
+
+  string h = std::to_string(handle);
+  EXPECT_TRUE(server.handle_request("check " + h + " 0 -e ind", reply));
+  EXPECT_TRUE(server.handle_request("check " + h + " 1", reply));
+  // unknown property and design
+  EXPECT_TRUE(server.handle_request("check " + h + " 2", reply));
+  EXPECT_TRUE(server.handle_request(
+      "check " + std::to_string(handle + 1) + " 0", reply));
+  EXPECT_TRUE(server.handle_request("wait", reply));
+  EXPECT_EQ(server.num_finished(), 2);
+
+  EXPECT_TRUE(server.handle_request("unload " + h, reply));
+  EXPECT_EQ(server.num_designs(), 0);
+  EXPECT_THROW(server.num_props(handle), PonoException);
+  EXPECT_TRUE(server.handle_request("memory", reply));
+
+  lock_guard<mutex> lock(mtx);
+  auto has = [&](const string & line) {
+    return find(replies.begin(), replies.end(), line) != replies.end();
+  };
+  EXPECT_TRUE(has("unloaded " + h));
+  EXPECT_EQ(replies.back().rfind("memory ", 0), 0);
+  // no design left
+  EXPECT_EQ(replies.back().substr(replies.back().size() - 2), " 0");
+  EXPECT_TRUE(has("queued 0"));
+  EXPECT_TRUE(has("queued 1"));
+  EXPECT_TRUE(has("result 0 unsat"));
+  EXPECT_TRUE(has("result 1 sat"));
+  EXPECT_TRUE(has("done"));
+  size_t num_errors = 0;
+  for (const auto & r : replies) {
+    num_errors += (r.rfind("error ", 0) == 0);
+  }
+  EXPECT_EQ(num_errors, 2);
+}
+
+TEST_P(UtilsUnitTests, Cubes)
+{
+  FunctionalTransitionSystem fts(s);
+  counter_system(fts, fts.make_term(10, bvsort));
+  Term x = fts.lookup("x");
+  Term b = fts.make_statevar("b", boolsort);
+  fts.assign_next(b, fts.make_term(Not, b));
+  Term prop = fts.make_term(BVUle, x, fts.make_term(10, bvsort));
+
+  // x is in the cone of the property and its own update
+  Cube vars = cube_variables(fts, prop, 4);
+  ASSERT_EQ(vars.size(), 2);
+  EXPECT_EQ(vars[0].var, x);
+  EXPECT_EQ(vars[0].bit, 7);
+  EXPECT_EQ(vars[1].var, b);
+  EXPECT_EQ(vars[1].bit, -1);
+
+  vector<Cube> cubes = make_cubes(vars, 3);
+  ASSERT_EQ(cubes.size(), 4);
+  EXPECT_EQ(cube_to_string(cubes[1]), "x@3[7]=1;b@3=0");
+  for (const auto & c : cubes) {
+    Cube parsed = parse_cube(fts, cube_to_string(c));
+    ASSERT_EQ(parsed.size(), 2);
+    for (size_t i = 0; i < 2; ++i) {
+      EXPECT_EQ(parsed[i].var, c[i].var);
+      EXPECT_EQ(parsed[i].bit, c[i].bit);
+      EXPECT_EQ(parsed[i].time, 3);
+      EXPECT_EQ(parsed[i].value, c[i].value);
+    }
+  }
+
+  // variables the system does not have are dropped
+  EXPECT_EQ(parse_cube(fts, "gone@1=1;b@2=1").size(), 1);
+  EXPECT_THROW(parse_cube(fts, "b@2=2"), PonoException);
+  EXPECT_THROW(parse_cube(fts, "b@2[0]=1"), PonoException);
+  EXPECT_THROW(parse_cube(fts, "x@2[8]=1"), PonoException);
+}
+
+/** Sends the requests to a server in this process */
+class LocalCubeServer : public CubeServer
+{
+ public:
+  LocalCubeServer(VerificationServer & server) : server_(server) {}
+
+  void send(const string & line) override
+  {
+    server_.handle_request(line, handler_);
+  }
+
+ protected:
+  VerificationServer & server_;
+};
+
+TEST_P(UtilsUnitTests, CubeAndConquer)
+{
+  FunctionalTransitionSystem fts(s);
+  counter_system(fts, fts.make_term(10, bvsort));
+  Term x = fts.lookup("x");
+
+  PonoOptions opts;
+  opts.smt_solver_ = GetParam();
+  opts.bound_ = 10;
+  opts.cube_snapshot_ = ::testing::TempDir() + "pono_cubes.snap";
+  auto check = [](PonoOptions o,
+                  Term & prop,
+                  TransitionSystem & ts,
+                  const SmtSolver & js,
+                  vector<UnorderedTermMap> & cex,
+                  bool & bounded) {
+    EXPECT_EQ(o.engine_, BMC);
+    EXPECT_FALSE(o.bmc_cube_.empty());
+    Property p(js, prop);
+    shared_ptr<Prover> prover = make_prover(o.engine_, p, ts, js, o);
+    ProverResult r = prover->check_until(o.bound_);
+    bounded = r == ProverResult::UNKNOWN && !prover->interrupted();
+    return r;
+  };
+  VerificationServer server(opts, check, 2);
+  vector<unique_ptr<CubeServer>> servers;
+  servers.emplace_back(new LocalCubeServer(server));
+  servers.emplace_back(new LocalCubeServer(server));
+
+  // split on the top bit of x at step 5, where x is 5
+  Term fails = fts.make_term(BVUlt, x, fts.make_term(5, bvsort));
+  CubeAndConquerResult res = cube_and_conquer(fts, fails, opts, servers);
+  EXPECT_EQ(res.result, ProverResult::FALSE);
+  EXPECT_EQ(res.num_cubes, 2);
+  EXPECT_EQ(res.cube, "x@5[7]=0");
+
+  Term holds = fts.make_term(BVUle, x, fts.make_term(10, bvsort));
+  res = cube_and_conquer(fts, holds, opts, servers);
+  EXPECT_EQ(res.result, ProverResult::UNKNOWN);
+  EXPECT_EQ(res.num_unsat, 2);
+  EXPECT_EQ(res.num_unknown, 0);
+
+  // cubes stopped by a budget are undecided, not unsat
+  PonoOptions limited = opts;
+  limited.solver_call_limit_ = 1;
+  VerificationServer limited_server(limited, check, 1);
+  vector<unique_ptr<CubeServer>> limited_servers;
+  limited_servers.emplace_back(new LocalCubeServer(limited_server));
+  res = cube_and_conquer(fts, holds, opts, limited_servers);
+  EXPECT_EQ(res.result, ProverResult::UNKNOWN);
+  EXPECT_EQ(res.num_unsat, 0);
+  EXPECT_EQ(res.num_unknown, 2);
+
+  // the designs are unloaded, the snapshot removed
+  server.wait();
+  EXPECT_EQ(server.num_designs(), 0);
+  EXPECT_FALSE(ifstream(opts.cube_snapshot_).good());
+}
+
+TEST_P(UtilsUnitTests, LemmaExchange)
+{
+  FunctionalTransitionSystem fts(s);
+  counter_system(fts, fts.make_term(10, bvsort));
+  Term x = fts.lookup("x");
+  Term b = fts.make_statevar("b", boolsort);
+  fts.assign_next(b, fts.make_term(true));
+  Term prop = fts.make_term(BVUle, x, fts.make_term(10, bvsort));
+
+  // the same system on another machine
+  SmtSolver s2 = create_solver(GetParam());
+  TermTranslator tt(s2);
+  FunctionalTransitionSystem fts2(fts, tt);
+  Term prop2 = tt.transfer_term(prop, BOOL);
+
+  LemmaCodec codec(fts, prop);
+  LemmaCodec codec2(fts2, prop2);
+  EXPECT_EQ(codec.hash(), codec2.hash());
+  EXPECT_NE(codec.hash(), LemmaCodec(fts, fts.make_term(Not, prop)).hash());
+
+  Term top_bit = fts.make_term(Equal,
+                               fts.make_term(Op(Extract, 7, 7), x),
+                               fts.make_term(0, s->make_sort(BV, 1)));
+  TermVec clause = { fts.make_term(Not, b),
+                     fts.make_term(Equal, x, fts.make_term(3, bvsort)),
+                     top_bit };
+  string wire;
+  ASSERT_TRUE(codec.encode(clause, wire));
+  TermVec decoded;
+  ASSERT_TRUE(codec2.decode(wire, decoded));
+  EXPECT_EQ(decoded.size(), 3);
+  string wire2;
+  ASSERT_TRUE(codec2.encode(decoded, wire2));
+  EXPECT_EQ(wire, wire2);
+
+  // predicates and malformed lemmas
+  EXPECT_FALSE(codec.encode({ prop }, wire2));
+  EXPECT_FALSE(codec2.decode("", decoded));
+  EXPECT_FALSE(codec2.decode("99", decoded));
+  EXPECT_FALSE(codec2.decode(wire + ",", decoded));
+
+  // the server drops duplicates and limits the rate
+  PonoOptions opts;
+  opts.lemma_exchange_rate_ = 2;
+  VerificationServer limited(opts, VerificationServer::Checker(), 1);
+  vector<string> replies;
+  auto reply = [&replies](const string & line) { replies.push_back(line); };
+  limited.handle_request("share h a b a c", reply);
+  limited.handle_request("fetch h 0", reply);
+  limited.handle_request("fetch h 2", reply);
+  limited.handle_request("fetch g 0", reply);
+  EXPECT_EQ(replies,
+            vector<string>({ "shared 2",
+                             "lemma a",
+                             "lemma b",
+                             "fetched 2",
+                             "fetched 2",
+                             "fetched 0" }));
+
+  // a lemma of one bus reaches the other one through the server
+  VerificationServer server(PonoOptions(), VerificationServer::Checker(), 1);
+  shared_ptr<LemmaBus> bus = make_shared<LemmaBus>(s);
+  shared_ptr<LemmaBus> bus2 = make_shared<LemmaBus>(s2);
+  LemmaExchangeClient client(
+      bus, fts, prop, unique_ptr<CubeServer>(new LocalCubeServer(server)));
+  LemmaExchangeClient client2(
+      bus2, fts2, prop2, unique_ptr<CubeServer>(new LocalCubeServer(server)));
+
+  TermTranslator to_bus(s);
+  int engine;
+  bus->publish_lemma(clause, to_bus, &engine);
+  bus->publish_lemma({ prop }, to_bus, &engine);
+  client.sync();
+  client2.sync();
+  EXPECT_EQ(client.statistics().get("lemmas_sent"), 1);
+  EXPECT_EQ(client.statistics().get("lemmas_not_encoded"), 1);
+  EXPECT_EQ(client2.statistics().get("lemmas_received"), 1);
+
+  TermTranslator from_bus2(s2);
+  size_t idx = 0;
+  vector<TermVec> out;
+  bus2->import_lemmas(idx, from_bus2, nullptr, out);
+  ASSERT_EQ(out.size(), 1);
+  ASSERT_TRUE(codec2.encode(out[0], wire2));
+  EXPECT_EQ(wire2, wire);
+
+  // nothing comes back to the sender
+  client.sync();
+  EXPECT_EQ(client.statistics().get("lemmas_received"), 0);
+  EXPECT_EQ(bus->num_lemmas(), 2);
+}
+
+TEST_P(UtilsUnitTests, PreCheck)
+{
+  FunctionalTransitionSystem fts(s);
+  Term max_val = fts.make_term(10, bvsort);
+  counter_system(fts, max_val);
+  Term x = fts.named_terms().at("x");
+  Term c = fts.make_statevar("c", boolsort);
+  fts.assign_next(c, fts.make_term(true));
+  fts.constrain_init(c);
+
+  PonoOptions opts;
+  opts.smt_solver_ = GetParam();
+  opts.bound_ = 20;
+
+  // a constant latch
+  PreCheckResult res = pre_check(fts, c, opts);
+  EXPECT_EQ(res.result, ProverResult::TRUE);
+  EXPECT_EQ(res.stage, "simplify");
+
+  // fails after one transition, even without simulation
+  opts.pre_check_cycles_ = 0;
+  Term shallow = fts.make_term(BVUlt, x, fts.make_term(1, bvsort));
+  res = pre_check(fts, shallow, opts);
+  EXPECT_EQ(res.result, ProverResult::FALSE);
+  EXPECT_EQ(res.stage, "bmc");
+  ASSERT_EQ(res.cex.size(), 2);
+  EXPECT_EQ(res.cex[1].at(x), fts.make_term(1, bvsort));
+
+  // too deep for bmc, but not for the simulation
+  Term deep = fts.make_term(BVUlt, x, fts.make_term(5, bvsort));
+  res = pre_check(fts, deep, opts);
+  EXPECT_EQ(res.result, ProverResult::UNKNOWN);
+  EXPECT_TRUE(res.stage.empty());
+
+  opts.pre_check_cycles_ = 64;
+  res = pre_check(fts, deep, opts);
+  EXPECT_EQ(res.result, ProverResult::FALSE);
+  EXPECT_EQ(res.stage, "sim");
+
+  // the true but not trivial property is left to the engine
+  Term safe = fts.make_term(BVUle, x, max_val);
+  res = pre_check(fts, safe, opts);
+  EXPECT_EQ(res.result, ProverResult::UNKNOWN);
+}
+
 INSTANTIATE_TEST_SUITE_P(ParameterizedUtilsUnitTests,
                          UtilsUnitTests,
                          testing::ValuesIn(available_solver_enums()));
@@ -227,4 +1686,212 @@ INSTANTIATE_TEST_SUITE_P(
     testing::Combine(testing::ValuesIn(available_solver_enums()),
                      testing::ValuesIn(all_engines())));
 
+TEST(LoggerTests, ComponentsAndRateLimit)
+{
+  Log l(1);
+  EXPECT_TRUE(l.enabled(1));
+  EXPECT_FALSE(l.enabled(2));
+
+  LogComponent c = Log::component("logger_test");
+  EXPECT_FALSE(l.enabled(c, 3));
+  Log::set_component_verbosities("logger_test=3");
+  EXPECT_TRUE(l.enabled(c, 3));
+  EXPECT_FALSE(l.enabled(c, 4));
+  EXPECT_THROW(Log::set_component_verbosities("logger_test"), PonoException);
+
+  l.set_buffer_size(1 << 12);
+  l.set_rate_limit(2);
+  for (size_t i = 0; i < 5; ++i) {
+    l.log(c, 1, "logger test message {}", i);
+  }
+  l.flush();
+  EXPECT_EQ(l.num_dropped(), 3u);
+}
+
+TEST(NameInternerTests, ScopeTrie)
+{
+  NameInterner interner;
+  NameId c = interner.intern("top.sub.c");
+  // the scopes are interned with the name
+  EXPECT_EQ(interner.size(), 4u);
+  EXPECT_EQ(interner.intern("top.sub.c"), c);
+  EXPECT_EQ(interner.name(c), "top.sub.c");
+  EXPECT_EQ(interner.leaf(c), "c");
+
+  NameId sub = interner.scope(c);
+  EXPECT_EQ(interner.name(sub), "top.sub");
+  EXPECT_EQ(interner.leaf(sub), "sub");
+  NameId top = interner.scope(sub);
+  EXPECT_EQ(interner.name(top), "top");
+  EXPECT_EQ(interner.scope(top), NameInterner::root);
+
+  NameId d = interner.intern("top.sub.d");
+  EXPECT_EQ(interner.scope(d), sub);
+  EXPECT_EQ(interner.size(), 5u);
+  EXPECT_EQ(interner.scope(interner.intern("x")), NameInterner::root);
+}
+
+TEST(BenchmarkTests, CsvRoundTrip)
+{
+  BenchRecord r;
+  r.file = "samples/counter.btor";
+  r.engine = "bmc";
+  r.solver = "btor";
+  r.rep = 2;
+  r.result = ProverResult::FALSE;
+  r.wall_time = 0.5;
+  r.peak_rss_kb = 1024;
+  r.solver_calls = 7;
+  r.threads = 4;
+  r.solver_time = 1.5;
+  r.lock_wait_time = 0.25;
+
+  stringstream ss;
+  write_bench_csv(ss, { r, r });
+  vector<BenchRecord> records = read_bench_csv(ss);
+  ASSERT_EQ(records.size(), 2);
+  EXPECT_EQ(records[0].file, r.file);
+  EXPECT_EQ(records[0].engine, r.engine);
+  EXPECT_EQ(records[0].rep, r.rep);
+  EXPECT_EQ(records[0].result, r.result);
+  EXPECT_EQ(records[0].wall_time, r.wall_time);
+  EXPECT_EQ(records[0].peak_rss_kb, r.peak_rss_kb);
+  EXPECT_EQ(records[0].solver_calls, r.solver_calls);
+  EXPECT_EQ(records[0].threads, r.threads);
+  EXPECT_EQ(records[0].solver_time, r.solver_time);
+  EXPECT_EQ(records[0].lock_wait_time, r.lock_wait_time);
+
+  // records without the threads columns
+  stringstream old("samples/counter.btor,bmc,btor,0,TRUE,0.5,1024,7\n");
+  records = read_bench_csv(old);
+  ASSERT_EQ(records.size(), 1);
+  EXPECT_EQ(records[0].threads, 1);
+
+  stringstream bad("samples/counter.btor,bmc,btor,0,TRUE\n");
+  EXPECT_THROW(read_bench_csv(bad), PonoException);
+}
+
+TEST(BenchmarkTests, CompareBenchmarks)
+{
+  auto make_runs = [](const vector<double> & times, ProverResult res) {
+    vector<BenchRecord> records;
+    for (size_t i = 0; i < times.size(); ++i) {
+      BenchRecord r;
+      r.file = "f.btor2";
+      r.engine = "bmc";
+      r.solver = "btor";
+      r.rep = i;
+      r.result = res;
+      r.wall_time = times[i];
+      records.push_back(r);
+    }
+    return records;
+  };
+
+  vector<BenchRecord> base = make_runs({ 1.0, 1.1, 0.9 }, TRUE);
+
+  // within noise
+  EXPECT_EQ(compare_benchmarks(base, make_runs({ 1.05, 0.95, 1.0 }, TRUE), 0.1)
+                .size(),
+            0);
+  // much slower with low variance
+  EXPECT_EQ(compare_benchmarks(base, make_runs({ 2.0, 2.1, 1.9 }, TRUE), 0.1)
+                .size(),
+            1);
+  // slower mean but too noisy to be significant
+  EXPECT_EQ(compare_benchmarks(base, make_runs({ 0.5, 3.0, 0.5 }, TRUE), 0.1)
+                .size(),
+            0);
+  // lost the result
+  EXPECT_EQ(compare_benchmarks(base, make_runs({ 1.0, 1.0, 1.0 }, UNKNOWN), 0.1)
+                .size(),
+            1);
+}
+
+TEST(BenchmarkTests, ScalingSummary)
+{
+  vector<BenchRecord> records;
+  for (unsigned int threads : { 1, 2, 4 }) {
+    for (double t : { 0.9, 1.1 }) {
+      BenchRecord r;
+      r.file = "f.btor2";
+      r.engine = "bmc-par";
+      r.solver = "btor";
+      r.threads = threads;
+      r.wall_time = t * (threads == 4 ? 0.5 : 1.0 / threads);
+      r.solver_time = r.wall_time * threads / 2;
+      r.lock_wait_time = 0.1 * threads;
+      records.push_back(r);
+    }
+  }
+
+  vector<ScalingPoint> points = scaling_summary(records);
+  ASSERT_EQ(points.size(), 3);
+  EXPECT_EQ(points[0].threads, 1);
+  EXPECT_DOUBLE_EQ(points[0].speedup, 1);
+  EXPECT_DOUBLE_EQ(points[1].speedup, 2);
+  EXPECT_DOUBLE_EQ(points[1].efficiency, 1);
+  // no gain from 2 to 4 threads
+  EXPECT_DOUBLE_EQ(points[2].speedup, 2);
+  EXPECT_DOUBLE_EQ(points[2].efficiency, 0.5);
+  EXPECT_DOUBLE_EQ(points[2].lock_wait_time, 0.4);
+  EXPECT_DOUBLE_EQ(points[2].busy_fraction, 0.5);
+
+  stringstream ss;
+  write_scaling_csv(ss, points);
+  string line;
+  getline(ss, line);
+  EXPECT_EQ(line.find("file,engine,solver,threads,"), 0);
+}
+
+TEST(ThreadPlacementTests, WorkerPlacement)
+{
+  const vector<vector<int>> & nodes = numa_cpus();
+  ASSERT_GE(nodes.size(), 1);
+  size_t num_cpus = 0;
+  for (const auto & cpus : nodes) {
+    ASSERT_GE(cpus.size(), 1);
+    num_cpus += cpus.size();
+  }
+
+  PonoOptions opts;
+  EXPECT_EQ(num_worker_threads(opts, 3), 3);
+  opts.threads_ = 5;
+  EXPECT_EQ(num_worker_threads(opts, 0), 5);
+  // nothing to place by default
+  EXPECT_EQ(worker_placement(opts, 0).node, -1);
+  EXPECT_EQ(place_worker_thread(opts, 0).node, -1);
+
+  // one CPU per worker
+  opts.pin_threads_ = true;
+  std::set<int> used;
+  for (size_t i = 0; i < num_cpus; ++i) {
+    WorkerPlacement p = worker_placement(opts, i);
+    ASSERT_GE(p.node, 0);
+    EXPECT_TRUE(used.insert(p.cpu).second);
+  }
+  EXPECT_EQ(worker_placement(opts, num_cpus).cpu,
+            worker_placement(opts, 0).cpu);
+
+  // the workers alternate between the nodes
+  opts.pin_threads_ = false;
+  opts.numa_ = true;
+  for (size_t i = 0; i < 2 * nodes.size(); ++i) {
+    WorkerPlacement p = worker_placement(opts, i);
+    EXPECT_EQ(static_cast<size_t>(p.node), i % nodes.size());
+    EXPECT_EQ(p.cpu, -1);
+  }
+
+  // the placement of a thread is in the statistics
+  opts.pin_threads_ = true;
+  Statistics stats;
+  std::thread t([&] { place_worker_thread(opts, 1, &stats, "worker_1"); });
+  t.join();
+#ifdef __linux__
+  WorkerPlacement p = worker_placement(opts, 1);
+  EXPECT_EQ(stats.get("worker_1_node"), static_cast<size_t>(p.node));
+  EXPECT_EQ(stats.get("worker_1_cpu"), static_cast<size_t>(p.cpu));
+#endif
+}
+
 }  // namespace pono_tests
@@ -105,6 +105,41 @@ TEST_P(WalkersUnitTests, SubTermCollectorBasic)
   }
 }
 
+TEST_P(WalkersUnitTests, TermSimplifier)
+{
+  Term zero = s->make_term(0, bvsort8);
+  Term cat = s->make_term(Concat, x, y);
+  TermSimplifier simp(s, { { z, zero } });
+
+  EXPECT_EQ(simp.simplify(s->make_term(Op(Extract, 7, 0), cat)), y);
+  EXPECT_EQ(simp.simplify(s->make_term(Op(Extract, 15, 8), cat)), x);
+  Term w = s->make_symbol("w", s->make_sort(BV, 16));
+  EXPECT_EQ(simp.simplify(s->make_term(
+                Concat,
+                s->make_term(Op(Extract, 15, 4), w),
+                s->make_term(Op(Extract, 3, 0), w))),
+            w);
+
+  Term zext = s->make_term(Op(Zero_Extend, 2),
+                           s->make_term(Op(Zero_Extend, 3), x));
+  EXPECT_EQ(simp.simplify(zext), s->make_term(Op(Zero_Extend, 5), x));
+  EXPECT_EQ(simp.simplify(s->make_term(Op(Extract, 12, 8), zext)),
+            s->make_term(0, s->make_sort(BV, 5)));
+
+  // z is replaced by zero
+  Term cond = s->make_term(Equal, z, zero);
+  EXPECT_EQ(simp.simplify(s->make_term(Ite, cond, x, y)), x);
+  EXPECT_EQ(simp.simplify(s->make_term(BVAdd, x, z)), x);
+  EXPECT_EQ(simp.simplify(s->make_term(
+                BVAnd,
+                x,
+                s->make_term(BVMul, s->make_term(2, bvsort8), s->make_term(3, bvsort8)))),
+            s->make_term(BVAnd, x, s->make_term(6, bvsort8)));
+  EXPECT_EQ(simp.simplify(s->make_term(
+                And, s->make_term(Not, cond), s->make_term(BVUlt, x, y))),
+            s->make_term(false));
+}
+
 INSTANTIATE_TEST_SUITE_P(ParameterizedWalkersUnitTests,
                          WalkersUnitTests,
                          testing::ValuesIn(available_solver_enums()));
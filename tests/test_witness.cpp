@@ -1,3 +1,6 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
 #include <utility>
 #include <vector>
 
@@ -9,6 +12,9 @@
 #include "engines/interpolantmc.h"
 #include "engines/kinduction.h"
 #include "gtest/gtest.h"
+#include "printers/vcd_stream_writer.h"
+#include "printers/witness_values.h"
+#include "printers/witness_writer.h"
 #include "smt/available_solvers.h"
 #include "tests/common_ts.h"
 #include "utils/exceptions.h"
@@ -89,6 +95,189 @@ TEST_P(WitnessUnitTests, ArraysDefaultSolver)
   ASSERT_EQ(witness[6][x], fts.make_term(10, bvsort4));
 }
 
+TEST_P(WitnessUnitTests, FilteredWitness)
+{
+  SmtSolver s = create_solver(GetParam());
+  s->set_opt("produce-models", "true");
+  s->set_opt("incremental", "true");
+  FunctionalTransitionSystem fts(s);
+  Sort bvsort8 = fts.make_sort(BV, 8);
+  counter_system(fts, fts.make_term(20, bvsort8));
+  Term x = fts.named_terms().at("x");
+  Term in = fts.make_inputvar("in", bvsort8);
+  Property prop(fts.solver(),
+                fts.make_term(BVUlt, x, fts.make_term(4, bvsort8)));
+
+  PonoOptions opts;
+  opts.witness_signals_ = "i*";
+  opts.set_witness_steps("2:");
+  Bmc bmc(prop, fts, s, opts);
+  ASSERT_EQ(bmc.check_until(5), FALSE);
+  vector<UnorderedTermMap> witness;
+  ASSERT_TRUE(bmc.witness(witness));
+  ASSERT_EQ(witness.size(), 5);
+  EXPECT_TRUE(witness[0].empty());
+  EXPECT_TRUE(witness[1].empty());
+  for (size_t i = 2; i < witness.size(); ++i) {
+    EXPECT_EQ(witness[i].size(), 1);
+    EXPECT_NE(witness[i].find(in), witness[i].end());
+  }
+}
+
+TEST_P(WitnessUnitTests, ValueBits)
+{
+  SmtSolver s = create_solver(GetParam());
+  Sort bvsort8 = s->make_sort(BV, 8);
+  Sort bvsort100 = s->make_sort(BV, 100);
+
+  Term five = s->make_term(5, bvsort8);
+  EXPECT_EQ(value_bits(five), "00000101");
+  EXPECT_EQ(value_decimal(five), "5");
+  EXPECT_EQ(value_bits(s->make_term(true)), "1");
+
+  // wider than 64 bits, through the string representation
+  string bits = "1" + string(98, '0') + "1";
+  Term wide = s->make_term(bits, bvsort100, 2);
+  EXPECT_EQ(value_bits(wide), bits);
+  EXPECT_EQ(value_decimal(wide), "633825300114114700748351602689");
+
+  WitnessValues values;
+  const string & cached = values.bits(five);
+  EXPECT_EQ(cached, "00000101");
+  EXPECT_EQ(&values.bits(five), &cached);
+}
+
+TEST_P(WitnessUnitTests, Table)
+{
+  SmtSolver s = create_solver(GetParam());
+  Sort bvsort8 = s->make_sort(BV, 8);
+  Sort bvsort100 = s->make_sort(BV, 100);
+  Term b = s->make_symbol("b", s->make_sort(BOOL));
+  Term x = s->make_symbol("x", bvsort8);
+  Term w = s->make_symbol("w", bvsort100);
+
+  string bits = "1" + string(98, '0') + "1";
+  vector<UnorderedTermMap> cex(2);
+  cex[0][x] = s->make_term(5, bvsort8);
+  cex[0][b] = s->make_term(true);
+  cex[1][x] = s->make_term(200, bvsort8);
+  cex[1][w] = s->make_term(bits, bvsort100, 2);
+
+  WitnessTable table;
+  witness_table(cex, table);
+  ASSERT_EQ(table.names, vector<string>({ "b", "w", "x" }));
+  EXPECT_EQ(table.widths, vector<uint32_t>({ 1, 100, 8 }));
+  EXPECT_EQ(table.offsets, vector<uint32_t>({ 0, 1, 3 }));
+  ASSERT_EQ(table.row_words, 4);
+  ASSERT_EQ(table.num_frames, 2);
+  EXPECT_EQ(table.known, vector<uint8_t>({ 1, 0, 1, 0, 1, 1 }));
+  EXPECT_EQ(table.values,
+            vector<uint64_t>({ 1, 0, 0, 5, 0, 1, uint64_t(1) << 35, 200 }));
+}
+
+TEST_P(WitnessUnitTests, VCDStream)
+{
+  SmtSolver s = create_solver(GetParam());
+  s->set_opt("produce-models", "true");
+  s->set_opt("incremental", "true");
+  FunctionalTransitionSystem fts(s);
+  Sort bvsort8 = fts.make_sort(BV, 8);
+  counter_system(fts, fts.make_term(20, bvsort8));
+  Term x = fts.named_terms().at("x");
+  Property prop(fts.solver(),
+                fts.make_term(BVUlt, x, fts.make_term(3, bvsort8)));
+
+  Bmc bmc(prop, fts, s);
+  ASSERT_EQ(bmc.check_until(5), FALSE);
+  vector<UnorderedTermMap> witness;
+  ASSERT_TRUE(bmc.witness(witness));
+
+  string filename = ::testing::TempDir() + "pono_vcd_stream.vcd";
+  {
+    VCDStreamWriter vcd(fts, filename);
+    for (const auto & frame : witness) {
+      vcd.add_frame(frame);
+    }
+    EXPECT_EQ(vcd.num_frames(), witness.size());
+    vcd.close();
+  }
+
+  ifstream in(filename);
+  ASSERT_TRUE(in.good());
+  stringstream content;
+  content << in.rdbuf();
+  string vcd = content.str();
+  size_t defs = vcd.find("$enddefinitions $end");
+  ASSERT_NE(defs, string::npos);
+  // x counts from 0 to 3, one change per frame
+  EXPECT_NE(vcd.find("b00000000 ", defs), string::npos);
+  EXPECT_NE(vcd.find("b00000011 ", defs), string::npos);
+  EXPECT_NE(vcd.find("#" + to_string(witness.size()), defs),
+            string::npos);
+  remove(filename.c_str());
+}
+
+TEST_P(WitnessUnitTests, BackgroundWriter)
+{
+  SmtSolver s = create_solver(GetParam());
+  s->set_opt("produce-models", "true");
+  s->set_opt("incremental", "true");
+  FunctionalTransitionSystem fts(s);
+  Sort bvsort8 = fts.make_sort(BV, 8);
+  counter_system(fts, fts.make_term(20, bvsort8));
+  Term x = fts.named_terms().at("x");
+  Property prop(fts.solver(),
+                fts.make_term(BVUlt, x, fts.make_term(3, bvsort8)));
+
+  Bmc bmc(prop, fts, s);
+  ASSERT_EQ(bmc.check_until(5), FALSE);
+  vector<UnorderedTermMap> witness;
+  ASSERT_TRUE(bmc.witness(witness));
+
+  string filename = ::testing::TempDir() + "pono_vcd_background.vcd";
+  ostringstream out;
+  {
+    // one job queued at a time, so post waits for the writer
+    WitnessWriter writer(1, out);
+    writer.print("sat\n");
+    VCDStreamWriter vcd(fts, filename);
+    for (const auto & frame : witness) {
+      vcd.add_frame(frame);
+    }
+    string header = vcd.close_body();
+    writer.post(
+        [filename, header]() { VCDStreamWriter::write_file(filename, header); });
+    for (size_t i = 0; i < 10; ++i) {
+      writer.print(to_string(i) + "\n");
+    }
+    writer.flush();
+    EXPECT_EQ(writer.num_jobs(), 12);
+
+    // errors are reported by the next flush
+    writer.post([]() { throw PonoException("failed"); });
+    writer.print("after\n");
+    EXPECT_THROW(writer.flush(), PonoException);
+    EXPECT_NO_THROW(writer.flush());
+  }
+  EXPECT_EQ(out.str(), "sat\n0\n1\n2\n3\n4\n5\n6\n7\n8\n9\nafter\n");
+
+  ifstream in(filename);
+  ASSERT_TRUE(in.good());
+  stringstream content;
+  content << in.rdbuf();
+  string vcd = content.str();
+  size_t defs = vcd.find("$enddefinitions $end");
+  ASSERT_NE(defs, string::npos);
+  EXPECT_NE(vcd.find("b00000011 ", defs), string::npos);
+  in.close();
+  remove(filename.c_str());
+
+  // without a queue the jobs run when posted
+  WitnessWriter sync_writer(0, out);
+  EXPECT_THROW(sync_writer.post([]() { throw PonoException("failed"); }),
+               PonoException);
+}
+
 INSTANTIATE_TEST_SUITE_P(
     ParameterizedWitnessUnitTests,
     WitnessUnitTests,
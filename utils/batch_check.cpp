@@ -0,0 +1,143 @@
+/*********************                                                        */
+/*! \file batch_check.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Checks many properties of one transition system in a single
+**        call, e.g. for the Python bindings. The cone-of-influence
+**        analysis is shared by the properties, and the results can be
+**        collected as they complete.
+**
+**/
+
+#include "utils/batch_check.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "core/prop.h"
+#include "utils/exceptions.h"
+#include "utils/incremental_coi.h"
+#include "utils/logger.h"
+#include "utils/portfolio.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+BatchChecker::BatchChecker(const TransitionSystem & ts,
+                           const TermVec & props,
+                           const vector<Engine> & engines,
+                           int k,
+                           const PonoOptions & opts)
+    : ts_(ts),
+      props_(props),
+      engines_(engines),
+      k_(k),
+      opts_(opts),
+      interrupted_(false),
+      done_(false)
+{
+  if (engines_.empty()) {
+    throw PonoException("Batch checking requires at least one engine");
+  }
+  results_.reserve(props_.size());
+  for (size_t idx = 0; idx < props_.size(); ++idx) {
+    results_.push_back({ idx, ProverResult::UNKNOWN, Engine::NONE });
+  }
+}
+
+void BatchChecker::run()
+{
+  try {
+    check();
+  }
+  catch (...) {
+    // don't leave next_result waiting
+    lock_guard<mutex> lock(queue_mutex_);
+    done_ = true;
+    queue_cv_.notify_all();
+    throw;
+  }
+  lock_guard<mutex> lock(queue_mutex_);
+  done_ = true;
+  queue_cv_.notify_all();
+}
+
+void BatchChecker::check()
+{
+  // one dependency graph for the cones of all the properties
+  unique_ptr<IncrementalConeOfInfluence> coi;
+  if (ts_.is_functional()) {
+    coi.reset(new IncrementalConeOfInfluence(ts_));
+  }
+
+  vector<size_t> order(props_.size());
+  for (size_t idx = 0; idx < order.size(); ++idx) {
+    order[idx] = idx;
+  }
+  if (coi) {
+    vector<size_t> cone_sizes;
+    cone_sizes.reserve(props_.size());
+    for (const auto & p : props_) {
+      cone_sizes.push_back(coi->cone_size({ p }));
+    }
+    stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return cone_sizes[a] < cone_sizes[b];
+    });
+  }
+
+  unordered_map<Term, size_t> first_idx;
+  for (size_t idx : order) {
+    BatchResult r = results_[idx];
+    auto it = first_idx.find(props_[idx]);
+    if (it != first_idx.end()) {
+      r.result = results_[it->second].result;
+      r.engine = results_[it->second].engine;
+    } else if (!interrupted_) {
+      first_idx[props_[idx]] = idx;
+      logger.log(1, "BatchChecker: checking property {}", idx);
+      PortfolioResult pr;
+      if (coi) {
+        TransitionSystem reduced = coi->reduced_ts({ props_[idx] });
+        Property p(reduced.solver(), props_[idx]);
+        pr = run_portfolio(engines_, p, reduced, k_, opts_);
+      } else {
+        Property p(ts_.solver(), props_[idx]);
+        pr = run_portfolio(engines_, p, ts_, k_, opts_);
+      }
+      r.result = pr.result;
+      r.engine = pr.engine;
+    }
+    report(r);
+  }
+}
+
+bool BatchChecker::next_result(BatchResult & out)
+{
+  unique_lock<mutex> lock(queue_mutex_);
+  queue_cv_.wait(lock, [this] { return !queue_.empty() || done_; });
+  if (queue_.empty()) {
+    return false;
+  }
+  out = queue_.front();
+  queue_.pop_front();
+  return true;
+}
+
+void BatchChecker::report(const BatchResult & r)
+{
+  lock_guard<mutex> lock(queue_mutex_);
+  results_[r.idx] = r;
+  queue_.push_back(r);
+  queue_cv_.notify_all();
+}
+
+}  // namespace pono
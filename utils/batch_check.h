@@ -0,0 +1,100 @@
+/*********************                                                        */
+/*! \file batch_check.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Checks many properties of one transition system in a single
+**        call, e.g. for the Python bindings. The cone-of-influence
+**        analysis is shared by the properties, and the results can be
+**        collected as they complete.
+**
+**/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "core/ts.h"
+#include "engines/prover.h"
+
+namespace pono {
+
+struct BatchResult
+{
+  size_t idx;  ///< the index of the property
+  ProverResult result;
+  Engine engine;  ///< the engine that decided it (NONE if unknown)
+};
+
+class BatchChecker
+{
+ public:
+  /** @param ts the transition system, which must not be modified (or its
+   *         solver used) until run returns
+   *  @param props the properties, terms of ts
+   *  @param engines the engines raced on each property (see run_portfolio)
+   *  @param k the bound passed to check_until
+   *  @param opts the options passed to each engine
+   *  @throws PonoException if there are no engines
+   */
+  BatchChecker(const TransitionSystem & ts,
+               const smt::TermVec & props,
+               const std::vector<Engine> & engines,
+               int k,
+               const PonoOptions & opts = PonoOptions());
+
+  /** Checks the properties one after the other, the smallest cones first
+   *  (for functional systems), and returns when all are reported.
+   *  Each property is checked on the system reduced to its cone, from
+   *  one dependency graph of the system. Syntactically identical
+   *  properties are only checked once.
+   */
+  void run();
+
+  /** Waits for the next result of run
+   *  Can be called from another thread than run.
+   *  @param out set to the result
+   *  @return false once run has returned (or thrown) and every result
+   *          it reported has been returned
+   */
+  bool next_result(BatchResult & out);
+
+  /** Asks run to stop: the properties that are not started yet are
+   *  reported as unknown. The property being checked is finished.
+   */
+  void interrupt() { interrupted_ = true; }
+
+  /** @return the results of run, by property (UNKNOWN until reported) */
+  const std::vector<BatchResult> & results() const { return results_; }
+
+ protected:
+  void check();
+  void report(const BatchResult & r);
+
+  const TransitionSystem & ts_;
+  smt::TermVec props_;
+  std::vector<Engine> engines_;
+  int k_;
+  PonoOptions opts_;
+
+  std::vector<BatchResult> results_;
+  std::atomic<bool> interrupted_;
+
+  std::mutex queue_mutex_;
+  std::condition_variable queue_cv_;
+  std::deque<BatchResult> queue_;  ///< reported, not returned yet
+  bool done_;  ///< run has returned
+};
+
+}  // namespace pono
@@ -0,0 +1,412 @@
+/*********************                                                        */
+/*! \file benchmark.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Utilities for benchmarking the engines (see bench/pono_bench.cpp).
+**        Runs one engine on one file, reads and writes the measurements
+**        as CSV or JSON, compares measurements against a baseline and
+**        computes how the parallel features scale with the threads.
+**
+**/
+
+#include "utils/benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <sstream>
+#include <tuple>
+
+#include "core/fts.h"
+#include "core/prop.h"
+#include "core/rts.h"
+#include "frontends/btor2_encoder.h"
+#include "frontends/smv_encoder.h"
+#include "frontends/vmt_encoder.h"
+#include "modifiers/prop_monitor.h"
+#include "smt/available_solvers.h"
+#include "utils/exceptions.h"
+#include "utils/make_provers.h"
+#include "utils/portfolio.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+static string file_extension(const string & filename)
+{
+  size_t pos = filename.find_last_of(".");
+  return pos == string::npos ? "" : filename.substr(pos + 1);
+}
+
+bool is_benchmark_file(const string & filename)
+{
+  string ext = file_extension(filename);
+  return ext == "btor2" || ext == "btor" || ext == "smv" || ext == "vmt";
+}
+
+BenchRecord run_benchmark(const string & filename,
+                          Engine e,
+                          SolverEnum se,
+                          PonoOptions opts)
+{
+  BenchRecord rec;
+  rec.file = filename;
+  rec.engine = to_string(e);
+  rec.solver = smt::to_string(se);
+
+  auto begin = chrono::steady_clock::now();
+
+  opts.engine_ = e;
+  opts.smt_solver_ = se;
+  SmtSolver s = create_solver_for(se, e, false);
+
+  string ext = file_extension(filename);
+  unique_ptr<TransitionSystem> ts;
+  TermVec propvec;
+  if (ext == "btor2" || ext == "btor") {
+    ts.reset(new FunctionalTransitionSystem(s));
+    BTOR2Encoder btor_enc(filename, *ts);
+    propvec = btor_enc.propvec();
+  } else if (ext == "smv") {
+    ts.reset(new RelationalTransitionSystem(s));
+    SMVEncoder smv_enc(filename, *ts);
+    propvec = smv_enc.propvec();
+  } else if (ext == "vmt") {
+    ts.reset(new RelationalTransitionSystem(s));
+    VMTEncoder vmt_enc(filename, *ts);
+    propvec = vmt_enc.propvec();
+  } else {
+    throw PonoException("Unrecognized file extension " + ext + " for file "
+                        + filename);
+  }
+
+  if (!propvec.size()) {
+    throw PonoException("No properties in file " + filename);
+  }
+
+  Term prop = propvec[0];
+  if (!ts->only_curr(prop)) {
+    prop = add_prop_monitor(*ts, prop);
+  }
+  Property p(ts->solver(), prop);
+
+  vector<shared_ptr<Prover>> provers;
+  if (opts.portfolio_) {
+    rec.engine = "portfolio";
+    PortfolioResult pr = run_portfolio(
+        default_portfolio_engines(), p, *ts, opts.bound_, opts);
+    rec.result = pr.result;
+    provers = pr.provers;
+  } else {
+    shared_ptr<Prover> prover = make_prover(e, p, *ts, s, opts);
+    // HACK MSAT_IC3IA does not support check_until
+    rec.result = (e == MSAT_IC3IA) ? prover->prove()
+                                   : prover->check_until(opts.bound_);
+    provers.push_back(prover);
+  }
+
+  rec.wall_time =
+      chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+  for (const auto & prover : provers) {
+    const Statistics & stats = prover->statistics();
+    rec.solver_calls += prover->budget().num_solver_calls();
+    rec.solver_time += stats.get_time("check_sat_time")
+                       + stats.get_time("check_sat_assuming_time")
+                       + stats.get_time("frame_solver_time")
+                       + stats.get_time("sat_solve_time");
+    rec.lock_wait_time += stats.get_time("lock_wait_time");
+  }
+  return rec;
+}
+
+static ProverResult to_prover_result(const string & s)
+{
+  if (s == "TRUE") {
+    return ProverResult::TRUE;
+  } else if (s == "FALSE") {
+    return ProverResult::FALSE;
+  } else if (s == "UNKNOWN") {
+    return ProverResult::UNKNOWN;
+  } else if (s == "ERROR") {
+    return ProverResult::ERROR;
+  }
+  throw PonoException("Unknown result in benchmark CSV: " + s);
+}
+
+void write_bench_csv(ostream & out,
+                     const vector<BenchRecord> & records,
+                     bool header)
+{
+  if (header) {
+    out << "file,engine,solver,rep,result,wall_time,peak_rss_kb,solver_calls,"
+        << "threads,solver_time,lock_wait_time" << endl;
+  }
+  for (const auto & r : records) {
+    // file names with commas are not supported
+    out << r.file << "," << r.engine << "," << r.solver << "," << r.rep << ","
+        << to_string(r.result) << "," << r.wall_time << "," << r.peak_rss_kb
+        << "," << r.solver_calls << "," << r.threads << "," << r.solver_time
+        << "," << r.lock_wait_time << endl;
+  }
+}
+
+vector<BenchRecord> read_bench_csv(istream & in)
+{
+  vector<BenchRecord> records;
+  string line;
+  size_t lineno = 0;
+  while (getline(in, line)) {
+    ++lineno;
+    if (line.empty() || line.rfind("file,", 0) == 0) {
+      // skip the header
+      continue;
+    }
+
+    vector<string> fields;
+    stringstream ss(line);
+    string field;
+    while (getline(ss, field, ',')) {
+      fields.push_back(field);
+    }
+    // 8 fields in the records written before the threads were added
+    if (fields.size() != 8 && fields.size() != 11) {
+      throw PonoException("Malformed benchmark CSV at line "
+                          + std::to_string(lineno));
+    }
+
+    BenchRecord r;
+    r.file = fields[0];
+    r.engine = fields[1];
+    r.solver = fields[2];
+    try {
+      r.rep = stoul(fields[3]);
+      r.result = to_prover_result(fields[4]);
+      r.wall_time = stod(fields[5]);
+      r.peak_rss_kb = stoul(fields[6]);
+      r.solver_calls = stoul(fields[7]);
+      if (fields.size() == 11) {
+        r.threads = stoul(fields[8]);
+        r.solver_time = stod(fields[9]);
+        r.lock_wait_time = stod(fields[10]);
+      }
+    }
+    catch (std::logic_error & e) {
+      throw PonoException("Malformed benchmark CSV at line "
+                          + std::to_string(lineno));
+    }
+    records.push_back(r);
+  }
+  return records;
+}
+
+string bench_to_json(const vector<BenchRecord> & records)
+{
+  ostringstream out;
+  out << "[";
+  for (size_t i = 0; i < records.size(); ++i) {
+    const BenchRecord & r = records[i];
+    out << (i ? ",\n " : "") << "{\"file\": \"" << r.file << "\", "
+        << "\"engine\": \"" << r.engine << "\", "
+        << "\"solver\": \"" << r.solver << "\", "
+        << "\"rep\": " << r.rep << ", "
+        << "\"result\": \"" << to_string(r.result) << "\", "
+        << "\"wall_time\": " << r.wall_time << ", "
+        << "\"peak_rss_kb\": " << r.peak_rss_kb << ", "
+        << "\"solver_calls\": " << r.solver_calls << ", "
+        << "\"threads\": " << r.threads << ", "
+        << "\"solver_time\": " << r.solver_time << ", "
+        << "\"lock_wait_time\": " << r.lock_wait_time << "}";
+  }
+  out << "]" << endl;
+  return out.str();
+}
+
+namespace {
+
+typedef tuple<string, string, string, unsigned int> BenchKey;
+
+struct BenchSummary
+{
+  vector<double> times;
+  bool decided = false;  ///< some run returned TRUE or FALSE
+};
+
+map<BenchKey, BenchSummary> summarize(const vector<BenchRecord> & records)
+{
+  map<BenchKey, BenchSummary> res;
+  for (const auto & r : records) {
+    BenchSummary & s = res[BenchKey(r.file, r.engine, r.solver, r.threads)];
+    s.times.push_back(r.wall_time);
+    s.decided |= (r.result == ProverResult::TRUE
+                  || r.result == ProverResult::FALSE);
+  }
+  return res;
+}
+
+double mean(const vector<double> & v)
+{
+  double sum = 0;
+  for (double x : v) {
+    sum += x;
+  }
+  return sum / v.size();
+}
+
+double variance(const vector<double> & v, double m)
+{
+  if (v.size() < 2) {
+    return 0;
+  }
+  double sum = 0;
+  for (double x : v) {
+    sum += (x - m) * (x - m);
+  }
+  return sum / (v.size() - 1);
+}
+
+/** one-sided 95% critical value of Student's t distribution */
+double t_critical(double df)
+{
+  static const double table[] = { 6.314, 2.920, 2.353, 2.132, 2.015, 1.943,
+                                  1.895, 1.860, 1.833, 1.812, 1.796, 1.782,
+                                  1.771, 1.761, 1.753, 1.746, 1.740, 1.734,
+                                  1.729, 1.725, 1.721, 1.717, 1.714, 1.711,
+                                  1.708, 1.706, 1.703, 1.701, 1.699, 1.697 };
+  if (df < 1) {
+    return table[0];
+  } else if (df > 30) {
+    return 1.645;
+  }
+  // round down for a conservative value
+  return table[static_cast<size_t>(df) - 1];
+}
+
+}  // namespace
+
+vector<BenchRegression> compare_benchmarks(
+    const vector<BenchRecord> & baseline,
+    const vector<BenchRecord> & current,
+    double threshold,
+    double min_time)
+{
+  vector<BenchRegression> res;
+  map<BenchKey, BenchSummary> base = summarize(baseline);
+  map<BenchKey, BenchSummary> cur = summarize(current);
+
+  for (const auto & elem : cur) {
+    auto it = base.find(elem.first);
+    if (it == base.end()) {
+      continue;
+    }
+    const BenchSummary & b = it->second;
+    const BenchSummary & c = elem.second;
+
+    BenchRegression reg;
+    std::tie(reg.file, reg.engine, reg.solver, reg.threads) = elem.first;
+    reg.baseline_mean = mean(b.times);
+    reg.current_mean = mean(c.times);
+
+    if (b.decided && !c.decided) {
+      reg.reason = "no longer decides the property";
+      res.push_back(reg);
+      continue;
+    }
+
+    double diff = reg.current_mean - reg.baseline_mean;
+    if (reg.current_mean < min_time
+        || diff <= threshold * std::max(reg.baseline_mean, min_time)) {
+      continue;
+    }
+
+    size_t nb = b.times.size();
+    size_t nc = c.times.size();
+    if (nb > 1 && nc > 1) {
+      // Welch's t-test, the variances are not assumed to be equal
+      double vb = variance(b.times, reg.baseline_mean) / nb;
+      double vc = variance(c.times, reg.current_mean) / nc;
+      if (vb + vc > 0) {
+        double t = diff / sqrt(vb + vc);
+        double df = (vb + vc) * (vb + vc)
+                    / (vb * vb / (nb - 1) + vc * vc / (nc - 1));
+        if (t < t_critical(df)) {
+          continue;
+        }
+      }
+    }
+
+    ostringstream reason;
+    reason << "mean wall time " << reg.baseline_mean << "s -> "
+           << reg.current_mean << "s";
+    reg.reason = reason.str();
+    res.push_back(reg);
+  }
+  return res;
+}
+
+vector<ScalingPoint> scaling_summary(const vector<BenchRecord> & records)
+{
+  struct Runs
+  {
+    vector<double> times;
+    double lock_wait_time = 0;
+    double solver_time = 0;
+  };
+  map<BenchKey, Runs> runs;
+  for (const auto & r : records) {
+    Runs & rs = runs[BenchKey(r.file, r.engine, r.solver, r.threads)];
+    rs.times.push_back(r.wall_time);
+    rs.lock_wait_time += r.lock_wait_time;
+    rs.solver_time += r.solver_time;
+  }
+
+  vector<ScalingPoint> res;
+  // the keys of a configuration are consecutive, fewest threads first
+  double base_time = 0;
+  unsigned int base_threads = 0;
+  for (const auto & elem : runs) {
+    ScalingPoint sp;
+    std::tie(sp.file, sp.engine, sp.solver, sp.threads) = elem.first;
+    const Runs & rs = elem.second;
+    size_t n = rs.times.size();
+    sp.mean_time = mean(rs.times);
+    sp.lock_wait_time = rs.lock_wait_time / n;
+    sp.busy_fraction =
+        sp.mean_time > 0
+            ? rs.solver_time / n / (sp.threads * sp.mean_time)
+            : 0;
+
+    if (!res.size() || res.back().file != sp.file
+        || res.back().engine != sp.engine || res.back().solver != sp.solver) {
+      base_time = sp.mean_time;
+      base_threads = sp.threads;
+    }
+    sp.speedup = sp.mean_time > 0 ? base_time / sp.mean_time : 1;
+    sp.efficiency = sp.speedup * base_threads / sp.threads;
+    res.push_back(sp);
+  }
+  return res;
+}
+
+void write_scaling_csv(ostream & out, const vector<ScalingPoint> & points)
+{
+  out << "file,engine,solver,threads,mean_time,speedup,efficiency,"
+      << "lock_wait_time,busy_fraction" << endl;
+  for (const auto & sp : points) {
+    out << sp.file << "," << sp.engine << "," << sp.solver << ","
+        << sp.threads << "," << sp.mean_time << "," << sp.speedup << ","
+        << sp.efficiency << "," << sp.lock_wait_time << ","
+        << sp.busy_fraction << endl;
+  }
+}
+
+}  // namespace pono
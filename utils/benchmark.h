@@ -0,0 +1,140 @@
+/*********************                                                        */
+/*! \file benchmark.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Utilities for benchmarking the engines (see bench/pono_bench.cpp).
+**        Runs one engine on one file, reads and writes the measurements
+**        as CSV or JSON, compares measurements against a baseline and
+**        computes how the parallel features scale with the threads.
+**
+**/
+
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "core/proverresult.h"
+#include "options/options.h"
+#include "smt-switch/smt.h"
+
+namespace pono {
+
+/** One measured run of an engine on a file */
+struct BenchRecord
+{
+  std::string file;
+  std::string engine;
+  std::string solver;
+  size_t rep = 0;  ///< repetition number, starting at 0
+  ProverResult result = ProverResult::UNKNOWN;
+  double wall_time = 0;     ///< seconds, including parsing
+  size_t peak_rss_kb = 0;   ///< peak resident memory of the run
+  size_t solver_calls = 0;  ///< solver queries made by the prover
+  unsigned int threads = 1;  ///< threads of the parallel feature measured
+  double solver_time = 0;     ///< seconds in solver queries, summed over
+                              ///< the threads
+  double lock_wait_time = 0;  ///< seconds spent waiting for contended locks
+};
+
+/** @return true iff the file extension is supported by run_benchmark */
+bool is_benchmark_file(const std::string & filename);
+
+/** Parse a file and check its first property with a single engine
+ *  (or the default portfolio if opts.portfolio_ is set)
+ *  Does not fill in peak_rss_kb, which requires running in a separate
+ *  process (see bench/pono_bench.cpp), nor threads.
+ *  @param filename a btor2, smv or vmt file
+ *  @param e the engine
+ *  @param se the solver
+ *  @param opts the options, the bound is opts.bound_
+ *  @return the measurements
+ */
+BenchRecord run_benchmark(const std::string & filename,
+                          Engine e,
+                          smt::SolverEnum se,
+                          PonoOptions opts);
+
+/** Write records as CSV with a header line */
+void write_bench_csv(std::ostream & out,
+                     const std::vector<BenchRecord> & records,
+                     bool header = true);
+
+/** Read records written by write_bench_csv
+ *  Also accepts the records written before the threads, solver_time and
+ *  lock_wait_time columns were added.
+ *  @throws PonoException on a malformed line
+ */
+std::vector<BenchRecord> read_bench_csv(std::istream & in);
+
+/** @return the records as a JSON array of objects */
+std::string bench_to_json(const std::vector<BenchRecord> & records);
+
+/** A configuration that is slower than (or lost a result of) the baseline */
+struct BenchRegression
+{
+  std::string file;
+  std::string engine;
+  std::string solver;
+  unsigned int threads;
+  double baseline_mean;  ///< mean wall time in the baseline
+  double current_mean;   ///< mean wall time in the current run
+  std::string reason;
+};
+
+/** Compare the runs of each (file, engine, solver, threads) against a
+ *  baseline
+ *  A configuration regressed if
+ *    - it decided the property in the baseline but not anymore, or
+ *    - its mean wall time grew by more than threshold (relative) and
+ *      Welch's t-test rejects equal means at the 95% level
+ *      (with a single run on either side only the threshold is used)
+ *  Configurations missing from either side are ignored.
+ *  @param baseline the stored measurements
+ *  @param current the new measurements
+ *  @param threshold the relative slowdown to report, e.g. 0.1 for 10%
+ *  @param min_time wall times below this (seconds) are considered noise
+ *  @return the regressions
+ */
+std::vector<BenchRegression> compare_benchmarks(
+    const std::vector<BenchRecord> & baseline,
+    const std::vector<BenchRecord> & current,
+    double threshold,
+    double min_time = 0.05);
+
+/** How a parallel feature scales on a file at a number of threads */
+struct ScalingPoint
+{
+  std::string file;
+  std::string engine;  ///< the parallel feature
+  std::string solver;
+  unsigned int threads;
+  double mean_time;       ///< mean wall time
+  double speedup;         ///< of the fewest threads measured over this one
+  double efficiency;      ///< speedup over the ratio of the threads, 1
+                          ///< is linear
+  double lock_wait_time;  ///< mean seconds waiting for contended locks
+  double busy_fraction;   ///< solver time per thread over the wall time
+};
+
+/** Compute the scaling curves of the runs of each (file, engine, solver)
+ *  with different numbers of threads
+ *  @param records the runs, several per thread count are averaged
+ *  @return a point per (file, engine, solver, threads) in that order
+ */
+std::vector<ScalingPoint> scaling_summary(
+    const std::vector<BenchRecord> & records);
+
+/** Write scaling points as CSV with a header line */
+void write_scaling_csv(std::ostream & out,
+                       const std::vector<ScalingPoint> & points);
+
+}  // namespace pono
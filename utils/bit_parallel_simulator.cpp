@@ -0,0 +1,499 @@
+/*********************                                                        */
+/*! \file bit_parallel_simulator.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Bit-parallel random simulation of a functional transition system.
+**        Simulates a multiple of 64 independent traces at once. Each bit
+**        of a value is stored as a plane with one bit per trace, so the
+**        bitwise operators, adders and comparators evaluate all traces
+**        with word operations. Multiplication, division and remainder
+**        fall back to the scalar operations, one trace at a time.
+**
+**/
+
+#include "utils/bit_parallel_simulator.h"
+
+#include <algorithm>
+
+#include "assert.h"
+#include "utils/exceptions.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+static bool any(const vector<uint64_t> & lanes)
+{
+  for (auto l : lanes) {
+    if (l) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static size_t count(const vector<uint64_t> & lanes)
+{
+  size_t n = 0;
+  for (auto l : lanes) {
+    n += __builtin_popcountll(l);
+  }
+  return n;
+}
+
+BitParallelSimulator::BitParallelSimulator(const TransitionSystem & ts,
+                                           size_t lanes,
+                                           unsigned int seed)
+    : ConcreteSimulator(ts, seed), words_(lanes / 64)
+{
+  if (!lanes || lanes % 64) {
+    throw PonoException(
+        "Bit-parallel simulation requires a positive multiple of 64 traces");
+  }
+  alive_.assign(words_, 0);
+  // the largest width is 64
+  tmp0_.resize(64 * words_);
+  tmp1_.resize(64 * words_);
+  tmp2_.resize(64 * words_);
+  extend_planes();
+}
+
+bool BitParallelSimulator::reset()
+{
+  extend_planes();
+  trace_rng_ = rng_;
+
+  vector<uint64_t> pending(words_, ~uint64_t(0));
+  vector<uint64_t> ok(words_);
+  for (size_t i = 0; i < max_tries && any(pending); ++i) {
+    // only the pending traces get new values, so recomputing the others
+    // gives the same result
+    randomize_lanes(init_random_, pending);
+    randomize_lanes(inputs_, pending);
+
+    size_t pos = 0;
+    for (const auto & def : init_defs_) {
+      run_lanes(init_prog_, pos, def.end);
+      pos = def.end;
+      copy_n(plane(def.expr, 0), widths_[def.expr] * words_, plane(def.var, 0));
+    }
+    run_lanes(init_prog_, pos, init_prog_.instrs.size());
+    run_lanes(cycle_prog_, 0, cycle_prog_.instrs.size());
+
+    holds(true, ok);
+    for (size_t k = 0; k < words_; ++k) {
+      pending[k] &= ~ok[k];
+    }
+  }
+
+  for (size_t k = 0; k < words_; ++k) {
+    alive_[k] = ~pending[k];
+  }
+  num_cycles_ += count(alive_);
+  return any(alive_);
+}
+
+bool BitParallelSimulator::step()
+{
+  next_planes_.clear();
+  for (const auto & u : updates_) {
+    const uint64_t * p = plane(u.second, 0);
+    next_planes_.insert(next_planes_.end(), p, p + widths_[u.second] * words_);
+  }
+  const uint64_t * next = next_planes_.data();
+  for (const auto & u : updates_) {
+    size_t n = widths_[u.first] * words_;
+    copy_n(next, n, plane(u.first, 0));
+    next += n;
+  }
+
+  vector<uint64_t> pending = alive_;
+  vector<uint64_t> ok(words_);
+  for (size_t i = 0; i < max_tries && any(pending); ++i) {
+    randomize_lanes(cycle_random_, pending);
+    run_lanes(cycle_prog_, 0, cycle_prog_.instrs.size());
+
+    holds(false, ok);
+    for (size_t k = 0; k < words_; ++k) {
+      pending[k] &= ~ok[k];
+    }
+  }
+
+  for (size_t k = 0; k < words_; ++k) {
+    alive_[k] &= ~pending[k];
+  }
+  num_cycles_ += count(alive_);
+  return any(alive_);
+}
+
+uint64_t BitParallelSimulator::value(uint32_t id, size_t lane) const
+{
+  assert(lane < num_lanes());
+  size_t k = lane / 64, j = lane % 64;
+  uint64_t v = 0;
+  for (uint32_t b = 0; b < widths_[id]; ++b) {
+    v |= ((plane(id, b)[k] >> j) & 1) << b;
+  }
+  return v;
+}
+
+size_t BitParallelSimulator::find_lane(uint32_t id) const
+{
+  const uint64_t * p = plane(id, 0);
+  for (size_t k = 0; k < words_; ++k) {
+    uint64_t hit = p[k] & alive_[k];
+    if (hit) {
+      return k * 64 + __builtin_ctzll(hit);
+    }
+  }
+  return num_lanes();
+}
+
+void BitParallelSimulator::extend_planes()
+{
+  for (size_t s = offsets_.size(); s < values_.size(); ++s) {
+    offsets_.push_back(planes_.size());
+    planes_.resize(planes_.size() + widths_[s] * words_);
+    // the scalar value is only set for constants
+    for (uint32_t b = 0; b < widths_[s]; ++b) {
+      uint64_t bit = ((values_[s] >> b) & 1) ? ~uint64_t(0) : 0;
+      fill_n(plane(s, b), words_, bit);
+    }
+  }
+}
+
+void BitParallelSimulator::run_lanes(const SimProgram & prog,
+                                     size_t begin,
+                                     size_t end)
+{
+  const uint32_t * all_args = prog.args.data();
+  for (size_t pc = begin; pc < end; ++pc) {
+    const SimInstr & in = prog.instrs[pc];
+    apply_lanes(in, all_args + in.args_begin);
+  }
+}
+
+void BitParallelSimulator::apply_lanes(const SimInstr & in,
+                                       const uint32_t * args)
+{
+  const size_t W = words_;
+  const uint32_t w = in.width;
+  const uint32_t aw = in.arg_width;
+  const uint64_t ones = ~uint64_t(0);
+  uint64_t * d = plane(in.dst, 0);
+  auto arg = [&](uint32_t i) -> const uint64_t * { return plane(args[i], 0); };
+
+  switch (in.op) {
+    case Not:
+    case BVNot: {
+      const uint64_t * a = arg(0);
+      for (size_t k = 0; k < w * W; ++k) {
+        d[k] = ~a[k];
+      }
+      return;
+    }
+    case And:
+    case BVAnd:
+    case Or:
+    case BVOr:
+    case Xor:
+    case BVXor: {
+      copy_n(arg(0), w * W, d);
+      for (uint32_t i = 1; i < in.num_args; ++i) {
+        const uint64_t * a = arg(i);
+        if (in.op == And || in.op == BVAnd) {
+          for (size_t k = 0; k < w * W; ++k) {
+            d[k] &= a[k];
+          }
+        } else if (in.op == Or || in.op == BVOr) {
+          for (size_t k = 0; k < w * W; ++k) {
+            d[k] |= a[k];
+          }
+        } else {
+          for (size_t k = 0; k < w * W; ++k) {
+            d[k] ^= a[k];
+          }
+        }
+      }
+      return;
+    }
+    case BVNand:
+    case BVNor:
+    case BVXnor: {
+      const uint64_t * a = arg(0);
+      const uint64_t * b = arg(1);
+      for (size_t k = 0; k < w * W; ++k) {
+        uint64_t r = in.op == BVNand  ? a[k] & b[k]
+                     : in.op == BVNor ? a[k] | b[k]
+                                      : a[k] ^ b[k];
+        d[k] = ~r;
+      }
+      return;
+    }
+    case Implies: {
+      const uint64_t * a = arg(0);
+      const uint64_t * b = arg(1);
+      for (size_t k = 0; k < W; ++k) {
+        d[k] = ~a[k] | b[k];
+      }
+      return;
+    }
+    case Ite: {
+      const uint64_t * c = arg(0);
+      const uint64_t * t = arg(1);
+      const uint64_t * e = arg(2);
+      for (uint32_t b = 0; b < w; ++b) {
+        for (size_t k = 0; k < W; ++k) {
+          d[b * W + k] = (c[k] & t[b * W + k]) | (~c[k] & e[b * W + k]);
+        }
+      }
+      return;
+    }
+    case Equal:
+    case BVComp:
+    case Distinct: {
+      // Distinct is pairwise, Equal is chained
+      fill_n(d, W, ones);
+      for (uint32_t i = 0; i < in.num_args; ++i) {
+        for (uint32_t j = i + 1; j < in.num_args; ++j) {
+          if (in.op != Distinct && i) {
+            break;
+          }
+          const uint64_t * a = arg(i);
+          const uint64_t * b = arg(j);
+          for (size_t k = 0; k < W; ++k) {
+            uint64_t diff = 0;
+            for (uint32_t bit = 0; bit < aw; ++bit) {
+              diff |= a[bit * W + k] ^ b[bit * W + k];
+            }
+            d[k] &= in.op == Distinct ? diff : ~diff;
+          }
+        }
+      }
+      return;
+    }
+    case Concat: {
+      // the last argument is the lowest part
+      uint64_t * out = d;
+      for (uint32_t i = in.num_args; i-- > 0;) {
+        size_t n = widths_[args[i]] * W;
+        copy_n(arg(i), n, out);
+        out += n;
+      }
+      return;
+    }
+    case Extract:
+      // idx0 is the high bit, idx1 the low bit
+      copy_n(arg(0) + in.idx1 * W, w * W, d);
+      return;
+    case Zero_Extend:
+    case Sign_Extend: {
+      const uint64_t * a = arg(0);
+      copy_n(a, aw * W, d);
+      for (uint32_t b = aw; b < w; ++b) {
+        if (in.op == Zero_Extend) {
+          fill_n(d + b * W, W, 0);
+        } else {
+          copy_n(a + (aw - 1) * W, W, d + b * W);
+        }
+      }
+      return;
+    }
+    case Repeat:
+      for (uint32_t b = 0; b < w; b += aw) {
+        copy_n(arg(0), aw * W, d + b * W);
+      }
+      return;
+    case Rotate_Left:
+    case Rotate_Right: {
+      uint32_t n = in.idx0 % w;
+      if (in.op == Rotate_Right) {
+        n = (w - n) % w;
+      }
+      const uint64_t * a = arg(0);
+      for (uint32_t b = 0; b < w; ++b) {
+        copy_n(a + b * W, W, d + ((b + n) % w) * W);
+      }
+      return;
+    }
+    case BVShl:
+    case BVLshr:
+    case BVAshr: {
+      // barrel shifter, one stage per bit of the shift amount
+      const uint64_t * a = arg(0);
+      const uint64_t * amt = arg(1);
+      uint64_t * cur = tmp0_.data();
+      uint64_t * next = tmp1_.data();
+      copy_n(a, w * W, cur);
+      uint32_t s = 0;
+      for (; s < w && (uint64_t(1) << s) < w; ++s) {
+        uint32_t dist = 1 << s;
+        const uint64_t * sel = amt + s * W;
+        for (uint32_t b = 0; b < w; ++b) {
+          const uint64_t * src = nullptr;
+          if (in.op == BVShl) {
+            src = b >= dist ? cur + (b - dist) * W : nullptr;
+          } else if (b + dist < w) {
+            src = cur + (b + dist) * W;
+          } else if (in.op == BVAshr) {
+            src = cur + (w - 1) * W;
+          }
+          for (size_t k = 0; k < W; ++k) {
+            uint64_t shifted = src ? src[k] : 0;
+            next[b * W + k] = (sel[k] & shifted) | (~sel[k] & cur[b * W + k]);
+          }
+        }
+        swap(cur, next);
+      }
+      // the remaining bits of the amount shift everything out
+      uint64_t * high = tmp2_.data();
+      fill_n(high, W, 0);
+      for (; s < w; ++s) {
+        for (size_t k = 0; k < W; ++k) {
+          high[k] |= amt[s * W + k];
+        }
+      }
+      for (uint32_t b = 0; b < w; ++b) {
+        for (size_t k = 0; k < W; ++k) {
+          // the sign bit is not changed by an arithmetic shift
+          uint64_t fill = in.op == BVAshr ? cur[(w - 1) * W + k] : 0;
+          d[b * W + k] = (~high[k] & cur[b * W + k]) | (high[k] & fill);
+        }
+      }
+      return;
+    }
+    case BVAdd:
+      add(arg(0), arg(1), false, false, w, d, tmp2_.data());
+      for (uint32_t i = 2; i < in.num_args; ++i) {
+        add(d, arg(i), false, false, w, d, tmp2_.data());
+      }
+      return;
+    case BVSub: add(arg(0), arg(1), true, true, w, d, tmp2_.data()); return;
+    case BVNeg: add(nullptr, arg(0), true, true, w, d, tmp2_.data()); return;
+    case BVUlt:
+    case BVUle:
+    case BVUgt:
+    case BVUge:
+    case BVSlt:
+    case BVSle:
+    case BVSgt:
+    case BVSge: {
+      // x < y iff there is no carry out of x + ~y + 1
+      bool swapped = in.op == BVUgt || in.op == BVUle || in.op == BVSgt
+                     || in.op == BVSle;
+      bool negated = in.op == BVUle || in.op == BVUge || in.op == BVSle
+                     || in.op == BVSge;
+      bool is_signed = in.op == BVSlt || in.op == BVSle || in.op == BVSgt
+                       || in.op == BVSge;
+      const uint64_t * x = arg(swapped ? 1 : 0);
+      const uint64_t * y = arg(swapped ? 0 : 1);
+      uint64_t * carry = tmp2_.data();
+      add(x, y, true, true, aw, nullptr, carry);
+      const uint64_t * xs = x + (aw - 1) * W;
+      const uint64_t * ys = y + (aw - 1) * W;
+      for (size_t k = 0; k < W; ++k) {
+        uint64_t lt = ~carry[k];
+        if (is_signed) {
+          // differing signs decide, otherwise as unsigned
+          uint64_t differ = xs[k] ^ ys[k];
+          lt = (differ & xs[k]) | (~differ & lt);
+        }
+        d[k] = negated ? ~lt : lt;
+      }
+      return;
+    }
+    default: break;
+  }
+
+  // multiplication, division and remainder
+  apply_scalar(in, args);
+}
+
+void BitParallelSimulator::apply_scalar(const SimInstr & in,
+                                        const uint32_t * args)
+{
+  const size_t W = words_;
+  vector<uint64_t> vals(in.num_args);
+  vector<uint32_t> idx(in.num_args);
+  vector<uint32_t> widths(in.num_args);
+  for (uint32_t i = 0; i < in.num_args; ++i) {
+    idx[i] = i;
+    widths[i] = widths_[args[i]];
+  }
+
+  uint64_t * d = plane(in.dst, 0);
+  fill_n(d, in.width * W, 0);
+  for (size_t lane = 0; lane < num_lanes(); ++lane) {
+    for (uint32_t i = 0; i < in.num_args; ++i) {
+      vals[i] = value(args[i], lane);
+    }
+    uint64_t r = sim_apply(in, vals.data(), idx.data(), widths.data());
+    size_t k = lane / 64, j = lane % 64;
+    for (uint32_t b = 0; b < in.width; ++b) {
+      d[b * W + k] |= ((r >> b) & 1) << j;
+    }
+  }
+}
+
+void BitParallelSimulator::add(const uint64_t * a,
+                               const uint64_t * b,
+                               bool negate_b,
+                               bool carry_in,
+                               uint32_t w,
+                               uint64_t * out,
+                               uint64_t * carry) const
+{
+  const size_t W = words_;
+  fill_n(carry, W, carry_in ? ~uint64_t(0) : 0);
+  for (uint32_t bit = 0; bit < w; ++bit) {
+    for (size_t k = 0; k < W; ++k) {
+      uint64_t x = a ? a[bit * W + k] : 0;
+      uint64_t y = negate_b ? ~b[bit * W + k] : b[bit * W + k];
+      uint64_t s = x ^ y;
+      if (out) {
+        out[bit * W + k] = s ^ carry[k];
+      }
+      carry[k] = (x & y) | (carry[k] & s);
+    }
+  }
+}
+
+void BitParallelSimulator::randomize_lanes(const vector<uint32_t> & slots,
+                                           const vector<uint64_t> & lanes)
+{
+  for (auto s : slots) {
+    for (uint32_t b = 0; b < widths_[s]; ++b) {
+      uint64_t * p = plane(s, b);
+      for (size_t k = 0; k < words_; ++k) {
+        p[k] = (p[k] & ~lanes[k]) | (rng_() & lanes[k]);
+      }
+    }
+  }
+}
+
+void BitParallelSimulator::holds(bool check_init, vector<uint64_t> & ok) const
+{
+  fill(ok.begin(), ok.end(), ~uint64_t(0));
+  if (check_init) {
+    const uint64_t * p = plane(init_slot_, 0);
+    for (size_t k = 0; k < words_; ++k) {
+      ok[k] &= p[k];
+    }
+  }
+  for (auto s : constraint_slots_) {
+    const uint64_t * p = plane(s, 0);
+    for (size_t k = 0; k < words_; ++k) {
+      ok[k] &= p[k];
+    }
+  }
+}
+
+}  // namespace pono
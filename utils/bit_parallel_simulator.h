@@ -0,0 +1,138 @@
+/*********************                                                        */
+/*! \file bit_parallel_simulator.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Bit-parallel random simulation of a functional transition system.
+**        Simulates a multiple of 64 independent traces at once. Each bit
+**        of a value is stored as a plane with one bit per trace, so the
+**        bitwise operators, adders and comparators evaluate all traces
+**        with word operations. Multiplication, division and remainder
+**        fall back to the scalar operations, one trace at a time.
+**
+**        The words of a plane are consecutive and every operation loops
+**        over them, so with 256 or 512 traces the loops are vectorized
+**        (e.g. AVX2 or AVX-512) when compiling for such a target.
+**
+**/
+
+#pragma once
+
+#include <vector>
+
+#include "utils/concrete_simulator.h"
+
+namespace pono {
+
+class BitParallelSimulator : public ConcreteSimulator
+{
+ public:
+  /** @param ts a functional transition system
+   *  @param lanes the number of traces, a positive multiple of 64
+   *  @param seed the seed for the random values
+   *  @throws PonoException if lanes is not supported, and see
+   *          ConcreteSimulator
+   */
+  BitParallelSimulator(const TransitionSystem & ts,
+                       size_t lanes = 64,
+                       unsigned int seed = 0);
+
+  /** Start new traces from random initial states
+   *  The traces without an initial state satisfying init and the
+   *  constraints within a few tries are blocked.
+   *  @return false if all the traces are blocked
+   */
+  bool reset() override;
+
+  /** Advance all traces by one cycle
+   *  The traces without inputs satisfying the constraints within a few
+   *  tries are blocked.
+   *  @return false if all the traces are blocked
+   */
+  bool step() override;
+
+  size_t num_lanes() const override { return words_ * 64; }
+
+  uint64_t value(uint32_t id, size_t lane = 0) const override;
+
+  /** @return the first trace that is not blocked in which a boolean output
+   *          is true, or num_lanes() if there is none
+   */
+  size_t find_lane(uint32_t id) const override;
+
+  /** @return bit b of an output in the current cycle, one bit per trace
+   *          in num_lanes() / 64 consecutive words
+   */
+  const uint64_t * bits(uint32_t id, uint32_t b) const { return plane(id, b); }
+
+  /** @return the traces that are not blocked, one bit per trace */
+  const std::vector<uint64_t> & alive() const { return alive_; }
+
+ protected:
+  /** Allocate the planes of the slots compiled since the last call
+   *  The values are set for all traces, which initializes the constants.
+   */
+  void extend_planes();
+
+  /** @return the first word of bit b of a slot */
+  uint64_t * plane(uint32_t slot, uint32_t b)
+  {
+    return &planes_[offsets_[slot] + b * words_];
+  }
+  const uint64_t * plane(uint32_t slot, uint32_t b) const
+  {
+    return &planes_[offsets_[slot] + b * words_];
+  }
+
+  /** Evaluate the instructions [begin, end) of prog for all traces */
+  void run_lanes(const SimProgram & prog, size_t begin, size_t end);
+
+  /** Evaluate one instruction for all traces */
+  void apply_lanes(const SimInstr & in, const uint32_t * args);
+
+  /** Evaluate one instruction with sim_apply, one trace at a time */
+  void apply_scalar(const SimInstr & in, const uint32_t * args);
+
+  /** Ripple-carry addition of w-bit planes, out = a + (~)b + carry_in
+   *  @param a the planes of the first operand, null for zero
+   *  @param b the planes of the second operand
+   *  @param negate_b add the complement of b
+   *  @param carry_in the carry into the lowest bit
+   *  @param w the width
+   *  @param out the planes of the result, null to only compute the carry
+   *  @param carry set to the carry out of the highest bit
+   */
+  void add(const uint64_t * a,
+           const uint64_t * b,
+           bool negate_b,
+           bool carry_in,
+           uint32_t w,
+           uint64_t * out,
+           uint64_t * carry) const;
+
+  /** Set the bits of the traces in lanes to random values */
+  void randomize_lanes(const std::vector<uint32_t> & slots,
+                       const std::vector<uint64_t> & lanes);
+
+  /** Set ok to the traces in which all the constraints hold in the current
+   *  cycle, and init as well if check_init
+   */
+  void holds(bool check_init, std::vector<uint64_t> & ok) const;
+
+  size_t words_;                  ///< the words of a plane
+  std::vector<uint64_t> planes_;  ///< all the bits of all the slots
+  std::vector<size_t> offsets_;   ///< the first plane of each slot
+  std::vector<uint64_t> alive_;   ///< the traces that are not blocked
+
+  // scratch space
+  std::vector<uint64_t> tmp0_, tmp1_, tmp2_;
+  std::vector<uint64_t> next_planes_;
+};
+
+}  // namespace pono
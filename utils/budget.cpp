@@ -0,0 +1,172 @@
+/*********************                                                        */
+/*! \file budget.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Resource budget and cancellation token for a running engine.
+**        Engines poll exhausted() at their loop heads and return UNKNOWN
+**        once the budget is used up or the run was cancelled.
+**
+**/
+
+#include "utils/budget.h"
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+
+#include "utils/logger.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+Budget::Budget()
+    : cancelled_(false),
+      num_solver_calls_(0),
+      start_time_(clock::now()),
+      time_limit_(0),
+      solver_call_limit_(0),
+      memory_limit_(0),
+      soft_memory_limit_(0),
+      last_soft_memory_mb_(0)
+{
+}
+
+void Budget::start()
+{
+  start_time_ = clock::now();
+  num_solver_calls_ = 0;
+}
+
+void Budget::cancel(const string & reason)
+{
+  {
+    lock_guard<mutex> lock(reason_mutex_);
+    if (reason_.empty()) {
+      reason_ = reason;
+    }
+  }
+  cancelled_ = true;
+}
+
+void Budget::resume()
+{
+  lock_guard<mutex> lock(reason_mutex_);
+  reason_.clear();
+  cancelled_ = false;
+}
+
+double Budget::elapsed_seconds() const
+{
+  return chrono::duration<double>(clock::now() - start_time_).count();
+}
+
+bool Budget::exhausted()
+{
+  if (cancelled_) {
+    return true;
+  }
+
+  if (solver_call_limit_ && num_solver_calls_ >= solver_call_limit_) {
+    cancel("solver call limit of " + std::to_string(solver_call_limit_)
+           + " reached");
+  } else if (time_limit_ > 0 && elapsed_seconds() >= time_limit_) {
+    cancel("time limit of " + std::to_string(time_limit_) + "s reached");
+  } else if (memory_limit_ && peak_memory_mb() >= memory_limit_) {
+    cancel("memory limit of " + std::to_string(memory_limit_)
+           + "MB reached");
+  }
+
+  return cancelled_;
+}
+
+bool Budget::over_soft_memory_limit()
+{
+  if (!soft_memory_limit_) {
+    return false;
+  }
+  size_t mb = current_memory_kb() / 1024;
+  if (mb < soft_memory_limit_
+      || (last_soft_memory_mb_
+          && mb < last_soft_memory_mb_
+                      + max<size_t>(soft_memory_limit_ / 10, 1))) {
+    return false;
+  }
+  last_soft_memory_mb_ = mb;
+  return true;
+}
+
+string Budget::reason() const
+{
+  lock_guard<mutex> lock(reason_mutex_);
+  return reason_;
+}
+
+bool set_query_time_limit(const SmtSolver & s, size_t ms)
+{
+  switch (s->get_solver_enum()) {
+    case CVC4: {
+      s->set_opt("tlimit-per", std::to_string(ms));
+      return true;
+    }
+    default: {
+      logger.log(0,
+                 "Warning: solver {} does not support a per-query time "
+                 "limit, only checking the budget between queries",
+                 smt::to_string(s->get_solver_enum()));
+      return false;
+    }
+  }
+}
+
+bool set_query_resource_limit(const SmtSolver & s, size_t units)
+{
+  switch (s->get_solver_enum()) {
+    case CVC4: {
+      s->set_opt("rlimit-per", std::to_string(units));
+      return true;
+    }
+    default: {
+      logger.log(0,
+                 "Warning: solver {} does not support a per-query resource "
+                 "limit, only checking the budget between queries",
+                 smt::to_string(s->get_solver_enum()));
+      return false;
+    }
+  }
+}
+
+size_t peak_memory_kb()
+{
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage)) {
+    return 0;
+  }
+  // ru_maxrss is in kilobytes on Linux
+  return usage.ru_maxrss;
+}
+
+size_t peak_memory_mb() { return peak_memory_kb() / 1024; }
+
+size_t current_memory_kb()
+{
+  // the second field is the number of resident pages
+  ifstream statm("/proc/self/statm");
+  size_t size, resident;
+  if (!(statm >> size >> resident)) {
+    return 0;
+  }
+  return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+}  // namespace pono
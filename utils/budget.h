@@ -0,0 +1,142 @@
+/*********************                                                        */
+/*! \file budget.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Resource budget and cancellation token for a running engine.
+**        Engines poll exhausted() at their loop heads and return UNKNOWN
+**        once the budget is used up or the run was cancelled.
+**
+**/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+
+#include "smt-switch/smt.h"
+
+namespace pono {
+
+class Budget
+{
+ public:
+  Budget();
+
+  /** Restart the wall-clock timer and the solver call count */
+  void start();
+
+  /** Set the wall-clock limit in seconds (0 means no limit) */
+  void set_time_limit(double seconds) { time_limit_ = seconds; }
+
+  /** Set the maximum number of solver queries (0 means no limit) */
+  void set_solver_call_limit(size_t n) { solver_call_limit_ = n; }
+
+  /** Set the peak resident memory limit in megabytes (0 means no limit)
+   *  Note: this is measured for the whole process
+   */
+  void set_memory_limit(size_t mb) { memory_limit_ = mb; }
+
+  /** Set the soft resident memory limit in megabytes (0 means no limit)
+   *  Unlike the memory limit this does not stop the engine, it only
+   *  asks it to drop its caches, see over_soft_memory_limit.
+   */
+  void set_soft_memory_limit(size_t mb) { soft_memory_limit_ = mb; }
+
+  /** Checks the current resident memory against the soft limit
+   *  To avoid dropping the caches at every step once the limit is
+   *  reached (freed memory is not always returned to the system), this
+   *  only returns true again after the memory grew by another tenth of
+   *  the limit.
+   *  @return true iff the engine should drop its caches
+   */
+  bool over_soft_memory_limit();
+
+  /** Request that the engine stops as soon as possible
+   *  Safe to call from any thread.
+   *  @param reason the reason reported by reason()
+   */
+  void cancel(const std::string & reason = "interrupted");
+
+  /** Clear a cancellation so that a suspended engine can continue
+   *  (e.g. in a later time slice of the portfolio). The limits still
+   *  apply. Must not be called while the engine is running.
+   */
+  void resume();
+
+  /** @return true iff cancel() was called */
+  bool cancelled() const { return cancelled_; }
+
+  /** Record one solver query */
+  void count_solver_call() { ++num_solver_calls_; }
+
+  size_t num_solver_calls() const { return num_solver_calls_; }
+
+  /** @return the wall-clock seconds since start() */
+  double elapsed_seconds() const;
+
+  /** Checks all the limits and cancels the budget if one is exceeded
+   *  Cheap enough to call once per solver query.
+   *  @return true iff the engine should stop
+   */
+  bool exhausted();
+
+  /** @return why the budget was exhausted (empty if it was not) */
+  std::string reason() const;
+
+ private:
+  typedef std::chrono::steady_clock clock;
+
+  std::atomic<bool> cancelled_;
+  std::atomic<size_t> num_solver_calls_;
+  clock::time_point start_time_;
+
+  double time_limit_;
+  size_t solver_call_limit_;
+  size_t memory_limit_;
+  size_t soft_memory_limit_;
+  size_t last_soft_memory_mb_;  ///< memory when the soft limit last fired
+
+  mutable std::mutex reason_mutex_;
+  std::string reason_;
+};
+
+/** Give a solver a time limit for each check_sat call
+ *  A query that runs out of time returns unknown.
+ *  Only supported by some solvers, for the others this only logs a warning
+ *  and the engines rely on polling their Budget between queries.
+ *  @param s the solver
+ *  @param ms the time limit per query in milliseconds
+ *  @return true iff the solver accepted the limit
+ */
+bool set_query_time_limit(const smt::SmtSolver & s, size_t ms);
+
+/** Give a solver a resource limit for each check_sat call
+ *  Like set_query_time_limit, but counted in solver steps (e.g. conflicts),
+ *  so that the result does not depend on the machine load.
+ *  @param s the solver
+ *  @param units the resource limit per query
+ *  @return true iff the solver accepted the limit
+ */
+bool set_query_resource_limit(const smt::SmtSolver & s, size_t units);
+
+/** @return the peak resident memory of this process in kilobytes */
+size_t peak_memory_kb();
+
+/** @return the peak resident memory of this process in megabytes */
+size_t peak_memory_mb();
+
+/** @return the current resident memory of this process in kilobytes
+ *          (0 if it cannot be read, e.g. without /proc)
+ */
+size_t current_memory_kb();
+
+}  // namespace pono
@@ -0,0 +1,184 @@
+/*********************                                                        */
+/*! \file cex_minimizer.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Minimization of the counterexamples of a functional transition
+**        system by ternary simulation.
+**
+**/
+
+#include "utils/cex_minimizer.h"
+
+#include "utils/logger.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+static bool supported_var(const Term & v)
+{
+  Sort sort = v->get_sort();
+  SortKind sk = sort->get_sort_kind();
+  return sk == BOOL || (sk == BV && sort->get_width() <= 64);
+}
+
+static uint32_t width_of(const Term & v)
+{
+  Sort sort = v->get_sort();
+  return sort->get_sort_kind() == BOOL ? 1 : sort->get_width();
+}
+
+CexMinimizer::CexMinimizer(const TransitionSystem & ts, const Term & prop)
+    : ts_(ts), prop_(prop), supported_(ts.is_functional()), sim_(ts),
+      num_dropped_(0)
+{
+  const UnorderedTermMap & updates = ts_.state_updates();
+  for (const auto & sv : ts_.statevars()) {
+    auto it = updates.find(sv);
+    supported_ &= supported_var(sv) && it != updates.end();
+    if (!supported_) {
+      return;
+    }
+    statevars_.push_back(sv);
+    updates_.push_back(it->second);
+  }
+  for (const auto & iv : ts_.inputvars()) {
+    supported_ &= supported_var(iv);
+    inputvars_.push_back(iv);
+  }
+  for (const auto & c : ts_.constraints()) {
+    checks_.push_back(c.first);
+  }
+  checks_.push_back(prop_);
+}
+
+bool CexMinimizer::step(size_t i, Values & states, bool check_prop)
+{
+  sim_.clear();
+  for (size_t k = 0; k < statevars_.size(); ++k) {
+    sim_.set_value(statevars_[k], states[k]);
+  }
+  for (size_t j = 0; j < inputvars_.size(); ++j) {
+    const Term & val = inputs_[i][j];
+    if (val) {
+      sim_.set_value(inputvars_[j], val);
+    } else {
+      const Term & iv = inputvars_[j];
+      sim_.set_value(iv, TernaryValue(width_of(iv), 0, 0));
+    }
+  }
+
+  Values checks = sim_.eval(checks_);
+  for (size_t c = 0; c + 1 < checks.size(); ++c) {
+    if (!checks[c].is_true()) {
+      return false;
+    }
+  }
+  if (check_prop && !checks.back().is_false()) {
+    return false;
+  }
+  states = sim_.eval(updates_);
+  return true;
+}
+
+vector<UnorderedTermMap> CexMinimizer::minimize(
+    const vector<UnorderedTermMap> & cex)
+{
+  num_dropped_ = 0;
+  if (!supported_ || cex.empty()) {
+    return cex;
+  }
+
+  // the values of the trace, which must be complete
+  inputs_.assign(cex.size(), TermVec(inputvars_.size()));
+  for (size_t i = 0; i < cex.size(); ++i) {
+    for (size_t j = 0; j < inputvars_.size(); ++j) {
+      auto it = cex[i].find(inputvars_[j]);
+      if (it == cex[i].end()) {
+        return cex;
+      }
+      inputs_[i][j] = it->second;
+    }
+  }
+  sim_.clear();
+  for (const auto & sv : statevars_) {
+    auto it = cex[0].find(sv);
+    if (it == cex[0].end()) {
+      return cex;
+    }
+    sim_.set_value(sv, it->second);
+  }
+
+  // the shortest prefix that violates the property
+  // states[i] are the values of the state variables at step i
+  vector<Values> states({ sim_.eval(statevars_) });
+  size_t len = 0;
+  while (len < cex.size()) {
+    Values next = states.back();
+    if (step(len, next, true)) {
+      ++len;
+      break;
+    }
+    next = states.back();
+    if (!step(len, next, false)) {
+      // e.g. an operator that is not simulated
+      logger.log(1, "CexMinimizer: could not simulate step {}", len);
+      return cex;
+    }
+    states.push_back(next);
+    ++len;
+  }
+  if (len == cex.size() && states.size() == cex.size() + 1) {
+    logger.log(1, "CexMinimizer: the property is not false in simulation");
+    return cex;
+  }
+
+  // drop the inputs that the violation does not depend on
+  for (size_t i = 0; i < len; ++i) {
+    for (size_t j = 0; j < inputvars_.size(); ++j) {
+      Term val = inputs_[i][j];
+      inputs_[i][j] = nullptr;
+      Values cur = states[i];
+      bool ok = true;
+      vector<Values> updated;
+      for (size_t k = i; ok && k < len; ++k) {
+        ok = step(k, cur, k + 1 == len);
+        updated.push_back(cur);
+      }
+      if (!ok) {
+        inputs_[i][j] = val;
+        continue;
+      }
+      ++num_dropped_;
+      for (size_t k = i + 1; k < len; ++k) {
+        states[k] = updated[k - i - 1];
+      }
+    }
+  }
+
+  vector<UnorderedTermMap> res(cex.begin(), cex.begin() + len);
+  for (size_t i = 0; i < len; ++i) {
+    for (size_t j = 0; j < inputvars_.size(); ++j) {
+      if (!inputs_[i][j]) {
+        res[i].erase(inputvars_[j]);
+      }
+    }
+  }
+  logger.log(1,
+             "CexMinimizer: {} of {} steps, dropped {} of {} input values",
+             len,
+             cex.size(),
+             num_dropped_,
+             len * inputvars_.size());
+  return res;
+}
+
+}  // namespace pono
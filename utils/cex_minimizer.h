@@ -0,0 +1,87 @@
+/*********************                                                        */
+/*! \file cex_minimizer.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Minimization of the counterexamples of a functional transition
+**        system by ternary simulation: the trace is cut at the first step
+**        that violates the property, then the inputs that the violation
+**        does not depend on are dropped (don't-cares).
+**
+**/
+
+#pragma once
+
+#include <vector>
+
+#include "core/ts.h"
+#include "smt-switch/smt.h"
+#include "utils/ternary_simulator.h"
+
+namespace pono {
+
+class CexMinimizer
+{
+ public:
+  /** @param ts the system of the counterexamples
+   *  @param prop the property they violate
+   */
+  CexMinimizer(const TransitionSystem & ts, const smt::Term & prop);
+
+  /** @return true iff the counterexamples of ts can be minimized, i.e. ts
+   *          is functional with boolean and bit-vector variables of at
+   *          most 64 bits
+   */
+  bool supported() const { return supported_; }
+
+  /** Minimize a counterexample
+   *  Each input is made unknown in each step (from the first one), and
+   *  it is dropped if the constraints are still true at every step and
+   *  the property is still false at the last step in ternary simulation.
+   *  The values of the remaining variables are kept, so the result is a
+   *  valid counterexample for any value of the dropped inputs.
+   *  @param cex a counterexample with the values of all the state and
+   *         input variables (it is returned unchanged otherwise, or if
+   *         the system is not supported)
+   *  @return the minimized counterexample
+   */
+  std::vector<smt::UnorderedTermMap> minimize(
+      const std::vector<smt::UnorderedTermMap> & cex);
+
+  /** @return the number of inputs dropped by the last minimize */
+  size_t num_dropped() const { return num_dropped_; }
+
+ protected:
+  typedef std::vector<TernaryValue> Values;
+
+  /** Simulate step i of the trace
+   *  @param states the values of statevars_ at step i, overwritten with
+   *         the values at step i+1
+   *  @param check_prop also check that the property is false at step i
+   *  @return false if a constraint may be false at step i, or the property
+   *          may be true (when checked)
+   */
+  bool step(size_t i, Values & states, bool check_prop);
+
+  const TransitionSystem & ts_;
+  smt::Term prop_;
+  bool supported_;
+
+  smt::TermVec statevars_;
+  smt::TermVec inputvars_;
+  smt::TermVec updates_;  ///< the state update of each of statevars_
+  smt::TermVec checks_;   ///< the constraints, then the property
+
+  TernarySimulator sim_;
+  /** the input values of each step, null for the dropped ones */
+  std::vector<smt::TermVec> inputs_;
+  size_t num_dropped_;
+};
+
+}  // namespace pono
@@ -0,0 +1,774 @@
+/*********************                                                        */
+/*! \file concrete_simulator.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Concrete random simulation of a functional transition system.
+**        The initial state definitions, constraints and state updates are
+**        compiled into a flat, topologically sorted program over 64-bit
+**        words, so simulating a cycle never touches the term DAG.
+**
+**/
+
+#include "utils/concrete_simulator.h"
+
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+
+#include "assert.h"
+#include "smt-switch/utils.h"
+#include "utils/exceptions.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+static const unordered_set<PrimOp> supported_ops(
+    { Not,         And,          Or,          Xor,         Implies,
+      Ite,         Equal,        Distinct,    BVNot,       BVNeg,
+      BVAnd,       BVOr,         BVXor,       BVNand,      BVNor,
+      BVXnor,      BVComp,       Concat,      Extract,     Zero_Extend,
+      Sign_Extend, Repeat,       Rotate_Left, Rotate_Right, BVShl,
+      BVLshr,      BVAshr,       BVAdd,       BVSub,       BVMul,
+      BVUdiv,      BVUrem,       BVSdiv,      BVSrem,      BVSmod,
+      BVUlt,       BVUle,        BVUgt,       BVUge,       BVSlt,
+      BVSle,       BVSgt,        BVSge });
+
+static uint64_t mask(uint32_t w)
+{
+  return w >= 64 ? ~uint64_t(0) : (uint64_t(1) << w) - 1;
+}
+
+/** @return the width of a boolean (1) or bit-vector term of width at most
+ *          64, and 0 otherwise
+ */
+static uint32_t width_of(const Term & t)
+{
+  Sort sort = t->get_sort();
+  SortKind sk = sort->get_sort_kind();
+  if (sk == BOOL) {
+    return 1;
+  } else if (sk == BV && sort->get_width() <= 64) {
+    return sort->get_width();
+  }
+  return 0;
+}
+
+static int64_t to_signed(uint64_t v, uint32_t w)
+{
+  if (w < 64 && (v >> (w - 1)) & 1) {
+    v |= ~mask(w);
+  }
+  return static_cast<int64_t>(v);
+}
+
+/** The value of a boolean or bit-vector value term */
+static uint64_t value_of(const Term & value)
+{
+  assert(value->is_value());
+  string s = value->to_string();
+  if (value->get_sort()->get_sort_kind() == BOOL) {
+    return s == "true";
+  }
+
+  // printed as #b0101, #x5 or (_ bv5 4)
+  try {
+    if (s.rfind("#b", 0) == 0) {
+      return stoull(s.substr(2), nullptr, 2);
+    } else if (s.rfind("#x", 0) == 0) {
+      return stoull(s.substr(2), nullptr, 16);
+    } else if (s.rfind("(_ bv", 0) == 0) {
+      return stoull(s.substr(5));
+    }
+  }
+  catch (std::logic_error & e) {
+    // fall through
+  }
+  throw PonoException("Could not read value for simulation: " + s);
+}
+
+ConcreteSimulator::ConcreteSimulator(const TransitionSystem & ts,
+                                     unsigned int seed)
+    : ts_(ts), rng_(seed), num_cycles_(0)
+{
+  if (!ts_.is_functional()) {
+    throw PonoException(
+        "ConcreteSimulator requires a functional transition system");
+  }
+
+  for (const auto & sv : ts_.statevars()) {
+    leaf_slot(sv);
+  }
+  for (const auto & iv : ts_.inputvars()) {
+    inputs_.push_back(leaf_slot(iv));
+  }
+  cycle_random_ = inputs_;
+
+  compile_init();
+
+  const UnorderedTermMap & updates = ts_.state_updates();
+  for (const auto & sv : ts_.statevars()) {
+    auto it = updates.find(sv);
+    if (it == updates.end()) {
+      cycle_random_.push_back(leaves_.at(sv));
+    } else {
+      updates_.push_back({ leaves_.at(sv), compile(it->second, cycle_prog_) });
+    }
+  }
+  next_values_.resize(updates_.size());
+
+  for (const auto & c : ts_.constraints()) {
+    constraint_slots_.push_back(compile(c.first, cycle_prog_));
+  }
+}
+
+bool ConcreteSimulator::supported(const Term & t) const
+{
+  UnorderedTermSet visited;
+  TermVec to_visit({ t });
+  while (to_visit.size()) {
+    Term cur = to_visit.back();
+    to_visit.pop_back();
+    if (!visited.insert(cur).second) {
+      continue;
+    }
+
+    if (!width_of(cur)) {
+      return false;
+    }
+
+    Op op = cur->get_op();
+    if (op.is_null()) {
+      if (!cur->is_value() && !ts_.is_curr_var(cur) && !ts_.is_input_var(cur)) {
+        return false;
+      }
+      continue;
+    }
+
+    if (supported_ops.find(op.prim_op) == supported_ops.end()) {
+      return false;
+    }
+    for (const auto & c : *cur) {
+      to_visit.push_back(c);
+    }
+  }
+  return true;
+}
+
+uint32_t ConcreteSimulator::add_output(const Term & t)
+{
+  if (!supported(t)) {
+    throw PonoException("Term not supported by simulation: " + t->to_string());
+  }
+  return compile(t, cycle_prog_);
+}
+
+bool ConcreteSimulator::reset()
+{
+  trace_rng_ = rng_;
+  for (size_t i = 0; i < max_tries; ++i) {
+    randomize(init_random_);
+    randomize(inputs_);
+
+    size_t pos = 0;
+    for (const auto & def : init_defs_) {
+      run(init_prog_, pos, def.end);
+      pos = def.end;
+      values_[def.var] = values_[def.expr];
+    }
+    run(init_prog_, pos, init_prog_.instrs.size());
+    if (!values_[init_slot_]) {
+      continue;
+    }
+
+    run(cycle_prog_, 0, cycle_prog_.instrs.size());
+    if (constraints_hold()) {
+      ++num_cycles_;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ConcreteSimulator::rewind()
+{
+  rng_ = trace_rng_;
+  return reset();
+}
+
+bool ConcreteSimulator::step()
+{
+  for (size_t i = 0; i < updates_.size(); ++i) {
+    next_values_[i] = values_[updates_[i].second];
+  }
+  for (size_t i = 0; i < updates_.size(); ++i) {
+    values_[updates_[i].first] = next_values_[i];
+  }
+
+  for (size_t i = 0; i < max_tries; ++i) {
+    randomize(cycle_random_);
+    run(cycle_prog_, 0, cycle_prog_.instrs.size());
+    if (constraints_hold()) {
+      ++num_cycles_;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ConcreteSimulator::replay_init(const UnorderedTermMap & frame)
+{
+  for (auto s : init_random_) {
+    values_[s] = 0;
+  }
+  for (auto s : inputs_) {
+    values_[s] = 0;
+  }
+  unordered_set<uint32_t> given = assign(frame);
+
+  size_t pos = 0;
+  for (const auto & def : init_defs_) {
+    run(init_prog_, pos, def.end);
+    pos = def.end;
+    if (given.find(def.var) == given.end()) {
+      values_[def.var] = values_[def.expr];
+    }
+  }
+  run(init_prog_, pos, init_prog_.instrs.size());
+  if (!values_[init_slot_]) {
+    return false;
+  }
+
+  run(cycle_prog_, 0, cycle_prog_.instrs.size());
+  ++num_cycles_;
+  return constraints_hold();
+}
+
+bool ConcreteSimulator::replay_step(const UnorderedTermMap & frame)
+{
+  for (size_t i = 0; i < updates_.size(); ++i) {
+    next_values_[i] = values_[updates_[i].second];
+  }
+  for (auto s : cycle_random_) {
+    values_[s] = 0;
+  }
+  unordered_set<uint32_t> given = assign(frame);
+  for (size_t i = 0; i < updates_.size(); ++i) {
+    uint32_t sv = updates_[i].first;
+    if (given.find(sv) != given.end() && values_[sv] != next_values_[i]) {
+      return false;
+    }
+    values_[sv] = next_values_[i];
+  }
+
+  run(cycle_prog_, 0, cycle_prog_.instrs.size());
+  ++num_cycles_;
+  return constraints_hold();
+}
+
+unordered_set<uint32_t> ConcreteSimulator::assign(
+    const UnorderedTermMap & frame)
+{
+  unordered_set<uint32_t> given;
+  for (const auto & elem : frame) {
+    // e.g. variables removed from the system
+    auto it = leaves_.find(elem.first);
+    if (it == leaves_.end() || !elem.first->is_symbolic_const()) {
+      continue;
+    }
+    values_[it->second] = value_of(elem.second) & mask(widths_[it->second]);
+    given.insert(it->second);
+  }
+  return given;
+}
+
+uint32_t ConcreteSimulator::compile(const Term & t, SimProgram & prog)
+{
+  // post-order traversal, the updates can be deep
+  vector<pair<Term, bool>> to_visit({ { t, false } });
+  while (to_visit.size()) {
+    auto [cur, visited] = to_visit.back();
+    to_visit.pop_back();
+
+    if (cur->get_op().is_null()) {
+      leaf_slot(cur);
+      continue;
+    } else if (prog.slots.find(cur) != prog.slots.end()) {
+      continue;
+    }
+
+    if (!visited) {
+      to_visit.push_back({ cur, true });
+      for (const auto & c : *cur) {
+        to_visit.push_back({ c, false });
+      }
+      continue;
+    }
+
+    Op op = cur->get_op();
+    uint32_t w = width_of(cur);
+    if (!w || supported_ops.find(op.prim_op) == supported_ops.end()) {
+      throw PonoException("Term not supported by simulation: "
+                          + cur->to_string());
+    }
+
+    SimInstr instr;
+    instr.op = op.prim_op;
+    instr.width = w;
+    instr.idx0 = op.num_idx > 0 ? op.idx0 : 0;
+    instr.idx1 = op.num_idx > 1 ? op.idx1 : 0;
+    instr.args_begin = prog.args.size();
+    instr.num_args = 0;
+    for (const auto & c : *cur) {
+      auto it = prog.slots.find(c);
+      prog.args.push_back(it != prog.slots.end() ? it->second : leaf_slot(c));
+      ++instr.num_args;
+    }
+    instr.arg_width = instr.num_args ? widths_[prog.args[instr.args_begin]] : 0;
+    instr.dst = values_.size();
+    values_.push_back(0);
+    widths_.push_back(w);
+    prog.instrs.push_back(instr);
+    prog.slots[cur] = instr.dst;
+  }
+
+  if (t->get_op().is_null()) {
+    return leaf_slot(t);
+  }
+  return prog.slots.at(t);
+}
+
+uint32_t ConcreteSimulator::leaf_slot(const Term & t)
+{
+  auto it = leaves_.find(t);
+  if (it != leaves_.end()) {
+    return it->second;
+  }
+
+  uint32_t w = width_of(t);
+  if (!w) {
+    throw PonoException("Sort not supported by simulation: "
+                        + t->get_sort()->to_string());
+  }
+
+  uint64_t v = 0;
+  if (t->is_value()) {
+    v = value_of(t) & mask(w);
+  } else if (!ts_.is_curr_var(t) && !ts_.is_input_var(t)) {
+    throw PonoException("Symbol not supported by simulation: "
+                        + t->to_string());
+  }
+
+  uint32_t slot = values_.size();
+  values_.push_back(v);
+  widths_.push_back(w);
+  leaves_[t] = slot;
+  return slot;
+}
+
+void ConcreteSimulator::compile_init()
+{
+  const SmtSolver & solver = ts_.solver();
+
+  // the conjuncts of init
+  TermVec conjuncts;
+  TermVec to_visit({ ts_.init() });
+  UnorderedTermSet visited;
+  while (to_visit.size()) {
+    Term cur = to_visit.back();
+    to_visit.pop_back();
+    if (!visited.insert(cur).second) {
+      continue;
+    }
+    if (cur->get_op() == And) {
+      for (const auto & c : *cur) {
+        to_visit.push_back(c);
+      }
+    } else {
+      conjuncts.push_back(cur);
+    }
+  }
+
+  // the first definition of each state variable
+  UnorderedTermMap defs;
+  auto is_def = [&](const Term & v, const Term & e) {
+    if (!ts_.is_curr_var(v) || defs.find(v) != defs.end()) {
+      return false;
+    }
+    UnorderedTermSet vars;
+    get_free_symbolic_consts(e, vars);
+    return vars.find(v) == vars.end();
+  };
+  for (const auto & c : conjuncts) {
+    TermVec args;
+    for (const auto & a : *c) {
+      args.push_back(a);
+    }
+    Op op = c->get_op();
+    if (c->is_symbolic_const()) {
+      Term val = solver->make_term(true);
+      if (is_def(c, val)) {
+        defs[c] = val;
+      }
+    } else if (op == Not && args[0]->is_symbolic_const()) {
+      Term val = solver->make_term(false);
+      if (is_def(args[0], val)) {
+        defs[args[0]] = val;
+      }
+    } else if (op == Equal && args.size() == 2) {
+      if (is_def(args[0], args[1])) {
+        defs[args[0]] = args[1];
+      } else if (is_def(args[1], args[0])) {
+        defs[args[1]] = args[0];
+      }
+    }
+  }
+
+  // order the definitions such that the variables a definition depends on
+  // are defined first, the ones in a cycle are left random
+  unordered_map<Term, size_t> num_deps;
+  unordered_map<Term, TermVec> users;
+  TermVec ready;
+  for (const auto & d : defs) {
+    UnorderedTermSet vars;
+    get_free_symbolic_consts(d.second, vars);
+    size_t n = 0;
+    for (const auto & v : vars) {
+      if (defs.find(v) != defs.end()) {
+        users[v].push_back(d.first);
+        ++n;
+      }
+    }
+    num_deps[d.first] = n;
+    if (!n) {
+      ready.push_back(d.first);
+    }
+  }
+
+  UnorderedTermSet defined;
+  while (ready.size()) {
+    Term v = ready.back();
+    ready.pop_back();
+    uint32_t expr = compile(defs.at(v), init_prog_);
+    init_defs_.push_back({ leaves_.at(v), expr, init_prog_.instrs.size() });
+    defined.insert(v);
+    for (const auto & u : users[v]) {
+      if (!--num_deps.at(u)) {
+        ready.push_back(u);
+      }
+    }
+  }
+
+  for (const auto & sv : ts_.statevars()) {
+    if (defined.find(sv) == defined.end()) {
+      init_random_.push_back(leaves_.at(sv));
+    }
+  }
+
+  // checks the conjuncts that are not definitions
+  init_slot_ = compile(ts_.init(), init_prog_);
+}
+
+void ConcreteSimulator::randomize(const vector<uint32_t> & slots)
+{
+  for (auto s : slots) {
+    values_[s] = rng_() & mask(widths_[s]);
+  }
+}
+
+bool ConcreteSimulator::constraints_hold() const
+{
+  for (auto s : constraint_slots_) {
+    if (!values_[s]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Term sim_evaluate(const SmtSolver & solver, const Term & t)
+{
+  Op op = t->get_op();
+  uint32_t w = width_of(t);
+  if (!w || op.is_null()
+      || supported_ops.find(op.prim_op) == supported_ops.end()) {
+    return Term();
+  }
+
+  vector<uint64_t> vals;
+  vector<uint32_t> widths;
+  vector<uint32_t> args;
+  try {
+    for (const auto & c : *t) {
+      uint32_t cw = width_of(c);
+      if (!cw || !c->is_value()) {
+        return Term();
+      }
+      args.push_back(vals.size());
+      vals.push_back(value_of(c) & mask(cw));
+      widths.push_back(cw);
+    }
+  }
+  catch (PonoException & e) {
+    return Term();
+  }
+  if (vals.empty()) {
+    return Term();
+  }
+
+  SimInstr in;
+  in.op = op.prim_op;
+  in.width = w;
+  in.arg_width = widths[0];
+  in.idx0 = op.num_idx > 0 ? op.idx0 : 0;
+  in.idx1 = op.num_idx > 1 ? op.idx1 : 0;
+  in.dst = 0;
+  in.args_begin = 0;
+  in.num_args = vals.size();
+  uint64_t r = sim_apply(in, vals.data(), args.data(), widths.data());
+
+  Sort sort = t->get_sort();
+  if (sort->get_sort_kind() == BOOL) {
+    return solver->make_term(r != 0);
+  }
+  return solver->make_term(std::to_string(r), sort);
+}
+
+bool sim_evaluate(const Term & t,
+                  unordered_map<Term, uint64_t> & values,
+                  UnorderedTermSet * failed)
+{
+  vector<uint64_t> vals;
+  vector<uint32_t> widths;
+  vector<uint32_t> args;
+  // post-order traversal, marks the term and its visited ancestors
+  // as failed if it cannot be evaluated
+  vector<pair<Term, bool>> to_visit({ { t, false } });
+  auto fail = [&](const Term & cur) {
+    if (failed) {
+      failed->insert(cur);
+      for (const auto & p : to_visit) {
+        if (p.second) {
+          failed->insert(p.first);
+        }
+      }
+    }
+    return false;
+  };
+
+  while (to_visit.size()) {
+    auto [cur, visited] = to_visit.back();
+    to_visit.pop_back();
+    if (values.find(cur) != values.end()) {
+      continue;
+    } else if (failed && failed->find(cur) != failed->end()) {
+      return fail(cur);
+    }
+
+    Op op = cur->get_op();
+    uint32_t w = width_of(cur);
+    if (!w) {
+      return fail(cur);
+    } else if (op.is_null()) {
+      if (!cur->is_value()) {
+        return fail(cur);
+      }
+      try {
+        values[cur] = value_of(cur) & mask(w);
+      }
+      catch (PonoException & e) {
+        return fail(cur);
+      }
+      continue;
+    } else if (supported_ops.find(op.prim_op) == supported_ops.end()) {
+      return fail(cur);
+    }
+
+    if (!visited) {
+      to_visit.push_back({ cur, true });
+      for (const auto & c : *cur) {
+        to_visit.push_back({ c, false });
+      }
+      continue;
+    }
+
+    vals.clear();
+    widths.clear();
+    args.clear();
+    for (const auto & c : *cur) {
+      args.push_back(vals.size());
+      vals.push_back(values.at(c));
+      widths.push_back(width_of(c));
+    }
+
+    SimInstr in;
+    in.op = op.prim_op;
+    in.width = w;
+    in.arg_width = widths.size() ? widths[0] : 0;
+    in.idx0 = op.num_idx > 0 ? op.idx0 : 0;
+    in.idx1 = op.num_idx > 1 ? op.idx1 : 0;
+    in.dst = 0;
+    in.args_begin = 0;
+    in.num_args = vals.size();
+    values[cur] = sim_apply(in, vals.data(), args.data(), widths.data());
+  }
+  return true;
+}
+
+uint64_t sim_apply(const SimInstr & in,
+                   const uint64_t * vals,
+                   const uint32_t * args,
+                   const uint32_t * widths)
+{
+  const uint64_t m = mask(in.width);
+  const uint64_t x = vals[args[0]];
+  const uint64_t y = in.num_args > 1 ? vals[args[1]] : 0;
+  const uint32_t aw = in.arg_width;
+  uint64_t r = 0;
+
+  switch (in.op) {
+    case Not:
+    case BVNot: r = ~x; break;
+    case BVNeg: r = -x; break;
+    case And:
+    case BVAnd:
+      r = x;
+      for (uint32_t i = 1; i < in.num_args; ++i) {
+        r &= vals[args[i]];
+      }
+      break;
+    case Or:
+    case BVOr:
+      r = x;
+      for (uint32_t i = 1; i < in.num_args; ++i) {
+        r |= vals[args[i]];
+      }
+      break;
+    case Xor:
+    case BVXor:
+      r = x;
+      for (uint32_t i = 1; i < in.num_args; ++i) {
+        r ^= vals[args[i]];
+      }
+      break;
+    case BVNand: r = ~(x & y); break;
+    case BVNor: r = ~(x | y); break;
+    case BVXnor: r = ~(x ^ y); break;
+    case Implies: r = !x || y; break;
+    case Ite: r = x ? y : vals[args[2]]; break;
+    case Equal:
+      r = 1;
+      for (uint32_t i = 1; i < in.num_args; ++i) {
+        r &= vals[args[i]] == x;
+      }
+      break;
+    case Distinct:
+      r = 1;
+      for (uint32_t i = 0; i < in.num_args; ++i) {
+        for (uint32_t j = i + 1; j < in.num_args; ++j) {
+          r &= vals[args[i]] != vals[args[j]];
+        }
+      }
+      break;
+    case BVComp: r = x == y; break;
+    case Concat:
+      r = x;
+      for (uint32_t i = 1; i < in.num_args; ++i) {
+        r = (r << widths[args[i]]) | vals[args[i]];
+      }
+      break;
+    // idx0 is the high bit, idx1 the low bit
+    case Extract: r = x >> in.idx1; break;
+    case Zero_Extend: r = x; break;
+    case Sign_Extend: r = to_signed(x, aw); break;
+    case Repeat:
+      for (uint32_t i = 0; i < in.idx0; ++i) {
+        r = (r << aw) | x;
+      }
+      break;
+    case Rotate_Left:
+    case Rotate_Right: {
+      uint32_t n = in.idx0 % in.width;
+      if (in.op == Rotate_Right) {
+        n = (in.width - n) % in.width;
+      }
+      r = n ? (x << n) | (x >> (in.width - n)) : x;
+      break;
+    }
+    case BVShl: r = y >= in.width ? 0 : x << y; break;
+    case BVLshr: r = y >= in.width ? 0 : x >> y; break;
+    case BVAshr: {
+      int64_t sx = to_signed(x, in.width);
+      r = static_cast<uint64_t>(sx >> (y >= in.width ? in.width - 1 : y));
+      break;
+    }
+    case BVAdd:
+      r = x;
+      for (uint32_t i = 1; i < in.num_args; ++i) {
+        r += vals[args[i]];
+      }
+      break;
+    case BVMul:
+      r = x;
+      for (uint32_t i = 1; i < in.num_args; ++i) {
+        r *= vals[args[i]];
+      }
+      break;
+    case BVSub: r = x - y; break;
+    // division by zero is all ones, remainder by zero is the dividend
+    case BVUdiv: r = y ? x / y : m; break;
+    case BVUrem: r = y ? x % y : x; break;
+    case BVSdiv:
+    case BVSrem:
+    case BVSmod: {
+      // on the absolute values, as in the SMT-LIB definitions
+      bool nx = to_signed(x, aw) < 0, ny = to_signed(y, aw) < 0;
+      uint64_t ax = (nx ? -x : x) & m, ay = (ny ? -y : y) & m;
+      if (in.op == BVSdiv) {
+        uint64_t q = ay ? ax / ay : m;
+        r = nx != ny ? -q : q;
+      } else {
+        uint64_t u = ay ? ax % ay : ax;
+        if (in.op == BVSrem || !u) {
+          r = nx ? -u : u;
+        } else if (nx == ny) {
+          r = nx ? -u : u;
+        } else {
+          r = nx ? y - u : u + y;
+        }
+      }
+      break;
+    }
+    case BVUlt: r = x < y; break;
+    case BVUle: r = x <= y; break;
+    case BVUgt: r = x > y; break;
+    case BVUge: r = x >= y; break;
+    case BVSlt: r = to_signed(x, aw) < to_signed(y, aw); break;
+    case BVSle: r = to_signed(x, aw) <= to_signed(y, aw); break;
+    case BVSgt: r = to_signed(x, aw) > to_signed(y, aw); break;
+    case BVSge: r = to_signed(x, aw) >= to_signed(y, aw); break;
+    default: assert(false);
+  }
+  return r & m;
+}
+
+void ConcreteSimulator::run(const SimProgram & prog, size_t begin, size_t end)
+{
+  uint64_t * vals = values_.data();
+  const uint32_t * all_args = prog.args.data();
+  const uint32_t * widths = widths_.data();
+  for (size_t pc = begin; pc < end; ++pc) {
+    const SimInstr & in = prog.instrs[pc];
+    vals[in.dst] = sim_apply(in, vals, all_args + in.args_begin, widths);
+  }
+}
+
+}  // namespace pono
@@ -0,0 +1,241 @@
+/*********************                                                        */
+/*! \file concrete_simulator.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Concrete random simulation of a functional transition system.
+**        The initial state definitions, constraints and state updates are
+**        compiled into a flat, topologically sorted program over 64-bit
+**        words, so simulating a cycle never touches the term DAG.
+**
+**/
+
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "core/ts.h"
+#include "smt-switch/smt.h"
+
+namespace pono {
+
+/** One operation of a compiled program
+ *  Reads the value slots args[args_begin, args_begin + num_args) of its
+ *  program and writes the value slot dst.
+ */
+struct SimInstr
+{
+  smt::PrimOp op;
+  uint32_t width;       ///< width of the result (1 for booleans)
+  uint32_t arg_width;   ///< width of the first argument
+  uint32_t idx0;        ///< first index of indexed operators
+  uint32_t idx1;        ///< second index of indexed operators
+  uint32_t dst;         ///< value slot of the result
+  uint32_t args_begin;  ///< offset of the argument slots in args
+  uint32_t num_args;
+};
+
+/** A topologically sorted sequence of operations
+ *  Evaluating the instructions in order computes every compiled term
+ *  from the values of the leaves.
+ */
+struct SimProgram
+{
+  std::vector<SimInstr> instrs;
+  std::vector<uint32_t> args;
+  ///< value slots of the non-leaf terms computed by this program
+  std::unordered_map<smt::Term, uint32_t> slots;
+};
+
+/** Apply the operation of an instruction to scalar values
+ *  @param in the instruction
+ *  @param vals the values, indexed by the argument slots
+ *  @param args the argument slots of in
+ *  @param widths the widths, indexed by the argument slots
+ *  @return the result, masked to the width of in
+ */
+uint64_t sim_apply(const SimInstr & in,
+                   const uint64_t * vals,
+                   const uint32_t * args,
+                   const uint32_t * widths);
+
+/** Evaluate a term whose children are values with sim_apply
+ *  @param solver the solver to make the result in
+ *  @param t the term
+ *  @return the value of t, or a null term if t is not supported
+ */
+smt::Term sim_evaluate(const smt::SmtSolver & solver, const smt::Term & t);
+
+/** Evaluate a term under values of its variables with sim_apply
+ *  @param t a boolean or bit-vector term
+ *  @param values the values of the variables, the values of the subterms
+ *         of t are added to it
+ *  @param failed if not null, the terms that could not be evaluated under
+ *         values, which are added to it and not traversed again
+ *  @return false if t (or a subterm) is not supported or has a variable
+ *          without a value
+ */
+bool sim_evaluate(const smt::Term & t,
+                  std::unordered_map<smt::Term, uint64_t> & values,
+                  smt::UnorderedTermSet * failed = nullptr);
+
+class ConcreteSimulator
+{
+ public:
+  /** Compiles the initial states, constraints and state updates of ts
+   *  Only booleans and bit-vectors of width at most 64 are supported.
+   *  @param ts a functional transition system
+   *  @param seed the seed for the random values
+   *  @throws PonoException if ts is not functional or uses anything else
+   */
+  ConcreteSimulator(const TransitionSystem & ts, unsigned int seed = 0);
+
+  virtual ~ConcreteSimulator() {}
+
+  /** @return true iff t can be compiled */
+  bool supported(const smt::Term & t) const;
+
+  /** Compile a term over current state and input variables
+   *  It is evaluated every cycle, after reset() and after each step().
+   *  Variables and values are not compiled, and can be read as well.
+   *  @return the id to read its value with value()
+   *  @throws PonoException if t is not supported
+   */
+  uint32_t add_output(const smt::Term & t);
+
+  /** Start a new trace from a random initial state
+   *  The state variables without an initial value are random, and so are
+   *  the inputs, such that init and the constraints hold.
+   *  @return false if no such state was found within a few tries
+   */
+  virtual bool reset();
+
+  /** Go back to the start of the current trace
+   *  Repeats reset() with the same random values, so the following calls
+   *  to step() repeat the trace as well. Used to recover a trace without
+   *  recording every cycle.
+   */
+  bool rewind();
+
+  /** Advance by one cycle with random inputs satisfying the constraints
+   *  State variables without a state update are random as well.
+   *  @return false if no such inputs were found within a few tries
+   */
+  virtual bool step();
+
+  /** Start a trace from the state and inputs of a witness frame
+   *  Replays the frame instead of picking random values: the state
+   *  variables and inputs are taken from frame, and the ones it does not
+   *  assign get their initial state definition, or 0.
+   *  @param frame values of the current state and input variables
+   *  @return false if init or the constraints do not hold
+   */
+  bool replay_init(const smt::UnorderedTermMap & frame);
+
+  /** Advance by one cycle with the inputs of a witness frame
+   *  The state variables with an update are computed as in step(), and
+   *  must match their values in frame if it assigns them. The inputs and
+   *  other state variables are taken from frame, or 0.
+   *  @param frame values of the current state and input variables
+   *  @return false if frame does not match the state updates or the
+   *          constraints do not hold
+   */
+  bool replay_step(const smt::UnorderedTermMap & frame);
+
+  /** @return the number of traces simulated at once */
+  virtual size_t num_lanes() const { return 1; }
+
+  /** @return the value of an output in the current cycle of a trace */
+  virtual uint64_t value(uint32_t id, size_t lane = 0) const
+  {
+    return values_[id];
+  }
+
+  /** @return the first trace in which a boolean output is true in the
+   *          current cycle, or num_lanes() if there is none
+   */
+  virtual size_t find_lane(uint32_t id) const { return values_[id] ? 0 : 1; }
+
+  /** @return the number of cycles simulated so far, summed over all
+   *          traces
+   */
+  uint64_t num_cycles() const { return num_cycles_; }
+
+ protected:
+  ///< tries to find random values satisfying init and the constraints
+  static constexpr size_t max_tries = 64;
+
+  /** Compile t and its subterms into prog
+   *  @return the value slot of t
+   */
+  uint32_t compile(const smt::Term & t, SimProgram & prog);
+
+  /** @return the value slot of a leaf (variable or value) */
+  uint32_t leaf_slot(const smt::Term & t);
+
+  /** Evaluate the instructions [begin, end) of prog */
+  void run(const SimProgram & prog, size_t begin, size_t end);
+
+  /** Find the initial state definitions v = e in the conjuncts of init
+   *  and compile them in an order such that the definitions of the
+   *  variables in e come first. The other variables are random.
+   */
+  void compile_init();
+
+  /** Set the random leaves to fresh random values */
+  void randomize(const std::vector<uint32_t> & slots);
+
+  /** Set the variables assigned in a witness frame
+   *  @return the slots of the variables that were set
+   */
+  std::unordered_set<uint32_t> assign(const smt::UnorderedTermMap & frame);
+
+  /** @return true iff all constraints hold in the current cycle */
+  bool constraints_hold() const;
+
+  const TransitionSystem & ts_;
+
+  std::mt19937_64 rng_;
+  std::mt19937_64 trace_rng_;  ///< rng_ at the last reset()
+
+  std::vector<uint64_t> values_;  ///< the value of every slot
+  std::vector<uint32_t> widths_;  ///< the width of every slot
+  std::unordered_map<smt::Term, uint32_t> leaves_;  ///< slots of the leaves
+
+  SimProgram init_prog_;   ///< initial state definitions and init
+  SimProgram cycle_prog_;  ///< constraints, state updates and outputs
+
+  struct InitDef
+  {
+    uint32_t var;   ///< slot of the state variable
+    uint32_t expr;  ///< slot of its initial value
+    size_t end;     ///< expr is computed by the instructions before end
+  };
+  std::vector<InitDef> init_defs_;
+  uint32_t init_slot_;
+
+  std::vector<uint32_t> init_random_;   ///< state variables without init
+  std::vector<uint32_t> cycle_random_;  ///< inputs and state variables
+                                        ///< without an update
+  std::vector<uint32_t> inputs_;        ///< slots of the input variables
+
+  std::vector<uint32_t> constraint_slots_;
+  ///< (state variable slot, update slot) for each state update
+  std::vector<std::pair<uint32_t, uint32_t>> updates_;
+  std::vector<uint64_t> next_values_;  ///< scratch space for step()
+
+  uint64_t num_cycles_;
+};
+
+}  // namespace pono
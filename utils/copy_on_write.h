@@ -0,0 +1,71 @@
+/*********************                                                        */
+/*! \file copy_on_write.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A container shared between copies until one of them modifies it.
+**
+**/
+
+#pragma once
+
+#include <memory>
+
+namespace pono {
+
+/** Holds a value that is shared by copies of the holder
+ *  Copying is O(1). The value is only copied by mut(), and only when the
+ *  holder is not the only owner, so a copy of a holder never observes the
+ *  modifications made through another one.
+ *  Note: like the standard containers, a holder must not be modified
+ *  while it is read or copied by another thread.
+ */
+template <typename T>
+class CopyOnWrite
+{
+ public:
+  CopyOnWrite() : ptr_(std::make_shared<T>()) {}
+
+  CopyOnWrite(const T & val) : ptr_(std::make_shared<T>(val)) {}
+
+  CopyOnWrite(T && val) : ptr_(std::make_shared<T>(std::move(val))) {}
+
+  const T & operator*() const { return *ptr_; }
+
+  const T * operator->() const { return ptr_.get(); }
+
+  /** @return a modifiable reference to the value, copied first if it is
+   *          shared with another holder
+   */
+  T & mut()
+  {
+    if (ptr_.use_count() > 1) {
+      ptr_ = std::make_shared<T>(*ptr_);
+    }
+    return *ptr_;
+  }
+
+  /** Replace the value with an empty one, without copying it */
+  void reset() { ptr_ = std::make_shared<T>(); }
+
+  bool operator==(const CopyOnWrite & other) const
+  {
+    return ptr_ == other.ptr_ || *ptr_ == *other.ptr_;
+  }
+
+  bool operator!=(const CopyOnWrite & other) const
+  {
+    return !(*this == other);
+  }
+
+ private:
+  std::shared_ptr<T> ptr_;
+};
+
+}  // namespace pono
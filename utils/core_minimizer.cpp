@@ -0,0 +1,252 @@
+/*********************                                                        */
+/*! \file core_minimizer.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Minimization of unsat cores over assumptions with QuickXplain
+**        (divide and conquer), used by the CEGAR reducers, and unsat
+**        cores of groups of assumptions checked in parallel solvers.
+**
+**/
+
+#include "utils/core_minimizer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <exception>
+#include <thread>
+
+#include "smt-switch/term_translator.h"
+#include "smt/available_solvers.h"
+#include "utils/exceptions.h"
+#include "utils/logger.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+CoreMinimizer::CoreMinimizer(const SmtSolver & solver, size_t time_limit_ms)
+    : solver_(solver),
+      time_limit_ms_(time_limit_ms),
+      timed_out_(false),
+      num_checks_(0)
+{
+  budget_.set_time_limit(time_limit_ms_ / 1000.0);
+}
+
+bool CoreMinimizer::minimize(const TermVec & assumps, TermVec & out)
+{
+  budget_.start();
+  timed_out_ = false;
+  num_checks_ = 0;
+  out.clear();
+
+  Result r = solver_->check_sat_assuming(assumps);
+  ++num_checks_;
+  if (!r.is_unsat()) {
+    out = assumps;
+    return false;
+  }
+
+  // start from the core of the solver, keeping the order of assumps
+  UnorderedTermSet core;
+  TermVec c;
+  try {
+    solver_->get_unsat_assumptions(core);
+    for (const auto & a : assumps) {
+      if (core.find(a) != core.end()) {
+        c.push_back(a);
+      }
+    }
+  }
+  catch (SmtException & e) {
+    c = assumps;
+  }
+
+  TermVec background;
+  quickxplain(background, false, c, out);
+
+  // restore the order of assumps
+  UnorderedTermSet kept(out.begin(), out.end());
+  out.clear();
+  for (const auto & a : assumps) {
+    if (kept.find(a) != kept.end()) {
+      out.push_back(a);
+    }
+  }
+
+  logger.log(2,
+             "CoreMinimizer: {}/{} assumptions after {} checks{}",
+             out.size(),
+             assumps.size(),
+             num_checks_,
+             timed_out_ ? " (timed out)" : "");
+  return true;
+}
+
+bool CoreMinimizer::is_unsat(const TermVec & background, const TermVec & c)
+{
+  TermVec assumps(background);
+  assumps.insert(assumps.end(), c.begin(), c.end());
+  ++num_checks_;
+  // unknown is treated as sat, which only keeps more assumptions
+  return solver_->check_sat_assuming(assumps).is_unsat();
+}
+
+void CoreMinimizer::quickxplain(TermVec & background,
+                                bool has_delta,
+                                const TermVec & c,
+                                TermVec & out)
+{
+  if (has_delta && is_unsat(background, {})) {
+    return;
+  }
+
+  if (c.empty()) {
+    return;
+  }
+
+  if (c.size() == 1) {
+    out.push_back(c[0]);
+    return;
+  }
+
+  if (time_limit_ms_ && budget_.exhausted()) {
+    // keep all the candidates, which is still unsat with background
+    timed_out_ = true;
+    out.insert(out.end(), c.begin(), c.end());
+    return;
+  }
+
+  assert(c.size() > 1);
+  size_t half = c.size() / 2;
+  TermVec c1(c.begin(), c.begin() + half);
+  TermVec c2(c.begin() + half, c.end());
+
+  size_t bg_size = background.size();
+
+  // the part of c2 needed together with all of c1
+  TermVec delta2;
+  background.insert(background.end(), c1.begin(), c1.end());
+  quickxplain(background, !c1.empty(), c2, delta2);
+  background.resize(bg_size);
+
+  // the part of c1 needed together with delta2
+  TermVec delta1;
+  background.insert(background.end(), delta2.begin(), delta2.end());
+  quickxplain(background, !delta2.empty(), c1, delta1);
+  background.resize(bg_size);
+
+  out.insert(out.end(), delta1.begin(), delta1.end());
+  out.insert(out.end(), delta2.begin(), delta2.end());
+}
+
+void minimize_core(const SmtSolver & solver,
+                   const TermVec & assumps,
+                   UnorderedTermSet & core,
+                   size_t time_limit_ms)
+{
+  TermVec core_assumps;
+  for (const auto & a : assumps) {
+    if (core.find(a) != core.end()) {
+      core_assumps.push_back(a);
+    }
+  }
+  TermVec min_core;
+  CoreMinimizer minimizer(solver, time_limit_ms);
+  if (minimizer.minimize(core_assumps, min_core)) {
+    core = UnorderedTermSet(min_core.begin(), min_core.end());
+  }
+}
+
+size_t split_unsat_cores(const SmtSolver & solver,
+                         const Term & formula,
+                         const vector<TermVec> & groups,
+                         size_t num_threads,
+                         size_t time_limit_ms,
+                         UnorderedTermSet & core)
+{
+  const size_t n = groups.size();
+  num_threads = std::min(num_threads, n);
+  if (!num_threads) {
+    return 0;
+  }
+
+  // only this thread uses solver, so all the terms are created here and
+  // the threads just run the queries in their own solver
+  // worker t checks the groups t, t + num_threads, ...
+  vector<SmtSolver> solvers;
+  vector<TermVec> assumps(n);
+  for (size_t t = 0; t < num_threads; ++t) {
+    SmtSolver s = create_solver(solver->get_solver_enum());
+    s->set_opt("produce-unsat-assumptions", "true");
+    TermTranslator tt(s);
+    s->assert_formula(tt.transfer_term(formula, BOOL));
+    for (size_t j = t; j < n; j += num_threads) {
+      for (const auto & a : groups[j]) {
+        assumps[j].push_back(tt.transfer_term(a, BOOL));
+      }
+    }
+    solvers.push_back(s);
+  }
+
+  // not a vector<bool>, the workers write neighboring entries
+  vector<char> unsat(n, false);
+  vector<UnorderedTermSet> cores(n);
+  vector<string> errors(num_threads);
+  auto run = [&](size_t t) {
+    const SmtSolver & s = solvers[t];
+    try {
+      for (size_t j = t; j < n; j += num_threads) {
+        if (s->check_sat_assuming(assumps[j]).is_unsat()) {
+          unsat[j] = true;
+          s->get_unsat_assumptions(cores[j]);
+          if (time_limit_ms) {
+            minimize_core(s, assumps[j], cores[j], time_limit_ms);
+          }
+        }
+      }
+    }
+    catch (std::exception & e) {
+      errors[t] = e.what();
+    }
+  };
+
+  vector<thread> threads;
+  threads.reserve(num_threads);
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.push_back(thread(run, t));
+  }
+  for (auto & t : threads) {
+    t.join();
+  }
+
+  for (const auto & e : errors) {
+    if (!e.empty()) {
+      throw PonoException("Parallel unsat core query failed: " + e);
+    }
+  }
+
+  size_t num_unsat = 0;
+  for (size_t j = 0; j < n; ++j) {
+    if (!unsat[j]) {
+      continue;
+    }
+    ++num_unsat;
+    for (size_t k = 0; k < groups[j].size(); ++k) {
+      if (cores[j].find(assumps[j][k]) != cores[j].end()) {
+        core.insert(groups[j][k]);
+      }
+    }
+  }
+  return num_unsat;
+}
+
+}  // namespace pono
@@ -0,0 +1,116 @@
+/*********************                                                        */
+/*! \file core_minimizer.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Minimization of unsat cores over assumptions with QuickXplain
+**        (divide and conquer), used by the CEGAR reducers, and unsat
+**        cores of groups of assumptions checked in parallel solvers, used
+**        by the CEGAR refinements (see --cegar-refine-threads).
+**
+**/
+
+#pragma once
+
+#include <vector>
+
+#include "smt-switch/smt.h"
+#include "utils/budget.h"
+
+namespace pono {
+
+class CoreMinimizer
+{
+ public:
+  /** @param solver the solver holding the background assertions
+   *         the assumptions are checked against
+   *  @param time_limit_ms a time budget for each call to minimize
+   *         (0 means no limit)
+   */
+  CoreMinimizer(const smt::SmtSolver & solver, size_t time_limit_ms = 0);
+
+  /** Minimize a set of assumptions that is unsat with the assertions
+   *  in the solver. The result is minimal (dropping any element makes it
+   *  sat) unless the time budget ran out, in which case it is only
+   *  smaller or equal. Elements earlier in assumps are preferred.
+   *  @param assumps boolean literals to use as assumptions
+   *  @param out is populated with the reduced assumptions (in the order
+   *         of assumps)
+   *  @return false if the assumptions are not unsat (out is then assumps)
+   */
+  bool minimize(const smt::TermVec & assumps, smt::TermVec & out);
+
+  /** @return true iff the last call to minimize ran out of time */
+  bool timed_out() const { return timed_out_; }
+
+  /** @return the number of solver queries of the last call to minimize */
+  size_t num_checks() const { return num_checks_; }
+
+ protected:
+  /** @return true iff background together with c is unsat */
+  bool is_unsat(const smt::TermVec & background, const smt::TermVec & c);
+
+  /** QuickXplain: returns a minimal subset of c that is unsat together
+   *  with background, assuming background /\ c is unsat
+   *  @param background the assumptions that are always included
+   *  @param has_delta whether background was extended by the caller
+   *         (if not, it is known to be sat)
+   *  @param c the candidates
+   *  @param out the subset is appended here
+   */
+  void quickxplain(smt::TermVec & background,
+                   bool has_delta,
+                   const smt::TermVec & c,
+                   smt::TermVec & out);
+
+  const smt::SmtSolver & solver_;
+  size_t time_limit_ms_;
+  Budget budget_;
+  bool timed_out_;
+  size_t num_checks_;
+};
+
+/** Shrink an unsat core returned by the solver with a CoreMinimizer
+ *  Expects the solver to be in the state of the unsat query.
+ *  @param solver the solver of the query
+ *  @param assumps the assumptions of the query (gives the preference order)
+ *  @param core the core of the query, reduced in place
+ *  @param time_limit_ms the time budget (0 means no limit)
+ */
+void minimize_core(const smt::SmtSolver & solver,
+                   const smt::TermVec & assumps,
+                   smt::UnorderedTermSet & core,
+                   size_t time_limit_ms);
+
+/** Check a formula under each group of assumptions on its own, in
+ *  parallel solvers
+ *  A group that is unsat on its own refutes the formula just as well as
+ *  all the assumptions together, so the cores of all the unsat groups can
+ *  be used at once. The formula and the assumptions are copied to the
+ *  worker solvers by the calling thread, the workers only run the
+ *  queries, each checking its groups in turn.
+ *  @param solver the solver of the terms
+ *  @param formula the assertions the groups are checked against
+ *  @param groups the groups of boolean literals
+ *  @param num_threads the number of worker solvers
+ *  @param time_limit_ms the budget for minimizing the core of each group
+ *         (see minimize_core), 0 keeps the cores of the solver
+ *  @param core is populated with the union of the cores of the unsat
+ *         groups, over the literals of groups
+ *  @return the number of unsat groups
+ *  @throws PonoException if a query fails
+ */
+size_t split_unsat_cores(const smt::SmtSolver & solver,
+                         const smt::Term & formula,
+                         const std::vector<smt::TermVec> & groups,
+                         size_t num_threads,
+                         size_t time_limit_ms,
+                         smt::UnorderedTermSet & core);
+
+}  // namespace pono
@@ -0,0 +1,604 @@
+/*********************                                                        */
+/*! \file cube_and_conquer.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Cube-and-conquer bmc over verification servers.
+**
+**/
+
+#include "utils/cube_and_conquer.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+#include "smt-switch/utils.h"
+#include "utils/exceptions.h"
+#include "utils/logger.h"
+#include "utils/timeline.h"
+#include "utils/ts_snapshot.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+// cubes a server works on at once, its workers pick them up in parallel
+static const size_t cubes_per_server = 4;
+// the most variables split on, 2^max_cube_vars cubes
+static const size_t max_cube_vars = 16;
+
+/** @return true iff name can be written in a cube (and a request line) */
+static bool cube_name(const string & name)
+{
+  if (name.empty()) {
+    return false;
+  }
+  for (char c : name) {
+    if (isspace(static_cast<unsigned char>(c)) || c == ';' || c == '@'
+        || c == '=') {
+      return false;
+    }
+  }
+  return true;
+}
+
+/** The value of a counterexample line of the server, see lemma_cache */
+static Term parse_value(const SmtSolver & solver,
+                        const Sort & sort,
+                        const string & val)
+{
+  SortKind sk = sort->get_sort_kind();
+  if (sk == BOOL) {
+    return solver->make_term(val == "true");
+  } else if (sk == BV) {
+    if (val.rfind("#b", 0) == 0) {
+      return solver->make_term(val.substr(2), sort, 2);
+    } else if (val.rfind("#x", 0) == 0) {
+      return solver->make_term(val.substr(2), sort, 16);
+    } else if (val.rfind("(_ bv", 0) == 0) {
+      // (_ bvN W)
+      return solver->make_term(val.substr(5, val.find(' ', 5) - 5), sort);
+    }
+  }
+  throw PonoException("Unsupported value in counterexample: " + val);
+}
+
+Cube cube_variables(const TransitionSystem & ts,
+                    const Term & prop,
+                    size_t num_vars)
+{
+  TermVec roots({ prop });
+  for (const auto & elem : ts.state_updates()) {
+    roots.push_back(elem.second);
+  }
+  for (const auto & c : ts.constraints()) {
+    roots.push_back(c.first);
+  }
+  if (!ts.is_functional()) {
+    roots.push_back(ts.trans());
+  }
+
+  // the number of roots that depend on each variable
+  unordered_map<Term, size_t> fanout;
+  for (const auto & r : roots) {
+    UnorderedTermSet free_vars;
+    get_free_symbolic_consts(r, free_vars);
+    for (const auto & v : free_vars) {
+      if (ts.is_curr_var(v) || ts.is_input_var(v)) {
+        ++fanout[v];
+      }
+    }
+  }
+
+  const auto & named = ts.named_terms();
+  vector<pair<Term, size_t>> candidates;
+  for (const auto & elem : fanout) {
+    const Term & v = elem.first;
+    SortKind sk = v->get_sort()->get_sort_kind();
+    string name = v->to_string();
+    auto it = named.find(name);
+    if ((sk == BOOL || sk == BV) && cube_name(name) && it != named.end()
+        && it->second == v) {
+      candidates.push_back(elem);
+    }
+  }
+  // ties are broken by name, so the cubes don't depend on hashing
+  sort(candidates.begin(),
+       candidates.end(),
+       [](const pair<Term, size_t> & a, const pair<Term, size_t> & b) {
+         if (a.second != b.second) {
+           return a.second > b.second;
+         }
+         return a.first->to_string() < b.first->to_string();
+       });
+
+  Cube vars;
+  for (size_t i = 0; i < candidates.size() && i < num_vars; ++i) {
+    const Term & v = candidates[i].first;
+    Sort sort = v->get_sort();
+    int bit = sort->get_sort_kind() == BV ? sort->get_width() - 1 : -1;
+    vars.push_back({ v, bit, 0, false });
+  }
+  return vars;
+}
+
+vector<Cube> make_cubes(const Cube & vars, int time)
+{
+  if (vars.size() > max_cube_vars) {
+    throw PonoException("Too many cube variables: "
+                        + std::to_string(vars.size()));
+  }
+
+  vector<Cube> cubes;
+  size_t n = size_t(1) << vars.size();
+  for (size_t i = 0; i < n; ++i) {
+    Cube c = vars;
+    for (size_t j = 0; j < c.size(); ++j) {
+      c[j].time = time;
+      c[j].value = (i >> j) & 1;
+    }
+    cubes.push_back(c);
+  }
+  return cubes;
+}
+
+string cube_to_string(const Cube & cube)
+{
+  string res;
+  for (const auto & lit : cube) {
+    if (!res.empty()) {
+      res += ";";
+    }
+    res += lit.var->to_string() + "@" + std::to_string(lit.time);
+    if (lit.bit >= 0) {
+      res += "[" + std::to_string(lit.bit) + "]";
+    }
+    res += lit.value ? "=1" : "=0";
+  }
+  return res;
+}
+
+Cube parse_cube(const TransitionSystem & ts, const string & s)
+{
+  Cube cube;
+  istringstream in(s);
+  string lit_str;
+  while (getline(in, lit_str, ';')) {
+    if (lit_str.empty()) {
+      continue;
+    }
+    // parsed from the right, names may contain brackets
+    size_t eq = lit_str.rfind('=');
+    if (eq == string::npos
+        || (lit_str.substr(eq + 1) != "0" && lit_str.substr(eq + 1) != "1")) {
+      throw PonoException("Malformed cube literal: " + lit_str);
+    }
+    CubeLiteral lit;
+    lit.value = lit_str[eq + 1] == '1';
+    string head = lit_str.substr(0, eq);
+    lit.bit = -1;
+    size_t at = head.rfind('@');
+    try {
+      if (head.size() && head.back() == ']') {
+        size_t lb = head.rfind('[');
+        if (lb != string::npos && at != string::npos && lb > at) {
+          lit.bit = stoi(head.substr(lb + 1, head.size() - lb - 2));
+          head = head.substr(0, lb);
+        }
+      }
+      at = head.rfind('@');
+      if (at == string::npos || at == 0) {
+        throw PonoException("Malformed cube literal: " + lit_str);
+      }
+      lit.time = stoi(head.substr(at + 1));
+    }
+    catch (std::logic_error & e) {
+      throw PonoException("Malformed cube literal: " + lit_str);
+    }
+
+    string name = head.substr(0, at);
+    const auto & named = ts.named_terms();
+    auto it = named.find(name);
+    if (it == named.end()) {
+      continue;
+    }
+    lit.var = it->second;
+    Sort sort = lit.var->get_sort();
+    bool ok = lit.time >= 0
+              && (sort->get_sort_kind() == BOOL
+                      ? lit.bit < 0
+                      : sort->get_sort_kind() == BV && lit.bit >= 0
+                            && lit.bit < (int)sort->get_width());
+    if (!ok) {
+      throw PonoException("Cube literal does not fit the variable: "
+                          + lit_str);
+    }
+    cube.push_back(lit);
+  }
+  return cube;
+}
+
+Term cube_literal_term(const SmtSolver & solver, const CubeLiteral & lit)
+{
+  if (lit.bit < 0) {
+    return lit.value ? lit.var : solver->make_term(Not, lit.var);
+  }
+  Term b = solver->make_term(Op(Extract, lit.bit, lit.bit), lit.var);
+  return solver->make_term(
+      Equal, b, solver->make_term(lit.value ? 1 : 0, solver->make_sort(BV, 1)));
+}
+
+SocketCubeServer::SocketCubeServer(const string & socket_path)
+{
+  sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(addr.sun_path)) {
+    throw PonoException("Socket path is too long: " + socket_path);
+  }
+  strcpy(addr.sun_path, socket_path.c_str());
+
+  fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd_ < 0) {
+    throw PonoException("Could not create a socket: "
+                        + string(strerror(errno)));
+  }
+  if (connect(fd_, (sockaddr *)&addr, sizeof(addr)) < 0) {
+    string err = strerror(errno);
+    close(fd_);
+    throw PonoException("Could not connect to " + socket_path + ": " + err);
+  }
+  reader_ = thread(&SocketCubeServer::read_replies, this);
+}
+
+SocketCubeServer::~SocketCubeServer()
+{
+  // wakes up the reader
+  ::shutdown(fd_, SHUT_RDWR);
+  reader_.join();
+  close(fd_);
+}
+
+void SocketCubeServer::send(const string & line)
+{
+  string out = line + "\n";
+  size_t sent = 0;
+  while (sent < out.size()) {
+    ssize_t n =
+        ::send(fd_, out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    } else if (n <= 0) {
+      // the reader reports the closed connection
+      return;
+    }
+    sent += n;
+  }
+}
+
+void SocketCubeServer::read_replies()
+{
+  string buf;
+  char data[4096];
+  while (true) {
+    ssize_t n = recv(fd_, data, sizeof(data), 0);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    } else if (n <= 0) {
+      break;
+    }
+    buf.append(data, n);
+    size_t pos;
+    while ((pos = buf.find('\n')) != string::npos) {
+      string line = buf.substr(0, pos);
+      buf.erase(0, pos + 1);
+      if (handler_) {
+        handler_(line);
+      }
+    }
+  }
+  if (handler_) {
+    handler_("closed");
+  }
+}
+
+namespace {
+
+/** The state shared with the reply handlers, which may still be called
+ *  by abandoned jobs after cube_and_conquer returned
+ */
+struct CubeState
+{
+  mutex mtx;
+  condition_variable cv;
+
+  struct Server
+  {
+    string handle;      ///< the design on the server, empty until loaded
+    bool failed = false;  ///< could not load, or the connection closed
+    string error;
+    deque<size_t> pending;  ///< submitted cubes without a job id yet
+    unordered_map<string, size_t> jobs;  ///< job id to cube
+    unordered_map<string, vector<string>> cex_lines;  ///< by job id
+    size_t outstanding = 0;  ///< submitted cubes without a result
+  };
+  vector<Server> servers;
+
+  size_t num_unsat = 0;
+  size_t num_unknown = 0;
+  bool sat = false;
+  size_t sat_cube = 0;
+  vector<string> sat_cex;  ///< "<step> <var> <value>" lines
+
+  void handle(size_t s, const string & line)
+  {
+    lock_guard<mutex> lock(mtx);
+    Server & srv = servers[s];
+    istringstream in(line);
+    string word;
+    in >> word;
+    if (word == "loaded") {
+      in >> srv.handle;
+    } else if (word == "closed" || (word == "error" && srv.handle.empty())) {
+      srv.failed = true;
+      srv.error = line;
+      num_unknown += srv.outstanding;
+      srv.outstanding = 0;
+    } else if (word == "error" && srv.pending.size()) {
+      // a check request that was not queued
+      srv.pending.pop_front();
+      --srv.outstanding;
+      ++num_unknown;
+    } else if (word == "queued" && srv.pending.size()) {
+      string job;
+      in >> job;
+      srv.jobs[job] = srv.pending.front();
+      srv.pending.pop_front();
+    } else if (word == "cex") {
+      string job;
+      in >> job;
+      string rest;
+      getline(in, rest);
+      srv.cex_lines[job].push_back(rest);
+    } else if (word == "result") {
+      string job, res;
+      in >> job >> res;
+      auto it = srv.jobs.find(job);
+      if (it == srv.jobs.end() || !srv.outstanding) {
+        return;
+      }
+      --srv.outstanding;
+      if (res == "sat") {
+        if (!sat) {
+          sat = true;
+          sat_cube = it->second;
+          sat_cex = srv.cex_lines[job];
+        }
+      } else if (res == "unsat" || res == "bounded") {
+        // bounded: bmc reached the bound without a counterexample
+        ++num_unsat;
+      } else {
+        ++num_unknown;
+      }
+      srv.jobs.erase(it);
+      srv.cex_lines.erase(job);
+    } else {
+      return;
+    }
+    cv.notify_all();
+  }
+};
+
+}  // namespace
+
+/** Rebuild the counterexample from the "<step> <var> <value>" lines */
+static vector<UnorderedTermMap> parse_cex(const TransitionSystem & ts,
+                                          const vector<string> & lines)
+{
+  vector<UnorderedTermMap> cex;
+  const auto & named = ts.named_terms();
+  for (const auto & l : lines) {
+    string line = l;
+    size_t start = line.find_first_not_of(' ');
+    if (start == string::npos) {
+      continue;
+    }
+    line = line.substr(start);
+    size_t sp = line.find(' ');
+    if (sp == string::npos) {
+      continue;
+    }
+    size_t step = stoul(line.substr(0, sp));
+    string rest = line.substr(sp + 1);
+    // the value is the last word, or (_ bvN W)
+    size_t vpos = rest.back() == ')' ? rest.rfind("(_ bv") : rest.rfind(' ');
+    if (vpos == string::npos || vpos == 0) {
+      continue;
+    }
+    string val = rest.substr(rest.back() == ')' ? vpos : vpos + 1);
+    string name = rest.substr(0, vpos);
+    while (name.size() && name.back() == ' ') {
+      name.pop_back();
+    }
+    auto it = named.find(name);
+    if (it == named.end()) {
+      // e.g. an auxiliary variable of the server's preprocessing
+      continue;
+    }
+    if (cex.size() <= step) {
+      cex.resize(step + 1);
+    }
+    cex[step][it->second] =
+        parse_value(ts.solver(), it->second->get_sort(), val);
+  }
+  return cex;
+}
+
+CubeAndConquerResult cube_and_conquer(
+    const TransitionSystem & ts,
+    const Term & prop,
+    const PonoOptions & opts,
+    vector<unique_ptr<CubeServer>> & servers)
+{
+  TIMELINE_SPAN("cube_and_conquer");
+  if (servers.empty()) {
+    throw PonoException("Cube-and-conquer needs at least one server");
+  }
+
+  int bound = opts.bound_;
+  int depth = opts.cube_depth_ ? std::min<int>(opts.cube_depth_, bound)
+                               : bound / 2;
+  Cube vars = cube_variables(ts, prop, opts.cube_vars_);
+  vector<Cube> cubes = make_cubes(vars, depth);
+  CubeAndConquerResult res;
+  res.num_cubes = cubes.size();
+  logger.log(1,
+             "Cube-and-conquer: {} cubes over {} variables at depth {}",
+             cubes.size(),
+             vars.size(),
+             depth);
+
+  string snapshot = opts.cube_snapshot_;
+  if (snapshot.empty()) {
+    snapshot = "pono-cubes-" + std::to_string(getpid()) + ".snap";
+  } else if (snapshot.size() < 5
+             || snapshot.compare(snapshot.size() - 5, 5, ".snap")) {
+    throw PonoException("The cube snapshot must end in .snap: " + snapshot);
+  }
+  write_ts_snapshot(snapshot, ts, { prop });
+  // the servers may run in another working directory
+  if (char * path = realpath(snapshot.c_str(), nullptr)) {
+    snapshot = path;
+    free(path);
+  }
+
+  shared_ptr<CubeState> st = make_shared<CubeState>();
+  st->servers.resize(servers.size());
+  for (size_t s = 0; s < servers.size(); ++s) {
+    servers[s]->set_handler(
+        [st, s](const string & line) { st->handle(s, line); });
+  }
+  for (auto & srv : servers) {
+    srv->send("load " + snapshot);
+  }
+
+  string job_opts = " 0 -e bmc -k " + std::to_string(bound) + " --bmc-cube ";
+  if (opts.witness_) {
+    job_opts = " 0 --witness -e bmc -k " + std::to_string(bound)
+               + " --bmc-cube ";
+  }
+
+  size_t next = 0;
+  unique_lock<mutex> lock(st->mtx);
+  // wait for the servers to load the snapshot
+  st->cv.wait(lock, [&st]() {
+    for (const auto & srv : st->servers) {
+      if (srv.handle.empty() && !srv.failed) {
+        return false;
+      }
+    }
+    return true;
+  });
+
+  while (true) {
+    if (st->sat) {
+      break;
+    }
+
+    // hand out cubes, sending without the lock as the handlers may be
+    // called from send
+    vector<pair<size_t, string>> requests;
+    bool alive = false;
+    for (size_t s = 0; s < st->servers.size(); ++s) {
+      CubeState::Server & srv = st->servers[s];
+      if (srv.failed || srv.handle.empty()) {
+        continue;
+      }
+      alive = true;
+      while (srv.outstanding < cubes_per_server && next < cubes.size()) {
+        srv.pending.push_back(next);
+        ++srv.outstanding;
+        requests.push_back(
+            { s,
+              "check " + srv.handle + job_opts
+                  + cube_to_string(cubes[next]) });
+        ++next;
+      }
+    }
+    if (requests.size()) {
+      lock.unlock();
+      for (const auto & r : requests) {
+        servers[r.first]->send(r.second);
+      }
+      lock.lock();
+      continue;
+    }
+
+    size_t outstanding = 0;
+    for (const auto & srv : st->servers) {
+      outstanding += srv.outstanding;
+    }
+    if (!alive) {
+      // the cubes no server got are not decided
+      st->num_unknown += cubes.size() - next;
+      next = cubes.size();
+      for (const auto & srv : st->servers) {
+        logger.log(1, "Cube-and-conquer: server failed: {}", srv.error);
+      }
+    }
+    if (next == cubes.size() && !outstanding) {
+      break;
+    }
+    st->cv.wait(lock);
+  }
+
+  res.num_unsat = st->num_unsat;
+  res.num_unknown = st->num_unknown;
+  if (st->sat) {
+    res.result = ProverResult::FALSE;
+    res.cube = cube_to_string(cubes[st->sat_cube]);
+    res.cex = parse_cex(ts, st->sat_cex);
+  }
+  vector<string> handles;
+  for (const auto & srv : st->servers) {
+    handles.push_back(srv.failed ? "" : srv.handle);
+  }
+  lock.unlock();
+
+  // the servers free the design once the abandoned jobs finished
+  for (size_t s = 0; s < servers.size(); ++s) {
+    if (!handles[s].empty()) {
+      servers[s]->send("unload " + handles[s]);
+    }
+  }
+  remove(snapshot.c_str());
+
+  logger.log(1,
+             "Cube-and-conquer: {} of {} cubes unsat, {} undecided",
+             res.num_unsat,
+             res.num_cubes,
+             res.num_unknown);
+  return res;
+}
+
+}  // namespace pono
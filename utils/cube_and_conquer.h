@@ -0,0 +1,156 @@
+/*********************                                                        */
+/*! \file cube_and_conquer.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Cube-and-conquer bmc over verification servers (see
+**        --cube-servers). A lookahead picks a few high-impact variables,
+**        and the values of their bits at a target depth split the bmc
+**        problem into cubes that together cover every path. The system
+**        is shipped to each server once as a binary snapshot, and each
+**        cube is a bmc job of the server protocol (see --bmc-cube and
+**        verification_server.h).
+**        The first cube with a counterexample decides the property; if
+**        all cubes are unsat there is no counterexample up to the bound.
+**
+**        A cube is written as literals separated by ';', each
+**          <variable>@<time>=<0|1>     for a boolean variable
+**          <variable>@<time>[<bit>]=<0|1>  for a bit of a bit-vector
+**
+**/
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/ts.h"
+#include "engines/prover.h"
+#include "options/options.h"
+#include "smt-switch/smt.h"
+
+namespace pono {
+
+struct CubeLiteral
+{
+  smt::Term var;  ///< a boolean or bit-vector variable
+  int bit;        ///< the bit of a bit-vector variable, -1 for a boolean
+  int time;
+  bool value;
+};
+
+typedef std::vector<CubeLiteral> Cube;
+
+/** Pick the variables to split on
+ *  The lookahead is structural: the state and input variables that the
+ *  most state updates, constraints and the property depend on, splitting
+ *  a bit-vector on its most significant bit. Variables whose name can't
+ *  be written in a cube are skipped.
+ *  @param ts the transition system
+ *  @param prop the property
+ *  @param num_vars the number of variables
+ *  @return literals with value false, at time 0
+ */
+Cube cube_variables(const TransitionSystem & ts,
+                    const smt::Term & prop,
+                    size_t num_vars);
+
+/** @return the 2^n cubes of the n literals of vars at time */
+std::vector<Cube> make_cubes(const Cube & vars, int time);
+
+/** @return the cube as a string, see the file comment */
+std::string cube_to_string(const Cube & cube);
+
+/** Parse a cube over the variables of ts
+ *  Literals of variables that ts does not have (e.g. removed by the cone
+ *  of influence reduction) are dropped, which only makes the cube larger.
+ *  @throws PonoException if the string is malformed
+ */
+Cube parse_cube(const TransitionSystem & ts, const std::string & s);
+
+/** @return the literal as a boolean term over the variable at time 0 */
+smt::Term cube_literal_term(const smt::SmtSolver & solver,
+                            const CubeLiteral & lit);
+
+/** A connection to a verification server */
+class CubeServer
+{
+ public:
+  /** Receives the reply lines of the server, possibly on another thread */
+  typedef std::function<void(const std::string &)> Reply;
+
+  virtual ~CubeServer() {}
+
+  /** Send one request line, the replies go to the handler */
+  virtual void send(const std::string & line) = 0;
+
+  void set_handler(const Reply & handler) { handler_ = handler; }
+
+ protected:
+  Reply handler_;
+};
+
+/** A server listening on a Unix domain socket (see --serve)
+ *  The replies are read on a thread of the connection, which stops when
+ *  it is destroyed (the jobs still running on the server are abandoned).
+ */
+class SocketCubeServer : public CubeServer
+{
+ public:
+  /** @throws PonoException if the socket can't be connected */
+  SocketCubeServer(const std::string & socket_path);
+
+  ~SocketCubeServer();
+
+  void send(const std::string & line) override;
+
+ protected:
+  void read_replies();
+
+  int fd_;
+  std::thread reader_;
+};
+
+/** The result of cube_and_conquer */
+struct CubeAndConquerResult
+{
+  ProverResult result = ProverResult::UNKNOWN;
+  size_t num_cubes = 0;
+  size_t num_unsat = 0;    ///< cubes without a counterexample
+  size_t num_unknown = 0;  ///< cubes that were not decided (or errors)
+  std::string cube;        ///< the cube with the counterexample
+  ///< the counterexample of the cube, if the server sent one (--witness)
+  std::vector<smt::UnorderedTermMap> cex;
+};
+
+/** Check the bounds up to opts.bound_ by cube-and-conquer
+ *  Uses opts.cube_vars_ variables split at opts.cube_depth_ (0 for half of
+ *  the bound). The snapshot is written to opts.cube_snapshot_ (a file in
+ *  the working directory if empty), which the servers must be able to
+ *  read (its absolute path is sent), and removed afterwards. Each server
+ *  gets a few cubes at a time, so no new cube is started once one has a
+ *  counterexample.
+ *  @param ts the transition system
+ *  @param prop the property
+ *  @param opts the options
+ *  @param servers the servers
+ *  @return the result, UNKNOWN unless a cube has a counterexample
+ *  @throws PonoException if the snapshot can't be written or a server
+ *          can't load it
+ */
+CubeAndConquerResult cube_and_conquer(
+    const TransitionSystem & ts,
+    const smt::Term & prop,
+    const PonoOptions & opts,
+    std::vector<std::unique_ptr<CubeServer>> & servers);
+
+}  // namespace pono
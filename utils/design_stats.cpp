@@ -0,0 +1,113 @@
+/*********************                                                        */
+/*! \file design_stats.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Size statistics of a parsed design (--stats-only), used to
+**        estimate the cost of a job before running an engine.
+**
+**/
+
+#include "utils/design_stats.h"
+
+#include <sstream>
+#include <unordered_map>
+
+#include "utils/fcoi.h"
+#include "utils/logger.h"
+#include "utils/term_walkers.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+// sort and operator names don't need escaping
+static void write_counts(ostream & out, const map<string, size_t> & counts)
+{
+  out << "{";
+  bool first = true;
+  for (const auto & elem : counts) {
+    out << (first ? "" : ", ") << "\"" << elem.first << "\": " << elem.second;
+    first = false;
+  }
+  out << "}";
+}
+
+string DesignStats::to_json() const
+{
+  ostringstream out;
+  out << "{\"statevars\": ";
+  write_counts(out, statevars);
+  out << ", \"inputvars\": ";
+  write_counts(out, inputvars);
+  out << ", \"arrays\": " << arrays << ", \"init_nodes\": " << init_nodes
+      << ", \"trans_nodes\": " << trans_nodes
+      << ", \"constraints\": " << constraints << ", \"props\": " << props
+      << ", \"ops\": ";
+  write_counts(out, ops);
+  out << ", \"cones\": [";
+  for (size_t i = 0; i < cones.size(); ++i) {
+    out << (i ? ", " : "") << "{\"statevars\": " << cones[i].statevars
+        << ", \"inputvars\": " << cones[i].inputvars << "}";
+  }
+  out << "]}";
+  return out.str();
+}
+
+DesignStats compute_design_stats(const TransitionSystem & ts,
+                                 const TermVec & props,
+                                 bool with_coi)
+{
+  DesignStats stats;
+  auto count_vars = [&stats](const UnorderedTermSet & vars,
+                             map<string, size_t> & counts) {
+    for (const auto & v : vars) {
+      Sort sort = v->get_sort();
+      ++counts[sort->to_string()];
+      if (sort->get_sort_kind() == ARRAY) {
+        ++stats.arrays;
+      }
+    }
+  };
+  count_vars(ts.statevars(), stats.statevars);
+  count_vars(ts.inputvars(), stats.inputvars);
+  stats.constraints = ts.constraints().size();
+  stats.props = props.size();
+
+  // one walk of each DAG, the histogram counts the nodes shared by init
+  // and trans once
+  unordered_map<PrimOp, size_t> op_counts;
+  TermOpCollector collector(ts.solver());
+  stats.trans_nodes = collector.add_op_counts(ts.trans(), op_counts);
+  collector.add_op_counts(ts.init(), op_counts);
+  unordered_map<PrimOp, size_t> init_counts;
+  stats.init_nodes =
+      TermOpCollector(ts.solver()).add_op_counts(ts.init(), init_counts);
+  for (const auto & elem : op_counts) {
+    stats.ops[smt::to_string(elem.first)] = elem.second;
+  }
+
+  if (with_coi && !ts.is_functional()) {
+    logger.log(0,
+               "Warning: cones of influence are only computed for "
+               "functional systems");
+  } else if (with_coi) {
+    // the analysis of StaticConeOfInfluence, without rebuilding the system
+    FunctionalConeOfInfluence coi(ts, 0);
+    for (const auto & p : props) {
+      coi.compute_coi({ p });
+      stats.cones.push_back(
+          { coi.statevars_in_coi().size(), coi.inputvars_in_coi().size() });
+    }
+  }
+  return stats;
+}
+
+}  // namespace pono
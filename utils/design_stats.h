@@ -0,0 +1,63 @@
+/*********************                                                        */
+/*! \file design_stats.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Size statistics of a parsed design (--stats-only), used to
+**        estimate the cost of a job before running an engine.
+**
+**/
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "core/ts.h"
+#include "smt-switch/smt.h"
+
+namespace pono {
+
+/** The cone of influence of a property */
+struct ConeSize
+{
+  size_t statevars = 0;
+  size_t inputvars = 0;
+};
+
+struct DesignStats
+{
+  // variables by sort, e.g. "(_ BitVec 8)" or "Bool"
+  std::map<std::string, size_t> statevars;
+  std::map<std::string, size_t> inputvars;
+  size_t arrays = 0;       ///< state and input variables of array sort
+  size_t init_nodes = 0;   ///< DAG nodes of init
+  size_t trans_nodes = 0;  ///< DAG nodes of trans
+  size_t constraints = 0;
+  size_t props = 0;
+  std::map<std::string, size_t> ops;  ///< operator nodes of trans and init
+  std::vector<ConeSize> cones;  ///< per property, empty if not computed
+
+  /** @return the statistics as a JSON object */
+  std::string to_json() const;
+};
+
+/** Collect the size statistics of a system and its properties
+ *  @param ts the transition system
+ *  @param props the properties
+ *  @param with_coi compute the cone of influence of each property, only
+ *         for functional systems
+ *  @return the statistics
+ */
+DesignStats compute_design_stats(const TransitionSystem & ts,
+                                 const smt::TermVec & props,
+                                 bool with_coi);
+
+}  // namespace pono
@@ -0,0 +1,385 @@
+/*********************                                                        */
+/*! \file engine_selector.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Automatic engine and solver selection (--engine auto).
+**
+**/
+
+#include "utils/engine_selector.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <unordered_set>
+
+#include "assert.h"
+#include "smt/available_solvers.h"
+#include "utils/exceptions.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+// the rules are tried in order, so the specific ones come first
+static const string builtin_model = R"(
+# arrays need the abstraction refinement of IC3IA with prophecy variables,
+# and integers and uninterpreted functions its predicate abstraction
+arrays=1 => ic3ia msat --ceg-prophecy-arrays
+ints=1 => ic3ia msat
+ufs=1 => ic3ia msat
+# without MathSAT, k-induction supports these theories
+arrays=1 => ind btor
+ints=1 => ind cvc4
+ufs=1 => ind btor
+# purely Boolean systems (e.g. AIGER) are checked on a CNF encoding
+max_width<=1 => ic3bits btor --ic3bits-sat
+# multipliers and dividers blow up bit-level generalization
+mul_ops>0 => ic3ia msat
+)"
+#ifdef WITH_CUDD
+R"(# small control-dominated systems, before the BDDs blow up
+functional=1 state_bits<=64 => bdd btor
+)"
+#endif
+R"(# word-level IC3 otherwise
+=> mbic3 btor
+)";
+
+static const unordered_set<PrimOp> mul_prim_ops({ BVMul,
+                                                  BVUdiv,
+                                                  BVSdiv,
+                                                  BVUrem,
+                                                  BVSrem,
+                                                  BVSmod,
+                                                  Mult,
+                                                  Div,
+                                                  IntDiv,
+                                                  Mod });
+
+static const unordered_set<PrimOp> arith_prim_ops({ BVAdd,
+                                                    BVSub,
+                                                    BVNeg,
+                                                    BVUlt,
+                                                    BVUle,
+                                                    BVUgt,
+                                                    BVUge,
+                                                    BVSlt,
+                                                    BVSle,
+                                                    BVSgt,
+                                                    BVSge,
+                                                    Plus,
+                                                    Minus,
+                                                    Negate,
+                                                    Lt,
+                                                    Le,
+                                                    Gt,
+                                                    Ge });
+
+static const unordered_set<PrimOp> bit_prim_ops({ BVAnd,
+                                                  BVOr,
+                                                  BVXor,
+                                                  BVNot,
+                                                  BVNand,
+                                                  BVNor,
+                                                  BVXnor,
+                                                  BVShl,
+                                                  BVAshr,
+                                                  BVLshr,
+                                                  Concat,
+                                                  Extract,
+                                                  Zero_Extend,
+                                                  Sign_Extend,
+                                                  Repeat,
+                                                  Rotate_Left,
+                                                  Rotate_Right });
+
+double TsFeatures::get(const string & name) const
+{
+  if (name == "statevars") {
+    return statevars;
+  } else if (name == "inputs") {
+    return inputs;
+  } else if (name == "state_bits") {
+    return state_bits;
+  } else if (name == "functional") {
+    return functional;
+  } else if (name == "arrays") {
+    return arrays;
+  } else if (name == "ints") {
+    return ints;
+  } else if (name == "ufs") {
+    return ufs;
+  } else if (name == "max_width") {
+    return max_width;
+  } else if (name == "nodes") {
+    return nodes;
+  } else if (name == "arith_ops") {
+    return arith_ops;
+  } else if (name == "mul_ops") {
+    return mul_ops;
+  } else if (name == "bit_ops") {
+    return bit_ops;
+  }
+  throw PonoException("Unknown feature: " + name);
+}
+
+string TsFeatures::to_string() const
+{
+  ostringstream out;
+  out << "statevars=" << statevars << " inputs=" << inputs
+      << " state_bits=" << state_bits << " functional=" << functional << " arrays=" << arrays
+      << " ints=" << ints << " ufs=" << ufs << " max_width=" << max_width
+      << " nodes=" << nodes << " arith_ops=" << arith_ops
+      << " mul_ops=" << mul_ops << " bit_ops=" << bit_ops;
+  return out.str();
+}
+
+TsFeatures extract_features(const TransitionSystem & ts, const Term & prop)
+{
+  TsFeatures f;
+  f.statevars = ts.statevars().size();
+  f.inputs = ts.inputvars().size();
+  f.functional = ts.is_functional();
+  for (const auto & sv : ts.statevars()) {
+    Sort sort = sv->get_sort();
+    SortKind sk = sort->get_sort_kind();
+    if (sk == BOOL) {
+      ++f.state_bits;
+    } else if (sk == BV) {
+      f.state_bits += sort->get_width();
+    }
+  }
+
+  UnorderedTermSet visited;
+  TermVec to_visit({ ts.init(), ts.trans(), prop });
+  while (to_visit.size()) {
+    Term t = to_visit.back();
+    to_visit.pop_back();
+    if (!visited.insert(t).second) {
+      continue;
+    }
+
+    Sort sort = t->get_sort();
+    SortKind sk = sort->get_sort_kind();
+    if (sk == ARRAY) {
+      f.arrays = true;
+    } else if (sk == INT || sk == REAL) {
+      f.ints = true;
+    } else if (sk == FUNCTION) {
+      f.ufs = true;
+    } else if (sk == BV) {
+      f.max_width = max<size_t>(f.max_width, sort->get_width());
+    }
+
+    Op op = t->get_op();
+    if (op.is_null()) {
+      continue;
+    }
+    ++f.nodes;
+    if (mul_prim_ops.find(op.prim_op) != mul_prim_ops.end()) {
+      ++f.mul_ops;
+    } else if (arith_prim_ops.find(op.prim_op) != arith_prim_ops.end()) {
+      ++f.arith_ops;
+    } else if (bit_prim_ops.find(op.prim_op) != bit_prim_ops.end()) {
+      ++f.bit_ops;
+    }
+    for (const auto & c : *t) {
+      to_visit.push_back(c);
+    }
+  }
+  return f;
+}
+
+/** @return the solver of a model rule, named as for --smt-solver */
+static SolverEnum solver_from_string(const string & s)
+{
+  if (s == "btor") {
+    return BTOR;
+  } else if (s == "cvc4") {
+    return CVC4;
+  } else if (s == "msat") {
+    return MSAT;
+  }
+  throw PonoException("Unknown solver: " + s);
+}
+
+EngineSelector::EngineSelector()
+{
+  istringstream in(builtin_model);
+  parse(in, "the built-in model");
+}
+
+void EngineSelector::load_model(const string & filename)
+{
+  ifstream in(filename);
+  if (!in.is_open()) {
+    throw PonoException("Could not open engine model " + filename);
+  }
+  parse(in, filename);
+}
+
+void EngineSelector::parse(istream & in, const string & source)
+{
+  vector<SolverEnum> available = available_solver_enums();
+  TsFeatures probe;
+
+  vector<Rule> rules;
+  string line;
+  size_t lineno = 0;
+  while (getline(in, line)) {
+    ++lineno;
+    size_t comment = line.find('#');
+    if (comment != string::npos) {
+      line.erase(comment);
+    }
+    istringstream words(line);
+    string word;
+    if (!(words >> word)) {
+      continue;
+    }
+
+    auto malformed = [&](const string & msg) {
+      return PonoException(msg + " in " + source + ":"
+                           + std::to_string(lineno));
+    };
+
+    Rule r;
+    while (word != "=>") {
+      size_t pos = word.find_first_of("<>=");
+      if (pos == string::npos || !pos) {
+        throw malformed("Expecting a condition <feature><op><value>");
+      }
+      Condition c;
+      c.feature = word.substr(0, pos);
+      size_t len = (word.size() > pos + 1 && word[pos + 1] == '=') ? 2 : 1;
+      c.op = word.substr(pos, len);
+      if (c.op == "==" || c.op == "=>") {
+        throw malformed("Unknown operator " + c.op);
+      }
+      size_t idx = 0;
+      try {
+        c.value = stod(word.substr(pos + len), &idx);
+      }
+      catch (std::logic_error & e) {
+        // invalid_argument or out_of_range
+      }
+      if (!idx || pos + len + idx != word.size()) {
+        throw malformed("Expecting a number in " + word);
+      }
+      try {
+        // check the name of the feature
+        probe.get(c.feature);
+      }
+      catch (PonoException & e) {
+        throw malformed(e.what());
+      }
+      r.conditions.push_back(c);
+      if (!(words >> word)) {
+        throw malformed("Expecting => <engine> <solver>");
+      }
+    }
+
+    string engine, solver;
+    if (!(words >> engine >> solver)) {
+      throw malformed("Expecting => <engine> <solver>");
+    }
+    // klive checks justice properties, not the safety properties here
+    if (str2engine.find(engine) == str2engine.end() || engine == "auto"
+        || engine == "klive") {
+      throw malformed("Unknown engine " + engine);
+    }
+    r.choice.engine = str2engine.at(engine);
+    try {
+      r.choice.solver = solver_from_string(solver);
+    }
+    catch (PonoException & e) {
+      throw malformed(e.what());
+    }
+    while (words >> word) {
+      r.choice.options.push_back(word);
+    }
+    // the text of the rule, for logging
+    r.choice.rule = line.substr(line.find_first_not_of(" \t"));
+    r.choice.rule.erase(r.choice.rule.find_last_not_of(" \t") + 1);
+
+    if (find(available.begin(), available.end(), r.choice.solver)
+        == available.end()) {
+      // e.g. a rule for MathSAT in a build without it
+      continue;
+    }
+    rules.push_back(r);
+  }
+
+  rules_ = rules;
+}
+
+bool EngineSelector::matches(const Rule & r, const TsFeatures & features) const
+{
+  for (const auto & c : r.conditions) {
+    double v = features.get(c.feature);
+    bool holds;
+    if (c.op == "=") {
+      holds = v == c.value;
+    } else if (c.op == "<") {
+      holds = v < c.value;
+    } else if (c.op == "<=") {
+      holds = v <= c.value;
+    } else if (c.op == ">") {
+      holds = v > c.value;
+    } else {
+      assert(c.op == ">=");
+      holds = v >= c.value;
+    }
+    if (!holds) {
+      return false;
+    }
+  }
+  return true;
+}
+
+EngineChoice EngineSelector::select(const TsFeatures & features) const
+{
+  for (const auto & r : rules_) {
+    if (matches(r, features)) {
+      return r.choice;
+    }
+  }
+  throw PonoException("No rule of the engine model matches "
+                      + features.to_string());
+}
+
+vector<Engine> EngineSelector::rank_portfolio(const TsFeatures & features,
+                                              const vector<Engine> & engines,
+                                              size_t max_engines) const
+{
+  vector<Engine> ranked;
+  auto add = [&](Engine e) {
+    if (find(engines.begin(), engines.end(), e) != engines.end()
+        && find(ranked.begin(), ranked.end(), e) == ranked.end()) {
+      ranked.push_back(e);
+    }
+  };
+  for (const auto & r : rules_) {
+    if (matches(r, features)) {
+      add(r.choice.engine);
+    }
+  }
+  for (const auto & e : engines) {
+    add(e);
+  }
+  if (max_engines && ranked.size() > max_engines) {
+    ranked.resize(max_engines);
+  }
+  return ranked;
+}
+
+}  // namespace pono
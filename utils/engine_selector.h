@@ -0,0 +1,128 @@
+/*********************                                                        */
+/*! \file engine_selector.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Automatic engine and solver selection (--engine auto) from cheap
+**        static features of a transition system.
+**
+**        The decision model is a list of rules, the first one whose
+**        conditions all hold picks the engine. A model file has one rule
+**        per line:
+**          <feature><op><value> ... => <engine> <solver> [<options>...]
+**        where op is one of = < <= > >=, and the options are passed as
+**        on the command line (e.g. --ic3-indgen-mode 1). A rule without
+**        conditions always matches. Rules with a solver that is not
+**        available are skipped. Everything after a # is a comment.
+**        The features are named as in TsFeatures::get.
+**
+**/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "core/ts.h"
+#include "options/options.h"
+#include "smt-switch/smt.h"
+
+namespace pono {
+
+/** Static features of a transition system and property */
+struct TsFeatures
+{
+  size_t statevars = 0;
+  size_t inputs = 0;
+  size_t state_bits = 0;  ///< sum of the widths of the state variables
+  bool functional = false;
+  bool arrays = false;
+  bool ints = false;     ///< integer or real variables or terms
+  bool ufs = false;      ///< uninterpreted functions
+  size_t max_width = 0;  ///< widest bit-vector, 0 if none
+  size_t nodes = 0;      ///< operator nodes of init, trans and prop
+  size_t arith_ops = 0;  ///< linear arithmetic (add, sub, neg, comparisons)
+  size_t mul_ops = 0;    ///< multiplication, division and remainder
+  size_t bit_ops = 0;    ///< bitwise ops, shifts, concat and extract
+
+  /** @return the value of a feature by name, as used in a decision model
+   *  @throws PonoException for an unknown feature
+   */
+  double get(const std::string & name) const;
+
+  /** @return the features on one line, for logging */
+  std::string to_string() const;
+};
+
+/** @return the features of init, trans and prop of ts */
+TsFeatures extract_features(const TransitionSystem & ts,
+                            const smt::Term & prop);
+
+/** The configuration picked by EngineSelector */
+struct EngineChoice
+{
+  Engine engine = BMC;
+  smt::SolverEnum solver = smt::BTOR;
+  std::vector<std::string> options;  ///< extra command line options
+  std::string rule;                  ///< the rule that matched
+};
+
+class EngineSelector
+{
+ public:
+  /** Uses the built-in decision model */
+  EngineSelector();
+
+  /** Replace the decision model with the rules of a file
+   *  @throws PonoException if the file can't be read or is malformed
+   */
+  void load_model(const std::string & filename);
+
+  /** @return the configuration of the first matching rule
+   *  @throws PonoException if no rule matches
+   */
+  EngineChoice select(const TsFeatures & features) const;
+
+  /** Order engines for a portfolio, those picked by the matching rules
+   *  first (in rule order) and then the others in their given order
+   *  @param features the features of the system
+   *  @param engines the engines of the portfolio
+   *  @param max_engines keep at most this many, 0 to keep all
+   *  @return the ordered and pruned engines
+   */
+  std::vector<Engine> rank_portfolio(const TsFeatures & features,
+                                     const std::vector<Engine> & engines,
+                                     size_t max_engines = 0) const;
+
+ protected:
+  struct Condition
+  {
+    std::string feature;
+    std::string op;
+    double value;
+  };
+
+  struct Rule
+  {
+    std::vector<Condition> conditions;
+    EngineChoice choice;
+  };
+
+  /** Parse the rules of a model
+   *  @param in the model
+   *  @param source the name of the model, for the error messages
+   */
+  void parse(std::istream & in, const std::string & source);
+
+  bool matches(const Rule & r, const TsFeatures & features) const;
+
+  std::vector<Rule> rules_;
+};
+
+}  // namespace pono
@@ -0,0 +1,170 @@
+/*********************                                                        */
+/*! \file event_stream.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Newline-delimited JSON stream of progress events and results.
+**
+**/
+
+#include "utils/event_stream.h"
+
+#include <cstdio>
+#include <iostream>
+
+using namespace std;
+
+namespace pono {
+
+EventStream event_stream;
+
+// values may be file names or names from the design, escape them
+static string json_string(const string & s)
+{
+  string res = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      res += '\\';
+      res += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char buf[8];
+      snprintf(buf, sizeof(buf), "\\u%04x", c);
+      res += buf;
+    } else {
+      res += c;
+    }
+  }
+  res += "\"";
+  return res;
+}
+
+JsonEvent::JsonEvent(const string & type)
+    : json_("{\"event\": " + json_string(type)
+            + ", \"time\": " + std::to_string(event_stream.seconds()))
+{
+}
+
+JsonEvent & JsonEvent::add_string(const string & key, const string & value)
+{
+  json_ += ", " + json_string(key) + ": " + json_string(value);
+  return *this;
+}
+
+JsonEvent & JsonEvent::add_int(const string & key, int64_t value)
+{
+  json_ += ", " + json_string(key) + ": " + std::to_string(value);
+  return *this;
+}
+
+JsonEvent & JsonEvent::add_double(const string & key, double value)
+{
+  json_ += ", " + json_string(key) + ": " + std::to_string(value);
+  return *this;
+}
+
+EventStream::EventStream()
+    : enabled_(false),
+      start_(chrono::steady_clock::now()),
+      out_(nullptr),
+      dropped_(0),
+      stop_(false)
+{
+}
+
+EventStream::~EventStream() { close(); }
+
+bool EventStream::set_output_file(const string & filename)
+{
+  close();
+  lock_guard<mutex> lock(mutex_);
+  if (filename == "-") {
+    file_.reset();
+    out_ = &cout;
+  } else {
+    file_.reset(new ofstream(filename));
+    if (!file_->is_open()) {
+      file_.reset();
+      return false;
+    }
+    out_ = file_.get();
+  }
+  stop_ = false;
+  writer_ = std::thread([this]() { write_loop(); });
+  enabled_ = true;
+  return true;
+}
+
+double EventStream::seconds() const
+{
+  return chrono::duration<double>(chrono::steady_clock::now() - start_)
+      .count();
+}
+
+void EventStream::emit(const JsonEvent & e, bool droppable)
+{
+  if (!enabled()) {
+    return;
+  }
+  string line = e.line();
+  lock_guard<mutex> lock(mutex_);
+  if (stop_) {
+    return;
+  }
+  if (droppable && pending_.size() >= max_pending_bytes) {
+    ++dropped_;
+    return;
+  }
+  pending_ += line;
+  cv_.notify_one();
+}
+
+size_t EventStream::num_dropped() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return dropped_;
+}
+
+void EventStream::close()
+{
+  enabled_ = false;
+  {
+    lock_guard<mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_one();
+  if (writer_.joinable()) {
+    writer_.join();
+  }
+  lock_guard<mutex> lock(mutex_);
+  file_.reset();
+  out_ = nullptr;
+}
+
+void EventStream::write_loop()
+{
+  unique_lock<mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this]() { return stop_ || !pending_.empty(); });
+    // write outside the lock, the engines keep appending meanwhile
+    string out;
+    out.swap(pending_);
+    bool stop = stop_;
+    lock.unlock();
+    if (out.size()) {
+      out_->write(out.data(), out.size());
+      out_->flush();
+    }
+    if (stop) {
+      return;
+    }
+    lock.lock();
+  }
+}
+
+}  // namespace pono
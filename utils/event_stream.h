@@ -0,0 +1,115 @@
+/*********************                                                        */
+/*! \file event_stream.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Newline-delimited JSON stream of progress events and results,
+**        for services that drive pono (see --json-events).
+**
+**        Events are appended to a buffer and written by a background
+**        thread, so an engine never waits for a slow reader. When the
+**        reader falls behind, progress events are dropped and counted,
+**        results are always kept. When disabled an event costs one
+**        atomic load.
+**
+**/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace pono {
+
+/** One JSON object, built field by field */
+class JsonEvent
+{
+ public:
+  /** Starts the object with the fields event (the type) and time (the
+   *  seconds since the start of the event stream)
+   */
+  JsonEvent(const std::string & type);
+
+  JsonEvent & add_string(const std::string & key, const std::string & value);
+  JsonEvent & add_int(const std::string & key, int64_t value);
+  JsonEvent & add_double(const std::string & key, double value);
+
+  /** @return the object on one line, with the newline */
+  std::string line() const { return json_ + "}\n"; }
+
+ protected:
+  std::string json_;  ///< without the closing brace
+};
+
+// Meant to be used as a singleton class -- instantiated as event_stream
+// below
+class EventStream
+{
+ public:
+  ///< bytes waiting for the writer above which progress events are dropped
+  static constexpr size_t max_pending_bytes = 1 << 24;
+
+  EventStream();
+  ~EventStream();
+
+  /** Open the output and start the writer thread -- enables the stream
+   *  @param filename the file, or - for stdout
+   *  @return false if the file cannot be opened
+   */
+  bool set_output_file(const std::string & filename);
+
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  /** @return seconds since the stream was created */
+  double seconds() const;
+
+  /** Queue an event for the writer (does nothing if not enabled)
+   *  Safe to call from any thread.
+   *  @param e the event
+   *  @param droppable true for progress events, which are dropped while
+   *         max_pending_bytes are waiting
+   */
+  void emit(const JsonEvent & e, bool droppable = true);
+
+  /** @return the number of progress events dropped so far */
+  size_t num_dropped() const;
+
+  /** Write the queued events and stop the writer
+   *  Later events are ignored.
+   */
+  void close();
+
+ protected:
+  void write_loop();
+
+  std::atomic<bool> enabled_;
+  std::chrono::steady_clock::time_point start_;
+
+  std::unique_ptr<std::ofstream> file_;  ///< null when writing to stdout
+  std::ostream * out_;
+
+  mutable std::mutex mutex_;  ///< protects everything but the output
+  std::condition_variable cv_;
+  std::string pending_;  ///< events not written yet
+  size_t dropped_;
+  bool stop_;
+  std::thread writer_;
+};
+
+// globally available event stream
+extern EventStream event_stream;
+
+}  // namespace pono
@@ -0,0 +1,179 @@
+/*********************                                                        */
+/*! \file incremental_coi.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Cone-of-influence queries for many sets of terms over the same
+**        functional transition system.
+**
+**/
+
+#include "utils/incremental_coi.h"
+
+#include <algorithm>
+
+#include "assert.h"
+#include "smt-switch/utils.h"
+#include "utils/exceptions.h"
+#include "utils/logger.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+IncrementalConeOfInfluence::IncrementalConeOfInfluence(
+    const TransitionSystem & ts)
+    : ts_(ts)
+{
+  if (!ts_.is_functional()) {
+    throw PonoException(
+        "Temporary restriction: cone-of-influence analysis "
+        "currently supported for functional transition systems only.");
+  }
+
+  for (const auto & sv : ts_.statevars()) {
+    index_[sv] = vars_.size();
+    vars_.push_back(sv);
+  }
+  num_statevars_ = vars_.size();
+  for (const auto & iv : ts_.inputvars()) {
+    index_[iv] = vars_.size();
+    vars_.push_back(iv);
+  }
+
+  const UnorderedTermMap & updates = ts_.state_updates();
+  deps_.resize(num_statevars_);
+  for (size_t i = 0; i < num_statevars_; ++i) {
+    auto it = updates.find(vars_[i]);
+    if (it != updates.end()) {
+      support(it->second, deps_[i]);
+    }
+  }
+
+  vector<size_t> seeds;
+  for (const auto & e : ts_.constraints()) {
+    support(e.first, seeds);
+  }
+  vector<bool> marked(vars_.size(), false);
+  vector<size_t> todo;
+  for (auto i : seeds) {
+    if (!marked[i]) {
+      marked[i] = true;
+      constraints_cone_.push_back(i);
+      todo.push_back(i);
+    }
+  }
+  reach(todo, marked, constraints_cone_);
+  sort(constraints_cone_.begin(), constraints_cone_.end());
+
+  logger.log(1,
+             "COI dependency graph: {} state variables, {} input variables, "
+             "{} variables in the cone of the constraints",
+             num_statevars_,
+             vars_.size() - num_statevars_,
+             constraints_cone_.size());
+}
+
+void IncrementalConeOfInfluence::compute_coi(const TermVec & terms,
+                                             UnorderedTermSet & statevars,
+                                             UnorderedTermSet & inputvars)
+{
+  for (auto i : cone(terms)) {
+    if (i < num_statevars_) {
+      statevars.insert(vars_[i]);
+    } else {
+      inputvars.insert(vars_[i]);
+    }
+  }
+}
+
+size_t IncrementalConeOfInfluence::cone_size(const TermVec & terms)
+{
+  return cone(terms).size();
+}
+
+TransitionSystem IncrementalConeOfInfluence::reduced_ts(const TermVec & terms)
+{
+  UnorderedTermSet statevars, inputvars;
+  compute_coi(terms, statevars, inputvars);
+  TransitionSystem reduced(ts_);
+  reduced.rebuild_trans_based_on_coi(statevars, inputvars);
+  return reduced;
+}
+
+const vector<size_t> & IncrementalConeOfInfluence::cone(const TermVec & terms)
+{
+  vector<size_t> key;
+  for (const auto & t : terms) {
+    support(t, key);
+  }
+  sort(key.begin(), key.end());
+  key.erase(unique(key.begin(), key.end()), key.end());
+
+  auto it = cones_.find(key);
+  if (it != cones_.end()) {
+    return it->second;
+  }
+
+  vector<bool> marked(vars_.size(), false);
+  vector<size_t> result = constraints_cone_;
+  for (auto i : result) {
+    marked[i] = true;
+  }
+  vector<size_t> todo;
+  for (auto i : key) {
+    if (!marked[i]) {
+      marked[i] = true;
+      result.push_back(i);
+      todo.push_back(i);
+    }
+  }
+  reach(todo, marked, result);
+  sort(result.begin(), result.end());
+
+  logger.log(2, "COI: {} variables in the cone", result.size());
+  return cones_.emplace(key, std::move(result)).first->second;
+}
+
+void IncrementalConeOfInfluence::support(const Term & t,
+                                         vector<size_t> & indices) const
+{
+  UnorderedTermSet free_vars;
+  get_free_symbolic_consts(t, free_vars);
+  for (const auto & v : free_vars) {
+    auto it = index_.find(v);
+    // next state variables are not in the graph
+    if (it != index_.end()) {
+      indices.push_back(it->second);
+    }
+  }
+}
+
+void IncrementalConeOfInfluence::reach(vector<size_t> & todo,
+                                       vector<bool> & marked,
+                                       vector<size_t> & result) const
+{
+  while (!todo.empty()) {
+    size_t i = todo.back();
+    todo.pop_back();
+    if (i >= num_statevars_) {
+      continue;
+    }
+    for (auto d : deps_[i]) {
+      if (!marked[d]) {
+        marked[d] = true;
+        result.push_back(d);
+        todo.push_back(d);
+      }
+    }
+  }
+}
+
+}  // namespace pono
@@ -0,0 +1,91 @@
+/*********************                                                        */
+/*! \file incremental_coi.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Cone-of-influence queries for many sets of terms over the same
+**        functional transition system. The state updates and constraints
+**        are traversed once to build the dependency graph of the
+**        variables, then each cone is found by reachability in the graph.
+**
+**/
+
+#pragma once
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "core/ts.h"
+
+namespace pono {
+
+class IncrementalConeOfInfluence
+{
+ public:
+  /** Builds the dependency graph of the state updates of ts
+   *  @param ts the functional transition system, which must not be modified
+   *         while this object is used
+   *  @throws PonoException if ts is not functional
+   */
+  IncrementalConeOfInfluence(const TransitionSystem & ts);
+
+  /** Compute the cone-of-influence of terms, with the same variables as
+   *  FunctionalConeOfInfluence: the variables of the terms and of the
+   *  constraints, and the variables of the updates of the state variables
+   *  in the cone
+   *  @param terms the terms to keep
+   *  @param statevars set to add the state variables of the cone to
+   *  @param inputvars set to add the input variables of the cone to
+   */
+  void compute_coi(const smt::TermVec & terms,
+                   smt::UnorderedTermSet & statevars,
+                   smt::UnorderedTermSet & inputvars);
+
+  /** @return the number of state and input variables in the cone of terms
+   *          e.g. to check the properties with the smallest cones first
+   */
+  size_t cone_size(const smt::TermVec & terms);
+
+  /** @return a copy of the system reduced to the cone of terms */
+  TransitionSystem reduced_ts(const smt::TermVec & terms);
+
+ protected:
+  /** @return the (sorted) indices of the variables in the cone of terms
+   *  The cones are cached by the variables of the terms.
+   */
+  const std::vector<size_t> & cone(const smt::TermVec & terms);
+
+  /** Add the variables of t to the (possibly unsorted) vector of indices */
+  void support(const smt::Term & t, std::vector<size_t> & indices) const;
+
+  /** Add the variables reachable from the marked ones in the dependency
+   *  graph to result and mark them
+   *  @param todo the marked variables to visit
+   *  @param marked the marks of the variables
+   *  @param result the vector of the marked variables
+   */
+  void reach(std::vector<size_t> & todo,
+             std::vector<bool> & marked,
+             std::vector<size_t> & result) const;
+
+  const TransitionSystem & ts_;
+
+  smt::TermVec vars_;  ///< the state variables, then the input variables
+  size_t num_statevars_;
+  std::unordered_map<smt::Term, size_t> index_;
+  /** the variables of the update of each state variable */
+  std::vector<std::vector<size_t>> deps_;
+  /** the cone of the constraints, part of every cone */
+  std::vector<size_t> constraints_cone_;
+  /** cones by the sorted variables of the terms */
+  std::map<std::vector<size_t>, std::vector<size_t>> cones_;
+};
+
+}  // namespace pono
@@ -0,0 +1,473 @@
+/*********************                                                        */
+/*! \file invariant_miner.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Mines candidate invariants over the state variables from random
+**        simulation traces and prunes them to an inductive subset with
+**        the Houdini algorithm.
+**
+**/
+
+#include "utils/invariant_miner.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+
+#include "smt-switch/term_translator.h"
+#include "smt/available_solvers.h"
+#include "utils/bit_parallel_simulator.h"
+#include "utils/exceptions.h"
+#include "utils/lemma_cache.h"
+#include "utils/logger.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+namespace {
+
+uint64_t mix(uint64_t h, uint64_t x)
+{
+  h ^= x + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+  return h;
+}
+
+// what was observed of a state variable in all the simulated cycles
+struct VarSamples
+{
+  uint64_t signature = 0;  ///< hash of all the values
+  uint64_t seen0 = 0;      ///< bits that were 0 at least once
+  uint64_t seen1 = 0;      ///< bits that were 1 at least once
+  bool multi = false;      ///< more than one bit set at least once
+  bool none = false;       ///< no bit set at least once
+  uint64_t max = 0;
+  uint64_t min = ~uint64_t(0);
+};
+
+// a solver with the system and the candidates, used by one thread
+struct HoudiniWorker
+{
+  SmtSolver solver;
+  Term init;
+  Term trans;
+  Term true_;
+  TermVec curr;
+  TermVec next;
+};
+
+}  // namespace
+
+InvariantMiner::InvariantMiner(const TransitionSystem & ts,
+                               size_t threads,
+                               size_t lanes,
+                               size_t cycles,
+                               unsigned int seed)
+    : ts_(ts),
+      threads_(std::max<size_t>(threads, 1)),
+      lanes_(lanes),
+      cycles_(cycles),
+      seed_(seed)
+{
+}
+
+TermVec InvariantMiner::mine() const
+{
+  TermVec candidates;
+  if (!ts_.is_functional()) {
+    logger.log(1, "Invariant mining skipped: system is not functional");
+    return candidates;
+  }
+
+  TermVec vars(ts_.statevars().begin(), ts_.statevars().end());
+  // deterministic candidates
+  sort(vars.begin(), vars.end(), [](const Term & a, const Term & b) {
+    return a->get_id() < b->get_id();
+  });
+
+  unique_ptr<BitParallelSimulator> sim;
+  vector<uint32_t> ids;
+  try {
+    sim.reset(new BitParallelSimulator(ts_, lanes_, seed_));
+    for (const auto & v : vars) {
+      ids.push_back(sim->add_output(v));
+    }
+  }
+  catch (PonoException & e) {
+    logger.log(1, "Invariant mining skipped: {}", e.what());
+    return candidates;
+  }
+
+  size_t n = vars.size();
+  vector<uint32_t> widths(n);
+  // the 1-bit state variables paired for implications
+  vector<size_t> bits1;
+  for (size_t i = 0; i < n; ++i) {
+    Sort sort = vars[i]->get_sort();
+    widths[i] = sort->get_sort_kind() == BOOL ? 1 : sort->get_width();
+    if (widths[i] == 1 && bits1.size() < max_bool_pairs) {
+      bits1.push_back(i);
+    }
+  }
+  size_t nb = bits1.size();
+  // for each pair, the combinations of their values that were seen:
+  // 1 for (1, 0), 2 for (0, 1), 4 for (1, 1) and 8 for (0, 0)
+  vector<uint8_t> pairs(nb * nb, 0);
+
+  vector<VarSamples> samples(n);
+  size_t words = sim->num_lanes() / 64;
+  vector<uint64_t> seen(words), dup(words), cand(words), hits(words);
+
+  // the max or min value over the traces
+  auto extreme = [&](uint32_t id, uint32_t w, bool maximum) {
+    const vector<uint64_t> & alive = sim->alive();
+    cand = alive;
+    uint64_t v = 0;
+    for (uint32_t b = w; b-- > 0;) {
+      const uint64_t * p = sim->bits(id, b);
+      bool any = false;
+      for (size_t k = 0; k < words; ++k) {
+        hits[k] = cand[k] & (maximum ? p[k] : ~p[k]);
+        any |= hits[k] != 0;
+      }
+      if (any) {
+        cand.swap(hits);
+      }
+      if (any == maximum) {
+        v |= uint64_t(1) << b;
+      }
+    }
+    return v;
+  };
+
+  if (!sim->reset()) {
+    logger.log(1, "Invariant mining skipped: no initial state found");
+    return candidates;
+  }
+  for (size_t c = 0; c < cycles_; ++c) {
+    if (c && !sim->step()) {
+      break;
+    }
+    const vector<uint64_t> & alive = sim->alive();
+    for (size_t i = 0; i < n; ++i) {
+      VarSamples & s = samples[i];
+      fill(seen.begin(), seen.end(), 0);
+      fill(dup.begin(), dup.end(), 0);
+      for (uint32_t b = 0; b < widths[i]; ++b) {
+        const uint64_t * p = sim->bits(ids[i], b);
+        for (size_t k = 0; k < words; ++k) {
+          uint64_t x = p[k] & alive[k];
+          s.signature = mix(s.signature, x);
+          if (x) {
+            s.seen1 |= uint64_t(1) << b;
+          }
+          if (~p[k] & alive[k]) {
+            s.seen0 |= uint64_t(1) << b;
+          }
+          dup[k] |= seen[k] & x;
+          seen[k] |= x;
+        }
+      }
+      if (widths[i] > 1) {
+        for (size_t k = 0; k < words; ++k) {
+          s.multi |= dup[k] != 0;
+          s.none |= (alive[k] & ~seen[k]) != 0;
+        }
+        s.max = std::max(s.max, extreme(ids[i], widths[i], true));
+        s.min = std::min(s.min, extreme(ids[i], widths[i], false));
+      }
+    }
+
+    for (size_t a = 0; a < nb; ++a) {
+      const uint64_t * pa = sim->bits(ids[bits1[a]], 0);
+      for (size_t b = a + 1; b < nb; ++b) {
+        const uint64_t * pb = sim->bits(ids[bits1[b]], 0);
+        uint8_t & f = pairs[a * nb + b];
+        for (size_t k = 0; k < words; ++k) {
+          uint64_t al = alive[k];
+          f |= (pa[k] & ~pb[k] & al) ? 1 : 0;
+          f |= (~pa[k] & pb[k] & al) ? 2 : 0;
+          f |= (pa[k] & pb[k] & al) ? 4 : 0;
+          f |= (~pa[k] & ~pb[k] & al) ? 8 : 0;
+        }
+      }
+    }
+  }
+
+  const SmtSolver & solver = ts_.solver();
+  auto value = [&](uint64_t v, const Sort & sort) {
+    return sort->get_sort_kind() == BOOL
+               ? solver->make_term(v != 0)
+               : solver->make_term(std::to_string(v), sort);
+  };
+
+  // only the first variable of each class of equal variables gets the
+  // other candidates
+  vector<bool> is_rep(n, false);
+  unordered_map<uint64_t, TermVec> classes;
+  for (size_t i = 0; i < n; ++i) {
+    const Term & v = vars[i];
+    Sort sort = v->get_sort();
+    const VarSamples & s = samples[i];
+    if (!(s.seen0 & s.seen1)) {
+      candidates.push_back(
+          solver->make_term(Equal, v, value(s.seen1, sort)));
+      continue;
+    }
+
+    TermVec & cls = classes[s.signature];
+    Term rep;
+    for (const auto & r : cls) {
+      if (r->get_sort() == sort) {
+        rep = r;
+        break;
+      }
+    }
+    if (rep) {
+      candidates.push_back(solver->make_term(Equal, v, rep));
+      continue;
+    }
+    cls.push_back(v);
+    is_rep[i] = true;
+
+    if (widths[i] == 1) {
+      continue;
+    }
+    Term zero = solver->make_term(0, sort);
+    if (!s.multi) {
+      Term one = solver->make_term(1, sort);
+      Term amo = solver->make_term(
+          Equal,
+          solver->make_term(BVAnd, v, solver->make_term(BVSub, v, one)),
+          zero);
+      candidates.push_back(
+          s.none ? amo
+                 : solver->make_term(
+                     And, amo, solver->make_term(Distinct, v, zero)));
+    }
+    uint64_t mask = widths[i] == 64 ? ~uint64_t(0)
+                                    : (uint64_t(1) << widths[i]) - 1;
+    if (s.max < mask) {
+      candidates.push_back(
+          solver->make_term(BVUle, v, value(s.max, sort)));
+    }
+    if (s.min > 0) {
+      candidates.push_back(
+          solver->make_term(BVUge, v, value(s.min, sort)));
+    }
+  }
+
+  // literal of a 1-bit state variable
+  auto lit = [&](const Term & v) {
+    Sort sort = v->get_sort();
+    return sort->get_sort_kind() == BOOL
+               ? v
+               : solver->make_term(Equal, v, solver->make_term(1, sort));
+  };
+  for (size_t a = 0; a < nb; ++a) {
+    if (!is_rep[bits1[a]]) {
+      continue;
+    }
+    Term la = lit(vars[bits1[a]]);
+    for (size_t b = a + 1; b < nb; ++b) {
+      if (!is_rep[bits1[b]]) {
+        continue;
+      }
+      Term lb = lit(vars[bits1[b]]);
+      uint8_t f = pairs[a * nb + b];
+      if (!(f & 1)) {
+        candidates.push_back(solver->make_term(Implies, la, lb));
+      }
+      if (!(f & 2)) {
+        candidates.push_back(solver->make_term(Implies, lb, la));
+      }
+      if (!(f & 4)) {
+        candidates.push_back(
+            solver->make_term(Not, solver->make_term(And, la, lb)));
+      }
+      if (!(f & 8)) {
+        candidates.push_back(solver->make_term(Or, la, lb));
+      }
+    }
+  }
+
+  logger.log(1,
+             "Invariant mining: {} candidates after simulating {} cycles",
+             candidates.size(),
+             sim->num_cycles());
+  return candidates;
+}
+
+TermVec InvariantMiner::prune(const TermVec & candidates) const
+{
+  TermVec invariants;
+  size_t n = candidates.size();
+  if (!n) {
+    return invariants;
+  }
+  size_t num_threads = std::min(threads_, n);
+
+  // all the terms are transferred on this thread, and the threads only
+  // use their own solver
+  vector<HoudiniWorker> workers(num_threads);
+  for (auto & w : workers) {
+    w.solver = create_solver(ts_.solver()->get_solver_enum());
+    w.solver->set_opt("incremental", "true");
+    TermTranslator tt(w.solver);
+    w.init = tt.transfer_term(ts_.init(), BOOL);
+    w.trans = tt.transfer_term(ts_.trans(), BOOL);
+    w.true_ = w.solver->make_term(true);
+    w.curr.reserve(n);
+    w.next.reserve(n);
+    for (const auto & c : candidates) {
+      w.curr.push_back(tt.transfer_term(c, BOOL));
+      w.next.push_back(tt.transfer_term(ts_.next(c), BOOL));
+    }
+  }
+
+  vector<char> active(n, 1);
+  // set by the thread checking the slice of the candidate
+  vector<char> dropped(n, 0);
+
+  // thread t drops the candidates in its slice that are false in a model
+  // of init (base) or of trans and the active candidates (step)
+  auto check = [&](size_t t, bool base) {
+    HoudiniWorker & w = workers[t];
+    const size_t begin = t * n / num_threads;
+    const size_t end = (t + 1) * n / num_threads;
+    const TermVec & goals = base ? w.curr : w.next;
+
+    w.solver->push();
+    w.solver->assert_formula(base ? w.init : w.trans);
+    if (!base) {
+      for (size_t j = 0; j < n; ++j) {
+        if (active[j]) {
+          w.solver->assert_formula(w.curr[j]);
+        }
+      }
+    }
+    while (true) {
+      Term some_false;
+      for (size_t j = begin; j < end; ++j) {
+        if (active[j] && !dropped[j]) {
+          Term f = w.solver->make_term(Not, goals[j]);
+          some_false = some_false ? w.solver->make_term(Or, some_false, f) : f;
+        }
+      }
+      if (!some_false) {
+        break;
+      }
+
+      w.solver->push();
+      w.solver->assert_formula(some_false);
+      Result r = w.solver->check_sat();
+      for (size_t j = begin; j < end; ++j) {
+        if (!active[j] || dropped[j]) {
+          continue;
+        }
+        if (r.is_unknown()
+            || (r.is_sat() && w.solver->get_value(goals[j]) != w.true_)) {
+          dropped[j] = 1;
+        }
+      }
+      w.solver->pop();
+      if (!r.is_sat()) {
+        break;
+      }
+    }
+    w.solver->pop();
+  };
+
+  // @return true iff a candidate was dropped
+  auto round = [&](bool base) {
+    fill(dropped.begin(), dropped.end(), 0);
+    if (num_threads == 1) {
+      check(0, base);
+    } else {
+      vector<thread> threads;
+      threads.reserve(num_threads);
+      for (size_t t = 0; t < num_threads; ++t) {
+        threads.push_back(thread(check, t, base));
+      }
+      for (auto & t : threads) {
+        t.join();
+      }
+    }
+    bool any = false;
+    for (size_t j = 0; j < n; ++j) {
+      if (dropped[j]) {
+        active[j] = 0;
+        any = true;
+      }
+    }
+    return any;
+  };
+
+  round(true);
+  size_t rounds = 1;
+  while (round(false)) {
+    ++rounds;
+  }
+
+  for (size_t j = 0; j < n; ++j) {
+    if (active[j]) {
+      invariants.push_back(candidates[j]);
+      logger.log(2, "Invariant mining: proved {}", candidates[j]);
+    }
+  }
+  logger.log(1,
+             "Invariant mining: {} of {} candidates are invariants after {} "
+             "Houdini rounds",
+             invariants.size(),
+             n,
+             rounds);
+  return invariants;
+}
+
+TermVec migrate_invariants(const TransitionSystem & ts,
+                           const string & filename,
+                           size_t threads)
+{
+  vector<TermVec> clauses;
+  if (!read_lemma_cache_by_name(filename, ts, clauses)) {
+    logger.log(1, "Migration: no lemma cache {}", filename);
+    return {};
+  }
+
+  const SmtSolver & solver = ts.solver();
+  TermVec candidates;
+  UnorderedTermSet seen;
+  for (const auto & children : clauses) {
+    Term clause;
+    for (const auto & c : children) {
+      if (c->get_sort()->get_sort_kind() != BOOL) {
+        // a boolean variable that became a bit-vector
+        clause = nullptr;
+        break;
+      }
+      clause = clause ? solver->make_term(Or, clause, c) : c;
+    }
+    if (clause && seen.insert(clause).second) {
+      candidates.push_back(clause);
+    }
+  }
+  logger.log(1,
+             "Migration: {} of the {} clauses of {} are over this revision",
+             candidates.size(),
+             clauses.size(),
+             filename);
+
+  InvariantMiner miner(ts, threads);
+  return miner.prune(candidates);
+}
+
+}  // namespace pono
@@ -0,0 +1,92 @@
+/*********************                                                        */
+/*! \file invariant_miner.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Mines candidate invariants over the state variables from random
+**        simulation traces and prunes them to an inductive subset with
+**        the Houdini algorithm.
+**
+**        The candidates hold in every simulated cycle:
+**          - a state variable is constant, or equal to another
+**          - an implication (or exclusion) between two boolean state
+**            variables
+**          - a bit-vector state variable is one-hot, has at most one bit
+**            set, or is within the range of its simulated values
+**
+**        Each round of Houdini checks the candidates in slices over several
+**        threads, each with its own solver, assuming all the candidates
+**        that were not dropped before the round. The rounds end when none
+**        is dropped, and then the remaining candidates are invariants.
+**
+**/
+
+#pragma once
+
+#include <string>
+
+#include "core/ts.h"
+#include "smt-switch/smt.h"
+
+namespace pono {
+
+class InvariantMiner
+{
+ public:
+  /** @param ts a functional transition system
+   *  @param threads the number of threads used by prune
+   *  @param lanes the number of simulated traces, a positive multiple of 64
+   *  @param cycles the length of the simulated traces
+   *  @param seed the seed for the random simulation
+   */
+  InvariantMiner(const TransitionSystem & ts,
+                 size_t threads = 1,
+                 size_t lanes = 256,
+                 size_t cycles = 64,
+                 unsigned int seed = 0);
+
+  /** Simulate the system and collect the candidates
+   *  @return the candidates, over the current state variables of ts.
+   *          Empty if the system cannot be simulated.
+   */
+  smt::TermVec mine() const;
+
+  /** Drop candidates until the others are inductive
+   *  @param candidates terms over the current state variables of ts
+   *  @return the candidates that hold in all reachable states
+   */
+  smt::TermVec prune(const smt::TermVec & candidates) const;
+
+ protected:
+  const TransitionSystem & ts_;
+  size_t threads_;
+  size_t lanes_;
+  size_t cycles_;
+  unsigned int seed_;
+
+  ///< boolean state variables paired for implications
+  static constexpr size_t max_bool_pairs = 128;
+};
+
+/** Migrate the clauses of a previous revision of a design
+ *  Reads a lemma cache (e.g. written by IC3 with --ic3-lemma-cache, or a
+ *  --kind-invariants file) of any revision, maps its state variables to
+ *  those of ts by name and sort, and prunes the clauses to an inductive
+ *  subset with the Houdini algorithm (see InvariantMiner::prune).
+ *  @param ts the system of the new revision
+ *  @param filename the lemma cache
+ *  @param threads the number of threads of the pruning
+ *  @return the clauses that are invariants of ts, as disjunctions
+ *  @throws PonoException if the file is malformed
+ */
+smt::TermVec migrate_invariants(const TransitionSystem & ts,
+                                const std::string & filename,
+                                size_t threads = 1);
+
+}  // namespace pono
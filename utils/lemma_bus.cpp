@@ -0,0 +1,163 @@
+/*********************                                                        */
+/*! \file lemma_bus.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Thread-safe exchange of lemmas and bounds between engines that
+**        run concurrently on the same property (see utils/portfolio.h).
+**
+**/
+
+#include "utils/lemma_bus.h"
+
+#include <algorithm>
+
+#include "assert.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+LemmaBus::LemmaBus(const SmtSolver & solver)
+    : solver_(solver), safe_bound_(-1), epochs_(false), pending_safe_bound_(-1)
+{
+}
+
+void LemmaBus::publish_lemma(const TermVec & children,
+                             TermTranslator & to_bus,
+                             const void * source,
+                             Statistics * stats,
+                             int frame)
+{
+  assert(children.size());
+  TimedLockGuard lock(mutex_, stats);
+
+  TermVec bus_children;
+  bus_children.reserve(children.size());
+  for (const auto & c : children) {
+    bus_children.push_back(to_bus.transfer_term(c, BOOL));
+  }
+
+  if (epochs_) {
+    pending_.push_back({ bus_children, source, frame });
+    return;
+  }
+  add_lemma(bus_children, source, frame);
+}
+
+void LemmaBus::add_lemma(const TermVec & bus_children,
+                         const void * source,
+                         int frame)
+{
+  Term clause = bus_children[0];
+  for (size_t i = 1; i < bus_children.size(); ++i) {
+    clause = solver_->make_term(Or, clause, bus_children[i]);
+  }
+  auto it = lemma_frames_.find(clause);
+  bool repeated = it != lemma_frames_.end();
+  if (repeated && it->second >= frame) {
+    return;
+  }
+  lemma_frames_[clause] = frame;
+  lemmas_.push_back(bus_children);
+  sources_.push_back(source);
+  frames_.push_back(frame);
+  repeated_.push_back(repeated);
+}
+
+void LemmaBus::import_lemmas(size_t & idx,
+                             TermTranslator & from_bus,
+                             const void * source,
+                             vector<TermVec> & out,
+                             Statistics * stats)
+{
+  TimedLockGuard lock(mutex_, stats);
+  for (; idx < lemmas_.size(); ++idx) {
+    if (sources_[idx] == source || repeated_[idx]) {
+      continue;
+    }
+    TermVec children;
+    children.reserve(lemmas_[idx].size());
+    for (const auto & c : lemmas_[idx]) {
+      children.push_back(from_bus.transfer_term(c, BOOL));
+    }
+    out.push_back(children);
+  }
+}
+
+void LemmaBus::import_frame_lemmas(size_t & idx,
+                                   TermTranslator & from_bus,
+                                   const void * source,
+                                   vector<TermVec> & out,
+                                   vector<int> & frames,
+                                   Statistics * stats)
+{
+  TimedLockGuard lock(mutex_, stats);
+  for (; idx < lemmas_.size(); ++idx) {
+    if (sources_[idx] == source || frames_[idx] < 0) {
+      continue;
+    }
+    TermVec children;
+    children.reserve(lemmas_[idx].size());
+    for (const auto & c : lemmas_[idx]) {
+      children.push_back(from_bus.transfer_term(c, BOOL));
+    }
+    out.push_back(children);
+    frames.push_back(frames_[idx]);
+  }
+}
+
+size_t LemmaBus::num_lemmas() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return lemmas_.size();
+}
+
+void LemmaBus::publish_safe_bound(int k)
+{
+  if (epochs_) {
+    lock_guard<mutex> lock(mutex_);
+    pending_safe_bound_ = max(pending_safe_bound_, k);
+    return;
+  }
+  int cur = safe_bound_;
+  while (cur < k && !safe_bound_.compare_exchange_weak(cur, k)) {
+  }
+}
+
+void LemmaBus::register_source(const void * source)
+{
+  lock_guard<mutex> lock(mutex_);
+  source_ranks_.emplace(source, source_ranks_.size());
+}
+
+void LemmaBus::end_epoch()
+{
+  lock_guard<mutex> lock(mutex_);
+  auto rank = [this](const void * source) {
+    auto it = source_ranks_.find(source);
+    return it == source_ranks_.end() ? source_ranks_.size() : it->second;
+  };
+  // the publications of each publisher stay in their order
+  stable_sort(pending_.begin(),
+              pending_.end(),
+              [&](const PendingLemma & a, const PendingLemma & b) {
+                return rank(a.source) < rank(b.source);
+              });
+  for (const auto & l : pending_) {
+    add_lemma(l.children, l.source, l.frame);
+  }
+  pending_.clear();
+  if (pending_safe_bound_ > safe_bound_) {
+    safe_bound_ = pending_safe_bound_;
+  }
+}
+
+}  // namespace pono
@@ -0,0 +1,163 @@
+/*********************                                                        */
+/*! \file lemma_bus.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Thread-safe exchange of lemmas and bounds between engines that
+**        run concurrently on the same property (see utils/portfolio.h).
+**
+**        Lemmas are clauses over the current state variables and are
+**        stored in the solver of the original transition system. They
+**        are only candidates: an importing engine must check them
+**        (e.g. relative induction) before using them.
+**
+**        A lemma may come with a frame i, if it holds in every state
+**        reachable with at most i transitions (e.g. a lemma of IC3 frame
+**        i). These can be used up to that bound without checking them.
+**
+**        The safe bound is a k such that there is no counterexample
+**        with k or fewer transitions.
+**
+**        In epoch mode (for --deterministic) publications are held back
+**        until end_epoch, which makes them visible ordered by the rank
+**        of their publisher, so what an engine imports does not depend
+**        on the timing of the others.
+**
+**/
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "smt-switch/smt.h"
+#include "utils/statistics.h"
+
+namespace pono {
+
+class LemmaBus
+{
+ public:
+  /** @param solver the solver of the original transition system
+   *         all lemmas on the bus are terms of this solver and it must
+   *         not be used by anything else while the bus is in use
+   */
+  LemmaBus(const smt::SmtSolver & solver);
+
+  const smt::SmtSolver & solver() const { return solver_; }
+
+  /** Publish a clause
+   *  @param children the literals of the clause in the publisher's solver
+   *  @param to_bus a translator from the publisher's solver to solver()
+   *         only used while holding the bus lock
+   *  @param source identifies the publisher
+   *  @param stats statistics of the publisher for the time spent waiting
+   *         for the bus lock (may be null)
+   *  @param frame the clause holds in every state reachable with at most
+   *         frame transitions, -1 if it is only a candidate
+   *         A clause that is already on the bus is published again only
+   *         if its frame grows, for import_frame_lemmas.
+   */
+  void publish_lemma(const smt::TermVec & children,
+                     smt::TermTranslator & to_bus,
+                     const void * source,
+                     Statistics * stats = nullptr,
+                     int frame = -1);
+
+  /** Import all the clauses published since a previous import
+   *  @param idx the number of clauses already imported, updated to the
+   *         total number of clauses
+   *  @param from_bus a translator from solver() to the importer's solver
+   *         only used while holding the bus lock
+   *  @param source identifies the importer, its own clauses are skipped
+   *  @param out vector to append the literals of each new clause to
+   *  @param stats statistics of the importer for the time spent waiting
+   *         for the bus lock (may be null)
+   */
+  void import_lemmas(size_t & idx,
+                     smt::TermTranslator & from_bus,
+                     const void * source,
+                     std::vector<smt::TermVec> & out,
+                     Statistics * stats = nullptr);
+
+  /** Import the clauses with a frame published since a previous import
+   *  including the clauses published again with a larger frame
+   *  @param idx the number of clauses already imported, updated to the
+   *         total number of clauses
+   *  @param from_bus a translator from solver() to the importer's solver
+   *  @param source identifies the importer, its own clauses are skipped
+   *  @param out vector to append the literals of each new clause to
+   *  @param frames vector to append the frame of each new clause to
+   *  @param stats statistics of the importer (may be null)
+   */
+  void import_frame_lemmas(size_t & idx,
+                           smt::TermTranslator & from_bus,
+                           const void * source,
+                           std::vector<smt::TermVec> & out,
+                           std::vector<int> & frames,
+                           Statistics * stats = nullptr);
+
+  size_t num_lemmas() const;
+
+  /** Publish that there is no counterexample with k or fewer transitions */
+  void publish_safe_bound(int k);
+
+  /** @return the largest published safe bound (-1 if none) */
+  int safe_bound() const { return safe_bound_; }
+
+  /** Hold back the publications until end_epoch
+   *  Must be set before anything is published.
+   */
+  void set_epoch_mode(bool epochs) { epochs_ = epochs; }
+
+  /** Register a publisher, the publications of an epoch are ordered by
+   *  the order of registration of their publishers (unregistered ones
+   *  last)
+   */
+  void register_source(const void * source);
+
+  /** Make the publications held back since the previous epoch visible
+   *  Must not be called while the publishers run.
+   */
+  void end_epoch();
+
+ private:
+  /** Add a clause of the bus solver, requires holding mutex_ */
+  void add_lemma(const smt::TermVec & bus_children,
+                 const void * source,
+                 int frame);
+
+  struct PendingLemma
+  {
+    smt::TermVec children;  ///< in the bus solver
+    const void * source;
+    int frame;
+  };
+
+  smt::SmtSolver solver_;
+
+  mutable std::mutex mutex_;
+  std::vector<smt::TermVec> lemmas_;
+  std::vector<const void *> sources_;  ///< publisher of each lemma
+  std::vector<int> frames_;            ///< frame of each lemma, or -1
+  std::vector<bool> repeated_;  ///< published before with a smaller frame
+  ///< largest frame of each clause, for skipping duplicates
+  std::unordered_map<smt::Term, int> lemma_frames_;
+
+  std::atomic<int> safe_bound_;
+
+  bool epochs_;
+  std::unordered_map<const void *, size_t> source_ranks_;
+  std::vector<PendingLemma> pending_;  ///< held back until end_epoch
+  int pending_safe_bound_;
+};
+
+}  // namespace pono
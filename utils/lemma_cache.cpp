@@ -0,0 +1,1113 @@
+/*********************                                                        */
+/*! \file lemma_cache.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Saves clauses over the state variables of a transition system to
+**        a file and loads them in a later run.
+**
+**        The file is line based. Terms are written in post-order, one per
+**        line, and refer to their children by their line id:
+**          t <id> s <state variable name>
+**          t <id> v <sort> <value>
+**          t <id> o <op> <num indices> <idx0> <idx1> <num children> <ids>
+**        followed by the clauses:
+**          l <num literals> <ids>
+**
+**        A result cache entry writes the variables by their position in
+**        the canonical order instead (t <id> c <position>, and
+**        t <id> n <position> for a next state variable), followed by the
+**        system it was computed for, compared on lookup so that a
+**        collision of the hashes is a miss
+**          prop <id>
+**          init <id>
+**          trans <id>
+**        and the result
+**          result <true|false>
+**          invar <id>
+**          steps <number of steps>
+**          cex <step> <position> <id of the value>
+**
+**        A predicate cache is a sequence of sections appended by the runs,
+**        each a line "section" (the term ids start over) followed by term
+**        lines and the predicates:
+**          p <id>
+**
+**/
+
+#include "utils/lemma_cache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#include <unistd.h>
+
+#include "assert.h"
+#include "utils/exceptions.h"
+#include "utils/logger.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+static const string lemma_cache_header = "pono-lemma-cache 1";
+static const string checkpoint_header = "pono-checkpoint 1";
+static const string result_cache_header = "pono-result-cache 2";
+static const string predicate_cache_header = "pono-predicate-cache 1";
+
+static uint64_t hash_combine(uint64_t h, uint64_t v)
+{
+  return h ^ (v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+}
+
+static uint64_t hash_string(const string & s)
+{
+  // FNV-1a, std::hash is not guaranteed to be stable across builds
+  uint64_t h = 0xcbf29ce484222325ULL;
+  for (unsigned char c : s) {
+    h ^= c;
+    h *= 0x100000001b3ULL;
+  }
+  return h;
+}
+
+/** Hash the DAG of t bottom-up
+ *  @param t the term
+ *  @param cache the hashes of the terms visited so far
+ *  @param leaf returns the hash of a symbol or value
+ *  @return the hash of t
+ */
+static uint64_t hash_dag(const Term & t,
+                         unordered_map<Term, uint64_t> & cache,
+                         const function<uint64_t(const Term &)> & leaf)
+{
+  TermVec to_visit({ t });
+  while (to_visit.size()) {
+    Term cur = to_visit.back();
+    if (cache.find(cur) != cache.end()) {
+      to_visit.pop_back();
+      continue;
+    }
+
+    Op op = cur->get_op();
+    if (op.is_null()) {
+      // symbol or value
+      to_visit.pop_back();
+      cache[cur] = leaf(cur);
+      continue;
+    }
+
+    bool children_done = true;
+    for (const auto & c : *cur) {
+      if (cache.find(c) == cache.end()) {
+        to_visit.push_back(c);
+        children_done = false;
+      }
+    }
+    if (!children_done) {
+      continue;
+    }
+
+    to_visit.pop_back();
+    uint64_t h = hash_string(op.to_string());
+    for (const auto & c : *cur) {
+      h = hash_combine(h, cache.at(c));
+    }
+    cache[cur] = h;
+  }
+  return cache.at(t);
+}
+
+uint64_t structural_hash(const Term & t)
+{
+  unordered_map<Term, uint64_t> cache;
+  return hash_dag(t, cache, [](const Term & leaf) {
+    return hash_combine(hash_string(leaf->to_string()),
+                        hash_string(leaf->get_sort()->to_string()));
+  });
+}
+
+uint64_t canonical_hash(const TransitionSystem & ts,
+                        const Term & prop,
+                        TermVec * vars)
+{
+  unordered_map<Term, size_t> var_ids;
+  TermVec order;
+  auto leaf_hash = [&](const Term & leaf) {
+    uint64_t h = hash_string(leaf->get_sort()->to_string());
+    if (leaf->is_value()) {
+      return hash_combine(h, hash_string(leaf->to_string()));
+    }
+    // a next state variable is its current one, marked as next
+    bool next = ts.is_next_var(leaf);
+    Term v = next ? ts.curr(leaf) : leaf;
+    auto it = var_ids.find(v);
+    size_t id = order.size();
+    if (it == var_ids.end()) {
+      var_ids[v] = id;
+      order.push_back(v);
+    } else {
+      id = it->second;
+    }
+    string kind = next                 ? "n"
+                  : ts.is_curr_var(v)  ? "s"
+                  : ts.is_input_var(v) ? "i"
+                                       : "x";
+    return hash_combine(hash_combine(h, hash_string(kind)), id);
+  };
+
+  unordered_map<Term, uint64_t> cache;
+  uint64_t h = hash_dag(prop, cache, leaf_hash);
+  h = hash_combine(h, hash_dag(ts.init(), cache, leaf_hash));
+  h = hash_combine(h, hash_dag(ts.trans(), cache, leaf_hash));
+  if (vars) {
+    *vars = order;
+  }
+  return h;
+}
+
+bool same_up_to_renaming(const TransitionSystem & ts_a,
+                         const Term & prop_a,
+                         const TermVec & vars_a,
+                         const TransitionSystem & ts_b,
+                         const Term & prop_b,
+                         const TermVec & vars_b,
+                         UnorderedTermMap & a_to_b)
+{
+  const SmtSolver & solver = ts_a.solver();
+  if (solver != ts_b.solver() || vars_a.size() != vars_b.size()) {
+    return false;
+  }
+
+  a_to_b.clear();
+  for (size_t i = 0; i < vars_a.size(); ++i) {
+    const Term & a = vars_a[i];
+    const Term & b = vars_b[i];
+    if (a->get_sort() != b->get_sort()
+        || ts_a.is_curr_var(a) != ts_b.is_curr_var(b)
+        || ts_a.is_input_var(a) != ts_b.is_input_var(b)) {
+      return false;
+    }
+    a_to_b[a] = b;
+    if (ts_a.is_curr_var(a)) {
+      a_to_b[ts_a.next(a)] = ts_b.next(b);
+    }
+  }
+
+  // the terms of a solver are hash-consed, same structure is same term
+  return solver->substitute(prop_a, a_to_b) == prop_b
+         && solver->substitute(ts_a.init(), a_to_b) == ts_b.init()
+         && solver->substitute(ts_a.trans(), a_to_b) == ts_b.trans();
+}
+
+uint64_t lemma_cache_key(const TransitionSystem & ts, const Term & prop)
+{
+  vector<string> vars;
+  for (const auto & sv : ts.statevars()) {
+    vars.push_back(sv->to_string() + ":" + sv->get_sort()->to_string());
+  }
+  // statevars is unordered
+  sort(vars.begin(), vars.end());
+
+  uint64_t h = structural_hash(prop);
+  for (const auto & v : vars) {
+    h = hash_combine(h, hash_string(v));
+  }
+  return h;
+}
+
+uint64_t lemma_cache_hash(const TransitionSystem & ts, const Term & prop)
+{
+  uint64_t h = lemma_cache_key(ts, prop);
+  h = hash_combine(h, structural_hash(ts.init()));
+  return hash_combine(h, structural_hash(ts.trans()));
+}
+
+namespace {
+
+/** @return the sort as written in a cache, or "" if not supported */
+string sort_to_string(const Sort & sort)
+{
+  SortKind sk = sort->get_sort_kind();
+  if (sk == BOOL) {
+    return "bool";
+  } else if (sk == BV) {
+    return "bv" + std::to_string(sort->get_width());
+  } else if (sk == INT) {
+    return "int";
+  }
+  return "";
+}
+
+Sort sort_from_string(const SmtSolver & solver, const string & s)
+{
+  if (s == "bool") {
+    return solver->make_sort(BOOL);
+  } else if (s == "int") {
+    return solver->make_sort(INT);
+  } else if (s.rfind("bv", 0) == 0) {
+    return solver->make_sort(BV, stoul(s.substr(2)));
+  }
+  throw PonoException("Unsupported sort in lemma cache: " + s);
+}
+
+Term value_from_string(const SmtSolver & solver,
+                       const Sort & sort,
+                       const string & val)
+{
+  SortKind sk = sort->get_sort_kind();
+  if (sk == BOOL) {
+    return solver->make_term(val == "true");
+  } else if (sk == BV) {
+    if (val.rfind("#b", 0) == 0) {
+      return solver->make_term(val.substr(2), sort, 2);
+    } else if (val.rfind("#x", 0) == 0) {
+      return solver->make_term(val.substr(2), sort, 16);
+    } else if (val.rfind("(_ bv", 0) == 0) {
+      // (_ bvN W)
+      return solver->make_term(val.substr(5, val.find(' ', 5) - 5), sort);
+    }
+  } else if (sk == INT) {
+    if (val.rfind("(- ", 0) == 0) {
+      return solver->make_term("-" + val.substr(3, val.size() - 4), sort);
+    }
+    return solver->make_term(val, sort);
+  }
+  throw PonoException("Unsupported value in lemma cache: " + val);
+}
+
+class LemmaCacheWriter
+{
+ public:
+  /** @param ts the system the terms are over
+   *  @param out the stream to write to
+   *  @param var_ids if given, the variables are written by their position
+   *         in the canonical order (see canonical_hash) instead of by name
+   */
+  LemmaCacheWriter(const TransitionSystem & ts,
+                   ostream & out,
+                   const unordered_map<Term, size_t> * var_ids = nullptr)
+      : ts_(ts), out_(out), var_ids_(var_ids)
+  {
+  }
+
+  /** Write the terms that are not written yet
+   *  @param terms the terms
+   *  @param term_ids set to the ids of the terms
+   *  @return false if some term cannot be written, and then nothing is
+   *          written
+   */
+  bool write_terms(const TermVec & terms, vector<size_t> & term_ids)
+  {
+    ostringstream lines;
+    unordered_map<Term, size_t> new_ids;
+    term_ids.clear();
+    for (const auto & t : terms) {
+      if (!write_term(t, lines, new_ids)) {
+        return false;
+      }
+      term_ids.push_back(id(t, new_ids));
+    }
+
+    out_ << lines.str();
+    ids_.insert(new_ids.begin(), new_ids.end());
+    return true;
+  }
+
+  /** Write the terms of a clause that are not written yet
+   *  @param children the literals of the clause
+   *  @param kind the start of the clause line, e.g. "f <frame>"
+   *  @return false if some term cannot be written, and then nothing is
+   *          written
+   */
+  bool write_clause(const TermVec & children, const string & kind = "l")
+  {
+    vector<size_t> lits;
+    if (!write_terms(children, lits)) {
+      return false;
+    }
+    out_ << kind << " " << lits.size();
+    for (auto l : lits) {
+      out_ << " " << l;
+    }
+    out_ << endl;
+    return true;
+  }
+
+ private:
+  size_t id(const Term & t, const unordered_map<Term, size_t> & new_ids)
+  {
+    auto it = ids_.find(t);
+    return (it != ids_.end()) ? it->second : new_ids.at(t);
+  }
+
+  bool known(const Term & t, const unordered_map<Term, size_t> & new_ids)
+  {
+    return ids_.find(t) != ids_.end() || new_ids.find(t) != new_ids.end();
+  }
+
+  bool write_term(const Term & t,
+                  ostream & lines,
+                  unordered_map<Term, size_t> & new_ids)
+  {
+    TermVec to_visit({ t });
+    while (to_visit.size()) {
+      Term cur = to_visit.back();
+      if (known(cur, new_ids)) {
+        to_visit.pop_back();
+        continue;
+      }
+
+      string sort = sort_to_string(cur->get_sort());
+      if (sort.empty()) {
+        return false;
+      }
+
+      Op op = cur->get_op();
+      if (op.is_null()) {
+        to_visit.pop_back();
+        size_t i = ids_.size() + new_ids.size();
+        if (cur->is_value()) {
+          lines << "t " << i << " v " << sort << " " << cur->to_string()
+                << endl;
+        } else if (var_ids_) {
+          bool next = ts_.is_next_var(cur);
+          auto it = var_ids_->find(next ? ts_.curr(cur) : cur);
+          if (it == var_ids_->end()) {
+            return false;
+          }
+          lines << "t " << i << (next ? " n " : " c ") << it->second << endl;
+        } else if (ts_.is_curr_var(cur)) {
+          lines << "t " << i << " s " << cur->to_string() << endl;
+        } else {
+          // inputs, next state variables and other symbols are not
+          // meaningful across runs
+          return false;
+        }
+        new_ids[cur] = i;
+        continue;
+      }
+
+      bool children_done = true;
+      for (const auto & c : *cur) {
+        if (!known(c, new_ids)) {
+          to_visit.push_back(c);
+          children_done = false;
+        }
+      }
+      if (!children_done) {
+        continue;
+      }
+
+      to_visit.pop_back();
+      size_t i = ids_.size() + new_ids.size();
+      TermVec args;
+      for (const auto & c : *cur) {
+        args.push_back(c);
+      }
+      lines << "t " << i << " o " << smt::to_string(op.prim_op) << " "
+            << op.num_idx << " " << op.idx0 << " " << op.idx1 << " "
+            << args.size();
+      for (const auto & a : args) {
+        lines << " " << id(a, new_ids);
+      }
+      lines << endl;
+      new_ids[cur] = i;
+    }
+    return true;
+  }
+
+  const TransitionSystem & ts_;
+  ostream & out_;
+  const unordered_map<Term, size_t> * var_ids_;
+  unordered_map<Term, size_t> ids_;  ///< terms already written
+};
+
+unordered_map<string, PrimOp> prim_op_names()
+{
+  unordered_map<string, PrimOp> prim_ops;
+  for (int po = 0; po < NUM_OPS_AND_NULL; ++po) {
+    prim_ops[smt::to_string(PrimOp(po))] = PrimOp(po);
+  }
+  return prim_ops;
+}
+
+/** Parse the rest of a term line "t <id> ..." and append the term
+ *  @param ss the line after "t"
+ *  @param solver the solver to rebuild the term in
+ *  @param prim_ops the operators by name
+ *  @param symbol returns the variable of a "s", "c" or "n" line given the
+ *         kind and the rest of the line, or null if it no longer exists
+ *  @param terms the terms read so far, null for the missing ones
+ *  @return false if the line is malformed
+ */
+bool read_term_line(istringstream & ss,
+                    const SmtSolver & solver,
+                    const unordered_map<string, PrimOp> & prim_ops,
+                    const function<Term(const string &, istream &)> & symbol,
+                    TermVec & terms)
+{
+  size_t i;
+  string tkind;
+  ss >> i >> tkind;
+  if (!ss || i != terms.size()) {
+    return false;
+  }
+
+  if (tkind == "s" || tkind == "c" || tkind == "n") {
+    terms.push_back(symbol(tkind, ss));
+  } else if (tkind == "v") {
+    string sort, val;
+    ss >> sort;
+    getline(ss >> ws, val);
+    terms.push_back(
+        value_from_string(solver, sort_from_string(solver, sort), val));
+  } else if (tkind == "o") {
+    string opname;
+    Op op;
+    size_t num_args;
+    ss >> opname >> op.num_idx >> op.idx0 >> op.idx1 >> num_args;
+    auto it = prim_ops.find(opname);
+    if (!ss || it == prim_ops.end()) {
+      return false;
+    }
+    op.prim_op = it->second;
+
+    TermVec args;
+    bool missing = false;
+    for (size_t j = 0; j < num_args; ++j) {
+      size_t a;
+      ss >> a;
+      if (!ss || a >= terms.size()) {
+        return false;
+      }
+      missing |= !terms[a];
+      args.push_back(terms[a]);
+    }
+    Term t;
+    if (!missing) {
+      try {
+        t = solver->make_term(op, args);
+      }
+      catch (std::exception & e) {
+        // e.g. a variable whose sort changed in this revision, the terms
+        // using it are skipped
+      }
+    }
+    terms.push_back(t);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+size_t write_lemma_cache(const string & filename,
+                         const TransitionSystem & ts,
+                         const Term & prop,
+                         const vector<TermVec> & lemmas)
+{
+  ofstream out(filename);
+  if (!out.is_open()) {
+    throw PonoException("Could not open lemma cache " + filename);
+  }
+
+  out << lemma_cache_header << endl;
+  out << "key " << lemma_cache_key(ts, prop) << endl;
+  out << "hash " << lemma_cache_hash(ts, prop) << endl;
+
+  LemmaCacheWriter writer(ts, out);
+  size_t num_written = 0;
+  for (const auto & children : lemmas) {
+    num_written += writer.write_clause(children);
+  }
+
+  if (!out.good()) {
+    throw PonoException("Failed to write lemma cache " + filename);
+  }
+  return num_written;
+}
+
+/** Read a lemma cache, or a checkpoint if cp is given
+ *  @param any_key read the clauses of a lemma cache with any key
+ *  @return false if the file does not exist or has a different key (or
+ *          hash for a checkpoint)
+ */
+static bool read_lemma_file(const string & filename,
+                            const TransitionSystem & ts,
+                            const Term & prop,
+                            vector<TermVec> & out,
+                            Checkpoint * cp,
+                            bool any_key = false)
+{
+  assert(!cp || !any_key);
+  ifstream in(filename);
+  if (!in.is_open()) {
+    return false;
+  }
+
+  string line;
+  const string & header = cp ? checkpoint_header : lemma_cache_header;
+  if (!getline(in, line) || line != header) {
+    throw PonoException((cp ? "Not a checkpoint: " : "Not a lemma cache: ")
+                        + filename);
+  }
+
+  const SmtSolver & solver = ts.solver();
+  unordered_map<string, PrimOp> prim_ops = prim_op_names();
+  unordered_map<string, Term> statevars;
+  for (const auto & sv : ts.statevars()) {
+    statevars[sv->to_string()] = sv;
+  }
+  auto symbol = [&](const string & tkind, istream & ss) -> Term {
+    if (tkind != "s") {
+      throw PonoException("Malformed lemma cache " + filename);
+    }
+    string name;
+    // the name is the rest of the line
+    getline(ss >> ws, name);
+    auto it = statevars.find(name);
+    // removed in this revision, clauses using it will be skipped
+    return (it == statevars.end()) ? nullptr : it->second;
+  };
+
+  vector<TermVec> lemmas;
+  TermVec terms;
+  size_t lineno = 1;
+  while (getline(in, line)) {
+    ++lineno;
+    if (line.empty()) {
+      continue;
+    }
+
+    auto malformed = [&]() {
+      return PonoException("Malformed lemma cache " + filename + " at line "
+                           + std::to_string(lineno));
+    };
+
+    istringstream ss(line);
+    string kind;
+    ss >> kind;
+    if (kind == "key") {
+      uint64_t key;
+      ss >> key;
+      if (!any_key && key != lemma_cache_key(ts, prop)) {
+        // cached for a different system or property
+        return false;
+      }
+    } else if (kind == "hash") {
+      // only informational for a lemma cache, the clauses are checked
+      // anyway, but a checkpoint is only valid for the same system
+      uint64_t hash;
+      ss >> hash;
+      if (cp && hash != lemma_cache_hash(ts, prop)) {
+        return false;
+      }
+    } else if (cp && kind == "engine") {
+      ss >> cp->engine;
+    } else if (cp && kind == "reached_k") {
+      ss >> cp->reached_k;
+    } else if (kind == "t") {
+      if (!read_term_line(ss, solver, prim_ops, symbol, terms)) {
+        throw malformed();
+      }
+    } else if (kind == "l" || (cp && kind == "f")) {
+      size_t frame = 0;
+      if (kind == "f") {
+        ss >> frame;
+        if (!ss || !frame) {
+          throw malformed();
+        }
+      }
+      size_t n;
+      ss >> n;
+      TermVec children;
+      bool missing = false;
+      for (size_t j = 0; j < n; ++j) {
+        size_t a;
+        ss >> a;
+        if (!ss || a >= terms.size()) {
+          throw malformed();
+        }
+        missing |= !terms[a];
+        children.push_back(terms[a]);
+      }
+      if (kind == "f") {
+        // the system is the same, nothing can be missing
+        if (missing || children.empty()) {
+          throw malformed();
+        }
+        if (cp->frames.size() < frame) {
+          cp->frames.resize(frame);
+        }
+        cp->frames[frame - 1].push_back(children);
+      } else if (!missing && children.size()) {
+        lemmas.push_back(children);
+      }
+    } else {
+      throw malformed();
+    }
+  }
+
+  out.insert(out.end(), lemmas.begin(), lemmas.end());
+  return true;
+}
+
+bool read_lemma_cache(const string & filename,
+                      const TransitionSystem & ts,
+                      const Term & prop,
+                      vector<TermVec> & out)
+{
+  return read_lemma_file(filename, ts, prop, out, nullptr);
+}
+
+bool read_lemma_cache_by_name(const string & filename,
+                              const TransitionSystem & ts,
+                              vector<TermVec> & out)
+{
+  // the property is only used for the key
+  return read_lemma_file(
+      filename, ts, ts.solver()->make_term(true), out, nullptr, true);
+}
+
+bool write_checkpoint(const string & filename,
+                      const TransitionSystem & ts,
+                      const Term & prop,
+                      const Checkpoint & cp)
+{
+  string tmp = filename + ".tmp";
+  {
+    ofstream out(tmp);
+    if (!out.is_open()) {
+      throw PonoException("Could not open checkpoint " + tmp);
+    }
+
+    out << checkpoint_header << endl;
+    out << "key " << lemma_cache_key(ts, prop) << endl;
+    out << "hash " << lemma_cache_hash(ts, prop) << endl;
+    out << "engine " << cp.engine << endl;
+    out << "reached_k " << cp.reached_k << endl;
+
+    LemmaCacheWriter writer(ts, out);
+    for (size_t i = 0; i < cp.frames.size(); ++i) {
+      string kind = "f " + std::to_string(i + 1);
+      for (const auto & children : cp.frames[i]) {
+        if (!writer.write_clause(children, kind)) {
+          // a frame without this clause could let IC3 miss a bad state
+          out.close();
+          remove(tmp.c_str());
+          return false;
+        }
+      }
+    }
+
+    if (!out.good()) {
+      throw PonoException("Failed to write checkpoint " + tmp);
+    }
+  }
+
+  if (rename(tmp.c_str(), filename.c_str())) {
+    throw PonoException("Failed to replace checkpoint " + filename);
+  }
+  return true;
+}
+
+bool read_checkpoint(const string & filename,
+                     const TransitionSystem & ts,
+                     const Term & prop,
+                     Checkpoint & out)
+{
+  out = Checkpoint();
+  vector<TermVec> unused;
+  Checkpoint cp;
+  if (!read_lemma_file(filename, ts, prop, unused, &cp)) {
+    return false;
+  }
+  out = std::move(cp);
+  return true;
+}
+
+size_t write_predicate_cache(const string & filename,
+                             const TransitionSystem & ts,
+                             const TermVec & preds)
+{
+  ostringstream section;
+  section << "section" << endl;
+  LemmaCacheWriter writer(ts, section);
+  size_t num_written = 0;
+  for (const auto & p : preds) {
+    vector<size_t> ids;
+    if (writer.write_terms({ p }, ids)) {
+      section << "p " << ids[0] << endl;
+      ++num_written;
+    }
+  }
+  if (!num_written) {
+    return 0;
+  }
+
+  bool exists = ifstream(filename).is_open();
+  ofstream out(filename, ios::app);
+  if (!out.is_open()) {
+    throw PonoException("Could not open predicate cache " + filename);
+  }
+  if (!exists) {
+    out << predicate_cache_header << endl;
+  }
+  // a single write, so the sections of concurrent runs don't interleave
+  // (on most file systems)
+  string str = section.str();
+  out.write(str.data(), str.size());
+  out.flush();
+  if (!out.good()) {
+    throw PonoException("Failed to write predicate cache " + filename);
+  }
+  return num_written;
+}
+
+bool read_predicate_cache(const string & filename,
+                          const TransitionSystem & ts,
+                          TermVec & out)
+{
+  ifstream in(filename);
+  if (!in.is_open()) {
+    return false;
+  }
+
+  string line;
+  if (!getline(in, line) || line != predicate_cache_header) {
+    throw PonoException("Not a predicate cache: " + filename);
+  }
+
+  const SmtSolver & solver = ts.solver();
+  unordered_map<string, PrimOp> prim_ops = prim_op_names();
+  unordered_map<string, Term> statevars;
+  for (const auto & sv : ts.statevars()) {
+    statevars[sv->to_string()] = sv;
+  }
+  auto symbol = [&](const string & tkind, istream & ss) -> Term {
+    if (tkind != "s") {
+      throw PonoException("Malformed predicate cache " + filename);
+    }
+    string name;
+    getline(ss >> ws, name);
+    auto it = statevars.find(name);
+    // not in the cone of this property (or removed in this revision),
+    // predicates using it are skipped
+    return (it == statevars.end()) ? nullptr : it->second;
+  };
+
+  TermVec preds;
+  UnorderedTermSet seen(out.begin(), out.end());
+  TermVec terms;
+  size_t lineno = 1;
+  while (getline(in, line)) {
+    ++lineno;
+    if (line.empty()) {
+      continue;
+    }
+
+    auto malformed = [&]() {
+      return PonoException("Malformed predicate cache " + filename
+                           + " at line " + std::to_string(lineno));
+    };
+
+    istringstream ss(line);
+    string kind;
+    ss >> kind;
+    if (kind == "section") {
+      terms.clear();
+    } else if (kind == "t") {
+      if (!read_term_line(ss, solver, prim_ops, symbol, terms)) {
+        throw malformed();
+      }
+    } else if (kind == "p") {
+      size_t id;
+      ss >> id;
+      if (!ss || id >= terms.size()) {
+        throw malformed();
+      }
+      const Term & p = terms[id];
+      if (p && p->get_sort()->get_sort_kind() == BOOL
+          && seen.insert(p).second) {
+        preds.push_back(p);
+      }
+    } else {
+      throw malformed();
+    }
+  }
+
+  out.insert(out.end(), preds.begin(), preds.end());
+  return true;
+}
+
+/** @return the file of a system in a result cache directory */
+static string result_file(const string & dir,
+                          uint64_t hash,
+                          const string & options)
+{
+  ostringstream name;
+  name << dir << "/" << hex << setw(16) << setfill('0')
+       << hash_combine(hash, hash_string(options)) << ".result";
+  return name.str();
+}
+
+bool write_result_cache(const string & dir,
+                        const TransitionSystem & ts,
+                        const Term & prop,
+                        const string & options,
+                        const CachedResult & res)
+{
+  if (res.result != TRUE && res.result != FALSE) {
+    return false;
+  }
+
+  TermVec vars;
+  uint64_t hash = canonical_hash(ts, prop, &vars);
+  unordered_map<Term, size_t> var_ids;
+  for (size_t i = 0; i < vars.size(); ++i) {
+    var_ids[vars[i]] = i;
+  }
+
+  string filename = result_file(dir, hash, options);
+  // written to a temporary file first, the cache may be shared by runs
+  string tmp = filename + ".tmp" + std::to_string(getpid()) + "."
+               + std::to_string(std::hash<std::thread::id>()(this_thread::get_id()));
+  {
+    ofstream out(tmp);
+    if (!out.is_open()) {
+      throw PonoException("Could not open result cache " + tmp);
+    }
+
+    out << result_cache_header << endl;
+    out << "hash " << hash << endl;
+    out << "options " << options << endl;
+
+    // the system itself, without it the entry could not be told apart
+    // from one of a different system with the same hash
+    LemmaCacheWriter writer(ts, out, &var_ids);
+    vector<size_t> ids;
+    if (!writer.write_terms({ prop, ts.init(), ts.trans() }, ids)) {
+      out.close();
+      remove(tmp.c_str());
+      return false;
+    }
+    out << "prop " << ids[0] << endl;
+    out << "init " << ids[1] << endl;
+    out << "trans " << ids[2] << endl;
+
+    out << "result " << (res.result == TRUE ? "true" : "false") << endl;
+
+    if (res.invar && writer.write_terms({ res.invar }, ids)) {
+      out << "invar " << ids[0] << endl;
+    }
+
+    // the whole witness or nothing
+    ostringstream cex_lines;
+    bool cex_ok = true;
+    for (size_t t = 0; cex_ok && t < res.cex.size(); ++t) {
+      for (const auto & elem : res.cex[t]) {
+        auto it = var_ids.find(elem.first);
+        if (it == var_ids.end()) {
+          // e.g. a variable added after hashing, not part of the system
+          continue;
+        }
+        if (!writer.write_terms({ elem.second }, ids)) {
+          cex_ok = false;
+          break;
+        }
+        cex_lines << "cex " << t << " " << it->second << " " << ids[0]
+                  << endl;
+      }
+    }
+    if (cex_ok && res.cex.size()) {
+      out << "steps " << res.cex.size() << endl;
+      out << cex_lines.str();
+    }
+
+    if (!out.good()) {
+      throw PonoException("Failed to write result cache " + tmp);
+    }
+  }
+
+  if (rename(tmp.c_str(), filename.c_str())) {
+    remove(tmp.c_str());
+    throw PonoException("Failed to write result cache " + filename);
+  }
+  return true;
+}
+
+/** Read a result cache entry
+ *  @param in the open file, after the header
+ *  @param vars the variables of ts in the canonical order
+ *  @return false if the entry is for a different system, property or
+ *          options
+ *  @throws PonoException if the file is malformed
+ */
+static bool read_result_file(istream & in,
+                             const string & filename,
+                             const TransitionSystem & ts,
+                             const Term & prop,
+                             const string & options,
+                             uint64_t hash,
+                             const TermVec & vars,
+                             CachedResult & out)
+{
+  const SmtSolver & solver = ts.solver();
+  unordered_map<string, PrimOp> prim_ops = prim_op_names();
+  auto symbol = [&](const string & tkind, istream & ss) -> Term {
+    size_t idx;
+    ss >> idx;
+    if (tkind == "s" || !ss || idx >= vars.size()) {
+      throw PonoException("Malformed result cache " + filename);
+    }
+    if (tkind == "c") {
+      return vars[idx];
+    }
+    // a variable of the other system may be a state variable here, then
+    // the terms differ and the entry is a miss
+    return ts.is_curr_var(vars[idx]) ? ts.next(vars[idx]) : nullptr;
+  };
+
+  CachedResult res;
+  TermVec terms;
+  // the system of the entry, all three must match
+  TermVec expected({ prop, ts.init(), ts.trans() });
+  vector<bool> matched(expected.size(), false);
+  string line;
+  size_t lineno = 1;
+  while (getline(in, line)) {
+    ++lineno;
+    if (line.empty()) {
+      continue;
+    }
+
+    auto malformed = [&]() {
+      return PonoException("Malformed result cache " + filename + " at line "
+                           + std::to_string(lineno));
+    };
+
+    istringstream ss(line);
+    string kind;
+    ss >> kind;
+    if (kind == "hash") {
+      uint64_t h;
+      ss >> h;
+      if (h != hash) {
+        // a collision of the file names
+        return false;
+      }
+    } else if (kind == "options") {
+      string opts;
+      getline(ss >> ws, opts);
+      if (opts != options) {
+        return false;
+      }
+    } else if (kind == "prop" || kind == "init" || kind == "trans") {
+      size_t i = (kind == "prop") ? 0 : (kind == "init") ? 1 : 2;
+      size_t id;
+      ss >> id;
+      if (!ss || id >= terms.size()) {
+        throw malformed();
+      }
+      if (!terms[id] || terms[id] != expected[i]) {
+        // a different system with the same hash
+        return false;
+      }
+      matched[i] = true;
+    } else if (kind == "result") {
+      string r;
+      ss >> r;
+      if (r != "true" && r != "false") {
+        throw malformed();
+      }
+      res.result = (r == "true") ? TRUE : FALSE;
+    } else if (kind == "t") {
+      if (!read_term_line(ss, solver, prim_ops, symbol, terms)) {
+        throw malformed();
+      }
+    } else if (kind == "invar") {
+      size_t id;
+      ss >> id;
+      if (!ss || id >= terms.size() || !terms[id]) {
+        throw malformed();
+      }
+      res.invar = terms[id];
+    } else if (kind == "steps") {
+      size_t steps;
+      ss >> steps;
+      if (!ss) {
+        throw malformed();
+      }
+      res.cex.resize(steps);
+    } else if (kind == "cex") {
+      size_t t, idx, id;
+      ss >> t >> idx >> id;
+      if (!ss || t >= res.cex.size() || idx >= vars.size()
+          || id >= terms.size() || !terms[id]) {
+        throw malformed();
+      }
+      res.cex[t][vars[idx]] = terms[id];
+    } else {
+      throw malformed();
+    }
+  }
+
+  if (res.result != TRUE && res.result != FALSE) {
+    throw PonoException("Malformed result cache " + filename);
+  }
+  if (find(matched.begin(), matched.end(), false) != matched.end()) {
+    throw PonoException("Malformed result cache " + filename
+                        + ": the system is missing");
+  }
+  out = std::move(res);
+  return true;
+}
+
+bool read_result_cache(const string & dir,
+                       const TransitionSystem & ts,
+                       const Term & prop,
+                       const string & options,
+                       CachedResult & out)
+{
+  out = CachedResult();
+  TermVec vars;
+  uint64_t hash = canonical_hash(ts, prop, &vars);
+  string filename = result_file(dir, hash, options);
+  ifstream in(filename);
+  if (!in.is_open()) {
+    return false;
+  }
+
+  // the cache may be shared with other versions or hand-edited, a bad
+  // entry is a miss and the property is checked
+  try {
+    string line;
+    if (!getline(in, line) || line != result_cache_header) {
+      throw PonoException("Not a result cache: " + filename);
+    }
+    return read_result_file(in, filename, ts, prop, options, hash, vars, out);
+  }
+  catch (std::exception & e) {
+    // e.g. a value or sort the solver can't build
+    logger.log(0, "Warning: ignoring result cache entry: {}", e.what());
+    out = CachedResult();
+    return false;
+  }
+}
+
+}  // namespace pono
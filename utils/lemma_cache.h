@@ -0,0 +1,248 @@
+/*********************                                                        */
+/*! \file lemma_cache.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Saves clauses over the state variables of a transition system to
+**        a file and loads them in a later run, e.g. to warm start IC3 on a
+**        revision of the same design.
+**
+**        A cache is keyed by a structural hash of the state variables
+**        (names and sorts) and of the property, so it can be reused after
+**        the init or trans of the system changed. Loaded clauses are only
+**        candidates and must be checked before they are used.
+**
+**        A checkpoint uses the same format to save the state of a running
+**        engine (the bound it reached and the IC3 frames), and is only
+**        restored for exactly the same system (the full hash matches).
+**
+**        A result cache is a directory with the results (and invariants
+**        or witnesses) of properties, keyed by a canonical hash that
+**        ignores the names, so unchanged properties of a new revision of
+**        a design are answered without running an engine.
+**
+**        A predicate cache collects the predicates learned by IC3IA. It has
+**        no key: the predicates are shared by all the properties and
+**        revisions of a design, and a run only uses the ones over its own
+**        state variables.
+**
+**/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/proverresult.h"
+#include "core/ts.h"
+#include "smt-switch/smt.h"
+
+namespace pono {
+
+/** @return a hash of the structure of t that does not depend on the solver
+ *          or on the run (unlike Term::hash)
+ */
+uint64_t structural_hash(const smt::Term & t);
+
+/** @return a hash of the structure of prop, init and trans of ts that does
+ *          not depend on the names: the variables are identified by their
+ *          sort, kind (state, input or other) and position in the order of
+ *          first occurrence
+ *  @param vars if given, set to the variables in that order
+ */
+uint64_t canonical_hash(const TransitionSystem & ts,
+                        const smt::Term & prop,
+                        smt::TermVec * vars = nullptr);
+
+/** Checks that two systems of the same solver with the same canonical
+ *  hash are the same up to the names of the variables, e.g. the cones of
+ *  two replicated properties
+ *  @param ts_a the first system
+ *  @param prop_a its property
+ *  @param vars_a its variables in the canonical order (see canonical_hash)
+ *  @param ts_b the second system
+ *  @param prop_b its property
+ *  @param vars_b its variables in the canonical order
+ *  @param a_to_b set to the variables (current and next) of ts_b of each
+ *         variable of ts_a
+ *  @return true iff renaming the variables of ts_a gives prop_b and the
+ *          init and trans of ts_b
+ */
+bool same_up_to_renaming(const TransitionSystem & ts_a,
+                         const smt::Term & prop_a,
+                         const smt::TermVec & vars_a,
+                         const TransitionSystem & ts_b,
+                         const smt::Term & prop_b,
+                         const smt::TermVec & vars_b,
+                         smt::UnorderedTermMap & a_to_b);
+
+/** @return the key of a lemma cache: a structural hash of the state
+ *          variables of ts and of prop
+ */
+uint64_t lemma_cache_key(const TransitionSystem & ts, const smt::Term & prop);
+
+/** @return a structural hash of the whole system (key, init and trans) */
+uint64_t lemma_cache_hash(const TransitionSystem & ts, const smt::Term & prop);
+
+/** Write clauses to a lemma cache file
+ *  Clauses with terms that cannot be written (e.g. arrays, uninterpreted
+ *  functions or non-state variables) are skipped.
+ *  @param filename the file to (over)write
+ *  @param ts the transition system the clauses are over
+ *  @param prop the property
+ *  @param lemmas the literals of each clause
+ *  @return the number of clauses written
+ *  @throws PonoException if the file cannot be written
+ */
+size_t write_lemma_cache(const std::string & filename,
+                         const TransitionSystem & ts,
+                         const smt::Term & prop,
+                         const std::vector<smt::TermVec> & lemmas);
+
+/** Read the clauses of a lemma cache file
+ *  @param filename the file written by write_lemma_cache
+ *  @param ts the transition system, the clauses are rebuilt in its solver
+ *  @param prop the property
+ *  @param out vector to append the literals of each clause to
+ *  @return false if the file does not exist or has a different key,
+ *          and then out is unchanged
+ *  @throws PonoException if the file is malformed
+ */
+bool read_lemma_cache(const std::string & filename,
+                      const TransitionSystem & ts,
+                      const smt::Term & prop,
+                      std::vector<smt::TermVec> & out);
+
+/** Read the clauses of a lemma cache written for any revision of a design
+ *  (e.g. with other state variables, see migrate_invariants)
+ *  @param filename the file written by write_lemma_cache
+ *  @param ts the transition system, the clauses are rebuilt in its solver
+ *         by the names of the state variables, and the clauses over
+ *         variables it does not have (or that changed sort) are skipped
+ *  @param out vector to append the literals of each clause to
+ *  @return false if the file does not exist
+ *  @throws PonoException if the file is malformed
+ */
+bool read_lemma_cache_by_name(const std::string & filename,
+                              const TransitionSystem & ts,
+                              std::vector<smt::TermVec> & out);
+
+/** The state of an engine saved by write_checkpoint */
+struct Checkpoint
+{
+  std::string engine;  ///< the engine that saved it
+  int reached_k = -1;  ///< the last bound reached with no counterexamples
+  ///< the literals of the clauses of each IC3 frame, starting at frame 1
+  std::vector<std::vector<smt::TermVec>> frames;
+};
+
+/** Write a checkpoint to a temporary file and then rename it to filename,
+ *  so a run killed while writing keeps the previous checkpoint
+ *  @param filename the checkpoint file
+ *  @param ts the transition system the clauses are over
+ *  @param prop the property
+ *  @param cp the state to save
+ *  @return false if some clause cannot be written (the checkpoint would
+ *          be incomplete), and then filename is unchanged
+ *  @throws PonoException if the file cannot be written
+ */
+bool write_checkpoint(const std::string & filename,
+                      const TransitionSystem & ts,
+                      const smt::Term & prop,
+                      const Checkpoint & cp);
+
+/** Read a checkpoint written by write_checkpoint
+ *  @param filename the checkpoint file
+ *  @param ts the transition system, the clauses are rebuilt in its solver
+ *  @param prop the property
+ *  @param out the restored state
+ *  @return false if the file does not exist or was written for a
+ *          different system or property (any change to init or trans)
+ *  @throws PonoException if the file is malformed
+ */
+bool read_checkpoint(const std::string & filename,
+                     const TransitionSystem & ts,
+                     const smt::Term & prop,
+                     Checkpoint & out);
+
+/** Append predicates to a predicate cache file
+ *  Predicates with terms that cannot be written (e.g. arrays, uninterpreted
+ *  functions or non-state variables) are skipped.
+ *  @param filename the file to append to, created if it does not exist
+ *  @param ts the transition system the predicates are over
+ *  @param preds the predicates
+ *  @return the number of predicates written
+ *  @throws PonoException if the file cannot be written
+ */
+size_t write_predicate_cache(const std::string & filename,
+                             const TransitionSystem & ts,
+                             const smt::TermVec & preds);
+
+/** Read the predicates of a predicate cache file over state variables of
+ *  a system
+ *  @param filename the file written by write_predicate_cache
+ *  @param ts the transition system, the predicates are rebuilt in its
+ *         solver and the ones over other variables are skipped
+ *  @param out vector to append the predicates to, without duplicates
+ *  @return false if the file does not exist
+ *  @throws PonoException if the file is malformed
+ */
+bool read_predicate_cache(const std::string & filename,
+                          const TransitionSystem & ts,
+                          smt::TermVec & out);
+
+/** A result saved in a result cache */
+struct CachedResult
+{
+  ProverResult result = ProverResult::UNKNOWN;
+  smt::Term invar;  ///< the invariant of a TRUE result, if known
+  std::vector<smt::UnorderedTermMap> cex;  ///< the witness of a FALSE result,
+                                           ///< if known
+};
+
+/** Save a result in a result cache
+ *  The entry holds the system, so that a lookup can tell it apart from a
+ *  different system with the same hash, and is not saved if the system
+ *  can't be written (e.g. arrays). The invariant and witness are dropped
+ *  if they can't be written. The file is replaced atomically, so the
+ *  cache can be shared.
+ *  @param dir the cache directory
+ *  @param ts the system, e.g. after the cone-of-influence reduction
+ *  @param prop the property
+ *  @param options the options that change the result, part of the key
+ *  @param res the result, only TRUE or FALSE results are saved
+ *  @return true if the result was saved
+ *  @throws PonoException if the file cannot be written
+ */
+bool write_result_cache(const std::string & dir,
+                        const TransitionSystem & ts,
+                        const smt::Term & prop,
+                        const std::string & options,
+                        const CachedResult & res);
+
+/** Look up a result in a result cache
+ *  The invariant and witness are over the variables of ts. A cached
+ *  invariant should be checked with check_invar, and a cached witness
+ *  with check_witness, before the result is trusted.
+ *  @param dir the cache directory
+ *  @param ts the system
+ *  @param prop the property
+ *  @param options the options that change the result
+ *  @param out the result
+ *  @return false if there is no result for the same system, property
+ *          and options, or if the entry is malformed (it is logged)
+ */
+bool read_result_cache(const std::string & dir,
+                       const TransitionSystem & ts,
+                       const smt::Term & prop,
+                       const std::string & options,
+                       CachedResult & out);
+
+}  // namespace pono
@@ -0,0 +1,478 @@
+/*********************                                                        */
+/*! \file lemma_exchange.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Sharing of lemmas between portfolios on different machines
+**        (see --lemma-exchange).
+**
+**/
+
+#include "utils/lemma_exchange.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#include "core/fts.h"
+#include "core/rts.h"
+#include "printers/witness_values.h"
+#include "smt/available_solvers.h"
+#include "utils/exceptions.h"
+#include "utils/lemma_cache.h"
+#include "utils/logger.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+// the most lemmas a client sends per exchange, the rest is dropped
+static const size_t max_sent_lemmas = 256;
+// the lemmas of one share request
+static const size_t share_batch = 64;
+
+static string bits_to_hex(const string & bits)
+{
+  static const char digits[] = "0123456789abcdef";
+  string padded = string((4 - bits.size() % 4) % 4, '0') + bits;
+  string hex;
+  for (size_t i = 0; i < padded.size(); i += 4) {
+    int d = 0;
+    for (size_t j = i; j < i + 4; ++j) {
+      d = 2 * d + (padded[j] == '1');
+    }
+    hex.push_back(digits[d]);
+  }
+  return hex;
+}
+
+static bool parse_index(const string & s, size_t & idx)
+{
+  if (s.empty() || s.size() > 18
+      || s.find_first_not_of("0123456789") != string::npos) {
+    return false;
+  }
+  idx = stoul(s);
+  return true;
+}
+
+/* LemmaCodec */
+
+LemmaCodec::LemmaCodec(const TransitionSystem & ts, const Term & prop)
+    : ts_(ts)
+{
+  ostringstream h;
+  h << hex << setw(16) << setfill('0') << canonical_hash(ts, prop, &vars_);
+  hash_ = h.str();
+  for (size_t i = 0; i < vars_.size(); ++i) {
+    ids_[vars_[i]] = i;
+  }
+}
+
+int LemmaCodec::var_id(const Term & v) const
+{
+  auto it = ids_.find(v);
+  if (it == ids_.end() || !ts_.is_curr_var(v)) {
+    return -1;
+  }
+  return it->second;
+}
+
+string LemmaCodec::encode_literal(const Term & lit) const
+{
+  Op op = lit->get_op();
+  if (op.prim_op == Not) {
+    string s = encode_literal(*lit->begin());
+    if (s.empty()) {
+      return s;
+    }
+    return s[0] == '-' ? s.substr(1) : "-" + s;
+  }
+
+  if (lit->is_symbolic_const()) {
+    int id = var_id(lit);
+    if (id < 0 || lit->get_sort()->get_sort_kind() != BOOL) {
+      return "";
+    }
+    return std::to_string(id);
+  }
+
+  if (op.prim_op != Equal) {
+    return "";
+  }
+  TermVec children(lit->begin(), lit->end());
+  Term a = children[0];
+  Term b = children[1];
+  if (a->is_value()) {
+    std::swap(a, b);
+  }
+  if (!b->is_value() || a->get_sort()->get_sort_kind() != BV) {
+    return "";
+  }
+
+  if (a->is_symbolic_const()) {
+    // v = value
+    int id = var_id(a);
+    if (id < 0) {
+      return "";
+    }
+    return std::to_string(id) + "=" + bits_to_hex(value_bits(b));
+  }
+
+  Op aop = a->get_op();
+  if (aop.prim_op == Extract && aop.idx0 == aop.idx1) {
+    // ((_ extract i i) v) = #b0 or #b1, as in IC3Bits
+    int id = var_id(*a->begin());
+    if (id < 0) {
+      return "";
+    }
+    string s = std::to_string(id) + "." + std::to_string(aop.idx0);
+    return value_bits(b) == "0" ? "-" + s : s;
+  }
+  return "";
+}
+
+bool LemmaCodec::encode(const TermVec & clause, string & out) const
+{
+  vector<string> lits;
+  lits.reserve(clause.size());
+  for (const auto & l : clause) {
+    lits.push_back(encode_literal(l));
+    if (lits.back().empty()) {
+      return false;
+    }
+  }
+  if (lits.empty()) {
+    return false;
+  }
+  // the same clause has the same wire form on every machine
+  sort(lits.begin(), lits.end());
+
+  out.clear();
+  for (const auto & l : lits) {
+    if (!out.empty()) {
+      out += ",";
+    }
+    out += l;
+  }
+  return true;
+}
+
+Term LemmaCodec::decode_literal(const string & s) const
+{
+  bool neg = !s.empty() && s[0] == '-';
+  size_t begin = neg ? 1 : 0;
+  size_t end = s.find_first_of("=.", begin);
+  size_t id;
+  if (!parse_index(s.substr(begin, end - begin), id) || id >= vars_.size()) {
+    return nullptr;
+  }
+  const Term & v = vars_[id];
+  if (!ts_.is_curr_var(v)) {
+    return nullptr;
+  }
+
+  const SmtSolver & solver = ts_.solver();
+  Sort sort = v->get_sort();
+  Term lit;
+  if (end == string::npos) {
+    if (sort->get_sort_kind() != BOOL) {
+      return nullptr;
+    }
+    lit = v;
+  } else if (sort->get_sort_kind() != BV) {
+    return nullptr;
+  } else if (s[end] == '=') {
+    string hex = s.substr(end + 1);
+    size_t first = hex.find_first_not_of('0');
+    if (hex.empty()
+        || hex.find_first_not_of("0123456789abcdef") != string::npos
+        || (first != string::npos
+            && (hex.size() - first) * 4 > sort->get_width() + 3)) {
+      return nullptr;
+    }
+    try {
+      lit = solver->make_term(Equal, v, solver->make_term(hex, sort, 16));
+    }
+    catch (std::exception & e) {
+      // e.g. a value too wide for the variable
+      return nullptr;
+    }
+  } else {
+    size_t bit;
+    if (!parse_index(s.substr(end + 1), bit) || bit >= sort->get_width()) {
+      return nullptr;
+    }
+    lit = solver->make_term(
+        Equal,
+        solver->make_term(Op(Extract, bit, bit), v),
+        solver->make_term(1, solver->make_sort(BV, 1)));
+  }
+  return neg ? solver->make_term(Not, lit) : lit;
+}
+
+bool LemmaCodec::decode(const string & wire, TermVec & out) const
+{
+  out.clear();
+  size_t pos = 0;
+  while (pos <= wire.size()) {
+    size_t comma = wire.find(',', pos);
+    if (comma == string::npos) {
+      comma = wire.size();
+    }
+    Term lit = decode_literal(wire.substr(pos, comma - pos));
+    if (!lit) {
+      out.clear();
+      return false;
+    }
+    out.push_back(lit);
+    pos = comma + 1;
+  }
+  return !out.empty();
+}
+
+/* LemmaExchange */
+
+LemmaExchange::LemmaExchange(size_t rate, size_t max_lemmas)
+    : rate_(rate), max_lemmas_(max_lemmas), num_dropped_(0)
+{
+}
+
+size_t LemmaExchange::share(const string & hash, const vector<string> & lemmas)
+{
+  auto now = chrono::steady_clock::now();
+  lock_guard<mutex> lock(mutex_);
+  auto it = pools_.find(hash);
+  if (it == pools_.end()) {
+    it = pools_.emplace(hash, Pool()).first;
+    it->second.tokens = rate_;
+    it->second.refilled = now;
+  }
+  Pool & pool = it->second;
+  double elapsed = chrono::duration<double>(now - pool.refilled).count();
+  pool.tokens = min<double>(rate_, pool.tokens + elapsed * rate_);
+  pool.refilled = now;
+
+  size_t num_new = 0;
+  for (const auto & l : lemmas) {
+    if (pool.seen.find(l) != pool.seen.end()) {
+      continue;
+    }
+    if (pool.tokens < 1 || pool.lemmas.size() >= max_lemmas_) {
+      ++num_dropped_;
+      continue;
+    }
+    pool.tokens -= 1;
+    pool.seen.insert(l);
+    pool.lemmas.push_back(l);
+    ++num_new;
+  }
+  return num_new;
+}
+
+size_t LemmaExchange::fetch(const string & hash,
+                            size_t since,
+                            vector<string> & out,
+                            size_t max_lemmas) const
+{
+  lock_guard<mutex> lock(mutex_);
+  auto it = pools_.find(hash);
+  if (it == pools_.end()) {
+    return 0;
+  }
+  const vector<string> & lemmas = it->second.lemmas;
+  size_t end = min(lemmas.size(), since + max_lemmas);
+  for (size_t i = since; i < end; ++i) {
+    out.push_back(lemmas[i]);
+  }
+  return max(since, end);
+}
+
+size_t LemmaExchange::num_dropped() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return num_dropped_;
+}
+
+/* LemmaExchangeClient */
+
+LemmaExchangeClient::LemmaExchangeClient(const shared_ptr<LemmaBus> & bus,
+                                         const TransitionSystem & ts,
+                                         const Term & prop,
+                                         unique_ptr<CubeServer> server)
+    : bus_(bus),
+      solver_(create_solver(ts.solver()->get_solver_enum())),
+      bus_idx_(0),
+      remote_idx_(0),
+      stats_(make_shared<Statistics>()),
+      server_(std::move(server)),
+      closed_(false),
+      stopping_(false)
+{
+  // the cache of from_bus_ maps the terms of ts to the copy
+  from_bus_.reset(new TermTranslator(solver_));
+  if (ts.is_functional()) {
+    ts_.reset(new FunctionalTransitionSystem(ts, *from_bus_));
+  } else {
+    ts_.reset(new RelationalTransitionSystem(ts, *from_bus_));
+  }
+  codec_.reset(
+      new LemmaCodec(*ts_, from_bus_->transfer_term(prop, BOOL)));
+
+  to_bus_.reset(new TermTranslator(bus_->solver()));
+  UnorderedTermMap & cache = to_bus_->get_cache();
+  for (const auto & v : ts.statevars()) {
+    cache[from_bus_->transfer_term(v)] = v;
+  }
+
+  bus_->register_source(this);
+  statistics_registry.add("lemma_exchange", stats_);
+  logger.log(1, "Lemma exchange: system {}", codec_->hash());
+
+  server_->set_handler([this](const string & line) {
+    lock_guard<mutex> lock(reply_mutex_);
+    if (line == "closed") {
+      closed_ = true;
+    } else {
+      replies_.push_back(line);
+    }
+    reply_cv_.notify_all();
+  });
+}
+
+LemmaExchangeClient::~LemmaExchangeClient()
+{
+  {
+    lock_guard<mutex> lock(stop_mutex_);
+    stopping_ = true;
+  }
+  stop_cv_.notify_all();
+  {
+    // wakes up a pending request
+    lock_guard<mutex> lock(reply_mutex_);
+    closed_ = true;
+  }
+  reply_cv_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  // before the members the handler uses
+  server_.reset();
+}
+
+void LemmaExchangeClient::start(size_t period_ms)
+{
+  if (thread_.joinable()) {
+    throw PonoException("Lemma exchange already started");
+  }
+  thread_ = thread(&LemmaExchangeClient::run, this, period_ms);
+}
+
+void LemmaExchangeClient::request(const string & req,
+                                  const string & last,
+                                  vector<string> & lines)
+{
+  {
+    lock_guard<mutex> lock(reply_mutex_);
+    replies_.clear();
+  }
+  server_->send(req);
+
+  // only one request is pending, so its last line is the last reply
+  auto is_last = [&](const string & line) {
+    return line.compare(0, last.size() + 1, last + " ") == 0
+           || line.compare(0, 6, "error ") == 0;
+  };
+  unique_lock<mutex> lock(reply_mutex_);
+  reply_cv_.wait(lock, [&]() {
+    return closed_ || (replies_.size() && is_last(replies_.back()));
+  });
+  if (replies_.empty() || !is_last(replies_.back())) {
+    throw PonoException("Lemma exchange: the server closed the connection");
+  }
+  if (replies_.back().compare(0, 6, "error ") == 0) {
+    throw PonoException("Lemma exchange: " + replies_.back());
+  }
+  lines = std::move(replies_);
+  replies_.clear();
+}
+
+void LemmaExchangeClient::sync()
+{
+  const string & hash = codec_->hash();
+
+  vector<TermVec> local;
+  bus_->import_lemmas(bus_idx_, *from_bus_, this, local, stats_.get());
+  vector<string> wires;
+  string w;
+  for (const auto & c : local) {
+    if (!codec_->encode(c, w)) {
+      // e.g. predicates of IC3IA
+      stats_->increment("lemmas_not_encoded");
+    } else if (known_.insert(w).second) {
+      wires.push_back(w);
+    }
+  }
+  if (wires.size() > max_sent_lemmas) {
+    stats_->increment("lemmas_not_sent", wires.size() - max_sent_lemmas);
+    wires.resize(max_sent_lemmas);
+  }
+
+  vector<string> lines;
+  for (size_t i = 0; i < wires.size(); i += share_batch) {
+    string req = "share " + hash;
+    for (size_t j = i; j < min(wires.size(), i + share_batch); ++j) {
+      req += " " + wires[j];
+    }
+    request(req, "shared", lines);
+  }
+  stats_->increment("lemmas_sent", wires.size());
+
+  request("fetch " + hash + " " + std::to_string(remote_idx_), "fetched", lines);
+  TermVec children;
+  for (const auto & line : lines) {
+    if (line.compare(0, 8, "fetched ") == 0) {
+      parse_index(line.substr(8), remote_idx_);
+    } else if (line.compare(0, 6, "lemma ") == 0) {
+      string wire = line.substr(6);
+      if (!known_.insert(wire).second) {
+        // e.g. one of ours
+        continue;
+      }
+      if (!codec_->decode(wire, children)) {
+        stats_->increment("lemmas_malformed");
+        continue;
+      }
+      // only candidates, the engines check them before use
+      bus_->publish_lemma(children, *to_bus_, this, stats_.get(), -1);
+      stats_->increment("lemmas_received");
+    }
+  }
+}
+
+void LemmaExchangeClient::run(size_t period_ms)
+{
+  unique_lock<mutex> lock(stop_mutex_);
+  while (!stop_cv_.wait_for(lock, chrono::milliseconds(period_ms), [this]() {
+    return stopping_;
+  })) {
+    lock.unlock();
+    try {
+      sync();
+    }
+    catch (PonoException & e) {
+      logger.log(1, "Lemma exchange stopped: {}", e.what());
+      return;
+    }
+    lock.lock();
+  }
+}
+
+}  // namespace pono
@@ -0,0 +1,219 @@
+/*********************                                                        */
+/*! \file lemma_exchange.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Sharing of lemmas between portfolios on different machines
+**        (see --lemma-exchange). A verification server (pono --serve)
+**        keeps the lemmas it is sent, per system, and each portfolio
+**        connected to it sends the lemmas of its LemmaBus and publishes
+**        the lemmas of the others on its bus as candidates, which the
+**        engines check before using them.
+**
+**        On the wire, a system is identified by the hash of its
+**        structure (see canonical_hash), so different frontends or
+**        variable names of the same system match. A lemma is a sorted
+**        list of literals separated by ',', each over a state variable
+**        identified by its position in the canonical order:
+**          <id>          the boolean variable
+**          <id>=<hex>    the bit-vector variable equals a value
+**          <id>.<bit>    the bit of the bit-vector variable is 1
+**        and negated with a leading '-'.
+**
+**        The server side requests are:
+**          share <hash> <lemma>...
+**            -> shared <number of new lemmas kept>
+**          fetch <hash> <index>
+**            -> lemma <lemma> lines, then fetched <next index>
+**
+**/
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "core/ts.h"
+#include "smt-switch/smt.h"
+#include "smt-switch/term_translator.h"
+#include "utils/cube_and_conquer.h"
+#include "utils/lemma_bus.h"
+#include "utils/statistics.h"
+
+namespace pono {
+
+/** Converts between clauses over a system and their wire form */
+class LemmaCodec
+{
+ public:
+  /** @param ts the transition system, must outlive the codec
+   *  @param prop the property, part of the hash
+   */
+  LemmaCodec(const TransitionSystem & ts, const smt::Term & prop);
+
+  /** @return the hash of the system, in hexadecimal */
+  const std::string & hash() const { return hash_; }
+
+  /** @param clause the literals of a clause over the state variables
+   *  @param out set to the wire form
+   *  @return false if a literal has none (e.g. a predicate)
+   */
+  bool encode(const smt::TermVec & clause, std::string & out) const;
+
+  /** @param wire a lemma in the wire form
+   *  @param out set to the literals of the clause
+   *  @return false if the lemma is malformed or not over this system
+   */
+  bool decode(const std::string & wire, smt::TermVec & out) const;
+
+ protected:
+  /** @return the wire form of a literal, empty if it has none */
+  std::string encode_literal(const smt::Term & lit) const;
+
+  smt::Term decode_literal(const std::string & s) const;
+
+  /** @return the position of a state variable, -1 if it isn't one */
+  int var_id(const smt::Term & v) const;
+
+  const TransitionSystem & ts_;
+  std::string hash_;
+  smt::TermVec vars_;  ///< in the canonical order, may contain inputs
+  std::unordered_map<smt::Term, size_t> ids_;
+};
+
+/** The lemmas kept by a verification server for its clients
+ *  Duplicates are dropped, and each system accepts at most rate new
+ *  lemmas per second (a token bucket holding up to one second), so a
+ *  chatty client can't flood the others.
+ */
+class LemmaExchange
+{
+ public:
+  /** @param rate the new lemmas accepted per second for each system
+   *  @param max_lemmas the lemmas kept for each system
+   */
+  LemmaExchange(size_t rate = 1000, size_t max_lemmas = 100000);
+
+  /** Add lemmas of a system
+   *  @return the number of new lemmas kept
+   */
+  size_t share(const std::string & hash,
+               const std::vector<std::string> & lemmas);
+
+  /** Get the lemmas of a system
+   *  @param hash the system
+   *  @param since the number of lemmas already fetched
+   *  @param out vector to append the new lemmas to
+   *  @param max_lemmas the most lemmas to return
+   *  @return the index to fetch from next time
+   */
+  size_t fetch(const std::string & hash,
+               size_t since,
+               std::vector<std::string> & out,
+               size_t max_lemmas = 1000) const;
+
+  /** @return the lemmas dropped by the rate limit or the size limit */
+  size_t num_dropped() const;
+
+ protected:
+  struct Pool
+  {
+    std::vector<std::string> lemmas;
+    std::unordered_set<std::string> seen;
+    double tokens;
+    std::chrono::steady_clock::time_point refilled;
+  };
+
+  size_t rate_;
+  size_t max_lemmas_;
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, Pool> pools_;
+  size_t num_dropped_;
+};
+
+/** Connects a LemmaBus to the lemma exchange of a verification server
+ *  Once started, a thread sends the new lemmas of the bus (those the
+ *  codec can encode) every period and publishes the new lemmas of the
+ *  server on the bus as candidates. It works on its own copy of the
+ *  system, and only uses the bus solver through the bus.
+ */
+class LemmaExchangeClient
+{
+ public:
+  /** @param bus the bus of the portfolio
+   *  @param ts the system of the bus, only read during construction
+   *  @param prop the property
+   *  @param server the connection to the server
+   */
+  LemmaExchangeClient(const std::shared_ptr<LemmaBus> & bus,
+                      const TransitionSystem & ts,
+                      const smt::Term & prop,
+                      std::unique_ptr<CubeServer> server);
+
+  /** Stops the thread, lemmas not yet exchanged are dropped */
+  ~LemmaExchangeClient();
+
+  /** Start the thread calling sync
+   *  Publishing on the bus uses the solver of ts, so only once nothing
+   *  else reads the terms of ts (e.g. after the provers copied it).
+   *  @param period_ms the time between two exchanges
+   */
+  void start(size_t period_ms = 500);
+
+  /** Exchange the new lemmas with the server once
+   *  @throws PonoException if the server closed the connection
+   */
+  void sync();
+
+  const Statistics & statistics() const { return *stats_; }
+
+ protected:
+  /** Send a request and wait for the line that ends its reply
+   *  @param request the request line
+   *  @param last the first word of the line ending the reply
+   *  @param lines set to the reply lines, the last one included
+   */
+  void request(const std::string & request,
+               const std::string & last,
+               std::vector<std::string> & lines);
+
+  void run(size_t period_ms);
+
+  std::shared_ptr<LemmaBus> bus_;
+  smt::SmtSolver solver_;
+  std::unique_ptr<TransitionSystem> ts_;
+  std::unique_ptr<LemmaCodec> codec_;
+  std::unique_ptr<smt::TermTranslator> to_bus_;
+  std::unique_ptr<smt::TermTranslator> from_bus_;
+  size_t bus_idx_;      ///< lemmas imported from the bus
+  size_t remote_idx_;   ///< lemmas fetched from the server
+  std::unordered_set<std::string> known_;  ///< sent or received
+  std::shared_ptr<Statistics> stats_;
+
+  std::unique_ptr<CubeServer> server_;
+  std::mutex reply_mutex_;
+  std::condition_variable reply_cv_;
+  std::vector<std::string> replies_;
+  bool closed_;
+
+  std::mutex stop_mutex_;
+  std::condition_variable stop_cv_;
+  bool stopping_;
+  std::thread thread_;
+};
+
+}  // namespace pono
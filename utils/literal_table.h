@@ -0,0 +1,89 @@
+/*********************                                                        */
+/*! \file literal_table.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Dense 32-bit ids for the literals of the clauses of an engine.
+**
+**        Sorted vectors of ids compare, intersect and test inclusion
+**        with integer comparisons only, without touching the terms
+**        (reference counts, hashing, term equality).
+**
+**/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "smt-switch/smt.h"
+#include "utils/exceptions.h"
+#include "utils/term_hash_map.h"
+
+namespace pono {
+
+typedef uint32_t LitId;
+typedef std::vector<LitId> LitVec;  ///< sorted, without duplicates
+
+class LiteralTable
+{
+ public:
+  /** @return the id of the literal l, assigning the next one if new */
+  LitId id(const smt::Term & l)
+  {
+    auto it = ids_.find(l);
+    if (it != ids_.end()) {
+      return it->second;
+    }
+    if (terms_.size() == std::numeric_limits<LitId>::max()) {
+      throw PonoException("Too many literals in the literal table");
+    }
+    LitId res = terms_.size();
+    ids_.emplace(l, res);
+    terms_.push_back(l);
+    return res;
+  }
+
+  /** @return the sorted ids of the literals */
+  LitVec ids(const smt::TermVec & lits)
+  {
+    LitVec res;
+    res.reserve(lits.size());
+    for (const auto & l : lits) {
+      res.push_back(id(l));
+    }
+    std::sort(res.begin(), res.end());
+    res.erase(std::unique(res.begin(), res.end()), res.end());
+    return res;
+  }
+
+  /** @return the literal of id */
+  const smt::Term & term(LitId id) const { return terms_.at(id); }
+
+  /** @return the literals of the sorted ids */
+  smt::TermVec terms(const LitVec & ids) const
+  {
+    smt::TermVec res;
+    res.reserve(ids.size());
+    for (LitId id : ids) {
+      res.push_back(term(id));
+    }
+    return res;
+  }
+
+  size_t size() const { return terms_.size(); }
+
+ private:
+  TermHashMap<LitId> ids_;
+  smt::TermVec terms_;  ///< indexed by id
+};
+
+}  // namespace pono
@@ -16,6 +16,13 @@
 
 #include "utils/logger.h"
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
 std::string remove_curly_brackets(std::string s)
 {
   std::size_t pos;
@@ -28,8 +35,245 @@ std::string remove_curly_brackets(std::string s)
   return s;
 }
 
-// declare a global logger
 namespace pono {
+
+/** Where the messages go, buffered and rate limited if configured */
+class LogSink
+{
+ public:
+  LogSink() : buffer_size_(0), rate_limit_(0), count_(0), dropped_(0),
+              total_dropped_(0), stop_(false)
+  {
+  }
+
+  ~LogSink()
+  {
+    set_async(false);
+    flush();
+  }
+
+  void emit(const std::string & msg)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (rate_limit_ && !within_rate()) {
+      return;
+    }
+
+    pending_ += msg;
+    pending_ += '\n';
+    if (pending_.size() < buffer_size_) {
+      return;
+    }
+
+    if (writer_.joinable()) {
+      cv_.notify_one();
+    } else {
+      write_pending(lock);
+    }
+  }
+
+  void flush()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    write_pending(lock);
+  }
+
+  void set_buffer_size(size_t size)
+  {
+    flush();
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffer_size_ = size;
+  }
+
+  void set_async(bool async)
+  {
+    if (async == writer_.joinable()) {
+      return;
+    } else if (async) {
+      stop_ = false;
+      writer_ = std::thread([this]() { write_loop(); });
+    } else {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+      }
+      cv_.notify_one();
+      writer_.join();
+    }
+  }
+
+  void set_rate_limit(size_t n)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rate_limit_ = n;
+    count_ = 0;
+    window_start_ = std::chrono::steady_clock::now();
+  }
+
+  size_t num_dropped()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_dropped_;
+  }
+
+ protected:
+  /** @return true iff the message is within the rate limit
+   *  @requires mutex_ is held
+   */
+  bool within_rate()
+  {
+    auto now = std::chrono::steady_clock::now();
+    if (now - window_start_ >= std::chrono::seconds(1)) {
+      if (dropped_) {
+        pending_ += fmt::format("[log] dropped {} messages over the rate limit\n",
+                                dropped_);
+      }
+      window_start_ = now;
+      count_ = 0;
+      dropped_ = 0;
+    }
+    if (count_ >= rate_limit_) {
+      ++dropped_;
+      ++total_dropped_;
+      return false;
+    }
+    ++count_;
+    return true;
+  }
+
+  /** Write the pending messages
+   *  The output lock is taken before the buffer lock is released, so
+   *  that the batches are written in the order they were taken.
+   *  @requires lock holds mutex_, released on return
+   */
+  void write_pending(std::unique_lock<std::mutex> & lock)
+  {
+    std::string out;
+    out.swap(pending_);
+    std::lock_guard<std::mutex> out_lock(out_mutex_);
+    lock.unlock();
+    if (out.size()) {
+      std::cout.write(out.data(), out.size());
+      std::cout.flush();
+    }
+  }
+
+  void write_loop()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      cv_.wait(lock,
+               [this]() { return stop_ || pending_.size() >= buffer_size_; });
+      if (stop_) {
+        return;
+      }
+      write_pending(lock);
+      lock.lock();
+    }
+  }
+
+  std::mutex mutex_;      ///< protects everything but the output
+  std::mutex out_mutex_;  ///< held while writing to the output
+  std::string pending_;   ///< messages not written yet
+  size_t buffer_size_;
+
+  size_t rate_limit_;  ///< messages per second, 0 for no limit
+  std::chrono::steady_clock::time_point window_start_;
+  size_t count_;    ///< messages in the current second
+  size_t dropped_;  ///< messages dropped in the current second
+  size_t total_dropped_;
+
+  std::thread writer_;  ///< only with set_async
+  std::condition_variable cv_;
+  bool stop_;
+};
+
+// component verbosities live as long as the program, and may be
+// registered from static initializers of other translation units
+static std::mutex & components_mutex()
+{
+  static std::mutex m;
+  return m;
+}
+
+static std::unordered_map<std::string, std::atomic<int> *> & components()
+{
+  static std::unordered_map<std::string, std::atomic<int> *> c;
+  return c;
+}
+
+static std::atomic<int> * component_verbosity(const std::string & name)
+{
+  // never freed, a deque keeps the addresses stable
+  static std::deque<std::atomic<int>> store;
+  std::lock_guard<std::mutex> lock(components_mutex());
+  auto it = components().find(name);
+  if (it != components().end()) {
+    return it->second;
+  }
+  store.emplace_back(-1);
+  components()[name] = &store.back();
+  return &store.back();
+}
+
+Log::Log() : verbosity(0), verbosity_set(false), sink_(new LogSink()) {}
+
+Log::Log(size_t v) : verbosity(v), verbosity_set(true), sink_(new LogSink())
+{
+}
+
+Log::~Log() {}
+
+LogComponent Log::component(const std::string & name)
+{
+  return { component_verbosity(name) };
+}
+
+void Log::set_component_verbosity(const std::string & name, size_t v)
+{
+  component_verbosity(name)->store(v, std::memory_order_relaxed);
+}
+
+void Log::set_component_verbosities(const std::string & spec)
+{
+  size_t start = 0;
+  while (start < spec.size()) {
+    size_t end = spec.find(',', start);
+    if (end == std::string::npos) {
+      end = spec.size();
+    }
+    std::string item = spec.substr(start, end - start);
+    size_t eq = item.find('=');
+    if (eq == std::string::npos || !eq || eq + 1 == item.size()) {
+      throw PonoException("Expecting component=verbosity in log components "
+                          "but got: " + item);
+    }
+    size_t v;
+    try {
+      v = std::stoul(item.substr(eq + 1));
+    }
+    catch (std::exception & e) {
+      throw PonoException("Expecting a number as the verbosity of log "
+                          "component " + item.substr(0, eq));
+    }
+    set_component_verbosity(item.substr(0, eq), v);
+    start = end + 1;
+  }
+}
+
+void Log::set_buffer_size(size_t size) { sink_->set_buffer_size(size); }
+
+void Log::set_async(bool async) { sink_->set_async(async); }
+
+void Log::set_rate_limit(size_t n) { sink_->set_rate_limit(n); }
+
+void Log::flush() { sink_->flush(); }
+
+size_t Log::num_dropped() const { return sink_->num_dropped(); }
+
+void Log::emit(const std::string & msg) const { sink_->emit(msg); }
+
+// declare a global logger
 Log logger;
 
 void set_global_logger_verbosity(size_t v) { logger.set_verbosity(v); }
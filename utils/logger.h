@@ -20,7 +20,9 @@
 #define FMT_HEADER_ONLY
 
 #include <fmt/format.h>
+#include <atomic>
 #include <iostream>
+#include <memory>
 
 #include <smt-switch/smt.h>
 
@@ -129,14 +131,33 @@ struct fmt::formatter<smt::Result>
  * ************************************************/
 // Meant to be used as a singleton class -- instantiated as logger below
 
+/** Compile-time maximum verbosity, e.g. -DPONO_LOG_MAX_LEVEL=1
+ *  Calls to log with a constant level above it compile to nothing.
+ */
+#ifndef PONO_LOG_MAX_LEVEL
+#define PONO_LOG_MAX_LEVEL 100
+#endif
+
 namespace pono {
 
+/** Handle of a named part of pono (e.g. an engine) whose verbosity can be
+ *  set separately, see Log::component
+ */
+struct LogComponent
+{
+  const std::atomic<int> * verbosity;  ///< negative to use the global one
+};
+
+class LogSink;
+
 class Log
 {
  public:
-  Log() : verbosity(0), verbosity_set(false) {}
+  Log();
+
+  Log(size_t v);
 
-  Log(size_t v) : verbosity(v), verbosity_set(true) {}
+  ~Log();
 
   /* Logs to the terminal using Python-style format string
    * @param level the verbosity level to print this log (prints for any
@@ -147,9 +168,9 @@ class Log
   template <typename... Args>
   void log(size_t level, const std::string & format, const Args &... args) const
   {
-    if (level <= verbosity)
+    if (enabled(level))
     {
-      std::cout << fmt::format(format, args...) << std::endl;
+      emit(fmt::format(format, args...));
     }
   }
 
@@ -166,12 +187,43 @@ class Log
            const std::string & format,
            const Args &... args) const
   {
-    if ((lower <= verbosity) && (verbosity <= upper))
+    if (enabled(lower) && (verbosity <= upper))
+    {
+      emit(fmt::format(format, args...));
+    }
+  }
+
+  /* Logs a message of a component, see component
+   * @param c the component
+   * @param level the verbosity level to print this log
+   * @param format the format string
+   * @param args comma separated list of inputs for the format string
+   */
+  template <typename... Args>
+  void log(const LogComponent & c,
+           size_t level,
+           const std::string & format,
+           const Args &... args) const
+  {
+    if (enabled(c, level))
     {
-      std::cout << fmt::format(format, args...) << std::endl;
+      emit(fmt::format(format, args...));
     }
   }
 
+  /** @return true iff a message at this level would be printed */
+  bool enabled(size_t level) const
+  {
+    return level <= PONO_LOG_MAX_LEVEL && level <= verbosity;
+  }
+
+  bool enabled(const LogComponent & c, size_t level) const
+  {
+    int v = c.verbosity->load(std::memory_order_relaxed);
+    return level <= PONO_LOG_MAX_LEVEL
+           && level <= (v < 0 ? verbosity : size_t(v));
+  }
+
   /* set verbosity -- can only be set once
    * @param v the verbosity to set
    */
@@ -187,9 +239,52 @@ class Log
     }
   }
 
+  /** @return the handle of a component, created on the first call with
+   *          this name. Safe to call during static initialization.
+   */
+  static LogComponent component(const std::string & name);
+
+  /** Use a verbosity for a component instead of the global one
+   *  @param name the name of the component
+   *  @param v the verbosity of its messages
+   */
+  static void set_component_verbosity(const std::string & name, size_t v);
+
+  /** Set the verbosity of components from a specification
+   *  @param spec comma separated name=verbosity pairs, e.g. "ic3=3,bmc=0"
+   */
+  static void set_component_verbosities(const std::string & spec);
+
+  /** Buffer the messages instead of flushing the output after each one
+   *  The buffer is written once it holds size bytes, on flush and at exit.
+   *  @param size the buffer size in bytes, 0 flushes every message (the
+   *         default)
+   */
+  void set_buffer_size(size_t size);
+
+  /** Write the full buffers from a background thread, so that logging
+   *  never waits for the output. Only used with a buffer.
+   */
+  void set_async(bool async);
+
+  /** Print at most n messages per second, drop and count the others
+   *  @param n the number of messages, 0 for no limit (the default)
+   */
+  void set_rate_limit(size_t n);
+
+  /** Write the buffered messages, e.g. before printing results */
+  void flush();
+
+  /** @return the number of messages dropped by the rate limit */
+  size_t num_dropped() const;
+
  protected:
+  /** Write or buffer a formatted message */
+  void emit(const std::string & msg) const;
+
   size_t verbosity;
   bool verbosity_set;
+  std::unique_ptr<LogSink> sink_;
 };
 
 // globally avaiable logger instance
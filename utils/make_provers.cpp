@@ -19,18 +19,29 @@
 #include "engines/bmc.h"
 #include "engines/bmc_simplepath.h"
 #include "engines/ceg_prophecy_arrays.h"
+#include "engines/cegar_localization.h"
+#include "engines/cegar_width_reduction.h"
 #include "engines/cegar_ops_uf.h"
 #include "engines/cegar_values.h"
 #include "engines/ic3bits.h"
 #include "engines/ic3ia.h"
 #include "engines/ic3sa.h"
 #include "engines/interpolantmc.h"
+#include "engines/ismc.h"
 #include "engines/kinduction.h"
+#include "engines/kliveness.h"
 #include "engines/mbic3.h"
+#include "engines/parallel_bmc.h"
+#include "engines/prop_decomposition.h"
+#include "engines/random_sim.h"
+#include "engines/reverse_ic3.h"
 #include "engines/syguspdr.h"
 #ifdef WITH_MSAT_IC3IA
 #include "engines/msat_ic3ia.h"
 #endif
+#ifdef WITH_CUDD
+#include "engines/bdd_reach.h"
+#endif
 
 #include "smt/available_solvers.h"
 
@@ -41,10 +52,14 @@ namespace pono {
 
 vector<Engine> all_engines()
 {
-  return { BMC, BMC_SP, KIND, MBIC3,
+  return { BMC, BMC_SP, KIND, MBIC3, SIM, REVERSE_IC3,
            #ifdef WITH_MSAT
            INTERP,
            IC3IA_ENGINE,
+           ISMC_ENGINE,
+           #endif
+           #ifdef WITH_CUDD
+           BDD_REACH,
            #endif
            IC3SA_ENGINE
   };
@@ -88,6 +103,27 @@ shared_ptr<Prover> make_prover(Engine e,
     return make_shared<IC3SA>(p, ts, slv, opts);
   } else if (e == SYGUS_PDR) {
     return make_shared<SygusPdr>(p, ts, slv, opts);
+  } else if (e == BMC_PAR) {
+    return make_shared<ParallelBmc>(p, ts, slv, opts);
+  } else if (e == ISMC_ENGINE) {
+#ifdef WITH_MSAT
+    return make_shared<ISMC>(p, ts, slv, opts);
+#else
+    throw PonoException(
+        "Interpolation-sequence modelchecking requires an interpolator");
+#endif
+  } else if (e == SIM) {
+    return make_shared<RandomSim>(p, ts, slv, opts);
+  } else if (e == KLIVE) {
+    return make_shared<KLiveness>(p, ts, slv, opts);
+  } else if (e == REVERSE_IC3) {
+    return make_shared<ReverseIC3>(p, ts, slv, opts);
+  } else if (e == BDD_REACH) {
+#ifdef WITH_CUDD
+    return make_shared<BddReach>(p, ts, slv, opts);
+#else
+    throw PonoException("The BDD engine requires building with CUDD");
+#endif
   } else {
     throw PonoException("Unhandled engine");
   }
@@ -158,6 +194,8 @@ shared_ptr<Prover> make_cegar_bv_arith_prover(Engine e,
       prover->set_ops_to_abstract(
           { BVMul, BVUdiv, BVSdiv, BVUrem, BVSrem, BVSmod });
       prover->set_min_bitwidth(opts.ceg_bv_arith_min_bw_);
+      prover->set_min_cost(opts.ceg_bv_arith_min_cost_);
+      prover->set_max_op_refinements(opts.ceg_bv_arith_max_refine_);
       return prover;
     } else {
       shared_ptr<CegarOpsUf<IC3IA>> prover =
@@ -165,6 +203,8 @@ shared_ptr<Prover> make_cegar_bv_arith_prover(Engine e,
       prover->set_ops_to_abstract(
           { BVMul, BVUdiv, BVSdiv, BVUrem, BVSrem, BVSmod });
       prover->set_min_bitwidth(opts.ceg_bv_arith_min_bw_);
+      prover->set_min_cost(opts.ceg_bv_arith_min_cost_);
+      prover->set_max_op_refinements(opts.ceg_bv_arith_max_refine_);
       return prover;
     }
   } else if (e == IC3SA_ENGINE) {
@@ -173,10 +213,54 @@ shared_ptr<Prover> make_cegar_bv_arith_prover(Engine e,
     prover->set_ops_to_abstract(
         { BVMul, BVUdiv, BVSdiv, BVUrem, BVSrem, BVSmod });
     prover->set_min_bitwidth(opts.ceg_bv_arith_min_bw_);
+    prover->set_min_cost(opts.ceg_bv_arith_min_cost_);
+    prover->set_max_op_refinements(opts.ceg_bv_arith_max_refine_);
     return prover;
   } else {
     throw PonoException("CegarOpsUf currently only supports IC3IA and IC3SA");
   }
 }
 
+shared_ptr<Prover> make_cegar_localization_prover(Engine e,
+                                                  const Property & p,
+                                                  const TransitionSystem & ts,
+                                                  const SmtSolver & slv,
+                                                  PonoOptions opts)
+{
+  if (e == MSAT_IC3IA) {
+    throw PonoException(
+        "CegarLocalization needs an engine that supports check_until");
+  }
+  opts.engine_ = e;
+  return make_shared<CegarLocalization>(p, ts, slv, opts);
+}
+
+shared_ptr<Prover> make_cegar_width_reduction_prover(
+    Engine e,
+    const Property & p,
+    const TransitionSystem & ts,
+    const SmtSolver & slv,
+    PonoOptions opts)
+{
+  if (e == MSAT_IC3IA) {
+    throw PonoException(
+        "CegarWidthReduction needs an engine that supports check_until");
+  }
+  opts.engine_ = e;
+  return make_shared<CegarWidthReduction>(p, ts, slv, opts);
+}
+
+shared_ptr<Prover> make_decomposed_prover(Engine e,
+                                          const Property & p,
+                                          const TransitionSystem & ts,
+                                          const SmtSolver & slv,
+                                          PonoOptions opts)
+{
+  if (e == KLIVE) {
+    throw PonoException("PropDecomposition needs a safety engine");
+  }
+  opts.engine_ = e;
+  return make_shared<PropDecomposition>(p, ts, slv, opts);
+}
+
 }  // namespace pono
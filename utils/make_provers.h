@@ -48,4 +48,25 @@ std::shared_ptr<Prover> make_cegar_bv_arith_prover(
     const smt::SmtSolver & slv,
     PonoOptions opts = PonoOptions());
 
+std::shared_ptr<Prover> make_cegar_localization_prover(
+    Engine e,
+    const Property & p,
+    const TransitionSystem & ts,
+    const smt::SmtSolver & slv,
+    PonoOptions opts = PonoOptions());
+
+std::shared_ptr<Prover> make_cegar_width_reduction_prover(
+    Engine e,
+    const Property & p,
+    const TransitionSystem & ts,
+    const smt::SmtSolver & slv,
+    PonoOptions opts = PonoOptions());
+
+std::shared_ptr<Prover> make_decomposed_prover(
+    Engine e,
+    const Property & p,
+    const TransitionSystem & ts,
+    const smt::SmtSolver & slv,
+    PonoOptions opts = PonoOptions());
+
 }  // namespace pono
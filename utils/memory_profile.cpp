@@ -0,0 +1,98 @@
+/*********************                                                        */
+/*! \file memory_profile.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Resident memory of the process sampled at phase boundaries.
+**
+**/
+
+#include "utils/memory_profile.h"
+
+#include <cstdlib>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "utils/budget.h"
+#include "utils/logger.h"
+
+using namespace std;
+
+namespace pono {
+
+MemoryProfile memory_profile;
+
+MemoryProfile::MemoryProfile() : enabled_(false), stats_(new Statistics())
+{
+}
+
+void MemoryProfile::enable()
+{
+  if (enabled_ || !statistics_registry.enabled()) {
+    return;
+  }
+  enabled_ = true;
+  statistics_registry.add("memory", stats_);
+}
+
+void MemoryProfile::record(const char * name, size_t peak_kb_before)
+{
+  const string phase(name);
+  size_t peak_kb = peak_memory_kb();
+  stats_->set(phase + "_rss_kb", current_memory_kb());
+  stats_->increment(phase + "_peak_growth_kb",
+                    peak_kb > peak_kb_before ? peak_kb - peak_kb_before : 0);
+  stats_->set("peak_rss_kb", peak_kb);
+}
+
+void MemoryProfile::record_release(const char * name,
+                                   size_t released_kb,
+                                   size_t retained_kb)
+{
+  const string owner(name);
+  stats_->increment(owner + "_released_kb", released_kb);
+  stats_->set(owner + "_retained_kb", retained_kb);
+}
+
+size_t release_memory(const char * name)
+{
+  size_t before_kb = current_memory_kb();
+#ifdef __GLIBC__
+  malloc_trim(0);
+#endif
+  size_t after_kb = current_memory_kb();
+  size_t released_kb = before_kb > after_kb ? before_kb - after_kb : 0;
+  if (memory_profile.enabled()) {
+    memory_profile.record_release(name, released_kb, after_kb);
+  }
+  logger.log(2,
+             "Released {}kB of memory after {}, {}kB resident",
+             released_kb,
+             name,
+             after_kb);
+  return released_kb;
+}
+
+MemoryPhase::MemoryPhase(const char * name)
+    : name_(name), active_(memory_profile.enabled()), peak_kb_before_(0)
+{
+  if (active_) {
+    peak_kb_before_ = peak_memory_kb();
+  }
+}
+
+MemoryPhase::~MemoryPhase()
+{
+  if (active_) {
+    memory_profile.record(name_, peak_kb_before_);
+  }
+}
+
+}  // namespace pono
@@ -0,0 +1,105 @@
+/*********************                                                        */
+/*! \file memory_profile.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Resident memory of the process sampled at phase boundaries
+**        (parsing, preprocessing, proving), reported as the "memory"
+**        entry of the statistics JSON. For each phase:
+**          <phase>_rss_kb          the resident memory at its end
+**          <phase>_peak_growth_kb  how much it raised the peak, summed
+**                                  over all the times it ran
+**        so that the phase responsible for the peak can be found. The
+**        caches of the engines are reported in their own statistics
+**        (see Prover::report_memory). What is given back between
+**        properties or server jobs is reported by release_memory.
+**
+**/
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "utils/statistics.h"
+
+namespace pono {
+
+// Meant to be used as a singleton class -- instantiated as
+// memory_profile below
+class MemoryProfile
+{
+ public:
+  MemoryProfile();
+
+  /** Add the statistics to statistics_registry, as "memory"
+   *  Does nothing unless the registry is enabled.
+   */
+  void enable();
+
+  bool enabled() const { return enabled_; }
+
+  /** Record the end of a phase
+   *  @param name the phase
+   *  @param peak_kb_before the peak memory at its start, from
+   *         peak_memory_kb
+   */
+  void record(const char * name, size_t peak_kb_before);
+
+  /** Record a release_memory
+   *  @param name the owner of the released memory
+   *  @param released_kb the resident memory given back
+   *  @param retained_kb the resident memory after it
+   */
+  void record_release(const char * name,
+                      size_t released_kb,
+                      size_t retained_kb);
+
+  const Statistics & statistics() const { return *stats_; }
+
+ protected:
+  bool enabled_;
+  std::shared_ptr<Statistics> stats_;
+};
+
+// globally available memory profile
+extern MemoryProfile memory_profile;
+
+/** Give the memory freed by destroyed engines and systems back to the
+ *  operating system (with glibc, whose allocator keeps it otherwise),
+ *  so that the resident memory of a long-running process does not only
+ *  grow. Call it once the state of a property or job is destroyed.
+ *  If the memory profile is enabled, records for name:
+ *    <name>_released_kb  the resident memory given back, summed
+ *    <name>_retained_kb  the resident memory after the last release
+ *  @param name the owner of the released memory, e.g. property
+ *  @return the resident memory given back in kB
+ */
+size_t release_memory(const char * name);
+
+/** Records the memory of a phase from construction to destruction */
+class MemoryPhase
+{
+ public:
+  MemoryPhase(const char * name);
+  ~MemoryPhase();
+
+ protected:
+  const char * name_;
+  bool active_;
+  size_t peak_kb_before_;
+};
+
+#define MEMORY_PHASE_CONCAT_(a, b) a##b
+#define MEMORY_PHASE_NAME_(line) MEMORY_PHASE_CONCAT_(memory_phase_, line)
+
+/** Records the memory of the rest of the enclosing scope as a phase */
+#define MEMORY_PHASE(name) MemoryPhase MEMORY_PHASE_NAME_(__LINE__)(name)
+
+}  // namespace pono
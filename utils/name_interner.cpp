@@ -0,0 +1,89 @@
+/*********************                                                        */
+/*! \file name_interner.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A thread-safe, process-wide pool of signal names.
+**
+**/
+
+#include "utils/name_interner.h"
+
+#include <limits>
+
+#include "utils/exceptions.h"
+
+using namespace std;
+
+namespace pono {
+
+NameInterner::NameInterner()
+{
+  nodes_.push_back({ "", root, 0 });
+  ids_.emplace(string_view(nodes_.back().name), root);
+}
+
+NameId NameInterner::intern(string_view name)
+{
+  lock_guard<mutex> lock(mutex_);
+  return intern_locked(name);
+}
+
+NameId NameInterner::intern_locked(string_view name)
+{
+  auto it = ids_.find(name);
+  if (it != ids_.end()) {
+    return it->second;
+  }
+
+  size_t dot = name.rfind('.');
+  NameId scope =
+      dot == string_view::npos ? root : intern_locked(name.substr(0, dot));
+  if (nodes_.size() == numeric_limits<NameId>::max()) {
+    throw PonoException("Too many interned names");
+  }
+  NameId id = nodes_.size();
+  nodes_.push_back(
+      { string(name), scope, dot == string_view::npos ? 0 : dot + 1 });
+  ids_.emplace(string_view(nodes_.back().name), id);
+  return id;
+}
+
+const string & NameInterner::name(NameId id) const
+{
+  lock_guard<mutex> lock(mutex_);
+  return nodes_.at(id).name;
+}
+
+NameId NameInterner::scope(NameId id) const
+{
+  lock_guard<mutex> lock(mutex_);
+  return nodes_.at(id).scope;
+}
+
+string_view NameInterner::leaf(NameId id) const
+{
+  lock_guard<mutex> lock(mutex_);
+  const Node & n = nodes_.at(id);
+  return string_view(n.name).substr(n.leaf_pos);
+}
+
+size_t NameInterner::size() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return nodes_.size();
+}
+
+NameInterner & name_interner()
+{
+  static NameInterner interner;
+  return interner;
+}
+
+}  // namespace pono
@@ -0,0 +1,85 @@
+/*********************                                                        */
+/*! \file name_interner.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A thread-safe, process-wide pool of signal names.
+**
+**        Each name is stored once and identified by a NameId. The names
+**        also form a trie by their '.' separated scopes: the scope of
+**        a.b.c is a.b, whose scope is a, whose scope is the root (the
+**        empty name). Interning a name interns its scopes.
+**
+**        Names are never freed, references to them and views of them
+**        stay valid until the end of the process.
+**
+**/
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace pono {
+
+typedef uint32_t NameId;
+
+class NameInterner
+{
+ public:
+  /** the id of the empty name, the scope of top-level names */
+  static const NameId root = 0;
+
+  NameInterner();
+
+  NameInterner(const NameInterner &) = delete;
+  NameInterner & operator=(const NameInterner &) = delete;
+
+  /** @return the id of name, interning it (and its scopes) if needed */
+  NameId intern(std::string_view name);
+
+  /** @return the name of id */
+  const std::string & name(NameId id) const;
+
+  /** @return the id of the scope of id, root for top-level names */
+  NameId scope(NameId id) const;
+
+  /** @return the part of the name of id after its scope
+   *  e.g. c for a.b.c
+   */
+  std::string_view leaf(NameId id) const;
+
+  /** @return the number of interned names, including the root */
+  size_t size() const;
+
+ private:
+  /** intern while holding mutex_ */
+  NameId intern_locked(std::string_view name);
+
+  struct Node
+  {
+    std::string name;
+    NameId scope;
+    size_t leaf_pos;  ///< position of the leaf in name
+  };
+
+  mutable std::mutex mutex_;
+  // a deque does not move its elements, so the views stay valid
+  std::deque<Node> nodes_;
+  std::unordered_map<std::string_view, NameId> ids_;
+};
+
+/** @return the interner shared by the whole process */
+NameInterner & name_interner();
+
+}  // namespace pono
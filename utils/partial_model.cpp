@@ -18,6 +18,8 @@
 #include "utils/partial_model.h"
 #include "utils/str_util.h"
 
+#include <algorithm>
+
 #include "assert.h"
 
 namespace pono {
@@ -28,7 +30,7 @@ IC3Formula PartialModelGen::GetPartialModel(const smt::Term & ast) {
   smt::Term conj;
   smt::TermVec conjvec;
   for (smt::Term v : dfs_vars_) {
-    smt::Term val = solver_->get_value(v);
+    smt::Term val = get_value(v);
     auto eq = solver_->make_term(smt::Op(smt::PrimOp::Equal), v,val );
     conjvec.push_back( eq );
     if (conj) {
@@ -51,7 +53,7 @@ std::pair<IC3Formula,syntax_analysis::IC3FormulaModel>
   smt::Term conj;
   smt::TermVec conjvec;
   for (smt::Term v : dfs_vars_) {
-    smt::Term val = solver_->get_value(v);
+    smt::Term val = get_value(v);
     cube.emplace(v,val);
     auto eq = solver_->make_term(smt::Op(smt::PrimOp::Equal), v,val );
     conjvec.push_back( eq );
@@ -68,8 +70,7 @@ std::pair<IC3Formula,syntax_analysis::IC3FormulaModel>
 }
 
 void PartialModelGen::GetVarList(const smt::Term & ast ) {
-  dfs_walked_.clear();
-  dfs_vars_.clear();
+  new_walk();
   dfs_walk(ast);
 }
 
@@ -77,19 +78,53 @@ void PartialModelGen::GetVarList(const smt::Term & ast ) {
 void PartialModelGen::GetVarList(const smt::Term & ast, 
   std::unordered_set<smt::Term> & out_vars ) {
 
-  dfs_walked_.clear();
-  dfs_vars_.clear();
+  new_walk();
   dfs_walk(ast);
   out_vars.insert(dfs_vars_.begin(), dfs_vars_.end());
 }
 
 void PartialModelGen::GetVarListForAsts(const smt::TermVec & asts, 
   smt::UnorderedTermSet & out_vars ) {
-  dfs_walked_.clear();
-  dfs_vars_.clear();
+  GetVarListForAsts(asts);
+  out_vars.insert(dfs_vars_.begin(), dfs_vars_.end());
+}
+
+const smt::TermVec & PartialModelGen::GetVarListForAsts(
+  const smt::TermVec & asts) {
+  new_walk();
   for (const auto & ast : asts)
     dfs_walk(ast);
-  out_vars.insert(dfs_vars_.begin(), dfs_vars_.end());
+  return dfs_vars_;
+}
+
+void PartialModelGen::new_walk() {
+  dfs_vars_.clear();
+  if (++gen_ == 0) { // wrapped around, the old marks could look current
+    std::fill(walked_gen_.begin(), walked_gen_.end(), 0);
+    std::fill(val_gen_.begin(), val_gen_.end(), 0);
+    gen_ = 1;
+  }
+}
+
+uint32_t PartialModelGen::term_id(const smt::Term & t) {
+  auto pos = term_ids_.find(t);
+  if (pos != term_ids_.end())
+    return pos->second;
+  uint32_t id = term_ids_.size();
+  term_ids_.emplace(t, id);
+  walked_gen_.push_back(0);
+  val_gen_.push_back(0);
+  vals_.push_back(smt::Term());
+  return id;
+}
+
+smt::Term PartialModelGen::get_value(const smt::Term & t) {
+  uint32_t id = term_id(t);
+  if (val_gen_[id] != gen_) {
+    vals_[id] = solver_->get_value(t);
+    val_gen_[id] = gen_;
+  }
+  return vals_[id];
 }
 
 
@@ -209,27 +244,29 @@ static inline bool is_all_one(const std::string & s, uint64_t w)  {
 
 
 void PartialModelGen::dfs_walk(const smt::Term & input_ast ) {
-  smt::TermVec node_stack_;
+  node_stack_.clear();
   node_stack_.push_back(input_ast);
   while(!node_stack_.empty()) {
-    const auto & ast = node_stack_.back();
-    if (dfs_walked_.find(ast) != dfs_walked_.end()) {
+    // a copy, pushing the children may reallocate the stack
+    smt::Term ast = node_stack_.back();
+    uint32_t id = term_id(ast);
+    if (walked_gen_[id] == gen_) {
       node_stack_.pop_back();
       continue;
     }
-    dfs_walked_.insert(ast);
+    walked_gen_[id] = gen_;
 
     smt::Op op = ast->get_op();
     if (op.is_null()) { // this is the root node
       if (ast->is_symbolic_const()) {
-        dfs_vars_.insert(ast);
+        dfs_vars_.push_back(ast);
       }
       node_stack_.pop_back(); // no need to wait for the next time
       continue;
     } else { // non variable/non constant case
       if (op.prim_op == smt::PrimOp::Ite)  {
         ARG3(cond, texpr, fexpr)
-        auto cond_val = solver_->get_value(cond);
+        auto cond_val = get_value(cond);
         assert(cond_val->is_value());
         if ( is_all_one(cond_val->to_string(),1) ) {
           node_stack_.push_back(cond);
@@ -241,8 +278,8 @@ void PartialModelGen::dfs_walk(const smt::Term & input_ast ) {
         }
       } else if (op.prim_op == smt::PrimOp::Implies) {
         ARG2(left,right)
-        auto cond_left = solver_->get_value(left);
-        auto cond_right = solver_->get_value(right);
+        auto cond_left = get_value(left);
+        auto cond_right = get_value(right);
         assert(cond_left->is_value() && cond_right->is_value());
         if (!( is_all_one(cond_left->to_string(),1) )) // if it is false
           node_stack_.push_back(left);
@@ -254,8 +291,8 @@ void PartialModelGen::dfs_walk(const smt::Term & input_ast ) {
         }
       } else if (op.prim_op == smt::PrimOp::And) {
         ARG2(left,right)
-        auto cond_left = solver_->get_value(left);
-        auto cond_right = solver_->get_value(right);
+        auto cond_left = get_value(left);
+        auto cond_right = get_value(right);
         assert(cond_left->is_value() && cond_right->is_value());
         if (!( is_all_one(cond_left->to_string(),1) )) // if it is false
           node_stack_.push_back(left);
@@ -267,8 +304,8 @@ void PartialModelGen::dfs_walk(const smt::Term & input_ast ) {
         }
       } else if (op.prim_op == smt::PrimOp::Or) {
         ARG2(left,right)
-        auto cond_left = solver_->get_value(left);
-        auto cond_right = solver_->get_value(right);
+        auto cond_left = get_value(left);
+        auto cond_right = get_value(right);
         assert(cond_left->is_value() && cond_right->is_value());
         if (is_all_one(cond_left->to_string(),1)) // if it is true
           node_stack_.push_back(left);
@@ -280,8 +317,8 @@ void PartialModelGen::dfs_walk(const smt::Term & input_ast ) {
         }
       } else if (op.prim_op == smt::PrimOp::BVAnd || op.prim_op == smt::PrimOp::BVNand) {
         ARG2(left,right)
-        auto cond_left = solver_->get_value(left);
-        auto cond_right = solver_->get_value(right);
+        auto cond_left = get_value(left);
+        auto cond_right = get_value(right);
         assert(cond_left->is_value() && cond_right->is_value());
         std::string left_val = cond_left->to_string();
         std::string right_val = cond_right->to_string();
@@ -297,8 +334,8 @@ void PartialModelGen::dfs_walk(const smt::Term & input_ast ) {
 
       } else if (op.prim_op == smt::PrimOp::BVOr  || op.prim_op == smt::PrimOp::BVNor) {
         ARG2(left,right)
-        auto cond_left = solver_->get_value(left);
-        auto cond_right = solver_->get_value(right);
+        auto cond_left = get_value(left);
+        auto cond_right = get_value(right);
         assert(cond_left->is_value() && cond_right->is_value());
         std::string left_val = cond_left->to_string();
         std::string right_val = cond_right->to_string();
@@ -313,8 +350,8 @@ void PartialModelGen::dfs_walk(const smt::Term & input_ast ) {
         }
       } else if (op.prim_op == smt::PrimOp::BVMul) {
         ARG2(left,right)
-        auto cond_left = solver_->get_value(left);
-        auto cond_right = solver_->get_value(right);
+        auto cond_left = get_value(left);
+        auto cond_right = get_value(right);
         assert(cond_left->is_value() && cond_right->is_value());
         std::string left_val = cond_left->to_string();
         std::string right_val = cond_right->to_string();
@@ -17,6 +17,10 @@
 
 #pragma once
 
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
 #include "utils/sygus_ic3formula_helper.h"
 #include "engines/ic3base.h"
 
@@ -25,11 +29,13 @@ namespace pono {
 class PartialModelGen {
 public:
   /** This class computes the cone of influence on construction
-   *  The current implementation does not have internal cache,
-   *  but in the future maybe we can cache some of the results
+   *  Each walk is for the current model of the solver: the marks of the
+   *  previous walks are not cleared but outdated by a generation counter.
+   *  It does not depend on the engine, so any engine with a solver in a
+   *  sat state can use it.
    *  @param the solver where the assertions were made
    */
-  PartialModelGen(smt::SmtSolver & solver) : solver_(solver) { }
+  PartialModelGen(smt::SmtSolver & solver) : solver_(solver), gen_(0) { }
     
   // disallow copy construct/assign
   PartialModelGen(const PartialModelGen &) = delete;
@@ -39,9 +45,23 @@ protected:
   // let's keep a reference to the solver since we need to add terms
   smt::SmtSolver & solver_;
 
-  // for the DFS, will not use the stack but use one reference here
-  std::unordered_set<smt::Term> dfs_walked_;
-  std::unordered_set<smt::Term> dfs_vars_;
+  // the terms seen so far get consecutive ids, the per-walk marks are
+  // indexed by id and valid if they hold the current generation
+  std::unordered_map<smt::Term, uint32_t> term_ids_;
+  std::vector<uint32_t> walked_gen_;
+  std::vector<uint32_t> val_gen_;
+  smt::TermVec vals_; ///< model values, valid in generation val_gen_
+  uint32_t gen_;
+
+  smt::TermVec dfs_vars_; ///< the variables found by the current walk
+  smt::TermVec node_stack_; ///< reused by dfs_walk
+
+  /** @return the id of a term, assigning one if needed */
+  uint32_t term_id(const smt::Term & t);
+  /** @return the model value of t, queried once per walk */
+  smt::Term get_value(const smt::Term & t);
+  /** Start a walk for the current model */
+  void new_walk();
   void dfs_walk(const smt::Term & ast);
 
   // conditon var buffer
@@ -65,6 +85,14 @@ public:
   void GetVarListForAsts(const smt::TermVec & asts, 
     smt::UnorderedTermSet & out_vars);
 
+  /** This class computes the variables that need to
+   *  appear in the partial model of asts in the vector
+   *  @param the vector of ast to walk
+   *  @return the variables, in the order they are found. The vector
+   *          is reused and only valid until the next call
+   */
+  const smt::TermVec & GetVarListForAsts(const smt::TermVec & asts);
+
   /** This class computes the variables that need to
    *  appear in the partial model of asts in the vector
    *  @param the ast to walk
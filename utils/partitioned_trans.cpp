@@ -0,0 +1,131 @@
+/*********************                                                        */
+/*! \file partitioned_trans.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A view of the transition relation partitioned by next-state
+**        variables.
+**
+**/
+
+#include "utils/partitioned_trans.h"
+
+#include <algorithm>
+#include <map>
+
+#include "assert.h"
+#include "smt-switch/utils.h"
+#include "utils/logger.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+PartitionedTrans::PartitionedTrans(const TransitionSystem & ts)
+{
+  const SmtSolver & solver = ts.solver();
+  const UnorderedTermMap & updates = ts.state_updates();
+
+  // the update conjuncts next(v) = f with f without next-state variables
+  UnorderedTermMap update_of;  // next(v) -> conjunct
+  TermVec global_conjuncts;
+  UnorderedTermSet global_next_vars;
+  for (const auto & c : ts.trans_conjuncts()) {
+    Term nv;
+    if (c->get_op() == Equal) {
+      TermVec ch(c->begin(), c->end());
+      if (ts.is_next_var(ch[0]) && update_of.find(ch[0]) == update_of.end()) {
+        auto it = updates.find(ts.curr(ch[0]));
+        if (it != updates.end() && it->second == ch[1]
+            && ts.no_next(ch[1])) {
+          nv = ch[0];
+        }
+      }
+    }
+
+    if (nv) {
+      update_of[nv] = c;
+    } else {
+      global_conjuncts.push_back(c);
+      UnorderedTermSet free_vars;
+      get_free_symbolic_consts(c, free_vars);
+      for (const auto & v : free_vars) {
+        if (ts.is_next_var(v)) {
+          global_next_vars.insert(v);
+        }
+      }
+    }
+  }
+
+  // group the remaining updates by their support
+  map<vector<size_t>, size_t> by_support;
+  vector<TermVec> conjuncts;
+  for (const auto & elem : update_of) {
+    if (global_next_vars.find(elem.first) != global_next_vars.end()) {
+      global_conjuncts.push_back(elem.second);
+      continue;
+    }
+
+    Term sv = ts.curr(elem.first);
+    UnorderedTermSet free_vars;
+    get_free_symbolic_consts(updates.at(sv), free_vars);
+    vector<size_t> key;
+    key.reserve(free_vars.size());
+    for (const auto & v : free_vars) {
+      key.push_back(v->get_id());
+    }
+    sort(key.begin(), key.end());
+
+    auto it = by_support.find(key);
+    if (it == by_support.end()) {
+      it = by_support.insert({ key, conjuncts.size() }).first;
+      conjuncts.push_back(TermVec());
+      partition_vars_.push_back(TermVec());
+    }
+    conjuncts[it->second].push_back(elem.second);
+    partition_vars_[it->second].push_back(sv);
+    partition_of_[sv] = it->second;
+  }
+
+  auto make_and = [&](const TermVec & v) {
+    Term res = solver->make_term(true);
+    for (size_t i = 0; i < v.size(); ++i) {
+      res = i ? solver->make_term(And, res, v[i]) : v[i];
+    }
+    return res;
+  };
+  global_ = make_and(global_conjuncts);
+  for (const auto & v : conjuncts) {
+    partitions_.push_back(make_and(v));
+  }
+
+  logger.log(1,
+             "Partitioned trans: {} global conjuncts, {} partitions of {} "
+             "state updates",
+             global_conjuncts.size(),
+             partitions_.size(),
+             partition_of_.size());
+}
+
+void PartitionedTrans::cone(const UnorderedTermSet & statevars,
+                            vector<size_t> & out) const
+{
+  size_t prev = out.size();
+  for (const auto & sv : statevars) {
+    auto it = partition_of_.find(sv);
+    if (it != partition_of_.end()) {
+      out.push_back(it->second);
+    }
+  }
+  sort(out.begin() + prev, out.end());
+  out.erase(unique(out.begin() + prev, out.end()), out.end());
+}
+
+}  // namespace pono
@@ -0,0 +1,77 @@
+/*********************                                                        */
+/*! \file partitioned_trans.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A view of the transition relation partitioned by next-state
+**        variables, so that a query about some next-state variables only
+**        needs the state updates that define them.
+**
+**/
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "core/ts.h"
+
+namespace pono {
+
+class PartitionedTrans
+{
+ public:
+  /** Partitions the transition relation of ts
+   *  The state updates next(v) = f whose next-state variable only occurs
+   *  there are grouped by the variables of f, one partition per support.
+   *  All the other conjuncts (constraints, relational conjuncts and the
+   *  updates of the next-state variables they mention) are in the global
+   *  part. Any assignment to the current state and input variables that
+   *  satisfies the global part can be extended to the next-state
+   *  variables of the omitted partitions, so for a query over some
+   *  next-state variables:
+   *     global and the partitions of those variables  is satisfiable iff
+   *     trans and the query is satisfiable
+   *  but the model of the other next-state variables is arbitrary.
+   *  @param ts the transition system
+   */
+  PartitionedTrans(const TransitionSystem & ts);
+
+  /** @return the conjunction of the conjuncts that must always be kept */
+  const smt::Term & global() const { return global_; }
+
+  /** @return the number of partitions (excluding the global part) */
+  size_t size() const { return partitions_.size(); }
+
+  /** @return the conjunction of the state updates of partition i */
+  const smt::Term & partition(size_t i) const { return partitions_.at(i); }
+
+  /** @return the current state variables whose update is in partition i */
+  const smt::TermVec & statevars(size_t i) const
+  {
+    return partition_vars_.at(i);
+  }
+
+  /** Collect the partitions defining the next-state variables of a term
+   *  @param statevars the current state variables whose next-state
+   *         variables are needed (e.g. the support of a cube c for c')
+   *  @param out vector to add the (sorted, distinct) partition indices to
+   */
+  void cone(const smt::UnorderedTermSet & statevars,
+            std::vector<size_t> & out) const;
+
+ protected:
+  smt::Term global_;
+  smt::TermVec partitions_;
+  std::vector<smt::TermVec> partition_vars_;
+  /** the partition of each state variable that is not in the global part */
+  std::unordered_map<smt::Term, size_t> partition_of_;
+};
+
+}  // namespace pono
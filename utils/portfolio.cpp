@@ -0,0 +1,565 @@
+/*********************                                                        */
+/*! \file portfolio.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief In-process portfolio that races several engines on the same
+**        property. Each engine runs in its own thread with its own
+**        solver instance. The first definitive result (TRUE or FALSE)
+**        interrupts the remaining engines.
+**
+**/
+
+#include "utils/portfolio.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+#include "assert.h"
+#include "smt/available_solvers.h"
+#include "utils/lemma_bus.h"
+#include "utils/lemma_exchange.h"
+#include "utils/logger.h"
+#include "utils/make_provers.h"
+#include "utils/thread_placement.h"
+#include "utils/timeline.h"
+#include "utils/ts_clone.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+vector<Engine> default_portfolio_engines()
+{
+  return { SIM, BMC, KIND, MBIC3,
+#ifdef WITH_MSAT
+           IC3IA_ENGINE, INTERP,
+#endif
+#ifdef WITH_CUDD
+           BDD_REACH,
+#endif
+  };
+}
+
+SolverEnum portfolio_solver_for(Engine e, SolverEnum se)
+{
+  if (e == INTERP || e == ISMC_ENGINE || e == IC3IA_ENGINE || e == MSAT_IC3IA) {
+    // only MathSAT interpolation is supported
+    return MSAT;
+  }
+
+  if (se == CVC4
+      && (ic3_variants().find(e) != ic3_variants().end()
+          || e == REVERSE_IC3)) {
+    // see options.cpp -- CVC4 does not support the multiple solver
+    // instances needed by IC3 variants
+    return BTOR;
+  }
+
+  return se;
+}
+
+/** Construct the provers of a portfolio on the calling thread
+ *  this copies the transition system into each prover's solver (loading
+ *  the copies concurrently with a TsCloner when ts fits in a snapshot)
+ *  and is the only place the terms of ts are read
+ *  the bus uses the solver of ts, which is idle while the engines run
+ *  exchange is set to the connection of --lemma-exchange, which must
+ *  outlive the provers' runs
+ */
+static vector<shared_ptr<Prover>> make_portfolio_provers(
+    const vector<Engine> & engines,
+    const Property & p,
+    const TransitionSystem & ts,
+    const PonoOptions & opts,
+    unique_ptr<LemmaExchangeClient> & exchange,
+    shared_ptr<LemmaBus> * bus = nullptr)
+{
+  shared_ptr<LemmaBus> lemma_bus;
+  if (opts.share_lemmas_) {
+    lemma_bus = make_shared<LemmaBus>(ts.solver());
+    lemma_bus->set_epoch_mode(opts.deterministic_);
+  }
+  if (bus) {
+    *bus = lemma_bus;
+  }
+
+  vector<SmtSolver> solvers;
+  solvers.reserve(engines.size());
+  for (const auto & e : engines) {
+    SolverEnum se = portfolio_solver_for(e, opts.smt_solver_);
+    solvers.push_back(create_solver_for(se, e, false));
+  }
+  // the copies of ts are loaded concurrently, then each prover finds its
+  // terms in the cache of its translator
+  unique_ptr<TsCloner> cloner;
+  try {
+    cloner.reset(new TsCloner(ts, { p.prop() }));
+    // the memory of copy i is allocated where engine i runs
+    cloner->clone(
+        solvers, 0, [&opts](size_t t) { place_worker_thread(opts, t); });
+  }
+  catch (PonoException & ex) {
+    logger.log(1, "Portfolio: copying the system serially: {}", ex.what());
+    cloner.reset();
+  }
+
+  vector<shared_ptr<Prover>> provers;
+  provers.reserve(engines.size());
+  for (size_t i = 0; i < engines.size(); ++i) {
+    Engine e = engines[i];
+    const SmtSolver & s = solvers[i];
+    SolverEnum se = s->get_solver_enum();
+    PonoOptions eopts = opts;
+    eopts.engine_ = e;
+    eopts.smt_solver_ = se;
+    provers.push_back(make_prover(e, p, ts, s, eopts));
+    if (lemma_bus) {
+      provers.back()->set_lemma_bus(lemma_bus);
+    }
+    logger.log(1,
+               "Portfolio: created {} with solver {}",
+               to_string(e),
+               smt::to_string(se));
+  }
+
+  if (lemma_bus && !opts.lemma_exchange_.empty()) {
+    if (opts.deterministic_) {
+      // remote lemmas arrive at any time
+      logger.log(1, "Portfolio: no lemma exchange with --deterministic");
+    } else {
+      unique_ptr<CubeServer> server(
+          new SocketCubeServer(opts.lemma_exchange_));
+      exchange.reset(new LemmaExchangeClient(
+          lemma_bus, ts, p.prop(), std::move(server)));
+      exchange->start();
+    }
+  }
+  return provers;
+}
+
+/** Run (or continue) one engine of a portfolio
+ *  @param failed if not null, set to whether the engine threw
+ *  @return its result, UNKNOWN if it failed
+ */
+static ProverResult run_portfolio_engine(Prover & prover,
+                                         Engine e,
+                                         int k,
+                                         bool * failed = nullptr)
+{
+  ProverResult r = ProverResult::UNKNOWN;
+  try {
+    TIMELINE_SPAN("portfolio_engine");
+    // HACK MSAT_IC3IA does not support check_until
+    r = (e == MSAT_IC3IA) ? prover.prove() : prover.check_until(k);
+  }
+  catch (std::exception & ex) {
+    // engines may reject the transition system (e.g. unsupported
+    // theories) -- just drop out of the race
+    logger.log(1, "Portfolio: {} failed with: {}", to_string(e), ex.what());
+    r = ProverResult::UNKNOWN;
+    if (failed) {
+      *failed = true;
+    }
+  }
+
+  logger.log(1, "Portfolio: {} returned {}", to_string(e), to_string(r));
+  return r;
+}
+
+PortfolioResult run_portfolio(const vector<Engine> & engines,
+                              const Property & p,
+                              const TransitionSystem & ts,
+                              int k,
+                              PonoOptions opts)
+{
+  if (!engines.size()) {
+    throw PonoException("Portfolio requires at least one engine");
+  }
+
+  if (opts.deterministic_) {
+    size_t num_cores = engines.size();
+    if (opts.portfolio_cores_ && opts.portfolio_cores_ < num_cores) {
+      num_cores = opts.portfolio_cores_;
+    }
+    return run_deterministic_portfolio(engines, p, ts, k, num_cores, opts);
+  }
+
+  if (opts.portfolio_cores_ && opts.portfolio_cores_ < engines.size()) {
+    return run_sliced_portfolio(engines,
+                                p,
+                                ts,
+                                k,
+                                opts.portfolio_cores_,
+                                opts.portfolio_slice_ / 1000.0,
+                                opts);
+  }
+
+  unique_ptr<LemmaExchangeClient> exchange;
+  vector<shared_ptr<Prover>> provers =
+      make_portfolio_provers(engines, p, ts, opts, exchange);
+
+  PortfolioResult res;
+  res.provers = provers;
+  mutex res_mutex;
+
+  auto run_engine = [&](size_t idx) {
+    const shared_ptr<Prover> & prover = provers[idx];
+    Engine e = engines[idx];
+    place_worker_thread(opts, idx, &prover->statistics(), "thread");
+    ProverResult r = run_portfolio_engine(*prover, e, k);
+
+    if (r != ProverResult::TRUE && r != ProverResult::FALSE) {
+      return;
+    }
+
+    lock_guard<mutex> lock(res_mutex);
+    if (res.prover) {
+      // another engine already won
+      return;
+    }
+    res.result = r;
+    res.engine = e;
+    res.prover = prover;
+    for (size_t i = 0; i < provers.size(); ++i) {
+      if (i != idx) {
+        provers[i]->interrupt();
+      }
+    }
+  };
+
+  vector<thread> workers;
+  workers.reserve(provers.size());
+  for (size_t i = 0; i < provers.size(); ++i) {
+    workers.push_back(thread(run_engine, i));
+  }
+  for (auto & w : workers) {
+    w.join();
+  }
+
+  if (res.prover) {
+    logger.log(1, "Portfolio: property decided by {}", to_string(res.engine));
+  }
+  return res;
+}
+
+size_t portfolio_progress(const Prover & prover)
+{
+  const Statistics & stats = prover.statistics();
+  return stats.get("reached_k") + stats.get("frames")
+         + stats.get("refinements") + stats.get("cegar_refinements");
+}
+
+/** the reason a sliced engine is stopped with, it continues later */
+static const string slice_expired = "time slice expired";
+
+PortfolioResult run_sliced_portfolio(const vector<Engine> & engines,
+                                     const Property & p,
+                                     const TransitionSystem & ts,
+                                     int k,
+                                     size_t num_cores,
+                                     double slice_seconds,
+                                     PonoOptions opts)
+{
+  typedef chrono::steady_clock clock;
+
+  if (!engines.size()) {
+    throw PonoException("Portfolio requires at least one engine");
+  }
+  if (!num_cores) {
+    throw PonoException("Portfolio requires at least one core");
+  }
+  if (slice_seconds <= 0) {
+    throw PonoException("Portfolio time slices must be positive");
+  }
+
+  unique_ptr<LemmaExchangeClient> exchange;
+  vector<shared_ptr<Prover>> provers =
+      make_portfolio_provers(engines, p, ts, opts, exchange);
+
+  enum SliceState
+  {
+    WAITING,  ///< not running, can continue
+    RUNNING,
+    STOPPED   ///< gave up or failed
+  };
+
+  struct Sliced
+  {
+    SliceState state = WAITING;
+    thread worker;
+    bool returned = false;  ///< set by the worker when the engine returned
+    ProverResult result = ProverResult::UNKNOWN;
+    clock::time_point slice_start;
+    size_t progress = 0;  ///< at slice_start
+    double rate = -1;     ///< progress per second, -1 until it ran
+    size_t waited = 0;    ///< slices since it last ran
+  };
+
+  vector<Sliced> sliced(provers.size());
+  PortfolioResult res;
+  res.provers = provers;
+  mutex m;  ///< protects the returned and result fields
+  condition_variable returned_cv;
+
+  auto run_engine = [&](size_t idx) {
+    // an engine keeps its place between its slices
+    place_worker_thread(opts, idx, &provers[idx]->statistics(), "thread");
+    ProverResult r = run_portfolio_engine(*provers[idx], engines[idx], k);
+    lock_guard<mutex> lock(m);
+    sliced[idx].result = r;
+    sliced[idx].returned = true;
+    returned_cv.notify_all();
+  };
+
+  // update the progress rate of a running engine, a moving average
+  // over its slices so that it reacts to an engine that stalls
+  auto account = [&](size_t idx) {
+    Sliced & s = sliced[idx];
+    clock::time_point now = clock::now();
+    double elapsed = chrono::duration<double>(now - s.slice_start).count();
+    size_t progress = portfolio_progress(*provers[idx]);
+    if (elapsed > 0) {
+      // the counters of an engine only grow, unless it restarted
+      double rate =
+          progress > s.progress ? (progress - s.progress) / elapsed : 0;
+      s.rate = s.rate < 0 ? rate : (s.rate + rate) / 2;
+    }
+    s.slice_start = now;
+    s.progress = progress;
+  };
+
+  // join an engine that returned, the lock must be held
+  auto collect = [&](size_t idx) {
+    Sliced & s = sliced[idx];
+    assert(s.state == RUNNING && s.returned);
+    s.worker.join();
+    s.returned = false;
+    account(idx);
+    Budget & budget = provers[idx]->budget();
+    if ((s.result == ProverResult::TRUE || s.result == ProverResult::FALSE)
+        && !res.prover) {
+      res.result = s.result;
+      res.engine = engines[idx];
+      res.prover = provers[idx];
+      s.state = STOPPED;
+    } else if (s.result == ProverResult::UNKNOWN
+               && budget.reason() == slice_expired) {
+      // preempted, it continues from its last bound in a later slice
+      budget.resume();
+      s.state = WAITING;
+    } else {
+      s.state = STOPPED;
+    }
+  };
+
+  size_t num_starved = engines.size();
+  unique_lock<mutex> lock(m);
+  while (!res.prover) {
+    // the engines that never ran or waited for a round over all the
+    // engines come first, then the ones making the most progress
+    vector<size_t> order;
+    for (size_t i = 0; i < sliced.size(); ++i) {
+      if (sliced[i].state != STOPPED) {
+        order.push_back(i);
+      }
+    }
+    if (order.empty()) {
+      break;
+    }
+    auto starved = [&](const Sliced & s) {
+      return s.rate < 0 || s.waited >= num_starved;
+    };
+    stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      const Sliced & sa = sliced[a];
+      const Sliced & sb = sliced[b];
+      if (starved(sa) != starved(sb)) {
+        return starved(sa);
+      }
+      if (sa.rate != sb.rate) {
+        return sa.rate > sb.rate;
+      }
+      // avoid switching engines that are equally good
+      return sa.state == RUNNING && sb.state != RUNNING;
+    });
+    if (order.size() > num_cores) {
+      order.resize(num_cores);
+    }
+    unordered_set<size_t> scheduled(order.begin(), order.end());
+
+    // preempt the running engines that lost their core
+    vector<size_t> preempted;
+    for (size_t i = 0; i < sliced.size(); ++i) {
+      if (sliced[i].state == RUNNING && !scheduled.count(i)) {
+        logger.log(2,
+                   "Portfolio: suspending {} (rate {})",
+                   to_string(engines[i]),
+                   sliced[i].rate);
+        provers[i]->budget().cancel(slice_expired);
+        preempted.push_back(i);
+      }
+    }
+    for (auto i : preempted) {
+      returned_cv.wait(lock, [&] { return sliced[i].returned; });
+      collect(i);
+    }
+    if (res.prover) {
+      break;
+    }
+
+    for (size_t i = 0; i < sliced.size(); ++i) {
+      Sliced & s = sliced[i];
+      if (s.state != WAITING) {
+        continue;
+      } else if (!scheduled.count(i)) {
+        ++s.waited;
+        continue;
+      }
+      logger.log(2, "Portfolio: running {}", to_string(engines[i]));
+      s.state = RUNNING;
+      s.waited = 0;
+      s.slice_start = clock::now();
+      s.progress = portfolio_progress(*provers[i]);
+      s.worker = thread(run_engine, i);
+    }
+
+    // wait for the end of the slice, or an engine that frees its core
+    auto any_returned = [&] {
+      for (const auto & s : sliced) {
+        if (s.state == RUNNING && s.returned) {
+          return true;
+        }
+      }
+      return false;
+    };
+    returned_cv.wait_for(
+        lock, chrono::duration<double>(slice_seconds), any_returned);
+
+    for (size_t i = 0; i < sliced.size(); ++i) {
+      if (sliced[i].state != RUNNING) {
+        continue;
+      } else if (sliced[i].returned) {
+        collect(i);
+      } else {
+        account(i);
+      }
+    }
+  }
+
+  // stop the engines that are still running
+  for (size_t i = 0; i < sliced.size(); ++i) {
+    if (sliced[i].state == RUNNING) {
+      provers[i]->interrupt();
+    }
+  }
+  for (size_t i = 0; i < sliced.size(); ++i) {
+    if (sliced[i].state == RUNNING) {
+      returned_cv.wait(lock, [&] { return sliced[i].returned; });
+      sliced[i].worker.join();
+    }
+  }
+
+  if (res.prover) {
+    logger.log(1, "Portfolio: property decided by {}", to_string(res.engine));
+  }
+  return res;
+}
+
+PortfolioResult run_deterministic_portfolio(const vector<Engine> & engines,
+                                            const Property & p,
+                                            const TransitionSystem & ts,
+                                            int k,
+                                            size_t num_cores,
+                                            PonoOptions opts)
+{
+  if (!engines.size()) {
+    throw PonoException("Portfolio requires at least one engine");
+  }
+  if (!num_cores) {
+    throw PonoException("Portfolio requires at least one core");
+  }
+
+  // also for the parallel engines in the portfolio
+  opts.deterministic_ = true;
+  unique_ptr<LemmaExchangeClient> exchange;
+  shared_ptr<LemmaBus> lemma_bus;
+  vector<shared_ptr<Prover>> provers =
+      make_portfolio_provers(engines, p, ts, opts, exchange, &lemma_bus);
+
+  PortfolioResult res;
+  res.provers = provers;
+  vector<ProverResult> results(provers.size(), ProverResult::UNKNOWN);
+  // not a vector<bool>, the workers write neighboring entries
+  vector<char> stopped(provers.size(), false);
+
+  for (int bound = 0; bound <= k && !res.prover; ++bound) {
+    TIMELINE_SPAN("portfolio_epoch");
+    vector<size_t> todo;
+    for (size_t i = 0; i < provers.size(); ++i) {
+      if (!stopped[i]) {
+        todo.push_back(i);
+      }
+    }
+    if (todo.empty()) {
+      break;
+    }
+
+    // the engines only differ in their speed between two epochs
+    atomic<size_t> next(0);
+    auto worker = [&]() {
+      size_t j;
+      while ((j = next++) < todo.size()) {
+        size_t i = todo[j];
+        // the engines move between the threads, place by engine
+        place_worker_thread(opts, i, &provers[i]->statistics(), "thread");
+        bool failed = false;
+        results[i] =
+            run_portfolio_engine(*provers[i], engines[i], bound, &failed);
+        // HACK MSAT_IC3IA does not support check_until, it ran to the end
+        stopped[i] = failed || provers[i]->budget().cancelled()
+                     || engines[i] == MSAT_IC3IA;
+      }
+    };
+    vector<thread> workers;
+    for (size_t t = 0; t < min(num_cores, todo.size()); ++t) {
+      workers.push_back(thread(worker));
+    }
+    for (auto & w : workers) {
+      w.join();
+    }
+
+    // the first engine in the list with a definitive result decides
+    for (size_t i : todo) {
+      if (results[i] == ProverResult::TRUE
+          || results[i] == ProverResult::FALSE) {
+        res.result = results[i];
+        res.engine = engines[i];
+        res.prover = provers[i];
+        break;
+      }
+    }
+    if (lemma_bus) {
+      lemma_bus->end_epoch();
+    }
+    logger.log(2, "Portfolio: epoch {} done", bound);
+  }
+
+  if (res.prover) {
+    logger.log(1, "Portfolio: property decided by {}", to_string(res.engine));
+  }
+  return res;
+}
+
+}  // namespace pono
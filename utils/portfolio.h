@@ -0,0 +1,151 @@
+/*********************                                                        */
+/*! \file portfolio.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief In-process portfolio that races several engines on the same
+**        property. Each engine runs in its own thread with its own
+**        solver instance. The first definitive result (TRUE or FALSE)
+**        interrupts the remaining engines. With fewer cores than
+**        engines, the engines take turns in time slices instead. With
+**        --deterministic, they run in lockstep epochs.
+**
+**/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "engines/prover.h"
+
+namespace pono {
+
+struct PortfolioResult
+{
+  PortfolioResult() : result(ProverResult::UNKNOWN), engine(Engine::NONE) {}
+
+  ProverResult result;
+  Engine engine;  ///< the engine that decided the property (NONE if unknown)
+  std::shared_ptr<Prover> prover;  ///< the deciding prover, for witnesses and
+                                   ///< invariants (null if unknown)
+  std::vector<std::shared_ptr<Prover>> provers;  ///< all the engines, e.g.
+                                                ///< for their statistics
+};
+
+/** Returns the engines used by --portfolio
+ *  Random simulation, BMC, KInduction and MBIC3 always, and IC3IA and
+ *  InterpolantMC if Pono was built with MathSAT. Simulation finds shallow
+ *  bugs quickly and drops out on systems it does not support.
+ */
+std::vector<Engine> default_portfolio_engines();
+
+/** Returns the solver enum an engine should use in a portfolio
+ *  Engines that require interpolation use MathSAT, and IC3 variants
+ *  fall back to Boolector if the requested solver does not support
+ *  multiple instances (CVC4).
+ *  @param e the engine
+ *  @param se the requested solver
+ *  @return the solver enum to create for this engine
+ */
+smt::SolverEnum portfolio_solver_for(Engine e, smt::SolverEnum se);
+
+/** Race the given engines on a property
+ *  The provers are all constructed (and the transition system copied into
+ *  each fresh solver) on the calling thread, so the terms of ts are never
+ *  accessed concurrently. Then each prover runs check_until(k) on a worker
+ *  thread. Engines are stopped cooperatively with Prover::interrupt, so
+ *  this returns only after every worker has reached a polling point.
+ *  If opts.share_lemmas_ is set, the engines exchange lemmas and bounds
+ *  through a LemmaBus over the solver of ts.
+ *  If opts.deterministic_ is set, this is run_deterministic_portfolio
+ *  with opts.portfolio_cores_ (all the engines if 0). Otherwise, if
+ *  opts.portfolio_cores_ is smaller than the number of engines, this is
+ *  run_sliced_portfolio with opts.portfolio_slice_.
+ *
+ *  @param engines the engines to run
+ *  @param p the property to check
+ *  @param ts the transition system
+ *  @param k the bound passed to check_until
+ *  @param opts the options passed to each engine
+ *  @return the first definitive result, or UNKNOWN if no engine decided p
+ */
+PortfolioResult run_portfolio(const std::vector<Engine> & engines,
+                              const Property & p,
+                              const TransitionSystem & ts,
+                              int k,
+                              PonoOptions opts = PonoOptions());
+
+/** @return the progress of a prover so far, for the portfolio scheduler
+ *  The sum of the bounds reached (BMC and k-induction), the IC3 frames
+ *  and the abstraction refinements, so it grows while the engine works
+ *  towards a result.
+ */
+size_t portfolio_progress(const Prover & prover);
+
+/** Race the given engines on a property using at most num_cores threads
+ *  The engines take turns: at the end of each time slice the scheduler
+ *  gives the cores to the engines that made the most progress per second
+ *  (see portfolio_progress), averaged over their recent slices. The
+ *  others are suspended with their budget, return UNKNOWN at their next
+ *  polling point, and continue from their last bound when they get a core
+ *  again. Every engine runs in the first slices, and a suspended engine
+ *  gets a slice again after waiting for as many slices as there are
+ *  engines, so a slow start does not stop an engine for good.
+ *  Engines that give up (e.g. reach k or fail) free their core at once.
+ *  Note that MSAT_IC3IA does not support check_until and restarts when it
+ *  continues.
+ *
+ *  @param engines the engines to run, the first ones start first
+ *  @param p the property to check
+ *  @param ts the transition system
+ *  @param k the bound passed to check_until
+ *  @param num_cores the number of engines running at any time
+ *  @param slice_seconds the length of a time slice
+ *  @param opts the options passed to each engine
+ *  @return the first definitive result, or UNKNOWN if no engine decided p
+ */
+PortfolioResult run_sliced_portfolio(const std::vector<Engine> & engines,
+                                     const Property & p,
+                                     const TransitionSystem & ts,
+                                     int k,
+                                     size_t num_cores,
+                                     double slice_seconds,
+                                     PonoOptions opts = PonoOptions());
+
+/** Run the given engines on a property in lockstep epochs, so that the
+ *  result (and the witness or invariant) is the same in every run
+ *  In epoch b, each engine runs check_until(b) (continuing from the
+ *  previous epoch) on one of num_cores threads. After all of them
+ *  returned, the first engine in the list with a definitive result
+ *  decides, otherwise the lemmas and bounds shared in the epoch (see
+ *  opts.share_lemmas_) are made visible in the order of the engines and
+ *  the next epoch starts. Engines that fail or run out of budget drop
+ *  out. The engines are run with opts.deterministic_ set.
+ *  The cost is the wait for the slowest engine of each epoch.
+ *  Note that the time and memory limits are not reproducible.
+ *
+ *  @param engines the engines to run, in the order of precedence
+ *  @param p the property to check
+ *  @param ts the transition system
+ *  @param k the bound of the last epoch
+ *  @param num_cores the number of engines running at any time
+ *  @param opts the options passed to each engine
+ *  @return the result of the first engine in the list that decided p in
+ *          the first epoch any engine did, or UNKNOWN
+ */
+PortfolioResult run_deterministic_portfolio(
+    const std::vector<Engine> & engines,
+    const Property & p,
+    const TransitionSystem & ts,
+    int k,
+    size_t num_cores,
+    PonoOptions opts = PonoOptions());
+
+}  // namespace pono
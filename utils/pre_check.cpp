@@ -0,0 +1,127 @@
+/*********************                                                        */
+/*! \file pre_check.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Cheap checks that decide trivial properties before an engine is
+**        set up (see --pre-check).
+**
+**/
+
+#include "utils/pre_check.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+
+#include "core/prop.h"
+#include "engines/bmc.h"
+#include "engines/random_sim.h"
+#include "modifiers/constant_propagation.h"
+#include "smt/available_solvers.h"
+#include "utils/logger.h"
+#include "utils/statistics.h"
+#include "utils/timeline.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+// the length of the simulated traces
+static const int sim_depth = 32;
+// the time limit of the bmc stage in seconds
+static const double bmc_time_limit = 1.0;
+
+PreCheckResult pre_check(const TransitionSystem & ts,
+                         const Term & prop,
+                         const PonoOptions & opts)
+{
+  TIMELINE_SPAN("pre_check");
+  shared_ptr<Statistics> stats = make_shared<Statistics>();
+  statistics_registry.add("pre_check", stats);
+  PreCheckResult res;
+
+  auto timed = [&](const string & stage, const function<void()> & f) {
+    auto begin = chrono::steady_clock::now();
+    try {
+      f();
+    }
+    catch (std::exception & e) {
+      // e.g. a system the stage does not support
+      logger.log(2, "Pre-check: skipped {}: {}", stage, e.what());
+      stats->increment(stage + "_skipped");
+    }
+    stats->add_time(
+        stage + "_time",
+        chrono::duration<double>(chrono::steady_clock::now() - begin)
+            .count());
+    if (res.result != ProverResult::UNKNOWN) {
+      res.stage = stage;
+      stats->set_string("decided_by", stage);
+      logger.log(1, "Pre-check: {} decided {}", stage, to_string(res.result));
+    }
+  };
+
+  // constant propagation on a copy, the engine gets the original system
+  timed("simplify", [&]() {
+    Term simplified = prop;
+    if (!opts.simplify_) {
+      TransitionSystem copy(ts);
+      ConstantPropagation cp(copy);
+      simplified = cp.rewrite(prop);
+    }
+    if (simplified == ts.solver()->make_term(true)) {
+      res.result = ProverResult::TRUE;
+    }
+  });
+
+  int bound = opts.bound_;
+  if (res.result == ProverResult::UNKNOWN && opts.pre_check_cycles_
+      && ts.is_functional()) {
+    timed("sim", [&]() {
+      // works on the terms of ts, nothing is asserted
+      PonoOptions sim_opts = opts;
+      sim_opts.engine_ = SIM;
+      int depth = std::min(bound, sim_depth);
+      sim_opts.sim_traces_ =
+          std::max<size_t>(1, opts.pre_check_cycles_ / (depth + 1));
+      sim_opts.sim_lanes_ = 1;
+      Property p(ts.solver(), prop);
+      RandomSim sim(p, ts, ts.solver(), sim_opts);
+      if (sim.check_until(depth) == ProverResult::FALSE) {
+        res.result = ProverResult::FALSE;
+        sim.witness(res.cex);
+      }
+    });
+  }
+
+  if (res.result == ProverResult::UNKNOWN) {
+    timed("bmc", [&]() {
+      // in its own solver, the unrolling must not reach the engine
+      PonoOptions bmc_opts = opts;
+      bmc_opts.engine_ = BMC;
+      bmc_opts.time_limit_ = 0;
+      bmc_opts.bmc_step_size_ = 1;
+      SmtSolver s = create_solver_for(opts.smt_solver_, BMC, false);
+      Property p(ts.solver(), prop);
+      Bmc bmc(p, ts, s, bmc_opts);
+      bmc.budget().set_time_limit(bmc_time_limit);
+      if (bmc.check_until(std::min(bound, 1)) == ProverResult::FALSE) {
+        res.result = ProverResult::FALSE;
+        bmc.witness(res.cex);
+      }
+    });
+  }
+
+  return res;
+}
+
+}  // namespace pono
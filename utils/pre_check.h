@@ -0,0 +1,55 @@
+/*********************                                                        */
+/*! \file pre_check.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Cheap checks that decide trivial properties before an engine is
+**        set up (see --pre-check). In order:
+**          simplify  the property is true after constant propagation
+**          sim       random simulation finds a counterexample
+**          bmc       a counterexample with at most one transition, with
+**                    a small time limit
+**        Each stage is skipped if it does not support the system.
+**
+**/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "core/ts.h"
+#include "engines/prover.h"
+#include "options/options.h"
+#include "smt-switch/smt.h"
+
+namespace pono {
+
+struct PreCheckResult
+{
+  ProverResult result = ProverResult::UNKNOWN;
+  std::string stage;  ///< the stage that decided, empty if none
+  std::vector<smt::UnorderedTermMap> cex;  ///< for FALSE, over the
+                                           ///< variables of ts
+};
+
+/** Run the pre-checks on a property
+ *  Only creates a solver for the bmc stage, the other stages work in the
+ *  solver of ts. The statistics are registered as "pre_check".
+ *  @param ts the transition system, not modified
+ *  @param prop the property, a term of ts
+ *  @param opts the options, opts.pre_check_cycles_ is the budget of the
+ *         simulation and the bounds are at most opts.bound_
+ *  @return the result, UNKNOWN if no stage decided the property
+ */
+PreCheckResult pre_check(const TransitionSystem & ts,
+                         const smt::Term & prop,
+                         const PonoOptions & opts);
+
+}  // namespace pono
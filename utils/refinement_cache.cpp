@@ -0,0 +1,105 @@
+/*********************                                                        */
+/*! \file refinement_cache.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Cache of learned CEGAR refinements shared by the properties of
+**        one design (see check_all_props in pono.cpp).
+**
+**/
+
+#include "utils/refinement_cache.h"
+
+#include "assert.h"
+#include "smt-switch/utils.h"
+#include "utils/term_walkers.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+RefinementCache::RefinementCache(const SmtSolver & solver) : solver_(solver)
+{
+}
+
+void RefinementCache::add(const Term & t)
+{
+  assert(t->get_sort()->get_sort_kind() == BOOL);
+  lock_guard<mutex> lock(mutex_);
+  if (!refinement_terms_.insert(t).second) {
+    return;
+  }
+  UnorderedTermSet free_vars;
+  get_free_symbolic_consts(t, free_vars);
+  refinements_.push_back(t);
+  free_vars_.push_back(free_vars);
+}
+
+TermVec RefinementCache::relevant(const TransitionSystem & ts) const
+{
+  assert(ts.solver() == solver_);
+  lock_guard<mutex> lock(mutex_);
+  TermVec res;
+  for (size_t i = 0; i < refinements_.size(); ++i) {
+    bool in_ts = true;
+    for (const auto & v : free_vars_[i]) {
+      if (!ts.is_curr_var(v) && !ts.is_next_var(v) && !ts.is_input_var(v)) {
+        in_ts = false;
+        break;
+      }
+    }
+    if (in_ts) {
+      res.push_back(refinements_[i]);
+    }
+  }
+  return res;
+}
+
+size_t RefinementCache::size() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return refinements_.size();
+}
+
+bool RefinementCache::op_terms(const TransitionSystem & ts,
+                               const unordered_set<PrimOp> & ops,
+                               UnorderedTermSet & out)
+{
+  assert(ts.solver() == solver_);
+  const UnorderedTermMap & updates = ts.state_updates();
+  // independent of the order of the updates
+  size_t h = updates.size();
+  hash<Term> term_hash;
+  for (const auto & elem : updates) {
+    h += (term_hash(elem.first) * 0x9e3779b97f4a7c15ULL)
+         ^ term_hash(elem.second);
+  }
+
+  // the others wait instead of walking the same updates
+  lock_guard<mutex> lock(mutex_);
+  vector<OpTerms> & entries = op_terms_[h];
+  for (const auto & e : entries) {
+    if (e.ops == ops && e.updates == updates) {
+      out.insert(e.terms.begin(), e.terms.end());
+      return true;
+    }
+  }
+
+  entries.push_back({ ops, updates, UnorderedTermSet() });
+  UnorderedTermSet & terms = entries.back().terms;
+  TermOpCollector op_collector(solver_);
+  for (const auto & elem : updates) {
+    op_collector.add_matching_terms(elem.second, ops, terms);
+  }
+  out.insert(terms.begin(), terms.end());
+  return false;
+}
+
+}  // namespace pono
@@ -0,0 +1,92 @@
+/*********************                                                        */
+/*! \file refinement_cache.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Cache of learned CEGAR refinements shared by the properties of
+**        one design (see check_all_props in pono.cpp).
+**
+**        Refinements are untimed constraints over the variables of the
+**        concrete transition system that hold in every run of the design
+**        (e.g. instantiated array axioms), stored in the solver of the
+**        original transition system. A later prover seeds its abstraction
+**        with the ones over variables of its own system.
+**
+**        It also keeps the operator terms found by the operator
+**        abstraction of sygus-pdr, so the properties whose systems have
+**        the same state updates walk them only once.
+**
+**/
+
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "core/ts.h"
+#include "smt-switch/smt.h"
+
+namespace pono {
+
+class RefinementCache
+{
+ public:
+  /** @param solver the solver of the original transition system
+   *         all refinements are terms of this solver
+   */
+  RefinementCache(const smt::SmtSolver & solver);
+
+  const smt::SmtSolver & solver() const { return solver_; }
+
+  /** Add a refinement (duplicates are skipped)
+   *  @param t a boolean term over current and next state variables and
+   *         inputs of the concrete system, in solver()
+   */
+  void add(const smt::Term & t);
+
+  /** @param ts a transition system in solver()
+   *  @return the refinements whose variables all belong to ts
+   */
+  smt::TermVec relevant(const TransitionSystem & ts) const;
+
+  size_t size() const;
+
+  /** Get the terms of the state updates of ts with an operator in ops
+   *  The terms are found once for each set of state updates and
+   *  operators.
+   *  @param ts a transition system in solver()
+   *  @param ops the operators
+   *  @param out set to add the terms to
+   *  @return true iff the terms were found for an earlier system
+   */
+  bool op_terms(const TransitionSystem & ts,
+                const std::unordered_set<smt::PrimOp> & ops,
+                smt::UnorderedTermSet & out);
+
+ private:
+  smt::SmtSolver solver_;
+
+  mutable std::mutex mutex_;
+  smt::TermVec refinements_;
+  std::vector<smt::UnorderedTermSet> free_vars_;  ///< of each refinement
+  smt::UnorderedTermSet refinement_terms_;       ///< for skipping duplicates
+
+  struct OpTerms
+  {
+    std::unordered_set<smt::PrimOp> ops;
+    smt::UnorderedTermMap updates;
+    smt::UnorderedTermSet terms;
+  };
+  // by a hash of the state updates
+  std::unordered_map<size_t, std::vector<OpTerms>> op_terms_;
+};
+
+}  // namespace pono
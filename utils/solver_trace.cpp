@@ -0,0 +1,171 @@
+/*********************                                                        */
+/*! \file solver_trace.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Low-overhead tracing of solver calls.
+**
+**/
+
+#include "utils/solver_trace.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+namespace pono {
+
+SolverTrace solver_trace;
+
+static thread_local uint32_t current_tag = 0;
+
+static const char * call_names[NUM_TRACE_CALLS] = { "check_sat",
+                                                    "check_sat_assuming",
+                                                    "get_value",
+                                                    "get_unsat_assumptions",
+                                                    "get_interpolant" };
+
+SolverTrace::SolverTrace() : enabled_(false), tags_({ "" }) {}
+
+void SolverTrace::set_output_file(const string & filename)
+{
+  lock_guard<mutex> lock(mutex_);
+  filename_ = filename;
+  enabled_ = true;
+}
+
+uint32_t SolverTrace::tag_id(const string & name)
+{
+  lock_guard<mutex> lock(mutex_);
+  for (uint32_t i = 0; i < tags_.size(); ++i) {
+    if (tags_[i] == name) {
+      return i;
+    }
+  }
+  if (tags_.size() == max_tags) {
+    return 0;
+  }
+  tags_.push_back(name);
+  return tags_.size() - 1;
+}
+
+SolverTrace::ThreadTrace & SolverTrace::thread_trace()
+{
+  static thread_local ThreadTrace * trace = nullptr;
+  if (!trace) {
+    // value-initialized, i.e. all counters are 0
+    trace = new ThreadTrace();
+    lock_guard<mutex> lock(mutex_);
+    threads_.push_back(trace);
+  }
+  return *trace;
+}
+
+void SolverTrace::record(SolverCall call,
+                         double seconds,
+                         uint8_t result,
+                         size_t num_assumptions)
+{
+  Histogram & h = thread_trace().hist[call][current_tag];
+  uint64_t nanos = seconds * 1e9;
+  // only this thread writes, relaxed read-modify-writes are enough
+  h.count.fetch_add(1, memory_order_relaxed);
+  h.nanos.fetch_add(nanos, memory_order_relaxed);
+  if (nanos > h.max_nanos.load(memory_order_relaxed)) {
+    h.max_nanos.store(nanos, memory_order_relaxed);
+  }
+  h.assumptions.fetch_add(num_assumptions, memory_order_relaxed);
+  h.results[result < 3 ? result : 2].fetch_add(1, memory_order_relaxed);
+
+  uint64_t micros = nanos / 1000;
+  size_t bucket = 0;
+  while (micros && bucket + 1 < num_buckets) {
+    micros >>= 1;
+    ++bucket;
+  }
+  h.buckets[bucket].fetch_add(1, memory_order_relaxed);
+}
+
+string SolverTrace::to_json() const
+{
+  lock_guard<mutex> lock(mutex_);
+  ostringstream out;
+  out << "[";
+  bool first = true;
+  for (size_t c = 0; c < NUM_TRACE_CALLS; ++c) {
+    for (size_t t = 0; t < tags_.size(); ++t) {
+      uint64_t count = 0, nanos = 0, max_nanos = 0, assumptions = 0;
+      uint64_t results[3] = { 0, 0, 0 };
+      vector<uint64_t> buckets(num_buckets, 0);
+      for (const auto & trace : threads_) {
+        const Histogram & h = trace->hist[c][t];
+        count += h.count.load(memory_order_relaxed);
+        nanos += h.nanos.load(memory_order_relaxed);
+        max_nanos = max(max_nanos, h.max_nanos.load(memory_order_relaxed));
+        assumptions += h.assumptions.load(memory_order_relaxed);
+        for (size_t r = 0; r < 3; ++r) {
+          results[r] += h.results[r].load(memory_order_relaxed);
+        }
+        for (size_t b = 0; b < num_buckets; ++b) {
+          buckets[b] += h.buckets[b].load(memory_order_relaxed);
+        }
+      }
+      if (!count) {
+        continue;
+      }
+
+      // tags are identifiers chosen in the code, no escaping needed
+      out << (first ? "" : ",\n ") << "{\"call\": \"" << call_names[c]
+          << "\", \"tag\": \"" << tags_[t] << "\", \"count\": " << count
+          << ", \"time\": " << nanos * 1e-9
+          << ", \"max_time\": " << max_nanos * 1e-9
+          << ", \"assumptions\": " << assumptions
+          << ", \"sat\": " << results[0] << ", \"unsat\": " << results[1]
+          << ", \"unknown\": " << results[2] << ", \"log2_micros\": [";
+      // drop the trailing empty buckets
+      size_t end = num_buckets;
+      while (end > 1 && !buckets[end - 1]) {
+        --end;
+      }
+      for (size_t b = 0; b < end; ++b) {
+        out << (b ? ", " : "") << buckets[b];
+      }
+      out << "]}";
+      first = false;
+    }
+  }
+  out << "]" << endl;
+  return out.str();
+}
+
+bool SolverTrace::dump() const
+{
+  if (!enabled()) {
+    return true;
+  }
+  ofstream f(filename_);
+  if (!f.is_open()) {
+    return false;
+  }
+  f << to_json();
+  return f.good();
+}
+
+SolverTraceScope::SolverTraceScope(uint32_t tag) : prev_(current_tag)
+{
+  current_tag = tag;
+}
+
+SolverTraceScope::~SolverTraceScope() { current_tag = prev_; }
+
+uint32_t SolverTraceScope::current() { return current_tag; }
+
+}  // namespace pono
@@ -0,0 +1,183 @@
+/*********************                                                        */
+/*! \file solver_trace.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Low-overhead tracing of solver calls: the duration, result and
+**        number of assumptions of each call, attributed to the engine
+**        phase (tag) it was made in. Unlike a LoggingSolver it does not
+**        touch the terms.
+**
+**        Each thread records into its own histograms of atomic counters,
+**        so recording takes no lock and the histograms can be read while
+**        they are updated. They are written as JSON by dump(), e.g. at
+**        exit. When tracing is disabled a call costs one atomic load.
+**
+**/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "smt-switch/smt.h"
+
+namespace pono {
+
+enum SolverCall
+{
+  TRACE_CHECK_SAT = 0,
+  TRACE_CHECK_SAT_ASSUMING,
+  TRACE_GET_VALUE,
+  TRACE_GET_UNSAT_ASSUMPTIONS,
+  TRACE_GET_INTERPOLANT,
+  NUM_TRACE_CALLS
+};
+
+// Meant to be used as a singleton class -- instantiated as solver_trace
+// below (the per-thread histograms are per process)
+class SolverTrace
+{
+ public:
+  ///< the number of distinct tags, later tags are merged with tag 0 ("")
+  static constexpr size_t max_tags = 64;
+  ///< calls taking [2^(i-1), 2^i) microseconds go to bucket i
+  static constexpr size_t num_buckets = 32;
+
+  SolverTrace();
+
+  /** Enable tracing and set the file written by dump */
+  void set_output_file(const std::string & filename);
+
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  /** @return the id of a tag, the name of an engine phase such as
+   *          "ic3_rel_ind". The same name always gets the same id.
+   */
+  uint32_t tag_id(const std::string & name);
+
+  /** Record a call made by this thread
+   *  @param call the kind of call
+   *  @param seconds its duration
+   *  @param result 0 for sat, 1 for unsat, 2 for unknown or no result
+   *  @param num_assumptions the number of assumptions of the call
+   */
+  void record(SolverCall call,
+              double seconds,
+              uint8_t result,
+              size_t num_assumptions);
+
+  /** @return the histograms of all threads as JSON, one object per call
+   *          kind and tag that was recorded
+   */
+  std::string to_json() const;
+
+  /** Write to_json() to the output file (does nothing if not enabled)
+   *  @return true on success
+   */
+  bool dump() const;
+
+ protected:
+  struct Histogram
+  {
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> nanos;
+    std::atomic<uint64_t> max_nanos;
+    std::atomic<uint64_t> assumptions;
+    std::atomic<uint64_t> results[3];
+    std::atomic<uint64_t> buckets[num_buckets];
+  };
+
+  /** The histograms of a thread, indexed by call and tag */
+  struct ThreadTrace
+  {
+    Histogram hist[NUM_TRACE_CALLS][max_tags];
+  };
+
+  /** @return the histograms of the calling thread, created on first use */
+  ThreadTrace & thread_trace();
+
+  std::atomic<bool> enabled_;
+  std::string filename_;
+
+  mutable std::mutex mutex_;
+  std::vector<std::string> tags_;
+  ///< the traces of all threads, kept after the threads exit
+  std::vector<ThreadTrace *> threads_;
+};
+
+// globally available solver trace
+extern SolverTrace solver_trace;
+
+/** Attribute the solver calls of this thread to a tag while in scope */
+class SolverTraceScope
+{
+ public:
+  SolverTraceScope(uint32_t tag);
+  ~SolverTraceScope();
+
+  /** @return the tag of the calls of this thread */
+  static uint32_t current();
+
+ protected:
+  uint32_t prev_;
+};
+
+/** Looks up the tag once per call site, then sets it for the scope */
+#define SOLVER_TRACE_SCOPE(name)                                   \
+  static const uint32_t solver_trace_tag_ = solver_trace.tag_id(name); \
+  SolverTraceScope solver_trace_scope_(solver_trace_tag_)
+
+/** Times a solver call and records it when done (or destroyed) */
+class SolverCallTimer
+{
+ public:
+  SolverCallTimer(SolverCall call, size_t num_assumptions = 0)
+      : call_(call),
+        num_assumptions_(num_assumptions),
+        active_(solver_trace.enabled())
+  {
+    if (active_) {
+      begin_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~SolverCallTimer() { done(2); }
+
+  /** Record the call with a result (once) */
+  void done(const smt::Result & r)
+  {
+    done(r.is_sat() ? 0 : (r.is_unsat() ? 1 : 2));
+  }
+
+  void done(uint8_t result)
+  {
+    if (active_) {
+      active_ = false;
+      solver_trace.record(call_,
+                          std::chrono::duration<double>(
+                              std::chrono::steady_clock::now() - begin_)
+                              .count(),
+                          result,
+                          num_assumptions_);
+    }
+  }
+
+ protected:
+  SolverCall call_;
+  size_t num_assumptions_;
+  bool active_;
+  std::chrono::steady_clock::time_point begin_;
+};
+
+}  // namespace pono
@@ -0,0 +1,376 @@
+/*********************                                                        */
+/*! \file statistics.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Machine-readable statistics of the engines.
+**        Every prover owns a Statistics object with named counters,
+**        timers, lists and histograms. The global statistics_registry collects them
+**        and writes them as JSON (e.g. at exit or on a signal), and can
+**        periodically rewrite a metrics file in the Prometheus text
+**        format while the engines run.
+**
+**/
+
+#include "utils/statistics.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "utils/budget.h"
+
+using namespace std;
+
+namespace pono {
+
+// names are generated by pono (and strings may come from the user), so
+// escape them
+static string json_string(const string & s)
+{
+  string res = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      res += '\\';
+      res += c;
+    } else if (c == '\n') {
+      res += "\\n";
+    } else if (c == '\t') {
+      res += "\\t";
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      // the other control characters are not allowed in a JSON string
+      char buf[8];
+      snprintf(buf, sizeof(buf), "\\u%04x", c);
+      res += buf;
+    } else {
+      res += c;
+    }
+  }
+  res += "\"";
+  return res;
+}
+
+void Statistics::increment(const string & name, size_t n)
+{
+  lock_guard<mutex> lock(mutex_);
+  counters_[name] += n;
+}
+
+void Statistics::set(const string & name, size_t v)
+{
+  lock_guard<mutex> lock(mutex_);
+  counters_[name] = v;
+}
+
+void Statistics::add_time(const string & name, double seconds)
+{
+  lock_guard<mutex> lock(mutex_);
+  timers_[name] += seconds;
+}
+
+void Statistics::set_string(const string & name, const string & v)
+{
+  lock_guard<mutex> lock(mutex_);
+  strings_[name] = v;
+}
+
+void Statistics::set_list(const string & name, const vector<size_t> & l)
+{
+  lock_guard<mutex> lock(mutex_);
+  lists_[name] = l;
+}
+
+void Statistics::record(const string & name, size_t v)
+{
+  size_t bucket = 0;
+  for (size_t r = v; r; r >>= 1) {
+    ++bucket;
+  }
+  lock_guard<mutex> lock(mutex_);
+  Histogram & h = histograms_[name];
+  ++h.count;
+  h.sum += v;
+  h.max = std::max(h.max, v);
+  if (h.log2_buckets.size() <= bucket) {
+    h.log2_buckets.resize(bucket + 1, 0);
+  }
+  ++h.log2_buckets[bucket];
+}
+
+Statistics::Histogram Statistics::get_histogram(const string & name) const
+{
+  lock_guard<mutex> lock(mutex_);
+  auto it = histograms_.find(name);
+  return it == histograms_.end() ? Histogram() : it->second;
+}
+
+size_t Statistics::get(const string & name) const
+{
+  lock_guard<mutex> lock(mutex_);
+  auto it = counters_.find(name);
+  return it == counters_.end() ? 0 : it->second;
+}
+
+double Statistics::get_time(const string & name) const
+{
+  lock_guard<mutex> lock(mutex_);
+  auto it = timers_.find(name);
+  return it == timers_.end() ? 0 : it->second;
+}
+
+TimedLockGuard::TimedLockGuard(mutex & m, Statistics * stats) : mutex_(m)
+{
+  if (mutex_.try_lock()) {
+    return;
+  }
+  auto begin = chrono::steady_clock::now();
+  mutex_.lock();
+  if (stats) {
+    stats->add_time(
+        "lock_wait_time",
+        chrono::duration<double>(chrono::steady_clock::now() - begin).count());
+  }
+}
+
+map<string, double> Statistics::snapshot() const
+{
+  lock_guard<mutex> lock(mutex_);
+  map<string, double> res;
+  for (const auto & elem : counters_) {
+    res[elem.first] = elem.second;
+  }
+  for (const auto & elem : timers_) {
+    res[elem.first + "_seconds"] = elem.second;
+  }
+  for (const auto & elem : histograms_) {
+    res[elem.first + "_count"] = elem.second.count;
+    res[elem.first + "_sum"] = elem.second.sum;
+  }
+  return res;
+}
+
+string Statistics::to_json() const
+{
+  lock_guard<mutex> lock(mutex_);
+  ostringstream out;
+  out << "{";
+  bool first = true;
+  for (const auto & elem : counters_) {
+    out << (first ? "" : ", ") << json_string(elem.first) << ": "
+        << elem.second;
+    first = false;
+  }
+  for (const auto & elem : timers_) {
+    out << (first ? "" : ", ") << json_string(elem.first) << ": "
+        << elem.second;
+    first = false;
+  }
+  for (const auto & elem : lists_) {
+    out << (first ? "" : ", ") << json_string(elem.first) << ": [";
+    for (size_t i = 0; i < elem.second.size(); ++i) {
+      out << (i ? ", " : "") << elem.second[i];
+    }
+    out << "]";
+    first = false;
+  }
+  for (const auto & elem : histograms_) {
+    const Histogram & h = elem.second;
+    out << (first ? "" : ", ") << json_string(elem.first)
+        << ": {\"count\": " << h.count << ", \"sum\": " << h.sum
+        << ", \"max\": " << h.max << ", \"log2_buckets\": [";
+    for (size_t i = 0; i < h.log2_buckets.size(); ++i) {
+      out << (i ? ", " : "") << h.log2_buckets[i];
+    }
+    out << "]}";
+    first = false;
+  }
+  for (const auto & elem : strings_) {
+    out << (first ? "" : ", ") << json_string(elem.first) << ": "
+        << json_string(elem.second);
+    first = false;
+  }
+  out << "}";
+  return out.str();
+}
+
+StatisticsRegistry::~StatisticsRegistry() { stop_metrics(); }
+
+void StatisticsRegistry::set_output_file(const string & filename)
+{
+  lock_guard<mutex> lock(mutex_);
+  filename_ = filename;
+  enabled_ = true;
+}
+
+void StatisticsRegistry::set_metrics_file(const string & filename,
+                                          size_t interval)
+{
+  stop_metrics();
+  {
+    lock_guard<mutex> lock(mutex_);
+    metrics_filename_ = filename;
+    enabled_ = true;
+  }
+  stop_metrics_ = false;
+  metrics_writer_ = std::thread(
+      [this, interval]() { metrics_loop(std::max<size_t>(interval, 1)); });
+}
+
+void StatisticsRegistry::add(const string & engine,
+                             const shared_ptr<Statistics> & stats)
+{
+  if (!enabled()) {
+    return;
+  }
+  lock_guard<mutex> lock(mutex_);
+  stats_.push_back({ engine, stats });
+}
+
+string StatisticsRegistry::to_json() const
+{
+  lock_guard<mutex> lock(mutex_);
+  ostringstream out;
+  out << "[";
+  for (size_t i = 0; i < stats_.size(); ++i) {
+    out << (i ? ",\n " : "") << "{\"engine\": " << json_string(stats_[i].first)
+        << ", \"stats\": " << stats_[i].second->to_json() << "}";
+  }
+  out << "]" << endl;
+  return out.str();
+}
+
+bool StatisticsRegistry::dump() const
+{
+  if (filename_.empty()) {
+    return true;
+  }
+  ofstream f(filename_);
+  if (!f.is_open()) {
+    return false;
+  }
+  f << to_json();
+  return f.good();
+}
+
+// metric names may only contain letters, digits and underscores
+static string metric_name(const string & s)
+{
+  string res = "pono_";
+  for (char c : s) {
+    res += isalnum(static_cast<unsigned char>(c)) ? c : '_';
+  }
+  return res;
+}
+
+static string label_value(const string & s)
+{
+  string res;
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      res += '\\';
+      res += c;
+    } else if (c == '\n') {
+      res += "\\n";
+    } else {
+      res += c;
+    }
+  }
+  return res;
+}
+
+string StatisticsRegistry::to_prometheus() const
+{
+  // the samples of each metric are grouped under its TYPE line
+  map<string, vector<string>> samples;
+  {
+    lock_guard<mutex> lock(mutex_);
+    for (size_t i = 0; i < stats_.size(); ++i) {
+      string labels = "{engine=\"" + label_value(stats_[i].first)
+                      + "\",id=\"" + std::to_string(i) + "\"}";
+      for (const auto & elem : stats_[i].second->snapshot()) {
+        ostringstream sample;
+        sample << labels << " " << elem.second;
+        samples[metric_name(elem.first)].push_back(sample.str());
+      }
+    }
+  }
+
+  ostringstream out;
+  out << "# TYPE pono_rss_bytes gauge\n"
+      << "pono_rss_bytes " << current_memory_kb() * 1024 << "\n"
+      << "# TYPE pono_uptime_seconds gauge\n"
+      << "pono_uptime_seconds "
+      << chrono::duration<double>(chrono::steady_clock::now() - start_)
+             .count()
+      << "\n";
+  for (const auto & elem : samples) {
+    // counters may also be set to lower values, e.g. reached_k
+    out << "# TYPE " << elem.first << " gauge\n";
+    for (const auto & sample : elem.second) {
+      out << elem.first << sample << "\n";
+    }
+  }
+  return out.str();
+}
+
+bool StatisticsRegistry::write_metrics() const
+{
+  if (metrics_filename_.empty()) {
+    return true;
+  }
+  // rename is atomic, the readers see the old or the new file
+  string tmp = metrics_filename_ + ".tmp";
+  {
+    ofstream f(tmp);
+    if (!f.is_open()) {
+      return false;
+    }
+    f << to_prometheus();
+    if (!f.good()) {
+      return false;
+    }
+  }
+  return std::rename(tmp.c_str(), metrics_filename_.c_str()) == 0;
+}
+
+void StatisticsRegistry::stop_metrics()
+{
+  if (!metrics_writer_.joinable()) {
+    return;
+  }
+  {
+    lock_guard<mutex> lock(metrics_mutex_);
+    stop_metrics_ = true;
+  }
+  metrics_cv_.notify_one();
+  metrics_writer_.join();
+}
+
+void StatisticsRegistry::metrics_loop(size_t interval)
+{
+  unique_lock<mutex> lock(metrics_mutex_);
+  while (true) {
+    bool stop = metrics_cv_.wait_for(
+        lock, chrono::seconds(interval), [this]() { return stop_metrics_; });
+    lock.unlock();
+    write_metrics();
+    if (stop) {
+      return;
+    }
+    lock.lock();
+  }
+}
+
+// declare a global statistics registry
+StatisticsRegistry statistics_registry;
+
+}  // namespace pono
@@ -0,0 +1,198 @@
+/*********************                                                        */
+/*! \file statistics.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Machine-readable statistics of the engines.
+**        Every prover owns a Statistics object with named counters,
+**        timers, lists and histograms. The global statistics_registry collects them
+**        and writes them as JSON (e.g. at exit or on a signal), and can
+**        periodically rewrite a metrics file in the Prometheus text
+**        format while the engines run.
+**
+**/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace pono {
+
+class Statistics
+{
+ public:
+  Statistics() {}
+
+  /** Add n to a counter (counters start at 0) */
+  void increment(const std::string & name, size_t n = 1);
+
+  /** Overwrite the value of a counter */
+  void set(const std::string & name, size_t v);
+
+  /** Add seconds to a timer (timers start at 0) */
+  void add_time(const std::string & name, double seconds);
+
+  /** Overwrite a string, e.g. the value of an option */
+  void set_string(const std::string & name, const std::string & v);
+
+  /** Overwrite a list, e.g. the number of lemmas in each frame */
+  void set_list(const std::string & name, const std::vector<size_t> & l);
+
+  /** The distribution of the values recorded under a name */
+  struct Histogram
+  {
+    size_t count = 0;
+    size_t sum = 0;
+    size_t max = 0;
+    ///< values in [2^(i-1), 2^i) go to bucket i, 0 to bucket 0
+    std::vector<size_t> log2_buckets;
+  };
+
+  /** Add a value to a histogram, e.g. the size of each generalized cube */
+  void record(const std::string & name, size_t v);
+
+  /** @return a histogram (empty if nothing was recorded) */
+  Histogram get_histogram(const std::string & name) const;
+
+  /** @return the value of a counter (0 if it was never set) */
+  size_t get(const std::string & name) const;
+
+  /** @return the value of a timer (0 if it was never set) */
+  double get_time(const std::string & name) const;
+
+  /** @return the statistics as a JSON object */
+  std::string to_json() const;
+
+  /** @return the counters, the timers (their names suffixed with
+   *          _seconds) and the count and sum of the histograms (suffixed
+   *          with _count and _sum), e.g. for the metrics file
+   */
+  std::map<std::string, double> snapshot() const;
+
+ private:
+  mutable std::mutex mutex_;
+  std::map<std::string, size_t> counters_;
+  std::map<std::string, double> timers_;
+  std::map<std::string, std::vector<size_t>> lists_;
+  std::map<std::string, Histogram> histograms_;
+  std::map<std::string, std::string> strings_;
+};
+
+/** Locks a mutex like std::lock_guard, and adds the time spent waiting
+ *  for it to the timer lock_wait_time of the statistics
+ *  Only a contended lock is timed, taking a free lock costs no more
+ *  than with std::lock_guard.
+ */
+class TimedLockGuard
+{
+ public:
+  /** @param m the mutex to lock
+   *  @param stats the statistics to add the waiting time to (may be null)
+   */
+  TimedLockGuard(std::mutex & m, Statistics * stats);
+  ~TimedLockGuard() { mutex_.unlock(); }
+
+  TimedLockGuard(const TimedLockGuard &) = delete;
+  TimedLockGuard & operator=(const TimedLockGuard &) = delete;
+
+ private:
+  std::mutex & mutex_;
+};
+
+// Meant to be used as a singleton class -- instantiated as
+// statistics_registry below
+class StatisticsRegistry
+{
+ public:
+  StatisticsRegistry()
+      : enabled_(false),
+        start_(std::chrono::steady_clock::now()),
+        stop_metrics_(false)
+  {
+  }
+  ~StatisticsRegistry();
+
+  /** Set the file written by dump -- enables the registry
+   *  Until this or set_metrics_file is called the registry does not
+   *  keep any statistics.
+   */
+  void set_output_file(const std::string & filename);
+
+  /** Rewrite a file with the current statistics every interval seconds,
+   *  from a background thread, in the Prometheus text format (e.g. for
+   *  the textfile collector of node_exporter) -- enables the registry
+   *  The file is replaced atomically, readers never see a partial file.
+   *  The engines are not slowed down: the statistics of each engine are
+   *  only locked while they are copied, once per interval.
+   *  @param filename the metrics file
+   *  @param interval seconds between two rewrites (at least 1)
+   */
+  void set_metrics_file(const std::string & filename, size_t interval);
+
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  /** Add the statistics of an engine
+   *  @param engine the engine name, used as the key in the JSON output
+   *  @param stats the statistics, kept alive by the registry after the
+   *         engine is destroyed
+   */
+  void add(const std::string & engine,
+           const std::shared_ptr<Statistics> & stats);
+
+  /** @return all the statistics as a JSON array, one object per engine */
+  std::string to_json() const;
+
+  /** Write to_json() to the output file (does nothing if not enabled)
+   *  @return true on success
+   */
+  bool dump() const;
+
+  /** @return all the counters and timers in the Prometheus text format,
+   *          labeled with the engine and its index in the registry, and
+   *          the resident memory and uptime of the process
+   */
+  std::string to_prometheus() const;
+
+  /** Write to_prometheus() to the metrics file (does nothing if there is
+   *  none)
+   *  @return true on success
+   */
+  bool write_metrics() const;
+
+  /** Write the metrics a last time and stop the background thread */
+  void stop_metrics();
+
+ private:
+  void metrics_loop(size_t interval);
+
+  std::atomic<bool> enabled_;
+  mutable std::mutex mutex_;
+  std::string filename_;
+  std::vector<std::pair<std::string, std::shared_ptr<Statistics>>> stats_;
+
+  std::string metrics_filename_;
+  std::chrono::steady_clock::time_point start_;
+  std::mutex metrics_mutex_;  ///< protects stop_metrics_
+  std::condition_variable metrics_cv_;
+  bool stop_metrics_;
+  std::thread metrics_writer_;
+};
+
+// globally available statistics registry
+extern StatisticsRegistry statistics_registry;
+
+}  // namespace pono
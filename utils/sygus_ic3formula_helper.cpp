@@ -17,6 +17,7 @@
 #include "utils/sygus_ic3formula_helper.h"
 #include "utils/str_util.h"
 
+#include <algorithm>
 #include <cassert>
 
 namespace pono {
@@ -33,13 +34,18 @@ namespace syntax_analysis {
 // }
 
 IC3FormulaModel::IC3FormulaModel(IC3FormulaModel && f) :
-  cube_(std::move(f.cube_)), expr_(std::move(f.expr_)) {
+  cube_(std::move(f.cube_)), expr_(std::move(f.expr_)),
+  varset_key_(std::move(f.varset_key_)), key_computed_(f.key_computed_) {
+  f.key_computed_ = false;
 }
   
 IC3FormulaModel & IC3FormulaModel::operator=(IC3FormulaModel && other) {
   if (this != &other) {
     cube_ = std::move(other.cube_);
     expr_ = std::move(other.expr_);
+    varset_key_ = std::move(other.varset_key_);
+    key_computed_ = other.key_computed_;
+    other.key_computed_ = false;
   }
   return *this;
 }
@@ -53,6 +59,24 @@ std::string IC3FormulaModel::vars_to_canonical_string() const {
   return Join(vars, "?<*>?"); // hope it won't appear in the the var names
 }
 
+const VarsetKey & IC3FormulaModel::varset_key() const {
+  if (key_computed_)
+    return varset_key_;
+  auto & ids = varset_key_.ids;
+  ids.clear();
+  ids.reserve(cube_.size());
+  for (auto && v_val : cube_)
+    ids.push_back(v_val.first->get_id());
+  std::sort(ids.begin(), ids.end());
+  // boost::hash_combine
+  size_t h = ids.size();
+  for (auto id : ids)
+    h ^= std::hash<uint64_t>()(id) + 0x9e3779b9 + (h << 6) + (h >> 2);
+  varset_key_.hash = h;
+  key_computed_ = true;
+  return varset_key_;
+}
+
 std::string IC3FormulaModel::vars_val_to_canonical_string() const {
   std::vector<std::pair<std::string,std::string>> vars_vals;
   for (auto && v_val : cube_) {
@@ -18,12 +18,29 @@
 
 #include "smt-switch/smt.h"
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace pono {
 
 namespace syntax_analysis {
 
+// the set of variables of a model: the sorted ids of the terms and
+// their hash, computed once. It keys the per-varset caches, so a lookup
+// compares integers instead of joining and hashing the variable names
+struct VarsetKey {
+  std::vector<uint64_t> ids;
+  size_t hash = 0;
+
+  bool operator==(const VarsetKey & other) const
+  { return hash == other.hash && ids == other.ids; }
+};
+
+struct VarsetKeyHash {
+  size_t operator()(const VarsetKey & k) const { return k.hash; }
+};
+
 // I really want to cache some of the results
 // instead of deciding the variables again and again
 // and only class of partial model can construct
@@ -36,7 +53,7 @@ class IC3FormulaModel {
   // because very often we need to construct the map
   // first and want to avoid a copy
   IC3FormulaModel(cube_t && cube, const smt::Term & expr) : 
-    cube_(cube), expr_(expr) {}
+    cube_(cube), expr_(expr), key_computed_(false) {}
   
   // here we really do the extraction
   // IC3FormulaModel(const IC3Formula & f);
@@ -49,13 +66,19 @@ class IC3FormulaModel {
  protected:
   cube_t cube_;
   smt::Term expr_;
+  // the cube is not changed after construction
+  mutable VarsetKey varset_key_;
+  mutable bool key_computed_;
   
  public:
   std::string vars_to_canonical_string() const;
+  // the same varsets as vars_to_canonical_string, computed on first use
+  const VarsetKey & varset_key() const;
   std::string vars_val_to_canonical_string() const;
   std::string to_string() const;
   void get_varset(std::unordered_set<smt::Term> & varset) const;
   smt::Term to_expr() const { return expr_; }
+  const cube_t & cube() const { return cube_; }
   
 }; // IC3FormulaModel
 
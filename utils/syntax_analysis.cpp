@@ -30,10 +30,10 @@ unsigned VarTermManager::GetMoreTerms(IC3FormulaModel * pre, IC3FormulaModel * p
     const smt::Term & trans, bool failed_at_init, SyGuSTermMode term_mode) {
   // decide the policy
   assert(pre && post);
-  std::string var_string = post->vars_to_canonical_string();
-  assert(IN(var_string, terms_cache_)); // should already done this
+  const VarsetKey & varset_key = post->varset_key();
+  assert(IN(varset_key, terms_cache_)); // should already done this
 
-  PerVarsetInfo & varset_info = terms_cache_.at(var_string);
+  PerVarsetInfo & varset_info = terms_cache_.at(varset_key);
   
   assert(varset_info.state.stage != PerVarsetInfo::state_t::EXTRACTBITS);
 #if 0
@@ -83,9 +83,9 @@ unsigned VarTermManager::GetMoreTerms(IC3FormulaModel * pre, IC3FormulaModel * p
   assert(false);
 } // GetMoreTerms
 
-// we just won't compute canonical_string twice
+// we just won't compute varset_key twice
 const PerVarsetInfo & VarTermManager::SetupTermsForVarModelNormal(
-  IC3FormulaModel * m, const std::string & canonical_string, 
+  IC3FormulaModel * m, const VarsetKey & varset_key, 
   smt::SmtSolver & solver_,
   unsigned term_extract_depth, unsigned initial_term_width,
   unsigned initial_term_inc, unsigned accumulated_term_bound) {
@@ -95,7 +95,7 @@ const PerVarsetInfo & VarTermManager::SetupTermsForVarModelNormal(
   m->get_varset(varset);
 
   terms_cache_t::iterator pos; bool succ;
-  std::tie(pos, succ) = terms_cache_.emplace(canonical_string, 
+  std::tie(pos, succ) = terms_cache_.emplace(varset_key, 
     PerVarsetInfo(PerVarsetInfo::state_t::EMPTY));
 
   // now TERM_EXTRACT_DEPTH
@@ -142,20 +142,20 @@ const PerVarsetInfo & VarTermManager::GetAllTermsForVarsInModel(
   unsigned term_extract_depth, unsigned initial_term_width,
   unsigned initial_term_inc, unsigned accumulated_term_bound) {
 
-  std::string var_string = m->vars_to_canonical_string();
-  auto pos = terms_cache_.find(var_string);
+  const VarsetKey & varset_key = m->varset_key();
+  auto pos = terms_cache_.find(varset_key);
   if ( pos != terms_cache_.end() )  {
     return pos->second;
   }
   if (term_mode == SyGuSTermMode::FROM_DESIGN_LEARN_EXT)
-    return SetupTermsForVarModelNormal(m, var_string, s, 
+    return SetupTermsForVarModelNormal(m, varset_key, s, 
       term_extract_depth, initial_term_width, initial_term_inc, accumulated_term_bound);
   if (term_mode == SyGuSTermMode::VAR_C_EXT)
-    return SetupTermsForVarModeExt(m, var_string, s);
+    return SetupTermsForVarModeExt(m, varset_key, s);
   if (term_mode == SyGuSTermMode::SPLIT_FROM_DESIGN)
-    return SetupTermsForVarModeSplit(m, var_string, s);
+    return SetupTermsForVarModeSplit(m, varset_key, s);
   if (term_mode == SyGuSTermMode::VAR_C_EQ_LT)
-    return SetupTermsForVarModelVC(m, var_string, s); // just var and constant, you don't need a lot more
+    return SetupTermsForVarModelVC(m, varset_key, s); // just var and constant, you don't need a lot more
 
   assert(false);
 } // GetAllTermsFor
@@ -166,7 +166,7 @@ const PerVarsetInfo & VarTermManager::GetAllTermsForVarsInModel(
 
 
 const PerVarsetInfo & VarTermManager::SetupTermsForVarModeSplit(
-  IC3FormulaModel * m, const std::string & canonical_string, smt::SmtSolver & solver_)
+  IC3FormulaModel * m, const VarsetKey & varset_key, smt::SmtSolver & solver_)
 {
 
   bool collect_constant = width_to_constants_.empty();
@@ -174,7 +174,7 @@ const PerVarsetInfo & VarTermManager::SetupTermsForVarModeSplit(
   m->get_varset(varset);
 
   terms_cache_t::iterator pos; bool succ;
-  std::tie(pos, succ) = terms_cache_.emplace(canonical_string, 
+  std::tie(pos, succ) = terms_cache_.emplace(varset_key, 
     PerVarsetInfo(PerVarsetInfo::state_t::WPARTIAL)); //WPARTIAL is better
     // EXTRACTBITS is simply see if we need more
 
@@ -207,7 +207,7 @@ const PerVarsetInfo & VarTermManager::SetupTermsForVarModeSplit(
 } // SetupTermsForVarModeSplit
 
 const PerVarsetInfo & VarTermManager::SetupTermsForVarModelVC(
-  IC3FormulaModel * m, const std::string & canonical_string,
+  IC3FormulaModel * m, const VarsetKey & varset_key,
   smt::SmtSolver & solver_)
 {
   bool collect_constant = width_to_constants_.empty();
@@ -215,7 +215,7 @@ const PerVarsetInfo & VarTermManager::SetupTermsForVarModelVC(
   m->get_varset(varset);
 
   terms_cache_t::iterator pos; bool succ;
-  std::tie(pos, succ) = terms_cache_.emplace(canonical_string, 
+  std::tie(pos, succ) = terms_cache_.emplace(varset_key, 
     PerVarsetInfo(PerVarsetInfo::state_t::VCLTE)); // see if we need more 
   // auto determine is needed!
 
@@ -247,14 +247,14 @@ const PerVarsetInfo & VarTermManager::SetupTermsForVarModelVC(
 
 
 const PerVarsetInfo & VarTermManager::SetupTermsForVarModeExt(
-  IC3FormulaModel * m, const std::string & canonical_string, smt::SmtSolver & solver_) {
+  IC3FormulaModel * m, const VarsetKey & varset_key, smt::SmtSolver & solver_) {
   
   bool collect_constant = width_to_constants_.empty();
   std::unordered_set<smt::Term> varset;
   m->get_varset(varset);
 
   terms_cache_t::iterator pos; bool succ;
-  std::tie(pos, succ) = terms_cache_.emplace(canonical_string, 
+  std::tie(pos, succ) = terms_cache_.emplace(varset_key, 
     PerVarsetInfo(PerVarsetInfo::state_t::EXTRACTBITS));
 
   if (collect_constant) {
@@ -28,11 +28,16 @@ class TermLearner;
 class VarTermManager{
 public:
   // type definition
-  typedef std::unordered_map<std::string, PerVarsetInfo> terms_cache_t;
+  typedef std::unordered_map<VarsetKey, PerVarsetInfo, VarsetKeyHash> terms_cache_t;
 public:
   VarTermManager() {}
   void RegisterTermsToWalk(const smt::Term & t) { terms_to_check_.push_back(t); } // register the init by var and also trans by var, and property
   
+  // for a walk of the registered terms that collects the constants along
+  // with other analyses (FusedExtractor), instead of on the first varset
+  std::map<unsigned, std::vector<smt::Term>> & ConstantMapToFill() { return width_to_constants_; }
+  std::unordered_set<std::string> & ConstantStringsToFill() { return constants_strings_; }
+  
   
   // this includes Constant Terms (will be inserted)
   const PerVarsetInfo & GetAllTermsForVarsInModel(
@@ -79,18 +84,18 @@ protected:
   // 2. ----------------------------------------------
   // helps with the Terms
   const PerVarsetInfo & SetupTermsForVarModelNormal(
-    IC3FormulaModel * m, const std::string & canonical_string, smt::SmtSolver & s,
+    IC3FormulaModel * m, const VarsetKey & varset_key, smt::SmtSolver & s,
     unsigned term_extract_depth, unsigned initial_term_width,
     unsigned initial_term_inc, unsigned accumulated_term_bound);
 
   const PerVarsetInfo & SetupTermsForVarModeExt(
-    IC3FormulaModel * m, const std::string & canonical_string, smt::SmtSolver & s);
+    IC3FormulaModel * m, const VarsetKey & varset_key, smt::SmtSolver & s);
 
   const PerVarsetInfo & SetupTermsForVarModelVC(
-    IC3FormulaModel * m, const std::string & canonical_string, smt::SmtSolver & s);
+    IC3FormulaModel * m, const VarsetKey & varset_key, smt::SmtSolver & s);
   
   const PerVarsetInfo & SetupTermsForVarModeSplit(
-    IC3FormulaModel * m, const std::string & canonical_string, smt::SmtSolver & solver_);
+    IC3FormulaModel * m, const VarsetKey & varset_key, smt::SmtSolver & solver_);
   
 }; // class VarTermManager
 
@@ -88,6 +88,10 @@ eval_val::eval_val(const std::string & val) {
     return;
   }
   // convert 101 --> 5
+  if (val.length() - pos <= 64) {
+    sv = std::to_string(std::stoull(val.substr(pos), nullptr, 2));
+    return;
+  }
   sv = convert_bin_str_to_decimal(val.substr(pos));
 } // eval_val::eval_val
 
@@ -20,7 +20,9 @@
 #include "smt-switch/smt.h"
 #include "utils/sygus_ic3formula_helper.h"
 
+#include <cstdint>
 #include <map>
+#include <string>
 #include <functional>
 
 namespace pono {
@@ -85,6 +87,7 @@ struct eval_val {
   
   eval_val(const std::string & val); 
   // will remove #b0...0 and then decide to convert or not
+  explicit eval_val(uint64_t val) : sv(std::to_string(val)) {}
   // default copy and assignment, and then
 
   bool operator==(const eval_val &r) const {
@@ -121,6 +124,13 @@ struct PerCexInfo {
   };
 
   std::unordered_map<smt::Term,eval_val> terms_val_under_cex;
+  // the values of the cex variables and of the subterms evaluated without
+  // the solver, and the subterms that cannot be (e.g., abstracted operators)
+  std::unordered_map<smt::Term, uint64_t> native_vals;
+  smt::UnorderedTermSet native_failed;
+  // the terms evaluated by the solver, their value may change with
+  // the operator abstraction refinement
+  smt::TermVec solver_evaluated;
   std::vector<smt::Term> predicates_nxt;
   std::unordered_set<std::string> predicates_str;
   // std::unordered_map<smt::Term, smt::Term> pred_next_to_pred_curr;
@@ -440,6 +440,35 @@ void SliceExtractor::PostChild(const smt::Term & ast) {
   } // if it is extract (slice)
 } // PostChild
 
+// ---------------------------------------------- //
+//                                                //
+//              Fused Extract                     //
+//                                                //
+// ---------------------------------------------- //
+
+bool FusedExtractor::Skip(const smt::Term & ast) {
+  return IN(ast, walked_nodes_);
+}
+
+void FusedExtractor::PreChild(const smt::Term & ast) {
+  // the scores need the children, so everything is in PostChild
+}
+
+void FusedExtractor::PostChild(const smt::Term & ast) {
+  walked_nodes_.insert(ast);
+  // the walkers may have seen the node on their own walks
+  if (ops_ && !IN(ast, ops_->walked_nodes_))
+    ops_->PreChild(ast);
+  if (!all_)
+    return;
+  if (scores_ && !IN(ast, scores_->scores_))
+    scores_->PostChild(ast);
+  if (parents_ && !IN(ast, parents_->walked_nodes_))
+    parents_->PostChild(ast);
+  if (constants_ && !IN(ast, constants_->walked_nodes_))
+    constants_->PostChild(ast);
+} // PostChild
+
 
 // ---------------------------------------------- //
 //                                                //
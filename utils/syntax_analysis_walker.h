@@ -24,6 +24,8 @@
 namespace pono {
 namespace syntax_analysis {
 
+class FusedExtractor;
+
 class Walker {
 protected:
   // if you want to buffer and avoid further walk
@@ -51,6 +53,7 @@ public:
       return constructs; }
 
 protected:
+  friend class FusedExtractor;
   std::unordered_set<smt::Term> walked_nodes_;
   std::unordered_set<smt::Term> all_symbols_;
   syntax_analysis::SyntaxStructure constructs;
@@ -126,6 +129,7 @@ public:
   const score_map_t & GetScoreMap() const {return scores_;}
   
 protected:
+  friend class FusedExtractor;
   score_map_t scores_;
   
   virtual bool Skip(const smt::Term & ast) override;
@@ -151,6 +155,7 @@ public:
   }
   
 protected:
+  friend class FusedExtractor;
 
   std::unordered_set<smt::Term> walked_nodes_;
   parent_map_t parent_;
@@ -173,6 +178,7 @@ public:
     ) : width_constant_map(out), constants_strs_(cnstr_strs)  {}
 
 protected:
+  friend class FusedExtractor;
   width_constant_map_t & width_constant_map;
   std::unordered_set<std::string> & constants_strs_;
   std::unordered_set<smt::Term> walked_nodes_;
@@ -212,6 +218,38 @@ protected:
 
 // -----------------------------------------------------
 
+// the analyses of OpExtractor, TermScore, ParentExtract and
+// ConstantExtractor in one traversal, with one visited set.
+// Each of them can be null. After SetAll(false), the nodes walked
+// are only given to the OpExtractor (the scores need the children,
+// so don't go back to SetAll(true))
+class FusedExtractor: public Walker {
+public:
+  FusedExtractor(OpExtractor * ops, TermScore * scores,
+    ParentExtract * parents, ConstantExtractor * constants) :
+    ops_(ops), scores_(scores), parents_(parents), constants_(constants),
+    all_(true) { }
+
+  // if false, the following walks only extract the operators
+  // (e.g. for the terms whose parents are not wanted)
+  void SetAll(bool all) { all_ = all; }
+
+protected:
+  OpExtractor * ops_;
+  TermScore * scores_;
+  ParentExtract * parents_;
+  ConstantExtractor * constants_;
+  bool all_;
+  std::unordered_set<smt::Term> walked_nodes_;
+
+  virtual bool Skip(const smt::Term & ast) override;
+  virtual void PreChild(const smt::Term & ast) override;
+  virtual void PostChild(const smt::Term & ast) override;
+
+}; // FusedExtractor
+
+// -----------------------------------------------------
+
 // you may also want to register the model -> full model map
 class TermLearner {
 
@@ -18,6 +18,7 @@
 #include "smt-switch/smt.h"
 #include "smt-switch/utils.h"
 #include "utils/exceptions.h"
+#include "utils/term_analysis.h"
 
 using namespace smt;
 using namespace std;
@@ -197,6 +198,83 @@ void get_leaves(const Term & term, UnorderedTermSet & leaves)
   }
 }
 
+/** One step of get_predicates
+ *  @param t the term to analyze
+ *  @param succ set to the terms to visit next
+ *  @return true iff t is a predicate
+ */
+static bool predicate_step(const SmtSolver & solver,
+                           const Sort & boolsort,
+                           const Term & t,
+                           bool include_symbols,
+                           bool search_subterms,
+                           bool split_ites,
+                           TermVec & succ)
+{
+  succ.clear();
+
+  TermVec children(t->begin(), t->end());
+  // later we will want to know which children are ITEs (if any)
+  unordered_set<size_t> ite_indices;
+  Term c;
+  for (size_t i = 0; i < children.size(); ++i) {
+    c = children[i];
+    if (c->get_op() == Ite) {
+      ite_indices.insert(i);
+    }
+  }
+
+  if (!search_subterms && t->get_sort() != boolsort) {
+    // not a candidate for predicates
+    return false;
+  }
+
+  if (t->is_value()) {
+    // values are not predicates
+    return false;
+  }
+
+  bool is_pred = false;
+  // special case for ITE children
+  // Note: we're trying to never include an ITE in a predicate
+  //       so if we get y = ite(x < 10, x+1, 0), we want to add
+  //       y = x+1 and y = 0 as the predicates instead of the
+  //       whole formula
+  if (split_ites && ite_indices.size()) {
+    vector<TermVec> options;
+    for (size_t i = 0; i < children.size(); ++i) {
+      if (ite_indices.find(i) != ite_indices.end()) {
+        TermVec ite_children(children[i]->begin(), children[i]->end());
+        assert(ite_children.size() == 3);
+        options.push_back({ ite_children[1], ite_children[2] });
+        // look for predicates in the ite condition
+        succ.push_back(ite_children[0]);
+      } else {
+        options.push_back({ children[i] });
+      }
+    }
+    assert(options.size() == children.size());
+    // generate all combinations of options
+    vector<TermVec> all_combinations = get_combinations(options);
+
+    // then rebuild for each TermVec of children
+    const Op & op = t->get_op();
+    for (auto comb : all_combinations) {
+      // construct a new term with the given combination of children
+      assert(comb.size() == children.size());
+      // add this term to the terms to check for predicates
+      succ.push_back(solver->make_term(op, comb));
+    }
+  } else if (is_predicate(t, boolsort, include_symbols)) {
+    is_pred = true;
+  }
+
+  if (!is_pred || search_subterms) {
+    succ.insert(succ.end(), children.begin(), children.end());
+  }
+  return is_pred;
+}
+
 void get_predicates(const SmtSolver & solver,
                     const Term & term,
                     UnorderedTermSet & out,
@@ -216,6 +294,7 @@ void get_predicates(const SmtSolver & solver,
 
   TermVec to_visit({ term });
   UnorderedTermSet visited;
+  TermVec succ;
 
   Term t;
   while (to_visit.size()) {
@@ -225,132 +304,184 @@ void get_predicates(const SmtSolver & solver,
 
     if (visited.find(t) == visited.end()) {
       visited.insert(t);
-
-      TermVec children(t->begin(), t->end());
-      // later we will want to know which children are ITEs (if any)
-      unordered_set<size_t> ite_indices;
-      // add children to stack
-      Term c;
-      for (size_t i = 0; i < children.size(); ++i) {
-        c = children[i];
-        if (c->get_op() == Ite) {
-          ite_indices.insert(i);
-        }
+      if (predicate_step(solver,
+                         boolsort,
+                         t,
+                         include_symbols,
+                         search_subterms,
+                         split_ites,
+                         succ)) {
+        out.insert(t);
       }
+      to_visit.insert(to_visit.end(), succ.begin(), succ.end());
+    }
+  }
+}
 
-      if (!search_subterms && t->get_sort() != boolsort) {
-        // not a candidate for predicates
-        continue;
-      }
+PredicateCollector::PredicateCollector(const SmtSolver & solver,
+                                       bool include_symbols,
+                                       bool search_subterms,
+                                       bool split_ites)
+    : solver_(solver),
+      boolsort_(solver->make_sort(BOOL)),
+      include_symbols_(include_symbols),
+      search_subterms_(search_subterms),
+      split_ites_(split_ites)
+{
+}
 
-      if (t->is_value()) {
-        // values are not predicates
-        continue;
-      }
+void PredicateCollector::get_predicates(const Term & term,
+                                        UnorderedTermSet & out)
+{
+  visited_.clear();
+  collect(term, visited_, out);
+}
 
-      bool is_pred = false;
-      // special case for ITE children
-      // Note: we're trying to never include an ITE in a predicate
-      //       so if we get y = ite(x < 10, x+1, 0), we want to add
-      //       y = x+1 and y = 0 as the predicates instead of the
-      //       whole formula
-      if (split_ites && ite_indices.size()) {
-        vector<TermVec> options;
-        for (size_t i = 0; i < children.size(); ++i) {
-          if (ite_indices.find(i) != ite_indices.end()) {
-            TermVec ite_children(children[i]->begin(), children[i]->end());
-            assert(ite_children.size() == 3);
-            options.push_back({ ite_children[1], ite_children[2] });
-            // look for predicates in the ite condition
-            to_visit.push_back(ite_children[0]);
-          } else {
-            options.push_back({ children[i] });
-          }
-        }
-        assert(options.size() == children.size());
-        // generate all combinations of options
-        vector<TermVec> all_combinations = get_combinations(options);
-
-        // then rebuild for each TermVec of children
-        const Op & op = t->get_op();
-        Term res;
-        for (auto comb : all_combinations) {
-          // construct a new term with the given combination of children
-          assert(comb.size() == children.size());
-          res = solver->make_term(op, comb);
-          // add this term to the stack of terms to check for predicates
-          to_visit.push_back(res);
-        }
-      } else if (is_predicate(t, boolsort, include_symbols)) {
-        out.insert(t);
-        is_pred = true;
-      }
+void PredicateCollector::get_new_predicates(const Term & term,
+                                            UnorderedTermSet & out)
+{
+  collect(term, seen_, out);
+}
 
-      if (!is_pred || search_subterms) {
-        to_visit.insert(to_visit.end(), children.begin(), children.end());
-      }
-    }
+const PredicateCollector::Node & PredicateCollector::node(const Term & t)
+{
+  auto it = nodes_.find(t);
+  if (it != nodes_.end()) {
+    return it->second;
   }
+  Node n;
+  n.is_pred = predicate_step(solver_,
+                             boolsort_,
+                             t,
+                             include_symbols_,
+                             search_subterms_,
+                             split_ites_,
+                             n.succ);
+  return nodes_.emplace(t, std::move(n)).first->second;
 }
 
-TermVec remove_ites_under_model(const SmtSolver & solver, const TermVec & terms)
+void PredicateCollector::collect(const Term & term,
+                                 TermHashSet & visited,
+                                 UnorderedTermSet & out)
 {
-  UnorderedTermSet visited;
-  UnorderedTermMap cache;
-
-  TermVec to_visit = terms;
-  Term solver_true = solver->make_term(true);
+  TermVec to_visit({ term });
   Term t;
   while (to_visit.size()) {
     t = to_visit.back();
+    assert(t);  // non-null term
     to_visit.pop_back();
 
-    if (visited.find(t) == visited.end()) {
-      to_visit.push_back(t);
-      visited.insert(t);
-      for (const auto & tt : t) {
-        to_visit.push_back(tt);
-      }
-    } else {
-      // post-order case
+    if (!visited.insert(t).second) {
+      continue;
+    }
+    const Node & n = node(t);
+    if (n.is_pred) {
+      out.insert(t);
+    }
+    to_visit.insert(to_visit.end(), n.succ.begin(), n.succ.end());
+  }
+}
 
-      TermVec cached_children;
-      for (const auto & tt : t) {
-        cached_children.push_back(tt);
-      }
-      Op op = t->get_op();
+TermVec remove_ites_under_model(const SmtSolver & solver, const TermVec & terms)
+{
+  ModelIteRemover remover(solver);
+  return remover.remove_ites(terms);
+}
+
+ModelIteRemover::ModelIteRemover(const SmtSolver & solver)
+    : solver_(solver), true_(solver->make_term(true)), num_evaluations_(0)
+{
+}
+
+void ModelIteRemover::new_model()
+{
+  cache_.clear();
+  values_.clear();
+  visited_.clear();
+}
+
+const Term & ModelIteRemover::condition_value(const Term & cond)
+{
+  auto it = values_.find(cond);
+  if (it != values_.end()) {
+    return it->second;
+  }
+  ++num_evaluations_;
+  return values_.emplace(cond, solver_->get_value(cond)).first->second;
+}
 
+Term ModelIteRemover::selected_branch(const Term & ite)
+{
+  auto it = ite->begin();
+  Term cond = *it;
+  ++it;
+  Term then_branch = *it;
+  ++it;
+  return condition_value(cond) == true_ ? then_branch : *it;
+}
+
+Term ModelIteRemover::remove_ites(const Term & term)
+{
+  to_visit_.clear();
+  to_visit_.push_back(term);
+  TermVec children;
+  Term t;
+  while (to_visit_.size()) {
+    t = to_visit_.back();
+
+    if (cache_.find(t) != cache_.end()) {
+      to_visit_.pop_back();
+      continue;
+    }
+
+    Op op = t->get_op();
+    if (visited_.insert(t).second) {
+      // pre-order: only the selected branch of an ITE is needed
       if (op == Ite) {
-        if (solver->get_value(cached_children[0]) == solver_true) {
-          // if case
-          cache[t] = cached_children[1];
-        } else {
-          // else case
-          cache[t] = cached_children[2];
-        }
-      } else if (cached_children.size()) {
-        // rebuild to take into account any changes
-        if (!op.is_null()) {
-          cache[t] = solver->make_term(op, cached_children);
-        } else {
-          assert(cached_children.size() == 1);  // must be a constant array
-          assert(t->get_sort()->get_sort_kind() == ARRAY);
-          cache[t] = solver->make_term(cached_children[0], t->get_sort());
-        }
+        to_visit_.push_back(selected_branch(t));
       } else {
-        // just map to itself in the cache
-        // when there's no children
-        cache[t] = t;
+        for (const auto & tt : t) {
+          to_visit_.push_back(tt);
+        }
       }
+      continue;
+    }
 
-      assert(cache.find(t) != cache.end());
+    // post-order case
+    to_visit_.pop_back();
+    if (op == Ite) {
+      Term res = cache_.at(selected_branch(t));
+      cache_.emplace(t, res);
+      continue;
+    }
+
+    children.clear();
+    bool changed = false;
+    for (const auto & tt : t) {
+      children.push_back(cache_.at(tt));
+      changed |= children.back() != tt;
+    }
+    if (!changed) {
+      // also covers the terms with no children
+      cache_.emplace(t, t);
+    } else if (!op.is_null()) {
+      // rebuild to take into account any changes
+      cache_.emplace(t, solver_->make_term(op, children));
+    } else {
+      assert(children.size() == 1);  // must be a constant array
+      assert(t->get_sort()->get_sort_kind() == ARRAY);
+      cache_.emplace(t, solver_->make_term(children[0], t->get_sort()));
     }
   }
+  return cache_.at(term);
+}
 
+TermVec ModelIteRemover::remove_ites(const TermVec & terms)
+{
   TermVec res;
   res.reserve(terms.size());
   for (const auto & tt : terms) {
-    res.push_back(cache.at(tt));
+    res.push_back(remove_ites(tt));
   }
   return res;
 }
@@ -17,6 +17,7 @@
 #pragma once
 
 #include "smt-switch/smt.h"
+#include "utils/term_hash_map.h"
 
 namespace pono {
 
@@ -70,6 +71,63 @@ void get_predicates(const smt::SmtSolver & solver,
                     bool search_subterms = false,
                     bool split_ites = false);
 
+/** get_predicates with a cache that is kept between calls
+ *  For each visited term it stores whether it is a predicate and the
+ *  terms the search continues with (its children, or the rebuilt terms
+ *  when splitting ITEs), so the terms are only analyzed once and the
+ *  ITE cases only built once. Use one collector per solver and options.
+ */
+class PredicateCollector
+{
+ public:
+  /** see get_predicates for the options */
+  PredicateCollector(const smt::SmtSolver & solver,
+                     bool include_symbols = false,
+                     bool search_subterms = false,
+                     bool split_ites = false);
+
+  /** Add all the predicates of term to out, same as get_predicates
+   *  Only the terms that were never visited are analyzed.
+   */
+  void get_predicates(const smt::Term & term, smt::UnorderedTermSet & out);
+
+  /** Add the predicates of term that no earlier call of this method
+   *  returned to out. Costs O(number of terms never seen by this method).
+   */
+  void get_new_predicates(const smt::Term & term,
+                          smt::UnorderedTermSet & out);
+
+  /** @return the number of cached terms */
+  size_t size() const { return nodes_.size(); }
+
+ protected:
+  struct Node
+  {
+    bool is_pred;
+    smt::TermVec succ;  ///< the terms to search next
+  };
+
+  /** @return the cached analysis of t (computed on a miss)
+   *  the reference is invalidated by the next call
+   */
+  const Node & node(const smt::Term & t);
+
+  /** Traverse from term, skipping and adding to visited */
+  void collect(const smt::Term & term,
+               TermHashSet & visited,
+               smt::UnorderedTermSet & out);
+
+  smt::SmtSolver solver_;
+  smt::Sort boolsort_;
+  bool include_symbols_;
+  bool search_subterms_;
+  bool split_ites_;
+
+  TermHashMap<Node> nodes_;
+  TermHashSet visited_;  ///< of the current get_predicates call
+  TermHashSet seen_;     ///< visited by get_new_predicates
+};
+
 /** Traverses the terms and replaces any ITEs with
  *  their return value under the current model
  *  @requires state of solver is SAT (no push/pop since last SAT call)
@@ -83,4 +141,49 @@ void get_predicates(const smt::SmtSolver & solver,
 smt::TermVec remove_ites_under_model(const smt::SmtSolver & solver,
                                      const smt::TermVec & terms);
 
+/** remove_ites_under_model with state kept between calls
+ *  Below an ITE only the branch selected by the model is visited, each
+ *  ITE condition is evaluated once per model and the rebuilt terms are
+ *  memoized until the next model, so calls on terms that share subterms
+ *  (e.g. the conjuncts of trans) share the work. The buffers keep their
+ *  allocation between models.
+ */
+class ModelIteRemover
+{
+ public:
+  ModelIteRemover(const smt::SmtSolver & solver);
+
+  /** Forget the values and rebuilt terms of the previous model
+   *  Must be called whenever the model changes (after each check_sat).
+   */
+  void new_model();
+
+  /** @requires state of solver is SAT
+   *  @return the term with ITEs replaced by their value under the model
+   */
+  smt::Term remove_ites(const smt::Term & term);
+
+  /** @return remove_ites of each term, in the same order */
+  smt::TermVec remove_ites(const smt::TermVec & terms);
+
+  /** @return the number of get_value calls since construction */
+  size_t num_evaluations() const { return num_evaluations_; }
+
+ protected:
+  /** @return the value of an ITE condition in the current model */
+  const smt::Term & condition_value(const smt::Term & cond);
+
+  /** @return the branch of an ITE selected by the current model */
+  smt::Term selected_branch(const smt::Term & ite);
+
+  smt::SmtSolver solver_;
+  smt::Term true_;
+
+  TermHashMap<smt::Term> cache_;   ///< rebuilt terms in the current model
+  TermHashMap<smt::Term> values_;  ///< condition values in the model
+  TermHashSet visited_;
+  smt::TermVec to_visit_;
+  size_t num_evaluations_;
+};
+
 }  // namespace pono
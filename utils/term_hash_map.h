@@ -0,0 +1,453 @@
+/*********************                                                        */
+/*! \file term_hash_map.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Flat hash set and map keyed by terms, for the hot caches of the
+**        engines in place of smt::UnorderedTermSet / UnorderedTermMap.
+**
+**        The entries live in one array with linear probing instead of
+**        one allocated node per entry. Each slot also stores the hash of
+**        its term (the node id for most backends), so probing compares
+**        integers and only calls the term equality on a hash match, and
+**        growing never hashes a term again. Up to a few entries are kept
+**        in place without allocating at all.
+**
+**/
+
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "smt-switch/smt.h"
+
+namespace pono {
+
+/** Open-addressing hash table of terms or (term, value) pairs
+ *  Use it through TermHashSet and TermHashMap.
+ *  Like the standard containers, iterators and references to entries
+ *  are invalidated by insert and erase, and iteration order is
+ *  unspecified.
+ */
+template <typename Entry>
+class TermHashTable
+{
+  static const size_t num_inline = 4;  ///< entries kept without allocating
+
+  template <bool Const>
+  class Iter
+  {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Entry value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef typename std::conditional<Const, const Entry *, Entry *>::type
+        pointer;
+    typedef typename std::conditional<Const, const Entry &, Entry &>::type
+        reference;
+
+    Iter() : entries_(nullptr), hashes_(nullptr), i_(0), n_(0) {}
+
+    Iter(pointer entries, const uint64_t * hashes, size_t i, size_t n)
+        : entries_(entries), hashes_(hashes), i_(i), n_(n)
+    {
+      skip_empty();
+    }
+
+    // iterator to const_iterator
+    template <bool C = Const, typename = typename std::enable_if<C>::type>
+    Iter(const Iter<false> & other)
+        : entries_(other.entries_),
+          hashes_(other.hashes_),
+          i_(other.i_),
+          n_(other.n_)
+    {
+    }
+
+    reference operator*() const { return entries_[i_]; }
+    pointer operator->() const { return &entries_[i_]; }
+
+    Iter & operator++()
+    {
+      ++i_;
+      skip_empty();
+      return *this;
+    }
+
+    Iter operator++(int)
+    {
+      Iter res = *this;
+      ++(*this);
+      return res;
+    }
+
+    bool operator==(const Iter & other) const
+    {
+      return entries_ + i_ == other.entries_ + other.i_;
+    }
+    bool operator!=(const Iter & other) const { return !(*this == other); }
+
+   private:
+    void skip_empty()
+    {
+      while (i_ < n_ && !hashes_[i_]) {
+        ++i_;
+      }
+    }
+
+    pointer entries_;
+    const uint64_t * hashes_;
+    size_t i_;
+    size_t n_;
+
+    friend class TermHashTable;
+    friend class Iter<true>;
+  };
+
+ public:
+  typedef Iter<false> iterator;
+  typedef Iter<true> const_iterator;
+
+  TermHashTable() : size_(0) { inline_hashes_.fill(0); }
+
+  size_t size() const { return size_; }
+  bool empty() const { return !size_; }
+
+  iterator begin() { return make_iter(0); }
+  iterator end() { return make_iter(num_slots()); }
+  const_iterator begin() const { return make_citer(0); }
+  const_iterator end() const { return make_citer(num_slots()); }
+
+  iterator find(const smt::Term & t)
+  {
+    size_t i = lookup(t, stored_hash(t));
+    return i == npos ? end() : make_iter(i);
+  }
+
+  const_iterator find(const smt::Term & t) const
+  {
+    size_t i = lookup(t, stored_hash(t));
+    return i == npos ? end() : make_citer(i);
+  }
+
+  size_t count(const smt::Term & t) const
+  {
+    return lookup(t, stored_hash(t)) != npos;
+  }
+
+  /** @return the entry of its term and true if it was inserted, or the
+   *          existing entry and false
+   */
+  std::pair<iterator, bool> insert(const Entry & e)
+  {
+    return insert_entry(Entry(e));
+  }
+
+  std::pair<iterator, bool> insert(Entry && e)
+  {
+    return insert_entry(std::move(e));
+  }
+
+  /** @return the number of erased entries (0 or 1) */
+  size_t erase(const smt::Term & t)
+  {
+    uint64_t h = stored_hash(t);
+    size_t i = lookup(t, h);
+    if (i == npos) {
+      return 0;
+    }
+    erase_slot(i);
+    return 1;
+  }
+
+  /** Remove all entries, keeps the allocated slots */
+  void clear()
+  {
+    for (size_t i = 0; i < num_slots(); ++i) {
+      if (hashes()[i]) {
+        hashes()[i] = 0;
+        entries()[i] = Entry();
+      }
+    }
+    size_ = 0;
+  }
+
+  /** Allocate the slots for n entries */
+  void reserve(size_t n)
+  {
+    if (n > num_inline && n > max_load(heap_hashes_.size())) {
+      size_t cap = 16;
+      while (max_load(cap) < n) {
+        cap *= 2;
+      }
+      rehash(cap);
+    }
+  }
+
+  void swap(TermHashTable & other)
+  {
+    std::swap(inline_entries_, other.inline_entries_);
+    std::swap(inline_hashes_, other.inline_hashes_);
+    heap_entries_.swap(other.heap_entries_);
+    heap_hashes_.swap(other.heap_hashes_);
+    std::swap(size_, other.size_);
+  }
+
+  /** @return the bytes used by the table, not counting the terms */
+  size_t memory() const
+  {
+    return sizeof(*this)
+           + heap_hashes_.capacity() * (sizeof(Entry) + sizeof(uint64_t));
+  }
+
+ protected:
+  static const size_t npos = size_t(-1);
+
+  static const smt::Term & key_of(const smt::Term & e) { return e; }
+
+  template <typename V>
+  static const smt::Term & key_of(const std::pair<smt::Term, V> & e)
+  {
+    return e.first;
+  }
+
+  /** @return a mix of the term hash, never 0 which marks empty slots */
+  static uint64_t stored_hash(const smt::Term & t)
+  {
+    uint64_t h = t->hash();
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h | 1;
+  }
+
+  // at most 3/4 of the slots are used
+  static size_t max_load(size_t cap) { return cap - cap / 4; }
+
+  bool on_heap() const { return !heap_hashes_.empty(); }
+
+  size_t num_slots() const
+  {
+    return on_heap() ? heap_hashes_.size() : num_inline;
+  }
+
+  Entry * entries()
+  {
+    return on_heap() ? heap_entries_.data() : inline_entries_.data();
+  }
+
+  const Entry * entries() const
+  {
+    return on_heap() ? heap_entries_.data() : inline_entries_.data();
+  }
+
+  uint64_t * hashes()
+  {
+    return on_heap() ? heap_hashes_.data() : inline_hashes_.data();
+  }
+
+  const uint64_t * hashes() const
+  {
+    return on_heap() ? heap_hashes_.data() : inline_hashes_.data();
+  }
+
+  iterator make_iter(size_t i)
+  {
+    return iterator(entries(), hashes(), i, num_slots());
+  }
+
+  const_iterator make_citer(size_t i) const
+  {
+    return const_iterator(entries(), hashes(), i, num_slots());
+  }
+
+  size_t home(uint64_t h) const { return (h >> 1) & (heap_hashes_.size() - 1); }
+
+  /** @return the slot of t or npos */
+  size_t lookup(const smt::Term & t, uint64_t h) const
+  {
+    if (!on_heap()) {
+      // inline entries are dense
+      for (size_t i = 0; i < size_; ++i) {
+        if (inline_hashes_[i] == h && key_of(inline_entries_[i]) == t) {
+          return i;
+        }
+      }
+      return npos;
+    }
+
+    size_t mask = heap_hashes_.size() - 1;
+    for (size_t i = home(h); heap_hashes_[i]; i = (i + 1) & mask) {
+      if (heap_hashes_[i] == h && key_of(heap_entries_[i]) == t) {
+        return i;
+      }
+    }
+    return npos;
+  }
+
+  std::pair<iterator, bool> insert_entry(Entry && e)
+  {
+    const smt::Term & t = key_of(e);
+    uint64_t h = stored_hash(t);
+    size_t i = lookup(t, h);
+    if (i != npos) {
+      return { make_iter(i), false };
+    }
+
+    if (!on_heap() && size_ < num_inline) {
+      i = size_;
+      inline_hashes_[i] = h;
+      inline_entries_[i] = std::move(e);
+    } else {
+      if (size_ + 1 > max_load(heap_hashes_.size())) {
+        rehash(on_heap() ? 2 * heap_hashes_.size() : 16);
+      }
+      i = place(h, std::move(e));
+    }
+    ++size_;
+    return { make_iter(i), true };
+  }
+
+  /** Put an entry that is not in the table into a free heap slot */
+  size_t place(uint64_t h, Entry && e)
+  {
+    size_t mask = heap_hashes_.size() - 1;
+    size_t i = home(h);
+    while (heap_hashes_[i]) {
+      i = (i + 1) & mask;
+    }
+    heap_hashes_[i] = h;
+    heap_entries_[i] = std::move(e);
+    return i;
+  }
+
+  /** Move all entries to cap heap slots, cap is a power of 2 */
+  void rehash(size_t cap)
+  {
+    assert(cap && !(cap & (cap - 1)));
+    assert(max_load(cap) >= size_);
+    std::vector<Entry> old_entries(cap);
+    std::vector<uint64_t> old_hashes(cap, 0);
+    bool was_on_heap = on_heap();
+    old_entries.swap(heap_entries_);
+    old_hashes.swap(heap_hashes_);
+
+    if (was_on_heap) {
+      for (size_t i = 0; i < old_hashes.size(); ++i) {
+        if (old_hashes[i]) {
+          place(old_hashes[i], std::move(old_entries[i]));
+        }
+      }
+    } else {
+      for (size_t i = 0; i < size_; ++i) {
+        place(inline_hashes_[i], std::move(inline_entries_[i]));
+        inline_hashes_[i] = 0;
+        inline_entries_[i] = Entry();
+      }
+    }
+  }
+
+  void erase_slot(size_t i)
+  {
+    --size_;
+    if (!on_heap()) {
+      // keep the inline entries dense
+      if (i != size_) {
+        inline_entries_[i] = std::move(inline_entries_[size_]);
+        inline_hashes_[i] = inline_hashes_[size_];
+      }
+      inline_hashes_[size_] = 0;
+      inline_entries_[size_] = Entry();
+      return;
+    }
+
+    // shift back the following entries of the probe sequence, so that
+    // lookups never need tombstones
+    size_t mask = heap_hashes_.size() - 1;
+    size_t j = i;
+    while (true) {
+      j = (j + 1) & mask;
+      if (!heap_hashes_[j]) {
+        break;
+      }
+      size_t k = home(heap_hashes_[j]);
+      // move j to i unless its home is cyclically in (i, j]
+      bool stays = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+      if (!stays) {
+        heap_hashes_[i] = heap_hashes_[j];
+        heap_entries_[i] = std::move(heap_entries_[j]);
+        i = j;
+      }
+    }
+    heap_hashes_[i] = 0;
+    heap_entries_[i] = Entry();
+  }
+
+  std::array<Entry, num_inline> inline_entries_;
+  std::array<uint64_t, num_inline> inline_hashes_;
+  std::vector<Entry> heap_entries_;  ///< empty while the entries fit inline
+  std::vector<uint64_t> heap_hashes_;  ///< 0 for empty slots
+  size_t size_;
+};
+
+/** Flat replacement for smt::UnorderedTermSet */
+typedef TermHashTable<smt::Term> TermHashSet;
+
+/** Flat replacement for smt::UnorderedTermMap and other maps from terms */
+template <typename V>
+class TermHashMap : public TermHashTable<std::pair<smt::Term, V>>
+{
+  typedef TermHashTable<std::pair<smt::Term, V>> super;
+
+ public:
+  typedef typename super::iterator iterator;
+  typedef typename super::const_iterator const_iterator;
+
+  std::pair<iterator, bool> emplace(const smt::Term & t, const V & v)
+  {
+    return super::insert(std::make_pair(t, v));
+  }
+
+  V & operator[](const smt::Term & t)
+  {
+    auto it = super::find(t);
+    if (it != super::end()) {
+      return it->second;
+    }
+    return super::insert(std::make_pair(t, V())).first->second;
+  }
+
+  V & at(const smt::Term & t)
+  {
+    auto it = super::find(t);
+    if (it == super::end()) {
+      throw std::out_of_range("TermHashMap::at");
+    }
+    return it->second;
+  }
+
+  const V & at(const smt::Term & t) const
+  {
+    auto it = super::find(t);
+    if (it == super::end()) {
+      throw std::out_of_range("TermHashMap::at");
+    }
+    return it->second;
+  }
+};
+
+}  // namespace pono
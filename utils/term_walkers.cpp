@@ -16,7 +16,11 @@
 
 #include "utils/term_walkers.h"
 
+#include <algorithm>
+#include <string>
+
 #include "assert.h"
+#include "utils/concrete_simulator.h"
 #include "utils/term_analysis.h"
 
 using namespace smt;
@@ -32,41 +36,69 @@ namespace pono {
 void TermOpCollector::find_matching_terms(
     Term t, const unordered_set<PrimOp> & prim_ops, UnorderedTermSet & out)
 {
-  // set the pointers for use in visit/visit_term
-  prim_ops_ = &prim_ops;
-  out_ = &out;
-
-  // visit all the subterms and collect them in out
-  // see visit_term below
-  visit(t);
-
-  // set the pointers back to null
-  // better to be null than stale
-  prim_ops_ = nullptr;
-  out_ = nullptr;
+  visited_.clear();
+  collect(t, prim_ops, visited_, out);
 }
 
-WalkerStepResult TermOpCollector::visit_term(smt::Term & term)
+void TermOpCollector::add_matching_terms(
+    Term t, const unordered_set<PrimOp> & prim_ops, UnorderedTermSet & out)
 {
-  // pointers should be non-null
-  assert(prim_ops_);
-  assert(out_);
+  collect(t, prim_ops, seen_, out);
+}
 
-  if (preorder_) {
-    Op op = term->get_op();
-    if (prim_ops_->find(op.prim_op) != prim_ops_->end()) {
-      out_->insert(term);
+void TermOpCollector::collect(Term t,
+                              const unordered_set<PrimOp> & prim_ops,
+                              TermHashSet & visited,
+                              UnorderedTermSet & out)
+{
+  // visit all the subterms once and collect the matching ones in out
+  TermVec to_visit({ t });
+  while (to_visit.size()) {
+    Term cur = to_visit.back();
+    to_visit.pop_back();
+    if (!visited.insert(cur).second) {
+      continue;
+    }
+
+    Op op = cur->get_op();
+    if (prim_ops.find(op.prim_op) != prim_ops.end()) {
+      out.insert(cur);
+    }
+    for (const auto & c : cur) {
+      to_visit.push_back(c);
     }
   }
+}
 
-  return Walker_Continue;
+size_t TermOpCollector::add_op_counts(Term t,
+                                      unordered_map<PrimOp, size_t> & counts)
+{
+  size_t num_new = 0;
+  TermVec to_visit({ t });
+  while (to_visit.size()) {
+    Term cur = to_visit.back();
+    to_visit.pop_back();
+    if (!seen_.insert(cur).second) {
+      continue;
+    }
+
+    ++num_new;
+    Op op = cur->get_op();
+    if (!op.is_null()) {
+      ++counts[op.prim_op];
+    }
+    for (const auto & c : cur) {
+      to_visit.push_back(c);
+    }
+  }
+  return num_new;
 }
 
 SubTermCollector::SubTermCollector(const smt::SmtSolver & solver,
                                    bool exclude_bools,
                                    bool exclude_funs,
                                    bool exclute_ites)
-    : super(solver, true),
+    : super(solver, false),
       exclude_bools_(exclude_bools),
       exclude_funs_(exclude_funs),
       exclude_ites_(exclute_ites),
@@ -123,4 +155,277 @@ WalkerStepResult SubTermCollector::visit_term(smt::Term & term)
   return Walker_Continue;
 }
 
+TermSimplifier::TermSimplifier(const SmtSolver & solver,
+                               const UnorderedTermMap & subst)
+    // keep the cache to share it between calls to simplify
+    : super(solver, false),
+      true_(solver->make_term(true)),
+      false_(solver->make_term(false))
+{
+  for (const auto & elem : subst) {
+    save_in_cache(elem.first, elem.second);
+  }
+}
+
+Term TermSimplifier::simplify(const Term & t)
+{
+  Term tt = t;
+  return visit(tt);
+}
+
+WalkerStepResult TermSimplifier::visit_term(Term & term)
+{
+  if (preorder_ || in_cache(term)) {
+    return Walker_Continue;
+  }
+
+  Op op = term->get_op();
+  if (op.is_null()) {
+    save_in_cache(term, term);
+    return Walker_Continue;
+  }
+
+  TermVec children;
+  Term cc;
+  for (auto c : term) {
+    bool ok = query_cache(c, cc);
+    assert(ok);  // in post-order so should always have a cache hit
+    children.push_back(cc);
+  }
+  save_in_cache(term, rebuild(op, children));
+  return Walker_Continue;
+}
+
+// width of a bit-vector term
+static uint64_t bv_width(const Term & t) { return t->get_sort()->get_width(); }
+
+Term TermSimplifier::rebuild(const Op & op, const TermVec & children)
+{
+  TermVec ch = children;
+  const size_t n = ch.size();
+  Sort sort = n ? ch[0]->get_sort() : Sort();
+  auto is_val = [this](const Term & t, int64_t v) {
+    return t->is_value() && t->get_sort()->get_sort_kind() == BV
+           && t == solver_->make_term(v, t->get_sort());
+  };
+  auto is_ones = [this](const Term & t) {
+    return t->is_value() && t->get_sort()->get_sort_kind() == BV
+           && t
+                  == solver_->make_term(
+                      std::string(t->get_sort()->get_width(), '1'),
+                      t->get_sort(),
+                      2);
+  };
+
+  switch (op.prim_op) {
+    case Not: {
+      if (ch[0]->get_op() == Not) {
+        return *ch[0]->begin();
+      }
+      break;
+    }
+    case And:
+    case Or: {
+      // absorbing and neutral elements
+      const Term & absorb = op == And ? false_ : true_;
+      const Term & neutral = op == And ? true_ : false_;
+      TermVec kept;
+      for (const auto & c : ch) {
+        if (c == absorb) {
+          return absorb;
+        } else if (c != neutral
+                   && std::find(kept.begin(), kept.end(), c) == kept.end()) {
+          kept.push_back(c);
+        }
+      }
+      if (kept.empty()) {
+        return neutral;
+      } else if (kept.size() == 1) {
+        return kept[0];
+      }
+      ch = kept;
+      break;
+    }
+    case Implies: {
+      if (ch[0] == true_) {
+        return ch[1];
+      } else if (ch[0] == false_ || ch[1] == true_ || ch[0] == ch[1]) {
+        return true_;
+      } else if (ch[1] == false_) {
+        return rebuild(Op(Not), { ch[0] });
+      }
+      break;
+    }
+    case Ite: {
+      if (ch[0] == true_) {
+        return ch[1];
+      } else if (ch[0] == false_ || ch[1] == ch[2]) {
+        return ch[2];
+      } else if (ch[1] == true_ && ch[2] == false_) {
+        return ch[0];
+      } else if (ch[1] == false_ && ch[2] == true_) {
+        return rebuild(Op(Not), { ch[0] });
+      } else if (ch[0]->get_op() == Not) {
+        return rebuild(op, { *ch[0]->begin(), ch[2], ch[1] });
+      }
+      break;
+    }
+    case Equal: {
+      if (ch[0] == ch[1]) {
+        return true_;
+      } else if (sort->get_sort_kind() == BOOL) {
+        for (size_t i = 0; i < 2; ++i) {
+          if (ch[i] == true_) {
+            return ch[1 - i];
+          } else if (ch[i] == false_) {
+            return rebuild(Op(Not), { ch[1 - i] });
+          }
+        }
+      }
+      break;
+    }
+    case Distinct: {
+      if (n == 2 && ch[0] == ch[1]) {
+        return false_;
+      }
+      break;
+    }
+    case Extract: {
+      return rebuild_indexed(op, ch[0]);
+    }
+    case Zero_Extend:
+    case Sign_Extend: {
+      if (!op.idx0) {
+        return ch[0];
+      } else if (ch[0]->get_op() == op.prim_op) {
+        // nested extensions of the same kind
+        Op inner = ch[0]->get_op();
+        return rebuild(Op(op.prim_op, op.idx0 + inner.idx0),
+                       { *ch[0]->begin() });
+      }
+      break;
+    }
+    case Concat: {
+      if (n != 2) {
+        break;
+      }
+      Op a = ch[0]->get_op();
+      Op b = ch[1]->get_op();
+      if (a == Extract && b == Extract && a.idx1 == b.idx0 + 1
+          && *ch[0]->begin() == *ch[1]->begin()) {
+        // adjacent slices of the same term
+        return rebuild_indexed(Op(Extract, a.idx0, b.idx1), *ch[0]->begin());
+      } else if (is_val(ch[0], 0)) {
+        return rebuild(Op(Zero_Extend, bv_width(ch[0])), { ch[1] });
+      }
+      break;
+    }
+    case BVAnd:
+    case BVOr: {
+      if (n != 2) {
+        break;
+      }
+      for (size_t i = 0; i < 2; ++i) {
+        bool zero = is_val(ch[i], 0);
+        bool ones = !zero && is_ones(ch[i]);
+        if ((op == BVAnd && zero) || (op == BVOr && ones)) {
+          return ch[i];
+        } else if ((op == BVAnd && ones) || (op == BVOr && zero)) {
+          return ch[1 - i];
+        }
+      }
+      if (ch[0] == ch[1]) {
+        return ch[0];
+      }
+      break;
+    }
+    case BVXor:
+    case BVAdd: {
+      if (n != 2) {
+        break;
+      }
+      if (op == BVXor && ch[0] == ch[1]) {
+        return solver_->make_term(0, sort);
+      }
+      for (size_t i = 0; i < 2; ++i) {
+        if (is_val(ch[i], 0)) {
+          return ch[1 - i];
+        }
+      }
+      break;
+    }
+    case BVSub: {
+      if (ch[0] == ch[1]) {
+        return solver_->make_term(0, sort);
+      } else if (is_val(ch[1], 0)) {
+        return ch[0];
+      }
+      break;
+    }
+    case BVMul: {
+      if (n != 2) {
+        break;
+      }
+      for (size_t i = 0; i < 2; ++i) {
+        if (is_val(ch[i], 0)) {
+          return ch[i];
+        } else if (is_val(ch[i], 1)) {
+          return ch[1 - i];
+        }
+      }
+      break;
+    }
+    case BVShl:
+    case BVLshr:
+    case BVAshr: {
+      if (is_val(ch[1], 0)) {
+        return ch[0];
+      }
+      break;
+    }
+    default: break;
+  }
+
+  Term t = solver_->make_term(op, ch);
+  Term v = sim_evaluate(solver_, t);
+  return v ? v : t;
+}
+
+Term TermSimplifier::rebuild_indexed(const Op & op, const Term & x)
+{
+  assert(op == Extract);
+  const uint64_t hi = op.idx0;
+  const uint64_t lo = op.idx1;
+  if (lo == 0 && hi + 1 == bv_width(x)) {
+    return x;
+  }
+
+  Op xop = x->get_op();
+  TermVec xch;
+  for (auto c : x) {
+    xch.push_back(c);
+  }
+  if (xop == Concat && xch.size() == 2) {
+    uint64_t wb = bv_width(xch[1]);
+    if (hi < wb) {
+      return rebuild_indexed(op, xch[1]);
+    } else if (lo >= wb) {
+      return rebuild_indexed(Op(Extract, hi - wb, lo - wb), xch[0]);
+    }
+  } else if (xop == Extract) {
+    return rebuild_indexed(Op(Extract, hi + xop.idx1, lo + xop.idx1), xch[0]);
+  } else if (xop == Zero_Extend || xop == Sign_Extend) {
+    uint64_t wy = bv_width(xch[0]);
+    if (hi < wy) {
+      return rebuild_indexed(op, xch[0]);
+    } else if (xop == Zero_Extend && lo >= wy) {
+      return solver_->make_term(0, solver_->make_sort(BV, hi - lo + 1));
+    }
+  }
+
+  Term t = solver_->make_term(op, x);
+  Term v = sim_evaluate(solver_, t);
+  return v ? v : t;
+}
+
 }  // namespace pono
@@ -17,23 +17,19 @@
 
 #include "smt-switch/identity_walker.h"
 #include "smt-switch/smt.h"
+#include "utils/term_hash_map.h"
 
 namespace pono {
 
 /** Class for finding terms matching a given set of PrimOps
- *  uses protected inheritance because visit should not be
- *  called outside of this class (relies on the pointers
- *  being set)
+ *  Traverses the terms directly with a flat visited set rather than
+ *  through an IdentityWalker, which would also build a substitution
+ *  cache for every subterm.
  */
-class TermOpCollector : protected smt::IdentityWalker
+class TermOpCollector
 {
  public:
-  TermOpCollector(const smt::SmtSolver & solver)
-      // enable cache clearing because we want to traverse the whole
-      // formula each time when looking for terms
-      : smt::IdentityWalker(solver, true)
-  {
-  }
+  TermOpCollector(const smt::SmtSolver & solver) : solver_(solver) {}
 
   /** Populates out with sub-terms of t that match one of the
    *  PrimOps in prim_ops
@@ -45,15 +41,40 @@ class TermOpCollector : protected smt::IdentityWalker
                            const std::unordered_set<smt::PrimOp> & prim_ops,
                            smt::UnorderedTermSet & out);
 
- protected:
-  smt::WalkerStepResult visit_term(smt::Term & term) override;
+  /** Like find_matching_terms, but skips the subterms visited by earlier
+   *  calls of this method, so collecting from many terms that share
+   *  subterms (e.g. all the state updates) visits each subterm once
+   *  @requires the same prim_ops and out in every call
+   */
+  void add_matching_terms(smt::Term t,
+                          const std::unordered_set<smt::PrimOp> & prim_ops,
+                          smt::UnorderedTermSet & out);
+
+  /** Counts the operators of the subterms of t not visited by earlier
+   *  calls of this method (or of add_matching_terms)
+   *  @param t the term to traverse
+   *  @param counts incremented for the PrimOp of each new operator node
+   *  @return the number of new subterms, including symbols and values
+   */
+  size_t add_op_counts(smt::Term t,
+                       std::unordered_map<smt::PrimOp, size_t> & counts);
 
-  const std::unordered_set<smt::PrimOp> * prim_ops_ = nullptr;
-  smt::UnorderedTermSet * out_ = nullptr;
+ protected:
+  /** Traverse from t, skipping and adding to visited */
+  void collect(smt::Term t,
+               const std::unordered_set<smt::PrimOp> & prim_ops,
+               TermHashSet & visited,
+               smt::UnorderedTermSet & out);
+
+  smt::SmtSolver solver_;
+  TermHashSet visited_;  ///< cleared on each call, keeps its slots
+  TermHashSet seen_;     ///< visited by add_matching_terms
 };
 
 /** Class for collecting all subterms and grouping by sort
  *  It will also store predicates separately from all the other terms
+ *  The walker cache is kept between calls, so terms that were already
+ *  collected are not visited again.
  */
 class SubTermCollector : public smt::IdentityWalker
 {
@@ -74,6 +95,15 @@ class SubTermCollector : public smt::IdentityWalker
 
   const smt::UnorderedTermSet & get_predicates() const { return predicates_; }
 
+  /** Clear the collected terms, but not the cache. Then the next calls
+   *  of collect_subterms only collect the terms never seen before.
+   */
+  void clear_collected()
+  {
+    subterms_.clear();
+    predicates_.clear();
+  }
+
  protected:
   bool exclude_bools_;  ///< if true, don't include boolean terms in subterms
                         ///<  (although predicates are still kept separately in
@@ -92,4 +122,41 @@ class SubTermCollector : public smt::IdentityWalker
   smt::WalkerStepResult visit_term(smt::Term & term) override;
 };
 
+/** Class for word-level constant propagation and structural simplification
+ *  Folds operators over values (for booleans and bit-vectors of width at
+ *  most 64) and rewrites common patterns, e.g. ITEs with a constant
+ *  condition, extracts of concats and nested zero-extends.
+ *  The cache is kept between calls, so simplifying many terms over the
+ *  same subterms, e.g. all the state updates of a system, shares the work.
+ */
+class TermSimplifier : public smt::IdentityWalker
+{
+ public:
+  /** @param solver the solver of the terms
+   *  @param subst symbols to replace with their values before simplifying
+   */
+  TermSimplifier(const smt::SmtSolver & solver,
+                 const smt::UnorderedTermMap & subst = {});
+
+  typedef smt::IdentityWalker super;
+
+  /** @return the simplified term */
+  smt::Term simplify(const smt::Term & t);
+
+ protected:
+  smt::WalkerStepResult visit_term(smt::Term & term) override;
+
+  /** @return a simplification of the term op(children)
+   *  @param op the operator
+   *  @param children the (simplified) children
+   */
+  smt::Term rebuild(const smt::Op & op, const smt::TermVec & children);
+
+  /** @return a simplification of a one-argument indexed operator */
+  smt::Term rebuild_indexed(const smt::Op & op, const smt::Term & x);
+
+  smt::Term true_;
+  smt::Term false_;
+};
+
 }  // namespace pono
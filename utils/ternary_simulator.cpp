@@ -0,0 +1,456 @@
+/*********************                                                        */
+/*! \file ternary_simulator.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Ternary (0/1/X) simulation of the state updates of a functional
+**        transition system. Used to lift predecessor cubes without
+**        calling a solver.
+**
+**/
+
+#include "utils/ternary_simulator.h"
+
+#include <stdexcept>
+#include <string>
+
+#include "assert.h"
+#include "smt-switch/utils.h"
+#include "utils/exceptions.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+static uint64_t mask(uint32_t w)
+{
+  return w >= 64 ? ~uint64_t(0) : (uint64_t(1) << w) - 1;
+}
+
+/** @return the width of a boolean (1) or bit-vector term, 0 otherwise */
+static uint32_t width_of(const Term & t)
+{
+  Sort sort = t->get_sort();
+  SortKind sk = sort->get_sort_kind();
+  if (sk == BOOL) {
+    return 1;
+  } else if (sk == BV) {
+    return sort->get_width();
+  }
+  return 0;
+}
+
+static TernaryValue unknown(uint32_t w) { return TernaryValue(w, 0, 0); }
+
+static TernaryValue concrete(uint32_t w, uint64_t v)
+{
+  if (!w || w > 64) {
+    return unknown(w);
+  }
+  return TernaryValue(w, v & mask(w), mask(w));
+}
+
+static int64_t to_signed(uint64_t v, uint32_t w)
+{
+  if (w < 64 && (v >> (w - 1)) & 1) {
+    v |= ~mask(w);
+  }
+  return static_cast<int64_t>(v);
+}
+
+/** The value of a boolean or bit-vector value term of width at most 64
+ *  @return unknown if it could not be read
+ */
+static TernaryValue value_of(const Term & value)
+{
+  assert(value->is_value());
+  uint32_t w = width_of(value);
+  string s = value->to_string();
+  if (value->get_sort()->get_sort_kind() == BOOL) {
+    return concrete(1, s == "true");
+  } else if (!w || w > 64) {
+    return unknown(w);
+  }
+
+  // printed either as #b0101 or (_ bv5 4)
+  try {
+    if (s.rfind("#b", 0) == 0) {
+      return concrete(w, stoull(s.substr(2), nullptr, 2));
+    } else if (s.rfind("(_ bv", 0) == 0) {
+      return concrete(w, stoull(s.substr(5)));
+    }
+  }
+  catch (std::logic_error & e) {
+    // fall through
+  }
+  return unknown(w);
+}
+
+bool TernaryValue::is_known() const
+{
+  return width && width <= 64 && known == mask(width);
+}
+
+TernarySimulator::TernarySimulator(const TransitionSystem & ts) : ts_(ts)
+{
+  if (!ts_.is_functional()) {
+    throw PonoException(
+        "TernarySimulator requires a functional transition system");
+  }
+}
+
+void TernarySimulator::set_value(const Term & var, const Term & value)
+{
+  assert(var->is_symbolic_const());
+  assert(value->is_value());
+
+  assignment_[var] = value_of(value);
+}
+
+void TernarySimulator::set_bit(const Term & var, size_t i, bool value)
+{
+  auto it = assignment_.find(var);
+  if (it == assignment_.end()) {
+    it = assignment_.insert({ var, unknown(width_of(var)) }).first;
+  }
+  TernaryValue & v = it->second;
+  if (i >= v.width || i >= 64) {
+    return;
+  }
+  uint64_t bit = uint64_t(1) << i;
+  v.known |= bit;
+  v.val = value ? (v.val | bit) : (v.val & ~bit);
+}
+
+void TernarySimulator::set_unknown(const Term & var, size_t i)
+{
+  auto it = assignment_.find(var);
+  if (it == assignment_.end() || i >= 64) {
+    return;
+  }
+  uint64_t bit = uint64_t(1) << i;
+  it->second.known &= ~bit;
+  it->second.val &= ~bit;
+}
+
+TernaryValue TernarySimulator::eval(const Term & t) const
+{
+  ValueMap cache;
+  return eval(t, assignment_, cache);
+}
+
+std::vector<TernaryValue> TernarySimulator::eval(const TermVec & terms) const
+{
+  ValueMap cache;
+  std::vector<TernaryValue> res;
+  res.reserve(terms.size());
+  for (const auto & t : terms) {
+    res.push_back(eval(t, assignment_, cache));
+  }
+  return res;
+}
+
+TernaryValue TernarySimulator::eval_next(const Term & t) const
+{
+  // the updates share subterms, evaluate them with one cache
+  ValueMap cache;
+  ValueMap next;
+  const UnorderedTermMap & updates = ts_.state_updates();
+  UnorderedTermSet vars;
+  get_free_symbolic_consts(t, vars);
+  for (const auto & v : vars) {
+    if (!ts_.is_curr_var(v)) {
+      continue;
+    }
+    auto it = updates.find(v);
+    next[v] = (it == updates.end()) ? unknown(width_of(v))
+                                    : eval(it->second, assignment_, cache);
+  }
+
+  ValueMap next_cache;
+  return eval(t, next, next_cache);
+}
+
+TernaryValue TernarySimulator::eval(const Term & t,
+                                    const ValueMap & env,
+                                    ValueMap & cache) const
+{
+  // post-order traversal, the updates can be deep
+  vector<pair<Term, bool>> to_visit({ { t, false } });
+  vector<TernaryValue> args;
+  while (to_visit.size()) {
+    auto [cur, visited] = to_visit.back();
+    to_visit.pop_back();
+
+    if (cache.find(cur) != cache.end()) {
+      continue;
+    }
+
+    if (cur->get_op().is_null()) {
+      // a leaf
+      auto it = env.find(cur);
+      if (it != env.end()) {
+        cache[cur] = it->second;
+      } else if (cur->is_value()) {
+        cache[cur] = value_of(cur);
+      } else {
+        cache[cur] = unknown(width_of(cur));
+      }
+    } else if (!visited) {
+      to_visit.push_back({ cur, true });
+      for (const auto & c : *cur) {
+        if (cache.find(c) == cache.end()) {
+          to_visit.push_back({ c, false });
+        }
+      }
+    } else {
+      args.clear();
+      for (const auto & c : *cur) {
+        args.push_back(cache.at(c));
+      }
+      cache[cur] = apply(cur, args);
+    }
+  }
+  return cache.at(t);
+}
+
+TernaryValue TernarySimulator::apply(const Term & t,
+                                     const vector<TernaryValue> & args) const
+{
+  const Op op = t->get_op();
+  const uint32_t w = width_of(t);
+  if (!w || w > 64 || !args.size()) {
+    return unknown(w);
+  }
+  for (const auto & a : args) {
+    if (!a.width || a.width > 64) {
+      // no precision for wide arguments
+      return unknown(w);
+    }
+  }
+
+  const uint64_t m = mask(w);
+  const TernaryValue & a = args[0];
+  // known ones and known zeros
+  auto ones = [](const TernaryValue & x) { return x.known & x.val; };
+  auto zeros = [](const TernaryValue & x) { return x.known & ~x.val; };
+
+  switch (op.prim_op) {
+    case Not:
+    case BVNot: return TernaryValue(w, ~a.val & m, a.known);
+    case And:
+    case BVAnd:
+    case BVNand: {
+      uint64_t k1 = ones(a), k0 = zeros(a);
+      for (size_t i = 1; i < args.size(); ++i) {
+        k1 &= ones(args[i]);
+        k0 |= zeros(args[i]);
+      }
+      if (op.prim_op == BVNand) {
+        std::swap(k0, k1);
+      }
+      return TernaryValue(w, k1, (k0 | k1) & m);
+    }
+    case Or:
+    case BVOr:
+    case BVNor: {
+      uint64_t k1 = ones(a), k0 = zeros(a);
+      for (size_t i = 1; i < args.size(); ++i) {
+        k1 |= ones(args[i]);
+        k0 &= zeros(args[i]);
+      }
+      if (op.prim_op == BVNor) {
+        std::swap(k0, k1);
+      }
+      return TernaryValue(w, k1, (k0 | k1) & m);
+    }
+    case Xor:
+    case BVXor:
+    case BVXnor: {
+      uint64_t v = a.val, k = a.known;
+      for (size_t i = 1; i < args.size(); ++i) {
+        v ^= args[i].val;
+        k &= args[i].known;
+      }
+      if (op.prim_op == BVXnor) {
+        v = ~v;
+      }
+      return TernaryValue(w, v, k & m);
+    }
+    case Implies: {
+      assert(args.size() == 2);
+      const TernaryValue & b = args[1];
+      if (a.is_false() || b.is_true()) {
+        return concrete(1, 1);
+      } else if (a.is_true() && b.is_false()) {
+        return concrete(1, 0);
+      }
+      return unknown(1);
+    }
+    case Ite: {
+      assert(args.size() == 3);
+      const TernaryValue & b = args[1];
+      const TernaryValue & c = args[2];
+      if (ones(a) & 1) {
+        return b;
+      } else if (zeros(a) & 1) {
+        return c;
+      }
+      // known where both branches agree
+      uint64_t k = b.known & c.known & ~(b.val ^ c.val);
+      return TernaryValue(w, b.val, k);
+    }
+    case Equal:
+    case Distinct:
+    case BVComp: {
+      assert(args.size() >= 2);
+      bool all_known = a.is_known();
+      bool differ = false;
+      for (size_t i = 1; i < args.size(); ++i) {
+        const TernaryValue & b = args[i];
+        all_known &= b.is_known();
+        differ |= ((a.val ^ b.val) & a.known & b.known) != 0;
+      }
+      if (op.prim_op == Distinct && args.size() != 2) {
+        return unknown(1);
+      }
+      bool eq;
+      if (differ) {
+        eq = false;
+      } else if (all_known) {
+        eq = true;
+      } else {
+        return unknown(w);
+      }
+      return concrete(w, op.prim_op == Distinct ? !eq : eq);
+    }
+    case Concat: {
+      uint64_t v = a.val, k = a.known;
+      for (size_t i = 1; i < args.size(); ++i) {
+        uint32_t bw = args[i].width;
+        v = (v << bw) | args[i].val;
+        k = (k << bw) | args[i].known;
+      }
+      return TernaryValue(w, v & m, k & m);
+    }
+    case Extract: {
+      // idx0 is the high bit, idx1 the low bit
+      uint32_t lo = op.idx1;
+      return TernaryValue(w, (a.val >> lo) & m, (a.known >> lo) & m);
+    }
+    case Zero_Extend:
+      return TernaryValue(w, a.val, a.known | (m & ~mask(a.width)));
+    case Sign_Extend: {
+      uint64_t sign = uint64_t(1) << (a.width - 1);
+      uint64_t ext = m & ~mask(a.width);
+      uint64_t k = a.known | ((a.known & sign) ? ext : 0);
+      uint64_t v = a.val | ((a.val & sign) ? ext : 0);
+      return TernaryValue(w, v, k);
+    }
+    case Repeat: {
+      uint64_t v = 0, k = 0;
+      for (uint32_t i = 0; i < w / a.width; ++i) {
+        v = (v << a.width) | a.val;
+        k = (k << a.width) | a.known;
+      }
+      return TernaryValue(w, v, k);
+    }
+    case Rotate_Left:
+    case Rotate_Right: {
+      uint32_t n = op.idx0 % w;
+      if (op.prim_op == Rotate_Right) {
+        n = (w - n) % w;
+      }
+      auto rotl = [&](uint64_t x) {
+        return n ? ((x << n) | (x >> (w - n))) & m : x;
+      };
+      return TernaryValue(w, rotl(a.val), rotl(a.known));
+    }
+    case BVShl:
+    case BVLshr:
+    case BVAshr: {
+      assert(args.size() == 2);
+      const TernaryValue & b = args[1];
+      if (!b.is_known()) {
+        return unknown(w);
+      }
+      uint64_t n = b.val;
+      uint64_t sign = uint64_t(1) << (w - 1);
+      if (op.prim_op == BVShl) {
+        if (n >= w) {
+          return concrete(w, 0);
+        }
+        // the low bits are known zeros
+        return TernaryValue(
+            w, (a.val << n) & m, ((a.known << n) | mask(n)) & m);
+      } else if (op.prim_op == BVLshr || !(a.known & sign)) {
+        if (n >= w) {
+          return op.prim_op == BVLshr ? concrete(w, 0) : unknown(w);
+        }
+        uint64_t high = op.prim_op == BVLshr ? m & ~(m >> n) : 0;
+        return TernaryValue(w, a.val >> n, (a.known >> n) | high);
+      }
+      // arithmetic shift with a known sign bit
+      if (n >= w) {
+        n = w - 1;
+      }
+      uint64_t high = m & ~(m >> n);
+      uint64_t v = (a.val >> n) | ((a.val & sign) ? high : 0);
+      return TernaryValue(w, v, (a.known >> n) | high);
+    }
+    default: break;
+  }
+
+  // the remaining operators are only evaluated on known arguments
+  for (const auto & x : args) {
+    if (!x.is_known()) {
+      return unknown(w);
+    }
+  }
+
+  const uint32_t aw = a.width;
+  const uint64_t x = a.val;
+  const uint64_t y = args.size() > 1 ? args[1].val : 0;
+  switch (op.prim_op) {
+    case BVNeg: return concrete(w, -x);
+    case BVAdd: {
+      uint64_t v = x;
+      for (size_t i = 1; i < args.size(); ++i) {
+        v += args[i].val;
+      }
+      return concrete(w, v);
+    }
+    case BVMul: {
+      uint64_t v = x;
+      for (size_t i = 1; i < args.size(); ++i) {
+        v *= args[i].val;
+      }
+      return concrete(w, v);
+    }
+    case BVSub: return concrete(w, x - y);
+    // division by zero is all ones, remainder by zero is the dividend
+    case BVUdiv: return concrete(w, y ? x / y : m);
+    case BVUrem: return concrete(w, y ? x % y : x);
+    case BVUlt: return concrete(1, x < y);
+    case BVUle: return concrete(1, x <= y);
+    case BVUgt: return concrete(1, x > y);
+    case BVUge: return concrete(1, x >= y);
+    case BVSlt: return concrete(1, to_signed(x, aw) < to_signed(y, aw));
+    case BVSle: return concrete(1, to_signed(x, aw) <= to_signed(y, aw));
+    case BVSgt: return concrete(1, to_signed(x, aw) > to_signed(y, aw));
+    case BVSge: return concrete(1, to_signed(x, aw) >= to_signed(y, aw));
+    default: break;
+  }
+
+  // not supported (e.g. signed division, arrays, uninterpreted functions)
+  return unknown(w);
+}
+
+}  // namespace pono
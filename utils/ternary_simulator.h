@@ -0,0 +1,108 @@
+/*********************                                                        */
+/*! \file ternary_simulator.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Ternary (0/1/X) simulation of the state updates of a functional
+**        transition system. Used to lift predecessor cubes without
+**        calling a solver.
+**
+**/
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "core/ts.h"
+#include "smt-switch/smt.h"
+
+namespace pono {
+
+/** A ternary value of a boolean or bit-vector of width at most 64
+ *  Bit j is known iff bit j of known is set, and then its value is bit j
+ *  of val. Wider bit-vectors and other sorts are always unknown.
+ */
+struct TernaryValue
+{
+  TernaryValue() : width(0), val(0), known(0) {}
+  TernaryValue(uint32_t w, uint64_t v, uint64_t k)
+      : width(w), val(v & k), known(k)
+  {
+  }
+
+  bool is_known() const;
+  bool is_true() const { return width == 1 && known == 1 && val == 1; }
+  bool is_false() const { return width == 1 && known == 1 && val == 0; }
+
+  uint32_t width;
+  uint64_t val;
+  uint64_t known;
+};
+
+class TernarySimulator
+{
+ public:
+  /** @param ts a transition system with functional state updates */
+  TernarySimulator(const TransitionSystem & ts);
+
+  /** Set a (boolean or bit-vector) variable to a value from a model */
+  void set_value(const smt::Term & var, const smt::Term & value);
+
+  /** Set a (boolean or bit-vector) variable to a ternary value */
+  void set_value(const smt::Term & var, const TernaryValue & value)
+  {
+    assignment_[var] = value;
+  }
+
+  /** Set bit i of a variable, the other bits are unchanged
+   *  (unknown if the variable was not set before)
+   */
+  void set_bit(const smt::Term & var, size_t i, bool value);
+
+  /** Make bit i of a variable unknown */
+  void set_unknown(const smt::Term & var, size_t i);
+
+  /** Forget all assignments */
+  void clear() { assignment_.clear(); }
+
+  /** Evaluate a term over the current state and input variables */
+  TernaryValue eval(const smt::Term & t) const;
+
+  /** Evaluate terms over the current state and input variables, with the
+   *  values of their shared subterms computed once
+   */
+  std::vector<TernaryValue> eval(const smt::TermVec & terms) const;
+
+  /** Evaluate a term over current state variables after one step
+   *  The state variables are replaced by the ternary value of their
+   *  state update (unknown if they have none).
+   */
+  TernaryValue eval_next(const smt::Term & t) const;
+
+ protected:
+  typedef std::unordered_map<smt::Term, TernaryValue> ValueMap;
+
+  /** Evaluates t with the leaves bound by env (unknown otherwise)
+   *  @param cache the memoized values of subterms
+   */
+  TernaryValue eval(const smt::Term & t,
+                    const ValueMap & env,
+                    ValueMap & cache) const;
+
+  /** Apply the operator of t to the values of its children */
+  TernaryValue apply(const smt::Term & t,
+                     const std::vector<TernaryValue> & args) const;
+
+  const TransitionSystem & ts_;
+  ValueMap assignment_;  ///< values of current state and input variables
+};
+
+}  // namespace pono
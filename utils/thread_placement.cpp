@@ -0,0 +1,202 @@
+/*********************                                                        */
+/*! \file thread_placement.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Placement of the worker threads of the parallel modes (parallel
+**        bmc and the portfolios) on the CPUs and NUMA nodes, see --pin
+**        and --numa.
+**
+**/
+
+#include "utils/thread_placement.h"
+
+#ifdef __linux__
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <thread>
+
+#include "utils/logger.h"
+
+using namespace std;
+
+namespace pono {
+
+/** Parse a Linux cpu list, e.g. 0-3,8-11 */
+static vector<int> parse_cpu_list(const string & list)
+{
+  vector<int> res;
+  size_t pos = 0;
+  while (pos < list.size()) {
+    size_t end = list.find(',', pos);
+    if (end == string::npos) {
+      end = list.size();
+    }
+    string range = list.substr(pos, end - pos);
+    size_t dash = range.find('-');
+    try {
+      int first = stoi(range.substr(0, dash));
+      int last = dash == string::npos ? first : stoi(range.substr(dash + 1));
+      for (int c = first; c <= last; ++c) {
+        res.push_back(c);
+      }
+    }
+    catch (std::exception &) {
+      // whitespace or a malformed entry
+    }
+    pos = end + 1;
+  }
+  return res;
+}
+
+static vector<vector<int>> read_numa_cpus()
+{
+  vector<int> allowed;
+  vector<vector<int>> nodes;
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (!sched_getaffinity(0, sizeof(set), &set)) {
+    for (int c = 0; c < CPU_SETSIZE; ++c) {
+      if (CPU_ISSET(c, &set)) {
+        allowed.push_back(c);
+      }
+    }
+  }
+
+  const string node_dir = "/sys/devices/system/node";
+  vector<int> node_ids;
+  if (DIR * dir = opendir(node_dir.c_str())) {
+    while (dirent * entry = readdir(dir)) {
+      string name = entry->d_name;
+      if (name.size() > 4 && name.compare(0, 4, "node") == 0
+          && all_of(name.begin() + 4, name.end(), ::isdigit)) {
+        node_ids.push_back(stoi(name.substr(4)));
+      }
+    }
+    closedir(dir);
+  }
+  sort(node_ids.begin(), node_ids.end());
+  for (int id : node_ids) {
+    ifstream f(node_dir + "/node" + std::to_string(id) + "/cpulist");
+    string list;
+    getline(f, list);
+    vector<int> cpus;
+    for (int c : parse_cpu_list(list)) {
+      if (find(allowed.begin(), allowed.end(), c) != allowed.end()) {
+        cpus.push_back(c);
+      }
+    }
+    // the nodes without memory or without allowed CPUs don't count
+    if (cpus.size()) {
+      nodes.push_back(cpus);
+    }
+  }
+#endif
+
+  if (nodes.empty()) {
+    if (allowed.empty()) {
+      for (unsigned c = 0; c < max(1u, thread::hardware_concurrency()); ++c) {
+        allowed.push_back(c);
+      }
+    }
+    nodes.push_back(allowed);
+  }
+  return nodes;
+}
+
+const vector<vector<int>> & numa_cpus()
+{
+  static const vector<vector<int>> nodes = read_numa_cpus();
+  return nodes;
+}
+
+size_t num_worker_threads(const PonoOptions & opts, size_t requested)
+{
+  if (requested) {
+    return requested;
+  } else if (opts.threads_) {
+    return opts.threads_;
+  }
+  return max(1u, thread::hardware_concurrency());
+}
+
+WorkerPlacement worker_placement(const PonoOptions & opts, size_t idx)
+{
+  WorkerPlacement res;
+  const vector<vector<int>> & nodes = numa_cpus();
+  if (opts.numa_) {
+    res.node = idx % nodes.size();
+    if (opts.pin_threads_) {
+      const vector<int> & cpus = nodes[res.node];
+      res.cpu = cpus[(idx / nodes.size()) % cpus.size()];
+    }
+  } else if (opts.pin_threads_) {
+    size_t num_cpus = 0;
+    for (const auto & cpus : nodes) {
+      num_cpus += cpus.size();
+    }
+    size_t i = idx % num_cpus;
+    for (size_t n = 0; n < nodes.size(); ++n) {
+      if (i < nodes[n].size()) {
+        res.node = n;
+        res.cpu = nodes[n][i];
+        break;
+      }
+      i -= nodes[n].size();
+    }
+  }
+  return res;
+}
+
+WorkerPlacement place_worker_thread(const PonoOptions & opts,
+                                    size_t idx,
+                                    Statistics * stats,
+                                    const string & name)
+{
+  WorkerPlacement p = worker_placement(opts, idx);
+  if (p.node < 0) {
+    return p;
+  }
+
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (p.cpu >= 0) {
+    CPU_SET(p.cpu, &set);
+  } else {
+    for (int c : numa_cpus()[p.node]) {
+      CPU_SET(c, &set);
+    }
+  }
+  if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set)) {
+    logger.log(1, "Could not place {} {} on node {}", name, idx, p.node);
+    return WorkerPlacement();
+  }
+#else
+  logger.log(1, "Thread placement is only supported on Linux");
+  return WorkerPlacement();
+#endif
+
+  if (stats) {
+    stats->set(name + "_node", p.node);
+    if (p.cpu >= 0) {
+      stats->set(name + "_cpu", p.cpu);
+    }
+  }
+  return p;
+}
+
+}  // namespace pono
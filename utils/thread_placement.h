@@ -0,0 +1,77 @@
+/*********************                                                        */
+/*! \file thread_placement.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Placement of the worker threads of the parallel modes (parallel
+**        bmc and the portfolios) on the CPUs and NUMA nodes, see --pin
+**        and --numa.
+**
+**        Each worker has its own solver, which is memory-heavy, so a
+**        worker should not migrate away from the memory it allocated.
+**        The memory of a thread is allocated on the node it runs on
+**        (first touch), so placing the threads that load the copies of
+**        the system and run the solvers keeps that memory local without
+**        a NUMA library.
+**
+**/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "options/options.h"
+#include "utils/statistics.h"
+
+namespace pono {
+
+/** The CPUs this process may run on, grouped by NUMA node
+ *  Read once (from sysfs on Linux), a single node elsewhere.
+ */
+const std::vector<std::vector<int>> & numa_cpus();
+
+/** @return the number of worker threads of a parallel mode
+ *  @param opts the options, opts.threads_ is the default
+ *  @param requested the engine-specific number of threads, 0 for the
+ *         default (the number of cores if opts.threads_ is 0)
+ */
+size_t num_worker_threads(const PonoOptions & opts, size_t requested);
+
+struct WorkerPlacement
+{
+  int node = -1;  ///< the index of the NUMA node in numa_cpus(), -1 if
+                  ///< not placed
+  int cpu = -1;   ///< the CPU, -1 if not pinned to one
+};
+
+/** @return where worker idx runs, without moving any thread
+ *  With opts.numa_ the workers are spread evenly over the nodes (worker
+ *  idx on node idx modulo the number of nodes), and with
+ *  opts.pin_threads_ each worker gets its own CPU (wrapping around with
+ *  more workers than CPUs). Without opts.numa_, the pinned workers fill
+ *  the CPUs of a node before the next.
+ */
+WorkerPlacement worker_placement(const PonoOptions & opts, size_t idx);
+
+/** Move the calling thread to the placement of worker idx
+ *  Does nothing if neither opts.pin_threads_ nor opts.numa_ is set.
+ *  @param opts the options
+ *  @param idx the worker index
+ *  @param stats if not null, the placement is recorded as name_node and
+ *         name_cpu
+ *  @param name the name of the worker in the statistics
+ *  @return the placement, empty if the thread could not be moved
+ */
+WorkerPlacement place_worker_thread(const PonoOptions & opts,
+                                    size_t idx,
+                                    Statistics * stats = nullptr,
+                                    const std::string & name = "worker");
+
+}  // namespace pono
@@ -0,0 +1,126 @@
+/*********************                                                        */
+/*! \file timeline.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Timeline of the engine phases in the Chrome trace event format.
+**
+**/
+
+#include "utils/timeline.h"
+
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+namespace pono {
+
+Timeline timeline;
+
+Timeline::Timeline() : enabled_(false), start_(chrono::steady_clock::now())
+{
+}
+
+Timeline::~Timeline()
+{
+  for (auto te : threads_) {
+    delete te;
+  }
+}
+
+void Timeline::set_output_file(const string & filename)
+{
+  lock_guard<mutex> lock(mutex_);
+  filename_ = filename;
+  enabled_ = true;
+}
+
+uint64_t Timeline::now() const
+{
+  return chrono::duration_cast<chrono::microseconds>(
+             chrono::steady_clock::now() - start_)
+      .count();
+}
+
+Timeline::ThreadEvents & Timeline::thread_events()
+{
+  static thread_local ThreadEvents * events = nullptr;
+  if (!events) {
+    events = new ThreadEvents();
+    events->dropped = 0;
+    lock_guard<mutex> lock(mutex_);
+    events->tid = threads_.size() + 1;
+    threads_.push_back(events);
+  }
+  return *events;
+}
+
+void Timeline::record(const char * name, uint64_t begin, uint64_t end)
+{
+  ThreadEvents & te = thread_events();
+  lock_guard<mutex> lock(te.mutex);
+  if (te.events.size() < max_events_per_thread) {
+    te.events.push_back({ name, begin, end - begin });
+  } else {
+    ++te.dropped;
+  }
+}
+
+size_t Timeline::num_dropped() const
+{
+  lock_guard<mutex> lock(mutex_);
+  size_t dropped = 0;
+  for (const auto & te : threads_) {
+    lock_guard<mutex> tlock(te->mutex);
+    dropped += te->dropped;
+  }
+  return dropped;
+}
+
+string Timeline::to_json() const
+{
+  lock_guard<mutex> lock(mutex_);
+  ostringstream out;
+  out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+  bool first = true;
+  for (const auto & te : threads_) {
+    lock_guard<mutex> tlock(te->mutex);
+    // name the track of each thread, the first one is the main thread
+    out << (first ? "" : ",") << "\n {\"name\": \"thread_name\", \"ph\": "
+        << "\"M\", \"pid\": 1, \"tid\": " << te->tid
+        << ", \"args\": {\"name\": \""
+        << (te->tid == 1 ? "main" : "worker " + std::to_string(te->tid - 1))
+        << "\"}}";
+    first = false;
+    // span names are literals chosen in the code, no escaping needed
+    for (const auto & e : te->events) {
+      out << ",\n {\"name\": \"" << e.name
+          << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << te->tid
+          << ", \"ts\": " << e.begin << ", \"dur\": " << e.duration << "}";
+    }
+  }
+  out << "]}" << endl;
+  return out.str();
+}
+
+bool Timeline::dump() const
+{
+  if (!enabled()) {
+    return true;
+  }
+  ofstream f(filename_);
+  if (!f.is_open()) {
+    return false;
+  }
+  f << to_json();
+  return f.good();
+}
+
+}  // namespace pono
@@ -0,0 +1,133 @@
+/*********************                                                        */
+/*! \file timeline.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Timeline of the engine phases (parsing, preprocessing, IC3 steps,
+**        blocking, propagation, refinement, witness printing), written in
+**        the Chrome trace event format. The file can be loaded in
+**        chrome://tracing or ui.perfetto.dev.
+**
+**        Each thread appends complete ("X") events to its own buffer,
+**        identified by a small thread id, so parallel modes show one
+**        track per thread. When disabled a span costs one atomic load.
+**
+**/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace pono {
+
+// Meant to be used as a singleton class -- instantiated as timeline below
+class Timeline
+{
+ public:
+  ///< events recorded per thread, later events are dropped and counted
+  static constexpr size_t max_events_per_thread = 1 << 20;
+
+  Timeline();
+  ~Timeline();
+
+  /** Enable recording and set the file written by dump */
+  void set_output_file(const std::string & filename);
+
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  /** @return microseconds since the timeline was created */
+  uint64_t now() const;
+
+  /** Record a span of the calling thread
+   *  @param name the phase, a string literal (it is not copied)
+   *  @param begin its start as returned by now()
+   *  @param end its end as returned by now()
+   */
+  void record(const char * name, uint64_t begin, uint64_t end);
+
+  /** @return the number of spans dropped because a buffer was full */
+  size_t num_dropped() const;
+
+  /** @return the events of all threads as Chrome trace JSON */
+  std::string to_json() const;
+
+  /** Write to_json() to the output file (does nothing if not enabled)
+   *  @return true on success
+   */
+  bool dump() const;
+
+ protected:
+  struct Event
+  {
+    const char * name;
+    uint64_t begin;
+    uint64_t duration;
+  };
+
+  /** The events of a thread, only appended to by that thread */
+  struct ThreadEvents
+  {
+    uint32_t tid;
+    mutable std::mutex mutex;  ///< uncontended except during to_json
+    std::vector<Event> events;
+    size_t dropped;
+  };
+
+  /** @return the buffer of the calling thread, created on first use */
+  ThreadEvents & thread_events();
+
+  std::atomic<bool> enabled_;
+  std::string filename_;
+  std::chrono::steady_clock::time_point start_;
+
+  mutable std::mutex mutex_;
+  ///< the buffers of all threads, kept after the threads exit
+  std::vector<ThreadEvents *> threads_;
+};
+
+// globally available timeline
+extern Timeline timeline;
+
+/** Records the time from construction to destruction as one span */
+class TimelineSpan
+{
+ public:
+  TimelineSpan(const char * name)
+      : name_(name), active_(timeline.enabled())
+  {
+    if (active_) {
+      begin_ = timeline.now();
+    }
+  }
+
+  ~TimelineSpan()
+  {
+    if (active_) {
+      timeline.record(name_, begin_, timeline.now());
+    }
+  }
+
+ protected:
+  const char * name_;
+  bool active_;
+  uint64_t begin_;
+};
+
+#define TIMELINE_SPAN_CONCAT_(a, b) a##b
+#define TIMELINE_SPAN_NAME_(line) TIMELINE_SPAN_CONCAT_(timeline_span_, line)
+
+/** Records the rest of the enclosing scope as a span */
+#define TIMELINE_SPAN(name) TimelineSpan TIMELINE_SPAN_NAME_(__LINE__)(name)
+
+}  // namespace pono
@@ -14,10 +14,20 @@
 **
 **/
 
+#include <algorithm>
+#include <memory>
+#include <thread>
+
 #include "smt-switch/term_translator.h"
+#include "smt-switch/utils.h"
 
 #include "smt/available_solvers.h"
+#include "utils/budget.h"
+#include "utils/concrete_simulator.h"
+#include "utils/core_minimizer.h"
+#include "utils/exceptions.h"
 #include "utils/logger.h"
+#include "utils/term_hash_map.h"
 #include "utils/ts_analysis.h"
 
 using namespace smt;
@@ -75,4 +85,299 @@ bool check_invar(const TransitionSystem & ts,
   return pass;
 }
 
+InvarCheckResult check_invar_clauses(const TransitionSystem & ts,
+                                     const Term & other_prop,
+                                     const Term & other_invar,
+                                     size_t num_threads)
+{
+  InvarCheckResult res;
+  if (!ts.only_curr(other_invar)) {
+    logger.log(1, "INVARCHECK: Fail, contains non-current state vars");
+    return res;
+  }
+
+  TermVec conjuncts;
+  conjunctive_partition(other_invar, conjuncts, true);
+  size_t n = conjuncts.size();
+  num_threads = std::max<size_t>(1, std::min(num_threads, n));
+
+  // solver 0 checks initiation, solver 1 the property and the others
+  // a slice of the conjuncts each
+  // all the terms are transferred on this thread, and the threads only
+  // use their own solver
+  struct Worker
+  {
+    SmtSolver solver;
+    Term invar;
+    Term goal;      ///< init or not prop
+    Term trans;
+    TermVec next;   ///< next of the conjuncts of the slice
+    size_t begin;   ///< the slice of the conjuncts
+    size_t end;
+    Term true_;
+  };
+  std::vector<Worker> workers(num_threads + 2);
+  for (size_t t = 0; t < workers.size(); ++t) {
+    Worker & w = workers[t];
+    w.solver = create_solver(ts.solver()->get_solver_enum());
+    w.solver->set_opt("incremental", "true");
+    TermTranslator tt(w.solver);
+    w.invar = tt.transfer_term(other_invar, BOOL);
+    w.true_ = w.solver->make_term(true);
+    if (t == 0) {
+      w.goal = tt.transfer_term(ts.init(), BOOL);
+    } else if (t == 1) {
+      w.goal = w.solver->make_term(Not, tt.transfer_term(other_prop, BOOL));
+    } else {
+      w.trans = tt.transfer_term(ts.trans(), BOOL);
+      w.begin = (t - 2) * n / num_threads;
+      w.end = (t - 1) * n / num_threads;
+      w.next.reserve(w.end - w.begin);
+      for (size_t j = w.begin; j < w.end; ++j) {
+        w.next.push_back(tt.transfer_term(ts.next(conjuncts[j]), BOOL));
+      }
+    }
+  }
+
+  std::vector<Result> results(2);
+  // set by the thread checking the slice of the conjunct
+  std::vector<char> failed(n, 0);
+
+  auto check = [&](size_t t) {
+    Worker & w = workers[t];
+    if (t < 2) {
+      w.solver->assert_formula(t ? w.invar : w.goal);
+      w.solver->assert_formula(t ? w.goal : w.solver->make_term(Not, w.invar));
+      results[t] = w.solver->check_sat();
+      return;
+    }
+
+    w.solver->assert_formula(w.invar);
+    w.solver->assert_formula(w.trans);
+    // each model falsifies at least one of the remaining conjuncts
+    while (true) {
+      Term some_false;
+      for (size_t j = w.begin; j < w.end; ++j) {
+        if (!failed[j]) {
+          Term f = w.solver->make_term(Not, w.next[j - w.begin]);
+          some_false = some_false ? w.solver->make_term(Or, some_false, f) : f;
+        }
+      }
+      if (!some_false) {
+        break;
+      }
+
+      w.solver->push();
+      w.solver->assert_formula(some_false);
+      Result r = w.solver->check_sat();
+      for (size_t j = w.begin; j < w.end; ++j) {
+        if (!failed[j]
+            && (r.is_unknown()
+                || (r.is_sat()
+                    && w.solver->get_value(w.next[j - w.begin]) != w.true_))) {
+          failed[j] = 1;
+        }
+      }
+      w.solver->pop();
+      if (!r.is_sat()) {
+        break;
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(workers.size() - 1);
+  for (size_t t = 1; t < workers.size(); ++t) {
+    threads.push_back(std::thread(check, t));
+  }
+  check(0);
+  for (auto & t : threads) {
+    t.join();
+  }
+
+  res.init_ok = results[0].is_unsat();
+  res.prop_ok = results[1].is_unsat();
+  for (size_t j = 0; j < n; ++j) {
+    if (failed[j]) {
+      res.not_inductive.push_back(conjuncts[j]);
+    }
+  }
+  res.inductive_ok = res.not_inductive.empty();
+
+  logger.log(1, "INVARCHECK: init |= inv...{}", res.init_ok ? "OK" : "FAIL");
+  logger.log(1,
+             "INVARCHECK: inv & trans |= inv'...{} ({} of {} conjuncts "
+             "failed, {} threads)",
+             res.inductive_ok ? "OK" : "FAIL",
+             res.not_inductive.size(),
+             n,
+             num_threads);
+  for (const auto & c : res.not_inductive) {
+    logger.log(1, "INVARCHECK: not inductive: {}", c);
+  }
+  logger.log(1, "INVARCHECK: inv |= prop...{}", res.prop_ok ? "OK" : "FAIL");
+  return res;
+}
+
+WitnessCheckResult check_witness(const TransitionSystem & ts,
+                                 const Term & prop,
+                                 const std::vector<UnorderedTermMap> & cex)
+{
+  WitnessCheckResult res;
+  std::unique_ptr<ConcreteSimulator> sim;
+  uint32_t prop_id = 0;
+  try {
+    sim.reset(new ConcreteSimulator(ts));
+    prop_id = sim->add_output(prop);
+  }
+  catch (PonoException & e) {
+    logger.log(1, "WITNESSCHECK: not supported: {}", e.what());
+    res.reason = e.what();
+    return res;
+  }
+  res.supported = true;
+
+  if (cex.empty()) {
+    res.reason = "empty witness";
+    return res;
+  }
+
+  for (size_t k = 0; k < cex.size(); ++k) {
+    res.step = k;
+    try {
+      if (!(k ? sim->replay_step(cex[k]) : sim->replay_init(cex[k]))) {
+        res.reason = k ? "not a transition of the system"
+                       : "not an initial state";
+        return res;
+      }
+    }
+    catch (PonoException & e) {
+      // a frame value the simulator cannot read
+      res.reason = e.what();
+      return res;
+    }
+  }
+
+  if (sim->value(prop_id)) {
+    res.reason = "the property holds in the last step";
+    return res;
+  }
+  res.valid = true;
+  return res;
+}
+
+Term compact_invar(const TransitionSystem & ts,
+                   const Term & other_prop,
+                   const Term & other_invar,
+                   size_t time_limit_ms)
+{
+  TermVec conjuncts;
+  conjunctive_partition(other_invar, conjuncts, true);
+  size_t n = conjuncts.size();
+  if (n < 2 || !ts.only_curr(other_invar)) {
+    return other_invar;
+  }
+
+  Budget budget;
+  budget.set_time_limit(time_limit_ms / 1000.0);
+  budget.start();
+
+  // use a fresh solver, with trans, the property and a label per conjunct
+  SmtSolver solver = create_solver(ts.solver()->get_solver_enum());
+  solver->set_opt("produce-unsat-assumptions", "true");
+  if (time_limit_ms) {
+    set_query_time_limit(solver, time_limit_ms);
+  }
+  TermTranslator tt(solver);
+  Sort boolsort = solver->make_sort(BOOL);
+  solver->assert_formula(tt.transfer_term(ts.trans(), BOOL));
+  solver->assert_formula(tt.transfer_term(other_prop, BOOL));
+
+  TermVec labels, next;
+  labels.reserve(n);
+  next.reserve(n);
+  TermHashMap<size_t> label_idx;
+  for (size_t j = 0; j < n; ++j) {
+    Term l = solver->make_symbol("__compact_invar_label_" + std::to_string(j),
+                                 boolsort);
+    solver->assert_formula(solver->make_term(
+        Implies, l, tt.transfer_term(conjuncts[j], BOOL)));
+    labels.push_back(l);
+    label_idx.emplace(l, j);
+    next.push_back(tt.transfer_term(ts.next(conjuncts[j]), BOOL));
+  }
+
+  std::vector<char> required(n, 0);
+  // the next states to entail in this round, starting with the property
+  TermVec goals({ tt.transfer_term(ts.next(other_prop), BOOL) });
+  size_t num_checks = 0;
+  while (!goals.empty()) {
+    if (budget.exhausted()) {
+      logger.log(1, "Invariant compaction: out of time, keeping the invariant");
+      return other_invar;
+    }
+
+    // prefer the conjuncts that are already required
+    TermVec assumps, core;
+    assumps.reserve(n);
+    for (size_t j = 0; j < n; ++j) {
+      if (required[j]) {
+        assumps.push_back(labels[j]);
+      }
+    }
+    for (size_t j = 0; j < n; ++j) {
+      if (!required[j]) {
+        assumps.push_back(labels[j]);
+      }
+    }
+
+    Term goal = goals[0];
+    for (size_t i = 1; i < goals.size(); ++i) {
+      goal = solver->make_term(And, goal, goals[i]);
+    }
+    solver->push();
+    solver->assert_formula(solver->make_term(Not, goal));
+    size_t remaining_ms = 0;
+    if (time_limit_ms) {
+      remaining_ms = static_cast<size_t>(
+          std::max(1.0, time_limit_ms - budget.elapsed_seconds() * 1000));
+    }
+    CoreMinimizer minimizer(solver, remaining_ms);
+    bool unsat = minimizer.minimize(assumps, core);
+    num_checks += minimizer.num_checks();
+    solver->pop();
+    if (!unsat) {
+      // not inductive, or a query ran out of time
+      logger.log(1, "Invariant compaction: failed, keeping the invariant");
+      return other_invar;
+    }
+
+    goals.clear();
+    for (const auto & l : core) {
+      size_t j = label_idx.at(l);
+      if (!required[j]) {
+        required[j] = 1;
+        goals.push_back(next[j]);
+      }
+    }
+  }
+
+  // closed under trans, and each conjunct holds initially because invar does
+  Term res = other_prop;
+  size_t num_required = 0;
+  for (size_t j = 0; j < n; ++j) {
+    if (required[j] && conjuncts[j] != other_prop) {
+      res = ts.solver()->make_term(And, res, conjuncts[j]);
+      ++num_required;
+    }
+  }
+  logger.log(1,
+             "Invariant compaction: kept {} of {} conjuncts ({} checks, {}s)",
+             num_required,
+             n,
+             num_checks,
+             budget.elapsed_seconds());
+  return res;
+}
+
 }  // namespace pono
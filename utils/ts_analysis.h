@@ -15,6 +15,9 @@
 **/
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "smt-switch/smt.h"
 
 #include "core/ts.h"
@@ -34,4 +37,78 @@ bool check_invar(const TransitionSystem & ts,
                  const smt::Term & prop,
                  const smt::Term & invar);
 
+/** The result of check_invar_clauses */
+struct InvarCheckResult
+{
+  bool init_ok = false;        ///< init |= invar
+  bool inductive_ok = false;   ///< invar & trans |= invar'
+  bool prop_ok = false;        ///< invar |= prop
+  smt::TermVec not_inductive;  ///< conjuncts c of invar with invar & trans
+                               ///< not entailing c' (or unknown)
+
+  bool passed() const { return init_ok && inductive_ok && prop_ok; }
+};
+
+/** Check the same obligations as check_invar, but check the
+ *  inductiveness of each conjunct of the invariant separately, split in
+ *  chunks over num_threads fresh solvers, and report the failing ones.
+ *  The initiation and property checks run concurrently with them.
+ *  All terms are transferred on the calling thread.
+ *  @param ts the transition system
+ *  @param prop the term representing the property
+ *  @param invar the term representing the invariant
+ *  @param num_threads the number of solvers checking inductiveness
+ *  @return the result of each obligation
+ */
+InvarCheckResult check_invar_clauses(const TransitionSystem & ts,
+                                     const smt::Term & prop,
+                                     const smt::Term & invar,
+                                     size_t num_threads);
+
+/** The result of check_witness */
+struct WitnessCheckResult
+{
+  bool supported = false;  ///< false if the system cannot be simulated
+  bool valid = false;      ///< the witness is a trace of the system that
+                           ///< violates the property in its last step
+  size_t step = 0;         ///< the first step that failed
+  std::string reason;      ///< why the witness is not valid
+
+  /** @return false only for a witness known to be wrong */
+  bool passed() const { return !supported || valid; }
+};
+
+/** Check a counterexample by replaying it on the concrete simulator
+ *  (without a solver): the first frame must satisfy init, each frame
+ *  must follow from the previous one by the state updates, the
+ *  constraints must hold in every frame, and the property must be false
+ *  in the last one. Inputs the frames do not assign are 0.
+ *  @param ts a functional transition system
+ *  @param prop the term representing the property
+ *  @param cex the values of the state and input variables in each step
+ *  @return the result, not supported for relational systems and systems
+ *          the simulator does not support
+ */
+WitnessCheckResult check_witness(
+    const TransitionSystem & ts,
+    const smt::Term & prop,
+    const std::vector<smt::UnorderedTermMap> & cex);
+
+/** Drop the conjuncts of an inductive invariant that are not needed to
+ *  keep it inductive and entail the property. Starting from the
+ *  property, adds the (minimized) unsat core of the conjuncts needed to
+ *  entail the next state of the conjuncts added so far, until that set
+ *  is closed. The result is the property and that set.
+ *  @param ts the transition system
+ *  @param prop the term representing the property
+ *  @param invar an inductive invariant that guarantees prop holds
+ *  @param time_limit_ms the time budget (0 means no limit)
+ *  @return the compacted invariant, or invar if it could not be
+ *          compacted in time (or is not inductive)
+ */
+smt::Term compact_invar(const TransitionSystem & ts,
+                        const smt::Term & prop,
+                        const smt::Term & invar,
+                        size_t time_limit_ms);
+
 }  // namespace pono
@@ -0,0 +1,148 @@
+/*********************                                                        */
+/*! \file ts_clone.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Copies of a transition system in many solvers, built
+**        concurrently.
+**
+**/
+
+#include "utils/ts_clone.h"
+
+#include <algorithm>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include "assert.h"
+#include "core/fts.h"
+#include "core/rts.h"
+#include "utils/exceptions.h"
+#include "utils/ts_snapshot.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+namespace {
+
+// the caches of the copies not used by a translator yet, by source and
+// target solver
+typedef pair<const AbsSmtSolver *, const AbsSmtSolver *> SolverPair;
+
+mutex seeds_mutex;
+
+map<SolverPair, UnorderedTermMap> & seeds()
+{
+  static map<SolverPair, UnorderedTermMap> res;
+  return res;
+}
+
+}  // namespace
+
+TsCloner::TsCloner(const TransitionSystem & ts, const TermVec & props)
+    : solver_(ts.solver()),
+      functional_(ts.is_functional()),
+      data_(ts_snapshot(ts, props, &terms_))
+{
+}
+
+TsCloner::~TsCloner()
+{
+  lock_guard<mutex> lock(seeds_mutex);
+  for (const auto & c : copies_) {
+    seeds().erase({ solver_.get(), c.solver.get() });
+  }
+}
+
+void TsCloner::clone(const vector<SmtSolver> & solvers,
+                     size_t num_threads,
+                     const function<void(size_t)> & init_thread)
+{
+  size_t first = copies_.size();
+  for (const auto & s : solvers) {
+    if (s == solver_) {
+      throw PonoException("TsCloner can't copy a system into its solver");
+    }
+    copies_.push_back({ s, TransitionSystem(), {}, {} });
+  }
+  if (!num_threads || num_threads > solvers.size()) {
+    num_threads = solvers.size();
+  }
+
+  // each thread loads every num_threads-th copy
+  vector<exception_ptr> errors(num_threads);
+  auto load = [&](size_t t) {
+    try {
+      if (init_thread) {
+        init_thread(t);
+      }
+      for (size_t i = first + t; i < copies_.size(); i += num_threads) {
+        Copy & c = copies_[i];
+        const char * data = data_.data();
+        if (functional_) {
+          FunctionalTransitionSystem fts(c.solver);
+          load_ts_snapshot(data, data_.size(), fts, c.props, &c.terms);
+          c.ts = fts;
+        } else {
+          RelationalTransitionSystem rts(c.solver);
+          load_ts_snapshot(data, data_.size(), rts, c.props, &c.terms);
+          c.ts = rts;
+        }
+      }
+    }
+    catch (...) {
+      errors[t] = current_exception();
+    }
+  };
+  vector<thread> threads;
+  threads.reserve(num_threads);
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.push_back(thread(load, t));
+  }
+  for (auto & t : threads) {
+    t.join();
+  }
+  for (const auto & e : errors) {
+    if (e) {
+      rethrow_exception(e);
+    }
+  }
+
+  // the caches hash the terms of the original system, on this thread
+  for (size_t i = first; i < copies_.size(); ++i) {
+    const Copy & c = copies_[i];
+    assert(c.terms.size() == terms_.size());
+    UnorderedTermMap cache;
+    cache.reserve(terms_.size());
+    for (size_t j = 0; j < terms_.size(); ++j) {
+      cache[terms_[j]] = c.terms[j];
+    }
+    lock_guard<mutex> lock(seeds_mutex);
+    seeds()[{ solver_.get(), c.solver.get() }] = std::move(cache);
+  }
+}
+
+TermTranslator make_translator(const TransitionSystem & ts,
+                               const SmtSolver & solver)
+{
+  TermTranslator tt(solver);
+  lock_guard<mutex> lock(seeds_mutex);
+  auto it = seeds().find({ ts.solver().get(), solver.get() });
+  if (it != seeds().end()) {
+    tt.get_cache() = std::move(it->second);
+    seeds().erase(it);
+  }
+  return tt;
+}
+
+}  // namespace pono
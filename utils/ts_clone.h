@@ -0,0 +1,101 @@
+/*********************                                                        */
+/*! \file ts_clone.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Copies of a transition system in many solvers, built
+**        concurrently.
+**
+**        The system is written once in the snapshot format (see
+**        ts_snapshot.h), the only step that reads its terms, and each
+**        copy is loaded from the snapshot on its own thread, which only
+**        creates terms in its own solver. A prover constructed on the
+**        original system in one of these solvers then finds every term
+**        in the cache of its translator instead of transferring it.
+**
+**/
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/ts.h"
+#include "smt-switch/smt.h"
+#include "smt-switch/term_translator.h"
+
+namespace pono {
+
+class TsCloner
+{
+ public:
+  /** Writes the snapshot of ts and props, on the calling thread
+   *  @throws PonoException if ts has terms a snapshot does not support
+   */
+  TsCloner(const TransitionSystem & ts, const smt::TermVec & props = {});
+
+  /** Removes the translator caches that were not used */
+  ~TsCloner();
+
+  TsCloner(const TsCloner &) = delete;
+  TsCloner & operator=(const TsCloner &) = delete;
+
+  /** Copies the system into each solver, loading the copies concurrently
+   *  Must be called on the thread that owns the solver of the system.
+   *  The cache of the copy in each solver is then used by the next
+   *  make_translator from the solver of the system to that solver.
+   *  @param solvers the solvers, none of them the solver of the system
+   *  @param num_threads the number of threads (0: one per solver)
+   *  @param init_thread if set, called first on each loading thread with
+   *         its index t, thread t loads the copies t, t + num_threads, ...
+   *         (e.g. to place it with place_worker_thread)
+   *  @throws PonoException if a copy fails
+   */
+  void clone(const std::vector<smt::SmtSolver> & solvers,
+             size_t num_threads = 0,
+             const std::function<void(size_t)> & init_thread = nullptr);
+
+  /** @return the number of copies */
+  size_t size() const { return copies_.size(); }
+
+  /** @return the copy of the system in the i-th solver */
+  const TransitionSystem & ts(size_t i) const { return copies_.at(i).ts; }
+
+  /** @return the copies of the properties in the i-th solver */
+  const smt::TermVec & props(size_t i) const { return copies_.at(i).props; }
+
+  /** @return the size of the snapshot in bytes */
+  size_t snapshot_size() const { return data_.size(); }
+
+ private:
+  struct Copy
+  {
+    smt::SmtSolver solver;
+    TransitionSystem ts;
+    smt::TermVec props;
+    smt::TermVec terms;  ///< by snapshot id
+  };
+
+  const smt::SmtSolver solver_;  ///< of the original system
+  bool functional_;
+  smt::TermVec terms_;  ///< the terms of the original system by id
+  std::string data_;  ///< the snapshot
+  std::vector<Copy> copies_;
+};
+
+/** @return a translator to solver, whose cache holds the copies of the
+ *          terms of ts made by a TsCloner in solver if there are any
+ *          (only the first translator to solver gets them)
+ */
+smt::TermTranslator make_translator(const TransitionSystem & ts,
+                                    const smt::SmtSolver & solver);
+
+}  // namespace pono
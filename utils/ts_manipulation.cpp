@@ -33,4 +33,21 @@ TransitionSystem create_fresh_ts(bool functional, const SmtSolver & solver)
   }
 }
 
+Term make_fresh_var(TransitionSystem & ts,
+                    const string & name,
+                    const Sort & sort,
+                    bool state)
+{
+  size_t cnt = 0;
+  while (true) {
+    string n = cnt ? name + "_" + std::to_string(cnt) : name;
+    try {
+      return state ? ts.make_statevar(n, sort) : ts.make_inputvar(n, sort);
+    }
+    catch (std::exception & e) {
+      ++cnt;
+    }
+  }
+}
+
 }  // namespace pono
@@ -23,4 +23,13 @@ namespace pono {
 TransitionSystem create_fresh_ts(bool functional,
                                  const smt::SmtSolver & solver);
 
+/** @return a new variable of ts named name, or name with a numbered
+ *          suffix if it is already used
+ *  @param state true for a state variable, false for an input variable
+ */
+smt::Term make_fresh_var(TransitionSystem & ts,
+                         const std::string & name,
+                         const smt::Sort & sort,
+                         bool state);
+
 }  // namespace pono
@@ -0,0 +1,676 @@
+/*********************                                                        */
+/*! \file ts_snapshot.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A binary snapshot of a transition system and its properties.
+**
+**/
+
+#include "utils/ts_snapshot.h"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+#include "assert.h"
+#include "core/rts.h"
+#include "utils/exceptions.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+namespace {
+
+const char snapshot_magic[] = "PONOSNAP";
+const size_t snapshot_magic_size = 8;
+const uint32_t snapshot_version = 1;
+const uint32_t functional_flag = 1;
+
+// kinds of terms
+enum : uint8_t
+{
+  SNAP_SYMBOL = 0,
+  SNAP_VALUE,
+  SNAP_CONST_ARRAY,
+  SNAP_OP
+};
+
+// kinds of sorts
+enum : uint8_t
+{
+  SNAP_BOOL = 0,
+  SNAP_BV,
+  SNAP_INT,
+  SNAP_REAL,
+  SNAP_ARRAY,
+  SNAP_FUNCTION
+};
+
+class SnapshotWriter
+{
+ public:
+  SnapshotWriter() {}
+
+  void u8(uint8_t v) { out_.push_back(static_cast<char>(v)); }
+
+  void u32(uint32_t v)
+  {
+    for (size_t i = 0; i < 4; ++i) {
+      u8((v >> (8 * i)) & 0xff);
+    }
+  }
+
+  void u64(uint64_t v)
+  {
+    for (size_t i = 0; i < 8; ++i) {
+      u8((v >> (8 * i)) & 0xff);
+    }
+  }
+
+  void str(const string & s)
+  {
+    u32(s.size());
+    out_ += s;
+  }
+
+  /** @return the id of a sort, written to the sort table if new */
+  uint32_t sort_id(const Sort & sort)
+  {
+    auto it = sort_ids_.find(sort);
+    if (it != sort_ids_.end()) {
+      return it->second;
+    }
+
+    // the parameters are written first
+    SortKind sk = sort->get_sort_kind();
+    vector<uint32_t> params;
+    uint8_t kind;
+    if (sk == BOOL) {
+      kind = SNAP_BOOL;
+    } else if (sk == BV) {
+      kind = SNAP_BV;
+      params.push_back(sort->get_width());
+    } else if (sk == INT) {
+      kind = SNAP_INT;
+    } else if (sk == REAL) {
+      kind = SNAP_REAL;
+    } else if (sk == ARRAY) {
+      kind = SNAP_ARRAY;
+      params.push_back(sort_id(sort->get_indexsort()));
+      params.push_back(sort_id(sort->get_elemsort()));
+    } else if (sk == FUNCTION) {
+      kind = SNAP_FUNCTION;
+      for (const auto & s : sort->get_domain_sorts()) {
+        params.push_back(sort_id(s));
+      }
+      params.push_back(sort_id(sort->get_codomain_sort()));
+    } else {
+      throw PonoException("Unsupported sort in snapshot: "
+                          + sort->to_string());
+    }
+
+    string & rec = sort_table_;
+    rec.push_back(static_cast<char>(kind));
+    if (kind == SNAP_FUNCTION) {
+      append_u32(rec, params.size());
+    }
+    for (auto p : params) {
+      append_u32(rec, p);
+    }
+    uint32_t id = num_sorts_++;
+    sort_ids_[sort] = id;
+    return id;
+  }
+
+  /** @return the id of a term, written to the term table with its
+   *          subterms if new
+   */
+  uint32_t term_id(const Term & t)
+  {
+    TermVec to_visit({ t });
+    while (to_visit.size()) {
+      Term cur = to_visit.back();
+      if (term_ids_.find(cur) != term_ids_.end()) {
+        to_visit.pop_back();
+        continue;
+      }
+
+      Op op = cur->get_op();
+      bool children_done = true;
+      for (const auto & c : *cur) {
+        if (term_ids_.find(c) == term_ids_.end()) {
+          to_visit.push_back(c);
+          children_done = false;
+        }
+      }
+      if (!children_done) {
+        continue;
+      }
+      to_visit.pop_back();
+
+      string & rec = term_table_;
+      if (op.is_null()) {
+        uint32_t sid = sort_id(cur->get_sort());
+        if (cur->is_symbol()) {
+          rec.push_back(static_cast<char>(SNAP_SYMBOL));
+          append_u32(rec, sid);
+          append_str(rec, cur->to_string());
+        } else if (cur->get_sort()->get_sort_kind() == ARRAY) {
+          // constant array, the child is the constant element
+          Term elem = *cur->begin();
+          rec.push_back(static_cast<char>(SNAP_CONST_ARRAY));
+          append_u32(rec, sid);
+          append_u32(rec, term_ids_.at(elem));
+        } else {
+          assert(cur->is_value());
+          rec.push_back(static_cast<char>(SNAP_VALUE));
+          append_u32(rec, sid);
+          append_value(rec, cur);
+        }
+      } else {
+        rec.push_back(static_cast<char>(SNAP_OP));
+        append_u32(rec, op_id(op.prim_op));
+        append_u32(rec, op.num_idx);
+        append_u64(rec, op.idx0);
+        append_u64(rec, op.idx1);
+        TermVec children;
+        for (const auto & c : *cur) {
+          children.push_back(c);
+        }
+        append_u32(rec, children.size());
+        for (const auto & c : children) {
+          append_u32(rec, term_ids_.at(c));
+        }
+      }
+      term_ids_[cur] = num_terms_++;
+      terms_.push_back(cur);
+    }
+    return term_ids_.at(t);
+  }
+
+  /** @return the snapshot with the tables followed by the body written
+   *          with u8, u32, ...
+   */
+  string finish(uint32_t flags)
+  {
+    string res(snapshot_magic, snapshot_magic_size);
+    append_u32(res, snapshot_version);
+    append_u32(res, flags);
+    append_u32(res, op_names_.size());
+    for (const auto & name : op_names_) {
+      append_str(res, name);
+    }
+    append_u32(res, num_sorts_);
+    res += sort_table_;
+    append_u32(res, num_terms_);
+    res += term_table_;
+    res += out_;
+    return res;
+  }
+
+  /** @return the terms written so far by id */
+  const TermVec & terms() const { return terms_; }
+
+ private:
+  static void append_u32(string & s, uint32_t v)
+  {
+    for (size_t i = 0; i < 4; ++i) {
+      s.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+    }
+  }
+
+  static void append_u64(string & s, uint64_t v)
+  {
+    for (size_t i = 0; i < 8; ++i) {
+      s.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+    }
+  }
+
+  static void append_str(string & s, const string & v)
+  {
+    append_u32(s, v.size());
+    s += v;
+  }
+
+  /** Append a value as a base (0 for the solver syntax) and digits */
+  static void append_value(string & s, const Term & value)
+  {
+    string v = value->to_string();
+    SortKind sk = value->get_sort()->get_sort_kind();
+    uint8_t base = 0;
+    if (sk == BV) {
+      // printed as #b0101, #x5 or (_ bv5 4)
+      if (v.rfind("#b", 0) == 0) {
+        base = 2;
+        v = v.substr(2);
+      } else if (v.rfind("#x", 0) == 0) {
+        base = 16;
+        v = v.substr(2);
+      } else if (v.rfind("(_ bv", 0) == 0) {
+        base = 10;
+        v = v.substr(5, v.find(' ', 5) - 5);
+      } else {
+        throw PonoException("Unsupported value in snapshot: " + v);
+      }
+    } else if (sk == INT || sk == REAL) {
+      // negative values are printed as (- 3)
+      if (v.rfind("(- ", 0) == 0) {
+        v = "-" + v.substr(3, v.size() - 4);
+      }
+      if (v.find('(') != string::npos) {
+        throw PonoException("Unsupported value in snapshot: " + v);
+      }
+      base = 10;
+    } else if (sk != BOOL) {
+      throw PonoException("Unsupported value in snapshot: " + v);
+    }
+    s.push_back(static_cast<char>(base));
+    append_str(s, v);
+  }
+
+  uint32_t op_id(PrimOp po)
+  {
+    auto it = op_ids_.find(po);
+    if (it != op_ids_.end()) {
+      return it->second;
+    }
+    uint32_t id = op_names_.size();
+    op_names_.push_back(smt::to_string(po));
+    op_ids_[po] = id;
+    return id;
+  }
+
+  string out_;
+  string sort_table_;
+  string term_table_;
+  uint32_t num_sorts_ = 0;
+  uint32_t num_terms_ = 0;
+  unordered_map<Sort, uint32_t> sort_ids_;
+  unordered_map<Term, uint32_t> term_ids_;
+  TermVec terms_;  ///< by id
+  unordered_map<int, uint32_t> op_ids_;
+  vector<string> op_names_;
+};
+
+class SnapshotReader
+{
+ public:
+  SnapshotReader(const char * data, size_t size) : data_(data), size_(size)
+  {
+  }
+
+  uint8_t u8()
+  {
+    need(1);
+    return static_cast<uint8_t>(data_[pos_++]);
+  }
+
+  uint32_t u32()
+  {
+    need(4);
+    uint32_t v = 0;
+    for (size_t i = 0; i < 4; ++i) {
+      v |= uint32_t(static_cast<uint8_t>(data_[pos_++])) << (8 * i);
+    }
+    return v;
+  }
+
+  uint64_t u64()
+  {
+    need(8);
+    uint64_t v = 0;
+    for (size_t i = 0; i < 8; ++i) {
+      v |= uint64_t(static_cast<uint8_t>(data_[pos_++])) << (8 * i);
+    }
+    return v;
+  }
+
+  string str()
+  {
+    uint32_t n = u32();
+    need(n);
+    string s(data_ + pos_, n);
+    pos_ += n;
+    return s;
+  }
+
+  /** Read the magic number and the version
+   *  @return the flags
+   */
+  uint32_t header()
+  {
+    need(snapshot_magic_size);
+    if (memcmp(data_, snapshot_magic, snapshot_magic_size)) {
+      throw PonoException("Not a transition system snapshot");
+    }
+    pos_ = snapshot_magic_size;
+    uint32_t version = u32();
+    if (version != snapshot_version) {
+      throw PonoException("Unsupported snapshot version "
+                          + std::to_string(version));
+    }
+    return u32();
+  }
+
+  bool done() const { return pos_ == size_; }
+
+ private:
+  void need(size_t n)
+  {
+    if (size_ - pos_ < n) {
+      throw PonoException("Malformed snapshot: unexpected end");
+    }
+  }
+
+  const char * data_;
+  size_t size_;
+  size_t pos_ = 0;
+};
+
+}  // namespace
+
+string ts_snapshot(const TransitionSystem & ts,
+                   const TermVec & props,
+                   TermVec * terms)
+{
+  SnapshotWriter w;
+
+  w.u32(ts.statevars().size());
+  for (const auto & sv : ts.statevars()) {
+    w.u32(w.term_id(sv));
+    w.u32(w.term_id(ts.next(sv)));
+  }
+
+  w.u32(ts.inputvars().size());
+  for (const auto & iv : ts.inputvars()) {
+    w.u32(w.term_id(iv));
+  }
+
+  w.u32(w.term_id(ts.init()));
+
+  const UnorderedTermMap & updates = ts.state_updates();
+  w.u32(updates.size());
+  for (const auto & elem : updates) {
+    w.u32(w.term_id(elem.first));
+    w.u32(w.term_id(elem.second));
+  }
+
+  // the trans conjuncts added for the updates and the constraints are
+  // added again when loading, so only the other ones are written
+  UnorderedTermSet implied;
+  const SmtSolver & solver = ts.solver();
+  for (const auto & elem : updates) {
+    implied.insert(solver->make_term(Equal, ts.next(elem.first), elem.second));
+  }
+  w.u32(ts.constraints().size());
+  for (const auto & e : ts.constraints()) {
+    w.u32(w.term_id(e.first));
+    w.u8(e.second);
+    implied.insert(e.first);
+    if (e.second && ts.only_curr(e.first)) {
+      implied.insert(ts.next(e.first));
+    }
+  }
+
+  TermVec others;
+  for (const auto & c : ts.trans_conjuncts()) {
+    if (implied.find(c) == implied.end()) {
+      others.push_back(c);
+    }
+  }
+  if (ts.is_functional() && others.size()) {
+    throw PonoException(
+        "Functional system with unexpected trans conjuncts in snapshot");
+  }
+  w.u32(others.size());
+  for (const auto & c : others) {
+    w.u32(w.term_id(c));
+  }
+
+  const auto & named = ts.named_terms();
+  w.u32(named.size());
+  for (const auto & elem : named) {
+    w.str(elem.first);
+    w.u32(w.term_id(elem.second));
+  }
+
+  w.u32(props.size());
+  for (const auto & p : props) {
+    w.u32(w.term_id(p));
+  }
+
+  if (terms) {
+    *terms = w.terms();
+  }
+  return w.finish(ts.is_functional() ? functional_flag : 0);
+}
+
+void write_ts_snapshot(const string & filename,
+                       const TransitionSystem & ts,
+                       const TermVec & props)
+{
+  string data = ts_snapshot(ts, props);
+  ofstream out(filename, ios::binary);
+  if (!out.is_open()) {
+    throw PonoException("Could not open snapshot " + filename);
+  }
+  out.write(data.data(), data.size());
+  if (!out.good()) {
+    throw PonoException("Failed to write snapshot " + filename);
+  }
+}
+
+string read_ts_snapshot_file(const string & filename)
+{
+  ifstream in(filename, ios::binary);
+  if (!in.is_open()) {
+    throw PonoException("Could not open snapshot " + filename);
+  }
+  ostringstream ss;
+  ss << in.rdbuf();
+  return ss.str();
+}
+
+bool ts_snapshot_is_functional(const char * data, size_t size)
+{
+  SnapshotReader r(data, size);
+  return r.header() & functional_flag;
+}
+
+void load_ts_snapshot(const char * data,
+                      size_t size,
+                      TransitionSystem & ts,
+                      TermVec & props,
+                      TermVec * terms_out)
+{
+  SnapshotReader r(data, size);
+  bool functional = r.header() & functional_flag;
+  if (functional != ts.is_functional()) {
+    throw PonoException(
+        functional ? "Snapshot of a functional system needs a "
+                     "FunctionalTransitionSystem"
+                   : "Snapshot of a relational system needs a "
+                     "RelationalTransitionSystem");
+  }
+  if (ts.statevars().size() || ts.inputvars().size()) {
+    throw PonoException("Can only load a snapshot in an empty system");
+  }
+  RelationalTransitionSystem * rts =
+      dynamic_cast<RelationalTransitionSystem *>(&ts);
+  if (!functional && !rts) {
+    throw PonoException("Expected a RelationalTransitionSystem");
+  }
+
+  const SmtSolver & solver = ts.solver();
+  auto malformed = [](const string & what) {
+    return PonoException("Malformed snapshot: " + what);
+  };
+
+  unordered_map<string, PrimOp> prim_ops;
+  for (int po = 0; po < NUM_OPS_AND_NULL; ++po) {
+    prim_ops[smt::to_string(PrimOp(po))] = PrimOp(po);
+  }
+  vector<PrimOp> ops;
+  uint32_t num_ops = r.u32();
+  for (uint32_t i = 0; i < num_ops; ++i) {
+    string name = r.str();
+    auto it = prim_ops.find(name);
+    if (it == prim_ops.end()) {
+      throw malformed("unknown operator " + name);
+    }
+    ops.push_back(it->second);
+  }
+
+  SortVec sorts;
+  auto get_sort = [&](uint32_t id) {
+    if (id >= sorts.size()) {
+      throw malformed("bad sort id");
+    }
+    return sorts[id];
+  };
+  uint32_t num_sorts = r.u32();
+  for (uint32_t i = 0; i < num_sorts; ++i) {
+    uint8_t kind = r.u8();
+    if (kind == SNAP_BOOL) {
+      sorts.push_back(solver->make_sort(BOOL));
+    } else if (kind == SNAP_BV) {
+      sorts.push_back(solver->make_sort(BV, r.u32()));
+    } else if (kind == SNAP_INT) {
+      sorts.push_back(solver->make_sort(INT));
+    } else if (kind == SNAP_REAL) {
+      sorts.push_back(solver->make_sort(REAL));
+    } else if (kind == SNAP_ARRAY) {
+      Sort idx = get_sort(r.u32());
+      Sort elem = get_sort(r.u32());
+      sorts.push_back(solver->make_sort(ARRAY, idx, elem));
+    } else if (kind == SNAP_FUNCTION) {
+      uint32_t n = r.u32();
+      SortVec params;
+      for (uint32_t j = 0; j < n; ++j) {
+        params.push_back(get_sort(r.u32()));
+      }
+      sorts.push_back(solver->make_sort(FUNCTION, params));
+    } else {
+      throw malformed("unknown sort kind");
+    }
+  }
+
+  TermVec terms;
+  auto get_term = [&](uint32_t id) {
+    if (id >= terms.size()) {
+      throw malformed("bad term id");
+    }
+    return terms[id];
+  };
+  uint32_t num_terms = r.u32();
+  terms.reserve(num_terms);
+  for (uint32_t i = 0; i < num_terms; ++i) {
+    uint8_t kind = r.u8();
+    if (kind == SNAP_SYMBOL) {
+      Sort sort = get_sort(r.u32());
+      terms.push_back(solver->make_symbol(r.str(), sort));
+    } else if (kind == SNAP_VALUE) {
+      Sort sort = get_sort(r.u32());
+      uint8_t base = r.u8();
+      string v = r.str();
+      if (sort->get_sort_kind() == BOOL) {
+        terms.push_back(solver->make_term(v == "true"));
+      } else {
+        terms.push_back(solver->make_term(v, sort, base));
+      }
+    } else if (kind == SNAP_CONST_ARRAY) {
+      Sort sort = get_sort(r.u32());
+      terms.push_back(solver->make_term(get_term(r.u32()), sort));
+    } else if (kind == SNAP_OP) {
+      uint32_t op_idx = r.u32();
+      if (op_idx >= ops.size()) {
+        throw malformed("bad operator id");
+      }
+      Op op;
+      op.prim_op = ops[op_idx];
+      op.num_idx = r.u32();
+      op.idx0 = r.u64();
+      op.idx1 = r.u64();
+      uint32_t n = r.u32();
+      TermVec children;
+      children.reserve(n);
+      for (uint32_t j = 0; j < n; ++j) {
+        children.push_back(get_term(r.u32()));
+      }
+      terms.push_back(solver->make_term(op, children));
+    } else {
+      throw malformed("unknown term kind");
+    }
+  }
+
+  uint32_t n = r.u32();
+  for (uint32_t i = 0; i < n; ++i) {
+    Term cv = get_term(r.u32());
+    Term nv = get_term(r.u32());
+    ts.add_statevar(cv, nv);
+  }
+  n = r.u32();
+  for (uint32_t i = 0; i < n; ++i) {
+    ts.add_inputvar(get_term(r.u32()));
+  }
+
+  // adding constraints changes init, so it is set last
+  Term init = get_term(r.u32());
+
+  n = r.u32();
+  for (uint32_t i = 0; i < n; ++i) {
+    Term sv = get_term(r.u32());
+    ts.assign_next(sv, get_term(r.u32()));
+  }
+
+  vector<pair<Term, bool>> constraints;
+  n = r.u32();
+  for (uint32_t i = 0; i < n; ++i) {
+    Term c = get_term(r.u32());
+    constraints.push_back({ c, r.u8() != 0 });
+  }
+
+  n = r.u32();
+  for (uint32_t i = 0; i < n; ++i) {
+    Term c = get_term(r.u32());
+    if (!rts) {
+      throw malformed("trans conjuncts in a functional system");
+    }
+    rts->constrain_trans(c);
+  }
+
+  for (const auto & e : constraints) {
+    ts.add_constraint(e.first, e.second);
+  }
+  ts.set_init(init);
+
+  n = r.u32();
+  for (uint32_t i = 0; i < n; ++i) {
+    string name = r.str();
+    ts.name_term(name, get_term(r.u32()));
+  }
+
+  n = r.u32();
+  for (uint32_t i = 0; i < n; ++i) {
+    props.push_back(get_term(r.u32()));
+  }
+
+  if (!r.done()) {
+    throw malformed("trailing bytes");
+  }
+  if (terms_out) {
+    *terms_out = std::move(terms);
+  }
+}
+
+}  // namespace pono
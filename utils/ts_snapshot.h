@@ -0,0 +1,88 @@
+/*********************                                                        */
+/*! \file ts_snapshot.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief A binary snapshot of a transition system and its properties, e.g.
+**        to save the result of parsing and preprocessing a large design
+**        and reload it in a later run, in any solver.
+**
+**        All integers are little-endian and strings are a 32-bit length
+**        followed by the bytes, so a snapshot can be read in place from
+**        a mapped file:
+**          magic "PONOSNAP", u32 version, u32 flags (1: functional)
+**          u32 #op names, names
+**          u32 #sorts, sorts (u8 kind, then the width or the sort ids
+**            of the parameters)
+**          u32 #terms, in post-order (u8 kind, then the sort, name or
+**            value of a leaf, or the op, indices and children ids)
+**          u32 #state variables, (current id, next id) pairs
+**          u32 #input variables, ids
+**          init id
+**          u32 #state updates, (variable id, update id) pairs
+**          u32 #constraints, (id, u8 to_init_and_next) pairs
+**          u32 #other trans conjuncts (relational systems), ids
+**          u32 #named terms, (name, id) pairs
+**          u32 #properties, ids
+**
+**/
+
+#pragma once
+
+#include <string>
+
+#include "core/ts.h"
+#include "smt-switch/smt.h"
+
+namespace pono {
+
+/** @return the snapshot of ts and props
+ *  @param terms if given, set to the terms of the snapshot by id
+ *  @throws PonoException if a term has a sort or value that is not
+ *          supported (e.g. a real value that is not a decimal)
+ */
+std::string ts_snapshot(const TransitionSystem & ts,
+                        const smt::TermVec & props,
+                        smt::TermVec * terms = nullptr);
+
+/** Write the snapshot of ts and props to a file
+ *  @throws PonoException if the file cannot be written
+ */
+void write_ts_snapshot(const std::string & filename,
+                       const TransitionSystem & ts,
+                       const smt::TermVec & props);
+
+/** @return the bytes of a snapshot file
+ *  @throws PonoException if the file cannot be read
+ */
+std::string read_ts_snapshot_file(const std::string & filename);
+
+/** @return true iff the snapshot is of a functional system, which must be
+ *          loaded in a FunctionalTransitionSystem
+ *  @throws PonoException if it is not a snapshot of a supported version
+ */
+bool ts_snapshot_is_functional(const char * data, size_t size);
+
+/** Load a snapshot
+ *  @param data the bytes of the snapshot
+ *  @param size the number of bytes
+ *  @param ts a transition system without variables, functional iff the
+ *         snapshot is. The terms are rebuilt in its solver.
+ *  @param props vector to append the properties to
+ *  @param terms if given, set to the rebuilt terms by id, the same ids as
+ *         the terms given by ts_snapshot
+ *  @throws PonoException if the snapshot is malformed or does not fit ts
+ */
+void load_ts_snapshot(const char * data,
+                      size_t size,
+                      TransitionSystem & ts,
+                      smt::TermVec & props,
+                      smt::TermVec * terms = nullptr);
+
+}  // namespace pono
@@ -0,0 +1,591 @@
+/*********************                                                        */
+/*! \file verification_server.cpp
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Resident verification server (pono --serve).
+**
+**/
+
+#include "utils/verification_server.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+
+#include "core/fts.h"
+#include "core/rts.h"
+#include "frontends/aiger_encoder.h"
+#include "frontends/btor2_encoder.h"
+#include "frontends/smv_encoder.h"
+#include "frontends/vmt_encoder.h"
+#include "smt-switch/logging_solver.h"
+#include "smt/available_solvers.h"
+#include "utils/budget.h"
+#include "utils/exceptions.h"
+#include "utils/logger.h"
+#include "utils/memory_profile.h"
+#include "utils/timeline.h"
+#include "utils/ts_snapshot.h"
+
+using namespace smt;
+using namespace std;
+
+namespace pono {
+
+static string file_extension(const string & filename)
+{
+  size_t pos = filename.find_last_of(".");
+  return pos == string::npos ? "" : filename.substr(pos + 1);
+}
+
+static size_t to_index(const string & s)
+{
+  if (s.empty() || s.find_first_not_of("0123456789") != string::npos) {
+    throw PonoException("Expecting a number but got " + s);
+  }
+  return stoul(s);
+}
+
+/** @return the message on one line, for the line based protocol */
+static string one_line(string msg)
+{
+  for (auto & c : msg) {
+    if (c == '\n' || c == '\r') {
+      c = ' ';
+    }
+  }
+  return msg;
+}
+
+static string result_word(ProverResult r, bool bounded)
+{
+  if (r == UNKNOWN && bounded) {
+    return "bounded";
+  }
+  // same words as the btor2 output of pono
+  switch (r) {
+    case FALSE: return "sat";
+    case TRUE: return "unsat";
+    case ERROR: return "error";
+    default: return "unknown";
+  }
+}
+
+VerificationServer::VerificationServer(const PonoOptions & opts,
+                                       const Checker & check,
+                                       unsigned int num_workers)
+    : options_(opts),
+      check_(check),
+      next_handle_(0),
+      next_job_(0),
+      num_running_(0),
+      num_finished_(0),
+      stopping_(false),
+      listen_fd_(-1),
+      shutdown_(false),
+      lemmas_(opts.lemma_exchange_rate_)
+{
+  if (!num_workers) {
+    num_workers = thread::hardware_concurrency();
+  }
+  num_workers = max(num_workers, 1u);
+  workers_.reserve(num_workers);
+  for (unsigned int i = 0; i < num_workers; ++i) {
+    workers_.push_back(thread(&VerificationServer::run_worker, this));
+  }
+}
+
+VerificationServer::~VerificationServer() { stop(); }
+
+size_t VerificationServer::load(const string & filename)
+{
+  TIMELINE_SPAN("load_design");
+  // the terms of the design live in this solver, the jobs copy them
+  SmtSolver s = create_solver_for(options_.smt_solver_,
+                                  options_.engine_,
+                                  false,
+                                  options_.ceg_prophecy_arrays_);
+
+  unique_ptr<TransitionSystem> ts;
+  TermVec props;
+  string ext = file_extension(filename);
+  if (ext == "btor2" || ext == "btor") {
+    FunctionalTransitionSystem * fts = new FunctionalTransitionSystem(s);
+    ts.reset(fts);
+    BTOR2Encoder btor_enc(filename, *fts, options_.simplify_);
+    props = btor_enc.propvec();
+  } else if (ext == "aag" || ext == "aig") {
+    FunctionalTransitionSystem * fts = new FunctionalTransitionSystem(s);
+    ts.reset(fts);
+    AigerEncoder aiger_enc(filename, *fts);
+    props = aiger_enc.propvec();
+  } else if (ext == "smv") {
+    RelationalTransitionSystem * rts = new RelationalTransitionSystem(s);
+    ts.reset(rts);
+    SMVEncoder smv_enc(filename, *rts);
+    props = smv_enc.propvec();
+  } else if (ext == "vmt" || ext == "smt2") {
+    RelationalTransitionSystem * rts = new RelationalTransitionSystem(s);
+    ts.reset(rts);
+    VMTEncoder vmt_enc(filename, *rts);
+    props = vmt_enc.propvec();
+  } else if (ext == "snap") {
+    string data = read_ts_snapshot_file(filename);
+    if (ts_snapshot_is_functional(data.data(), data.size())) {
+      ts.reset(new FunctionalTransitionSystem(s));
+    } else {
+      ts.reset(new RelationalTransitionSystem(s));
+    }
+    load_ts_snapshot(data.data(), data.size(), *ts, props);
+  } else {
+    throw PonoException("Unrecognized file extension " + ext + " for file "
+                        + filename);
+  }
+
+  size_t handle = add_design(*ts, props);
+  logger.log(1,
+             "Server: loaded {} with {} properties as design {}",
+             filename,
+             props.size(),
+             handle);
+  return handle;
+}
+
+size_t VerificationServer::add_design(const TransitionSystem & ts,
+                                      const TermVec & props)
+{
+  shared_ptr<Design> d = make_shared<Design>();
+  if (ts.is_functional()) {
+    d->ts.reset(new FunctionalTransitionSystem(ts));
+  } else {
+    d->ts.reset(new RelationalTransitionSystem(ts));
+  }
+  d->props = props;
+
+  lock_guard<mutex> lock(mutex_);
+  size_t handle = next_handle_++;
+  designs_[handle] = d;
+  return handle;
+}
+
+void VerificationServer::unload(size_t handle)
+{
+  shared_ptr<Design> d;
+  {
+    lock_guard<mutex> lock(mutex_);
+    auto it = designs_.find(handle);
+    if (it == designs_.end()) {
+      throw PonoException("Unknown design " + std::to_string(handle));
+    }
+    d = it->second;
+    designs_.erase(it);
+  }
+  // the queued jobs of the design keep it alive
+  bool last = d.use_count() == 1;
+  d.reset();
+  if (last) {
+    release_memory("server_design");
+  }
+  logger.log(1, "Server: unloaded design {}", handle);
+}
+
+size_t VerificationServer::num_designs() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return designs_.size();
+}
+
+shared_ptr<VerificationServer::Design> VerificationServer::get_design(
+    size_t handle) const
+{
+  lock_guard<mutex> lock(mutex_);
+  auto it = designs_.find(handle);
+  if (it == designs_.end()) {
+    throw PonoException("Unknown design " + std::to_string(handle));
+  }
+  return it->second;
+}
+
+size_t VerificationServer::num_props(size_t handle) const
+{
+  // the properties are not modified after loading
+  return get_design(handle)->props.size();
+}
+
+size_t VerificationServer::submit(size_t handle,
+                                  size_t prop_idx,
+                                  const PonoOptions & opts,
+                                  const Reply & reply)
+{
+  shared_ptr<Design> d = get_design(handle);
+  if (prop_idx >= d->props.size()) {
+    throw PonoException("Property index " + std::to_string(prop_idx)
+                        + " is greater than the number of properties of "
+                        + "design " + std::to_string(handle) + " ("
+                        + std::to_string(d->props.size()) + ")");
+  }
+
+  size_t id;
+  {
+    lock_guard<mutex> lock(mutex_);
+    if (stopping_) {
+      throw PonoException("Server is stopping");
+    }
+    id = next_job_++;
+    // before the job is visible to the workers, so it comes first
+    reply("queued " + std::to_string(id));
+    queue_.push_back({ id, d, prop_idx, opts, reply });
+  }
+  queue_cv_.notify_one();
+  return id;
+}
+
+void VerificationServer::wait()
+{
+  unique_lock<mutex> lock(mutex_);
+  idle_cv_.wait(lock, [this] { return queue_.empty() && !num_running_; });
+}
+
+size_t VerificationServer::num_finished() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return num_finished_;
+}
+
+void VerificationServer::run_worker()
+{
+  while (true) {
+    Job job;
+    {
+      unique_lock<mutex> lock(mutex_);
+      queue_cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      job = std::move(queue_.front());
+      queue_.pop_front();
+      ++num_running_;
+    }
+
+    run_job(job);
+    // the last job of an unloaded design destroys it
+    job = Job();
+    release_memory("server_job");
+
+    {
+      lock_guard<mutex> lock(mutex_);
+      --num_running_;
+      ++num_finished_;
+    }
+    idle_cv_.notify_all();
+  }
+}
+
+void VerificationServer::run_job(const Job & job)
+{
+  TIMELINE_SPAN("server_job");
+  PonoOptions opts = job.opts;
+  if (opts.engine_ == IC3SA_ENGINE) {
+    // IC3SA expects all state variables
+    opts.promote_inputvars_ = true;
+  }
+
+  ProverResult r;
+  bool bounded = false;
+  string msg;
+  try {
+    SmtSolver s = create_solver_for(
+        opts.smt_solver_, opts.engine_, false, opts.ceg_prophecy_arrays_);
+    if (opts.logging_smt_solver_) {
+      s = make_shared<LoggingSolver>(s);
+    }
+
+    unique_ptr<TransitionSystem> ts;
+    Term prop;
+    {
+      // the only place the terms of the design are read
+      lock_guard<mutex> lock(job.design->mutex);
+      TermTranslator tt(s);
+      const TransitionSystem & dts = *job.design->ts;
+      if (dts.is_functional()) {
+        ts.reset(new FunctionalTransitionSystem(dts, tt));
+      } else {
+        ts.reset(new RelationalTransitionSystem(dts, tt));
+      }
+      prop = tt.transfer_term(job.design->props[job.prop_idx], BOOL);
+    }
+
+    vector<UnorderedTermMap> cex;
+    r = check_(opts, prop, *ts, s, cex, bounded);
+    for (size_t t = 0; t < cex.size(); ++t) {
+      for (const auto & elem : cex[t]) {
+        job.reply("cex " + std::to_string(job.id) + " " + std::to_string(t)
+                  + " " + elem.first->to_string() + " "
+                  + elem.second->to_string());
+      }
+    }
+  }
+  catch (std::exception & e) {
+    r = ERROR;
+    msg = " " + one_line(e.what());
+  }
+
+  logger.log(1, "Server: job {} is {}", job.id, result_word(r, bounded));
+  job.reply("result " + std::to_string(job.id) + " "
+            + result_word(r, bounded) + msg);
+}
+
+void VerificationServer::stop()
+{
+  {
+    lock_guard<mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  queue_cv_.notify_all();
+  for (auto & w : workers_) {
+    w.join();
+  }
+  workers_.clear();
+}
+
+bool VerificationServer::handle_request(const string & line,
+                                        const Reply & reply)
+{
+  istringstream in(line);
+  string cmd;
+  in >> cmd;
+  vector<string> args;
+  string arg;
+  while (in >> arg) {
+    args.push_back(arg);
+  }
+
+  try {
+    if (cmd.empty()) {
+      // ignore empty lines
+    } else if (cmd == "load") {
+      if (args.size() != 1) {
+        throw PonoException("Usage: load <file>");
+      }
+      size_t handle = load(args[0]);
+      reply("loaded " + std::to_string(handle) + " "
+            + std::to_string(num_props(handle)));
+    } else if (cmd == "check") {
+      if (args.size() < 2) {
+        throw PonoException("Usage: check <handle> <property> [options]");
+      }
+      size_t handle = to_index(args[0]);
+      size_t prop_idx = to_index(args[1]);
+      PonoOptions opts = options_;
+      vector<string> job_args(args.begin() + 2, args.end());
+      if (job_args.size()
+          && opts.parse_and_set_options(job_args, false) == ERROR) {
+        throw PonoException("Invalid options for the job");
+      }
+      submit(handle, prop_idx, opts, reply);
+    } else if (cmd == "unload") {
+      if (args.size() != 1) {
+        throw PonoException("Usage: unload <handle>");
+      }
+      size_t handle = to_index(args[0]);
+      unload(handle);
+      reply("unloaded " + std::to_string(handle));
+    } else if (cmd == "memory") {
+      reply("memory " + std::to_string(current_memory_kb()) + " "
+            + std::to_string(peak_memory_kb()) + " "
+            + std::to_string(num_designs()));
+    } else if (cmd == "wait") {
+      wait();
+      reply("done");
+    } else if (cmd == "share") {
+      if (args.empty()) {
+        throw PonoException("Usage: share <hash> <lemma>...");
+      }
+      vector<string> lemmas(args.begin() + 1, args.end());
+      reply("shared " + std::to_string(lemmas_.share(args[0], lemmas)));
+    } else if (cmd == "fetch") {
+      if (args.size() != 2) {
+        throw PonoException("Usage: fetch <hash> <index>");
+      }
+      vector<string> lemmas;
+      size_t next = lemmas_.fetch(args[0], to_index(args[1]), lemmas);
+      for (const auto & l : lemmas) {
+        reply("lemma " + l);
+      }
+      reply("fetched " + std::to_string(next));
+    } else if (cmd == "shutdown") {
+      wait();
+      {
+        lock_guard<mutex> lock(mutex_);
+        shutdown_ = true;
+        // wake up serve and the other clients
+        if (listen_fd_ >= 0) {
+          ::shutdown(listen_fd_, SHUT_RDWR);
+        }
+        for (const auto & conn : connections_) {
+          lock_guard<mutex> clock(conn->mutex);
+          if (conn->open) {
+            ::shutdown(conn->fd, SHUT_RD);
+          }
+        }
+      }
+      reply("bye");
+      return false;
+    } else {
+      throw PonoException("Unknown request " + cmd);
+    }
+  }
+  catch (std::exception & e) {
+    reply("error " + one_line(e.what()));
+  }
+  return true;
+}
+
+void VerificationServer::serve_client(shared_ptr<Connection> conn)
+{
+  // the jobs may outlive the client, they drop their replies once closed
+  Reply reply = [conn](const string & line) {
+    lock_guard<mutex> lock(conn->mutex);
+    if (!conn->open) {
+      return;
+    }
+    string out = line + "\n";
+    size_t sent = 0;
+    while (sent < out.size()) {
+      ssize_t n =
+          send(conn->fd, out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+      if (n < 0 && errno == EINTR) {
+        continue;
+      } else if (n <= 0) {
+        // the client went away
+        return;
+      }
+      sent += n;
+    }
+  };
+
+  string buf;
+  char data[4096];
+  bool running = true;
+  while (running) {
+    ssize_t n = recv(conn->fd, data, sizeof(data), 0);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    } else if (n <= 0) {
+      break;
+    }
+    buf.append(data, n);
+    size_t pos;
+    while (running && (pos = buf.find('\n')) != string::npos) {
+      string line = buf.substr(0, pos);
+      buf.erase(0, pos + 1);
+      running = handle_request(line, reply);
+    }
+  }
+
+  {
+    lock_guard<mutex> lock(conn->mutex);
+    conn->open = false;
+    close(conn->fd);
+  }
+
+  // serve joins this thread with the next client
+  lock_guard<mutex> lock(mutex_);
+  connections_.erase(
+      std::find(connections_.begin(), connections_.end(), conn));
+  finished_.push_back(conn);
+}
+
+void VerificationServer::serve(const string & socket_path)
+{
+  sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(addr.sun_path)) {
+    throw PonoException("Socket path is too long: " + socket_path);
+  }
+  strcpy(addr.sun_path, socket_path.c_str());
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    throw PonoException("Could not create a socket: "
+                        + string(strerror(errno)));
+  }
+  unlink(socket_path.c_str());
+  if (::bind(fd, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 16) < 0) {
+    string err = strerror(errno);
+    close(fd);
+    throw PonoException("Could not listen on " + socket_path + ": " + err);
+  }
+  {
+    lock_guard<mutex> lock(mutex_);
+    listen_fd_ = fd;
+  }
+  logger.log(0, "Serving on {}", socket_path);
+  logger.flush();
+
+  // join the threads of the clients that disconnected, a long-running
+  // server would keep them (and their stacks) otherwise
+  auto join_finished = [this]() {
+    vector<shared_ptr<Connection>> finished;
+    {
+      lock_guard<mutex> lock(mutex_);
+      finished.swap(finished_);
+    }
+    for (const auto & conn : finished) {
+      // the open clients at the end were already joined
+      if (conn->thread.joinable()) {
+        conn->thread.join();
+      }
+    }
+  };
+
+  while (true) {
+    int cfd = accept(fd, nullptr, nullptr);
+    if (cfd < 0 && errno == EINTR) {
+      continue;
+    }
+    join_finished();
+    lock_guard<mutex> lock(mutex_);
+    if (cfd < 0 || shutdown_) {
+      if (cfd >= 0) {
+        close(cfd);
+      }
+      break;
+    }
+    shared_ptr<Connection> conn = make_shared<Connection>();
+    conn->fd = cfd;
+    conn->open = true;
+    connections_.push_back(conn);
+    // started while holding mutex_, so the thread is set before the
+    // client can finish
+    conn->thread = thread(&VerificationServer::serve_client, this, conn);
+  }
+
+  vector<shared_ptr<Connection>> open;
+  {
+    lock_guard<mutex> lock(mutex_);
+    listen_fd_ = -1;
+    open = connections_;
+  }
+  for (const auto & conn : open) {
+    conn->thread.join();
+  }
+  join_finished();
+  close(fd);
+  unlink(socket_path.c_str());
+}
+
+}  // namespace pono
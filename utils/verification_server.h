@@ -0,0 +1,222 @@
+/*********************                                                        */
+/*! \file verification_server.h
+** \verbatim
+** Top contributors (to current version):
+**   Makai Mann, Ahmed Irfan
+** This file is part of the pono project.
+** Copyright (c) 2019 by the authors listed in the file AUTHORS
+** in the top-level source directory) and their institutional affiliations.
+** All rights reserved.  See the file LICENSE in the top-level source
+** directory for licensing information.\endverbatim
+**
+** \brief Resident verification server (pono --serve). Designs are parsed
+**        once and kept in memory, and the properties are checked by a pool
+**        of worker threads, so a job does not pay for parsing and process
+**        startup.
+**
+**        The protocol is line based, one request per line:
+**          load <file>
+**            -> loaded <handle> <number of properties>
+**          check <handle> <property index> [<pono options>...]
+**            -> queued <job>
+**            -> result <job> <sat|unsat|bounded|unknown|error> [<message>]
+**               (preceded by "cex <job> <step> <var> <value>" lines for a
+**                counterexample if --witness is given; bounded means all
+**                the bounds up to -k were checked without a
+**                counterexample, unknown that the job stopped early, e.g.
+**                on a time limit)
+**          unload <handle>
+**            -> unloaded <handle> (the design is freed once its queued
+**               jobs finished)
+**          memory
+**            -> memory <resident kB> <peak kB> <number of designs>
+**          wait
+**            -> done (once all the queued jobs finished)
+**          shutdown
+**            -> bye (stops the server after the queued jobs)
+**          share <system hash> <lemma>...
+**          fetch <system hash> <index>
+**            the lemma exchange between portfolios, see lemma_exchange.h
+**        Any failing request gets "error <message>". The options of a job
+**        (e.g. -e ind -k 20 --time-limit 60) override the options the
+**        server was started with. The results of the jobs are streamed
+**        back as they finish, so they may come out of order.
+**
+**        Each job copies the system of its design into a fresh solver
+**        (holding the lock of the design only for the copy) and then runs
+**        the regular pipeline, so the terms of a design are never used by
+**        two threads at once. All the state of a job (the copy, its
+**        engine and solver) is destroyed when it finishes and the freed
+**        memory is given back to the system (see release_memory), so a
+**        long-running server only keeps the designs that are loaded.
+**
+**/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "core/ts.h"
+#include "options/options.h"
+#include "utils/lemma_exchange.h"
+
+namespace pono {
+
+class VerificationServer
+{
+ public:
+  /** Checks a property of a system, both in the solver s of the job
+   *  pono.cpp passes check_prop, so jobs get all the preprocessing
+   *  The last argument is set to true if an UNKNOWN result checked all
+   *  the bounds up to the bound of the options (e.g. a bmc cube job).
+   */
+  typedef std::function<ProverResult(PonoOptions,
+                                     smt::Term &,
+                                     TransitionSystem &,
+                                     const smt::SmtSolver &,
+                                     std::vector<smt::UnorderedTermMap> &,
+                                     bool &)>
+      Checker;
+
+  /** Receives the reply lines of a request, possibly on a worker thread */
+  typedef std::function<void(const std::string &)> Reply;
+
+  /** @param opts the defaults of the jobs
+   *  @param check runs one job
+   *  @param num_workers jobs run in parallel, 0 for the number of
+   *         hardware threads
+   */
+  VerificationServer(const PonoOptions & opts,
+                     const Checker & check,
+                     unsigned int num_workers = 0);
+
+  /** Stops the workers after the queued jobs */
+  ~VerificationServer();
+
+  /** Parse a design (btor2, aiger, smv, vmt or snapshot file)
+   *  @return its handle
+   *  @throws PonoException if the file can't be parsed
+   */
+  size_t load(const std::string & filename);
+
+  /** Add an already built design, e.g. to serve a system built in memory
+   *  The solver of ts must not be used by the caller afterwards.
+   *  @return its handle
+   */
+  size_t add_design(const TransitionSystem & ts, const smt::TermVec & props);
+
+  /** Remove a design, it is destroyed once its queued jobs finished
+   *  @throws PonoException for an unknown handle
+   */
+  void unload(size_t handle);
+
+  /** @return the number of loaded designs */
+  size_t num_designs() const;
+
+  /** @return the number of properties of a design
+   *  @throws PonoException for an unknown handle
+   */
+  size_t num_props(size_t handle) const;
+
+  /** Queue a job
+   *  @param handle the design
+   *  @param prop_idx the property of the design
+   *  @param opts the options of the job
+   *  @param reply receives the queued, cex and result lines of the job
+   *  @return the job id
+   *  @throws PonoException for an unknown handle or property
+   */
+  size_t submit(size_t handle,
+                size_t prop_idx,
+                const PonoOptions & opts,
+                const Reply & reply);
+
+  /** Wait until all the queued jobs finished */
+  void wait();
+
+  /** Handle one request of the protocol
+   *  @param line the request
+   *  @param reply receives the reply lines
+   *  @return false iff the request was shutdown
+   */
+  bool handle_request(const std::string & line, const Reply & reply);
+
+  /** Serve the clients of a Unix domain socket until a shutdown request
+   *  @param socket_path the socket, replaced if it exists
+   *  @throws PonoException if the socket can't be created
+   */
+  void serve(const std::string & socket_path);
+
+  /** @return the number of jobs finished so far */
+  size_t num_finished() const;
+
+ protected:
+  struct Design
+  {
+    std::unique_ptr<TransitionSystem> ts;
+    smt::TermVec props;
+    std::mutex mutex;  ///< held while the system is copied into a job
+  };
+
+  struct Job
+  {
+    size_t id;
+    std::shared_ptr<Design> design;
+    size_t prop_idx;
+    PonoOptions opts;
+    Reply reply;
+  };
+
+  /** A client of serve, closed when the client disconnects */
+  struct Connection
+  {
+    int fd;
+    bool open;
+    std::mutex mutex;  ///< serializes the replies of the jobs
+    std::thread thread;  ///< runs serve_client, joined by serve
+  };
+
+  std::shared_ptr<Design> get_design(size_t handle) const;
+
+  void serve_client(std::shared_ptr<Connection> conn);
+
+  void run_worker();
+
+  void run_job(const Job & job);
+
+  void stop();
+
+  PonoOptions options_;
+  Checker check_;
+
+  mutable std::mutex mutex_;  ///< protects the members below
+  std::condition_variable queue_cv_;
+  std::condition_variable idle_cv_;
+  std::unordered_map<size_t, std::shared_ptr<Design>> designs_;
+  size_t next_handle_;
+  std::deque<Job> queue_;
+  size_t next_job_;
+  size_t num_running_;
+  size_t num_finished_;
+  bool stopping_;  ///< set when the workers should exit
+
+  int listen_fd_;  ///< socket of serve, -1 if not serving
+  bool shutdown_;  ///< set by a shutdown request
+  std::vector<std::shared_ptr<Connection>> connections_;  ///< open clients
+  ///< closed clients, whose thread serve did not join yet
+  std::vector<std::shared_ptr<Connection>> finished_;
+
+  LemmaExchange lemmas_;  ///< has its own lock
+
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace pono